@@ -132,11 +132,13 @@ local flexCallIns = {
   'UnitCommand',
   'UnitCmdDone',
   'UnitDamaged',
+  'UnitDamagedBatch',
   'UnitStunned',
   'UnitEnteredRadar',
   'UnitEnteredLos',
   'UnitLeftRadar',
   'UnitLeftLos',
+  'UnitLosChangedBatch',
   'UnitEnteredUnderwater',
   'UnitEnteredWater',
   'UnitEnteredAir',
@@ -1914,6 +1916,14 @@ function widgetHandler:UnitDamaged(unitID, unitDefID, unitTeam, damage, paralyze
   return
 end
 
+
+function widgetHandler:UnitDamagedBatch(count, unitIDs, unitDefIDs, unitTeams, damages, paralyzers, weaponDefIDs, projectileIDs)
+  for _,w in ipairs(self.UnitDamagedBatchList) do
+    w:UnitDamagedBatch(count, unitIDs, unitDefIDs, unitTeams, damages, paralyzers, weaponDefIDs, projectileIDs)
+  end
+  return
+end
+
 function widgetHandler:UnitStunned(unitID, unitDefID, unitTeam, stunned)
   for _,w in ipairs(self.UnitStunnedList) do
     w:UnitStunned(unitID, unitDefID, unitTeam, stunned)
@@ -1954,6 +1964,14 @@ function widgetHandler:UnitLeftLos(unitID, unitTeam)
 end
 
 
+function widgetHandler:UnitLosChangedBatch(count, unitIDs, unitTeams, transitions)
+  for _,w in ipairs(self.UnitLosChangedBatchList) do
+    w:UnitLosChangedBatch(count, unitIDs, unitTeams, transitions)
+  end
+  return
+end
+
+
 function widgetHandler:UnitEnteredUnderwater(unitID, unitDefID, unitTeam)
   for _,w in ipairs(self.UnitEnteredUnderwaterList) do
     w:UnitEnteredUnderwater(unitID, unitDefID, unitTeam)
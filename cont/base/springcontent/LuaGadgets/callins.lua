@@ -57,6 +57,7 @@ CALLIN_LIST = {
 	"UnitCmdDone",
 	"UnitPreDamaged",
 	"UnitDamaged",
+	"UnitDamagedBatch",
 	"UnitStunned",
 	"UnitTaken",
 	"UnitGiven",
@@ -64,6 +65,7 @@ CALLIN_LIST = {
 	"UnitEnteredLos",
 	"UnitLeftRadar",
 	"UnitLeftLos",
+	"UnitLosChangedBatch",
 	"UnitSeismicPing",
 	"UnitLoaded",
 	"UnitUnloaded",
@@ -94,6 +96,7 @@ CALLIN_LIST = {
 
 	-- projectile callins
 	"ProjectileCreated",
+	"ProjectileCreatedBatch",
 	"ProjectileDestroyed",
 
 	-- shield callins
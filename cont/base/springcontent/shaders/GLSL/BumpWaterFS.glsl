@@ -43,7 +43,14 @@ vec2 clampedWorldPos = clamp(worldPos.xz, vec2(0.0), (vec2(1.0) / TexGenPlane.xy
 
 vec2 screenPos = gl_FragCoord.xy - ViewPos;
 vec2 screencoord = screenPos * ScreenTextureSizeInverse;
-vec2 reftexcoord = screenPos * ScreenInverse;
+#ifdef opt_reflreproject
+  // screen of the frame the reflection was last rendered in
+  uniform mat4 reflViewProjMatrix;
+  vec4 reflClipPos = reflViewProjMatrix * vec4(worldPos, 1.0);
+  vec2 reftexcoord = (reflClipPos.xy / reflClipPos.w) * 0.5 + 0.5;
+#else
+  vec2 reftexcoord = screenPos * ScreenInverse;
+#endif
 
 //////////////////////////////////////////////////
 // Depth conversion
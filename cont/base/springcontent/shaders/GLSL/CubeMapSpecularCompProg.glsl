@@ -0,0 +1,38 @@
+#version 430 core
+
+// regenerates all faces of the specular cubemap, same as CubeMapHandler::CreateSpecularFacePart
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(rgba8) writeonly uniform imageCube specularImg;
+
+uniform int texSize;
+
+uniform vec3 lightDir;
+uniform vec4 specularColor;
+uniform float specularExponent;
+
+// per face: corner direction, x and y spans
+const vec3 FACE_DIRS[6 * 3] = vec3[6 * 3](
+	vec3( 1.0,  1.0,  1.0), vec3( 0.0, 0.0, -2.0), vec3(0.0, -2.0,  0.0), // +x
+	vec3(-1.0,  1.0, -1.0), vec3( 0.0, 0.0,  2.0), vec3(0.0, -2.0,  0.0), // -x
+	vec3(-1.0,  1.0, -1.0), vec3( 2.0, 0.0,  0.0), vec3(0.0,  0.0,  2.0), // +y
+	vec3(-1.0, -1.0,  1.0), vec3( 2.0, 0.0,  0.0), vec3(0.0,  0.0, -2.0), // -y
+	vec3(-1.0,  1.0,  1.0), vec3( 2.0, 0.0,  0.0), vec3(0.0, -2.0,  0.0), // +z
+	vec3( 1.0,  1.0, -1.0), vec3(-2.0, 0.0,  0.0), vec3(0.0, -2.0,  0.0)  // -z
+);
+
+void main() {
+	ivec3 texel = ivec3(gl_GlobalInvocationID.xyz);
+
+	if (any(greaterThanEqual(texel.xy, ivec2(texSize))))
+		return;
+
+	vec2 st = (vec2(texel.xy) + 0.5) / float(texSize);
+	vec3 dir = normalize(FACE_DIRS[texel.z * 3 + 0] + FACE_DIRS[texel.z * 3 + 1] * st.x + FACE_DIRS[texel.z * 3 + 2] * st.y);
+
+	float cosAng = max(0.0, dot(dir, lightDir));
+	float spec = min(1.0, pow(cosAng, specularExponent) + pow(cosAng, 3.0) * 0.25);
+
+	imageStore(specularImg, texel, vec4(specularColor.rgb * spec, 1.0));
+}
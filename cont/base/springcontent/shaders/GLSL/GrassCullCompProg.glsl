@@ -0,0 +1,139 @@
+#version 430 core
+
+// generates the grass turfs of the squares around the camera and appends the
+// visible ones to the mesh and billboard instance lists, see CGrassDrawer::CullGPU
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+// mesh turfs: pos, rotation (radians); billboard turfs: pos, alpha
+layout(std430, binding = 13) writeonly buffer InstancesBuffer {
+	vec4 instances[];
+};
+layout(std430, binding = 14) buffer DrawCommandsBuffer {
+	uint meshCmd[5];      // DrawElementsIndirectCommand, [1] is the instance count
+	uint billboardCmd[4]; // DrawArraysIndirectCommand, [1] is the instance count
+};
+
+uniform sampler2D grassDensityTex;
+uniform sampler2D heightTex;
+
+uniform vec4 mapDims; // mapxy; 1.0 / mapxy
+
+uniform ivec2 windowOrigin;
+uniform ivec2 windowSize;
+uniform int grassMapSizeX;
+
+uniform int numTurfs;
+uniform int maxInstances; // per list, billboards start at this offset
+
+uniform float grassSquareSize;
+uniform float turfSize;
+uniform float bladeHeight;
+uniform float maxGrassDist;
+uniform float maxDetailedDist;
+
+uniform vec3 camPos;
+
+uniform vec4 frustumPlanes[6];
+uniform int frustumPlanesMask;
+
+const float SQUARE_SIZE = 8.0;
+
+const vec2 HM_TEXEL = vec2(8.0, 8.0);
+float HeightAtWorldPos(vec2 wxz) {
+	// Some texel magic to make the heightmap tex perfectly align:
+	wxz +=  -HM_TEXEL * (wxz * mapDims.zw) + 0.5 * HM_TEXEL;
+
+	vec2 uvhm = clamp(wxz, HM_TEXEL, mapDims.xy - HM_TEXEL);
+	uvhm *= mapDims.zw;
+
+	return textureLod(heightTex, uvhm, 0.0).x;
+}
+
+// 1 - normal.y, like CGround::GetSlope
+float SlopeAtWorldPos(vec2 wxz) {
+	float hl = HeightAtWorldPos(wxz - vec2(SQUARE_SIZE, 0.0));
+	float hr = HeightAtWorldPos(wxz + vec2(SQUARE_SIZE, 0.0));
+	float hu = HeightAtWorldPos(wxz - vec2(0.0, SQUARE_SIZE));
+	float hd = HeightAtWorldPos(wxz + vec2(0.0, SQUARE_SIZE));
+
+	return 1.0 - normalize(vec3(hl - hr, 2.0 * SQUARE_SIZE, hu - hd)).y;
+}
+
+bool InFrustum(vec3 center, float radius) {
+	for (int i = 0; i < 6; ++i) {
+		if ((frustumPlanesMask & (1 << i)) == 0)
+			continue;
+
+		if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+// per-square sequence, turfs have to stay in place while the camera moves
+uint Hash(uint x) {
+	x ^= x >> 16u;
+	x *= 0x7FEB352Du;
+	x ^= x >> 15u;
+	x *= 0x846CA68Bu;
+	x ^= x >> 16u;
+	return x;
+}
+
+float NextFloat(inout uint state) {
+	state = Hash(state);
+	return float(state >> 8u) * (1.0 / 16777216.0);
+}
+
+float LinearStep(float edge0, float edge1, float x) {
+	return clamp((x - edge0) / (edge1 - edge0), 0.0, 1.0);
+}
+
+void main() {
+	ivec2 idx = ivec2(gl_GlobalInvocationID.xy);
+
+	if (any(greaterThanEqual(idx, windowSize)))
+		return;
+
+	ivec2 square = windowOrigin + idx;
+
+	if (texelFetch(grassDensityTex, square, 0).r == 0.0)
+		return;
+
+	vec2 squarePos = vec2(square) * grassSquareSize;
+	float dist = distance(camPos, vec3(squarePos.x, HeightAtWorldPos(squarePos), squarePos.y));
+
+	if (dist > maxGrassDist)
+		return;
+
+	uint rng = Hash(uint(square.y * grassMapSizeX + square.x));
+
+	// same LOD bands as the CPU path: meshes sink into the ground while
+	// fading to billboards, billboards fade out towards maxGrassDist
+	float fadeDist  = 128.0 * (1.0 + NextFloat(rng) * 0.5);
+	float meshFade  = LinearStep(maxDetailedDist, maxDetailedDist + fadeDist, dist);
+	float farAlpha  = min(1.0 - LinearStep(maxGrassDist, maxGrassDist + 127.0, dist + 128.0), meshFade);
+
+	bool drawMesh      = (dist < maxDetailedDist + fadeDist);
+	bool drawBillboard = (dist > maxDetailedDist) && (farAlpha > 0.0);
+
+	for (int i = 0; i < numTurfs; ++i) {
+		vec2 turfPos = (vec2(square) + vec2(NextFloat(rng), NextFloat(rng))) * grassSquareSize;
+		float rot = NextFloat(rng) * 6.28318530718;
+
+		vec3 pos = vec3(turfPos.x, HeightAtWorldPos(turfPos), turfPos.y);
+		pos.y -= SlopeAtWorldPos(turfPos) * 30.0;
+
+		if (!InFrustum(pos + vec3(0.0, bladeHeight, 0.0), turfSize + 2.0 * bladeHeight))
+			continue;
+
+		// the window is sized s.t. neither list can overflow
+		if (drawMesh)
+			instances[atomicAdd(meshCmd[1], 1u)] = vec4(pos.x, pos.y - 2.0 * bladeHeight * meshFade, pos.z, rot);
+
+		if (drawBillboard)
+			instances[maxInstances + int(atomicAdd(billboardCmd[1], 1u))] = vec4(pos, farAlpha);
+	}
+}
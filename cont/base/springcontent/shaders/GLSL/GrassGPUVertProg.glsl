@@ -0,0 +1,194 @@
+#version 430 compatibility
+
+// GrassVertProg for the turfs generated by GrassCullCompProg, the mesh pass
+// instances the blade mesh, the billboard pass expands quads from gl_VertexID
+
+// mesh turfs: pos, rotation (radians); billboard turfs: pos, alpha
+layout(std430, binding = 13) readonly buffer InstancesBuffer {
+	vec4 instances[];
+};
+
+#ifndef DISTANCE_FAR
+layout(location = 0) in vec3 bladePos;
+layout(location = 1) in vec2 bladeTexCoord;
+layout(location = 2) in vec3 bladeNormal;
+#endif
+
+uniform int farInstanceOffset;
+uniform float turfSize;
+
+uniform vec2 mapSizePO2;     // (1.0 / pwr2map{x,z} * SQUARE_SIZE)
+uniform vec2 mapSize;        // (1.0 /     map{x,z} * SQUARE_SIZE)
+
+uniform mat4 shadowMatrix;
+uniform vec4 shadowParams;
+
+uniform vec3 camPos;
+uniform vec3 camUp;
+uniform vec3 camRight;
+
+uniform float frame;
+uniform vec3 windSpeed;
+
+uniform vec3 sunDir;
+uniform vec3 ambientLightColor;
+uniform vec3 diffuseLightColor;
+
+out vec3 normal;
+out vec4 shadingTexCoords;
+out vec2 bladeTexCoords;
+out vec3 ambientDiffuseLightTerm;
+#if defined(HAVE_SHADOWS)
+  out vec4 shadowTexCoords;
+#endif
+
+
+const float PI = 3.14159265358979323846264;
+
+// s, t, size x, size y (times turfSize)
+const vec4 BILLBOARD_VERTS[4] = vec4[4](
+	vec4(0.0       , 1.0, -1.0, -1.0),
+	vec4(1.0 / 16.0, 1.0,  1.0, -1.0),
+	vec4(1.0 / 16.0, 0.0,  1.0,  1.0),
+	vec4(0.0       , 0.0, -1.0,  1.0)
+);
+const int BILLBOARD_INDICES[6] = int[6](0, 1, 2, 0, 2, 3);
+
+
+//////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+// Crytek - foliage animation
+// src: http://http.developer.nvidia.com/GPUGems3/gpugems3_ch16.html
+//
+
+// This bends the entire plant in the direction of the wind.
+// vPos: The world position of the plant *relative* to the base of the plant.
+vec3 ApplyMainBending(in vec3 vPos, in vec2 vWind, in float fBendScale)
+{
+	float fLength = length(vPos);
+	float fBF = vPos.y * fBendScale + 1.0;
+	fBF *= fBF;
+	fBF  = fBF * fBF - fBF;
+	vPos.xz += vWind.xy * fBF;
+	return normalize(vPos) * fLength;
+}
+
+vec2 SmoothCurve( vec2 x ) {
+	return x * x * (3.0 - 2.0 * x);
+}
+vec2 TriangleWave( vec2 x ) {
+	return abs( fract( x + 0.5 ) * 1.99 - 1.0 );
+}
+vec2 SmoothTriangleWave( vec2 x ) {
+	// similar to sine wave, but faster
+	return SmoothCurve( TriangleWave( x ) );
+}
+
+const vec2 V_FREQ = vec2(1.975, 0.793);
+
+// This provides "chaotic" motion for leaves and branches (the entire plant, really)
+void ApplyDetailBending(inout vec3 vPos, vec3 vNormal, float fDetailPhase, float fTime, float fSpeed, float fDetailAmp)
+{
+	float vWavesIn = fTime + fDetailPhase;
+	vec2 vWaves = (fract( vec2(vWavesIn) * V_FREQ ) * 2.0 - 1.0 ) * fSpeed;
+	vWaves = SmoothTriangleWave( vWaves );
+	vPos.xyz += vNormal.xyz * vWaves.xxy * fDetailAmp;
+}
+
+
+//////////////////////////////////////////////////////////////////////
+//////////////////////////////////////////////////////////////////////
+
+
+void main() {
+	vec2 texOffset = vec2(0.);
+	vec2 texCoord;
+	gl_FrontColor = gl_Color;
+
+#ifndef DISTANCE_FAR
+	// mesh grass, same as glTranslate(pos) * glRotate(rot, UpVector)
+	vec4 turf = instances[gl_InstanceID];
+
+	float ca = cos(turf.w);
+	float sa = sin(turf.w);
+	mat3 rotMat = mat3(ca, 0.0, -sa, 0.0, 1.0, 0.0, sa, 0.0, ca);
+
+	vec3 objPos = rotMat * bladePos;
+	vec4 worldPos = vec4(turf.xyz + objPos, 1.0);
+	normal = rotMat * bladeNormal;
+	texCoord = bladeTexCoord;
+
+	// anim
+	worldPos.xyz += ApplyMainBending(objPos, windSpeed.xz, texCoord.s * 0.004 + 0.007) - objPos;
+	ApplyDetailBending(worldPos.xyz, normal,
+			texCoord.s,
+			frame / 30.0,
+			0.3,
+			texCoord.t * 0.4);
+
+	// compute ambient & diffuse lighting per-vertex, specular is per-pixel
+	float fNdotL  = dot(normal, sunDir);
+	float diffuseTerm = fNdotL * 0.4 + 0.6; // front surface
+	diffuseTerm = max(diffuseTerm, ((-fNdotL) * 0.3 + 0.7) * 0.8); // back surface
+	ambientDiffuseLightTerm = ambientLightColor + diffuseTerm * diffuseLightColor;
+#else
+	// billboards
+	vec4 turf = instances[farInstanceOffset + gl_InstanceID];
+	vec4 vert = BILLBOARD_VERTS[BILLBOARD_INDICES[gl_VertexID % 6]];
+
+	gl_FrontColor.a *= turf.w; // alpha blend far turfs
+	vec4 worldPos = vec4(turf.xyz, 1.0);
+	normal = vec3(0.0, 1.0, 0.0);
+	texCoord = vert.xy;
+
+	// get the camera angle on the billboard and select the corresponding sprite
+	float cosCamAngle = normalize(camPos.xyz - worldPos.xyz).y;
+	float ang = acos(-cosCamAngle);
+	texOffset.s = clamp(floor((ang + PI / 16.0 - PI / 2.0) / PI * 30.0), 0.0, 15.0) / 16.0;
+
+	// billboard size
+	vec2 billboardSize = vert.zw * turfSize;
+
+	// cut of lower half in horizontal views (the fartexture is empty in lower 50% in horizontal view!)
+	billboardSize.y = max(billboardSize.y, billboardSize.y * cosCamAngle);
+
+	// span the billboard
+	worldPos.xyz += camRight * billboardSize.x;
+	worldPos.xyz += camUp    * billboardSize.y;
+
+	// adjust texcoord for cut of billboard
+	texOffset.t = max((0.5 * cosCamAngle - 0.5), -texCoord.t);
+
+	// anim
+	float seed = fract(abs(dot(turf.xyz, vec3(1.0))));
+	vec3 objPos = (worldPos.xyz - turf.xyz);
+	worldPos.xyz += ApplyMainBending(objPos, windSpeed.xz, seed * 0.006 + 0.01) - objPos;
+	ApplyDetailBending(worldPos.xyz, vec3(1., 0., 1.),
+			seed,
+			frame / 30.0,
+			0.3,
+			0.5 * max(1.0 - texCoord.t, cosCamAngle));
+
+	// move up when looking down (to fix clipping issues)
+	worldPos.y   += 5.0 * cosCamAngle;
+
+	// compute ambient & diffuse lighting per-vertex
+	ambientDiffuseLightTerm = ambientLightColor + diffuseLightColor;
+#endif
+
+#if defined(HAVE_SHADOWS)
+	vec4 vertexShadowPos = shadowMatrix * worldPos;
+
+	vertexShadowPos.xy += shadowParams.xy;
+	shadowTexCoords = vertexShadowPos;
+#endif
+
+	shadingTexCoords = worldPos.xzxz * vec4(mapSizePO2, mapSize);
+	bladeTexCoords   = texCoord + texOffset;
+
+	gl_Position = gl_ProjectionMatrix * worldPos;
+
+	gl_FogFragCoord = distance(camPos, worldPos.xyz);
+	gl_FogFragCoord = (gl_Fog.end - gl_FogFragCoord) * gl_Fog.scale;
+	gl_FogFragCoord = clamp(gl_FogFragCoord, 0.0, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 150
+
+// emulates the glLineStipple call of CLineDrawer::SetupLineStipple
+uniform int stipplePattern;
+uniform int stippleShift;
+uniform float stippleFactor;
+
+noperspective in float vLineDist;
+flat in float vStippled;
+in vec4 vColor;
+
+out vec4 fragColor;
+
+void main()
+{
+	if (vStippled > 0.5) {
+		int bit = (int(vLineDist / stippleFactor) + stippleShift) & 15;
+
+		if (((stipplePattern >> bit) & 1) == 0)
+			discard;
+	}
+
+	fragColor = vColor;
+}
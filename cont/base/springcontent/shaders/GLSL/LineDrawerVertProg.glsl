@@ -0,0 +1,32 @@
+#version 150 compatibility
+
+// draws one queued line segment per instance, see CLineDrawer::DrawAll
+
+in vec4 segStart; // world pos, stippled flag
+in vec3 segEnd;
+in vec4 segStartColor;
+in vec4 segEndColor;
+
+uniform vec2 viewportSize;
+
+noperspective out float vLineDist; // in pixels from the segment start
+flat out float vStippled;
+out vec4 vColor;
+
+vec2 ClipToWindow(vec4 clipPos) {
+	return (clipPos.xy / max(clipPos.w, 1e-4)) * 0.5 * viewportSize;
+}
+
+void main()
+{
+	vec4 clipStart = gl_ModelViewProjectionMatrix * vec4(segStart.xyz, 1.0);
+	vec4 clipEnd   = gl_ModelViewProjectionMatrix * vec4(segEnd, 1.0);
+
+	bool isEnd = (gl_VertexID == 1);
+
+	vLineDist = isEnd ? distance(ClipToWindow(clipStart), ClipToWindow(clipEnd)) : 0.0;
+	vStippled = segStart.w;
+	vColor = isEnd ? segEndColor : segStartColor;
+
+	gl_Position = isEnd ? clipEnd : clipStart;
+}
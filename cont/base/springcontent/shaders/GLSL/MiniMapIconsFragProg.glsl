@@ -0,0 +1,17 @@
+#version 150
+
+uniform sampler2D iconTex;
+
+in vec2 vTexCoords;
+in vec4 vColor;
+
+out vec4 fragColor;
+
+void main()
+{
+	fragColor = vColor * texture(iconTex, vTexCoords);
+
+	// same as the GL_GREATER 0.0 alpha test of the per-quad path
+	if (fragColor.a <= 0.0)
+		discard;
+}
@@ -0,0 +1,49 @@
+#version 150 compatibility
+
+// expands one minimap icon quad per instance, see CUnitDrawerGLSL::DrawUnitMiniMapIconsInstanced
+
+in vec3 iconPosScale; // world xz, icon scale
+in vec4 iconColor;
+in vec4 iconTexCoords; // icon atlas x1, y1, x2, y2
+
+uniform vec2 iconSize; // CMiniMap::GetUnitSize{X,Y}
+uniform vec2 mapSize;  // map{x,y} * SQUARE_SIZE
+uniform int rotation;  // CMiniMap::RotationOptions
+
+out vec2 vTexCoords;
+out vec4 vColor;
+
+const vec2 QUAD_VERTS[6] = vec2[6](
+	vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+	vec2(1.0, 1.0), vec2(0.0, 1.0), vec2(0.0, 0.0)
+);
+
+void main()
+{
+	vec2 pos = iconPosScale.xy;
+
+	switch (rotation) {
+		case 1: { // ROTATION_90
+			pos.x = mapSize.x - pos.x;
+			pos = vec2(pos.y * (mapSize.x / mapSize.y), pos.x * (mapSize.y / mapSize.x));
+		} break;
+		case 2: { // ROTATION_180
+			pos = mapSize - pos;
+		} break;
+		case 3: { // ROTATION_270
+			pos.y = mapSize.y - pos.y;
+			pos = vec2(pos.y * (mapSize.x / mapSize.y), pos.x * (mapSize.y / mapSize.x));
+		} break;
+		default: {
+		} break;
+	}
+
+	vec2 corner = QUAD_VERTS[gl_VertexID];
+
+	pos += (corner * 2.0 - 1.0) * iconSize * iconPosScale.z;
+
+	vTexCoords = mix(iconTexCoords.xy, iconTexCoords.zw, corner);
+	vColor = iconColor;
+
+	gl_Position = gl_ModelViewProjectionMatrix * vec4(pos, 0.0, 1.0);
+}
@@ -0,0 +1,153 @@
+#version 430 core
+
+// culls the instances of S3DModelVAO::Submit, see ModelGPUCuller::Submit
+
+layout(local_size_x = 64) in;
+
+struct DrawCommand {
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	uint baseVertex;
+	uint baseInstance;
+};
+
+// mirrors ModelUniformData, see ModelsMemStorageDefs.h
+struct ModelUniformData {
+	uint composite;
+	uint unused2;
+	uint unused3;
+	uint unused4;
+
+	float maxHealth;
+	float health;
+	float cullRadius;
+	float unused6;
+
+	vec4 drawPos;
+	vec4 speed;
+
+	vec4 userDefined[4];
+};
+
+layout(std140, binding = 1) readonly buffer UniformDataBuffer {
+	ModelUniformData uni[];
+};
+
+// SInstanceData: matOffset, uniOffset, info, bposeMatOffset
+layout(std430, binding = 5) readonly buffer CandidatesBuffer {
+	uvec4 candidates[];
+};
+layout(std430, binding = 6) readonly buffer CandidateCmdsBuffer {
+	uint candidateCmds[];
+};
+layout(std430, binding = 7) buffer DrawCommandsBuffer {
+	DrawCommand cmds[];
+};
+layout(std430, binding = 8) writeonly buffer InstancesBuffer {
+	uvec4 instances[];
+};
+
+uniform int numCandidates;
+uniform int numUniforms;
+
+uniform vec4 frustumPlanes[6];
+uniform int frustumPlanesMask;
+
+// 0 := no occlusion culling
+uniform int pyramidLevels;
+uniform vec2 pyramidSize;
+uniform mat4 pyramidViewProj;
+uniform sampler2D pyramidTex;
+
+bool InFrustum(vec3 center, float radius) {
+	for (int i = 0; i < 6; ++i) {
+		if ((frustumPlanesMask & (1 << i)) == 0)
+			continue;
+
+		if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+bool IsOccluded(vec3 center, float radius) {
+	if (pyramidLevels == 0)
+		return false;
+
+	vec2 ndcMin = vec2( 1e9);
+	vec2 ndcMax = vec2(-1e9);
+	float minDepth = 1e9;
+
+	// screen rect and nearest depth of the sphere's bounding box
+	for (int i = 0; i < 8; ++i) {
+		vec3 corner = center + radius * vec3(
+			((i & 1) != 0) ? 1.0 : -1.0,
+			((i & 2) != 0) ? 1.0 : -1.0,
+			((i & 4) != 0) ? 1.0 : -1.0
+		);
+		vec4 clipPos = pyramidViewProj * vec4(corner, 1.0);
+
+		// crosses the near plane
+		if (clipPos.w <= 0.0)
+			return false;
+
+		vec3 ndcPos = clipPos.xyz / clipPos.w;
+
+		ndcMin = min(ndcMin, ndcPos.xy);
+		ndcMax = max(ndcMax, ndcPos.xy);
+		minDepth = min(minDepth, ndcPos.z);
+	}
+
+	#ifndef DEPTH_CLIP01
+	minDepth = minDepth * 0.5 + 0.5;
+	#endif
+
+	vec2 uvMin = clamp(ndcMin * 0.5 + 0.5, 0.0, 1.0);
+	vec2 uvMax = clamp(ndcMax * 0.5 + 0.5, 0.0, 1.0);
+	vec2 extent = (uvMax - uvMin) * pyramidSize;
+
+	// the level on which the rect covers at most 2x2 texels
+	int level = clamp(int(ceil(log2(max(max(extent.x, extent.y), 1.0)))), 0, pyramidLevels - 1);
+
+	ivec2 levelSize = textureSize(pyramidTex, level);
+	ivec2 texMin = clamp(ivec2(uvMin * vec2(levelSize)), ivec2(0), levelSize - 1);
+	ivec2 texMax = clamp(ivec2(uvMax * vec2(levelSize)), ivec2(0), levelSize - 1);
+
+	float maxDepth = 0.0;
+
+	for (int y = texMin.y; y <= texMax.y; ++y) {
+		for (int x = texMin.x; x <= texMax.x; ++x) {
+			maxDepth = max(maxDepth, texelFetch(pyramidTex, ivec2(x, y), level).x);
+		}
+	}
+
+	return (minDepth > maxDepth);
+}
+
+void main() {
+	int i = int(gl_GlobalInvocationID.x);
+
+	if (i >= numCandidates)
+		return;
+
+	uvec4 instData = candidates[i];
+
+	// defs and bare models have no uniforms to cull by
+	if (instData.y < uint(numUniforms)) {
+		vec3 center = uni[instData.y].drawPos.xyz;
+		float radius = uni[instData.y].cullRadius;
+
+		if (!InFrustum(center, radius))
+			return;
+
+		if (IsOccluded(center, radius))
+			return;
+	}
+
+	uint cmdIdx = candidateCmds[i];
+	uint slot = atomicAdd(cmds[cmdIdx].instanceCount, 1u);
+
+	instances[cmds[cmdIdx].baseInstance + slot] = instData;
+}
@@ -0,0 +1,33 @@
+#version 430 core
+
+// builds one level of a max-depth pyramid, see ModelGPUCuller::BuildDepthPyramid
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+uniform sampler2D srcTex;
+uniform int srcLevel;
+uniform ivec2 srcSize;
+uniform ivec2 dstSize;
+
+layout(r32f) writeonly uniform image2D dstImg;
+
+void main() {
+	ivec2 dstTexel = ivec2(gl_GlobalInvocationID.xy);
+
+	if (any(greaterThanEqual(dstTexel, dstSize)))
+		return;
+
+	// level 0 shrinks the depth copy by a factor in [1, 2), so a texel can cover up to 3x3 source texels
+	ivec2 beg = (dstTexel * srcSize) / dstSize;
+	ivec2 end = min(((dstTexel + 1) * srcSize + dstSize - 1) / dstSize, srcSize);
+
+	float maxDepth = 0.0;
+
+	for (int y = beg.y; y < end.y; ++y) {
+		for (int x = beg.x; x < end.x; ++x) {
+			maxDepth = max(maxDepth, texelFetch(srcTex, ivec2(x, y), srcLevel).x);
+		}
+	}
+
+	imageStore(dstImg, dstTexel, vec4(maxDepth));
+}
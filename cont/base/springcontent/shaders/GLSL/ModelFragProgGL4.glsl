@@ -6,6 +6,13 @@ layout(binding = 1) uniform sampler2D tex2;
 #if (USE_SHADOWS == 1)
 	layout(binding = 2) uniform sampler2DShadow shadowTex;
 	layout(binding = 3) uniform sampler2D shadowColorTex;
+	layout(binding = 6) uniform sampler2DArrayShadow shadowCascadeTex;
+
+	// near cascades in front of shadowTex, nearest first
+	uniform int numShadowCascades = 0;
+	uniform mat4 shadowCascadeMat0;
+	uniform mat4 shadowCascadeMat1;
+	uniform mat4 shadowCascadeMat2;
 #endif
 
 layout(binding = 4) uniform samplerCube reflectTex;
@@ -70,9 +77,26 @@ bool AlphaDiscard(float a) {
 	return ((alphaTestGT + alphaTestLT + alphaCtrl.w) == 0.0);
 }
 
+#if (USE_SHADOWS == 1)
+float GetShadowDepthTest(vec3 shadowCoord) {
+	mat4 cascadeMats[3] = mat4[3](shadowCascadeMat0, shadowCascadeMat1, shadowCascadeMat2);
+
+	for (int i = 0; i < numShadowCascades; i++) {
+		vec3 cascadeCoord = (cascadeMats[i] * worldPos).xyz;
+		cascadeCoord.xy += vec2(0.5);
+
+		// keep clear of the border, the next cascade covers it
+		if (all(greaterThan(cascadeCoord.xy, vec2(0.01))) && all(lessThan(cascadeCoord.xy, vec2(0.99))))
+			return texture(shadowCascadeTex, vec4(cascadeCoord.xy, float(i), cascadeCoord.z));
+	}
+
+	return texture(shadowTex, shadowCoord);
+}
+#endif
+
 vec3 GetShadowMult(vec3 shadowCoord, float NdotL) {
 	#if (USE_SHADOWS == 1)
-		float sh = min(texture(shadowTex, shadowCoord).r, smoothstep(0.0, 0.35, NdotL));
+		float sh = min(GetShadowDepthTest(shadowCoord), smoothstep(0.0, 0.35, NdotL));
 		vec3 shColor = texture(shadowColorTex, shadowCoord.xy).rgb;
 		return mix(1.0, sh, shadowDensity.y) * shColor;
 	#else
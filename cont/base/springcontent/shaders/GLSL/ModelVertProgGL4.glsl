@@ -92,6 +92,11 @@ layout(std140, binding = 0) readonly buffer TransformBuffer {
 	Transform transforms[];
 };
 
+// world placements of statically posed instances (matrixMode == 2), indexed by instData.w
+layout(std140, binding = 2) readonly buffer StaticTransformBuffer {
+	Transform staticTransforms[];
+};
+
 uniform int cameraMode = 0;
 uniform int matrixMode = 0;
 
@@ -337,15 +342,19 @@ void GetModelSpaceVertex(out vec4 msPosition, out vec3 msNormal)
 
 void main(void)
 {
-	bool staticModel = (matrixMode > 0);
-
 	vec4 modelPos;
 	vec3 modelNormal;
 	GetModelSpaceVertex(modelPos, modelNormal);
 
-	if (staticModel) {
+	if (matrixMode == 1) {
 		worldPos = staticModelMatrix * modelPos;
 		worldNormal = mat3(staticModelMatrix) * modelNormal;
+	} else if (matrixMode == 2) {
+		Transform tx = staticTransforms[instData.w];
+
+		worldPos = ApplyTransform(tx, modelPos);
+		tx.trSc = vec4(0, 0, 0, 1); //nullify the transform part
+		worldNormal = ApplyTransform(tx, modelNormal);
 	} else {
 		// do interpolation
 		Transform tx = Lerp(
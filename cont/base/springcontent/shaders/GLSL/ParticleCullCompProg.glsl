@@ -0,0 +1,94 @@
+#version 430 core
+
+// collects the live GPU particles inside the view, see ParticleGPUSim::Prepare
+
+layout(local_size_x = 64) in;
+
+// mirrors GPUParticle, see ParticleGPUSim.h
+struct Particle {
+	vec4 posSize;
+	vec4 speedGrowth;
+	vec4 accelDrag;
+	vec4 ageParams;
+	vec4 rotParams;
+	vec4 color;
+	vec4 texCoords;
+	ivec4 info; // texPage, colorRamp, spawnFrame, flags
+};
+
+struct DrawCommand {
+	uint count;
+	uint instanceCount;
+	uint first;
+	uint baseInstance;
+};
+
+layout(std430, binding = 9) readonly buffer ParticlesBuffer {
+	Particle particles[];
+};
+// (sort key, particle index)
+layout(std430, binding = 11) writeonly buffer EntriesBuffer {
+	uvec2 entries[];
+};
+layout(std430, binding = 12) buffer DrawCommandBuffer {
+	DrawCommand cmd;
+};
+
+uniform int numParticles;
+uniform int numEntries;
+uniform int sortEntries;
+uniform float timeOffset;
+
+uniform vec3 camPos;
+uniform vec3 camDir;
+
+uniform vec4 frustumPlanes[6];
+uniform int frustumPlanesMask;
+
+// sorts behind every visible particle
+const float DEAD_KEY = -3.0e38;
+
+bool InFrustum(vec3 center, float radius) {
+	for (int i = 0; i < 6; ++i) {
+		if ((frustumPlanesMask & (1 << i)) == 0)
+			continue;
+
+		if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+			return false;
+	}
+
+	return true;
+}
+
+void main() {
+	int i = int(gl_GlobalInvocationID.x);
+
+	if (i >= numEntries)
+		return;
+
+	bool visible = (i < numParticles);
+	vec3 drawPos = vec3(0.0);
+
+	if (visible) {
+		Particle p = particles[i];
+
+		drawPos = p.posSize.xyz + p.speedGrowth.xyz * timeOffset;
+		visible = (p.ageParams.x < 1.0) && InFrustum(drawPos, p.posSize.w + p.speedGrowth.w * timeOffset);
+	}
+
+	if (sortEntries == 0) {
+		if (!visible)
+			return;
+
+		// compacted, in no particular order
+		entries[atomicAdd(cmd.count, 6u) / 6u] = uvec2(0u, uint(i));
+		return;
+	}
+
+	// every entry gets a key, the sort moves the invisible ones to the end
+	if (visible)
+		atomicAdd(cmd.count, 6u);
+
+	float key = visible ? dot(drawPos - camPos, camDir) : DEAD_KEY;
+	entries[i] = uvec2(floatBitsToUint(key), uint(i));
+}
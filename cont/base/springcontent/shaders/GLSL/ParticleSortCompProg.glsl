@@ -0,0 +1,36 @@
+#version 430 core
+
+// one merge step of the bitonic sort of ParticleGPUSim::Sort, far entries first
+
+layout(local_size_x = 256) in;
+
+// (sort key, particle index)
+layout(std430, binding = 11) buffer EntriesBuffer {
+	uvec2 entries[];
+};
+
+uniform int numEntries;
+uniform int blockSize;
+uniform int compareDist;
+
+void main() {
+	uint i = gl_GlobalInvocationID.x;
+	uint l = i ^ uint(compareDist);
+
+	if (i >= uint(numEntries) || l <= i)
+		return;
+
+	uvec2 a = entries[i];
+	uvec2 b = entries[l];
+
+	float ka = uintBitsToFloat(a.x);
+	float kb = uintBitsToFloat(b.x);
+
+	// descending within even blocks and ascending within odd ones, the final merge is descending
+	bool descending = ((i & uint(blockSize)) == 0u);
+
+	if (descending ? (ka < kb) : (ka > kb)) {
+		entries[i] = b;
+		entries[l] = a;
+	}
+}
@@ -0,0 +1,58 @@
+#version 430 core
+
+// advances the GPU particles to the current sim frame, see ParticleGPUSim::Update
+
+layout(local_size_x = 64) in;
+
+// mirrors GPUParticle, see ParticleGPUSim.h
+struct Particle {
+	vec4 posSize;
+	vec4 speedGrowth;
+	vec4 accelDrag;
+	vec4 ageParams;
+	vec4 rotParams;
+	vec4 color;
+	vec4 texCoords;
+	ivec4 info; // texPage, colorRamp, spawnFrame, flags
+};
+
+layout(std430, binding = 9) buffer ParticlesBuffer {
+	Particle particles[];
+};
+
+uniform int numParticles;
+uniform int curFrame;
+uniform int firstFrame;
+uniform vec3 windVec;
+
+void main() {
+	int i = int(gl_GlobalInvocationID.x);
+
+	if (i >= numParticles)
+		return;
+
+	Particle p = particles[i];
+
+	if (p.ageParams.x >= 1.0)
+		return;
+
+	// particles spawned since the last update only start moving from their spawn frame on
+	int numSteps = curFrame - max(firstFrame, p.info.z);
+
+	for (int n = 0; n < numSteps && p.ageParams.x < 1.0; ++n) {
+		p.posSize.xyz += p.speedGrowth.xyz;
+		p.posSize.xyz += windVec * p.ageParams.x * p.rotParams.w;
+
+		p.speedGrowth.xyz = (p.speedGrowth.xyz + p.accelDrag.xyz) * p.accelDrag.w;
+
+		p.posSize.w = p.posSize.w * p.ageParams.z + p.speedGrowth.w;
+		p.posSize.w += (p.ageParams.w - p.posSize.w) * 0.2 * float(p.posSize.w < p.ageParams.w);
+
+		p.rotParams.x += p.rotParams.y;
+		p.rotParams.y += p.rotParams.z;
+
+		p.ageParams.x = min(p.ageParams.x + p.ageParams.y, 1.0);
+	}
+
+	particles[i] = p;
+}
@@ -0,0 +1,121 @@
+#version 430 compatibility
+
+// expands the GPU particles into billboards, see ParticleGPUSim::Draw
+// the outputs match ProjFXVertProg, ProjFXFragProg does the shading
+
+// mirrors GPUParticle, see ParticleGPUSim.h
+struct Particle {
+	vec4 posSize;
+	vec4 speedGrowth;
+	vec4 accelDrag;
+	vec4 ageParams;
+	vec4 rotParams;
+	vec4 color;
+	vec4 texCoords;
+	ivec4 info; // texPage, colorRamp, spawnFrame, flags
+};
+
+layout(std430, binding = 9) readonly buffer ParticlesBuffer {
+	Particle particles[];
+};
+// RAMP_NUM_COLORS packed RGBA8 colors per ramp
+layout(std430, binding = 10) readonly buffer RampsBuffer {
+	uint ramps[];
+};
+// (sort key, particle index), the visible ones first
+layout(std430, binding = 11) readonly buffer EntriesBuffer {
+	uvec2 entries[];
+};
+
+out vec4 vCol;
+centroid out vec4 vUV;
+out float vLayer;
+out float vBF;
+out float fogFactor;
+out vec4 vsPos;
+noperspective out vec2 screenUV;
+
+out float gl_ClipDistance[1];
+
+uniform float timeOffset;
+
+// of the camera the billboards face
+uniform vec3 camRight;
+uniform vec3 camUp;
+uniform vec3 camDir;
+uniform vec3 viewPos;
+
+uniform vec2 fogParams;
+uniform vec3 camPos;
+uniform vec4 clipPlane = vec4(0.0, 0.0, 0.0, 1.0);
+
+const int RAMP_NUM_COLORS = 16;
+const int FLAG_DIRECTIONAL = 1;
+
+// two triangles per particle
+const int QUAD_CORNERS[6] = int[](0, 1, 2, 2, 3, 0);
+const vec2 CORNER_OFFSETS[4] = vec2[](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(1.0, 1.0), vec2(-1.0, 1.0));
+
+#define SNORM2NORM(value) (value * 0.5 + 0.5)
+
+vec4 GetRampColor(int rampIdx, float age) {
+	float f = age * float(RAMP_NUM_COLORS - 1);
+	int i0 = min(int(f), RAMP_NUM_COLORS - 1);
+	int i1 = min(i0 + 1, RAMP_NUM_COLORS - 1);
+
+	vec4 c0 = unpackUnorm4x8(ramps[rampIdx * RAMP_NUM_COLORS + i0]);
+	vec4 c1 = unpackUnorm4x8(ramps[rampIdx * RAMP_NUM_COLORS + i1]);
+
+	return mix(c0, c1, fract(f));
+}
+
+void main() {
+	Particle p = particles[entries[gl_VertexID / 6].y];
+
+	vec3 drawPos = p.posSize.xyz + p.speedGrowth.xyz * timeOffset;
+	float drawSize = p.posSize.w + p.speedGrowth.w * timeOffset;
+
+	vec3 xdir = camRight;
+	vec3 ydir = camUp;
+
+	if ((p.info.w & FLAG_DIRECTIONAL) != 0) {
+		vec3 zdir = normalize(drawPos - viewPos);
+		vec3 sdir = cross(zdir, p.speedGrowth.xyz);
+
+		if (dot(sdir, sdir) > 0.001) {
+			ydir = normalize(sdir);
+			xdir = cross(ydir, zdir);
+		}
+	}
+
+	vec2 corner = CORNER_OFFSETS[QUAD_CORNERS[gl_VertexID % 6]];
+	vec2 offset = corner;
+
+	if (abs(p.rotParams.x) > 0.01) {
+		float s = sin(p.rotParams.x);
+		float c = cos(p.rotParams.x);
+		offset = mat2(c, s, -s, c) * offset;
+	}
+
+	vec3 pos = drawPos + (xdir * offset.x + ydir * offset.y) * drawSize;
+
+	if (p.info.y >= 0)
+		vCol = GetRampColor(p.info.y, p.ageParams.x);
+	else
+		vCol = p.color * (1.0 - p.ageParams.x);
+
+	vUV = mix(p.texCoords.xy, p.texCoords.zw, SNORM2NORM(corner)).xyxy;
+	vLayer = float(p.info.x);
+	vBF = 0.0;
+
+	float fogDist = length(pos - camPos);
+	fogFactor = (fogParams.y - fogDist) / (fogParams.y - fogParams.x);
+	fogFactor = clamp(fogFactor, 0.0, 1.0);
+
+	gl_ClipDistance[0] = dot(vec4(pos, 1.0), clipPlane); //water clip plane
+
+	// viewport relative UV [0.0, 1.0]
+	vsPos = gl_ModelViewMatrix * vec4(pos, 1.0);
+	gl_Position = gl_ProjectionMatrix * vsPos;
+	screenUV = SNORM2NORM(gl_Position.xy / gl_Position.w);
+}
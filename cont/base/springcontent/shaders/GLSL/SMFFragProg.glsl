@@ -69,6 +69,28 @@ uniform vec2 infoTexGen;     // 1.0/(pwr2map{x,z} * SQUARE_SIZE)
 	uniform sampler2DShadow shadowTex;
 	uniform sampler2D shadowColorTex;
 	uniform mat4 shadowMat;
+
+	// near cascades in front of shadowTex, nearest first
+	uniform sampler2DArrayShadow shadowCascadeTex;
+	uniform int numShadowCascades;
+	uniform mat4 shadowCascadeMat0;
+	uniform mat4 shadowCascadeMat1;
+	uniform mat4 shadowCascadeMat2;
+
+	float GetShadowDepthTest(vec4 vertexShadowPos) {
+		mat4 cascadeMats[3] = mat4[3](shadowCascadeMat0, shadowCascadeMat1, shadowCascadeMat2);
+
+		for (int i = 0; i < numShadowCascades; i++) {
+			vec3 cascadeCoord = (cascadeMats[i] * vertexWorldPos).xyz;
+			cascadeCoord.xy += vec2(0.5);
+
+			// keep clear of the border, the next cascade covers it
+			if (all(greaterThan(cascadeCoord.xy, vec2(0.01))) && all(lessThan(cascadeCoord.xy, vec2(0.99))))
+				return texture(shadowCascadeTex, vec4(cascadeCoord.xy, float(i), cascadeCoord.z));
+		}
+
+		return shadow2DProj(shadowTex, vertexShadowPos).r;
+	}
 #endif
 
 #ifdef SMF_WATER_ABSORPTION
@@ -368,7 +390,7 @@ void main() {
 
 		// same as ARB shader: shadowCoeff = 1 - (1 - shadowCoeff) * groundShadowDensity
 		vec3 shadowColor = texture(shadowColorTex, vertexShadowPos.xy).rgb;
-		shadowCoeff = mix(vec3(1.0), shadow2DProj(shadowTex, vertexShadowPos).r * shadowColor, groundShadowDensity);
+		shadowCoeff = mix(vec3(1.0), GetShadowDepthTest(vertexShadowPos) * shadowColor, groundShadowDensity);
 	}
 	#endif
 
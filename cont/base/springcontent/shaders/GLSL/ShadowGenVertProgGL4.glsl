@@ -100,9 +100,15 @@ out Data {
 };
 out float gl_ClipDistance[2];
 
+// set while drawing one of the near shadow cascades
+uniform int useCascadeView = 0;
+uniform mat4 cascadeView;
+
 void TransformShadowCam(vec4 worldPos, vec3 worldNormal) {
-	vec4 lightVertexPos = shadowView * worldPos;
-	vec3 lightVertexNormal = normalize(mat3(shadowView) * worldNormal);
+	mat4 lightView = (useCascadeView != 0) ? cascadeView : shadowView;
+
+	vec4 lightVertexPos = lightView * worldPos;
+	vec3 lightVertexNormal = normalize(mat3(lightView) * worldNormal);
 
 	float NdotL = clamp(lightVertexNormal.z, 0.0, 1.0);
 
@@ -2256,6 +2256,20 @@ struct SSkirmishAICallback {
 
 	bool              (CALLING_CONV *Debug_GraphDrawer_isEnabled)(int skirmishAIId);
 
+	/**
+	 * Bulk variant of Unit_getPos, Unit_getVel, Unit_getHealth,
+	 * Unit_getBuildProgress and Unit_getDef, for AIs that poll many units
+	 * every frame: queries all of the given units in a single call.
+	 * Every non-NULL output array receives one entry per unit, in the same
+	 * order as unitIds (three floats per unit for positions and velocities);
+	 * pass NULL for any field that is not needed.
+	 * Each value is the same as the matching single-unit getter returns,
+	 * including the fail values for units that this team can not see.
+	 *
+	 * @return the number of units written, which is unitIds_size
+	 */
+	int               (CALLING_CONV *getUnitsState)(int skirmishAIId, int* unitIds, int unitIds_size, float* positions, float* velocities, float* healths, float* buildProgresses, int* unitDefIds);
+
 };
 
 #if	defined(__cplusplus)
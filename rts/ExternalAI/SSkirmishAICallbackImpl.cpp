@@ -206,12 +206,11 @@ static float getRulesParamFloatValueByName(
 	const char* rulesParamName,
 	float defaultValue
 ) {
-	const std::string key(rulesParamName);
-	const auto it = params.find(key);
-	if (it == params.end())
+	const LuaRulesParams::Param* paramPtr = params.Find(rulesParamName);
+	if (paramPtr == nullptr)
 		return defaultValue;
 
-	const LuaRulesParams::Param& param = it->second;
+	const LuaRulesParams::Param& param = *paramPtr;
 	if (!modParamIsVisible(param, losMask))
 		return defaultValue;
 
@@ -229,13 +228,12 @@ static const char* getRulesParamStringValueByName(
 	const char* rulesParamName,
 	const char* defaultValue
 ) {
-	const std::string key(rulesParamName);
-	const auto it = params.find(key);
-	if (it == params.end())
+	const LuaRulesParams::Param* paramPtr = params.Find(rulesParamName);
+	if (paramPtr == nullptr)
 		return defaultValue;
 
-	const LuaRulesParams::Param& param = it->second;
-	if (!modParamIsVisible(it->second, losMask))
+	const LuaRulesParams::Param& param = *paramPtr;
+	if (!modParamIsVisible(param, losMask))
 		return defaultValue;
 
 	if (!std::holds_alternative <std::string> (param.value))
@@ -3658,6 +3656,71 @@ EXPORT(void) skirmishAiCallback_Unit_getVel(int skirmishAIId, int unitId, float*
 }
 
 
+// resolves the callback and cheat state once for all units, instead of once per unit and field
+template<typename AICallbackType>
+static void GetUnitsState(
+	int skirmishAIId,
+	AICallbackType* clb,
+	bool cheating,
+	const int* unitIds,
+	int numUnits,
+	float* positions,
+	float* velocities,
+	float* healths,
+	float* buildProgresses,
+	int* unitDefIds
+) {
+	const int allyId = teamHandler.AllyTeam(AI_TEAM_IDS[skirmishAIId]);
+
+	for (int i = 0; i < numUnits; i++) {
+		const int unitId = unitIds[i];
+
+		if (positions != nullptr)
+			clb->GetUnitPos(unitId).copyInto(&positions[i * 3]);
+		if (velocities != nullptr)
+			clb->GetUnitVelocity(unitId).copyInto(&velocities[i * 3]);
+		if (healths != nullptr)
+			healths[i] = clb->GetUnitHealth(unitId);
+
+		if (buildProgresses != nullptr) {
+			const CUnit* unit = getUnit(unitId);
+
+			buildProgresses[i] = -1.0f;
+
+			if (unit != nullptr && (cheating || teamHandler.Ally(unit->allyteam, allyId) || unit->losStatus[allyId] & LOS_INLOS))
+				buildProgresses[i] = unit->buildProgress;
+		}
+
+		if (unitDefIds != nullptr) {
+			const UnitDef* unitDef = clb->GetUnitDef(unitId);
+			unitDefIds[i] = (unitDef != nullptr)? unitDef->id: -1;
+		}
+	}
+}
+
+EXPORT(int) skirmishAiCallback_getUnitsState(
+	int skirmishAIId,
+	int* unitIds,
+	int unitIds_size,
+	float* positions,
+	float* velocities,
+	float* healths,
+	float* buildProgresses,
+	int* unitDefIds
+) {
+	if (unitIds == nullptr || unitIds_size <= 0)
+		return 0;
+
+	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
+		GetUnitsState(skirmishAIId, GetCheatCallBack(skirmishAIId), true, unitIds, unitIds_size, positions, velocities, healths, buildProgresses, unitDefIds);
+	} else {
+		GetUnitsState(skirmishAIId, GetCallBack(skirmishAIId), false, unitIds, unitIds_size, positions, velocities, healths, buildProgresses, unitDefIds);
+	}
+
+	return unitIds_size;
+}
+
+
 //EXPORT(int) skirmishAiCallback_Unit_0MULTI1SIZE0ResourceInfo(int skirmishAIId, int unitId) {
 //	return skirmishAiCallback_0MULTI1SIZE0Resource(skirmishAIId);
 //}
@@ -5525,6 +5588,7 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->Unit_Weapon_isShieldEnabled = &skirmishAiCallback_Unit_Weapon_isShieldEnabled;
 	callback->Unit_Weapon_getShieldPower = &skirmishAiCallback_Unit_Weapon_getShieldPower;
 	callback->Debug_GraphDrawer_isEnabled = &skirmishAiCallback_Debug_GraphDrawer_isEnabled;
+	callback->getUnitsState = &skirmishAiCallback_getUnitsState;
 }
 
 SSkirmishAICallback* skirmishAiCallback_GetInstance(CSkirmishAIWrapper* ai)
@@ -17,6 +17,7 @@
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
@@ -32,6 +33,8 @@
 
 #undef DeleteFile
 
+CONFIG(bool, AIDeferEvents).defaultValue(false).description("Queue high-rate Skirmish AI events (damage, weapon fire, LOS and radar changes) and deliver them in batches instead of one at a time as they happen.");
+
 CR_BIND(CSkirmishAIWrapper, )
 CR_REG_METADATA(CSkirmishAIWrapper, (
 	CR_MEMBER(key),
@@ -51,6 +54,8 @@ CR_REG_METADATA(CSkirmishAIWrapper, (
 
 	CR_MEMBER(cheatEvents),
 	CR_MEMBER(blockEvents),
+	CR_IGNORED(deferEvents),
+	CR_IGNORED(deferredEvents),
 
 	CR_SERIALIZER(Serialize),
 	CR_POSTLOAD(PostLoad)
@@ -74,6 +79,9 @@ void CSkirmishAIWrapper::PreInit(int aiID)
 
 		cheatEvents = false;
 		blockEvents = false;
+		deferEvents = configHandler->GetBool("AIDeferEvents");
+
+		deferredEvents.clear();
 	}
 	{
 		const std::string& kn = key.GetShortName();
@@ -163,6 +171,8 @@ void CSkirmishAIWrapper::Kill()
 		skirmishAiCallback_Release(this);
 	}
 	{
+		deferredEvents.clear();
+
 		library = nullptr;
 		callback = nullptr;
 	}
@@ -332,6 +342,9 @@ void CSkirmishAIWrapper::UnitDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
+	if (DeferEvent({EVENT_UNIT_DAMAGED, unitId, attackerUnitId, weaponDefId, damage, dir, paralyzer}))
+		return;
+
 	float3 cpyDir = dir;
 	const SUnitDamagedEvent evtData = {unitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
@@ -365,21 +378,33 @@ void CSkirmishAIWrapper::EnemyFinished(int unitId) {
 }
 
 void CSkirmishAIWrapper::EnemyEnterLOS(int unitId) {
+	if (DeferEvent({EVENT_ENEMY_ENTER_LOS, unitId, -1, -1, 0.0f, ZeroVector, false}))
+		return;
+
 	const SEnemyEnterLOSEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_ENTER_LOS, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveLOS(int unitId) {
+	if (DeferEvent({EVENT_ENEMY_LEAVE_LOS, unitId, -1, -1, 0.0f, ZeroVector, false}))
+		return;
+
 	const SEnemyLeaveLOSEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_LEAVE_LOS, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyEnterRadar(int unitId) {
+	if (DeferEvent({EVENT_ENEMY_ENTER_RADAR, unitId, -1, -1, 0.0f, ZeroVector, false}))
+		return;
+
 	const SEnemyEnterRadarEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_ENTER_RADAR, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveRadar(int unitId) {
+	if (DeferEvent({EVENT_ENEMY_LEAVE_RADAR, unitId, -1, -1, 0.0f, ZeroVector, false}))
+		return;
+
 	const SEnemyLeaveRadarEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_LEAVE_RADAR, &evtData);
 }
@@ -397,6 +422,9 @@ void CSkirmishAIWrapper::EnemyDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
+	if (DeferEvent({EVENT_ENEMY_DAMAGED, enemyUnitId, attackerUnitId, weaponDefId, damage, dir, paralyzer}))
+		return;
+
 	float3 cpyDir = dir;
 	const SEnemyDamagedEvent evtData = {enemyUnitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
@@ -419,6 +447,9 @@ void CSkirmishAIWrapper::SendLuaMessage(const char* inData, const char** outData
 }
 
 void CSkirmishAIWrapper::WeaponFired(int unitId, int weaponDefId) {
+	if (DeferEvent({EVENT_WEAPON_FIRED, unitId, -1, weaponDefId, 0.0f, ZeroVector, false}))
+		return;
+
 	const SWeaponFiredEvent evtData = {unitId, weaponDefId};
 	HandleEvent(EVENT_WEAPON_FIRED, &evtData);
 }
@@ -447,6 +478,9 @@ void CSkirmishAIWrapper::SeismicPing(
 	const float3& pos,
 	float strength
 ) {
+	if (DeferEvent({EVENT_SEISMIC_PING, unitId, -1, -1, strength, pos, false}))
+		return;
+
 	/*const*/ float3 cpyPos = pos;
 	const SSeismicPingEvent evtData = {&cpyPos[0], strength};
 
@@ -454,7 +488,79 @@ void CSkirmishAIWrapper::SeismicPing(
 }
 
 
-int CSkirmishAIWrapper::HandleEvent(int topic, const void* data) const {
+bool CSkirmishAIWrapper::DeferEvent(const DeferredEvent& event) {
+	if (!deferEvents)
+		return false;
+
+	if (!blockEvents)
+		deferredEvents.push_back(event);
+	return true;
+}
+
+void CSkirmishAIWrapper::FlushDeferredEvents() {
+	if (deferredEvents.empty())
+		return;
+
+	ScopedTimer timer(GetTimerNameHash());
+
+	// swapped out first, the AI may raise new events while handling these
+	std::vector<DeferredEvent> events;
+	events.swap(deferredEvents);
+
+	for (DeferredEvent& e: events) {
+		if (blockEvents)
+			break;
+
+		switch (e.topic) {
+			case EVENT_UNIT_DAMAGED: {
+				const SUnitDamagedEvent evtData = {e.unitId, e.attackerId, e.value, &e.vec[0], e.weaponDefId, e.paralyzer};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			case EVENT_ENEMY_DAMAGED: {
+				const SEnemyDamagedEvent evtData = {e.unitId, e.attackerId, e.value, &e.vec[0], e.weaponDefId, e.paralyzer};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			case EVENT_ENEMY_ENTER_LOS: {
+				const SEnemyEnterLOSEvent evtData = {e.unitId};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			case EVENT_ENEMY_LEAVE_LOS: {
+				const SEnemyLeaveLOSEvent evtData = {e.unitId};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			case EVENT_ENEMY_ENTER_RADAR: {
+				const SEnemyEnterRadarEvent evtData = {e.unitId};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			case EVENT_ENEMY_LEAVE_RADAR: {
+				const SEnemyLeaveRadarEvent evtData = {e.unitId};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			case EVENT_WEAPON_FIRED: {
+				const SWeaponFiredEvent evtData = {e.unitId, e.weaponDefId};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			case EVENT_SEISMIC_PING: {
+				const SSeismicPingEvent evtData = {&e.vec[0], e.value};
+				library->HandleEvent(skirmishAIId, e.topic, &evtData);
+			} break;
+			default: {
+				assert(false);
+			} break;
+		}
+	}
+
+	// keep the capacity around unless a nested flush already refilled the queue
+	if (deferredEvents.empty()) {
+		events.clear();
+		events.swap(deferredEvents);
+	}
+}
+
+int CSkirmishAIWrapper::HandleEvent(int topic, const void* data) {
+	// anything not deferrable has to see the queued events first
+	FlushDeferredEvents();
+
 	ScopedTimer timer(GetTimerNameHash());
 
 	if (!blockEvents || (topic == EVENT_RELEASE))
@@ -4,12 +4,14 @@
 #define SKIRMISH_AI_WRAPPER_H
 
 #include "SkirmishAIKey.h"
+#include "System/float3.h"
+
+#include <vector>
 
 class CSkirmishAILibrary;
 struct SSkirmishAICallback;
 
 struct Command;
-class float3;
 
 
 /**
@@ -100,6 +102,26 @@ public:
 	bool IsLoadSupported() const;
 
 private:
+	/**
+	 * High-rate events that carry nothing but plain values (damage, weapon
+	 * fire, sensor changes) and are safe to hand over a little later; with
+	 * deferral enabled they are queued and delivered as one batch, either at
+	 * the next Update or right before any other event so ordering is kept.
+	 */
+	struct DeferredEvent {
+		int topic;
+		int unitId;
+		int attackerId;
+		int weaponDefId;
+		float value;
+		float3 vec;
+		bool paralyzer;
+	};
+
+	bool DeferEvent(const DeferredEvent& event);
+	/// delivers all events held back since the last flush, in the order they were raised
+	void FlushDeferredEvents();
+
 	bool InitLibrary();
 	void CreateCallback();
 
@@ -109,7 +131,7 @@ private:
 	/**
 	 * CAUTION: takes C AI Interface events, not engine C++ ones!
 	 */
-	int HandleEvent(int topic, const void* data) const;
+	int HandleEvent(int topic, const void* data);
 
 	uint32_t GetTimerNameHash() const { return *reinterpret_cast<const uint32_t*>(&timerName[0]); }
 
@@ -134,6 +156,9 @@ private:
 	bool libraryInit = false; // CSkirmishAILibrary::Init retval
 	bool cheatEvents = false;
 	bool blockEvents = false;
+	bool deferEvents = false;
+
+	std::vector<DeferredEvent> deferredEvents;
 };
 
 #endif // SKIRMISH_AI_WRAPPER_H
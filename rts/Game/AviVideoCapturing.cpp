@@ -25,6 +25,14 @@ void AviVideoCapturing::StopCapturing()
 	if (!IsCapturing())
 		return;
 
+	// the last few frames are still in flight
+	while (frameReadback.NumPending() > 0) {
+		if (!SubmitOldestFrame(true))
+			break;
+	}
+
+	frameReadback.Kill();
+
 	capturing = false;
 	allowRecord = false;
 
@@ -74,6 +82,7 @@ void AviVideoCapturing::StartCapturing()
 		LOG_L(L_ERROR, "%s", aviGenerator->GetLastErrorMessage().c_str());
 		spring::SafeDelete(aviGenerator);
 	} else {
+		frameReadback.Init(3);
 		LOG("Recording avi to %s size %i x %i", fileName.c_str(), videoSizeX, videoSizeY);
 	}
 
@@ -84,13 +93,39 @@ void AviVideoCapturing::StartCapturing()
 }
 
 
+bool AviVideoCapturing::SubmitOldestFrame(bool wait)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const uint8_t* pixels = frameReadback.MapOldest(wait);
+
+	// not done yet; a failed map drops the frame
+	if (pixels == nullptr)
+		return true;
+
+	const bool ret = aviGenerator->readOpenglPixelDataThreaded(pixels);
+
+	frameReadback.UnmapOldest();
+	return ret;
+}
+
 void AviVideoCapturing::RenderFrame()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (!IsCapturing())
 		return;
 
-	if (aviGenerator->readOpenglPixelDataThreaded())
+	// only waits when the GPU is more frames behind than there are buffers
+	if (frameReadback.IsFull() && !SubmitOldestFrame(true)) {
+		StopCapturing();
+		return;
+	}
+
+	const int videoSizeX = aviGenerator->GetVideoSizeX();
+	const int videoSizeY = aviGenerator->GetVideoSizeY();
+
+	frameReadback.Read(0, 0, videoSizeX, videoSizeY, GL_BGR_EXT, GL_UNSIGNED_BYTE, videoSizeX * videoSizeY * 3);
+
+	if (SubmitOldestFrame(false))
 		return;
 
 	StopCapturing();
@@ -6,6 +6,7 @@
 #if       defined AVI_CAPTURING
 
 #include "IVideoCapturing.h"
+#include "Rendering/GL/PixelReadback.h"
 
 class CAVIGenerator;
 
@@ -21,8 +22,14 @@ public:
 
 	void RenderFrame() override;
 
+private:
+	bool SubmitOldestFrame(bool wait);
+
 private:
 	CAVIGenerator* aviGenerator = nullptr;
+
+	// frames reach the encoder a few frames after they were drawn
+	PixelReadback frameReadback;
 };
 
 #endif // defined AVI_CAPTURING
@@ -232,6 +232,7 @@ public:
 	*/
 
 	uint32_t GetCamType() const { return camType; }
+	uint8_t GetInViewPlanesMask() const { return inViewPlanesMask; }
 	uint32_t GetProjType() const { return projType; }
 	void SetCamType(uint32_t ct);
 	void SetProjType(uint32_t pt) { projType = pt; }
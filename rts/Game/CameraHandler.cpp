@@ -25,6 +25,7 @@
 #include "System/SafeUtil.h"
 #include "System/StringHash.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/Config/ConfigVar.h"
 #include "System/Log/ILog.h"
 #include "System/Math/SpringDampers.h"
 #include "System/Math/expDecay.h"
@@ -401,7 +402,9 @@ void UpdateTransitionExpDecay(const CCameraController* currCam, CCameraHandler::
 	camTransState.tweenRot = currCam->GetRot();
 	camTransState.tweenFOV = currCam->GetFOV();
 
-	int vsync = configHandler->GetInt("VSync");
+	static ConfigVar<int> vsyncVar("VSync");
+
+	int vsync = vsyncVar.Get();
 	float transTime = globalRendering->lastFrameStart.toMilliSecsf();
 	float lastswaptime = globalRendering->lastSwapBuffersEnd.toMilliSecsf();
 	float drawFPS = std::fmax(globalRendering->FPS, 1.0f); // this is probably much better
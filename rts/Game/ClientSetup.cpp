@@ -21,6 +21,8 @@ CONFIG(int, HostPortDefault).defaultValue(8452).minimumValue(0).maximumValue(655
 ClientSetup::ClientSetup()
 	: hostIP(configHandler->GetString("HostIPDefault"))
 	, hostPort(configHandler->GetInt("HostPortDefault"))
+	, autohostIP(configHandler->GetString("AutohostIP"))
+	, autohostPort(configHandler->GetInt("AutohostPort"))
 	, isHost(false)
 {
 }
@@ -69,11 +71,15 @@ void ClientSetup::LoadFromStartScript(const std::string& setup)
 	if (file.SGetValue(sourceport, "GAME\\SourcePort"))
 		configHandler->SetString("SourcePort", sourceport, true);
 
-	if (file.SGetValue(autohostip, "GAME\\AutohostIP"))
+	if (file.SGetValue(autohostip, "GAME\\AutohostIP")) {
 		configHandler->SetString("AutohostIP", autohostip, true);
+		autohostIP = autohostip;
+	}
 
-	if (file.SGetValue(autohostport, "GAME\\AutohostPort"))
+	if (file.SGetValue(autohostport, "GAME\\AutohostPort")) {
 		configHandler->SetString("AutohostPort", autohostport, true);
+		autohostPort = StringToInt(autohostport);
+	}
 
 	file.GetDef(saveFile, "", "GAME\\SaveFile");
 	file.GetDef(demoFile, "", "GAME\\DemoFile");
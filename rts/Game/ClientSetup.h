@@ -27,6 +27,11 @@ public:
 	//! if this client is the server player, the port over which we accept incoming connections
 	int hostPort;
 
+	//! where the server reports game events to, autohost disabled if the port is 0
+	//! kept here rather than only in the config, which all games in a process share
+	std::string autohostIP;
+	int autohostPort;
+
 	bool isHost;
 
 	std::string showServerName;
@@ -0,0 +1,324 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef FORMATION_UNIT_GRID_H
+#define FORMATION_UNIT_GRID_H
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "System/float3.h"
+#include "System/UnorderedMap.hpp"
+
+/**
+ * Picks the closest not yet assigned unit of a given type for each formation
+ * slot, as CSelectedUnitsHandlerAI::MakeFormationFrontOrder did by scanning
+ * every unassigned unit per slot. Units of each type are bucketed into a
+ * uniform grid searched in rings around the slot, s.t. only the cells up to
+ * the closest unit are visited.
+ *
+ * The picks are identical to the linear scan over a vector that is
+ * swap-and-popped after every pick (ties go to the lower position in that
+ * vector): the order runs in synced code, every client has to agree.
+ */
+class CFormationUnitGrid {
+public:
+	struct UnitReference {
+		UnitReference(int _unitId, int _unitDefId, const float3& _pos)
+			: unitId(_unitId)
+			, unitDefId(_unitDefId)
+			, pos(_pos)
+		{}
+
+		UnitReference() {};
+
+		int unitId = -1;
+		int unitDefId = -1;
+		float3 pos;
+	};
+
+public:
+	void Init(const std::vector<UnitReference>& unitRefs) {
+		units.assign(unitRefs.begin(), unitRefs.end());
+		slots.resize(units.size());
+		slotUnits.resize(units.size());
+
+		for (uint32_t i = 0, n = units.size(); i < n; i++) {
+			slots[i] = i;
+			slotUnits[i] = i;
+		}
+
+		numSlots = units.size();
+
+		defGrids.clear();
+		defGridIndices.clear();
+
+		std::vector<std::vector<uint32_t>> defUnits;
+
+		for (uint32_t i = 0, n = units.size(); i < n; i++) {
+			const auto it = defGridIndices.find(units[i].unitDefId);
+
+			if (it == defGridIndices.end()) {
+				defGridIndices.emplace(units[i].unitDefId, defUnits.size());
+				defUnits.emplace_back(1, i);
+				continue;
+			}
+
+			defUnits[it->second].push_back(i);
+		}
+
+		defGrids.resize(defUnits.size());
+
+		for (size_t i = 0; i < defUnits.size(); i++) {
+			Build(defGrids[i], defUnits[i]);
+		}
+	}
+
+	/// removes and returns the id of the closest remaining unit of type unitDefId to pos
+	int PopClosest(int unitDefId, const float3& pos) {
+		assert(numSlots > 0);
+
+		uint32_t unitIndex = NO_UNIT;
+
+		const auto it = defGridIndices.find(unitDefId);
+
+		if (it != defGridIndices.end() && defGrids[it->second].numLeft > 0)
+			unitIndex = RemoveClosest(defGrids[it->second], pos);
+
+		// like the linear scan, take the front unit if none of this type is left
+		if (unitIndex == NO_UNIT) {
+			unitIndex = slotUnits[0];
+			Remove(defGrids[defGridIndices.find(units[unitIndex].unitDefId)->second], unitIndex);
+		}
+
+		const uint32_t slot = slots[unitIndex];
+		const uint32_t movedIndex = slotUnits[numSlots - 1];
+
+		slotUnits[slot] = movedIndex;
+		slots[movedIndex] = slot;
+		slots[unitIndex] = NO_UNIT;
+		numSlots--;
+
+		return units[unitIndex].unitId;
+	}
+
+private:
+	struct CellEntry {
+		float3 pos;
+		uint32_t unitIndex;
+	};
+
+	struct DefGrid {
+		/// per-cell offsets into entries, the first cellCounts[c] of cell c are unassigned
+		std::vector<uint32_t> cellOffsets;
+		std::vector<uint32_t> cellCounts;
+		std::vector<CellEntry> entries;
+
+		float originX = 0.0f;
+		float originZ = 0.0f;
+		float cellSize = 1.0f;
+
+		int sizeX = 1;
+		int sizeZ = 1;
+
+		uint32_t numBuilt = 0;
+		uint32_t numLeft = 0;
+	};
+
+	static constexpr uint32_t NO_UNIT = std::numeric_limits<uint32_t>::max();
+
+	void Build(DefGrid& grid, const std::vector<uint32_t>& unitIndices) {
+		float minX = std::numeric_limits<float>::max(), maxX = std::numeric_limits<float>::lowest();
+		float minZ = std::numeric_limits<float>::max(), maxZ = std::numeric_limits<float>::lowest();
+
+		for (const uint32_t i: unitIndices) {
+			minX = std::min(minX, units[i].pos.x); maxX = std::max(maxX, units[i].pos.x);
+			minZ = std::min(minZ, units[i].pos.z); maxZ = std::max(maxZ, units[i].pos.z);
+		}
+
+		const uint32_t n = unitIndices.size();
+
+		// aim for several units per cell; the cell size only affects the search cost, not the picks
+		const float area = std::max((maxX - minX) * (maxZ - minZ), 1.0f);
+		const float extent = std::max(maxX - minX, maxZ - minZ);
+		const float cellSize = std::max({std::sqrt(area * UNITS_PER_CELL / std::max(n, 1u)), extent / (MAX_GRID_SIZE - 1), MIN_CELL_SIZE});
+
+		grid.originX = minX;
+		grid.originZ = minZ;
+		grid.cellSize = cellSize;
+		grid.sizeX = std::clamp(static_cast<int>((maxX - minX) / cellSize) + 1, 1, MAX_GRID_SIZE);
+		grid.sizeZ = std::clamp(static_cast<int>((maxZ - minZ) / cellSize) + 1, 1, MAX_GRID_SIZE);
+		grid.numBuilt = n;
+		grid.numLeft = n;
+
+		const uint32_t numCells = grid.sizeX * grid.sizeZ;
+
+		grid.cellOffsets.clear();
+		grid.cellOffsets.resize(numCells + 1, 0);
+		grid.cellCounts.clear();
+		grid.cellCounts.resize(numCells, 0);
+		grid.entries.resize(n);
+
+		for (const uint32_t i: unitIndices) {
+			grid.cellCounts[GetCell(grid, units[i].pos)]++;
+		}
+		for (uint32_t c = 0; c < numCells; c++) {
+			grid.cellOffsets[c + 1] = grid.cellOffsets[c] + grid.cellCounts[c];
+			grid.cellCounts[c] = 0;
+		}
+		for (const uint32_t i: unitIndices) {
+			const uint32_t cell = GetCell(grid, units[i].pos);
+			grid.entries[grid.cellOffsets[cell] + grid.cellCounts[cell]++] = {units[i].pos, i};
+		}
+	}
+
+	// shrinks the grid to the unassigned units, keeps the rings from crawling over emptied cells
+	void Rebuild(DefGrid& grid) {
+		std::vector<uint32_t> unitIndices;
+		unitIndices.reserve(grid.numLeft);
+
+		for (size_t c = 0, n = grid.cellCounts.size(); c < n; c++) {
+			for (uint32_t k = grid.cellOffsets[c], e = k + grid.cellCounts[c]; k < e; k++) {
+				unitIndices.push_back(grid.entries[k].unitIndex);
+			}
+		}
+
+		Build(grid, unitIndices);
+	}
+
+	static int GetCellX(const DefGrid& grid, float x) { return std::clamp(static_cast<int>((x - grid.originX) / grid.cellSize), 0, grid.sizeX - 1); }
+	static int GetCellZ(const DefGrid& grid, float z) { return std::clamp(static_cast<int>((z - grid.originZ) / grid.cellSize), 0, grid.sizeZ - 1); }
+	static uint32_t GetCell(const DefGrid& grid, const float3& pos) { return (GetCellZ(grid, pos.z) * grid.sizeX + GetCellX(grid, pos.x)); }
+
+	// squared xz-distance from pos to cells [x0,x1]x[z0,z1]; the border cells also hold clamped units, so are open-ended
+	static float CellRangeSqDist(const DefGrid& grid, const float3& pos, int x0, int x1, int z0, int z1) {
+		constexpr float inf = std::numeric_limits<float>::infinity();
+
+		const float minX = (x0 == 0)? -inf: grid.originX + x0 * grid.cellSize;
+		const float maxX = (x1 == grid.sizeX - 1)? inf: grid.originX + (x1 + 1) * grid.cellSize;
+		const float minZ = (z0 == 0)? -inf: grid.originZ + z0 * grid.cellSize;
+		const float maxZ = (z1 == grid.sizeZ - 1)? inf: grid.originZ + (z1 + 1) * grid.cellSize;
+
+		const float dx = std::max({minX - pos.x, 0.0f, pos.x - maxX});
+		const float dz = std::max({minZ - pos.z, 0.0f, pos.z - maxZ});
+		return (dx * dx + dz * dz);
+	}
+
+	static void RemoveEntry(DefGrid& grid, uint32_t cell, uint32_t k) {
+		grid.entries[k] = grid.entries[grid.cellOffsets[cell] + (--grid.cellCounts[cell])];
+		grid.numLeft--;
+	}
+
+	void Remove(DefGrid& grid, uint32_t unitIndex) {
+		const uint32_t cell = GetCell(grid, units[unitIndex].pos);
+
+		for (uint32_t k = grid.cellOffsets[cell], e = k + grid.cellCounts[cell]; k < e; k++) {
+			if (grid.entries[k].unitIndex != unitIndex)
+				continue;
+
+			RemoveEntry(grid, cell, k);
+			return;
+		}
+
+		assert(false);
+	}
+
+	uint32_t RemoveClosest(DefGrid& grid, const float3& pos) {
+		if (grid.numBuilt > MIN_REBUILD_SIZE && grid.numLeft * 2 < grid.numBuilt)
+			Rebuild(grid);
+
+		uint32_t bestCell = 0;
+		uint32_t bestEntry = 0;
+		uint32_t bestIndex = NO_UNIT;
+		float bestDistSq = std::numeric_limits<float>::infinity();
+
+		const auto ScanCell = [&](uint32_t cell) {
+			for (uint32_t k = grid.cellOffsets[cell], e = k + grid.cellCounts[cell]; k < e; k++) {
+				const CellEntry& entry = grid.entries[k];
+
+				// same expression as the linear scan, s.t. ties compare equal
+				const float distSq = entry.pos.SqDistance(pos);
+
+				if (distSq > bestDistSq)
+					continue;
+				if (distSq == bestDistSq && bestIndex != NO_UNIT && slots[entry.unitIndex] > slots[bestIndex])
+					continue;
+
+				bestDistSq = distSq;
+				bestIndex = entry.unitIndex;
+				bestCell = cell;
+				bestEntry = k;
+			}
+		};
+
+		const int cx = GetCellX(grid, pos.x);
+		const int cz = GetCellZ(grid, pos.z);
+
+		for (int r = 0; ; r++) {
+			const int x0 = cx - r, x1 = cx + r;
+			const int z0 = cz - r, z1 = cz + r;
+
+			const int bx0 = std::max(x0, 0), bx1 = std::min(x1, grid.sizeX - 1);
+			const int bz0 = std::max(z0, 0), bz1 = std::min(z1, grid.sizeZ - 1);
+
+			for (int z = bz0; z <= bz1; z++) {
+				if (z == z0 || z == z1) {
+					for (int x = bx0; x <= bx1; x++) {
+						ScanCell(z * grid.sizeX + x);
+					}
+				} else {
+					if (x0 >= 0)
+						ScanCell(z * grid.sizeX + x0);
+					if (x1 < grid.sizeX)
+						ScanCell(z * grid.sizeX + x1);
+				}
+			}
+
+			// distance from pos to the nearest unscanned cell (the strips around the scanned
+			// block), shrunk by an elmo to absorb rounding in GetCell; the y-term only adds
+			float boundSq = std::numeric_limits<float>::infinity();
+
+			if (bx0 > 0)
+				boundSq = std::min(boundSq, CellRangeSqDist(grid, pos, 0, bx0 - 1, 0, grid.sizeZ - 1));
+			if (bx1 < grid.sizeX - 1)
+				boundSq = std::min(boundSq, CellRangeSqDist(grid, pos, bx1 + 1, grid.sizeX - 1, 0, grid.sizeZ - 1));
+			if (bz0 > 0)
+				boundSq = std::min(boundSq, CellRangeSqDist(grid, pos, bx0, bx1, 0, bz0 - 1));
+			if (bz1 < grid.sizeZ - 1)
+				boundSq = std::min(boundSq, CellRangeSqDist(grid, pos, bx0, bx1, bz1 + 1, grid.sizeZ - 1));
+
+			if (boundSq == std::numeric_limits<float>::infinity())
+				break;
+
+			const float bound = std::sqrt(boundSq) - 1.0f;
+
+			if (bestIndex != NO_UNIT && bound > 0.0f && (bound * bound * 0.999f) > bestDistSq)
+				break;
+		}
+
+		if (bestIndex != NO_UNIT)
+			RemoveEntry(grid, bestCell, bestEntry);
+
+		return bestIndex;
+	}
+
+private:
+	static constexpr float UNITS_PER_CELL = 8.0f;
+	static constexpr float MIN_CELL_SIZE = 16.0f;
+	static constexpr int MAX_GRID_SIZE = 256;
+	static constexpr uint32_t MIN_REBUILD_SIZE = 32;
+
+	std::vector<UnitReference> units;
+	/// unit index -> position in the emulated swap-and-pop vector, NO_UNIT once assigned
+	std::vector<uint32_t> slots;
+	std::vector<uint32_t> slotUnits;
+	uint32_t numSlots = 0;
+
+	std::vector<DefGrid> defGrids;
+	spring::unsynced_map<int, uint32_t> defGridIndices;
+};
+
+#endif // FORMATION_UNIT_GRID_H
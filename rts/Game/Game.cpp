@@ -12,6 +12,7 @@
 #include "ConsoleHistory.h"
 #include "GameHelper.h"
 #include "GameSetup.h"
+#include "GameVersion.h"
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
 #include "SelectedUnitsHandler.h"
@@ -24,6 +25,7 @@
 #include "SyncedGameCommands.h"
 #include "UnsyncedActionExecutor.h"
 #include "UnsyncedGameCommands.h"
+#include "UnitStateExporter.h"
 #include "Game/Players/Player.h"
 #include "Game/Players/PlayerHandler.h"
 #include "Game/UI/PlayerRoster.h"
@@ -41,15 +43,18 @@
 #include "Rendering/CommandDrawer.h"
 #include "Rendering/LineDrawer.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/GPUTimer.h"
 #include "Rendering/DebugDrawerAI.h"
 #include "Rendering/HUDDrawer.h"
 #include "Rendering/IconHandler.h"
 #include "Rendering/ModelsDataUploader.h"
+#include "Rendering/Screenshot.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/TeamHighlight.h"
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/UniformConstants.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
+#include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Textures/NamedTextures.h"
 #include "Lua/LuaGaia.h"
 #include "Lua/LuaHandle.h"
@@ -112,6 +117,7 @@
 #include "UI/ProfileDrawer.h"
 #include "UI/Groups/GroupHandler.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/Config/ConfigVar.h"
 #include "System/creg/SerializeLuaState.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
@@ -119,6 +125,9 @@
 #include "System/SafeUtil.h"
 #include "System/SpringExitCode.h"
 #include "System/SpringMath.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/LoadSave/LoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
@@ -129,9 +138,11 @@
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/TimeProfiler.h"
 #include "System/LoadLock.h"
 
+#include "System/Misc/StartupTrace.h"
 #include "System/Misc/TracyDefs.h"
 
 #include "fmt/ranges.h"
@@ -149,6 +160,9 @@ CONFIG(int, ShowPlayerInfo).defaultValue(1).headlessValue(0);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
 
+CONFIG(bool, LoadingParallelTasks).defaultValue(true).safemodeValue(false).description("Runs independent loading stages (sound definitions) on worker threads while the gamedata definitions are parsed.");
+CONFIG(bool, LuaDefsCache).defaultValue(true).description("Caches the gamedata definition tables between launches of the same game, map and options when the defs scripts allow it.");
+CONFIG(float, LuaGarbageCollectionFrameBudget).defaultValue(2.0f).minimumValue(0.1f).description("Maximum number of milliseconds Lua garbage collection may take after each draw frame, when enabled by /LuaGCControl 2.");
 CONFIG(int, SmoothTimeOffset).defaultValue(0).headlessValue(0).description("Enables frametimeoffset smoothing, 0 = off (old version), -1 = forced 0.5,  1-20 smooth, recommended = 2-3");
 
 CGame* game = nullptr;
@@ -197,6 +211,7 @@ CR_REG_METADATA(CGame, (
 
 	CR_IGNORED(msgProcTimeLeft),
 	CR_IGNORED(consumeSpeedMult),
+	CR_IGNORED(snapshotRequestFrame),
 
 /*
 	CR_IGNORED(skipStartFrame),
@@ -215,6 +230,7 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(worldDrawer),
 	CR_IGNORED(saveFileHandler),
 	CR_IGNORED(gameInputReceiver),
+	CR_IGNORED(soundDefsTask),
 
 	// Post Load
 	CR_POSTLOAD(PostLoad)
@@ -320,7 +336,7 @@ void CGame::AddTimedJobs()
 
 			// SimFrame handles gc when not paused, this all other cases
 			// do not check the global synced state, never true in demos
-			if (luaGCControl == 1 || simFrameDeltaTime > gcForcedDeltaTime)
+			if (luaGCControl == 1 || (luaGCControl == 0 && simFrameDeltaTime > gcForcedDeltaTime))
 				eventHandler.CollectGarbage(false);
 
 			CInputReceiver::CollectGarbage();
@@ -350,6 +366,52 @@ void CGame::AddTimedJobs()
 	}
 }
 
+namespace {
+	// reports the duration of a loading stage to the loadscreen
+	struct ScopedLoadTiming {
+		ScopedLoadTiming(const char* _name, bool _async = false)
+			: name(_name)
+			, async(_async)
+			, startTime(spring_gettime())
+		{}
+		~ScopedLoadTiming() {
+			if (loadscreen != nullptr)
+				loadscreen->AddLoadTiming(name, startTime, spring_gettime() - startTime, async);
+		}
+
+		const char* name;
+		const bool async;
+		const spring_time startTime;
+	};
+
+	// runs a loading stage that neither touches GL nor the loadscreen on a worker thread
+	template<typename F>
+	std::shared_future<void> StartLoadTask(const char* name, F&& f)
+	{
+		if (!configHandler->GetBool("LoadingParallelTasks"))
+			return {};
+
+		return ThreadPool::Enqueue([name, f = std::forward<F>(f)]() {
+			ScopedLoadTiming loadTiming(name, true);
+			f();
+		});
+	}
+
+	// returns false if the task was never started, rethrows its content_error otherwise
+	bool FinishLoadTask(std::shared_future<void>& task)
+	{
+		if (!task.valid())
+			return false;
+
+		const std::shared_future<void> f = std::move(task);
+
+		f.get();
+		Watchdog::ClearTimer(WDT_LOAD);
+		return true;
+	}
+}
+
+
 void CGame::Load(const std::string& mapFileName)
 {
 	// NOTE:
@@ -360,6 +422,7 @@ void CGame::Load(const std::string& mapFileName)
 	Watchdog::RegisterThread(WDT_LOAD);
 
 	ZoneScoped;
+	SCOPED_STARTUP_TRACE("CGame::Load", "load")
 
 	std::vector<std::string> contentErrors;
 
@@ -534,6 +597,7 @@ void CGame::Load(const std::string& mapFileName)
 
 void CGame::LoadMap(const std::string& mapFileName)
 {
+	ScopedLoadTiming loadTiming(__func__);
 	ENTER_SYNCED_CODE();
 
 	{
@@ -552,7 +616,7 @@ void CGame::LoadMap(const std::string& mapFileName)
 		static_assert(BUILD_GRID_RESOLUTION == 2);
 		buildingMaskMap.Init(mapDims.hmapx * mapDims.hmapy);
 
-		groundBlockingObjectMap.Init(mapDims.mapSquares);
+		groundBlockingObjectMap.Init(mapDims.mapSquares, mapDims.mapx);
 		yardmapStatusEffectsMap.InitNewYardmapStatusEffectsMap();
 	}
 
@@ -562,8 +626,21 @@ void CGame::LoadMap(const std::string& mapFileName)
 
 void CGame::LoadDefs(LuaParser* defsParser)
 {
+	ScopedLoadTiming loadTiming(__func__);
 	ENTER_SYNCED_CODE();
 
+	// sound definitions are unrelated to the gamedata ones, parse both at once
+	// WeaponDefs need the sound IDs, the task is finished in PostLoadSimulation
+	soundDefsTask = StartLoadTask("Game::LoadDefs (Sound)", []() {
+		LuaParser soundDefsParser("gamedata/sounds.lua", SPRING_VFS_MOD_BASE, SPRING_VFS_MOD_BASE);
+		soundDefsParser.GetTable("Spring");
+		soundDefsParser.AddFunc("GetModOptions", LuaSyncedRead::GetModOptions);
+		soundDefsParser.AddFunc("GetMapOptions", LuaSyncedRead::GetMapOptions);
+		soundDefsParser.EndTable();
+
+		sound->LoadSoundDefs(&soundDefsParser);
+	});
+
 	{
 		SCOPED_ONCE_TIMER("Game::LoadDefs (GameData)");
 		loadscreen->SetLoadMessage("Loading GameData Definitions");
@@ -571,30 +648,61 @@ void CGame::LoadDefs(LuaParser* defsParser)
 		defsParser->SetupLua(true, true);
 		// customize the defs environment; LuaParser has no access to LuaSyncedRead
 		#define LSR_ADDFUNC(f) defsParser->AddFunc(#f, LuaSyncedRead::f)
+		// the team and player layout is not part of the cache key
+		#define LSR_ADDFUNC_UNCACHEABLE(f) defsParser->AddUncacheableFunc(#f, LuaSyncedRead::f)
 		defsParser->GetTable("Spring");
 
 		LSR_ADDFUNC(GetModOptions);
 		LSR_ADDFUNC(GetModOption);
 		LSR_ADDFUNC(GetMapOptions);
 		LSR_ADDFUNC(GetMapOption);
-		LSR_ADDFUNC(GetTeamLuaAI);
-		LSR_ADDFUNC(GetTeamList);
-		LSR_ADDFUNC(GetGaiaTeamID);
-		LSR_ADDFUNC(GetPlayerList);
-		LSR_ADDFUNC(GetAllyTeamList);
-		LSR_ADDFUNC(GetTeamInfo);
-		LSR_ADDFUNC(GetAllyTeamInfo);
-		LSR_ADDFUNC(GetAIInfo);
-		LSR_ADDFUNC(GetTeamAllyTeamID);
-		LSR_ADDFUNC(AreTeamsAllied);
-		LSR_ADDFUNC(ArePlayersAllied);
+		LSR_ADDFUNC_UNCACHEABLE(GetTeamLuaAI);
+		LSR_ADDFUNC_UNCACHEABLE(GetTeamList);
+		LSR_ADDFUNC_UNCACHEABLE(GetGaiaTeamID);
+		LSR_ADDFUNC_UNCACHEABLE(GetPlayerList);
+		LSR_ADDFUNC_UNCACHEABLE(GetAllyTeamList);
+		LSR_ADDFUNC_UNCACHEABLE(GetTeamInfo);
+		LSR_ADDFUNC_UNCACHEABLE(GetAllyTeamInfo);
+		LSR_ADDFUNC_UNCACHEABLE(GetAIInfo);
+		LSR_ADDFUNC_UNCACHEABLE(GetTeamAllyTeamID);
+		LSR_ADDFUNC_UNCACHEABLE(AreTeamsAllied);
+		LSR_ADDFUNC_UNCACHEABLE(ArePlayersAllied);
 		LSR_ADDFUNC(GetSideData);
 
 		defsParser->EndTable();
+		#undef LSR_ADDFUNC_UNCACHEABLE
 		#undef LSR_ADDFUNC
 
+		std::string cacheFile;
+		std::string cacheKey;
+
+		{
+			// everything the defs environment exposes besides team and player data
+			sha512::hex_digest mapHexDigest;
+			sha512::hex_digest modHexDigest;
+			sha512::dump_digest(archiveScanner->GetArchiveCompleteChecksumBytes(gameSetup->mapName), mapHexDigest);
+			sha512::dump_digest(archiveScanner->GetArchiveCompleteChecksumBytes(gameSetup->modName), modHexDigest);
+
+			std::vector<std::pair<std::string, std::string>> modOpts = {gameSetup->GetModOptionsCont().begin(), gameSetup->GetModOptionsCont().end()};
+			std::vector<std::pair<std::string, std::string>> mapOpts = {gameSetup->GetMapOptionsCont().begin(), gameSetup->GetMapOptionsCont().end()};
+
+			std::sort(modOpts.begin(), modOpts.end());
+			std::sort(mapOpts.begin(), mapOpts.end());
+
+			cacheKey = fmt::format("{}\n{}\n{}\n{}\n{}\n{} {} {}\n", SpringVersion::GetFull(), SpringVersion::GetAdditional(), modHexDigest.data(), mapHexDigest.data(), gameSetup->startPosType, gameSetup->ghostedBuildings, gameSetup->hostDemo, gameSetup->demoName);
+
+			for (const auto& [key, value]: modOpts)
+				cacheKey += fmt::format("modopt {}={}\n", key, value);
+			for (const auto& [key, value]: mapOpts)
+				cacheKey += fmt::format("mapopt {}={}\n", key, value);
+
+			// one file per game and map, the key inside tells stale ones apart
+			if (configHandler->GetBool("LuaDefsCache"))
+				cacheFile = dataDirsAccess.LocateFile(fmt::format("cache/defs/{:.16}{:.16}.bin", modHexDigest.data(), mapHexDigest.data()), FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+		}
+
 		// run the parser
-		if (!defsParser->Execute())
+		if (!defsParser->ExecuteCached(cacheFile, cacheKey))
 			throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
 
 		const LuaTable& root = defsParser->GetRoot();
@@ -626,7 +734,7 @@ void CGame::LoadDefs(LuaParser* defsParser)
 		auto lock = CLoadLock::GetUniqueLock();
 		icon::iconHandler.Init();
 	}
-	{
+	if (!soundDefsTask.valid()) {
 		SCOPED_ONCE_TIMER("Game::LoadDefs (Sound)");
 		loadscreen->SetLoadMessage("Loading Sound Definitions");
 
@@ -647,6 +755,7 @@ void CGame::LoadDefs(LuaParser* defsParser)
 void CGame::PreLoadSimulation(LuaParser* defsParser)
 {
 	ZoneScoped;
+	ScopedLoadTiming loadTiming(__func__);
 	ENTER_SYNCED_CODE();
 
 	loadscreen->SetLoadMessage("Creating Smooth Height Mesh");
@@ -662,6 +771,11 @@ void CGame::PreLoadSimulation(LuaParser* defsParser)
 void CGame::PostLoadSimulation(LuaParser* defsParser)
 {
 	ZoneScoped;
+	ScopedLoadTiming loadTiming(__func__);
+
+	if (FinishLoadTask(soundDefsTask))
+		chatSound = sound->GetDefSoundId("IncomingChat");
+
 	CommonDefHandler::InitStatic();
 
 	{
@@ -731,6 +845,8 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 	inMapDrawerModel = new CInMapDrawModel();
 	inMapDrawer = new CInMapDraw();
 
+	unitStateExporter.Init();
+
 	LEAVE_SYNCED_CODE();
 }
 
@@ -738,6 +854,7 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 void CGame::PreLoadRendering()
 {
 	ZoneScoped;
+	ScopedLoadTiming loadTiming(__func__);
 	auto lock = CLoadLock::GetUniqueLock();
 
 	geometricObjects = new CGeometricObjects();
@@ -753,6 +870,7 @@ void CGame::PreLoadRendering()
 
 void CGame::PostLoadRendering() {
 	ZoneScoped;
+	ScopedLoadTiming loadTiming(__func__);
 	worldDrawer.InitPost();
 }
 
@@ -760,6 +878,7 @@ void CGame::PostLoadRendering() {
 void CGame::LoadInterface()
 {
 	ZoneScoped;
+	ScopedLoadTiming loadTiming(__func__);
 	auto lock = CLoadLock::GetUniqueLock();
 
 	camHandler->Init();
@@ -853,6 +972,7 @@ void CGame::LoadInterface()
 void CGame::LoadLua(bool dryRun, bool onlyUnsynced)
 {
 	ZoneScoped;
+	ScopedLoadTiming loadTiming(__func__);
 	assert(!(dryRun && onlyUnsynced));
 	// Lua components
 	ENTER_SYNCED_CODE();
@@ -886,6 +1006,7 @@ void CGame::LoadLua(bool dryRun, bool onlyUnsynced)
 
 void CGame::LoadSkirmishAIs()
 {
+	ScopedLoadTiming loadTiming(__func__);
 	if (gameSetup->hostDemo)
 		return;
 	// happens if LoadInterface was skipped or interrupted on forcedQuit
@@ -915,6 +1036,7 @@ void CGame::LoadSkirmishAIs()
 void CGame::LoadFinalize()
 {
 	ZoneScoped;
+	ScopedLoadTiming loadTiming(__func__);
 	{
 		loadscreen->SetLoadMessage("[" + std::string(__func__) + "] finalizing PFS");
 
@@ -929,6 +1051,8 @@ void CGame::LoadFinalize()
 		);
 	}
 
+	shaderHandler->LogProgramBinaryStats();
+
 	lastReadNetTime = spring_gettime();
 	lastSimFrameTime = lastReadNetTime;
 	lastDrawFrameTime = lastReadNetTime;
@@ -972,6 +1096,8 @@ void CGame::KillLua(bool dtor)
 	CLuaRules::FreeHandler();
 
 	CSplitLuaHandle::ClearGameParams();
+	// names are interned in the order a game first sets them, start over with the next one
+	LuaRulesParams::ClearKeys();
 	LEAVE_SYNCED_CODE();
 
 
@@ -987,6 +1113,7 @@ void CGame::KillMisc()
 	RECOIL_DETAILED_TRACY_ZONE;
 	LOG("[Game::%s][1]", __func__);
 	CEndGameBox::Destroy();
+	KillScreenshots();
 	IVideoCapturing::FreeInstance();
 
 	LOG("[Game::%s][2]", __func__);
@@ -1049,6 +1176,7 @@ void CGame::KillSimulation()
 	}
 
 	LOG("[Game::%s][2]", __func__);
+	unitStateExporter.Kill();
 	unitHandler.DeleteScripts();
 
 	featureHandler.Kill(); // depends on unitHandler (via ~CFeature)
@@ -1171,7 +1299,7 @@ bool CGame::Update()
 
 	// When video recording do step by step simulation, so each simframe gets a corresponding videoframe
 	// FIXME: SERVER ALREADY DOES THIS BY ITSELF
-	if (playing && gameServer != nullptr && videoCapturing->AllowRecord())
+	if (playing && gameServer != nullptr && (videoCapturing->AllowRecord() || benchmarkEndFrame > 0))
 		gameServer->CreateNewFrame(false, true);
 
 	ENTER_SYNCED_CODE();
@@ -1268,7 +1396,9 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 		globalRendering->lastTimeOffset = globalRendering->timeOffset;
 		globalRendering->timeOffset = (currentTime - lastFrameTime).toMilliSecsf() * globalRendering->weightedSpeedFactor;
 
-		int SmoothTimeOffset = configHandler->GetInt("SmoothTimeOffset");
+		static ConfigVar<int> smoothTimeOffsetVar("SmoothTimeOffset");
+
+		int SmoothTimeOffset = smoothTimeOffsetVar.Get();
 		float strictness = 0.9f; // This defines how strict we are going to be when trying to keep frame timings
 		if (SmoothTimeOffset > 0) {
 			strictness = 1.0f - (SmoothTimeOffset) * 0.025f;
@@ -1393,6 +1523,8 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 	if (inMapDrawer->IsWantLabel() && gameTextInput.SendLabelInput())
 		gameTextInput.ClearInput();
 
+	inMapDrawer->SendPendingLines();
+
 	infoConsole->PushNewLinesToEventHandler();
 	infoConsole->Update();
 
@@ -1430,7 +1562,24 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 }
 
 
+void CGame::PostSwapBuffers()
+{
+	// draw frames keep coming while paused or lagging, no fallback needed
+	if (luaGCControl != 2)
+		return;
+
+	eventHandler.CollectGarbageInBudget(configHandler->GetFloat("LuaGarbageCollectionFrameBudget"));
+}
+
+static const char* const tracingDrawFrameName = "DrawFrame";
+
 bool CGame::Draw() {
+	// discontinuous, next to SimFrame; the continuous FrameMark is set by SwapBuffers
+	struct ScopedDrawFrameMark {
+		ScopedDrawFrameMark() { FrameMarkStart(tracingDrawFrameName); }
+		~ScopedDrawFrameMark() { FrameMarkEnd(tracingDrawFrameName); }
+	} drawFrameMark;
+
 	const spring_time currentTimePreUpdate = spring_gettime();
 
 	if (UpdateUnsynced(currentTimePreUpdate))
@@ -1514,6 +1663,7 @@ bool CGame::Draw() {
 
 	{
 		SCOPED_TIMER("Draw::Screen");
+		SCOPED_GPU_TIMER("Draw::Screen");
 		SCOPED_GL_DEBUGGROUP("Draw::Screen");
 		if (CUnitDrawer::UseScreenIcons())
 			unitDrawer->DrawUnitIconsScreen();
@@ -1535,6 +1685,8 @@ bool CGame::Draw() {
 	glEnable(GL_DEPTH_TEST);
 	glLoadIdentity();
 
+	UpdateScreenshots();
+
 	if (videoCapturing->AllowRecord()) {
 		videoCapturing->SetLastFrameTime(globalRendering->lastFrameTime = 1000.0f / GAME_SPEED);
 		// does nothing unless StartCapturing has also been called via /createvideo (Windows-only)
@@ -1675,6 +1827,16 @@ void CGame::StartPlaying()
 
 	if (saveFileHandler == nullptr)
 		eventHandler.GameStart();
+
+	if (benchmarkEndFrame > 0) {
+		LOG("[Game::%s] benchmarking until frame %d", __func__, benchmarkEndFrame);
+
+		// timers other than the special ones only record while enabled
+		CTimeProfiler::GetInstance().ResetState();
+		CTimeProfiler::GetInstance().SetEnabled(true);
+
+		benchmarkStartTime = spring_gettime();
+	}
 }
 
 static const char* const tracingSimFrameName = "SimFrame";
@@ -1757,7 +1919,8 @@ void CGame::SimFrame() {
 
 			// keep garbage-collection rate tied to sim-speed
 			// (fixed 30Hz gc is not enough while catching up)
-			if (luaGCControl == 0)
+			// but defer it at reduced sim quality, it is not synced
+			if (luaGCControl == 0 && gs->SimQualityFrame())
 				eventHandler.CollectGarbage(false);
 
 			eventHandler.GameFrame(gs->frameNum);
@@ -1795,6 +1958,7 @@ void CGame::SimFrame() {
 
 		teamHandler.GameFrame(gs->frameNum);
 		playerHandler.GameFrame(gs->frameNum);
+		eventHandler.SendBatchedEvents();
 		eventHandler.GameFramePost(gs->frameNum);
 
 		unitHandler.UpdatePostFrame();
@@ -1809,8 +1973,15 @@ void CGame::SimFrame() {
 
 	FrameMarkEnd(tracingSimFrameName);
 
+	if (benchmarkEndFrame > 0 && gs->frameNum >= benchmarkEndFrame) {
+		WriteBenchmarkResults();
+
+		benchmarkEndFrame = 0;
+		gu->globalQuit = true;
+	}
+
 	#ifdef HEADLESS
-	{
+	if (benchmarkEndFrame == 0 && !gu->globalQuit) {
 		const float msecMaxSimFrameTime = 1000.0f / (GAME_SPEED * gs->wantedSpeedFactor);
 		const float msecDifSimFrameTime = (lastSimFrameTime - lastFrameTime).toMilliSecsf();
 		// multiply by 0.5 to give unsynced code some execution time (50% of our sleep-budget)
@@ -1822,6 +1993,8 @@ void CGame::SimFrame() {
 	}
 	#endif
 
+	unitStateExporter.Update();
+
 	// useful for desync-debugging (enter instead of -1 start & end frame of the range you want to debug)
 	DumpState(-1, -1, 1, std::nullopt);
 
@@ -2014,6 +2187,27 @@ void CGame::HandleChatMsg(const ChatMessage& msg)
 
 
 
+void CGame::WriteBenchmarkResults() const
+{
+	const std::string filePath = dataDirsAccess.LocateFile(benchmarkFile, FileQueryFlags::WRITE);
+	FILE* file = fopen(filePath.c_str(), "w");
+
+	if (file == nullptr) {
+		LOG_L(L_ERROR, "[Game::%s] can not write benchmark results to \"%s\"", __func__, filePath.c_str());
+		return;
+	}
+
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"frames\": %d,\n", gs->frameNum);
+	fprintf(file, "\t\"wallTimeMs\": %.3f,\n", (spring_gettime() - benchmarkStartTime).toMilliSecsf());
+	fprintf(file, "\t\"avgSimFrameTimeMs\": %.3f,\n", gu->avgSimFrameTime);
+	CTimeProfiler::GetInstance().WriteProfilingInfo(file);
+	fprintf(file, "}\n");
+	fclose(file);
+
+	LOG("[Game::%s] wrote benchmark results for %d frames to \"%s\"", __func__, gs->frameNum, filePath.c_str());
+}
+
 void CGame::StartSkip(int toFrame) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	#if 0 // FIXME: desyncs
@@ -4,6 +4,7 @@
 #define _GAME_H
 
 #include <atomic>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -109,10 +110,21 @@ public:
 	bool ActionReleased(const Action& action);
 
 	const ActionList& GetLastActionList();
+
+public:
+	// set from the command line; while nonzero the sim is stepped as fast as it
+	// runs and the game quits once this frame is reached, after writing all the
+	// timer totals (pathing, LOS, projectiles, Lua, COB, ...) to benchmarkFile
+	inline static int benchmarkEndFrame = 0;
+	inline static std::string benchmarkFile = "benchmark.json";
+
 private:
 	bool Draw() override;
 	bool Update() override;
 	bool UpdateUnsynced(const spring_time currentTime);
+	void PostSwapBuffers() override;
+
+	void WriteBenchmarkResults() const;
 
 	void DrawSkip(bool blackscreen = true);
 	void DrawInputReceivers();
@@ -143,6 +155,8 @@ private:
 
 	void SendClientProcUsage();
 	void ClientReadNet();
+	/// serializes the sim for a mid-game joiner and streams it to the server
+	void SendSnapshot(int frameNum);
 	void UpdateNumQueuedSimFrames();
 	void UpdateNetMessageProcessingTimeLeft();
 	void SimFrame();
@@ -169,6 +183,7 @@ public:
 	spring_time lastSimFrameNetPacketTime;
 	spring_time lastUnsyncedUpdateTime;
 	spring_time skipLastDrawTime;
+	spring_time benchmarkStartTime;
 
 	float updateDeltaSeconds = 0.0f;
 	/// Time in seconds, stops at game end
@@ -192,6 +207,9 @@ public:
 	float msgProcTimeLeft = 0.0f;  ///< How many SimFrame() calls we still may do.
 	float consumeSpeedMult = 1.0f; ///< How fast we should eat NETMSG_NEWFRAMEs.
 
+	/// keyframe after which the server wants a snapshot from us, see NETMSG_SNAPSHOT_REQUEST
+	int snapshotRequestFrame = -1;
+
 
 	#if 0
 	int skipStartFrame = 0;
@@ -210,6 +228,7 @@ public:
 	int speedControl = -1;
 
 	// 0 := 1/f rate, 1 := 30/s rate
+	// 0: collect once per sim frame, 1: at 30Hz, 2: after every draw frame within LuaGarbageCollectionFrameBudget
 	int luaGCControl = 0;
 
 private:
@@ -225,6 +244,9 @@ private:
 
 	CGameInputReceiver gameInputReceiver;
 
+	/// independent loading stages overlapped with the defs parse, see LoadingParallelTasks
+	std::shared_future<void> soundDefsTask;
+
 	std::atomic<bool> loadDone = {false};
 	std::atomic<bool> gameOver = {false};
 };
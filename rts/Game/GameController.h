@@ -17,6 +17,8 @@ public:
 
 	virtual bool Draw() { return true; }
 	virtual bool Update() { return true; }
+	// called after each frame has been presented, for work that can use the idle time
+	virtual void PostSwapBuffers() {}
 	virtual int KeyPressed(int keyCode, int scanCode, bool isRepeat) { return 0; }
 	virtual int KeyMapChanged() { return 0; }
 	virtual int KeyReleased(int keyCode, int scanCode) { return 0; }
@@ -54,10 +54,13 @@ void CGameHelper::Init()
 		wdVec.clear();
 		wdVec.reserve(32);
 	}
+
+	weaponTargetCandidates.Reset();
 }
 
 void CGameHelper::Kill()
 {
+	weaponTargetCandidates.Reset();
 }
 
 void CGameHelper::Update()
@@ -655,6 +658,52 @@ namespace {
 
 
 
+void CGameHelper::WeaponTargetCandidates::Update(const CUnit* owner, float scanRadius)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const bool sameOwner = (ownerID == owner->id && ownerAllyTeam == owner->allyteam);
+	const bool sameState = (frameNum == gs->frameNum && unitQuadsVersion == quadField.GetUnitQuadsVersion());
+	const bool samePos = (posX == owner->pos.x && posZ == owner->pos.z);
+
+	if (sameOwner && sameState && samePos && scanRadius <= radius)
+		return;
+
+	ownerID = owner->id;
+	ownerAllyTeam = owner->allyteam;
+	frameNum = gs->frameNum;
+	unitQuadsVersion = quadField.GetUnitQuadsVersion();
+
+	posX = owner->pos.x;
+	posZ = owner->pos.z;
+	radius = scanRadius;
+
+	QuadFieldQuery qfQuery;
+	quadField.GetQuads(qfQuery, owner->pos, scanRadius);
+
+	units.clear();
+	allyTeamSegments.resize(teamHandler.ActiveAllyTeams());
+	allyTeamCached.assign(teamHandler.ActiveAllyTeams(), 0);
+
+	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+		allyTeamSegments[t].clear();
+
+		if (teamHandler.Ally(owner->allyteam, t))
+			continue;
+
+		allyTeamCached[t] = 1;
+
+		for (const int qi: *qfQuery.quads) {
+			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
+
+			if (allyTeamUnits.empty())
+				continue;
+
+			allyTeamSegments[t].push_back({qi, static_cast<unsigned int>(units.size()), static_cast<unsigned int>(units.size() + allyTeamUnits.size())});
+			units.insert(units.end(), allyTeamUnits.begin(), allyTeamUnits.end());
+		}
+	}
+}
+
 size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
 {
 	const CUnit*  weaponOwner = weapon->owner;
@@ -696,88 +745,117 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 
 	const int tempNum = gs->GetTempNum();
 
-	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
-		if (teamHandler.Ally(weaponOwner->allyteam, t))
-			continue;
+	const auto AddTarget = [&](CUnit* targetUnit) {
+		if (targetUnit->tempNum == tempNum)
+			return;
 
-		for (const int qi: *qfQuery.quads) {
-			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
+		targetUnit->tempNum = tempNum;
 
-			for (CUnit* targetUnit: allyTeamUnits) {
-				if (targetUnit->tempNum == tempNum)
-					continue;
+		if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
+			return;
 
-				targetUnit->tempNum = tempNum;
+		const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
 
-				if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
-					continue;
+		float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
+		float3 targetPos;
 
-				const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
+		if (targetLOSState & LOS_INLOS) {
+			targetPos = targetUnit->aimPos;
+		} else if (targetLOSState & LOS_INRADAR) {
+			targetPos = weapon->GetUnitPositionWithError(targetUnit);
+			targetPriority *= tgtPriorityMults[1];
+		} else {
+			return;
+		}
 
-				float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
-				float3 targetPos;
+		const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
+		const float sqDist2D = ownerPos.SqDistance2D(targetPos);
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPos = targetUnit->aimPos;
-				} else if (targetLOSState & LOS_INRADAR) {
-					targetPos = weapon->GetUnitPositionWithError(targetUnit);
-					targetPriority *= tgtPriorityMults[1];
-				} else {
-					continue;
-				}
+		if (sqDist2D > Square(modRange))
+			return;
 
-				const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
-				const float sqDist2D = ownerPos.SqDistance2D(targetPos);
+		const float3 worldTargetDir = (targetPos - ownerPos).SafeNormalize();
+		const float angleOffset =  (1.f - worldMainDir.dot(worldTargetDir));
+		const float angleMod = angleOffset * weaponAimAdjustPriority + 1.f;
 
-				if (sqDist2D > Square(modRange))
-					continue;
+		// Strengthen focus towards the front, desire should weaken quadratically rather
+		// than linearly otherwise target distance can too easily cause units to choose a
+		// target that requires turning around to fire at.
+		const float angleMul = angleMod*angleMod;
+
+		const float dist2D = math::sqrt(sqDist2D);
+		const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
+		const float damageMul = std::max(0.0001f, weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
 
-				const float3 worldTargetDir = (targetPos - ownerPos).SafeNormalize();
-				const float angleOffset =  (1.f - worldMainDir.dot(worldTargetDir));
-				const float angleMod = angleOffset * weaponAimAdjustPriority + 1.f;
+		targetPriority *= angleMul;
+		targetPriority *= rangeMul;
+		targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
 
-				// Strengthen focus towards the front, desire should weaken quadratically rather
-				// than linearly otherwise target distance can too easily cause units to choose a
-				// target that requires turning around to fire at.
-				const float angleMul = angleMod*angleMod;
+		if (targetLOSState & LOS_INLOS) {
+			targetPriority *= (secDamage + targetUnit->health);
 
-				const float dist2D = math::sqrt(sqDist2D);
-				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = std::max(0.0001f, weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple);
+			if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
+				targetPriority *= tgtPriorityMults[5];
 
-				targetPriority *= angleMul;
-				targetPriority *= rangeMul;
-				targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
+			if (weapon->hasTargetWeight)
+				targetPriority *= weapon->TargetWeight(targetUnit);
+
+		} else {
+			targetPriority *= (secDamage + 10000.0f);
+		}
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPriority *= (secDamage + targetUnit->health);
+		if (targetLOSState & LOS_PREVLOS) {
+			targetPriority /= (damageMul * targetUnit->power);
+			targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
+			targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
+			targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
+		}
 
-					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
-						targetPriority *= tgtPriorityMults[5];
+		const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
 
-					if (weapon->hasTargetWeight)
-						targetPriority *= weapon->TargetWeight(targetUnit);
+		// Lua call may have changed tempNum, so needs to be set again
+		targetUnit->tempNum = tempNum;
 
-				} else {
-					targetPriority *= (secDamage + 10000.0f);
-				}
+		if (!allowTarget)
+			return;
+
+		targets.emplace_back(targetPriority, targetUnit);
+	};
+
+	// shared with the owner's other weapons, see WeaponTargetCandidates
+	WeaponTargetCandidates& candidates = helper->weaponTargetCandidates;
+	candidates.Update(weaponOwner, scanRadius);
+
+	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+		if (teamHandler.Ally(weaponOwner->allyteam, t))
+			continue;
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power);
-					targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
-					targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
-					targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
+		// only misses if alliances changed since the cache was built
+		if (!candidates.HasAllyTeam(t)) {
+			for (const int qi: *qfQuery.quads) {
+				for (CUnit* targetUnit: quadField.GetQuad(qi).teamUnits[t]) {
+					AddTarget(targetUnit);
 				}
+			}
 
-				const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
+			continue;
+		}
 
-				// Lua call may have changed tempNum, so needs to be set again
-				targetUnit->tempNum = tempNum;
+		const auto& segments = candidates.allyTeamSegments[t];
+		auto segIt = segments.begin();
 
-				if (!allowTarget)
-					continue;
+		// both lists are in ascending quad order
+		for (const int qi: *qfQuery.quads) {
+			while (segIt != segments.end() && segIt->quadIdx < qi)
+				++segIt;
+
+			if (segIt == segments.end())
+				break;
+			if (segIt->quadIdx != qi)
+				continue;
 
-				targets.emplace_back(targetPriority, targetUnit);
+			for (unsigned int k = segIt->unitsBeg; k < segIt->unitsEnd; k++) {
+				AddTarget(candidates.units[k]);
 			}
 		}
 	}
@@ -14,6 +14,7 @@
 
 #include <array>
 #include <bit>
+#include <cstdint>
 #include <vector>
 #include <memory>
 #include <variant>
@@ -266,9 +267,46 @@ private:
 	std::array<std::vector<WaitingDamage>, 128> waitingDamages;
 	static_assert (std::has_single_bit(std::tuple_size_v <decltype(waitingDamages)>), "Size is used in bit hax and must be 2^N");
 
+	// Enemy units near one weapon owner, copied out of the quads once and shared by
+	// all of its weapons while their AutoTarget calls run within the same SlowUpdate.
+	// Each weapon's own quads are a subset of the (larger) cached ones, so walking the
+	// cached segments of those quads visits the same units in the same order as
+	// reading the quads directly.
+	struct WeaponTargetCandidates {
+	public:
+		struct Segment {
+			int quadIdx;
+			unsigned int unitsBeg;
+			unsigned int unitsEnd;
+		};
+
+		void Reset() { ownerID = -1; }
+		// rebuilds the cache unless it still covers <radius> around <owner>
+		void Update(const CUnit* owner, float radius);
+
+		bool HasAllyTeam(int allyTeam) const { return (allyTeamCached[allyTeam] != 0); }
+
+	public:
+		// per allyteam, in ascending quad order
+		std::vector< std::vector<Segment> > allyTeamSegments;
+		std::vector<std::uint8_t> allyTeamCached;
+		std::vector<CUnit*> units;
+
+	private:
+		int ownerID = -1;
+		int ownerAllyTeam = -1;
+		int frameNum = -1;
+		unsigned int unitQuadsVersion = 0;
+
+		float posX = 0.0f;
+		float posZ = 0.0f;
+		float radius = 0.0f;
+	};
+
 public:
 	std::vector<int> targetUnitIDs; // GetEnemyUnits{NoLosTest}
 	std::vector<std::pair<float, CUnit*>> targetPairs; // GenerateWeaponTargets
+	WeaponTargetCandidates weaponTargetCandidates; // GenerateWeaponTargets
 };
 
 extern CGameHelper* helper;
\ No newline at end of file
@@ -153,6 +153,14 @@ public:
 	 */
 	bool spectatingFullSelect = false;
 
+	/**
+	 * @brief spectatingAllAllyTeams
+	 *
+	 * Whether the LOS and radar views of a full-view spectator show what any
+	 * allyteam sees instead of the current allyteam's view
+	 */
+	bool spectatingAllAllyTeams = false;
+
 	/**
 	 * @brief fpsMode
 	 *
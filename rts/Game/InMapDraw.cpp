@@ -17,6 +17,7 @@
 #include "Net/Protocol/NetProtocol.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/Config/ConfigVar.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/EventHandler.h"
 #include "System/EventClient.h"
@@ -29,6 +30,8 @@
 
 CONFIG(bool, MiniMapCanDraw).defaultValue(false).description("Enables drawing with cursor over MiniMap.");
 
+static ConfigVar<bool> miniMapCanDraw("MiniMapCanDraw");
+
 
 CInMapDraw* inMapDrawer = nullptr;
 
@@ -105,7 +108,7 @@ void CInMapDraw::MousePress(int x, int y, int button)
 			SendPoint(pos, "", false);
 		} break;
 		case SDL_BUTTON_RIGHT: {
-			if (!isInMiniMap || configHandler->GetBool("MiniMapCanDraw"))
+			if (!isInMiniMap || miniMapCanDraw.Get())
 				SendErase(pos);
 		} break;
 		default: {
@@ -128,7 +131,7 @@ void CInMapDraw::MouseMove(int x, int y, int dx, int dy, int button)
 	RECOIL_DETAILED_TRACY_ZONE;
 	const bool isInMiniMap = (minimap != nullptr) && minimap->IsInside(x,y);
 
-	if (isInMiniMap && !configHandler->GetBool("MiniMapCanDraw"))
+	if (isInMiniMap && !miniMapCanDraw.Get())
 		return;
 
 	const float3 pos = isInMiniMap ? minimap->GetMapPosition(x, y) : mouse->GetWorldMapPos();
@@ -195,6 +198,30 @@ int CInMapDraw::GotNetMsg(std::shared_ptr<const netcode::RawPacket>& packet)
 				if (!fromLua || allowLuaMapDrawing)
 					inMapDrawerModel->AddLine(pos1, pos2, playerID);
 			} break;
+			case MAPDRAW_POLYLINE: {
+				uint8_t flags;
+				pckt >> flags;
+
+				// x and z of each point fill the rest of the packet
+				polylineCoords.resize(((packet->length - 5) / sizeof(uint16_t)) & ~size_t(1));
+				pckt >> polylineCoords;
+
+				if ((flags & MAPDRAW_POLYLINE_FROM_LUA) != 0 && !allowLuaMapDrawing)
+					break;
+
+				const bool reversed = ((flags & MAPDRAW_POLYLINE_REVERSED) != 0);
+
+				for (size_t i = 2; (i + 1) < polylineCoords.size(); i += 2) {
+					const float3 posA(polylineCoords[i - 2], 0, polylineCoords[i - 1]);
+					const float3 posB(polylineCoords[i    ], 0, polylineCoords[i + 1]);
+
+					if (reversed) {
+						inMapDrawerModel->AddLine(posB, posA, playerID);
+					} else {
+						inMapDrawerModel->AddLine(posA, posB, playerID);
+					}
+				}
+			} break;
 			case MAPDRAW_ERASE: {
 				uint32_t x, z;
 				pckt >> x;
@@ -229,6 +256,9 @@ void CInMapDraw::SetLuaMapDrawingAllowed(bool state)
 void CInMapDraw::SendErase(const float3& pos)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// keeps the order of queued lines and the erase
+	SendPendingLines();
+
 	if (!gu->spectating || allowSpecMapDrawing)
 		clientNet->Send(CBaseNetProtocol::Get().SendMapErase(gu->myPlayerNum, (uint32_t)pos.x, (uint32_t)pos.z));
 }
@@ -237,6 +267,8 @@ void CInMapDraw::SendErase(const float3& pos)
 void CInMapDraw::SendPoint(const float3& pos, const std::string& label, bool fromLua)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	SendPendingLines();
+
 	if (!gu->spectating || allowSpecMapDrawing)
 		clientNet->Send(CBaseNetProtocol::Get().SendMapDrawPoint(gu->myPlayerNum, (uint32_t)pos.x, (uint32_t)pos.z, label, fromLua));
 }
@@ -244,8 +276,73 @@ void CInMapDraw::SendPoint(const float3& pos, const std::string& label, bool fro
 void CInMapDraw::SendLine(const float3& pos, const float3& pos2, bool fromLua)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (!gu->spectating || allowSpecMapDrawing)
-		clientNet->Send(CBaseNetProtocol::Get().SendMapDrawLine(gu->myPlayerNum, (uint32_t)pos.x, (uint32_t)pos.z, (uint32_t)pos2.x, (uint32_t)pos2.z, fromLua));
+	if (gu->spectating && !allowSpecMapDrawing)
+		return;
+
+	const auto ToCoord = [](float c) { return static_cast<uint16_t>(std::clamp(c, 0.0f, 65535.0f)); };
+
+	const uint16_t x1 = ToCoord(pos.x);
+	const uint16_t z1 = ToCoord(pos.z);
+	const uint16_t x2 = ToCoord(pos2.x);
+	const uint16_t z2 = ToCoord(pos2.z);
+
+	// consecutive lines of a stroke or a Lua shape go out as one packet
+	if (!AppendPendingLine(x1, z1, x2, z2, fromLua)) {
+		SendPendingLines();
+
+		pendingLine.assign({x1, z1, x2, z2});
+		pendingLineFlags = fromLua? MAPDRAW_POLYLINE_FROM_LUA: 0;
+	}
+
+	if (pendingLine.size() >= (MAPDRAW_POLYLINE_MAX_POINTS * 2))
+		SendPendingLines();
+}
+
+bool CInMapDraw::AppendPendingLine(uint16_t x1, uint16_t z1, uint16_t x2, uint16_t z2, bool fromLua)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (pendingLine.empty() || ((pendingLineFlags & MAPDRAW_POLYLINE_FROM_LUA) != 0) != fromLua)
+		return false;
+
+	const size_t n = pendingLine.size();
+
+	if ((pendingLineFlags & MAPDRAW_POLYLINE_REVERSED) == 0) {
+		// segments run from point i to point i+1, the new one has to start at the last point
+		if (pendingLine[n - 2] == x1 && pendingLine[n - 1] == z1) {
+			pendingLine.push_back(x2);
+			pendingLine.push_back(z2);
+			return true;
+		}
+
+		// a single segment can still be turned around; mouse strokes
+		// send each segment ending where the previous one started
+		if (n != 4 || pendingLine[0] != x2 || pendingLine[1] != z2)
+			return false;
+
+		std::swap(pendingLine[0], pendingLine[2]);
+		std::swap(pendingLine[1], pendingLine[3]);
+		pendingLineFlags |= MAPDRAW_POLYLINE_REVERSED;
+	}
+
+	// segments run from point i+1 to point i, the new one has to end at the last point
+	if (pendingLine[n - 2] != x2 || pendingLine[n - 1] != z2)
+		return false;
+
+	pendingLine.push_back(x1);
+	pendingLine.push_back(z1);
+	return true;
+}
+
+void CInMapDraw::SendPendingLines()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (pendingLine.empty())
+		return;
+
+	clientNet->Send(CBaseNetProtocol::Get().SendMapDrawPolyline(gu->myPlayerNum, pendingLine, pendingLineFlags));
+
+	pendingLine.clear();
+	pendingLineFlags = 0;
 }
 
 void CInMapDraw::SendWaitingInput(const std::string& label)
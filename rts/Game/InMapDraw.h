@@ -39,6 +39,8 @@ public:
 	void SendLine(const float3& pos1, const float3& pos2, bool fromLua);
 	void SendErase(const float3& pos);
 	void SendWaitingInput(const std::string& label);
+	/// sends the lines queued by SendLine since the last call, once per frame
+	void SendPendingLines();
 
 	void PromptLabel(const float3& pos);
 
@@ -58,6 +60,9 @@ public:
 	void SetLuaMapDrawingAllowed(bool state);
 	bool GetLuaMapDrawingAllowed() const { return allowLuaMapDrawing; }
 
+private:
+	bool AppendPendingLine(uint16_t x1, uint16_t z1, uint16_t x2, uint16_t z2, bool fromLua);
+
 private:
 	float lastLeftClickTime = 0.0f;
 	float lastDrawTime = 0.0f;
@@ -80,6 +85,13 @@ private:
 	/// whether client ignores incoming Lua MAPDRAW net-messages (unsynced)
 	bool allowLuaMapDrawing = true;
 
+	/// connected lines queued by SendLine (x and z of each point), sent as one MAPDRAW_POLYLINE
+	std::vector<uint16_t> pendingLine;
+	uint8_t pendingLineFlags = 0;
+
+	/// received MAPDRAW_POLYLINE points
+	std::vector<uint16_t> polylineCoords;
+
 	std::unique_ptr<CNotificationPeeper> notificationPeeper;
 };
 
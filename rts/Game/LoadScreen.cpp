@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <SDL.h>
+#include <algorithm>
 #include <functional>
 
 #include "Rendering/GL/myGL.h"
@@ -27,12 +28,16 @@
 #include "System/Misc/UnfreezeSpring.h"
 #include "System/Matrix44f.h"
 #include "System/SafeUtil.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/VFSHandler.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Platform/Threading.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/LoadLock.h"
+#include "System/TimeProfiler.h"
+#include "System/Misc/StartupTrace.h"
 
 #if !defined(HEADLESS) && !defined(NO_SOUND)
 #include "System/Sound/OpenAL/EFX.h"
@@ -48,6 +53,28 @@ CONFIG(int, LoadingMT)
 	.defaultValue(0)
 	.safemodeValue(0);
 
+CONFIG(bool, LoadingPrefetch)
+	.description("Read the game's definition and script files concurrently into memory before loading starts.")
+	.defaultValue(true)
+	.safemodeValue(false);
+
+
+static void PrefetchGameFiles()
+{
+	// directories the loading stages read (nearly) in full; textures, models and sounds stay on demand
+	static const std::vector<std::string> PREFETCH_DIRS = {"gamedata", "units", "weapons", "features", "scripts", "luarules", "luagaia", "luaui"};
+	static constexpr int MAX_PREFETCH_FILE_SIZE = 1024 * 1024;
+
+	if (!configHandler->GetBool("LoadingPrefetch"))
+		return;
+
+	SCOPED_ONCE_TIMER("LoadScreen::PrefetchGameFiles");
+
+	const size_t numFiles = vfsHandler->PrefetchFilesInDirs(PREFETCH_DIRS, MAX_PREFETCH_FILE_SIZE, CVFSHandler::Section::Mod);
+
+	LOG("[LoadScreen::%s] prefetched %u files", __func__, static_cast<uint32_t>(numFiles));
+}
+
 
 CLoadScreen* CLoadScreen::singleton = nullptr;
 
@@ -59,6 +86,7 @@ CLoadScreen::CLoadScreen(std::string&& _mapFileName, std::string&& _modFileName,
 
 	, mtLoading(true)
 	, lastDrawTime(0)
+	, loadStartTime(spring_gettime())
 {
 }
 
@@ -111,6 +139,9 @@ bool CLoadScreen::Init()
 	netHeartbeatThread = spring::thread(Threading::CreateNewThread(std::bind(&CNetProtocol::UpdateLoop, clientNet)));
 	game = new CGame(mapFileName, modFileName, saveFile);
 
+	// ahead of the load-thread, Init would only spin-wait on it meanwhile
+	PrefetchGameFiles();
+
 	CglFont::sync.SetThreadSafety(mtLoading);
 	CLoadLock::SetThreadSafety(mtLoading);
 	if (mtLoading) {
@@ -162,6 +193,9 @@ void CLoadScreen::Kill()
 	// has finished and deregistered itself from WatchDog
 	gameLoadThread.join();
 
+	LogLoadTimings();
+	WriteStartupTrace();
+
 	CFontTexture::sync.SetThreadSafety(false);
 	CLoadLock::SetThreadSafety(false);
 	// set last time and forever
@@ -170,6 +204,43 @@ void CLoadScreen::Kill()
 }
 
 
+void CLoadScreen::AddLoadTiming(const char* name, spring_time startTime, spring_time duration, bool async)
+{
+	std::lock_guard<spring::recursive_mutex> lck(mutex);
+	loadTimings.push_back({name, startTime, duration, async});
+
+	CStartupTrace::AddEvent(name, async? "load-worker": "load", startTime, duration);
+}
+
+void CLoadScreen::WriteStartupTrace() const
+{
+	if (!CStartupTrace::IsEnabled())
+		return;
+
+	const std::string filePath = dataDirsAccess.LocateFile(CStartupTrace::GetFileName(), FileQueryFlags::WRITE);
+
+	if (!CStartupTrace::Finish(filePath)) {
+		LOG_L(L_ERROR, "[LoadScreen::%s] can not write startup trace to \"%s\"", __func__, filePath.c_str());
+		return;
+	}
+
+	LOG("[LoadScreen::%s] wrote startup trace to \"%s\"", __func__, filePath.c_str());
+}
+
+void CLoadScreen::LogLoadTimings() const
+{
+	// stages are recorded when they end, list them in the order they began
+	std::vector<LoadTiming> timings = loadTimings;
+	std::stable_sort(timings.begin(), timings.end(), [](const LoadTiming& a, const LoadTiming& b) { return (a.startTime < b.startTime); });
+
+	LOG("[LoadScreen::%s] %u loading stages, %.0fms total", __func__, static_cast<uint32_t>(timings.size()), (spring_gettime() - loadStartTime).toMilliSecsf());
+
+	for (const LoadTiming& t: timings) {
+		LOG("\t%-32s start=%8.1fms duration=%8.1fms%s", t.name, (t.startTime - loadStartTime).toMilliSecsf(), t.duration.toMilliSecsf(), t.async? " (worker)": "");
+	}
+}
+
+
 /******************************************************************************/
 
 static void FinishedLoading()
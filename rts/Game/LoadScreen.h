@@ -4,6 +4,7 @@
 #define _LOAD_SCREEN_H
 
 #include <string>
+#include <vector>
 
 #include "GameController.h"
 #include "System/LoadSave/LoadSaveHandler.h"
@@ -17,6 +18,8 @@ class CLoadScreen : public CGameController
 {
 public:
 	void SetLoadMessage(const std::string& text, bool replaceLast = false);
+	/// thread-safe, also called by loading tasks running on worker threads
+	void AddLoadTiming(const char* name, spring_time startTime, spring_time duration, bool async);
 
 	CLoadScreen(std::string&& mapFileName, std::string&& modFileName, ILoadSaveHandler* saveFile);
 	~CLoadScreen();
@@ -43,11 +46,24 @@ public:
 
 
 private:
+	void LogLoadTimings() const;
+	/// writes the --startup-trace file, everything from startup until here
+	void WriteStartupTrace() const;
+
+private:
+	struct LoadTiming {
+		const char* name;
+		spring_time startTime;
+		spring_time duration;
+		bool async;
+	};
+
 	static CLoadScreen* singleton;
 
 	ILoadSaveHandler* saveFile;
 
 	std::vector< std::pair<std::string, bool> > loadMessages;
+	std::vector<LoadTiming> loadTimings;
 
 	std::string mapFileName;
 	std::string modFileName;
@@ -59,6 +75,7 @@ private:
 	bool mtLoading;
 
 	spring_time lastDrawTime;
+	spring_time loadStartTime;
 };
 
 
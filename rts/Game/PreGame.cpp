@@ -42,6 +42,7 @@
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/VFSHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/LoadSave/LoadSaveHandler.h"
@@ -447,6 +448,15 @@ void CPreGame::UpdateClientNet()
 				);
 			} break;
 
+			case NETMSG_SNAPSHOT_CHUNK: {
+				// joining a running game; loaded like a savegame instead of re-simulating it
+				try {
+					SnapshotChunkReceived(packet);
+				} catch (const netcode::UnpackPacketException& ex) {
+					LOG_L(L_ERROR, "[PreGame::%s][NETMSG_SNAPSHOT_CHUNK] exception \"%s\"", __func__, ex.what());
+				}
+			} break;
+
 			case NETMSG_SETPLAYERNUM: {
 				// this is sent after NETMSG_GAMEDATA, to let us know which
 				// player number we have (server assigns them based on order
@@ -676,6 +686,49 @@ void CPreGame::GameDataReceived(std::shared_ptr<const netcode::RawPacket> packet
 	LEAVE_SYNCED_CODE();
 }
 
+
+void CPreGame::SnapshotChunkReceived(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	netcode::UnpackPacket pckt(packet, 3);
+
+	uint8_t playerNum;
+	int32_t frameNum;
+	uint32_t syncChecksum;
+	uint32_t totalSize;
+	uint32_t offset;
+
+	pckt >> playerNum;
+	pckt >> frameNum;
+	pckt >> syncChecksum;
+	pckt >> totalSize;
+	pckt >> offset;
+
+	constexpr uint32_t headerSize = 3 + 1 + 4 + 4 + 4 + 4;
+
+	if (offset != snapshotData.size())
+		throw content_error("Snapshot from server arrived out of order");
+
+	if (offset == 0)
+		snapshotData.reserve(totalSize);
+
+	snapshotData.insert(snapshotData.end(), packet->data + headerSize, packet->data + packet->length);
+
+	if (snapshotData.size() < totalSize)
+		return;
+
+	CCregLoadSaveHandler* snapshotHandler = new CCregLoadSaveHandler();
+
+	if (!snapshotHandler->LoadSnapshot(snapshotData, syncChecksum)) {
+		spring::SafeDelete(snapshotHandler);
+		throw content_error("Could not load the game snapshot sent by the server");
+	}
+
+	LOG("[PreGame::%s] received snapshot of frame %d (%u KiB) taken by player %d", __func__, frameNum, unsigned(totalSize / 1024), playerNum);
+
+	saveFileHandler = snapshotHandler;
+	snapshotData = {};
+}
+
 bool CPreGame::HasPendingAsyncTask()
 {
 	if (!pendingTask.valid())
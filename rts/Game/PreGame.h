@@ -3,9 +3,11 @@
 #ifndef PREGAME_H
 #define PREGAME_H
 
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <future>
+#include <vector>
 
 #include "GameController.h"
 #include "System/Misc/SpringTime.h"
@@ -67,6 +69,7 @@ private:
 	void UpdateClientNet();
 
 	void GameDataReceived(std::shared_ptr<const netcode::RawPacket> packet);
+	void SnapshotChunkReceived(std::shared_ptr<const netcode::RawPacket> packet);
 
 	bool HasPendingAsyncTask();
 private:
@@ -83,6 +86,9 @@ private:
 	std::string modFileName;
 	ILoadSaveHandler* saveFileHandler;
 
+	/// mid-game join: sim state the server sends between gamedata and our player number
+	std::vector<std::uint8_t> snapshotData;
+
 	spring_time connectTimer;
 
 	bool wantDemo;
@@ -450,29 +450,11 @@ void CSelectedUnitsHandlerAI::MakeFormationFrontOrder(Command* c, int playerNum)
 		sortedUnitGroups.clear();
 	}
 
-	// find closest unassigned unit to move for each move command
-	for (size_t i = 0; i < allFrontMoveCommands.size(); i++) {
-		size_t closestUnit = 0;
-		float closestDistSq = std::numeric_limits<float>::infinity();
-		const auto cmdPos = allFrontMoveCommands[i].second.GetPos(0);
-
-		// find closest unit of the unit type selected for this move command
-		for (size_t j = 0; j < unassignedUnits.size(); j++) {
-			const auto& unit = unassignedUnits[j];
-			if (unit.unitDefId == mixedUnitTypes[i]){
-				float curDistSq = unit.pos.SqDistance(cmdPos);
-				if (curDistSq < closestDistSq) {
-					closestUnit = j;
-					closestDistSq = curDistSq;
-				}
-			}
-		}
+	// find closest unassigned unit of the type selected for each move command
+	unassignedUnitGrid.Init(unassignedUnits);
 
-		mixedUnitIDs.emplace_back(unassignedUnits[closestUnit].unitId);
-
-		auto& selUnit = unassignedUnits[closestUnit];
-		selUnit = unassignedUnits.back();
-		unassignedUnits.pop_back();
+	for (size_t i = 0; i < allFrontMoveCommands.size(); i++) {
+		mixedUnitIDs.emplace_back(unassignedUnitGrid.PopClosest(mixedUnitTypes[i], allFrontMoveCommands[i].second.GetPos(0)));
 	}
 
 	for (size_t i = 0; i < allFrontMoveCommands.size(); i++) {
@@ -3,6 +3,7 @@
 #ifndef SELECTED_UNITS_AI_H
 #define SELECTED_UNITS_AI_H
 
+#include "Game/FormationUnitGrid.h"
 #include "Sim/Units/CommandAI/Command.h"
 #include "System/float3.h"
 
@@ -56,21 +57,8 @@ private:
 	std::vector<size_t> mixedGroupSizes;
 	std::vector<size_t> mixedUnitTypes;
 
-	struct UnitReference {
-		UnitReference(int _unitId, int _unitDefId, float3& _pos)
-			: unitId(_unitId)
-			, unitDefId(_unitDefId)
-			, pos(_pos)
-		{}
-
-		UnitReference()	{};
-
-		int unitId = -1;
-		int unitDefId = -1;
-		float3 pos;
-	};
-
-	std::vector<UnitReference> unassignedUnits;
+	std::vector<CFormationUnitGrid::UnitReference> unassignedUnits;
+	CFormationUnitGrid unassignedUnitGrid;
 
 	std::vector<int> targetUnitIDs;
 };
@@ -64,6 +64,7 @@ void CSelectedUnitsHandler::Init(unsigned numPlayers)
 	autoAddBuiltUnitsToSelectedGroup = configHandler->GetBool("AutoAddBuiltUnitsToSelectedGroup");
 
 	netSelected.resize(numPlayers);
+	selectedUnitsListDirty = true;
 }
 
 
@@ -404,6 +405,7 @@ void CSelectedUnitsHandler::AddUnit(CUnit* unit)
 		AddDeathDependence(unit, DEPENDENCE_SELECTED);
 
 		selectionChanged = true;
+		selectedUnitsListDirty = true;
 		possibleCommandsChanged = true;
 
 		const CGroup* g = unit->GetGroup();
@@ -416,6 +418,17 @@ void CSelectedUnitsHandler::AddUnit(CUnit* unit)
 }
 
 
+const std::vector<int>& CSelectedUnitsHandler::GetSelectedUnitsList() const
+{
+	if (selectedUnitsListDirty) {
+		selectedUnitsList.assign(selectedUnits.begin(), selectedUnits.end());
+		selectedUnitsListDirty = false;
+	}
+
+	return selectedUnitsList;
+}
+
+
 void CSelectedUnitsHandler::RemoveUnit(CUnit* unit)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -423,6 +436,7 @@ void CSelectedUnitsHandler::RemoveUnit(CUnit* unit)
 		DeleteDeathDependence(unit, DEPENDENCE_SELECTED);
 
 		selectionChanged = true;
+		selectedUnitsListDirty = true;
 		possibleCommandsChanged = true;
 		selectedGroup = -1;
 		unit->isSelected = false;
@@ -454,6 +468,7 @@ void CSelectedUnitsHandler::ClearSelected()
 
 	selectedUnits.clear();
 	selectionChanged = true;
+	selectedUnitsListDirty = true;
 	possibleCommandsChanged = true;
 	selectedGroup = -1;
 }
@@ -493,6 +508,7 @@ void CSelectedUnitsHandler::SelectGroup(int num)
 	if (!selectedUnits.empty()) {
 		// if ClearSelected changed anything then it already set these.
 		selectionChanged = true;
+		selectedUnitsListDirty = true;
 		possibleCommandsChanged = true;
 	}
 }
@@ -731,6 +747,7 @@ void CSelectedUnitsHandler::DependentDied(CObject* o)
 	selectedUnits.erase(static_cast<CUnit*>(o)->id);
 
 	selectionChanged = true;
+	selectedUnitsListDirty = true;
 	possibleCommandsChanged = true;
 }
 
@@ -57,6 +57,9 @@ public:
 	void SendSelect();
 	void SendCommandsToUnits(const std::vector<int>& unitIDs, const std::vector<Command>& commands, bool pairwise = false);
 
+	/// selectedUnits as a vector, rebuilt only after the selection changed
+	const std::vector<int>& GetSelectedUnitsList() const;
+
 	bool CommandsChanged() const { return possibleCommandsChanged; }
 	bool IsUnitSelected(const CUnit* unit) const;
 	bool IsUnitSelected(const int unitID) const;
@@ -91,6 +94,10 @@ public:
 private:
 	// buffer for SendCommand unordered_set->vector conversion
 	std::vector<int16_t> selectedUnitIDs;
+
+	// backs GetSelectedUnitsList for Lua callers that ask every frame
+	mutable std::vector<int> selectedUnitsList;
+	mutable bool selectedUnitsListDirty = true;
 };
 
 extern CSelectedUnitsHandler selectedUnitsHandler;
@@ -31,6 +31,7 @@
 #include "System/Log/ILog.h"
 #include "System/SafeUtil.h"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <stdexcept>
@@ -567,6 +568,33 @@ public:
 	}
 };
 
+
+
+class SimQualityActionExecutor : public ISyncedActionExecutor {
+public:
+	SimQualityActionExecutor() : ISyncedActionExecutor(
+		"SimQuality",
+		"Sets the sim quality level (0 is full quality) at which "
+		"non-critical sim work runs, issued by the server only"
+	) {
+	}
+
+	bool Execute(const SyncedAction& action) const final {
+		// clients can not send this, the server decides for everyone
+		if (action.GetPlayerID() != SERVER_PLAYER)
+			return false;
+
+		const int level = std::clamp(std::atoi(action.GetArgs().c_str()), 0, MAX_SIM_QUALITY_LEVEL);
+
+		if (level == gs->simQualityLevel)
+			return true;
+
+		gs->simQualityLevel = level;
+		LOG("[SimQualityActionExecutor] sim quality level set to %d in frame %d", level, gs->frameNum);
+		return true;
+	}
+};
+
 } // namespace (unnamed)
 
 
@@ -599,6 +627,7 @@ void SyncedGameCommands::AddDefaultActionExecutors()
 		AddActionExecutor(AllocActionExecutor<TakeActionExecutor>());
 
 	AddActionExecutor(AllocActionExecutor<SkipActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<SimQualityActionExecutor>());
 }
 
 
@@ -10,6 +10,7 @@
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GeometricObjects.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -20,8 +21,11 @@
 #include "Sim/Weapons/WeaponDef.h"
 #include "System/GlobalConfig.h"
 #include "System/SpringMath.h"
+#include "System/Platform/Threading.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <algorithm>
+#include <array>
 #include <vector>
 
 #include "System/Misc/TracyDefs.h"
@@ -233,6 +237,7 @@ float TraceRay(
 		CollisionQuery cq;
 
 		QuadFieldQuery qfQuery;
+		qfQuery.threadOwner = ThreadPool::GetThreadNum();
 		quadField.GetQuadsOnRay(qfQuery, pos, dir, traceLength);
 
 		// locally point somewhere non-NULL; we cannot pass hitColQuery
@@ -240,6 +245,10 @@ float TraceRay(
 		if (hitColQuery == nullptr)
 			hitColQuery = &cq;
 
+		// objects spanning several quads would otherwise be hit-tested once per quad
+		const int threadNum = ThreadPool::GetThreadNum();
+		const int tempNum = gs->GetMtTempNum(threadNum);
+
 		// feature intersection
 		if (scanForFeatures) {
 			for (const int quadIdx: *qfQuery.quads) {
@@ -251,6 +260,10 @@ float TraceRay(
 					//   for collisions with projectiles so we can skip it here
 					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 						continue;
+					if (f->mtTempNum[threadNum] == tempNum)
+						continue;
+
+					f->mtTempNum[threadNum] = tempNum;
 
 					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
 						const float len = cq.GetHitPosDist(pos, dir);
@@ -289,6 +302,10 @@ float TraceRay(
 
 					if (!doHitTest)
 						continue;
+					if (u->mtTempNum[threadNum] == tempNum)
+						continue;
+
+					u->mtTempNum[threadNum] = tempNum;
 
 					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
 						const float len = cq.GetHitPosDist(pos, dir);
@@ -340,6 +357,7 @@ void TraceRayShields(
 	CollisionQuery cq;
 
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
 	quadField.GetQuadsOnRay(qfQuery, start, dir, length);
 
 	for (const int quadIdx: *qfQuery.quads) {
@@ -368,7 +386,7 @@ void TraceRayShields(
 }
 
 
-float GuiTraceRay(
+static float GuiTraceRayImpl(
 	const float3& start,
 	const float3& dir,
 	const float length,
@@ -421,6 +439,7 @@ float GuiTraceRay(
 	CollisionQuery cq;
 
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
 	if (useRadar) {
 		const float allyTeamError = losHandler->GetAllyTeamRadarErrorSize(gu->myAllyTeam);
 		quadField.GetQuadsOnWideRay(qfQuery, start, dir, maxRayLength, allyTeamError);
@@ -523,6 +542,112 @@ float GuiTraceRay(
 	return minIngressDist;
 }
 
+// GuiTraceRay results of the current draw frame; the ray under the cursor is
+// traced by the mouse and gui handlers and then again by any number of widgets
+// (via Spring.TraceScreenRay), and unit positions are interpolated per frame
+struct GuiTraceRayCache {
+public:
+	struct Entry {
+		float3 start;
+		float3 dir;
+		float length;
+
+		const CUnit* exclude;
+		const CUnit* hitUnit;
+		const CFeature* hitFeature;
+
+		float hitDist;
+
+		bool useRadar;
+		bool groundOnly;
+		bool ignoreWater;
+	};
+
+	const Entry* Find(const float3& start, const float3& dir, float length, const CUnit* exclude, bool useRadar, bool groundOnly, bool ignoreWater) {
+		Validate();
+
+		for (size_t i = 0; i < numEntries; i++) {
+			const Entry& e = entries[i];
+
+			if (!e.start.same(start) || !e.dir.same(dir) || e.length != length || e.exclude != exclude)
+				continue;
+			if (e.useRadar != useRadar || e.groundOnly != groundOnly || e.ignoreWater != ignoreWater)
+				continue;
+
+			return &e;
+		}
+
+		return nullptr;
+	}
+
+	void Insert(const Entry& e) {
+		entries[nextEntry] = e;
+		nextEntry = (nextEntry + 1) % entries.size();
+		numEntries = std::min(numEntries + 1, entries.size());
+	}
+
+private:
+	// anything that changes what a ray would hit clears the cache
+	void Validate() {
+		const int newSimFrame = gs->frameNum;
+		const int newAllyTeam = gu->myAllyTeam;
+		const unsigned int newDrawFrame = globalRendering->drawFrame;
+		const bool newFullView = gu->spectatingFullView;
+
+		if (newDrawFrame == drawFrame && newSimFrame == simFrame && newAllyTeam == allyTeam && newFullView == fullView)
+			return;
+
+		drawFrame = newDrawFrame;
+		simFrame = newSimFrame;
+		allyTeam = newAllyTeam;
+		fullView = newFullView;
+
+		numEntries = 0;
+		nextEntry = 0;
+	}
+
+private:
+	std::array<Entry, 16> entries;
+
+	size_t numEntries = 0;
+	size_t nextEntry = 0;
+
+	unsigned int drawFrame = 0;
+	int simFrame = -1;
+	int allyTeam = -1;
+	bool fullView = false;
+};
+
+static GuiTraceRayCache guiTraceRayCache;
+
+float GuiTraceRay(
+	const float3& start,
+	const float3& dir,
+	const float length,
+	const CUnit* exclude,
+	const CUnit*& hitUnit,
+	const CFeature*& hitFeature,
+	bool useRadar,
+	bool groundOnly,
+	bool ignoreWater
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the cache is not synchronized, rays traced from other threads bypass it
+	if (!Threading::IsMainThread())
+		return (GuiTraceRayImpl(start, dir, length, exclude, hitUnit, hitFeature, useRadar, groundOnly, ignoreWater));
+
+	if (const GuiTraceRayCache::Entry* e = guiTraceRayCache.Find(start, dir, length, exclude, useRadar, groundOnly, ignoreWater); e != nullptr) {
+		hitUnit = e->hitUnit;
+		hitFeature = e->hitFeature;
+		return e->hitDist;
+	}
+
+	const float hitDist = GuiTraceRayImpl(start, dir, length, exclude, hitUnit, hitFeature, useRadar, groundOnly, ignoreWater);
+
+	guiTraceRayCache.Insert({start, dir, length, exclude, hitUnit, hitFeature, hitDist, useRadar, groundOnly, ignoreWater});
+	return hitDist;
+}
+
 
 bool TestCone(
 	const float3& from,
@@ -535,6 +660,7 @@ bool TestCone(
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
 	quadField.GetQuadsOnRay(qfQuery, from, dir, length);
 
 	if (qfQuery.quads->empty())
@@ -544,23 +670,38 @@ bool TestCone(
 	const bool scanForNeutrals = ((traceFlags & Collision::NONEUTRALS  ) == 0);
 	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
 
+	// each object only needs to be tested once, however many quads it spans
+	const int threadNum = ThreadPool::GetThreadNum();
+	const int tempNum = gs->GetMtTempNum(threadNum);
+
+	const auto FirstVisit = [&](CSolidObject* o) {
+		if (o->mtTempNum[threadNum] == tempNum)
+			return false;
+
+		o->mtTempNum[threadNum] = tempNum;
+		return true;
+	};
+
 	for (const int quadIdx: *qfQuery.quads) {
 		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
 		if (scanForAllies) {
-			for (const CUnit* u: quad.teamUnits[allyteam]) {
+			for (CUnit* u: quad.teamUnits[allyteam]) {
 				if (u == owner)
 					continue;
 				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 					continue;
 
+				if (!FirstVisit(u))
+					continue;
+
 				if (TestConeHelper(from, dir, length, spread, u))
 					return true;
 			}
 		}
 
 		if (scanForNeutrals) {
-			for (const CUnit* u: quad.units) {
+			for (CUnit* u: quad.units) {
 				if (!u->IsNeutral())
 					continue;
 				if (u == owner)
@@ -568,16 +709,22 @@ bool TestCone(
 				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 					continue;
 
+				if (!FirstVisit(u))
+					continue;
+
 				if (TestConeHelper(from, dir, length, spread, u))
 					return true;
 			}
 		}
 
 		if (scanForFeatures) {
-			for (const CFeature* f: quad.features) {
+			for (CFeature* f: quad.features) {
 				if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 					continue;
 
+				if (!FirstVisit(f))
+					continue;
+
 				if (TestConeHelper(from, dir, length, spread, f))
 					return true;
 			}
@@ -602,6 +749,7 @@ bool TestTrajectoryCone(
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
 	quadField.GetQuadsOnRay(qfQuery, from, dir, length);
 
 	if (qfQuery.quads->empty())
@@ -611,17 +759,32 @@ bool TestTrajectoryCone(
 	const bool scanForNeutrals = ((traceFlags & Collision::NONEUTRALS  ) == 0);
 	const bool scanForFeatures = ((traceFlags & Collision::NOFEATURES  ) == 0);
 
+	// each object only needs to be tested once, however many quads it spans
+	const int threadNum = ThreadPool::GetThreadNum();
+	const int tempNum = gs->GetMtTempNum(threadNum);
+
+	const auto FirstVisit = [&](CSolidObject* o) {
+		if (o->mtTempNum[threadNum] == tempNum)
+			return false;
+
+		o->mtTempNum[threadNum] = tempNum;
+		return true;
+	};
+
 	for (const int quadIdx: *qfQuery.quads) {
 		const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
 		// friendly units in this quad
 		if (scanForAllies) {
-			for (const CUnit* u: quad.teamUnits[allyteam]) {
+			for (CUnit* u: quad.teamUnits[allyteam]) {
 				if (u == owner)
 					continue;
 				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 					continue;
 
+				if (!FirstVisit(u))
+					continue;
+
 				if (TestTrajectoryConeHelper(from, dir, length, linear, quadratic, spread, 0.0f, u))
 					return true;
 
@@ -630,7 +793,7 @@ bool TestTrajectoryCone(
 
 		// neutral units in this quad
 		if (scanForNeutrals) {
-			for (const CUnit* u: quad.units) {
+			for (CUnit* u: quad.units) {
 				if (!u->IsNeutral())
 					continue;
 				if (u == owner)
@@ -638,6 +801,9 @@ bool TestTrajectoryCone(
 				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 					continue;
 
+				if (!FirstVisit(u))
+					continue;
+
 				if (TestTrajectoryConeHelper(from, dir, length, linear, quadratic, spread, 0.0f, u))
 					return true;
 			}
@@ -645,10 +811,13 @@ bool TestTrajectoryCone(
 
 		// features in this quad
 		if (scanForFeatures) {
-			for (const CFeature* f: quad.features) {
+			for (CFeature* f: quad.features) {
 				if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 					continue;
 
+				if (!FirstVisit(f))
+					continue;
+
 				if (TestTrajectoryConeHelper(from, dir, length, linear, quadratic, spread, 0.0f, f))
 					return true;
 			}
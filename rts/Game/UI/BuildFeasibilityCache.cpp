@@ -0,0 +1,123 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#include "BuildFeasibilityCache.h"
+
+#include <algorithm>
+
+#include "Game/GlobalUnsynced.h"
+#include "Map/ReadMap.h"
+#include "Sim/Features/Feature.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Units/BuildInfo.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
+#include "System/EventHandler.h"
+#include "System/Rectangle.h"
+
+#include "System/Misc/TracyDefs.h"
+
+// same as CUnitDrawer's build-square cache, mobile objects are only seen when this expires
+static constexpr int CACHE_VALIDITY_PERIOD = GAME_SPEED / 5;
+
+
+CBuildFeasibilityCache::CBuildFeasibilityCache()
+: CEventClient("[CBuildFeasibilityCache]", 314160, false)
+{
+	eventHandler.AddClient(this);
+}
+
+CBuildFeasibilityCache::~CBuildFeasibilityCache()
+{
+	eventHandler.RemoveClient(this);
+}
+
+
+CGameHelper::BuildSquareStatus CBuildFeasibilityCache::Test(const BuildInfo& buildInfo, int allyTeam_)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	CFeature* feature = nullptr;
+
+	if (buildInfo.def->id != unitDefID || buildInfo.buildFacing != buildFacing || allyTeam_ != allyTeam) {
+		Clear();
+
+		unitDefID = buildInfo.def->id;
+		buildFacing = buildInfo.buildFacing;
+		allyTeam = allyTeam_;
+		xsize = buildInfo.GetXSize();
+		zsize = buildInfo.GetZSize();
+	}
+
+	if (cells.empty()) {
+		cellsX = mapDims.mapx / BUILD_GRID_RESOLUTION + 1;
+		cellsZ = mapDims.mapy / BUILD_GRID_RESOLUTION + 1;
+		cells.resize(cellsX * cellsZ);
+	}
+
+	const int cx = static_cast<int>(buildInfo.pos.x / BUILD_SQUARE_SIZE);
+	const int cz = static_cast<int>(buildInfo.pos.z / BUILD_SQUARE_SIZE);
+
+	if (buildInfo.pos.x < 0.0f || buildInfo.pos.z < 0.0f || cx >= cellsX || cz >= cellsZ)
+		return CGameHelper::TestUnitBuildSquare(buildInfo, feature, allyTeam, false);
+
+	Cell& cell = cells[cz * cellsX + cx];
+
+	// positions are normally snapped to the build grid, anything else bypasses the cache
+	const bool posMatch = (cell.x == buildInfo.pos.x && cell.z == buildInfo.pos.z);
+	const bool ageMatch = (cell.frame >= 0 && (gs->frameNum - cell.frame) < CACHE_VALIDITY_PERIOD);
+
+	if (posMatch && ageMatch)
+		return cell.status;
+
+	cell.x = buildInfo.pos.x;
+	cell.z = buildInfo.pos.z;
+	cell.frame = gs->frameNum;
+	cell.status = CGameHelper::TestUnitBuildSquare(buildInfo, feature, allyTeam, false);
+
+	return cell.status;
+}
+
+void CBuildFeasibilityCache::Clear()
+{
+	for (Cell& cell: cells) {
+		cell.frame = -1;
+	}
+}
+
+
+void CBuildFeasibilityCache::InvalidateSquares(int x1, int z1, int x2, int z2)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (cells.empty() || unitDefID < 0)
+		return;
+
+	// every footprint center whose footprint (plus the slope samples around it) overlaps the change
+	const int cx1 = std::max((x1 - xsize / 2 - 1) / BUILD_GRID_RESOLUTION, 0);
+	const int cz1 = std::max((z1 - zsize / 2 - 1) / BUILD_GRID_RESOLUTION, 0);
+	const int cx2 = std::min((x2 + xsize / 2 + 1) / BUILD_GRID_RESOLUTION, cellsX - 1);
+	const int cz2 = std::min((z2 + zsize / 2 + 1) / BUILD_GRID_RESOLUTION, cellsZ - 1);
+
+	for (int cz = cz1; cz <= cz2; cz++) {
+		for (int cx = cx1; cx <= cx2; cx++) {
+			cells[cz * cellsX + cx].frame = -1;
+		}
+	}
+}
+
+void CBuildFeasibilityCache::InvalidateObject(const CSolidObject* object)
+{
+	const int2 mapPos = object->mapPos;
+
+	InvalidateSquares(mapPos.x, mapPos.y, mapPos.x + object->xsize - 1, mapPos.y + object->zsize - 1);
+}
+
+
+void CBuildFeasibilityCache::UnsyncedHeightMapUpdate(const SRectangle& rect)
+{
+	InvalidateSquares(rect.x1, rect.z1, rect.x2, rect.z2);
+}
+
+void CBuildFeasibilityCache::UnitCreated(const CUnit* unit, const CUnit* builder) { InvalidateObject(unit); }
+void CBuildFeasibilityCache::UnitDestroyed(const CUnit* unit, const CUnit* attacker, int weaponDefID) { InvalidateObject(unit); }
+void CBuildFeasibilityCache::FeatureCreated(const CFeature* feature) { InvalidateObject(feature); }
+void CBuildFeasibilityCache::FeatureDestroyed(const CFeature* feature) { InvalidateObject(feature); }
@@ -0,0 +1,78 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef BUILD_FEASIBILITY_CACHE_H
+#define BUILD_FEASIBILITY_CACHE_H
+
+#include <vector>
+
+#include "Game/GameHelper.h"
+#include "System/EventClient.h"
+
+struct BuildInfo;
+class CSolidObject;
+
+/**
+ * Unsynced TestUnitBuildSquare verdicts for build previews, one per build-grid
+ * position of the footprint class being placed (UnitDef, facing and allyteam).
+ * Line, box and grid placement re-test the same positions every frame, which
+ * become lookups until the terrain or a structure under them changes or the
+ * entry ages out; the latter covers moving units and LOS changes.
+ */
+class CBuildFeasibilityCache : public CEventClient
+{
+public:
+	CBuildFeasibilityCache();
+	~CBuildFeasibilityCache() override;
+
+	// CEventClient interface
+	bool WantsEvent(const std::string& eventName) override {
+		return
+			(eventName == "UnsyncedHeightMapUpdate") ||
+			(eventName == "UnitCreated"            ) ||
+			(eventName == "UnitDestroyed"          ) ||
+			(eventName == "FeatureCreated"         ) ||
+			(eventName == "FeatureDestroyed"       );
+	}
+	bool GetFullRead() const override { return true; }
+	int  GetReadAllyTeam() const override { return AllAccessTeam; }
+
+	void UnsyncedHeightMapUpdate(const SRectangle& rect) override;
+	void UnitCreated(const CUnit* unit, const CUnit* builder) override;
+	void UnitDestroyed(const CUnit* unit, const CUnit* attacker, int weaponDefID) override;
+	void FeatureCreated(const CFeature* feature) override;
+	void FeatureDestroyed(const CFeature* feature) override;
+
+public:
+	// same as CGameHelper::TestUnitBuildSquare in unsynced context, without the feature output
+	CGameHelper::BuildSquareStatus Test(const BuildInfo& buildInfo, int allyTeam);
+
+	void Clear();
+
+private:
+	// inclusive, in map squares
+	void InvalidateSquares(int x1, int z1, int x2, int z2);
+	void InvalidateObject(const CSolidObject* object);
+
+private:
+	struct Cell {
+		float x = 0.0f;
+		float z = 0.0f;
+		int frame = -1;
+		CGameHelper::BuildSquareStatus status = CGameHelper::BUILDSQUARE_BLOCKED;
+	};
+
+	// indexed by build-grid position of the footprint center
+	std::vector<Cell> cells;
+
+	int cellsX = 0;
+	int cellsZ = 0;
+
+	// footprint class the cells belong to
+	int unitDefID = -1;
+	int buildFacing = -1;
+	int allyTeam = -1;
+	int xsize = 0;
+	int zsize = 0;
+};
+
+#endif // BUILD_FEASIBILITY_CACHE_H
@@ -195,6 +195,8 @@ bool CCommandColors::LoadConfigFromString(const std::string& cfg)
 	RECOIL_DETAILED_TRACY_ZONE;
 	CSimpleParser parser(cfg);
 
+	configVersion++;
+
 	while (true) {
 		const std::string line = parser.GetCleanLine();
 
@@ -40,6 +40,9 @@ public:
 
 	float        UnitBoxLineWidth()  const { return unitBoxLineWidth;  }
 
+	/// bumped whenever the config or the custom command data change
+	unsigned int ConfigVersion()     const { return configVersion;     }
+
 	// custom command queue rendering
 	struct DrawData {
 		int cmdIconID = 0;
@@ -57,8 +60,8 @@ public:
 		}
 	};
 
-	void SetCustomCmdData(int cmdID, int cmdIconID, const float color[4], bool showArea) { customCmds[cmdID] = DrawData(cmdIconID, color, showArea); }
-	void ClearCustomCmdData(int cmdID) { customCmds.erase(cmdID); }
+	void SetCustomCmdData(int cmdID, int cmdIconID, const float color[4], bool showArea) { customCmds[cmdID] = DrawData(cmdIconID, color, showArea); ++configVersion; }
+	void ClearCustomCmdData(int cmdID) { customCmds.erase(cmdID); ++configVersion; }
 
 	/// get custom command line parameters
 	/// @return NULL if no line defined, a pointer to a DrawData otherwise
@@ -191,6 +194,8 @@ private:
 	unsigned int mouseBoxBlendSrc;
 	unsigned int mouseBoxBlendDst;
 
+	unsigned int configVersion = 0;
+
 	spring::unordered_map<std::string, int> colorNames;
 	spring::unordered_map<int, DrawData> customCmds;
 };
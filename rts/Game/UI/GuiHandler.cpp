@@ -1108,9 +1108,7 @@ void CGuiHandler::SetCursorIcon() const
 			bi.pos = CGameHelper::Pos2BuildPos(bi, false);
 			// if an unit (enemy), is not in LOS, then TestUnitBuildSquare()
 			// does not consider it when checking for position blocking
-			CFeature* feature = nullptr;
-
-			if (!CGameHelper::TestUnitBuildSquare(bi, feature, gu->myAllyTeam, false)) {
+			if (!buildFeasibilityCache.Test(bi, gu->myAllyTeam)) {
 				newCursor = "BuildBad";
 			} else {
 				newCursor = "BuildGood";
@@ -2252,10 +2250,8 @@ Command CGuiHandler::GetCommand(int mouseX, int mouseY, int buttonHint, bool pre
 				return Command(CMD_STOP);
 
 			if (buildInfos.size() == 1) {
-				CFeature* feature = nullptr;
-
 				// TODO: maybe also check out-of-range for immobile builder?
-				if (!CGameHelper::TestUnitBuildSquare(buildInfos[0], feature, gu->myAllyTeam, false))
+				if (!buildFeasibilityCache.Test(buildInfos[0], gu->myAllyTeam))
 					return defaultRet;
 
 			}
@@ -5,6 +5,7 @@
 
 #include <vector>
 
+#include "BuildFeasibilityCache.h"
 #include "KeySet.h"
 #include "InputReceiver.h"
 #include "MouseHandler.h"
@@ -262,6 +263,8 @@ private:
 
 	// DrawMapStuff caches
 	std::vector<BuildInfo> buildInfos;
+	// also used by const queries like the cursor update
+	mutable CBuildFeasibilityCache buildFeasibilityCache;
 	std::vector<Command> buildCommands;
 
 public:
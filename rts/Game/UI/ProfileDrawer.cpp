@@ -1,13 +1,19 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <deque>
+#include <numeric>
+#include <vector>
 
 #include "ProfileDrawer.h"
 #include "InputReceiver.h"
 #include "Game/GlobalUnsynced.h"
 #include "Lua/LuaAllocState.h"
+#include "Lua/LuaCallInProfiler.h"
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/StateCache.h"
 #include "Rendering/Fonts/glFont.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GlobalRenderingInfo.h"
@@ -21,6 +27,7 @@
 #include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Weapons/WeaponMemPool.h"
 #include "System/EventHandler.h"
+#include "System/Misc/AllocCounter.h"
 #include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/SafeUtil.h"
@@ -31,6 +38,7 @@
 ProfileDrawer* ProfileDrawer::instance = nullptr;
 
 static constexpr float MAX_FRAMES_HIST_TIME = 0.5f; // secs
+static constexpr float WORKER_LOAD_INTERVAL = 0.5f; // secs
 
 static constexpr float  MIN_X_COOR = 0.6f;
 static constexpr float  MAX_X_COOR = 0.99f;
@@ -46,6 +54,15 @@ static std::deque<TimeSlice> lgcFrames;
 static std::deque<TimeSlice> swpFrames;
 static std::deque<TimeSlice> uusFrames;
 
+// fraction of each interval a pool thread spent running {sync, async} tasks
+struct WorkerLoad {
+	uint64_t busyTimes[2] = {0, 0};
+	float loads[2] = {0.0f, 0.0f};
+};
+
+static std::array<WorkerLoad, ThreadPool::MAX_THREADS> workerLoads;
+static spring_time workerLoadTime;
+
 
 ProfileDrawer::ProfileDrawer()
 : CEventClient("[ProfileDrawer]", 199991, false)
@@ -58,6 +75,9 @@ ProfileDrawer::ProfileDrawer()
 void ProfileDrawer::SetEnabled(bool enable)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// the drawer shows the Lua callin profile, which is only collected while enabled
+	LuaCallInProfiler::SetEnabled(enable, LuaCallInProfiler::GetSampleInstrCount());
+
 	if (!enable) {
 		spring::SafeDelete(instance);
 		return;
@@ -136,6 +156,109 @@ static void DrawBufferStats(const float2 pos)
 	}
 }
 
+static void DrawLuaCallInProfile(const float2 pos)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	constexpr size_t MAX_ENTRIES = 12;
+
+	static std::vector<LuaCallInProfiler::ProfileEntry> profiles;
+	LuaCallInProfiler::CollectProfiles(profiles);
+
+	const float4 drawArea = {pos.x, pos.y + 0.02f, MIN_X_COOR - 0.05f, pos.y - (0.02f * MAX_ENTRIES + 0.02f)};
+
+	auto& rb = RenderBuffer::GetTypedRenderBuffer<VA_TYPE_C>();
+
+	// background
+	constexpr SColor bgColor = SColor{ 0.0f, 0.0f, 0.0f, 0.5f };
+	rb.AddVertex({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TL
+	rb.AddVertex({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BL
+	rb.AddVertex({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BR
+
+	rb.AddVertex({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BR
+	rb.AddVertex({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TR
+	rb.AddVertex({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TL
+	rb.Submit(GL_TRIANGLES);
+
+	const float profTime = std::max(LuaCallInProfiler::GetProfiledTime(), 0.001f);
+
+	font->SetTextColor(1.0f, 1.0f, 0.5f, 0.8f);
+	font->glFormat(pos.x, pos.y - 0.005f, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\tLUA CALLINS (%.0fs, per second)", profTime);
+
+	for (size_t i = 0, n = std::min(profiles.size(), MAX_ENTRIES); i < n; i++) {
+		const auto& p = profiles[i];
+
+		font->glFormat(pos.x, pos.y - (0.025f + 0.02f * i), 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\t%s::%s %s={%.2fms, %.1fKB}",
+			p.handleName, p.callInName, p.sourceName,
+			(p.stats.timeNs * 1e-6f) / profTime,
+			(p.stats.allocBytes / 1024.0f) / profTime
+		);
+	}
+}
+
+static void DrawAllocStats(const float2 pos)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	constexpr size_t MAX_ENTRIES = 5;
+
+	// only built with ALLOCATION_COUNTING
+	if (!CAllocCounter::IsEnabled())
+		return;
+
+	static std::vector<uint32_t> tags;
+
+	tags.resize(CAllocCounter::GetNumTags());
+	std::iota(tags.begin(), tags.end(), 0);
+	std::sort(tags.begin(), tags.end(), [](uint32_t a, uint32_t b) {
+		const auto& sa = CAllocCounter::GetFrameStats(a);
+		const auto& sb = CAllocCounter::GetFrameStats(b);
+		return ((sa.numAllocs + sa.numLuaAllocs) > (sb.numAllocs + sb.numLuaAllocs));
+	});
+
+	CAllocCounter::Stats total;
+
+	for (const uint32_t tag: tags) {
+		const auto& s = CAllocCounter::GetFrameStats(tag);
+
+		total.numAllocs += s.numAllocs;
+		total.numBytes += s.numBytes;
+		total.numLuaAllocs += s.numLuaAllocs;
+		total.numLuaBytes += s.numLuaBytes;
+	}
+
+	const float4 drawArea = {pos.x, pos.y + 0.02f, MIN_X_COOR - 0.05f, pos.y - (0.02f * MAX_ENTRIES + 0.02f)};
+
+	auto& rb = RenderBuffer::GetTypedRenderBuffer<VA_TYPE_C>();
+
+	// background
+	constexpr SColor bgColor = SColor{ 0.0f, 0.0f, 0.0f, 0.5f };
+	rb.AddVertex({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TL
+	rb.AddVertex({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BL
+	rb.AddVertex({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BR
+
+	rb.AddVertex({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // BR
+	rb.AddVertex({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TR
+	rb.AddVertex({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, bgColor }); // TL
+	rb.Submit(GL_TRIANGLES);
+
+	static constexpr const char* FMT = "\t%s={heap=%u (%.1fKB), lua=%u (%.1fKB)}";
+
+	font->SetTextColor(1.0f, 1.0f, 0.5f, 0.8f);
+	font->glFormat(pos.x, pos.y - 0.005f, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, FMT, "ALLOCS PER FRAME",
+		uint32_t(total.numAllocs), total.numBytes / 1024.0f,
+		uint32_t(total.numLuaAllocs), total.numLuaBytes / 1024.0f
+	);
+
+	for (size_t i = 0, n = std::min(tags.size(), MAX_ENTRIES - 1); i < n; i++) {
+		const auto& s = CAllocCounter::GetFrameStats(tags[i]);
+
+		font->glFormat(pos.x, pos.y - (0.025f + 0.02f * i), 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, FMT,
+			CAllocCounter::GetTagName(tags[i]),
+			uint32_t(s.numAllocs), s.numBytes / 1024.0f,
+			uint32_t(s.numLuaAllocs), s.numLuaBytes / 1024.0f
+		);
+	}
+}
+
 static void DrawTimeSlices(
 	std::deque<TimeSlice>& frames,
 	const spring_time maxTime,
@@ -184,6 +307,67 @@ static void DrawTimeSlices(
 }
 
 
+static void UpdateWorkerLoads(size_t numThreads, float avgLoads[2])
+{
+	const spring_time curTime = spring_now();
+	const float dt = (curTime - workerLoadTime).toSecsf();
+
+	if (dt >= WORKER_LOAD_INTERVAL) {
+		for (size_t i = 0; i < numThreads; i++) {
+			for (const bool async: {false, true}) {
+				const uint64_t busyTime = ThreadPool::GetWorkerBusyTime(i, async);
+
+				// tasks are only accounted for once finished, long ones can exceed an interval
+				workerLoads[i].loads[async] = std::clamp((busyTime - workerLoads[i].busyTimes[async]) * 1e-9f / dt, 0.0f, 1.0f);
+				workerLoads[i].busyTimes[async] = busyTime;
+			}
+		}
+
+		workerLoadTime = curTime;
+	}
+
+	avgLoads[0] = 0.0f;
+	avgLoads[1] = 0.0f;
+
+	// main thread only ever runs sync tasks inline, not counted
+	for (size_t i = 1; i < numThreads; i++) {
+		avgLoads[0] += workerLoads[i].loads[0] / (numThreads - 1);
+		avgLoads[1] += workerLoads[i].loads[1] / (numThreads - 1);
+	}
+
+	TracyPlot("ThreadPool::SyncLoad", avgLoads[0] * 100.0f);
+	TracyPlot("ThreadPool::AsyncLoad", avgLoads[1] * 100.0f);
+}
+
+static void DrawWorkerLoad(const WorkerLoad& wl, const float drawArea[4])
+{
+	auto& rb = RenderBuffer::GetTypedRenderBuffer<VA_TYPE_C>();
+
+	constexpr SColor loadColors[2] = {SColor{1.0f, 0.0f, 0.0f, 0.6f}, SColor{0.0f, 0.5f, 1.0f, 0.6f}};
+
+	const float ym = (drawArea[1] + drawArea[3]) * 0.5f;
+	const float ys[3] = {drawArea[1], ym, drawArea[3]};
+
+	// sync load in the lower half, async in the upper
+	for (const bool async: {false, true}) {
+		const float x1 = drawArea[0];
+		const float x2 = drawArea[0] + (drawArea[2] - drawArea[0]) * wl.loads[async];
+		const float y1 = ys[async    ];
+		const float y2 = ys[async + 1];
+
+		if (x2 <= x1)
+			continue;
+
+		rb.AddVertex({{x1, y1, 0.0f}, loadColors[async]}); // bl
+		rb.AddVertex({{x1, y2, 0.0f}, loadColors[async]}); // tl
+		rb.AddVertex({{x2, y2, 0.0f}, loadColors[async]}); // tr
+
+		rb.AddVertex({{x2, y2, 0.0f}, loadColors[async]}); // tr
+		rb.AddVertex({{x2, y1, 0.0f}, loadColors[async]}); // br
+		rb.AddVertex({{x1, y1, 0.0f}, loadColors[async]}); // bl
+	}
+}
+
 static void DrawThreadBarcode(TypedRenderBuffer<VA_TYPE_C   >& rb)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -192,12 +376,18 @@ static void DrawThreadBarcode(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	constexpr SColor feederColor = SColor{1.0f, 0.0f, 0.0f, 1.0f};
 
 	const float drawArea[4] = {0.01f, 0.30f, (MIN_X_COOR * 0.5f), 0.35f};
+	// per-thread load bars go to the right of the time slices
+	const float loadArea[2] = {drawArea[2] - 0.025f, drawArea[2]};
+	const float sliceArea[4] = {drawArea[0], drawArea[1], loadArea[0] - 10.0f * globalRendering->pixelX, drawArea[3]};
 
 	const spring_time curTime = spring_now();
 	const spring_time maxTime = spring_secs(MAX_THREAD_HIST_TIME);
 
 	const size_t numThreads = std::min(profiler.GetNumThreadProfiles(), (size_t)ThreadPool::GetNumThreads());
 
+	float avgLoads[2];
+	UpdateWorkerLoads(numThreads, avgLoads);
+
 	{
 		// background
 		rb.AddVertex({{drawArea[0] - 10.0f * globalRendering->pixelX, drawArea[1] - 10.0f * globalRendering->pixelY, 0.0f}, barColor}); // tl
@@ -210,7 +400,7 @@ static void DrawThreadBarcode(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	}
 	{
 		// title
-		font->glFormat(drawArea[0], drawArea[3], 0.7f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "ThreadPool (%.1f seconds :: %u threads)", MAX_THREAD_HIST_TIME, numThreads);
+		font->glFormat(drawArea[0], drawArea[3], 0.7f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "ThreadPool (%.1f seconds :: %u threads :: %.0f%% sync / %.0f%% async load)", MAX_THREAD_HIST_TIME, numThreads, avgLoads[0] * 100.0f, avgLoads[1] * 100.0f);
 	}
 	{
 		// Need to lock; CleanupOldThreadProfiles pop_front()'s old entries
@@ -224,10 +414,13 @@ static void DrawThreadBarcode(TypedRenderBuffer<VA_TYPE_C   >& rb)
 		size_t numRows = numThreads + 1;
 		for (auto& threadProf: profiler.GetThreadProfiles()) {
 			if (i >= numThreads) break;
-			float drawArea2[4] = {drawArea[0], 0.0f, drawArea[2], 0.0f};
+			float drawArea2[4] = {sliceArea[0], 0.0f, sliceArea[2], 0.0f};
 			drawArea2[1] = drawArea[1] + ((drawArea[3] - drawArea[1]) / numRows) * i++;
 			drawArea2[3] = drawArea[1] + ((drawArea[3] - drawArea[1]) / numRows) * i - (4 * globalRendering->pixelY);
 			DrawTimeSlices(threadProf, maxTime, drawArea2, {1.0f, 0.0f, 0.0f, 0.6f});
+
+			const float drawArea3[4] = {loadArea[0], drawArea2[1], loadArea[1], drawArea2[3]};
+			DrawWorkerLoad(workerLoads[i - 1], drawArea3);
 		}
 
 		profiler.ToggleLock(false);
@@ -235,7 +428,7 @@ static void DrawThreadBarcode(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	{
 		// feeder
 		const float r = (curTime % maxTime).toSecsf() / MAX_THREAD_HIST_TIME;
-		const float xf = drawArea[0] + r * (drawArea[2] - drawArea[0]);
+		const float xf = sliceArea[0] + r * (sliceArea[2] - sliceArea[0]);
 
 		rb.AddVertex({{xf                                 , drawArea[1], 0.0f}, feederColor}); // tl
 		rb.AddVertex({{xf                                 , drawArea[3], 0.0f}, feederColor}); // bl
@@ -467,10 +660,10 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	// background
 
 	rb.AddVertex({{             0.01f - 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, bgColor}); // tl
-	rb.AddVertex({{             0.01f - 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // bl
-	rb.AddVertex({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
+	rb.AddVertex({{             0.01f - 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // bl
+	rb.AddVertex({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
 
-	rb.AddVertex({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.17f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
+	rb.AddVertex({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.19f + 20.0f * globalRendering->pixelY, 0.0f}, bgColor}); // br
 	rb.AddVertex({{MIN_X_COOR - 0.05f + 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, bgColor}); // tr
 	rb.AddVertex({{             0.01f - 10.0f * globalRendering->pixelX, 0.02f - 10.0f * globalRendering->pixelY, 0.0f}, bgColor}); // tl
 
@@ -487,6 +680,7 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	constexpr const char* luaFmtStr = "[7] Lua-allocated memory: %.1fMB (%.1fK allocs : %.5u usecs : %.1u states)";
 	constexpr const char* gpuFmtStr = "[8] GPU-allocated memory: %.1fMB / %.1fMB";
 	constexpr const char* sopFmtStr = "[9] SOP-allocated memory: {U,F,P,W}={%.1f/%.1f, %.1f/%.1f, %.1f/%.1f, %.1f/%.1f}KB";
+	constexpr const char* glsFmtStr = "[10] GL-state changes: {Issued,Elided}={%u, %u} (%s)";
 
 	const CProjectileHandler* ph = &projectileHandler;
 	const IPathManager* pm = pathManager;
@@ -524,7 +718,7 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 	}
 
 	{
-		SLuaAllocState state = {{0}, {0}, {0}, {0}};
+		SLuaAllocState state = {{0}, {0}, {0}, {0}, {0}};
 		spring_lua_alloc_get_stats(&state);
 
 		const    float allocMegs = state.allocedBytes.load() / 1024.0f / 1024.0f;
@@ -553,6 +747,12 @@ static void DrawInfoText(TypedRenderBuffer<VA_TYPE_C   >& rb)
 		weaponMemPool.alloc_size() / 1024.0f,
 		weaponMemPool.freed_size() / 1024.0f
 	);
+
+	{
+		const auto& glsStats = GL::StateCache::GetFrameStats();
+
+		font->glFormat(0.01f, 0.20f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, glsFmtStr, glsStats.issued, glsStats.elided, GL::StateCache::IsInstalled() ? "cached" : "off");
+	}
 }
 
 
@@ -577,6 +777,8 @@ void ProfileDrawer::DrawScreen()
 	DrawInfoText(rb);
 	DrawProfiler(rb);
 	DrawBufferStats({0.01f, 0.605f});
+	DrawLuaCallInProfile({0.25f, 0.605f});
+	DrawAllocStats({0.25f, 0.34f});
 
 	shader.Disable();
 
@@ -0,0 +1,343 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "UnitStateExporter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <string>
+
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
+#include "System/Misc/TracyDefs.h"
+
+CONFIG(int, UnitStateExportInterval).defaultValue(0).minimumValue(0).description("Write unit positions and health every N sim-frames to UnitStateExportFile (see Game/UnitStateExporter.h for the format), 0 disables.");
+CONFIG(std::string, UnitStateExportFile).defaultValue("unitstates.bin").description("File written by UnitStateExportInterval.");
+
+// frames waiting to be encoded; past this the exporter drops samples rather than stall the sim
+static constexpr size_t MAX_QUEUED_FRAMES = 64;
+
+CUnitStateExporter unitStateExporter;
+
+
+class CUnitStateWriter
+{
+public:
+	typedef CUnitStateExporter::UnitSample UnitSample;
+
+	~CUnitStateWriter() {
+		assert(!thread.joinable());
+
+		if (file != nullptr)
+			fclose(file);
+	}
+
+	bool Open(const std::string& filePath, std::uint32_t interval, unsigned int maxUnits) {
+		if ((file = fopen(filePath.c_str(), "wb")) == nullptr)
+			return false;
+
+		lastStates.resize(maxUnits);
+
+		fwrite(CUnitStateExporter::MAGIC, sizeof(CUnitStateExporter::MAGIC) - 1, 1, file);
+		fwrite(&CUnitStateExporter::VERSION, sizeof(CUnitStateExporter::VERSION), 1, file);
+		fwrite(&interval, sizeof(interval), 1, file);
+		fflush(file);
+		return true;
+	}
+
+	void Start(const std::shared_ptr<CUnitStateWriter>& self) {
+		thread = spring::thread([self]() { self->Run(); });
+	}
+
+	std::vector<UnitSample> GetBuffer() {
+		std::lock_guard<spring::mutex> lock(jobMutex);
+
+		if (freeBuffers.empty())
+			return {};
+
+		std::vector<UnitSample> buffer = std::move(freeBuffers.back());
+		freeBuffers.pop_back();
+		buffer.clear();
+		return buffer;
+	}
+
+	// returns false (and keeps nothing) if the writer is too far behind
+	bool Push(int frameNum, std::vector<UnitSample>&& samples) {
+		{
+			std::lock_guard<spring::mutex> lock(jobMutex);
+
+			if (jobs.size() >= MAX_QUEUED_FRAMES)
+				return false;
+
+			jobs.push_back({frameNum, std::move(samples)});
+		}
+
+		jobCond.notify_one();
+		return true;
+	}
+
+	void Finish() {
+		{
+			std::lock_guard<spring::mutex> lock(jobMutex);
+			finished = true;
+		}
+
+		jobCond.notify_one();
+	}
+
+	spring::thread&& GetThread() { return std::move(thread); }
+
+private:
+	struct Job {
+		int frameNum;
+		std::vector<UnitSample> samples;
+	};
+
+	// quantized values as last written, deltas are taken against these
+	struct UnitState {
+		int unitDefID;
+		int team;
+		int x, y, z;
+		int heading;
+		int health;
+		int maxHealth;
+		bool alive;
+	};
+
+	void Run() {
+		Threading::SetThreadName("unitexport");
+
+		while (true) {
+			Job job;
+
+			{
+				std::unique_lock<spring::mutex> lock(jobMutex);
+
+				jobCond.wait(lock, [&]() { return (!jobs.empty() || finished); });
+
+				if (jobs.empty())
+					break;
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			EncodeFrame(job.frameNum, job.samples);
+
+			if (fwrite(block.data(), block.size(), 1, file) != 1 || fflush(file) != 0)
+				LOG_L(L_ERROR, "[UnitStateExporter] error writing frame %d", job.frameNum);
+
+			{
+				std::lock_guard<spring::mutex> lock(jobMutex);
+
+				if (freeBuffers.size() < 4)
+					freeBuffers.push_back(std::move(job.samples));
+			}
+		}
+
+		fclose(file);
+		file = nullptr;
+	}
+
+	void EncodeFrame(int frameNum, std::vector<UnitSample>& samples) {
+		std::sort(samples.begin(), samples.end(), [](const UnitSample& a, const UnitSample& b) { return (a.id < b.id); });
+
+		block.clear();
+		changed.clear();
+		currIDs.clear();
+
+		PutVarInt(frameNum);
+
+		for (const UnitSample& s: samples) {
+			currIDs.push_back(s.id);
+		}
+
+		// units that were written before but are no longer there; both lists are sorted
+		{
+			removed.clear();
+			std::set_difference(prevIDs.begin(), prevIDs.end(), currIDs.begin(), currIDs.end(), std::back_inserter(removed));
+
+			PutVarInt(removed.size());
+
+			for (size_t i = 0; i < removed.size(); i++) {
+				PutVarInt(removed[i] - ((i > 0)? removed[i - 1]: 0));
+				lastStates[removed[i]].alive = false;
+			}
+		}
+
+		for (const UnitSample& s: samples) {
+			UnitState& last = lastStates[s.id];
+			UnitState curr;
+
+			curr.unitDefID = s.unitDefID;
+			curr.team = s.team;
+			curr.x = Quantize(s.pos.x, 8.0f);
+			curr.y = Quantize(s.pos.y, 8.0f);
+			curr.z = Quantize(s.pos.z, 8.0f);
+			curr.heading = s.heading;
+			curr.health = Quantize(s.health, 16.0f);
+			curr.maxHealth = Quantize(s.maxHealth, 16.0f);
+			curr.alive = true;
+
+			// an ID taken over by another unit between two samples shows up as a changed
+			// type or team, which is written out as a new unit as well (as is a capture)
+			if (!last.alive || last.unitDefID != curr.unitDefID || last.team != curr.team)
+				last = {};
+
+			std::uint8_t mask = 0;
+
+			mask |= (CUnitStateExporter::FIELD_NEW       * (!last.alive));
+			mask |= (CUnitStateExporter::FIELD_POS       * (curr.x != last.x || curr.y != last.y || curr.z != last.z));
+			mask |= (CUnitStateExporter::FIELD_HEADING   * (curr.heading != last.heading));
+			mask |= (CUnitStateExporter::FIELD_HEALTH    * (curr.health != last.health));
+			mask |= (CUnitStateExporter::FIELD_MAXHEALTH * (curr.maxHealth != last.maxHealth));
+
+			if (mask != 0)
+				changed.push_back({&s, curr, mask});
+		}
+
+		PutVarInt(changed.size());
+
+		for (size_t i = 0; i < changed.size(); i++) {
+			const ChangedUnit& c = changed[i];
+			UnitState& last = lastStates[c.sample->id];
+
+			PutVarInt(c.sample->id - ((i > 0)? changed[i - 1].sample->id: 0));
+			block.push_back(c.mask);
+
+			if (c.mask & CUnitStateExporter::FIELD_NEW) {
+				PutVarInt(c.sample->unitDefID);
+				PutVarInt(c.sample->team);
+			}
+			if (c.mask & CUnitStateExporter::FIELD_POS) {
+				PutSignedVarInt(c.state.x - last.x);
+				PutSignedVarInt(c.state.y - last.y);
+				PutSignedVarInt(c.state.z - last.z);
+			}
+			if (c.mask & CUnitStateExporter::FIELD_HEADING)
+				PutSignedVarInt(c.state.heading - last.heading);
+			if (c.mask & CUnitStateExporter::FIELD_HEALTH)
+				PutSignedVarInt(c.state.health - last.health);
+			if (c.mask & CUnitStateExporter::FIELD_MAXHEALTH)
+				PutSignedVarInt(c.state.maxHealth - last.maxHealth);
+
+			last = c.state;
+		}
+
+		prevIDs.swap(currIDs);
+	}
+
+	static int Quantize(float v, float scale) {
+		return static_cast<int>(std::clamp(std::round(v * scale), -2.0e9f, 2.0e9f));
+	}
+
+	void PutVarInt(std::uint64_t v) {
+		while (v >= 0x80) {
+			block.push_back(static_cast<std::uint8_t>(v | 0x80));
+			v >>= 7;
+		}
+
+		block.push_back(static_cast<std::uint8_t>(v));
+	}
+
+	void PutSignedVarInt(std::int64_t v) {
+		PutVarInt((static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+	}
+
+private:
+	struct ChangedUnit {
+		const UnitSample* sample;
+		UnitState state;
+		std::uint8_t mask;
+	};
+
+	FILE* file = nullptr;
+
+	spring::thread thread;
+	spring::mutex jobMutex;
+	spring::condition_variable jobCond;
+
+	std::deque<Job> jobs;
+	std::vector< std::vector<UnitSample> > freeBuffers;
+
+	bool finished = false;
+
+	// encoder state, only touched by the writer thread
+	std::vector<UnitState> lastStates;
+	std::vector<ChangedUnit> changed;
+	std::vector<int> prevIDs;
+	std::vector<int> currIDs;
+	std::vector<int> removed;
+	std::vector<std::uint8_t> block;
+};
+
+
+
+void CUnitStateExporter::Init()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if ((interval = configHandler->GetInt("UnitStateExportInterval")) <= 0)
+		return;
+
+	const std::string fileName = configHandler->GetString("UnitStateExportFile");
+	const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+
+	writer = std::make_shared<CUnitStateWriter>();
+
+	if (!writer->Open(filePath, interval, unitHandler.MaxUnits())) {
+		LOG_L(L_ERROR, "[UnitStateExporter] could not open \"%s\"", filePath.c_str());
+		writer.reset();
+		return;
+	}
+
+	writer->Start(writer);
+	LOG("[UnitStateExporter] writing unit states every %d frames to \"%s\"", interval, filePath.c_str());
+}
+
+void CUnitStateExporter::Kill()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (writer == nullptr)
+		return;
+
+	// the remaining frames are written in the background
+	writer->Finish();
+	ThreadPool::AddExtJob(writer->GetThread());
+	writer.reset();
+}
+
+void CUnitStateExporter::Update()
+{
+	if (writer == nullptr)
+		return;
+	if ((gs->frameNum % interval) != 0)
+		return;
+
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	const std::vector<CUnit*>& activeUnits = unitHandler.GetActiveUnits();
+	std::vector<UnitSample> samples = writer->GetBuffer();
+
+	samples.reserve(activeUnits.size());
+
+	// the hot states are only kept current for us, on export frames
+	unitHandler.UpdateUnitHotStates();
+
+	for (const CUnit* u: activeUnits) {
+		const CUnitHandler::UnitHotState& hs = unitHandler.GetUnitHotState(u->id);
+		samples.push_back({u->id, hs.unitDefID, hs.team, hs.heading, hs.pos, hs.health, hs.maxHealth});
+	}
+
+	if (!writer->Push(gs->frameNum, std::move(samples)))
+		LOG_L(L_WARNING, "[UnitStateExporter] writer is falling behind, frame %d skipped", gs->frameNum);
+}
@@ -0,0 +1,80 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef UNIT_STATE_EXPORTER_H
+#define UNIT_STATE_EXPORTER_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "System/float3.h"
+
+class CUnitStateWriter;
+
+/**
+ * Writes the transform and health of every unit each UnitStateExportInterval
+ * sim-frames to UnitStateExportFile, for external analytics that would
+ * otherwise poll Spring.GetUnit* per unit from a widget. The sim thread only
+ * copies the raw values out of unitHandler; encoding and I/O happen on a
+ * worker thread.
+ *
+ * The file starts with a header:
+ *   char[8] magic ("SPRUNITS"), uint32 version, uint32 interval
+ * followed by one block per sampled frame:
+ *   varint frameNum
+ *   varint numRemoved, then numRemoved unit IDs (each a varint delta to the previous one)
+ *   varint numChanged, then numChanged units, sorted by ID:
+ *     varint ID delta to the previous changed unit, uint8 field mask
+ *     (NEW) varint unitDefID, varint team; also set when the ID changed type or team
+ *     (POS) 3 x svarint x/y/z, in units of 1/8 elmo
+ *     (HEADING) svarint heading
+ *     (HEALTH) svarint health, in units of 1/16
+ *     (MAXHEALTH) svarint maxHealth, in units of 1/16
+ * All svarint fields are zigzag-encoded deltas to the last value written for
+ * that unit (to zero if NEW is set); units whose quantized state did not
+ * change are left out of the block. Varints are LEB128, little-endian.
+ *
+ * Blocks are flushed as they are written, so the file can be tailed live.
+ */
+class CUnitStateExporter
+{
+public:
+	static constexpr char MAGIC[] = "SPRUNITS";
+	static constexpr std::uint32_t VERSION = 1;
+
+	enum FieldMask: std::uint8_t {
+		FIELD_NEW       = 1 << 0,
+		FIELD_POS       = 1 << 1,
+		FIELD_HEADING   = 1 << 2,
+		FIELD_HEALTH    = 1 << 3,
+		FIELD_MAXHEALTH = 1 << 4,
+	};
+
+	// raw per-unit values as copied on the sim thread
+	struct UnitSample {
+		int id;
+		int unitDefID;
+		int team;
+		short heading;
+		float3 pos;
+		float health;
+		float maxHealth;
+	};
+
+	void Init();
+	void Kill();
+
+	// called at the end of every SimFrame
+	void Update();
+
+	bool IsEnabled() const { return (writer != nullptr); }
+
+private:
+	std::shared_ptr<CUnitStateWriter> writer;
+
+	int interval = 0;
+};
+
+extern CUnitStateExporter unitStateExporter;
+
+#endif // UNIT_STATE_EXPORTER_H
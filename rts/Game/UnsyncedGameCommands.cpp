@@ -101,6 +101,7 @@
 #include "System/GlobalConfig.h"
 #include "System/SafeUtil.h"
 #include "System/TimeProfiler.h"
+#include "System/Misc/TracyDefs.h"
 #include "System/Log/ILog.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/SimpleParser.h"
@@ -254,7 +255,7 @@ public:
 
 class MapMeshDrawerActionExecutor : public IUnsyncedActionExecutor {
 public:
-	MapMeshDrawerActionExecutor() : IUnsyncedActionExecutor("mapmeshdrawer", "Switch map-mesh rendering modes: 0=GCM, 1=HLOD, 2=ROAM") {
+	MapMeshDrawerActionExecutor() : IUnsyncedActionExecutor("mapmeshdrawer", "Switch map-mesh rendering modes: 0=GCM, 1=HLOD, 2=ROAM, 3=GeoMip") {
 	}
 
 	bool Execute(const UnsyncedAction& action) const final {
@@ -1158,7 +1159,7 @@ class SpecFullViewActionExecutor : public IUnsyncedActionExecutor {
 public:
 	SpecFullViewActionExecutor() : IUnsyncedActionExecutor(
 		"SpecFullView",
-		"Sets or toggles LOS settings if the local user is a spectator. Fullview: See everything, otherwise visibility is determined by the current team. Fullselect: Whether all units can be selected",
+		"Sets or toggles LOS settings if the local user is a spectator. Fullview: See everything, otherwise visibility is determined by the current team. Fullselect: Whether all units can be selected. Allyteams: Whether a Fullview shows the LOS and radar coverage of all allyteams merged",
 		false, 
 		{
 			{"", "Toggles both Fullview and Fullselect from current values"},
@@ -1166,6 +1167,8 @@ public:
 			{"1", "Fullview, Not Fullselect"},
 			{"2", "Not Fullview, Fullselect"},
 			{"3", "Fullview, Fullselect (default)"},
+			{"5", "Fullview, Allyteams, Not Fullselect"},
+			{"7", "Fullview, Allyteams, Fullselect"},
 		}
 	) {
 	}
@@ -1180,8 +1183,9 @@ public:
 
 		if (!action.GetArgs().empty()) {
 			const int mode = StringToInt(action.GetArgs());
-			gu->spectatingFullView   = !!(mode & 1);
-			gu->spectatingFullSelect = !!(mode & 2);
+			gu->spectatingFullView     = !!(mode & 1);
+			gu->spectatingFullSelect   = !!(mode & 2);
+			gu->spectatingAllAllyTeams = !!(mode & 4);
 		} else {
 			gu->spectatingFullView = !gu->spectatingFullView;
 			gu->spectatingFullSelect = gu->spectatingFullView;
@@ -1786,18 +1790,18 @@ class LuaGarbageCollectControlExecutor: public IUnsyncedActionExecutor {
 public:
 	LuaGarbageCollectControlExecutor() : IUnsyncedActionExecutor(
 		"LuaGCControl",
-		"Toggle between 1/f and 30/s Lua garbage collection rate"
+		"Toggle between 1/f and 30/s Lua garbage collection rate, or pass 2 to collect in the idle time after each draw frame"
 	) {}
 
 	bool Execute(const UnsyncedAction& action) const final {
-		constexpr const char* strs[] = {"1/f", "30/s"};
+		constexpr const char* strs[] = {"1/f", "30/s", "per draw-frame (budgeted)"};
 
 		const std::string& args = action.GetArgs();
 
 		if (!args.empty()) {
-			LOG("Lua garbage collection rate: %s", strs[game->luaGCControl = std::clamp(StringToInt(args), 0, 1)]);
+			LOG("Lua garbage collection rate: %s", strs[game->luaGCControl = std::clamp(StringToInt(args), 0, 2)]);
 		} else {
-			LOG("Lua garbage collection rate: %s", strs[game->luaGCControl = 1 - game->luaGCControl]);
+			LOG("Lua garbage collection rate: %s", strs[game->luaGCControl = (game->luaGCControl == 0)]);
 		}
 
 		return true;
@@ -3869,6 +3873,35 @@ public:
 
 
 
+class TracyZonesActionExecutor : public IUnsyncedActionExecutor {
+public:
+	TracyZonesActionExecutor() : IUnsyncedActionExecutor(
+		"TracyZones",
+		"Set the Tracy zone categories to record (\"all\", \"none\" or a list like \"sim,path,lua\"), prints them without arguments"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final {
+		if (!action.GetArgs().empty()) {
+			Recoil::TracyZones::SetEnabled(Recoil::TracyZones::ParseCategories(action.GetArgs()));
+			configHandler->SetString("TracyZones", action.GetArgs(), true);
+		}
+
+		std::string enabled;
+
+		for (size_t i = 0; i < std::size(Recoil::TracyZones::CATEGORY_NAMES); i++) {
+			if ((Recoil::TracyZones::GetEnabled() & (1u << i)) == 0)
+				continue;
+
+			enabled += (enabled.empty())? "": ",";
+			enabled += Recoil::TracyZones::CATEGORY_NAMES[i];
+		}
+
+		LOG("[TracyZonesAction] enabled categories: %s", (enabled.empty())? "none": enabled.c_str());
+		return true;
+	}
+};
+
 class RedirectToSyncedActionExecutor : public IUnsyncedActionExecutor {
 public:
 	RedirectToSyncedActionExecutor(const std::string& command): IUnsyncedActionExecutor(
@@ -4199,6 +4232,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<ReloadTexturesActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DumpAtlasActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugInfoActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<TracyZonesActionExecutor>());
 
 	// XXX are these redirects really required?
 	AddActionExecutor(AllocActionExecutor<RedirectToSyncedActionExecutor>("ATM"));
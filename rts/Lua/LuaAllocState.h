@@ -15,6 +15,8 @@ struct SLuaAllocState {
 	std::atomic<uint64_t> numLuaAllocs;
 	std::atomic<uint64_t> luaAllocTime;
 	std::atomic<uint64_t> numLuaStates;
+	// running total of bytes requested by growing (re)allocations, never decreases
+	std::atomic<uint64_t> numAllocBytes;
 };
 
 #endif
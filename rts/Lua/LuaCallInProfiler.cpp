@@ -0,0 +1,259 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaCallInProfiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "LuaContextData.h"
+#include "LuaHandle.h"
+#include "LuaAllocState.h"
+#include "lib/lua/include/LuaInclude.h"
+#include "System/StringHash.h"
+#include "System/UnorderedSet.hpp"
+#include "System/Misc/SpringTime.h"
+
+#include "System/Misc/TracyDefs.h"
+
+
+static inline int64_t GetTimeNs() { return spring_gettime().toNanoSecsi(); }
+
+
+void LuaCallInProfiler::SetEnabled(bool enable, int instrCount)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	sampleInstrCount = std::max(instrCount, 1);
+
+	if (enable && !enabled) {
+		// states clear their results lazily, see CheckEpoch
+		globalEpoch += 1;
+		enableTime = GetTimeNs();
+	}
+
+	enabled = enable;
+}
+
+float LuaCallInProfiler::GetProfiledTime()
+{
+	return (enableTime == 0)? 0.0f: (GetTimeNs() - enableTime) * 1e-9f;
+}
+
+void LuaCallInProfiler::CollectProfiles(std::vector<ProfileEntry>& profiles)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// [0] := unsynced, [1] := synced
+	extern const spring::unsynced_set<const luaContextData*>* LUAHANDLE_CONTEXTS[2];
+
+	profiles.clear();
+
+	for (const bool synced: {false, true}) {
+		for (const luaContextData* lcd: *LUAHANDLE_CONTEXTS[synced]) {
+			if (lcd->owner == nullptr)
+				continue;
+
+			const LuaCallInProfiler& profiler = lcd->callInProfiler;
+
+			if (!profiler.IsCurrent())
+				continue;
+
+			for (const auto& [key, stats]: profiler.GetEntries()) {
+				profiles.push_back({
+					lcd->owner->GetName().c_str(),
+					profiler.callIns[GetCallInIndex(key)].name.c_str(),
+					profiler.sources[GetSourceIndex(key)].name.c_str(),
+					synced,
+					stats
+				});
+			}
+		}
+	}
+
+	std::sort(profiles.begin(), profiles.end(), [](const ProfileEntry& a, const ProfileEntry& b) {
+		return (a.stats.timeNs > b.stats.timeNs);
+	});
+}
+
+
+void LuaCallInProfiler::Reset()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(frames.empty());
+
+	callIns.clear();
+	sources.clear();
+	entries.clear();
+
+	callInIndices.clear();
+	sourceIndices.clear();
+
+	sources.push_back({"<handler>", 0});
+	epoch = globalEpoch;
+}
+
+void LuaCallInProfiler::CheckEpoch()
+{
+	// indices are held by running frames, results can only go away in between callins
+	if (IsCurrent())
+		return;
+	if (!frames.empty())
+		return;
+
+	Reset();
+}
+
+
+uint32_t LuaCallInProfiler::GetCallInIdx(const char* name)
+{
+	const uint32_t hash = hashString(name);
+	const auto it = callInIndices.find(hash);
+
+	if (it != callInIndices.end())
+		return it->second;
+
+	callIns.push_back({name, hash});
+	callInIndices[hash] = static_cast<uint32_t>(callIns.size() - 1);
+
+	return callInIndices[hash];
+}
+
+uint32_t LuaCallInProfiler::GetSourceIdx(const char* name)
+{
+	// "@file" and "=name" chunk names, plain strings for loadstring'ed chunks
+	if (name[0] == '@' || name[0] == '=')
+		name += 1;
+
+	const uint32_t hash = hashString(name);
+	const auto it = sourceIndices.find(hash);
+
+	if (it != sourceIndices.end())
+		return it->second;
+
+	sources.push_back({name, hash});
+	sourceIndices[hash] = static_cast<uint32_t>(sources.size() - 1);
+
+	return sourceIndices[hash];
+}
+
+
+void LuaCallInProfiler::BeginCallIn(lua_State* L, const char* name)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	CheckEpoch();
+
+	// close the outer callin's interval, the nested one is charged on its own
+	if (!frames.empty())
+		Charge(frames.back().sourceIdx, false);
+
+	const int64_t curTime = GetTimeNs();
+	const uint64_t curBytes = allocState.numAllocBytes.load();
+
+	frames.push_back({GetCallInIdx(name), HANDLER_SOURCE_IDX, curTime, curBytes, curTime, curBytes});
+
+	if (frames.size() > 1)
+		return;
+
+	// leave hooks installed by Lua code (debug.sethook) alone
+	if (lua_gethook(L) != nullptr && lua_gethook(L) != SampleHook)
+		return;
+
+	lua_sethook(L, SampleHook, LUA_MASKCOUNT, sampleInstrCount);
+	hookedState = L;
+}
+
+void LuaCallInProfiler::EndCallIn()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(!frames.empty());
+
+	// the tail since the last sample goes to the source sampled last
+	Charge(frames.back().sourceIdx, false);
+
+	const Frame& frame = frames.back();
+	CallInStats& callIn = callIns[frame.callInIdx];
+
+	callIn.numCalls += 1;
+	callIn.stats.timeNs += (frame.lastTime - frame.startTime);
+	callIn.stats.allocBytes += (frame.lastBytes - frame.startBytes);
+
+	const int64_t curTime = frame.lastTime;
+	const uint64_t curBytes = frame.lastBytes;
+
+	frames.pop_back();
+
+	if (!frames.empty()) {
+		// resume the outer callin without charging it for the nested one
+		frames.back().lastTime = curTime;
+		frames.back().lastBytes = curBytes;
+		return;
+	}
+
+	if (hookedState == nullptr)
+		return;
+
+	if (lua_gethook(hookedState) == SampleHook)
+		lua_sethook(hookedState, nullptr, 0, 0);
+
+	hookedState = nullptr;
+}
+
+
+void LuaCallInProfiler::Charge(uint32_t sourceIdx, bool sampled)
+{
+	Frame& frame = frames.back();
+
+	const int64_t curTime = GetTimeNs();
+	const uint64_t curBytes = allocState.numAllocBytes.load();
+
+	const uint64_t key = (uint64_t(frame.callInIdx) << 32) | sourceIdx;
+	Stats& stats = entries[key];
+
+	stats.timeNs += (curTime - frame.lastTime);
+	stats.allocBytes += (curBytes - frame.lastBytes);
+	stats.numSamples += sampled;
+
+	frame.sourceIdx = sourceIdx;
+	frame.lastTime = curTime;
+	frame.lastBytes = curBytes;
+}
+
+void LuaCallInProfiler::Sample(lua_State* L)
+{
+	if (frames.empty())
+		return;
+
+	lua_Debug ar;
+
+	// the outermost run of frames sharing a source is the handler (e.g.
+	// widgets.lua), the run right inside it is the client it dispatched to
+	const char* curRunSrc = nullptr;
+	const char* prvRunSrc = nullptr;
+
+	for (int level = 0; lua_getstack(L, level, &ar) != 0; ++level) {
+		if (lua_getinfo(L, "S", &ar) == 0 || ar.what[0] == 'C')
+			continue;
+
+		if (curRunSrc != nullptr && strcmp(curRunSrc, ar.source) == 0)
+			continue;
+
+		prvRunSrc = curRunSrc;
+		curRunSrc = ar.source;
+	}
+
+	if (curRunSrc == nullptr) {
+		Charge(HANDLER_SOURCE_IDX, true);
+		return;
+	}
+
+	Charge(GetSourceIdx((prvRunSrc != nullptr)? prvRunSrc: curRunSrc), true);
+}
+
+void LuaCallInProfiler::SampleHook(lua_State* L, lua_Debug* ar)
+{
+	if (!enabled) {
+		lua_sethook(L, nullptr, 0, 0);
+		return;
+	}
+
+	GetLuaContextData(L)->callInProfiler.Sample(L);
+}
@@ -0,0 +1,163 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_CALLIN_PROFILER_H
+#define LUA_CALLIN_PROFILER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/UnorderedMap.hpp"
+
+struct lua_State;
+struct lua_Debug;
+struct SLuaAllocState;
+
+/**
+ * Sampling profiler that attributes Lua time and allocated bytes to every
+ * (callin, source file) pair of a single Lua state.
+ *
+ * While enabled, a count hook fires every N VM instructions of a running
+ * callin and charges the time and bytes spent since the previous sample to
+ * the source that is currently executing. The source is taken from the
+ * first stack frame inside the handler's own file, i.e. the widget/gadget
+ * that the handler dispatched the callin to, so a single callin like
+ * DrawScreen is broken down per client.
+ *
+ * States running a debug hook of their own (debug.sethook) are not sampled,
+ * their callins are still timed as a whole. Until enabled, a callin only
+ * pays for one branch.
+ */
+class LuaCallInProfiler {
+public:
+	static constexpr int DEFAULT_SAMPLE_INSTR_COUNT = 1000;
+
+	struct Stats {
+		uint64_t timeNs = 0;
+		uint64_t allocBytes = 0;
+		uint32_t numSamples = 0;
+	};
+
+	struct CallInStats {
+		std::string name;
+		uint32_t hash = 0;
+		uint32_t numCalls = 0;
+		Stats stats;
+	};
+
+	struct SourceStats {
+		std::string name;
+		uint32_t hash = 0;
+	};
+
+	class ScopedCallIn {
+	public:
+		ScopedCallIn(LuaCallInProfiler& _profiler, lua_State* L, const char* name)
+			: profiler(_profiler)
+			, active(enabled)
+		{
+			if (active)
+				profiler.BeginCallIn(L, name);
+		}
+		~ScopedCallIn() {
+			if (active)
+				profiler.EndCallIn();
+		}
+	private:
+		LuaCallInProfiler& profiler;
+		const bool active;
+	};
+
+public:
+	LuaCallInProfiler(const SLuaAllocState& _allocState)
+		: allocState(_allocState)
+	{}
+
+	LuaCallInProfiler(const LuaCallInProfiler&) = delete;
+	LuaCallInProfiler(LuaCallInProfiler&&) = delete;
+
+	LuaCallInProfiler& operator = (const LuaCallInProfiler&) = delete;
+	LuaCallInProfiler& operator = (LuaCallInProfiler&&) = delete;
+
+	void Reset();
+
+	// profiles of all states are cleared when (re)enabled
+	static void SetEnabled(bool enable, int instrCount = DEFAULT_SAMPLE_INSTR_COUNT);
+	static bool IsEnabled() { return enabled; }
+	static int GetSampleInstrCount() { return sampleInstrCount; }
+	// seconds of profiling the current results span
+	static float GetProfiledTime();
+
+	const std::vector<CallInStats>& GetCallIns() const { return callIns; }
+	const std::vector<SourceStats>& GetSources() const { return sources; }
+	// keyed by (callIn index << 32 | source index)
+	const spring::flat_hash_map<uint64_t, Stats>& GetEntries() const { return entries; }
+
+	// false until the state ran a callin since profiling was (re)enabled
+	bool IsCurrent() const { return (epoch == globalEpoch && !sources.empty()); }
+
+	static uint32_t GetCallInIndex(uint64_t key) { return static_cast<uint32_t>(key >> 32); }
+	static uint32_t GetSourceIndex(uint64_t key) { return static_cast<uint32_t>(key & 0xFFFFFFFFu); }
+
+	struct ProfileEntry {
+		// point into the profilers, valid until the next callin runs
+		const char* handleName;
+		const char* callInName;
+		const char* sourceName;
+		bool synced;
+		Stats stats;
+	};
+
+	// entries of all Lua states, most expensive first
+	static void CollectProfiles(std::vector<ProfileEntry>& profiles);
+
+private:
+	void BeginCallIn(lua_State* L, const char* name);
+	void EndCallIn();
+
+	void CheckEpoch();
+	void Charge(uint32_t sourceIdx, bool sampled);
+	void Sample(lua_State* L);
+
+	uint32_t GetCallInIdx(const char* name);
+	uint32_t GetSourceIdx(const char* name);
+
+	static void SampleHook(lua_State* L, lua_Debug* ar);
+
+private:
+	struct Frame {
+		uint32_t callInIdx;
+		uint32_t sourceIdx;
+		int64_t startTime;
+		uint64_t startBytes;
+		int64_t lastTime;
+		uint64_t lastBytes;
+	};
+
+	const SLuaAllocState& allocState;
+	lua_State* hookedState = nullptr;
+
+	// nested callins charge their own entries, outer frames resume afterwards
+	std::vector<Frame> frames;
+
+	std::vector<CallInStats> callIns;
+	std::vector<SourceStats> sources;
+	spring::flat_hash_map<uint64_t, Stats> entries;
+
+	// by name hash
+	spring::flat_hash_map<uint32_t, uint32_t> callInIndices;
+	spring::flat_hash_map<uint32_t, uint32_t> sourceIndices;
+
+	uint32_t epoch = 0;
+
+private:
+	static inline bool enabled = false;
+	static inline int sampleInstrCount = DEFAULT_SAMPLE_INSTR_COUNT;
+	static inline uint32_t globalEpoch = 0;
+	static inline int64_t enableTime = 0;
+
+	// charged while no sample was taken inside a client yet
+	static constexpr uint32_t HANDLER_SOURCE_IDX = 0;
+};
+
+#endif // LUA_CALLIN_PROFILER_H
@@ -15,6 +15,7 @@
 #include "LuaVBO.h"
 #include "LuaVAO.h"
 #include "LuaDisplayLists.h"
+#include "LuaCallInProfiler.h"
 #endif
 
 #include "System/EventClient.h"
@@ -47,7 +48,10 @@ public:
 	, readAllyTeam(0)
 	, selectTeam(CEventClient::NoAccessTeam)
 
-	, allocState{{0}, {0}, {0}, {0}}
+	, allocState{{0}, {0}, {0}, {0}, {0}}
+	#if (!defined(UNITSYNC) && !defined(DEDICATED))
+	, callInProfiler(allocState)
+	#endif
 	{}
 
 	~luaContextData() {
@@ -118,6 +122,8 @@ public:
 	CLuaDisplayLists displayLists;
 
 	GLMatrixStateTracker glMatrixTracker;
+
+	LuaCallInProfiler callInProfiler;
 #endif
 };
 
@@ -20,6 +20,12 @@ struct SLuaGarbageCollectCtrl {
 
 	float baseRunTimeMult = 0.0f;
 	float baseMemLoadMult = 0.0f;
+
+	// state of the per-draw-frame collector (LuaGCControl 2)
+	// footprint left after the previous pass, in KB; growth since then is taken as the allocation rate
+	int lastMemFootPrint = 0;
+	// running average of the time taken by one step, in milliseconds
+	float avgStepTime = 0.01f;
 };
 
 #endif
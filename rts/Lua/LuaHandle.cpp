@@ -50,6 +50,7 @@
 #include "System/ScopedFPUSettings.h"
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/StartupTrace.h"
 #include "System/Input/KeyInput.h"
 #include "System/Platform/SDL1_keysym.h"
 
@@ -143,15 +144,16 @@ CLuaHandle::CLuaHandle(const string& _name, int _order, bool _userMode, bool _sy
 	: CEventClient(_name, _order, _synced)
 	, userMode(_userMode)
 	, killMe(false)
-	// no shared pool for LuaIntro to protect against LoadingMT=1
-	// do not use it for LuaMenu either; too many blocks allocated
-	// by *other* states end up not being recycled which presently
-	// forces clearing the shared pool on reload
-	, D(_name != "LuaIntro" && name != "LuaMenu", true)
+	// every handle gets its own arena, so that a reload (of LuaUI
+	// e.g.) can drop all its blocks at once without waiting on the
+	// states that would otherwise share the pool
+	, D(false, true)
 {
 	D.owner = this;
 	D.synced = _synced;
 
+	callInRefs.resize(eventHandler.GetNumEvents(), LUA_NOREF);
+
 	D.gcCtrl.baseMemLoadMult = configHandler->GetFloat("LuaGarbageCollectionMemLoadMult");
 	D.gcCtrl.baseRunTimeMult = configHandler->GetFloat("LuaGarbageCollectionRunTimeMult");
 
@@ -218,6 +220,9 @@ void CLuaHandle::KillLua(bool inFreeHandler)
 	// false and FreeHandler runs next
 	LUA_ERASE_CONTEXT(&D, LUAHANDLE_CONTEXTS[D.synced]);
 	LUA_CLOSE(&L);
+
+	// the refs died with the state
+	std::fill(callInRefs.begin(), callInRefs.end(), LUA_NOREF);
 }
 
 
@@ -355,7 +360,11 @@ int CLuaHandle::RunCallInTraceback(
 	int errFuncIndex,
 	bool popErrorFunc
 ) {
-	RECOIL_DETAILED_TRACY_ZONE;
+	RECOIL_TRACY_ZONE(LUA);
+	if (hs != nullptr) {
+		RECOIL_TRACY_ZONE_NAME(LUA, hs->GetString(), strlen(hs->GetString()));
+	}
+
 	// do not signal floating point exceptions in user Lua code
 	ScopedDisableFpuExceptions fe;
 
@@ -394,7 +403,10 @@ int CLuaHandle::RunCallInTraceback(
 			// note1: disable GC outside of this scope to prevent sync errors and similar
 			// note2: we collect garbage now in its own callin "CollectGarbage"
 			// lua_gc(L, LUA_GCRESTART, 0);
-			error = lua_pcall(state, nInArgs, nOutArgs, errFuncIdx);
+			{
+				LuaCallInProfiler::ScopedCallIn profCallIn(GetLuaContextData(state)->callInProfiler, state, luaFunc);
+				error = lua_pcall(state, nInArgs, nOutArgs, errFuncIdx);
+			}
 			// only run GC inside of "SetHandleRunning(L, true) ... SetHandleRunning(L, false)"!
 			lua_gc(state, LUA_GCSTOP, 0);
 
@@ -534,7 +546,12 @@ bool CLuaHandle::LoadCode(lua_State* L, std::string code, const string& debug)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	LuaUtils::TracyRemoveAlsoExtras(code.data());
-	const int error = luaL_loadbuffer(L, code.c_str(), code.size(), debug.c_str());
+	int error = 0;
+
+	{
+		SCOPED_STARTUP_TRACE(name + "::Parse(" + debug + ")", "lua")
+		error = luaL_loadbuffer(L, code.c_str(), code.size(), debug.c_str());
+	}
 
 	if (error != 0) {
 		LOG_L(L_ERROR, "[%s::%s] error=%i (%s) debug=%s msg=%s", name.c_str(), __func__, error, LuaErrorString(error), debug.c_str(), lua_tostring(L, -1));
@@ -544,6 +561,8 @@ bool CLuaHandle::LoadCode(lua_State* L, std::string code, const string& debug)
 
 	static const LuaHashString cmdStr(__func__);
 
+	SCOPED_STARTUP_TRACE(name + "::Run(" + debug + ")", "lua")
+
 	// call Initialize immediately after load
 	return (RunCallInTraceback(L, cmdStr, 0, 0, traceBack.GetErrFuncIdx(), false));
 }
@@ -687,7 +706,7 @@ bool CLuaHandle::HasCallIn(lua_State* L, const string& name) const
 bool CLuaHandle::UpdateCallIn(lua_State* L, const string& name)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (HasCallIn(L, name)) {
+	if (BindCallIn(L, name, HasCallIn(L, name))) {
 		eventHandler.InsertEvent(this, name);
 	} else {
 		eventHandler.RemoveEvent(this, name);
@@ -695,6 +714,42 @@ bool CLuaHandle::UpdateCallIn(lua_State* L, const string& name)
 	return true;
 }
 
+
+LuaCallInString::LuaCallInString(const char* name)
+	: LuaHashString(name)
+	, eventIndex(eventHandler.GetEventIndex(name))
+{}
+
+bool CLuaHandle::BindCallIn(lua_State* L, const string& name, bool found)
+{
+	const int eventIndex = eventHandler.GetEventIndex(name);
+
+	if (eventIndex < 0 || !IsValid())
+		return found;
+
+	int& ref = callInRefs[eventIndex];
+
+	luaL_unref(L, LUA_REGISTRYINDEX, ref);
+	ref = LUA_NOREF;
+
+	if (!found)
+		return false;
+
+	lua_pushvalue(L, LUA_GLOBALSINDEX);
+	lua_pushsstring(L, name);
+	lua_rawget(L, -2);
+
+	// CollectGarbage counts as found without a Lua function
+	if (lua_isfunction(L, -1)) {
+		ref = luaL_ref(L, LUA_REGISTRYINDEX);
+	} else {
+		lua_pop(L, 1);
+	}
+
+	lua_pop(L, 1);
+	return true;
+}
+
 /*** Game
  * @section game
  */
@@ -845,9 +900,9 @@ void CLuaHandle::GameFrame(int frameNum)
 
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return;
 
 	lua_pushnumber(L, frameNum);
@@ -1382,10 +1437,10 @@ void CLuaHandle::UnitDamaged(
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 11, __func__);
 
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return;
 
 	static constexpr int argCount = 7 + 3;
@@ -1405,6 +1460,52 @@ void CLuaHandle::UnitDamaged(
 	RunCallInTraceback(L, cmdStr, argCount, 0, traceBack.GetErrFuncIdx(), false);
 }
 
+/*** Batched form of UnitDamaged, called once at the end of each sim-frame.
+ *
+ * Defining this instead of UnitDamaged saves one callin per damage event;
+ * the damage can not be changed from here (use UnitPreDamaged for that).
+ * Element `i` of every array belongs to the `i`-th event of the frame, in
+ * the order they happened; missing attacker info is -1.
+ *
+ * @function Callins:UnitDamagedBatch
+ * @param count integer
+ * @param unitIDs integer[]
+ * @param unitDefIDs integer[]
+ * @param unitTeams integer[]
+ * @param damages number[]
+ * @param paralyzers boolean[]
+ * @param weaponDefIDs integer[]
+ * @param projectileIDs integer[]
+ * @param attackerIDs integer[]
+ * @param attackerDefIDs integer[]
+ * @param attackerTeams integer[]
+ */
+void CLuaHandle::UnitDamagedBatch(
+	const CUnit* unit,
+	const CUnit* attacker,
+	float damage,
+	int weaponDefID,
+	int projectileID,
+	bool paralyzer)
+{
+	// same information as UnitDamaged pushes, c.f. LuaUtils::PushAttackerInfo
+	const bool attackerVisible = (attacker != nullptr && LuaUtils::IsUnitVisible(L, attacker));
+	const bool attackerTyped = (attackerVisible && LuaUtils::IsUnitTyped(L, attacker));
+
+	unitDamagedBatch.push_back({
+		unit->id,
+		unit->unitDef->id,
+		unit->team,
+		damage,
+		paralyzer,
+		weaponDefID,
+		projectileID,
+		attackerVisible? attacker->id: -1,
+		attackerTyped? LuaUtils::EffectiveUnitDef(L, attacker)->id: -1,
+		attackerVisible? attacker->team: -1,
+	});
+}
+
 /*** Called when a unit changes its stun status.
  *
  * @function Callins:UnitStunned
@@ -1631,6 +1732,36 @@ void CLuaHandle::UnitLeftLos(const CUnit* unit, int allyTeam)
 }
 
 
+/***
+ * Batched form of the four LOS and radar callins above, called once at the end of each sim-frame.
+ *
+ * Element `i` of every array belongs to the `i`-th transition of the frame, in
+ * the order the per-event callins would have run. A transition is 1 for
+ * entered LOS, 2 for left LOS, 3 for entered radar and 4 for left radar.
+ * Unlike UnitLeftLos, this runs after the unit has left, so its position can
+ * not be read anymore. The last two arrays are only passed to handles with
+ * full read access.
+ *
+ * @function Callins:UnitLosChangedBatch
+ * @param count integer
+ * @param unitIDs integer[]
+ * @param unitTeams integer[]
+ * @param transitions integer[]
+ * @param allyTeams integer[]
+ * @param unitDefIDs integer[]
+ */
+void CLuaHandle::UnitLosChangedBatch(const CUnit* unit, int allyTeam, int transition)
+{
+	unitLosChangedBatch.push_back({
+		unit->id,
+		unit->team,
+		transition,
+		allyTeam,
+		unit->unitDef->id,
+	});
+}
+
+
 /******************************************************************************
  * Transport
  * @section transport
@@ -2084,8 +2215,8 @@ void CLuaHandle::FeatureDamaged(
 	luaL_checkstack(L, 11, __func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	static const LuaCallInString cmdStr(__func__);
+	if (!GetCallInFunc(L, cmdStr))
 		return;
 
 	int argCount = 6 + 3;
@@ -2127,34 +2258,44 @@ void CLuaHandle::FeatureDamaged(
  * @see Script.SetWatchProjectile
  * @see Script.SetWatchWeapon
  */
-void CLuaHandle::ProjectileCreated(const CProjectile* p)
+bool CLuaHandle::IsWatchedProjectile(const CProjectile* p, const WeaponDef** wd) const
 {
-	RECOIL_DETAILED_TRACY_ZONE;
 	// if empty, we are not a LuaHandleSynced
 	if (watchProjectileDefs.empty())
-		return;
+		return false;
 
 	if (!p->weapon && !p->piece)
-		return;
+		return false;
 
 	assert(p->synced);
 
-	const CUnit* owner = p->owner();
-	const CWeaponProjectile* wp = p->weapon? static_cast<const CWeaponProjectile*>(p): nullptr;
-	const WeaponDef* wd = p->weapon? wp->GetWeaponDef(): nullptr;
+	*wd = p->weapon? static_cast<const CWeaponProjectile*>(p)->GetWeaponDef(): nullptr;
 
 	// if this weapon-type is not being watched, bail
-	if (p->weapon && (wd == nullptr || !watchProjectileDefs[wd->id]))
-		return;
+	if (p->weapon && (*wd == nullptr || !watchProjectileDefs[(*wd)->id]))
+		return false;
 	if (p->piece && !watchProjectileDefs[watchProjectileDefs.size() - 1])
+		return false;
+
+	return true;
+}
+
+void CLuaHandle::ProjectileCreated(const CProjectile* p)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const WeaponDef* wd = nullptr;
+
+	if (!IsWatchedProjectile(p, &wd))
 		return;
 
+	const CUnit* owner = p->owner();
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 5, __func__);
 
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return;
 
 	lua_pushnumber(L, p->id);
@@ -2165,6 +2306,148 @@ void CLuaHandle::ProjectileCreated(const CProjectile* p)
 	RunCallIn(L, cmdStr, 3, 0);
 }
 
+/*** Batched form of ProjectileCreated, called once at the end of each sim-frame.
+ *
+ * Element `i` of every array belongs to the `i`-th projectile created during
+ * the frame; a missing owner or weaponDefID is -1.
+ *
+ * @function Callins:ProjectileCreatedBatch
+ * @param count integer
+ * @param proIDs integer[]
+ * @param proOwnerIDs integer[]
+ * @param weaponDefIDs integer[]
+ *
+ * @see Script.SetWatchProjectile
+ * @see Script.SetWatchWeapon
+ */
+void CLuaHandle::ProjectileCreatedBatch(const CProjectile* p)
+{
+	const WeaponDef* wd = nullptr;
+
+	if (!IsWatchedProjectile(p, &wd))
+		return;
+
+	const CUnit* owner = p->owner();
+
+	projectileCreatedBatch.push_back({
+		p->id,
+		(owner != nullptr)? owner->id: -1,
+		(wd != nullptr)? wd->id: -1,
+	});
+}
+
+
+template<typename T, typename F>
+static void PushBatchArray(lua_State* L, const std::vector<T>& batch, F&& pushField)
+{
+	lua_createtable(L, batch.size(), 0);
+
+	for (size_t i = 0; i < batch.size(); i++) {
+		pushField(batch[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+}
+
+void CLuaHandle::SendBatchedEvents()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!unitDamagedBatch.empty())
+		SendUnitDamagedBatch();
+	if (!projectileCreatedBatch.empty())
+		SendProjectileCreatedBatch();
+	if (!unitLosChangedBatch.empty())
+		SendUnitLosChangedBatch();
+}
+
+void CLuaHandle::SendUnitDamagedBatch()
+{
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 2 + 11 + 1, __func__);
+
+	static const LuaCallInString cmdStr("UnitDamagedBatch");
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!GetCallInFunc(L, cmdStr)) {
+		unitDamagedBatch.clear();
+		return;
+	}
+
+	const auto& batch = unitDamagedBatch;
+
+	lua_pushnumber(L, batch.size());
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.unitID); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.unitDefID); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.unitTeam); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.damage); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushboolean(L, e.paralyzer); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.weaponDefID); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.projectileID); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.attackerID); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.attackerDefID); });
+	PushBatchArray(L, batch, [L](const UnitDamagedEvent& e) { lua_pushnumber(L, e.attackerTeam); });
+
+	// clear before the call, the callin can cause more damage
+	unitDamagedBatch.clear();
+
+	RunCallInTraceback(L, cmdStr, 11, 0, traceBack.GetErrFuncIdx(), false);
+}
+
+void CLuaHandle::SendProjectileCreatedBatch()
+{
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 2 + 4 + 1, __func__);
+
+	static const LuaCallInString cmdStr("ProjectileCreatedBatch");
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!GetCallInFunc(L, cmdStr)) {
+		projectileCreatedBatch.clear();
+		return;
+	}
+
+	const auto& batch = projectileCreatedBatch;
+
+	lua_pushnumber(L, batch.size());
+	PushBatchArray(L, batch, [L](const ProjectileCreatedEvent& e) { lua_pushnumber(L, e.proID); });
+	PushBatchArray(L, batch, [L](const ProjectileCreatedEvent& e) { lua_pushnumber(L, e.ownerID); });
+	PushBatchArray(L, batch, [L](const ProjectileCreatedEvent& e) { lua_pushnumber(L, e.weaponDefID); });
+
+	projectileCreatedBatch.clear();
+
+	RunCallInTraceback(L, cmdStr, 4, 0, traceBack.GetErrFuncIdx(), false);
+}
+
+void CLuaHandle::SendUnitLosChangedBatch()
+{
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 2 + 6 + 1, __func__);
+
+	static const LuaCallInString cmdStr("UnitLosChangedBatch");
+	const LuaUtils::ScopedDebugTraceBack traceBack(L);
+
+	if (!GetCallInFunc(L, cmdStr)) {
+		unitLosChangedBatch.clear();
+		return;
+	}
+
+	const auto& batch = unitLosChangedBatch;
+	const bool fullRead = GetHandleFullRead(L);
+
+	lua_pushnumber(L, batch.size());
+	PushBatchArray(L, batch, [L](const UnitLosChangedEvent& e) { lua_pushnumber(L, e.unitID); });
+	PushBatchArray(L, batch, [L](const UnitLosChangedEvent& e) { lua_pushnumber(L, e.unitTeam); });
+	PushBatchArray(L, batch, [L](const UnitLosChangedEvent& e) { lua_pushnumber(L, e.transition); });
+
+	if (fullRead) {
+		PushBatchArray(L, batch, [L](const UnitLosChangedEvent& e) { lua_pushnumber(L, e.allyTeam); });
+		PushBatchArray(L, batch, [L](const UnitLosChangedEvent& e) { lua_pushnumber(L, e.unitDefID); });
+	}
+
+	unitLosChangedBatch.clear();
+
+	RunCallInTraceback(L, cmdStr, fullRead? 6: 4, 0, traceBack.GetErrFuncIdx(), false);
+}
+
 
 /*** Called when the projectile is destroyed.
  *
@@ -2207,9 +2490,9 @@ void CLuaHandle::ProjectileDestroyed(const CProjectile* p)
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 6, __func__);
 
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return;
 
 	lua_pushnumber(L, p->id);
@@ -2272,8 +2555,8 @@ bool CLuaHandle::Explosion(int weaponDefID, const WeaponDef* weaponDef, const CE
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 7, __func__);
 
-	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	static const LuaCallInString cmdStr(__func__);
+	if (!GetCallInFunc(L, cmdStr))
 		return false;
 
 	lua_pushnumber(L, weaponDefID);
@@ -2532,8 +2815,8 @@ void CLuaHandle::Update()
 	RECOIL_DETAILED_TRACY_ZONE;
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 2, __func__);
-	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	static const LuaCallInString cmdStr(__func__);
+	if (!GetCallInFunc(L, cmdStr))
 		return;
 
 	// call the routine
@@ -2676,12 +2959,12 @@ bool CLuaHandle::DefaultCommand(const CUnit* unit,
 }
 
 
-void CLuaHandle::RunDrawCallIn(const LuaHashString& hs)
+void CLuaHandle::RunDrawCallIn(const LuaCallInString& hs)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 2, __func__);
-	if (!hs.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, hs))
 		return;
 
 	LuaOpenGL::SetDrawingEnabled(L, true);
@@ -2692,11 +2975,11 @@ void CLuaHandle::RunDrawCallIn(const LuaHashString& hs)
 	LuaOpenGL::SetDrawingEnabled(L, false);
 }
 
-#define DRAW_CALLIN(name)                     \
-void CLuaHandle::name()                       \
-{                                             \
-	static const LuaHashString cmdStr(#name); \
-	RunDrawCallIn(cmdStr);                    \
+#define DRAW_CALLIN(name)                        \
+void CLuaHandle::name()                          \
+{                                                \
+	static const LuaCallInString cmdStr(#name);  \
+	RunDrawCallIn(cmdStr);                       \
 }
 
 
@@ -4079,6 +4362,57 @@ void CLuaHandle::CollectGarbage(bool forced)
 	eventHandler.DbgTimingInfo(TIMING_GC, startTime, finishTime);
 }
 
+void CLuaHandle::CollectGarbageInBudget(float maxRunTime)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	LUA_CALL_IN_CHECK_NAMED(L, (GetLuaContextData(L)->synced)? "Lua::CollectGarbage::Synced": "Lua::CollectGarbage::Unsynced");
+
+	lua_lock(L_GC);
+	SetHandleRunning(L_GC, true);
+
+	SLuaGarbageCollectCtrl& gcCtrl = D.gcCtrl;
+
+	// memory is only released by the collector, so growth since the last pass
+	// is what was allocated in the meantime; aim to collect a quarter more so
+	// that a backlog (e.g. from a big fight) is worked off over the next frames
+	const int gcMemFootPrint = lua_gc(L_GC, LUA_GCCOUNT, 0);
+	const int gcMemAllocated = std::max(gcMemFootPrint - gcCtrl.lastMemFootPrint, 0);
+
+	// one step is roughly one KB of work; keep each lua_gc call to about a tenth
+	// of the budget so the deadline is not overshot by more than that
+	const int gcStepsTotal = std::max(gcMemAllocated + gcMemAllocated / 4, gcCtrl.minStepsPerIter);
+	const int gcStepsPerIter = std::clamp(int((maxRunTime * 0.1f) / gcCtrl.avgStepTime), gcCtrl.minStepsPerIter, gcCtrl.maxStepsPerIter);
+
+	const spring_time startTime = spring_gettime();
+	const spring_time   endTime = startTime + spring_msecs(maxRunTime);
+
+	int gcStepsDone = 0;
+
+	while (gcStepsDone < gcStepsTotal && spring_gettime() < endTime) {
+		const int numSteps = std::min(gcStepsPerIter, gcStepsTotal - gcStepsDone);
+
+		gcStepsDone += numSteps;
+
+		// stop at the end of a cycle, the next one starts with fresh garbage
+		if (lua_gc(L_GC, LUA_GCSTEP, numSteps))
+			break;
+	}
+
+	lua_gc(L_GC, LUA_GCSTOP, 0);
+	SetHandleRunning(L_GC, false);
+
+	gcCtrl.lastMemFootPrint = lua_gc(L_GC, LUA_GCCOUNT, 0);
+	lua_unlock(L_GC);
+
+
+	const spring_time finishTime = spring_gettime();
+
+	if (gcStepsDone > 0)
+		gcCtrl.avgStepTime = mix(gcCtrl.avgStepTime, std::max((finishTime - startTime).toMilliSecsf() / gcStepsDone, 0.0001f), 0.1f);
+
+	eventHandler.DbgTimingInfo(TIMING_GC, startTime, finishTime);
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -49,6 +49,23 @@ class WeaponDef;
 class CCobDeferredCallin;
 
 
+/**
+ * Name of a frequently called callin; the index lets CLuaHandle::GetCallInFunc
+ * fetch the function bound at subscription time instead of looking it up in
+ * the globals table on every call.
+ */
+class LuaCallInString : public LuaHashString
+{
+public:
+	LuaCallInString(const char* name);
+
+	int GetEventIndex() const { return eventIndex; }
+
+private:
+	int eventIndex = -1;
+};
+
+
 class CLuaHandle : public CEventClient
 {
 	public:
@@ -107,10 +124,21 @@ class CLuaHandle : public CEventClient
 		CLuaDisplayLists& GetDisplayLists(const lua_State* L = NULL) { return GetLuaContextData(L)->displayLists; }
 #endif
 	public: // call-ins
-		bool WantsEvent(const std::string& name) override { return HasCallIn(L, name); }
+		bool WantsEvent(const std::string& name) override { return BindCallIn(L, name, HasCallIn(L, name)); }
 		virtual bool HasCallIn(lua_State* L, const std::string& name) const;
 		virtual bool UpdateCallIn(lua_State* L, const std::string& name);
 
+		// pushes the callin's function and returns true, or pushes nothing and returns false
+		bool GetCallInFunc(lua_State* L, const LuaCallInString& cs) const {
+			const int ref = (cs.GetEventIndex() >= 0)? callInRefs[cs.GetEventIndex()]: LUA_NOREF;
+
+			if (ref == LUA_NOREF)
+				return cs.GetGlobalFunc(L);
+
+			lua_rawgeti(L, LUA_REGISTRYINDEX, ref);
+			return true;
+		}
+
 		void Load(IArchive* archive) override;
 
 		void GamePreload() override;
@@ -147,6 +175,14 @@ class CLuaHandle : public CEventClient
 			int projectileID,
 			bool paralyzer
 		) override;
+		void UnitDamagedBatch(
+			const CUnit* unit,
+			const CUnit* attacker,
+			float damage,
+			int weaponDefID,
+			int projectileID,
+			bool paralyzer
+		) override;
 		void UnitStunned(const CUnit* unit, bool stunned) override;
 		void UnitExperience(const CUnit* unit, float oldExperience) override;
 		void UnitHarvestStorageFull(const CUnit* unit) override;
@@ -157,6 +193,7 @@ class CLuaHandle : public CEventClient
 		void UnitEnteredLos(const CUnit* unit, int allyTeam) override;
 		void UnitLeftRadar(const CUnit* unit, int allyTeam) override;
 		void UnitLeftLos(const CUnit* unit, int allyTeam) override;
+		void UnitLosChangedBatch(const CUnit* unit, int allyTeam, int transition) override;
 
 		void UnitEnteredUnderwater(const CUnit* unit) override;
 		void UnitEnteredWater(const CUnit* unit) override;
@@ -189,6 +226,8 @@ class CLuaHandle : public CEventClient
 		) override;
 
 		void ProjectileCreated(const CProjectile* p) override;
+		void ProjectileCreatedBatch(const CProjectile* p) override;
+		void SendBatchedEvents() override;
 		void ProjectileDestroyed(const CProjectile* p) override;
 
 		bool IsExplosionVisible(const WeaponDef* weaponDef, const CExplosionParams& params);
@@ -288,6 +327,7 @@ class CLuaHandle : public CEventClient
 		//FIXME void MetalMapChanged(const int x, const int z);
 
 		void CollectGarbage(bool forced) override;
+		void CollectGarbageInBudget(float maxRunTime) override;
 
 		void DownloadQueued(int ID, const std::string& archiveName, const std::string& archiveType) override;
 		void DownloadStarted(int ID) override;
@@ -339,7 +379,7 @@ class CLuaHandle : public CEventClient
 		void LosCallIn(const LuaHashString& hs, const CUnit* unit, int allyTeam);
 		void UnitCallIn(const LuaHashString& hs, const CUnit* unit);
 
-		void RunDrawCallIn(const LuaHashString& hs);
+		void RunDrawCallIn(const LuaCallInString& hs);
 
 		void DrawObjectsLua(std::initializer_list<bool> bools, const char* func);
 		void InitializeRmlUi();
@@ -356,11 +396,23 @@ class CLuaHandle : public CEventClient
 		lua_State* L_GC;
 		luaContextData D;
 
+		// registry refs to the global function of each subscribed callin, indexed
+		// by event; rebound whenever the subscription is (see BindCallIn), so Lua
+		// code replacing a callin must do so through Script.UpdateCallIn
+		std::vector<int> callInRefs;
+
 		std::string killMsg;
 
 		std::map <int, std::vector <std::pair <int, std::vector <int>>>> delayedCallsByFrame;
 		void RunDelayedFunctions(int frameNum);
 
+		bool BindCallIn(lua_State* L, const std::string& name, bool found);
+
+		bool IsWatchedProjectile(const CProjectile* p, const WeaponDef** wd) const;
+		void SendUnitDamagedBatch();
+		void SendProjectileCreatedBatch();
+		void SendUnitLosChangedBatch();
+
 		virtual void EnactDevMode() const {};
 		void SwapEnableModule(lua_State* L, bool enabled, const char* moduleName, lua_CFunction func) const;
 
@@ -370,6 +422,38 @@ class CLuaHandle : public CEventClient
 		std::vector<bool> watchExplosionDefs;   // callin masks for Explosion
 		std::vector<bool> watchAllowTargetDefs; // callin masks for AllowWeapon*Target*
 
+		// events queued for the *Batch callins during a sim-frame, with all
+		// visibility checks applied when they were queued; -1 means nil
+		struct UnitDamagedEvent {
+			int unitID;
+			int unitDefID;
+			int unitTeam;
+			float damage;
+			bool paralyzer;
+			int weaponDefID;
+			int projectileID;
+			int attackerID;
+			int attackerDefID;
+			int attackerTeam;
+		};
+		struct ProjectileCreatedEvent {
+			int proID;
+			int ownerID;
+			int weaponDefID;
+		};
+
+		std::vector<UnitDamagedEvent> unitDamagedBatch;
+		struct UnitLosChangedEvent {
+			int unitID;
+			int unitTeam;
+			int transition;
+			int allyTeam;
+			int unitDefID;
+		};
+
+		std::vector<ProjectileCreatedEvent> projectileCreatedBatch;
+		std::vector<UnitLosChangedEvent> unitLosChangedBatch;
+
 	private: // call-outs
 		static int KillActiveHandle(lua_State* L);
 		static int CallOutGetName(lua_State* L);
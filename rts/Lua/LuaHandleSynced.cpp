@@ -116,6 +116,7 @@ bool CUnsyncedLuaHandle::Init(std::string code, const std::string& file)
 
 	LuaPushNamedCFunc(L, "loadstring", CLuaHandle::LoadStringData);
 	LuaPushNamedCFunc(L, "CallAsTeam", CSplitLuaHandle::CallAsTeam);
+	LuaPushNamedCFunc(L, "GetPackedFromSynced", GetPackedFromSynced);
 	/*** @global COBSCALE integer */ 
 	LuaPushNamedNumber(L, "COBSCALE",  COBSCALE);
 
@@ -123,6 +124,7 @@ bool CUnsyncedLuaHandle::Init(std::string code, const std::string& file)
 	{
 		#define KILL { KillLua(); return false; }
 		if (!LuaSyncedTable::PushEntries(L)) KILL
+		if (!LuaPackedChannels::CreateMetatable(L)) KILL
 
 		if (!AddCommonModules(L)						       ) KILL
 		if (!AddEntriesToTable(L, "VFS",                   LuaVFS::PushUnsynced       )) KILL
@@ -210,6 +212,23 @@ void CUnsyncedLuaHandle::RecvFromSynced(lua_State* srcState, int args)
 	RunCallIn(L, cmdStr, args, 0);
 }
 
+/***
+ * Get a view of the records the synced half sent via `SendPackedToUnsynced`.
+ *
+ * The view stays valid and always reflects the latest records, so it can be
+ * kept around. It has `#view`, `view:Count()`, `view:Get(i)` (all fields of
+ * record i), `view:GetField(i, field)`, `view:GetFrame()` (sim frame the
+ * records were written in) and `view:GetFormat()`.
+ *
+ * @function UnsyncedCallins.GetPackedFromSynced
+ * @param channel string
+ * @return userdata view
+ */
+int CUnsyncedLuaHandle::GetPackedFromSynced(lua_State* L)
+{
+	return (GetUnsyncedHandle(L)->base.packedChannels.PushView(L));
+}
+
 /*** Custom Object Rendering
  *
  * For the following calls drawMode can be one of the following, notDrawing = 0, normalDraw = 1, shadowDraw = 2, reflectionDraw = 3, refractionDraw = 4, and finally gameDeferredDraw = 5 which was added in 102.0.
@@ -510,6 +529,7 @@ bool CSyncedLuaHandle::Init(std::string code, const std::string& file)
 
 	// add the custom file loader
 	LuaPushNamedCFunc(L, "SendToUnsynced", SendToUnsynced);
+	LuaPushNamedCFunc(L, "SendPackedToUnsynced", SendPackedToUnsynced);
 	LuaPushNamedCFunc(L, "CallAsTeam",     CSplitLuaHandle::CallAsTeam);
 	LuaPushNamedNumber(L, "COBSCALE",      COBSCALE);
 
@@ -1490,9 +1510,9 @@ bool CSyncedLuaHandle::UnitPreDamaged(
 	luaL_checkstack(L, 2 + 2 + 10, __func__);
 
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return false;
 
 	int inArgCount = 5;
@@ -1583,9 +1603,9 @@ bool CSyncedLuaHandle::FeaturePreDamaged(
 	luaL_checkstack(L, 2 + 9 + 2, __func__);
 
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return false;
 
 	int inArgCount = 4;
@@ -1669,9 +1689,9 @@ bool CSyncedLuaHandle::ShieldPreDamaged(
 	luaL_checkstack(L, 2 + 7 + 1, __func__);
 
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return false;
 
 	// push the call-in arguments
@@ -1795,9 +1815,9 @@ bool CSyncedLuaHandle::AllowWeaponTarget(
 	luaL_checkstack(L, 2 + 5 + 2, __func__);
 
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return ret;
 
 	// casts are only here to preserve -1's passed from *CAI as floats
@@ -1860,9 +1880,9 @@ bool CSyncedLuaHandle::AllowWeaponInterceptTarget(
 	luaL_checkstack(L, 2 + 3 + 1, __func__);
 
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
-	static const LuaHashString cmdStr(__func__);
+	static const LuaCallInString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!GetCallInFunc(L, cmdStr))
 		return ret;
 
 	lua_pushnumber(L, interceptorUnit->id);
@@ -2040,6 +2060,27 @@ int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
 }
 
 
+/***
+ * Append binary records to a channel read by `GetPackedFromSynced`.
+ *
+ * The records written during one frame replace those of the last frame that
+ * wrote to the channel. Unlike `SendToUnsynced` no callin is run and nothing
+ * is copied into the unsynced Lua state.
+ *
+ * @function SyncedCallins.SendPackedToUnsynced
+ *
+ * @param channel string
+ * @param format string field types of a record, f = float, i/I = (u)int32, h/H = (u)int16, b/B = (u)int8
+ * @param ... number|number[] values of one or more whole records, or an array of them
+ *
+ * @see UnsyncedCallins.GetPackedFromSynced
+ */
+int CSyncedLuaHandle::SendPackedToUnsynced(lua_State* L)
+{
+	return (GetSyncedHandle(L)->base.packedChannels.Write(L));
+}
+
+
 int CSyncedLuaHandle::AddSyncedActionFallback(lua_State* L)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -6,6 +6,7 @@
 #include <string>
 
 #include "LuaHandle.h"
+#include "LuaPackedChannels.h"
 #include "LuaRulesParams.h"
 #include "System/UnorderedMap.hpp"
 
@@ -45,6 +46,8 @@ class CUnsyncedLuaHandle : public CLuaHandle
 		static int GetWatchExplosionDef(lua_State* L);
 		static int SetWatchExplosionDef(lua_State* L);
 
+		static int GetPackedFromSynced(lua_State* L);
+
 	protected:
 		CSplitLuaHandle& base;
 };
@@ -153,6 +156,7 @@ class CSyncedLuaHandle : public CLuaHandle
 		static int SyncedPairs(lua_State* L);
 
 		static int SendToUnsynced(lua_State* L);
+		static int SendPackedToUnsynced(lua_State* L);
 
 		static int AddSyncedActionFallback(lua_State* L);
 		static int RemoveSyncedActionFallback(lua_State* L);
@@ -269,12 +273,15 @@ class CSplitLuaHandle
 		// call-outs
 		static int CallAsTeam(lua_State* L);
 
+		// written by the synced half, read by the unsynced one
+		LuaPackedChannels packedChannels;
+
 	public:
 		CSyncedLuaHandle syncedLuaHandle;
 		CUnsyncedLuaHandle unsyncedLuaHandle;
 
 	public:
-		static void ClearGameParams() { spring::clear_unordered_map(gameParams); }
+		static void ClearGameParams() { gameParams.Clear(); }
 		static const LuaRulesParams::Params& GetGameParams() { return gameParams; }
 
 	private:
@@ -9,6 +9,7 @@
 #include "System/MainDefines.h"
 #include "System/SafeUtil.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/AllocCounter.h"
 #include "System/Threading/SpringThreading.h"
 #include "lib/fmt/printf.h"
 
@@ -68,6 +69,9 @@ void LuaMemPool::ReleasePtr(LuaMemPool* p, const CLuaHandle* o)
 		return;
 	}
 
+	// the state is closed by now; hand the arena back right away instead of on reuse
+	p->Clear();
+
 	gMutex.lock();
 	gIndcs.push_back(p->GetGlobalIndex());
 	gMutex.unlock();
@@ -94,43 +98,130 @@ LuaMemPool::LuaMemPool(bool isEnabled): LuaMemPool(size_t(-1)) { assert(isEnable
 LuaMemPool::LuaMemPool(size_t lmpIndex): globalIndex(lmpIndex)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (!LuaMemPool::enabled)
-		return;
+}
+
+
+size_t LuaMemPool::GetSizeClass(size_t size)
+{
+	// indexed by the size in units of MIN_CLASS_SIZE, rounded up
+	static constexpr auto CLASS_TABLE = []() {
+		std::array<uint8_t, MAX_CLASS_SIZE / MIN_CLASS_SIZE + 1> table = {};
+
+		for (size_t i = 0, c = 0; i < table.size(); i++) {
+			while (GetClassSize(c) < i * MIN_CLASS_SIZE)
+				c++;
+
+			table[i] = static_cast<uint8_t>(c);
+		}
 
-	luaMemPoolImpl = std::make_unique<LuaMemPool::LuaMemPoolImpl>();
+		return table;
+	}();
+
+	static_assert(GetClassSize(NUM_SIZE_CLASSES - 1) == MAX_CLASS_SIZE);
+
+	if (size > MAX_CLASS_SIZE)
+		return NUM_SIZE_CLASSES;
+
+	return CLASS_TABLE[(size + MIN_CLASS_SIZE - 1) / MIN_CLASS_SIZE];
 }
 
+
 void LuaMemPool::Clear()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	//allocStats = {};
+	// arena blocks are never handed back one by one; the whole lot goes at once
+	for (uint8_t* chunk: chunks) {
+		::operator delete(chunk);
+	}
+
+	chunks.clear();
+	sizeClasses = {};
+
+	chunkPos = nullptr;
+	chunkEnd = nullptr;
+}
+
+void* LuaMemPool::AllocSmall(size_t sizeClass)
+{
+	SizeClass& sc = sizeClasses[sizeClass];
+	sc.numAllocs += 1;
+
+	if (sc.freeList != nullptr) {
+		FreeBlock* block = sc.freeList;
+
+		sc.freeList = block->next;
+		sc.numReused += 1;
+		return block;
+	}
+
+	const size_t blockSize = GetClassSize(sizeClass);
+
+	if (sc.slabPos == sc.slabEnd) {
+		// carve the next slab for this class out of the current chunk, or start a new
+		// one; the tail of a chunk too small for even one block is left unused
+		if (static_cast<size_t>(chunkEnd - chunkPos) < blockSize) {
+			chunks.push_back(static_cast<uint8_t*>(::operator new(CHUNK_SIZE)));
+
+			chunkPos = chunks.back();
+			chunkEnd = chunkPos + CHUNK_SIZE;
+		}
+
+		const size_t numBlocks = std::min(SLAB_SIZE / blockSize, static_cast<size_t>(chunkEnd - chunkPos) / blockSize);
+
+		sc.slabPos = chunkPos;
+		sc.slabEnd = chunkPos + numBlocks * blockSize;
+		sc.numSlabs += 1;
+
+		chunkPos = sc.slabEnd;
+	}
+
+	void* block = sc.slabPos;
+	sc.slabPos += blockSize;
+	return block;
+}
+
+void LuaMemPool::FreeSmall(void* ptr, size_t sizeClass)
+{
+	SizeClass& sc = sizeClasses[sizeClass];
+	FreeBlock* block = static_cast<FreeBlock*>(ptr);
+
+	block->next = sc.freeList;
+	sc.freeList = block;
+	sc.numFrees += 1;
 }
 
+void* LuaMemPool::AllocLarge(size_t size) { return ::operator new(size); }
+void LuaMemPool::FreeLarge(void* ptr) { ::operator delete(ptr); }
+
+
 void* LuaMemPool::Alloc(size_t size)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (!LuaMemPool::enabled) {
+	const size_t sizeClass = LuaMemPool::enabled? GetSizeClass(size): NUM_SIZE_CLASSES;
+
+	if (sizeClass == NUM_SIZE_CLASSES) {
 		allocStats[STAT_NAE] += 1 * (size > 0);
 		allocStats[STAT_NBE] += size;
 		auto t0 = spring_now();
-		void* ptr = ::operator new(size);
+		void* ptr = AllocLarge(size);
 		allocStats[STAT_NTE] += (spring_now() - t0).toMicroSecsi();
 		return ptr;
 	}
 
+	const uint64_t numReused = sizeClasses[sizeClass].numReused;
+
+	// large blocks and chunks come from operator new and are counted there
+	CAllocCounter::CountLua(size);
+
 	auto t0 = spring_now();
-	auto* ptr = luaMemPoolImpl->allocMem(size);
-	
-	if (size > NUM_BUCKETS * BUCKET_STEP) {
-		allocStats[STAT_NAE] += 1 * (size > 0);
-		allocStats[STAT_NBE] += size;
-		allocStats[STAT_NTE] += (spring_now() - t0).toMicroSecsi();
-	} else if (luaMemPoolImpl->isAllocInternal(ptr)) {
-		allocStats[STAT_NAI] += 1 * (size > 0);
+	void* ptr = AllocSmall(sizeClass);
+
+	if (sizeClasses[sizeClass].numReused != numReused) {
+		allocStats[STAT_NAI] += 1;
 		allocStats[STAT_NBI] += size;
 		allocStats[STAT_NTI] += (spring_now() - t0).toMicroSecsi();
 	} else {
-		allocStats[STAT_NAF] += 1 * (size > 0);
+		allocStats[STAT_NAF] += 1;
 		allocStats[STAT_NBF] += size;
 		allocStats[STAT_NTF] += (spring_now() - t0).toMicroSecsi();
 	}
@@ -144,65 +235,50 @@ void* LuaMemPool::Realloc(void* ptr, size_t nsize, size_t osize)
 	if (ptr == nullptr || osize == 0)
 		return Alloc(nsize);
 
-	if (!LuaMemPool::enabled) {
-		void* newPtr = ::operator new(nsize);
+	if (LuaMemPool::enabled) {
+		const size_t oldClass = GetSizeClass(osize);
 
-		if (newPtr == nullptr)
-			return nullptr;
-
-		allocStats[STAT_NBE] -= osize;
-		allocStats[STAT_NBE] += nsize;
+		// tables and strings often grow or shrink within a single class
+		if (oldClass < NUM_SIZE_CLASSES && oldClass == GetSizeClass(nsize))
+			return ptr;
+	}
 
-		auto t0 = spring_now();
-		std::memcpy(newPtr, ptr, std::min(nsize, osize));
-		std::memset(ptr, 0, osize);
-		::operator delete(ptr);
-		allocStats[STAT_NTE] += (spring_now() - t0).toMicroSecsi();
+	void* newPtr = Alloc(nsize);
 
-		return newPtr;
-	}
+	if (newPtr == nullptr)
+		return nullptr;
 
-	auto t0 = spring_now();
-	auto* ret = luaMemPoolImpl->reAllocMem(ptr, nsize);
-	if (nsize > NUM_BUCKETS * BUCKET_STEP) {
-		allocStats[STAT_NAE] += 1 * (nsize > 0);
-		allocStats[STAT_NBE] += nsize;
-		allocStats[STAT_NTE] += (spring_now() - t0).toMicroSecsi();
-	}
-	else if (luaMemPoolImpl->isAllocInternal(ret)) {
-		allocStats[STAT_NAI] += 1 * (nsize > 0);
-		allocStats[STAT_NBI] += nsize;
-		allocStats[STAT_NTI] += (spring_now() - t0).toMicroSecsi();
-	}
-	else {
-		allocStats[STAT_NAF] += 1 * (nsize > 0);
-		allocStats[STAT_NBF] += nsize;
-		allocStats[STAT_NTF] += (spring_now() - t0).toMicroSecsi();
-	}
-	return ret;
+	std::memcpy(newPtr, ptr, std::min(nsize, osize));
+	Free(ptr, osize);
+	return newPtr;
 }
 
 void LuaMemPool::Free(void* ptr, size_t size)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (!LuaMemPool::enabled) {
-		::operator delete(ptr);
+	if (ptr == nullptr)
+		return;
+
+	const size_t sizeClass = LuaMemPool::enabled? GetSizeClass(size): NUM_SIZE_CLASSES;
+
+	if (sizeClass == NUM_SIZE_CLASSES) {
+		FreeLarge(ptr);
 		return;
 	}
 
-	luaMemPoolImpl->freeMem(ptr);
+	FreeSmall(ptr, sizeClass);
 }
 
 void LuaMemPool::LogStats(const char* handle, const char* lctype)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	static constexpr auto one = uint64_t(1);
-	const float intPerc = 100.0f * static_cast<float>(allocStats[STAT_NAI]) / static_cast<float>(std::max(allocStats[STAT_NAI] + allocStats[STAT_NAF] + allocStats[STAT_NAE], one));
+	const float intPerc = 100.0f * static_cast<float>(allocStats[STAT_NAI] + allocStats[STAT_NAF]) / static_cast<float>(std::max(allocStats[STAT_NAI] + allocStats[STAT_NAF] + allocStats[STAT_NAE], one));
 	const float avgAllocTimeI = static_cast<float>(allocStats[STAT_NTI]) / static_cast<float>(std::max(allocStats[STAT_NAI], one));
 	const float avgAllocTimeF = static_cast<float>(allocStats[STAT_NTF]) / static_cast<float>(std::max(allocStats[STAT_NAF], one));
 	const float avgAllocTimeE = static_cast<float>(allocStats[STAT_NTE]) / static_cast<float>(std::max(allocStats[STAT_NAE], one));
 	std::string msg = fmt::sprintf(
-		"[LuaMemPool::%s][handle=%s (%s)] index=%u numAllocs{int+, int-, ext, int_p}={%u, %u, %u, %.1f} allocedSize{int+, int-, ext}={%u, %u, %u}, avgAllocTime{int+, int-, ext}={%.4f, %.4f, %.4f}, cumAllocTime={int+, int-, ext}={%u, %u, %u}",
+		"[LuaMemPool::%s][handle=%s (%s)] index=%u numAllocs{int+, int-, ext, int_p}={%u, %u, %u, %.1f} allocedSize{int+, int-, ext}={%u, %u, %u}, avgAllocTime{int+, int-, ext}={%.4f, %.4f, %.4f}, cumAllocTime={int+, int-, ext}={%u, %u, %u} arenaSize=%uKB",
 		__func__,
 		handle,
 		lctype,
@@ -219,8 +295,31 @@ void LuaMemPool::LogStats(const char* handle, const char* lctype)
 		avgAllocTimeE,
 		allocStats[STAT_NTI],
 		allocStats[STAT_NTF],
-		allocStats[STAT_NTE]
+		allocStats[STAT_NTE],
+		(chunks.size() * CHUNK_SIZE) / 1024
 	);
 	LOG("%s", msg.c_str());
+
+	// per-class hit rate (share of allocs served by a recycled block), live blocks and slabs
+	msg = fmt::sprintf("[LuaMemPool::%s][handle=%s (%s)] sizeClasses{size: hit%%, allocs, live, slabs}={", __func__, handle, lctype);
+
+	for (size_t i = 0; i < NUM_SIZE_CLASSES; i++) {
+		const SizeClass& sc = sizeClasses[i];
+
+		if (sc.numAllocs == 0)
+			continue;
+
+		msg += fmt::sprintf(
+			"%u: %.1f, %u, %u, %u; ",
+			GetClassSize(i),
+			100.0f * static_cast<float>(sc.numReused) / static_cast<float>(sc.numAllocs),
+			sc.numAllocs,
+			sc.numAllocs - sc.numFrees,
+			sc.numSlabs
+		);
+	}
+
+	msg += "}";
+	LOG("%s", msg.c_str());
 	allocStats = {};
 }
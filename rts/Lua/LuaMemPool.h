@@ -2,29 +2,34 @@
 
 #pragma once
 
+#include <array>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
-#include <memory>
 
-#include "System/MemPoolTypes.h"
 #include "System/UnorderedMap.hpp"
 
 #define LMP_USE_CHUNK_TABLE 0
 
 class CLuaHandle;
+
+/**
+ * Arena backing the allocations of one Lua state. Blocks up to MAX_CLASS_SIZE
+ * are rounded up to one of NUM_SIZE_CLASSES classes, each with its own free
+ * list and slabs carved out of CHUNK_SIZE chunks; larger blocks go straight to
+ * the system allocator. Lua passes the old size to every free and realloc, so
+ * blocks carry no header.
+ *
+ * A non-shared pool is only touched by the thread running its state, so none
+ * of this is synchronized. Clear() drops all chunks at once; it runs when a
+ * pool is released (e.g. by /luaui reload) and again when it is reacquired.
+ */
 class LuaMemPool {
 public:
 	explicit LuaMemPool(bool isEnabled);
 	explicit LuaMemPool(size_t lmpIndex);
 
-	~LuaMemPool() {
-		Clear();
-
-		if (!LuaMemPool::enabled)
-			return;
-
-		luaMemPoolImpl = nullptr;
-	}
+	~LuaMemPool() { Clear(); }
 
 	LuaMemPool(const LuaMemPool& p) = delete;
 	LuaMemPool(LuaMemPool&& p) = delete;
@@ -57,15 +62,56 @@ public:
 
 public:
 	static bool enabled;
+
+	// 16 to 128 in steps of 16, then four classes per power of two up to 4096
+	static constexpr size_t NUM_SIZE_CLASSES = 8 + 5 * 4;
+	static constexpr size_t MIN_CLASS_SIZE = 16;
+	static constexpr size_t MAX_CLASS_SIZE = 4096;
+	static constexpr size_t SLAB_SIZE = 16 * 1024;
+	static constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+	static constexpr size_t GetClassSize(size_t sizeClass) {
+		if (sizeClass < 8)
+			return ((sizeClass + 1) * MIN_CLASS_SIZE);
+
+		const size_t base = size_t(128) << ((sizeClass - 8) / 4);
+		return (base + (base / 4) * ((sizeClass - 8) % 4 + 1));
+	}
+	// returns NUM_SIZE_CLASSES for sizes not served from the arena
+	static size_t GetSizeClass(size_t size);
+
 private:
-	static constexpr uint32_t NUM_BUCKETS = 32;
-	static constexpr uint32_t BUCKET_STEP = 16;
-	using LuaMemPoolImpl = PassThroughPool<NUM_BUCKETS, 4 * (1024 * 1024)>;
-	std::unique_ptr<LuaMemPoolImpl> luaMemPoolImpl;
+	void* AllocSmall(size_t sizeClass);
+	void FreeSmall(void* ptr, size_t sizeClass);
+	void* AllocLarge(size_t size);
+	void FreeLarge(void* ptr);
+
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	struct SizeClass {
+		FreeBlock* freeList = nullptr;
+
+		// unused part of the slab this class is currently carving from
+		uint8_t* slabPos = nullptr;
+		uint8_t* slabEnd = nullptr;
+
+		uint64_t numAllocs = 0;
+		uint64_t numReused = 0; // allocs served from freeList
+		uint64_t numFrees = 0;
+		uint64_t numSlabs = 0;
+	};
+
+	std::array<SizeClass, NUM_SIZE_CLASSES> sizeClasses;
+	std::vector<uint8_t*> chunks;
+
+	uint8_t* chunkPos = nullptr;
+	uint8_t* chunkEnd = nullptr;
 
 	enum {
-		STAT_NAI = 0, // number of internal allocs
-		STAT_NAF = 1, // number of int fail allocs
+		STAT_NAI = 0, // number of internal allocs (reused block)
+		STAT_NAF = 1, // number of internal allocs (fresh block from a slab)
 		STAT_NAE = 2, // number of external allocs
 		STAT_NBI = 3, // number of bytes alloced (internal)
 		STAT_NBF = 4, // number of bytes alloced (int fail)
@@ -0,0 +1,272 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaPackedChannels.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#include "LuaInclude.h"
+#include "LuaHashString.h"
+#include "LuaUtils.h"
+#include "Sim/Misc/GlobalSynced.h"
+
+#include "System/Misc/TracyDefs.h"
+
+
+static constexpr const char* VIEW_METATABLE = "PackedChannelView";
+static constexpr uint32_t MAX_RECORD_FIELDS = 64;
+
+
+template<typename T> static void StoreValue(uint8_t* dst, lua_Number value)
+{
+	T v;
+
+	if constexpr (std::is_integral_v<T>) {
+		// out-of-range float to int conversions are undefined
+		v = static_cast<T>(std::clamp(value, lua_Number(std::numeric_limits<T>::min()), lua_Number(std::numeric_limits<T>::max())));
+	} else {
+		v = static_cast<T>(value);
+	}
+
+	std::memcpy(dst, &v, sizeof(T));
+}
+
+template<typename T> static lua_Number LoadValue(const uint8_t* src)
+{
+	T v;
+	std::memcpy(&v, src, sizeof(T));
+	return static_cast<lua_Number>(v);
+}
+
+static uint32_t GetTypeSize(char type)
+{
+	switch (type) {
+		case 'f': case 'i': case 'I': return 4;
+		case 'h': case 'H':           return 2;
+		case 'b': case 'B':           return 1;
+		default: {} break;
+	}
+
+	return 0;
+}
+
+static void StoreField(uint8_t* dst, char type, lua_Number value)
+{
+	switch (type) {
+		case 'f': { StoreValue<   float>(dst, value); } break;
+		case 'i': { StoreValue< int32_t>(dst, value); } break;
+		case 'I': { StoreValue<uint32_t>(dst, value); } break;
+		case 'h': { StoreValue< int16_t>(dst, value); } break;
+		case 'H': { StoreValue<uint16_t>(dst, value); } break;
+		case 'b': { StoreValue<  int8_t>(dst, value); } break;
+		case 'B': { StoreValue< uint8_t>(dst, value); } break;
+		default: { assert(false); } break;
+	}
+}
+
+
+/******************************************************************************/
+
+bool LuaPackedChannels::CreateMetatable(lua_State* L)
+{
+	luaL_newmetatable(L, VIEW_METATABLE);
+	HSTR_PUSH_CFUNC(L, "__len", meta_len);
+
+	HSTR_PUSH(L, "__index");
+	lua_createtable(L, 0, 5);
+	HSTR_PUSH_CFUNC(L, "Count",     meta_len);
+	HSTR_PUSH_CFUNC(L, "Get",       meta_Get);
+	HSTR_PUSH_CFUNC(L, "GetField",  meta_GetField);
+	HSTR_PUSH_CFUNC(L, "GetFrame",  meta_GetFrame);
+	HSTR_PUSH_CFUNC(L, "GetFormat", meta_GetFormat);
+	lua_rawset(L, -3);
+
+	lua_pop(L, 1);
+	return true;
+}
+
+
+bool LuaPackedChannels::ParseFormat(const char* format, Channel& channel)
+{
+	channel.format = format;
+	channel.fields.clear();
+	channel.stride = 0;
+
+	for (const char* c = format; *c != 0; c++) {
+		const uint32_t size = GetTypeSize(*c);
+
+		if (size == 0 || channel.fields.size() >= MAX_RECORD_FIELDS)
+			return false;
+
+		channel.fields.push_back({*c, static_cast<uint8_t>(channel.stride)});
+		channel.stride += size;
+	}
+
+	return (!channel.fields.empty());
+}
+
+uint32_t LuaPackedChannels::GetChannelIndex(const std::string& name)
+{
+	const auto it = channelIndices.find(name);
+
+	if (it != channelIndices.end())
+		return it->second;
+
+	channels.emplace_back();
+	channelIndices.emplace(name, static_cast<uint32_t>(channels.size() - 1));
+
+	return static_cast<uint32_t>(channels.size() - 1);
+}
+
+
+int LuaPackedChannels::Write(lua_State* L)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::string& name = luaL_checkstring(L, 1);
+	const char* format = luaL_checkstring(L, 2);
+
+	Channel& channel = channels[GetChannelIndex(name)];
+
+	if (channel.frame != gs->frameNum) {
+		// first write in this frame, drop the previous frame's records
+		channel.data.clear();
+		channel.numRecords = 0;
+		channel.frame = gs->frameNum;
+
+		// a fresh channel has no fields but the same (empty) format as an empty argument
+		if ((channel.format != format || channel.fields.empty()) && !ParseFormat(format, channel)) {
+			channel.format.clear();
+			channel.frame = -1;
+			luaL_error(L, "[%s] invalid record format \"%s\" for channel \"%s\"", __func__, format, name.c_str());
+		}
+	} else if (channel.format != format) {
+		luaL_error(L, "[%s] record format of channel \"%s\" changed within a frame (\"%s\" vs. \"%s\")", __func__, name.c_str(), channel.format.c_str(), format);
+	}
+
+	const bool fromTable = lua_istable(L, 3);
+	const uint32_t numFields = channel.fields.size();
+	const uint32_t numValues = fromTable? lua_objlen(L, 3): std::max(lua_gettop(L) - 2, 0);
+
+	if ((numValues % numFields) != 0)
+		luaL_error(L, "[%s] %u values do not make whole records of format \"%s\"", __func__, numValues, format);
+
+	const size_t dataOffset = channel.data.size();
+	const uint32_t numRecords = numValues / numFields;
+
+	channel.data.resize(dataOffset + size_t(numRecords) * channel.stride);
+
+	uint8_t* dst = channel.data.data() + dataOffset;
+
+	for (uint32_t i = 0; i < numValues; i++) {
+		const Field& field = channel.fields[i % numFields];
+		lua_Number value;
+
+		if (fromTable) {
+			lua_rawgeti(L, 3, i + 1);
+			value = lua_tonumber(L, -1);
+			lua_pop(L, 1);
+		} else {
+			value = luaL_checknumber(L, 3 + i);
+		}
+
+		StoreField(dst + field.offset, field.type, value);
+
+		if ((i % numFields) == (numFields - 1))
+			dst += channel.stride;
+	}
+
+	channel.numRecords += numRecords;
+	return 0;
+}
+
+
+int LuaPackedChannels::PushView(lua_State* L)
+{
+	// channels are created on first access so views can be kept across frames
+	View* view = static_cast<View*>(lua_newuserdata(L, sizeof(View)));
+
+	view->owner = this;
+	view->index = GetChannelIndex(luaL_checkstring(L, 1));
+
+	luaL_getmetatable(L, VIEW_METATABLE);
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
+
+/******************************************************************************/
+
+const LuaPackedChannels::Channel& LuaPackedChannels::GetViewChannel(lua_State* L)
+{
+	const View* view = static_cast<const View*>(luaL_checkudata(L, 1, VIEW_METATABLE));
+	return view->owner->channels[view->index];
+}
+
+void LuaPackedChannels::PushField(lua_State* L, const Channel& channel, uint32_t record, uint32_t field)
+{
+	const Field& f = channel.fields[field];
+	const uint8_t* src = channel.data.data() + size_t(record) * channel.stride + f.offset;
+
+	switch (f.type) {
+		case 'f': { lua_pushnumber(L, LoadValue<   float>(src)); } break;
+		case 'i': { lua_pushnumber(L, LoadValue< int32_t>(src)); } break;
+		case 'I': { lua_pushnumber(L, LoadValue<uint32_t>(src)); } break;
+		case 'h': { lua_pushnumber(L, LoadValue< int16_t>(src)); } break;
+		case 'H': { lua_pushnumber(L, LoadValue<uint16_t>(src)); } break;
+		case 'b': { lua_pushnumber(L, LoadValue<  int8_t>(src)); } break;
+		case 'B': { lua_pushnumber(L, LoadValue< uint8_t>(src)); } break;
+		default: { lua_pushnil(L); } break;
+	}
+}
+
+
+int LuaPackedChannels::meta_len(lua_State* L)
+{
+	lua_pushnumber(L, GetViewChannel(L).numRecords);
+	return 1;
+}
+
+int LuaPackedChannels::meta_Get(lua_State* L)
+{
+	const Channel& channel = GetViewChannel(L);
+	const uint32_t record = luaL_checkint(L, 2) - 1;
+
+	if (record >= channel.numRecords)
+		return 0;
+
+	luaL_checkstack(L, channel.fields.size(), __func__);
+
+	for (uint32_t field = 0; field < channel.fields.size(); field++) {
+		PushField(L, channel, record, field);
+	}
+
+	return channel.fields.size();
+}
+
+int LuaPackedChannels::meta_GetField(lua_State* L)
+{
+	const Channel& channel = GetViewChannel(L);
+	const uint32_t record = luaL_checkint(L, 2) - 1;
+	const uint32_t field = luaL_checkint(L, 3) - 1;
+
+	if (record >= channel.numRecords || field >= channel.fields.size())
+		return 0;
+
+	PushField(L, channel, record, field);
+	return 1;
+}
+
+int LuaPackedChannels::meta_GetFrame(lua_State* L)
+{
+	lua_pushnumber(L, GetViewChannel(L).frame);
+	return 1;
+}
+
+int LuaPackedChannels::meta_GetFormat(lua_State* L)
+{
+	lua_pushsstring(L, GetViewChannel(L).format);
+	return 1;
+}
@@ -0,0 +1,81 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_PACKED_CHANNELS_H
+#define LUA_PACKED_CHANNELS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/UnorderedMap.hpp"
+
+struct lua_State;
+
+
+/**
+ * Binary channels from the synced to the unsynced half of a split handle.
+ *
+ * Synced code appends fixed-format records to a named channel; the records
+ * written during one sim frame replace those of the previous frame that
+ * wrote to the channel. Unsynced code reads them through a userdata view
+ * that always reflects the current contents, no Lua tables are created or
+ * copied on either side.
+ *
+ * Format characters: f = float, i/I = (u)int32, h/H = (u)int16, b/B = (u)int8
+ */
+class LuaPackedChannels {
+	public:
+		void Clear() {
+			channels.clear();
+			channelIndices.clear();
+		}
+
+		// SendPackedToUnsynced(name, format, values... | {values})
+		int Write(lua_State* L);
+		// GetPackedFromSynced(name) -> view
+		int PushView(lua_State* L);
+
+		static bool CreateMetatable(lua_State* L);
+
+	private:
+		struct Field {
+			char type;
+			uint8_t offset;
+		};
+
+		struct Channel {
+			std::string format;
+			std::vector<Field> fields;
+			std::vector<uint8_t> data;
+
+			uint32_t stride = 0;
+			uint32_t numRecords = 0;
+
+			// sim frame the records were written in
+			int frame = -1;
+		};
+
+		struct View {
+			const LuaPackedChannels* owner;
+			uint32_t index;
+		};
+
+		uint32_t GetChannelIndex(const std::string& name);
+
+		static bool ParseFormat(const char* format, Channel& channel);
+		static const Channel& GetViewChannel(lua_State* L);
+		static void PushField(lua_State* L, const Channel& channel, uint32_t record, uint32_t field);
+
+	private:
+		std::vector<Channel> channels;
+		spring::unordered_map<std::string, uint32_t> channelIndices;
+
+	private: // metatable methods
+		static int meta_len(lua_State* L);
+		static int meta_Get(lua_State* L);
+		static int meta_GetField(lua_State* L);
+		static int meta_GetFrame(lua_State* L);
+		static int meta_GetFormat(lua_State* L);
+};
+
+#endif /* LUA_PACKED_CHANNELS_H */
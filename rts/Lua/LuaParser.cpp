@@ -5,6 +5,8 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstring>
+#include <fstream>
 
 #include "lib/streflop/streflop_cond.h"
 
@@ -24,6 +26,7 @@
 #include "System/Log/ILog.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Misc/SpringTime.h"
+#include "System/Misc/StartupTrace.h"
 #include "System/ContainerUtil.h"
 #include "System/TimeProfiler.h"
 #include "System/ScopedFPUSettings.h"
@@ -243,6 +246,8 @@ bool LuaParser::Execute()
 	char errorBuf[4096] = {0};
 	int errorNum = 0;
 
+	SCOPED_STARTUP_TRACE("LuaParser::Execute(" + codeLabel + ")", "lua")
+
 	LuaUtils::TracyRemoveAlsoExtras(code.data());
 	if ((errorNum = luaL_loadbuffer(L, code.c_str(), code.size(), codeLabel.c_str())) != 0) {
 		SNPRINTF(errorBuf, sizeof(errorBuf), "[loadbuf] error %d (\"%s\") in %s", errorNum, lua_tostring(L, -1), codeLabel.c_str());
@@ -299,6 +304,353 @@ bool LuaParser::Execute()
 }
 
 
+/******************************************************************************/
+//
+//  root table cache
+//
+//  blob := magic | u32 keySize | key | value
+//  value := u8 tag | number | u32 size, chars | u8 bool | u32 narr, u32 nrec, (value value)*
+//
+//  table keys are written in sorted order so the rebuilt tables come out the
+//  same regardless of how the source tables were grown by the defs scripts
+//
+
+static constexpr char CACHE_MAGIC[] = "LuaParserCache-1";
+static constexpr int CACHE_MAX_DEPTH = 64;
+
+enum {
+	CACHE_TAG_NUMBER  = 1,
+	CACHE_TAG_STRING  = 2,
+	CACHE_TAG_BOOLEAN = 3,
+	CACHE_TAG_TABLE   = 4,
+};
+
+struct CacheTableKey {
+	int type;
+	lua_Number num;
+	std::string str;
+
+	bool operator < (const CacheTableKey& k) const {
+		if (type != k.type)
+			return (type < k.type);
+		if (type == LUA_TSTRING)
+			return (str < k.str);
+
+		return (num < k.num);
+	}
+};
+
+template<typename T> static void AppendCacheData(std::string& blob, const T& v) {
+	blob.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template<typename T> static bool ReadCacheData(const char*& ptr, const char* end, T& v) {
+	if (size_t(end - ptr) < sizeof(T))
+		return false;
+
+	std::memcpy(&v, ptr, sizeof(T));
+	ptr += sizeof(T);
+	return true;
+}
+
+static bool SerializeCacheValue(lua_State* L, int index, std::string& blob, std::vector<const void*>& path);
+static bool SerializeCacheTable(lua_State* L, int index, std::string& blob, std::vector<const void*>& path)
+{
+	luaL_checkstack(L, 4, __func__);
+
+	const void* p = lua_topointer(L, index);
+
+	// metatables can not be restored, cycles can not be flattened
+	if (path.size() >= CACHE_MAX_DEPTH || std::find(path.begin(), path.end(), p) != path.end())
+		return false;
+	if (lua_getmetatable(L, index) != 0) {
+		lua_pop(L, 1);
+		return false;
+	}
+
+	std::vector<CacheTableKey> keys;
+
+	for (lua_pushnil(L); lua_next(L, index) != 0; lua_pop(L, 1)) {
+		switch (lua_type(L, -2)) {
+			case LUA_TNUMBER : { keys.push_back({LUA_TNUMBER , lua_tonumber(L, -2), {}}); } break;
+			case LUA_TBOOLEAN: { keys.push_back({LUA_TBOOLEAN, lua_Number(lua_toboolean(L, -2)), {}}); } break;
+			case LUA_TSTRING : {
+				size_t len = 0;
+				const char* str = lua_tolstring(L, -2, &len);
+				keys.push_back({LUA_TSTRING, 0, {str, len}});
+			} break;
+			default: {
+				lua_pop(L, 2);
+				return false;
+			} break;
+		}
+	}
+
+	std::stable_sort(keys.begin(), keys.end());
+
+	uint32_t narr = 0;
+
+	// length of the 1..n sequence, numbers sort before strings
+	while (narr < keys.size() && keys[narr].type == LUA_TNUMBER && keys[narr].num == lua_Number(narr + 1))
+		narr++;
+
+	AppendCacheData(blob, narr);
+	AppendCacheData(blob, uint32_t(keys.size() - narr));
+
+	path.push_back(p);
+
+	for (const CacheTableKey& key: keys) {
+		switch (key.type) {
+			case LUA_TNUMBER : { lua_pushnumber(L, key.num); } break;
+			case LUA_TBOOLEAN: { lua_pushboolean(L, key.num != 0); } break;
+			case LUA_TSTRING : { lua_pushsstring(L, key.str); } break;
+		}
+
+		SerializeCacheValue(L, -1, blob, path);
+		lua_rawget(L, index);
+
+		if (!SerializeCacheValue(L, lua_gettop(L), blob, path)) {
+			lua_pop(L, 1);
+			return false;
+		}
+
+		lua_pop(L, 1);
+	}
+
+	path.pop_back();
+	return true;
+}
+
+static bool SerializeCacheValue(lua_State* L, int index, std::string& blob, std::vector<const void*>& path)
+{
+	if (index < 0)
+		index = lua_gettop(L) + index + 1;
+
+	switch (lua_type(L, index)) {
+		case LUA_TNUMBER: {
+			AppendCacheData(blob, uint8_t(CACHE_TAG_NUMBER));
+			AppendCacheData(blob, lua_tonumber(L, index));
+		} break;
+		case LUA_TBOOLEAN: {
+			AppendCacheData(blob, uint8_t(CACHE_TAG_BOOLEAN));
+			AppendCacheData(blob, uint8_t(lua_toboolean(L, index)));
+		} break;
+		case LUA_TSTRING: {
+			size_t len = 0;
+			const char* str = lua_tolstring(L, index, &len);
+
+			AppendCacheData(blob, uint8_t(CACHE_TAG_STRING));
+			AppendCacheData(blob, uint32_t(len));
+			blob.append(str, len);
+		} break;
+		case LUA_TTABLE: {
+			AppendCacheData(blob, uint8_t(CACHE_TAG_TABLE));
+			return (SerializeCacheTable(L, index, blob, path));
+		} break;
+		default: {
+			// functions, userdata, threads
+			return false;
+		} break;
+	}
+
+	return true;
+}
+
+// pushes the value on success, leaves the stack untouched otherwise
+static bool DeserializeCacheValue(lua_State* L, const char*& ptr, const char* end, int depth)
+{
+	uint8_t tag = 0;
+
+	if (!ReadCacheData(ptr, end, tag))
+		return false;
+
+	switch (tag) {
+		case CACHE_TAG_NUMBER: {
+			lua_Number num = 0;
+
+			if (!ReadCacheData(ptr, end, num))
+				return false;
+
+			lua_pushnumber(L, num);
+		} break;
+		case CACHE_TAG_BOOLEAN: {
+			uint8_t b = 0;
+
+			if (!ReadCacheData(ptr, end, b))
+				return false;
+
+			lua_pushboolean(L, b != 0);
+		} break;
+		case CACHE_TAG_STRING: {
+			uint32_t len = 0;
+
+			if (!ReadCacheData(ptr, end, len) || size_t(end - ptr) < len)
+				return false;
+
+			lua_pushlstring(L, ptr, len);
+			ptr += len;
+		} break;
+		case CACHE_TAG_TABLE: {
+			uint32_t narr = 0;
+			uint32_t nrec = 0;
+
+			if (depth >= CACHE_MAX_DEPTH)
+				return false;
+			if (!ReadCacheData(ptr, end, narr) || !ReadCacheData(ptr, end, nrec))
+				return false;
+			// every pair takes at least four bytes, reject sizes a corrupt file might claim
+			if ((uint64_t(narr) + nrec) * 4 > uint64_t(end - ptr))
+				return false;
+
+			luaL_checkstack(L, 4, __func__);
+			lua_createtable(L, narr, nrec);
+
+			for (uint32_t i = 0, n = narr + nrec; i < n; i++) {
+				if (!DeserializeCacheValue(L, ptr, end, depth + 1)) {
+					lua_pop(L, 1);
+					return false;
+				}
+				// never written as keys, NaN would raise an error in lua_rawset
+				if (lua_istable(L, -1) || (lua_type(L, -1) == LUA_TNUMBER && lua_tonumber(L, -1) != lua_tonumber(L, -1))) {
+					lua_pop(L, 2);
+					return false;
+				}
+				if (!DeserializeCacheValue(L, ptr, end, depth + 1)) {
+					lua_pop(L, 2);
+					return false;
+				}
+
+				lua_rawset(L, -3);
+			}
+		} break;
+		default: {
+			return false;
+		} break;
+	}
+
+	return true;
+}
+
+
+bool LuaParser::ExecuteCached(const std::string& cacheFile, const std::string& cacheKey)
+{
+	cacheHit = false;
+	cacheable = true;
+
+	if (!IsValid())
+		return (Execute());
+
+	if (!cacheFile.empty() && (cacheHit = LoadCache(cacheFile, cacheKey)))
+		return true;
+
+	if (!Execute())
+		return false;
+
+	if (!cacheable) {
+		LOG("[LuaParser::%s] not caching %s (used uncacheable functions)", __func__, fileName.c_str());
+		return true;
+	}
+
+	std::string blob;
+
+	blob.append(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	AppendCacheData(blob, uint32_t(cacheKey.size()));
+	blob.append(cacheKey);
+
+	// swap in the rebuilt tables even when not writing the cache, so that
+	// clients with and without a cache hit hold identically built tables
+	if (!RebuildRoot(blob)) {
+		LOG("[LuaParser::%s] not caching %s (tables hold uncacheable values)", __func__, fileName.c_str());
+		return true;
+	}
+
+	if (cacheFile.empty())
+		return true;
+
+	std::ofstream ofs(cacheFile, std::ios::binary | std::ios::trunc);
+
+	if (!ofs.write(blob.data(), blob.size()))
+		LOG_L(L_WARNING, "[LuaParser::%s] could not write cache-file \"%s\"", __func__, cacheFile.c_str());
+
+	return true;
+}
+
+bool LuaParser::RebuildRoot(std::string& blob)
+{
+	std::vector<const void*> path;
+
+	const size_t valuesPos = blob.size();
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, rootRef);
+
+	if (!SerializeCacheValue(L, -1, blob, path)) {
+		lua_settop(L, 0);
+		return false;
+	}
+
+	lua_settop(L, 0);
+
+	const char* ptr = blob.data() + valuesPos;
+	const char* end = blob.data() + blob.size();
+
+	if (!DeserializeCacheValue(L, ptr, end, 0)) {
+		assert(false);
+		return false;
+	}
+
+	luaL_unref(L, LUA_REGISTRYINDEX, rootRef);
+
+	rootRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	lua_settop(L, 0);
+	return true;
+}
+
+bool LuaParser::LoadCache(const std::string& cacheFile, const std::string& cacheKey)
+{
+	std::ifstream ifs(cacheFile, std::ios::binary);
+
+	if (!ifs.is_open())
+		return false;
+
+	const std::string blob = {std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+
+	const char* ptr = blob.data();
+	const char* end = blob.data() + blob.size();
+
+	uint32_t keySize = 0;
+
+	if (blob.size() < sizeof(CACHE_MAGIC) || std::memcmp(ptr, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0)
+		return false;
+
+	ptr += sizeof(CACHE_MAGIC);
+
+	if (!ReadCacheData(ptr, end, keySize) || size_t(end - ptr) < keySize)
+		return false;
+	// stale cache, written for different archives or options
+	if (cacheKey.compare(0, std::string::npos, ptr, keySize) != 0)
+		return false;
+
+	ptr += keySize;
+
+	assert(rootRef == LUA_NOREF);
+	assert(initDepth == 0);
+
+	if (!DeserializeCacheValue(L, ptr, end, 0) || !lua_istable(L, -1) || ptr != end) {
+		LOG_L(L_WARNING, "[LuaParser::%s] ignoring corrupt cache-file \"%s\"", __func__, cacheFile.c_str());
+		lua_settop(L, 0);
+		return false;
+	}
+
+	LOG("[LuaParser::%s] restored %s from cache-file \"%s\"", __func__, fileName.c_str(), cacheFile.c_str());
+
+	initDepth = -1;
+	rootRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	lua_settop(L, 0);
+
+	return (valid = true);
+}
+
+
 void LuaParser::AddTable(LuaTable* tbl) { spring::VectorInsertUnique(tables, tbl); }
 void LuaParser::RemoveTable(LuaTable* tbl) { spring::VectorErase(tables, tbl); }
 
@@ -397,6 +749,21 @@ void LuaParser::AddFunc(const std::string& key, int (*func)(lua_State*))
 }
 
 
+void LuaParser::AddUncacheableFunc(const std::string& key, int (*func)(lua_State*))
+{
+	if (!IsValid() || (initDepth < 0))
+		return;
+	if (func == nullptr)
+		return;
+
+	lua_pushsstring(L, key);
+	lua_pushcfunction(L, func);
+	lua_pushcclosure(L, UncacheableFunc, 1);
+
+	PushParam();
+}
+
+
 void LuaParser::AddInt(const std::string& key, int value)
 {
 	if (!IsValid() || (initDepth < 0))
@@ -533,6 +900,8 @@ int LuaParser::Random(lua_State* L)
 {
 	// both US and DS depend on LuaParser via MapParser, etc
 	#if (!defined(UNITSYNC) && !defined(DEDICATED))
+	// a cache hit would skip the draws and leave gsRNG out of sync
+	GetLuaParser(L)->cacheable = false;
 
 	switch (lua_gettop(L)) {
 		case 0: {
@@ -748,6 +1117,18 @@ int LuaParser::DontMessWithMyCase(lua_State* L)
 	return 0;
 }
 
+int LuaParser::UncacheableFunc(lua_State* L)
+{
+	GetLuaParser(L)->cacheable = false;
+
+	// forward to the wrapped function
+	lua_pushvalue(L, lua_upvalueindex(1));
+	lua_insert(L, 1);
+	lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+
+	return lua_gettop(L);
+}
+
 
 /******************************************************************************/
 /******************************************************************************/
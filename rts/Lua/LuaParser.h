@@ -132,6 +132,11 @@ public:
 	void SetupLua(bool isSyncedCtxt, bool isDefsParser);
 
 	bool Execute();
+	// like Execute, but restores the root table from <cacheFile> instead if
+	// a previous run with an equal <cacheKey> wrote it; runs that called any
+	// uncacheable function are never cached (see AddUncacheableFunc)
+	bool ExecuteCached(const std::string& cacheFile, const std::string& cacheKey);
+	bool IsCacheHit() const { return cacheHit; }
 	bool IsValid() const { return (L != nullptr); } // true if nothing failed during Execute
 	bool NoTable() const { return (errorLog.find("no return table") == 0); } // parser is still valid if true
 
@@ -156,6 +161,8 @@ public:
 	void AddBool(const std::string& key, bool value);
 	void AddFloat(const std::string& key, float value);
 	void AddString(const std::string& key, const std::string& value);
+	// for functions whose results are not covered by the cache key
+	void AddUncacheableFunc(const std::string& key, int (*func)(lua_State*));
 
 	void SetLowerKeys(bool state) { lowerKeys = state; }
 	void SetLowerCppKeys(bool state) { lowerCppKeys = state; }
@@ -173,6 +180,9 @@ private:
 	void AddTable(LuaTable* tbl);
 	void RemoveTable(LuaTable* tbl);
 
+	bool LoadCache(const std::string& cacheFile, const std::string& cacheKey);
+	bool RebuildRoot(std::string& blob);
+
 private:
 	lua_State* L = nullptr;
 	luaContextData D;
@@ -191,10 +201,13 @@ private:
 	bool valid = false;
 	bool lowerKeys = false; // convert all returned keys to lower case
 	bool lowerCppKeys = false; // convert strings in arguments keys to lower case
+	bool cacheable = true; // false if Execute called an uncacheable function
+	bool cacheHit = false;
 
 private:
 	// Weird call-outs
 	static int DontMessWithMyCase(lua_State* L);
+	static int UncacheableFunc(lua_State* L);
 
 	// Spring call-outs
 	static int RandomSeed(lua_State* L);
@@ -63,6 +63,7 @@ bool LuaPathFinder::PushEntries(lua_State* L)
 	CreatePathMetatable(L);
 
 	REGISTER_LUA_CFUNC(RequestPath);
+	REGISTER_LUA_CFUNC(RequestPaths);
 	REGISTER_LUA_CFUNC(InitPathNodeCostsArray);
 	REGISTER_LUA_CFUNC(FreePathNodeCostsArray);
 	REGISTER_LUA_CFUNC(SetPathNodeCosts);
@@ -151,6 +152,15 @@ static int path_next(lua_State* L)
 }
 
 
+static int path_pending(lua_State* L)
+{
+	const int* idPtr = (int*)luaL_checkudata(L, 1, "Path");
+	const int pathID = *idPtr;
+
+	lua_pushboolean(L, pathID != 0 && pathManager->PathSearchPending(pathID));
+	return 1;
+}
+
 static int path_nodes(lua_State* L)
 {
 	const int* idPtr = (int*)luaL_checkudata(L, 1, "Path");
@@ -176,6 +186,10 @@ static int path_index(lua_State* L)
 		lua_pushcfunction(L, path_nodes);
 		return 1;
 	}
+	if (key == "IsPending") {
+		lua_pushcfunction(L, path_pending);
+		return 1;
+	}
 	return 0;
 }
 
@@ -211,20 +225,32 @@ static void CreatePathMetatable(lua_State* L)
 /******************************************************************************/
 /******************************************************************************/
 
-int LuaPathFinder::RequestPath(lua_State* L)
+static const MoveDef* ParseMoveDef(lua_State* L, int index, const char* caller)
 {
-	const MoveDef* moveDef = nullptr;
+	if (lua_israwstring(L, index))
+		return (moveDefHandler.GetMoveDefByName(lua_tostring(L, index)));
 
-	if (lua_israwstring(L, 1)) {
-		moveDef = moveDefHandler.GetMoveDefByName(lua_tostring(L, 1));
-	} else {
-		const unsigned int pathType = luaL_checkint(L, 1);
+	const unsigned int pathType = luaL_checkint(L, index);
 
-		if (pathType >= moveDefHandler.GetNumMoveDefs())
-			luaL_error(L, "Invalid moveID passed to RequestPath");
+	if (pathType >= moveDefHandler.GetNumMoveDefs())
+		luaL_error(L, "Invalid moveID passed to %s", caller);
+
+	return (moveDefHandler.GetMoveDefByPathType(pathType));
+}
+
+static void PushPath(lua_State* L, int pathID)
+{
+	int* idPtr = (int*)lua_newuserdata(L, sizeof(int));
+	luaL_getmetatable(L, "Path");
+	lua_setmetatable(L, -2);
+
+	*idPtr = pathID;
+}
 
-		moveDef = moveDefHandler.GetMoveDefByPathType(pathType);
-	}
+
+int LuaPathFinder::RequestPath(lua_State* L)
+{
+	const MoveDef* moveDef = ParseMoveDef(L, 1, __func__);
 
 	if (moveDef == nullptr)
 		return 0;
@@ -240,11 +266,74 @@ int LuaPathFinder::RequestPath(lua_State* L)
 	if (pathID == 0)
 		return 0;
 
-	int* idPtr = (int*)lua_newuserdata(L, sizeof(int));
-	luaL_getmetatable(L, "Path");
-	lua_setmetatable(L, -2);
+	PushPath(L, pathID);
+	return 1;
+}
+
+/*
+ * RequestPaths(moveID | moveName, {{startX, startY, startZ, goalX, goalY, goalZ [, radius]}, ...} [, radius = 8])
+ *
+ * Returns an array with one Path (or false on failure) per request. Synced requests
+ * are queued and run with all other searches of the next path update, so they are
+ * not blocking the calling frame; until then Path:IsPending() returns true and the
+ * path only yields temporary waypoints. Where the pathfinder cannot defer caller-less
+ * requests (and for unsynced ones) every path is searched right away, as RequestPath
+ * does.
+ */
+int LuaPathFinder::RequestPaths(lua_State* L)
+{
+	const MoveDef* moveDef = ParseMoveDef(L, 1, __func__);
+
+	if (moveDef == nullptr)
+		return 0;
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	const float defRadius = luaL_optfloat(L, 3, 8.0f);
+
+	const bool synced = CLuaHandle::GetHandleSynced(L);
+	const bool deferred = synced && pathManager->AllowDeferredRequests();
+
+	const int numRequests = lua_objlen(L, 2);
+
+	lua_createtable(L, numRequests, 0);
+
+	for (int i = 1; i <= numRequests; i++) {
+		lua_rawgeti(L, 2, i);
+
+		if (!lua_istable(L, -1))
+			luaL_error(L, "[%s] request %d is not a table", __func__, i);
+
+		float values[7] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, defRadius};
+
+		for (int j = 0; j < 7; j++) {
+			lua_rawgeti(L, -1, j + 1);
+
+			if (lua_isnumber(L, -1)) {
+				values[j] = lua_tofloat(L, -1);
+			} else if (j < 6) {
+				luaL_error(L, "[%s] request %d needs start and goal coordinates", __func__, i);
+			}
+
+			lua_pop(L, 1);
+		}
+
+		lua_pop(L, 1);
+
+		const float3 start(values[0], values[1], values[2]);
+		const float3   end(values[3], values[4], values[5]);
+
+		const int pathID = pathManager->RequestPath(nullptr, moveDef, start, end, values[6], synced, !deferred);
+
+		if (pathID != 0) {
+			PushPath(L, pathID);
+		} else {
+			lua_pushboolean(L, false);
+		}
+
+		lua_rawseti(L, -2, i);
+	}
 
-	*idPtr = pathID;
 	return 1;
 }
 
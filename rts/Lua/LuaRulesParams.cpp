@@ -1,6 +1,10 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+
 #include "LuaRulesParams.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "System/UnorderedMap.hpp"
 #include "System/creg/STL_Variant.h"
 
 using namespace LuaRulesParams;
@@ -10,3 +14,189 @@ CR_REG_METADATA(Param, (
 	CR_MEMBER(los),
 	CR_MEMBER(value)
 ))
+
+CR_BIND(Params,)
+CR_REG_METADATA(Params, (
+	CR_IGNORED(keys),
+	CR_IGNORED(params),
+	CR_IGNORED(changes),
+	CR_IGNORED(slots),
+	CR_IGNORED(erasedKeys),
+	CR_IGNORED(lastChange),
+	CR_SERIALIZER(Serialize)
+))
+
+
+static std::vector<std::string> keyNames;
+static spring::unordered_map<std::string, uint32_t> keyIndices;
+
+
+uint32_t LuaRulesParams::GetKeyIndex(const std::string& name)
+{
+	const auto it = keyIndices.find(name);
+
+	if (it != keyIndices.end())
+		return it->second;
+
+	keyNames.push_back(name);
+	keyIndices.emplace(name, static_cast<uint32_t>(keyNames.size() - 1));
+
+	return static_cast<uint32_t>(keyNames.size() - 1);
+}
+
+uint32_t LuaRulesParams::FindKeyIndex(const std::string& name)
+{
+	// never interns, unsynced readers may pass arbitrary names
+	const auto it = keyIndices.find(name);
+
+	if (it == keyIndices.end())
+		return INVALID_KEY;
+
+	return it->second;
+}
+
+const std::string& LuaRulesParams::GetKeyName(uint32_t keyIdx) { return keyNames[keyIdx]; }
+
+void LuaRulesParams::ClearKeys()
+{
+	keyNames.clear();
+	keyIndices.clear();
+}
+
+int LuaRulesParams::GetChangeFrame() { return gs->frameNum; }
+
+
+std::vector<Params::Slot>::const_iterator Params::FindSlot(uint32_t keyIdx) const
+{
+	const auto pred = [](const Slot& a, uint32_t k) { return (a.first < k); };
+	return (std::lower_bound(slots.begin(), slots.end(), keyIdx, pred));
+}
+
+std::vector<Params::Slot>::iterator Params::FindSlot(uint32_t keyIdx)
+{
+	const auto pred = [](const Slot& a, uint32_t k) { return (a.first < k); };
+	return (std::lower_bound(slots.begin(), slots.end(), keyIdx, pred));
+}
+
+
+void Params::SetChanged(size_t i)
+{
+	changes[i] = (lastChange = gs->frameNum);
+}
+
+void Params::Set(const std::string& name, Param&& param)
+{
+	const uint32_t keyIdx = GetKeyIndex(name);
+	const auto slot = FindSlot(keyIdx);
+
+	if (slot != slots.end() && slot->first == keyIdx) {
+		const size_t i = slot->second;
+
+		if (params[i] == param)
+			return;
+
+		params[i] = std::move(param);
+		SetChanged(i);
+		return;
+	}
+
+	slots.insert(slot, {keyIdx, static_cast<uint32_t>(keys.size())});
+
+	keys.push_back(keyIdx);
+	params.push_back(std::move(param));
+	changes.push_back(0);
+
+	SetChanged(keys.size() - 1);
+
+	// set again, no longer part of the erased deltas
+	const auto pred = [keyIdx](const std::pair<uint32_t, int>& p) { return (p.first == keyIdx); };
+	const auto iter = std::find_if(erasedKeys.begin(), erasedKeys.end(), pred);
+
+	if (iter != erasedKeys.end()) {
+		*iter = erasedKeys.back();
+		erasedKeys.pop_back();
+	}
+}
+
+void Params::Erase(const std::string& name)
+{
+	const uint32_t keyIdx = FindKeyIndex(name);
+	const auto slot = FindSlot(keyIdx);
+
+	if (slot == slots.end() || slot->first != keyIdx)
+		return;
+
+	// move the last slot into the erased one
+	const size_t i = slot->second;
+	const size_t j = keys.size() - 1;
+
+	slots.erase(slot);
+
+	if (i != j)
+		FindSlot(keys[j])->second = static_cast<uint32_t>(i);
+
+	keys[i] = keys[j];
+	params[i] = std::move(params[j]);
+	changes[i] = changes[j];
+
+	keys.pop_back();
+	params.pop_back();
+	changes.pop_back();
+
+	const auto pred = [keyIdx](const std::pair<uint32_t, int>& p) { return (p.first == keyIdx); };
+	const auto iter = std::find_if(erasedKeys.begin(), erasedKeys.end(), pred);
+
+	// at most one entry per key
+	if (iter != erasedKeys.end()) {
+		iter->second = (lastChange = gs->frameNum);
+	} else {
+		erasedKeys.emplace_back(keyIdx, lastChange = gs->frameNum);
+	}
+}
+
+void Params::Clear()
+{
+	keys.clear();
+	params.clear();
+	changes.clear();
+	slots.clear();
+	erasedKeys.clear();
+
+	// only used on teardown and load, readers start over
+	lastChange = std::numeric_limits<int>::min();
+}
+
+
+void Params::Serialize(creg::ISerializer* s)
+{
+	// key indices depend on the order names were first set in, store names
+	int numParams = static_cast<int>(keys.size());
+
+	s->SerializeInt(&numParams, sizeof(numParams));
+
+	const auto nameType = creg::DeduceType<std::string>::Get();
+	const auto paramType = creg::DeduceType<Param>::Get();
+
+	if (s->IsWriting()) {
+		for (size_t i = 0; i < keys.size(); i++) {
+			std::string name = keyNames[keys[i]];
+
+			nameType->Serialize(s, &name);
+			paramType->Serialize(s, &params[i]);
+		}
+
+		return;
+	}
+
+	Clear();
+
+	for (int i = 0; i < numParams; i++) {
+		std::string name;
+		Param param;
+
+		nameType->Serialize(s, &name);
+		paramType->Serialize(s, &param);
+
+		Set(name, std::move(param));
+	}
+}
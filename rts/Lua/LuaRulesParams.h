@@ -3,10 +3,12 @@
 #ifndef LUA_RULESPARAMS_H
 #define LUA_RULESPARAMS_H
 
+#include <cstdint>
+#include <limits>
 #include <string>
 #include <variant>
+#include <vector>
 
-#include "System/UnorderedMap.hpp"
 #include "System/creg/creg_cond.h"
 
 namespace LuaRulesParams
@@ -31,11 +33,94 @@ namespace LuaRulesParams
 	struct Param {
 		CR_DECLARE_STRUCT(Param)
 
+		bool operator == (const Param& p) const { return (los == p.los && value == p.value); }
+
 		int   los = RULESPARAMLOS_PRIVATE;
 		std::variant <bool, float, std::string> value;
 	};
 
-	typedef spring::unordered_map<std::string, Param> Params;
+	static constexpr uint32_t INVALID_KEY = -1u;
+
+	// param names are interned once for all objects; only synced code adds
+	// names (via Params::Set), so indices are identical across clients
+	uint32_t GetKeyIndex(const std::string& name);
+	uint32_t FindKeyIndex(const std::string& name);
+	const std::string& GetKeyName(uint32_t keyIdx);
+	// forgets all names, once no Params of the previous game are left
+	void ClearKeys();
+
+	// changes are stamped with the sim frame they were made in
+	int GetChangeFrame();
+
+
+	/**
+	 * Params of a single game, team, player, unit or feature, stored densely
+	 * in insertion order. Lookups by name cost one hash of the name into the
+	 * shared key table, lookups by key index a binary search over the keys of
+	 * this object only, so its size does not depend on how many names exist.
+	 *
+	 * Every slot remembers the frame of its last change, so readers can ask
+	 * for the params changed (or erased) in or after a frame they saw before
+	 * and skip objects whose params did not change at all. A change made in
+	 * the frame a reader pulled in can be reported again on the next pull.
+	 */
+	class Params {
+		CR_DECLARE_STRUCT(Params)
+
+	public:
+		const Param* Find(const std::string& name) const { return (Find(FindKeyIndex(name))); }
+		const Param* Find(uint32_t keyIdx) const {
+			const auto iter = FindSlot(keyIdx);
+
+			if (iter == slots.end() || iter->first != keyIdx)
+				return nullptr;
+
+			return &params[iter->second];
+		}
+
+		// no change is recorded if both value and los stay the same
+		void Set(const std::string& name, Param&& param);
+		void Erase(const std::string& name);
+		void Clear();
+
+		size_t size() const { return keys.size(); }
+		bool empty() const { return keys.empty(); }
+
+		uint32_t GetKey(size_t i) const { return keys[i]; }
+		const Param& GetParam(size_t i) const { return params[i]; }
+
+		bool ChangedSince(int frame) const { return (lastChange >= frame); }
+		bool ChangedSince(size_t i, int frame) const { return (changes[i] >= frame); }
+
+		// keys erased in or after <frame> and not set again since
+		template<typename F> void ForEachErasedSince(int frame, F&& func) const {
+			for (const auto& [keyIdx, erasedAt]: erasedKeys) {
+				if (erasedAt >= frame)
+					func(keyIdx);
+			}
+		}
+
+		void Serialize(creg::ISerializer* s);
+
+	private:
+		using Slot = std::pair<uint32_t, uint32_t>;
+
+		std::vector<Slot>::const_iterator FindSlot(uint32_t keyIdx) const;
+		std::vector<Slot>::iterator FindSlot(uint32_t keyIdx);
+
+		void SetChanged(size_t i);
+
+	private:
+		std::vector<uint32_t> keys;
+		std::vector<Param> params;
+		std::vector<int> changes;
+
+		// (key index, index into keys) of every set key, sorted by key index
+		std::vector<Slot> slots;
+		std::vector<std::pair<uint32_t, int>> erasedKeys;
+
+		int lastChange = std::numeric_limits<int>::min();
+	};
 }
 
 #endif // LUA_RULESPARAMS_H
@@ -19,6 +19,7 @@
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/Models/ModelsMemStorage.h"
 #include "Rendering/Models/ModelsMemStorageDefs.h"
+#include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/UniformConstants.h"
 
 #include <string>
@@ -44,6 +45,7 @@ bool LuaShaders::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(DeleteShader);
 	REGISTER_LUA_CFUNC(UseShader);
 	REGISTER_LUA_CFUNC(ActiveShader);
+	REGISTER_LUA_CFUNC(IsShaderReady);
 
 	REGISTER_LUA_CFUNC(GetActiveUniforms);
 	REGISTER_LUA_CFUNC(GetUniformLocation);
@@ -105,9 +107,10 @@ inline void CheckDrawingEnabled(lua_State* L, const char* caller)
 /******************************************************************************/
 /******************************************************************************/
 
+// programs still linking (async = true) read as missing until UpdatePendingProgram finished them
 GLuint LuaShaders::GetProgramName(uint32_t progIdx) const
 {
-	if (progIdx < programs.size())
+	if (progIdx < programs.size() && !programs[progIdx].pending)
 		return programs[progIdx].id;
 
 	return 0;
@@ -115,7 +118,7 @@ GLuint LuaShaders::GetProgramName(uint32_t progIdx) const
 
 const LuaShaders::Program* LuaShaders::GetProgram(uint32_t progIdx) const
 {
-	if (progIdx < programs.size() && progIdx > 0)
+	if (progIdx < programs.size() && progIdx > 0 && !programs[progIdx].pending)
 		return &programs[progIdx];
 
 	return nullptr;
@@ -123,7 +126,7 @@ const LuaShaders::Program* LuaShaders::GetProgram(uint32_t progIdx) const
 
 LuaShaders::Program* LuaShaders::GetProgram(uint32_t progIdx)
 {
-	if (progIdx < programs.size() && progIdx > 0)
+	if (progIdx < programs.size() && progIdx > 0 && !programs[progIdx].pending)
 		return &programs[progIdx];
 
 	return nullptr;
@@ -411,6 +414,7 @@ namespace {
 		const std::vector<std::string>& defs,
 		const std::vector<std::string>& sources,
 		const GLenum type,
+		bool deferStatus,
 		bool& success
 	) {
 		if (sources.empty()) {
@@ -435,6 +439,12 @@ namespace {
 		glShaderSource(obj, text.size(), &text[0], nullptr);
 		glCompileShader(obj);
 
+		// checked by FinishProgram if linking fails, querying it here would wait for the compile
+		if (deferStatus) {
+			success = true;
+			return obj;
+		}
+
 		GLint result;
 		glGetShaderiv(obj, GL_COMPILE_STATUS, &result);
 		GLchar log[4096];
@@ -550,6 +560,95 @@ GLint LuaShaders::GetUniformLocation(LuaShaders::Program* p, const char* name)
 	return iter->second.location;
 }
 
+bool LuaShaders::FinishProgram(lua_State* L, int table, Program& p)
+{
+	GLint linkStatus;
+	GLint validStatus;
+
+	glGetProgramiv(p.id, GL_LINK_STATUS, &linkStatus);
+
+	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
+
+	if (linkStatus != GL_TRUE) {
+		GLchar log[4096];
+		GLsizei logSize = sizeof(log);
+
+		glGetProgramInfoLog(p.id, logSize, &logSize, log);
+		shaders.errorLog = log;
+
+		// async compiles were not checked yet, report the object that failed instead
+		for (const Object& obj: p.objects) {
+			GLint compileStatus;
+			glGetShaderiv(obj.id, GL_COMPILE_STATUS, &compileStatus);
+
+			if (compileStatus == GL_TRUE)
+				continue;
+
+			logSize = sizeof(log);
+			glGetShaderInfoLog(obj.id, logSize, &logSize, log);
+			shaders.errorLog = log;
+			break;
+		}
+
+		DeleteProgram(p);
+		return false;
+	}
+
+	// Parse active uniforms and locations
+	GLint currentProgram = FillActiveUniforms(p);
+
+	// Allows setting up uniforms when drawing is disabled
+	// (much more convenient for sampler uniforms, and static
+	//  configuration values)
+	// needs to be called before validation
+	ParseUniformSetupTables(L, table, p);
+
+	glUseProgram(currentProgram);
+
+	glValidateProgram(p.id);
+	glGetProgramiv(p.id, GL_VALIDATE_STATUS, &validStatus);
+
+	if (validStatus != GL_TRUE) {
+		GLchar log[4096];
+		GLsizei logSize = sizeof(log);
+		glGetProgramInfoLog(p.id, logSize, &logSize, log);
+		shaders.errorLog = log;
+
+		DeleteProgram(p);
+		return false;
+	}
+
+	return true;
+}
+
+bool LuaShaders::UpdatePendingProgram(lua_State* L, uint32_t progIdx)
+{
+	if (progIdx == 0 || progIdx >= programs.size())
+		return false;
+
+	Program& p = programs[progIdx];
+
+	if (!p.pending)
+		return (p.id != 0);
+
+	if (!shaderHandler->IsProgramLinkComplete(p.id))
+		return false;
+
+	p.pending = false;
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, p.setupTableRef);
+	luaL_unref(L, LUA_REGISTRYINDEX, p.setupTableRef);
+	p.setupTableRef = LUA_NOREF;
+
+	// a failed program keeps its (now empty) slot until gl.DeleteShader, the
+	// index is still held by Lua and must not be handed out to another one
+	const bool linked = FinishProgram(L, lua_gettop(L), p);
+
+	lua_pop(L, 1);
+	return linked;
+}
+
+
 /***
  * A table of uniform name to value.
  * 
@@ -619,6 +718,13 @@ GLint LuaShaders::GetUniformLocation(LuaShaders::Program* p, const char* name)
  * @field geoOutputType integer? outType
  * @field geoOutputVerts integer? maxVerts
  * @field definitions string? string of shader #defines"
+ *
+ * Compile and link on driver threads where supported, instead of stalling
+ * until done. The shader can not be used until `gl.IsShaderReady` returns
+ * true, before that `gl.UseShader` returns false and the shaderID reads as
+ * invalid everywhere else. Compile errors are reported by `gl.IsShaderReady`.
+ *
+ * @field async boolean?
  */
  
 /***
@@ -671,27 +777,31 @@ int LuaShaders::CreateShader(lua_State* L)
 	if (!graphicSrcEmpty && !computeSrcEmpty)
 		return 0;
 
+	lua_getfield(L, 1, "async");
+	const bool async = luaL_optboolean(L, -1, false) && shaderHandler->UseParallelCompile();
+	lua_pop(L, 1);
+
 	bool success;
-	const GLuint vertObj = CompileObject(L, shdrDefs, vertSrcs, GL_VERTEX_SHADER, success);
+	const GLuint vertObj = CompileObject(L, shdrDefs, vertSrcs, GL_VERTEX_SHADER, async, success);
 
 	if (!success)
 		return 0;
 
-	const GLuint tcsObj = CompileObject(L, shdrDefs,  tcsSrcs, GL_TESS_CONTROL_SHADER, success);
+	const GLuint tcsObj = CompileObject(L, shdrDefs,  tcsSrcs, GL_TESS_CONTROL_SHADER, async, success);
 
 	if (!success) {
 		glDeleteShader(vertObj);
 		return 0;
 	}
 
-	const GLuint tesObj = CompileObject(L, shdrDefs,  tesSrcs,  GL_TESS_EVALUATION_SHADER, success);
+	const GLuint tesObj = CompileObject(L, shdrDefs,  tesSrcs,  GL_TESS_EVALUATION_SHADER, async, success);
 
 	if (!success) {
 		glDeleteShader(vertObj);
 		glDeleteShader(tcsObj);
 		return 0;
 	}
-	const GLuint geomObj = CompileObject(L, shdrDefs, geomSrcs, GL_GEOMETRY_SHADER, success);
+	const GLuint geomObj = CompileObject(L, shdrDefs, geomSrcs, GL_GEOMETRY_SHADER, async, success);
 
 	if (!success) {
 		glDeleteShader(vertObj);
@@ -700,7 +810,7 @@ int LuaShaders::CreateShader(lua_State* L)
 		return 0;
 	}
 
-	const GLuint fragObj = CompileObject(L, shdrDefs, fragSrcs, GL_FRAGMENT_SHADER, success);
+	const GLuint fragObj = CompileObject(L, shdrDefs, fragSrcs, GL_FRAGMENT_SHADER, async, success);
 
 	if (!success) {
 		glDeleteShader(vertObj);
@@ -710,7 +820,7 @@ int LuaShaders::CreateShader(lua_State* L)
 		return 0;
 	}
 
-	const GLuint compObj = CompileObject(L, shdrDefs, compSrcs, GL_COMPUTE_SHADER, success);
+	const GLuint compObj = CompileObject(L, shdrDefs, compSrcs, GL_COMPUTE_SHADER, async, success);
 
 	if (!success)
 		return 0;
@@ -749,38 +859,19 @@ int LuaShaders::CreateShader(lua_State* L)
 		p.objects.emplace_back(compObj, GL_COMPUTE_SHADER);
 	}
 
-	GLint linkStatus;
-	GLint validStatus;
-
 	glLinkProgram(prog);
-	glGetProgramiv(prog, GL_LINK_STATUS, &linkStatus);
-
-	// Parse active uniforms and locations
-	GLint currentProgram = FillActiveUniforms(p);
-
-	// Allows setting up uniforms when drawing is disabled
-	// (much more convenient for sampler uniforms, and static
-	//  configuration values)
-	// needs to be called before validation
-	ParseUniformSetupTables(L, 1, p);
-
-	glUseProgram(currentProgram);
-
-	glValidateProgram(prog);
-	glGetProgramiv(prog, GL_VALIDATE_STATUS, &validStatus);
 
-	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
-
-	if (linkStatus != GL_TRUE || validStatus != GL_TRUE) {
-		GLchar log[4096];
-		GLsizei logSize = sizeof(log);
-		glGetProgramInfoLog(prog, logSize, &logSize, log);
-		shaders.errorLog = log;
-
-		DeleteProgram(p);
+	if (async) {
+		// the uniform setup tables are applied once linked
+		lua_pushvalue(L, 1);
+		p.setupTableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+		p.pending = true;
+	} else if (!FinishProgram(L, 1, p)) {
 		return 0;
 	}
 
+	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
+
 	// note: index, not raw ID
 	lua_pushnumber(L, shaders.AddProgram(p));
 	// also push the program ID
@@ -800,8 +891,17 @@ int LuaShaders::DeleteShader(lua_State* L)
 		return 0;
 
 	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
+	const uint32_t progIdx = luaL_checkint(L, 1);
 
-	lua_pushboolean(L, shaders.RemoveProgram(luaL_checkint(L, 1)));
+	if (progIdx < shaders.programs.size() && shaders.programs[progIdx].pending) {
+		Program& p = shaders.programs[progIdx];
+
+		luaL_unref(L, LUA_REGISTRYINDEX, p.setupTableRef);
+		p.setupTableRef = LUA_NOREF;
+		p.pending = false;
+	}
+
+	lua_pushboolean(L, shaders.RemoveProgram(progIdx));
 	return 1;
 }
 
@@ -825,6 +925,10 @@ int LuaShaders::UseShader(lua_State* L)
 	}
 
 	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
+
+	// async programs only become available once linked
+	shaders.UpdatePendingProgram(L, progIdx);
+
 	auto* prog = shaders.GetProgram(progIdx);
 
 	if (prog == nullptr) {
@@ -839,6 +943,34 @@ int LuaShaders::UseShader(lua_State* L)
 }
 
 
+/***
+ * Returns whether a shader created with `async = true` has finished compiling
+ * and linking. Shaders created without it are always ready.
+ *
+ * @function gl.IsShaderReady
+ * @param shaderID integer
+ * @return boolean? ready `nil` if the shader failed to compile or link (see `gl.GetShaderLog`), or shaderID is invalid
+ */
+int LuaShaders::IsShaderReady(lua_State* L)
+{
+	LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
+	const uint32_t progIdx = luaL_checkint(L, 1);
+
+	if (shaders.UpdatePendingProgram(L, progIdx)) {
+		lua_pushboolean(L, true);
+		return 1;
+	}
+
+	if (progIdx < shaders.programs.size() && shaders.programs[progIdx].pending) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+
+	lua_pushnil(L);
+	return 1;
+}
+
+
 /***
  * Binds a shader program identified by shaderID, and calls the Lua func with
  * the specified arguments.
@@ -860,6 +992,8 @@ int LuaShaders::ActiveShader(lua_State* L)
 	if (progIdx != 0) {
 		LuaShaders& shaders = CLuaHandle::GetActiveShaders(L);
 
+		shaders.UpdatePendingProgram(L, progIdx);
+
 		if ((prog = shaders.GetProgram(progIdx)) == nullptr) {
 			return 0;
 		}
@@ -49,6 +49,10 @@ class LuaShaders {
 			Program(GLuint _id) : id(_id) {}
 
 			GLuint id;
+			// created with async = true and still linking, see UpdatePendingProgram
+			bool pending = false;
+			// registry reference to the gl.CreateShader table while pending
+			int setupTableRef = -2; // LUA_NOREF
 			std::vector<Object> objects;
 			std::unordered_map<std::string, ActiveUniform> activeUniforms;
 			std::unordered_map<std::string, ActiveUniformLocation> activeUniformLocations;
@@ -65,7 +69,11 @@ class LuaShaders {
 	private:
 		// helper
 		static bool DeleteProgram(Program& p);
+		static bool FinishProgram(lua_State* L, int table, Program& p);
 		static GLint GetUniformLocation(Program* p, const char* name);
+
+		// returns true if the program is linked and usable, finishes it once its async link is complete
+		bool UpdatePendingProgram(lua_State* L, uint32_t progIdx);
 	private:
 
 		// the call-outs
@@ -73,6 +81,7 @@ class LuaShaders {
 		static int DeleteShader(lua_State* L);
 		static int UseShader(lua_State* L);
 		static int ActiveShader(lua_State* L);
+		static int IsShaderReady(lua_State* L);
 
 		static int GetActiveUniforms(lua_State* L);
 		static int GetUniformLocation(lua_State* L);
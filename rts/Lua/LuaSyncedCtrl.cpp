@@ -1401,8 +1401,13 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	const int losIndex = offset + 3; // table
 
 	const std::string& key = luaL_checkstring(L, index);
+	const LuaRulesParams::Param* prevParam = params.Find(key);
 
-	LuaRulesParams::Param& param = params[key];
+	LuaRulesParams::Param param;
+
+	// the los level is kept if not given
+	if (prevParam != nullptr)
+		param.los = prevParam->los;
 
 	// set the value of the parameter
 	if (lua_israwnumber(L, valIndex)) {
@@ -1412,10 +1417,10 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	} else if (lua_isstring(L, valIndex)) {
 		param.value.emplace <std::string> (lua_tostring(L, valIndex));
 	} else if (lua_isnoneornil(L, valIndex)) {
-		params.erase(key);
+		params.Erase(key);
 		return; //no need to set los if param was erased
 	} else {
-		params.erase(key);
+		params.Erase(key);
 		luaL_error(L, "Incorrect arguments to %s()", caller);
 	}
 
@@ -1447,6 +1452,9 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	} else {
 		param.los = luaL_optint(L, losIndex, param.los);
 	}
+
+	// readers only see a change if value or los differ
+	params.Set(key, std::move(param));
 }
 
 
@@ -109,6 +109,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(IsNoCostEnabled);
 	REGISTER_LUA_CFUNC(GetGlobalLos);
 	REGISTER_LUA_CFUNC(AreHelperAIsEnabled);
+	REGISTER_LUA_CFUNC(GetSimQuality);
 	REGISTER_LUA_CFUNC(FixedAllies);
 
 	REGISTER_LUA_CFUNC(IsGameOver);
@@ -120,6 +121,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetGameRulesParam);
 	REGISTER_LUA_CFUNC(GetGameRulesParams);
+	REGISTER_LUA_CFUNC(GetGameRulesParamsChanged);
 
 	REGISTER_LUA_CFUNC(GetPlayerRulesParam);
 	REGISTER_LUA_CFUNC(GetPlayerRulesParams);
@@ -234,6 +236,9 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitDirection);
 	REGISTER_LUA_CFUNC(GetUnitHeading);
 	REGISTER_LUA_CFUNC(GetUnitVelocity);
+	REGISTER_LUA_CFUNC(GetUnitsPosition);
+	REGISTER_LUA_CFUNC(GetUnitsHealth);
+	REGISTER_LUA_CFUNC(GetUnitsVelocity);
 	REGISTER_LUA_CFUNC(GetUnitBuildFacing);
 	REGISTER_LUA_CFUNC(GetUnitIsBuilding);
 	REGISTER_LUA_CFUNC(GetUnitWorkerTask);
@@ -289,6 +294,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetUnitRulesParam);
 	REGISTER_LUA_CFUNC(GetUnitRulesParams);
+	REGISTER_LUA_CFUNC(GetUnitRulesParamsChanged);
 
 	REGISTER_LUA_CFUNC(GetCEGID);
 
@@ -543,6 +549,56 @@ static int GetSolidObjectPosition(lua_State* L, const CSolidObject* o, bool isFe
 	return (3 + (3 * returnMidPos) + (3 * returnAimPos));
 }
 
+/**
+ * Shared body of the GetUnits* bulk getters: walks the unitID array at index 1 and
+ * writes <stride> numbers per unit into the table at index 2 (or a new one), at
+ * (i - 1) * stride + 1 for the i-th ID. Units that do not exist or fail <fill>'s
+ * access checks get nils, so a reused table never keeps stale values. Returns the
+ * table and the number of units that were filled in.
+ */
+template<int stride, typename F>
+static int FillUnitsArray(lua_State* L, F&& fill)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const int numUnitIDs = lua_objlen(L, 1);
+
+	if (lua_istable(L, 2)) {
+		lua_pushvalue(L, 2);
+	} else {
+		lua_createtable(L, numUnitIDs * stride, 0);
+	}
+
+	const int tableIdx = lua_gettop(L);
+
+	float values[stride];
+	int numFilled = 0;
+
+	for (int i = 0; i < numUnitIDs; i++) {
+		lua_rawgeti(L, 1, i + 1);
+
+		const CUnit* unit = lua_isnumber(L, -1)? unitHandler.GetUnit(lua_toint(L, -1)): nullptr;
+		const bool filled = (unit != nullptr && fill(unit, values));
+
+		lua_pop(L, 1);
+
+		for (int j = 0; j < stride; j++) {
+			if (filled) {
+				lua_pushnumber(L, values[j]);
+			} else {
+				lua_pushnil(L);
+			}
+
+			lua_rawseti(L, tableIdx, i * stride + j + 1);
+		}
+
+		numFilled += filled;
+	}
+
+	lua_pushnumber(L, numFilled);
+	return 2;
+}
+
 static int GetSolidObjectRotation(lua_State* L, const CSolidObject* o)
 {
 	if (o == nullptr)
@@ -703,9 +759,9 @@ static int PushRulesParams(lua_State* L, const char* caller,
 {
 	lua_createtable(L, 0, params.size());
 
-	for (const auto& it: params) {
-		const std::string& name = it.first;
-		const LuaRulesParams::Param& param = it.second;
+	for (size_t i = 0; i < params.size(); i++) {
+		const std::string& name = LuaRulesParams::GetKeyName(params.GetKey(i));
+		const LuaRulesParams::Param& param = params.GetParam(i);
 		if (!(param.los & losStatus))
 			continue;
 
@@ -728,12 +784,11 @@ static int GetRulesParam(lua_State* L, const char* caller, int index,
                           const LuaRulesParams::Params& params,
                           const int& losStatus)
 {
-	const std::string& key = luaL_checkstring(L, index);
-	const auto it = params.find(key);
-	if (it == params.end())
+	const LuaRulesParams::Param* paramPtr = params.Find(luaL_checkstring(L, index));
+	if (paramPtr == nullptr)
 		return 0;
 
-	const LuaRulesParams::Param& param = it->second;
+	const LuaRulesParams::Param& param = *paramPtr;
 	if (!(param.los & losStatus))
 		return 0;
 
@@ -751,6 +806,54 @@ static int GetRulesParam(lua_State* L, const char* caller, int index,
 }
 
 
+static int PushRulesParamsChanged(lua_State* L, const char* caller, int index,
+                          const LuaRulesParams::Params& params,
+                          const int losStatus)
+{
+	const int sinceFrame = luaL_optint(L, index, std::numeric_limits<int>::min());
+
+	if (!params.ChangedSince(sinceFrame)) {
+		lua_pushnil(L);
+		lua_pushnil(L);
+		lua_pushnumber(L, LuaRulesParams::GetChangeFrame());
+		return 3;
+	}
+
+	lua_createtable(L, 0, 0);
+
+	for (size_t i = 0; i < params.size(); i++) {
+		if (!params.ChangedSince(i, sinceFrame))
+			continue;
+
+		const std::string& name = LuaRulesParams::GetKeyName(params.GetKey(i));
+		const LuaRulesParams::Param& param = params.GetParam(i);
+		if (!(param.los & losStatus))
+			continue;
+
+		std::visit ([L, &name](auto&& value) {
+			using T = std::decay_t <decltype(value)>;
+			if constexpr (std::is_same_v <T, float>)
+				LuaPushNamedNumber(L, name, value);
+			else if constexpr (std::is_same_v <T, bool>)
+				LuaPushNamedBool(L, name, value);
+			else if constexpr (std::is_same_v <T, std::string>)
+				LuaPushNamedString(L, name, value);
+		}, param.value);
+	}
+
+	int numErased = 0;
+
+	lua_createtable(L, 0, 0);
+	params.ForEachErasedSince(sinceFrame, [L, &numErased](uint32_t keyIdx) {
+		lua_pushsstring(L, LuaRulesParams::GetKeyName(keyIdx));
+		lua_rawseti(L, -2, ++numErased);
+	});
+
+	lua_pushnumber(L, LuaRulesParams::GetChangeFrame());
+	return 3;
+}
+
+
 /******************************************************************************
  * Game States
  * @section gamestates
@@ -856,6 +959,22 @@ int LuaSyncedRead::AreHelperAIsEnabled(lua_State* L)
 }
 
 
+/***
+ * Lets gadgets throttle their own work while the server runs at reduced quality.
+ *
+ * @function Spring.GetSimQuality
+ *
+ * @return integer level 0 is full quality, higher levels defer more work
+ * @return integer period frames between runs of deferred work
+ */
+int LuaSyncedRead::GetSimQuality(lua_State* L)
+{
+	lua_pushnumber(L, gs->simQualityLevel);
+	lua_pushnumber(L, gs->SimQualityPeriod());
+	return 2;
+}
+
+
 /***
  *
  * @function Spring.FixedAllies
@@ -992,6 +1111,27 @@ int LuaSyncedRead::GetGameRulesParams(lua_State* L)
 }
 
 
+/***
+ * Params changed or erased since an earlier pull.
+ *
+ * Pass the frame returned by the previous call; changes made during that
+ * frame may be returned twice. Both tables are nil if nothing changed.
+ *
+ * @function Spring.GetGameRulesParamsChanged
+ *
+ * @param sinceFrame integer? returns all params if omitted
+ *
+ * @return RulesParams? changedParams map with rules names as key and values as values
+ * @return string[]? erasedParams
+ * @return integer frame to pass to the next call
+ */
+int LuaSyncedRead::GetGameRulesParamsChanged(lua_State* L)
+{
+	// always readable for all
+	return PushRulesParamsChanged(L, __func__, 1, CSplitLuaHandle::GetGameParams(), LuaRulesParams::RULESPARAMLOS_PRIVATE_MASK);
+}
+
+
 /***
  *
  * @function Spring.GetTeamRulesParams
@@ -1105,6 +1245,32 @@ int LuaSyncedRead::GetUnitRulesParams(lua_State* L)
 }
 
 
+/***
+ * Params changed or erased since an earlier pull.
+ *
+ * Pass the frame returned by the previous call; changes made during that
+ * frame may be returned twice. Both tables are nil if nothing changed.
+ * Changes to params that are not readable at the time are skipped.
+ *
+ * @function Spring.GetUnitRulesParamsChanged
+ *
+ * @param unitID integer
+ * @param sinceFrame integer? returns all params if omitted
+ *
+ * @return RulesParams? changedParams map with rules names as key and values as values
+ * @return string[]? erasedParams
+ * @return integer frame to pass to the next call
+ */
+int LuaSyncedRead::GetUnitRulesParamsChanged(lua_State* L)
+{
+	const CUnit* unit = ParseUnit(L, __func__, 1);
+	if (unit == nullptr || game == nullptr)
+		return 0;
+
+	return PushRulesParamsChanged(L, __func__, 2, unit->modParams, GetUnitRulesParamLosMask(L, unit));
+}
+
+
 /***
  *
  * @function Spring.GetFeatureRulesParams
@@ -4599,6 +4765,95 @@ int LuaSyncedRead::GetUnitVelocity(lua_State* L)
 }
 
 
+/***
+ * Bulk version of GetUnitPosition, without the per-unit call overhead.
+ *
+ * @function Spring.GetUnitsPosition
+ * @param unitIDs integer[]
+ * @param result number[]? table to fill in, reused between calls to avoid allocations
+ * @param midPos boolean? (Default: `false`) return midpoints instead of basepoints
+ * @return number[] result x, y, z of the i-th unit at `3 * (i - 1) + 1`, nil if not visible
+ * @return integer numUnits number of units that could be read
+ */
+int LuaSyncedRead::GetUnitsPosition(lua_State* L)
+{
+	const int readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+	const bool fullRead = CLuaHandle::GetHandleFullRead(L);
+	const bool returnMidPos = luaL_optboolean(L, 3, false);
+
+	return (FillUnitsArray<3>(L, [&](const CUnit* unit, float* values) {
+		if (!LuaUtils::IsUnitVisible(L, unit))
+			return false;
+
+		const float3 pos = returnMidPos? unit->midPos: unit->pos;
+		float3 errorVec;
+
+		if (!LuaUtils::IsAllyUnit(L, unit))
+			errorVec = unit->GetLuaErrorVector(readAllyTeam, fullRead);
+
+		values[0] = pos.x + errorVec.x;
+		values[1] = pos.y + errorVec.y;
+		values[2] = pos.z + errorVec.z;
+		return true;
+	}));
+}
+
+
+/***
+ * Bulk version of GetUnitHealth, without the per-unit call overhead.
+ *
+ * @function Spring.GetUnitsHealth
+ * @param unitIDs integer[]
+ * @param result number[]? table to fill in, reused between calls to avoid allocations
+ * @return number[] result health, maxHealth of the i-th unit at `2 * (i - 1) + 1`, nil if not in LOS or hidden
+ * @return integer numUnits number of units that could be read
+ */
+int LuaSyncedRead::GetUnitsHealth(lua_State* L)
+{
+	return (FillUnitsArray<2>(L, [&](const CUnit* unit, float* values) {
+		if (!LuaUtils::IsUnitInLos(L, unit))
+			return false;
+
+		const UnitDef* ud = unit->unitDef;
+		const bool enemyUnit = LuaUtils::IsEnemyUnit(L, unit);
+
+		if (ud->hideDamage && enemyUnit)
+			return false;
+
+		// same decoy scaling as GetUnitHealth
+		const float scale = (!enemyUnit || (ud->decoyDef == nullptr))? 1.0f: (ud->decoyDef->health / ud->health);
+
+		values[0] = scale * unit->health;
+		values[1] = scale * unit->maxHealth;
+		return true;
+	}));
+}
+
+
+/***
+ * Bulk version of GetUnitVelocity, without the per-unit call overhead.
+ *
+ * @function Spring.GetUnitsVelocity
+ * @param unitIDs integer[]
+ * @param result number[]? table to fill in, reused between calls to avoid allocations
+ * @return number[] result x, y, z, speed of the i-th unit at `4 * (i - 1) + 1`, nil if not in LOS
+ * @return integer numUnits number of units that could be read
+ */
+int LuaSyncedRead::GetUnitsVelocity(lua_State* L)
+{
+	return (FillUnitsArray<4>(L, [&](const CUnit* unit, float* values) {
+		if (!LuaUtils::IsUnitInLos(L, unit))
+			return false;
+
+		values[0] = unit->speed.x;
+		values[1] = unit->speed.y;
+		values[2] = unit->speed.z;
+		values[3] = unit->speed.w;
+		return true;
+	}));
+}
+
+
 /***
  *
  * @function Spring.GetUnitBuildFacing
@@ -39,6 +39,7 @@ class LuaSyncedRead {
 		static int IsNoCostEnabled(lua_State* L);
 		static int GetGlobalLos(lua_State* L);
 		static int AreHelperAIsEnabled(lua_State* L);
+		static int GetSimQuality(lua_State* L);
 		static int FixedAllies(lua_State* L);
 
 		static int IsGameOver(lua_State* L);
@@ -48,6 +49,7 @@ class LuaSyncedRead {
 
 		static int GetGameRulesParam(lua_State* L);
 		static int GetGameRulesParams(lua_State* L);
+		static int GetGameRulesParamsChanged(lua_State* L);
 
 		static int GetTidal(lua_State* L);
 		static int GetWind(lua_State* L);
@@ -138,6 +140,9 @@ class LuaSyncedRead {
 		static int GetUnitDirection(lua_State* L);
 		static int GetUnitHeading(lua_State* L);
 		static int GetUnitVelocity(lua_State* L);
+		static int GetUnitsPosition(lua_State* L);
+		static int GetUnitsHealth(lua_State* L);
+		static int GetUnitsVelocity(lua_State* L);
 		static int GetUnitBuildFacing(lua_State* L);
 		static int GetUnitIsBuilding(lua_State* L);
 		static int GetUnitWorkerTask(lua_State* L);
@@ -190,6 +195,7 @@ class LuaSyncedRead {
 
 		static int GetUnitRulesParam(lua_State* L);
 		static int GetUnitRulesParams(lua_State* L);
+		static int GetUnitRulesParamsChanged(lua_State* L);
 
 		static int GetUnitLosState(lua_State* L);
 		static int GetUnitSeparation(lua_State* L);
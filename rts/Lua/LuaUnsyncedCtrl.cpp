@@ -3,6 +3,7 @@
 #include "LuaUnsyncedCtrl.h"
 
 #include "Game/Camera/DollyController.h"
+#include "LuaCallInProfiler.h"
 #include "LuaConfig.h"
 #include "LuaInclude.h"
 #include "LuaHandle.h"
@@ -306,6 +307,7 @@ bool LuaUnsyncedCtrl::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(ClearWatchDogTimer);
 	REGISTER_LUA_CFUNC(GarbageCollectCtrl);
+	REGISTER_LUA_CFUNC(SetLuaCallInProfiling);
 
 	REGISTER_LUA_CFUNC(PreloadUnitDefModel);
 	REGISTER_LUA_CFUNC(PreloadFeatureDefModel);
@@ -4280,6 +4282,21 @@ int LuaUnsyncedCtrl::GarbageCollectCtrl(lua_State* L) {
 }
 
 
+/*** @function Spring.SetLuaCallInProfiling
+ *
+ * Samples the time and allocations of every callin of every Lua handle per source file,
+ * see `Spring.GetLuaCallInProfile`. Enabling clears previous results. The profile
+ * drawer (`/debug`) enables it as well while shown.
+ *
+ * @param enabled boolean
+ * @param sampleInstrCount integer? (Default: `1000`) Lua VM instructions between samples
+ * @return nil
+ */
+int LuaUnsyncedCtrl::SetLuaCallInProfiling(lua_State* L) {
+	LuaCallInProfiler::SetEnabled(luaL_checkboolean(L, 1), luaL_optint(L, 2, LuaCallInProfiler::DEFAULT_SAMPLE_INSTR_COUNT));
+	return 0;
+}
+
 /*** @function Spring.SetAutoShowMetal
  * @param autoShow boolean
  * @return nil
@@ -199,6 +199,7 @@ class LuaUnsyncedCtrl {
 
 		static int ClearWatchDogTimer(lua_State* L);
 		static int GarbageCollectCtrl(lua_State* L);
+		static int SetLuaCallInProfiling(lua_State* L);
 
 		static int PreloadUnitDefModel(lua_State* L);
 		static int PreloadFeatureDefModel(lua_State* L);
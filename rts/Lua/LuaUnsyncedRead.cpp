@@ -2,6 +2,7 @@
 
 #include "LuaUnsyncedRead.h"
 
+#include "LuaCallInProfiler.h"
 #include "LuaConfig.h"
 #include "LuaInclude.h"
 #include "LuaHandle.h"
@@ -37,6 +38,8 @@
 #include "Net/GameServer.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GlobalRenderingInfo.h"
+#include "Rendering/ModelsDataUploader.h"
+#include "Rendering/Models/ModelsMemStorage.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/Env/IWater.h"
@@ -71,6 +74,7 @@
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/StringUtil.h"
+#include "System/Misc/AllocCounter.h"
 #include "System/Misc/SpringTime.h"
 #include "System/ScopedResource.h"
 #include "System/Math/NURBS.h"
@@ -107,7 +111,10 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetProfilerRecordNames);
 
 	REGISTER_LUA_CFUNC(GetLuaMemUsage);
+	REGISTER_LUA_CFUNC(GetLuaCallInProfile);
+	REGISTER_LUA_CFUNC(GetAllocationStats);
 	REGISTER_LUA_CFUNC(GetVidMemUsage);
+	REGISTER_LUA_CFUNC(GetModelDataUploadStats);
 
 	REGISTER_LUA_CFUNC(GetDrawFrame);
 	REGISTER_LUA_CFUNC(GetFrameTimeOffset);
@@ -212,6 +219,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetCameraVectors);
 	REGISTER_LUA_CFUNC(WorldToScreenCoords);
 	REGISTER_LUA_CFUNC(TraceScreenRay);
+	REGISTER_LUA_CFUNC(TraceScreenRays);
 	REGISTER_LUA_CFUNC(GetPixelDir);
 
 	REGISTER_LUA_CFUNC(GetTimer);
@@ -532,6 +540,9 @@ int LuaUnsyncedRead::GetMenuName(lua_State* L)
  *
  * @function Spring.GetProfilerTimeRecord
  *
+ * GPU times of the major draw passes are recorded under the same name prefixed
+ * with "GPU::", e.g. "GPU::Draw::World::Terrain", and lag one frame behind.
+ *
  * @param profilerName string
  * @param frameData boolean? (Default: `false`)
  *
@@ -638,6 +649,98 @@ int LuaUnsyncedRead::GetLuaMemUsage(lua_State* L)
 }
 
 
+/***
+ * @class LuaCallInProfile
+ * @field handle string Name of the Lua handle, e.g. "LuaUI"
+ * @field synced boolean
+ * @field callin string
+ * @field source string File the time was sampled in, usually a widget or gadget
+ * @field time number in ms
+ * @field allocated number in kilobytes
+ * @field samples integer
+ */
+
+/***
+ * Results of the callin profiler, see `Spring.SetLuaCallInProfiling`.
+ *
+ * @function Spring.GetLuaCallInProfile
+ *
+ * Time and allocations of every (handle, callin, source) sampled since profiling was enabled.
+ *
+ * @return LuaCallInProfile[] profiles most expensive first, empty while profiling is disabled
+ * @return number profiledTime in seconds
+ */
+int LuaUnsyncedRead::GetLuaCallInProfile(lua_State* L)
+{
+	static std::vector<LuaCallInProfiler::ProfileEntry> profiles;
+
+	if (LuaCallInProfiler::IsEnabled()) {
+		LuaCallInProfiler::CollectProfiles(profiles);
+	} else {
+		profiles.clear();
+	}
+
+	lua_createtable(L, profiles.size(), 0);
+
+	for (size_t i = 0; i < profiles.size(); i++) {
+		const auto& p = profiles[i];
+
+		lua_createtable(L, 0, 7);
+		LuaPushNamedString(L, "handle", p.handleName);
+		LuaPushNamedBool(L, "synced", p.synced);
+		LuaPushNamedString(L, "callin", p.callInName);
+		LuaPushNamedString(L, "source", p.sourceName);
+		LuaPushNamedNumber(L, "time", p.stats.timeNs * 1e-6);
+		LuaPushNamedNumber(L, "allocated", p.stats.allocBytes / 1024.0);
+		LuaPushNamedNumber(L, "samples", p.stats.numSamples);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_pushnumber(L, LuaCallInProfiler::GetProfiledTime());
+	return 2;
+}
+
+
+/***
+ * @class AllocationStats
+ * @field tag string Profiler scope the allocations were made in, "Other" outside of any
+ * @field allocs integer Heap allocations (operator new)
+ * @field allocated number Heap allocated kilobytes
+ * @field luaAllocs integer Allocations served from the Lua memory pools
+ * @field luaAllocated number Kilobytes allocated from the Lua memory pools
+ */
+
+/***
+ * Heap allocations per profiler scope during the last completed draw frame (including the sim frames run in it).
+ *
+ * @function Spring.GetAllocationStats
+ *
+ * Only counted by engines built with `ALLOCATION_COUNTING`.
+ *
+ * @return AllocationStats[] stats one entry per scope seen so far, empty if allocations are not counted
+ */
+int LuaUnsyncedRead::GetAllocationStats(lua_State* L)
+{
+	const uint32_t numTags = CAllocCounter::IsEnabled()? CAllocCounter::GetNumTags(): 0;
+
+	lua_createtable(L, numTags, 0);
+
+	for (uint32_t i = 0; i < numTags; i++) {
+		const auto& s = CAllocCounter::GetFrameStats(i);
+
+		lua_createtable(L, 0, 5);
+		LuaPushNamedString(L, "tag", CAllocCounter::GetTagName(i));
+		LuaPushNamedNumber(L, "allocs", s.numAllocs);
+		LuaPushNamedNumber(L, "allocated", s.numBytes / 1024.0);
+		LuaPushNamedNumber(L, "luaAllocs", s.numLuaAllocs);
+		LuaPushNamedNumber(L, "luaAllocated", s.numLuaBytes / 1024.0);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
+
+
 /***
  *
  * @function Spring.GetVidMemUsage
@@ -657,6 +760,26 @@ int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 }
 
 
+/***
+ * Bytes of model transforms and uniforms uploaded to the GPU this frame.
+ *
+ * Only the ranges that changed since the previous upload are sent.
+ *
+ * @function Spring.GetModelDataUploadStats
+ *
+ * @return integer transformsBytes
+ * @return integer uniformsBytes
+ * @return integer numRelocations increases whenever transforms were compacted, instance data created by `InstanceDataFromUnitIDs` and friends before that has to be refreshed
+ */
+int LuaUnsyncedRead::GetModelDataUploadStats(lua_State* L)
+{
+	lua_pushnumber(L, transformsUploader.GetLastUploadedBytes());
+	lua_pushnumber(L, modelUniformsUploader.GetLastUploadedBytes());
+	lua_pushnumber(L, transformsMemStorage.GetNumRelocations());
+	return 3;
+}
+
+
 static void PushTimer(lua_State* L, const spring_time& time, bool microseconds)
 {
 	// use time since Spring's epoch in MILLIseconds because that
@@ -2248,11 +2371,6 @@ int LuaUnsyncedRead::GetUnitsInScreenRectangle(lua_State* L)
 	if (l > r) std::swap(l, r);
 	if (t > b) std::swap(t, b);
 
-	static CVisUnitQuadDrawer unitQuadIter;
-
-	unitQuadIter.ResetState();
-	readMap->GridVisibility(nullptr, &unitQuadIter, 1e9, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE);
-
 	const int readTeam = CLuaHandle::GetHandleReadTeam(L);
 	const int readATeam = CLuaHandle::GetHandleReadAllyTeam(L);
 
@@ -2292,6 +2410,30 @@ int LuaUnsyncedRead::GetUnitsInScreenRectangle(lua_State* L)
 	} break;
 	}
 
+	static std::vector<CUnit*> rectUnits;
+	rectUnits.clear();
+
+	// units drawn this frame were already projected by the unit drawer, try its screen grid first
+	if (CUnitDrawer::FindUnitsInScreenRect(camera, l, t, r, b, rectUnits)) {
+		lua_createtable(L, rectUnits.size(), 0);
+
+		uint32_t count = 0;
+		for (const CUnit* unit : rectUnits) {
+			if (disqualifierFunc(unit))
+				continue;
+
+			lua_pushnumber(L, unit->id);
+			lua_rawseti(L, -2, ++count);
+		}
+
+		return 1;
+	}
+
+	static CVisUnitQuadDrawer unitQuadIter;
+
+	unitQuadIter.ResetState();
+	readMap->GridVisibility(nullptr, &unitQuadIter, 1e9, CQuadField::BASE_QUAD_SIZE / SQUARE_SIZE);
+
 	// Even though we're in unsynced it's ok to use gs->tempNum since its exact value
 	// doesn't matter
 	const int tempNum = gs->GetTempNum();
@@ -2445,7 +2587,7 @@ int LuaUnsyncedRead::GetSpectatingState(lua_State* L)
  */
 int LuaUnsyncedRead::GetSelectedUnits(lua_State* L)
 {
-	PushNumberContainerAsArray(L, selectedUnitsHandler.selectedUnits);
+	PushNumberContainerAsArray(L, selectedUnitsHandler.GetSelectedUnitsList());
 	return 1;
 }
 
@@ -2457,7 +2599,7 @@ int LuaUnsyncedRead::GetSelectedUnits(lua_State* L)
  */
 int LuaUnsyncedRead::GetSelectedUnitsSorted(lua_State* L)
 {
-	const auto numDefKeys = PushUnitListSortedByDef(L, selectedUnitsHandler.selectedUnits);
+	const auto numDefKeys = PushUnitListSortedByDef(L, selectedUnitsHandler.GetSelectedUnitsList());
 	lua_pushnumber(L, numDefKeys);
 
 	return 2;
@@ -2473,7 +2615,7 @@ int LuaUnsyncedRead::GetSelectedUnitsSorted(lua_State* L)
  */
 int LuaUnsyncedRead::GetSelectedUnitsCounts(lua_State* L)
 {
-	const auto numDefKeys = PushSparseUnitTallyByDef(L, selectedUnitsHandler.selectedUnits);
+	const auto numDefKeys = PushSparseUnitTallyByDef(L, selectedUnitsHandler.GetSelectedUnitsList());
 	lua_pushnumber(L, numDefKeys);
 
 	return 2;
@@ -2940,23 +3082,12 @@ int LuaUnsyncedRead::WorldToScreenCoords(lua_State* L)
  * @return number|string|nil featureID or ground
  * @return xyz? coords
  */
-int LuaUnsyncedRead::TraceScreenRay(lua_State* L)
+// pushes the (description, id or coordinates) pair of TraceScreenRay, returns 0 if nothing was hit
+static int PushScreenRayTrace(lua_State* L, int mx, int my, bool onlyCoords, bool useMiniMap, bool includeSky, bool ignoreWater, float planeHeight)
 {
-	// window coordinates
-	const int mx = luaL_checkint(L, 1);
-	const int my = luaL_checkint(L, 2);
-
 	const int wx = mx + globalRendering->viewPosX;
 	const int wy = globalRendering->viewSizeY - 1 - my;
 
-	const int optArgIdx = 3 + lua_isnumber(L, 3); // 3 or 4
-	const int newArgIdx = 3 + 4 * (optArgIdx == 3); // 7 or 3
-
-	const bool onlyCoords  = luaL_optboolean(L, optArgIdx + 0, false);
-	const bool useMiniMap  = luaL_optboolean(L, optArgIdx + 1, false);
-	const bool includeSky  = luaL_optboolean(L, optArgIdx + 2, false);
-	const bool ignoreWater = luaL_optboolean(L, optArgIdx + 3, false);
-
 	if (useMiniMap && (minimap != nullptr) && !minimap->GetMinimized()) {
 		const int px = minimap->GetPosX() - globalRendering->viewPosX;
 		const int py = minimap->GetPosY() - globalRendering->viewPosY;
@@ -2999,9 +3130,9 @@ int LuaUnsyncedRead::TraceScreenRay(lua_State* L)
 	const float3 camPos = camera->GetPos();
 	const float3 pxlDir = camera->CalcPixelDir(wx, wy);
 
-	// trace for player's allyteam
+	// trace for player's allyteam; repeated rays within a frame are answered from GuiTraceRay's cache
 	const float traceDist = TraceRay::GuiTraceRay(camPos, pxlDir, rawRange, nullptr, unit, feature, true, onlyCoords, ignoreWater);
-	const float planeDist = CGround::LinePlaneCol(camPos, pxlDir, rawRange, luaL_optnumber(L, newArgIdx, 0.0f));
+	const float planeDist = CGround::LinePlaneCol(camPos, pxlDir, rawRange, planeHeight);
 
 	const float3 tracePos = camPos + (pxlDir * traceDist);
 	const float3 planePos = camPos + (pxlDir * planeDist); // backup (for includeSky and onlyCoords)
@@ -3041,6 +3172,86 @@ int LuaUnsyncedRead::TraceScreenRay(lua_State* L)
 	return 2;
 }
 
+int LuaUnsyncedRead::TraceScreenRay(lua_State* L)
+{
+	// window coordinates
+	const int mx = luaL_checkint(L, 1);
+	const int my = luaL_checkint(L, 2);
+
+	const int optArgIdx = 3 + lua_isnumber(L, 3); // 3 or 4
+	const int newArgIdx = 3 + 4 * (optArgIdx == 3); // 7 or 3
+
+	const bool onlyCoords  = luaL_optboolean(L, optArgIdx + 0, false);
+	const bool useMiniMap  = luaL_optboolean(L, optArgIdx + 1, false);
+	const bool includeSky  = luaL_optboolean(L, optArgIdx + 2, false);
+	const bool ignoreWater = luaL_optboolean(L, optArgIdx + 3, false);
+
+	return (PushScreenRayTrace(L, mx, my, onlyCoords, useMiniMap, includeSky, ignoreWater, luaL_optnumber(L, newArgIdx, 0.0f)));
+}
+
+
+/*** Trace several screen positions at once
+ *
+ * @function Spring.TraceScreenRays
+ *
+ * Same as calling `Spring.TraceScreenRay` once per position, without a Lua call per ray.
+ *
+ * @param screenPositions number[][] array of `{screenX, screenY}` pairs, in mouse coordinates
+ * @param onlyCoords boolean? (Default: `false`)
+ * @param useMinimap boolean? (Default: `false`)
+ * @param includeSky boolean? (Default: `false`)
+ * @param ignoreWater boolean? (Default: `false`)
+ * @param heightOffset number? (Default: `0`)
+ * @return (false|table)[] results one per position, `false` where `Spring.TraceScreenRay` would return nothing, else `{description, unitID|featureID|coords}`
+ */
+int LuaUnsyncedRead::TraceScreenRays(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	const bool onlyCoords  = luaL_optboolean(L, 2, false);
+	const bool useMiniMap  = luaL_optboolean(L, 3, false);
+	const bool includeSky  = luaL_optboolean(L, 4, false);
+	const bool ignoreWater = luaL_optboolean(L, 5, false);
+	const float planeHeight = luaL_optnumber(L, 6, 0.0f);
+
+	const int numPositions = lua_objlen(L, 1);
+
+	lua_createtable(L, numPositions, 0);
+
+	for (int i = 1; i <= numPositions; i++) {
+		lua_rawgeti(L, 1, i);
+
+		if (!lua_istable(L, -1))
+			luaL_error(L, "[%s] screen position %d is not a {x, y} table", __func__, i);
+
+		lua_rawgeti(L, -1, 1);
+		lua_rawgeti(L, -2, 2);
+
+		if (!lua_isnumber(L, -2) || !lua_isnumber(L, -1))
+			luaL_error(L, "[%s] screen position %d is not a {x, y} table", __func__, i);
+
+		const int mx = lua_toint(L, -2);
+		const int my = lua_toint(L, -1);
+
+		lua_pop(L, 3);
+
+		if (PushScreenRayTrace(L, mx, my, onlyCoords, useMiniMap, includeSky, ignoreWater, planeHeight) == 0) {
+			lua_pushboolean(L, false);
+			lua_rawseti(L, -2, i);
+			continue;
+		}
+
+		// {description, value}
+		lua_createtable(L, 2, 0);
+		lua_insert(L, -3);
+		lua_rawseti(L, -3, 2);
+		lua_rawseti(L, -2, 1);
+		lua_rawseti(L, -2, i);
+	}
+
+	return 1;
+}
+
 
 /***
  *
@@ -23,7 +23,10 @@ class LuaUnsyncedRead {
 		static int GetProfilerRecordNames(lua_State* L);
 
 		static int GetLuaMemUsage(lua_State* L);
+		static int GetLuaCallInProfile(lua_State* L);
+		static int GetAllocationStats(lua_State* L);
 		static int GetVidMemUsage(lua_State* L);
+		static int GetModelDataUploadStats(lua_State* L);
 
 		static int GetDrawFrame(lua_State* L);
 		static int GetFrameTimeOffset(lua_State* L);
@@ -126,6 +129,7 @@ class LuaUnsyncedRead {
 		static int GetCameraVectors(lua_State* L);
 		static int WorldToScreenCoords(lua_State* L);
 		static int TraceScreenRay(lua_State* L);
+		static int TraceScreenRays(lua_State* L);
 		static int GetPixelDir(lua_State* L);
 
 		static int GetTimer(lua_State* L);
@@ -36,6 +36,9 @@ bool LuaVBOs::PushEntries(lua_State* L)
 		"Download", &LuaVBOImpl::Download,
 		"Clear", &LuaVBOImpl::Clear,
 
+		"GetTypedBuffer", &LuaVBOImpl::GetTypedBuffer,
+		"Commit", &LuaVBOImpl::Commit,
+
 		"ModelsVBO", &LuaVBOImpl::ModelsVBO,
 
 		"InstanceDataFromUnitDefIDs", sol::overload(
@@ -68,7 +71,16 @@ bool LuaVBOs::PushEntries(lua_State* L)
 		"GetID", &LuaVBOImpl::GetID
 	);
 
+	gl.new_usertype<LuaVBOTypedBuffer>("VBOTypedBuffer",
+		sol::no_constructor,
+		"Set", &LuaVBOTypedBuffer::Set,
+		sol::meta_function::index, &LuaVBOTypedBuffer::Get,
+		sol::meta_function::new_index, &LuaVBOTypedBuffer::SetOne,
+		sol::meta_function::length, &LuaVBOTypedBuffer::Length
+	);
+
 	gl.set("VBO", sol::lua_nil); // don't want this to be accessible directly without gl.GetVBO
+	gl.set("VBOTypedBuffer", sol::lua_nil); // only obtainable through VBO:GetTypedBuffer
 #if defined(__GNUG__) && defined(_DEBUG)
 	lua_settop(L, top); //workaround for https://github.com/ThePhD/sol2/issues/1441, remove when fixed
 #endif
@@ -14,6 +14,7 @@
 #include "Rendering/ModelsDataUploader.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/VBO.h"
+#include "Rendering/GL/FrameRingBuffer.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Sim/Objects/SolidObjectDef.h"
 #include "Sim/Features/Feature.h"
@@ -122,6 +123,13 @@ void LuaVBOImpl::Delete()
 		bufferData = nullptr;
 	}
 
+	if (typedBuffer) {
+		typedBuffer->owner = nullptr; // Lua may still hold it
+		typedBuffer = nullptr;
+	}
+
+	scalarLayout.clear();
+
 	bufferAttribDefs.clear();
 	bufferAttribDefsVec.clear();
 }
@@ -661,6 +669,284 @@ size_t LuaVBOImpl::Upload(const sol::stack_table& luaTblData, sol::optional<int>
 }
 
 
+/***
+ * Returns a view Lua can write VBO data into directly, skipping the table conversion of `VBO:Upload`.
+ *
+ * @function VBO:GetTypedBuffer
+ *
+ * Values are addressed by the same flat 1-based index `VBO:Upload` uses across attributes and elements,
+ * i.e. `typedBuffer[i] = v` or `typedBuffer:Set(i, v1, v2, ...)`, and are converted to the attribute type
+ * as they are written. Written data reaches the GPU with `VBO:Commit`.
+ *
+ * The view is invalidated by `VBO:Delete`.
+ *
+ * @return VBOTypedBuffer typedBuffer
+ * @see VBO:Commit
+ */
+std::shared_ptr<LuaVBOTypedBuffer> LuaVBOImpl::GetTypedBuffer()
+{
+	VBOExistenceCheck(vbo, __func__);
+
+	if (!vboOwner || bufferData == nullptr) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Typed buffers are not available for engine owned buffers", __func__);
+	}
+
+	if (typedBuffer)
+		return typedBuffer;
+
+	FillScalarLayout();
+	typedBuffer = std::make_shared<LuaVBOTypedBuffer>(this);
+
+	return typedBuffer;
+}
+
+/***
+ * Uploads data written through `VBO:GetTypedBuffer` to the GPU.
+ *
+ * @function VBO:Commit
+ *
+ * Frequently updated VBOs on hardware with persistently mapped buffers go through a triple buffered
+ * staging ring, so the upload is a fence wait, a memcpy, a range flush and a GPU side copy.
+ *
+ * @param elemOffset integer? (Default: first written element) The first element to upload.
+ * @param elemCount integer? (Default: up to the last written element) The number of elements to upload.
+ * @return integer bytesUploaded
+ * @see VBO:GetTypedBuffer
+ */
+size_t LuaVBOImpl::Commit(sol::optional<int> elemOffsetOpt, sol::optional<int> elemCountOpt)
+{
+	VBOExistenceCheck(vbo, __func__);
+
+	if (!vboOwner || bufferData == nullptr) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Typed buffers are not available for engine owned buffers", __func__);
+	}
+
+	uint32_t elemBeg = dirtyElemBeg;
+	uint32_t elemEnd = dirtyElemEnd;
+
+	if (elemOffsetOpt.has_value() || elemCountOpt.has_value()) {
+		elemBeg = static_cast<uint32_t>(std::max(elemOffsetOpt.value_or(0), 0));
+		if (elemBeg >= elementsCount) {
+			LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid elemOffset [%u] >= elementsCount [%u]", __func__, elemBeg, elementsCount);
+		}
+
+		const uint32_t elemCount = static_cast<uint32_t>(std::max(elemCountOpt.value_or(elementsCount - elemBeg), 0));
+		elemEnd = std::min(elemBeg + elemCount, elementsCount);
+	}
+
+	if (elemBeg >= elemEnd)
+		return 0u;
+
+	// only forget about the written range when all of it got uploaded
+	if (elemBeg <= dirtyElemBeg && elemEnd >= dirtyElemEnd) {
+		dirtyElemBeg = ~0u;
+		dirtyElemEnd = 0u;
+	}
+
+	const uint32_t byteCount = (elemEnd - elemBeg) * elemSizeInBytes;
+	CommitImpl(elemBeg * elemSizeInBytes, byteCount);
+
+	return byteCount;
+}
+
+void LuaVBOImpl::CommitImpl(uint32_t bufferOffsetInBytes, uint32_t byteCount)
+{
+	const uint8_t* shadowData = static_cast<const uint8_t*>(bufferData) + bufferOffsetInBytes;
+
+	// frequently updated buffers stream through the shared per-frame staging ring, GPU-side copied into vbo
+	const FrameRingBuffer::Allocation staging = freqUpdated
+		? FrameRingBuffer::GetInstance().Allocate(byteCount)
+		: FrameRingBuffer::Allocation{};
+
+	if (!staging.Valid()) {
+		vbo->Bind();
+		vbo->SetBufferSubData(bufferOffsetInBytes, byteCount, shadowData);
+		vbo->Unbind();
+		return;
+	}
+
+	memcpy(staging.ptr, shadowData, byteCount);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, FrameRingBuffer::GetInstance().GetID());
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vbo->GetId());
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, staging.offset, bufferOffsetInBytes, byteCount);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+}
+
+void LuaVBOImpl::FillScalarLayout()
+{
+	scalarLayout.clear();
+
+	for (const auto& [attrID, attrDef] : bufferAttribDefsVec) {
+		int basicTypeSize = attrDef.size;
+
+		// same flattening as UploadImpl
+		if (attrDef.typeSizeInBytes > 4) {
+			assert(attrDef.typeSizeInBytes % 4 == 0);
+			basicTypeSize *= attrDef.typeSizeInBytes >> 2; // / 4;
+		}
+
+		GLenum basicType = GL_FLOAT;
+		uint32_t basicTypeBytes = 4;
+
+		switch (attrDef.type) {
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE: {
+			basicType = attrDef.type; basicTypeBytes = 1;
+		} break;
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT: {
+			basicType = attrDef.type; basicTypeBytes = 2;
+		} break;
+		case GL_INT:
+		case GL_INT_VEC4: {
+			basicType = GL_INT;
+		} break;
+		case GL_UNSIGNED_INT:
+		case GL_UNSIGNED_INT_VEC4: {
+			basicType = GL_UNSIGNED_INT;
+		} break;
+		default:
+			break;
+		}
+
+		for (int n = 0; n < basicTypeSize; ++n) {
+			scalarLayout.emplace_back(static_cast<uint32_t>(attrDef.pointer) + n * basicTypeBytes, basicType);
+		}
+	}
+}
+
+uint8_t* LuaVBOImpl::GetScalarPtr(int luaIndex, GLenum& type)
+{
+	if (luaIndex < 1) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid index [%d], must be >= 1", __func__, luaIndex);
+	}
+
+	const uint32_t scalarIdx = static_cast<uint32_t>(luaIndex - 1);
+	const uint32_t elemIdx = scalarIdx / scalarLayout.size();
+
+	if (elemIdx >= elementsCount) {
+		LuaUtils::SolLuaError("[LuaVBOImpl::%s] Invalid index [%d] is beyond the last element [%u]", __func__, luaIndex, elementsCount);
+	}
+
+	const auto& [offset, basicType] = scalarLayout[scalarIdx % scalarLayout.size()];
+	type = basicType;
+
+	return static_cast<uint8_t*>(bufferData) + elemIdx * elemSizeInBytes + offset;
+}
+
+void LuaVBOImpl::MarkDirty(uint32_t elemIdx)
+{
+	dirtyElemBeg = std::min(dirtyElemBeg, elemIdx    );
+	dirtyElemEnd = std::max(dirtyElemEnd, elemIdx + 1);
+}
+
+
+/***
+ * @class VBOTypedBuffer
+ */
+
+namespace {
+	inline void TypedBufferOwnerCheck(const LuaVBOImpl* owner, const char* func)
+	{
+		if (!owner) {
+			LuaUtils::SolLuaError("[LuaVBOTypedBuffer::%s] The VBO of this typed buffer was deleted", func);
+		}
+	}
+
+	template<typename T>
+	inline void WriteScalar(uint8_t* ptr, lua_Number value)
+	{
+		const auto outVal = spring::SafeCast<T, lua_Number>(value);
+		memcpy(ptr, &outVal, sizeof(T));
+	}
+
+	template<typename T>
+	inline lua_Number ReadScalar(const uint8_t* ptr)
+	{
+		T inVal; memcpy(&inVal, ptr, sizeof(T));
+		return spring::SafeCast<lua_Number, T>(inVal);
+	}
+}
+
+/***
+ * @function VBOTypedBuffer:__index
+ * @param index integer flat 1-based index, see `VBO:Upload`
+ * @return number value
+ */
+lua_Number LuaVBOTypedBuffer::Get(int luaIndex) const
+{
+	TypedBufferOwnerCheck(owner, __func__);
+
+	GLenum type;
+	const uint8_t* ptr = owner->GetScalarPtr(luaIndex, type);
+
+	switch (type) {
+	case GL_BYTE          : return ReadScalar<int8_t  >(ptr);
+	case GL_UNSIGNED_BYTE : return ReadScalar<uint8_t >(ptr);
+	case GL_SHORT         : return ReadScalar<int16_t >(ptr);
+	case GL_UNSIGNED_SHORT: return ReadScalar<uint16_t>(ptr);
+	case GL_INT           : return ReadScalar<int32_t >(ptr);
+	case GL_UNSIGNED_INT  : return ReadScalar<uint32_t>(ptr);
+	default               : return ReadScalar<GLfloat >(ptr);
+	}
+}
+
+/***
+ * @function VBOTypedBuffer:__newindex
+ * @param index integer flat 1-based index, see `VBO:Upload`
+ * @param value number
+ * @return nil
+ */
+void LuaVBOTypedBuffer::SetOne(int luaIndex, lua_Number value)
+{
+	TypedBufferOwnerCheck(owner, __func__);
+
+	GLenum type;
+	uint8_t* ptr = owner->GetScalarPtr(luaIndex, type);
+
+	switch (type) {
+	case GL_BYTE          : WriteScalar<int8_t  >(ptr, value); break;
+	case GL_UNSIGNED_BYTE : WriteScalar<uint8_t >(ptr, value); break;
+	case GL_SHORT         : WriteScalar<int16_t >(ptr, value); break;
+	case GL_UNSIGNED_SHORT: WriteScalar<uint16_t>(ptr, value); break;
+	case GL_INT           : WriteScalar<int32_t >(ptr, value); break;
+	case GL_UNSIGNED_INT  : WriteScalar<uint32_t>(ptr, value); break;
+	default               : WriteScalar<GLfloat >(ptr, value); break;
+	}
+
+	owner->MarkDirty((luaIndex - 1) / owner->scalarLayout.size());
+}
+
+/***
+ * Writes consecutive values starting at `index`.
+ *
+ * @function VBOTypedBuffer:Set
+ * @param index integer flat 1-based index of the first value, see `VBO:Upload`
+ * @param ... number values
+ * @return integer nextIndex the index following the last written value
+ */
+int LuaVBOTypedBuffer::Set(int luaIndex, sol::variadic_args va)
+{
+	for (const auto& value : va) {
+		SetOne(luaIndex++, value.get<lua_Number>());
+	}
+
+	return luaIndex;
+}
+
+/***
+ * @function VBOTypedBuffer:__len
+ * @return integer count number of values the buffer holds
+ */
+uint32_t LuaVBOTypedBuffer::Length() const
+{
+	TypedBufferOwnerCheck(owner, __func__);
+	return static_cast<uint32_t>(owner->scalarLayout.size()) * owner->elementsCount;
+}
+
+
 /***
  *
  * @function VBO:Download
@@ -4,6 +4,7 @@
 #define LUA_VBO_IMPL_H
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
 #include <algorithm>
@@ -16,6 +17,24 @@
 
 class VBO;
 class LuaVAOImpl;
+class LuaVBOImpl;
+
+// Lua-writable view of a VBO's shadow buffer, scalars are addressed by the same
+// 1-based flat index VBO:Upload uses and converted to the attribute type on write
+class LuaVBOTypedBuffer {
+public:
+	LuaVBOTypedBuffer(LuaVBOImpl* owner_)
+		: owner{ owner_ }
+	{}
+
+	lua_Number Get(int luaIndex) const;
+	void SetOne(int luaIndex, lua_Number value);
+	int Set(int luaIndex, sol::variadic_args va);
+	uint32_t Length() const;
+private:
+	friend class LuaVBOImpl;
+	LuaVBOImpl* owner;
+};
 
 class LuaVBOImpl {
 public:
@@ -34,6 +53,9 @@ public:
 	sol::as_table_t<std::vector<lua_Number>> Download(sol::optional<int> attribIdxOpt, sol::optional<int> elemOffsetOpt, sol::optional<int> elemCountOpt, sol::optional<bool> forceGPUReadOpt);
 	void Clear();
 
+	std::shared_ptr<LuaVBOTypedBuffer> GetTypedBuffer();
+	size_t Commit(sol::optional<int> elemOffsetOpt, sol::optional<int> elemCountOpt);
+
 	size_t ModelsVBO();
 
 	size_t InstanceDataFromUnitDefIDs(int id, int attrID, sol::optional<int> teamIdOpt, sol::optional<int> elemOffsetOpt);
@@ -71,6 +93,11 @@ private:
 	bool FillAttribsTableImpl(const sol::table& attrDefTable);
 	bool FillAttribsNumberImpl(const int numVec4Attribs);
 	bool DefineElementArray(const sol::optional<sol::object> attribDefArgOpt);
+
+	void FillScalarLayout();
+	uint8_t* GetScalarPtr(int luaIndex, GLenum& type);
+	void MarkDirty(uint32_t elemIdx);
+	void CommitImpl(uint32_t bufferOffsetInBytes, uint32_t byteCount);
 private:
 	uint32_t GetId() const { return vbo->GetIdRaw(); }
 
@@ -119,6 +146,7 @@ private:
 	bool TransformAndRead(int& bytesRead, GLubyte*& mappedBuf, const int mappedBufferSizeInBytes, const int size, std::vector<lua_Number>& vec, const bool copyData);
 private:
 	friend class LuaVAOImpl;
+	friend class LuaVBOTypedBuffer;
 private:
 	struct BufferAttribDef {
 		GLenum type;
@@ -149,6 +177,13 @@ private:
 
 	std::vector<std::pair<const int, const BufferAttribDef>> bufferAttribDefsVec;
 	std::map<const int, BufferAttribDef> bufferAttribDefs;
+
+	// {byte offset within element, basic GL type} of every scalar of one element
+	std::vector<std::pair<uint32_t, GLenum>> scalarLayout;
+	std::shared_ptr<LuaVBOTypedBuffer> typedBuffer;
+
+	uint32_t dirtyElemBeg = ~0u;
+	uint32_t dirtyElemEnd = 0u;
 private:
 	static constexpr uint32_t uboMinIndex = 5 + 1; // glBindBufferBase(GL_UNIFORM_BUFFER, 5, uboGroundLighting.GetId()); //DecalsDrawerGL4
 	static constexpr uint32_t ssboMinIndex = 3 + 1; // glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, uboDecalsStructures.GetId()); //DecalsDrawerGL4
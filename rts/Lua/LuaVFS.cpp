@@ -261,7 +261,8 @@ const string LuaVFS::GetModes(lua_State* L, int index, bool synced)
 
 static int LoadFileWithModes(const std::string& fileName, std::string& data, const std::string& vfsModes)
 {
-	CFileHandler fh(fileName, vfsModes);
+	// copied (once) straight from the mapped file or archive entry if possible
+	CFileHandler fh(fileName, vfsModes, true);
 
 	if (!fh.FileExists())
 		return (fh.LoadCode());
@@ -1,6 +1,9 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <algorithm>
+#include <iterator>
+
 #include "BasicMapDamage.h"
 #include "ReadMap.h"
 #include "MapInfo.h"
@@ -14,10 +17,31 @@
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Features/FeatureHandler.h"
 #include "System/TimeProfiler.h"
+#include "System/Log/ILog.h"
 
 #include "System/Misc/TracyDefs.h"
 
 
+CBasicMapDamage::~CBasicMapDamage()
+{
+	if (recalcStats.numQueuedRects == 0)
+		return;
+
+	// the saved time only counts the squares not recalculated twice, extrapolated from the average cost
+	const float areaRatio = recalcStats.queuedArea / std::max(float(recalcStats.mergedArea), 1.0f);
+	const float savedTime = recalcStats.recalcTime * 1e-6f * (areaRatio - 1.0f);
+
+	LOG("[%s] aggregated %u explosions into %u, merged %u explosion areas into %u (%.0f%% fewer squares, ~%.1fms saved)", __func__,
+		static_cast<unsigned>(recalcStats.numExplosions),
+		static_cast<unsigned>(recalcStats.numAggregates),
+		static_cast<unsigned>(recalcStats.numQueuedRects),
+		static_cast<unsigned>(recalcStats.numMergedRects),
+		100.0f * (1.0f - 1.0f / std::max(areaRatio, 1.0f)),
+		savedTime
+	);
+}
+
+
 void CBasicMapDamage::Init()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -253,10 +277,200 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 }
 
 
+void CBasicMapDamage::AggregateNewExplosions()
+{
+	// explosions since the last Update are at the back of the queue and not applied yet
+	size_t freshIdx = explosionUpdateQueue.size();
+
+	while (freshIdx > explUpdateQueueIdx && explosionUpdateQueue[freshIdx - 1].ttl == EXPLOSION_LIFETIME)
+		freshIdx -= 1;
+
+	const size_t numFresh = explosionUpdateQueue.size() - freshIdx;
+
+	recalcStats.numExplosions += numFresh;
+
+	if (numFresh < 2) {
+		recalcStats.numAggregates += numFresh;
+		return;
+	}
+
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	newExplosions.clear();
+	newExplosionGroups.clear();
+
+	// group craters while the union of their rects stays no larger than the craters
+	// themselves, s.t. an aggregate never touches more squares than its members did
+	const auto GetArea = [](const Explo& e) { return ((e.x2 - e.x1 + 1) * (e.y2 - e.y1 + 1)); };
+
+	for (size_t i = freshIdx; i < explosionUpdateQueue.size(); i++) {
+		const Explo& e = explosionUpdateQueue[i];
+
+		size_t j = 0;
+
+		for (; j < newExplosions.size(); j++) {
+			Explo& a = newExplosions[j];
+			Explo u;
+			u.x1 = std::min(a.x1, e.x1); u.x2 = std::max(a.x2, e.x2);
+			u.y1 = std::min(a.y1, e.y1); u.y2 = std::max(a.y2, e.y2);
+
+			if (GetArea(u) > (GetArea(a) + GetArea(e)))
+				continue;
+
+			a.x1 = u.x1; a.x2 = u.x2;
+			a.y1 = u.y1; a.y2 = u.y2;
+			break;
+		}
+
+		if (j == newExplosions.size()) {
+			newExplosions.emplace_back();
+			newExplosions.back().x1 = e.x1; newExplosions.back().x2 = e.x2;
+			newExplosions.back().y1 = e.y1; newExplosions.back().y2 = e.y2;
+		}
+
+		newExplosionGroups.push_back(j);
+	}
+
+	recalcStats.numAggregates += newExplosions.size();
+
+	if (newExplosions.size() == numFresh)
+		return;
+
+	// sum the per-frame deltas of each group into one field over its rect, members
+	// in queue order; applied and recalculated once per frame instead of per crater
+	for (size_t j = 0; j < newExplosions.size(); j++) {
+		Explo& a = newExplosions[j];
+
+		const int w = a.x2 - a.x1 + 1;
+		const int h = a.y2 - a.y1 + 1;
+
+		// lone craters are kept as they are
+		if (std::count(newExplosionGroups.begin(), newExplosionGroups.end(), j) == 1) {
+			const auto iter = std::find(newExplosionGroups.begin(), newExplosionGroups.end(), j);
+
+			a = std::move(explosionUpdateQueue[freshIdx + (iter - newExplosionGroups.begin())]);
+			continue;
+		}
+
+		aggregateSquares.clear();
+		aggregateSquares.resize(w * h, 0.0f);
+
+		bool firstMember = true;
+
+		for (size_t i = freshIdx; i < explosionUpdateQueue.size(); i++) {
+			if (newExplosionGroups[i - freshIdx] != j)
+				continue;
+
+			Explo& e = explosionUpdateQueue[i];
+
+			if (firstMember) {
+				a.pos = e.pos;
+				a.strength = e.strength;
+				a.radius = e.radius;
+				firstMember = false;
+			}
+
+			unsigned int expSquarePoolIdx = e.idx;
+
+			for (int y = e.y1; y <= e.y2; ++y) {
+				for (int x = e.x1; x <= e.x2; ++x) {
+					aggregateSquares[(y - a.y1) * w + (x - a.x1)] += explosionSquaresPool[ (expSquarePoolIdx++) % explosionSquaresPool.size() ];
+				}
+			}
+
+			// buildings hit by several craters are moved once by the sum
+			for (const ExploBuilding& eb: e.buildings) {
+				const auto pred = [&](const ExploBuilding& ab) { return (ab.id == eb.id); };
+				const auto iter = std::find_if(a.buildings.begin(), a.buildings.end(), pred);
+
+				if (iter == a.buildings.end()) {
+					a.buildings.push_back(eb);
+				} else {
+					iter->dif += eb.dif;
+				}
+			}
+		}
+
+		a.ttl = EXPLOSION_LIFETIME;
+		a.idx = explSquaresPoolIdx;
+
+		for (const float v: aggregateSquares) {
+			SetExplosionSquare(v);
+		}
+	}
+
+	explosionUpdateQueue.resize(freshIdx);
+	explosionUpdateQueue.insert(explosionUpdateQueue.end(), std::make_move_iterator(newExplosions.begin()), std::make_move_iterator(newExplosions.end()));
+}
+
+void CBasicMapDamage::QueueRecalcArea(int x1, int x2, int y1, int y2)
+{
+	x1 = std::max(x1, 0); x2 = std::clamp(x2, x1, mapDims.mapx);
+	y1 = std::max(y1, 0); y2 = std::clamp(y2, y1, mapDims.mapy);
+
+	const SRectangle updRect(x1, y1, x2, y2);
+	if (updRect.GetArea() <= 0)
+		return;
+
+	recalcRects.push_back(updRect);
+}
+
+void CBasicMapDamage::FlushRecalcAreas()
+{
+	if (recalcRects.empty())
+		return;
+
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t numQueued = recalcRects.size();
+
+	for (const SRectangle& r: recalcRects) {
+		recalcStats.queuedArea += r.GetArea();
+	}
+
+	// join pairs whose bounding box is no larger than both of them together; this never
+	// recalculates more squares and also saves the per-area LOS, path and feature updates
+	for (size_t i = 0; i < recalcRects.size(); i++) {
+		for (size_t j = i + 1; j < recalcRects.size(); j++) {
+			const SRectangle& a = recalcRects[i];
+			const SRectangle& b = recalcRects[j];
+			const SRectangle u = {std::min(a.x1, b.x1), std::min(a.z1, b.z1), std::max(a.x2, b.x2), std::max(a.z2, b.z2)};
+
+			if (u.GetArea() > (a.GetArea() + b.GetArea()))
+				continue;
+
+			recalcRects[i] = u;
+			recalcRects[j] = recalcRects.back();
+			recalcRects.pop_back();
+
+			// <i> grew and might now absorb rects skipped earlier
+			j = i;
+		}
+	}
+
+	recalcStats.numQueuedRects += numQueued;
+	recalcStats.numMergedRects += recalcRects.size();
+
+	TracyPlot("MapDamage::RecalcAreas", static_cast<int64_t>(numQueued));
+	TracyPlot("MapDamage::RecalcAreasMerged", static_cast<int64_t>(recalcRects.size()));
+
+	const spring_time t0 = spring_gettime();
+
+	for (const SRectangle& r: recalcRects) {
+		recalcStats.mergedArea += r.GetArea();
+		RecalcArea(r.x1, r.x2, r.z1, r.z2);
+	}
+
+	recalcStats.recalcTime += (spring_gettime() - t0).toNanoSecsi();
+	recalcRects.clear();
+}
+
+
 void CBasicMapDamage::Update()
 {
 	SCOPED_TIMER("Sim::BasicMapDamage");
 
+	AggregateNewExplosions();
+
 	for (unsigned int i = explUpdateQueueIdx, n = explosionUpdateQueue.size(); i < n; i++) {
 		Explo& e = explosionUpdateQueue[i];
 
@@ -292,9 +506,12 @@ void CBasicMapDamage::Update()
 		if (e.ttl != 0)
 			continue;
 
-		RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+		QueueRecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
 	}
 
+	// derived maps only need to be current once all of this frame's deformations are applied
+	FlushRecalcAreas();
+
 
 	// pop explosions that are no longer being processed
 	while (explUpdateQueueIdx < explosionUpdateQueue.size()) {
@@ -4,12 +4,16 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Rectangle.h"
 
+#include <cstdint>
 #include <vector>
 
 class CBasicMapDamage : public IMapDamage
 {
 public:
+	~CBasicMapDamage() override;
+
 	void Explosion(const float3& pos, float strength, float radius, float& maxHeightDiff) override;
 	void RecalcArea(int x1, int x2, int y1, int y2) override;
 	void TerrainTypeHardnessChanged(int ttIndex) override;
@@ -21,6 +25,10 @@ public:
 	bool Disabled() const override { return false; }
 
 private:
+	void AggregateNewExplosions();
+	void QueueRecalcArea(int x1, int x2, int y1, int y2);
+	void FlushRecalcAreas();
+
 	void SetExplosionSquare(float v) {
 		explosionSquaresPool[explSquaresPoolIdx] = v;
 
@@ -60,6 +68,13 @@ private:
 
 	std::vector<float> explosionSquaresPool;
 	std::vector<Explo> explosionUpdateQueue;
+	// areas of explosions that ended this frame, merged before being recalculated
+	std::vector<SRectangle> recalcRects;
+
+	// scratch space for AggregateNewExplosions
+	std::vector<Explo> newExplosions;
+	std::vector<unsigned int> newExplosionGroups;
+	std::vector<float> aggregateSquares;
 
 	static constexpr unsigned int CRATER_TABLE_SIZE = 200;
 	static constexpr unsigned int EXPLOSION_LIFETIME = 10;
@@ -71,6 +86,16 @@ private:
 	float rawHardness[/*CMapInfo::NUM_TERRAIN_TYPES*/ 256];
 	float invHardness[/*CMapInfo::NUM_TERRAIN_TYPES*/ 256];
 	float weightTable[9];
+
+	struct RecalcStats {
+		uint64_t numQueuedRects = 0;
+		uint64_t numMergedRects = 0;
+		uint64_t queuedArea = 0;
+		uint64_t mergedArea = 0;
+		uint64_t recalcTime = 0; // ns
+		uint64_t numExplosions = 0;
+		uint64_t numAggregates = 0;
+	} recalcStats;
 };
 
 #endif /* _BASIC_MAP_DAMAGE_H */
@@ -212,6 +212,100 @@ inline static bool ClampInMapHeight(float3& from, float3& to)
 }
 
 
+// Tells LineGroundCol which squares along a ray can be skipped since the ray passes above all
+// of their terrain, using the synced max-height mips. Starting at the square itself, blocks get
+// coarser until one is no longer clear and the largest clear one is remembered, so a ray through
+// open sky costs a few mip lookups per block instead of the heightmap and normals of each square.
+//
+// Conservative by construction: a square's triangles never rise above its max corner height,
+// so any hit LineGroundSquareCol reports lies on the (infinite) line at or below that height.
+// The line is therefore tested over the whole block rather than just the segment, with margins
+// for the rounding in the exact test, and the squares it does not skip give identical results.
+class CSkyBlockSkipper {
+public:
+	CSkyBlockSkipper(const float3& from, const float3& to, bool synced): from(from), dir(to - from), enabled(synced) {
+		invDirXZ.x = (dir.x != 0.0f)? (1.0f / dir.x): 0.0f;
+		invDirXZ.y = (dir.z != 0.0f)? (1.0f / dir.z): 0.0f;
+	}
+
+	bool IsClear(int sx, int sz) {
+		if (!enabled)
+			return false;
+		if (sx < 0 || sz < 0)
+			return false;
+		if (sx >= clearMins.x && sx < clearMaxs.x && sz >= clearMins.y && sz < clearMaxs.y)
+			return true;
+
+		bool clear = false;
+
+		for (int mip = 0; mip < CReadMap::numHeightMipMaps; mip++) {
+			const int bx = sx >> mip;
+			const int bz = sz >> mip;
+
+			// partial blocks at the map edge are not covered by coarser mips
+			if (bx >= (mapDims.mapx >> mip) || bz >= (mapDims.mapy >> mip))
+				break;
+
+			const float maxHeight = readMap->GetMIPMaxHeightMapSynced(mip)[bx + bz * (mapDims.mapx >> mip)];
+			const int2 blockMins = {(bx    ) << mip, (bz    ) << mip};
+			const int2 blockMaxs = {(bx + 1) << mip, (bz + 1) << mip};
+
+			if (GetLineMinHeight(blockMins, blockMaxs) <= (maxHeight + HEIGHT_MARGIN))
+				break;
+
+			clearMins = blockMins;
+			clearMaxs = blockMaxs;
+			clear = true;
+		}
+
+		return clear;
+	}
+
+private:
+	// lowest point of the line over the xz-rectangle spanned by squares [mins, maxs)
+	float GetLineMinHeight(const int2& mins, const int2& maxs) const {
+		float tmin = std::numeric_limits<float>::lowest();
+		float tmax = std::numeric_limits<float>::max();
+
+		const float rmins[2] = {mins.x * SQUARE_SIZE - RECT_MARGIN, mins.y * SQUARE_SIZE - RECT_MARGIN};
+		const float rmaxs[2] = {maxs.x * SQUARE_SIZE + RECT_MARGIN, maxs.y * SQUARE_SIZE + RECT_MARGIN};
+		const float rpos[2] = {from.x, from.z};
+		const float rinv[2] = {invDirXZ.x, invDirXZ.y};
+
+		for (int i = 0; i < 2; i++) {
+			if (rinv[i] == 0.0f)
+				continue;
+
+			const float t0 = (rmins[i] - rpos[i]) * rinv[i];
+			const float t1 = (rmaxs[i] - rpos[i]) * rinv[i];
+
+			tmin = std::max(tmin, std::min(t0, t1));
+			tmax = std::min(tmax, std::max(t0, t1));
+		}
+
+		// vertical line or not crossing the block (the latter only due to rounding)
+		if (tmin == std::numeric_limits<float>::lowest() || tmax == std::numeric_limits<float>::max() || tmin > tmax)
+			return std::numeric_limits<float>::lowest();
+
+		return std::min(from.y + dir.y * tmin, from.y + dir.y * tmax);
+	}
+
+private:
+	static constexpr float HEIGHT_MARGIN = 1.0f;
+	static constexpr float RECT_MARGIN = 0.5f;
+
+	float3 from;
+	float3 dir;
+	float2 invDirXZ;
+
+	int2 clearMins = {0, 0};
+	int2 clearMaxs = {0, 0};
+
+	// the max-height mips only track the synced heightmap
+	bool enabled;
+};
+
+
 float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -266,6 +360,8 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 
 	bool stopTrace = false;
 
+	CSkyBlockSkipper skyBlockSkipper(from, to, synced);
+
 	if ((fsx == tsx) && (fsz == tsz)) {
 		// <from> and <to> are the same
 		const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, fsz);
@@ -281,7 +377,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		int zp = fsz;
 
 		for (unsigned int i = 0, n = Square(mapDims.mapyp1); (Square(i) <= n && zp != tsz); i++) {
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, zp);
+			const float ret = skyBlockSkipper.IsClear(fsx, zp)? -1.0f: LineGroundSquareCol(hm, nm,  from, to,  fsx, zp);
 
 			if (ret >= 0.0f)
 				return (ret + skippedDist);
@@ -297,7 +393,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		int xp = fsx;
 
 		for (unsigned int i = 0, n = Square(mapDims.mapxp1); (Square(i) <= n && xp != tsx); i++) {
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  xp, fsz);
+			const float ret = skyBlockSkipper.IsClear(xp, fsz)? -1.0f: LineGroundSquareCol(hm, nm,  from, to,  xp, fsz);
 
 			if (ret >= 0.0f)
 				return (ret + skippedDist);
@@ -335,7 +431,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 
 		for (unsigned int i = 0, n = Square(mapDims.mapxp1) + Square(mapDims.mapyp1); !stopTrace; i++) {
 			// test for collision with the ground-square triangles
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
+			const float ret = skyBlockSkipper.IsClear(curx, curz)? -1.0f: LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
 
 			if (ret >= 0.0f)
 				return (ret + skippedDist);
@@ -470,6 +566,42 @@ float CGround::GetHeightReal(float x, float z, bool synced)
 	return InterpolateCornerHeight(x, z, readMap->GetSharedCornerHeightMap(synced));
 }
 
+void CGround::GetHeightsReal(const float* xs, const float* zs, float* heights, size_t count, bool synced)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const float* cornerHeightMap = readMap->GetSharedCornerHeightMap(synced);
+
+	// same arithmetic as InterpolateCornerHeight, but evaluating both triangles and
+	// selecting one afterwards so the loop has no branches; all four corners are in
+	// bounds since x and z are clamped to less than the map size
+	for (size_t i = 0; i < count; i++) {
+		const float x = std::clamp(xs[i], 0.0f, float3::maxxpos) / SQUARE_SIZE;
+		const float z = std::clamp(zs[i], 0.0f, float3::maxzpos) / SQUARE_SIZE;
+
+		const int ix = x;
+		const int iz = z;
+		const int hs = ix + iz * mapDims.mapxp1;
+
+		const float dx = x - ix;
+		const float dz = z - iz;
+
+		const float h00 = cornerHeightMap[hs + 0                 ];
+		const float h10 = cornerHeightMap[hs + 1                 ];
+		const float h01 = cornerHeightMap[hs + 0 + mapDims.mapxp1];
+		const float h11 = cornerHeightMap[hs + 1 + mapDims.mapxp1];
+
+		const float tlxdif = dx * (h10 - h00);
+		const float tlzdif = dz * (h01 - h00);
+		const float brxdif = (1.0f - dx) * (h01 - h11);
+		const float brzdif = (1.0f - dz) * (h10 - h11);
+
+		const float htl = h00 + tlxdif + tlzdif;
+		const float hbr = h11 + brxdif + brzdif;
+
+		heights[i] = (dx + dz < 1.0f)? htl: hbr;
+	}
+}
+
 float CGround::GetOrigHeight(float x, float z)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -3,6 +3,8 @@
 #ifndef GROUND_H
 #define GROUND_H
 
+#include <cstddef>
+
 #include "System/float3.h"
 #include "System/type2.h"
 
@@ -18,6 +20,8 @@ public:
 	static float GetHeightAboveWater(float x, float z, bool synced = true);
 	/// Returns the real height at the specified position, can be below 0
 	static float GetHeightReal(float x, float z, bool synced = true);
+	/// GetHeightReal for <count> positions at once, with bit-identical results
+	static void GetHeightsReal(const float* xs, const float* zs, float* heights, size_t count, bool synced = true);
 	static float GetOrigHeight(float x, float z);
 
 	static consteval float GetWaterPlaneLevel() {
@@ -2,6 +2,7 @@
 
 #include "HeightLinePalette.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/Config/ConfigVar.h"
 
 #include "System/Misc/TracyDefs.h"
 
@@ -62,7 +63,9 @@ std::array<SColor, 256> CHeightLinePalette::paletteBlackAndWhite = CreateBW();
 
 const SColor* CHeightLinePalette::GetData()
 {
-	if (configHandler->GetBool("ColorElev")) {
+	static ConfigVar<bool> colorElev("ColorElev");
+
+	if (colorElev.Get()) {
 		return &paletteColored[0];
 	} else {
 		return &paletteBlackAndWhite[0];
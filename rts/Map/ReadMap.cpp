@@ -65,6 +65,7 @@ CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(unsyncedHeightInfo),
 	CR_IGNORED(boundingRadius),
 	CR_IGNORED(mapChecksum),
+	CR_IGNORED(numUnsyncedHeightMapUpdates),
 
 	CR_IGNORED(heightMapSyncedPtr),
 	CR_IGNORED(heightMapUnsyncedPtr),
@@ -74,6 +75,7 @@ CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(originalHeightMap),
 	CR_IGNORED(centerHeightMap),
 	CR_IGNORED(mipCenterHeightMaps),
+	CR_IGNORED(mipMaxHeightMaps),
 	*/
 	CR_IGNORED(mipPointerHeightMaps),
 	/*
@@ -116,6 +118,7 @@ std::vector<float> CReadMap::originalHeightMap;
 std::vector<float> CReadMap::centerHeightMap;
 std::vector<float> CReadMap::maxHeightMap;
 std::array<std::vector<float>, CReadMap::numHeightMipMaps - 1> CReadMap::mipCenterHeightMaps;
+std::array<std::vector<float>, CReadMap::numHeightMipMaps - 1> CReadMap::mipMaxHeightMaps;
 
 std::vector<float3> CReadMap::faceNormalsSynced;
 std::vector<float3> CReadMap::faceNormalsUnsynced;
@@ -284,6 +287,8 @@ void CReadMap::PostLoad()
 	for (int i = 1; i < numHeightMipMaps; i++) {
 		mipCenterHeightMaps[i - 1].clear();
 		mipCenterHeightMaps[i - 1].resize((mapDims.mapx >> i) * (mapDims.mapy >> i));
+		mipMaxHeightMaps[i - 1].clear();
+		mipMaxHeightMaps[i - 1].resize((mapDims.mapx >> i) * (mapDims.mapy >> i));
 
 		mipPointerHeightMaps[i] = &mipCenterHeightMaps[i - 1][0];
 	}
@@ -329,9 +334,9 @@ void CReadMap::Initialize()
 			((  mapDims.hmapx     * mapDims.hmapy           * sizeof(float))         / 1024) +   // MetalMap::extractionMap
 			((  mapDims.hmapx     * mapDims.hmapy           * sizeof(unsigned char)) / 1024);    // MetalMap::metalMap
 
-		// mipCenterHeightMaps[i]
+		// mipCenterHeightMaps[i], mipMaxHeightMaps[i]
 		for (int i = 1; i < numHeightMipMaps; i++) {
-			reqMemFootPrintKB += ((((mapDims.mapx >> i) * (mapDims.mapy >> i)) * sizeof(float)) / 1024);
+			reqMemFootPrintKB += ((((mapDims.mapx >> i) * (mapDims.mapy >> i)) * 2 * sizeof(float)) / 1024);
 		}
 
 		sprintf(loadMsg, fmtString, reqMemFootPrintKB / 1024);
@@ -365,6 +370,8 @@ void CReadMap::Initialize()
 	for (int i = 1; i < numHeightMipMaps; i++) {
 		mipCenterHeightMaps[i - 1].clear();
 		mipCenterHeightMaps[i - 1].resize((mapDims.mapx >> i) * (mapDims.mapy >> i));
+		mipMaxHeightMaps[i - 1].clear();
+		mipMaxHeightMaps[i - 1].resize((mapDims.mapx >> i) * (mapDims.mapy >> i));
 
 		mipPointerHeightMaps[i] = &mipCenterHeightMaps[i - 1][0];
 	}
@@ -510,6 +517,8 @@ void CReadMap::UpdateDraw(bool firstCall)
 		eventHandler.UnsyncedHeightMapUpdate(*(unsyncedHeightMapUpdates.begin() + i));
 	}
 
+	numUnsyncedHeightMapUpdates += (N > 0);
+
 	for (int i = 0; i < N; i++) {
 		unsyncedHeightMapUpdates.pop_front();
 	}
@@ -534,6 +543,7 @@ void CReadMap::UpdateHeightMapSynced(const SRectangle& hgtMapRect)
 
 	UpdateCenterHeightmap(centerRect, initialize);
 	UpdateMipHeightmaps(centerRect, initialize);
+	UpdateMipMaxHeightmaps(centerRect); // must happen after UpdateCenterHeightmap()!
 	UpdateFaceNormals(centerRect, initialize);
 	UpdateSlopemap(centerRect, initialize); // must happen after UpdateFaceNormals()!
 
@@ -619,22 +629,42 @@ void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize) co
 	const float* heightmapSynced = GetCornerHeightMapSynced();
 
 	for_mt_chunk(rect.z1, rect.z2 + 1, [heightmapSynced, &rect](const int y) {
-		for (int x = rect.x1; x <= rect.x2; x++) {
-			const int idxTL = (y + 0) * mapDims.mapxp1 + x + 0;
-			const int idxTR = (y + 0) * mapDims.mapxp1 + x + 1;
-			const int idxBL = (y + 1) * mapDims.mapxp1 + x + 0;
-			const int idxBR = (y + 1) * mapDims.mapxp1 + x + 1;
+		using FloatBatch = xsimd::simd_type<float>;
+
+		const float* rowT = &heightmapSynced[(y + 0) * mapDims.mapxp1];
+		const float* rowB = &heightmapSynced[(y + 1) * mapDims.mapxp1];
+
+		float* centerRow = &centerHeightMap[y * mapDims.mapx];
+		float* maxRow = &maxHeightMap[y * mapDims.mapx];
+
+		int x = rect.x1;
+
+		// same operation order as the scalar tail, s.t. results stay bit-identical
+		for (; (x + int(FloatBatch::size)) <= (rect.x2 + 1); x += FloatBatch::size) {
+			FloatBatch hTL; hTL.load_unaligned(rowT + x    );
+			FloatBatch hTR; hTR.load_unaligned(rowT + x + 1);
+			FloatBatch hBL; hBL.load_unaligned(rowB + x    );
+			FloatBatch hBR; hBR.load_unaligned(rowB + x + 1);
 
-			const int index = y * mapDims.mapx + x;
+			const FloatBatch height = (((hTL + hTR) + hBL) + hBR) * FloatBatch(0.25f);
+			// select rather than xsimd::max, which differs from std::max for signed zeroes
+			const FloatBatch maxT = xsimd::select(hTL < hTR, hTR, hTL);
+			const FloatBatch maxB = xsimd::select(hBL < hBR, hBR, hBL);
+
+			height.store_unaligned(centerRow + x);
+			xsimd::select(maxT < maxB, maxB, maxT).store_unaligned(maxRow + x);
+		}
+
+		for (; x <= rect.x2; x++) {
 			const float height =
-				heightmapSynced[idxTL] +
-				heightmapSynced[idxTR] +
-				heightmapSynced[idxBL] +
-				heightmapSynced[idxBR];
-			centerHeightMap[index] = height * 0.25f;
-			maxHeightMap[index] = std::max
-					( std::max(heightmapSynced[idxTL], heightmapSynced[idxTR])
-					, std::max(heightmapSynced[idxBL], heightmapSynced[idxBR])
+				rowT[x    ] +
+				rowT[x + 1] +
+				rowB[x    ] +
+				rowB[x + 1];
+			centerRow[x] = height * 0.25f;
+			maxRow[x] = std::max
+					( std::max(rowT[x], rowT[x + 1])
+					, std::max(rowB[x], rowB[x + 1])
 					);
 		}
 	}, 256);
@@ -652,10 +682,13 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 		const int sy = (rect.z1 >> i) & (~1);
 		const int ey = (rect.z2 >> i);
 
-		float* topMipMap = mipPointerHeightMaps[i    ];
-		float* subMipMap = mipPointerHeightMaps[i + 1];
+		const float* topMipMap = mipPointerHeightMaps[i    ];
+		      float* subMipMap = mipPointerHeightMaps[i + 1];
+
+		// each level only reads the previous one, rows within a level are independent
+		for_mt_chunk(0, (ey - sy + 1) / 2, [&](const int j) {
+			const int y = sy + j * 2;
 
-		for (int y = sy; y < ey; y += 2) {
 			for (int x = sx; x < ex; x += 2) {
 				const float height =
 					topMipMap[(x    ) + (y    ) * hmapx] +
@@ -664,7 +697,37 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 					topMipMap[(x + 1) + (y + 1) * hmapx];
 				subMipMap[(x / 2) + (y / 2) * hmapx / 2] = height * 0.25f;
 			}
-		}
+		}, 128);
+	}
+}
+
+
+void CReadMap::UpdateMipMaxHeightmaps(const SRectangle& rect)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// these are used to skip ray-casts over terrain, so unlike the center-height
+	// mips every block overlapping <rect> has to be refreshed, up to the last row
+	for (int i = 1; i < numHeightMipMaps; i++) {
+		const int topMapX = mapDims.mapx >> (i - 1);
+		const int subMapX = mapDims.mapx >> (i    );
+		const int subMapY = mapDims.mapy >> (i    );
+
+		const float* topMipMap = GetMIPMaxHeightMapSynced(i - 1);
+		      float* subMipMap = &mipMaxHeightMaps[i - 1][0];
+
+		const int sx = rect.x1 >> i;
+		const int ex = std::min(rect.x2 >> i, subMapX - 1);
+		const int sy = rect.z1 >> i;
+		const int ey = std::min(rect.z2 >> i, subMapY - 1);
+
+		for_mt_chunk(sy, ey + 1, [&](const int y) {
+			for (int x = sx; x <= ex; x++) {
+				subMipMap[x + y * subMapX] = std::max(
+					std::max(topMipMap[(x * 2    ) + (y * 2    ) * topMapX], topMipMap[(x * 2 + 1) + (y * 2    ) * topMapX]),
+					std::max(topMipMap[(x * 2    ) + (y * 2 + 1) * topMapX], topMipMap[(x * 2 + 1) + (y * 2 + 1) * topMapX])
+				);
+			}
+		}, 128);
 	}
 }
 
@@ -170,6 +170,8 @@ public:
 	const float* GetCenterHeightMapSynced() const { return &centerHeightMap[0]; }
 	const float* GetMaxHeightMapSynced() const { return &maxHeightMap[0]; }
 	const float* GetMIPHeightMapSynced(uint32_t mip) const { return mipPointerHeightMaps[mip]; }
+	/// maximum (corner) height per block of 2^mip * 2^mip squares, mip 0 is maxHeightMap
+	const float* GetMIPMaxHeightMapSynced(uint32_t mip) const { return ((mip == 0)? &maxHeightMap[0]: &mipMaxHeightMaps[mip - 1][0]); }
 	const float* GetSlopeMapSynced() const { return &slopeMap[0]; }
 	const uint8_t* GetTypeMapSynced() const { return &typeMap[0]; }
 	      uint8_t* GetTypeMapSynced()       { return &typeMap[0]; }
@@ -224,6 +226,8 @@ public:
 	void UpdateHeightBounds();
 
 	bool GetHeightMapUpdated() const { return hmUpdated; }
+	// increases whenever drawn (unsynced) terrain changed
+	uint32_t GetNumUnsyncedHeightMapUpdates() const { return numUnsyncedHeightMapUpdates; }
 
 	virtual int2 GetPatch(int hmx, int hmz) const = 0;
 	virtual const float3& GetUnsyncedHeightInfo(int patchX, int patchZ) const = 0;
@@ -235,6 +239,7 @@ private:
 
 	void UpdateCenterHeightmap(const SRectangle& rect, bool initialize) const;
 	void UpdateMipHeightmaps(const SRectangle& rect, bool initialize);
+	void UpdateMipMaxHeightmaps(const SRectangle& rect);
 	void UpdateFaceNormals(const SRectangle& rect, bool initialize);
 	void UpdateSlopemap(const SRectangle& rect, bool initialize);
 
@@ -262,6 +267,7 @@ protected:
 	static std::vector<float> centerHeightMap;          //< size: (mapx  )*(mapy  ) (per face) [SYNCED, updates on terrain deformation]
 	static std::array<std::vector<float>, numHeightMipMaps - 1> mipCenterHeightMaps;
 	static std::vector<float> maxHeightMap;			// map for sea/hover to catch coast lines with sharp vertical changes so they don't try to climb the cliff.
+	static std::array<std::vector<float>, numHeightMipMaps - 1> mipMaxHeightMaps; // max-reduced mips of maxHeightMap, for hierarchical ray-casts
 
 	/**
 	 * array of pointers to heightmaps in different resolutions
@@ -300,6 +306,7 @@ private:
 	static std::vector<uint8_t> unsyncedHeightMapDigests;
 
 	uint32_t mapChecksum = 0;
+	uint32_t numUnsyncedHeightMapUpdates = 0;
 
 	bool processingHeightBounds = false;
 	bool hmUpdated = false;
@@ -0,0 +1,377 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GeoMipMeshDrawer.h"
+#include "Game/Camera.h"
+#include "Game/CameraHandler.h"
+#include "Map/ReadMap.h"
+#include "Map/SMF/SMFGroundDrawer.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/RenderBuffers.h"
+
+#include <cmath>
+
+#include "System/Misc/TracyDefs.h"
+
+
+// camera distance (in elmos, per unit of GroundDetail) up to which patches use the finest LOD;
+// each doubling of the distance halves the grid resolution
+static constexpr float LOD_DIST_SCALE = 16.0f;
+
+
+CGeoMipMeshDrawer::CGeoMipMeshDrawer(CSMFGroundDrawer* gd)
+	: smfGroundDrawer(gd)
+{
+	numPatchesX = mapDims.mapx / PATCH_SIZE;
+	numPatchesY = mapDims.mapy / PATCH_SIZE;
+
+	assert(numPatchesX >= 1);
+	assert(numPatchesY >= 1);
+
+	for (uint32_t lod = 0; lod < LOD_LEVELS; lod++) {
+		UploadPatchSquareGeometry(meshLODs[lod], lod);
+	}
+
+	for (uint32_t lod = 0; lod < LOD_LEVELS; lod++) {
+		const uint32_t lodStep = 1 << lod;
+		const size_t numVert = (PATCH_SIZE / lodStep + 1) * 2;
+		const size_t numIndx = (PATCH_SIZE / lodStep    ) * 6;
+		for (uint32_t b = MAP_BORDER_L; b < MAP_BORDER_C; b++) {
+			auto& borderRenderBuffer = borderRenderBuffers[lod * static_cast<uint32_t>(MAP_BORDER_C) + static_cast<uint32_t>(b)];
+			borderRenderBuffer = std::make_unique<BordRenderBuffer>(numVert, numIndx, IStreamBufferConcept::SB_BUFFERSUBDATA, false);
+			UploadPatchBorderGeometry(borderRenderBuffer, static_cast<MAP_BORDERS>(b), lodStep);
+			borderRenderBuffer->SetReadonly();
+		}
+	}
+
+	meshVisPatches.resize(numPatchesX * numPatchesY);
+	for (auto& meshVisPatch : meshVisPatches) {
+		meshVisPatch.visUpdateFrames.fill(0);
+	}
+
+	patchLODs.resize(numPatchesX * numPatchesY, 0);
+	patchStitchMasks.resize(numPatchesX * numPatchesY, 0);
+}
+
+CGeoMipMeshDrawer::~CGeoMipMeshDrawer()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	meshLODs = {};
+	borderRenderBuffers = {};
+}
+
+
+
+void CGeoMipMeshDrawer::UploadPatchSquareGeometry(MeshLOD& meshLOD, uint32_t lod)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const uint32_t lodStep = 1 << lod;
+	const uint32_t numQuads = PATCH_SIZE / lodStep;
+	const uint32_t numVerts = numQuads + 1;
+
+	std::vector<float3> verts;
+	std::vector<uint32_t> indcs;
+
+	verts.reserve(numVerts * numVerts);
+	indcs.reserve(numQuads * numQuads * 6 * STITCH_EDGE_C);
+
+	for (uint32_t z = 0; z < numVerts; z++) {
+		for (uint32_t x = 0; x < numVerts; x++) {
+			verts.emplace_back(x * lodStep * SQUARE_SIZE, 0.0f, z * lodStep * SQUARE_SIZE);
+		}
+	}
+
+	// the coarsest level never has a coarser neighbor to stitch to
+	const uint32_t numMasks = (lod < LOD_LEVELS - 1)? STITCH_EDGE_C: 1;
+
+	for (uint32_t mask = 0; mask < numMasks; mask++) {
+		// on a stitched edge, every odd vertex collapses into its even predecessor s.t.
+		// the edge consists of the same vertices as that of the next coarser level
+		const auto VertIdx = [&](uint32_t x, uint32_t z) {
+			if (((mask & STITCH_EDGE_T) != 0 && z == 0) || ((mask & STITCH_EDGE_B) != 0 && z == numQuads))
+				x &= ~1u;
+			if (((mask & STITCH_EDGE_L) != 0 && x == 0) || ((mask & STITCH_EDGE_R) != 0 && x == numQuads))
+				z &= ~1u;
+
+			return (z * numVerts + x);
+		};
+		const auto AddTriangle = [&](uint32_t i0, uint32_t i1, uint32_t i2) {
+			// skip the triangles the collapse made degenerate
+			if (i0 == i1 || i1 == i2 || i2 == i0)
+				return;
+
+			indcs.push_back(i0);
+			indcs.push_back(i1);
+			indcs.push_back(i2);
+		};
+
+		meshLOD.indxOffsets[mask] = static_cast<uint32_t>(indcs.size());
+
+		for (uint32_t z = 0; z < numQuads; z++) {
+			for (uint32_t x = 0; x < numQuads; x++) {
+				const uint32_t tli = VertIdx(x + 0, z + 0);
+				const uint32_t tri = VertIdx(x + 1, z + 0);
+				const uint32_t bli = VertIdx(x + 0, z + 1);
+				const uint32_t bri = VertIdx(x + 1, z + 1);
+
+				// CCW like MakeQuadsTriangles, but split along the tl-br diagonal
+				// so no triangle folds over when its edge vertices are collapsed
+				AddTriangle(tli, bri, tri);
+				AddTriangle(tli, bli, bri);
+			}
+		}
+
+		meshLOD.indxCounts[mask] = static_cast<uint32_t>(indcs.size()) - meshLOD.indxOffsets[mask];
+	}
+
+	meshLOD.vertVBO = { GL_ARRAY_BUFFER        , false, false };
+	meshLOD.indxVBO = { GL_ELEMENT_ARRAY_BUFFER, false, false };
+
+	meshLOD.vertVBO.Bind();
+	meshLOD.vertVBO.New(verts, GL_STATIC_DRAW);
+	meshLOD.vertVBO.Unbind();
+
+	meshLOD.indxVBO.Bind();
+	meshLOD.indxVBO.New(indcs, GL_STATIC_DRAW);
+	meshLOD.indxVBO.Unbind();
+
+	meshLOD.vao.Bind();
+
+	meshLOD.indxVBO.Bind();
+	meshLOD.vertVBO.Bind();
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribDivisor(0, 0);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, false, 0, nullptr);
+
+	meshLOD.vao.Unbind();
+
+	meshLOD.indxVBO.Unbind();
+	meshLOD.vertVBO.Unbind();
+
+	glDisableVertexAttribArray(0);
+}
+
+void CGeoMipMeshDrawer::UploadPatchBorderGeometry(std::unique_ptr<BordRenderBuffer>& borderRenderBuffer, MAP_BORDERS b, uint32_t lodStep)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto tl = VA_TYPE_C{ {0.0f,  0.0f ,0.0f}, { 255, 255, 255, 255 } };
+	auto tr = VA_TYPE_C{ {0.0f,  0.0f ,0.0f}, { 255, 255, 255, 255 } };
+	auto bl = VA_TYPE_C{ {0.0f, -1.0f ,0.0f}, { 255, 255, 255,   0 } };
+	auto br = VA_TYPE_C{ {0.0f, -1.0f ,0.0f}, { 255, 255, 255,   0 } };
+
+	// same layout as CBasicMeshDrawer, border patches are never stitched on their map-edge side
+	switch (b)
+	{
+	case CGeoMipMeshDrawer::MAP_BORDER_L: {
+		tl.pos.x = 0.0f; tl.pos.z = 0.0f;
+		bl.pos.x = 0.0f; bl.pos.z = 0.0f;
+		tr.pos.x = 0.0f; tr.pos.z = PATCH_SIZE * SQUARE_SIZE;
+		br.pos.x = 0.0f; br.pos.z = PATCH_SIZE * SQUARE_SIZE;
+	} break;
+	case CGeoMipMeshDrawer::MAP_BORDER_R: {
+		tl.pos.x = PATCH_SIZE * SQUARE_SIZE; tl.pos.z = PATCH_SIZE * SQUARE_SIZE;
+		bl.pos.x = PATCH_SIZE * SQUARE_SIZE; bl.pos.z = PATCH_SIZE * SQUARE_SIZE;
+		tr.pos.x = PATCH_SIZE * SQUARE_SIZE; tr.pos.z = 0.0f;
+		br.pos.x = PATCH_SIZE * SQUARE_SIZE; br.pos.z = 0.0f;
+	} break;
+	case CGeoMipMeshDrawer::MAP_BORDER_T: {
+		tl.pos.x = PATCH_SIZE * SQUARE_SIZE; tl.pos.z = 0.0f;
+		bl.pos.x = PATCH_SIZE * SQUARE_SIZE; bl.pos.z = 0.0f;
+		tr.pos.x = 0.0f;                     tr.pos.z = 0.0f;
+		br.pos.x = 0.0f;                     br.pos.z = 0.0f;
+	} break;
+	case CGeoMipMeshDrawer::MAP_BORDER_B: {
+		tl.pos.x = 0.0f;                     tl.pos.z = PATCH_SIZE * SQUARE_SIZE;
+		bl.pos.x = 0.0f;                     bl.pos.z = PATCH_SIZE * SQUARE_SIZE;
+		tr.pos.x = PATCH_SIZE * SQUARE_SIZE; tr.pos.z = PATCH_SIZE * SQUARE_SIZE;
+		br.pos.x = PATCH_SIZE * SQUARE_SIZE; br.pos.z = PATCH_SIZE * SQUARE_SIZE;
+	} break;
+	default:
+		assert(false);
+		break;
+	}
+
+	borderRenderBuffer->MakeQuadsTriangles(
+		tl,
+		tr,
+		br,
+		bl,
+		PATCH_SIZE / lodStep,
+		1
+	);
+}
+
+
+
+void CGeoMipMeshDrawer::UpdateVisibility(const CCamera* cam)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static constexpr float wsEdge = PATCH_SIZE * SQUARE_SIZE;
+
+	for (uint32_t x = 0; x < numPatchesX; ++x) {
+		for (uint32_t z = 0; z < numPatchesY; ++z) {
+			const auto& uhmi = readMap->GetUnsyncedHeightInfo(x, z);
+
+			AABB aabb {
+				{ (x + 0) * wsEdge, uhmi.x, (z + 0) * wsEdge },
+				{ (x + 1) * wsEdge, uhmi.y, (z + 1) * wsEdge }
+			};
+
+			if (!cam->InView(aabb))
+				continue;
+
+			meshVisPatches[z * numPatchesX + x].visUpdateFrames[cam->GetCamType()] = globalRendering->drawFrame;
+		}
+	}
+}
+
+void CGeoMipMeshDrawer::UpdatePatchLODs(const DrawPass::e& drawPass)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static constexpr float wsEdge = PATCH_SIZE * SQUARE_SIZE;
+
+	// LODs always follow the player camera, s.t. e.g. the shadow mesh matches the visible one
+	const float3& camPos = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER)->GetPos();
+	const float lodDistScale = 1.0f / (std::max(smfGroundDrawer->GetGroundDetail(drawPass), 1) * LOD_DIST_SCALE);
+
+	for (uint32_t z = 0; z < numPatchesY; ++z) {
+		for (uint32_t x = 0; x < numPatchesX; ++x) {
+			const auto& uhmi = readMap->GetUnsyncedHeightInfo(x, z);
+
+			// distance to the closest point of the patch bounds
+			const float3 closestPos = {
+				std::clamp(camPos.x, (x + 0) * wsEdge, (x + 1) * wsEdge),
+				std::clamp(camPos.y, uhmi.x, uhmi.y),
+				std::clamp(camPos.z, (z + 0) * wsEdge, (z + 1) * wsEdge)
+			};
+
+			const float lodDist = std::max(camPos.distance(closestPos) * lodDistScale, 1.0f);
+
+			patchLODs[z * numPatchesX + x] = static_cast<uint8_t>(std::min(static_cast<int>(std::log2(lodDist)), LOD_LEVELS - 1));
+		}
+	}
+
+	// refine patches until no two neighbors are more than one level apart; converges
+	// after at most LOD_LEVELS iterations since a level is never raised
+	for (bool changed = true; changed; ) {
+		changed = false;
+
+		for (uint32_t z = 0; z < numPatchesY; ++z) {
+			for (uint32_t x = 0; x < numPatchesX; ++x) {
+				const uint32_t idx = z * numPatchesX + x;
+
+				uint8_t lod = patchLODs[idx];
+
+				if (x > (              0)) lod = std::min(lod, static_cast<uint8_t>(patchLODs[idx -           1] + 1));
+				if (x < (numPatchesX - 1)) lod = std::min(lod, static_cast<uint8_t>(patchLODs[idx +           1] + 1));
+				if (z > (              0)) lod = std::min(lod, static_cast<uint8_t>(patchLODs[idx - numPatchesX] + 1));
+				if (z < (numPatchesY - 1)) lod = std::min(lod, static_cast<uint8_t>(patchLODs[idx + numPatchesX] + 1));
+
+				changed |= (lod != patchLODs[idx]);
+				patchLODs[idx] = lod;
+			}
+		}
+	}
+
+	for (uint32_t z = 0; z < numPatchesY; ++z) {
+		for (uint32_t x = 0; x < numPatchesX; ++x) {
+			const uint32_t idx = z * numPatchesX + x;
+			const uint8_t lod = patchLODs[idx];
+
+			uint8_t mask = 0;
+
+			if (x > (              0) && patchLODs[idx -           1] > lod) mask |= STITCH_EDGE_L;
+			if (x < (numPatchesX - 1) && patchLODs[idx +           1] > lod) mask |= STITCH_EDGE_R;
+			if (z > (              0) && patchLODs[idx - numPatchesX] > lod) mask |= STITCH_EDGE_T;
+			if (z < (numPatchesY - 1) && patchLODs[idx + numPatchesX] > lod) mask |= STITCH_EDGE_B;
+
+			patchStitchMasks[idx] = mask;
+		}
+	}
+}
+
+
+
+void CGeoMipMeshDrawer::DrawSquareMeshPatch(uint32_t patchIdx) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const MeshLOD& meshLOD = meshLODs[patchLODs[patchIdx]];
+	const uint8_t mask = patchStitchMasks[patchIdx];
+
+	meshLOD.vao.Bind();
+	glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(meshLOD.indxCounts[mask]), GL_UNSIGNED_INT, reinterpret_cast<const void*>(meshLOD.indxOffsets[mask] * sizeof(uint32_t)));
+	meshLOD.vao.Unbind();
+}
+
+void CGeoMipMeshDrawer::DrawMesh(const DrawPass::e& drawPass)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const CCamera* activeCam = CCameraHandler::GetActiveCamera();
+
+	UpdateVisibility(activeCam);
+	UpdatePatchLODs(drawPass);
+
+	for (uint32_t py = 0; py < numPatchesY; py += 1) {
+		for (uint32_t px = 0; px < numPatchesX; px += 1) {
+			const uint32_t patchIdx = py * numPatchesX + px;
+
+			if (meshVisPatches[patchIdx].visUpdateFrames[activeCam->GetCamType()] < globalRendering->drawFrame)
+				continue;
+
+			smfGroundDrawer->SetupBigSquare(drawPass, px, py);
+
+			DrawSquareMeshPatch(patchIdx);
+		}
+	}
+}
+
+
+
+void CGeoMipMeshDrawer::DrawBorderMeshPatch(uint32_t patchIdx, uint32_t borderSide) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const auto idx = patchLODs[patchIdx] * static_cast<uint32_t>(MAP_BORDER_C) + borderSide;
+	borderRenderBuffers[idx]->DrawElements(GL_TRIANGLES, false);
+}
+
+void CGeoMipMeshDrawer::DrawBorderMesh(const DrawPass::e& drawPass)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const uint32_t npxm1 = numPatchesX - 1;
+	const uint32_t npym1 = numPatchesY - 1;
+
+	const CCamera* activeCam  = CCameraHandler::GetActiveCamera();
+	const uint32_t actCamType = activeCam->GetCamType();
+
+	// relies on the patch LODs of the preceding DrawMesh call for this pass
+	for (uint32_t px = 0; px < numPatchesX; px++) {
+		if (meshVisPatches[0 * numPatchesX + px].visUpdateFrames[actCamType] < globalRendering->drawFrame)
+			continue;
+
+		smfGroundDrawer->SetupBigSquare(drawPass, px, 0);
+		DrawBorderMeshPatch(0 * numPatchesX + px, MAP_BORDER_T);
+	}
+	for (uint32_t py = 0; py < numPatchesY; py++) {
+		if (meshVisPatches[py * numPatchesX + npxm1].visUpdateFrames[actCamType] < globalRendering->drawFrame)
+			continue;
+
+		smfGroundDrawer->SetupBigSquare(drawPass, npxm1, py);
+		DrawBorderMeshPatch(py * numPatchesX + npxm1, MAP_BORDER_R);
+	}
+
+	for (uint32_t px = 0; px < numPatchesX; px++) {
+		if (meshVisPatches[npym1 * numPatchesX + px].visUpdateFrames[actCamType] < globalRendering->drawFrame)
+			continue;
+
+		smfGroundDrawer->SetupBigSquare(drawPass, px, npym1);
+		DrawBorderMeshPatch(npym1 * numPatchesX + px, MAP_BORDER_B);
+	}
+	for (uint32_t py = 0; py < numPatchesY; py++) {
+		if (meshVisPatches[py * numPatchesX + 0].visUpdateFrames[actCamType] < globalRendering->drawFrame)
+			continue;
+
+		smfGroundDrawer->SetupBigSquare(drawPass, 0, py);
+		DrawBorderMeshPatch(py * numPatchesX + 0, MAP_BORDER_L);
+	}
+}
@@ -0,0 +1,99 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _GEOMIP_MESH_DRAWER_H_
+#define _GEOMIP_MESH_DRAWER_H_
+
+#include <array>
+#include <vector>
+#include <memory>
+
+#include "Map/MapDrawPassTypes.h"
+#include "Map/SMF/IMeshDrawer.h"
+#include "Rendering/GL/RenderBuffersFwd.h"
+#include "Rendering/GL/VBO.h"
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VertexArrayTypes.h"
+
+class CSMFGroundDrawer;
+class CCamera;
+
+/**
+ * Map mesh drawer built from static, GPU-resident patch grids (geomipmapping).
+ *
+ * Every LOD level is one flat grid of xz-positions whose heights are read from
+ * the heightmap texture by the map shaders, so terrain deformation only costs
+ * the (partial) heightmap texture updates SMFReadMap already does. Per pass the
+ * CPU only picks a LOD per patch from its camera distance; neighbors differ by
+ * at most one level and the finer patch draws one of the pre-built index sets
+ * that collapse its edge vertices onto the coarser neighbor's to avoid cracks.
+ */
+class CGeoMipMeshDrawer : public IMeshDrawer {
+public:
+	CGeoMipMeshDrawer(CSMFGroundDrawer* gd);
+	~CGeoMipMeshDrawer();
+
+	static constexpr int32_t PATCH_SIZE = 128; // must match SMFReadMap::bigSquareSize
+	static constexpr int32_t LOD_LEVELS =   8; // log2(PATCH_SIZE) + 1; 129x129 to 2x2
+
+	enum MAP_BORDERS {
+		MAP_BORDER_L = 0,
+		MAP_BORDER_R = 1,
+		MAP_BORDER_T = 2,
+		MAP_BORDER_B = 3,
+		MAP_BORDER_C = MAP_BORDER_B + 1
+	};
+
+	// patch edges that are stitched to a coarser neighbor
+	enum STITCH_EDGES {
+		STITCH_EDGE_L = 1 << MAP_BORDER_L,
+		STITCH_EDGE_R = 1 << MAP_BORDER_R,
+		STITCH_EDGE_T = 1 << MAP_BORDER_T,
+		STITCH_EDGE_B = 1 << MAP_BORDER_B,
+		STITCH_EDGE_C = 1 << MAP_BORDER_C
+	};
+
+	using BordRenderBuffer = TypedRenderBuffer<VA_TYPE_C>;
+
+	struct MeshVisPatch {
+		std::array<uint32_t, 4> visUpdateFrames;	// [CAMTYPE_PLAYER -> CAMTYPE_ENVMAP]
+	};
+
+	void Update() override {}
+
+	void DrawMesh(const DrawPass::e& drawPass) override;
+	void DrawBorderMesh(const DrawPass::e& drawPass) override;
+private:
+	struct MeshLOD {
+		VBO vertVBO;
+		VBO indxVBO;
+		VAO vao;
+
+		// per stitch mask, in indices
+		std::array<uint32_t, STITCH_EDGE_C> indxOffsets = {};
+		std::array<uint32_t, STITCH_EDGE_C> indxCounts = {};
+	};
+
+	void UploadPatchSquareGeometry(MeshLOD& meshLOD, uint32_t lod);
+	void UploadPatchBorderGeometry(std::unique_ptr<BordRenderBuffer>& borderRenderBuffer, MAP_BORDERS b, uint32_t lodStep);
+
+	void UpdateVisibility(const CCamera* cam);
+	void UpdatePatchLODs(const DrawPass::e& drawPass);
+
+	void DrawSquareMeshPatch(uint32_t patchIdx) const;
+	void DrawBorderMeshPatch(uint32_t patchIdx, uint32_t borderSide) const;
+private:
+	uint32_t numPatchesX;
+	uint32_t numPatchesY;
+
+	std::vector<MeshVisPatch> meshVisPatches;
+	// LOD level and stitch mask per patch, for the pass last drawn
+	std::vector<uint8_t> patchLODs;
+	std::vector<uint8_t> patchStitchMasks;
+
+	std::array<MeshLOD, LOD_LEVELS> meshLODs;
+	std::array<std::unique_ptr<BordRenderBuffer>, MAP_BORDERS::MAP_BORDER_C * LOD_LEVELS> borderRenderBuffers;
+
+	CSMFGroundDrawer* smfGroundDrawer;
+};
+
+#endif
@@ -16,11 +16,13 @@
 #include "Map/ReadMap.h"
 #include "Map/SMF/SMFGroundDrawer.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/FrameRingBuffer.h"
 #include "System/Log/ILog.h"
 #include "System/Threading/ThreadPool.h"
 #include "xsimd/xsimd.hpp"
 
 #include <climits>
+#include <cstring>
 #include <array>
 
 #include "System/Misc/TracyDefs.h"
@@ -87,17 +89,19 @@ void CTriNodePool::Resize(size_t poolSize)
 bool CTriNodePool::Allocate(TriTreeNode*& left, TriTreeNode*& right)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t triNodeIdx = nextTriNodeIdx.fetch_add(2);
+
 	// pool exhausted, make sure both child nodes are dummies
-	if (OutOfNodes()) {
-		LOG_L(L_WARNING, "[TriNodePool::%s] #nodes=" _STPF_ " #pool=" _STPF_ , __func__, nextTriNodeIdx, tris.size());
+	if (triNodeIdx >= tris.size()) {
+		LOG_L(L_WARNING, "[TriNodePool::%s] #nodes=" _STPF_ " #pool=" _STPF_ , __func__, triNodeIdx, tris.size());
 
 		left  = &TriTreeNode::dummyNode;
 		right = &TriTreeNode::dummyNode;
 		return false;
 	}
 
-	left  = &tris[nextTriNodeIdx++];
-	right = &tris[nextTriNodeIdx++];
+	left  = &tris[triNodeIdx + 0];
+	right = &tris[triNodeIdx + 1];
 
 	left->Reset();
 	right->Reset();
@@ -204,8 +208,10 @@ namespace {
 		static constexpr auto usage = GL_STREAM_DRAW;
 		bool vboUpdated = false;
 
+		const size_t sz = vec.size() * sizeof(T);
+
 		vbo.Bind();
-		if (const size_t sz = vec.size() * sizeof(T); (sz > vbo.GetSize() || vbo.GetSize() >= sz * sizeDownMult)) {
+		if (sz > vbo.GetSize() || vbo.GetSize() >= sz * sizeDownMult) {
 			// resize/remake the buffer without copying the old buffer content
 			vbo.Unbind();
 			vbo = VBO{ target, false, false };
@@ -213,9 +219,27 @@ namespace {
 			vbo.New(sz * sizeUpMult, usage, nullptr);
 			vboUpdated = true;
 		}
-		vbo.SetBufferSubData(vec);
+
+		// stream through the shared per-frame staging ring, GPU-side copied into vbo
+		FrameRingBuffer& frb = FrameRingBuffer::GetInstance();
+		const FrameRingBuffer::Allocation staging = frb.Allocate(static_cast<uint32_t>(sz));
+
+		if (!staging.Valid()) {
+			vbo.SetBufferSubData(vec);
+			vbo.Unbind();
+			return vboUpdated;
+		}
+
 		vbo.Unbind();
 
+		std::memcpy(staging.ptr, vec.data(), sz);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, frb.GetID());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, vbo.GetId());
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, staging.offset, 0, sz);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
 		return vboUpdated;
 	}
 }
@@ -276,6 +300,22 @@ void Patch::InitBorderVAO() const
 	glDisableVertexAttribArray(0);
 }
 
+// -------------------------------------------------------------------------------------------------
+// Whether splitting tri only writes to this patch and its direct neighbors.
+//
+bool Patch::InSplitBounds(const TriTreeNode* tri) const
+{
+	const auto InBounds = [this](const TriTreeNode* n) {
+		if (n->IsDummy())
+			return true;
+
+		const int2& nc = n->parentPatch->coors;
+		return (std::abs(nc.x - coors.x) <= PATCH_SIZE && std::abs(nc.y - coors.y) <= PATCH_SIZE);
+	};
+
+	return (InBounds(tri) && InBounds(tri->LeftNeighbor) && InBounds(tri->RightNeighbor) && InBounds(tri->BaseNeighbor));
+}
+
 // -------------------------------------------------------------------------------------------------
 // Split a single Triangle and link it into the mesh.
 // Will correctly force-split diamonds.
@@ -290,12 +330,24 @@ bool Patch::Split(TriTreeNode* tri)
 	if (!tri->IsLeaf())
 		return true;
 
+	if (boundSplits && (splitDeferred || !InSplitBounds(tri))) {
+		splitDeferred = true;
+		return false;
+	}
+
 	// if this triangle is not in a proper diamond, force split our base-neighbor
 	if (!tri->BaseNeighbor->IsDummy() && (tri->BaseNeighbor->BaseNeighbor != tri)) {
 		Split(tri->BaseNeighbor);
 		if (tri->BaseNeighbor->parentPatch != this)
 			tri->BaseNeighbor->parentPatch->isChanged = true;
 	}
+
+	// the diamond partner is split below as well, leave both alone if either is out of bounds
+	if (boundSplits && (splitDeferred || (!tri->BaseNeighbor->IsDummy() && tri->BaseNeighbor->IsLeaf() && !InSplitBounds(tri->BaseNeighbor)))) {
+		splitDeferred = true;
+		return false;
+	}
+
 	// create children and link into mesh, or make this triangle a leaf
 	if (!curTriPool->Allocate(tri->LeftChild, tri->RightChild))
 		return false;
@@ -389,7 +441,7 @@ void Patch::RecursTessellate(TriTreeNode* tri, const int2 left, const int2 right
 	// bail if we can not tessellate further in at least one dimension
 	if ((abs(left.x - right.x) <= 1) && (abs(left.y - right.y) <= 1))
 		return;
-	if (tri->IsDummy())
+	if (tri->IsDummy() || splitDeferred)
 		return;
 
 	// default > 1; when variance isn't saved this issues further tessellation
@@ -593,10 +645,12 @@ void Patch::ComputeVariance()
 // ---------------------------------------------------------------------
 // Create an approximate mesh.
 //
-bool Patch::Tessellate(const float3& camPos, int viewRadius, bool shadowPass)
+bool Patch::Tessellate(const float3& camPos, int viewRadius, bool shadowPass, bool boundedSplits)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	isTesselated = true;
+	boundSplits = boundedSplits;
+	splitDeferred = false;
 
 	// Set/Update LOD params (FIXME: wrong height?)
 
@@ -636,6 +690,7 @@ bool Patch::Tessellate(const float3& camPos, int viewRadius, bool shadowPass)
 	if (baseLeft.IsLeaf() && baseRight.IsLeaf()) isChanged = true;
 
 	lastCameraPosition = camPos;
+	boundSplits = false;
 	return (!curTriPool->OutOfNodes());
 }
 
@@ -13,6 +13,7 @@
 
 
 #include <array>
+#include <atomic>
 #include <vector>
 
 
@@ -80,8 +81,8 @@ public:
 private:
 	std::vector<TriTreeNode> tris;
 
-	// index of next free TriTreeNode
-	size_t nextTriNodeIdx = 0;
+	// index of next free TriTreeNode, shared by the patches tessellated in parallel
+	std::atomic<size_t> nextTriNodeIdx = 0;
 
 	// how many TriTreeNodes should be reserved per pool
 	// (2M is a reasonable baseline for most large maps)
@@ -129,7 +130,10 @@ public:
 
 	// create an approximate mesh
 
-	bool Tessellate(const float3& camPos, int viewRadius, bool shadowPass);
+	// with <boundedSplits>, splits that would touch triangles outside of this patch and its
+	// eight neighbors are skipped and the patch is marked for a (serial) retessellation, so
+	// patches at least three apart can be tessellated concurrently
+	bool Tessellate(const float3& camPos, int viewRadius, bool shadowPass, bool boundedSplits = false);
 	void ComputeVariance();
 
 	void GenerateIndices();
@@ -147,6 +151,8 @@ private:
 	void InitMainVAO() const;
 	void InitBorderVAO() const;
 
+	bool InSplitBounds(const TriTreeNode* tri) const;
+
 	// recursive functions
 	bool Split(TriTreeNode* tri);
 	void RecursTessellate(TriTreeNode* tri, const int2 left, const int2 right, const int2 apex, const int varTreeIdx, const int curNodeIdx);
@@ -187,6 +193,9 @@ private:
 	bool isDirty = true;
 	// Did the tesselation tree change from what we have stored in the VBO?
 	bool isChanged = false;
+	// is the current Tessellate call bounded, and did it skip splits because of that?
+	bool boundSplits = false;
+	bool splitDeferred = false;
 
 	float varianceMaxLimit = std::numeric_limits<float>::max();
 	float camDistLODFactor = 1.0f; // defines the LOD falloff in camera distance
@@ -40,6 +40,8 @@ static constexpr int RETESSELLATE_TO_FREE_INVISIBLE_PATCHES = 50;
 static constexpr float MAGIC_RETESSELATE_CAMERA_RATIO = 1.5f;
 static constexpr float MAGIC_TOTAL_CAMDIST_RETESSELATE = 2.5f;
 static constexpr float CAMERA_CHANGE_TRESHOLD = 16.0f;
+// below this many patches to tessellate, the for_mt per patch color costs more than it saves
+static constexpr size_t MIN_PARALLEL_TESSELLATIONS = 32;
 
 
 bool CRoamMeshDrawer::forceNextTesselation[MESH_COUNT] = {false, false};
@@ -203,7 +205,7 @@ void CRoamMeshDrawer::Update()
 	if ((!forceNextTesselation[shadowPass]) &&
 		(cam->GetPos().distance(lastCamPos[shadowPass]) < CAMERA_CHANGE_TRESHOLD) &&
 		(cam->GetDir().distance(lastCamDir[shadowPass]) < CAMERA_CHANGE_TRESHOLD * 0.001f) &&
-		(heightMapChanged == false) &&
+		(heightMapChanged[shadowPass] == false) &&
 		!gldUpdated) {
 		return;
 	}
@@ -222,6 +224,8 @@ void CRoamMeshDrawer::Update()
 	std::vector<bool> patchesToTesselate(numPatches);
 	std::fill(patchesToTesselate.begin(), patchesToTesselate.end(), gldUpdated);
 
+	dirtyPatches.clear();
+
 #if TESSELATION_DEBUG
 	if (tesselMesh)
 		LOG("Tesselation forced for pass %i in frame %i", shadowPass,globalRendering->drawFrame);
@@ -232,7 +236,7 @@ void CRoamMeshDrawer::Update()
 		//SCOPED_TIMER("ROAM::ComputeVariance");
 
 		for (int i = 0; i < numPatches; ++i) {
-			//FIXME multithread? don't retessellate on small heightmap changes?
+			//FIXME don't retessellate on small heightmap changes?
 			Patch& p = patches[i];
 
 			const bool isVisibleNow = p.IsVisible(cam);
@@ -269,9 +273,9 @@ void CRoamMeshDrawer::Update()
 			// second case, a patch entered visibility:
 			if (isVisibleNow) {
 				numPatchesVisible++;
-				// if it was dirty(had heightmap change) then recompute variances.
+				// if it was dirty(had heightmap change) then recompute variances (below).
 				if (p.IsDirty()) {
-					p.ComputeVariance();
+					dirtyPatches.push_back(i);
 					// here we can do incremental retesselation?
 					patchesToTesselate[i] = true;
 				}
@@ -316,6 +320,11 @@ void CRoamMeshDrawer::Update()
 				}
 			#endif
 		}
+
+		// variance trees only depend on the heightmap, each patch can compute its own
+		for_mt(0, static_cast<int>(dirtyPatches.size()), [this, &patches](const int i) {
+			patches[dirtyPatches[i]].ComputeVariance();
+		});
 	}
 
 	int actualTesselations = 0;
@@ -340,9 +349,9 @@ void CRoamMeshDrawer::Update()
 		// then reset all of them and try again
 		bool tessSuccess = true;
 		if (!forceNextTesselation[shadowPass]) {
-			for (int pi = 0; pi < numPatches; ++pi) {
-				Patch& p = patches[pi];
+			tessPatches.clear();
 
+			for (int pi = 0; pi < numPatches; ++pi) {
 			#ifdef DRAW_DEBUG_IN_MINIMAP
 				debugColors[pi].x = std::max (debugColors[pi].x -0.002f,0.0f);
 			#endif
@@ -350,68 +359,70 @@ void CRoamMeshDrawer::Update()
 				if (!patchesToTesselate[pi])
 					continue;
 
-				actualTesselations++;
-				tesselationsSinceLastReset[shadowPass]++;
+				tessPatches.push_back(pi);
 
 			#ifdef DRAW_DEBUG_IN_MINIMAP
 				debugColors[pi].x = 1.0;
 			#endif
+			}
 
-				if (p.Tessellate(playerCameraPosition, smfGroundDrawer->GetGroundDetail(), shadowPass))
-					continue;
+			actualTesselations += tessPatches.size();
+			tesselationsSinceLastReset[shadowPass] += tessPatches.size();
 
-				tessSuccess = false;
+			tessSuccess = TessellatePatches(patches, tessPatches, playerCameraPosition, smfGroundDrawer->GetGroundDetail(), shadowPass);
 
-			#if TESSELATION_DEBUG
+		#if TESSELATION_DEBUG
+			if (!tessSuccess) {
 				LOG("Lazy tesselation ran out of trinodes, trying again after a reset #Visible=%i #tesssincelastreset=%i, shadow=%i",
 					numPatchesVisible,
 					tesselationsSinceLastReset[shadowPass],
 					shadowPass);
-			#endif // TESSELATION_DEBUG
-
-				break;
 			}
+		#endif // TESSELATION_DEBUG
 		}
 
 		if(forceNextTesselation[shadowPass] || !tessSuccess) {
 			Reset(shadowPass);
+			tessPatches.clear();
+
 			for (int pi = 0; pi < numPatches; ++pi) {
-				Patch& p = patches[pi];
-				if (!p.IsVisible(cam))
+				if (!patches[pi].IsVisible(cam))
 					continue;
 
-				p.Tessellate(playerCameraPosition, smfGroundDrawer->GetGroundDetail(), shadowPass);
-				actualTesselations++;
-				tesselationsSinceLastReset[shadowPass]++;
+				tessPatches.push_back(pi);
 
 			#ifdef DRAW_DEBUG_IN_MINIMAP
 				debugColors[pi].x = 1.0;
 			#endif
 			}
+
+			actualTesselations += tessPatches.size();
+			tesselationsSinceLastReset[shadowPass] += tessPatches.size();
+
+			TessellatePatches(patches, tessPatches, playerCameraPosition, smfGroundDrawer->GetGroundDetail(), shadowPass);
 		}
 	}
 
 	{
 		//SCOPED_TIMER("ROAM::GenerateIndexArray");
-		//only do for_mt if a full tesselation happened, since only a few patches come into visibility
-		if (forceNextTesselation[shadowPass]) {
-			for_mt(0, numPatches, [&patches, &cam](const int i) {
-				Patch* p = &patches[i];
-				if (!p->IsVisible(cam))
-					return;
-
-				p->GenerateIndices();
-				p->GenerateBorderVertices();
-			});
-		} else {
-			for (Patch& p: patches) {
-				if (!p.IsVisible(cam) || !p.isChanged)
-					continue;
+		changedPatches.clear();
 
-				p.GenerateIndices();
-				p.GenerateBorderVertices();
-			}
+		// after a full tesselation every visible patch needs new indices
+		for (int pi = 0; pi < numPatches; ++pi) {
+			const Patch& p = patches[pi];
+
+			if (!p.IsVisible(cam) || !(p.isChanged || forceNextTesselation[shadowPass]))
+				continue;
+
+			changedPatches.push_back(pi);
 		}
+
+		for_mt(0, static_cast<int>(changedPatches.size()), [this, &patches](const int i) {
+			Patch* p = &patches[changedPatches[i]];
+
+			p->GenerateIndices();
+			p->GenerateBorderVertices();
+		});
 	}
 	{
 		//SCOPED_TIMER("ROAM::Upload");
@@ -446,7 +457,7 @@ void CRoamMeshDrawer::Update()
 	lastCamPos[shadowPass] = cam->GetPos();
 	lastCamDir[shadowPass] = cam->GetDir();
 	forceNextTesselation[shadowPass] = false;
-	heightMapChanged = false;
+	heightMapChanged[shadowPass] = false;
 }
 
 
@@ -588,6 +599,53 @@ void CRoamMeshDrawer::Tessellate(std::vector<Patch>& patches, const CCamera* cam
 }
 
 
+bool CRoamMeshDrawer::TessellatePatches(std::vector<Patch>& patches, const std::vector<int>& patchIndices, const float3& camPos, int viewRadius, bool shadowPass)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (patchIndices.empty())
+		return true;
+
+	bool tessSuccess = true;
+
+	if (patchIndices.size() < MIN_PARALLEL_TESSELLATIONS) {
+		for (const int pi: patchIndices) {
+			tessSuccess &= patches[pi].Tessellate(camPos, viewRadius, shadowPass);
+		}
+
+		return tessSuccess;
+	}
+
+	// splits propagate into neighboring patches; patches of the same color are at
+	// least three apart so the 3x3 patch blocks their bounded splits may write to
+	// never overlap, and each color can be tessellated by all threads at once
+	for (auto& colorPatches: tessPatchColors) {
+		colorPatches.clear();
+	}
+	for (const int pi: patchIndices) {
+		tessPatchColors[((pi / numPatchesX) % 3) * 3 + ((pi % numPatchesX) % 3)].push_back(pi);
+	}
+
+	for (const auto& colorPatches: tessPatchColors) {
+		for_mt(0, static_cast<int>(colorPatches.size()), [&](const int i) {
+			patches[colorPatches[i]].Tessellate(camPos, viewRadius, shadowPass, true);
+		});
+	}
+
+	// finish the few patches whose splits had to reach further out
+	for (const int pi: patchIndices) {
+		Patch& p = patches[pi];
+
+		if (!p.splitDeferred)
+			continue;
+
+		p.Tessellate(camPos, viewRadius, shadowPass);
+	}
+
+	// all patches of a pass share one pool
+	return (!patches[patchIndices.front()].curTriPool->OutOfNodes());
+}
+
+
 void CRoamMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -620,6 +678,6 @@ void CRoamMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect)
 			}
 		}
 	}
-	heightMapChanged = true;
+	heightMapChanged.fill(true);
 }
 
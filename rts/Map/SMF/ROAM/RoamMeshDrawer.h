@@ -61,6 +61,7 @@ public:
 private:
 	void Reset(bool shadowPass);
 	void Tessellate(std::vector<Patch>& patches, const CCamera* cam, int viewRadius, bool shadowPass);
+	bool TessellatePatches(std::vector<Patch>& patches, const std::vector<int>& patchIndices, const float3& camPos, int viewRadius, bool shadowPass);
 
 private:
 	CSMFGroundDrawer* smfGroundDrawer;
@@ -69,7 +70,7 @@ private:
 	int numPatchesY = 0;
 	std::array<int, MESH_COUNT> lastGroundDetail = {};
 
-	bool heightMapChanged = false;
+	std::array<bool, MESH_COUNT> heightMapChanged = {};
 
 	std::array<float3, MESH_COUNT> lastCamPos;
 	std::array<float3, MESH_COUNT> lastCamDir;
@@ -85,6 +86,13 @@ private:
 	// char instead of bool, accessors to different elements must be thread-safe
 	std::vector<uint8_t> patchVisFlags[MESH_COUNT];
 
+	// scratch lists of patch indices, reused between updates
+	std::vector<int> dirtyPatches;
+	std::vector<int> tessPatches;
+	std::vector<int> changedPatches;
+	// tessPatches bucketed by (x % 3, z % 3) patch coordinates
+	std::array<std::vector<int>, 9> tessPatchColors;
+
 	// whether tessellation should be forcibly performed next frame
 	static bool forceNextTesselation[MESH_COUNT];
 
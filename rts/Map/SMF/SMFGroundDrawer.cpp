@@ -8,6 +8,7 @@
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
 #include "Map/SMF/Basic/BasicMeshDrawer.h"
+#include "Map/SMF/GeoMip/GeoMipMeshDrawer.h"
 #include "Map/SMF/ROAM/RoamMeshDrawer.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/ShadowHandler.h"
@@ -26,7 +27,7 @@
 
 #include "System/Misc/TracyDefs.h"
 
-//Basic, ROAM
+//Basic, ROAM (also GeoMip)
 static constexpr int MIN_GROUND_DETAIL[] = {                               0,   4};
 static constexpr int MAX_GROUND_DETAIL[] = {CBasicMeshDrawer::LOD_LEVELS - 1, 200};
 
@@ -52,8 +53,8 @@ CONFIG(bool, AllowDrawMapDeferredEvents).defaultValue(false).description("Enable
 CONFIG(int, ROAM)
 	.defaultValue(1)
 	.minimumValue(0)
-	.maximumValue(1)
-	.description("Use ROAM for terrain mesh rendering: 0 to disable, 1=VBO mode to enable.");
+	.maximumValue(2)
+	.description("Use ROAM for terrain mesh rendering: 0 to disable, 1=VBO mode to enable, 2=GPU-resident geomipmapped mesh instead.");
 
 CONFIG(bool, AlwaysSendDrawGroundEvents)
 	.defaultValue(false)
@@ -69,7 +70,11 @@ CSMFGroundDrawer::CSMFGroundDrawer(CSMFReadMap* rm)
 	, geomBuffer{"GROUNDDRAWER-GBUFFER"}
 {
 	alwaysDispatchEvents = configHandler->GetBool("AlwaysSendDrawGroundEvents");
-	drawerMode = (configHandler->GetInt("ROAM") != 0)? SMF_MESHDRAWER_ROAM: SMF_MESHDRAWER_BASIC;
+	switch (configHandler->GetInt("ROAM")) {
+		case  0: { drawerMode = SMF_MESHDRAWER_BASIC ; } break;
+		case  2: { drawerMode = SMF_MESHDRAWER_GEOMIP; } break;
+		default: { drawerMode = SMF_MESHDRAWER_ROAM  ; } break;
+	}
 	groundDetail = configHandler->GetInt("GroundDetail");
 
 	groundTextures = new CSMFGroundTextures(smfMap);
@@ -125,7 +130,11 @@ CSMFGroundDrawer::~CSMFGroundDrawer()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// remember which ROAM-mode was enabled (if any)
-	configHandler->Set("ROAM", (dynamic_cast<CRoamMeshDrawer*>(meshDrawer) != nullptr)? 1: 0);
+	if (dynamic_cast<CGeoMipMeshDrawer*>(meshDrawer) != nullptr) {
+		configHandler->Set("ROAM", 2);
+	} else {
+		configHandler->Set("ROAM", (dynamic_cast<CRoamMeshDrawer*>(meshDrawer) != nullptr)? 1: 0);
+	}
 
 	smfRenderStates[RENDER_STATE_SSP]->Kill(); ISMFRenderState::FreeInstance(smfRenderStates[RENDER_STATE_SSP]);
 	smfRenderStates[RENDER_STATE_LUA]->Kill(); ISMFRenderState::FreeInstance(smfRenderStates[RENDER_STATE_LUA]);
@@ -163,6 +172,10 @@ IMeshDrawer* CSMFGroundDrawer::SwitchMeshDrawer(int wantedMode)
 			LOG("Switching to Basic Mesh Rendering");
 			meshDrawer = new CBasicMeshDrawer(this);
 		} break;
+		case SMF_MESHDRAWER_GEOMIP: {
+			LOG("Switching to GeoMip Mesh Rendering");
+			meshDrawer = new CGeoMipMeshDrawer(this);
+		} break;
 		default: {
 			LOG("Switching to ROAM Mesh Rendering");
 			meshDrawer = new CRoamMeshDrawer(this);
@@ -494,11 +507,12 @@ bool CSMFGroundDrawer::UpdateGeometryBuffer(bool init)
 void CSMFGroundDrawer::SetDetail(int newGroundDetail)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const int minGroundDetail = MIN_GROUND_DETAIL[drawerMode == SMF_MESHDRAWER_ROAM];
-	const int maxGroundDetail = MAX_GROUND_DETAIL[drawerMode == SMF_MESHDRAWER_ROAM];
+	const bool detailIsBias = (drawerMode != SMF_MESHDRAWER_ROAM && drawerMode != SMF_MESHDRAWER_GEOMIP);
+	const int minGroundDetail = MIN_GROUND_DETAIL[!detailIsBias];
+	const int maxGroundDetail = MAX_GROUND_DETAIL[!detailIsBias];
 
 	configHandler->Set("GroundDetail", groundDetail = std::clamp(newGroundDetail, minGroundDetail, maxGroundDetail));
-	LOG("GroundDetail%s set to %i", ((drawerMode != SMF_MESHDRAWER_ROAM)? "[Bias]": ""), groundDetail);
+	LOG("GroundDetail%s set to %i", (detailIsBias? "[Bias]": ""), groundDetail);
 }
 
 
@@ -78,12 +78,28 @@ CSMFGroundTextures::CSMFGroundTextures(CSMFReadMap* rm): smfMap(rm)
 	smfTextureLodBias = configHandler->GetFloat("SMFTextureLodBias");
 
 	LoadTiles(smfMap->GetMapFile());
+
+	const size_t tileBytes = tiles.size() + tileMap.size() * sizeof(int);
+
 	if (smfTextureStreaming) {
 		LoadSquareTextures(3);
 		ConvolveHeightMap(mapDims.mapx, 1);
 	} else {
 		LoadSquareTexturesPersistent();
+
+		// every square now holds all of its mips on the GPU, which is
+		// where Get/SetSquareLuaTexture take the original tiles from
+		tiles.clear();
+		tiles.shrink_to_fit();
+		tileMap.clear();
+		tileMap.shrink_to_fit();
 	}
+
+	LOG("[%s] %.1fMB of map tiles decoded, %.1fMB kept after upload (streaming=%d)", __func__,
+		tileBytes / (1024.0f * 1024.0f),
+		(tiles.size() + tileMap.size() * sizeof(int)) / (1024.0f * 1024.0f),
+		smfTextureStreaming
+	);
 }
 
 CSMFGroundTextures::~CSMFGroundTextures()
@@ -146,11 +162,12 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 			(smfDir + smtFileName):
 			(smfDir + smf.smtFileNames[a]);
 
-		CFileHandler tileFile(smtFilePath);
+		// tiles are copied out piecewise, no need to buffer the whole file first
+		CFileHandler tileFile(smtFilePath, SPRING_VFS_RAW_FIRST, true);
 
 		// try absolute path
 		if (!tileFile.FileExists())
-			tileFile.Open(smtFilePath = (!smtHeaderOverride) ? smtFileName : smf.smtFileNames[a]);
+			tileFile.Open(smtFilePath = (!smtHeaderOverride) ? smtFileName : smf.smtFileNames[a], SPRING_VFS_RAW_FIRST, true);
 
 		if (!tileFile.FileExists()) {
 			LOG_L(L_WARNING,
@@ -444,17 +461,19 @@ bool CSMFGroundTextures::SetSquareLuaTexture(int texSquareX, int texSquareY, int
 	GroundSquare* square = &squares[texSquareY * smfMap->numBigTexX + texSquareX];
 
 	if (texID != 0) {
-		// free up some memory while the Lua texture is around
-		glDeleteTextures(1, square->GetTextureIDPtr());
-		square->SetRawTexture(0);
+		// free up some memory while the Lua texture is around; without
+		// streaming the raw texture is the only copy of its tiles left
+		if (smfTextureStreaming) {
+			glDeleteTextures(1, square->GetTextureIDPtr());
+			square->SetRawTexture(0);
+		}
+
 		square->SetLuaTexture(texID);
 	}
 	else {
 		square->SetLuaTexture(0);
 		if (smfTextureStreaming)
 			LoadSquareTexture(texSquareX, texSquareY, square->GetMipLevel());
-		else
-			LoadSquareTexturePersistent(texSquareX, texSquareY);
 	}
 
 	return square->HasLuaTexture();
@@ -483,6 +502,27 @@ bool CSMFGroundTextures::GetSquareLuaTexture(int texSquareX, int texSquareY, int
 	if (texSizeY != (smfMap->bigTexSize >> lodMin))
 		return false;
 
+	if (!smfTextureStreaming) {
+		const GroundSquare& square = squares[texSquareY * smfMap->numBigTexX + texSquareX];
+
+		std::vector<GLubyte> mipBuffer;
+
+		for (int lod = lodMin; lod <= lodMax; ++lod) {
+			const int mipSqSize = smfMap->bigTexSize >> lod;
+			const int numSqBytes = (mipSqSize * mipSqSize) / 2;
+
+			mipBuffer.resize(numSqBytes);
+
+			glBindTexture(ttarget, square.GetRawTextureID());
+			glGetCompressedTexImage(ttarget, lod, mipBuffer.data());
+			glBindTexture(ttarget, texID);
+			glCompressedTexImage2D(ttarget, 0, tileTexFormat, texSizeX, texSizeY, 0, numSqBytes, mipBuffer.data());
+		}
+
+		glBindTexture(ttarget, 0);
+		return true;
+	}
+
 	glBindTexture(ttarget, texID);
 
 	for (int lod = lodMin; lod <= lodMax; ++lod) {
@@ -55,6 +55,7 @@ private:
 
 		unsigned int* GetTextureIDPtr() { return &textureIDs[RAW_TEX_IDX]; }
 		unsigned int GetTextureID() const { return textureIDs[HasLuaTexture()]; }
+		unsigned int GetRawTextureID() const { return textureIDs[RAW_TEX_IDX]; }
 		unsigned int GetMipLevel() const { return texMipLevel; }
 		unsigned int GetDrawFrame() const { return texDrawFrame; }
 
@@ -67,6 +68,7 @@ private:
 	// note: intentionally declared static (see ReadMap)
 	static std::vector<GroundSquare> squares;
 
+	// only kept with SMFTextureStreaming, the persistent squares hold all mips
 	static std::vector<int> tileMap;
 	static std::vector<char> tiles;
 
@@ -38,7 +38,8 @@ void CSMFMapFile::Open(const std::string& mapFileName)
 	memset(&featureHeader, 0, sizeof(featureHeader));
 	memset( featureTypes , 0, sizeof(featureTypes ));
 
-	ifs.Open(mapFileName);
+	// map instead of buffering, the file stays open for the whole game
+	ifs.Open(mapFileName, SPRING_VFS_RAW_FIRST, true);
 
 	if (!ifs.FileExists()) {
 		snprintf(buf, sizeof(buf), fmts[0], __func__, mapFileName.c_str());
@@ -54,6 +54,75 @@ std::vector<float> CSMFReadMap::cornerHeightMapUnsynced;
 
 static std::vector<float> normalPixels;
 
+
+// GridVisibility results, keyed by everything the visible quad set depends on;
+// the VISCUL camera holds the player's, shadow or reflection camera's state at
+// different times during a frame and each of those gets its own entry
+struct GridVisibilityCacheEntry {
+	struct Span {
+		int y;
+		int sx;
+		int ex;
+	};
+
+	bool Matches(const CCamera* cam, float maxDist, int quadSize, int extraSize) const {
+		if (quadSize != quadSizeKey || extraSize != extraSizeKey || maxDist != maxDistKey || cam->GetPos() != camPos)
+			return false;
+
+		const CCamera::FrustumLine* lines[] = {cam->GetNegFrustumLines(), cam->GetPosFrustumLines()};
+
+		for (int side = 0; side < 2; side++) {
+			const int count = lines[side][4].sign;
+
+			if (count != frustumLines[side][4].sign)
+				return false;
+
+			for (int i = 0; i < count; i++) {
+				const CCamera::FrustumLine& a = lines[side][i];
+				const CCamera::FrustumLine& b = frustumLines[side][i];
+
+				if (a.sign != b.sign || a.base != b.base || a.dir != b.dir)
+					return false;
+			}
+		}
+
+		return true;
+	}
+
+	void SetKey(const CCamera* cam, float maxDist, int quadSize, int extraSize) {
+		std::copy_n(cam->GetNegFrustumLines(), 4 + 1, frustumLines[0]);
+		std::copy_n(cam->GetPosFrustumLines(), 4 + 1, frustumLines[1]);
+
+		camPos = cam->GetPos();
+		maxDistKey = maxDist;
+		quadSizeKey = quadSize;
+		extraSizeKey = extraSize;
+	}
+
+	CCamera::FrustumLine frustumLines[2][4 + 1];
+	float3 camPos;
+
+	float maxDistKey = 0.0f;
+	int quadSizeKey = 0;
+	int extraSizeKey = 0;
+
+	uint32_t lastUsed = 0;
+
+	std::vector<Span> spans;
+};
+
+static std::array<GridVisibilityCacheEntry, 8> gridVisibilityCache;
+static uint32_t gridVisibilityCacheTick = 0;
+
+static void ClearGridVisibilityCache()
+{
+	for (GridVisibilityCacheEntry& entry: gridVisibilityCache) {
+		entry = {};
+	}
+
+	gridVisibilityCacheTick = 0;
+}
+
 CSMFReadMap::CSMFReadMap(const std::string& mapName): CEventClient("[CSMFReadMap]", 271950, false)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -102,10 +171,13 @@ CSMFReadMap::CSMFReadMap(const std::string& mapName): CEventClient("[CSMFReadMap
 	}
 
 	mapFile.ReadFeatureInfo();
+	ClearGridVisibilityCache();
 }
 
 CSMFReadMap::~CSMFReadMap()
 {
+	ClearGridVisibilityCache();
+
 	shadingFBO = nullptr;
 	shaderHandler->ReleaseProgramObject("[CSMFReadMap]", "ShadingShader");
 	mapFile.Close();
@@ -831,6 +903,32 @@ void CSMFReadMap::GridVisibility(CCamera* cam, IQuadDrawer* qd, float maxDist, i
 		cam->CalcFrustumLines(GetCurrMinHeight() - 100.0f, GetCurrMaxHeight() + 100.0f, SQUARE_SIZE);
 	}
 
+	// the callers (grass, Lua's GetVisible* and the debug drawers) ask for the same
+	// sets several times per frame, replay those instead of walking the frustum again
+	GridVisibilityCacheEntry* cacheEntry = &gridVisibilityCache[0];
+
+	for (GridVisibilityCacheEntry& entry: gridVisibilityCache) {
+		if (entry.lastUsed != 0 && entry.Matches(cam, maxDist, quadSize, extraSize)) {
+			entry.lastUsed = ++gridVisibilityCacheTick;
+
+			for (const auto& span: entry.spans) {
+				for (int x = span.sx; x <= span.ex; x++) {
+					qd->DrawQuad(x, span.y);
+				}
+			}
+
+			return;
+		}
+
+		// least recently used (or empty) entry gets replaced
+		if (entry.lastUsed < cacheEntry->lastUsed)
+			cacheEntry = &entry;
+	}
+
+	cacheEntry->SetKey(cam, maxDist, quadSize, extraSize);
+	cacheEntry->lastUsed = ++gridVisibilityCacheTick;
+	cacheEntry->spans.clear();
+
 	// figure out the camera's own quad
 	const int cx = cam->GetPos().x / (SQUARE_SIZE * quadSize);
 	const int cy = cam->GetPos().z / (SQUARE_SIZE * quadSize);
@@ -888,6 +986,11 @@ void CSMFReadMap::GridVisibility(CCamera* cam, IQuadDrawer* qd, float maxDist, i
 				ex = ((int) xtest) + extraSize;
 		}
 
+		if (sx > ex)
+			continue;
+
+		cacheEntry->spans.push_back({y, sx, ex});
+
 		for (int x = sx; x <= ex; x++) {
 			qd->DrawQuad(x, y);
 		}
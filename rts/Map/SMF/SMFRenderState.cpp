@@ -157,6 +157,7 @@ void SMFRenderStateGLSL::Update(
 				glslShaders[n]->SetUniform("splatDetailNormalTex3", 17);
 				glslShaders[n]->SetUniform("splatDetailNormalTex4", 18);
 				glslShaders[n]->SetUniform("shadowColorTex", 19);
+				glslShaders[n]->SetUniform("shadowCascadeTex", 20);
 
 				glslShaders[n]->SetUniform4v("lightDir", &ISky::GetSky()->GetLight()->GetLightDir()[0]);
 				glslShaders[n]->SetUniform3v("cameraPos", &camera->GetPos()[0]);
@@ -168,6 +169,7 @@ void SMFRenderStateGLSL::Update(
 				glslShaders[n]->SetUniform("groundShadowDensity", sunLighting->groundShadowDensity);
 
 				glslShaders[n]->SetUniformMatrix4x4("shadowMat", false, shadowHandler.GetShadowMatrixRaw());
+				glslShaders[n]->SetUniform("numShadowCascades", 0);
 
 				glslShaders[n]->SetUniform3v("waterMinColor", &waterRendering->minColor[0]);
 				glslShaders[n]->SetUniform3v("waterBaseColor", &waterRendering->baseColor[0]);
@@ -226,6 +228,9 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 	if (isAdv && shadowHandler.ShadowsLoaded()) {
 		shadowHandler.SetupShadowTexSampler(GL_TEXTURE4, true);
 		glActiveTexture(GL_TEXTURE19); glBindTexture(GL_TEXTURE_2D, shadowHandler.GetColorTextureID());
+
+		if (shadowHandler.GetNumNearCascades() > 0)
+			shadowHandler.SetupShadowCascadeTexSampler(GL_TEXTURE20);
 	}
 
 	glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, smfMap->GetHeightMapTexture());
@@ -265,8 +270,10 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 
 	if (isAdv) {
 		currShader->SetUniform3v("cameraPos", &camera->GetPos()[0]);
-		if (shadowHandler.ShadowsLoaded())
+		if (shadowHandler.ShadowsLoaded()) {
 			currShader->SetUniformMatrix4x4("shadowMat", false, shadowHandler.GetShadowMatrixRaw());
+			shadowHandler.SetShadowCascadeUniforms(currShader);
+		}
 	}
 }
 
@@ -288,6 +295,9 @@ void SMFRenderStateGLSL::Disable(const CSMFGroundDrawer* smfGroundDrawer, const
 	if (isAdv && shadowHandler.ShadowsLoaded()) {
 		shadowHandler.ResetShadowTexSampler(GL_TEXTURE4, true);
 		glActiveTexture(GL_TEXTURE19); glBindTexture(GL_TEXTURE_2D, 0);
+
+		if (shadowHandler.GetNumNearCascades() > 0)
+			shadowHandler.ResetShadowCascadeTexSampler(GL_TEXTURE20);
 	}
 
 	glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, 0);
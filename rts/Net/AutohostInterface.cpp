@@ -1,11 +1,58 @@
 /* This file is part of the BumpStockEngine (GPL v2 or later), see LICENSE.html */
 
 #include "AutohostInterface.h"
+#include "AutohostShmRing.h"
 #include "Net/Protocol/BaseNetProtocol.h"
+#include "System/Config/ConfigHandler.h"
 #include <cstring>
 #include <chrono>
 #include <algorithm>  // For std::min
 
+namespace {
+/**
+ * @enum EVENT Which events can be sent to the autohost
+ *   (in brackets: parameters, where uchar means unsigned char and "string"
+ *   means plain ascii text)
+ */
+enum EVENT
+{
+    /// Server has started ()
+    SERVER_STARTED = 0,
+    /// Server is about to exit ()
+    SERVER_QUIT = 1,
+    /// Game starts (uint32 msgsize, uint8 gameID[16], "demoName")
+    SERVER_STARTPLAYING = 2,
+    /// Game has ended ()
+    SERVER_GAMEOVER = 3,
+    /// An information message from server (string message)
+    SERVER_MESSAGE = 4,
+    /// Server gave out a warning (string warningmessage)
+    SERVER_WARNING = 5,
+    /// Player has joined the game (uchar playernumber, string name)
+    PLAYER_JOINED = 10,
+    /// Player has left (uchar playernumber, uchar reason (0: lost connection, 1: left, 2: kicked) )
+    PLAYER_LEFT = 11,
+    /// Player has updated its ready-state (uchar playernumber, uchar state (0: not ready, 1: ready, 2: state not changed) )
+    PLAYER_READY = 12,
+    /// Player has sent a chat message (uchar playernumber, uchar destination, string text)
+    PLAYER_CHAT = 13,
+    /// Player has been defeated (uchar playernumber)
+    PLAYER_DEFEATED = 14,
+    /// Message sent by lua (uchar playernumber, std::uint16_t script, uint8_t mode, uint8_t[X] data) (X = space left in packet)
+    GAME_LUAMSG = 20,
+    /// team statistics
+    GAME_TEAMSTAT = 60,
+    /// Network latency (float p50, float p95, float p99, float jitter [ms], uint32 pendingRetries)
+    SERVER_NETLATENCY = 70,
+    /// Batch of events, binary framing only (see AutohostInterface.h)
+    AUTOHOST_BATCH = 0xF0
+};
+}
+
+CONFIG(bool, AutohostBinaryFraming).defaultValue(false).description("Send autohost events batched per server update in a versioned binary frame instead of one message per event.");
+CONFIG(std::string, AutohostShmRing).defaultValue("").description("Name of a shared-memory ring for a co-located autohost; the autohost port is appended. Requires AutohostBinaryFraming.");
+CONFIG(int, AutohostShmRingSize).defaultValue(1 << 20).minimumValue(4096).description("Data size in bytes of the autohost shared-memory ring.");
+
 #define LOG_SECTION_AUTOHOST_INTERFACE "AutohostInterface"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_AUTOHOST_INTERFACE)
 
@@ -17,21 +64,35 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_AUTOHOST_INTERFACE)
 AutohostInterface::AutohostInterface(const std::string& remoteIP, int remotePort,
                                      const std::string& localIP, int localPort)
     : ioContext(std::make_unique<asio::io_context>()) {
+    if (configHandler->GetBool("AutohostBinaryFraming")) {
+        framing = Framing::Binary;
+        batch.reserve(MAX_BATCH_SIZE);
+
+        // Port suffix: several hosted games each have their own autohost
+        const std::string shmName = configHandler->GetString("AutohostShmRing");
+        if (!shmName.empty()) {
+            shmRing = std::make_unique<AutohostShmRing>();
+            if (!shmRing->Open(shmName + "-" + std::to_string(remotePort), configHandler->GetInt("AutohostShmRingSize"))) {
+                shmRing.reset();
+            }
+        }
+    }
+
     try {
         // Primary: Try DCF integration
         dcfConnection = std::make_unique<DCFConnection>("config/dcf_network.json");
         if (dcfConnection->initialized) {
-            dcf::DCF_LOG(dcf::DCFLogLevel::INFO, "Autohost using DCF successfully");
+            DCF_LOG(dcf::DCFLogLevel::INFO, "Autohost using DCF successfully");
             initialized = true;
             running = true;
             ReceiveAsync();  // Start DCF-based receive if applicable
             return;
         } else {
-            dcf::DCF_LOG(dcf::DCFLogLevel::WARNING, "DCF init failed for autohost, falling back to UDP");
+            DCF_LOG(dcf::DCFLogLevel::WARNING, "DCF init failed for autohost, falling back to UDP");
             usingFallback = true;
         }
     } catch (const std::exception& e) {
-        dcf::DCF_LOG(dcf::DCFLogLevel::ERROR, "DCF setup for autohost failed: " + std::string(e.what()) + ", falling back to UDP");
+        DCF_LOG(dcf::DCFLogLevel::ERROR, "DCF setup for autohost failed: " + std::string(e.what()) + ", falling back to UDP");
         usingFallback = true;
     }
 
@@ -41,7 +102,7 @@ AutohostInterface::AutohostInterface(const std::string& remoteIP, int remotePort
             udpSocket = std::make_shared<asio::ip::udp::socket>(*ioContext);
             std::string error = TryBindSocket(*udpSocket, remoteIP, remotePort, localIP, localPort);
             if (!error.empty()) {
-                dcf::DCF_LOG(dcf::DCFLogLevel::ERROR, "UDP socket bind failed: " + error);
+                DCF_LOG(dcf::DCFLogLevel::ERROR, "UDP socket bind failed: " + error);
                 return;
             }
             running = true;
@@ -52,21 +113,23 @@ AutohostInterface::AutohostInterface(const std::string& remoteIP, int remotePort
                         try {
                             ioContext->run_one();
                         } catch (const std::exception& e) {
-                            dcf::DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("Fallback IO worker error: ") + e.what());
+                            DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("Fallback IO worker error: ") + e.what());
                         }
                     }
                 });
             }
             ReceiveAsync();  // Start async receive for fallback
             initialized = true;
-            dcf::DCF_LOG(dcf::DCFLogLevel::INFO, "Autohost fallback to UDP initialized on port " + std::to_string(remotePort));
+            DCF_LOG(dcf::DCFLogLevel::INFO, "Autohost fallback to UDP initialized on port " + std::to_string(remotePort));
         } catch (const std::exception& e) {
-            dcf::DCF_LOG(dcf::DCFLogLevel::FATAL, std::string("Fallback initialization failed: ") + e.what());
+            DCF_LOG(dcf::DCFLogLevel::FATAL, std::string("Fallback initialization failed: ") + e.what());
         }
     }
 }
 
 AutohostInterface::~AutohostInterface() {
+    // Whatever was queued after the last server update, e.g. SERVER_QUIT
+    Flush(batchFrame);
     running = false;
     if (ioContext) ioContext->stop();
     for (auto& th : workerThreads) {
@@ -74,7 +137,7 @@ AutohostInterface::~AutohostInterface() {
     }
     if (udpSocket && udpSocket->is_open()) udpSocket->close();
     dcfConnection.reset();
-    dcf::DCF_LOG(dcf::DCFLogLevel::INFO, "AutohostInterface destroyed");
+    DCF_LOG(dcf::DCFLogLevel::INFO, "AutohostInterface destroyed");
 }
 
 std::string AutohostInterface::TryBindSocket(asio::ip::udp::socket& socket,
@@ -97,7 +160,7 @@ std::string AutohostInterface::TryBindSocket(asio::ip::udp::socket& socket,
 
 void AutohostInterface::SendAsync(std::vector<std::uint8_t> buffer) {
     if (!initialized) {
-        dcf::DCF_LOG(dcf::DCFLogLevel::WARNING, "Interface not initialized for send");
+        DCF_LOG(dcf::DCFLogLevel::WARNING, "Interface not initialized for send");
         return;
     }
     if (dcfConnection && !usingFallback) {
@@ -108,7 +171,7 @@ void AutohostInterface::SendAsync(std::vector<std::uint8_t> buffer) {
         // Fallback UDP async send
         TrySendWithRetry(buffer);
     } else {
-        dcf::DCF_LOG(dcf::DCFLogLevel::WARNING, "No valid socket for send");
+        DCF_LOG(dcf::DCFLogLevel::WARNING, "No valid socket for send");
     }
 }
 
@@ -119,16 +182,16 @@ void AutohostInterface::TrySendWithRetry(const std::vector<std::uint8_t>& buffer
             udpSocket->async_send_to(asio::buffer(buffer), remoteEndpoint,
                 [this, buffer](const asio::error_code& error, size_t) {
                     if (error) {
-                        dcf::DCF_LOG(dcf::DCFLogLevel::WARNING, "Fallback async send failed: " + error.message());
+                        DCF_LOG(dcf::DCFLogLevel::WARNING, "Fallback async send failed: " + error.message());
                     }
                 });
             return;
         } catch (const asio::system_error& e) {
-            dcf::DCF_LOG(dcf::DCFLogLevel::WARNING, "Fallback send attempt " + std::to_string(attempt + 1) + " failed: " + e.what());
+            DCF_LOG(dcf::DCFLogLevel::WARNING, "Fallback send attempt " + std::to_string(attempt + 1) + " failed: " + e.what());
             std::this_thread::sleep_for(std::chrono::milliseconds(std::min(100 * (attempt + 1), 500)));
         }
     }
-    dcf::DCF_LOG(dcf::DCFLogLevel::ERROR, "All fallback send retries failed; closing socket");
+    DCF_LOG(dcf::DCFLogLevel::ERROR, "All fallback send retries failed; closing socket");
     udpSocket->close();
 }
 
@@ -151,107 +214,160 @@ void AutohostInterface::HandleReceive(const asio::error_code& error, size_t byte
         while (!receiveQueue.push(data)) {
             std::this_thread::sleep_for(std::chrono::milliseconds(10));
         }
-        dcf::DCF_LOG(dcf::DCFLogLevel::DEBUG, "Received " + std::to_string(bytes_transferred) + " bytes via fallback");
+        DCF_LOG(dcf::DCFLogLevel::DEBUG, "Received " + std::to_string(bytes_transferred) + " bytes via fallback");
     } else if (error) {
-        dcf::DCF_LOG(dcf::DCFLogLevel::ERROR, "Fallback receive error: " + error.message());
+        DCF_LOG(dcf::DCFLogLevel::ERROR, "Fallback receive error: " + error.message());
     }
     if (running && usingFallback && udpSocket->is_open()) ReceiveAsync();
 }
 
-void AutohostInterface::SendStart() {
+template<typename Writer>
+void AutohostInterface::Emit(size_t size, Writer&& write) {
     if (!initialized) return;
-    std::vector<std::uint8_t> buffer(1, SERVER_STARTED);
-    SendAsync(buffer);
+    if (framing == Framing::Legacy) {
+        std::vector<std::uint8_t> buffer(size);
+        write(buffer.data());
+        SendAsync(std::move(buffer));
+        return;
+    }
+    if (size > 0xFFFF) {
+        DCF_LOG(dcf::DCFLogLevel::WARNING, "Autohost event of " + std::to_string(size) + " bytes too large for a batch");
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(batchMutex);
+    const std::uint16_t length = static_cast<std::uint16_t>(size);
+    if (batchEvents == 0xFFFF || (!batch.empty() && batch.size() + sizeof(length) + size > MAX_BATCH_SIZE)) {
+        SendBatch();
+    }
+    if (batch.empty()) {
+        batch.resize(BATCH_HEADER_SIZE);
+    }
+
+    // Events are written straight into the batch, zero-initialized like the legacy buffers
+    const size_t offset = batch.size();
+    batch.resize(offset + sizeof(length) + size);
+    std::memcpy(&batch[offset], &length, sizeof(length));
+    write(&batch[offset + sizeof(length)]);
+    batchEvents++;
+}
+
+void AutohostInterface::SendBatch() {
+    if (batchEvents == 0) return;
+
+    const std::uint32_t batchSize = static_cast<std::uint32_t>(batch.size());
+    batch[0] = AUTOHOST_BATCH;
+    batch[1] = BATCH_VERSION;
+    std::memcpy(&batch[2], &batchEvents, sizeof(batchEvents));
+    std::memcpy(&batch[4], &batchFrame, sizeof(batchFrame));
+    std::memcpy(&batch[8], &batchSize, sizeof(batchSize));
+
+    if (shmRing) {
+        shmRing->Push(batch.data(), batch.size());
+        batch.clear();
+    } else {
+        std::vector<std::uint8_t> buffer;
+        buffer.reserve(MAX_BATCH_SIZE);
+        buffer.swap(batch);
+        SendAsync(std::move(buffer));
+    }
+    batchEvents = 0;
+    numBatches++;
+}
+
+void AutohostInterface::Flush(int frameNum) {
+    if (framing != Framing::Binary) return;
+    std::lock_guard<std::mutex> lock(batchMutex);
+    batchFrame = frameNum;
+    SendBatch();
+}
+
+void AutohostInterface::SendStart() {
+    Emit(1, [](std::uint8_t* buf) { buf[0] = SERVER_STARTED; });
 }
 
 void AutohostInterface::SendQuit() {
-    if (!initialized) return;
-    std::vector<std::uint8_t> buffer(1, SERVER_QUIT);
-    SendAsync(buffer);
+    Emit(1, [](std::uint8_t* buf) { buf[0] = SERVER_QUIT; });
 }
 
 void AutohostInterface::SendStartPlaying(const uchar* gameID, const std::string& demoName) {
-    if (!initialized) return;
-    const auto msgsize = sizeof(std::uint32_t) + 16 * sizeof(uchar) + demoName.size() + 1;  // +1 for safety
-    std::vector<std::uint8_t> buffer(msgsize);
-    buffer[0] = SERVER_STARTPLAYING;
-    std::memcpy(&buffer[1], &msgsize, sizeof(std::uint32_t));
-    std::memcpy(&buffer[5], gameID, 16 * sizeof(uchar));
-    std::copy(demoName.begin(), demoName.end(), buffer.begin() + 21);
-    SendAsync(buffer);
+    const std::uint32_t msgsize = sizeof(std::uint32_t) + 16 * sizeof(uchar) + demoName.size() + 1;  // +1 for safety
+    Emit(msgsize, [&](std::uint8_t* buf) {
+        buf[0] = SERVER_STARTPLAYING;
+        std::memcpy(&buf[1], &msgsize, sizeof(std::uint32_t));
+        std::memcpy(&buf[5], gameID, 16 * sizeof(uchar));
+        std::copy(demoName.begin(), demoName.end(), buf + 21);
+    });
 }
 
 void AutohostInterface::SendGameOver(uchar playerNum, const std::vector<uchar>& winningAllyTeams) {
-    if (!initialized) return;
-    const auto msgsize = 3 * sizeof(uchar) + winningAllyTeams.size();
-    std::vector<std::uint8_t> buffer(msgsize);
-    buffer[0] = SERVER_GAMEOVER;
-    buffer[1] = playerNum;
-    buffer[2] = static_cast<uchar>(winningAllyTeams.size() + 3);
-    std::copy(winningAllyTeams.begin(), winningAllyTeams.end(), buffer.begin() + 3);
-    SendAsync(buffer);
+    Emit(3 * sizeof(uchar) + winningAllyTeams.size(), [&](std::uint8_t* buf) {
+        buf[0] = SERVER_GAMEOVER;
+        buf[1] = playerNum;
+        buf[2] = static_cast<uchar>(winningAllyTeams.size() + 3);
+        std::copy(winningAllyTeams.begin(), winningAllyTeams.end(), buf + 3);
+    });
 }
 
 void AutohostInterface::SendPlayerJoined(uchar playerNum, const std::string& name) {
-    if (!initialized) return;
-    const auto msgsize = 2 * sizeof(uchar) + name.size() + 1;
-    std::vector<std::uint8_t> buffer(msgsize);
-    buffer[0] = PLAYER_JOINED;
-    buffer[1] = playerNum;
-    std::copy(name.begin(), name.end(), buffer.begin() + 2);
-    SendAsync(buffer);
+    Emit(2 * sizeof(uchar) + name.size() + 1, [&](std::uint8_t* buf) {
+        buf[0] = PLAYER_JOINED;
+        buf[1] = playerNum;
+        std::copy(name.begin(), name.end(), buf + 2);
+    });
 }
 
 void AutohostInterface::SendPlayerLeft(uchar playerNum, uchar reason) {
-    if (!initialized) return;
-    std::vector<std::uint8_t> buffer(3);
-    buffer[0] = PLAYER_LEFT;
-    buffer[1] = playerNum;
-    buffer[2] = reason;
-    SendAsync(buffer);
+    Emit(3, [&](std::uint8_t* buf) {
+        buf[0] = PLAYER_LEFT;
+        buf[1] = playerNum;
+        buf[2] = reason;
+    });
 }
 
 void AutohostInterface::SendPlayerReady(uchar playerNum, uchar readyState) {
-    if (!initialized) return;
-    std::vector<std::uint8_t> buffer(3);
-    buffer[0] = PLAYER_READY;
-    buffer[1] = playerNum;
-    buffer[2] = readyState;
-    SendAsync(buffer);
+    Emit(3, [&](std::uint8_t* buf) {
+        buf[0] = PLAYER_READY;
+        buf[1] = playerNum;
+        buf[2] = readyState;
+    });
 }
 
 void AutohostInterface::SendPlayerChat(uchar playerNum, uchar destination, const std::string& msg) {
-    if (!initialized) return;
-    const auto msgsize = 3 * sizeof(uchar) + msg.size() + 1;
-    std::vector<std::uint8_t> buffer(msgsize);
-    buffer[0] = PLAYER_CHAT;
-    buffer[1] = playerNum;
-    buffer[2] = destination;
-    std::copy(msg.begin(), msg.end(), buffer.begin() + 3);
-    SendAsync(buffer);
+    Emit(3 * sizeof(uchar) + msg.size() + 1, [&](std::uint8_t* buf) {
+        buf[0] = PLAYER_CHAT;
+        buf[1] = playerNum;
+        buf[2] = destination;
+        std::copy(msg.begin(), msg.end(), buf + 3);
+    });
 }
 
 void AutohostInterface::SendPlayerDefeated(uchar playerNum) {
-    if (!initialized) return;
-    std::vector<std::uint8_t> buffer(2);
-    buffer[0] = PLAYER_DEFEATED;
-    buffer[1] = playerNum;
-    SendAsync(buffer);
+    Emit(2, [&](std::uint8_t* buf) {
+        buf[0] = PLAYER_DEFEATED;
+        buf[1] = playerNum;
+    });
 }
 
 void AutohostInterface::SendLuaMsg(const std::uint8_t* msg, size_t msgSize) {
-    if (!initialized) return;
-    std::vector<std::uint8_t> buffer(msgSize + 1);
-    buffer[0] = GAME_LUAMSG;
-    std::copy(msg, msg + msgSize, buffer.begin() + 1);
-    SendAsync(buffer);
+    Emit(msgSize + 1, [&](std::uint8_t* buf) {
+        buf[0] = GAME_LUAMSG;
+        std::copy(msg, msg + msgSize, buf + 1);
+    });
+}
+
+void AutohostInterface::SendNetLatency(const spring::LatencyHistogram::Snapshot& rtt, size_t pendingRetries) {
+    const float values[] = {rtt.p50, rtt.p95, rtt.p99, rtt.jitter};
+    const std::uint32_t retries = static_cast<std::uint32_t>(pendingRetries);
+    Emit(1 + sizeof(values) + sizeof(retries), [&](std::uint8_t* buf) {
+        buf[0] = SERVER_NETLATENCY;
+        std::memcpy(&buf[1], values, sizeof(values));
+        std::memcpy(&buf[1 + sizeof(values)], &retries, sizeof(retries));
+    });
 }
 
 void AutohostInterface::Send(const std::uint8_t* msg, size_t msgSize) {
-    if (!initialized) return;
-    std::vector<std::uint8_t> buffer(msgSize);
-    std::copy(msg, msg + msgSize, buffer.begin());
-    SendAsync(buffer);
+    Emit(msgSize, [&](std::uint8_t* buf) { std::copy(msg, msg + msgSize, buf); });
 }
 
 std::vector<std::uint8_t> AutohostInterface::GetChatMessage() {
@@ -11,15 +11,29 @@
 #include "System/Net/DCFUtils.h"
 #include "System/Net/DCFConnection.h"  // For DCF integration
 
+class AutohostShmRing;
+
 /**
  * API for engine <-> autohost communication, integrated with DCF in BumpStockEngine.
  * Uses DCF for primary communication; falls back to async UDP on DCF errors.
+ *
+ * With AutohostBinaryFraming, events are not sent one by one but collected into a
+ * versioned batch per server update:
+ *   u8 AUTOHOST_BATCH (0xF0), u8 version, u16 numEvents, i32 frameNum, u32 batchSize,
+ *   then per event u16 length followed by the event exactly as in legacy framing.
+ * With AutohostShmRing set as well, batches go to a shared-memory ring instead of
+ * the network (see AutohostShmRing); autohost to engine messages are unaffected.
  */
 class AutohostInterface
 {
 public:
     typedef unsigned char uchar;
 
+    enum class Framing { Legacy, Binary };
+
+    static constexpr std::uint8_t BATCH_VERSION = 1;
+    static constexpr size_t BATCH_HEADER_SIZE = 1 + 1 + 2 + 4 + 4;
+
     AutohostInterface(const std::string& remoteIP, int remotePort,
                       const std::string& localIP = "", int localPort = 0);
     virtual ~AutohostInterface();
@@ -36,12 +50,25 @@ public:
     void SendPlayerChat(uchar playerNum, uchar destination, const std::string& msg);
     void SendPlayerDefeated(uchar playerNum);
     void SendLuaMsg(const std::uint8_t* msg, size_t msgSize);
+    void SendNetLatency(const spring::LatencyHistogram::Snapshot& rtt, size_t pendingRetries);
     void Send(const std::uint8_t* msg, size_t msgSize);
 
     std::vector<std::uint8_t> GetChatMessage();
 
+    /**
+     * Binary framing: sends the events queued since the last call as one batch
+     * tagged with frameNum. Called once per server update; no-op in legacy framing.
+     */
+    void Flush(int frameNum);
+
+    Framing GetFraming() const { return framing; }
+    std::uint64_t GetNumBatches() const { return numBatches; }
+
 private:
     void SendAsync(std::vector<std::uint8_t> buffer);
+    // Hands one event of <size> bytes to <write>, which fills it in place
+    template<typename Writer> void Emit(size_t size, Writer&& write);
+    void SendBatch();  // batchMutex held
     void ReceiveAsync();
     void HandleReceive(const asio::error_code& error, size_t bytes_transferred);
     void TrySendWithRetry(const std::vector<std::uint8_t>& buffer, int maxRetries = 3);
@@ -62,6 +89,17 @@ private:
     std::atomic<bool> usingFallback{false};  // Flag for UDP fallback
     std::mutex sendMutex;
     std::vector<std::uint8_t> receiveBuffer{65536};
+
+    // Split early beyond this, well below the datagram limit
+    static constexpr size_t MAX_BATCH_SIZE = 32768;
+
+    Framing framing = Framing::Legacy;
+    std::unique_ptr<AutohostShmRing> shmRing;
+    std::mutex batchMutex;
+    std::vector<std::uint8_t> batch;
+    std::uint16_t batchEvents = 0;
+    std::int32_t batchFrame = -1;
+    std::atomic<std::uint64_t> numBatches{0};
 };
 
 #endif // AUTOHOST_INTERFACE_H
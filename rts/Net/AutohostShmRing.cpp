@@ -0,0 +1,99 @@
+/* This file is part of the BumpStockEngine (GPL v2 or later), see LICENSE.html */
+
+#include "AutohostShmRing.h"
+#include "DCFUtils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+AutohostShmRing::~AutohostShmRing() {
+    Close();
+}
+
+bool AutohostShmRing::Open(const std::string& name, size_t capacity) {
+    Close();
+#ifdef _WIN32
+    DCF_LOG(dcf::DCFLogLevel::WARNING, "Autohost shared-memory ring not supported on this platform");
+    return false;
+#else
+    if (name.empty() || capacity == 0) return false;
+    const std::string objName = (name[0] == '/') ? name : ("/" + name);
+    const int fd = shm_open(objName.c_str(), O_CREAT | O_RDWR, 0600);
+    if (fd < 0) {
+        DCF_LOG(dcf::DCFLogLevel::ERROR, "shm_open(" + objName + ") failed: " + std::strerror(errno));
+        return false;
+    }
+
+    const size_t size = sizeof(Header) + capacity;
+    void* mem = MAP_FAILED;
+    if (ftruncate(fd, size) == 0) {
+        mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+
+    if (mem == MAP_FAILED) {
+        DCF_LOG(dcf::DCFLogLevel::ERROR, "Mapping autohost ring " + objName + " failed: " + std::strerror(errno));
+        shm_unlink(objName.c_str());
+        return false;
+    }
+
+    // Fresh ring; a reader left over from a previous server run resynchronizes on the magic
+    header = new (mem) Header{};
+    header->magic = MAGIC;
+    header->version = VERSION;
+    header->capacity = capacity;
+    header->writePos.store(0, std::memory_order_relaxed);
+    header->readPos.store(0, std::memory_order_release);
+
+    ringData = static_cast<std::uint8_t*>(mem) + sizeof(Header);
+    mappedSize = size;
+    shmName = objName;
+    DCF_LOG(dcf::DCFLogLevel::INFO, "Autohost ring " + objName + " open (" + std::to_string(capacity) + " bytes)");
+    return true;
+#endif
+}
+
+void AutohostShmRing::Close() {
+#ifndef _WIN32
+    if (header == nullptr) return;
+    munmap(header, mappedSize);
+    shm_unlink(shmName.c_str());
+#endif
+    header = nullptr;
+    ringData = nullptr;
+    mappedSize = 0;
+}
+
+void AutohostShmRing::CopyIn(std::uint64_t pos, const std::uint8_t* src, size_t length) {
+    const size_t capacity = header->capacity;
+    const size_t offset = pos % capacity;
+    const size_t first = std::min(length, capacity - offset);
+    std::memcpy(ringData + offset, src, first);
+    std::memcpy(ringData, src + first, length - first);
+}
+
+bool AutohostShmRing::Push(const std::uint8_t* data, size_t length) {
+    if (header == nullptr) return false;
+
+    const std::uint32_t recordLength = static_cast<std::uint32_t>(length);
+    const std::uint64_t writePos = header->writePos.load(std::memory_order_relaxed);
+    const std::uint64_t readPos = header->readPos.load(std::memory_order_acquire);
+    if ((writePos - readPos) + sizeof(recordLength) + length > header->capacity) {
+        numDropped++;
+        return false;
+    }
+
+    CopyIn(writePos, reinterpret_cast<const std::uint8_t*>(&recordLength), sizeof(recordLength));
+    CopyIn(writePos + sizeof(recordLength), data, length);
+    // Publish only after the record is complete
+    header->writePos.store(writePos + sizeof(recordLength) + length, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,63 @@
+/* This file is part of the BumpStockEngine (GPL v2 or later), see LICENSE.html */
+
+#ifndef AUTOHOST_SHM_RING_H
+#define AUTOHOST_SHM_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Single-producer byte ring in POSIX shared memory, for autohosts running on the
+ * same machine as the server. The server writes whole event batches as records
+ * ([u32 length][batch bytes], wrapping at the end of the data area); the autohost
+ * maps the same object and consumes them by advancing readPos.
+ *
+ * Layout at the start of the mapping, all fields little endian:
+ *   u32 magic ('AHSR'), u32 version, u64 capacity,
+ *   atomic u64 writePos, atomic u64 readPos, then <capacity> data bytes.
+ * Positions only ever grow; the byte at position p lives at data[p % capacity].
+ * The writer never blocks: a batch that does not fit is dropped and counted.
+ */
+class AutohostShmRing
+{
+public:
+    static constexpr std::uint32_t MAGIC = 0x52534841;  // "AHSR"
+    static constexpr std::uint32_t VERSION = 1;
+
+    struct Header {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint64_t capacity;
+        std::atomic<std::uint64_t> writePos;
+        std::atomic<std::uint64_t> readPos;
+    };
+
+    AutohostShmRing() = default;
+    AutohostShmRing(const AutohostShmRing&) = delete;
+    ~AutohostShmRing();
+
+    /// Creates (or recreates) the named object; false if shared memory is unavailable
+    bool Open(const std::string& name, size_t capacity);
+    void Close();
+
+    bool IsOpen() const { return (header != nullptr); }
+
+    /// Appends one record; false (and counted as dropped) if the reader is too far behind
+    bool Push(const std::uint8_t* data, size_t length);
+
+    std::uint64_t GetNumDropped() const { return numDropped; }
+
+private:
+    void CopyIn(std::uint64_t pos, const std::uint8_t* src, size_t length);
+
+    std::string shmName;
+    Header* header = nullptr;
+    std::uint8_t* ringData = nullptr;
+    size_t mappedSize = 0;
+
+    std::uint64_t numDropped = 0;
+};
+
+#endif // AUTOHOST_SHM_RING_H
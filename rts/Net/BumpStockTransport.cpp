@@ -1,30 +1,83 @@
 #include <dcf_sdk/dcf_plugin_manager.h>
 #include <asio.hpp>
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <thread>
+#include <deque>
+#include <mutex>
 #include <condition_variable>
-#include <boost/lockfree/spsc_queue.hpp>
 #include "DCFUtils.h"
+#include "BumpStockTransport.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/socket.h>
+#endif
+
+static constexpr int RECEIVE_WAIT_MS = 100;
 
 /**
  * @class MessageQueue
- * @brief Lock-free queue for messages.
+ * @brief Bounded blocking queue for received datagrams.
+ *
+ * Filled by the ASIO completion handlers (any IO worker) and drained by
+ * whichever DCF worker calls receive(), so both ends may be contended.
+ * Pop() parks the caller until a datagram arrives or the timeout expires,
+ * which lets the DCF workers wake on socket readiness instead of polling.
  */
 class MessageQueue {
 public:
-    void Push(std::vector<uint8_t> data) {
-        while (!queue.push(data)) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    bool Push(std::vector<uint8_t> data) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= MAX_QUEUED)
+                return false;
+            queue.emplace_back(std::move(data));
         }
+        cond.notify_one();
+        return true;
     }
-    
+
     bool Pop(std::vector<uint8_t>& data, std::chrono::milliseconds timeout) {
-        return queue.pop(data);
+        std::unique_lock<std::mutex> lock(mutex);
+        // A zero timeout polls: take what is there without touching the condition variable
+        if (timeout.count() > 0 && !cond.wait_for(lock, timeout, [this]() { return (!queue.empty() || woken); }))
+            return false;
+        if (queue.empty())
+            return false;
+        data = std::move(queue.front());
+        queue.pop_front();
+        return true;
     }
-    
+
+    bool Empty() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return queue.empty();
+    }
+
+    /// Releases every waiter, used on shutdown.
+    void WakeAll() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            woken = true;
+        }
+        cond.notify_all();
+    }
+
 private:
-    boost::lockfree::spsc_queue<std::vector<uint8_t>> queue{1024};
+    static constexpr size_t MAX_QUEUED = 1024;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<std::vector<uint8_t>> queue;
+    bool woken = false;
 };
 
 struct BumpStockTransport {
@@ -33,10 +86,78 @@ struct BumpStockTransport {
     std::vector<std::thread> workerThreads;
     std::atomic<bool> running{false};
     MessageQueue receiveQueue;
-    
+
+    std::array<uint8_t, 65536> recvBuffer;
+    asio::ip::udp::endpoint recvSender;
+    std::atomic<uint64_t> droppedDatagrams{0};
+
+    std::mutex endpointMutex;
+    std::unordered_map<std::string, asio::ip::udp::endpoint> endpointCache;
+
+    // Batched I/O (recvmmsg/sendmmsg); the slab is lent to the caller between receive_batch and release_batch
+    // How long receive() waits for a datagram; 0 while the DCF workers poll and sleep themselves
+    std::atomic<int> receiveWaitMs{RECEIVE_WAIT_MS};
+
+    bool batchedIO{false};
+    int ioBatchSize{0};
+    std::atomic<bool> batchOnLoan{false};
+    std::vector<uint8_t> recvSlab;
+    std::vector<BumpStockPacketView> recvViews;
+#ifdef __linux__
+    std::vector<mmsghdr> recvHeaders;
+    std::vector<iovec> recvIovecs;
+#endif
+
+    /// Resolves a send target once; DCF addresses peers by name on every send.
+    asio::ip::udp::endpoint ResolveTarget(const char* target) {
+        std::lock_guard<std::mutex> lock(endpointMutex);
+        auto it = endpointCache.find(target);
+        if (it != endpointCache.end())
+            return it->second;
+        asio::ip::udp::resolver resolver(*context);
+        const auto endpoint = *resolver.resolve(target, "8452").begin();
+        endpointCache.emplace(target, endpoint);
+        return endpoint;
+    }
+
+    void AllocateReceiveSlab() {
+        recvSlab.resize(ioBatchSize * BUMPSTOCK_IO_SLOT_SIZE);
+        recvViews.resize(ioBatchSize);
+#ifdef __linux__
+        recvHeaders.resize(ioBatchSize);
+        recvIovecs.resize(ioBatchSize);
+        for (int i = 0; i < ioBatchSize; ++i) {
+            recvIovecs[i] = {recvSlab.data() + i * BUMPSTOCK_IO_SLOT_SIZE, BUMPSTOCK_IO_SLOT_SIZE};
+            recvHeaders[i] = {};
+            recvHeaders[i].msg_hdr.msg_iov = &recvIovecs[i];
+            recvHeaders[i].msg_hdr.msg_iovlen = 1;
+        }
+#endif
+    }
+
+    /// Keeps exactly one async receive outstanding; re-armed from its own completion handler.
+    void StartReceive() {
+        socket->async_receive_from(
+            asio::buffer(recvBuffer),
+            recvSender,
+            [this](const asio::error_code& error, std::size_t bytes) {
+                if (!running)
+                    return;
+                if (!error && bytes > 0) {
+                    if (!receiveQueue.Push(std::vector<uint8_t>(recvBuffer.data(), recvBuffer.data() + bytes)))
+                        droppedDatagrams++;
+                } else if (error && error != asio::error::operation_aborted) {
+                    DCF_LOG(dcf::DCFLogLevel::WARNING, std::string("Receive error: ") + error.message());
+                }
+                StartReceive();
+            }
+        );
+    }
+
     ~BumpStockTransport() {
         if (running) {
             running = false;
+            receiveQueue.WakeAll();
             context->stop();
             for (auto& th : workerThreads) {
                 if (th.joinable()) th.join();
@@ -51,6 +172,14 @@ void* create_plugin() {
     try {
         auto transport = std::make_unique<BumpStockTransport>();
         transport->context = std::make_unique<asio::io_context>();
+        // Hosts that cannot call enable_batched_io directly can opt in through the environment
+        if (const char* batch = std::getenv("DCF_BATCHED_IO"); batch != nullptr && std::atoi(batch) > 0) {
+            enable_batched_io(transport.get(), std::atoi(batch));
+        }
+        // Exported by DCFConnection from its "worker_wakeup" setting; only event-mode workers want to block here
+        if (const char* wakeup = std::getenv("DCF_WORKER_WAKEUP"); wakeup != nullptr && std::strcmp(wakeup, "poll") == 0) {
+            transport->receiveWaitMs = 0;
+        }
         return transport.release();
     } catch (const std::exception& e) {
         DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("Failed to create transport: ") + e.what());
@@ -68,12 +197,20 @@ bool setup(void* self, const char* host, int port) {
             asio::ip::udp::endpoint(asio::ip::udp::v4(), port)
         );
         transport->running = true;
+        if (transport->batchedIO) {
+            // Readers pull whole slabs through receive_batch; no async receive competes for the socket
+            transport->socket->non_blocking(true);
+            transport->AllocateReceiveSlab();
+        } else {
+            transport->StartReceive();
+        }
         // Multi-threaded workers
         for (int i = 0; i < 4; ++i) {  // 4 threads for IO
             transport->workerThreads.emplace_back([transport]() {
+                // run() blocks in the reactor until sockets become ready; no polling
                 while (transport->running) {
                     try {
-                        transport->context->run_one();
+                        transport->context->run();
                     } catch (const std::exception& e) {
                         DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("IO worker error: ") + e.what());
                     }
@@ -93,8 +230,7 @@ bool send(void* self, const uint8_t* data, size_t size, const char* target) {
     if (!transport || !transport->running || size == 0 || size > 65535) return false;
     
     try {
-        asio::ip::udp::resolver resolver(*transport->context);
-        auto endpoint = *resolver.resolve(target, "8452").begin();
+        const auto endpoint = transport->ResolveTarget(target);
         transport->socket->async_send_to(
             asio::buffer(data, size),
             endpoint,
@@ -119,8 +255,24 @@ std::vector<uint8_t> receive(void* self, size_t* size) {
         return {};
     }
     
+    // Batched mode: refill the queue a whole slab at a time so legacy callers share the recvmmsg win;
+    // receive_batch already waited for readiness, so the queue is only polled afterwards
+    int queueWaitMs = transport->receiveWaitMs;
+    if (transport->batchedIO && transport->receiveQueue.Empty()) {
+        BumpStockPacketBatch batch;
+        if (receive_batch(self, &batch, queueWaitMs) > 0) {
+            for (size_t i = 0; i < batch.count; ++i) {
+                if (!transport->receiveQueue.Push(std::vector<uint8_t>(batch.packets[i].data, batch.packets[i].data + batch.packets[i].size)))
+                    transport->droppedDatagrams++;
+            }
+            release_batch(self, &batch);
+        }
+        queueWaitMs = 0;
+    }
+
     std::vector<uint8_t> data;
-    if (transport->receiveQueue.Pop(data, std::chrono::milliseconds(100))) {
+    // Blocks for socket readiness; DCF workers in event mode rely on this instead of sleeping
+    if (transport->receiveQueue.Pop(data, std::chrono::milliseconds(queueWaitMs))) {
         *size = data.size();
         return data;  // Return vector; no manual allocation
     }
@@ -129,9 +281,126 @@ std::vector<uint8_t> receive(void* self, size_t* size) {
     return {};
 }
 
+bool enable_batched_io(void* self, int batchSize) {
+    auto* transport = static_cast<BumpStockTransport*>(self);
+    if (!transport || transport->running) return false;
+#ifdef __linux__
+    transport->batchedIO = true;
+    transport->ioBatchSize = std::clamp(batchSize, 1, BUMPSTOCK_MAX_IO_BATCH);
+    DCF_LOG(dcf::DCFLogLevel::INFO, "Batched recvmmsg/sendmmsg I/O enabled, batch size " + std::to_string(transport->ioBatchSize));
+    return true;
+#else
+    DCF_LOG(dcf::DCFLogLevel::WARNING, "Batched I/O is only available on Linux");
+    return false;
+#endif
+}
+
+size_t receive_batch(void* self, BumpStockPacketBatch* batch, int timeoutMs) {
+    auto* transport = static_cast<BumpStockTransport*>(self);
+    batch->packets = nullptr;
+    batch->count = 0;
+    if (!transport || !transport->running || !transport->batchedIO) return 0;
+
+    bool expected = false;
+    if (!transport->batchOnLoan.compare_exchange_strong(expected, true)) {
+        DCF_LOG(dcf::DCFLogLevel::WARNING, "receive_batch called while a batch is still on loan");
+        return 0;
+    }
+
+#ifdef __linux__
+    const int fd = transport->socket->native_handle();
+    pollfd pfd = {fd, POLLIN, 0};
+    if (poll(&pfd, 1, timeoutMs) <= 0) {
+        transport->batchOnLoan = false;
+        return 0;
+    }
+
+    for (auto& hdr: transport->recvHeaders) {
+        hdr.msg_len = 0;
+        hdr.msg_hdr.msg_flags = 0;
+    }
+    const int received = recvmmsg(fd, transport->recvHeaders.data(), transport->ioBatchSize, MSG_DONTWAIT, nullptr);
+    if (received <= 0) {
+        transport->batchOnLoan = false;
+        return 0;
+    }
+
+    size_t count = 0;
+    for (int i = 0; i < received; ++i) {
+        const mmsghdr& hdr = transport->recvHeaders[i];
+        if ((hdr.msg_hdr.msg_flags & MSG_TRUNC) != 0 || hdr.msg_len == 0) {
+            transport->droppedDatagrams++;
+            continue;
+        }
+        transport->recvViews[count++] = {static_cast<const uint8_t*>(hdr.msg_hdr.msg_iov->iov_base), hdr.msg_len};
+    }
+
+    batch->packets = transport->recvViews.data();
+    batch->count = count;
+    if (count == 0)
+        transport->batchOnLoan = false;
+    return count;
+#else
+    transport->batchOnLoan = false;
+    return 0;
+#endif
+}
+
+void release_batch(void* self, BumpStockPacketBatch* batch) {
+    auto* transport = static_cast<BumpStockTransport*>(self);
+    if (!transport || !batch || batch->count == 0) return;
+    batch->packets = nullptr;
+    batch->count = 0;
+    transport->batchOnLoan = false;
+}
+
+size_t send_batch(void* self, const BumpStockPacketView* packets, size_t count, const char* target) {
+    auto* transport = static_cast<BumpStockTransport*>(self);
+    if (!transport || !transport->running || count == 0) return 0;
+
+    try {
+        const auto endpoint = transport->ResolveTarget(target);
+        size_t sent = 0;
+#ifdef __linux__
+        std::array<mmsghdr, BUMPSTOCK_MAX_IO_BATCH> headers;
+        std::array<iovec, BUMPSTOCK_MAX_IO_BATCH> iovecs;
+        const int fd = transport->socket->native_handle();
+
+        while (sent < count) {
+            const size_t chunk = std::min(count - sent, headers.size());
+            for (size_t i = 0; i < chunk; ++i) {
+                iovecs[i] = {const_cast<uint8_t*>(packets[sent + i].data), packets[sent + i].size};
+                headers[i] = {};
+                headers[i].msg_hdr.msg_name = const_cast<sockaddr*>(endpoint.data());
+                headers[i].msg_hdr.msg_namelen = endpoint.size();
+                headers[i].msg_hdr.msg_iov = &iovecs[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+            }
+            const int result = sendmmsg(fd, headers.data(), chunk, 0);
+            if (result < 0) {
+                if (errno == EINTR)
+                    continue;
+                DCF_LOG(dcf::DCFLogLevel::WARNING, std::string("sendmmsg failed: ") + strerror(errno));
+                break;
+            }
+            sent += result;
+        }
+#else
+        for (; sent < count; ++sent) {
+            transport->socket->send_to(asio::buffer(packets[sent].data, packets[sent].size), endpoint);
+        }
+#endif
+        return sent;
+    } catch (const std::exception& e) {
+        DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("Batch send failed: ") + e.what());
+        return 0;
+    }
+}
+
 void destroy(void* self) {
     if (auto* transport = static_cast<BumpStockTransport*>(self)) {
         transport->running = false;
+        transport->receiveQueue.WakeAll();
         transport->context->stop();
         for (auto& th : transport->workerThreads) {
             if (th.joinable()) th.join();
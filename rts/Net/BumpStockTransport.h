@@ -0,0 +1,66 @@
+#ifndef _BUMPSTOCK_TRANSPORT_H
+#define _BUMPSTOCK_TRANSPORT_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file BumpStockTransport.h
+ * @brief C ABI extensions exported by the BumpStockTransport plugin on top of DCF's ITransport.
+ *
+ * The batch entry points are optional; hosts look them up with dlsym and fall back to the
+ * per-message setup/send/receive functions of ITransport when they are missing.
+ */
+
+extern "C" {
+
+/**
+ * @brief View of one datagram. For received batches the memory belongs to the plugin's
+ * receive slab and stays valid until the batch is handed back via release_batch.
+ */
+struct BumpStockPacketView {
+    const uint8_t* data;
+    uint32_t size;
+};
+
+/**
+ * @brief A received batch on loan from the plugin.
+ */
+struct BumpStockPacketBatch {
+    const BumpStockPacketView* packets;
+    size_t count;
+};
+
+/**
+ * @brief Switches the plugin to recvmmsg/sendmmsg batched I/O (Linux only).
+ * Must be called before setup(); batchSize is clamped to [1, BUMPSTOCK_MAX_IO_BATCH].
+ * @return false if batching is unsupported on this platform.
+ */
+bool enable_batched_io(void* self, int batchSize);
+
+/**
+ * @brief Receives up to one slab of datagrams with a single syscall, waiting at most timeoutMs.
+ * The batch must be returned with release_batch before this is called again on any thread.
+ * @return number of datagrams in the batch (0 on timeout or error).
+ */
+size_t receive_batch(void* self, BumpStockPacketBatch* batch, int timeoutMs);
+
+/**
+ * @brief Returns a batch obtained from receive_batch, making its slab reusable.
+ */
+void release_batch(void* self, BumpStockPacketBatch* batch);
+
+/**
+ * @brief Sends count datagrams to target with as few syscalls as possible.
+ * @return number of datagrams accepted by the kernel.
+ */
+size_t send_batch(void* self, const BumpStockPacketView* packets, size_t count, const char* target);
+
+}
+
+/// Upper bound for enable_batched_io, also the size of the preallocated receive slab in datagrams.
+static constexpr int BUMPSTOCK_MAX_IO_BATCH = 64;
+/// Bytes reserved per slab slot; larger datagrams are reported truncated and dropped.
+static constexpr size_t BUMPSTOCK_IO_SLOT_SIZE = 2048;
+
+#endif // _BUMPSTOCK_TRANSPORT_H
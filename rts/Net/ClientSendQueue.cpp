@@ -0,0 +1,173 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ClientSendQueue.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Net/Protocol/NetMessageTypes.h"
+#include "System/Net/Connection.h"
+#include "System/Net/RawPacket.h"
+
+ClientSendQueue::Priority ClientSendQueue::Classify(const netcode::RawPacket& packet)
+{
+	if (packet.length == 0)
+		return PRIO_ORDERED;
+
+	switch (packet.data[0]) {
+		// unsynced; safe to overtake by frames and commands
+		case NETMSG_CHAT:
+		case NETMSG_MAPDRAW:
+		case NETMSG_SYSTEMMSG:
+		case NETMSG_PLAYERINFO:
+		case NETMSG_PLAYERSTAT:
+		case NETMSG_TEAMSTAT:
+		case NETMSG_LOGMSG:
+			return PRIO_BULK;
+		default:
+			break;
+	}
+
+	// NETMSG_LUAMSG stays ordered as well, LuaRules messages are synced
+	return PRIO_ORDERED;
+}
+
+
+void ClientSendQueue::Push(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	const Priority prio = Classify(*packet);
+
+	queuedBytes[prio] += packet->length;
+	queues[prio].emplace_back(std::move(packet));
+
+	if (prio != PRIO_BULK)
+		return;
+
+	while (queuedBytes[PRIO_BULK] > MAX_BULK_BYTES) {
+		queuedBytes[PRIO_BULK] -= queues[PRIO_BULK].front()->length;
+		queues[PRIO_BULK].pop_front();
+		numDroppedBulk += 1;
+	}
+}
+
+void ClientSendQueue::Flush(netcode::CConnection& link, spring_time now)
+{
+	if (!paced || capacity <= 0.0f) {
+		for (unsigned prio = PRIO_ORDERED; prio < PRIO_COUNT; prio++) {
+			while (SendHead(link, static_cast<Priority>(prio)));
+		}
+
+		lastRefill = now;
+		return;
+	}
+
+	const float rate = GetPacingRate();
+	const float burst = std::max(rate * BURST_SECONDS, MIN_BURST_BYTES);
+	const float elapsed = lastRefill.isDuration()? (now - lastRefill).toSecsf(): 0.0f;
+
+	tokens = std::min(tokens + rate * elapsed, burst);
+	lastRefill = now;
+
+	// the ordered class may overdraw the bucket by one message so a large
+	// keyframe never starves; the debt then holds back everything after it
+	while (tokens > 0.0f && SendHead(link, PRIO_ORDERED));
+	while (tokens > 0.0f && queues[PRIO_ORDERED].empty() && SendHead(link, PRIO_BULK));
+
+	if (!queues[PRIO_ORDERED].empty() || !queues[PRIO_BULK].empty())
+		numDeferredFlushes += 1;
+
+	backlogged |= !queues[PRIO_ORDERED].empty();
+}
+
+void ClientSendQueue::Drain(netcode::CConnection& link)
+{
+	for (unsigned prio = PRIO_ORDERED; prio < PRIO_COUNT; prio++) {
+		while (SendHead(link, static_cast<Priority>(prio)));
+	}
+}
+
+bool ClientSendQueue::SendHead(netcode::CConnection& link, Priority prio)
+{
+	if (queues[prio].empty())
+		return false;
+
+	std::shared_ptr<const netcode::RawPacket> packet = std::move(queues[prio].front());
+	queues[prio].pop_front();
+
+	queuedBytes[prio] -= packet->length;
+	bytesSent += packet->length;
+	tokens -= packet->length;
+
+	// remember how much had been sent when each frame left, for OnFrameAck
+	const uint8_t msgID = (packet->length > 0)? packet->data[0]: 0;
+
+	if (msgID == NETMSG_KEYFRAME && packet->length >= (1 + sizeof(int32_t))) {
+		int32_t frameNum = 0;
+		std::memcpy(&frameNum, packet->data + 1, sizeof(frameNum));
+		lastSentFrame = frameNum;
+		frameMarks[lastSentFrame % FRAME_HISTORY] = {lastSentFrame, bytesSent};
+	} else if (msgID == NETMSG_NEWFRAME && lastSentFrame >= 0) {
+		lastSentFrame += 1;
+		frameMarks[lastSentFrame % FRAME_HISTORY] = {lastSentFrame, bytesSent};
+	}
+
+	link.SendData(std::move(packet));
+	return true;
+}
+
+
+void ClientSendQueue::OnFrameAck(int frameNum, spring_time now)
+{
+	if (frameNum <= lastAckFrame || frameNum < 0)
+		return;
+
+	const FrameMark& mark = frameMarks[frameNum % FRAME_HISTORY];
+
+	// frame was sent before we started tracking, or fell out of the history
+	if (mark.frameNum != frameNum)
+		return;
+
+	if (lastAckTime.isDuration()) {
+		const float elapsed = (now - lastAckTime).toSecsf();
+
+		// acks arrive in bursts after a stall; very short intervals are noise
+		if (elapsed < 0.1f)
+			return;
+
+		AddCapacitySample((mark.bytesSent - lastAckBytes) / elapsed, backlogged);
+	}
+
+	lastAckFrame = frameNum;
+	lastAckTime = now;
+	lastAckBytes = mark.bytesSent;
+	backlogged = false;
+}
+
+void ClientSendQueue::AddCapacitySample(float bytesPerSec, bool wasBacklogged)
+{
+	// while the queue ran dry the sample only shows what we had to send, not
+	// what the link can carry; it may raise the estimate but never lower it
+	if (!wasBacklogged && bytesPerSec <= capacity)
+		return;
+
+	capacitySamples[capacitySampleIdx] = bytesPerSec;
+	capacitySampleIdx = (capacitySampleIdx + 1) % NUM_CAPACITY_SAMPLES;
+
+	// windowed maximum, old peaks expire after NUM_CAPACITY_SAMPLES samples
+	capacity = *std::max_element(capacitySamples.begin(), capacitySamples.end());
+}
+
+float ClientSendQueue::GetPacingRate() const
+{
+	return std::max(capacity * PACING_GAIN, MIN_PACING_RATE);
+}
+
+void ClientSendQueue::Clear()
+{
+	for (unsigned prio = PRIO_ORDERED; prio < PRIO_COUNT; prio++) {
+		queues[prio].clear();
+		queuedBytes[prio] = 0;
+	}
+
+	tokens = 0.0f;
+}
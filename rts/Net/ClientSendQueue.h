@@ -0,0 +1,113 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _CLIENT_SEND_QUEUE_H
+#define _CLIENT_SEND_QUEUE_H
+
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+#include "System/Misc/SpringTime.h"
+
+namespace netcode
+{
+	class CConnection;
+	class RawPacket;
+}
+
+/**
+ * @brief Per-client outgoing queue, paced by a token bucket
+ *
+ * Messages are split into two priority classes. The ordered class holds
+ * everything the simulation depends on (frames, keyframes, commands, synced
+ * Lua messages); it keeps its FIFO order because a client must see commands
+ * before the frame they belong to, and it is always served first. The bulk
+ * class holds unsynced traffic (chat, map drawing, system messages, player
+ * info) and is only sent while tokens remain after the ordered class.
+ *
+ * The bucket rate follows the link's measured delivery rate: the bytes handed
+ * to the link up to a frame count as delivered once the client reports having
+ * reached that frame. Until the first measurement, and for local clients, the
+ * queue is not paced at all. A client on a weak link thus falls behind on its
+ * own instead of dragging everyone down through speed control.
+ */
+class ClientSendQueue
+{
+public:
+	enum Priority {
+		PRIO_ORDERED = 0,
+		PRIO_BULK    = 1,
+		PRIO_COUNT   = 2,
+	};
+
+	static Priority Classify(const netcode::RawPacket& packet);
+
+	void Push(std::shared_ptr<const netcode::RawPacket> packet);
+	/// hands as much as the bucket allows to <link>, ordered class first
+	void Flush(netcode::CConnection& link, spring_time now);
+	/// hands everything to <link> regardless of the bucket, for a link about to be dropped
+	void Drain(netcode::CConnection& link);
+	/// the client reports having simulated <frameNum>; doubles as a delivery ack
+	void OnFrameAck(int frameNum, spring_time now);
+	void Clear();
+
+	void SetPaced(bool b) { paced = b; }
+
+	/// bytes per second, 0 while unknown
+	float GetCapacityEstimate() const { return capacity; }
+	float GetPacingRate() const;
+	size_t GetQueuedBytes(Priority prio) const { return queuedBytes[prio]; }
+	/// how often a flush had to leave messages behind
+	uint64_t GetNumDeferredFlushes() const { return numDeferredFlushes; }
+	uint64_t GetNumDroppedBulk() const { return numDroppedBulk; }
+
+private:
+	bool SendHead(netcode::CConnection& link, Priority prio);
+	void AddCapacitySample(float bytesPerSec, bool backlogged);
+
+private:
+	// delivery rate is multiplied by this to probe for spare capacity
+	static constexpr float PACING_GAIN = 1.25f;
+	static constexpr float MIN_PACING_RATE = 8.0f * 1024.0f;
+	// bucket depth relative to the rate, i.e. the longest burst at line rate
+	static constexpr float BURST_SECONDS = 0.1f;
+	static constexpr float MIN_BURST_BYTES = 4.0f * 1024.0f;
+	// unsynced traffic beyond this is dropped oldest-first
+	static constexpr size_t MAX_BULK_BYTES = 256 * 1024;
+
+	// frame numbers are learned from keyframes; NEWFRAME advances by one
+	static constexpr size_t FRAME_HISTORY = 256;
+	static constexpr size_t NUM_CAPACITY_SAMPLES = 16;
+
+	struct FrameMark {
+		int frameNum = -1;
+		uint64_t bytesSent = 0;
+	};
+
+	std::array<std::deque<std::shared_ptr<const netcode::RawPacket>>, PRIO_COUNT> queues;
+	std::array<size_t, PRIO_COUNT> queuedBytes = {};
+
+	std::array<FrameMark, FRAME_HISTORY> frameMarks;
+	std::array<float, NUM_CAPACITY_SAMPLES> capacitySamples = {};
+
+	spring_time lastRefill = spring_notime;
+	spring_time lastAckTime = spring_notime;
+
+	uint64_t bytesSent = 0;
+	uint64_t lastAckBytes = 0;
+	uint64_t numDeferredFlushes = 0;
+	uint64_t numDroppedBulk = 0;
+
+	float tokens = 0.0f;
+	float capacity = 0.0f;
+
+	int lastSentFrame = -1;
+	int lastAckFrame = -1;
+	unsigned capacitySampleIdx = 0;
+
+	bool paced = true;
+	bool backlogged = false; // ordered class had to wait since the last ack
+};
+
+#endif // _CLIENT_SEND_QUEUE_H
@@ -1,5 +1,9 @@
 #include "DCFConnection.h"
+#include "System/Net/ProtocolDef.h"
+#include "System/Misc/TracyDefs.h"
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
 #include <nlohmann/json.hpp>
@@ -9,7 +13,14 @@
 using json = nlohmann::json;
 using namespace std::chrono;
 
+static void RegisterGameEnvelopes() {
+    // So coalesced datagrams and relay payloads can be split around game envelopes
+    netcode::ProtocolDef::GetInstance()->AddType(dcf::GAME_DATA, -2);
+    netcode::ProtocolDef::GetInstance()->AddType(dcf::GAME_JOIN, -2);
+}
+
 DCFConnection::DCFConnection(const std::string& configPath) : client(nullptr, ClientDeleter) {
+    RegisterGameEnvelopes();
     try {
         if (!ValidateConfiguration(configPath)) {
             DCF_THROW("Invalid configuration file");
@@ -26,7 +37,28 @@ DCFConnection::DCFConnection(const std::string& configPath) : client(nullptr, Cl
     }
 }
 
+DCFConnection::DCFConnection(DCFConnection& sharedTransport, uint32_t gameID)
+    : client(nullptr, ClientDeleter)
+    , redundancy(nullptr)
+    , transport(&sharedTransport)
+    , gameChannelID(gameID)
+    , hasGameChannel(true) {
+    RegisterGameEnvelopes();
+    rttThreshold = transport->rttThreshold;
+    initialized = transport->initialized.load();
+    {
+        std::lock_guard<std::mutex> lock(transport->channelsMutex);
+        transport->channels[gameID] = this;
+    }
+    DCF_LOG(dcf::DCFLogLevel::INFO, "Opened game channel " + std::to_string(gameID));
+}
+
 DCFConnection::~DCFConnection() {
+    if (transport) {
+        // After this the transport workers can no longer route packets to us
+        std::lock_guard<std::mutex> lock(transport->channelsMutex);
+        transport->channels.erase(gameChannelID);
+    }
     Close(true);
     initialized = false;
     for (auto& th : updateThreads) {
@@ -55,7 +87,31 @@ bool DCFConnection::ValidateConfiguration(const std::string& configPath) {
             }
         }
         rttThreshold = config["group_rtt_threshold"].get<double>();
-        dcf::DCFLogger::Configure(config["logging"]["file"], static_cast<dcf::DCFLogLevel>(config["logging"]["level"].get<int>()));
+        nodeId = config["node_id"].get<std::string>();
+        // Optional, peers of a multi-game host: the game this node plays in
+        if (config.contains("game_id")) {
+            gameChannelID = config["game_id"].get<uint32_t>();
+            hasGameChannel = true;
+        }
+        // Optional: "poll" (default) sleeps 1ms between receives, "event" blocks in the transport until readiness
+        const std::string wakeup = config.value("worker_wakeup", std::string("poll"));
+        if (wakeup == "event") {
+            wakeupMode = WorkerWakeupMode::Event;
+        } else if (wakeup != "poll") {
+            DCF_LOG(dcf::DCFLogLevel::WARNING, "Unknown worker_wakeup mode '" + wakeup + "', using poll");
+        }
+        // Optional: coalesce small messages per server frame into datagrams of at most network_settings.mtu bytes
+        coalescePackets = config.value("coalesce_packets", false);
+        // Optional, host only: fan broadcasts out through one relay peer per RTT cluster
+        if (config.value("relay_fanout", false)) {
+            relayMinPeers = config.value("relay_min_peers", DEFAULT_RELAY_MIN_PEERS);
+            relayTree = std::make_unique<dcf::DCFRelayTree>(rttThreshold, config.value("relay_cluster_size", DEFAULT_RELAY_CLUSTER_SIZE), RELAY_HISTORY_SIZE);
+        }
+        if (config.contains("network_settings")) {
+            coalesceMTU = std::clamp(config["network_settings"].value("mtu", DEFAULT_COALESCE_MTU), 300u, 65535u);
+        }
+        dcf::DCFLogger::Configure(config["logging"]["file"], static_cast<dcf::DCFLogLevel>(config["logging"]["level"].get<int>()),
+                                  config["logging"].value("max_per_site_per_second", 20u));
         return true;
     } catch (const json::exception& e) {
         DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("JSON parse error: ") + e.what());
@@ -64,6 +120,14 @@ bool DCFConnection::ValidateConfiguration(const std::string& configPath) {
 }
 
 void DCFConnection::InitializeClient(const std::string& configPath) {
+    // The SDK loads the transport plugin itself, which can only be told how the workers wait through
+    // the environment (see create_plugin): in poll mode its receive() must not block
+    const char* wakeup = (wakeupMode == WorkerWakeupMode::Event) ? "event" : "poll";
+#ifdef _WIN32
+    _putenv_s("DCF_WORKER_WAKEUP", wakeup);
+#else
+    setenv("DCF_WORKER_WAKEUP", wakeup, 1);
+#endif
     DCFClient* rawClient = dcf_client_new();
     if (!rawClient) {
         DCF_THROW("Failed to create DCF client");
@@ -83,41 +147,74 @@ void DCFConnection::InitializeClient(const std::string& configPath) {
     initialized = true;
 }
 
-std::error_code DCFConnection::SendWithRetry(const RawPacket& data, int maxRetries) {
-    std::error_code ec;
-    for (int attempt = 0; attempt < maxRetries; ++attempt) {
-        DCFError err = dcf_client_send_message(client.get(), reinterpret_cast<const char*>(data.data), data.length, "broadcast");
-        if (err == DCF_SUCCESS) {
-            std::lock_guard<std::mutex> lock(metricsMutex);
-            metrics.totalPacketsSent++;
-            metrics.totalBytesSent += data.length;
-            return ec;
+std::error_code DCFConnection::TrySend(const RawPacket& data, const char* target) {
+    const DCFError err = dcf_client_send_message(client.get(), reinterpret_cast<const char*>(data.data), data.length, target);
+    if (err == DCF_SUCCESS) {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        metrics.totalPacketsSent++;
+        metrics.totalBytesSent += data.length;
+        return {};
+    }
+
+    DCF_LOG(dcf::DCFLogLevel::ERROR, "DCF SDK error code: " + std::to_string(err));
+    {
+        std::lock_guard<std::mutex> lock(metricsMutex);
+        metrics.failedSendAttempts++;
+    }
+    // Explicit handling: retry or failover based on error
+    if (err == DCF_TIMEOUT) {
+        TriggerFailoverIfNeeded();
+        return std::make_error_code(std::errc::timed_out);
+    }
+    if (err == DCF_NETWORK_ERROR) {
+        // Attempt reconnect
+        if (NeedsReconnect()) {
+            ReconnectTo(*this);
         }
-        if (err != DCF_SUCCESS) {
-            DCF_LOG(dcf::DCFLogLevel::ERROR, "DCF SDK error code: " + std::to_string(err));
-            // Explicit handling: retry or failover based on error
-            if (err == DCF_TIMEOUT) {
-                TriggerFailoverIfNeeded();
-                ec = std::make_error_code(std::errc::timed_out);
-            } else if (err == DCF_NETWORK_ERROR) {
-                // Attempt reconnect
-                if (NeedsReconnect()) {
-                    ReconnectTo(*this);
-                }
-                ec = std::make_error_code(std::errc::network_down);
-            } else {
-                // Unknown error: abort retry
-                return std::make_error_code(std::errc::io_error);
-            }
+        return std::make_error_code(std::errc::network_down);
+    }
+    // Unknown error: not worth retrying
+    return std::make_error_code(std::errc::io_error);
+}
+
+bool DCFConnection::IsRetryable(const std::error_code& ec) {
+    return (ec == std::errc::timed_out || ec == std::errc::network_down);
+}
+
+steady_clock::duration DCFConnection::RetryBackoff(int attempt) {
+    return milliseconds(std::min(RETRY_BACKOFF_STEP_MS * attempt, RETRY_BACKOFF_MAX_MS));  // Capped linear backoff
+}
+
+void DCFConnection::ProcessRetries() {
+    std::lock_guard<std::mutex> lock(retryMutex);
+
+    const auto now = steady_clock::now();
+    while (!retryBacklog.empty() && now >= nextRetryTime) {
+        PendingSend& head = retryBacklog.front();
+        const std::error_code ec = !head.target.empty() ? TrySend(*head.packet, head.target.c_str())
+                                 : relayTree ? TransmitRelayed(*head.packet) : TrySend(*head.packet);
+
+        if (!ec) {
+            retryBacklog.pop_front();
+            continue;
         }
-        metrics.failedSendAttempts++;
-        DCF_LOG(dcf::DCFLogLevel::WARNING, "Send attempt " + std::to_string(attempt + 1) + " failed");
-        std::this_thread::sleep_for(milliseconds(std::min(100 * (attempt + 1), 500)));  // Capped exponential backoff
+        if (!IsRetryable(ec) || head.attempts >= MAX_SEND_ATTEMPTS) {
+            DCF_LOG(dcf::DCFLogLevel::ERROR, "Send failed after " + std::to_string(head.attempts + 1) + " attempts: " + ec.message());
+            retryBacklog.pop_front();
+            abandonedSends++;
+            continue;
+        }
+
+        DCF_LOG(dcf::DCFLogLevel::WARNING, "Send attempt " + std::to_string(head.attempts + 1) + " failed");
+        nextRetryTime = now + RetryBackoff(++head.attempts);
+        break;
     }
-    return ec;
+
+    pendingRetryDepth.store(retryBacklog.size(), std::memory_order_relaxed);
 }
 
 void DCFConnection::SendData(std::shared_ptr<const RawPacket> data) {
+    RECOIL_TRACY_ZONE(NET);
     if (!initialized || muted) {
         DCF_LOG(dcf::DCFLogLevel::WARNING, "Send blocked: not initialized or muted");
         return;
@@ -126,6 +223,36 @@ void DCFConnection::SendData(std::shared_ptr<const RawPacket> data) {
         DCF_LOG(dcf::DCFLogLevel::ERROR, "Invalid packet data");
         return;
     }
+    if (relayTree && data->length > 65535 - dcf::RELAY_DATA_HEADER_SIZE) {
+        DCF_LOG(dcf::DCFLogLevel::ERROR, "Packet too large for a relay envelope");
+        return;
+    }
+    if (hasGameChannel && data->length > 65535 - dcf::GAME_HEADER_SIZE) {
+        DCF_LOG(dcf::DCFLogLevel::ERROR, "Packet too large for a game envelope");
+        return;
+    }
+
+    if (transport) {
+        // Game channel: the shared transport owns retries; only this game's members get the data
+        auto envelope = WrapGameEnvelope(dcf::GAME_DATA, data->data, data->length);
+        std::vector<std::string> members;
+        {
+            std::lock_guard<std::mutex> lock(channelMembersMutex);
+            members = channelMembers;
+        }
+        // Nobody announced yet: tagged broadcast, peers of other games drop it
+        if (members.empty()) {
+            transport->SendNow(std::move(envelope));
+            return;
+        }
+        for (const auto& member : members) {
+            transport->SendNow(envelope, member);
+        }
+        return;
+    }
+    if (hasGameChannel) {
+        data = WrapGameEnvelope(dcf::GAME_DATA, data->data, data->length);
+    }
 
     double rtt = metrics.averageRTT;
     if (!IsInRTTGroup(rtt)) {
@@ -133,11 +260,106 @@ void DCFConnection::SendData(std::shared_ptr<const RawPacket> data) {
         // Reroute via redundancy API if available
     }
 
-    auto ec = SendWithRetry(*data);
-    if (ec) {
+    if (coalescePackets) {
+        std::lock_guard<std::mutex> lock(coalesceMutex);
+        if (data->length < coalesceMTU) {
+            // Pack small messages into one datagram per frame; the receiver splits them by ProtocolDef length
+            if (coalesceBuffer.size() + data->length > coalesceMTU) {
+                FlushCoalesced();
+            }
+            coalesceBuffer.insert(coalesceBuffer.end(), data->data, data->data + data->length);
+            numCoalescedPackets++;
+            return;
+        }
+        // Oversized message: everything queued before it must go out first
+        FlushCoalesced();
+    }
+
+    SendNow(std::move(data));
+}
+
+void DCFConnection::FlushCoalesced() {
+    RECOIL_TRACY_ZONE(NET);
+    if (coalesceBuffer.empty()) {
+        return;
+    }
+    auto bundle = std::make_shared<RawPacket>(coalesceBuffer.data(), static_cast<uint32_t>(coalesceBuffer.size()));
+    coalesceBuffer.clear();
+    numCoalescedDatagrams++;
+    SendNow(std::move(bundle));
+}
+
+void DCFConnection::SendNow(std::shared_ptr<const RawPacket> data, const std::string& target) {
+    RECOIL_TRACY_ZONE(NET);
+    std::lock_guard<std::mutex> lock(retryMutex);
+
+    // Sequence once, before any retry, so receivers can drop duplicates of a resent envelope
+    if (relayTree && target.empty()) {
+        data = relayTree->Wrap(*data);
+    }
+
+    // Never block the caller (usually the server frame loop): once a send has failed, it and
+    // every later packet wait in the backlog so the NETMSG stream stays in order
+    if (!retryBacklog.empty()) {
+        if (retryBacklog.size() >= MAX_PENDING_RETRIES) {
+            DCF_LOG(dcf::DCFLogLevel::ERROR, "Retry backlog full, dropping packet");
+            abandonedSends++;
+            return;
+        }
+        retryBacklog.push_back({std::move(data), 0, target});
+        pendingRetryDepth.store(retryBacklog.size(), std::memory_order_relaxed);
+        return;
+    }
+
+    const std::error_code ec = !target.empty() ? TrySend(*data, target.c_str())
+                             : relayTree ? TransmitRelayed(*data) : TrySend(*data);
+    if (!ec) {
+        return;
+    }
+    if (!IsRetryable(ec)) {
         DCF_LOG(dcf::DCFLogLevel::ERROR, "Send failed: " + ec.message());
         TriggerFailoverIfNeeded();
+        return;
+    }
+
+    retryBacklog.push_front({std::move(data), 1, target});
+    nextRetryTime = steady_clock::now() + RetryBackoff(1);
+    pendingRetryDepth.store(retryBacklog.size(), std::memory_order_relaxed);
+}
+
+std::error_code DCFConnection::TransmitRelayed(const RawPacket& envelope) {
+    // Too few peers for a tree: the envelope still goes out so the sequence stays unbroken
+    if (relayTree->Empty()) {
+        return TrySend(envelope);
     }
+
+    std::error_code firstError;
+    relayTree->Send(envelope, [this, &firstError](const RawPacket& env, const std::string& target) {
+        const std::error_code ec = TrySend(env, target.c_str());
+        if (ec && !firstError)
+            firstError = ec;
+        return !ec;
+    });
+    return firstError;
+}
+
+void DCFConnection::RebuildRelayTree() {
+    const auto snapshots = GetPeerLatencySnapshots();
+    std::vector<std::pair<std::string, float>> peers;
+    if (snapshots.size() >= relayMinPeers) {
+        for (const auto& peer : snapshots) {
+            peers.emplace_back(peer.first, peer.second.p50);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(retryMutex);
+    relayTree->Rebuild(std::move(peers), [this](const RawPacket& env, const std::string& target) {
+        return !TrySend(env, target.c_str());
+    });
+}
+
+size_t DCFConnection::GetPendingRetryDepth() const {
+    return pendingRetryDepth.load(std::memory_order_relaxed);
 }
 
 void DCFConnection::TriggerFailoverIfNeeded() {
@@ -149,17 +371,167 @@ void DCFConnection::TriggerFailoverIfNeeded() {
     }
 }
 
-void DCFConnection::HandleIncomingMessage(const char* data, size_t length) {
+void DCFConnection::HandleIncomingMessage(char* data, size_t length) {
+    RECOIL_TRACY_ZONE(NET);
     if (!data || length == 0 || length > 65535) {
         DCF_LOG(dcf::DCFLogLevel::WARNING, "Invalid message data");
+        free(data);
+        return;
+    }
+
+    const auto* buf = reinterpret_cast<const uint8_t*>(data);
+    if (buf[0] == dcf::RELAY_DATA || buf[0] == dcf::RELAY_ASSIGN) {
+        HandleRelayEnvelope(RawPacket::Adopt(reinterpret_cast<uint8_t*>(data), length));
+        return;
+    }
+
+    // A coalesced datagram carries several NETMSGs back to back; split it on message boundaries
+    const int firstLength = netcode::ProtocolDef::GetInstance()->PacketLength(buf, length);
+    if (firstLength > 0 && static_cast<size_t>(firstLength) < length) {
+        QueuePayload(buf, length);
+        free(data);
         return;
     }
+
+    // Zero-copy: the packet takes over the SDK's malloc'ed buffer instead of duplicating it
+    QueueIncomingPacket(std::make_shared<RawPacket>(RawPacket::Adopt(reinterpret_cast<uint8_t*>(data), length)));
+}
+
+void DCFConnection::HandleRelayEnvelope(RawPacket envelope) {
+    if (envelope.data[0] == dcf::RELAY_ASSIGN) {
+        uint32_t epoch = 0;
+        std::vector<std::string> members;
+        if (!dcf::DCFRelayTree::ParseAssign(envelope.data, envelope.length, epoch, members)) {
+            DCF_LOG(dcf::DCFLogLevel::WARNING, "Malformed relay assignment");
+            return;
+        }
+        std::lock_guard<std::mutex> lock(relayMembersMutex);
+        if (epoch < relayEpoch) {
+            return;  // Overtaken by a newer assignment
+        }
+        relayEpoch = epoch;
+        relayMembers = std::move(members);
+        DCF_LOG(dcf::DCFLogLevel::INFO, "Relaying for " + std::to_string(relayMembers.size()) + " peers (epoch " + std::to_string(epoch) + ")");
+        return;
+    }
+
+    // Forward first so the rest of the cluster is not delayed by our own processing
+    {
+        std::lock_guard<std::mutex> lock(relayMembersMutex);
+        for (const auto& member : relayMembers) {
+            if (!TrySend(envelope, member.c_str())) {
+                numRelayForwarded++;
+            }
+        }
+    }
+
+    // Workers receive concurrently; the sequencer releases payloads to the queue in server order
+    std::lock_guard<std::mutex> lock(relaySequencerMutex);
+    const auto deliver = [this](const uint8_t* payload, size_t length) { QueuePayload(payload, length); };
+    if (!relaySequencer.Receive(envelope.data, envelope.length, deliver)) {
+        DCF_LOG(dcf::DCFLogLevel::WARNING, "Malformed relay envelope");
+    }
+}
+
+void DCFConnection::QueuePayload(const uint8_t* buf, size_t length) {
+    for (size_t pos = 0; pos < length; ) {
+        const int msgLength = netcode::ProtocolDef::GetInstance()->PacketLength(buf + pos, length - pos);
+        if (msgLength <= 0 || pos + msgLength > length) {
+            DCF_LOG(dcf::DCFLogLevel::WARNING, "Malformed coalesced datagram, discarding remainder");
+            break;
+        }
+        QueueIncomingPacket(std::make_shared<RawPacket>(buf + pos, static_cast<uint32_t>(msgLength)));
+        pos += msgLength;
+    }
+}
+
+std::shared_ptr<const RawPacket> DCFConnection::WrapGameEnvelope(uint8_t envelopeID, const uint8_t* payload, size_t length) const {
+    const uint16_t envelopeLength = static_cast<uint16_t>(dcf::GAME_HEADER_SIZE + length);
+    auto envelope = std::make_shared<RawPacket>(static_cast<uint32_t>(envelopeLength));
+    envelope->data[0] = envelopeID;
+    std::memcpy(envelope->data + 1, &envelopeLength, sizeof(envelopeLength));
+    std::memcpy(envelope->data + 3, &gameChannelID, sizeof(gameChannelID));
+    std::memcpy(envelope->data + dcf::GAME_HEADER_SIZE, payload, length);
+    return envelope;
+}
+
+void DCFConnection::RouteGameEnvelope(const RawPacket& envelope) {
+    uint16_t length = 0;
+    uint32_t gameID = 0;
+    if (envelope.length >= dcf::GAME_HEADER_SIZE) {
+        std::memcpy(&length, envelope.data + 1, sizeof(length));
+        std::memcpy(&gameID, envelope.data + 3, sizeof(gameID));
+    }
+    if (envelope.length < dcf::GAME_HEADER_SIZE || length != envelope.length) {
+        DCF_LOG(dcf::DCFLogLevel::WARNING, "Malformed game envelope");
+        return;
+    }
+
+    const uint8_t* payload = envelope.data + dcf::GAME_HEADER_SIZE;
+    const size_t payloadLength = envelope.length - dcf::GAME_HEADER_SIZE;
+    {
+        // Held while delivering, so a channel cannot be destroyed under a worker
+        std::lock_guard<std::mutex> lock(channelsMutex);
+        if (!channels.empty()) {
+            const auto it = channels.find(gameID);
+            if (it == channels.end()) {
+                numForeignGamePackets++;
+                return;
+            }
+            if (envelope.data[0] == dcf::GAME_JOIN) {
+                it->second->AddChannelMember(std::string(reinterpret_cast<const char*>(payload), payloadLength));
+            } else if (payloadLength > 0) {
+                it->second->QueuePayload(payload, payloadLength);
+            }
+            return;
+        }
+    }
+
+    // Peer: until the host has seen our announcement it broadcasts, so other games show up here too
+    if (envelope.data[0] != dcf::GAME_DATA || !hasGameChannel || gameID != gameChannelID || payloadLength == 0) {
+        numForeignGamePackets++;
+        return;
+    }
+    QueuePayload(payload, payloadLength);
+}
+
+void DCFConnection::AnnounceGameChannel() {
+    if (!hasGameChannel || transport || nodeId.empty()) {
+        return;
+    }
+    SendNow(WrapGameEnvelope(dcf::GAME_JOIN, reinterpret_cast<const uint8_t*>(nodeId.data()), nodeId.size()));
+}
+
+void DCFConnection::AddChannelMember(const std::string& member) {
+    std::lock_guard<std::mutex> lock(channelMembersMutex);
+    if (std::find(channelMembers.begin(), channelMembers.end(), member) != channelMembers.end()) {
+        return;
+    }
+    channelMembers.push_back(member);
+    DCF_LOG(dcf::DCFLogLevel::INFO, "Game channel " + std::to_string(gameChannelID) + ": " + member + " joined");
+}
+
+void DCFConnection::QueueIncomingPacket(std::shared_ptr<const RawPacket> packet) {
+    if (packet->data[0] == dcf::GAME_DATA || packet->data[0] == dcf::GAME_JOIN) {
+        RouteGameEnvelope(*packet);
+        return;
+    }
+
+    const uint32_t length = packet->length;
     try {
-        auto packet = std::make_shared<RawPacket>(reinterpret_cast<const unsigned char*>(data), length);
-        while (!msgQueue.push(packet)) {
-            std::this_thread::sleep_for(milliseconds(10));  // Backoff on full queue
+        int spins = 0;
+        while (!msgQueue.Push(packet)) {
+            if (++spins > RECV_QUEUE_MAX_PUSH_SPINS || !initialized) {
+                std::lock_guard<std::mutex> lock(metricsMutex);
+                metrics.droppedPackets++;
+                DCF_LOG(dcf::DCFLogLevel::WARNING, "Receive queue full, dropping packet");
+                return;
+            }
+            std::this_thread::yield();  // Consumer drains once per server tick; yield instead of sleeping
         }
+
         std::lock_guard<std::mutex> lock(metricsMutex);
+        metrics.queueFullWaits += (spins > 0);
         metrics.totalPacketsReceived++;
         metrics.totalBytesReceived += length;
     } catch (const std::exception& e) {
@@ -170,13 +542,23 @@ void DCFConnection::HandleIncomingMessage(const char* data, size_t length) {
 void DCFConnection::UpdateThreadLoop() {
     while (initialized) {
         try {
-            char* data;
-            size_t length;
-            if (dcf_client_receive_message(client.get(), &data, &length) == DCF_SUCCESS && data) {
-                HandleIncomingMessage(data, length);
-                free(data);
+            char* data = nullptr;
+            size_t length = 0;
+            const bool received = (dcf_client_receive_message(client.get(), &data, &length) == DCF_SUCCESS && data);
+            workerWakeups.fetch_add(1, std::memory_order_relaxed);
+            if (received) {
+                HandleIncomingMessage(data, length);  // Takes ownership of data
+            }
+            if (wakeupMode == WorkerWakeupMode::Poll) {
+                std::this_thread::sleep_for(milliseconds(1));  // Low sleep for responsiveness
+                continue;
+            }
+            // Event mode: the transport receive blocks until the socket is readable, so only
+            // park briefly if it returned empty-handed (timeout); Close() notifies to exit early
+            if (!received) {
+                std::unique_lock<std::mutex> lock(workerWaitMutex);
+                workerWaitCond.wait_for(lock, milliseconds(EVENT_IDLE_WAIT_MS), [this]() { return !initialized; });
             }
-            std::this_thread::sleep_for(milliseconds(1));  // Low sleep for responsiveness
         } catch (const std::exception& e) {
             DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("Update thread failed: ") + e.what());
         }
@@ -184,15 +566,36 @@ void DCFConnection::UpdateThreadLoop() {
 }
 
 void DCFConnection::Update() {
-    if (!initialized) return;
+    RECOIL_TRACY_ZONE(NET);
+    // Game channels are driven through the transport's Update
+    if (!initialized || transport) return;
 
     try {
-        std::lock_guard<std::mutex> lock(metricsMutex);
+        ProcessRetries();
+
         auto now = system_clock::now();
-        if (duration_cast<seconds>(now - metrics.lastMetricsUpdate).count() > 2) {
+        bool refreshMetrics = false;
+        {
+            std::lock_guard<std::mutex> lock(metricsMutex);
+            const auto elapsed = duration_cast<milliseconds>(now - metrics.lastMetricsUpdate).count();
+            if (elapsed > 2000) {
+                const uint64_t wakeups = workerWakeups.load(std::memory_order_relaxed);
+                metrics.workerWakeupsPerSec = (wakeups - lastWorkerWakeups) * 1000.0 / elapsed;
+                lastWorkerWakeups = wakeups;
+                metrics.lastMetricsUpdate = now;
+                refreshMetrics = true;
+            }
+        }
+        // UpdateMetrics and TriggerFailoverIfNeeded take metricsMutex themselves
+        if (refreshMetrics) {
+            DecayLatencyHistograms();
             ProcessMetrics();
+            if (relayTree) {
+                RebuildRelayTree();
+            }
+            // Repeated so a restarted host learns about us again
+            AnnounceGameChannel();
             LogMetrics();
-            metrics.lastMetricsUpdate = now;
         }
         TriggerFailoverIfNeeded();
     } catch (const std::exception& e) {
@@ -200,7 +603,39 @@ void DCFConnection::Update() {
     }
 }
 
+void DCFConnection::DecayLatencyHistograms() {
+    rttHistogram.Decay(RTT_HISTORY_SAMPLES);
+    std::lock_guard<std::mutex> lock(peerRTTMutex);
+    for (auto& peer : peerRTTHistograms) {
+        peer.second->Decay(PEER_RTT_HISTORY_SAMPLES);
+    }
+}
+
+void DCFConnection::SnapshotLatency() {
+    latencySnapshot = (transport ? transport->rttHistogram : rttHistogram).GetSnapshot();
+}
+
+std::vector<std::pair<std::string, DCFConnection::LatencySnapshot>> DCFConnection::GetPeerLatencySnapshots() const {
+    if (transport) {
+        // Only the peers playing in this channel's game
+        auto snapshots = transport->GetPeerLatencySnapshots();
+        std::lock_guard<std::mutex> lock(channelMembersMutex);
+        snapshots.erase(std::remove_if(snapshots.begin(), snapshots.end(), [this](const auto& peer) {
+            return (std::find(channelMembers.begin(), channelMembers.end(), peer.first) == channelMembers.end());
+        }), snapshots.end());
+        return snapshots;
+    }
+    std::lock_guard<std::mutex> lock(peerRTTMutex);
+    std::vector<std::pair<std::string, LatencySnapshot>> snapshots;
+    snapshots.reserve(peerRTTHistograms.size());
+    for (const auto& peer : peerRTTHistograms) {
+        snapshots.emplace_back(peer.first, peer.second->GetSnapshot());
+    }
+    return snapshots;
+}
+
 void DCFConnection::ProcessMetrics() {
+    if (!client) return;  // Game channel: the transport collects metrics
     cJSON* metricsJson;
     if (dcf_client_get_metrics(client.get(), &metricsJson) == DCF_SUCCESS && metricsJson) {
         UpdateMetrics(metricsJson);
@@ -218,6 +653,29 @@ void DCFConnection::UpdateMetrics(const cJSON* metricsJson) {
             std::lock_guard<std::mutex> lock(metricsMutex);
             metrics.averageRTT = rttObj->valuedouble;
         }
+
+        // Optional per-peer breakdown: "peers": [{"node_id": "...", "rtt": ms}, ...]
+        const cJSON* peersObj = cJSON_GetObjectItem(metricsJson, "peers");
+        bool havePeerSamples = false;
+        if (peersObj && cJSON_IsArray(peersObj)) {
+            std::lock_guard<std::mutex> lock(peerRTTMutex);
+            const cJSON* peerObj = nullptr;
+            cJSON_ArrayForEach(peerObj, peersObj) {
+                const cJSON* idObj = cJSON_GetObjectItem(peerObj, "node_id");
+                const cJSON* peerRTTObj = cJSON_GetObjectItem(peerObj, "rtt");
+                if (!idObj || !cJSON_IsString(idObj) || !peerRTTObj || !cJSON_IsNumber(peerRTTObj))
+                    continue;
+                auto& hist = peerRTTHistograms[idObj->valuestring];
+                if (!hist)
+                    hist = std::make_unique<spring::LatencyHistogram>();
+                hist->Record(static_cast<float>(peerRTTObj->valuedouble));
+                rttHistogram.Record(static_cast<float>(peerRTTObj->valuedouble));
+                havePeerSamples = true;
+            }
+        }
+        if (!havePeerSamples && rttObj && cJSON_IsNumber(rttObj)) {
+            rttHistogram.Record(static_cast<float>(rttObj->valuedouble));
+        }
     } catch (const std::exception& e) {
         DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("Update metrics failed: ") + e.what());
     }
@@ -233,40 +691,57 @@ void DCFConnection::LogMetrics() const {
        << "\"failed_attempts\":" << metrics.failedSendAttempts << ","
        << "\"average_rtt_ms\":" << metrics.averageRTT << "}";
     DCF_LOG(dcf::DCFLogLevel::INFO, ss.str());
+
+    if (relayTree) {
+        std::lock_guard<std::mutex> lock(retryMutex);
+        const auto totals = relayTree->GetTotals();
+        DCF_LOG(dcf::DCFLogLevel::INFO, "Relay fan-out: " + std::to_string(relayTree->GetClusters().size()) + " clusters, "
+                + std::to_string(totals.first) + " bytes sent for " + std::to_string(totals.second) + " bytes delivered");
+    }
 }
 
 bool DCFConnection::HasIncomingData() const {
-    return !msgQueue.empty();
+    return !msgQueue.Empty();
 }
 
 std::shared_ptr<const RawPacket> DCFConnection::Peek(unsigned ahead) const {
-    std::shared_ptr<const RawPacket> pkt;
-    if (ahead >= msgQueue.capacity()) {
+    if (ahead >= msgQueue.Capacity()) {
         DCF_LOG(dcf::DCFLogLevel::DEBUG, "Peek out of bounds");
         return nullptr;
     }
-    // Simulate peek on lock-free queue
-    if (msgQueue.pop(pkt)) {
-        msgQueue.push(pkt);  // Re-push
-        return pkt;
-    }
-    return nullptr;
+    const auto* pkt = msgQueue.Peek(ahead);
+    return (pkt != nullptr) ? *pkt : nullptr;
 }
 
 std::shared_ptr<const RawPacket> DCFConnection::GetData() {
     std::shared_ptr<const RawPacket> pkt;
-    if (msgQueue.pop(pkt)) {
+    if (msgQueue.Pop(pkt)) {
         return pkt;
     }
     return nullptr;
 }
 
+size_t DCFConnection::GetDataBatch(std::vector<std::shared_ptr<const RawPacket>>& out, size_t maxPackets) {
+    RECOIL_TRACY_ZONE(NET);
+    return msgQueue.PopBulk([&out](std::shared_ptr<const RawPacket>&& pkt) { out.emplace_back(std::move(pkt)); }, maxPackets);
+}
+
 void DCFConnection::DeleteBufferPacketAt(unsigned index) {
-    DCF_LOG(dcf::DCFLogLevel::DEBUG, "DeleteBufferPacketAt not directly supported; resetting queue");
-    msgQueue.reset();
+    // Only the consumer touches the read side, so the head can be dropped in place
+    if (index == 0) {
+        GetData();
+        return;
+    }
+    DCF_LOG(dcf::DCFLogLevel::DEBUG, "DeleteBufferPacketAt only supports the queue head; clearing queue");
+    msgQueue.Clear();
 }
 
 void DCFConnection::Flush(const bool forced) {
+    RECOIL_TRACY_ZONE(NET);
+    if (coalescePackets) {
+        std::lock_guard<std::mutex> lock(coalesceMutex);
+        FlushCoalesced();
+    }
     if (forced && client) {
         dcf_client_flush(client.get());
     }
@@ -288,33 +763,107 @@ bool DCFConnection::CanReconnect() const { return true; }
 
 bool DCFConnection::NeedsReconnect() { return metrics.failedSendAttempts > 10; }
 
-unsigned int DCFConnection::GetPacketQueueSize() const { return msgQueue.read_available(); }
+unsigned int DCFConnection::GetPacketQueueSize() const { return static_cast<unsigned int>(msgQueue.Size()); }
 
 std::string DCFConnection::Statistics() const {
+    const auto poolStats = netcode::PacketBufferPool::GetStats();
+    const auto rtt = rttHistogram.GetSnapshot();
+    const auto peers = GetPeerLatencySnapshots();
+    // Gathered before metricsMutex: the send path takes retryMutex first, then metricsMutex
+    const std::string relayStats = RelayStatistics();
     std::lock_guard<std::mutex> lock(metricsMutex);
     std::stringstream ss;
     ss << "DCF Statistics: {"
        << "\"initialized\":" << (initialized ? "true" : "false") << ","
        << "\"muted\":" << (muted ? "true" : "false") << ","
        << "\"loss_factor\":" << lossFactor << ","
+       << "\"game_channel\":" << (hasGameChannel ? std::to_string(gameChannelID) : std::string("null")) << ","
+       << "\"foreign_game_packets\":" << numForeignGamePackets.load(std::memory_order_relaxed) << ","
        << "\"total_packets_sent\":" << metrics.totalPacketsSent << ","
        << "\"total_packets_received\":" << metrics.totalPacketsReceived << ","
        << "\"total_bytes_sent\":" << metrics.totalBytesSent << ","
        << "\"total_bytes_received\":" << metrics.totalBytesReceived << ","
        << "\"failed_send_attempts\":" << metrics.failedSendAttempts << ","
-       << "\"average_rtt_ms\":" << metrics.averageRTT << "}";
+       << "\"pending_retry_depth\":" << GetPendingRetryDepth() << ","
+       << "\"abandoned_sends\":" << abandonedSends.load(std::memory_order_relaxed) << ","
+       << "\"recv_queue_size\":" << msgQueue.Size() << ","
+       << "\"recv_queue_full_waits\":" << metrics.queueFullWaits << ","
+       << "\"recv_dropped_packets\":" << metrics.droppedPackets << ","
+       << "\"worker_wakeup_mode\":\"" << ((wakeupMode == WorkerWakeupMode::Event) ? "event" : "poll") << "\","
+       << "\"worker_wakeups_per_sec\":" << metrics.workerWakeupsPerSec << ","
+       << "\"coalesced_packets\":" << numCoalescedPackets.load(std::memory_order_relaxed) << ","
+       << "\"coalesced_datagrams\":" << numCoalescedDatagrams.load(std::memory_order_relaxed) << ","
+       << "\"packet_pool_hit_rate\":" << poolStats.HitRate() << ","
+       << "\"bytes_copied_last_frame\":" << poolStats.lastFrameBytesCopied << ","
+       << "\"average_rtt_ms\":" << metrics.averageRTT << ","
+       << "\"rtt_p50_ms\":" << rtt.p50 << ","
+       << "\"rtt_p95_ms\":" << rtt.p95 << ","
+       << "\"rtt_p99_ms\":" << rtt.p99 << ","
+       << "\"rtt_jitter_ms\":" << rtt.jitter << ","
+       << "\"relay_forwarded\":" << numRelayForwarded.load(std::memory_order_relaxed) << ","
+       << relayStats
+       << "\"peers\":[";
+    for (size_t i = 0; i < peers.size(); ++i) {
+        ss << (i > 0 ? "," : "")
+           << "{\"node_id\":\"" << peers[i].first << "\","
+           << "\"p50\":" << peers[i].second.p50 << ","
+           << "\"p95\":" << peers[i].second.p95 << ","
+           << "\"p99\":" << peers[i].second.p99 << ","
+           << "\"jitter\":" << peers[i].second.jitter << "}";
+    }
+    ss << "]}";
+    return ss.str();
+}
+
+std::string DCFConnection::RelayStatistics() const {
+    std::stringstream ss;
+    {
+        std::lock_guard<std::mutex> lock(relaySequencerMutex);
+        ss << "\"relay_duplicates\":" << relaySequencer.GetNumDuplicates() << ","
+           << "\"relay_skipped\":" << relaySequencer.GetNumSkipped() << ",";
+    }
+    if (!relayTree) {
+        return ss.str();
+    }
+
+    // Per-cluster bandwidth: bytes_sent is what the host paid, bytes_fanned_out what direct sends would have cost
+    std::lock_guard<std::mutex> lock(retryMutex);
+    const auto& clusters = relayTree->GetClusters();
+    const auto totals = relayTree->GetTotals();
+    ss << "\"relay_epoch\":" << relayTree->GetEpoch() << ","
+       << "\"relay_bytes_sent\":" << totals.first << ","
+       << "\"relay_bytes_saved\":" << (totals.second - std::min(totals.first, totals.second)) << ","
+       << "\"relay_clusters\":[";
+    for (size_t i = 0; i < clusters.size(); ++i) {
+        ss << (i > 0 ? "," : "")
+           << "{\"relay\":\"" << clusters[i].relay << "\","
+           << "\"members\":" << clusters[i].members.size() + 1 << ","
+           << "\"bytes_sent\":" << clusters[i].bytesSent << ","
+           << "\"bytes_fanned_out\":" << clusters[i].bytesFannedOut << "}";
+    }
+    ss << "],";
     return ss.str();
 }
 
 std::string DCFConnection::GetFullAddress() const {
+    if (transport) {
+        return transport->GetFullAddress() + "#game" + std::to_string(gameChannelID);
+    }
     return "dcf://" + std::string(client ? client->host : "unknown") + ":" + std::to_string(client ? client->port : 0);
 }
 
-void DCFConnection::Unmute() { muted = false; }
+void DCFConnection::Unmute() {
+    muted = false;
+    AnnounceGameChannel();
+}
 
 void DCFConnection::Close(bool flush) {
     if (flush) Flush(true);
-    initialized = false;
+    {
+        std::lock_guard<std::mutex> lock(workerWaitMutex);
+        initialized = false;
+    }
+    workerWaitCond.notify_all();
     if (client) {
         dcf_client_stop(client.get());
     }
@@ -5,22 +5,32 @@
 #include <string>
 #include <vector>
 #include <deque>
+#include <map>
 #include <mutex>
 #include <atomic>
 #include <system_error>
 #include <thread>
-#include <vector>
-#include <boost/lockfree/spsc_queue.hpp>  // Lock-free queue
+#include <condition_variable>
+
+#include "System/Misc/LatencyHistogram.h"
+#include "System/Threading/MPSCRingBuffer.h"
 
 #include "Connection.h"
 #include "RawPacket.h"
 #include "DCFUtils.h"
+#include "DCFRelayTree.h"
 #include <dcf_sdk/dcf_client.h>
 #include <dcf_sdk/dcf_redundancy.h>
 
 class DCFConnection : public CConnection {
 public:
     explicit DCFConnection(const std::string& configPath = "config/dcf_network.json");
+    /**
+     * @brief One game's channel on a transport shared by several games (multi-game dedicated host).
+     * Owns no client and no threads: sends go out through the transport tagged with gameID, and the
+     * transport routes incoming GAME_DATA envelopes for gameID into this channel's queue.
+     */
+    DCFConnection(DCFConnection& transport, uint32_t gameID);
     ~DCFConnection();
 
     DCFConnection(const DCFConnection&) = delete;
@@ -30,6 +40,8 @@ public:
     bool HasIncomingData() const override;
     std::shared_ptr<const RawPacket> Peek(unsigned ahead) const override;
     std::shared_ptr<const RawPacket> GetData() override;
+    /// Drains up to maxPackets queued packets into out in one call; returns the number appended.
+    size_t GetDataBatch(std::vector<std::shared_ptr<const RawPacket>>& out, size_t maxPackets);
     void DeleteBufferPacketAt(unsigned index) override;
     void Flush(const bool forced = false) override;
     bool CheckTimeout(int seconds = 0, bool initial = false) const override;
@@ -37,6 +49,21 @@ public:
     bool CanReconnect() const override;
     bool NeedsReconnect() override;
     unsigned int GetPacketQueueSize() const override;
+    /// Number of outgoing packets waiting on a send retry; a cheap congestion signal for autohosts.
+    size_t GetPendingRetryDepth() const;
+
+    using LatencySnapshot = spring::LatencyHistogram::Snapshot;
+    /// Freezes the RTT distribution for the current server frame; call once per frame from the server thread.
+    void SnapshotLatency();
+    /// RTT percentiles and jitter over all peers as of the last SnapshotLatency().
+    const LatencySnapshot& GetLatencySnapshot() const { return latencySnapshot; }
+    /// Per-peer RTT percentiles, keyed by DCF node id.
+    std::vector<std::pair<std::string, LatencySnapshot>> GetPeerLatencySnapshots() const;
+    bool IsInRTTGroup(double rtt) const { return rtt < rttThreshold; }
+    bool IsGameChannel() const { return (transport != nullptr); }
+    bool IsInitialized() const { return initialized.load(); }
+    /// True if broadcasts fan out through relay peers ("relay_fanout", host only).
+    bool IsRelayFanout() const { return (relayTree != nullptr); }
     std::string Statistics() const override;
     std::string GetFullAddress() const override;
     void Update() override;
@@ -51,13 +78,17 @@ private:
         uint64_t totalBytesReceived{0};
         uint64_t totalBytesSent{0};
         uint64_t failedSendAttempts{0};
+        uint64_t droppedPackets{0};
+        uint64_t queueFullWaits{0};
+        double workerWakeupsPerSec{0.0};
         double averageRTT{0.0};
         std::chrono::system_clock::time_point lastMetricsUpdate;
     };
 
     std::unique_ptr<DCFClient, void(*)(DCFClient*)> client;
     DCFRedundancy* redundancy;
-    boost::lockfree::spsc_queue<std::shared_ptr<const RawPacket>> msgQueue{1024};
+    // Written by all update workers, drained by the server thread only.
+    Recoil::MPSCRingBuffer<std::shared_ptr<const RawPacket>> msgQueue{RECV_QUEUE_CAPACITY};
     std::atomic<bool> initialized{false};
     std::atomic<bool> muted{true};
     std::atomic<int> lossFactor{0};
@@ -65,18 +96,114 @@ private:
     Metrics metrics;
     double rttThreshold{50.0};
 
+    /// How update workers wait for inbound data ("worker_wakeup" in dcf_network.json).
+    enum class WorkerWakeupMode { Poll, Event };
+
+    WorkerWakeupMode wakeupMode{WorkerWakeupMode::Poll};
+    std::atomic<uint64_t> workerWakeups{0};
+    uint64_t lastWorkerWakeups{0};
+    std::mutex workerWaitMutex;
+    std::condition_variable workerWaitCond;
+
+    struct PendingSend {
+        std::shared_ptr<const RawPacket> packet;
+        int attempts;
+        std::string target;  // Empty: broadcast (through the relay tree if there is one)
+    };
+
+    // Ordered send backlog; only the head is retried, which Update() does once its backoff expires
+    std::deque<PendingSend> retryBacklog;
+    std::chrono::steady_clock::time_point nextRetryTime;
+    mutable std::mutex retryMutex;
+    std::atomic<size_t> pendingRetryDepth{0};
+    std::atomic<uint64_t> abandonedSends{0};
+
+    // Per-frame coalescing of small outgoing messages, drained by Flush()
+    bool coalescePackets{false};
+    uint32_t coalesceMTU{DEFAULT_COALESCE_MTU};
+    std::mutex coalesceMutex;
+    std::vector<uint8_t> coalesceBuffer;
+    std::atomic<uint64_t> numCoalescedPackets{0};
+    std::atomic<uint64_t> numCoalescedDatagrams{0};
+
+    // Relay fan-out ("relay_fanout"): as host, broadcasts go out once per RTT cluster as sequenced
+    // envelopes; as a peer, forward envelopes to the cluster the host assigned and reorder them
+    size_t relayMinPeers{DEFAULT_RELAY_MIN_PEERS};
+    std::unique_ptr<dcf::DCFRelayTree> relayTree;  // Host only; guarded by retryMutex like the send path
+    std::vector<std::string> relayMembers;
+    uint32_t relayEpoch{0};
+    std::mutex relayMembersMutex;
+    dcf::DCFRelaySequencer relaySequencer{RELAY_MAX_HELD};
+    mutable std::mutex relaySequencerMutex;
+    std::atomic<uint64_t> numRelayForwarded{0};
+
+    // RTT distribution: one histogram over all samples plus one per peer reported by the SDK.
+    // Written on metric refresh; decayed once they hold more than the *_HISTORY_SAMPLES below, so
+    // percentiles cover the last few minutes rather than the last refresh or the whole game.
+    spring::LatencyHistogram rttHistogram;
+    std::map<std::string, std::unique_ptr<spring::LatencyHistogram>> peerRTTHistograms;
+    mutable std::mutex peerRTTMutex;
+    LatencySnapshot latencySnapshot;  // Server thread only
+
+    // Game channels ("game_id" for peers, channel constructor for hosts). A peer tags everything it
+    // sends with its game id and announces its node id; a host keeps one channel per game and sends
+    // each game's traffic only to the members that announced themselves for it
+    DCFConnection* transport{nullptr};             // Channel only
+    std::map<uint32_t, DCFConnection*> channels;   // Transport only
+    mutable std::mutex channelsMutex;
+    std::vector<std::string> channelMembers;       // Channel only
+    mutable std::mutex channelMembersMutex;
+    std::string nodeId;
+    uint32_t gameChannelID{0};
+    bool hasGameChannel{false};
+    std::atomic<uint64_t> numForeignGamePackets{0};
+
     std::vector<std::thread> updateThreads;
     static constexpr int NUM_UPDATE_THREADS = 4;  // Multi-threading for update
+    static constexpr size_t RECV_QUEUE_CAPACITY = 4096;
+    // Bounded backpressure: a worker yields this many times on a full ring before dropping the packet
+    static constexpr int RECV_QUEUE_MAX_PUSH_SPINS = 64;
+    static constexpr uint32_t DEFAULT_COALESCE_MTU = 1400;
+    // Below this many peers the host broadcasts its envelopes directly instead of via relays
+    static constexpr size_t DEFAULT_RELAY_MIN_PEERS = 32;
+    static constexpr size_t DEFAULT_RELAY_CLUSTER_SIZE = 16;
+    // Envelopes kept by the host for replay after a relay change, and held by peers waiting on a gap
+    static constexpr size_t RELAY_HISTORY_SIZE = 512;
+    static constexpr size_t RELAY_MAX_HELD = 1024;
+    // A peer is sampled once per 2s metrics refresh: 128 samples are roughly the last 2-4 minutes
+    static constexpr uint32_t PEER_RTT_HISTORY_SAMPLES = 128;
+    static constexpr uint32_t RTT_HISTORY_SAMPLES = 4096;
+    static constexpr int MAX_SEND_ATTEMPTS = 3;
+    static constexpr size_t MAX_PENDING_RETRIES = 2048;
+    static constexpr int RETRY_BACKOFF_STEP_MS = 100;
+    static constexpr int RETRY_BACKOFF_MAX_MS = 500;
+    // Event mode: upper bound a worker parks when the transport returned without data
+    static constexpr int EVENT_IDLE_WAIT_MS = 50;
 
-    void HandleIncomingMessage(const char* data, size_t length);
+    void HandleIncomingMessage(char* data, size_t length);  // Takes ownership of the malloc'ed data
+    void QueueIncomingPacket(std::shared_ptr<const RawPacket> packet);
+    void QueuePayload(const uint8_t* data, size_t length);  // Copies; splits coalesced datagrams
+    void HandleRelayEnvelope(RawPacket envelope);
+    void RebuildRelayTree();
+    std::string RelayStatistics() const;  // JSON fragment for Statistics()
+    std::error_code TransmitRelayed(const RawPacket& envelope);  // Requires retryMutex
+    void SendNow(std::shared_ptr<const RawPacket> data, const std::string& target = {});
+    std::shared_ptr<const RawPacket> WrapGameEnvelope(uint8_t envelopeID, const uint8_t* payload, size_t length) const;
+    void RouteGameEnvelope(const RawPacket& envelope);
+    void AnnounceGameChannel();
+    void AddChannelMember(const std::string& member);
+    void FlushCoalesced();  // Requires coalesceMutex
     void ProcessMetrics();
+    void DecayLatencyHistograms();
     void UpdateMetrics(const cJSON* metricsJson);
     bool ValidateConfiguration(const std::string& configPath);
     void InitializeClient(const std::string& configPath);
     void LogMetrics() const;
-    std::error_code SendWithRetry(const RawPacket& data, int maxRetries = 3);
+    std::error_code TrySend(const RawPacket& data, const char* target = "broadcast");
+    void ProcessRetries();
+    static bool IsRetryable(const std::error_code& ec);
+    static std::chrono::steady_clock::duration RetryBackoff(int attempt);
     void TriggerFailoverIfNeeded();
-    bool IsInRTTGroup(double rtt) const { return rtt < rttThreshold; }
     void UpdateThreadLoop();  // Worker for multi-threading
 
     static void ClientDeleter(DCFClient* client) {
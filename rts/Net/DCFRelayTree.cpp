@@ -0,0 +1,203 @@
+#include "DCFRelayTree.h"
+#include "DCFUtils.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace dcf {
+
+namespace {
+    void PutU16(std::vector<uint8_t>& buf, size_t pos, uint16_t v) { std::memcpy(buf.data() + pos, &v, sizeof(v)); }
+    void PutU32(std::vector<uint8_t>& buf, size_t pos, uint32_t v) { std::memcpy(buf.data() + pos, &v, sizeof(v)); }
+    uint16_t GetU16(const uint8_t* p) { uint16_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+    uint32_t GetU32(const uint8_t* p) { uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+
+    // Serial number arithmetic so the sequence may wrap
+    bool SeqLess(uint32_t a, uint32_t b) { return static_cast<int32_t>(a - b) < 0; }
+}
+
+DCFRelayTree::DCFRelayTree(double rttThreshold, size_t maxClusterSize, size_t historySize)
+    : rttThreshold(rttThreshold), maxClusterSize(std::max<size_t>(maxClusterSize, 1)), historySize(historySize) {}
+
+bool DCFRelayTree::Rebuild(std::vector<std::pair<std::string, float>> peers, const SendFunc& send) {
+    std::sort(peers.begin(), peers.end(), [](const auto& a, const auto& b) { return a.second < b.second; });
+
+    std::vector<Cluster> layout;
+    float clusterMinRTT = 0.0f;
+    for (const auto& peer : peers) {
+        const bool split = layout.empty()
+            || (peer.second - clusterMinRTT) >= rttThreshold
+            || (layout.back().members.size() + 1) >= maxClusterSize;
+        if (split) {
+            layout.push_back({peer.first, {}});
+            clusterMinRTT = peer.second;
+            continue;
+        }
+        layout.back().members.push_back(peer.first);
+    }
+
+    const auto sameLayout = [](const Cluster& a, const Cluster& b) { return a.relay == b.relay && a.members == b.members; };
+    if (layout.size() == clusters.size() && std::equal(layout.begin(), layout.end(), clusters.begin(), sameLayout)) {
+        return false;
+    }
+
+    epoch++;
+
+    // Keep the counters of clusters that survived unchanged, retire the rest
+    for (Cluster& cluster : layout) {
+        const auto it = std::find_if(clusters.begin(), clusters.end(), [&](const Cluster& old) { return sameLayout(old, cluster); });
+        if (it != clusters.end()) {
+            cluster.bytesSent = it->bytesSent;
+            cluster.bytesFannedOut = it->bytesFannedOut;
+            it->relay.clear();  // Claimed
+        }
+    }
+    for (const Cluster& old : clusters) {
+        if (old.relay.empty())
+            continue;
+        retiredBytesSent += old.bytesSent;
+        retiredBytesFannedOut += old.bytesFannedOut;
+        // A relay that lost its role must stop forwarding, unless it is a relay again below
+        const bool stillRelay = std::any_of(layout.begin(), layout.end(), [&](const Cluster& c) { return c.relay == old.relay; });
+        if (!stillRelay) {
+            Announce(old.relay, {}, send);
+        }
+    }
+
+    for (const Cluster& cluster : layout) {
+        if (cluster.bytesSent != 0 || cluster.bytesFannedOut != 0)
+            continue;  // Unchanged cluster, nothing to announce or replay
+        Announce(cluster.relay, cluster.members, send);
+        // Members may have missed envelopes while their old relay was failing; receivers drop what they already have
+        for (const auto& envelope : history) {
+            send(*envelope, cluster.relay);
+        }
+    }
+
+    clusters = std::move(layout);
+    DCF_LOG(DCFLogLevel::INFO, "Relay tree epoch " + std::to_string(epoch) + ": " + std::to_string(peers.size()) + " peers in " + std::to_string(clusters.size()) + " clusters");
+    return true;
+}
+
+void DCFRelayTree::Announce(const std::string& relay, const std::vector<std::string>& members, const SendFunc& send) const {
+    if (!send(*MakeAssign(epoch, members), relay)) {
+        DCF_LOG(DCFLogLevel::WARNING, "Failed to announce relay cluster to " + relay);
+    }
+}
+
+std::shared_ptr<const netcode::RawPacket> DCFRelayTree::Wrap(const netcode::RawPacket& payload) {
+    std::vector<uint8_t> buf(RELAY_DATA_HEADER_SIZE + payload.length);
+    buf[0] = RELAY_DATA;
+    PutU16(buf, 1, static_cast<uint16_t>(std::min<size_t>(buf.size(), UINT16_MAX)));
+    PutU32(buf, 3, nextSeq++);
+    std::memcpy(buf.data() + RELAY_DATA_HEADER_SIZE, payload.data, payload.length);
+
+    auto envelope = std::make_shared<const netcode::RawPacket>(buf.data(), static_cast<uint32_t>(buf.size()));
+    if (historySize > 0) {
+        if (history.size() >= historySize)
+            history.pop_front();
+        history.push_back(envelope);
+    }
+    return envelope;
+}
+
+bool DCFRelayTree::Send(const netcode::RawPacket& envelope, const SendFunc& send) {
+    bool allSent = true;
+    for (Cluster& cluster : clusters) {
+        if (!send(envelope, cluster.relay)) {
+            allSent = false;
+            continue;
+        }
+        cluster.bytesSent += envelope.length;
+        cluster.bytesFannedOut += static_cast<uint64_t>(envelope.length - RELAY_DATA_HEADER_SIZE) * (cluster.members.size() + 1);
+    }
+    return allSent;
+}
+
+std::pair<uint64_t, uint64_t> DCFRelayTree::GetTotals() const {
+    std::pair<uint64_t, uint64_t> totals = {retiredBytesSent, retiredBytesFannedOut};
+    for (const Cluster& cluster : clusters) {
+        totals.first += cluster.bytesSent;
+        totals.second += cluster.bytesFannedOut;
+    }
+    return totals;
+}
+
+std::shared_ptr<const netcode::RawPacket> DCFRelayTree::MakeAssign(uint32_t epoch, const std::vector<std::string>& members) {
+    std::vector<uint8_t> buf(8);
+    buf[0] = RELAY_ASSIGN;
+    PutU32(buf, 3, epoch);
+    buf[7] = static_cast<uint8_t>(std::min<size_t>(members.size(), UINT8_MAX));
+    for (size_t i = 0; i < buf[7]; ++i) {
+        const size_t len = std::min<size_t>(members[i].size(), UINT8_MAX);
+        buf.push_back(static_cast<uint8_t>(len));
+        buf.insert(buf.end(), members[i].begin(), members[i].begin() + len);
+    }
+    PutU16(buf, 1, static_cast<uint16_t>(buf.size()));
+    return std::make_shared<const netcode::RawPacket>(buf.data(), static_cast<uint32_t>(buf.size()));
+}
+
+bool DCFRelayTree::ParseAssign(const uint8_t* data, size_t length, uint32_t& epoch, std::vector<std::string>& members) {
+    if (length < 8 || data[0] != RELAY_ASSIGN || GetU16(data + 1) != length)
+        return false;
+
+    epoch = GetU32(data + 3);
+    members.clear();
+    members.reserve(data[7]);
+
+    size_t pos = 8;
+    for (uint8_t i = 0; i < data[7]; ++i) {
+        if (pos >= length || pos + 1 + data[pos] > length)
+            return false;
+        members.emplace_back(reinterpret_cast<const char*>(data + pos + 1), data[pos]);
+        pos += 1 + data[pos];
+    }
+    return true;
+}
+
+bool DCFRelaySequencer::Receive(const uint8_t* envelope, size_t length, const DeliverFunc& deliver) {
+    if (length < RELAY_DATA_HEADER_SIZE || envelope[0] != RELAY_DATA || GetU16(envelope + 1) != length)
+        return false;
+
+    const uint32_t seq = GetU32(envelope + 3);
+    const uint8_t* payload = envelope + RELAY_DATA_HEADER_SIZE;
+    const size_t payloadLength = length - RELAY_DATA_HEADER_SIZE;
+
+    // Peers joining mid-game pick up the stream wherever it currently is
+    if (!started) {
+        started = true;
+        nextSeq = seq;
+    }
+    if (SeqLess(seq, nextSeq) || held.count(seq) != 0) {
+        numDuplicates++;
+        return true;
+    }
+    if (seq != nextSeq) {
+        held.emplace(seq, std::vector<uint8_t>(payload, payload + payloadLength));
+        if (held.size() > maxHeld) {
+            // The gap is not going to be filled (it fell out of the server's replay history);
+            // resume at the oldest held envelope rather than stalling the game forever
+            const auto oldest = std::min_element(held.begin(), held.end(), [](const auto& a, const auto& b) { return SeqLess(a.first, b.first); });
+            numSkipped += oldest->first - nextSeq;
+            DCF_LOG(DCFLogLevel::ERROR, "Relay stream gap of " + std::to_string(oldest->first - nextSeq) + " messages could not be recovered");
+            nextSeq = oldest->first;
+            DrainHeld(deliver);
+        }
+        return true;
+    }
+
+    deliver(payload, payloadLength);
+    nextSeq++;
+    DrainHeld(deliver);
+    return true;
+}
+
+void DCFRelaySequencer::DrainHeld(const DeliverFunc& deliver) {
+    for (auto it = held.find(nextSeq); it != held.end(); it = held.find(nextSeq)) {
+        deliver(it->second.data(), it->second.size());
+        held.erase(it);
+        nextSeq++;
+    }
+}
+
+} // namespace dcf
@@ -0,0 +1,140 @@
+#ifndef _DCF_RELAY_TREE_H
+#define _DCF_RELAY_TREE_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "System/Net/RawPacket.h"
+
+/**
+ * @file DCFRelayTree.h
+ * @brief Server-side relay fan-out for DCF broadcasts plus the receiver-side reordering it needs.
+ *
+ * With relaying enabled the server no longer sends each broadcast to every peer. Peers are
+ * grouped into clusters of similar RTT; the server sends one RELAY_DATA envelope per cluster to
+ * the cluster's relay (its lowest-RTT member), and the relay forwards the unchanged envelope to
+ * the rest of the cluster. Clusters are announced to relays with RELAY_ASSIGN envelopes.
+ *
+ * Ordering: every envelope carries one server-wide sequence number, so receivers restore the
+ * exact NETMSG order regardless of which relay (or the server directly) delivered it, and drop
+ * duplicates. When the tree is rebuilt the server replays its recent history through the new
+ * relays, so a relay that vanished mid-stream costs latency but not packets, which keeps the
+ * simulation stream identical on every client.
+ */
+
+namespace dcf {
+
+/// Envelope ids; chosen above NETMSG_LAST so they can never be mistaken for a game message.
+static constexpr uint8_t RELAY_DATA = 0xFA;    // u8 id, u16 length, u32 seq, payload
+static constexpr uint8_t RELAY_ASSIGN = 0xFB;  // u8 id, u16 length, u32 epoch, u8 count, count * (u8 len, id bytes)
+static constexpr uint32_t RELAY_DATA_HEADER_SIZE = 7;
+/// Game channel envelopes, used when one transport carries several games (see DCFConnection).
+static constexpr uint8_t GAME_DATA = 0xFE;     // u8 id, u16 length, u32 game id, payload
+static constexpr uint8_t GAME_JOIN = 0xFF;     // u8 id, u16 length, u32 game id, node id bytes
+static constexpr uint32_t GAME_HEADER_SIZE = 7;
+
+class DCFRelayTree {
+public:
+    struct Cluster {
+        std::string relay;
+        std::vector<std::string> members;  // Excluding the relay
+        uint64_t bytesSent{0};             // Bytes the server actually sent to this cluster
+        uint64_t bytesFannedOut{0};        // Bytes direct fan-out to every member would have cost
+    };
+
+    /// Callback used to put an envelope on the wire towards one node id; returns false on failure.
+    using SendFunc = std::function<bool(const netcode::RawPacket& envelope, const std::string& target)>;
+
+    DCFRelayTree(double rttThreshold, size_t maxClusterSize, size_t historySize);
+
+    /**
+     * @brief Regroups peers by RTT and announces the result to the (new and old) relays.
+     * Peers are sorted by RTT and greedily split whenever the spread inside a cluster would exceed
+     * the RTT threshold or the cluster is full. The recent history is replayed to every relay
+     * whose cluster changed.
+     * @param peers (node id, RTT in ms) for every connected peer.
+     * @return true if the layout changed.
+     */
+    bool Rebuild(std::vector<std::pair<std::string, float>> peers, const SendFunc& send);
+
+    /**
+     * @brief Wraps payload into a RELAY_DATA envelope with the next sequence number.
+     * The envelope is kept in the history ring for replays.
+     */
+    std::shared_ptr<const netcode::RawPacket> Wrap(const netcode::RawPacket& payload);
+
+    /**
+     * @brief Sends an envelope from Wrap() once per cluster.
+     * @return false if any relay could not be reached; the caller may retry the whole envelope,
+     * receivers drop the duplicates.
+     */
+    bool Send(const netcode::RawPacket& envelope, const SendFunc& send);
+
+    bool Empty() const { return clusters.empty(); }
+    const std::vector<Cluster>& GetClusters() const { return clusters; }
+    uint32_t GetEpoch() const { return epoch; }
+
+    /// @return (bytes sent by the server, bytes a direct fan-out would have sent) since startup.
+    std::pair<uint64_t, uint64_t> GetTotals() const;
+
+    static std::shared_ptr<const netcode::RawPacket> MakeAssign(uint32_t epoch, const std::vector<std::string>& members);
+    /// Parses a RELAY_ASSIGN envelope; returns false if it is malformed.
+    static bool ParseAssign(const uint8_t* data, size_t length, uint32_t& epoch, std::vector<std::string>& members);
+
+private:
+    void Announce(const std::string& relay, const std::vector<std::string>& members, const SendFunc& send) const;
+
+    double rttThreshold;
+    size_t maxClusterSize;
+    size_t historySize;
+
+    uint32_t nextSeq{0};
+    uint32_t epoch{0};
+    std::vector<Cluster> clusters;
+    std::deque<std::shared_ptr<const netcode::RawPacket>> history;
+
+    // Totals of clusters that were dissolved by a rebuild
+    uint64_t retiredBytesSent{0};
+    uint64_t retiredBytesFannedOut{0};
+};
+
+/**
+ * @class DCFRelaySequencer
+ * @brief Receiver side: releases RELAY_DATA payloads strictly in sequence order.
+ */
+class DCFRelaySequencer {
+public:
+    using DeliverFunc = std::function<void(const uint8_t* payload, size_t length)>;
+
+    explicit DCFRelaySequencer(size_t maxHeld) : maxHeld(maxHeld) {}
+
+    /**
+     * @brief Accepts one envelope; delivers it and any held successors if it is the next in line.
+     * @return false if the envelope was malformed.
+     */
+    bool Receive(const uint8_t* envelope, size_t length, const DeliverFunc& deliver);
+
+    uint64_t GetNumDuplicates() const { return numDuplicates; }
+    /// Sequence numbers given up on because too many later envelopes were waiting.
+    uint64_t GetNumSkipped() const { return numSkipped; }
+
+private:
+    void DrainHeld(const DeliverFunc& deliver);
+
+    size_t maxHeld;
+    bool started{false};
+    uint32_t nextSeq{0};
+    std::map<uint32_t, std::vector<uint8_t>> held;
+    uint64_t numDuplicates{0};
+    uint64_t numSkipped{0};
+};
+
+} // namespace dcf
+
+#endif // _DCF_RELAY_TREE_H
@@ -1,11 +1,21 @@
 #ifndef _DCF_UTILS_H
 #define _DCF_UTILS_H
 
-#include <string>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
 #include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
 #include <spdlog/spdlog.h>  // Structured logging dependency
+#include <spdlog/sinks/basic_file_sink.h>
 #include "System/Log/ILog.h"
+#include "System/Threading/MPSCRingBuffer.h"
 
 namespace dcf {
 
@@ -15,9 +25,47 @@ namespace dcf {
  */
 enum class DCFLogLevel { DEBUG, INFO, WARNING, ERROR, FATAL };
 
+/**
+ * @class DCFLogRateLimiter
+ * @brief Per call-site budget of log messages per second; one instance lives at every DCF_LOG site.
+ */
+class DCFLogRateLimiter {
+public:
+    /**
+     * @brief Claims one message from the current one-second window.
+     * @param suppressed Receives the number of messages dropped in the previous window(s), if any.
+     * @return false if the message should be dropped.
+     */
+    bool Allow(uint32_t& suppressed) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t window = windowStart.load(std::memory_order_relaxed);
+        suppressed = 0;
+        if (now != window && windowStart.compare_exchange_strong(window, now, std::memory_order_relaxed)) {
+            count.store(0, std::memory_order_relaxed);
+            suppressed = dropped.exchange(0, std::memory_order_relaxed);
+        }
+        if (count.fetch_add(1, std::memory_order_relaxed) < maxPerSecond.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    static inline std::atomic<uint32_t> maxPerSecond{20};
+
+private:
+    std::atomic<int64_t> windowStart{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> dropped{0};
+};
+
 /**
  * @class DCFLogger
  * @brief Logger class integrating with spdlog and engine's ILog for structured, configurable logging.
+ *
+ * Messages are formatted once into fixed-size records on the calling thread and pushed to a
+ * bounded lock-free ring; a background thread drains the ring into spdlog and ILog, so a hot
+ * path never waits on log I/O. FATAL messages are written synchronously.
  */
 class DCFLogger {
 public:
@@ -27,47 +75,142 @@ public:
      * @param message Message to log.
      * @param file Source file.
      * @param line Source line.
+     * @param suppressed Number of earlier messages from this site dropped by rate limiting.
      */
-    static void Log(DCFLogLevel level, const std::string& message, const char* file, int line) {
-        std::stringstream ss;
-        ss << "[DCF][" << GetTimestamp() << "] " << file << ":" << line << " - " << message;
-        spdlog::log(static_cast<spdlog::level::level_enum>(static_cast<int>(level)), ss.str());
-        // Map to engine's ILog for compatibility
-        switch (level) {
-            case DCFLogLevel::DEBUG:   LOG_L(L_DEBUG,   "%s", ss.str().c_str()); break;
-            case DCFLogLevel::INFO:    LOG_L(L_INFO,    "%s", ss.str().c_str()); break;
-            case DCFLogLevel::WARNING: LOG_L(L_WARNING, "%s", ss.str().c_str()); break;
-            case DCFLogLevel::ERROR:   LOG_L(L_ERROR,   "%s", ss.str().c_str()); break;
-            case DCFLogLevel::FATAL:   LOG_L(L_FATAL,   "%s", ss.str().c_str()); break;
+    static void Log(DCFLogLevel level, const std::string& message, const char* file, int line, uint32_t suppressed = 0) {
+        Record rec;
+        rec.level = level;
+        rec.length = FormatRecord(rec.text, sizeof(rec.text), message, file, line, suppressed);
+
+        if (level == DCFLogLevel::FATAL) {
+            Write(rec);
+            return;
+        }
+
+        Backend& backend = GetBackend();
+        if (!backend.ring.Push(rec)) {
+            backend.numDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
         }
+        backend.cond.notify_one();
     }
 
     /**
      * @brief Configures the logger with file and level from config.
      * @param logFile Path to log file.
      * @param level Initial log level.
+     * @param maxPerSitePerSecond Rate limit applied to every DCF_LOG call site.
      */
-    static void Configure(const std::string& logFile, DCFLogLevel level) {
+    static void Configure(const std::string& logFile, DCFLogLevel level, uint32_t maxPerSitePerSecond = 20) {
         spdlog::set_level(static_cast<spdlog::level::level_enum>(static_cast<int>(level)));
         spdlog::set_default_logger(spdlog::basic_logger_mt("dcf", logFile));
         spdlog::set_pattern("[%Y-%m-%d %H:%M:%S.%e] [%l] %v");
+        DCFLogRateLimiter::maxPerSecond = maxPerSitePerSecond;
     }
 
+    /// @return number of records lost because the ring was full.
+    static uint64_t GetNumDropped() { return GetBackend().numDropped.load(std::memory_order_relaxed); }
+
 private:
+    static constexpr size_t RECORD_TEXT_SIZE = 480;
+    static constexpr size_t RING_CAPACITY = 1024;
+
+    struct Record {
+        DCFLogLevel level{DCFLogLevel::INFO};
+        uint32_t length{0};
+        char text[RECORD_TEXT_SIZE];
+    };
+
+    struct Backend {
+        Recoil::MPSCRingBuffer<Record> ring{RING_CAPACITY};
+        std::atomic<uint64_t> numDropped{0};
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::atomic<bool> running{true};
+        std::thread drainer;
+
+        Backend() : drainer([this]() { Drain(); }) {}
+        ~Backend() {
+            running = false;
+            cond.notify_all();
+            if (drainer.joinable())
+                drainer.join();
+        }
+
+        void Drain() {
+            Record rec;
+            while (true) {
+                while (ring.Pop(rec)) {
+                    Write(rec);
+                }
+                if (!running)
+                    break;
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait_for(lock, std::chrono::milliseconds(50));
+            }
+        }
+    };
+
+    static Backend& GetBackend() {
+        static Backend backend;
+        return backend;
+    }
+
+    static void Write(const Record& rec) {
+        spdlog::log(static_cast<spdlog::level::level_enum>(static_cast<int>(rec.level)), std::string_view(rec.text, rec.length));
+        // Map to engine's ILog for compatibility
+        switch (rec.level) {
+            case DCFLogLevel::DEBUG:   LOG_L(L_DEBUG,   "%s", rec.text); break;
+            case DCFLogLevel::INFO:    LOG_L(L_INFO,    "%s", rec.text); break;
+            case DCFLogLevel::WARNING: LOG_L(L_WARNING, "%s", rec.text); break;
+            case DCFLogLevel::ERROR:   LOG_L(L_ERROR,   "%s", rec.text); break;
+            case DCFLogLevel::FATAL:   LOG_L(L_FATAL,   "%s", rec.text); break;
+        }
+    }
+
+    /**
+     * @brief Formats "[DCF][timestamp] file:line - message" into buf, truncating if needed.
+     * @return Number of characters written, excluding the terminator.
+     */
+    static uint32_t FormatRecord(char* buf, size_t size, const std::string& message, const char* file, int line, uint32_t suppressed) {
+        int n = 0;
+        if (suppressed > 0) {
+            n = snprintf(buf, size, "[DCF][%s] %s:%d - %s (%u similar messages suppressed)", GetTimestamp(), file, line, message.c_str(), suppressed);
+        } else {
+            n = snprintf(buf, size, "[DCF][%s] %s:%d - %s", GetTimestamp(), file, line, message.c_str());
+        }
+        return static_cast<uint32_t>(std::clamp(n, 0, static_cast<int>(size) - 1));
+    }
+
     /**
-     * @brief Gets current timestamp as string.
+     * @brief Gets current timestamp as string, re-formatted at most once per second per thread.
      * @return Formatted timestamp.
      */
-    static std::string GetTimestamp() {
-        auto now = std::chrono::system_clock::now();
-        auto time = std::chrono::system_clock::to_time_t(now);
-        char buffer[32];
-        strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", gmtime(&time));
+    static const char* GetTimestamp() {
+        thread_local std::time_t cachedTime = 0;
+        thread_local char buffer[32] = {0};
+        const std::time_t time = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        if (time != cachedTime) {
+            cachedTime = time;
+            std::tm tm;
+#ifdef _WIN32
+            gmtime_s(&tm, &time);
+#else
+            gmtime_r(&time, &tm);
+#endif
+            strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+        }
         return buffer;
     }
 };
 
-#define DCF_LOG(level, message) dcf::DCFLogger::Log(level, message, __FILE__, __LINE__)
+#define DCF_LOG(level, message)                                                  \
+    do {                                                                         \
+        static dcf::DCFLogRateLimiter dcfLogSiteLimiter_;                        \
+        uint32_t dcfLogSuppressed_ = 0;                                          \
+        if (dcfLogSiteLimiter_.Allow(dcfLogSuppressed_))                         \
+            dcf::DCFLogger::Log(level, message, __FILE__, __LINE__, dcfLogSuppressed_); \
+    } while (false)
 
 /**
  * @class DCFError
@@ -23,7 +23,22 @@ GameParticipant::~GameParticipant()
 void GameParticipant::SendData(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	if (clientLink != nullptr && myState != GameParticipant::State::DISCONNECTING)
-		clientLink->SendData(packet);
+		sendQueue.Push(std::move(packet));
+}
+
+void GameParticipant::FlushSendQueue(spring_time now)
+{
+	if (clientLink != nullptr && myState != GameParticipant::State::DISCONNECTING)
+		sendQueue.Flush(*clientLink, now);
+}
+
+void GameParticipant::DrainSendQueue()
+{
+	if (clientLink == nullptr || myState == GameParticipant::State::DISCONNECTING)
+		return;
+
+	sendQueue.Drain(*clientLink);
+	clientLink->Flush(true);
 }
 
 void GameParticipant::Connected(std::shared_ptr<netcode::CConnection> _link, bool local)
@@ -33,6 +48,10 @@ void GameParticipant::Connected(std::shared_ptr<netcode::CConnection> _link, boo
 	clientLink = _link;
 	aiClientLinks[MAX_AIS].link.reset(new netcode::CLoopbackConnection());
 
+	// local clients have no link to protect
+	sendQueue.Clear();
+	sendQueue.SetPaced(!local);
+
 	isLocal = local;
 	myState = CONNECTED;
 	lastFrameResponse = 0;
@@ -44,7 +63,11 @@ void GameParticipant::Kill(const std::string& reason, const bool flush)
 
 	if (clientLink != nullptr) {
 		if (myState != GameParticipant::State::DISCONNECTING) {
+			// nothing still queued matters to a client being kicked
+			sendQueue.Clear();
 			clientLink->SendData(CBaseNetProtocol::Get().SendQuit(reason));
+			// Close(false) drops whatever the link has not sent yet
+			clientLink->Flush(true);
 
 			if (flush) {
 				/* delay to make sure the Flush() performed by Close()
@@ -60,9 +83,6 @@ void GameParticipant::Kill(const std::string& reason, const bool flush)
 	}
 
 	aiClientLinks[MAX_AIS].link.reset();
-#ifdef SYNCCHECK
-	syncResponse.clear();
-#endif
 
 	myState = (disconnected) ? DISCONNECTED : DISCONNECTING;
 }
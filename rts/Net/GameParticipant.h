@@ -5,6 +5,7 @@
 
 #include <memory>
 
+#include "ClientSendQueue.h"
 #include "Game/Players/PlayerBase.h"
 #include "Game/Players/PlayerStatistics.h"
 #include "System/Net/LoopbackConnection.h"
@@ -23,7 +24,11 @@ public:
 	GameParticipant();
 	~GameParticipant();
 
+	/// queues <packet>; it goes out on the next FlushSendQueue, paced to the link
 	void SendData(std::shared_ptr<const netcode::RawPacket> packet);
+	void FlushSendQueue(spring_time now);
+	/// sends everything still queued, unpaced, and flushes the link
+	void DrainSendQueue();
 	void Connected(std::shared_ptr<netcode::CConnection> link, bool local);
 	void Kill(const std::string& reason, const bool flush = false);
 
@@ -47,6 +52,12 @@ public:
 	bool isLocal = false;
 	bool isReconn = false;
 	bool isMidgameJoin = false;
+	/// held back by the server until a snapshot for it is available
+	bool awaitingSnapshot = false;
+	/// frame of the snapshot this client joined from, until its sync has been verified
+	int snapshotFrame = -1;
+	/// server frame when this client started replaying the packet cache, until it answered a sync check for it
+	int catchUpFrame = -1;
 
 	PlayerStatistics lastStats;
 
@@ -65,12 +76,9 @@ public:
 	};
 
 	std::shared_ptr<netcode::CConnection> clientLink;
+	ClientSendQueue sendQueue;
 	spring::unordered_map<uint8_t, ClientLinkData> aiClientLinks;
 
-	#ifdef SYNCCHECK
-	spring::unordered_map<int, unsigned int> syncResponse; // syncResponse[frameNum] = checksum
-	#endif
-
 private:
 	void CloseConnection(bool flush);
 };
@@ -8,6 +8,7 @@
  */
 
 #include "GameServer.h"
+#include "GameServerHost.h"
 
 #include "GameParticipant.h"
 #include "GameSkirmishAI.h"
@@ -37,6 +38,7 @@
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Net/Connection.h"
 #include "System/Net/LocalConnection.h"
+#include "System/Net/PacketBufferPool.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/LoadSave/DemoReader.h"
@@ -55,6 +57,9 @@
 #include <map>
 #endif
 
+#include <algorithm>
+#include <limits>
+
 #define ALLOW_DEMO_GODMODE
 
 // Logging section
@@ -67,6 +72,7 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_GAMESERVER)
 
 // Configuration
 CONFIG(int, AutohostPort).defaultValue(0).description("Port for autohost interface connections.");
+CONFIG(int, UDPListenerSockets).defaultValue(1).minimumValue(1).maximumValue(16).description("Sockets (each with its own receive thread) the UDP fallback listener spreads clients over; more than 1 needs SO_REUSEPORT.");
 CONFIG(int, ServerSleepTime).defaultValue(5).description("Milliseconds to sleep per server tick.");
 CONFIG(int, SpeedControl).defaultValue(1).minimumValue(1).maximumValue(2).description("1: use average player load, 2: use highest load.");
 CONFIG(bool, AllowSpectatorJoin).defaultValue(true).dedicatedValue(false).description("Allow unauthenticated spectator joins with ~ prefix.");
@@ -75,11 +81,19 @@ CONFIG(bool, ServerRecordDemos).defaultValue(false).dedicatedValue(true);
 CONFIG(bool, ServerLogInfoMessages).defaultValue(false);
 CONFIG(bool, ServerLogDebugMessages).defaultValue(false);
 CONFIG(std::string, AutohostIP).defaultValue("127.0.0.1");
+CONFIG(bool, ServerSnapshotJoin).defaultValue(true).description("Let mid-game joiners load a sim snapshot taken by a connected client instead of simulating the whole game since its start.");
+CONFIG(int, ServerSnapshotJoinMinFrame).defaultValue(GAME_SPEED * 60 * 3).minimumValue(0).description("Joiners arriving before this frame replay the game from the start, which is cheaper than a snapshot early on.");
 
 // Constants
 static constexpr unsigned SYNCCHECK_TIMEOUT = 300;
 static constexpr unsigned SYNCCHECK_MSG_TIMEOUT = 400;
 static constexpr int serverKeyframeInterval = 16;
+static constexpr size_t PACKET_BATCH_SIZE = 64;
+static constexpr size_t MAX_PACKETS_PER_UPDATE = 4096;
+
+// map-drawing primitives a player may send per second, and in one burst
+static constexpr uint32_t MAPDRAW_RATE = 100;
+static constexpr uint32_t MAPDRAW_BURST = 400;
 
 // Global instance
 CGameServer* gameServer = nullptr;
@@ -95,7 +109,9 @@ std::array<std::string, 26> CGameServer::commandBlacklist = {{
 CGameServer::CGameServer(
 	const std::shared_ptr<const ClientSetup> newClientSetup,
 	const std::shared_ptr<const GameData> newGameData,
-	const std::shared_ptr<const CGameSetup> newGameSetup
+	const std::shared_ptr<const CGameSetup> newGameSetup,
+	CGameServerHost* newHost,
+	uint32_t newHostedGameID
 )
 	: myClientSetup(newClientSetup)
 	, myGameData(newGameData)
@@ -111,9 +127,6 @@ CGameServer::CGameServer(
 	, rejectedConnections{}
 	, refClientVersion{"", ""}
 	, packetCache{}
-#ifdef SYNCCHECK
-	, outstandingSyncFrames{}
-#endif
 	, serverStartTime(spring_gettime())
 	, readyTime(spring_notime)
 	, lastNewFrameTick(spring_notime)
@@ -158,17 +171,24 @@ CGameServer::CGameServer(
 	, reloadingServer{false}
 	, quitServer{false}
 	, gameID{0}
+	, host(newHost)
+	, hostedGameID(newHostedGameID)
 {
 	// Initialize DCF networking
-	try {
-		dcfConnection = std::make_unique<DCFConnection>("config/dcf_network.json");
-		if (!dcfConnection->initialized) {
-			LOG_L(L_WARNING, "[%s] DCF init failed, falling back to UDP", __func__);
-			udpListener = std::make_unique<netcode::UDPListener>(myClientSetup->hostPort);
+	if (host != nullptr && host->GetTransport() != nullptr) {
+		// our own channel on the transport all hosted games share
+		dcfConnection = std::make_unique<DCFConnection>(*host->GetTransport(), hostedGameID);
+	} else {
+		try {
+			dcfConnection = std::make_unique<DCFConnection>("config/dcf_network.json");
+			if (!dcfConnection->initialized) {
+				LOG_L(L_WARNING, "[%s] DCF init failed, falling back to UDP", __func__);
+				udpListener = std::make_unique<netcode::UDPListener>(myClientSetup->hostPort, "", configHandler->GetInt("UDPListenerSockets"));
+			}
+		} catch (const std::exception& e) {
+			LOG_L(L_ERROR, "[%s] DCF setup error: %s, falling back to UDP", __func__, e.what());
+			udpListener = std::make_unique<netcode::UDPListener>(myClientSetup->hostPort, "", configHandler->GetInt("UDPListenerSockets"));
 		}
-	} catch (const std::exception& e) {
-		LOG_L(L_ERROR, "[%s] DCF setup error: %s, falling back to UDP", __func__, e.what());
-		udpListener = std::make_unique<netcode::UDPListener>(myClientSetup->hostPort);
 	}
 
 	// Initialize configuration
@@ -178,6 +198,8 @@ CGameServer::CGameServer(
 	configHandler->GetValueSafe(whiteListAdditionalPlayers, "WhiteListAdditionalPlayers");
 	configHandler->GetValueSafe(logInfoMessages, "ServerLogInfoMessages");
 	configHandler->GetValueSafe(logDebugMessages, "ServerLogDebugMessages");
+	configHandler->GetValueSafe(snapshotJoin, "ServerSnapshotJoin");
+	configHandler->GetValueSafe(snapshotJoinMinFrame, "ServerSnapshotJoinMinFrame");
 
 	// Initialize demo recorder
 	if (configHandler->GetBool("ServerRecordDemos")) {
@@ -190,8 +212,9 @@ CGameServer::CGameServer(
 	}
 	std::reverse(freeSkirmishAIs.begin(), freeSkirmishAIs.end());
 
-	// Start server thread
-	thread = spring::thread(&CGameServer::UpdateLoop, this);
+	// Start server thread, hosted games are ticked by the host
+	if (host == nullptr)
+		thread = spring::thread(&CGameServer::UpdateLoop, this);
 }
 
 CGameServer::~CGameServer() {
@@ -208,14 +231,20 @@ CGameServer::~CGameServer() {
 
 void CGameServer::UpdateLoop() {
 	while (!quitServer) {
-		{
-			std::lock_guard<spring::recursive_mutex> lk(gameServerMutex);
-			Update();
-		}
+		Tick();
 		spring::thread::sleep_for(std::chrono::milliseconds(loopSleepTime));
 	}
 }
 
+void CGameServer::Tick() {
+	std::lock_guard<spring::recursive_mutex> lk(gameServerMutex);
+	Update();
+}
+
+bool CGameServer::HasFinished() const {
+	return quitServer;
+}
+
 void CGameServer::Initialize() {
 	if (dcfConnection && dcfConnection->initialized) {
 		dcfConnection->Update();
@@ -228,10 +257,11 @@ void CGameServer::Initialize() {
 	serverFrameNum = 0;
 	startTime = modGameTime;
 	AddLocalClient(myClientSetup->myPlayerName, myClientSetup->myVersion);
-	if (configHandler->GetInt("AutohostPort") != 0) {
+	// per game; the config value is shared by every game in the process
+	if (myClientSetup->autohostPort != 0) {
 		hostif = std::make_unique<AutohostInterface>(
-			configHandler->GetString("AutohostIP"),
-			configHandler->GetInt("AutohostPort")
+			myClientSetup->autohostIP,
+			myClientSetup->autohostPort
 		);
 	}
 }
@@ -249,7 +279,7 @@ void CGameServer::ServerMessage(const std::shared_ptr<const netcode::RawPacket>&
 	switch (packetCode) {
 		case NETMSG_SYNCRESPONSE: {
 			if (dcfConnection) {
-				double rtt = dcfConnection->metrics.averageRTT;
+				const double rtt = dcfConnection->GetLatencySnapshot().p95;
 				if (!dcfConnection->IsInRTTGroup(rtt)) {
 					InternalSpeedChange(userSpeedFactor * 0.8f);
 					DCF_LOG(dcf::DCFLogLevel::INFO, "Adjusted speed due to RTT: " + std::to_string(rtt));
@@ -263,11 +293,7 @@ void CGameServer::ServerMessage(const std::shared_ptr<const netcode::RawPacket>&
 			break;
 		}
 		case NETMSG_CREATE_NEWPLAYER: {
-			if (dcfConnection) {
-				dcfConnection->SendData(packet);
-			} else {
-				Broadcast(packet);
-			}
+			Broadcast(packet);
 			AddAdditionalUser(inbuf, dataLength);
 			break;
 		}
@@ -286,6 +312,24 @@ void CGameServer::ServerMessage(const std::shared_ptr<const netcode::RawPacket>&
 			DumpState(inbuf, dataLength);
 			break;
 		}
+		case NETMSG_SNAPSHOT_CHUNK: {
+			// only ever forwarded to the joiners waiting for it
+			switch (snapshot.AddChunk(packet)) {
+				case GameSnapshot::CHUNK_COMPLETE: {
+					Message(spring::format(" -> Snapshot of frame %d received (%u KiB)", snapshot.GetFrameNum(), unsigned(snapshot.GetTotalSize() / 1024)));
+				} break;
+				case GameSnapshot::CHUNK_FAILED: {
+					CancelSnapshotJoins("snapshot transfer failed");
+				} break;
+				default: {
+				} break;
+			}
+			break;
+		}
+		case NETMSG_SNAPSHOT_REQUEST: {
+			// issued by the server only
+			break;
+		}
 		case NETMSG_CHAT: {
 			try {
 				ChatMessage msg(packet);
@@ -295,6 +339,19 @@ void CGameServer::ServerMessage(const std::shared_ptr<const netcode::RawPacket>&
 			}
 			break;
 		}
+		case NETMSG_MAPDRAW: {
+			// rate shaped per player, clients do not need to see a flood of drawings
+			if (dataLength < 4 || inbuf[2] >= MAX_PLAYERS)
+				break;
+			if (!ShapeMapDraw(inbuf[2], MapDrawCost(inbuf, dataLength), spring_gettime()))
+				break;
+
+			if (dcfConnection) {
+				dcfConnection->AddTraffic(-1, packetCode, dataLength);
+			}
+			Broadcast(packet);
+			break;
+		}
 		case NETMSG_PAUSE: {
 			try {
 				netcode::UnpackPacket pckt(packet->data, packet->length);
@@ -311,11 +368,7 @@ void CGameServer::ServerMessage(const std::shared_ptr<const netcode::RawPacket>&
 			if (dcfConnection) {
 				dcfConnection->AddTraffic(-1, packetCode, dataLength);
 			}
-			if (dcfConnection) {
-				dcfConnection->SendData(packet);
-			} else {
-				Broadcast(packet);
-			}
+			Broadcast(packet);
 			break;
 		}
 	}
@@ -326,12 +379,19 @@ void CGameServer::Update() {
 
 	if (dcfConnection && dcfConnection->initialized) {
 		dcfConnection->Update();
-		while (dcfConnection->HasIncomingData()) {
-			auto pkt = dcfConnection->GetData();
-			if (pkt) {
+
+		// drain in bounded batches so a command burst cannot stall the frame
+		static std::vector<std::shared_ptr<const netcode::RawPacket>> inPackets;
+		for (size_t n = 0; n < MAX_PACKETS_PER_UPDATE; n += inPackets.size()) {
+			inPackets.clear();
+			if (dcfConnection->GetDataBatch(inPackets, PACKET_BATCH_SIZE) == 0)
+				break;
+
+			for (const auto& pkt: inPackets) {
 				ServerMessage(pkt);
 			}
 		}
+		inPackets.clear();
 		if (desyncHasOccurred) {
 			dcfConnection->TriggerFailoverIfNeeded();
 			desyncHasOccurred = false;
@@ -352,8 +412,15 @@ void CGameServer::Update() {
 		CreateNewFrame(true, false);
 	}
 
+	if (gameHasStarted) {
+		CheckSync();
+	}
+
 	if (currTick - lastPlayerInfo > spring_msecs(1000)) {
 		SendClientProcUsage();
+		if (hostif != nullptr && dcfConnection) {
+			hostif->SendNetLatency(dcfConnection->GetLatencySnapshot(), dcfConnection->GetPendingRetryDepth());
+		}
 		lastPlayerInfo = currTick;
 	}
 
@@ -362,46 +429,102 @@ void CGameServer::Update() {
 		lastBandwidthUpdate = currTick;
 	}
 
+	UpdateSnapshotJoins(currTick);
+
+	if (hostif != nullptr) {
+		for (std::vector<std::uint8_t> msg = hostif->GetChatMessage(); !msg.empty(); msg = hostif->GetChatMessage()) {
+			AutohostMessage(std::string(msg.begin(), msg.end()));
+		}
+	}
+
+	// per-client pacing: a weak link delays its own client instead of the game
+	for (GameParticipant& player : players) {
+		player.FlushSendQueue(currTick);
+	}
+
+	// push out whatever was coalesced during this tick
+	if (dcfConnection && dcfConnection->initialized) {
+		dcfConnection->Flush(false);
+	}
+
+	// one autohost batch per update in binary framing
+	if (hostif != nullptr) {
+		hostif->Flush(serverFrameNum);
+	}
+
 	if (CheckForGameEnd()) {
 		QuitGame();
 	}
 }
 
 void CGameServer::CheckSync() {
+	int syncTimeout = SYNCCHECK_TIMEOUT;
+
 	if (dcfConnection) {
-		double rtt = dcfConnection->metrics.averageRTT;
+		// tail latency decides whether slow sync responses are still expected
+		const double rtt = dcfConnection->GetLatencySnapshot().p99;
 		if (rtt > SYNCCHECK_MSG_TIMEOUT) {
 			LOG_L(L_WARNING, "[%s] High RTT (%f ms), adjusting timeout", __func__, rtt);
-			// Dynamically adjust timeout
-			int adjustedTimeout = SYNCCHECK_TIMEOUT + static_cast<int>(rtt / 10);
-			// Update sync logic with adjustedTimeout
+			syncTimeout += static_cast<int>(rtt / 10);
 		}
 	}
 
 #ifdef SYNCCHECK
-	for (const auto& p : outstandingSyncFrames) {
-		if (serverFrameNum - p.first > SYNCCHECK_TIMEOUT) {
-			syncWarningFrame = p.first;
-			DCF_LOG(dcf::DCFLogLevel::WARNING, "Sync timeout for frame " + std::to_string(p.first));
-			desyncHasOccurred = true;
+	unsigned numExpected = 0;
+
+	for (const GameParticipant& p : players) {
+		// joiners still replaying only answer for frames that were settled long ago
+		numExpected += (p.myState == GameParticipant::INGAME && !p.awaitingSnapshot && p.catchUpFrame < 0);
+	}
+
+	const int lastTimedOutFrame = syncChecksums.GetLastTimedOutFrame();
+
+	// frames everybody agreed on are settled inside the ring, only divergent ones come back
+	syncDivergences.clear();
+	syncChecksums.Update(serverFrameNum, numExpected, syncTimeout, syncDivergences);
+
+	if (syncChecksums.GetLastTimedOutFrame() != lastTimedOutFrame) {
+		syncWarningFrame = syncChecksums.GetLastTimedOutFrame();
+		DCF_LOG(dcf::DCFLogLevel::WARNING, "Sync timeout for frame " + std::to_string(syncWarningFrame));
+		desyncHasOccurred = true;
+	}
+
+	for (const SyncChecksumRing::Divergence& d : syncDivergences) {
+		for (const auto& p : d.desynced) {
+			Message(spring::format("Sync error for %s in frame %d (got %x, correct is %x)", players[p.first].name.c_str(), d.frameNum, p.second, d.checksum));
 		}
+
+		syncErrorFrame = d.frameNum;
+		desyncHasOccurred = true;
+
+		if (syncDumpFrame >= 0)
+			continue;
+
+		// have every client write out its state for the first frame that diverged
+		syncDumpFrame = d.frameNum;
+		Broadcast(CBaseNetProtocol::Get().SendGameStateDump(d.frameNum));
 	}
 #endif
 }
 
 void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime) {
 	serverFrameNum++;
+	netcode::PacketBufferPool::EndFrame();
+
+	if (dcfConnection) {
+		dcfConnection->SnapshotLatency();
+	}
 	const spring_time currTick = spring_gettime();
 	const float deltaTime = (currTick - lastNewFrameTick).toSecsf();
 	lastNewFrameTick = currTick;
 
 	if (serverFrameNum % serverKeyframeInterval == 0) {
 		std::shared_ptr<const RawPacket> keyFrame = CBaseNetProtocol::Get().SendKeyFrame(serverFrameNum);
-		if (dcfConnection) {
-			dcfConnection->SendData(keyFrame);
-		} else {
-			Broadcast(keyFrame);
-		}
+		Broadcast(keyFrame);
+
+		// joiners loading this snapshot resume with whatever follows its keyframe
+		if (snapshot.IsPending() && snapshot.GetFrameNum() == serverFrameNum)
+			snapshot.SetCacheIndex(packetCache.size());
 	}
 
 	modGameTime += deltaTime * internalSpeed;
@@ -418,11 +541,7 @@ void CGameServer::GotChatMessage(const ChatMessage& msg) {
 	}
 
 	std::shared_ptr<const RawPacket> packet(msg.Pack());
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 
 	if (hostif != nullptr && msg.fromPlayer >= 0 && msg.fromPlayer != SERVER_PLAYER) {
 		hostif->SendPlayerChat(msg.fromPlayer, msg.destination, msg.msg);
@@ -436,11 +555,7 @@ void CGameServer::InternalSpeedChange(float newSpeed) {
 
 	internalSpeed = newSpeed;
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendInternalSpeed(internalSpeed);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 
 	DCF_LOG(dcf::DCFLogLevel::INFO, "Internal speed changed to " + std::to_string(newSpeed));
 }
@@ -456,11 +571,7 @@ void CGameServer::UserSpeedChange(float newSpeed, int player) {
 	}
 
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendUserSpeed(player, userSpeedFactor = newSpeed);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 
 	DCF_LOG(dcf::DCFLogLevel::INFO, "User speed changed to " + std::to_string(newSpeed) + " by player " + std::to_string(player));
 }
@@ -484,7 +595,8 @@ void CGameServer::UpdateSpeedControl(int speedCtrl) {
 	}
 
 	if (dcfConnection) {
-		double rtt = dcfConnection->metrics.averageRTT;
+		// react to the slow tail rather than the mean, a few lagging peers stall everyone
+		const double rtt = dcfConnection->GetLatencySnapshot().p95;
 		if (rtt > 50.0) {
 			userSpeedFactor = std::clamp(userSpeedFactor * (50.0 / rtt), minUserSpeed, maxUserSpeed);
 			DCF_LOG(dcf::DCFLogLevel::INFO, "Adjusted userSpeedFactor to " + std::to_string(userSpeedFactor) + " due to RTT " + std::to_string(rtt));
@@ -504,6 +616,71 @@ void CGameServer::UpdateSpeedControl(int speedCtrl) {
 	}
 }
 
+uint32_t CGameServer::MapDrawCost(const unsigned char* inbuf, unsigned dataLength) {
+	// one per primitive, a polyline (x and z per point after the flags) costs one per segment
+	if (inbuf[3] != MAPDRAW_POLYLINE || dataLength < 5)
+		return 1;
+
+	return std::max(1u, ((dataLength - 5) / (2 * sizeof(uint16_t))) - 1);
+}
+
+bool CGameServer::ShapeMapDraw(unsigned playerNum, uint32_t cost, spring_time now) {
+	auto& [lastRefill, budget] = mapDrawTimings[playerNum];
+
+	if (!spring_istime(lastRefill)) {
+		lastRefill = now;
+		budget = MAPDRAW_BURST;
+	} else {
+		// token bucket, whole tokens only so no time is lost to rounding
+		const uint32_t refill = std::min<int64_t>(spring_diffmsecs(now, lastRefill) * MAPDRAW_RATE / 1000, MAPDRAW_BURST);
+
+		budget = std::min(budget + refill, MAPDRAW_BURST);
+		lastRefill = (budget == MAPDRAW_BURST)? now: (lastRefill + spring_msecs(refill * 1000 / MAPDRAW_RATE));
+	}
+
+	if (budget < cost)
+		return false;
+
+	budget -= cost;
+	return true;
+}
+
+void CGameServer::SetSimQuality(int level) {
+	level = std::clamp(level, 0, MAX_SIM_QUALITY_LEVEL);
+	if (simQualityLevel == level) {
+		return;
+	}
+
+	simQualityLevel = level;
+
+	// goes through the packet cache like any other command, demos and late joiners see it too
+	const CommandMessage msg(spring::format("simquality %d", level), SERVER_PLAYER);
+	Broadcast(std::shared_ptr<const RawPacket>(msg.Pack()));
+
+	Message(spring::format(" -> Sim quality level set to %d", level));
+}
+
+void CGameServer::AutohostMessage(const std::string& message) {
+	if (message.empty()) {
+		return;
+	}
+
+	// plain text is chat from the host, "/command args" is handled by the server
+	if (message[0] != '/') {
+		GotChatMessage(ChatMessage(SERVER_PLAYER, ChatMessage::TO_EVERYONE, message));
+		return;
+	}
+
+	const Action action(message.substr(1));
+
+	if (action.command == "simquality") {
+		SetSimQuality(std::atoi(action.extra.c_str()));
+		return;
+	}
+
+	Message(spring::format(" -> Unknown autohost command \"%s\"", action.command.c_str()));
+}
+
 void CGameServer::AddLocalClient(const std::string& name, const std::string& version) {
 	localClientNumber = AddConnection(std::make_unique<netcode::LocalConnection>(), name, version);
 }
@@ -526,11 +703,7 @@ unsigned CGameServer::AddConnection(std::unique_ptr<netcode::CConnection> conn,
 	players[playerNum].connection = std::move(conn);
 
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendPlayerName(playerNum, name);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 
 	Message(spring::format(" -> Connection established (given id %i)", playerNum));
 	return playerNum;
@@ -564,11 +737,7 @@ void CGameServer::AddAdditionalUser(const unsigned char* inbuf, unsigned dataLen
 		newPlayer.isMidgameJoin = (gameHasStarted && !newPlayer.spectator);
 
 		std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendCreateNewPlayer(playerNum, newPlayer.spectator, newPlayer.team, newPlayer.name);
-		if (dcfConnection) {
-			dcfConnection->SendData(packet);
-		} else {
-			Broadcast(packet);
-		}
+		Broadcast(packet);
 
 		if (!newPlayer.spectator) {
 			if (!teams[newPlayer.team].IsActive()) {
@@ -578,8 +747,15 @@ void CGameServer::AddAdditionalUser(const unsigned char* inbuf, unsigned dataLen
 			}
 		}
 
-		for (const std::shared_ptr<const netcode::RawPacket>& p : packetCache) {
-			newPlayer.SendData(p);
+		if (gameHasStarted && snapshotJoin && serverFrameNum >= snapshotJoinMinFrame && playerNum != localClientNumber) {
+			// hold the joiner back until it can be sent a snapshot instead of the full history
+			snapshotJoiners.push_back(playerNum);
+			newPlayer.awaitingSnapshot = true;
+
+			if (!snapshot.IsPending() && (!snapshot.IsComplete() || snapshot.IsStale(serverFrameNum)))
+				RequestSnapshot();
+		} else {
+			ReplayPacketCache(newPlayer, 0);
 		}
 
 		DCF_LOG(dcf::DCFLogLevel::INFO, "Added player " + name + " (id " + std::to_string(playerNum) + ")");
@@ -590,11 +766,7 @@ void CGameServer::AddAdditionalUser(const unsigned char* inbuf, unsigned dataLen
 
 void CGameServer::RejectConnection(unsigned playerNum, const std::string& reason) {
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendReject(playerNum, reason);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 	rejectedConnections[playerNum]++;
 	DCF_LOG(dcf::DCFLogLevel::WARNING, "Rejected connection for player " + std::to_string(playerNum) + ": " + reason);
 }
@@ -603,11 +775,7 @@ void CGameServer::SendClientProcUsage() {
 	for (const auto& player : players) {
 		if (player.second.active) {
 			std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendCpuUsage(player.second.cpuUsage);
-			if (dcfConnection) {
-				dcfConnection->SendData(packet);
-			} else {
-				Broadcast(packet);
-			}
+			Broadcast(packet);
 		}
 	}
 }
@@ -618,6 +786,23 @@ void CGameServer::CheckBandwidth() {
 	} else if (udpListener) {
 		LOG_L(L_DEBUG, "[%s] Bandwidth stats: UDP-based", __func__);
 	}
+
+	for (const GameParticipant& player : players) {
+		const ClientSendQueue& queue = player.sendQueue;
+		if (queue.GetNumDeferredFlushes() == 0)
+			continue;
+
+		LOG_L(L_DEBUG, "[%s] player %d: link %.1f KiB/s, pacing %.1f KiB/s, queued %u/%u bytes, %u deferred flushes, %u dropped",
+			__func__, player.id, queue.GetCapacityEstimate() / 1024.0f, queue.GetPacingRate() / 1024.0f,
+			unsigned(queue.GetQueuedBytes(ClientSendQueue::PRIO_ORDERED)), unsigned(queue.GetQueuedBytes(ClientSendQueue::PRIO_BULK)),
+			unsigned(queue.GetNumDeferredFlushes()), unsigned(queue.GetNumDroppedBulk()));
+	}
+
+#ifdef SYNCCHECK
+	LOG_L(L_DEBUG, "[%s] sync: %u frames settled (%u timed out, %u pending), %.3fms spent verifying",
+		__func__, unsigned(syncChecksums.GetNumSettled()), unsigned(syncChecksums.GetNumTimedOut()),
+		syncChecksums.GetNumPending(), syncChecksums.GetCpuTime().toMilliSecsf());
+#endif
 }
 
 void CGameServer::HandlePing(const unsigned char* inbuf, unsigned dataLength) {
@@ -646,6 +831,7 @@ void CGameServer::HandleGameFrameProgress(const unsigned char* inbuf, unsigned d
 		pckt >> playerNum >> frameNum;
 		if (playerNum < MAX_PLAYERS && players[playerNum].active) {
 			players[playerNum].lastFrameResponse = frameNum;
+			players[playerNum].sendQueue.OnFrameAck(frameNum, spring_gettime());
 			DCF_LOG(dcf::DCFLogLevel::DEBUG, "Frame progress from player " + std::to_string(playerNum) + ": frame " + std::to_string(frameNum));
 		}
 	} catch (const netcode::UnpackPacketException& ex) {
@@ -663,12 +849,7 @@ void CGameServer::DumpState(const unsigned char* inbuf, unsigned dataLength) {
 			demoRecorder->SaveState(frameNum);
 			DCF_LOG(dcf::DCFLogLevel::INFO, "Dumped game state for frame " + std::to_string(frameNum) + " by player " + std::to_string(playerNum));
 		}
-		if (dcfConnection) {
-			std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendGameState(frameNum);
-			dcfConnection->SendData(packet);
-		} else {
-			Broadcast(CBaseNetProtocol::Get().SendGameState(frameNum));
-		}
+		Broadcast(CBaseNetProtocol::Get().SendGameState(frameNum));
 	} catch (const netcode::UnpackPacketException& ex) {
 		DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("State dump unpack failed: ") + ex.what());
 	}
@@ -676,13 +857,23 @@ void CGameServer::DumpState(const unsigned char* inbuf, unsigned dataLength) {
 
 void CGameServer::UnpackSyncResponse(const std::shared_ptr<const netcode::RawPacket>& packet) {
 	try {
-		netcode::UnpackPacket pckt(packet->data, packet->length);
-		unsigned playerNum, frameNum;
+		netcode::UnpackPacket pckt(packet, 1);
+		uint8_t playerNum;
+		int32_t frameNum;
 		uint32_t checksum;
 		pckt >> playerNum >> frameNum >> checksum;
+		if (playerNum < players.size()) {
+			players[playerNum].sendQueue.OnFrameAck(frameNum, spring_gettime());
+		}
 #ifdef SYNCCHECK
-		outstandingSyncFrames[frameNum].insert(std::make_pair(playerNum, checksum));
-		DCF_LOG(dcf::DCFLogLevel::DEBUG, "Sync response from player " + std::to_string(playerNum) + " for frame " + std::to_string(frameNum));
+		if (playerNum == snapshot.GetDonor())
+			snapshot.AddDonorChecksum(frameNum, checksum);
+		if (playerNum < players.size() && players[playerNum].snapshotFrame >= 0)
+			VerifySnapshotJoin(playerNum, frameNum, checksum);
+		if (playerNum < players.size() && players[playerNum].catchUpFrame >= 0 && frameNum >= players[playerNum].catchUpFrame)
+			players[playerNum].catchUpFrame = -1;
+
+		syncChecksums.AddResponse(frameNum, playerNum, checksum);
 #endif
 	} catch (const netcode::UnpackPacketException& ex) {
 		DCF_LOG(dcf::DCFLogLevel::ERROR, std::string("Sync response unpack failed: ") + ex.what());
@@ -709,13 +900,170 @@ void CGameServer::FreeSkirmishAIId(uint8_t aiId) {
 }
 
 void CGameServer::Broadcast(const std::shared_ptr<const netcode::RawPacket>& packet) {
-	for (auto& player : players) {
-		if (player.second.active && player.second.connection) {
-			player.second.connection->SendData(packet);
+	// everything a (re)joining client has missed, see ReplayPacketCache
+	if (canReconnect || allowSpecJoin || !gameHasStarted) {
+		packetCache.push_back(packet);
+	}
+
+	// a relaying DCF host fans out itself, one send per packet; it can not leave out
+	// clients that get everything from the cache together with their snapshot
+	const bool dcfFanout = dcfConnection && dcfConnection->IsInitialized() && dcfConnection->IsRelayFanout();
+	const auto IsAwaitingSnapshot = [](const GameParticipant& p) { return p.awaitingSnapshot; };
+
+	if (dcfFanout && std::none_of(players.begin(), players.end(), IsAwaitingSnapshot)) {
+		dcfConnection->SendData(packet);
+		return;
+	}
+	for (GameParticipant& player : players) {
+		// gets it from the cache, together with the snapshot
+		if (player.awaitingSnapshot)
+			continue;
+
+		player.SendData(packet);
+	}
+}
+
+void CGameServer::ReplayPacketCache(GameParticipant& joiner, size_t skipEnd) {
+	// not expected to answer sync checks until it has caught up to here
+	if (gameHasStarted)
+		joiner.catchUpFrame = serverFrameNum;
+
+	for (size_t i = 0; i < packetCache.size(); ++i) {
+		const std::shared_ptr<const netcode::RawPacket>& p = packetCache[i];
+
+		if (i < gameStartCacheIndex) {
+			// the snapshot already carries the synced RNG state seeded from this
+			if (skipEnd != 0 && p->data[0] == NETMSG_RANDSEED)
+				continue;
+		} else if (i < skipEnd) {
+			// the player roster is not part of the snapshot, everything else is
+			switch (p->data[0]) {
+				case NETMSG_CREATE_NEWPLAYER:
+				case NETMSG_PLAYERNAME:
+				case NETMSG_PLAYERLEFT:
+					break;
+				default:
+					continue;
+			}
 		}
+
+		joiner.SendData(p);
 	}
 }
 
+unsigned CGameServer::ChooseSnapshotDonor() const {
+	// the host is right next to us and certainly up to date
+	if (HasLocalClient() && players[localClientNumber].myState == GameParticipant::INGAME)
+		return localClientNumber;
+
+	unsigned donor = -1u;
+	float donorCpu = std::numeric_limits<float>::max();
+
+	for (unsigned n = 0; n < players.size(); ++n) {
+		const GameParticipant& p = players[n];
+
+		if (p.myState != GameParticipant::INGAME || p.isMidgameJoin)
+			continue;
+		// clients still catching up would take the snapshot far in the future
+		if ((serverFrameNum - p.lastFrameResponse) > (GAME_SPEED * 2))
+			continue;
+		if (p.cpuUsage >= donorCpu)
+			continue;
+
+		donor = n;
+		donorCpu = p.cpuUsage;
+	}
+
+	return donor;
+}
+
+void CGameServer::RequestSnapshot() {
+	const unsigned donor = ChooseSnapshotDonor();
+
+	if (donor >= players.size()) {
+		CancelSnapshotJoins("no client can provide a snapshot");
+		return;
+	}
+
+	// the next keyframe; the request is ordered before it on every link
+	const int frameNum = (serverFrameNum / serverKeyframeInterval + 1) * serverKeyframeInterval;
+
+	snapshot.Request(donor, frameNum, spring_gettime());
+	Broadcast(CBaseNetProtocol::Get().SendSnapshotRequest(donor, frameNum));
+
+	Message(spring::format(" -> Requested snapshot of frame %d from player %d for %u joining client(s)", frameNum, donor, unsigned(snapshotJoiners.size())));
+}
+
+void CGameServer::UpdateSnapshotJoins(spring_time now) {
+	if (snapshotJoiners.empty())
+		return;
+
+	if (snapshot.HasTimedOut(now)) {
+		CancelSnapshotJoins("snapshot request timed out");
+		return;
+	}
+	if (!snapshot.IsComplete())
+		return;
+
+	for (const uint8_t playerNum : snapshotJoiners) {
+		GameParticipant& joiner = players[playerNum];
+
+		if (joiner.myState == GameParticipant::DISCONNECTED)
+			continue;
+
+		// same order as a regular join, with the sim state in between
+		joiner.SendData(std::shared_ptr<const netcode::RawPacket>(myGameData->Pack()));
+
+		for (const std::shared_ptr<const netcode::RawPacket>& chunk : snapshot.GetChunks()) {
+			joiner.SendData(chunk);
+		}
+
+		joiner.SendData(CBaseNetProtocol::Get().SendSetPlayerNum(playerNum));
+		joiner.snapshotFrame = snapshot.GetFrameNum();
+		joiner.awaitingSnapshot = false;
+
+		ReplayPacketCache(joiner, snapshot.GetCacheIndex());
+	}
+
+	Message(spring::format(" -> Sent snapshot of frame %d to %u joining client(s)", snapshot.GetFrameNum(), unsigned(snapshotJoiners.size())));
+	snapshotJoiners.clear();
+}
+
+void CGameServer::CancelSnapshotJoins(const std::string& reason) {
+	Message(spring::format(" -> Mid-game join falls back to a full replay: %s", reason.c_str()));
+
+	for (const uint8_t playerNum : snapshotJoiners) {
+		players[playerNum].awaitingSnapshot = false;
+		ReplayPacketCache(players[playerNum], 0);
+	}
+
+	snapshotJoiners.clear();
+	snapshot.Reset();
+}
+
+void CGameServer::VerifySnapshotJoin(unsigned playerNum, int frameNum, uint32_t checksum) {
+	GameParticipant& joiner = players[playerNum];
+
+	if (frameNum <= joiner.snapshotFrame)
+		return;
+
+	if (frameNum > (joiner.snapshotFrame + GameSnapshot::VERIFY_FRAMES)) {
+		Message(spring::format(" -> Player %d is in sync after joining from the snapshot of frame %d", playerNum, joiner.snapshotFrame));
+		joiner.snapshotFrame = -1;
+		return;
+	}
+
+	if (snapshot.CompareChecksum(frameNum, checksum) >= 0)
+		return;
+
+	// some state the creg snapshot does not capture; every later joiner would desync the same way
+	LOG_L(L_ERROR, "[%s] player %d desynced at frame %d after loading the snapshot of frame %d, disabling snapshot joins", __func__, playerNum, frameNum, joiner.snapshotFrame);
+
+	snapshotJoin = false;
+	joiner.snapshotFrame = -1;
+	joiner.Kill("Desync after loading the game snapshot, please reconnect", true);
+}
+
 void CGameServer::Message(const std::string& message, bool broadcast) {
 	if (!logInfoMessages && !logDebugMessages) {
 		return;
@@ -723,21 +1071,13 @@ void CGameServer::Message(const std::string& message, bool broadcast) {
 	DCF_LOG(dcf::DCFLogLevel::INFO, message);
 	if (broadcast) {
 		std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendSystemMessage(SERVER_PLAYER, message);
-		if (dcfConnection) {
-			dcfConnection->SendData(packet);
-		} else {
-			Broadcast(packet);
-		}
+		Broadcast(packet);
 	}
 }
 
 void CGameServer::SendSystemMsg(const std::string& message, int playerNum) {
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendSystemMessage(playerNum, message);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 	DCF_LOG(dcf::DCFLogLevel::INFO, "System message to player " + std::to_string(playerNum) + ": " + message);
 }
 
@@ -759,11 +1099,8 @@ void CGameServer::StartGame() {
 	gameHasStarted = true;
 	readyTime = spring_gettime();
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendStartPlaying(0);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
+	gameStartCacheIndex = packetCache.size();
 	DCF_LOG(dcf::DCFLogLevel::INFO, "Game started");
 }
 
@@ -773,11 +1110,7 @@ void CGameServer::PauseGame(bool pause, bool fromServer) {
 	}
 	isPaused = pause;
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendPause(fromServer ? SERVER_PLAYER : 0, pause);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 	DCF_LOG(dcf::DCFLogLevel::INFO, std::string("Game ") + (pause ? "paused" : "resumed") + " by " + (fromServer ? "server" : "player"));
 }
 
@@ -787,22 +1120,23 @@ void CGameServer::QuitGame() {
 	}
 	quitServer = true;
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendQuit();
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
+	Broadcast(packet);
+
+	// the server stops updating after this, nothing would flush the paced queues anymore
+	for (GameParticipant& player : players) {
+		player.DrainSendQueue();
 	}
+	if (dcfConnection && dcfConnection->IsInitialized()) {
+		dcfConnection->Flush(true);
+	}
+
 	DCF_LOG(dcf::DCFLogLevel::INFO, "Game quit");
 }
 
 void CGameServer::Reload(const std::string& newSetupText) {
 	reloadingServer = true;
 	std::shared_ptr<const RawPacket> packet = CBaseNetProtocol::Get().SendGameOver(0);
-	if (dcfConnection) {
-		dcfConnection->SendData(packet);
-	} else {
-		Broadcast(packet);
-	}
+	Broadcast(packet);
 	DCF_LOG(dcf::DCFLogLevel::INFO, "Reloading server with new setup");
 }
 
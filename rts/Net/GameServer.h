@@ -13,6 +13,8 @@
 #include <vector>
 
 #include "Game/GameData.h"
+#include "Net/GameSnapshot.h"
+#include "Net/SyncChecksumRing.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamBase.h"
 #include "System/float3.h"
@@ -41,6 +43,7 @@ class CGameSetup;
 class ChatMessage;
 class GameParticipant;
 class GameSkirmishAI;
+class CGameServerHost;
 
 class GameTeam : public TeamBase
 {
@@ -71,7 +74,9 @@ public:
 	CGameServer(
 		const std::shared_ptr<const ClientSetup> newClientSetup,
 		const std::shared_ptr<const GameData> newGameData,
-		const std::shared_ptr<const CGameSetup> newGameSetup
+		const std::shared_ptr<const CGameSetup> newGameSetup,
+		CGameServerHost* newHost = nullptr,
+		uint32_t newHostedGameID = 0
 	);
 
 	CGameServer(const CGameServer&) = delete; // no-copy
@@ -83,6 +88,11 @@ public:
 	void AddAutohostInterface(const std::string& autohostIP, const int autohostPort);
 
 	void Initialize();
+	/**
+	 * @brief One server update under gameServerMutex
+	 * Called by our own thread, or by the host's workers if this game is hosted.
+	 */
+	void Tick();
 	/**
 	 * @brief Set frame after loading
 	 * WARNING! No checks are done, so be careful
@@ -104,6 +114,13 @@ public:
 	void UpdateSpeedControl(int speedCtrl);
 	static std::string SpeedControlToString(int speedCtrl);
 
+	/**
+	 * @brief Degrade non-critical sim work while the server is overloaded
+	 * Clamped to [0, MAX_SIM_QUALITY_LEVEL] and sent to every client as a
+	 * synced command, so all of them switch in the same frame.
+	 */
+	void SetSimQuality(int level);
+
 	static bool IsServerCommand(const std::string& cmd) {
 		const auto pred = [](const std::string& a, const std::string& b) { return (a < b); };
 		const auto iter = std::lower_bound(commandBlacklist.begin(), commandBlacklist.end(), cmd, pred);
@@ -125,7 +142,7 @@ public:
 	const std::deque<std::shared_ptr<const netcode::RawPacket>>& GetPacketCache() const { return packetCache; }
 
 #ifdef SYNCCHECK
-	const std::set<int>& GetOutstandingSyncFrames() const { return outstandingSyncFrames; }
+	const SyncChecksumRing& GetSyncChecksums() const { return syncChecksums; }
 #endif
 
 	spring_time GetServerStartTime() const { return serverStartTime; }
@@ -144,6 +161,8 @@ public:
 	float GetUserSpeedFactor() const { return userSpeedFactor; }
 	float GetInternalSpeed() const { return internalSpeed; }
 
+	int GetSimQualityLevel() const { return simQualityLevel; }
+
 	float GetMedianCpu() const { return medianCpu; }
 	int GetMedianPing() const { return medianPing; }
 	int GetCurSpeedCtrl() const { return curSpeedCtrl; }
@@ -195,8 +214,27 @@ public:
 	// BumpStockEngine-specific: DCF integration
 	const std::unique_ptr<DCFConnection>& GetDCFConnection() const { return dcfConnection; }
 
+private:
+	void ReplayPacketCache(GameParticipant& joiner, size_t skipEnd);
+
+	unsigned ChooseSnapshotDonor() const;
+	void RequestSnapshot();
+	void UpdateSnapshotJoins(spring_time now);
+	void CancelSnapshotJoins(const std::string& reason);
+	void VerifySnapshotJoin(unsigned playerNum, int frameNum, uint32_t checksum);
+
+	void CheckSync();
+	void UnpackSyncResponse(const std::shared_ptr<const netcode::RawPacket>& packet);
+
+	void AutohostMessage(const std::string& message);
+
+	static uint32_t MapDrawCost(const unsigned char* inbuf, unsigned dataLength);
+	bool ShapeMapDraw(unsigned playerNum, uint32_t cost, spring_time now);
+
 private:
 	std::unique_ptr<DCFConnection> dcfConnection;  // Primary DCF networking
+	CGameServerHost* host = nullptr;  // Non-null if this is one of several games in the process
+	uint32_t hostedGameID = 0;
 	std::unique_ptr<netcode::UDPListener> udpListener;  // Fallback UDP listener
 
 	std::shared_ptr<const ClientSetup> myClientSetup;
@@ -220,9 +258,19 @@ private:
 	std::pair<std::string, std::string> refClientVersion;
 
 	std::deque<std::shared_ptr<const netcode::RawPacket>> packetCache;
+	/// first cache entry after NETMSG_STARTPLAYING
+	size_t gameStartCacheIndex = 0;
+
+	GameSnapshot snapshot;
+	std::vector<uint8_t> snapshotJoiners;
+	bool snapshotJoin = true;
+	int snapshotJoinMinFrame = 0;
 
 #ifdef SYNCCHECK
-	std::set<int> outstandingSyncFrames;
+	SyncChecksumRing syncChecksums;
+	std::vector<SyncChecksumRing::Divergence> syncDivergences;
+	/// frame for which clients were asked to dump their state, only done once
+	int syncDumpFrame = -1;
 #endif
 
 	spring_time serverStartTime = spring_gettime();
@@ -241,6 +289,8 @@ private:
 	float userSpeedFactor = 1.0f;
 	float internalSpeed = 1.0f;
 
+	int simQualityLevel = 0;
+
 	float medianCpu = 0.0f;
 	int medianPing = 0;
 	int curSpeedCtrl = 0;
@@ -0,0 +1,167 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GameServerHost.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+#include "DCFConnection.h"
+#include "GameServer.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+
+CONFIG(int, DedicatedHostThreads).defaultValue(2).minimumValue(1).description("Number of threads ticking the games of a multi-game dedicated server.");
+
+
+CGameServerHost::CGameServerHost()
+{
+	try {
+		transport = std::make_unique<DCFConnection>("config/dcf_network.json");
+
+		if (!transport->initialized) {
+			LOG_L(L_WARNING, "[GameServerHost::%s] DCF init failed, games fall back to UDP", __func__);
+			transport.reset();
+		}
+	} catch (const std::exception& e) {
+		LOG_L(L_ERROR, "[GameServerHost::%s] DCF setup error: %s, games fall back to UDP", __func__, e.what());
+		transport.reset();
+	}
+
+	const int numWorkers = configHandler->GetInt("DedicatedHostThreads");
+
+	for (int i = 0; i < numWorkers; i++) {
+		workers.emplace_back(&CGameServerHost::WorkerLoop, this);
+	}
+}
+
+CGameServerHost::~CGameServerHost()
+{
+	{
+		std::lock_guard<spring::mutex> lock(gamesMutex);
+		quit = true;
+	}
+
+	gamesCond.notify_all();
+
+	for (spring::thread& worker: workers) {
+		worker.join();
+	}
+
+	// channels deregister from the transport, so it has to outlive them
+	games.clear();
+	transport.reset();
+}
+
+
+CGameServer* CGameServerHost::AddGame(
+	const std::shared_ptr<const ClientSetup> clientSetup,
+	const std::shared_ptr<const GameData> gameData,
+	const std::shared_ptr<const CGameSetup> gameSetup,
+	uint32_t gameID
+) {
+	std::unique_ptr<HostedGame> game = std::make_unique<HostedGame>();
+	game->server = std::make_unique<CGameServer>(clientSetup, gameData, gameSetup, this, gameID);
+	game->nextUpdate = spring_gettime();
+
+	CGameServer* server = game->server.get();
+
+	{
+		std::lock_guard<spring::mutex> lock(gamesMutex);
+		games.emplace_back(std::move(game));
+	}
+
+	gamesCond.notify_one();
+	LOG("[GameServerHost::%s] hosting game %u (%u running)", __func__, gameID, GetNumGames());
+	return server;
+}
+
+unsigned CGameServerHost::RemoveFinishedGames()
+{
+	std::vector<std::unique_ptr<HostedGame>> finished;
+
+	{
+		std::lock_guard<spring::mutex> lock(gamesMutex);
+
+		// a game being ticked right now is picked up on the next call
+		const auto pred = [](const std::unique_ptr<HostedGame>& game) { return (!game->busy && game->server->HasFinished()); };
+		const auto iter = std::stable_partition(games.begin(), games.end(), [&](const auto& game) { return !pred(game); });
+
+		std::move(iter, games.end(), std::back_inserter(finished));
+		games.erase(iter, games.end());
+	}
+
+	// outside the lock, shutting a game down can take a while
+	finished.clear();
+	return GetNumGames();
+}
+
+unsigned CGameServerHost::GetNumGames() const
+{
+	std::lock_guard<spring::mutex> lock(gamesMutex);
+	return games.size();
+}
+
+
+void CGameServerHost::WorkerLoop()
+{
+	std::unique_lock<spring::mutex> lock(gamesMutex);
+
+	while (!quit) {
+		HostedGame* next = nullptr;
+
+		// earliest-due game nobody else is ticking
+		for (const auto& game: games) {
+			if (game->busy || game->server->HasFinished())
+				continue;
+
+			if (next == nullptr || game->nextUpdate < next->nextUpdate)
+				next = game.get();
+		}
+
+		if (next == nullptr) {
+			gamesCond.wait(lock);
+			continue;
+		}
+
+		const spring_time now = spring_gettime();
+
+		if (next->nextUpdate > now) {
+			gamesCond.wait_for(lock, std::chrono::nanoseconds((next->nextUpdate - now).toNanoSecsi()));
+			continue;
+		}
+
+		next->busy = true;
+		lock.unlock();
+
+		PumpTransport();
+		next->server->Tick();
+
+		lock.lock();
+		next->busy = false;
+		next->nextUpdate = spring_gettime() + spring_msecs(next->server->GetLoopSleepTime());
+
+		// another worker may have been waiting for this game
+		gamesCond.notify_one();
+	}
+}
+
+void CGameServerHost::PumpTransport()
+{
+	if (transport == nullptr)
+		return;
+
+	// whichever worker gets here first does it, the others go on with their game
+	std::unique_lock<spring::mutex> lock(transportMutex, std::try_to_lock);
+
+	if (!lock.owns_lock())
+		return;
+
+	const spring_time now = spring_gettime();
+
+	if ((now - lastTransportUpdate) < spring_msecs(1))
+		return;
+
+	lastTransportUpdate = now;
+	transport->Update();
+}
@@ -0,0 +1,76 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _GAME_SERVER_HOST_H
+#define _GAME_SERVER_HOST_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
+
+class ClientSetup;
+class CGameSetup;
+class CGameServer;
+class DCFConnection;
+class GameData;
+
+/**
+ * @brief Runs several games in one dedicated server process
+ *
+ * Each game is an ordinary CGameServer without a thread of its own. The host
+ * owns the workers that tick them and the DCF transport they all send and
+ * receive through, on which every game has its own channel keyed by game ID.
+ * Archives are loaded through the process-wide archive scanner and VFS, so
+ * games on the same map or mod share them.
+ */
+class CGameServerHost
+{
+public:
+	CGameServerHost();
+	CGameServerHost(const CGameServerHost&) = delete; // no-copy
+	~CGameServerHost();
+
+	/// games must be added with distinct, non-zero IDs; peers select theirs via "game_id"
+	CGameServer* AddGame(
+		const std::shared_ptr<const ClientSetup> clientSetup,
+		const std::shared_ptr<const GameData> gameData,
+		const std::shared_ptr<const CGameSetup> gameSetup,
+		uint32_t gameID
+	);
+	/// destroys finished games, returns how many are still running
+	unsigned RemoveFinishedGames();
+
+	unsigned GetNumGames() const;
+	unsigned GetNumWorkers() const { return workers.size(); }
+
+	/// nullptr if DCF could not be set up, games then fall back to UDP each
+	DCFConnection* GetTransport() const { return transport.get(); }
+
+private:
+	struct HostedGame {
+		std::unique_ptr<CGameServer> server;
+		spring_time nextUpdate;
+		bool busy = false;
+	};
+
+	void WorkerLoop();
+	void PumpTransport();
+
+private:
+	std::unique_ptr<DCFConnection> transport;
+
+	std::vector<std::unique_ptr<HostedGame>> games;
+	std::vector<spring::thread> workers;
+
+	mutable spring::mutex gamesMutex;
+	spring::mutex transportMutex;
+	spring::condition_variable_any gamesCond;
+
+	spring_time lastTransportUpdate = spring_notime;
+
+	bool quit = false;
+};
+
+#endif // _GAME_SERVER_HOST_H
@@ -0,0 +1,105 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GameSnapshot.h"
+
+#include "System/Log/ILog.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UnpackPacket.h"
+
+void GameSnapshot::Request(uint8_t _donor, int _frameNum, spring_time now)
+{
+	Reset();
+
+	donor = _donor;
+	frameNum = _frameNum;
+	requestTime = now;
+}
+
+GameSnapshot::ChunkResult GameSnapshot::AddChunk(std::shared_ptr<const netcode::RawPacket> chunk)
+{
+	if (!IsPending())
+		return CHUNK_IGNORED;
+
+	uint8_t playerNum;
+	int32_t chunkFrameNum;
+	uint32_t syncChecksum;
+	uint32_t chunkTotalSize;
+	uint32_t offset;
+
+	try {
+		netcode::UnpackPacket pckt(chunk, 3);
+
+		pckt >> playerNum;
+		pckt >> chunkFrameNum;
+		pckt >> syncChecksum;
+		pckt >> chunkTotalSize;
+		pckt >> offset;
+	} catch (const netcode::UnpackPacketException& ex) {
+		LOG_L(L_ERROR, "[GameSnapshot::%s] invalid chunk: %s", __func__, ex.what());
+		return CHUNK_IGNORED;
+	}
+
+	// left over from an earlier request, or sent by someone else
+	if (playerNum != donor || chunkFrameNum != frameNum)
+		return CHUNK_IGNORED;
+
+	constexpr uint32_t headerSize = 3 + 1 + 4 + 4 + 4 + 4;
+	const uint32_t dataSize = chunk->length - headerSize;
+
+	if (chunkTotalSize == 0) {
+		LOG_L(L_WARNING, "[GameSnapshot::%s] player %d could not serialize frame %d", __func__, donor, frameNum);
+		return CHUNK_FAILED;
+	}
+	if (chunks.empty())
+		totalSize = chunkTotalSize;
+
+	// the link is reliable and ordered, anything else means the donor is confused
+	if (chunkTotalSize != totalSize || offset != receivedSize || (receivedSize + dataSize) > totalSize) {
+		LOG_L(L_ERROR, "[GameSnapshot::%s] unexpected chunk at offset %u from player %d", __func__, offset, donor);
+		return CHUNK_FAILED;
+	}
+
+	chunks.emplace_back(std::move(chunk));
+	receivedSize += dataSize;
+
+	if (receivedSize < totalSize)
+		return CHUNK_ADDED;
+
+	// the donor had already answered its own sync request for this frame
+	donorChecksums[frameNum] = syncChecksum;
+
+	complete = true;
+	return CHUNK_COMPLETE;
+}
+
+void GameSnapshot::Reset()
+{
+	chunks.clear();
+	donorChecksums.clear();
+
+	cacheIndex = 0;
+	totalSize = 0;
+	receivedSize = 0;
+
+	frameNum = -1;
+	complete = false;
+}
+
+
+void GameSnapshot::AddDonorChecksum(int _frameNum, uint32_t checksum)
+{
+	if (frameNum < 0 || _frameNum <= frameNum || _frameNum > (frameNum + VERIFY_FRAMES))
+		return;
+
+	donorChecksums[_frameNum] = checksum;
+}
+
+int GameSnapshot::CompareChecksum(int _frameNum, uint32_t checksum) const
+{
+	const auto it = donorChecksums.find(_frameNum);
+
+	if (it == donorChecksums.end())
+		return 0;
+
+	return ((it->second == checksum)? 1: -1);
+}
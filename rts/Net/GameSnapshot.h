@@ -0,0 +1,89 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _GAME_SNAPSHOT_H
+#define _GAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/Misc/SpringTime.h"
+#include "System/UnorderedMap.hpp"
+
+namespace netcode
+{
+	class RawPacket;
+}
+
+/**
+ * @brief Server-side copy of a sim snapshot taken by one client at a keyframe
+ *
+ * A mid-game joiner loads this instead of simulating every frame since the
+ * start, and then only has to catch up on the messages the server cached
+ * after that keyframe. The chunks are kept exactly as the donor sent them so
+ * they can be forwarded to any number of joiners without reassembly.
+ *
+ * Under SYNCCHECK the donor's checksums for the frames right after the
+ * snapshot are kept as well, so the server can tell whether a joiner that
+ * loaded it really ended up in the same state as everybody else.
+ */
+class GameSnapshot
+{
+public:
+	enum ChunkResult {
+		CHUNK_IGNORED,
+		CHUNK_ADDED,
+		CHUNK_COMPLETE,
+		CHUNK_FAILED,
+	};
+
+	/// starts collecting what <donor> was asked to take right after keyframe <frameNum>
+	void Request(uint8_t donor, int frameNum, spring_time now);
+	/// adds one NETMSG_SNAPSHOT_CHUNK
+	ChunkResult AddChunk(std::shared_ptr<const netcode::RawPacket> chunk);
+	void Reset();
+
+	/// position in the server's packet cache right after the snapshot keyframe
+	void SetCacheIndex(size_t idx) { cacheIndex = idx; }
+
+	void AddDonorChecksum(int frameNum, uint32_t checksum);
+	/// -1 if the donor reported a different checksum for <frameNum>, 0 if unknown, 1 if equal
+	int CompareChecksum(int frameNum, uint32_t checksum) const;
+
+	bool IsPending() const { return (frameNum >= 0 && !complete); }
+	bool IsComplete() const { return complete; }
+	bool HasTimedOut(spring_time now) const { return (IsPending() && (now - requestTime) > spring_secs(REQUEST_TIMEOUT)); }
+	/// joiners would have more catching up to do than a fresh snapshot costs
+	bool IsStale(int serverFrameNum) const { return (serverFrameNum - frameNum) > MAX_AGE_FRAMES; }
+
+	uint8_t GetDonor() const { return donor; }
+	int GetFrameNum() const { return frameNum; }
+	size_t GetCacheIndex() const { return cacheIndex; }
+	size_t GetTotalSize() const { return totalSize; }
+	const std::vector<std::shared_ptr<const netcode::RawPacket>>& GetChunks() const { return chunks; }
+
+public:
+	/// frames after the snapshot for which joiners are compared with the donor
+	static constexpr int VERIFY_FRAMES = 64;
+
+private:
+	static constexpr int REQUEST_TIMEOUT = 30;
+	// about two minutes of tail, cheap to catch up on compared to a new snapshot
+	static constexpr int MAX_AGE_FRAMES = GAME_SPEED * 120;
+
+	std::vector<std::shared_ptr<const netcode::RawPacket>> chunks;
+	spring::unordered_map<int, uint32_t> donorChecksums;
+
+	spring_time requestTime;
+
+	size_t cacheIndex = 0;
+	size_t totalSize = 0;
+	size_t receivedSize = 0;
+
+	int frameNum = -1;
+	uint8_t donor = 0;
+	bool complete = false;
+};
+
+#endif // _GAME_SNAPSHOT_H
@@ -33,6 +33,7 @@
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
 #include "System/TimeProfiler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/Sound/ISound.h"
@@ -117,6 +118,36 @@ void CGame::SendClientProcUsage()
 	}
 }
 
+void CGame::SendSnapshot(int frameNum)
+{
+	ZoneScoped;
+	static constexpr uint32_t SNAPSHOT_CHUNK_SIZE = 4096;
+
+	const spring_time startTime = spring_gettime();
+
+	std::vector<std::uint8_t> snapshot;
+	std::uint32_t syncChecksum = 0;
+
+	// an empty snapshot still goes out, so the server falls back without waiting for a timeout
+	CCregLoadSaveHandler::SaveSnapshot(snapshot);
+
+#ifdef SYNCCHECK
+	syncChecksum = CSyncChecker::GetChecksum();
+#endif
+
+	if (snapshot.empty()) {
+		clientNet->Send(CBaseNetProtocol::Get().SendSnapshotChunk(gu->myPlayerNum, frameNum, syncChecksum, 0, 0, nullptr, 0));
+		return;
+	}
+
+	for (uint32_t offset = 0; offset < snapshot.size(); offset += SNAPSHOT_CHUNK_SIZE) {
+		const uint32_t size = std::min<uint32_t>(SNAPSHOT_CHUNK_SIZE, snapshot.size() - offset);
+		clientNet->Send(CBaseNetProtocol::Get().SendSnapshotChunk(gu->myPlayerNum, frameNum, syncChecksum, snapshot.size(), offset, snapshot.data() + offset, size));
+	}
+
+	LOG("[Game::%s] sent snapshot of frame %d (%u KiB) to the server in %dms", __func__, frameNum, unsigned(snapshot.size() / 1024), int((spring_gettime() - startTime).toMilliSecsi()));
+}
+
 
 uint32_t CGame::GetNumQueuedSimFrameMessages(uint32_t maxFrames) const
 {
@@ -631,9 +662,32 @@ void CGame::ClientReadNet()
 				if ((gs->frameNum & 4095) == 0)
 					CSyncChecker::NewFrame();
 #endif
+
+				// taken only now so the running checksum above is part of the snapshot
+				if (gs->frameNum == snapshotRequestFrame) {
+					SendSnapshot(snapshotRequestFrame);
+					snapshotRequestFrame = -1;
+				}
+
 				AddTraffic(-1, packetCode, dataLength);
 			} break;
 
+			case NETMSG_SNAPSHOT_REQUEST: {
+				ZoneScopedN("Net::SnapshotRequest");
+				const uint8_t playerNum = inbuf[1];
+				const int32_t frameNum = *reinterpret_cast<const int32_t*>(inbuf + 2);
+
+				// broadcast, only the chosen donor answers; keyframes always land on a NEWFRAME
+				if (playerNum == gu->myPlayerNum && frameNum > gs->frameNum)
+					snapshotRequestFrame = frameNum;
+
+				AddTraffic(-1, packetCode, dataLength);
+			} break;
+
+			case NETMSG_SNAPSHOT_CHUNK: {
+				// addressed to a joiner still in PreGame; nothing to do for a running game
+			} break;
+
 			case NETMSG_SYNCRESPONSE: {
 				ZoneScopedN("Net::SyncResponse");
 #if (defined(SYNCCHECK))
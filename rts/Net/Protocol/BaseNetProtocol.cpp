@@ -7,6 +7,7 @@
 #include "System/Net/RawPacket.h"
 #include "System/Net/PackPacket.h"
 #include "System/Net/ProtocolDef.h"
+#include <cassert>
 #include <cinttypes>
 
 using netcode::PackPacket;
@@ -375,6 +376,28 @@ PacketType CBaseNetProtocol::SendMapDrawLine(uint8_t playerNum, uint32_t x1, uin
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendMapDrawPolyline(uint8_t playerNum, const std::vector<uint16_t>& coords, uint8_t flags)
+{
+	constexpr uint8_t drawType = MAPDRAW_POLYLINE;
+
+	assert((coords.size() & 1) == 0 && (coords.size() >> 1) <= MAPDRAW_POLYLINE_MAX_POINTS);
+
+	// x and z of each point, the count follows from the packet size
+	const uint32_t payloadSize = sizeof(playerNum) + sizeof(drawType) + sizeof(flags) + (coords.size() * sizeof(uint16_t));
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint8_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_MAPDRAW);
+	*packet <<
+		static_cast<uint8_t>(packetSize) <<
+		playerNum <<
+		drawType <<
+		flags <<
+		coords;
+	return PacketType(packet);
+}
+
+
 
 PacketType CBaseNetProtocol::SendSyncResponse(uint8_t playerNum, int32_t frameNum, uint32_t checksum)
 {
@@ -544,6 +567,36 @@ PacketType CBaseNetProtocol::SendPing(uint8_t playerNum, uint8_t pingTag, float
 }
 
 
+PacketType CBaseNetProtocol::SendSnapshotRequest(uint8_t playerNum, int32_t frameNum)
+{
+	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(frameNum), NETMSG_SNAPSHOT_REQUEST);
+	*packet << playerNum;
+	*packet << frameNum;
+	return PacketType(packet);
+}
+
+PacketType CBaseNetProtocol::SendSnapshotChunk(uint8_t playerNum, int32_t frameNum, uint32_t syncChecksum, uint32_t totalSize, uint32_t offset, const uint8_t* data, uint32_t size)
+{
+	const uint32_t payloadSize = sizeof(playerNum) + sizeof(frameNum) + sizeof(syncChecksum) + sizeof(totalSize) + sizeof(offset) + size;
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SNAPSHOT_CHUNK);
+	*packet << static_cast<uint16_t>(packetSize);
+	*packet << playerNum;
+	*packet << frameNum;
+	*packet << syncChecksum;
+	*packet << totalSize;
+	*packet << offset;
+
+	if (size > 0) {
+		std::memcpy(packet->GetWritingPos(), data, size);
+		packet->pos += size;
+	}
+
+	return PacketType(packet);
+}
+
 PacketType CBaseNetProtocol::SendClientData(uint8_t playerNum, const std::vector<uint8_t>& data)
 {
 	const uint32_t payloadSize = sizeof(playerNum) + data.size();
@@ -672,6 +725,8 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_AI_STATE_CHANGED, 4);
 	proto->AddType(NETMSG_GAME_FRAME_PROGRESS, 5);
 	proto->AddType(NETMSG_PING, 1 + (1 + 1 + 4));
+	proto->AddType(NETMSG_SNAPSHOT_REQUEST, 1 + 1 + 4);
+	proto->AddType(NETMSG_SNAPSHOT_CHUNK, -2);
 
 #ifdef SYNCDEBUG
 	proto->AddType(NETMSG_SD_CHKREQUEST, 5);
@@ -73,6 +73,7 @@ public:
 	PacketType SendMapErase(uint8_t playerNum, uint32_t x, uint32_t z);
 	PacketType SendMapDrawLine(uint8_t playerNum, uint32_t x1, uint32_t z1, uint32_t x2, uint32_t z2, bool);
 	PacketType SendMapDrawPoint(uint8_t playerNum, uint32_t x, uint32_t z, const std::string& label, bool);
+	PacketType SendMapDrawPolyline(uint8_t playerNum, const std::vector<uint16_t>& coords, uint8_t flags);
 	PacketType SendSyncResponse(uint8_t playerNum, int32_t frameNum, uint32_t checksum);
 	PacketType SendSystemMessage(uint8_t playerNum, std::string message);
 	PacketType SendStartPos(uint8_t playerNum, uint8_t teamNum, uint8_t readyState, float x, float y, float z);
@@ -82,6 +83,8 @@ public:
 	PacketType SendLuaMsg(uint8_t playerNum, uint16_t script, uint8_t mode, const std::vector<uint8_t>& rawData);
 	PacketType SendCurrentFrameProgress(int32_t frameNum);
 	PacketType SendPing(uint8_t playerNum, uint8_t pingTag, float localTime);
+	PacketType SendSnapshotRequest(uint8_t playerNum, int32_t frameNum);
+	PacketType SendSnapshotChunk(uint8_t playerNum, int32_t frameNum, uint32_t syncChecksum, uint32_t totalSize, uint32_t offset, const uint8_t* data, uint32_t size);
 
 	PacketType SendPlayerStat(uint8_t playerNum, const PlayerStatistics& currentStats);
 	PacketType SendTeamStat(uint8_t teamNum, const TeamStatistics& currentStats);
@@ -96,6 +96,10 @@ enum NETMSG {
 
 	NETMSG_PING = 78, // uint8_t playerNum, uint8_t pingTag, float localTime
 
+	NETMSG_SNAPSHOT_REQUEST = 79, // uint8_t playerNum, int32_t frameNum # server asks <playerNum> to serialize the sim right after keyframe <frameNum> #
+	NETMSG_SNAPSHOT_CHUNK   = 80, // uint16_t messageSize, uint8_t playerNum, int32_t frameNum, uint32_t syncChecksum, uint32_t totalSize, uint32_t offset, std::vector<uint8_t> data
+	                              // # an empty snapshot (totalSize 0) means the request could not be served #
+
 	NETMSG_LAST //max types of netmessages, internal only
 };
 
@@ -115,8 +119,18 @@ enum TEAMMSG {
 enum MapDrawAction {
 	MAPDRAW_POINT,
 	MAPDRAW_ERASE,
-	MAPDRAW_LINE
+	MAPDRAW_LINE,
+	MAPDRAW_POLYLINE  // connected lines, only on the wire; receivers add each segment as a MAPDRAW_LINE
+};
+
+/// flags of a MAPDRAW_POLYLINE
+enum MapDrawPolylineFlags {
+	MAPDRAW_POLYLINE_FROM_LUA = 1,
+	MAPDRAW_POLYLINE_REVERSED = 2,  // segment i runs from point i+1 to point i, as the mouse draws them
 };
 
+/// the packet size is one byte: header, player, type and flags, then two uint16 per point
+static constexpr unsigned MAPDRAW_POLYLINE_MAX_POINTS = (255 - 5) / 4;
+
 #endif
 
@@ -0,0 +1,156 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SyncChecksumRing.h"
+
+#include <algorithm>
+#include <cassert>
+
+void SyncChecksumRing::Slot::Clear(int frame)
+{
+	responded.reset();
+	agreed.reset();
+	others.clear();
+
+	frameNum = frame;
+	numResponses = 0;
+	checksum = 0;
+}
+
+
+void SyncChecksumRing::AddResponse(int frameNum, uint8_t playerNum, uint32_t checksum)
+{
+	const spring_time t0 = spring_gettime();
+
+	// too old, or further ahead than any client can be
+	if (frameNum < nextFrame || frameNum >= (nextFrame + RING_SIZE) || playerNum >= MAX_PLAYERS)
+		return;
+
+	Slot& slot = slots[frameNum % RING_SIZE];
+
+	if (slot.frameNum != frameNum) {
+		assert(slot.frameNum < 0);
+		slot.Clear(frameNum);
+		numPending += 1;
+	}
+
+	if (slot.responded.test(playerNum))
+		return;
+
+	if (slot.numResponses == 0)
+		slot.checksum = checksum;
+
+	if (checksum == slot.checksum) {
+		slot.agreed.set(playerNum);
+	} else {
+		slot.others.emplace_back(playerNum, checksum);
+	}
+
+	slot.responded.set(playerNum);
+	slot.numResponses += 1;
+
+	cpuTime += (spring_gettime() - t0);
+}
+
+void SyncChecksumRing::Update(int serverFrameNum, unsigned numExpected, int timeoutFrames, std::vector<Divergence>& divergent)
+{
+	const spring_time t0 = spring_gettime();
+
+	timeoutFrames = std::min(timeoutFrames, RING_SIZE - 1);
+
+	// server skipped ahead (e.g. a savegame was loaded); whatever is left is useless
+	if ((serverFrameNum - nextFrame) >= RING_SIZE) {
+		for (Slot& slot: slots) {
+			slot.Clear(-1);
+		}
+
+		nextFrame = serverFrameNum - RING_SIZE + 1;
+		numPending = 0;
+	}
+
+	for (; nextFrame <= serverFrameNum; nextFrame++) {
+		Slot& slot = slots[nextFrame % RING_SIZE];
+
+		const bool timedOut = ((serverFrameNum - nextFrame) > timeoutFrames);
+		const bool answered = (slot.frameNum == nextFrame);
+
+		if (!answered) {
+			// nobody got this far yet
+			if (!timedOut)
+				break;
+
+			continue;
+		}
+
+		if (slot.numResponses < numExpected) {
+			if (!timedOut)
+				break;
+
+			lastTimedOutFrame = nextFrame;
+			numTimedOut += 1;
+		}
+
+		Settle(slot, divergent);
+		slot.Clear(-1);
+
+		numPending -= 1;
+		numSettled += 1;
+	}
+
+	cpuTime += (spring_gettime() - t0);
+}
+
+void SyncChecksumRing::Settle(Slot& slot, std::vector<Divergence>& divergent) const
+{
+	if (slot.others.empty())
+		return;
+
+	// tally the handful of distinct checksums; ties go to the first one seen
+	std::vector<std::pair<uint32_t, unsigned>> votes = {{slot.checksum, unsigned(slot.agreed.count())}};
+
+	for (const auto& p: slot.others) {
+		const auto it = std::find_if(votes.begin(), votes.end(), [&](const auto& v) { return (v.first == p.second); });
+
+		if (it == votes.end()) {
+			votes.emplace_back(p.second, 1);
+		} else {
+			it->second += 1;
+		}
+	}
+
+	const auto best = std::max_element(votes.begin(), votes.end(), [](const auto& a, const auto& b) { return (a.second < b.second); });
+
+	Divergence d;
+	d.frameNum = slot.frameNum;
+	d.checksum = best->first;
+
+	if (d.checksum != slot.checksum) {
+		for (unsigned p = 0; p < MAX_PLAYERS; p++) {
+			if (slot.agreed.test(p))
+				d.desynced.emplace_back(p, slot.checksum);
+		}
+	}
+
+	for (const auto& p: slot.others) {
+		if (p.second != d.checksum)
+			d.desynced.push_back(p);
+	}
+
+	divergent.emplace_back(std::move(d));
+}
+
+
+void SyncChecksumRing::Reset()
+{
+	for (Slot& slot: slots) {
+		slot.Clear(-1);
+	}
+
+	cpuTime = spring_notime;
+
+	numSettled = 0;
+	numTimedOut = 0;
+
+	nextFrame = 0;
+	lastTimedOutFrame = -1;
+	numPending = 0;
+}
@@ -0,0 +1,88 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SYNC_CHECKSUM_RING_H
+#define _SYNC_CHECKSUM_RING_H
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/Misc/SpringTime.h"
+
+/**
+ * @brief Server-side sync checksum voting, one ring slot per outstanding frame
+ *
+ * Responses are bucketed by frame as they arrive. Each slot remembers the
+ * first checksum reported for its frame and which players agreed with it;
+ * only responses that differ are stored individually. A frame where everyone
+ * agreed thus costs O(1) per response and is settled without looking at the
+ * players again. The full majority vote only runs for frames that diverged.
+ */
+class SyncChecksumRing
+{
+public:
+	struct Divergence {
+		int frameNum;
+		/// what the majority reported
+		uint32_t checksum;
+		/// everyone else, with what they reported
+		std::vector<std::pair<uint8_t, uint32_t>> desynced;
+	};
+
+	/// responses for frames that were already settled are dropped
+	void AddResponse(int frameNum, uint8_t playerNum, uint32_t checksum);
+	/**
+	 * @brief settles, in order, every frame that <numExpected> players have answered
+	 * or that is more than <timeoutFrames> behind <serverFrameNum>
+	 * @param divergent receives the settled frames on which players disagreed
+	 */
+	void Update(int serverFrameNum, unsigned numExpected, int timeoutFrames, std::vector<Divergence>& divergent);
+	void Reset();
+
+	/// most recent frame settled without all expected responses, -1 if none
+	int GetLastTimedOutFrame() const { return lastTimedOutFrame; }
+	unsigned GetNumPending() const { return numPending; }
+	uint64_t GetNumSettled() const { return numSettled; }
+	uint64_t GetNumTimedOut() const { return numTimedOut; }
+	/// accumulated time spent in AddResponse and Update
+	spring_time GetCpuTime() const { return cpuTime; }
+
+private:
+	// SYNCCHECK_TIMEOUT plus slack; responses older than this are useless anyway
+	static constexpr int RING_SIZE = 512;
+
+	struct Slot {
+		void Clear(int frame);
+
+		std::bitset<MAX_PLAYERS> responded;
+		std::bitset<MAX_PLAYERS> agreed;
+
+		/// responses that differ from <checksum>, normally none
+		std::vector<std::pair<uint8_t, uint32_t>> others;
+
+		int frameNum = -1;
+		unsigned numResponses = 0;
+		/// first checksum received for this frame
+		uint32_t checksum = 0;
+	};
+
+	void Settle(Slot& slot, std::vector<Divergence>& divergent) const;
+
+private:
+	std::array<Slot, RING_SIZE> slots;
+
+	spring_time cpuTime = spring_notime;
+
+	uint64_t numSettled = 0;
+	uint64_t numTimedOut = 0;
+
+	/// oldest frame not yet settled
+	int nextFrame = 0;
+	int lastTimedOutFrame = -1;
+	unsigned numPending = 0;
+};
+
+#endif // _SYNC_CHECKSUM_RING_H
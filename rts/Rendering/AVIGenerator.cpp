@@ -13,6 +13,7 @@
 
 #include <windows.h>
 
+#include <cstring>
 #include <functional>
 #include <cassert>
 
@@ -363,7 +364,7 @@ HRESULT CAVIGenerator::AddFrame(unsigned char* pixelData)
 }
 
 
-bool CAVIGenerator::readOpenglPixelDataThreaded()
+bool CAVIGenerator::readOpenglPixelDataThreaded(const unsigned char* pixels)
 {
 	while (true) {
 		std::unique_lock<spring::mutex> lock(AVIMutex);
@@ -386,7 +387,8 @@ bool CAVIGenerator::readOpenglPixelDataThreaded()
 		}
 	}
 
-	glReadPixels(0, 0, bitmapInfo.biWidth, bitmapInfo.biHeight, GL_BGR_EXT, GL_UNSIGNED_BYTE, readBuf);
+	// read back by the caller, see AviVideoCapturing
+	std::memcpy(readBuf, pixels, bitmapInfo.biSizeImage);
 	return true;
 }
 
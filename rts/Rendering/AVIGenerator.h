@@ -28,7 +28,11 @@ public:
 	/// Returns last error message
 	std::string GetLastErrorMessage() const	{return errorMsg;}
 
-	bool readOpenglPixelDataThreaded();
+	int GetVideoSizeX() const { return bitmapInfo.biWidth; }
+	int GetVideoSizeY() const { return bitmapInfo.biHeight; }
+
+	/// Queues <pixels> (BGR, biSizeImage bytes) for the encoder thread.
+	bool readOpenglPixelDataThreaded(const unsigned char* pixels);
 
 private:
 	bool initVFW();
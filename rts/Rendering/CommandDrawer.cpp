@@ -6,6 +6,7 @@
 #include "Game/UI/CommandColors.h"
 #include "Game/WaitCommandsAI.h"
 #include "Map/Ground.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/glExtra.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/RenderBuffers.h"
@@ -21,11 +22,15 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/UnitDefHandler.h"
+#include "System/SpringHash.h"
 #include "System/SpringMath.h"
 #include "System/Log/ILog.h"
 
-static const CUnit* GetTrackableUnit(const CUnit* caiOwner, const CUnit* cmdUnit)
+const CUnit* CommandDrawer::GetTrackableUnit(const CUnit* caiOwner, const CUnit* cmdUnit) const
 {
+	// the target moves and can enter or leave LOS
+	SetDynamicQueue();
+
 	if (cmdUnit == nullptr)
 		return nullptr;
 	if ((cmdUnit->losStatus[caiOwner->allyteam] & (LOS_INLOS | LOS_INRADAR)) == 0)
@@ -35,14 +40,64 @@ static const CUnit* GetTrackableUnit(const CUnit* caiOwner, const CUnit* cmdUnit
 }
 
 CommandDrawer* CommandDrawer::GetInstance() {
-	// luaQueuedUnitSet gets cleared each frame, so this is fine wrt. reloading
+	// luaQueuedUnitSet gets cleared each frame and the queue cache by CWorldDrawer::Kill, so this is fine wrt. reloading
 	static CommandDrawer drawer;
 	return &drawer;
 }
 
 
 
+void CommandDrawer::Update()
+{
+	// queues of units that were deselected (or died) a while ago
+	static constexpr uint32_t CACHE_EXPIRY_FRAMES = 30;
+
+	luaQueuedUnitSet.clear();
+
+	for (auto it = cachedQueues.begin(); it != cachedQueues.end(); ) {
+		if ((it->second.drawFrame + CACHE_EXPIRY_FRAMES) < globalRendering->drawFrame) {
+			it = cachedQueues.erase(it);
+		} else {
+			++it;
+		}
+	}
+}
+
+
+
 void CommandDrawer::Draw(const CCommandAI* cai, int queueDrawDepth) const {
+	const CUnit* owner = cai->owner;
+	const uint32_t signature = GetQueueSignature(cai, queueDrawDepth);
+
+	CachedQueue& cachedQueue = cachedQueues[owner->id];
+	cachedQueue.drawFrame = globalRendering->drawFrame;
+
+	if (cachedQueue.isStatic && cachedQueue.signature == signature) {
+		DrawCachedQueue(cachedQueue, owner);
+		return;
+	}
+
+	cachedQueue.signature = signature;
+	cachedQueue.isStatic = true;
+	cachedQueue.icons.clear();
+	cachedQueue.buildIcons.clear();
+
+	const size_t numSegments = lineDrawer.GetNumSegments();
+
+	recordingQueue = &cachedQueue;
+	DrawQueue(cai, queueDrawDepth);
+	recordingQueue = nullptr;
+
+	if (!cachedQueue.isStatic) {
+		cachedQueue.segments.clear();
+		return;
+	}
+
+	lineDrawer.GetSegments(numSegments, cachedQueue.segments);
+	cachedQueue.hasStartSegment = (!cachedQueue.segments.empty() && cachedQueue.segments[0].startPos == owner->GetObjDrawMidPos());
+}
+
+void CommandDrawer::DrawQueue(const CCommandAI* cai, int queueDrawDepth) const {
 	// note: {Air,Builder}CAI inherit from MobileCAI, so test that last
 	if ((dynamic_cast<const     CAirCAI*>(cai)) != nullptr) {     DrawAirCAICommands(static_cast<const     CAirCAI*>(cai), queueDrawDepth); return; }
 	if ((dynamic_cast<const CBuilderCAI*>(cai)) != nullptr) { DrawBuilderCAICommands(static_cast<const CBuilderCAI*>(cai), queueDrawDepth); return; }
@@ -52,6 +107,76 @@ void CommandDrawer::Draw(const CCommandAI* cai, int queueDrawDepth) const {
 	DrawCommands(cai, queueDrawDepth);
 }
 
+void CommandDrawer::DrawCachedQueue(CachedQueue& cachedQueue, const CUnit* owner) const {
+	const float3& startPos = owner->GetObjDrawMidPos();
+
+	if (owner->selfDCountdown != 0)
+		cursorIcons.AddIcon(CMD_SELFD, startPos);
+
+	if (cachedQueue.hasStartSegment)
+		cachedQueue.segments[0].startPos = startPos;
+
+	lineDrawer.AddSegments(cachedQueue.segments);
+
+	for (const CCursorIcons::Icon& icon: cachedQueue.icons) {
+		cursorIcons.AddIcon(icon.cmd, icon.pos);
+	}
+	for (const CCursorIcons::BuildIcon& icon: cachedQueue.buildIcons) {
+		cursorIcons.AddBuildIcon(icon.cmd, icon.pos, icon.team, icon.facing);
+	}
+}
+
+uint32_t CommandDrawer::GetQueueSignature(const CCommandAI* cai, int queueDrawDepth) const {
+	uint32_t hash = spring::LiteHash(queueDrawDepth);
+
+	hash = spring::LiteHash(cai->owner->team, hash);
+	hash = spring::LiteHash(cmdColors.ConfigVersion(), hash);
+
+	const auto HashQueue = [&hash](const CCommandQueue& commandQue) {
+		for (const Command& c: commandQue) {
+			hash = spring::LiteHash(c.GetID(), hash);
+			hash = spring::LiteHash(c.GetTag(), hash);
+			hash = spring::LiteHash(c.GetOpts(), hash);
+			hash = spring::LiteHash(c.GetParams(), c.GetNumParams() * sizeof(float), hash);
+		}
+
+		hash = spring::LiteHash(commandQue.size(), hash);
+	};
+
+	HashQueue(cai->commandQue);
+
+	// factories draw the queue given to new units (and a wait from their own)
+	if (const CFactoryCAI* factoryCAI = dynamic_cast<const CFactoryCAI*>(cai); factoryCAI != nullptr)
+		HashQueue(factoryCAI->newUnitCommands);
+
+	return hash;
+}
+
+void CommandDrawer::DrawLineAndIcon(int cmdID, const float3& endPos, const float* color) const {
+	if (recordingQueue != nullptr)
+		recordingQueue->icons.emplace_back(cmdID, endPos);
+
+	lineDrawer.DrawLineAndIcon(cmdID, endPos, color);
+}
+
+void CommandDrawer::DrawIconAtLastPos(int cmdID) const {
+	// might still be at the owner's position
+	SetDynamicQueue();
+	lineDrawer.DrawIconAtLastPos(cmdID);
+}
+
+void CommandDrawer::AddBuildIcon(int cmdID, const float3& pos, int team, int facing) const {
+	if (recordingQueue != nullptr)
+		recordingQueue->buildIcons.emplace_back(cmdID, pos, team, facing);
+
+	cursorIcons.AddBuildIcon(cmdID, pos, team, facing);
+}
+
+void CommandDrawer::SetDynamicQueue() const {
+	if (recordingQueue != nullptr)
+		recordingQueue->isStatic = false;
+}
+
 
 
 void CommandDrawer::AddLuaQueuedUnit(const CUnit* unit, int queueDrawDepth) {
@@ -118,7 +243,7 @@ void CommandDrawer::DrawCommands(const CCommandAI* cai, int queueDrawDepth) cons
 					const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 					if (unit != nullptr)
-						lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
+						DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
 
 				} else {
 					assert(ci->GetNumParams() >= 3);
@@ -127,7 +252,7 @@ void CommandDrawer::DrawCommands(const CCommandAI* cai, int queueDrawDepth) cons
 					const float z = ci->GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
-					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
+					DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
 
@@ -135,7 +260,7 @@ void CommandDrawer::DrawCommands(const CCommandAI* cai, int queueDrawDepth) cons
 				DrawWaitIcon(*ci);
 			} break;
 			case CMD_SELFD: {
-				lineDrawer.DrawIconAtLastPos(cmdID);
+				DrawIconAtLastPos(cmdID);
 			} break;
 
 			default: {
@@ -170,13 +295,13 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, int queueDrawDepth) c
 
 		switch (cmdID) {
 			case CMD_MOVE: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.move);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.move);
 			} break;
 			case CMD_FIGHT: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.fight);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.fight);
 			} break;
 			case CMD_PATROL: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.patrol);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.patrol);
 			} break;
 
 			case CMD_ATTACK: {
@@ -184,7 +309,7 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, int queueDrawDepth) c
 					const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 					if (unit != nullptr)
-						lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
+						DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
 
 				} else {
 					assert(ci->GetNumParams() >= 3);
@@ -193,17 +318,17 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, int queueDrawDepth) c
 					const float z = ci->GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
-					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
+					DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
 
 			case CMD_AREA_ATTACK: {
 				const float3& endPos = ci->GetPos(0);
 
-				lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.attack);
+				DrawLineAndIcon(cmdID, endPos, cmdColors.attack);
 				lineDrawer.Break(endPos, cmdColors.attack);
 
-				glSurfaceCircle(endPos, ci->GetParam(3), { cmdColors.attack }, cmdCircleResolution);
+				lineDrawer.DrawSurfaceCircle(endPos, ci->GetParam(3), cmdColors.attack, cmdCircleResolution);
 
 				lineDrawer.RestartWithColor(cmdColors.attack);
 			} break;
@@ -212,7 +337,7 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, int queueDrawDepth) c
 				const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 				if (unit != nullptr)
-					lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
+					DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
 
 			} break;
 
@@ -220,7 +345,7 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, int queueDrawDepth) c
 				DrawWaitIcon(*ci);
 			} break;
 			case CMD_SELFD: {
-				lineDrawer.DrawIconAtLastPos(cmdID);
+				DrawIconAtLastPos(cmdID);
 			} break;
 
 			default: {
@@ -260,13 +385,13 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 				if (!bi.Parse(*ci))
 					continue;
 
-				cursorIcons.AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
+				AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
 				lineDrawer.DrawLine(bi.pos, cmdColors.build);
 
 				// draw metal extraction range
 				if (bi.def->extractRange > 0.0f) {
 					lineDrawer.Break(bi.pos, cmdColors.build);
-					glSurfaceCircle(bi.pos, bi.def->extractRange, { cmdColors.rangeExtract }, 40.0f);
+					lineDrawer.DrawSurfaceCircle(bi.pos, bi.def->extractRange, cmdColors.rangeExtract, 40);
 					lineDrawer.Restart();
 				}
 			}
@@ -275,30 +400,30 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 
 		switch (cmdID) {
 			case CMD_MOVE: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.move);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.move);
 			} break;
 			case CMD_FIGHT:{
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.fight);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.fight);
 			} break;
 			case CMD_PATROL: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.patrol);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.patrol);
 			} break;
 
 			case CMD_GUARD: {
 				const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 				if (unit != nullptr)
-					lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
+					DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
 
 			} break;
 
 			case CMD_RESTORE: {
 				const float3& endPos = ci->GetPos(0);
 
-				lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.restore);
+				DrawLineAndIcon(cmdID, endPos, cmdColors.restore);
 				lineDrawer.Break(endPos, cmdColors.restore);
 
-				glSurfaceCircle(endPos, ci->GetParam(3), { cmdColors.restore }, cmdCircleResolution);
+				lineDrawer.DrawSurfaceCircle(endPos, ci->GetParam(3), cmdColors.restore, cmdCircleResolution);
 
 				lineDrawer.RestartWithColor(cmdColors.restore);
 			} break;
@@ -309,7 +434,7 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 					const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 					if (unit != nullptr)
-						lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
+						DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
 
 				} else {
 					assert(ci->GetNumParams() >= 3);
@@ -318,7 +443,7 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 					const float z = ci->GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
-					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
+					DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
 
@@ -329,10 +454,10 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 				if (ci->GetNumParams() == 4) {
 					const float3& endPos = ci->GetPos(0);
 
-					lineDrawer.DrawLineAndIcon(cmdID, endPos, color);
+					DrawLineAndIcon(cmdID, endPos, color);
 					lineDrawer.Break(endPos, color);
 
-					glSurfaceCircle(endPos, ci->GetParam(3), { color }, cmdCircleResolution);
+					lineDrawer.DrawSurfaceCircle(endPos, ci->GetParam(3), color, cmdCircleResolution);
 
 					lineDrawer.RestartWithColor(color);
 				} else {
@@ -343,14 +468,16 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 					if (id >= unitHandler.MaxUnits()) {
 						const CFeature* feature = featureHandler.GetFeature(id - unitHandler.MaxUnits());
 
+						SetDynamicQueue();
+
 						if (feature != nullptr)
-							lineDrawer.DrawLineAndIcon(cmdID, feature->GetObjDrawMidPos(), color);
+							DrawLineAndIcon(cmdID, feature->GetObjDrawMidPos(), color);
 
 					} else {
 						const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(id));
 
 						if (unit != nullptr && unit != owner)
-							lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), color);
+							DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), color);
 
 					}
 				}
@@ -363,10 +490,10 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 				if (ci->GetNumParams() == 4) {
 					const float3& endPos = ci->GetPos(0);
 
-					lineDrawer.DrawLineAndIcon(cmdID, endPos, color);
+					DrawLineAndIcon(cmdID, endPos, color);
 					lineDrawer.Break(endPos, color);
 
-					glSurfaceCircle(endPos, ci->GetParam(3), { color }, cmdCircleResolution);
+					lineDrawer.DrawSurfaceCircle(endPos, ci->GetParam(3), color, cmdCircleResolution);
 
 					lineDrawer.RestartWithColor(color);
 				} else {
@@ -374,7 +501,7 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 						const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 						if (unit != nullptr)
-							lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), color);
+							DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), color);
 
 					}
 				}
@@ -382,13 +509,14 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, int queueDraw
 
 			case CMD_LOAD_ONTO: {
 				const CUnit* unit = unitHandler.GetUnitUnsafe(ci->GetParam(0));
-				lineDrawer.DrawLineAndIcon(cmdID, unit->pos, cmdColors.load);
+				SetDynamicQueue();
+				DrawLineAndIcon(cmdID, unit->pos, cmdColors.load);
 			} break;
 			case CMD_WAIT: {
 				DrawWaitIcon(*ci);
 			} break;
 			case CMD_SELFD: {
-				lineDrawer.DrawIconAtLastPos(ci->GetID());
+				DrawIconAtLastPos(ci->GetID());
 			} break;
 
 			default: {
@@ -427,13 +555,13 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, int queueDraw
 
 		switch (cmdID) {
 			case CMD_MOVE: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0) + UpVector * 3.0f, cmdColors.move);
+				DrawLineAndIcon(cmdID, ci->GetPos(0) + UpVector * 3.0f, cmdColors.move);
 			} break;
 			case CMD_FIGHT: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0) + UpVector * 3.0f, cmdColors.fight);
+				DrawLineAndIcon(cmdID, ci->GetPos(0) + UpVector * 3.0f, cmdColors.fight);
 			} break;
 			case CMD_PATROL: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0) + UpVector * 3.0f, cmdColors.patrol);
+				DrawLineAndIcon(cmdID, ci->GetPos(0) + UpVector * 3.0f, cmdColors.patrol);
 			} break;
 
 			case CMD_ATTACK: {
@@ -441,7 +569,7 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, int queueDraw
 					const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 					if (unit != nullptr)
-						lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
+						DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
 
 				} else {
 					assert(ci->GetNumParams() >= 3);
@@ -450,7 +578,7 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, int queueDraw
 					const float z = ci->GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
-					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
+					DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
 
@@ -458,7 +586,7 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, int queueDraw
 				const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 				if (unit != nullptr)
-					lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
+					DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
 
 			} break;
 
@@ -466,7 +594,7 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, int queueDraw
 				DrawWaitIcon(*ci);
 			} break;
 			case CMD_SELFD: {
-				lineDrawer.DrawIconAtLastPos(cmdID);
+				DrawIconAtLastPos(cmdID);
 			} break;
 
 			default: {
@@ -480,13 +608,13 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, int queueDraw
 			if (!bi.Parse(*ci))
 				continue;
 
-			cursorIcons.AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
+			AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
 			lineDrawer.DrawLine(bi.pos, cmdColors.build);
 
 			// draw metal extraction range
 			if (bi.def->extractRange > 0.0f) {
 				lineDrawer.Break(bi.pos, cmdColors.build);
-				glSurfaceCircle(bi.pos, bi.def->extractRange, { cmdColors.rangeExtract }, 40.0f);
+				lineDrawer.DrawSurfaceCircle(bi.pos, bi.def->extractRange, cmdColors.rangeExtract, 40);
 				lineDrawer.Restart();
 			}
 		}
@@ -515,14 +643,14 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, int queueDrawDe
 
 		switch (cmdID) {
 			case CMD_MOVE: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.move);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.move);
 			} break;
 			case CMD_PATROL: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.patrol);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.patrol);
 			} break;
 			case CMD_FIGHT: {
 				if (ci->GetNumParams() >= 3)
-					lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.fight);
+					DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.fight);
 
 			} break;
 
@@ -532,7 +660,7 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, int queueDrawDe
 					const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 					if (unit != nullptr)
-						lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
+						DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.attack);
 
 				}
 
@@ -541,7 +669,7 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, int queueDrawDe
 					const float z = ci->GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
-					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
+					DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
 
@@ -549,30 +677,31 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, int queueDrawDe
 				const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 				if (unit != nullptr)
-					lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
+					DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.guard);
 
 			} break;
 
 			case CMD_LOAD_ONTO: {
 				const CUnit* unit = unitHandler.GetUnitUnsafe(ci->GetParam(0));
-				lineDrawer.DrawLineAndIcon(cmdID, unit->pos, cmdColors.load);
+				SetDynamicQueue();
+				DrawLineAndIcon(cmdID, unit->pos, cmdColors.load);
 			} break;
 
 			case CMD_LOAD_UNITS: {
 				if (ci->GetNumParams() == 4) {
 					const float3& endPos = ci->GetPos(0);
 
-					lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.load);
+					DrawLineAndIcon(cmdID, endPos, cmdColors.load);
 					lineDrawer.Break(endPos, cmdColors.load);
 
-					glSurfaceCircle(endPos, ci->GetParam(3), { cmdColors.load }, cmdCircleResolution);
+					lineDrawer.DrawSurfaceCircle(endPos, ci->GetParam(3), cmdColors.load, cmdCircleResolution);
 
 					lineDrawer.RestartWithColor(cmdColors.load);
 				} else {
 					const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(ci->GetParam(0)));
 
 					if (unit != nullptr)
-						lineDrawer.DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.load);
+						DrawLineAndIcon(cmdID, unit->GetObjDrawErrorPos(owner->allyteam), cmdColors.load);
 
 				}
 			} break;
@@ -581,23 +710,23 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, int queueDrawDe
 				if (ci->GetNumParams() == 5) {
 					const float3& endPos = ci->GetPos(0);
 
-					lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.unload);
+					DrawLineAndIcon(cmdID, endPos, cmdColors.unload);
 					lineDrawer.Break(endPos, cmdColors.unload);
 
-					glSurfaceCircle(endPos, ci->GetParam(3), { cmdColors.unload }, cmdCircleResolution);
+					lineDrawer.DrawSurfaceCircle(endPos, ci->GetParam(3), cmdColors.unload, cmdCircleResolution);
 
 					lineDrawer.RestartWithColor(cmdColors.unload);
 				}
 			} break;
 
 			case CMD_UNLOAD_UNIT: {
-				lineDrawer.DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.unload);
+				DrawLineAndIcon(cmdID, ci->GetPos(0), cmdColors.unload);
 			} break;
 			case CMD_WAIT: {
 				DrawWaitIcon(*ci);
 			} break;
 			case CMD_SELFD: {
-				lineDrawer.DrawIconAtLastPos(cmdID);
+				DrawIconAtLastPos(cmdID);
 			} break;
 
 			default: {
@@ -612,6 +741,8 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, int queueDrawDe
 
 void CommandDrawer::DrawWaitIcon(const Command& cmd) const
 {
+	// the icon text shows the wait state
+	SetDynamicQueue();
 	waitCommandsAI.AddIcon(cmd, lineDrawer.GetLastPos());
 }
 
@@ -631,11 +762,11 @@ void CommandDrawer::DrawDefaultCommand(const Command& c, const CUnit* owner) con
 			const float3 endPos = c.GetPos(0) + UpVector * 3.0f;
 
 			if (!dd->showArea || (c.GetNumParams() < 4)) {
-				lineDrawer.DrawLineAndIcon(dd->cmdIconID, endPos, dd->color);
+				DrawLineAndIcon(dd->cmdIconID, endPos, dd->color);
 			} else {
-				lineDrawer.DrawLineAndIcon(dd->cmdIconID, endPos, dd->color);
+				DrawLineAndIcon(dd->cmdIconID, endPos, dd->color);
 				lineDrawer.Break(endPos, dd->color);
-				glSurfaceCircle(endPos, c.GetParam(3), { dd->color }, cmdCircleResolution);
+				lineDrawer.DrawSurfaceCircle(endPos, c.GetParam(3), dd->color, cmdCircleResolution);
 				lineDrawer.RestartWithColor(dd->color);
 			}
 
@@ -649,7 +780,7 @@ void CommandDrawer::DrawDefaultCommand(const Command& c, const CUnit* owner) con
 	if (unit == nullptr)
 		return;
 
-	lineDrawer.DrawLineAndIcon(dd->cmdIconID, unit->GetObjDrawErrorPos(owner->allyteam), dd->color);
+	DrawLineAndIcon(dd->cmdIconID, unit->GetObjDrawErrorPos(owner->allyteam), dd->color);
 }
 
 void CommandDrawer::DrawQuedBuildingSquares(const CBuilderCAI* cai) const
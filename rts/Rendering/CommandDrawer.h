@@ -3,6 +3,11 @@
 #ifndef COMMAND_DRAWER_H
 #define COMMAND_DRAWER_H
 
+#include <vector>
+
+#include "Game/UI/CursorIcons.h"
+#include "Rendering/LineDrawer.h"
+#include "System/UnorderedMap.hpp"
 #include "System/UnorderedSet.hpp"
 
 struct Command;
@@ -18,7 +23,8 @@ public:
 	static CommandDrawer* GetInstance();
 
 	// clear the set after WorldDrawer and MiniMap have both used it
-	void Update() { luaQueuedUnitSet.clear(); }
+	void Update();
+	void Kill() { cachedQueues.clear(); }
 
 	void Draw(const CCommandAI*, int queueDrawDepth = -1) const;
 	void DrawLuaQueuedUnitSetCommands() const;
@@ -27,6 +33,34 @@ public:
 	void AddLuaQueuedUnit(const CUnit* unit, int queueDrawDepth = 0);
 
 private:
+	// the lines and icons of a queue that only references fixed positions,
+	// reused until the queue (or cmdColors) changes
+	struct CachedQueue {
+		uint32_t signature = 0;
+		uint32_t drawFrame = 0;
+
+		bool isStatic = false;
+		// first segment starts at the (moving) owner
+		bool hasStartSegment = false;
+
+		std::vector<CLineDrawer::LineSegment> segments;
+		std::vector<CCursorIcons::Icon> icons;
+		std::vector<CCursorIcons::BuildIcon> buildIcons;
+	};
+
+	uint32_t GetQueueSignature(const CCommandAI*, int queueDrawDepth) const;
+
+	void DrawQueue(const CCommandAI*, int queueDrawDepth) const;
+	void DrawCachedQueue(CachedQueue& cachedQueue, const CUnit* owner) const;
+
+	// wrappers that record into the queue being drawn
+	void DrawLineAndIcon(int cmdID, const float3& endPos, const float* color) const;
+	void DrawIconAtLastPos(int cmdID) const;
+	void AddBuildIcon(int cmdID, const float3& pos, int team, int facing) const;
+
+	const CUnit* GetTrackableUnit(const CUnit* caiOwner, const CUnit* cmdUnit) const;
+	void SetDynamicQueue() const;
+
 	void DrawCommands(const CCommandAI*, int queueDrawDepth) const;
 	void DrawAirCAICommands(const CAirCAI*, int queueDrawDepth) const;
 	void DrawBuilderCAICommands(const CBuilderCAI*, int queueDrawDepth) const;
@@ -38,6 +72,11 @@ private:
 
 private:
 	spring::unordered_set<std::pair<int, int>> luaQueuedUnitSet; //unitID, queueDepth (if > 0)
+
+	// by unitID, dropped when not drawn for a while
+	mutable spring::unordered_map<int, CachedQueue> cachedQueues;
+	mutable CachedQueue* recordingQueue = nullptr;
+
 	static constexpr uint32_t cmdCircleResolution = 100;
 };
 
@@ -106,6 +106,7 @@ public:
 	static bool SetTeamColor(int team, const float alpha = 1.0f) { return modelDrawerState->SetTeamColor(team, alpha); }
 	static void SetNanoColor(const float4& color) { modelDrawerState->SetNanoColor(color); }
 	static const ScopedTransformMemAlloc& GetTransformMemAlloc(const ObjType* o) { return const_cast<const TDrawerData*>(modelDrawerData)->GetObjectTransformMemAlloc(o); }
+	static int GetLastChangeFrame(const ObjType* o) { return modelDrawerData->GetObjectLastChangeFrame(o); }
 public:
 	virtual void Update() const = 0;
 	// Draw*
@@ -440,13 +441,17 @@ inline void CModelDrawerBase<TDrawerData, TDrawer>::DrawShadowPassImpl() const
 		po->Disable();
 	}
 
-	DrawShadowObjectsLua();
-
 	if constexpr (legacy) {
 		glDisable(GL_ALPHA_TEST);
 		glDisable(GL_POLYGON_OFFSET_FILL);
 	}
 
+	// Lua-drawn objects never end up in the static shadow cache, nor in the cascades
+	if (shadowHandler.GetShadowCasterLayer() == CShadowHandler::SHADOWCASTER_LAYER_STATIC || shadowHandler.InCascadePass())
+		return;
+
+	DrawShadowObjectsLua();
+
 	ScopedModelDrawerImpl<CModelDrawerBase<TDrawerData, TDrawer>> smdi(true, false, false);
 	// draw all custom'ed units that were bypassed in the loop above
 	LuaObjectDrawer::SetDrawPassGlobalLODFactor(lot);
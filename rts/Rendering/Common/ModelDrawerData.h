@@ -3,6 +3,7 @@
 #include <vector>
 #include <array>
 #include <functional>
+#include <utility>
 
 #include <unordered_map>
 
@@ -74,6 +75,12 @@ public:
 		return (it != scTransMemAllocMap.end()) ? it->second : ScopedTransformMemAlloc::Dummy();
 	}
 	auto& GetObjectTransformMemAlloc(const T* o) { return scTransMemAllocMap[const_cast<T*>(o)]; }
+
+	// sim-frame the synced transform of <o> or any of its pieces last changed
+	int32_t GetObjectLastChangeFrame(const T* o) const {
+		const auto it = lastSyncedFrameChange.find(o);
+		return (it != lastSyncedFrameChange.end()) ? it->second : gs->frameNum;
+	}
 private:
 	static constexpr int MMA_SIZE0 = 2 << 17;
 protected:
@@ -82,6 +89,7 @@ protected:
 	std::vector<T*> unsortedObjects;
 	spring::unordered_map<const T*, ScopedTransformMemAlloc> scTransMemAllocMap;
 	spring::unordered_map<const T*, int32_t> lastSyncedFrameUpload;
+	spring::unordered_map<const T*, int32_t> lastSyncedFrameChange;
 
 	bool& mtModelDrawer;
 };
@@ -130,6 +138,7 @@ inline void CModelDrawerDataBase<T>::AddObject(const T* co, bool add)
 	scTransMemAllocMap.emplace(o, ScopedTransformMemAlloc(numMatrices));
 	static constexpr auto INITIAL_FRAME_NUM = std::numeric_limits<typename decltype(lastSyncedFrameUpload)::mapped_type>::lowest();
 	lastSyncedFrameUpload.emplace(o, INITIAL_FRAME_NUM); //set to INITIAL_FRAME_NUM to update at least once before the sim starts
+	lastSyncedFrameChange.emplace(o, gs->frameNum);
 
 	modelUniformsStorage.AddObject(co);
 }
@@ -143,9 +152,13 @@ inline void CModelDrawerDataBase<T>::DelObject(const T* co, bool del)
 		modelRenderers[MDL_TYPE(o)].DelObject(o);
 	}
 
+	// also on model or build-state changes, the object is re-evaluated next rebuild
+	shadowHandler.RemoveShadowCaster(o);
+
 	if (del && spring::VectorErase(unsortedObjects, o)) {
 		scTransMemAllocMap.erase(o);
 		lastSyncedFrameUpload.erase(o);
+		lastSyncedFrameChange.erase(o);
 		modelUniformsStorage.DelObject(co);
 	}
 }
@@ -174,16 +187,31 @@ inline void CModelDrawerDataBase<T>::UpdateObjectTrasform(const T* o)
 
 	// conditionally update new and prev synced positions
 	stma.UpdateIfChanged(0, tmPrev);
-	stma.UpdateIfChanged(1, tmCurr);
+	bool changed = stma.UpdateIfChanged(1, tmCurr);
+
+	// forces dirty / wasUpdated recalculation if no other method called it yet
+	o->localModel.UpdatePieceTransforms();
+
+	// no piece moved this frame nor the last, nothing to upload
+	if (!o->localModel.GetPiecesUpdated()) {
+		lastUploadFrameIt->second = gs->frameNum;
+
+		if (changed)
+			lastSyncedFrameChange.find(o)->second = gs->frameNum;
+
+		return;
+	}
 
 	for (int i = 0; i < o->localModel.pieces.size(); ++i) {
 		const LocalModelPiece& lmp = o->localModel.pieces[i];
 
-		const auto& lmpTransform = lmp.GetModelSpaceTransform(); //forces dirty / wasUpdated recalculation if no other method called it yet
+		const auto& lmpTransform = lmp.GetModelSpaceTransform();
 
 		if likely(!lmp.GetWasUpdated())
 			continue;
 
+		changed = true;
+
 		if unlikely(!lmp.GetScriptVisible()) {
 			stma.UpdateForced(2 * (1 + i) + 0, Transform::Zero());
 			stma.UpdateForced(2 * (1 + i) + 1, Transform::Zero());
@@ -197,13 +225,20 @@ inline void CModelDrawerDataBase<T>::UpdateObjectTrasform(const T* o)
 		lmp.ResetWasUpdated();
 	}
 
+	o->localModel.ResetPiecesUpdated();
+
 	lastUploadFrameIt->second = gs->frameNum;
+
+	// existing entry, safe to write from the MT update
+	if (changed)
+		lastSyncedFrameChange.find(o)->second = gs->frameNum;
 }
 
 template<typename T>
 inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o)
 {
-	auto& uni = modelUniformsStorage.GetObjUniformsArray(o);
+	// work on a copy, objects whose uniforms did not change stay out of the upload
+	ModelUniformData uni = std::as_const(modelUniformsStorage).GetObjUniformsArray(o);
 	uni.drawFlag = o->drawFlag;
 
 	if (gu->spectatingFullView || o->IsInLosForAllyTeam(gu->myAllyTeam)) {
@@ -213,7 +248,11 @@ inline void CModelDrawerDataBase<T>::UpdateObjectUniforms(const T* o)
 		uni.speed = o->speed;
 		uni.maxHealth = o->maxHealth;
 		uni.health = o->health;
+		// bounding sphere around drawPos that also encloses the one around drawMidPos
+		uni.cullRadius = o->GetDrawRadius() + o->drawPos.distance(o->drawMidPos);
 	}
+
+	modelUniformsStorage.UpdateIfChanged(o, uni);
 }
 
 template<typename T>
@@ -6,15 +6,23 @@
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/Team.h"
 #include "Sim/Objects/SolidObject.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Textures/3DOTextureHandler.h"
 #include "Rendering/Env/CubeMapHandler.h"
+#include "Rendering/Env/IWater.h"
 
 #include "System/Misc/TracyDefs.h"
 
 bool CModelDrawerHelper::ObjectVisibleReflection(const float3& objPos, const float3& camPos, float maxRadius)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// distant objects contribute a few texels at most to the (low-res) reflection
+	if (const float cullDist = IWater::GetWater()->GetReflectionCullDistance(); cullDist > 0.0f) {
+		if (objPos.SqDistance(camPos) > Square(cullDist + maxRadius))
+			return false;
+	}
+
 #if 1
 	// If the object is underwater then,
 	// draw the object if the water depth at the object is less than the units draw radius
@@ -37,6 +45,14 @@ bool CModelDrawerHelper::ObjectVisibleReflection(const float3& objPos, const flo
 #endif
 }
 
+void CModelDrawerHelper::RequestObjectTextureSize(const CSolidObject* o, float camDist, const CCamera* cam)
+{
+	// projected diameter in pixels
+	const float pixelSize = o->GetDrawRadius() * globalRendering->viewSizeY / (std::max(camDist, 1.0f) * cam->GetTanHalfFov());
+
+	textureHandlerS3O.RequestTextureSize(o->model->textureType, pixelSize);
+}
+
 void CModelDrawerHelper::EnableTexturesCommon()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -46,6 +62,9 @@ void CModelDrawerHelper::EnableTexturesCommon()
 	if (shadowHandler.ShadowsLoaded()) {
 		shadowHandler.SetupShadowTexSampler(GL_TEXTURE2, true);
 		glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, shadowHandler.GetColorTextureID());
+
+		if (shadowHandler.GetNumNearCascades() > 0)
+			shadowHandler.SetupShadowCascadeTexSampler(GL_TEXTURE6);
 	}
 
 	glActiveTexture(GL_TEXTURE4);
@@ -66,9 +85,13 @@ void CModelDrawerHelper::DisableTexturesCommon()
 	glActiveTexture(GL_TEXTURE1);
 	glDisable(GL_TEXTURE_2D);
 
-	if (shadowHandler.ShadowsLoaded())
+	if (shadowHandler.ShadowsLoaded()) {
 		shadowHandler.ResetShadowTexSampler(GL_TEXTURE2, true);
 
+		if (shadowHandler.GetNumNearCascades() > 0)
+			shadowHandler.ResetShadowCascadeTexSampler(GL_TEXTURE6);
+	}
+
 	glActiveTexture(GL_TEXTURE3);
 	glDisable(GL_TEXTURE_CUBE_MAP);
 
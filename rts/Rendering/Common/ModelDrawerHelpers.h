@@ -33,6 +33,8 @@ public:
 public:
 	// Auxilary
 	static bool ObjectVisibleReflection(const float3& objPos, const float3& camPos, float maxRadius);
+	// lets the texture handler stream in the mip levels <o> needs when drawn by <cam> at <camDist>
+	static void RequestObjectTextureSize(const CSolidObject* o, float camDist, const CCamera* cam);
 
 	static void EnableTexturesCommon();
 	static void DisableTexturesCommon();
@@ -326,6 +326,9 @@ void CModelDrawerStateGL4::Enable(bool deferredPass, bool alphaPass) const
 	float gtThreshold = mix(0.5, 0.1, static_cast<float>(alphaPass));
 	modelShader->SetUniform("alphaCtrl", gtThreshold, 1.0f, 0.0f, 0.0f); // test > 0.1 | 0.5
 
+	if (shadowHandler.ShadowsLoaded())
+		shadowHandler.SetShadowCascadeUniforms(modelShader);
+
 	// end of EnableCommon();
 }
 
@@ -40,7 +40,7 @@ enum ShaderCameraModes {
 enum ShaderMatrixModes {
 	NORMAL_MATMODE = 0,
 	STATIC_MATMODE = 1,
-	 ARRAY_MATMODE = 2, //future
+	 ARRAY_MATMODE = 2, //static pose, per-instance placement from S3DModelVAO
 };
 
 enum ShaderShadingModes {
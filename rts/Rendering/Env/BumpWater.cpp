@@ -43,6 +43,8 @@ using std::max;
 
 CONFIG(int, BumpWaterTexSizeReflection).defaultValue(512).headlessValue(32).minimumValue(32).description("Sets the size of the framebuffer texture used to store the reflection in Bumpmapped water.");
 CONFIG(int, BumpWaterReflection).defaultValue(1).headlessValue(0).minimumValue(0).maximumValue(2).description("Determines the amount of objects reflected in Bumpmapped water.\n0:=off, 1:=fast (skip terrain), 2:=full");
+CONFIG(int, BumpWaterReflectionUpdateRate).defaultValue(1).minimumValue(1).maximumValue(8).description("Rerender the reflection of Bumpmapped water only every Nth frame, the frames in between reproject the last one.");
+CONFIG(float, BumpWaterReflectionCullDistance).defaultValue(0.0f).minimumValue(0.0f).description("Objects farther away from the camera than this are not drawn into the reflection of Bumpmapped water.\n0:=unlimited");
 CONFIG(int, BumpWaterRefraction).defaultValue(1).headlessValue(0).minimumValue(0).maximumValue(1).description("Determines the method of refraction with Bumpmapped water.\n0:=off, 1:=screencopy, 2:=own rendering cycle (disabled)");
 CONFIG(float, BumpWaterAnisotropy).defaultValue(0.0f).minimumValue(0.0f);
 CONFIG(bool, BumpWaterUseDepthTexture).defaultValue(true).headlessValue(false);
@@ -206,6 +208,9 @@ void CBumpWater::InitResources(bool loadShader)
 	// LOAD USER CONFIGS
 	reflTexSize  = std::bit_ceil <uint32_t> (configHandler->GetInt("BumpWaterTexSizeReflection"));
 	reflection   = configHandler->GetInt("BumpWaterReflection");
+	reflUpdateRate = configHandler->GetInt("BumpWaterReflectionUpdateRate");
+	reflCullDist = configHandler->GetFloat("BumpWaterReflectionCullDistance");
+	reflStale    = true;
 	refraction   = configHandler->GetInt("BumpWaterRefraction");
 	anisotropy   = configHandler->GetFloat("BumpWaterAnisotropy");
 	depthCopy    = configHandler->GetBool("BumpWaterUseDepthTexture");
@@ -419,6 +424,7 @@ void CBumpWater::InitResources(bool loadShader)
 	if (shoreWaves)   definitions += "#define opt_shorewaves\n";
 	if (depthCopy)    definitions += "#define opt_depth\n";
 	if (blurRefl)     definitions += "#define opt_blurreflection\n";
+	if (reflection > 0 && reflUpdateRate > 1) definitions += "#define opt_reflreproject\n";
 	if (endlessOcean) definitions += "#define opt_endlessocean\n";
 
 	GLSLDefineConstf3(definitions, "MapMid",                    float3(mapDims.mapx * SQUARE_SIZE * 0.5f, 0.0f, mapDims.mapy * SQUARE_SIZE * 0.5f));
@@ -566,7 +572,7 @@ void CBumpWater::UpdateWater(const CGame* game)
 
 	glPushAttrib(GL_FOG_BIT);
 	if (refraction > 1) DrawRefraction(game);
-	if (reflection > 0) DrawReflection(game);
+	if (reflection > 0 && (reflStale || (globalRendering->drawFrame % reflUpdateRate) == 0)) DrawReflection(game);
 	if (reflection || refraction) {
 		FBO::Unbind();
 		globalRendering->LoadViewport();
@@ -932,6 +938,9 @@ void CBumpWater::Draw()
 	waterShader->SetUniform("eyePos", camera->GetPos().x, camera->GetPos().y, camera->GetPos().z);
 	waterShader->SetUniform("frame", (gs->frameNum + globalRendering->timeOffset) / 15000.0f);
 
+	if (reflection > 0 && reflUpdateRate > 1)
+		waterShader->SetUniformMatrix4x4("reflViewProjMatrix", false, &reflViewProjMatrix.m[0]);
+
 	if (shadowHandler.ShadowsLoaded()) {
 		waterShader->SetUniformMatrix4x4("shadowMatrix", false, shadowHandler.GetShadowMatrixRaw());
 
@@ -1026,6 +1035,11 @@ void CBumpWater::DrawReflection(const CGame* game)
 	CCamera* prvCam = CCameraHandler::GetSetActiveCamera(CCamera::CAMTYPE_UWREFL);
 	CCamera* curCam = CCameraHandler::GetActiveCamera();
 
+	// the water shader maps screen- to reflection-coordinates, on frames
+	// without a reflection pass it has to use the screen of this frame
+	reflViewProjMatrix = prvCam->GetViewProjectionMatrix();
+	reflStale = false;
+
 	{
 		curCam->CopyStateReflect(prvCam);
 		curCam->UpdateLoadViewport(0, 0, reflTexSize, reflTexSize);
@@ -8,6 +8,8 @@
 #include "Rendering/GL/RenderBuffers.h"
 #include "IWater.h"
 
+#include "System/Matrix44f.h"
+
 #include "System/EventClient.h"
 #include "System/Misc/RectangleOverlapHandler.h"
 
@@ -41,6 +43,7 @@ public:
 
 	bool CanDrawReflectionPass() const override { return true; }
 	bool CanDrawRefractionPass() const override { return true; }
+	float GetReflectionCullDistance() const override { return reflCullDist; }
 private:
 	//! coastmap (needed for shorewaves)
 	struct CoastAtlasRect {
@@ -71,6 +74,8 @@ private:
 	char  reflection;   ///< 0:=off, 1:=don't render the terrain, 2:=render everything+terrain
 	char  refraction;   ///< 0:=off, 1:=screencopy, 2:=own rendering cycle
 	int   reflTexSize;
+	int   reflUpdateRate; ///< rerender the reflection every Nth draw-frame, reproject it in between
+	float reflCullDist;   ///< max. distance of reflected objects, 0:=unlimited
 	bool  depthCopy;    ///< uses a screen depth copy, which allows a nicer interpolation between deep sea and shallow water
 	float anisotropy;
 	char  depthBits;    ///< depthBits for reflection/refraction RBO
@@ -79,6 +84,9 @@ private:
 	bool  endlessOcean; ///< render the water around the whole map
 	bool  dynWaves;     ///< only usable if bumpmap/normal texture is a TileSet
 
+	bool reflStale;                 ///< reflection has to be rerendered next frame
+	CMatrix44f reflViewProjMatrix;  ///< player camera view-projection the reflection was rendered with
+
 	std::vector<uint8_t> tileOffsets; ///< used to randomize the wave/bumpmap/normal texture
 	int  normalTextureX; ///< needed for dynamic waves
 	int  normalTextureY;
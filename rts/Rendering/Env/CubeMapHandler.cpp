@@ -14,12 +14,17 @@
 #include "Rendering/Env/ISky.h"
 #include "Rendering/Env/SunLighting.h"
 #include "Rendering/Env/CubeMapHandler.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Rendering/Shaders/ShaderHandler.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
 
 #include "System/Misc/TracyDefs.h"
 
 CONFIG(int, CubeTexSizeSpecular).defaultValue(128).minimumValue(1).description("The square resolution of each face of the specular cubemap.");
 CONFIG(int, CubeTexSizeReflection).defaultValue(128).minimumValue(1).description("The square resolution of each face of the environment reflection cubemap.");
+CONFIG(int, CubeTexReflectionUpdateRate).defaultValue(1).minimumValue(1).maximumValue(30).description("Render one face of the environment reflection cubemap only every Nth frame.");
+CONFIG(bool, CubeTexSpecularCompute).defaultValue(true).headlessValue(false).safemodeValue(false).description("Regenerate the specular cubemap with a compute shader, instead of spreading it over frames on the CPU.");
 CONFIG(bool, CubeTexGenerateMipMaps).defaultValue(false).description("Generate mipmaps for the reflection and specular cubemap textures, useful for efficient subsampling and blurring.");
 
 CubeMapHandler cubeMapHandler;
@@ -40,6 +45,7 @@ bool CubeMapHandler::Init() {
 	specTexFaceBuf.resize(specTexSize * specTexSize * 4, 0);
 
 	currReflectionFace = 0;
+	reflUpdateRate = configHandler->GetInt("CubeTexReflectionUpdateRate");
 	specularTexIter = 0;
 
 	mapSkyReflections = (!mapInfo->smf.skyReflectModTexName.empty());
@@ -98,6 +104,9 @@ bool CubeMapHandler::Init() {
 
 	glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
+	if (configHandler->GetBool("CubeTexSpecularCompute") && !CreateSpecularShader())
+		LOG_L(L_WARNING, "[CubeMapHandler::%s] compute shader specular cubemap requested, but not supported", __func__);
+
 	// reflectionCubeFBO is no-op constructed, has to be initialized manually
 	reflectionCubeFBO.Init(false);
 
@@ -114,6 +123,10 @@ bool CubeMapHandler::Init() {
 
 void CubeMapHandler::Free() {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (specularShader != nullptr) {
+		shaderHandler->ReleaseProgramObjects("[CubeMapHandler]");
+		specularShader = nullptr;
+	}
 	if (specularTexID != 0) {
 		glDeleteTextures(1, &specularTexID);
 		specularTexID = 0;
@@ -132,9 +145,58 @@ void CubeMapHandler::Free() {
 
 
 
+bool CubeMapHandler::CreateSpecularShader()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!globalRendering->haveGL4)
+		return false;
+	if (!GLAD_GL_ARB_compute_shader || !GLAD_GL_ARB_shader_image_load_store)
+		return false;
+
+	specularShader = shaderHandler->CreateProgramObject("[CubeMapHandler]", "Specular");
+	specularShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/CubeMapSpecularCompProg.glsl", "", GL_COMPUTE_SHADER));
+	specularShader->Link();
+
+	specularShader->Enable();
+	specularShader->SetUniform("specularImg", 0);
+	specularShader->SetUniform("texSize", static_cast<int>(specTexSize));
+	specularShader->Disable();
+	specularShader->Validate();
+
+	if (specularShader->IsValid())
+		return true;
+
+	shaderHandler->ReleaseProgramObjects("[CubeMapHandler]");
+	specularShader = nullptr;
+	return false;
+}
+
+void CubeMapHandler::DispatchSpecularShader()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static constexpr unsigned int GROUP_SIZE = 8;
+
+	const float3 lightDir = ISky::GetSky()->GetLight()->GetLightDir();
+
+	specularShader->Enable();
+	specularShader->SetUniform("lightDir", lightDir.x, lightDir.y, lightDir.z);
+	specularShader->SetUniform4v("specularColor", &sunLighting->modelSpecularColor.x);
+	specularShader->SetUniform("specularExponent", sunLighting->specularExponent);
+
+	glBindImageTexture(0, specularTexID, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+	glDispatchCompute((specTexSize + GROUP_SIZE - 1) / GROUP_SIZE, (specTexSize + GROUP_SIZE - 1) / GROUP_SIZE, 6);
+	glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+	glBindImageTexture(0, 0, 0, GL_TRUE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+	specularShader->Disable();
+}
+
+
 void CubeMapHandler::UpdateReflectionTexture()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if ((globalRendering->drawFrame % reflUpdateRate) != 0)
+		return;
 
 	// NOTE:
 	//   we unbind later in WorldDrawer::GenerateIBLTextures() to save render
@@ -248,6 +310,10 @@ void CubeMapHandler::CreateReflectionFace(unsigned int glFace, bool skyOnly)
 void CubeMapHandler::UpdateSpecularTexture()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (specularShader != nullptr) {
+		DispatchSpecularShader();
+		return;
+	}
 
 	glBindTexture(GL_TEXTURE_CUBE_MAP, specularTexID);
 
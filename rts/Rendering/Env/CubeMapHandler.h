@@ -5,6 +5,10 @@
 
 #include "Rendering/GL/FBO.h"
 
+namespace Shader {
+	struct IProgramObject;
+}
+
 class CubeMapHandler {
 public:
 	CubeMapHandler(): reflectionCubeFBO(true) {}
@@ -22,6 +26,9 @@ public:
 	unsigned int GetSpecularTextureSize() const { return specTexSize; }
 
 private:
+	bool CreateSpecularShader();
+	void DispatchSpecularShader();
+
 	void CreateReflectionFace(unsigned int, bool);
 	void CreateSpecularFacePart(unsigned int, unsigned int, const float3&, const float3&, const float3&, unsigned int, unsigned char*);
 	void CreateSpecularFace(unsigned int, unsigned int, const float3&, const float3&, const float3&);
@@ -35,6 +42,7 @@ private:
 	unsigned int specTexSize;
 
 	unsigned int currReflectionFace;
+	unsigned int reflUpdateRate; // draw-frames per reflection face
 	unsigned int specularTexIter;
 
 	bool mapSkyReflections;
@@ -45,6 +53,9 @@ private:
 
 	FBO reflectionCubeFBO;
 
+	// regenerates the whole specular cubemap in one dispatch, rows are spread over frames otherwise
+	Shader::IProgramObject* specularShader = nullptr;
+
 	/*
 	GL_TEXTURE_CUBE_MAP_POSITIVE_X
 	GL_TEXTURE_CUBE_MAP_NEGATIVE_X
@@ -7,6 +7,7 @@
 #include "GroundDecal.h"
 #include "GroundDecalHandler.h"
 #include "Game/Camera.h"
+#include "Game/CameraHandler.h"
 #include "Game/GameHelper.h"
 #include "Game/GameSetup.h"
 #include "Game/GlobalUnsynced.h"
@@ -59,6 +60,7 @@
 
 CONFIG(int, GroundScarAlphaFade).deprecated(true);
 CONFIG(bool, HighQualityDecals).defaultValue(false).description("Forces MSAA processing of decals. Improves decals quality, but may ruin the performance.");
+CONFIG(bool, BinnedDecals).defaultValue(true).description("Bins decals into map tiles and only submits those of the tiles in view instead of all of them.");
 
 CR_BIND(CGroundDecalHandlerData::UnitMinMaxHeight, )
 CR_REG_METADATA_SUB(CGroundDecalHandlerData, UnitMinMaxHeight,
@@ -123,7 +125,7 @@ CGroundDecalHandler::CGroundDecalHandler()
 	eventHandler.AddClient(this);
 	CExplosionCreator::AddExplosionListener(this);
 
-	configHandler->NotifyOnChange(this, { "HighQualityDecals" });
+	configHandler->NotifyOnChange(this, { "HighQualityDecals", "BinnedDecals" });
 
 	smfDrawer = dynamic_cast<CSMFGroundDrawer*>(readMap->GetGroundDrawer());
 
@@ -135,6 +137,13 @@ CGroundDecalHandler::CGroundDecalHandler()
 	decals.reserve(1 << 16);
 	decalsUpdateList.Reserve(decals.capacity());
 
+	numDecalTilesX = (mapDims.mapx * SQUARE_SIZE + DECAL_TILE_SIZE - 1) / DECAL_TILE_SIZE;
+	numDecalTilesZ = (mapDims.mapy * SQUARE_SIZE + DECAL_TILE_SIZE - 1) / DECAL_TILE_SIZE;
+	decalTiles.resize(numDecalTilesX * numDecalTilesZ);
+
+	// the visible runs of the instance buffer are submitted as one indirect draw
+	drawBinnedDecals = configHandler->GetBool("BinnedDecals") && GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_base_instance;
+
 	nextId = 0;
 }
 
@@ -759,6 +768,7 @@ void CGroundDecalHandler::Draw()
 	}
 
 	if (decalsUpdateList.NeedUpdate()) {
+		decalTilesDirty = true;
 		instVBO.Bind();
 
 		for (auto itPair = decalsUpdateList.GetNext(); itPair.has_value(); itPair = decalsUpdateList.GetNext(itPair)) {
@@ -772,6 +782,14 @@ void CGroundDecalHandler::Draw()
 		decalsUpdateList.ResetNeedUpdateAll();
 	}
 
+	if (drawBinnedDecals) {
+		if (decalTilesDirty)
+			UpdateDecalTiles();
+
+		if (!GatherVisibleDecals(CCameraHandler::GetActiveCamera()))
+			return;
+	}
+
 	using namespace GL::State;
 
 	auto state = GL::SubState(
@@ -806,7 +824,10 @@ void CGroundDecalHandler::Draw()
 		decalShader->SetUniformMatrix4x4("shadowMatrix", false, shadowHandler.GetShadowMatrixRaw());
 
 	vao.Bind();
-	glDrawArraysInstanced(GL_TRIANGLES, 0, 36, decals.size());
+	if (drawBinnedDecals)
+		glMultiDrawArraysIndirect(GL_TRIANGLES, drawCommands.data(), drawCommands.size(), sizeof(SDrawArraysIndirectCommand));
+	else
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 36, decals.size());
 	vao.Unbind();
 
 	decalShader->Disable();
@@ -1554,6 +1575,104 @@ void CGroundDecalHandler::UpdateDecalsVisibility()
 	}
 }
 
+void CGroundDecalHandler::UpdateDecalTiles()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (auto& tile : decalTiles) {
+		tile.decalIndices.clear();
+		tile.maxRadius = 0.0f;
+	}
+
+	for (size_t i = 0; i < decals.size(); ++i) {
+		const auto& decal = decals[i];
+
+		if (!decal.IsValid())
+			continue;
+
+		const float2 midPos = (decal.posTL + decal.posTR + decal.posBR + decal.posBL) * 0.25f;
+
+		const int tx = std::clamp(static_cast<int>(midPos.x) / DECAL_TILE_SIZE, 0, numDecalTilesX - 1);
+		const int tz = std::clamp(static_cast<int>(midPos.y) / DECAL_TILE_SIZE, 0, numDecalTilesZ - 1);
+
+		// the box extends <height> along the (possibly tilted) normal, forced heights
+		// may lift it off the ground within [minHeight, maxHeight] of its reference
+		float radius = 0.0f;
+		radius = std::max(radius, midPos.Distance(decal.posTL));
+		radius = std::max(radius, midPos.Distance(decal.posTR));
+		radius = std::max(radius, midPos.Distance(decal.posBR));
+		radius = std::max(radius, midPos.Distance(decal.posBL));
+		radius += std::fabs(decal.height);
+
+		if (decal.forceHeightMode != 0.0f)
+			radius += std::max(std::fabs(decal.minHeight), std::fabs(decal.maxHeight));
+
+		auto& tile = decalTiles[tz * numDecalTilesX + tx];
+		tile.decalIndices.push_back(static_cast<uint32_t>(i));
+		tile.maxRadius = std::max(tile.maxRadius, radius);
+	}
+
+	decalTilesDirty = false;
+}
+
+bool CGroundDecalHandler::GatherVisibleDecals(const CCamera* cam)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	visibleDecals.clear();
+	drawCommands.clear();
+
+	const float curAdjustedFrame = std::max(gs->frameNum, 0) + globalRendering->timeOffset;
+
+	for (int tz = 0; tz < numDecalTilesZ; ++tz) {
+		for (int tx = 0; tx < numDecalTilesX; ++tx) {
+			const auto& tile = decalTiles[tz * numDecalTilesX + tx];
+
+			if (tile.decalIndices.empty())
+				continue;
+
+			const float3 mins = {
+				tx * DECAL_TILE_SIZE - tile.maxRadius,
+				readMap->GetCurrMinHeight() - tile.maxRadius,
+				tz * DECAL_TILE_SIZE - tile.maxRadius
+			};
+			const float3 maxs = {
+				(tx + 1) * DECAL_TILE_SIZE + tile.maxRadius,
+				readMap->GetCurrMaxHeight() + tile.maxRadius,
+				(tz + 1) * DECAL_TILE_SIZE + tile.maxRadius
+			};
+
+			if (!cam->InView(mins, maxs))
+				continue;
+
+			for (const uint32_t i : tile.decalIndices) {
+				const auto& decal = decals[i];
+
+				// same early-out as the vertex shader
+				const float alphaMax = (decal.alpha - (curAdjustedFrame - decal.createFrameMax) * decal.alphaFalloff) * decal.visMult;
+				if (alphaMax <= 0.0f)
+					continue;
+
+				visibleDecals.push_back(i);
+			}
+		}
+	}
+
+	// keep the submission order of the decals vector, decals are blended on top of each other
+	std::sort(visibleDecals.begin(), visibleDecals.end());
+
+	for (const uint32_t i : visibleDecals) {
+		if (!drawCommands.empty()) {
+			if (auto& cmd = drawCommands.back(); cmd.baseInstance + cmd.instanceCount == i) {
+				cmd.instanceCount++;
+				continue;
+			}
+		}
+
+		drawCommands.emplace_back(36, 1, 0, i);
+	}
+
+	return !drawCommands.empty();
+}
+
 void CGroundDecalHandler::GameFramePost(int frameNum)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -1646,6 +1765,12 @@ void CGroundDecalHandler::ExplosionOccurred(const CExplosionParams& event) {
 void CGroundDecalHandler::ConfigNotify(const std::string& key, const std::string& value)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (key == "BinnedDecals") {
+		drawBinnedDecals = configHandler->GetBool("BinnedDecals") && GLAD_GL_ARB_multi_draw_indirect && GLAD_GL_ARB_base_instance;
+		decalTilesDirty = true;
+		return;
+	}
+
 	if (key != "HighQualityDecals")
 		return;
 
@@ -12,6 +12,7 @@
 #include "Rendering/Env/IGroundDecalDrawer.h"
 #include "Rendering/GL/VBO.h"
 #include "Rendering/GL/VAO.h"
+#include "Rendering/GL/myGL.h"
 #include "Rendering/DepthBufferCopy.h"
 #include "Rendering/Textures/TextureRenderAtlas.h"
 #include "Rendering/Common/UpdateList.h"
@@ -28,6 +29,7 @@ class CTextureAtlas;
 class CSMFGroundDrawer;
 class GhostSolidObject;
 class CColorMap;
+class CCamera;
 
 namespace Shader {
 	struct IProgramObject;
@@ -203,6 +205,9 @@ private:
 
 	void UpdateDecalsVisibility();
 
+	void UpdateDecalTiles();
+	bool GatherVisibleDecals(const CCamera* cam);
+
 	void AddBuildingDecalTextures();
 	void AddTexturesFromTable();
 	void AddGroundTrackTextures();
@@ -211,4 +216,23 @@ private:
 	uint32_t GetNextId();
 
 	static constexpr uint32_t TRACKS_UPDATE_RATE = 4u;
+private:
+	// decals binned into square map tiles by their midpoint, the tiles are
+	// culled as a whole and only the decals of visible ones are submitted
+	struct DecalTile {
+		std::vector<uint32_t> decalIndices;
+		float maxRadius = 0.0f;
+	};
+
+	static constexpr int DECAL_TILE_SIZE = SQUARE_SIZE * 64;
+
+	std::vector<DecalTile> decalTiles;
+	int numDecalTilesX = 0;
+	int numDecalTilesZ = 0;
+	bool decalTilesDirty = true;
+
+	bool drawBinnedDecals = false;
+
+	std::vector<uint32_t> visibleDecals;
+	std::vector<SDrawArraysIndirectCommand> drawCommands;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <cmath>
+#include <cstddef>
 
 #include "GrassDrawer.h"
 #include "Game/Camera.h"
@@ -35,6 +36,7 @@
 #include "System/Misc/TracyDefs.h"
 
 CONFIG(int, GrassDetail).defaultValue(7).headlessValue(0).minimumValue(0).description("Sets how detailed the engine rendered grass will be on any given map.");
+CONFIG(bool, GPUGrass).defaultValue(false).headlessValue(false).description("Generate, cull and fade grass turfs on the GPU instead of per grass block on the CPU, requires compute shader support.");
 
 // uses a 'synced' RNG s.t. grass turfs generated from the same
 // seed also share identical sequences, otherwise an unpleasant
@@ -54,6 +56,11 @@ static constexpr int   blockMapSize    = grassSquareSize * grassBlockSize;
 static constexpr int   GSSSQ = SQUARE_SIZE * grassSquareSize;
 static constexpr int   BMSSQ = SQUARE_SIZE * blockMapSize;
 
+static constexpr int   GRASS_CULL_GROUP_SIZE = 8;
+
+static constexpr uint32_t INSTANCES_SSBO_BINDING_IDX = 13;
+static constexpr uint32_t COMMANDS_SSBO_BINDING_IDX  = 14;
+
 static GrassRNG grng;
 
 
@@ -190,6 +197,13 @@ CGrassDrawer::CGrassDrawer()
 , grassOff(false)
 , updateBillboards(false)
 , updateVisibility(false)
+, gpuGrass(false)
+, updateDensityTex(false)
+, grassDensityTex(0)
+, cullShader(nullptr)
+, numBladeIndices(0)
+, maxGPUInstances(0)
+, gpuCullRadius(0)
 {
 	blockDrawer.ResetState();
 	grng.Seed(15);
@@ -252,6 +266,12 @@ CGrassDrawer::CGrassDrawer()
 	farnearVA.Initialize();
 	grassDL = glGenLists(1);
 
+	gpuGrass = configHandler->GetBool("GPUGrass");
+	gpuGrass &= (globalRendering->haveGL4 && GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object && GLAD_GL_ARB_draw_indirect);
+
+	if (gpuGrass)
+		CreateGPUResources();
+
 	ChangeDetail(detail);
 	LoadGrassShaders();
 	configHandler->NotifyOnChange(this, {"GrassDetail"});
@@ -270,6 +290,7 @@ CGrassDrawer::~CGrassDrawer()
 	glDeleteLists(grassDL, 1);
 	glDeleteTextures(1, &grassBladeTex);
 	glDeleteTextures(1, &farTex);
+	glDeleteTextures(1, &grassDensityTex);
 	shaderHandler->ReleaseProgramObjects("[GrassDrawer]");
 }
 
@@ -289,6 +310,9 @@ void CGrassDrawer::ChangeDetail(int detail) {
 	CreateGrassDispList(grassDL);
 	CreateFarTex();
 
+	if (gpuGrass)
+		ResizeGPUInstances();
+
 	// reset  all cached blocks
 	for (GrassStruct& pGS: grass) {
 		ResetPos(pGS.posX, pGS.posZ);
@@ -310,17 +334,29 @@ void CGrassDrawer::LoadGrassShaders() {
 	static const std::string shaderNames[GRASS_PROGRAM_LAST] = {
 		"grassNearAdvShader",
 		"grassDistAdvShader",
-		"grassShadGenShader"
+		"grassShadGenShader",
+		"grassNearGPUShader",
+		"grassDistGPUShader"
 	};
 	static const std::string shaderDefines[GRASS_PROGRAM_LAST] = {
 		"#define DISTANCE_NEAR\n",
 		"#define DISTANCE_FAR\n",
-		"#define SHADOW_GEN\n"
+		"#define SHADOW_GEN\n",
+		"#define DISTANCE_NEAR\n",
+		"#define DISTANCE_FAR\n"
 	};
 
 	for (int i = 0; i < GRASS_PROGRAM_LAST; i++) {
+		const bool gpuProgram = (i == GRASS_PROGRAM_GPU_NEAR || i == GRASS_PROGRAM_GPU_DIST);
+
+		if (gpuProgram && !gpuGrass)
+			continue;
+
+		// the GPU programs take their turfs from the instances SSBO, but shade them the same way
+		const std::string vertProgName = gpuProgram ? "GLSL/GrassGPUVertProg.glsl" : "GLSL/GrassVertProg.glsl";
+
 		grassShaders[i] = sh->CreateProgramObject("[GrassDrawer]", shaderNames[i] + "GLSL");
-		grassShaders[i]->AttachShaderObject(sh->CreateShaderObject("GLSL/GrassVertProg.glsl", shaderDefines[i], GL_VERTEX_SHADER));
+		grassShaders[i]->AttachShaderObject(sh->CreateShaderObject(vertProgName, shaderDefines[i], GL_VERTEX_SHADER));
 		grassShaders[i]->AttachShaderObject(sh->CreateShaderObject("GLSL/GrassFragProg.glsl", shaderDefines[i], GL_FRAGMENT_SHADER));
 		grassShaders[i]->Link();
 
@@ -338,13 +374,46 @@ void CGrassDrawer::LoadGrassShaders() {
 		grassShaders[i]->SetUniform("groundShadowDensity", sunLighting->groundShadowDensity);
 		grassShaders[i]->SetUniformMatrix4x4("shadowMatrix", false, shadowHandler.GetShadowMatrixRaw());
 		grassShaders[i]->SetUniform4v("shadowParams", &shadowHandler.GetShadowParams().x);
+		if (gpuProgram) {
+			grassShaders[i]->SetUniform("turfSize", partTurfSize);
+			grassShaders[i]->SetUniform("farInstanceOffset", 0);
+		}
 		grassShaders[i]->Disable();
 		grassShaders[i]->Validate();
 
+		// fall back to the CPU path
+		if (gpuProgram) {
+			gpuGrass &= grassShaders[i]->IsValid();
+			continue;
+		}
+
 		if ((grassOff = !grassShaders[i]->IsValid()))
 			break;
 	}
 
+	if (gpuGrass) {
+		cullShader = sh->CreateProgramObject("[GrassDrawer]", "grassCullGPUShader");
+		cullShader->AttachShaderObject(sh->CreateShaderObject("GLSL/GrassCullCompProg.glsl", "", GL_COMPUTE_SHADER));
+		cullShader->Link();
+
+		cullShader->Enable();
+		cullShader->SetUniform("grassDensityTex", 0);
+		cullShader->SetUniform("heightTex", 1);
+		cullShader->SetUniform("mapDims",
+			static_cast<float>(mapDims.mapx * SQUARE_SIZE),
+			static_cast<float>(mapDims.mapy * SQUARE_SIZE),
+			1.0f / (mapDims.mapx * SQUARE_SIZE),
+			1.0f / (mapDims.mapy * SQUARE_SIZE)
+		);
+		cullShader->SetUniform("grassSquareSize", static_cast<float>(GSSSQ));
+		cullShader->SetUniform("turfSize", partTurfSize);
+		cullShader->SetUniform("bladeHeight", mapInfo->grass.bladeHeight);
+		cullShader->Disable();
+		cullShader->Validate();
+
+		gpuGrass &= cullShader->IsValid();
+	}
+
 	#undef sh
 }
 
@@ -511,9 +580,210 @@ void CGrassDrawer::DrawNearBillboards(const std::vector<InviewNearGrass>& inview
 }
 
 
+void CGrassDrawer::CreateGPUResources()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	glGenTextures(1, &grassDensityTex);
+	glBindTexture(GL_TEXTURE_2D, grassDensityTex);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	RecoilTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, mapDims.mapx / grassSquareSize, mapDims.mapy / grassSquareSize);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	updateDensityTex = true;
+
+	bladeVBO      = VBO{ GL_ARRAY_BUFFER        , false };
+	bladeIBO      = VBO{ GL_ELEMENT_ARRAY_BUFFER, false };
+	instancesSSBO = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+	commandsSSBO  = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+
+	commandsSSBO.Bind();
+	commandsSSBO.New(sizeof(SDrawElementsIndirectCommand) + sizeof(SDrawArraysIndirectCommand), GL_DYNAMIC_DRAW);
+	commandsSSBO.Unbind();
+}
+
+
+void CGrassDrawer::CreateGPUBladeMesh(const std::vector<VA_TYPE_TN>& verts, const std::vector<uint32_t>& stripEnds)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<uint32_t> indices;
+	indices.reserve(verts.size() * 3);
+
+	// one triangle list for all blade strips, keeping the winding of each strip
+	for (uint32_t s = 0, first = 0; s < stripEnds.size(); first = stripEnds[s++]) {
+		for (uint32_t k = first; (k + 2) < stripEnds[s]; ++k) {
+			if (((k - first) & 1) == 0)
+				indices.insert(indices.end(), { k    , k + 1, k + 2 });
+			else
+				indices.insert(indices.end(), { k + 1, k    , k + 2 });
+		}
+	}
+
+	numBladeIndices = static_cast<uint32_t>(indices.size());
+
+	bladeVAO.Bind();
+
+	bladeVBO.Bind();
+	bladeVBO.New(verts, GL_STATIC_DRAW);
+	bladeIBO.Bind();
+	bladeIBO.New(indices, GL_STATIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VA_TYPE_TN), reinterpret_cast<const void*>(offsetof(VA_TYPE_TN, pos)));
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(VA_TYPE_TN), reinterpret_cast<const void*>(offsetof(VA_TYPE_TN, s  )));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(VA_TYPE_TN), reinterpret_cast<const void*>(offsetof(VA_TYPE_TN, n  )));
+
+	bladeVAO.Unbind();
+
+	glDisableVertexAttribArray(0);
+	glDisableVertexAttribArray(1);
+	glDisableVertexAttribArray(2);
+
+	bladeIBO.Unbind();
+	bladeVBO.Unbind();
+}
+
+
+void CGrassDrawer::ResizeGPUInstances()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the cull window holds every grass square that can be within maxGrassDist of the
+	// camera, so the instance lists can never overflow
+	gpuCullRadius = static_cast<int>(maxGrassDist / GSSSQ) + 1;
+	maxGPUInstances = Square(2 * gpuCullRadius + 1) * numTurfs;
+
+	instancesSSBO.Bind();
+	instancesSSBO.New(2 * maxGPUInstances * sizeof(float4), GL_DYNAMIC_DRAW);
+	instancesSSBO.Unbind();
+}
+
+
+void CGrassDrawer::CullGPU(const CCamera* cam)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int grassMapX = mapDims.mapx / grassSquareSize;
+	const int grassMapY = mapDims.mapy / grassSquareSize;
+
+	if (updateDensityTex) {
+		glBindTexture(GL_TEXTURE_2D, grassDensityTex);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, grassMapX, grassMapY, GL_RED, GL_UNSIGNED_BYTE, grassMap.data());
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		updateDensityTex = false;
+	}
+
+	const float3& camPos = cam->GetPos();
+
+	const int cx = static_cast<int>(camPos.x / GSSSQ);
+	const int cz = static_cast<int>(camPos.z / GSSSQ);
+
+	const int x1 = std::clamp(cx - gpuCullRadius, 0, grassMapX);
+	const int z1 = std::clamp(cz - gpuCullRadius, 0, grassMapY);
+	const int x2 = std::clamp(cx + gpuCullRadius + 1, 0, grassMapX);
+	const int z2 = std::clamp(cz + gpuCullRadius + 1, 0, grassMapY);
+
+	const SDrawElementsIndirectCommand meshCmd = { numBladeIndices, 0, 0, 0, 0 };
+	const SDrawArraysIndirectCommand billboardCmd = { 6, 0, 0, 0 };
+
+	commandsSSBO.Bind();
+	commandsSSBO.SetBufferSubData(0, sizeof(meshCmd), &meshCmd);
+	commandsSSBO.SetBufferSubData(sizeof(meshCmd), sizeof(billboardCmd), &billboardCmd);
+	commandsSSBO.Unbind();
+
+	if (x1 >= x2 || z1 >= z2)
+		return;
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, readMap->GetHeightMapTexture());
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, grassDensityTex);
+
+	instancesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instancesSSBO.GetSize());
+	commandsSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMANDS_SSBO_BINDING_IDX, 0, commandsSSBO.GetSize());
+
+	cullShader->Enable();
+	cullShader->SetUniform("windowOrigin", x1, z1);
+	cullShader->SetUniform("windowSize", x2 - x1, z2 - z1);
+	cullShader->SetUniform("grassMapSizeX", grassMapX);
+	cullShader->SetUniform("numTurfs", numTurfs);
+	cullShader->SetUniform("maxInstances", static_cast<int>(maxGPUInstances));
+	cullShader->SetUniform("maxGrassDist", maxGrassDist);
+	cullShader->SetUniform("maxDetailedDist", maxDetailedDist);
+	cullShader->SetUniform("camPos", camPos.x, camPos.y, camPos.z);
+	cullShader->SetUniform4v("frustumPlanes", CCamera::FRUSTUM_PLANE_CNT, &cam->GetFrustum().planes[0].x);
+	cullShader->SetUniform("frustumPlanesMask", static_cast<int>(cam->GetInViewPlanesMask()));
+
+	glDispatchCompute(
+		(x2 - x1 + GRASS_CULL_GROUP_SIZE - 1) / GRASS_CULL_GROUP_SIZE,
+		(z2 - z1 + GRASS_CULL_GROUP_SIZE - 1) / GRASS_CULL_GROUP_SIZE,
+		1
+	);
+
+	cullShader->Disable();
+
+	commandsSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMANDS_SSBO_BINDING_IDX, 0, commandsSSBO.GetSize());
+	instancesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instancesSSBO.GetSize());
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+
+void CGrassDrawer::DrawGPU()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// grass is never drawn in any special (non-opaque) pass
+	CullGPU(CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER));
+
+	glPushAttrib(GL_CURRENT_BIT);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+	instancesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instancesSSBO.GetSize());
+
+	SetupGlStateNear(GRASS_PROGRAM_GPU_NEAR);
+		bladeVAO.Bind();
+		commandsSSBO.Bind(GL_DRAW_INDIRECT_BUFFER);
+		glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr);
+		commandsSSBO.Unbind();
+		bladeVAO.Unbind();
+	ResetGlStateNear();
+
+	// ATI crashes w/o an error when shadows are enabled!?
+	const bool shadows = (shadowHandler.ShadowsLoaded() && globalRendering->amdHacks);
+
+	if (!shadows) {
+		SetupGlStateFar(GRASS_PROGRAM_GPU_DIST);
+			grassShader->SetUniform("farInstanceOffset", static_cast<int>(maxGPUInstances));
+
+			billboardVAO.Bind();
+			commandsSSBO.Bind(GL_DRAW_INDIRECT_BUFFER);
+			glDrawArraysIndirect(GL_TRIANGLES, reinterpret_cast<const void*>(sizeof(SDrawElementsIndirectCommand)));
+			commandsSSBO.Unbind();
+			billboardVAO.Unbind();
+		ResetGlStateFar();
+	}
+
+	instancesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instancesSSBO.GetSize());
+
+	glPopAttrib();
+}
+
+
 void CGrassDrawer::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// turfs are generated at draw time
+	if (gpuGrass)
+		return;
+
 	// grass is never drawn in any special (non-opaque) pass
 	const CCamera* cam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
 
@@ -564,6 +834,11 @@ void CGrassDrawer::Draw()
 	if (grassOff || !readMap->GetGrassShadingTexture())
 		return;
 
+	if (gpuGrass) {
+		DrawGPU();
+		return;
+	}
+
 	glPushAttrib(GL_CURRENT_BIT);
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 
@@ -639,7 +914,7 @@ void CGrassDrawer::DrawShadow()
 }
 
 
-void CGrassDrawer::SetupGlStateNear()
+void CGrassDrawer::SetupGlStateNear(const GrassShaderProgram type)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// bind textures
@@ -657,7 +932,7 @@ void CGrassDrawer::SetupGlStateNear()
 	}
 
 	// bind shader
-	EnableShader(GRASS_PROGRAM_NEAR);
+	EnableShader(type);
 
 	if (shadowHandler.ShadowsLoaded()) {
 		shadowHandler.SetupShadowTexSampler(GL_TEXTURE4);
@@ -705,7 +980,7 @@ void CGrassDrawer::ResetGlStateNear()
 }
 
 
-void CGrassDrawer::SetupGlStateFar()
+void CGrassDrawer::SetupGlStateFar(const GrassShaderProgram type)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	//glEnable(GL_ALPHA_TEST);
@@ -721,7 +996,7 @@ void CGrassDrawer::SetupGlStateFar()
 		glPushMatrix();
 		glLoadIdentity();
 
-	EnableShader(GRASS_PROGRAM_DIST);
+	EnableShader(type);
 
 	glActiveTextureARB(GL_TEXTURE0_ARB);
 		glBindTexture(GL_TEXTURE_2D, farTex);
@@ -765,13 +1040,17 @@ void CGrassDrawer::ResetGlStateFar()
 }
 
 
-void CGrassDrawer::CreateGrassDispList(int listNum)
+void CGrassDrawer::CreateGrassBladeStrips(std::vector<VA_TYPE_TN>& verts, std::vector<uint32_t>& stripEnds)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	CVertexArray* va = GetVertexArray();
-	va->Initialize();
+	verts.clear();
+	stripEnds.clear();
 	grng.Seed(15);
 
+	const auto AddVertex = [&verts](const float3& pos, float s, float t, const float3& n) {
+		verts.push_back({ pos, s, t, n });
+	};
+
 	for (int a = 0; a < strawPerTurf; ++a) {
 		// draw a single blade
 		const float lngRnd = grng.NextFloat();
@@ -794,8 +1073,8 @@ void CGrassDrawer::CreateGrassDispList(int listNum)
 		float3 normalBend = -bendVect;
 
 		// start btm
-		va->AddVertexTN(basePos + sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord              , 0.f, normalBend);
-		va->AddVertexTN(basePos - sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord + (1.0f / 16), 0.f, normalBend);
+		AddVertex(basePos + sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord              , 0.f, normalBend);
+		AddVertex(basePos - sideVect - float3(0.0f, 3.0f, 0.0f), xtexCoord + (1.0f / 16), 0.f, normalBend);
 
 		for (float h = 0.0f; h < 1.0f; h += (1.0f / numSections)) {
 			const float ang = maxAng * h;
@@ -804,22 +1083,45 @@ void CGrassDrawer::CreateGrassDispList(int listNum)
 			const float3 edgePosL = edgePos - sideVect * (1.0f - h);
 			const float3 edgePosR = edgePos + sideVect * (1.0f - h);
 
-			va->AddVertexTN(basePos + edgePosR, xtexCoord + (1.0f / 32) * h              , h, (n + sideVect * 0.04f).ANormalize());
-			va->AddVertexTN(basePos + edgePosL, xtexCoord - (1.0f / 32) * h + (1.0f / 16), h, (n - sideVect * 0.04f).ANormalize());
+			AddVertex(basePos + edgePosR, xtexCoord + (1.0f / 32) * h              , h, (n + sideVect * 0.04f).ANormalize());
+			AddVertex(basePos + edgePosL, xtexCoord - (1.0f / 32) * h + (1.0f / 16), h, (n - sideVect * 0.04f).ANormalize());
 		}
 
 		// end top tip (single triangle)
 		const float3 edgePos = (UpVector * std::cos(maxAng) + bendVect * std::sin(maxAng)) * length;
 		const float3 n = (normalBend * std::cos(maxAng) + UpVector * std::sin(maxAng)).ANormalize();
-		va->AddVertexTN(basePos + edgePos, xtexCoord + (1.0f / 32), 1.0f, n);
+		AddVertex(basePos + edgePos, xtexCoord + (1.0f / 32), 1.0f, n);
 
 		// next blade
-		va->EndStrip();
+		stripEnds.push_back(static_cast<uint32_t>(verts.size()));
+	}
+}
+
+void CGrassDrawer::CreateGrassDispList(int listNum)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<VA_TYPE_TN> verts;
+	std::vector<uint32_t> stripEnds;
+	CreateGrassBladeStrips(verts, stripEnds);
+
+	CVertexArray* va = GetVertexArray();
+	va->Initialize();
+
+	for (size_t i = 0, s = 0; i < verts.size(); ++i) {
+		va->AddVertexTN(verts[i].pos, verts[i].s, verts[i].t, verts[i].n);
+
+		if ((i + 1) == stripEnds[s]) {
+			va->EndStrip();
+			++s;
+		}
 	}
 
 	glNewList(listNum, GL_COMPILE);
 	va->DrawArrayTN(GL_TRIANGLE_STRIP);
 	glEndList();
+
+	if (gpuGrass)
+		CreateGPUBladeMesh(verts, stripEnds);
 }
 
 void CGrassDrawer::CreateGrassBladeTex(unsigned char* buf)
@@ -1020,6 +1322,7 @@ void CGrassDrawer::AddGrass(const float3& pos, const uint8_t grassValue)
 	assert(z >= 0 && z < (mapDims.mapy / grassSquareSize));
 
 	grassMap[z * mapDims.mapx / grassSquareSize + x] = grassValue;
+	updateDensityTex = true;
 	ResetPos(pos);
 }
 
@@ -1035,6 +1338,7 @@ void CGrassDrawer::RemoveGrass(const float3& pos)
 	assert(z >= 0 && z < (mapDims.mapy / grassSquareSize));
 
 	grassMap[z * mapDims.mapx / grassSquareSize + x] = 0;
+	updateDensityTex = true;
 	ResetPos(pos);
 }
 
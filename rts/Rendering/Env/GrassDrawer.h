@@ -6,6 +6,8 @@
 #include <vector>
 
 #include "Rendering/GL/VertexArray.h"
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
 #include "System/float3.h"
 #include "System/EventClient.h"
 
@@ -13,6 +15,7 @@ namespace Shader {
 	struct IProgramObject;
 }
 
+class CCamera;
 class CVertexArray;
 struct VA_TYPE_TN;
 
@@ -70,7 +73,9 @@ public:
 		GRASS_PROGRAM_NEAR        = 0,
 		GRASS_PROGRAM_DIST        = 1,
 		GRASS_PROGRAM_SHADOW_GEN  = 2,
-		GRASS_PROGRAM_LAST        = 3
+		GRASS_PROGRAM_GPU_NEAR    = 3,
+		GRASS_PROGRAM_GPU_DIST    = 4,
+		GRASS_PROGRAM_LAST        = 5
 	};
 
 protected:
@@ -78,11 +83,18 @@ protected:
 	void CreateGrassBladeTex(unsigned char* buf);
 	void CreateFarTex();
 	void CreateGrassDispList(int listNum);
+	void CreateGrassBladeStrips(std::vector<VA_TYPE_TN>& verts, std::vector<uint32_t>& stripEnds);
+
+	void CreateGPUResources();
+	void CreateGPUBladeMesh(const std::vector<VA_TYPE_TN>& verts, const std::vector<uint32_t>& stripEnds);
+	void ResizeGPUInstances();
+	void CullGPU(const CCamera* cam);
+	void DrawGPU();
 
 	void EnableShader(const GrassShaderProgram type);
-	void SetupGlStateNear();
+	void SetupGlStateNear(const GrassShaderProgram type = GRASS_PROGRAM_NEAR);
 	void ResetGlStateNear();
-	void SetupGlStateFar();
+	void SetupGlStateFar(const GrassShaderProgram type = GRASS_PROGRAM_DIST);
 	void ResetGlStateFar();
 	void DrawNear(const std::vector<InviewNearGrass>& inviewGrass);
 	void DrawFarBillboards(const std::vector<GrassStruct*>& inviewGrass);
@@ -122,6 +134,32 @@ protected:
 	bool grassOff;
 	bool updateBillboards;
 	bool updateVisibility;
+
+	// GPU path: turfs are generated from grassDensityTex and culled by a
+	// compute shader into instance lists that are drawn indirectly, the
+	// CPU block visibility and billboard VA's above are then unused
+	bool gpuGrass;
+	bool updateDensityTex;
+
+	unsigned int grassDensityTex;
+
+	Shader::IProgramObject* cullShader;
+
+	VBO bladeVBO;
+	VBO bladeIBO;
+	VAO bladeVAO;
+	// billboards are expanded from gl_VertexID
+	VAO billboardVAO;
+
+	// mesh instances followed by billboard instances, maxGPUInstances each
+	VBO instancesSSBO;
+	// one DrawElementsIndirectCommand (mesh) and one DrawArraysIndirectCommand (billboards)
+	VBO commandsSSBO;
+
+	uint32_t numBladeIndices;
+	uint32_t maxGPUInstances;
+	// half-size in grass squares of the window around the camera the turfs are generated in
+	int gpuCullRadius;
 };
 
 extern CGrassDrawer* grassDrawer;
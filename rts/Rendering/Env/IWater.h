@@ -33,6 +33,8 @@ public:
 
 	virtual bool CanDrawReflectionPass() const { return false; }
 	virtual bool CanDrawRefractionPass() const { return false; }
+	/// objects farther than this from the reflection camera are not reflected, 0 means unlimited
+	virtual float GetReflectionCullDistance() const { return 0.0f; }
 
 	void ExplosionOccurred(const CExplosionParams& event) override;
 
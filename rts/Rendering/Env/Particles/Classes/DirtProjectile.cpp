@@ -7,6 +7,7 @@
 #include "Game/GlobalUnsynced.h"
 #include "Map/Ground.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/Env/Particles/ParticleGPUSim.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Rendering/Textures/TextureAtlas.h"
@@ -90,6 +91,28 @@ void CDirtProjectile::Update()
 	deleteMe |= (alpha <= 0.0f);
 }
 
+bool CDirtProjectile::SpawnGPUParticles(const CUnit* owner, const float3& offset)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!IsValidTexture(texture) || alpha <= 0.0f)
+		return false;
+
+	if (!InitGPUParticles(owner, offset))
+		return false;
+
+	// alpha falls off linearly, i.e. the age of a GPU particle
+	const float alphaNorm = alpha / 255.0f;
+
+	GPUParticle p = ParticleGPUSim::MakeParticle(pos, speed, size, texture);
+	p.speedGrowth.w = sizeExpansion;
+	p.accelDrag = float4{ 0.0f, mygravity, 0.0f, slowdown };
+	p.ageParams = float4{ 0.0f, alphaFalloff / alpha, 1.0f, 0.0f };
+	p.color = float4{ color * alphaNorm, alphaNorm };
+
+	ParticleGPUSim::GetInstance().AddParticle(p);
+	return true;
+}
+
 void CDirtProjectile::Draw()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
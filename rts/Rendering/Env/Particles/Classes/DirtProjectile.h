@@ -27,6 +27,7 @@ public:
 
 	void Draw() override;
 	void Update() override;
+	bool SpawnGPUParticles(const CUnit* owner, const float3& offset) override;
 
 	int GetProjectilesCount() const override;
 
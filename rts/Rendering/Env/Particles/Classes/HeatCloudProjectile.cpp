@@ -5,6 +5,7 @@
 
 #include "Game/Camera.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/Env/Particles/ParticleGPUSim.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Rendering/Textures/TextureAtlas.h"
@@ -99,6 +100,31 @@ void CHeatCloudProjectile::Init(const CUnit* owner, const float3& offset)
 	CProjectile::Init(owner, offset);
 }
 
+bool CHeatCloudProjectile::SpawnGPUParticles(const CUnit* owner, const float3& offset)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the shrinking by sizemod has no GPU equivalent
+	if (sizemod != 0.0f || !IsValidTexture(texture))
+		return false;
+	if (heat <= 0.0f || maxheat <= 0.0f || heatFalloff <= 0.0f)
+		return false;
+
+	if (!InitGPUParticles(owner, offset))
+		return false;
+
+	// heat falls off linearly, i.e. the age of a GPU particle
+	const float heatNorm = heat / maxheat;
+
+	GPUParticle p = ParticleGPUSim::MakeParticle(pos, speed, size, texture);
+	p.speedGrowth.w = sizeGrowth;
+	p.ageParams = float4{ 0.0f, heatFalloff / heat, 1.0f, 0.0f };
+	p.rotParams = float4{ rotVal, rotVel, rotParams.y, 0.0f };
+	p.color = float4{ heatNorm, heatNorm, heatNorm, 1.0f / 255.0f };
+
+	ParticleGPUSim::GetInstance().AddParticle(p);
+	return true;
+}
+
 void CHeatCloudProjectile::Draw()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -5,6 +5,7 @@
 #include "Game/Camera.h"
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/Env/Particles/ParticleGPUSim.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Rendering/Textures/ColorMap.h"
@@ -232,6 +233,50 @@ void CSimpleParticleSystem::Init(const CUnit* owner, const float3& offset)
 	validTextures[0] = validTextures[1];
 }
 
+bool CSimpleParticleSystem::SpawnGPUParticles(const CUnit* owner, const float3& offset)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// incomplete definitions get their warnings and defaults from Init
+	if (colorMap == nullptr || texture == nullptr || !IsValidTexture(texture))
+		return false;
+	// texture animations are not simulated on the GPU
+	if (static_cast<int>(animParams1.x) > 1 || static_cast<int>(animParams1.y) > 1)
+		return false;
+
+	if (!InitGPUParticles(owner, offset))
+		return false;
+
+	const float3 up = emitVector;
+	const float3 right = up.cross(float3(up.y, up.z, -up.x));
+	const float3 forward = up.cross(right);
+
+	ParticleGPUSim& gpuSim = ParticleGPUSim::GetInstance();
+
+	const int32_t colorRamp = gpuSim.GetColorRamp(colorMap);
+
+	// same distribution as Init
+	for (int i = 0; i < numParticles; i++) {
+		const float az = guRNG.NextFloat() * math::TWOPI;
+		const float ay = (emitRot + (emitRotSpread * guRNG.NextFloat())) * math::DEG_TO_RAD;
+
+		const float3 pSpeed = ((up * emitMul.y) * fastmath::cos(ay) - ((right * emitMul.x) * fastmath::cos(az) - (forward * emitMul.z) * fastmath::sin(az)) * fastmath::sin(ay)) * (particleSpeed + (guRNG.NextFloat() * particleSpeedSpread));
+		const float pDecayRate = 1.0f / (particleLife + (guRNG.NextFloat() * particleLifeSpread));
+		const float pSize = particleSize + guRNG.NextFloat() * particleSizeSpread;
+
+		GPUParticle p = ParticleGPUSim::MakeParticle(offset, pSpeed, pSize, texture);
+		p.speedGrowth.w = sizeGrowth;
+		p.accelDrag = float4{ gravity, airdrag };
+		p.ageParams = float4{ 0.0f, pDecayRate, sizeMod, 0.0f };
+		p.rotParams = float4{ rotParams.z, rotParams.x, rotParams.y, 0.0f };
+		p.colorRamp = colorRamp;
+		p.flags = directional * GPUParticle::FLAG_DIRECTIONAL;
+
+		gpuSim.AddParticle(p);
+	}
+
+	return true;
+}
+
 int CSimpleParticleSystem::GetProjectilesCount() const
 {
 	return numParticles;
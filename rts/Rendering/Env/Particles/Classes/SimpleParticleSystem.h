@@ -24,6 +24,7 @@ public:
 	void Draw() override;
 	void Update() override;
 	void Init(const CUnit* owner, const float3& offset) override;
+	bool SpawnGPUParticles(const CUnit* owner, const float3& offset) override;
 
 	int GetProjectilesCount() const override;
 
@@ -7,6 +7,7 @@
 #include "Game/GlobalUnsynced.h"
 #include "Map/Ground.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/Env/Particles/ParticleGPUSim.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Rendering/Textures/TextureAtlas.h"
@@ -82,6 +83,27 @@ void CSmokeProjectile::Init(const CUnit* owner, const float3& offset)
 	CProjectile::Init(owner, offset);
 }
 
+bool CSmokeProjectile::SpawnGPUParticles(const CUnit* owner, const float3& offset)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	useAirLos |= (offset.y - CGround::GetApproximateHeight(offset.x, offset.z, false) > 10.0f);
+	alwaysVisible |= (owner == nullptr);
+
+	if (!InitGPUParticles(owner, offset))
+		return false;
+
+	const auto* st = projectileDrawer->GetSmokeTexture(guRNG.NextInt(projectileDrawer->NumSmokeTextures()));
+
+	GPUParticle p = ParticleGPUSim::MakeParticle(pos, speed, size, st);
+	p.speedGrowth.w = sizeExpansion;
+	p.ageParams = float4{ age, ageSpeed, 1.0f, startSize };
+	p.rotParams.w = 0.05f;
+	p.color = float4{ color, color, color, 1.0f };
+
+	ParticleGPUSim::GetInstance().AddParticle(p);
+	return true;
+}
+
 void CSmokeProjectile::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
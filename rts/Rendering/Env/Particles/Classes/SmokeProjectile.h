@@ -27,6 +27,7 @@ public:
 	void Update() override;
 	void Draw() override;
 	void Init(const CUnit* owner, const float3& offset) override;
+	bool SpawnGPUParticles(const CUnit* owner, const float3& offset) override;
 
 	int GetProjectilesCount() const override;
 
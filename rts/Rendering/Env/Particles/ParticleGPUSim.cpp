@@ -0,0 +1,413 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ParticleGPUSim.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "Game/Camera.h"
+#include "Game/CameraHandler.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/Env/ISky.h"
+#include "Rendering/Env/Particles/ProjectileDrawer.h"
+#include "Rendering/GL/FrameRingBuffer.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Textures/ColorMap.h"
+#include "Rendering/Textures/TextureAtlas.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/Wind.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+
+#include "System/Misc/TracyDefs.h"
+
+CONFIG(bool, GPUParticles).defaultValue(false).headlessValue(false).description("Simulate and draw smoke, dirt, heat cloud and simple particle system CEG particles on the GPU, requires compute shader support.");
+CONFIG(int, MaxGPUParticles)
+	.defaultValue(1 << 17)
+	.minimumValue(1 << 10)
+	.maximumValue(1 << 21)
+	.description("Number of particles the GPU particle backend holds at once (rounded up to a power of two), the oldest ones are replaced when more get spawned.");
+
+std::unique_ptr<ParticleGPUSim> ParticleGPUSim::instance = nullptr;
+
+static constexpr int UPDATE_GROUP_SIZE = 64;
+static constexpr int CULL_GROUP_SIZE = 64;
+static constexpr int SORT_GROUP_SIZE = 256;
+
+// a particle is advanced by at most this many frames per update (catching up after a pause or skip)
+static constexpr int MAX_UPDATE_STEPS = 256;
+
+
+void ParticleGPUSim::Init()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!configHandler->GetBool("GPUParticles"))
+		return;
+
+	if (!IsSupported()) {
+		LOG_L(L_WARNING, "[ParticleGPUSim::%s] GPU particles requested, but not supported", __func__);
+		return;
+	}
+
+	instance = std::make_unique<ParticleGPUSim>();
+}
+
+void ParticleGPUSim::Kill()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	instance = nullptr;
+}
+
+bool ParticleGPUSim::IsSupported()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!globalRendering->haveGL4)
+		return false;
+
+	return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object && GLAD_GL_ARB_draw_indirect;
+}
+
+
+ParticleGPUSim::ParticleGPUSim()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	capacity = std::bit_ceil(static_cast<uint32_t>(configHandler->GetInt("MaxGPUParticles")));
+
+	particlesSSBO = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+	rampsSSBO     = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+	entriesSSBO   = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+	commandSSBO   = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+
+	particlesSSBO.Bind();
+	particlesSSBO.New(capacity * sizeof(GPUParticle), GL_DYNAMIC_DRAW);
+	particlesSSBO.Unbind();
+
+	// (sort key, particle index)
+	entriesSSBO.Bind();
+	entriesSSBO.New(capacity * 2 * sizeof(uint32_t), GL_DYNAMIC_DRAW);
+	entriesSSBO.Unbind();
+
+	commandSSBO.Bind();
+	commandSSBO.New(sizeof(SDrawArraysIndirectCommand), GL_DYNAMIC_DRAW);
+	commandSSBO.Unbind();
+
+	spawns.reserve(4096);
+	ramps.reserve(RAMP_NUM_COLORS * 64);
+
+	lastUpdateFrame = gs->frameNum;
+
+	CreateShaders();
+}
+
+ParticleGPUSim::~ParticleGPUSim()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	shaderHandler->ReleaseProgramObjects("[ParticleGPUSim]");
+}
+
+void ParticleGPUSim::CreateShaders()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	updateShader = shaderHandler->CreateProgramObject("[ParticleGPUSim]", "Update");
+	updateShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ParticleUpdateCompProg.glsl", "", GL_COMPUTE_SHADER));
+	updateShader->Link();
+	updateShader->Validate();
+
+	cullShader = shaderHandler->CreateProgramObject("[ParticleGPUSim]", "Cull");
+	cullShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ParticleCullCompProg.glsl", "", GL_COMPUTE_SHADER));
+	cullShader->Link();
+	cullShader->Validate();
+
+	sortShader = shaderHandler->CreateProgramObject("[ParticleGPUSim]", "Sort");
+	sortShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ParticleSortCompProg.glsl", "", GL_COMPUTE_SHADER));
+	sortShader->Link();
+	sortShader->Validate();
+
+	// same outputs as ProjFXVertProg, so the regular FX fragment shader is shared
+	drawShader = shaderHandler->CreateProgramObject("[ParticleGPUSim]", "Draw");
+	drawShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ProjFXGPUVertProg.glsl", "", GL_VERTEX_SHADER));
+	drawShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ProjFXFragProg.glsl", "", GL_FRAGMENT_SHADER));
+	drawShader->SetFlag("SMOOTH_PARTICLES", CProjectileDrawer::CheckSoftenExt());
+	drawShader->SetFlag("DEPTH_CLIP01", globalRendering->supportClipSpaceControl);
+	drawShader->SetFlag("USE_TEXTURE_ARRAY", false);
+	drawShader->Link();
+
+	drawShader->Enable();
+	drawShader->SetUniform("atlasTex", 0);
+	drawShader->SetUniform("depthTex", 15);
+	drawShader->SetUniform("softenExponent", CProjectileDrawer::softenExponent[0], CProjectileDrawer::softenExponent[1]);
+	drawShader->SetUniform("softenThreshold", CProjectileDrawer::softenThreshold[0]);
+	drawShader->Disable();
+	drawShader->Validate();
+}
+
+
+GPUParticle ParticleGPUSim::MakeParticle(const float3& pos, const float3& speed, float size, const AtlasedTexture* tex)
+{
+	GPUParticle p;
+	p.posSize     = float4{ pos, size };
+	p.speedGrowth = float4{ speed, 0.0f };
+	p.accelDrag   = float4{ 0.0f, 0.0f, 0.0f, 1.0f };
+	p.ageParams   = float4{ 0.0f, 0.0f, 1.0f, 0.0f };
+	p.rotParams   = float4{ 0.0f, 0.0f, 0.0f, 0.0f };
+	p.color       = float4{ 1.0f, 1.0f, 1.0f, 1.0f };
+	p.texCoords   = float4{ tex->xstart, tex->ystart, tex->xend, tex->yend };
+	p.texPage     = static_cast<int32_t>(tex->pageNum);
+	p.spawnFrame  = gs->frameNum;
+	return p;
+}
+
+void ParticleGPUSim::AddParticle(const GPUParticle& p)
+{
+	// more than a full ring per frame would only overwrite itself
+	if (spawns.size() >= capacity)
+		return;
+
+	spawns.push_back(p);
+}
+
+int32_t ParticleGPUSim::GetColorRamp(CColorMap* colorMap)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const auto it = rampIndices.find(colorMap);
+
+	if (it != rampIndices.end())
+		return it->second;
+
+	const int32_t rampIdx = static_cast<int32_t>(ramps.size() / RAMP_NUM_COLORS);
+
+	for (uint32_t i = 0; i < RAMP_NUM_COLORS; i++) {
+		uint8_t color[4];
+		colorMap->GetColor(color, i / static_cast<float>(RAMP_NUM_COLORS - 1));
+
+		uint32_t packed;
+		std::memcpy(&packed, color, sizeof(packed));
+		ramps.push_back(packed);
+	}
+
+	rampIndices.emplace(colorMap, rampIdx);
+	return rampIdx;
+}
+
+
+void ParticleGPUSim::UploadSpawns()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (ramps.size() > numUploadedRamps) {
+		// ramps are only ever appended and small, so all of them are uploaded again
+		rampsSSBO.Bind();
+		if (rampsSSBO.GetSize() < ramps.size() * sizeof(uint32_t))
+			rampsSSBO.New(std::bit_ceil(ramps.size() * sizeof(uint32_t)), GL_DYNAMIC_DRAW);
+
+		rampsSSBO.SetBufferSubData(ramps);
+		rampsSSBO.Unbind();
+
+		numUploadedRamps = ramps.size();
+	}
+
+	if (spawns.empty())
+		return;
+
+	const auto UploadRange = [this](uint32_t slot, const GPUParticle* data, uint32_t count) {
+		const uint32_t byteOffset = slot * sizeof(GPUParticle);
+		const uint32_t byteCount = count * sizeof(GPUParticle);
+
+		FrameRingBuffer& frb = FrameRingBuffer::GetInstance();
+		const FrameRingBuffer::Allocation staging = frb.Allocate(byteCount);
+
+		if (!staging.Valid()) {
+			particlesSSBO.Bind();
+			particlesSSBO.SetBufferSubData(byteOffset, byteCount, data);
+			particlesSSBO.Unbind();
+			return;
+		}
+
+		std::memcpy(staging.ptr, data, byteCount);
+
+		glBindBuffer(GL_COPY_READ_BUFFER, frb.GetID());
+		glBindBuffer(GL_COPY_WRITE_BUFFER, particlesSSBO.GetId());
+		glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, staging.offset, byteOffset, byteCount);
+		glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	};
+
+	const uint32_t numSpawns = static_cast<uint32_t>(spawns.size());
+	const uint32_t headCount = std::min(numSpawns, capacity - ringHead);
+
+	// the ring wraps at most once, AddParticle keeps numSpawns <= capacity
+	UploadRange(ringHead, spawns.data(), headCount);
+
+	if (headCount < numSpawns)
+		UploadRange(0, spawns.data() + headCount, numSpawns - headCount);
+
+	ringHead = (ringHead + numSpawns) & (capacity - 1);
+	numUsedSlots = std::min(numUsedSlots + numSpawns, capacity);
+
+	spawns.clear();
+}
+
+void ParticleGPUSim::Update()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	UploadSpawns();
+
+	// spawns of earlier frames were advanced already, spawnFrame covers the new ones
+	const int curFrame = gs->frameNum;
+	const int numSteps = std::min(curFrame - lastUpdateFrame, MAX_UPDATE_STEPS);
+
+	if (numSteps <= 0 || numUsedSlots == 0) {
+		lastUpdateFrame = std::max(lastUpdateFrame, curFrame);
+		return;
+	}
+
+	const float3& windVec = envResHandler.GetCurrentWindVec();
+
+	particlesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLES_SSBO_BINDING_IDX, 0, numUsedSlots * sizeof(GPUParticle));
+
+	updateShader->Enable();
+	updateShader->SetUniform("numParticles", static_cast<int>(numUsedSlots));
+	updateShader->SetUniform("curFrame", curFrame);
+	updateShader->SetUniform("firstFrame", curFrame - numSteps);
+	updateShader->SetUniform("windVec", windVec.x, windVec.y, windVec.z);
+
+	glDispatchCompute((numUsedSlots + UPDATE_GROUP_SIZE - 1) / UPDATE_GROUP_SIZE, 1, 1);
+
+	updateShader->Disable();
+
+	particlesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLES_SSBO_BINDING_IDX, 0, numUsedSlots * sizeof(GPUParticle));
+
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	lastUpdateFrame = curFrame;
+	// positions moved, entries have to be recomputed
+	preparedDrawFrame = -1u;
+}
+
+
+void ParticleGPUSim::Prepare(const CCamera* cam, bool sorted)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// sorting needs a power of two entries, dead and culled particles are keyed to the end
+	const uint32_t numEntries = sorted ? std::bit_ceil(numUsedSlots) : numUsedSlots;
+
+	static const SDrawArraysIndirectCommand CLEAR_CMD = { 0, 1, 0, 0 };
+
+	commandSSBO.Bind();
+	commandSSBO.SetBufferSubData(0, sizeof(CLEAR_CMD), &CLEAR_CMD);
+	commandSSBO.Unbind();
+
+	particlesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLES_SSBO_BINDING_IDX, 0, numUsedSlots * sizeof(GPUParticle));
+	entriesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, ENTRIES_SSBO_BINDING_IDX, 0, numEntries * 2 * sizeof(uint32_t));
+	commandSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMAND_SSBO_BINDING_IDX, 0, sizeof(SDrawArraysIndirectCommand));
+
+	const float3& camPos = cam->GetPos();
+	const float3& camDir = cam->GetForward();
+
+	cullShader->Enable();
+	cullShader->SetUniform("numParticles", static_cast<int>(numUsedSlots));
+	cullShader->SetUniform("numEntries", static_cast<int>(numEntries));
+	cullShader->SetUniform("sortEntries", static_cast<int>(sorted));
+	cullShader->SetUniform("timeOffset", globalRendering->timeOffset);
+	cullShader->SetUniform("camPos", camPos.x, camPos.y, camPos.z);
+	cullShader->SetUniform("camDir", camDir.x, camDir.y, camDir.z);
+	cullShader->SetUniform4v("frustumPlanes", CCamera::FRUSTUM_PLANE_CNT, &cam->GetFrustum().planes[0].x);
+	cullShader->SetUniform("frustumPlanesMask", static_cast<int>(cam->GetInViewPlanesMask()));
+
+	glDispatchCompute((numEntries + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+	cullShader->Disable();
+
+	commandSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMAND_SSBO_BINDING_IDX, 0, sizeof(SDrawArraysIndirectCommand));
+	particlesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLES_SSBO_BINDING_IDX, 0, numUsedSlots * sizeof(GPUParticle));
+
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	if (sorted)
+		Sort(numEntries);
+
+	entriesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, ENTRIES_SSBO_BINDING_IDX, 0, numEntries * 2 * sizeof(uint32_t));
+
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+
+	preparedDrawFrame = globalRendering->drawFrame;
+	preparedCamType = cam->GetCamType();
+	preparedSorted = sorted;
+}
+
+void ParticleGPUSim::Sort(uint32_t numEntries)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// bitonic sort, one dispatch per merge step; the entries are still bound by Prepare
+	sortShader->Enable();
+	sortShader->SetUniform("numEntries", static_cast<int>(numEntries));
+
+	for (uint32_t k = 2; k <= numEntries; k <<= 1) {
+		for (uint32_t j = k >> 1; j > 0; j >>= 1) {
+			sortShader->SetUniform("blockSize", static_cast<int>(k));
+			sortShader->SetUniform("compareDist", static_cast<int>(j));
+
+			glDispatchCompute((numEntries + SORT_GROUP_SIZE - 1) / SORT_GROUP_SIZE, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+	}
+
+	sortShader->Disable();
+}
+
+void ParticleGPUSim::Draw(const CCamera* cam, const float* clipPlane, bool sorted, bool soften)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (numUsedSlots == 0)
+		return;
+
+	// the above- and below-water passes share the entries of their camera
+	if (preparedDrawFrame != globalRendering->drawFrame || preparedCamType != cam->GetCamType() || preparedSorted != sorted)
+		Prepare(cam, sorted);
+
+	const auto camPlayer = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+	const auto& sky = ISky::GetSky();
+
+	const float3& camRight = cam->GetRight();
+	const float3& camUp = cam->GetUp();
+	const float3& camDir = cam->GetForward();
+	const float3& camPos = cam->GetPos();
+
+	drawShader->Enable();
+	drawShader->SetFlag("SMOOTH_PARTICLES", soften);
+	drawShader->SetFlag("USE_TEXTURE_ARRAY", (projectileDrawer->textureAtlas->GetNumPages() > 1));
+	drawShader->SetUniform("clipPlane", clipPlane[0], clipPlane[1], clipPlane[2], clipPlane[3]);
+	drawShader->SetUniform("alphaCtrl", 0.0f, 1.0f, 0.0f, 0.0f);
+	drawShader->SetUniform("softenThreshold", CProjectileDrawer::softenThreshold[0]);
+	drawShader->SetUniform("timeOffset", globalRendering->timeOffset);
+
+	drawShader->SetUniform("camRight", camRight.x, camRight.y, camRight.z);
+	drawShader->SetUniform("camUp", camUp.x, camUp.y, camUp.z);
+	drawShader->SetUniform("camDir", camDir.x, camDir.y, camDir.z);
+	drawShader->SetUniform("viewPos", camPos.x, camPos.y, camPos.z);
+
+	drawShader->SetUniform("camPos", camPlayer->pos.x, camPlayer->pos.y, camPlayer->pos.z);
+	drawShader->SetUniform("fogColor", sky->fogColor.x, sky->fogColor.y, sky->fogColor.z);
+	drawShader->SetUniform("fogParams", sky->fogStart * camPlayer->GetFarPlaneDist(), sky->fogEnd * camPlayer->GetFarPlaneDist());
+
+	particlesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLES_SSBO_BINDING_IDX, 0, numUsedSlots * sizeof(GPUParticle));
+	entriesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, ENTRIES_SSBO_BINDING_IDX, 0, entriesSSBO.GetSize());
+
+	if (rampsSSBO.GetSize() > 0)
+		rampsSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, RAMPS_SSBO_BINDING_IDX, 0, rampsSSBO.GetSize());
+
+	vao.Bind();
+	commandSSBO.Bind(GL_DRAW_INDIRECT_BUFFER);
+	glDrawArraysIndirect(GL_TRIANGLES, nullptr);
+	commandSSBO.Unbind();
+	vao.Unbind();
+
+	if (rampsSSBO.GetSize() > 0)
+		rampsSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, RAMPS_SSBO_BINDING_IDX, 0, rampsSSBO.GetSize());
+
+	entriesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, ENTRIES_SSBO_BINDING_IDX, 0, entriesSSBO.GetSize());
+	particlesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, PARTICLES_SSBO_BINDING_IDX, 0, numUsedSlots * sizeof(GPUParticle));
+
+	drawShader->Disable();
+}
@@ -0,0 +1,128 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
+#include "System/float4.h"
+#include "System/UnorderedMap.hpp"
+
+class CCamera;
+class CColorMap;
+struct AtlasedTexture;
+namespace Shader {
+	struct IProgramObject;
+}
+
+// mirrors the Particle struct of ParticleUpdateCompProg.glsl (std430)
+struct GPUParticle {
+	float4 posSize;        // xyz, size
+	float4 speedGrowth;    // xyz, size added per frame
+	float4 accelDrag;      // xyz added to the speed per frame, speed multiplier per frame
+	float4 ageParams;      // age [0, 1], age added per frame, size multiplier per frame, size grown towards
+	float4 rotParams;      // angle, angular speed, angular acceleration, wind drift scale (times age)
+	float4 color;          // premultiplied, faded by (1 - age) unless a color ramp is set
+	float4 texCoords;      // xstart, ystart, xend, yend
+	int32_t texPage = 0;
+	int32_t colorRamp = -1;
+	int32_t spawnFrame = 0;
+	int32_t flags = 0;
+
+	// billboard spans the speed vector instead of facing the camera
+	static constexpr int32_t FLAG_DIRECTIONAL = 1;
+};
+
+static_assert(sizeof(GPUParticle) == 128, "");
+
+/**
+ * GPU backend for purely visual, unsynced CEG particles.
+ *
+ * Spawnables that can be described by GPUParticle (smoke, dirt, heat clouds
+ * and simple particle systems) hand their particles over here instead of
+ * becoming a CProjectile, see CExpGenSpawnable::SpawnGPUParticles. Spawns
+ * are appended to a ring of Capacity() particles through the shared frame
+ * staging buffer, overwriting the oldest ones when it is full. A compute pass
+ * then advances all of them by the sim frames that passed, another culls
+ * them against the camera and (optionally) bitonic-sorts the survivors back
+ * to front, and the draw expands them into billboards with the FX fragment
+ * shader of CProjectileDrawer, so the CPU neither touches nor uploads them
+ * again after the spawn.
+ *
+ * The particles have no LOS check after spawning (hidden spawns stay on the
+ * CPU), do not collide with the ground, do not cast shadows, are invisible
+ * to Lua and are not saved, and they are sorted among themselves only.
+ */
+class ParticleGPUSim {
+public:
+	static void Init();
+	static void Kill();
+	static ParticleGPUSim& GetInstance() { assert(IsValid()); return *instance; }
+	static bool IsValid() { return instance != nullptr; }
+	static bool IsSupported();
+public:
+	ParticleGPUSim();
+	~ParticleGPUSim();
+
+	static GPUParticle MakeParticle(const float3& pos, const float3& speed, float size, const AtlasedTexture* tex);
+
+	void AddParticle(const GPUParticle& p);
+	int32_t GetColorRamp(CColorMap* colorMap);
+
+	// once per draw frame, advances all particles to the current sim frame
+	void Update();
+	// draws the particles as seen by <cam> with the FX blending setup of CProjectileDrawer::DrawAlpha
+	void Draw(const CCamera* cam, const float* clipPlane, bool sorted, bool soften);
+
+	uint32_t Capacity() const { return capacity; }
+private:
+	void CreateShaders();
+	void UploadSpawns();
+	void Prepare(const CCamera* cam, bool sorted);
+	void Sort(uint32_t numEntries);
+private:
+	static std::unique_ptr<ParticleGPUSim> instance;
+
+	static constexpr uint32_t RAMP_NUM_COLORS = 16;
+
+	static constexpr uint32_t PARTICLES_SSBO_BINDING_IDX = 9;
+	static constexpr uint32_t RAMPS_SSBO_BINDING_IDX     = 10;
+	static constexpr uint32_t ENTRIES_SSBO_BINDING_IDX   = 11;
+	static constexpr uint32_t COMMAND_SSBO_BINDING_IDX   = 12;
+private:
+	Shader::IProgramObject* updateShader = nullptr;
+	Shader::IProgramObject* cullShader = nullptr;
+	Shader::IProgramObject* sortShader = nullptr;
+	Shader::IProgramObject* drawShader = nullptr;
+
+	VBO particlesSSBO;
+	VBO rampsSSBO;
+	VBO entriesSSBO;
+	VBO commandSSBO;
+
+	// the draw has no vertex attributes, billboards are expanded from gl_VertexID
+	VAO vao;
+
+	std::vector<GPUParticle> spawns;
+
+	// RAMP_NUM_COLORS packed RGBA8 colors per ramp
+	std::vector<uint32_t> ramps;
+	spring::unordered_map<const CColorMap*, int32_t> rampIndices;
+	size_t numUploadedRamps = 0;
+
+	// ring of <capacity> (a power of two) particles, <ringHead> is the next slot to spawn into
+	uint32_t capacity = 0;
+	uint32_t ringHead = 0;
+	// slots holding a (possibly dead) particle, grows up to <capacity>
+	uint32_t numUsedSlots = 0;
+
+	int lastUpdateFrame = 0;
+
+	// camera and frame the draw entries were last prepared for
+	uint32_t preparedDrawFrame = -1u;
+	uint32_t preparedCamType = -1u;
+	bool preparedSorted = false;
+};
@@ -16,6 +16,7 @@
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/Env/ISky.h"
+#include "Rendering/Env/Particles/ParticleGPUSim.h"
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/SubState.h"
 #include "Rendering/GL/RenderBuffers.h"
@@ -329,6 +330,8 @@ void CProjectileDrawer::Init() {
 	sdbc = std::make_unique<ScopedDepthBufferCopy>(false);
 
 	EnableSoften(configHandler->GetInt("SoftParticles"));
+
+	ParticleGPUSim::Init();
 }
 
 void CProjectileDrawer::Kill() {
@@ -336,6 +339,8 @@ void CProjectileDrawer::Kill() {
 	eventHandler.RemoveClient(this);
 	autoLinkedEvents.clear();
 
+	ParticleGPUSim::Kill();
+
 	glDeleteTextures(8, perlinBlendTex);
 	spring::SafeDelete(textureAtlas);
 	spring::SafeDelete(groundFXAtlas);
@@ -429,6 +434,8 @@ void CProjectileDrawer::UpdateDrawFlags()
 		}
 	});
 
+	if (ParticleGPUSim::IsValid())
+		ParticleGPUSim::GetInstance().Update();
 }
 
 bool CProjectileDrawer::CheckSoftenExt()
@@ -788,7 +795,11 @@ void CProjectileDrawer::DrawAlpha(bool drawAboveWater, bool drawBelowWater, bool
 		eventHandler.DrawWorldPreParticles(drawAboveWater, drawBelowWater, drawReflection, drawRefraction);
 
 		auto& rb = CExpGenSpawnable::GetPrimaryRenderBuffer();
-		if (!rb.ShouldSubmit())
+
+		const bool drawCPUParticles = rb.ShouldSubmit();
+		const bool drawGPUParticles = ParticleGPUSim::IsValid();
+
+		if (!drawCPUParticles && !drawGPUParticles)
 			return;
 
 		const bool needSoften = (wantSoften > 0) && !drawReflection && !drawRefraction;
@@ -802,20 +813,26 @@ void CProjectileDrawer::DrawAlpha(bool drawAboveWater, bool drawBelowWater, bool
 		const auto camPlayer = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
 		const auto& sky = ISky::GetSky();
 
-		fxShader->Enable();
-		fxShader->SetFlag("SMOOTH_PARTICLES", needSoften);
-		fxShader->SetFlag("USE_TEXTURE_ARRAY", (textureAtlas->GetNumPages() > 1));
-		fxShader->SetUniform("clipPlane", clipPlane[0], clipPlane[1], clipPlane[2], clipPlane[3]);
-		fxShader->SetUniform("alphaCtrl", 0.0f, 1.0f, 0.0f, 0.0f);
-		fxShader->SetUniform("softenThreshold", CProjectileDrawer::softenThreshold[0]);
+		if (drawCPUParticles) {
+			fxShader->Enable();
+			fxShader->SetFlag("SMOOTH_PARTICLES", needSoften);
+			fxShader->SetFlag("USE_TEXTURE_ARRAY", (textureAtlas->GetNumPages() > 1));
+			fxShader->SetUniform("clipPlane", clipPlane[0], clipPlane[1], clipPlane[2], clipPlane[3]);
+			fxShader->SetUniform("alphaCtrl", 0.0f, 1.0f, 0.0f, 0.0f);
+			fxShader->SetUniform("softenThreshold", CProjectileDrawer::softenThreshold[0]);
 
-		fxShader->SetUniform("camPos", camPlayer->pos.x, camPlayer->pos.y, camPlayer->pos.z);
-		fxShader->SetUniform("fogColor", sky->fogColor.x, sky->fogColor.y, sky->fogColor.z);
-		fxShader->SetUniform("fogParams", sky->fogStart * camPlayer->GetFarPlaneDist(), sky->fogEnd * camPlayer->GetFarPlaneDist());
+			fxShader->SetUniform("camPos", camPlayer->pos.x, camPlayer->pos.y, camPlayer->pos.z);
+			fxShader->SetUniform("fogColor", sky->fogColor.x, sky->fogColor.y, sky->fogColor.z);
+			fxShader->SetUniform("fogParams", sky->fogStart * camPlayer->GetFarPlaneDist(), sky->fogEnd * camPlayer->GetFarPlaneDist());
 
-		rb.DrawElements(GL_TRIANGLES);
+			rb.DrawElements(GL_TRIANGLES);
+
+			fxShader->Disable();
+		}
 
-		fxShader->Disable();
+		// sorted among themselves only, on top of the CPU ones
+		if (drawGPUParticles)
+			ParticleGPUSim::GetInstance().Draw(camera, clipPlane.data(), drawSorted, needSoften);
 
 		if (needSoften) {
 			glBindTexture(GL_TEXTURE_2D, 0); //15th slot
@@ -25,6 +25,7 @@ class LuaTable;
 
 
 class CProjectileDrawer: public CEventClient {
+	friend class ParticleGPUSim;
 public:
 	CProjectileDrawer(): CEventClient("[CProjectileDrawer]", 123456, false), perlinFB(true) {}
 
@@ -120,7 +120,11 @@ bool CFeatureDrawer::ShouldDrawFeatureShadow(CFeature* f)
 	if (!f->HasDrawFlag(DrawFlags::SO_SHOPAQ_FLAG))
 		return false;
 
-	if (LuaObjectDrawer::AddShadowMaterialObject(f, LUAOBJ_FEATURE))
+	if (!shadowHandler.ShouldDrawShadowCaster(f, true, GetLastChangeFrame(f)))
+		return false;
+
+	// Lua materials only run in the regular shadow pass, cascades use the engine shader
+	if (!shadowHandler.InCascadePass() && LuaObjectDrawer::AddShadowMaterialObject(f, LUAOBJ_FEATURE))
 		return false;
 
 	if ((f->engineDrawMask & thisPassMask) != thisPassMask)
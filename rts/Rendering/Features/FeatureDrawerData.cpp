@@ -144,6 +144,9 @@ void CFeatureDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 			case CCamera::CAMTYPE_PLAYER: {
 				const float camDist = (f->drawPos - cam->GetPos()).Length();
 
+				if (!f->alphaFade || camDist <= featureDrawDistance)
+					CModelDrawerHelper::RequestObjectTextureSize(f, camDist, cam);
+
 				// special case for non-fading features
 				if (!f->alphaFade) {
 					f->SetDrawFlag(DrawFlags::SO_OPAQUE_FLAG);
@@ -4,7 +4,9 @@
 #include "glFontRenderer.h"
 #include "FontLogSection.h"
 
+#include <chrono>
 #include <cstring> // for memset, memcpy
+#include <fstream>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -12,6 +14,7 @@
 #ifndef HEADLESS
 	#include <ft2build.h>
 	#include FT_FREETYPE_H
+	#include FT_GLYPH_H
 	#ifdef USE_FONTCONFIG
 		#include <fontconfig/fontconfig.h>
 		#include <fontconfig/fcfreetype.h>
@@ -25,7 +28,9 @@
 #include "System/Exceptions.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/Threading/ThreadPool.h"
 #ifdef _DEBUG
 	#include "System/Platform/Threading.h"
@@ -368,6 +373,50 @@ static inline uint64_t GetKerningHash(char32_t lchar, char32_t rchar)
 	return (static_cast<uint64_t>(lchar) << 32) | static_cast<uint64_t>(rchar); // 64bit used
 }
 
+static void SetGlyphMetrics(GlyphInfo& glyph, const FT_GlyphSlot slot, float normScale, float fontDescender)
+{
+	const float xbearing = slot->metrics.horiBearingX * normScale;
+	const float ybearing = slot->metrics.horiBearingY * normScale;
+
+	glyph.size.x = xbearing;
+	glyph.size.y = ybearing - fontDescender;
+	glyph.size.w =  slot->metrics.width * normScale;
+	glyph.size.h = -slot->metrics.height * normScale;
+
+	glyph.advance   = slot->advance.x * normScale;
+	glyph.height    = slot->metrics.height * normScale;
+	glyph.descender = ybearing - glyph.height;
+
+	// workaround bugs in FreeSansBold (in range 0x02B0 - 0x0300)
+	if (glyph.advance == 0 && glyph.size.w > 0)
+		glyph.advance = glyph.size.w;
+}
+
+
+static constexpr char GLYPH_CACHE_MAGIC[] = "FontGlyphCache-1";
+
+// fixed part of a glyph in the cache file, followed by width * height gray pixels
+struct CachedGlyph {
+	uint32_t letter;
+	uint32_t index;
+	float sizeX, sizeY, sizeW, sizeH;
+	float advance, height, descender;
+	int32_t bmpWidth, bmpHeight;
+};
+
+template<typename T> static void AppendCacheData(std::string& blob, const T& v) {
+	blob.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template<typename T> static bool ReadCacheData(const char*& ptr, const char* end, T& v) {
+	if (size_t(end - ptr) < sizeof(T))
+		return false;
+
+	std::memcpy(&v, ptr, sizeof(T));
+	ptr += sizeof(T);
+	return true;
+}
+
 static std::shared_ptr<FontFace> LoadFontFace(const std::string& fontfile)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -716,6 +765,14 @@ CFontTexture::CFontTexture(const std::string& fontfile, int size, int _outlinesi
 	// has to be done before first GetGlyph() call!
 	CreateTexture(32, 32, true);
 
+	// fixed-size faces are rescaled per glyph, only cache the scalable ones
+	if (useGlyphCache && FT_IS_SCALABLE(face)) {
+		glyphCacheKey = fmt::format("{}\n{}\n{}\n{} {} {} {} {}.{}.{}\n", fontfile, fontFamily, fontStyle, fontSize, outlineSize, outlineWeight, face->num_glyphs, FREETYPE_MAJOR, FREETYPE_MINOR, FREETYPE_PATCH);
+		glyphCacheFile = fmt::format("cache/fonts/{:016x}.bin", std::hash<std::string>{}(glyphCacheKey));
+
+		LoadGlyphCache();
+	}
+
 	// precache ASCII glyphs & kernings (save them in kerningPrecached array for better lvl2 cpu cache hitrate)
 	PreloadGlyphs();
 
@@ -734,7 +791,7 @@ void CFontTexture::PreloadGlyphs()
 	// if given face doesn't contain alphanumerics, don't preload it
 	if (!FT_Get_Char_Index(face, 'a'))
 		return;
-	LoadWantedGlyphs(32, 127);
+	LoadWantedGlyphs(32, 127, false);
 	for (char32_t i = 32; i < 127; ++i) {
 		const auto& lgl = GetGlyph(i);
 		const float advance = lgl.advance;
@@ -752,11 +809,177 @@ void CFontTexture::PreloadGlyphs()
 #endif
 }
 
+/***
+ *
+ * Restores the primary face glyphs saved by an earlier run, s.t. they need no rasterization
+ */
+void CFontTexture::LoadGlyphCache()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+#ifndef HEADLESS
+	const std::string cacheFile = dataDirsAccess.LocateFile(glyphCacheFile);
+	std::ifstream ifs(cacheFile, std::ios::binary);
+
+	if (!ifs.is_open())
+		return;
+
+	const std::string blob = {std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+
+	const char* ptr = blob.data();
+	const char* end = blob.data() + blob.size();
+
+	uint32_t keySize = 0;
+	uint32_t numGlyphs = 0;
+
+	if (blob.size() < sizeof(GLYPH_CACHE_MAGIC) || std::memcmp(ptr, GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC)) != 0)
+		return;
+
+	ptr += sizeof(GLYPH_CACHE_MAGIC);
+
+	if (!ReadCacheData(ptr, end, keySize) || size_t(end - ptr) < keySize)
+		return;
+	// stale cache, written for a different font file or size
+	if (glyphCacheKey.compare(0, std::string::npos, ptr, keySize) != 0)
+		return;
+
+	ptr += keySize;
+
+	if (!ReadCacheData(ptr, end, numGlyphs))
+		return;
+
+	// parse everything first, a corrupt file must not leave half of its glyphs behind
+	std::vector<std::pair<CachedGlyph, const char*>> cached;
+	cached.reserve(numGlyphs);
+
+	for (uint32_t i = 0; i < numGlyphs; ++i) {
+		CachedGlyph cg;
+
+		if (!ReadCacheData(ptr, end, cg) || cg.bmpWidth < 0 || cg.bmpHeight < 0 || size_t(end - ptr) < size_t(cg.bmpWidth) * cg.bmpHeight) {
+			LOG_L(L_WARNING, "[CFontTexture::%s] ignoring corrupt glyph cache \"%s\"", __func__, cacheFile.c_str());
+			return;
+		}
+
+		cached.emplace_back(cg, ptr);
+		ptr += size_t(cg.bmpWidth) * cg.bmpHeight;
+	}
+
+	static std::vector<char32_t> letters;
+	letters.clear();
+
+	const int olSize = 2 * outlineSize;
+
+	for (const auto& [cg, pixels] : cached) {
+		const char32_t ch = cg.letter;
+
+		if (glyphs.contains(ch) || FT_Get_Char_Index(*shFace, ch) != cg.index)
+			continue;
+
+		auto& glyph = glyphs[ch];
+		glyph.face   = shFace;
+		glyph.index  = cg.index;
+		glyph.letter = ch;
+		glyph.size   = IGlyphRect(cg.sizeX, cg.sizeY, cg.sizeW, cg.sizeH);
+		glyph.advance   = cg.advance;
+		glyph.height    = cg.height;
+		glyph.descender = cg.descender;
+
+		letters.push_back(ch);
+
+		if (cg.bmpWidth == 0 || cg.bmpHeight == 0)
+			continue;
+
+		atlasGlyphs.emplace_back(reinterpret_cast<const uint8_t*>(pixels), cg.bmpWidth, cg.bmpHeight, 1);
+		atlasAlloc.AddEntry(IntToString(ch)       , int2(cg.bmpWidth         , cg.bmpHeight         ), reinterpret_cast<void*>(atlasGlyphs.size() - 1));
+		atlasAlloc.AddEntry(IntToString(ch) + "sh", int2(cg.bmpWidth + olSize, cg.bmpHeight + olSize)                                                 );
+	}
+
+	if (letters.empty())
+		return;
+
+	PlaceAtlasGlyphs(letters);
+	++curTextureUpdate;
+
+	numCachedGlyphs = letters.size();
+
+	LOG_L(L_INFO, "[CFontTexture::%s] restored %u glyphs of %s from \"%s\"", __func__, uint32_t(numCachedGlyphs), fontFamily.c_str(), cacheFile.c_str());
+#endif
+}
+
+/***
+ *
+ * Saves the rasterized primary face glyphs, if any were added since the cache was loaded
+ */
+void CFontTexture::SaveGlyphCache() const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+#ifndef HEADLESS
+	if (glyphCacheFile.empty() || needsColor || atlasUpdate.channels != 1)
+		return;
+
+	std::string pixels;
+	std::vector<CachedGlyph> cached;
+	cached.reserve(glyphs.size());
+
+	for (const auto& [ch, glyph] : glyphs) {
+		if (ch == PLACEHOLDER_GLYPH || glyph.index == 0 || glyph.face != shFace || pendingLetters.contains(ch))
+			continue;
+
+		const int x = static_cast<int>(glyph.texCord.x);
+		const int y = static_cast<int>(glyph.texCord.y);
+		const int w = static_cast<int>(glyph.texCord.w);
+		const int h = static_cast<int>(glyph.texCord.h);
+
+		// the glyph bitmap is only kept in the atlas
+		if (x < 0 || y < 0 || (x + w) > atlasUpdate.xsize || (y + h) > atlasUpdate.ysize)
+			continue;
+
+		cached.push_back({
+			uint32_t(ch), glyph.index,
+			glyph.size.x, glyph.size.y, glyph.size.w, glyph.size.h,
+			glyph.advance, glyph.height, glyph.descender,
+			w, h
+		});
+
+		const uint8_t* mem = atlasUpdate.GetRawMem();
+
+		for (int row = y; row < (y + h); ++row) {
+			pixels.append(reinterpret_cast<const char*>(mem + row * atlasUpdate.xsize + x), w);
+		}
+	}
+
+	if (cached.size() <= numCachedGlyphs)
+		return;
+
+	std::string blob;
+
+	blob.append(GLYPH_CACHE_MAGIC, sizeof(GLYPH_CACHE_MAGIC));
+	AppendCacheData(blob, uint32_t(glyphCacheKey.size()));
+	blob.append(glyphCacheKey);
+	AppendCacheData(blob, uint32_t(cached.size()));
+
+	const char* pixelPtr = pixels.data();
+
+	for (const CachedGlyph& cg : cached) {
+		AppendCacheData(blob, cg);
+		blob.append(pixelPtr, cg.bmpWidth * cg.bmpHeight);
+		pixelPtr += cg.bmpWidth * cg.bmpHeight;
+	}
+
+	const std::string cacheFile = dataDirsAccess.LocateFile(glyphCacheFile, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+	std::ofstream ofs(cacheFile, std::ios::binary | std::ios::trunc);
+
+	if (!ofs.write(blob.data(), blob.size()))
+		LOG_L(L_WARNING, "[CFontTexture::%s] could not write glyph cache \"%s\"", __func__, cacheFile.c_str());
+#endif
+}
+
 CFontTexture::~CFontTexture()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	CglFontRenderer::DeleteInstance(fontRenderer);
 #ifndef HEADLESS
+	SaveGlyphCache();
+
 	glDeleteTextures(1, &glyphAtlasTextureID);
 	glyphAtlasTextureID = 0;
 #endif
@@ -876,6 +1099,9 @@ bool CFontTexture::ClearGlyphs() {
 
 	// Invalidate glyphs coming from other fonts, or those with the 'not found' glyph.
 	for (const auto& g : glyphs) {
+		if (g.first == PLACEHOLDER_GLYPH)
+			continue;
+
 		if (g.second.face->face != shFace->face || g.second.index == 0) {
 			changed = true;
 		}
@@ -887,8 +1113,10 @@ bool CFontTexture::ClearGlyphs() {
 	if (changed) {
 		kerningPrecached = {};
 
-		// clear all glyps
+		// clear all glyps, rasters still in flight are dropped
 		glyphs.clear();
+		pendingGlyphs.clear();
+		pendingLetters.clear();
 
 		// clear atlases
 		ClearAtlases(32, 32);
@@ -939,6 +1167,8 @@ void CFontTexture::InitFonts()
 	maxFontTries = configHandler ? configHandler->GetInt("MaxFontTries") : 5;
 	maxPinnedFonts = configHandler ? configHandler->GetInt("MaxPinnedFonts") : 10;
 	allowColorFonts = configHandler ? configHandler->GetBool("AllowColorFonts") : false;
+	asyncGlyphs = configHandler ? configHandler->GetBool("AsyncGlyphRasterization") : false;
+	useGlyphCache = configHandler ? configHandler->GetBool("FontGlyphCache") : false;
 #endif
 }
 
@@ -968,6 +1198,7 @@ void CFontTexture::Update() {
 
 	for (const auto& font : allFonts) {
 		auto lf = font.lock();
+		lf->UpdatePendingGlyphs();
 		if (lf->GlyphAtlasTextureNeedsUpdate())
 			fontsToUpdate.emplace_back(std::move(lf));
 	}
@@ -1033,7 +1264,7 @@ float CFontTexture::GetKerning(const GlyphInfo& lgl, const GlyphInfo& rgl)
 #endif
 }
 
-void CFontTexture::LoadWantedGlyphs(char32_t begin, char32_t end)
+void CFontTexture::LoadWantedGlyphs(char32_t begin, char32_t end, bool async)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	static std::vector<char32_t> wanted;
@@ -1041,10 +1272,10 @@ void CFontTexture::LoadWantedGlyphs(char32_t begin, char32_t end)
 	for (char32_t i = begin; i < end; ++i)
 		wanted.emplace_back(i);
 
-	LoadWantedGlyphs(wanted);
+	LoadWantedGlyphs(wanted, async);
 }
 
-void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted)
+void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted, bool async)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 #ifndef HEADLESS
@@ -1080,6 +1311,11 @@ void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted)
 	if (map.empty())
 		return;
 
+	if (async && asyncGlyphs && !glyphs.contains(PLACEHOLDER_GLYPH)) {
+		LoadGlyph(shFace, PLACEHOLDER_GLYPH, 0);
+		wanted.emplace_back(PLACEHOLDER_GLYPH);
+	}
+
 	// load glyphs from different fonts (using fontconfig)
 	std::shared_ptr<FontFace> f = shFace;
 
@@ -1101,7 +1337,7 @@ void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted)
 			FT_UInt index = FT_Get_Char_Index(*f, map[idx]);
 
 			if (index != 0) {
-				LoadGlyph(f, map[idx], index);
+				LoadGlyph(f, map[idx], index, async);
 
 				map[idx] = map.back();
 				map.pop_back();
@@ -1120,6 +1356,29 @@ void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted)
 		LOG_L(L_WARNING, "[CFontTexture::%s] Failed to load glyph %u after %d font replacement attempts", __func__, uint32_t(c), failedAttemptsToReplace[c]);
 	}
 
+	PlaceAtlasGlyphs(wanted);
+
+	if (!pendingLetters.empty()) {
+		const GlyphInfo& placeholder = glyphs[PLACEHOLDER_GLYPH];
+
+		for (const auto c : wanted) {
+			if (!pendingLetters.contains(c))
+				continue;
+
+			glyphs[c].texCord       = placeholder.texCord;
+			glyphs[c].shadowTexCord = placeholder.shadowTexCord;
+		}
+	}
+
+	// schedule a texture update
+	++curTextureUpdate;
+#endif
+}
+
+void CFontTexture::PlaceAtlasGlyphs(const std::vector<char32_t>& letters)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+#ifndef HEADLESS
 	// read atlasAlloc glyph data back into atlasUpdate{Shadow}
 	{
 		if (!atlasAlloc.Allocate())
@@ -1150,7 +1409,7 @@ void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted)
 		if ((atlasUpdateShadow.xsize != wantedTexWidth) || (atlasUpdateShadow.ysize != wantedTexHeight))
 			atlasUpdateShadow = atlasUpdateShadow.CanvasResize(wantedTexWidth, wantedTexHeight, false);
 
-		for (const auto i : wanted) {
+		for (const auto i : letters) {
 			const std::string glyphName  = IntToString(i);
 			const std::string glyphName2 = glyphName + "sh";
 
@@ -1188,6 +1447,66 @@ void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted)
 		atlasAlloc.clear();
 		atlasGlyphs.clear();
 	}
+#endif
+}
+
+void CFontTexture::UpdatePendingGlyphs()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+#ifndef HEADLESS
+	if (pendingGlyphs.empty())
+		return;
+
+	static std::vector<char32_t> rasterized;
+	rasterized.clear();
+
+	for (size_t i = 0; i < pendingGlyphs.size(); /*nop*/) {
+		if (pendingGlyphs[i].raster.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+			++i;
+			continue;
+		}
+
+		const char32_t ch = pendingGlyphs[i].letter;
+		const GlyphRaster& raster = pendingGlyphs[i].raster.get();
+
+		auto& glyph = glyphs[ch];
+		glyph.texCord       = {};
+		glyph.shadowTexCord = {};
+
+		if (raster.width > 0 && raster.height > 0) {
+			const int olSize = 2 * outlineSize;
+
+			atlasGlyphs.emplace_back(raster.pixels.data(), raster.width, raster.height, 1);
+			atlasAlloc.AddEntry(IntToString(ch)       , int2(raster.width         , raster.height         ), reinterpret_cast<void*>(atlasGlyphs.size() - 1));
+			atlasAlloc.AddEntry(IntToString(ch) + "sh", int2(raster.width + olSize, raster.height + olSize)                                                 );
+		}
+
+		rasterized.push_back(ch);
+
+		pendingGlyphs[i] = std::move(pendingGlyphs.back());
+		pendingGlyphs.pop_back();
+	}
+
+	if (rasterized.empty())
+		return;
+
+	PlaceAtlasGlyphs(rasterized);
+
+	// hand the final texcoords to the duplicates waiting on the same raster
+	for (const auto ch : rasterized) {
+		pendingLetters.erase(ch);
+
+		const GlyphInfo& src = glyphs[ch];
+
+		for (auto& [c, glyph] : glyphs) {
+			if (glyph.index != src.index || glyph.face != src.face || !pendingLetters.contains(c))
+				continue;
+
+			glyph.texCord       = src.texCord;
+			glyph.shadowTexCord = src.shadowTexCord;
+			pendingLetters.erase(c);
+		}
+	}
 
 	// schedule a texture update
 	++curTextureUpdate;
@@ -1196,7 +1515,7 @@ void CFontTexture::LoadWantedGlyphs(const std::vector<char32_t>& allWanted)
 
 
 
-void CFontTexture::LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index)
+void CFontTexture::LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index, bool async)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 #ifndef HEADLESS
@@ -1208,6 +1527,9 @@ void CFontTexture::LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned
 	const auto iter = std::find_if(glyphs.begin(), glyphs.end(), pred);
 
 	if (iter != glyphs.end()) {
+		if (pendingLetters.contains(iter->first))
+			pendingLetters.insert(ch);
+
 		auto glyphInfo = iter->second;
 		glyphs[ch] = glyphInfo;
 		return;
@@ -1218,9 +1540,47 @@ void CFontTexture::LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned
 	glyph.index = index;
 	glyph.letter = ch;
 
+	const bool colorGlyph = (FT_HAS_COLOR(f->face) && allowColorFonts);
+
+	// the layout only needs the metrics, rasterize the outline on a worker and
+	// draw the placeholder until UpdatePendingGlyphs puts the bitmap into the atlas
+	if (async && asyncGlyphs && index != 0 && !colorGlyph && FT_IS_SCALABLE(f->face) && FT_Load_Glyph(*f, index, FT_LOAD_DEFAULT) == 0) {
+		FT_GlyphSlot slot = f->face->glyph;
+		FT_Glyph outline = nullptr;
+
+		if (slot->format == FT_GLYPH_FORMAT_OUTLINE && FT_Get_Glyph(slot, &outline) == 0) {
+			SetGlyphMetrics(glyph, slot, normScale, fontDescender);
+
+			// the FT_Glyph copy is independent of the face, which stays on this thread
+			pendingGlyphs.emplace_back(ch, ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::High, [outline]() {
+				FT_Glyph ftGlyph = outline;
+				GlyphRaster raster;
+
+				if (FT_Glyph_To_Bitmap(&ftGlyph, FT_RENDER_MODE_NORMAL, nullptr, true) == 0) {
+					const FT_Bitmap& bitmap = reinterpret_cast<FT_BitmapGlyph>(ftGlyph)->bitmap;
+
+					if (bitmap.pixel_mode == FT_PIXEL_MODE_GRAY && bitmap.width > 0 && bitmap.rows > 0) {
+						raster.width  = bitmap.width;
+						raster.height = bitmap.rows;
+						raster.pixels.resize(raster.width * raster.height);
+
+						for (int y = 0; y < raster.height; ++y) {
+							memcpy(&raster.pixels[y * raster.width], bitmap.buffer + y * bitmap.pitch, raster.width);
+						}
+					}
+				}
+
+				FT_Done_Glyph(ftGlyph);
+				return raster;
+			}));
+			pendingLetters.insert(ch);
+			return;
+		}
+	}
+
 	// load glyph
 	auto flags = FT_LOAD_DEFAULT;
-	if (FT_HAS_COLOR(f->face) && allowColorFonts) {
+	if (colorGlyph) {
 		flags |= FT_LOAD_COLOR;
 	} else {
 		flags |= FT_LOAD_RENDER;
@@ -1233,21 +1593,9 @@ void CFontTexture::LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned
 	if (slot->bitmap.pixel_mode == FT_PIXEL_MODE_BGRA)
 		needsColor = true;
 
-	const float xbearing = slot->metrics.horiBearingX * normScale;
-	const float ybearing = slot->metrics.horiBearingY * normScale;
+	SetGlyphMetrics(glyph, slot, normScale, fontDescender);
 
-	glyph.size.x = xbearing;
-	glyph.size.y = ybearing - fontDescender;
-	glyph.size.w =  slot->metrics.width * normScale;
-	glyph.size.h = -slot->metrics.height * normScale;
-
-	glyph.advance   = slot->advance.x * normScale;
-	glyph.height    = slot->metrics.height * normScale;
-	glyph.descender = ybearing - glyph.height;
-
-	// workaround bugs in FreeSansBold (in range 0x02B0 - 0x0300)
-	if (glyph.advance == 0 && glyph.size.w > 0)
-		glyph.advance = glyph.size.w;
+	const float ybearing = slot->metrics.horiBearingY * normScale;
 
 	int width  = slot->bitmap.width;
 	int height = slot->bitmap.rows;
@@ -3,8 +3,10 @@
 #ifndef _CFONTTEXTURE_H
 #define _CFONTTEXTURE_H
 
+#include <future>
 #include <string>
 #include <memory>
+#include <vector>
 
 #include "System/Rectangle.h"
 #include "Rendering/Textures/Bitmap.h"
@@ -141,8 +143,8 @@ public:
 	void ReallocAtlases(bool pre);
 	bool HasColor() const { return needsColor; }
 protected:
-	void LoadWantedGlyphs(char32_t begin, char32_t end);
-	void LoadWantedGlyphs(const std::vector<char32_t>& wanted);
+	void LoadWantedGlyphs(char32_t begin, char32_t end, bool async = true);
+	void LoadWantedGlyphs(const std::vector<char32_t>& wanted, bool async = true);
 	bool GlyphAtlasTextureNeedsUpdate() const;
 	bool GlyphAtlasTextureNeedsUpload() const;
 	void UpdateGlyphAtlasTexture();
@@ -152,15 +154,21 @@ private:
 	void ClearAtlases(const int width, const int height);
 	void CreateTexture(const int width, const int height);
 	void CreateTexture(const int width, const int height, const bool init);
-	void LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index);
+	void LoadGlyph(std::shared_ptr<FontFace>& f, char32_t ch, unsigned index, bool async = false);
+	void PlaceAtlasGlyphs(const std::vector<char32_t>& letters);
+	void UpdatePendingGlyphs();
 	bool ClearGlyphs();
 	void PreloadGlyphs();
+	void LoadGlyphCache();
+	void SaveGlyphCache() const;
 protected:
 	float GetKerning(const GlyphInfo& lgl, const GlyphInfo& rgl);
 protected:
 	static inline std::vector<std::weak_ptr<CFontTexture>> allFonts = {};
 
 	static inline const GlyphInfo dummyGlyph = GlyphInfo();
+	// a noncharacter, holds the 'not found' glyph of the primary face
+	static constexpr char32_t PLACEHOLDER_GLYPH = 0xFFFF;
 	static inline bool needsClearGlyphs = false;
 
 	std::array<float, 128 * 128> kerningPrecached = {}; // contains ASCII kerning
@@ -194,6 +202,29 @@ private:
 	inline static int maxFontTries = 0;
 	inline static int maxPinnedFonts = 0;
 	inline static int allowColorFonts = 0;
+	inline static bool asyncGlyphs = false;
+	inline static bool useGlyphCache = false;
+
+	// a glyph bitmap rasterized by a worker thread (8 bit gray, tightly packed)
+	struct GlyphRaster {
+		std::vector<uint8_t> pixels;
+		int width = 0;
+		int height = 0;
+	};
+	struct PendingGlyph {
+		char32_t letter;
+		std::shared_future<GlyphRaster> raster;
+	};
+
+	// glyphs drawn with the PLACEHOLDER_GLYPH texcoords until their raster arrives,
+	// includes duplicates sharing the face and index of a pending glyph
+	std::vector<PendingGlyph> pendingGlyphs;
+	spring::unordered_set<char32_t> pendingLetters;
+
+	// cache-dir file holding the primary face glyphs of earlier runs
+	std::string glyphCacheFile;
+	std::string glyphCacheKey;
+	size_t numCachedGlyphs = 0;
 #endif
 	std::shared_ptr<FontFace> shFace;
 
@@ -0,0 +1,138 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "FrameRingBuffer.h"
+
+#include "Rendering/GlobalRendering.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/SpringMath.h"
+
+#include "System/Misc/TracyDefs.h"
+
+CONFIG(int, FrameRingBufferSize)
+	.defaultValue(8)
+	.minimumValue(0)
+	.maximumValue(256)
+	.headlessValue(0)
+	.description("Size in MB of the staging memory per frame in flight shared by streamed GL uploads, 0 disables it.");
+
+
+bool FrameRingBuffer::Supported()
+{
+	// ForceDisablePersistentMapping applies here too
+	return globalRendering->supportPersistentMapping && GLAD_GL_ARB_sync && GLAD_GL_ARB_copy_buffer;
+}
+
+void FrameRingBuffer::Init()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (IsValid())
+		return;
+
+	if (!Supported())
+		return;
+
+	regionSize = static_cast<uint32_t>(configHandler->GetInt("FrameRingBufferSize")) << 20;
+	if (regionSize == 0)
+		return;
+
+	glGenBuffers(1, &id);
+	glBindBuffer(GL_COPY_READ_BUFFER, id);
+	glBufferStorage(GL_COPY_READ_BUFFER, NUM_REGIONS * regionSize, nullptr, GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT);
+	ptrBase = reinterpret_cast<uint8_t*>(glMapBufferRange(
+		GL_COPY_READ_BUFFER,
+		0,
+		NUM_REGIONS * regionSize,
+		GL_MAP_WRITE_BIT | GL_MAP_UNSYNCHRONIZED_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT
+	));
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+	if (ptrBase == nullptr) {
+		LOG_L(L_ERROR, "[FrameRingBuffer::%s] Failed to map %u bytes persistently, streamed uploads use their own buffers", __func__, NUM_REGIONS * regionSize);
+		glDeleteBuffers(1, &id);
+		id = 0;
+		return;
+	}
+
+	regionIdx = 0;
+	regionUsedBytes = 0;
+	lastFrameUsedBytes = 0;
+}
+
+void FrameRingBuffer::Kill()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (auto& fence : fences) {
+		if (glIsSync(fence))
+			glDeleteSync(fence);
+
+		fence = {};
+	}
+
+	if (!IsValid())
+		return;
+
+	glFinish(); // nothing may still copy out of the buffer
+
+	glBindBuffer(GL_COPY_READ_BUFFER, id);
+	glUnmapBuffer(GL_COPY_READ_BUFFER);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glDeleteBuffers(1, &id);
+
+	id = 0;
+	ptrBase = nullptr;
+}
+
+void FrameRingBuffer::SwapFrame()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!IsValid())
+		return;
+
+	lastFrameUsedBytes = regionUsedBytes;
+
+	// nothing was written, the previous fence (if any) still covers the region
+	if (regionUsedBytes > 0) {
+		if (glIsSync(fences[regionIdx]))
+			glDeleteSync(fences[regionIdx]);
+
+		fences[regionIdx] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	regionIdx = (regionIdx + 1) % NUM_REGIONS;
+	regionUsedBytes = 0;
+
+	GLsync& fence = fences[regionIdx];
+	if (!glIsSync(fence))
+		return;
+
+	uint32_t waitCount = 0;
+	while (true) {
+		const GLenum waitReturn = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1);
+		if (waitReturn == GL_ALREADY_SIGNALED || waitReturn == GL_CONDITION_SATISFIED || waitReturn == GL_WAIT_FAILED)
+			break;
+
+		waitCount++;
+	}
+	glDeleteSync(fence);
+	fence = {};
+
+	if (waitCount > 0)
+		LOG_L(L_DEBUG, "[FrameRingBuffer::%s] Detected non-zero (%u) wait spins on region %u", __func__, waitCount, regionIdx);
+}
+
+FrameRingBuffer::Allocation FrameRingBuffer::Allocate(uint32_t byteSize, uint32_t alignment)
+{
+	if (!IsValid() || byteSize == 0)
+		return {};
+
+	const uint32_t regionOffset = AlignUp(regionUsedBytes, alignment);
+
+	if (regionOffset + byteSize > regionSize)
+		return {};
+
+	regionUsedBytes = regionOffset + byteSize;
+
+	const uint32_t offset = regionIdx * regionSize + regionOffset;
+	return { ptrBase + offset, offset };
+}
@@ -0,0 +1,61 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include "myGL.h"
+
+/**
+ * One persistently mapped staging buffer shared by all per-frame uploads.
+ *
+ * The buffer is split into one region per frame in flight. Allocate() bumps
+ * a pointer inside the current frame's region, the data is then copied out
+ * of the buffer on the GPU (glCopyBufferSubData or by sourcing it directly).
+ * SwapFrame() fences the region once per frame and waits for the oldest one,
+ * so all users together pay for a single sync point instead of one buffer
+ * and fence each.
+ *
+ * An allocation that does not fit into what is left of the region fails,
+ * callers keep their own upload path as a fallback.
+ */
+class FrameRingBuffer {
+public:
+	struct Allocation {
+		uint8_t* ptr = nullptr;
+		uint32_t offset = 0; // into the buffer, not the region
+
+		bool Valid() const { return (ptr != nullptr); }
+	};
+public:
+	static FrameRingBuffer& GetInstance() {
+		static FrameRingBuffer frameRingBufferInstance;
+		return frameRingBufferInstance;
+	};
+	static bool Supported();
+
+	void Init();
+	void Kill();
+	void SwapFrame();
+
+	// <data> written to the returned pointer is visible to GL commands issued afterwards
+	Allocation Allocate(uint32_t byteSize, uint32_t alignment = DEFAULT_ALIGNMENT);
+
+	bool IsValid() const { return (ptrBase != nullptr); }
+	GLuint GetID() const { return id; }
+	uint32_t GetRegionSize() const { return regionSize; }
+	uint32_t GetLastFrameUsedBytes() const { return lastFrameUsedBytes; }
+private:
+	static constexpr uint32_t NUM_REGIONS = 3;
+	static constexpr uint32_t DEFAULT_ALIGNMENT = 16;
+private:
+	GLuint id = 0;
+	uint8_t* ptrBase = nullptr;
+
+	uint32_t regionSize = 0;
+	uint32_t regionIdx = 0;
+	uint32_t regionUsedBytes = 0;
+	uint32_t lastFrameUsedBytes = 0;
+
+	std::array<GLsync, NUM_REGIONS> fences = {};
+};
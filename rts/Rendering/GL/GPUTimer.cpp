@@ -0,0 +1,167 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#include "GPUTimer.h"
+
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <utility>
+
+#include "myGL.h"
+
+#include "System/Misc/TracyDefs.h"
+
+namespace {
+	// per frame; every scope takes two
+	constexpr uint32_t NUM_FRAME_QUERIES = 256;
+
+	struct PendingTimer {
+		unsigned nameHash;
+		uint32_t beginQuery;
+		uint32_t endQuery;
+	};
+
+	struct FrameQueries {
+		std::array<GLuint, NUM_FRAME_QUERIES> queries = {};
+		std::vector<PendingTimer> timers;
+
+		uint32_t numIssued = 0;
+		// two per open scope, so nested ends always have a query left
+		uint32_t numReserved = 0;
+	};
+
+	std::array<FrameQueries, 2> frameQueries;
+	// summed per name when resolving, repeated passes count once
+	std::vector<std::pair<unsigned, GLuint64>> frameSums;
+
+	uint32_t curFrame = 0;
+
+	bool initialized = false;
+	// latched once per frame so every Begin has a matching End
+	bool recording = false;
+
+	void ResolveQueries(FrameQueries& fq)
+	{
+		RECOIL_DETAILED_TRACY_ZONE;
+		frameSums.clear();
+
+		for (const PendingTimer& timer: fq.timers) {
+			GLuint64 t0 = 0;
+			GLuint64 t1 = 0;
+
+			glGetQueryObjectui64v(fq.queries[timer.beginQuery], GL_QUERY_RESULT, &t0);
+			glGetQueryObjectui64v(fq.queries[timer.endQuery  ], GL_QUERY_RESULT, &t1);
+
+			const auto pred = [&](const std::pair<unsigned, GLuint64>& p) { return (p.first == timer.nameHash); };
+			const auto iter = std::find_if(frameSums.begin(), frameSums.end(), pred);
+
+			if (iter == frameSums.end()) {
+				frameSums.emplace_back(timer.nameHash, t1 - t0);
+			} else {
+				iter->second += (t1 - t0);
+			}
+		}
+
+		for (const auto& [nameHash, dt]: frameSums) {
+			CTimeProfiler::GetInstance().AddTime(nameHash, spring_notime, spring_time::fromNanoSecs(dt));
+		}
+	}
+}
+
+
+void GL::GPUTimer::Init()
+{
+	if (!GLAD_GL_ARB_timer_query)
+		return;
+
+	for (FrameQueries& fq: frameQueries) {
+		glGenQueries(fq.queries.size(), fq.queries.data());
+
+		fq.timers.clear();
+		fq.timers.reserve(NUM_FRAME_QUERIES / 2);
+		fq.numIssued = 0;
+		fq.numReserved = 0;
+	}
+
+	frameSums.reserve(NUM_FRAME_QUERIES / 2);
+
+	curFrame = 0;
+	initialized = true;
+	recording = false;
+}
+
+void GL::GPUTimer::Kill()
+{
+	if (!initialized)
+		return;
+
+	for (FrameQueries& fq: frameQueries) {
+		glDeleteQueries(fq.queries.size(), fq.queries.data());
+		fq.queries.fill(0);
+		fq.timers.clear();
+	}
+
+	initialized = false;
+	recording = false;
+}
+
+void GL::GPUTimer::EndFrame()
+{
+	if (!initialized)
+		return;
+
+	RECOIL_DETAILED_TRACY_ZONE;
+
+	// the previous frame's queries are reused by the next one, resolve them now
+	FrameQueries& prv = frameQueries[curFrame ^ 1];
+
+	if (!prv.timers.empty()) {
+		GLint available = 0;
+
+		// the last query of a frame completes last; no stalls, drop the frame if it lags
+		glGetQueryObjectiv(prv.queries[prv.numIssued - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (available)
+			ResolveQueries(prv);
+	}
+
+	prv.timers.clear();
+	prv.numIssued = 0;
+	prv.numReserved = 0;
+
+	curFrame ^= 1;
+	recording = CTimeProfiler::GetInstance().IsEnabled();
+}
+
+uint32_t GL::GPUTimer::Begin()
+{
+	if (!recording)
+		return INVALID_QUERY;
+
+	FrameQueries& fq = frameQueries[curFrame];
+
+	if ((fq.numReserved + 2) > fq.queries.size())
+		return INVALID_QUERY;
+
+	fq.numReserved += 2;
+
+	glQueryCounter(fq.queries[fq.numIssued], GL_TIMESTAMP);
+	return (fq.numIssued++);
+}
+
+void GL::GPUTimer::End(uint32_t beginQuery, unsigned nameHash)
+{
+	if (beginQuery == INVALID_QUERY || !recording)
+		return;
+
+	FrameQueries& fq = frameQueries[curFrame];
+
+	// scope straddled EndFrame, its begin query belongs to another frame
+	if (beginQuery >= fq.numIssued || fq.numIssued >= fq.queries.size())
+		return;
+
+	glQueryCounter(fq.queries[fq.numIssued], GL_TIMESTAMP);
+	fq.timers.push_back({nameHash, beginQuery, fq.numIssued++});
+}
+
+bool GL::GPUTimer::IsEnabled() { return recording; }
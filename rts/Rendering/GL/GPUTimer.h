@@ -0,0 +1,55 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#pragma once
+
+#include <cstdint>
+
+#include "System/StringHash.h"
+#include "System/TimeProfiler.h"
+
+/*
+	GL::GPUTimer measures the GPU time spent between two points in the command
+	stream and feeds it to CTimeProfiler as "GPU::<name>" records, so it shows up
+	next to the CPU timers in the profiler and through Spring.GetProfilerTimeRecord.
+
+	Timestamp query pairs are used instead of GL_TIME_ELAPSED since the latter can
+	not be nested (e.g. Draw::World around Draw::World::Terrain). Queries issued in
+	one frame are resolved at the end of the next one, and dropped rather than
+	waited on if the GPU is more than a frame behind. Only active while the time
+	profiler is enabled and GL_ARB_timer_query is supported.
+*/
+
+// NB: name must be a compile-time literal
+#define SCOPED_GPU_TIMER(name)  static TimerNameRegistrar __gtnr("GPU::" name); GL::ScopedGPUTimer __scopedGPUTimer(hashString("GPU::" name));
+
+namespace GL::GPUTimer
+{
+	static constexpr uint32_t INVALID_QUERY = ~0u;
+
+	void Init();
+	void Kill();
+
+	// resolves the queries of the previous frame, called once per frame after swapping
+	void EndFrame();
+
+	uint32_t Begin();
+	void End(uint32_t beginQuery, unsigned nameHash);
+
+	bool IsEnabled();
+}
+
+namespace GL
+{
+	class ScopedGPUTimer : public spring::noncopyable
+	{
+	public:
+		ScopedGPUTimer(unsigned _nameHash)
+			: nameHash(_nameHash)
+			, beginQuery(GPUTimer::Begin())
+		{}
+		~ScopedGPUTimer() { GPUTimer::End(beginQuery, nameHash); }
+	private:
+		const unsigned nameHash;
+		const uint32_t beginQuery;
+	};
+}
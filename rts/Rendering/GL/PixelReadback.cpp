@@ -0,0 +1,156 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PixelReadback.h"
+
+#include <algorithm>
+
+#include "System/Log/ILog.h"
+
+#include "System/Misc/TracyDefs.h"
+
+
+bool PixelReadback::Supported()
+{
+	return GLAD_GL_ARB_sync && GLAD_GL_ARB_pixel_buffer_object;
+}
+
+void PixelReadback::Init(uint32_t numBuffers)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (IsValid())
+		return;
+
+	slots.resize(std::max(numBuffers, 1u));
+	usePBOs = Supported();
+
+	head = 0;
+	numPending = 0;
+	mapped = false;
+
+	if (!usePBOs)
+		return;
+
+	for (Slot& slot: slots) {
+		glGenBuffers(1, &slot.id);
+	}
+}
+
+void PixelReadback::Kill()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!IsValid())
+		return;
+
+	if (mapped)
+		UnmapOldest();
+
+	for (Slot& slot: slots) {
+		if (glIsSync(slot.fence))
+			glDeleteSync(slot.fence);
+
+		if (slot.id != 0)
+			glDeleteBuffers(1, &slot.id);
+	}
+
+	slots.clear();
+	head = 0;
+	numPending = 0;
+}
+
+bool PixelReadback::Read(int x, int y, int w, int h, GLenum format, GLenum type, uint32_t byteSize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!IsValid() || IsFull())
+		return false;
+
+	Slot& slot = slots[(head + numPending) % slots.size()];
+
+	if (!usePBOs) {
+		slot.hostBuf.resize(byteSize);
+		slot.size = byteSize;
+
+		glReadPixels(x, y, w, h, format, type, slot.hostBuf.data());
+		numPending++;
+		return true;
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.id);
+
+	// orphans the old storage, reallocates only when the size changed
+	if (slot.size != byteSize) {
+		glBufferData(GL_PIXEL_PACK_BUFFER, byteSize, nullptr, GL_STREAM_READ);
+		slot.size = byteSize;
+	}
+
+	glReadPixels(x, y, w, h, format, type, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	numPending++;
+	return true;
+}
+
+const uint8_t* PixelReadback::MapOldest(bool wait, uint32_t* byteSize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (numPending == 0 || mapped)
+		return nullptr;
+
+	Slot& slot = slots[head];
+
+	if (byteSize != nullptr)
+		*byteSize = slot.size;
+
+	if (!usePBOs) {
+		mapped = true;
+		return slot.hostBuf.data();
+	}
+
+	if (glIsSync(slot.fence)) {
+		// the first check also flushes, so the fence is guaranteed to signal eventually
+		GLenum waitReturn = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+
+		while (wait && waitReturn == GL_TIMEOUT_EXPIRED) {
+			waitReturn = glClientWaitSync(slot.fence, 0, 1000 * 1000);
+		}
+
+		if (waitReturn == GL_TIMEOUT_EXPIRED)
+			return nullptr;
+
+		glDeleteSync(slot.fence);
+		slot.fence = {};
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.id);
+	const uint8_t* ptr = reinterpret_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.size, GL_MAP_READ_BIT));
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	if (ptr == nullptr) {
+		LOG_L(L_ERROR, "[PixelReadback::%s] failed to map %u bytes of pixel data", __func__, slot.size);
+
+		// drop the read, nothing else would ever consume it
+		head = (head + 1) % slots.size();
+		numPending--;
+		return nullptr;
+	}
+
+	mapped = true;
+	return ptr;
+}
+
+void PixelReadback::UnmapOldest()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!mapped)
+		return;
+
+	if (usePBOs) {
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slots[head].id);
+		glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	}
+
+	head = (head + 1) % slots.size();
+	numPending--;
+	mapped = false;
+}
@@ -0,0 +1,60 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "myGL.h"
+
+/**
+ * Ring of pixel pack buffers for reading back the framebuffer without a stall.
+ *
+ * Read() makes glReadPixels copy into the next free buffer and fences it, so
+ * the call returns as soon as the copy is queued. Once the GPU is done, which
+ * is usually a frame or two later, MapOldest() maps the oldest pending read for
+ * the caller to copy the pixels out of before UnmapOldest(); an encoder then
+ * works on that copy off the render thread. Reads complete in issue order.
+ *
+ * Without ARB_sync every Read() falls back to a blocking glReadPixels into a
+ * buffer in main memory, which MapOldest() returns the same way. Owners have
+ * to Kill() while the GL context still exists.
+ */
+class PixelReadback {
+public:
+	static bool Supported();
+
+	PixelReadback() = default;
+	PixelReadback(const PixelReadback&) = delete;
+
+	PixelReadback& operator = (const PixelReadback&) = delete;
+
+	void Init(uint32_t numBuffers);
+	void Kill();
+
+	// false if all buffers hold pending reads, the oldest has to be mapped first
+	bool Read(int x, int y, int w, int h, GLenum format, GLenum type, uint32_t byteSize);
+
+	// nullptr if nothing is pending, or if the oldest read is not done and !wait
+	const uint8_t* MapOldest(bool wait, uint32_t* byteSize = nullptr);
+	void UnmapOldest();
+
+	bool IsValid() const { return (!slots.empty()); }
+	bool IsFull() const { return (numPending == slots.size()); }
+	uint32_t NumPending() const { return numPending; }
+private:
+	struct Slot {
+		GLuint id = 0;
+		GLsync fence = {};
+
+		uint32_t size = 0;
+		std::vector<uint8_t> hostBuf; // fallback path
+	};
+private:
+	std::vector<Slot> slots;
+
+	uint32_t head = 0; // oldest pending
+	uint32_t numPending = 0;
+
+	bool usePBOs = false;
+	bool mapped = false;
+};
@@ -0,0 +1,496 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#include "StateCache.h"
+
+#include <array>
+#include <algorithm>
+
+#include "myGL.h"
+
+#include "System/Misc/TracyDefs.h"
+
+namespace {
+	constexpr GLuint UNKNOWN_NAME = ~GLuint(0);
+	constexpr GLenum UNKNOWN_ENUM = ~GLenum(0);
+	constexpr uint8_t UNKNOWN_BOOL = 0xFF;
+
+	constexpr uint32_t NUM_TEX_UNITS = 32;
+
+	enum TexTargets {
+		TEX_TARGET_1D,
+		TEX_TARGET_2D,
+		TEX_TARGET_3D,
+		TEX_TARGET_1D_ARRAY,
+		TEX_TARGET_2D_ARRAY,
+		TEX_TARGET_RECTANGLE,
+		TEX_TARGET_CUBE_MAP,
+		TEX_TARGET_CUBE_MAP_ARRAY,
+		TEX_TARGET_BUFFER,
+		TEX_TARGET_2D_MULTISAMPLE,
+		TEX_TARGET_2D_MULTISAMPLE_ARRAY,
+		TEX_TARGET_COUNT
+	};
+
+	enum Capabilities {
+		CAP_BLEND,
+		CAP_DEPTH_TEST,
+		CAP_CULL_FACE,
+		CAP_COUNT
+	};
+
+	struct RealFuncs {
+		PFNGLACTIVETEXTUREPROC ActiveTexture;
+		PFNGLACTIVETEXTUREARBPROC ActiveTextureARB;
+		PFNGLBINDTEXTUREPROC BindTexture;
+		PFNGLBINDTEXTURESPROC BindTextures;
+		PFNGLBINDTEXTUREUNITPROC BindTextureUnit;
+		PFNGLDELETETEXTURESPROC DeleteTextures;
+		PFNGLUSEPROGRAMPROC UseProgram;
+		PFNGLBINDVERTEXARRAYPROC BindVertexArray;
+		PFNGLDELETEVERTEXARRAYSPROC DeleteVertexArrays;
+		PFNGLENABLEPROC Enable;
+		PFNGLDISABLEPROC Disable;
+		PFNGLENABLEIPROC Enablei;
+		PFNGLDISABLEIPROC Disablei;
+		PFNGLBLENDFUNCPROC BlendFunc;
+		PFNGLBLENDFUNCSEPARATEPROC BlendFuncSeparate;
+		PFNGLBLENDFUNCIPROC BlendFunci;
+		PFNGLBLENDFUNCSEPARATEIPROC BlendFuncSeparatei;
+		PFNGLDEPTHFUNCPROC DepthFunc;
+		PFNGLDEPTHMASKPROC DepthMask;
+		PFNGLPOPATTRIBPROC PopAttrib;
+		PFNGLNEWLISTPROC NewList;
+		PFNGLENDLISTPROC EndList;
+		PFNGLCALLLISTPROC CallList;
+		PFNGLCALLLISTSPROC CallLists;
+	};
+
+	struct CachedState {
+		uint32_t activeUnit; // index, NUM_TEX_UNITS if unknown or out of range
+		std::array<std::array<GLuint, TEX_TARGET_COUNT>, NUM_TEX_UNITS> textures;
+
+		GLuint program;
+		GLuint vao;
+
+		std::array<uint8_t, CAP_COUNT> caps;
+		std::array<GLenum, 4> blendFunc; // srcRGB, dstRGB, srcAlpha, dstAlpha
+		GLenum depthFunc;
+		uint8_t depthMask;
+
+		// display lists record instead of execute, state is not shadowed meanwhile
+		bool compilingList;
+	};
+
+	RealFuncs real = {};
+	CachedState state = {};
+	GL::StateCache::Stats curStats;
+	GL::StateCache::Stats frameStats;
+	bool installed = false;
+
+
+	void InvalidateAttribState()
+	{
+		state.activeUnit = NUM_TEX_UNITS;
+
+		for (auto& unitTextures: state.textures) {
+			unitTextures.fill(UNKNOWN_NAME);
+		}
+
+		state.caps.fill(UNKNOWN_BOOL);
+		state.blendFunc.fill(UNKNOWN_ENUM);
+		state.depthFunc = UNKNOWN_ENUM;
+		state.depthMask = UNKNOWN_BOOL;
+	}
+
+	void InvalidateState()
+	{
+		InvalidateAttribState();
+
+		state.program = UNKNOWN_NAME;
+		state.vao = UNKNOWN_NAME;
+	}
+
+	// returns true if the call can be skipped, otherwise updates the shadowed value
+	template<typename T>
+	bool Elide(T& cachedValue, T newValue)
+	{
+		if (state.compilingList) {
+			curStats.issued += 1;
+			return false;
+		}
+		if (cachedValue == newValue) {
+			curStats.elided += 1;
+			return true;
+		}
+
+		cachedValue = newValue;
+		curStats.issued += 1;
+		return false;
+	}
+
+
+	int GetTexTargetIndex(GLenum target)
+	{
+		switch (target) {
+			case GL_TEXTURE_1D                  : return TEX_TARGET_1D;
+			case GL_TEXTURE_2D                  : return TEX_TARGET_2D;
+			case GL_TEXTURE_3D                  : return TEX_TARGET_3D;
+			case GL_TEXTURE_1D_ARRAY            : return TEX_TARGET_1D_ARRAY;
+			case GL_TEXTURE_2D_ARRAY            : return TEX_TARGET_2D_ARRAY;
+			case GL_TEXTURE_RECTANGLE           : return TEX_TARGET_RECTANGLE;
+			case GL_TEXTURE_CUBE_MAP            : return TEX_TARGET_CUBE_MAP;
+			case GL_TEXTURE_CUBE_MAP_ARRAY      : return TEX_TARGET_CUBE_MAP_ARRAY;
+			case GL_TEXTURE_BUFFER              : return TEX_TARGET_BUFFER;
+			case GL_TEXTURE_2D_MULTISAMPLE      : return TEX_TARGET_2D_MULTISAMPLE;
+			case GL_TEXTURE_2D_MULTISAMPLE_ARRAY: return TEX_TARGET_2D_MULTISAMPLE_ARRAY;
+			default: {} break;
+		}
+
+		return -1;
+	}
+
+	int GetCapabilityIndex(GLenum cap)
+	{
+		switch (cap) {
+			case GL_BLEND     : return CAP_BLEND;
+			case GL_DEPTH_TEST: return CAP_DEPTH_TEST;
+			case GL_CULL_FACE : return CAP_CULL_FACE;
+			default: {} break;
+		}
+
+		return -1;
+	}
+
+
+	template<typename ActiveTextureFunc>
+	void SetActiveTexture(ActiveTextureFunc func, GLenum texUnit)
+	{
+		const uint32_t unitIdx = texUnit - GL_TEXTURE0;
+
+		if (unitIdx >= NUM_TEX_UNITS) {
+			// untracked unit, bindings on it pass through
+			state.activeUnit = NUM_TEX_UNITS;
+			curStats.issued += 1;
+			func(texUnit);
+			return;
+		}
+
+		if (Elide(state.activeUnit, unitIdx))
+			return;
+
+		func(texUnit);
+	}
+
+	void APIENTRY CachedActiveTexture(GLenum texUnit) { SetActiveTexture(real.ActiveTexture, texUnit); }
+	void APIENTRY CachedActiveTextureARB(GLenum texUnit) { SetActiveTexture(real.ActiveTextureARB, texUnit); }
+
+	void APIENTRY CachedBindTexture(GLenum target, GLuint texture)
+	{
+		const int targetIdx = GetTexTargetIndex(target);
+
+		if (targetIdx < 0 || state.activeUnit >= NUM_TEX_UNITS) {
+			curStats.issued += 1;
+			real.BindTexture(target, texture);
+			return;
+		}
+
+		if (Elide(state.textures[state.activeUnit][targetIdx], texture))
+			return;
+
+		real.BindTexture(target, texture);
+	}
+
+	void APIENTRY CachedBindTextures(GLuint first, GLsizei count, const GLuint* textures)
+	{
+		for (GLsizei i = 0; i < count; ++i) {
+			if ((first + i) < NUM_TEX_UNITS)
+				state.textures[first + i].fill(UNKNOWN_NAME);
+		}
+
+		curStats.issued += 1;
+		real.BindTextures(first, count, textures);
+	}
+
+	void APIENTRY CachedBindTextureUnit(GLuint unit, GLuint texture)
+	{
+		if (unit < NUM_TEX_UNITS)
+			state.textures[unit].fill(UNKNOWN_NAME);
+
+		curStats.issued += 1;
+		real.BindTextureUnit(unit, texture);
+	}
+
+	void APIENTRY CachedDeleteTextures(GLsizei n, const GLuint* textures)
+	{
+		// deleted textures revert every binding of them to zero
+		for (GLsizei i = 0; i < n; ++i) {
+			for (auto& unitTextures: state.textures) {
+				std::replace(unitTextures.begin(), unitTextures.end(), textures[i], GLuint(0));
+			}
+		}
+
+		real.DeleteTextures(n, textures);
+	}
+
+	void APIENTRY CachedUseProgram(GLuint program)
+	{
+		if (Elide(state.program, program))
+			return;
+
+		real.UseProgram(program);
+	}
+
+	void APIENTRY CachedBindVertexArray(GLuint vao)
+	{
+		if (Elide(state.vao, vao))
+			return;
+
+		real.BindVertexArray(vao);
+	}
+
+	void APIENTRY CachedDeleteVertexArrays(GLsizei n, const GLuint* vaos)
+	{
+		for (GLsizei i = 0; i < n; ++i) {
+			if (state.vao == vaos[i])
+				state.vao = 0;
+		}
+
+		real.DeleteVertexArrays(n, vaos);
+	}
+
+	void APIENTRY CachedEnable(GLenum cap)
+	{
+		if (const int capIdx = GetCapabilityIndex(cap); capIdx >= 0) {
+			if (Elide(state.caps[capIdx], uint8_t(GL_TRUE)))
+				return;
+		} else {
+			curStats.issued += 1;
+		}
+
+		real.Enable(cap);
+	}
+
+	void APIENTRY CachedDisable(GLenum cap)
+	{
+		if (const int capIdx = GetCapabilityIndex(cap); capIdx >= 0) {
+			if (Elide(state.caps[capIdx], uint8_t(GL_FALSE)))
+				return;
+		} else {
+			curStats.issued += 1;
+		}
+
+		real.Disable(cap);
+	}
+
+	void APIENTRY CachedEnablei(GLenum cap, GLuint index)
+	{
+		if (const int capIdx = GetCapabilityIndex(cap); capIdx >= 0)
+			state.caps[capIdx] = UNKNOWN_BOOL;
+
+		curStats.issued += 1;
+		real.Enablei(cap, index);
+	}
+
+	void APIENTRY CachedDisablei(GLenum cap, GLuint index)
+	{
+		if (const int capIdx = GetCapabilityIndex(cap); capIdx >= 0)
+			state.caps[capIdx] = UNKNOWN_BOOL;
+
+		curStats.issued += 1;
+		real.Disablei(cap, index);
+	}
+
+	void APIENTRY CachedBlendFunc(GLenum sfactor, GLenum dfactor)
+	{
+		if (Elide(state.blendFunc, std::array<GLenum, 4>{sfactor, dfactor, sfactor, dfactor}))
+			return;
+
+		real.BlendFunc(sfactor, dfactor);
+	}
+
+	void APIENTRY CachedBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+	{
+		if (Elide(state.blendFunc, std::array<GLenum, 4>{srcRGB, dstRGB, srcAlpha, dstAlpha}))
+			return;
+
+		real.BlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+	}
+
+	void APIENTRY CachedBlendFunci(GLuint buf, GLenum sfactor, GLenum dfactor)
+	{
+		state.blendFunc.fill(UNKNOWN_ENUM);
+		curStats.issued += 1;
+		real.BlendFunci(buf, sfactor, dfactor);
+	}
+
+	void APIENTRY CachedBlendFuncSeparatei(GLuint buf, GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha)
+	{
+		state.blendFunc.fill(UNKNOWN_ENUM);
+		curStats.issued += 1;
+		real.BlendFuncSeparatei(buf, srcRGB, dstRGB, srcAlpha, dstAlpha);
+	}
+
+	void APIENTRY CachedDepthFunc(GLenum func)
+	{
+		if (Elide(state.depthFunc, func))
+			return;
+
+		real.DepthFunc(func);
+	}
+
+	void APIENTRY CachedDepthMask(GLboolean flag)
+	{
+		if (Elide(state.depthMask, uint8_t(flag != GL_FALSE)))
+			return;
+
+		real.DepthMask(flag);
+	}
+
+	// all shadowed attrib state could have been pushed, or set while
+	// compiling a list (which does not execute it in GL_COMPILE mode)
+	void APIENTRY CachedPopAttrib()
+	{
+		real.PopAttrib();
+
+		if (!state.compilingList)
+			InvalidateAttribState();
+	}
+
+	void APIENTRY CachedNewList(GLuint list, GLenum mode)
+	{
+		real.NewList(list, mode);
+		state.compilingList = true;
+	}
+
+	void APIENTRY CachedEndList()
+	{
+		real.EndList();
+		state.compilingList = false;
+		// GL_COMPILE_AND_EXECUTE did change the state
+		InvalidateState();
+	}
+
+	void APIENTRY CachedCallList(GLuint list)
+	{
+		real.CallList(list);
+
+		if (!state.compilingList)
+			InvalidateState();
+	}
+
+	void APIENTRY CachedCallLists(GLsizei n, GLenum type, const void* lists)
+	{
+		real.CallLists(n, type, lists);
+
+		if (!state.compilingList)
+			InvalidateState();
+	}
+
+
+	// replaces a GLAD entry point, functions the context does not provide stay null
+	template<typename FuncPtr>
+	void Hook(FuncPtr& gladFunc, FuncPtr& realFunc, FuncPtr cachedFunc)
+	{
+		realFunc = gladFunc;
+
+		if (gladFunc != nullptr)
+			gladFunc = cachedFunc;
+	}
+
+	template<typename FuncPtr>
+	void Unhook(FuncPtr& gladFunc, FuncPtr& realFunc)
+	{
+		if (gladFunc != nullptr)
+			gladFunc = realFunc;
+
+		realFunc = nullptr;
+	}
+}
+
+
+void GL::StateCache::Install()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (installed)
+		return;
+
+	Hook(glad_glActiveTexture     , real.ActiveTexture     , &CachedActiveTexture     );
+	Hook(glad_glActiveTextureARB  , real.ActiveTextureARB  , &CachedActiveTextureARB  );
+	Hook(glad_glBindTexture       , real.BindTexture       , &CachedBindTexture       );
+	Hook(glad_glBindTextures      , real.BindTextures      , &CachedBindTextures      );
+	Hook(glad_glBindTextureUnit   , real.BindTextureUnit   , &CachedBindTextureUnit   );
+	Hook(glad_glDeleteTextures    , real.DeleteTextures    , &CachedDeleteTextures    );
+	Hook(glad_glUseProgram        , real.UseProgram        , &CachedUseProgram        );
+	Hook(glad_glBindVertexArray   , real.BindVertexArray   , &CachedBindVertexArray   );
+	Hook(glad_glDeleteVertexArrays, real.DeleteVertexArrays, &CachedDeleteVertexArrays);
+	Hook(glad_glEnable            , real.Enable            , &CachedEnable            );
+	Hook(glad_glDisable           , real.Disable           , &CachedDisable           );
+	Hook(glad_glEnablei           , real.Enablei           , &CachedEnablei           );
+	Hook(glad_glDisablei          , real.Disablei          , &CachedDisablei          );
+	Hook(glad_glBlendFunc         , real.BlendFunc         , &CachedBlendFunc         );
+	Hook(glad_glBlendFuncSeparate , real.BlendFuncSeparate , &CachedBlendFuncSeparate );
+	Hook(glad_glBlendFunci        , real.BlendFunci        , &CachedBlendFunci        );
+	Hook(glad_glBlendFuncSeparatei, real.BlendFuncSeparatei, &CachedBlendFuncSeparatei);
+	Hook(glad_glDepthFunc         , real.DepthFunc         , &CachedDepthFunc         );
+	Hook(glad_glDepthMask         , real.DepthMask         , &CachedDepthMask         );
+	Hook(glad_glPopAttrib         , real.PopAttrib         , &CachedPopAttrib         );
+	Hook(glad_glNewList           , real.NewList           , &CachedNewList           );
+	Hook(glad_glEndList           , real.EndList           , &CachedEndList           );
+	Hook(glad_glCallList          , real.CallList          , &CachedCallList          );
+	Hook(glad_glCallLists         , real.CallLists         , &CachedCallLists         );
+
+	state.compilingList = false;
+	InvalidateState();
+
+	curStats = {};
+	frameStats = {};
+	installed = true;
+}
+
+void GL::StateCache::Uninstall()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!installed)
+		return;
+
+	Unhook(glad_glActiveTexture     , real.ActiveTexture     );
+	Unhook(glad_glActiveTextureARB  , real.ActiveTextureARB  );
+	Unhook(glad_glBindTexture       , real.BindTexture       );
+	Unhook(glad_glBindTextures      , real.BindTextures      );
+	Unhook(glad_glBindTextureUnit   , real.BindTextureUnit   );
+	Unhook(glad_glDeleteTextures    , real.DeleteTextures    );
+	Unhook(glad_glUseProgram        , real.UseProgram        );
+	Unhook(glad_glBindVertexArray   , real.BindVertexArray   );
+	Unhook(glad_glDeleteVertexArrays, real.DeleteVertexArrays);
+	Unhook(glad_glEnable            , real.Enable            );
+	Unhook(glad_glDisable           , real.Disable           );
+	Unhook(glad_glEnablei           , real.Enablei           );
+	Unhook(glad_glDisablei          , real.Disablei          );
+	Unhook(glad_glBlendFunc         , real.BlendFunc         );
+	Unhook(glad_glBlendFuncSeparate , real.BlendFuncSeparate );
+	Unhook(glad_glBlendFunci        , real.BlendFunci        );
+	Unhook(glad_glBlendFuncSeparatei, real.BlendFuncSeparatei);
+	Unhook(glad_glDepthFunc         , real.DepthFunc         );
+	Unhook(glad_glDepthMask         , real.DepthMask         );
+	Unhook(glad_glPopAttrib         , real.PopAttrib         );
+	Unhook(glad_glNewList           , real.NewList           );
+	Unhook(glad_glEndList           , real.EndList           );
+	Unhook(glad_glCallList          , real.CallList          );
+	Unhook(glad_glCallLists         , real.CallLists         );
+
+	installed = false;
+}
+
+void GL::StateCache::Invalidate()
+{
+	InvalidateState();
+}
+
+void GL::StateCache::EndFrame()
+{
+	frameStats = curStats;
+	curStats = {};
+}
+
+bool GL::StateCache::IsInstalled() { return installed; }
+const GL::StateCache::Stats& GL::StateCache::GetFrameStats() { return frameStats; }
@@ -0,0 +1,36 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#pragma once
+
+#include <cstdint>
+
+/*
+	GL::StateCache shadows the most frequently (re)set GL state: texture, program
+	and VAO bindings, blend and depth state, and the GL_BLEND, GL_DEPTH_TEST and
+	GL_CULL_FACE capabilities. Once installed it replaces the respective GLAD entry
+	points, so every caller (engine and Lua alike) skips calls that would not change
+	the current value.
+
+	Shadowed values become unknown whenever GL can change them behind our back:
+	glPopAttrib, display list compilation and calls, multi-bind and indexed variants.
+	A single context exists (which moves between threads during loading), so the
+	shadowed state is global.
+*/
+
+namespace GL::StateCache
+{
+	struct Stats {
+		uint32_t issued = 0;
+		uint32_t elided = 0;
+	};
+
+	void Install();
+	void Uninstall();
+	// mark all shadowed state unknown, e.g. after a context switch
+	void Invalidate();
+	// latches the current counts into GetFrameStats
+	void EndFrame();
+
+	bool IsInstalled();
+	const Stats& GetFrameStats();
+}
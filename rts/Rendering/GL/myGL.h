@@ -141,6 +141,21 @@ struct SDrawElementsIndirectCommand {
 	uint32_t baseInstance;
 };
 
+struct SDrawArraysIndirectCommand {
+	SDrawArraysIndirectCommand() = default;
+	SDrawArraysIndirectCommand(uint32_t vertexCount_, uint32_t instanceCount_, uint32_t firstVertex_, uint32_t baseInstance_)
+		: vertexCount{ vertexCount_ }
+		, instanceCount{ instanceCount_ }
+		, firstVertex{ firstVertex_ }
+		, baseInstance{ baseInstance_ }
+	{};
+
+	uint32_t vertexCount;
+	uint32_t instanceCount;
+	uint32_t firstVertex;
+	uint32_t baseInstance;
+};
+
 struct SInstanceData {
 	SInstanceData() = default;
 	SInstanceData(uint32_t matOffset_, uint8_t teamIndex, uint8_t drawFlags, uint16_t numPieces, uint32_t uniOffset_, uint32_t bposeMatOffset_)
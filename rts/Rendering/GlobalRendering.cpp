@@ -10,11 +10,14 @@
 #include "GlobalRenderingInfo.h"
 #include "Rendering/VerticalSync.h"
 #include "Rendering/GL/StreamBuffer.h"
+#include "Rendering/GL/FrameRingBuffer.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/glExtra.h"
 #include "Rendering/GL/glxHandler.h"
+#include "Rendering/GL/GPUTimer.h"
+#include "Rendering/GL/StateCache.h"
 #include "Rendering/UniformConstants.h"
 #include "Rendering/Fonts/glFont.h"
 #include "System/EventHandler.h"
@@ -26,6 +29,7 @@
 #include "System/Matrix44f.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/AllocCounter.h"
 #include "System/Platform/CrashHandler.h"
 #include "System/Platform/MessageBox.h"
 #include "System/Platform/Threading.h"
@@ -44,6 +48,7 @@
 
 CONFIG(bool, DebugGL).defaultValue(false).description("Enables GL debug-context and output. (see GL_ARB_debug_output)");
 CONFIG(bool, DebugGLStacktraces).defaultValue(false).description("Create a stacktrace when an OpenGL error occurs");
+CONFIG(bool, GLStateCache).defaultValue(true).headlessValue(false).safemodeValue(false).description("Skip redundant texture, program, VAO, blend and depth state changes by shadowing them.");
 CONFIG(bool, DebugGLReportGroups).defaultValue(false).description("Show OpenGL PUSH/POP groups in the GL debug");
 
 CONFIG(int, GLContextMajorVersion).defaultValue(3).minimumValue(3).maximumValue(4);
@@ -379,6 +384,7 @@ CGlobalRendering::~CGlobalRendering()
 	// protect against aborted startup
 	if (glContext) {
 		glDeleteQueries(glTimerQueries.size(), glTimerQueries.data());
+		GL::GPUTimer::Kill();
 	}
 
 	DestroyWindowAndContext();
@@ -389,6 +395,7 @@ void CGlobalRendering::PreKill()
 {
 	UniformConstants::GetInstance().Kill(); //unsafe to kill in ~CGlobalRendering()
 	RenderBuffer::KillStatic();
+	FrameRingBuffer::GetInstance().Kill();
 	GL::shapes.Kill();
 	CShaderHandler::FreeInstance();
 }
@@ -589,6 +596,9 @@ bool CGlobalRendering::CreateWindowAndContext(const char* title)
 	gladLoadGL();
 	GLX::Load(sdlWindow);
 
+	if (configHandler->GetBool("GLStateCache"))
+		GL::StateCache::Install();
+
 	if (!CheckGLContextVersion(minCtx)) {
 		int ctxProfile = 0;
 		SDL_GL_GetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, &ctxProfile);
@@ -623,6 +633,8 @@ void CGlobalRendering::DestroyWindowAndContext() {
 	SDL_GL_MakeCurrent(sdlWindow, nullptr);
 	SDL_DestroyWindow(sdlWindow);
 
+	GL::StateCache::Uninstall();
+
 	#if !defined(HEADLESS)
 	if (glContext)
 		SDL_GL_DeleteContext(glContext);
@@ -661,7 +673,9 @@ void CGlobalRendering::PostInit() {
 	UniformConstants::GetInstance().Init();
 	ModelUniformData::Init();
 	glGenQueries(glTimerQueries.size(), glTimerQueries.data());
+	GL::GPUTimer::Init();
 	RenderBuffer::InitStatic();
+	FrameRingBuffer::GetInstance().Init();
 	GL::shapes.Init();
 
 	UpdateTimer();
@@ -686,6 +700,7 @@ void CGlobalRendering::SwapBuffers(bool allowSwapBuffers, bool clearErrors)
 
 		RenderBuffer::SwapRenderBuffers(); //all RBs are swapped here
 		IStreamBufferConcept::PutBufferLocks();
+		FrameRingBuffer::GetInstance().SwapFrame();
 
 		//https://stackoverflow.com/questions/68480028/supporting-opengl-screen-capture-by-third-party-applications
 		glBindFramebuffer(GL_READ_FRAMEBUFFER_EXT, 0);
@@ -711,6 +726,11 @@ void CGlobalRendering::SwapBuffers(bool allowSwapBuffers, bool clearErrors)
 
 		FrameMark;
 	}
+
+	GL::StateCache::EndFrame();
+	GL::GPUTimer::EndFrame();
+	CAllocCounter::EndFrame();
+
 	// exclude debug from SCOPED_TIMER("Misc::SwapBuffers");
 	eventHandler.DbgTimingInfo(TIMING_SWAP, pre, spring_now());
 	globalRendering->lastSwapBuffersEnd = spring_now();
@@ -10,6 +10,7 @@
 
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/RenderBuffers.h"
+#include "Rendering/Textures/TextureRenderAtlas.h"
 #include "System/Log/ILog.h"
 #include "Lua/LuaParser.h"
 #include "Textures/Bitmap.h"
@@ -29,6 +30,9 @@ static CIconData dummyIconData[CIconHandler::ICON_DATA_OFFSET];
 
 void CIconHandler::Kill()
 {
+	iconAtlas = nullptr;
+	iconAtlasDirty = true;
+
 	glDeleteTextures(1, &defTexID);
 
 	defTexID = 0;
@@ -134,6 +138,7 @@ bool CIconHandler::AddIcon(
 	iconData[numIcons] = {iconName, texID,  size, distance, radAdj, ownTexture, xsize, ysize};
 	// indices 0 and 1 are reserved
 	iconMap[iconName] = CIcon(ICON_DATA_OFFSET + numIcons++);
+	iconAtlasDirty = true;
 
 	if (iconName == "default") {
 		dummyIconData[DEFAULT_DATA_IDX].CopyData(&iconData[numIcons - 1]);
@@ -157,6 +162,7 @@ bool CIconHandler::FreeIcon(const std::string& iconName)
 	GetIconDataMut(it->second.dataIdx)->CopyData(&dummyIconData[DEFAULT_DATA_IDX]);
 
 	iconMap.erase(iconName);
+	iconAtlasDirty = true;
 	return true;
 }
 
@@ -175,6 +181,45 @@ const CIconData* CIconHandler::GetSafetyIconData() { return &dummyIconData[SAFET
 const CIconData* CIconHandler::GetDefaultIconData() { return &dummyIconData[DEFAULT_DATA_IDX]; }
 
 
+const CTextureRenderAtlas* CIconHandler::GetIconAtlas()
+{
+	if (!iconAtlasDirty)
+		return iconAtlas.get();
+
+	iconAtlasDirty = false;
+	iconAtlas = std::make_unique<CTextureRenderAtlas>(CTextureAtlas::ATLAS_ALLOC_LEGACY, 0, 0, GL_RGBA8, "IconAtlas");
+
+	// icons sharing a texture (e.g. the default one) share the atlas entry
+	const auto AddIconTexture = [this](const CIconData& data) {
+		if (data.GetTextureID() == 0)
+			return;
+
+		iconAtlas->AddTexFromID(std::to_string(data.GetTextureID()), data.GetTextureID(), data.GetSizeX(), data.GetSizeY());
+	};
+
+	AddIconTexture(dummyIconData[DEFAULT_DATA_IDX]);
+
+	for (unsigned int i = 0; i < numIcons; i++) {
+		AddIconTexture(iconData[i]);
+	}
+
+	if (!iconAtlas->Finalize()) {
+		LOG_L(L_WARNING, "[IconHandler::%s] icon textures do not fit into a single atlas", __func__);
+		iconAtlas = nullptr;
+	}
+
+	return iconAtlas.get();
+}
+
+AtlasedTexture CIconHandler::GetIconAtlasTexture(const CIconData* data) const
+{
+	if (iconAtlas == nullptr)
+		return AtlasedTexture::DefaultAtlasTexture;
+
+	return iconAtlas->GetTexture(std::to_string(data->GetTextureID()));
+}
+
+
 unsigned int CIconHandler::GetDefaultTexture()
 {
 	// FIXME: just use a PNG ?
@@ -4,13 +4,17 @@
 #define ICON_HANDLER_H
 
 #include <array>
+#include <memory>
 #include <string>
 
 #include "Icon.h"
+#include "Rendering/Textures/AtlasedTexture.hpp"
 #include "System/float3.h"
 #include "System/UnorderedMap.hpp"
 #include "Rendering/GL/RenderBuffersFwd.h"
 
+class CTextureRenderAtlas;
+
 namespace icon {
 	class CIconData {
 		public:
@@ -122,6 +126,11 @@ namespace icon {
 			static const CIconData* GetSafetyIconData();
 			static const CIconData* GetDefaultIconData();
 
+			/// all icon textures packed into one, rebuilt after icons were added or freed; nullptr if they do not fit
+			const CTextureRenderAtlas* GetIconAtlas();
+			/// coordinates of the texture of <data> within GetIconAtlas()
+			AtlasedTexture GetIconAtlasTexture(const CIconData* data) const;
+
 		private:
 			CIconData* GetIconDataMut(unsigned int idx) { return (const_cast<CIconData*>(GetIconData(idx))); }
 
@@ -152,6 +161,9 @@ namespace icon {
 
 			spring::unordered_map<std::string, CIcon> iconMap;
 			std::array<CIconData, 2048> iconData;
+
+			std::unique_ptr<CTextureRenderAtlas> iconAtlas;
+			bool iconAtlasDirty = true;
 	};
 
 	extern CIconHandler iconHandler;
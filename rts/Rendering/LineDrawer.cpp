@@ -4,10 +4,18 @@
 
 #include "LineDrawer.h"
 
+#include <bit>
 #include <cmath>
+#include <cstring>
 
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/RenderBuffers.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Rendering/Shaders/ShaderHandler.h"
 #include "Game/UI/CommandColors.h"
+#include "Map/Ground.h"
+#include "System/SpringMath.h"
+#include "System/Log/ILog.h"
 
 CLineDrawer lineDrawer;
 
@@ -21,9 +29,26 @@ CLineDrawer::CLineDrawer()
 	, lastPos(ZeroVector)
 	, lastColor(NULL)
 	, stippleTimer(0.0f)
+	, stipplePattern(0xffff)
+	, stippleShift(0)
 {
-	lines.reserve(32);
-	stippled.reserve(32);
+	segments.reserve(256);
+}
+
+
+void CLineDrawer::Kill()
+{
+	if (shader != nullptr)
+		shaderHandler->ReleaseProgramObject("[LineDrawer]", "LineDrawer");
+
+	shader = nullptr;
+	initialized = false;
+
+	segments = {};
+	uploadedSegments = {};
+
+	instVBO = nullptr;
+	vao = {};
 }
 
 
@@ -45,49 +70,176 @@ void CLineDrawer::SetupLineStipple()
 	}
 	const unsigned int fullPat = (stipPat << 16) | (stipPat & 0x0000ffff);
 	const int shiftBits = 15 - (int(stippleTimer * 20.0f) % 16);
+
+	stipplePattern = stipPat;
+	stippleShift = shiftBits;
+
+	// still set for LuaOpenGL::LineStipple, the queue lines emulate it
 	glLineStipple(cmdColors.StippleFactor(), (fullPat >> shiftBits));
 }
 
 
+void CLineDrawer::DrawSurfaceCircle(const float3& center, float radius, const float* color, uint32_t res)
+{
+	if (color[3] == 0.0f || res == 0)
+		return;
+
+	const SColor c = {color};
+
+	float3 prvPos;
+	float3 curPos;
+
+	for (uint32_t i = 0; i <= res; ++i) {
+		const float radians = math::TWOPI * (float)(i % res) / (float)res;
+
+		curPos.x = center.x + (fastmath::sin(radians) * radius);
+		curPos.z = center.z + (fastmath::cos(radians) * radius);
+		curPos.y = CGround::GetHeightAboveWater(curPos.x, curPos.z, false) + 5.0f;
+
+		if (i > 0)
+			segments.push_back({prvPos, 0.0f, curPos, c, c});
+
+		prvPos = curPos;
+	}
+}
+
+
+bool CLineDrawer::Init()
+{
+	if (initialized)
+		return (shader != nullptr && shader->IsValid());
+
+	initialized = true;
+	instVBO = std::make_unique<VBO>(GL_ARRAY_BUFFER);
+
+	shader = shaderHandler->CreateProgramObject("[LineDrawer]", "LineDrawer");
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/LineDrawerVertProg.glsl", "", GL_VERTEX_SHADER));
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/LineDrawerFragProg.glsl", "", GL_FRAGMENT_SHADER));
+	shader->BindAttribLocation("segStart", 0);
+	shader->BindAttribLocation("segEnd", 1);
+	shader->BindAttribLocation("segStartColor", 2);
+	shader->BindAttribLocation("segEndColor", 3);
+	shader->Link();
+	shader->Validate();
+
+	if (!shader->IsValid()) {
+		LOG_L(L_WARNING, "[LineDrawer::%s] line shader error, falling back to unstippled lines: %s", __func__, shader->GetLog().c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+void CLineDrawer::Upload()
+{
+	static_assert(sizeof(LineSegment) == 36);
+
+	// most segments come from CommandDrawer's cache in the same order every
+	// frame, so only re-upload the runs of segments that changed (e.g. the
+	// ones starting at moving units), merging runs separated by a few others
+	static constexpr size_t MAX_UNCHANGED_RUN = 32;
+
+	const size_t numSegments = segments.size();
+
+	instVBO->Bind(GL_ARRAY_BUFFER);
+
+	if (instVBO->GetSize() < numSegments * sizeof(LineSegment)) {
+		instVBO->New(std::bit_ceil(numSegments) * sizeof(LineSegment), GL_DYNAMIC_DRAW);
+		uploadedSegments.clear();
+
+		vao.Bind();
+		instVBO->Bind(GL_ARRAY_BUFFER);
+
+		for (GLuint i = 0; i < 4; ++i) {
+			glEnableVertexAttribArray(i);
+			glVertexAttribDivisor(i, 1);
+		}
+
+		// startPos and stippled are read as one vec4
+		glVertexAttribPointer(0, 4, GL_FLOAT        , false, sizeof(LineSegment), VA_TYPE_OFFSET(LineSegment, startPos  ));
+		glVertexAttribPointer(1, 3, GL_FLOAT        , false, sizeof(LineSegment), VA_TYPE_OFFSET(LineSegment, endPos    ));
+		glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, true , sizeof(LineSegment), VA_TYPE_OFFSET(LineSegment, startColor));
+		glVertexAttribPointer(3, 4, GL_UNSIGNED_BYTE, true , sizeof(LineSegment), VA_TYPE_OFFSET(LineSegment, endColor  ));
+
+		vao.Unbind();
+
+		for (GLuint i = 0; i < 4; ++i) {
+			glDisableVertexAttribArray(i);
+			glVertexAttribDivisor(i, 0);
+		}
+	}
+
+	const auto IsChanged = [&](size_t i) {
+		return (i >= uploadedSegments.size() || std::memcmp(&segments[i], &uploadedSegments[i], sizeof(LineSegment)) != 0);
+	};
+
+	for (size_t i = 0; i < numSegments; ) {
+		if (!IsChanged(i)) {
+			++i;
+			continue;
+		}
+
+		size_t j = i + 1;
+
+		for (size_t k = j; k < numSegments && (k - j) < MAX_UNCHANGED_RUN; ++k) {
+			if (IsChanged(k))
+				j = k + 1;
+		}
+
+		instVBO->SetBufferSubData(i * sizeof(LineSegment), (j - i) * sizeof(LineSegment), &segments[i]);
+		i = j;
+	}
+
+	instVBO->Unbind();
+
+	std::swap(segments, uploadedSegments);
+}
+
+
 void CLineDrawer::DrawAll()
 {
-	if (lines.empty() && stippled.empty())
+	if (segments.empty())
 		return;
-	
-	glEnableClientState(GL_VERTEX_ARRAY);
-	glEnableClientState(GL_COLOR_ARRAY);
 
 	glPushAttrib(GL_ENABLE_BIT);
 	glDisable(GL_TEXTURE_2D);
 	glDisable(GL_DEPTH_TEST);
 	glDisable(GL_LINE_STIPPLE);
 
-	for (int i = 0; i<lines.size(); ++i) {
-		int size = lines[i].colors.size();
-		if(size > 0) {
-			glColorPointer(4, GL_FLOAT, 0, &lines[i].colors[0]);
-			glVertexPointer(3, GL_FLOAT, 0, &lines[i].verts[0]);
-			glDrawArrays(lines[i].type, 0, size/4);
-		}
-	}
+	if (Init()) {
+		Upload();
+
+		// the stipple counts pixels along each segment, like GL_LINES
+		GLint viewport[4];
+		glGetIntegerv(GL_VIEWPORT, viewport);
+
+		shader->Enable();
+		shader->SetUniform("viewportSize", float(viewport[2]), float(viewport[3]));
+		shader->SetUniform("stipplePattern", static_cast<int>(stipplePattern));
+		shader->SetUniform("stippleShift", stippleShift);
+		shader->SetUniform("stippleFactor", float(std::max(1u, cmdColors.StippleFactor())));
+
+		vao.Bind();
+		glDrawArraysInstanced(GL_LINES, 0, 2, uploadedSegments.size());
+		vao.Unbind();
 
-	if (!stippled.empty()) {
-		glEnable(GL_LINE_STIPPLE);
-		for (int i = 0; i<stippled.size(); ++i) {
-			int size = stippled[i].colors.size();
-			if(size > 0) {
-				glColorPointer(4, GL_FLOAT, 0, &stippled[i].colors[0]);
-				glVertexPointer(3, GL_FLOAT, 0, &stippled[i].verts[0]);
-				glDrawArrays(stippled[i].type, 0, size/4);
-			}
+		shader->Disable();
+	} else {
+		auto& rb = RenderBuffer::GetTypedRenderBuffer<VA_TYPE_C>();
+		auto& sh = rb.GetShader();
+
+		for (const LineSegment& s: segments) {
+			rb.AddVertex({s.startPos, s.startColor});
+			rb.AddVertex({s.endPos  , s.endColor  });
 		}
-		glDisable(GL_LINE_STIPPLE);
+
+		sh.Enable();
+		rb.DrawArrays(GL_LINES);
+		sh.Disable();
 	}
 
-	glDisableClientState(GL_COLOR_ARRAY);
-	glDisableClientState(GL_VERTEX_ARRAY);
 	glPopAttrib();
 
-	lines.clear();
-	stippled.clear();
+	segments.clear();
 }
@@ -5,14 +5,34 @@
 
 #include <vector>
 #include <array>
+#include <memory>
 
 #include "Game/UI/CursorIcons.h"
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VBO.h"
+#include "Rendering/GL/VAO.h"
+#include "System/Color.h"
+
+namespace Shader {
+	struct IProgramObject;
+}
 
 class CLineDrawer {
+	public:
+		// one instance per segment, the vertex shader picks the endpoint
+		struct LineSegment {
+			float3 startPos;
+			float stippled;
+			float3 endPos;
+			SColor startColor;
+			SColor endColor;
+		};
+
 	public:
 		CLineDrawer();
 
+		void Kill();
+
 		void Configure(bool useColorRestarts, bool useRestartColor,
 		               const float* restartColor, float restartAlpha);
 
@@ -31,8 +51,20 @@ class CLineDrawer {
 		void RestartWithColor(const float* color);
 		const float3& GetLastPos() const { return lastPos; }
 
+		/// same as glSurfaceCircle, but batched with the lines (never stippled)
+		void DrawSurfaceCircle(const float3& center, float radius, const float* color, uint32_t res);
+
+		/// for CommandDrawer, which caches the segments of unchanged queues
+		size_t GetNumSegments() const { return segments.size(); }
+		void GetSegments(size_t offset, std::vector<LineSegment>& segs) const { segs.assign(segments.begin() + offset, segments.end()); }
+		void AddSegments(const std::vector<LineSegment>& segs) { segments.insert(segments.end(), segs.begin(), segs.end()); }
+
 		void DrawAll();
 
+	private:
+		bool Init();
+		void Upload();
+
 	private:
 		bool lineStipple;
 		bool useColorRestarts;
@@ -45,15 +77,20 @@ class CLineDrawer {
 		
 		float stippleTimer;
 
+		// pattern and shift of the last SetupLineStipple, applied by the fragment shader
+		unsigned int stipplePattern;
+		int stippleShift;
+
 		// queue all lines and draw them in one go later
-		struct LinePair {
-			GLenum type;
-			std::vector<GLfloat> verts;
-			std::vector<GLfloat> colors;
-		};
+		std::vector<LineSegment> segments;
+		std::vector<LineSegment> uploadedSegments;
 
-		std::vector<LinePair> lines;
-		std::vector<LinePair> stippled;
+		// created on first use, lineDrawer is a global constructed before GL
+		std::unique_ptr<VBO> instVBO;
+		VAO vao;
+
+		Shader::IProgramObject* shader = nullptr;
+		bool initialized = false;
 };
 
 
@@ -90,28 +127,8 @@ inline void CLineDrawer::Break(const float3& endPos, const float* color)
 
 inline void CLineDrawer::Restart()
 {
-	LinePair *ptr;
-	if (lineStipple) {
-		stippled.push_back(LinePair());
-		ptr = &stippled.back();
-	} else {
-		lines.push_back(LinePair());
-		ptr = &lines.back();
-	}
-	LinePair& p = *ptr;
-
-	if (!useColorRestarts)	 {
-		p.type = GL_LINE_STRIP;
-		p.colors.push_back(lastColor[0]);
-		p.colors.push_back(lastColor[1]);
-		p.colors.push_back(lastColor[2]);
-		p.colors.push_back(lastColor[3]);
-		p.verts.push_back(lastPos[0]);
-		p.verts.push_back(lastPos[1]);
-		p.verts.push_back(lastPos[2]);
-	} else {
-		p.type = GL_LINES;
-	}
+	// noop, every segment is drawn on its own; the next one
+	// starts at lastPos with lastColor (or the restart color)
 }
 
 
@@ -140,47 +157,18 @@ inline void CLineDrawer::StartPath(const float3& pos, const float* color)
 
 inline void CLineDrawer::DrawLine(const float3& endPos, const float* color)
 {
-	LinePair *ptr;
-	if (lineStipple) {
-		ptr = &stippled.back();
-	} else {
-		ptr = &lines.back();
-	}
-	LinePair& p = *ptr;
-
-	if (!useColorRestarts) {
-		p.colors.push_back(color[0]);
-		p.colors.push_back(color[1]);
-		p.colors.push_back(color[2]);
-		p.colors.push_back(color[3]);
-		p.verts.push_back(endPos.x);
-		p.verts.push_back(endPos.y);
-		p.verts.push_back(endPos.z);
-	} else {
+	SColor startColor = {lastColor};
+
+	if (useColorRestarts) {
 		if (useRestartColor) {
-			p.colors.push_back(restartColor[0]);
-			p.colors.push_back(restartColor[1]);
-			p.colors.push_back(restartColor[2]);
-			p.colors.push_back(restartColor[3]);
+			startColor = {restartColor};
 		} else {
-			p.colors.push_back(color[0]);
-			p.colors.push_back(color[1]);
-			p.colors.push_back(color[2]);
-			p.colors.push_back(color[3] * restartAlpha);
+			startColor = {color[0], color[1], color[2], color[3] * restartAlpha};
 		}
-		p.verts.push_back(lastPos.x);
-		p.verts.push_back(lastPos.y);
-		p.verts.push_back(lastPos.z);
-
-		p.colors.push_back(color[0]);
-		p.colors.push_back(color[1]);
-		p.colors.push_back(color[2]);
-		p.colors.push_back(color[3]);
-		p.verts.push_back(endPos.x);
-		p.verts.push_back(endPos.y);
-		p.verts.push_back(endPos.z);
 	}
 
+	segments.push_back({lastPos, lineStipple ? 1.0f : 0.0f, endPos, startColor, {color}});
+
 	lastPos = endPos;
 	lastColor = color;
 }
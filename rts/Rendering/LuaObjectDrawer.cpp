@@ -19,6 +19,7 @@
 #include "Sim/Features/Feature.h"
 #include "Sim/Units/Unit.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/Config/ConfigVar.h"
 #include "System/EventHandler.h"
 #include "System/SafeUtil.h"
 
@@ -283,9 +284,11 @@ void LuaObjectDrawer::Update(bool init)
 	if ((drawDeferredEnabled = geomBuffer->Valid())) {
 		drawDeferredEnabled &= (geomBuffer->Update(init));
 
-		notifyEventFlags[LUAOBJ_UNIT   ] = !unitDrawer->DrawForward() || configHandler->GetBool("AllowDrawModelPostDeferredEvents");
+		static ConfigVar<bool> allowPostDeferredEvents("AllowDrawModelPostDeferredEvents");
+
+		notifyEventFlags[LUAOBJ_UNIT   ] = !unitDrawer->DrawForward() || allowPostDeferredEvents.Get();
 		bufferClearFlags[LUAOBJ_UNIT   ] =  unitDrawer->DrawDeferred();
-		notifyEventFlags[LUAOBJ_FEATURE] = !featureDrawer->DrawForward() || configHandler->GetBool("AllowDrawModelPostDeferredEvents");
+		notifyEventFlags[LUAOBJ_FEATURE] = !featureDrawer->DrawForward() || allowPostDeferredEvents.Get();
 		bufferClearFlags[LUAOBJ_FEATURE] =  featureDrawer->DrawDeferred();
 
 		// if both object types are going to be drawn deferred, only
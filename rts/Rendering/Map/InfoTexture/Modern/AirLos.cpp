@@ -87,7 +87,16 @@ CAirLosTexture::~CAirLosTexture()
 void CAirLosTexture::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (losHandler->GetGlobalLOS(gu->myAllyTeam)) {
+	const int allyTeam = GetViewedAllyTeam();
+	const bool globalLOS = GetViewedGlobalLOS(allyTeam);
+	const bool fullUpdate = ViewStateChanged(allyTeam, globalLOS);
+
+	updatedRect = {};
+
+	if (globalLOS) {
+		if (!fullUpdate)
+			return;
+
 		fbo.Bind();
 		glViewport(0, 0, texSize.x, texSize.y);
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -97,23 +106,37 @@ void CAirLosTexture::Update()
 
 		auto binding = texture.ScopedBind();
 		texture.ProduceMipmaps();
+
+		updatedRect = GetFullRect();
 		return;
 	}
 
-	const auto& myAirLos = losHandler->airLos.losMaps[gu->myAllyTeam].GetLosMap();
+	SRectangle rect;
+
+	const auto& myAirLos = (allyTeam == ALL_ALLY_TEAMS)?
+		losHandler->airLos.GetMergedLosMap(rect, fullUpdate):
+		GetAllyTeamLosMap(losHandler->airLos.losMaps[allyTeam], rect, fullUpdate);
+
+	if (rect.GetArea() == 0)
+		return;
+
 	{
 		auto binding = uploadTex.ScopedBind();
-		uploadTex.UploadImage(myAirLos.data());
+		UploadSubRect(uploadTex, myAirLos, rect);
 	}
 
 	// do post-processing on the gpu (los-checking & scaling)
-	using namespace GL::State;
-	auto state = GL::SubState(
-		Blending(GL_FALSE)
-	);
-	RunFullScreenPass();
+	{
+		using namespace GL::State;
+		auto state = GL::SubState(
+			Blending(GL_FALSE)
+		);
+		RunFullScreenPass(rect);
+	}
 
 	// generate mipmaps
 	auto binding = texture.ScopedBind();
 	texture.ProduceMipmaps();
+
+	updatedRect = rect;
 }
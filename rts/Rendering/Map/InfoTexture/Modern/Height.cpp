@@ -1,5 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+
 #include "Height.h"
 #include "Map/HeightLinePalette.h"
 #include "Map/ReadMap.h"
@@ -28,6 +30,7 @@ CHeightTexture::CHeightTexture()
 	eventHandler.AddClient(this);
 
 	texSize = int2(mapDims.mapxp1, mapDims.mapyp1);
+	updateRect = GetFullRect();
 
 	{
 		GL::TextureCreationParams tcp{
@@ -106,7 +109,10 @@ CHeightTexture::~CHeightTexture()
 void CHeightTexture::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	const SRectangle rect = (updateRect.GetArea() != 0) ? updateRect : GetFullRect();
+
 	needUpdate = false;
+	updateRect = {};
 
 	const auto hmTexID = readMap->GetHeightMapTexture();
 
@@ -119,13 +125,32 @@ void CHeightTexture::Update()
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, hmTexID);
 
-	RunFullScreenPass();
+	RunFullScreenPass(rect);
+
+	updatedRect = rect;
 }
 
 
 void CHeightTexture::UnsyncedHeightMapUpdate(const SRectangle& rect)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// rect is inclusive in heightmap corners, pad by one texel for the linear lookups
+	const SRectangle texRect = {
+		std::max(rect.x1 - 1, 0),
+		std::max(rect.z1 - 1, 0),
+		std::min(rect.x2 + 2, texSize.x),
+		std::min(rect.z2 + 2, texSize.y)
+	};
+
+	if (updateRect.GetArea() == 0) {
+		updateRect = texRect;
+	} else {
+		updateRect.x1 = std::min(updateRect.x1, texRect.x1);
+		updateRect.z1 = std::min(updateRect.z1, texRect.z1);
+		updateRect.x2 = std::max(updateRect.x2, texRect.x2);
+		updateRect.z2 = std::max(updateRect.z2, texRect.z2);
+	}
+
 	needUpdate = true;
 }
 
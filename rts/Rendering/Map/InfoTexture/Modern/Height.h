@@ -36,6 +36,8 @@ public:
 	bool IsUpdateNeeded() override;
 private:
 	bool needUpdate;
+	// union of the heightmap changes since the last update, in texels
+	SRectangle updateRect;
 	GL::Texture2D paletteTex;
 };
 
@@ -86,7 +86,17 @@ CLosTexture::~CLosTexture()
 void CLosTexture::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (losHandler->GetGlobalLOS(gu->myAllyTeam)) {
+	const int allyTeam = GetViewedAllyTeam();
+	const bool globalLOS = GetViewedGlobalLOS(allyTeam);
+	const bool fullUpdate = ViewStateChanged(allyTeam, globalLOS);
+
+	updatedRect = {};
+
+	if (globalLOS) {
+		// stays fully visible until the view state changes again
+		if (!fullUpdate)
+			return;
+
 		fbo.Bind();
 		glViewport(0, 0, texSize.x, texSize.y);
 		glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -96,17 +106,25 @@ void CLosTexture::Update()
 
 		auto binding = texture.ScopedBind();
 		texture.ProduceMipmaps();
+
+		updatedRect = GetFullRect();
 		return;
 	}
 
-	static std::vector<uint8_t> infoTexMem;
-	infoTexMem.resize(texSize.x * texSize.y);
+	// only squares that entered or left LOS since the last update need to be redrawn
+	SRectangle rect;
+
+	const auto& myLos = (allyTeam == ALL_ALLY_TEAMS)?
+		losHandler->los.GetMergedLosMap(rect, fullUpdate):
+		GetAllyTeamLosMap(losHandler->los.losMaps[allyTeam], rect, fullUpdate);
 
-	const auto& myLos = losHandler->los.losMaps[gu->myAllyTeam].GetLosMap();
 	assert(myLos.size() == texSize.x * texSize.y);
 
+	if (rect.GetArea() == 0)
+		return;
+
 	auto binding = uploadTex.ScopedBind();
-	uploadTex.UploadImage(myLos.data());
+	UploadSubRect(uploadTex, myLos, rect);
 
 	// do post-processing on the gpu (los-checking & scaling)
 	{
@@ -114,10 +132,12 @@ void CLosTexture::Update()
 		auto state = GL::SubState(
 			Blending(GL_FALSE)
 		);
-		RunFullScreenPass();
+		RunFullScreenPass(rect);
 	}
 
 	// generate mipmaps
 	texture.ScopedBind(binding);
 	texture.ProduceMipmaps();
+
+	updatedRect = rect;
 }
@@ -1,8 +1,14 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+
 #include "ModernInfoTexture.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/SubState.h"
+#include "Game/GlobalUnsynced.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/TeamHandler.h"
 
 
 CModernInfoTexture::CModernInfoTexture(const std::string& _name)
@@ -33,4 +39,80 @@ void CModernInfoTexture::RunFullScreenPass()
 	shader->Disable();
 	FBO::Unbind();
 	globalRendering->LoadViewport();
-}
\ No newline at end of file
+}
+
+void CModernInfoTexture::RunFullScreenPass(const SRectangle& rect)
+{
+	using namespace GL::State;
+	auto state = GL::SubState(
+		ScissorTest(GL_TRUE),
+		Scissor(rect.x1, rect.z1, rect.GetWidth(), rect.GetHeight())
+	);
+	RunFullScreenPass();
+}
+
+void CModernInfoTexture::UploadSubRect(const GL::Texture2D& tex, const std::vector<unsigned short>& data, const SRectangle& rect)
+{
+	const int sizeX = rect.GetWidth();
+	const int sizeZ = rect.GetHeight();
+
+	pbo.Bind();
+	pbo.New(sizeX * sizeZ * sizeof(unsigned short));
+
+	auto* buf = reinterpret_cast<unsigned short*>(pbo.MapBuffer(0, pbo.GetSize(), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | pbo.mapUnsyncedBit));
+
+	if (buf != nullptr) {
+		for (int z = 0; z < sizeZ; z++) {
+			const auto* src = data.data() + rect.x1 + (z + rect.z1) * texSize.x;
+			      auto* dst = buf +                   (z          ) * sizeX;
+
+			std::copy(src, src + sizeX, dst);
+		}
+	}
+
+	pbo.UnmapBuffer();
+
+	tex.UploadSubImage(pbo.GetPtr(), rect.x1, rect.z1, sizeX, sizeZ);
+
+	pbo.Invalidate();
+	pbo.Unbind();
+}
+
+bool CModernInfoTexture::ViewStateChanged(int allyTeam, bool globalLOS)
+{
+	const bool changed = (allyTeam != viewAllyTeam || globalLOS != viewGlobalLOS);
+
+	viewAllyTeam = allyTeam;
+	viewGlobalLOS = globalLOS;
+
+	return changed;
+}
+
+int CModernInfoTexture::GetViewedAllyTeam()
+{
+	if (gu->spectating && gu->spectatingFullView && gu->spectatingAllAllyTeams)
+		return ALL_ALLY_TEAMS;
+
+	return gu->myAllyTeam;
+}
+
+const std::vector<unsigned short>& CModernInfoTexture::GetAllyTeamLosMap(CLosMap& losMap, SRectangle& rect, bool fullUpdate) const
+{
+	rect = fullUpdate ? GetFullRect() : losMap.GetChangedRect();
+	losMap.ClearChangedRect();
+
+	return losMap.GetLosMap();
+}
+
+bool CModernInfoTexture::GetViewedGlobalLOS(int allyTeam)
+{
+	if (allyTeam != ALL_ALLY_TEAMS)
+		return losHandler->GetGlobalLOS(allyTeam);
+
+	for (int a = 0; a < teamHandler.ActiveAllyTeams(); a++) {
+		if (losHandler->GetGlobalLOS(a))
+			return true;
+	}
+
+	return false;
+}
@@ -7,11 +7,14 @@
 #include "Rendering/GL/PBO.h"
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/VAO.h"
+#include "System/Rectangle.h"
 
 namespace Shader {
 	struct IProgramObject;
 }
 
+class CLosMap;
+
 class CModernInfoTexture : public CInfoTexture
 {
 public:
@@ -21,13 +24,43 @@ public:
 public:
 	virtual void Update() = 0;
 	virtual bool IsUpdateNeeded() = 0;
+
+	/// texels redrawn by the last Update, for textures that are derived from this one
+	const SRectangle& GetUpdatedRect() const { return updatedRect; }
 protected:
 	bool CreateFBO(const char* fboName);
 	void RunFullScreenPass();
+	/// same as RunFullScreenPass, but only overwrites the texels inside <rect>
+	void RunFullScreenPass(const SRectangle& rect);
+
+	/// uploads the <rect> part of <data> (texSize.x values per row) through the PBO, <tex> must be bound
+	void UploadSubRect(const GL::Texture2D& tex, const std::vector<unsigned short>& data, const SRectangle& rect);
+
+	/// true on the first call and whenever the viewed allyteam or its global-LOS state changed since the last call
+	bool ViewStateChanged(int allyTeam, bool globalLOS);
+
+	/// allyteam whose maps are shown, ALL_ALLY_TEAMS when a full-view spectator looks at the merged maps
+	static int GetViewedAllyTeam();
+	/// global-LOS state of <allyTeam>, of any allyteam for ALL_ALLY_TEAMS
+	static bool GetViewedGlobalLOS(int allyTeam);
+
+	/// the counters of a single allyteam's <losMap>, with the bounds of the squares changed since the last call in <rect>
+	const std::vector<unsigned short>& GetAllyTeamLosMap(CLosMap& losMap, SRectangle& rect, bool fullUpdate) const;
+
+	SRectangle GetFullRect() const { return {0, 0, texSize.x, texSize.y}; }
 protected:
 	FBO fbo;
 	VAO vao;
+	PBO pbo;
+
+	SRectangle updatedRect;
+
+	int viewAllyTeam = -1;
+	bool viewGlobalLOS = false;
+
 	Shader::IProgramObject* shader = nullptr;
 protected:
 	static constexpr const char* vertexCode = "GLSL/FullscreenTriangleVS.glsl";
+	// distinct from the initial viewAllyTeam so the first merged view is a full update
+	static constexpr int ALL_ALLY_TEAMS = -2;
 };
\ No newline at end of file
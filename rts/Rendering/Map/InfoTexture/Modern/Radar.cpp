@@ -1,5 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+
 #include "Radar.h"
 #include "InfoTextureHandler.h"
 #include "Game/GlobalUnsynced.h"
@@ -15,6 +17,23 @@
 #include "System/Misc/TracyDefs.h"
 
 
+static void AddRect(SRectangle& dst, const SRectangle& src)
+{
+	if (src.GetArea() == 0)
+		return;
+
+	if (dst.GetArea() == 0) {
+		dst = src;
+		return;
+	}
+
+	dst.x1 = std::min(dst.x1, src.x1);
+	dst.z1 = std::min(dst.z1, src.z1);
+	dst.x2 = std::max(dst.x2, src.x2);
+	dst.z2 = std::max(dst.z2, src.z2);
+}
+
+
 
 CRadarTexture::CRadarTexture()
 : CModernInfoTexture("radar")
@@ -101,7 +120,16 @@ CRadarTexture::~CRadarTexture()
 void CRadarTexture::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	if (losHandler->GetGlobalLOS(gu->myAllyTeam)) {
+	const int allyTeam = GetViewedAllyTeam();
+	const bool globalLOS = GetViewedGlobalLOS(allyTeam);
+	const bool fullUpdate = ViewStateChanged(allyTeam, globalLOS);
+
+	updatedRect = {};
+
+	if (globalLOS) {
+		if (!fullUpdate)
+			return;
+
 		fbo.Bind();
 		glViewport(0, 0, texSize.x, texSize.y);
 		glClearColor(1.0f, 0.0f, 0.0f, 0.0f);
@@ -111,19 +139,53 @@ void CRadarTexture::Update()
 
 		auto binding = texture.ScopedBind();
 		texture.ProduceMipmaps();
+
+		updatedRect = GetFullRect();
 		return;
 	}
 
-	const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
+	auto* losTex = static_cast<CModernInfoTexture*>(infoTextureHandler->GetInfoTexture("los"));
+
+	SRectangle rect;
+	SRectangle jammerRect;
+
+	// without separate jammers everyone shares the first allyteam's map, merging would only repeat it
+	const int jammerAllyTeam = modInfo.separateJammers ? allyTeam : 0;
+
+	const auto& myRadar = (allyTeam == ALL_ALLY_TEAMS)?
+		losHandler->radar.GetMergedLosMap(rect, fullUpdate):
+		GetAllyTeamLosMap(losHandler->radar.losMaps[allyTeam], rect, fullUpdate);
+	const auto& myJammer = (jammerAllyTeam == ALL_ALLY_TEAMS)?
+		losHandler->jammer.GetMergedLosMap(jammerRect, fullUpdate):
+		GetAllyTeamLosMap(losHandler->jammer.losMaps[jammerAllyTeam], jammerRect, fullUpdate);
+
+	AddRect(rect, jammerRect);
+
+	// jammed squares are masked by los, map the los texels redrawn by their
+	// last update to ours and pad by one for the bilinear los lookups
+	if (const SRectangle& losRect = losTex->GetUpdatedRect(); losRect.GetArea() != 0) {
+		const int2 losSize = losTex->GetTexSize();
+
+		SRectangle r;
+		r.x1 = std::max((losRect.x1 * texSize.x) / losSize.x - 1, 0);
+		r.z1 = std::max((losRect.z1 * texSize.y) / losSize.y - 1, 0);
+		r.x2 = std::min((losRect.x2 * texSize.x + losSize.x - 1) / losSize.x + 1, texSize.x);
+		r.z2 = std::min((losRect.z2 * texSize.y + losSize.y - 1) / losSize.y + 1, texSize.y);
+
+		AddRect(rect, r);
+	}
+
+	if (fullUpdate)
+		rect = GetFullRect();
 
-	const auto& myRadar  = losHandler->radar.losMaps[gu->myAllyTeam].GetLosMap();
-	const auto& myJammer = losHandler->jammer.losMaps[jammerAllyTeam].GetLosMap();
+	if (rect.GetArea() == 0)
+		return;
 
 	auto binding1 = uploadTexRadar.ScopedBind(1);
-	uploadTexRadar.UploadImage(myRadar.data());
+	UploadSubRect(uploadTexRadar, myRadar, rect);
 
 	auto binding0 = uploadTexJammer.ScopedBind(0);
-	uploadTexJammer.UploadImage(myJammer.data());
+	UploadSubRect(uploadTexJammer, myJammer, rect);
 
 	// do post-processing on the gpu (los-checking & scaling)
 	using namespace GL::State;
@@ -131,8 +193,8 @@ void CRadarTexture::Update()
 		Blending(GL_FALSE)
 	);
 	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, infoTextureHandler->GetInfoTexture("los")->GetTexture());
-	RunFullScreenPass();
+	glBindTexture(GL_TEXTURE_2D, losTex->GetTexture());
+	RunFullScreenPass(rect);
 
 	// cleanup
 	glBindTexture(GL_TEXTURE_2D, 0);
@@ -143,4 +205,6 @@ void CRadarTexture::Update()
 	glActiveTexture(GL_TEXTURE0);
 	auto binding = texture.ScopedBind();
 	texture.ProduceMipmaps();
+
+	updatedRect = rect;
 }
@@ -37,6 +37,7 @@ CR_REG_METADATA(LocalModelPiece, (
 	CR_IGNORED(original),
 
 	CR_MEMBER(dirty),
+	CR_MEMBER(modelSpaceMatStale),
 	CR_MEMBER(wasUpdated),
 	CR_MEMBER(noInterpolation),
 	CR_MEMBER(modelSpaceTra),
@@ -52,7 +53,9 @@ CR_REG_METADATA(LocalModel, (
 
 	CR_MEMBER(boundingVolume),
 	CR_IGNORED(luaMaterialData),
-	CR_MEMBER(needsBoundariesRecalc)
+	CR_MEMBER(needsBoundariesRecalc),
+	CR_MEMBER(piecesDirty),
+	CR_MEMBER(piecesUpdated)
 ))
 
 static_assert(sizeof(SVertexData) == (3 + 3 + 3 + 3 + 4 + 2 + 1) * 4);
@@ -415,6 +418,37 @@ LocalModelPiece* LocalModel::CreateLocalModelPieces(const S3DModelPiece* mpParen
 }
 
 
+void LocalModel::UpdatePieceTransforms() const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!piecesDirty)
+		return;
+
+	// pieces are created depth-first s.t. parents precede their children and
+	// a single in-order pass suffices; SetDirty marks whole subtrees, so clean
+	// pieces can be skipped without looking at their children. Pieces moved to
+	// a later parent by SetUnitPieceParent still work, the parent is updated
+	// first by UpdateParentMatricesRec
+	for (const LocalModelPiece& lmp: pieces) {
+		if (!lmp.IsDirty())
+			continue;
+
+		lmp.UpdateParentMatricesRec();
+	}
+
+	piecesDirty = false;
+}
+
+void LocalModel::UpdatePieceMatrices() const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	UpdatePieceTransforms();
+
+	for (const LocalModelPiece& lmp: pieces) {
+		lmp.GetModelSpaceMatrix();
+	}
+}
+
 void LocalModel::UpdateBoundingVolume()
 {
 	ZoneScoped;
@@ -495,6 +529,9 @@ void LocalModelPiece::SetDirty() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	dirty = true;
 
+	if (localModel != nullptr)
+		localModel->SetPiecesDirty();
+
 	for (LocalModelPiece* child: children) {
 		if (child->dirty)
 			continue;
@@ -544,13 +581,27 @@ const CMatrix44f& LocalModelPiece::GetModelSpaceMatrix() const
 	if (dirty)
 		UpdateParentMatricesRec();
 
+	// most consumers (e.g. the transform uploads) only want modelSpaceTra
+	if (modelSpaceMatStale) {
+		modelSpaceMat = modelSpaceTra.ToMatrix();
+		modelSpaceMatStale = false;
+	}
+
 	return modelSpaceMat;
 }
 
 void LocalModelPiece::SetScriptVisible(bool b)
 {
 	scriptSetVisible = b;
+	MarkUpdated();
+}
+
+void LocalModelPiece::MarkUpdated() const
+{
 	wasUpdated[0] = true; //update for current frame
+
+	if (localModel != nullptr)
+		localModel->MarkPiecesUpdated();
 }
 
 void LocalModelPiece::SavePrevModelSpaceTransform()
@@ -577,7 +628,7 @@ void LocalModelPiece::UpdateChildTransformRec(bool updateChildTransform) const
 
 	if (dirty) {
 		dirty = false;
-		wasUpdated[0] = true;  //update for current frame
+		MarkUpdated();
 		updateChildTransform = true;
 
 		pieceSpaceTra = CalcPieceSpaceTransform(pos, rot, original->scale);
@@ -589,7 +640,7 @@ void LocalModelPiece::UpdateChildTransformRec(bool updateChildTransform) const
 		else
 			modelSpaceTra = pieceSpaceTra;
 
-		modelSpaceMat = modelSpaceTra.ToMatrix();
+		modelSpaceMatStale = true;
 	}
 
 	for (auto& child : children) {
@@ -604,7 +655,7 @@ void LocalModelPiece::UpdateParentMatricesRec() const
 		parent->UpdateParentMatricesRec();
 
 	dirty = false;
-	wasUpdated[0] = true;  //update for current frame
+	MarkUpdated();
 
 	pieceSpaceTra = CalcPieceSpaceTransform(pos, rot, original->scale);
 
@@ -613,7 +664,7 @@ void LocalModelPiece::UpdateParentMatricesRec() const
 	else
 		modelSpaceTra = pieceSpaceTra;
 
-	modelSpaceMat = modelSpaceTra.ToMatrix();
+	modelSpaceMatStale = true;
 }
 
 
@@ -422,6 +422,7 @@ struct LocalModelPiece
 
 	LocalModelPiece()
 		: dirty(true)
+		, modelSpaceMatStale(true)
 		, wasUpdated{ true }
 		, noInterpolation { false }
 	{}
@@ -445,6 +446,7 @@ struct LocalModelPiece
 	// on-demand functions
 	void UpdateChildTransformRec(bool updateChildMatrices) const;
 	void UpdateParentMatricesRec() const;
+	void MarkUpdated() const;
 
 	auto CalcPieceSpaceTransformOrig(const float3& p, const float3& r, float s) const { return original->ComposeTransform(p, r, s); }
 	auto CalcPieceSpaceTransform(const float3& p, const float3& r, float s) const {
@@ -461,6 +463,7 @@ struct LocalModelPiece
 
 
 	void SetDirty();
+	bool IsDirty() const { return dirty; }
 	void SetPosOrRot(const float3& src, float3& dst); // anim-script only
 	void SetPosition(const float3& p) { SetPosOrRot(p, pos); } // anim-script only
 	void SetRotation(const float3& r) { SetPosOrRot(r, rot); } // anim-script only
@@ -512,13 +515,14 @@ private:
 
 	mutable Transform pieceSpaceTra;  // transform relative to parent LMP (SYNCED), combines <pos> and <rot>
 	mutable Transform modelSpaceTra;  // transform relative to root LMP (SYNCED), chained pieceSpaceMat's
-	mutable CMatrix44f modelSpaceMat; // same as above, except matrix
+	mutable CMatrix44f modelSpaceMat; // same as above, except matrix; converted on demand
 
 	CollisionVolume colvol;
 
 	mutable std::array<bool, 2> wasUpdated; // currFrame, prevFrame
 	mutable std::array<bool, 3> noInterpolation; // rotate, move, scale
 	mutable bool dirty;
+	mutable bool modelSpaceMatStale; // modelSpaceTra changed since modelSpaceMat was derived
 	bool scriptSetVisible; // TODO: add (visibility) maxradius!
 public:
 	bool blockScriptAnims; // if true, Set{Position,Rotation} are ignored for this piece
@@ -602,6 +606,20 @@ struct LocalModel
 
 	void SetBoundariesNeedsRecalc()       { needsBoundariesRecalc = true; }
 	bool GetBoundariesNeedsRecalc() const { return needsBoundariesRecalc; }
+
+	/// brings all dirty pieces up to date in one pass over <pieces>, clean subtrees are skipped
+	void UpdatePieceTransforms() const;
+	/// as above and also derives any stale model-space matrix, after which the pieces
+	/// can be hit-tested from several threads at once (nothing is computed lazily)
+	void UpdatePieceMatrices() const;
+
+	void SetPiecesDirty() const { piecesDirty = true; }
+	void MarkPiecesUpdated() const { piecesUpdated[0] = true; }
+
+	/// mirrors LocalModelPiece::{Get,Reset}WasUpdated for the whole model: false
+	/// means no piece needs to be uploaded and the per-piece checks can be skipped
+	bool GetPiecesUpdated() const { return piecesUpdated[0] || piecesUpdated[1]; }
+	void ResetPiecesUpdated() const { piecesUpdated[1] = std::exchange(piecesUpdated[0], false); }
 private:
 	LocalModelPiece* CreateLocalModelPieces(const S3DModelPiece* mpParent);
 
@@ -619,6 +637,10 @@ private:
 	LuaObjectMaterialData luaMaterialData;
 
 	bool needsBoundariesRecalc = true;
+
+	// any piece dirty, resp. any piece's wasUpdated set (currFrame, prevFrame)
+	mutable bool piecesDirty = true;
+	mutable std::array<bool, 2> piecesUpdated = {true, true};
 };
 
 #endif /* _3DMODEL_H */
@@ -3,10 +3,12 @@
 #include "3DModelVAO.h"
 
 #include <algorithm>
+#include <bit>
 #include <iterator>
 
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Models/IModelParser.h"
+#include "Rendering/Models/ModelGPUCuller.h"
 #include "Rendering/ModelsDataUploader.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
@@ -61,6 +63,8 @@ S3DModelVAO::S3DModelVAO()
 	indxVBO = VBO{ GL_ELEMENT_ARRAY_BUFFER, false };
 	instVBO = VBO{ GL_ARRAY_BUFFER        , false };
 
+	staticTraSSBO = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+
 	//no better place to init it
 	instVBO.Bind();
 	instVBO.New(S3DModelVAO::INSTANCE_BUFFER_NUM_ELEMS * sizeof(SInstanceData), GL_STREAM_DRAW);
@@ -78,7 +82,7 @@ void S3DModelVAO::ProcessVertices(const S3DModel* model)
 	if (const auto* root = model->GetRootPiece(); root->vertIndex != ~0u)
 		return;
 
-	uint32_t vertIndex = static_cast<uint32_t>(vertData.size());
+	uint32_t vertIndex = static_cast<uint32_t>(vertDataBase + vertData.size());
 	for (auto* modelPiece : model->pieceObjects) {
 		modelPiece->vertIndex = vertIndex;
 		const auto& modelPieceVerts = modelPiece->GetVerticesVec();
@@ -95,11 +99,11 @@ void S3DModelVAO::ProcessIndicies(S3DModel* model)
 		return;
 
 	//models should know their index offset
-	model->indxStart = static_cast<uint32_t>(std::distance(indxData.cbegin(), indxData.cend()));
+	model->indxStart = static_cast<uint32_t>(indxDataBase + indxData.size());
 
 	for (auto* modelPiece : model->pieceObjects) {
 		if (!modelPiece->HasGeometryData()) {
-			modelPiece->indxStart = static_cast<uint32_t>(indxData.size());
+			modelPiece->indxStart = static_cast<uint32_t>(indxDataBase + indxData.size());
 			modelPiece->indxCount = 0;
 			continue;
 		}
@@ -113,13 +117,13 @@ void S3DModelVAO::ProcessIndicies(S3DModel* model)
 		std::for_each(begIdx, endIdx, [offset = modelPiece->vertIndex](uint32_t& indx) { indx += offset; }); // add per piece vertex offset to indices
 
 		//model pieces should know their index offset
-		modelPiece->indxStart = static_cast<uint32_t>(std::distance(indxData.begin(), begIdx));
+		modelPiece->indxStart = static_cast<uint32_t>(indxDataBase + std::distance(indxData.begin(), begIdx));
 
 		//model pieces should know their index count
 		modelPiece->indxCount = static_cast<uint32_t>(modelPieceIndcs.size());
 	}
 	//models should know their index count
-	model->indxCount = static_cast<uint32_t>(indxData.size() - model->indxStart);
+	model->indxCount = static_cast<uint32_t>(indxDataBase + indxData.size() - model->indxStart);
 
 	//add shatter indices to the end of indxData
 	for (const auto* modelPiece : model->pieceObjects) {
@@ -165,27 +169,25 @@ void S3DModelVAO::UploadVBOs()
 	bool reinitVAO = (vao.GetIdRaw() == 0);
 
 	if (vertData.size() > vertUploadIndex) {
-		assert(!safeToDeleteVectors);
 		vertVBO.Bind();
-		const size_t reqSize = AlignUp(std::max(vertData.size(), S3DModelVAO::VERT_SIZE0) * sizeof(SVertexData), MEM_STEP);
+		const size_t reqSize = AlignUp(std::max(vertDataBase + vertData.size(), S3DModelVAO::VERT_SIZE0) * sizeof(SVertexData), MEM_STEP);
 		reinitVAO |= (reqSize > vertVBO.GetSize());
 		vertVBO.Resize(reqSize, GL_STATIC_DRAW); //noop if size hasn't changed, will copy data if changed
-		vertVBO.SetBufferSubData(vertUploadIndex * sizeof(SVertexData), (vertData.size() - vertUploadIndex) * sizeof(SVertexData), vertData.data() + vertUploadIndex);
+		vertVBO.SetBufferSubData((vertDataBase + vertUploadIndex) * sizeof(SVertexData), (vertData.size() - vertUploadIndex) * sizeof(SVertexData), vertData.data() + vertUploadIndex);
 		vertVBO.Unbind();
 		vertUploadIndex = vertData.size();
-		vertUploadSize = vertUploadIndex;
+		vertUploadSize = vertDataBase + vertUploadIndex;
 	}
 
 	if (indxData.size() > indxUploadIndex) {
-		assert(!safeToDeleteVectors);
 		indxVBO.Bind();
-		const size_t reqSize = AlignUp(std::max(indxData.size(), S3DModelVAO::INDX_SIZE0) * sizeof(   uint32_t), MEM_STEP);
+		const size_t reqSize = AlignUp(std::max(indxDataBase + indxData.size(), S3DModelVAO::INDX_SIZE0) * sizeof(   uint32_t), MEM_STEP);
 		reinitVAO |= (reqSize > indxVBO.GetSize());
 		indxVBO.Resize(reqSize, GL_STATIC_DRAW); //noop if size hasn't changed, will copy data if changed
-		indxVBO.SetBufferSubData(indxUploadIndex * sizeof(   uint32_t), (indxData.size() - indxUploadIndex) * sizeof(   uint32_t), indxData.data() + indxUploadIndex);
+		indxVBO.SetBufferSubData((indxDataBase + indxUploadIndex) * sizeof(   uint32_t), (indxData.size() - indxUploadIndex) * sizeof(   uint32_t), indxData.data() + indxUploadIndex);
 		indxVBO.Unbind();
 		indxUploadIndex = indxData.size();
-		indxUploadSize = indxUploadIndex;
+		indxUploadSize = indxDataBase + indxUploadIndex;
 	}
 
 	if (reinitVAO)
@@ -193,7 +195,10 @@ void S3DModelVAO::UploadVBOs()
 
 	if (safeToDeleteVectors && !vertData.empty()) {
 		// all models have been uploaded in the calls above
-		// safe to clear CPU copy of the data
+		// safe to clear CPU copy of the data, models
+		// loaded later are appended behind it
+		vertDataBase += vertData.size();
+		indxDataBase += indxData.size();
 		vertData.clear();
 		indxData.clear();
 		vertUploadIndex = 0;
@@ -364,6 +369,23 @@ bool S3DModelVAO::AddToSubmission(const UnitDef* unitDef, uint8_t teamID)
 }
 
 
+bool S3DModelVAO::AddToSubmission(const S3DModel* model, uint8_t teamID, uint8_t drawFlags, const Transform& worldTra)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(model);
+
+	if (!AddToSubmissionImpl(model, model->indxStart, model->indxCount, teamID, drawFlags))
+		return false;
+
+	// static models don't skin, bposeMatOffset is free to point at the placement instead
+	auto& modelInstanceData = modelDataToInstance[SIndexAndCount{ model->indxStart, model->indxCount }];
+	modelInstanceData.back().bposeMatOffset = static_cast<uint32_t>(staticTransforms.size());
+
+	staticTransforms.emplace_back(worldTra);
+
+	return true;
+}
+
 void S3DModelVAO::Submit(GLenum mode, bool bindUnbind)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -376,39 +398,71 @@ void S3DModelVAO::Submit(GLenum mode, bool bindUnbind)
 	allRenderModelData.reserve(INSTANCE_BUFFER_NUM_BATCHED);
 	allRenderModelData.clear();
 
+	// command index of each instance, only needed when culling on the GPU
+	static std::vector<uint32_t> allRenderModelCmds;
+	allRenderModelCmds.clear();
+
+	const bool gpuCulling = ModelGPUCuller::IsValid();
+
 	for (const auto& [indxCount, renderModelData] : modelDataToInstance) {
 		if (allRenderModelData.size() + renderModelData.size() >= INSTANCE_BUFFER_NUM_BATCHED)
 			continue;
 
+		// the culling pass counts the visible instances in
 		SDrawElementsIndirectCommand scmd{
 			indxCount.count,
-			static_cast<uint32_t>(renderModelData.size()),
+			gpuCulling ? 0u : static_cast<uint32_t>(renderModelData.size()),
 			indxCount.index,
 			0u,
 			batchedBaseInstance
 		};
 
+		if (gpuCulling)
+			allRenderModelCmds.insert(allRenderModelCmds.end(), renderModelData.size(), static_cast<uint32_t>(submitCmds.size()));
+
 		submitCmds.emplace_back(scmd);
 
 		allRenderModelData.insert(allRenderModelData.end(), renderModelData.cbegin(), renderModelData.cend());
 		batchedBaseInstance += renderModelData.size();
 	}
 
-	if (submitCmds.empty())
+	if (submitCmds.empty()) {
+		staticTransforms.clear();
 		return;
+	}
 
-	instVBO.Bind();
-	instVBO.SetBufferSubData(allRenderModelData);
-	instVBO.Unbind();
+	const size_t staticTraSize = staticTransforms.size() * sizeof(Transform);
+
+	if (staticTraSize > 0) {
+		staticTraSSBO.Bind();
+		if (staticTraSSBO.GetSize() < staticTraSize)
+			staticTraSSBO.New(std::bit_ceil(staticTraSize), GL_STREAM_DRAW);
+
+		staticTraSSBO.SetBufferSubData(staticTransforms);
+		staticTraSSBO.Unbind();
+		staticTraSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, STATIC_TRANSFORMS_SSBO_BINDING_IDX, 0, staticTraSize);
+	}
 
 	if (bindUnbind)
 		Bind();
 
-	glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, submitCmds.data(), submitCmds.size(), sizeof(SDrawElementsIndirectCommand));
+	if (gpuCulling) {
+		ModelGPUCuller::GetInstance().Submit(mode, allRenderModelData, allRenderModelCmds, submitCmds, instVBO);
+	} else {
+		instVBO.Bind();
+		instVBO.SetBufferSubData(allRenderModelData);
+		instVBO.Unbind();
+
+		glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, submitCmds.data(), submitCmds.size(), sizeof(SDrawElementsIndirectCommand));
+	}
 
 	if (bindUnbind)
 		Unbind();
 
+	if (staticTraSize > 0)
+		staticTraSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, STATIC_TRANSFORMS_SSBO_BINDING_IDX, 0, staticTraSize);
+
+	staticTransforms.clear();
 	modelDataToInstance.clear();
 }
 
@@ -45,10 +45,11 @@ public:
 	static constexpr size_t INSTANCE_BUFFER_NUM_BATCHED = 2 << 15;
 	static constexpr size_t INSTANCE_BUFFER_NUM_IMMEDIATE = 2 << 10;
 	static constexpr size_t INSTANCE_BUFFER_NUM_ELEMS = INSTANCE_BUFFER_NUM_BATCHED + INSTANCE_BUFFER_NUM_IMMEDIATE;
+	static constexpr uint32_t STATIC_TRANSFORMS_SSBO_BINDING_IDX = 2;
 public:
 	explicit S3DModelVAO();
 
-	uint32_t GetVertOffset() const { return static_cast<uint32_t>(vertData.size()); }
+	uint32_t GetVertOffset() const { return static_cast<uint32_t>(vertDataBase + vertData.size()); }
 
 	void ProcessVertices(const S3DModel* model);
 	void ProcessIndicies(S3DModel* model);
@@ -71,6 +72,11 @@ public:
 	bool AddToSubmission(const CFeature* feature);
 
 	bool AddToSubmission(const UnitDef* unitDef, uint8_t teamID);
+
+	// statically posed model placed at <worldTra>, must be drawn with ARRAY_MATMODE and
+	// not be mixed with the other kinds of submissions within the same Submit() call
+	bool AddToSubmission(const S3DModel* model, uint8_t teamID, uint8_t drawFlags, const Transform& worldTra);
+
 	void Submit(GLenum mode = GL_TRIANGLES, bool bindUnbind = false);
 
 	bool SubmitImmediately(const S3DModel* model, uint8_t teamID, uint8_t drawFlags, GLenum mode = GL_TRIANGLES, bool bindUnbind = false);
@@ -118,6 +124,10 @@ private:
 	size_t indxUploadIndex = 0;
 	size_t vertUploadSize = 0;
 	size_t indxUploadSize = 0;
+	// number of elements already uploaded and released from the CPU copies
+	// below, s.t. models loaded after preloading still get correct offsets
+	size_t vertDataBase = 0;
+	size_t indxDataBase = 0;
 
 	std::vector<SVertexData> vertData;
 	std::vector<uint32_t   > indxData;
@@ -128,5 +138,9 @@ private:
 	VBO instVBO;
 	VAO vao;
 
+	// world placements of the ARRAY_MATMODE submissions, indexed by their bposeMatOffset
+	VBO staticTraSSBO;
+	std::vector<Transform> staticTransforms;
+
 	std::unordered_map<SIndexAndCount, std::vector<SInstanceData>, SIndexAndCount> modelDataToInstance;
 };
\ No newline at end of file
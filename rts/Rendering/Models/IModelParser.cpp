@@ -226,16 +226,24 @@ void CModelLoader::PreloadModel(const std::string& modelName)
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(Threading::IsMainThread() || Threading::IsGameLoadThread());
 
+	{
+		// cheap compared to spawning a task, and keeps mid-game preloads
+		// (e.g. of the build options of every created unit) from piling
+		// up futures; a racing worker in FillModel holds the same lock
+		auto lock = CModelsLock::GetScopedLock();
+
+		if (GetCachedModel(StringToLower(modelName))->loadStatus != S3DModel::LoadStatus::NOTLOADED)
+			return;
+	}
+
 	//NB: do preload in any case
 	if (ThreadPool::HasThreads()) {
+		// collect the finished ones, nothing waits on them after loading
+		std::erase_if(preloadFutures, [](const auto& f) { return (f.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready); });
+
 
-		// if already in cache, thread just returns early
-		// not spawning the thread at all would be better but still
-		// requires locking around cache.find(...) since some other
-		// preload worker might be down in FillModel modifying it
-		// at the same time
 		preloadFutures.emplace_back(
-			ThreadPool::Enqueue([modelName]() {
+			ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::High, [modelName]() {
 				modelLoader.LoadModel(modelName, true);
 			})
 		);
@@ -379,13 +387,11 @@ void CModelLoader::DrainPreloadFutures(uint32_t numAllowed)
 	// collect completed futures
 	std::erase_if(preloadFutures, erasePredicate);
 
-	if (preloadFutures.size() <= numAllowed)
-		return;
-
 	while (preloadFutures.size() > numAllowed) {
 		//drain queue until there are <= numAllowed items there
+		//without polling, the oldest task is likely the first to finish
+		preloadFutures.front().wait();
 		std::erase_if(preloadFutures, erasePredicate);
-		spring_sleep(spring_msecs(100));
 	}
 }
 
@@ -465,14 +471,59 @@ void CModelLoader::Upload(S3DModel* model) const {
 	{
 		auto lock = CLoadLock::GetUniqueLock(); //mostly needed to support calls from CFeatureHandler::LoadFeaturesFromMap()
 		S3DModelVAO::GetInstance().UploadVBOs();
+		LoadTextures(model);
+	}
+
+	FinishUpload(model);
+}
+
+void CModelLoader::UploadModels()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(Threading::IsMainThread() || Threading::IsGameLoadThread());
+
+	std::vector<S3DModel*> pendingModels;
+
+	{
+		auto lock = CModelsLock::GetScopedLock();
+
+		// models[0] is the dummy
+		for (uint32_t i = 1; i <= modelID; i++) {
+			S3DModel& model = models[i];
+
+			if (model.loadStatus == S3DModel::LoadStatus::LOADED && !model.uploaded)
+				pendingModels.push_back(&model);
+		}
+	}
+
+	{
+		// one buffer upload for all of them, instead of
+		// one per model on its first use during the game
+		auto lock = CLoadLock::GetUniqueLock();
+		S3DModelVAO::GetInstance().UploadVBOs();
 
-		// 3DO atlases are preloaded C3DOTextureHandler::Init()
-		if (model->type != MODELTYPE_3DO) {
-			// make sure textures (already preloaded) are fully loaded
-			textureHandlerS3O.LoadTexture(model);
+		for (S3DModel* model: pendingModels) {
+			LoadTextures(model);
 		}
 	}
 
+	for (S3DModel* model: pendingModels) {
+		FinishUpload(model);
+	}
+}
+
+void CModelLoader::LoadTextures(S3DModel* model) const
+{
+	// 3DO atlases are preloaded C3DOTextureHandler::Init()
+	if (model->type == MODELTYPE_3DO)
+		return;
+
+	// make sure textures (already preloaded) are fully loaded
+	textureHandlerS3O.LoadTexture(model);
+}
+
+void CModelLoader::FinishUpload(S3DModel* model) const
+{
 	for (auto* p : model->pieceObjects) {
 		p->ReleaseShatterIndices();
 	}
@@ -36,6 +36,8 @@ public:
 	void LogErrors();
 
 	void DrainPreloadFutures(uint32_t numAllowed = 0);
+	/// uploads all loaded models at once, called after preloading
+	void UploadModels();
 
 	const std::vector<S3DModel>& GetModelsVec() const { return models; }
 	      std::vector<S3DModel>& GetModelsVec()       { return models; }
@@ -52,6 +54,8 @@ private:
 
 	void PostProcessGeometry(S3DModel* o);
 	void Upload(S3DModel* o) const;
+	void LoadTextures(S3DModel* o) const;
+	void FinishUpload(S3DModel* o) const;
 
 private:
 	std::vector<std::pair<std::string, uint32_t>> cache; // "<fullpath>/armflash.3do" --> idx at models
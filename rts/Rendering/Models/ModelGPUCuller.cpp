@@ -0,0 +1,286 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ModelGPUCuller.h"
+
+#include <algorithm>
+#include <bit>
+
+#include "Game/Camera.h"
+#include "Game/CameraHandler.h"
+#include "Rendering/DepthBufferCopy.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/ModelsDataUploader.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+
+#include "System/Misc/TracyDefs.h"
+
+CONFIG(bool, ModelGPUCulling).defaultValue(false).headlessValue(false).description("Cull batched GL4 model draws on the GPU against the camera frustum and the terrain depth, requires compute shader support.");
+
+std::unique_ptr<ModelGPUCuller> ModelGPUCuller::instance = nullptr;
+
+static constexpr int CULL_GROUP_SIZE = 64;
+static constexpr int PYRAMID_GROUP_SIZE = 8;
+
+// model textures occupy the low units while the cull pass runs
+static constexpr int PYRAMID_TEX_UNIT = 15;
+
+// a power of two level 0 keeps every further level an exact 2x2 reduction
+static inline int GetPyramidDim(int viewDim) { return static_cast<int>(std::bit_floor(static_cast<uint32_t>(std::max(viewDim, 1)))); }
+
+
+void ModelGPUCuller::Init()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!configHandler->GetBool("ModelGPUCulling"))
+		return;
+
+	if (!IsSupported()) {
+		LOG_L(L_WARNING, "[ModelGPUCuller::%s] GPU culling of models requested, but not supported", __func__);
+		return;
+	}
+
+	instance = std::make_unique<ModelGPUCuller>();
+}
+
+void ModelGPUCuller::Kill()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	instance = nullptr;
+}
+
+bool ModelGPUCuller::IsSupported()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!globalRendering->haveGL4)
+		return false;
+
+	return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_image_load_store && GLAD_GL_ARB_texture_storage;
+}
+
+
+ModelGPUCuller::ModelGPUCuller()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	candidatesSSBO = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+	candCmdsSSBO   = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+	commandsSSBO   = VBO{ GL_SHADER_STORAGE_BUFFER, false };
+
+	sdbc = std::make_unique<ScopedDepthBufferCopy>(false);
+
+	CreateShaders();
+}
+
+ModelGPUCuller::~ModelGPUCuller()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	DeletePyramid();
+	shaderHandler->ReleaseProgramObjects("[ModelGPUCuller]");
+
+	sdbc = nullptr;
+}
+
+void ModelGPUCuller::CreateShaders()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	pyramidShader = shaderHandler->CreateProgramObject("[ModelGPUCuller]", "DepthPyramid");
+	pyramidShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ModelCullPyramidCompProg.glsl", "", GL_COMPUTE_SHADER));
+	pyramidShader->Link();
+
+	pyramidShader->Enable();
+	pyramidShader->SetUniform("srcTex", 0);
+	pyramidShader->Disable();
+	pyramidShader->Validate();
+
+	cullShader = shaderHandler->CreateProgramObject("[ModelGPUCuller]", "Cull");
+	cullShader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/ModelCullCompProg.glsl", "", GL_COMPUTE_SHADER));
+	cullShader->SetFlag("DEPTH_CLIP01", globalRendering->supportClipSpaceControl);
+	cullShader->Link();
+
+	cullShader->Enable();
+	cullShader->SetUniform("pyramidTex", PYRAMID_TEX_UNIT);
+	cullShader->Disable();
+	cullShader->Validate();
+}
+
+
+void ModelGPUCuller::CreatePyramid(int sizeX, int sizeY)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	DeletePyramid();
+
+	pyramidSizeX = sizeX;
+	pyramidSizeY = sizeY;
+	pyramidLevels = static_cast<int>(std::bit_width(static_cast<uint32_t>(std::max(pyramidSizeX, pyramidSizeY))));
+
+	glGenTextures(1, &pyramidTex);
+	glBindTexture(GL_TEXTURE_2D, pyramidTex);
+	glTexStorage2D(GL_TEXTURE_2D, pyramidLevels, GL_R32F, pyramidSizeX, pyramidSizeY);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void ModelGPUCuller::DeletePyramid()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (pyramidTex != 0)
+		glDeleteTextures(1, &pyramidTex);
+
+	pyramidTex = 0;
+	pyramidSizeX = 0;
+	pyramidSizeY = 0;
+	pyramidLevels = 0;
+	pyramidValid = false;
+}
+
+bool ModelGPUCuller::HavePyramid(const CCamera* cam) const
+{
+	// the terrain depth only occludes for the view it was rendered from
+	if (!pyramidValid)
+		return false;
+	if (pyramidDrawFrame != globalRendering->drawFrame)
+		return false;
+
+	return (cam->GetCamType() == CCamera::CAMTYPE_PLAYER);
+}
+
+void ModelGPUCuller::BuildDepthPyramid(const CCamera* cam)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	pyramidValid = false;
+
+	if (!depthBufferCopy->IsValid(false))
+		return;
+
+	const int viewSizeX = globalRendering->viewSizeX;
+	const int viewSizeY = globalRendering->viewSizeY;
+
+	if (pyramidTex == 0 || pyramidSizeX != GetPyramidDim(viewSizeX) || pyramidSizeY != GetPyramidDim(viewSizeY))
+		CreatePyramid(GetPyramidDim(viewSizeX), GetPyramidDim(viewSizeY));
+
+	pyramidShader->Enable();
+	glActiveTexture(GL_TEXTURE0);
+
+	int srcSizeX = viewSizeX;
+	int srcSizeY = viewSizeY;
+
+	for (int level = 0; level < pyramidLevels; ++level) {
+		const int dstSizeX = std::max(pyramidSizeX >> level, 1);
+		const int dstSizeY = std::max(pyramidSizeY >> level, 1);
+
+		// level 0 reduces the depth copy, the others the level above them
+		if (level == 0) {
+			glBindTexture(GL_TEXTURE_2D, depthBufferCopy->GetDepthBufferTexture(false));
+			pyramidShader->SetUniform("srcLevel", 0);
+		} else {
+			glBindTexture(GL_TEXTURE_2D, pyramidTex);
+			pyramidShader->SetUniform("srcLevel", level - 1);
+		}
+
+		pyramidShader->SetUniform("srcSize", srcSizeX, srcSizeY);
+		pyramidShader->SetUniform("dstSize", dstSizeX, dstSizeY);
+
+		glBindImageTexture(0, pyramidTex, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+		glDispatchCompute((dstSizeX + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, (dstSizeY + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, 1);
+		glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+		srcSizeX = dstSizeX;
+		srcSizeY = dstSizeY;
+	}
+
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	pyramidShader->Disable();
+
+	pyramidViewProj = cam->GetViewProjectionMatrix();
+	pyramidDrawFrame = globalRendering->drawFrame;
+	pyramidValid = true;
+}
+
+
+void ModelGPUCuller::Submit(
+	GLenum mode,
+	const std::vector<SInstanceData>& instances,
+	const std::vector<uint32_t>& instanceCmds,
+	const std::vector<SDrawElementsIndirectCommand>& cmds,
+	const VBO& instVBO
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(instances.size() == instanceCmds.size());
+
+	if (cmds.empty())
+		return;
+
+	const auto UploadSSBO = [](VBO& ssbo, const auto& data) {
+		using DataType = typename std::decay_t<decltype(data)>::value_type;
+		const size_t byteSize = data.size() * sizeof(DataType);
+
+		ssbo.Bind();
+		if (ssbo.GetSize() < byteSize)
+			ssbo.New(std::bit_ceil(byteSize), GL_STREAM_DRAW);
+
+		ssbo.SetBufferSubData(data);
+		ssbo.Unbind();
+	};
+
+	UploadSSBO(candidatesSSBO, instances);
+	UploadSSBO(candCmdsSSBO, instanceCmds);
+	UploadSSBO(commandsSSBO, cmds);
+
+	const CCamera* cam = CCameraHandler::GetActiveCamera();
+	const bool usePyramid = HavePyramid(cam);
+
+	// the model shader is bound by the caller, the cull pass runs in between
+	Shader::IProgramObject* modelShader = shaderHandler->GetCurrentlyBoundProgram();
+
+	if (modelShader != nullptr)
+		modelShader->DisableRaw();
+
+	candidatesSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, CANDIDATES_SSBO_BINDING_IDX, 0, instances.size() * sizeof(SInstanceData));
+	candCmdsSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, CANDCMDS_SSBO_BINDING_IDX, 0, instanceCmds.size() * sizeof(uint32_t));
+	commandsSSBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMANDS_SSBO_BINDING_IDX, 0, cmds.size() * sizeof(SDrawElementsIndirectCommand));
+	instVBO.BindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instVBO.GetSize());
+
+	cullShader->EnableRaw();
+	cullShader->SetUniform("numCandidates", static_cast<int>(instances.size()));
+	cullShader->SetUniform("numUniforms", static_cast<int>(modelUniformsUploader.GetElemsCount()));
+	cullShader->SetUniform4v("frustumPlanes", CCamera::FRUSTUM_PLANE_CNT, &cam->GetFrustum().planes[0].x);
+	cullShader->SetUniform("frustumPlanesMask", static_cast<int>(cam->GetInViewPlanesMask()));
+	cullShader->SetUniform("pyramidLevels", usePyramid ? pyramidLevels : 0);
+
+	if (usePyramid) {
+		cullShader->SetUniform("pyramidSize", static_cast<float>(pyramidSizeX), static_cast<float>(pyramidSizeY));
+		cullShader->SetUniformMatrix4x4("pyramidViewProj", false, &pyramidViewProj.m[0]);
+
+		glActiveTexture(GL_TEXTURE0 + PYRAMID_TEX_UNIT);
+		glBindTexture(GL_TEXTURE_2D, pyramidTex);
+	}
+
+	glDispatchCompute((static_cast<uint32_t>(instances.size()) + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+	if (usePyramid) {
+		glBindTexture(GL_TEXTURE_2D, 0);
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	cullShader->DisableRaw();
+
+	candidatesSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, CANDIDATES_SSBO_BINDING_IDX, 0, instances.size() * sizeof(SInstanceData));
+	candCmdsSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, CANDCMDS_SSBO_BINDING_IDX, 0, instanceCmds.size() * sizeof(uint32_t));
+	commandsSSBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, COMMANDS_SSBO_BINDING_IDX, 0, cmds.size() * sizeof(SDrawElementsIndirectCommand));
+	instVBO.UnbindBufferRange(GL_SHADER_STORAGE_BUFFER, INSTANCES_SSBO_BINDING_IDX, 0, instVBO.GetSize());
+
+	if (modelShader != nullptr)
+		modelShader->EnableRaw();
+
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+
+	commandsSSBO.Bind(GL_DRAW_INDIRECT_BUFFER);
+	glMultiDrawElementsIndirect(mode, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(cmds.size()), sizeof(SDrawElementsIndirectCommand));
+	commandsSSBO.Unbind();
+}
@@ -0,0 +1,84 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VBO.h"
+#include "System/Matrix44f.h"
+
+class CCamera;
+struct ScopedDepthBufferCopy;
+namespace Shader {
+	struct IProgramObject;
+}
+
+/**
+ * Second, GPU side culling stage of the batched GL4 model draws.
+ *
+ * The CPU keeps flagging objects per camera (Lua, icons and the alpha bins
+ * depend on those flags) and S3DModelVAO::Submit still gathers the flagged
+ * instances; instead of drawing all of them this pass tests every instance's
+ * bounding sphere from ModelUniformsStorage against the active camera's
+ * frustum and, for the player camera, against a Hi-Z pyramid of the terrain
+ * depth (DepthBufferCopy). Survivors are compacted into the instance buffer
+ * and counted into the indirect draw commands, so hidden models cost no
+ * vertex work and the CPU never reads the result back.
+ */
+class ModelGPUCuller {
+public:
+	static void Init();
+	static void Kill();
+	static ModelGPUCuller& GetInstance() { assert(IsValid()); return *instance; }
+	static bool IsValid() { return instance != nullptr; }
+	static bool IsSupported();
+public:
+	ModelGPUCuller();
+	~ModelGPUCuller();
+
+	// call while the depth copy still holds only terrain, i.e. right after it was made
+	void BuildDepthPyramid(const CCamera* cam);
+
+	// culls <instances>, then draws <cmds> whose instance counts the GPU fills in
+	void Submit(
+		GLenum mode,
+		const std::vector<SInstanceData>& instances,
+		const std::vector<uint32_t>& instanceCmds,
+		const std::vector<SDrawElementsIndirectCommand>& cmds,
+		const VBO& instVBO
+	);
+private:
+	void CreateShaders();
+	void CreatePyramid(int sizeX, int sizeY);
+	void DeletePyramid();
+
+	bool HavePyramid(const CCamera* cam) const;
+private:
+	static std::unique_ptr<ModelGPUCuller> instance;
+
+	static constexpr uint32_t CANDIDATES_SSBO_BINDING_IDX = 5;
+	static constexpr uint32_t CANDCMDS_SSBO_BINDING_IDX   = 6;
+	static constexpr uint32_t COMMANDS_SSBO_BINDING_IDX   = 7;
+	static constexpr uint32_t INSTANCES_SSBO_BINDING_IDX  = 8;
+private:
+	Shader::IProgramObject* cullShader = nullptr;
+	Shader::IProgramObject* pyramidShader = nullptr;
+
+	std::unique_ptr<ScopedDepthBufferCopy> sdbc;
+
+	VBO candidatesSSBO;
+	VBO candCmdsSSBO;
+	VBO commandsSSBO;
+
+	// max-depth pyramid, level 0 is the depth copy shrunk to a power of two
+	GLuint pyramidTex = 0;
+	int pyramidSizeX = 0;
+	int pyramidSizeY = 0;
+	int pyramidLevels = 0;
+
+	// view-projection and draw frame the pyramid was built with
+	CMatrix44f pyramidViewProj;
+	uint32_t pyramidDrawFrame = 0;
+	bool pyramidValid = false;
+};
@@ -1,4 +1,7 @@
 #include "ModelsMemStorage.h"
+
+#include <cstring>
+
 #include "Sim/Objects/WorldObject.h"
 
 #include "System/Misc/TracyDefs.h"
@@ -102,6 +105,20 @@ ModelUniformsStorage::MyType& ModelUniformsStorage::GetObjUniformsArray(const CW
 	return storage[offset];
 }
 
+bool ModelUniformsStorage::UpdateIfChanged(const CWorldObject* o, const MyType& newValue)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t offset = GetObjOffset(o);
+	MyType& curValue = storage[offset];
+
+	if (std::memcmp(&curValue, &newValue, sizeof(MyType)) == 0)
+		return false;
+
+	updateList.SetUpdate(offset);
+	curValue = newValue;
+	return true;
+}
+
 ////////////////////////////////////////////////////////////////////
 
 TransformsMemStorage::TransformsMemStorage()
@@ -114,6 +131,7 @@ void TransformsMemStorage::Reset()
 	assert(Threading::IsMainThread());
 	storage.Reset();
 	updateList.Clear();
+	owners.clear();
 }
 
 size_t TransformsMemStorage::Allocate(size_t numElems)
@@ -133,6 +151,58 @@ void TransformsMemStorage::Free(size_t firstElem, size_t numElems, const MyType*
 	storage.Free(firstElem, numElems, T0);
 	updateList.SetUpdate(firstElem, numElems);
 	updateList.Trim(storage.GetSize());
+
+	owners.erase(firstElem);
+}
+
+void TransformsMemStorage::SetOwner(size_t firstElem, ScopedTransformMemAlloc* owner)
+{
+	if (firstElem == INVALID_INDEX)
+		return;
+
+	auto lock = CModelsLock::GetScopedLock();
+	owners[firstElem] = owner;
+}
+
+size_t TransformsMemStorage::Compact(size_t maxElems)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(Threading::IsMainThread());
+	auto lock = CModelsLock::GetScopedLock();
+
+	size_t numMoved = 0;
+
+	// moving the last allocation forward always lets the storage shrink
+	while (numMoved < maxElems && !owners.empty()) {
+		if (storage.GetNumFreeElems() < COMPACTION_FREE_FRACTION * storage.GetSize())
+			break;
+
+		const auto it = std::prev(owners.end());
+		const auto [oldPos, owner] = *it;
+		const size_t numElems = owner->numElems;
+		const size_t newPos = storage.Relocate(oldPos, numElems, &Transform::Zero());
+
+		// nothing fits in front of it, try again once more was freed
+		if (newPos == oldPos)
+			break;
+
+		owners.erase(it);
+		owners.emplace(newPos, owner);
+		owner->firstElem = newPos;
+
+		updateList.SetUpdate(newPos, numElems);
+		updateList.SetUpdate(oldPos, numElems);
+
+		numMoved += numElems;
+	}
+
+	if (numMoved == 0)
+		return 0;
+
+	updateList.Trim(storage.GetSize());
+	numRelocations += 1;
+
+	return numMoved;
 }
 
 const TransformsMemStorage::MyType& TransformsMemStorage::operator[](std::size_t idx) const
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <map>
 #include <memory>
 #include <vector>
 
@@ -15,6 +16,7 @@
 #include "Sim/Objects/SolidObjectDef.h"
 #include "Rendering/Common/UpdateList.h"
 
+class ScopedTransformMemAlloc;
 class TransformsMemStorage {
 public:
 	using MyType = Transform;
@@ -27,8 +29,15 @@ public:
 
 	void Free(size_t firstElem, size_t numElems, const MyType* T0 = nullptr);
 
+	// moves live allocations from the end of the storage into the gaps in front
+	// of them, at most about maxElems elements per call; returns the number moved
+	size_t Compact(size_t maxElems);
+
 	const auto& GetData() const { return storage.GetData(); }
 	const auto  GetSize() const { return storage.GetSize(); }
+	size_t GetNumFreeElems() const { return storage.GetNumFreeElems(); }
+	// offsets handed out before this changed might point elsewhere now
+	size_t GetNumRelocations() const { return numRelocations; }
 
 	template<typename MyTypeLike = MyType> // to force universal references
 	bool UpdateIfChanged(std::size_t idx, MyTypeLike&& newValue, EqualCmpFunctor eqCmp) {
@@ -63,11 +72,20 @@ public:
 
 	const auto& GetUpdateList() const { return updateList; }
 	      auto& GetUpdateList()       { return updateList; }
+private:
+	friend class ScopedTransformMemAlloc;
+	void SetOwner(size_t firstElem, ScopedTransformMemAlloc* owner);
 private:
 	StablePosAllocator<MyType> storage;
 	UpdateList updateList;
+
+	// live allocations by position, patched when Compact() moves them
+	std::map<size_t, ScopedTransformMemAlloc*> owners;
+	size_t numRelocations = 0;
 private:
 	static constexpr int INIT_NUM_ELEMS = 1 << 16u;
+	// fraction of the storage that has to be free before Compact() moves anything
+	static constexpr float COMPACTION_FREE_FRACTION = 0.125f;
 public:
 	static constexpr auto INVALID_INDEX = StablePosAllocator<MyType>::INVALID_INDEX;
 };
@@ -84,6 +102,7 @@ public:
 		: numElems{numElems_}
 	{
 		firstElem = transformsMemStorage.Allocate(numElems);
+		transformsMemStorage.SetOwner(firstElem, this);
 	}
 
 	ScopedTransformMemAlloc(const ScopedTransformMemAlloc&) = delete;
@@ -110,6 +129,9 @@ public:
 		std::swap(firstElem, smma.firstElem);
 		std::swap(numElems , smma.numElems );
 
+		transformsMemStorage.SetOwner(firstElem, this);
+		transformsMemStorage.SetOwner(smma.firstElem, &smma);
+
 		return *this;
 	}
 
@@ -139,6 +161,8 @@ public:
 
 		transformsMemStorage.UpdateForced(firstElem + offset, std::forward<MyTypeLike>(newValue));
 	}
+private:
+	friend class TransformsMemStorage;
 public:
 	static const ScopedTransformMemAlloc& Dummy() {
 		static ScopedTransformMemAlloc dummy;
@@ -165,6 +189,8 @@ public:
 	size_t GetObjOffset(const CWorldObject* o) const;
 	const MyType& GetObjUniformsArray(const CWorldObject* o) const;
 	MyType& GetObjUniformsArray(const CWorldObject* o);
+	// only marks the object for upload if <newValue> differs from the stored one
+	bool UpdateIfChanged(const CWorldObject* o, const MyType& newValue);
 	void   DelObject(const CWorldObject* o);
 
 	size_t AddObject(const SolidObjectDef* o) { return INVALID_INDEX; }
@@ -19,7 +19,7 @@ CR_REG_METADATA(ModelUniformData, (
 		CR_MEMBER(unused4),
 		CR_MEMBER(maxHealth),
 		CR_MEMBER(health),
-		CR_MEMBER(unused5),
+		CR_MEMBER(cullRadius),
 		CR_MEMBER(unused6),
 		CR_MEMBER(drawPos),
 		CR_MEMBER(speed),
@@ -23,7 +23,7 @@ public:
 
 	float maxHealth;
 	float health;
-	float unused5;
+	float cullRadius;
 	float unused6;
 
 	float4 drawPos;
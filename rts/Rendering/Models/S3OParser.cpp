@@ -38,18 +38,13 @@ void CS3OParser::Kill() {
 void CS3OParser::Load(S3DModel& model, const std::string& name)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	CFileHandler file(name);
-	std::vector<uint8_t> fileBuf;
+	// parsed in place, pieces and vertices are copied out before swapping
+	CFileHandler file(name, SPRING_VFS_RAW_FIRST, true);
 
 	if (!file.FileExists())
 		throw content_error("[S3OParser] could not find model-file " + name);
 
-	if (!file.IsBuffered()) {
-		fileBuf.resize(file.FileSize(), 0);
-		file.Read(fileBuf.data(), fileBuf.size());
-	} else {
-		fileBuf = std::move(file.GetBuffer());
-	}
+	const std::span<const uint8_t> fileBuf = file.GetView();
 
 	if (fileBuf.size() < sizeof(S3OHeader))
 		throw content_error("[S3OParser] corrupted header for model-file " + name);
@@ -61,8 +56,8 @@ void CS3OParser::Load(S3DModel& model, const std::string& name)
 	model.name = name;
 	model.type = MODELTYPE_S3O;
 	model.numPieces = 0;
-	model.texs[0] = (header.texture1 == 0)? "" : (char*) &fileBuf[header.texture1];
-	model.texs[1] = (header.texture2 == 0)? "" : (char*) &fileBuf[header.texture2];
+	model.texs[0] = (header.texture1 == 0)? "" : (const char*) &fileBuf[header.texture1];
+	model.texs[1] = (header.texture2 == 0)? "" : (const char*) &fileBuf[header.texture2];
 	model.mins = DEF_MIN_SIZE;
 	model.maxs = DEF_MAX_SIZE;
 
@@ -100,7 +95,7 @@ SS3OPiece* CS3OParser::AllocPiece()
 	return &piecePool[numPoolPieces++];
 }
 
-SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, std::vector<uint8_t>& buf, int offset)
+SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, std::span<const uint8_t> buf, int offset)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if ((offset + sizeof(Piece)) > buf.size())
@@ -109,14 +104,18 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, std::vector
 	model->numPieces++;
 
 	// retrieve piece data
-	Piece* fp = reinterpret_cast<Piece*>(&buf[offset]); fp->swap();
+	Piece pieceData;
+	memcpy(&pieceData, &buf[offset], sizeof(pieceData));
+	pieceData.swap();
+
+	const Piece* fp = &pieceData;
 
 	// (fp->xxxCount > 0) check rationale: apparently widely used s3o tools have a bug when fp->xxx might point outside of buffer
 	// this bug only manifests itself when launching spring in debug build with bounds checking (MSVC does it by default)
 	// Since s3o assets with such bugs is uncountable, let's workaround it in the code.
-	Vertex* vertexList = fp->numVertices > 0 ? reinterpret_cast<Vertex*>(&buf[fp->vertices]) : nullptr;
-	const int* indexList = fp->vertexTableSize > 0 ? reinterpret_cast<int*>(&buf[fp->vertexTable]) : nullptr;
-	const int* childList = fp->numchildren > 0 ? reinterpret_cast<int*>(&buf[fp->children]) : nullptr;
+	const uint8_t* vertexList = fp->numVertices > 0 ? &buf[fp->vertices] : nullptr;
+	const int* indexList = fp->vertexTableSize > 0 ? reinterpret_cast<const int*>(&buf[fp->vertexTable]) : nullptr;
+	const int* childList = fp->numchildren > 0 ? reinterpret_cast<const int*>(&buf[fp->children]) : nullptr;
 
 	// create piece
 	SS3OPiece* piece = AllocPiece();
@@ -125,15 +124,19 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, std::vector
 	piece->offset.y = fp->yoffset;
 	piece->offset.z = fp->zoffset;
 	piece->primType = fp->primitiveType;
-	piece->name = (char*) &buf[fp->name];
+	piece->name = (const char*) &buf[fp->name];
 	piece->parent = parent;
 	piece->SetParentModel(model);
 
 	// retrieve vertices
 	piece->SetVertexCount(fp->numVertices);
 	for (int a = 0; a < fp->numVertices; ++a) {
-		Vertex* v = vertexList++;
-		v->swap();
+		Vertex vertexData;
+		memcpy(&vertexData, vertexList, sizeof(vertexData));
+		vertexData.swap();
+
+		const Vertex* v = &vertexData;
+		vertexList += sizeof(Vertex);
 
 		SVertexData sv;
 		sv.pos = float3(v->xpos, v->ypos, v->zpos);
@@ -3,6 +3,8 @@
 #ifndef S3O_PARSER_H
 #define S3O_PARSER_H
 
+#include <span>
+
 #include "3DModel.h"
 #include "IModelParser.h"
 
@@ -63,7 +65,7 @@ public:
 
 private:
 	SS3OPiece* AllocPiece();
-	SS3OPiece* LoadPiece(S3DModel*, SS3OPiece*, std::vector<uint8_t>& buf, int offset);
+	SS3OPiece* LoadPiece(S3DModel*, SS3OPiece*, std::span<const uint8_t> buf, int offset);
 
 private:
 	std::vector<SS3OPiece> piecePool;
@@ -1,5 +1,6 @@
 #include "ModelsDataUploader.h"
 
+#include <algorithm>
 #include <limits>
 #include <cassert>
 
@@ -7,6 +8,7 @@
 #include "System/Matrix44f.h"
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/TimeProfiler.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Objects/SolidObject.h"
@@ -30,6 +32,11 @@
 #include "Game/GlobalUnsynced.h"
 
 
+CONFIG(int, TransformsCompactionRate)
+	.defaultValue(4096)
+	.minimumValue(0)
+	.description("Maximum number of model transforms moved per frame to keep their storage from fragmenting, 0 disables compaction. Lua instance data holding transform offsets has to be refreshed when Spring.GetModelDataUploadStats reports new relocations.");
+
 ////////////////////////////////////////////////////////////////////
 
 namespace Impl {
@@ -41,13 +48,14 @@ namespace Impl {
 		typename Uploader,
 		typename MemStorage
 	>
-	void UpdateCommon(Uploader& uploader, std::unique_ptr<SSBO>& ssbo, MemStorage& memStorage, const char* className, const char* funcName)
+	// returns the number of bytes written into the SSBO
+	size_t UpdateCommon(Uploader& uploader, std::unique_ptr<SSBO>& ssbo, MemStorage& memStorage, const char* className, const char* funcName)
 	{
 		auto& ul = memStorage.GetUpdateList();
 
 		if (!ssbo || !ssbo->IsValid()) {
 			ul.ResetNeedUpdateAll();
-			return;
+			return 0;
 		}
 
 		//resize handling
@@ -85,13 +93,14 @@ namespace Impl {
 		}
 
 		if (!ul.NeedUpdate())
-			return;
+			return 0;
 
 		// may have been already unbound above, not a big deal
 		ssbo->UnbindBufferRange(uploader.GetBindingIdx());
 
 		// get the data
 		const auto* clientPtr = memStorage.GetData().data();
+		size_t numBytes = 0;
 
 		// iterate over contiguous regions of values that need update on the GPU
 		for (auto itPair = ul.GetNext(); itPair.has_value(); itPair = ul.GetNext(itPair)) {
@@ -103,6 +112,7 @@ namespace Impl {
 				std::copy(clientPtr + idxOffset, clientPtr + idxOffset + idxSize, mappedPtr);
 
 			ul.DecrementUpdate(itPair.value());
+			numBytes += idxSize * sizeof(DataType);
 
 			ssbo->Unmap();
 		}
@@ -111,6 +121,8 @@ namespace Impl {
 		ssbo->SwapBuffer();
 
 		ul.CalcNeedUpdateAll();
+
+		return numBytes;
 	}
 
 	template <
@@ -178,6 +190,8 @@ ModelUniformsUploader modelUniformsUploader;
 
 void TransformsUploader::Init()
 {
+	compactionRate = std::max(configHandler->GetInt("TransformsCompactionRate"), 0);
+
 	const auto sbType = globalRendering->supportPersistentMapping
 		? IStreamBufferConcept::Types::SB_PERSISTENTMAP
 		: IStreamBufferConcept::Types::SB_BUFFERSUBDATA;
@@ -198,6 +212,12 @@ void TransformsUploader::Kill()
 
 void TransformsUploader::Update()
 {
+	// frame boundary, nothing holds on to transform offsets right now
+	if (compactionRate > 0) {
+		SCOPED_TIMER("TransformsUploader::Compact");
+		transformsMemStorage.Compact(compactionRate);
+	}
+
 	if (!globalRendering->haveGL4)
 		return;
 
@@ -205,7 +225,7 @@ void TransformsUploader::Update()
 
 	//auto lock = CModelsLock::GetScopedLock();
 
-	Impl::UpdateCommon<MyDataType>(
+	lastUploadedBytes = Impl::UpdateCommon<MyDataType>(
 		*this,
 		ssbo,
 		transformsMemStorage,
@@ -350,7 +370,7 @@ void ModelUniformsUploader::Update()
 {
 	SCOPED_TIMER("ModelUniformsUploader::Update");
 
-	Impl::UpdateCommon<MyDataType>(*this, ssbo, modelUniformsStorage, className, __func__);
+	lastUploadedBytes = Impl::UpdateCommon<MyDataType>(*this, ssbo, modelUniformsStorage, className, __func__);
 }
 
 size_t ModelUniformsUploader::GetElemOffset(const UnitDef* def) const
@@ -30,6 +30,8 @@ public:
 	uint32_t GetElemsCount() const { return ssbo->GetByteSize() / sizeof(MyDataType); }
 	constexpr uint32_t GetBindingIdx() const { return MATRIX_SSBO_BINDING_IDX; }
 	constexpr uint32_t GetElemCountIncr() const { return ELEM_COUNTI; }
+	// bytes of dirty ranges sent to the GPU by the last Update()
+	size_t GetLastUploadedBytes() const { return lastUploadedBytes; }
 public:
 	// Defs
 	size_t GetElemOffset(const UnitDef* def) const;
@@ -47,6 +49,9 @@ public:
 	size_t GetProjectileElemOffset(int32_t syncedProjectileID) const;
 private:
 	std::unique_ptr<IStreamBuffer<MyDataType>> ssbo;
+	size_t lastUploadedBytes = 0;
+	// max. elements moved per Update() to defragment transformsMemStorage
+	size_t compactionRate = 0;
 private:
 	static constexpr const char* className = spring::TypeToCStr<MyClassName>();
 	static constexpr uint32_t MATRIX_SSBO_BINDING_IDX = 0;
@@ -66,6 +71,8 @@ public:
 	uint32_t GetElemsCount() const { return ssbo->GetByteSize() / sizeof(MyDataType); }
 	constexpr uint32_t GetBindingIdx() const { return MATUNI_SSBO_BINDING_IDX; }
 	constexpr uint32_t GetElemCountIncr() const { return ELEM_COUNTI; }
+	// bytes of dirty ranges sent to the GPU by the last Update()
+	size_t GetLastUploadedBytes() const { return lastUploadedBytes; }
 public:
 	// Defs
 	size_t GetElemOffset(const UnitDef* def) const;
@@ -83,6 +90,7 @@ public:
 	size_t GetProjectileElemOffset(int32_t syncedProjectileID) const;
 private:
 	std::unique_ptr<IStreamBuffer<MyDataType>> ssbo;
+	size_t lastUploadedBytes = 0;
 private:
 	static constexpr const char* className = spring::TypeToCStr<MyClassName>();
 	static constexpr uint32_t MATUNI_SSBO_BINDING_IDX = 1;
@@ -2,9 +2,11 @@
 
 #include "Screenshot.h"
 
+#include <deque>
 #include <vector>
 
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/PixelReadback.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/Textures/Bitmap.h"
 #include "System/StringUtil.h"
@@ -12,7 +14,7 @@
 #include "System/Log/ILog.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileHandler.h"
-#include "System/Threading/ThreadPool.h"
+#include "System/Threading/AsyncTask.h"
 #include "System/TimeUtil.h"
 
 #undef CreateDirectory
@@ -28,7 +30,46 @@ struct FunctionArgs
 	int y;
 };
 
-static std::shared_future<void> fut = {};
+static Threading::AsyncTask<void> saveTask;
+
+// screenshots whose pixels are still being read back, in the order of their reads
+static std::deque<FunctionArgs> pendingShots;
+static PixelReadback screenshotReadback;
+
+static Threading::AsyncTask<void> SaveScreenshot(FunctionArgs args)
+{
+	co_await Threading::ToThreadPool(ThreadPool::TaskPriority::Background);
+
+	CBitmap bmp(&args.pixelbuf[0], args.x, args.y);
+	bmp.ReverseYAxis();
+	bmp.Save(args.filename, true, true, args.quality);
+}
+
+static void SaveOldestScreenshot(bool wait)
+{
+	const uint8_t* pixels = screenshotReadback.MapOldest(wait);
+
+	if (pixels == nullptr) {
+		// a failed map drops the read
+		if (screenshotReadback.NumPending() < pendingShots.size())
+			pendingShots.pop_front();
+
+		return;
+	}
+
+	FunctionArgs args = std::move(pendingShots.front());
+	pendingShots.pop_front();
+
+	args.pixelbuf.assign(pixels, pixels + args.pixelbuf.size());
+	screenshotReadback.UnmapOldest();
+
+	if (saveTask.Valid()) {
+		saveTask.Get();
+		saveTask.Reset();
+	}
+
+	saveTask = SaveScreenshot(std::move(args));
+}
 
 void TakeScreenshot(std::string type, unsigned quality)
 {
@@ -38,10 +79,11 @@ void TakeScreenshot(std::string type, unsigned quality)
 	if (!FileSystem::CreateDirectory("screenshots"))
 		return;
 
-	if (fut.valid()) {
-		fut.get();
-		fut = {};
-	}
+	screenshotReadback.Init(2);
+
+	// only blocks when screenshots are requested faster than the GPU finishes frames
+	if (screenshotReadback.IsFull())
+		SaveOldestScreenshot(true);
 
 	FunctionArgs args;
 	args.x  = globalRendering->winSizeX;
@@ -55,11 +97,35 @@ void TakeScreenshot(std::string type, unsigned quality)
 	args.quality = quality;
 	args.pixelbuf.resize(args.x * args.y * 4);
 
-	glReadPixels(0, 0, args.x, args.y, GL_RGBA, GL_UNSIGNED_BYTE, &args.pixelbuf[0]);
+	if (!screenshotReadback.Read(0, 0, args.x, args.y, GL_RGBA, GL_UNSIGNED_BYTE, args.pixelbuf.size()))
+		return;
+
+	pendingShots.push_back(std::move(args));
+}
+
+void UpdateScreenshots()
+{
+	while (!pendingShots.empty()) {
+		const size_t numPending = pendingShots.size();
+
+		SaveOldestScreenshot(false);
 
-	fut = ThreadPool::Enqueue([](const FunctionArgs& args) {
-		CBitmap bmp(&args.pixelbuf[0], args.x, args.y);
-		bmp.ReverseYAxis();
-		bmp.Save(args.filename, true, true, args.quality);
-	}, args);
+		// oldest read not done yet
+		if (pendingShots.size() == numPending)
+			break;
+	}
+}
+
+void KillScreenshots()
+{
+	while (!pendingShots.empty()) {
+		SaveOldestScreenshot(true);
+	}
+
+	screenshotReadback.Kill();
+
+	if (saveTask.Valid()) {
+		saveTask.Get();
+		saveTask.Reset();
+	}
 }
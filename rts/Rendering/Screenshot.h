@@ -5,6 +5,11 @@
 
 #include <string>
 
+// reads the framebuffer back asynchronously, the file is written a frame or two later
 void TakeScreenshot(std::string type, unsigned quality);
+// saves the screenshots whose pixels have arrived, once per draw frame
+void UpdateScreenshots();
+// waits for all pending screenshots, before the GL context goes away
+void KillScreenshots();
 
 #endif
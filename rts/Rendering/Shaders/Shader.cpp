@@ -14,6 +14,7 @@
 #include "System/Log/ILog.h"
 
 #include "System/Config/ConfigHandler.h"
+#include "System/Misc/StartupTrace.h"
 
 #include <algorithm>
 #ifdef DEBUG
@@ -119,6 +120,16 @@ namespace Shader {
 		return hash;
 	}
 
+	std::string IShaderObject::GetCacheKey() const {
+		std::string key;
+
+		key += IntToString(type, "%x") + " " + IntToString(rawDefStrs.size()) + " " + IntToString(modDefStrs.size()) + " " + IntToString(srcText.size()) + "\n";
+		key += rawDefStrs;
+		key += modDefStrs;
+		key += srcText;
+		return key;
+	}
+
 	std::string IShaderObject::GetShaderSource(const std::string& fileName)
 	{
 		if (fileName.find("void main()") != std::string::npos)
@@ -165,7 +176,7 @@ namespace Shader {
 	): IShaderObject(shType, shSrcFile, shSrcDefs)
 	{ }
 
-	GLSLShaderObject::CompiledShaderObjectUniquePtr GLSLShaderObject::CompileShaderObject()
+	GLSLShaderObject::CompiledShaderObjectUniquePtr GLSLShaderObject::CompileShaderObject(bool deferStatus)
 	{
 		CompiledShaderObjectUniquePtr res(new CompiledShaderObject(), [](CompiledShaderObject* so) {
 			glDeleteShader(so->id);
@@ -202,6 +213,12 @@ namespace Shader {
 		glShaderSource(res->id, sources.size(), &sources[0], NULL);
 		glCompileShader(res->id);
 
+		// assumed valid until the program fails to link
+		if (deferStatus) {
+			res->valid = true;
+			return res;
+		}
+
 		res->valid = glslIsValid(res->id);
 		res->log   = glslGetLog(res->id);
 
@@ -214,6 +231,17 @@ namespace Shader {
 		return res;
 	}
 
+	void GLSLShaderObject::CheckCompileStatus(CompiledShaderObject* so) const
+	{
+		so->valid = glslIsValid(so->id);
+		so->log   = glslGetLog(so->id);
+
+		if (!so->valid && logReporting) {
+			const std::string& name = srcFile.find("void main()") != std::string::npos ? "unknown" : srcFile;
+			LOG_L(L_WARNING, "[GLSL-SO::%s] shader-object name: %s, compile-log:\n%s\n", __FUNCTION__, name.c_str(), so->log.c_str());
+		}
+	}
+
 
 
 
@@ -645,57 +673,89 @@ namespace Shader {
 
 		// recompile if not found in cache (id 0)
 		if (objID == 0) {
+			SCOPED_STARTUP_TRACE("GLSL::Build(" + name + ")", "shader")
 			objID = glCreateProgram();
 
-			bool shadersValid = true;
-			for (IShaderObject*& so: shaderObjs) {
-				assert(dynamic_cast<GLSLShaderObject*>(so));
+			const bool useBinaryCache = shaderHandler->UseProgramBinaryCache();
+			const std::string binaryKey = useBinaryCache ? GetBinaryCacheKey() : std::string();
 
-				auto gso = static_cast<GLSLShaderObject*>(so);
-				auto obj = gso->CompileShaderObject();
+			// try the binary linked by a previous run before compiling
+			if (useBinaryCache && shaderHandler->LoadProgramBinary(objID, binaryKey)) {
+				valid = true;
+			} else {
+				// all stages compile concurrently on driver threads, their status is only checked if linking fails
+				const bool parallelCompile = shaderHandler->UseParallelCompile();
+
+				std::vector<GLSLShaderObject::CompiledShaderObjectUniquePtr> compiledObjs;
+				compiledObjs.reserve(shaderObjs.size());
+
+				bool shadersValid = true;
+				for (IShaderObject*& so: shaderObjs) {
+					assert(dynamic_cast<GLSLShaderObject*>(so));
+
+					auto gso = static_cast<GLSLShaderObject*>(so);
+					auto obj = gso->CompileShaderObject(parallelCompile);
+
+					if (obj->valid) {
+						glAttachShader(objID, obj->id);
+					} else {
+						shadersValid = false;
+					}
 
-				if (obj->valid) {
-					glAttachShader(objID, obj->id);
-				} else {
-					shadersValid = false;
+					compiledObjs.push_back(std::move(obj));
 				}
-			}
 
-			if (!shadersValid)
-				return;
+				if (!shadersValid)
+					return;
 
-			for (const auto& [name, index] : attribLocations) {
-				glBindAttribLocation(objID, index, name.c_str());
-			}
+				for (const auto& [name, index] : attribLocations) {
+					glBindAttribLocation(objID, index, name.c_str());
+				}
 
-			for (const auto& [name, index] : outputLocations) {
-				glBindFragDataLocation(objID, index, name.c_str());
-			}
+				for (const auto& [name, index] : outputLocations) {
+					glBindFragDataLocation(objID, index, name.c_str());
+				}
 
-			glLinkProgram(objID);
+				if (useBinaryCache)
+					glProgramParameteri(objID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 
-			valid = glslIsValid(objID);
-			log += glslGetLog(objID);
+				{
+					// also waits for the (parallel) compiles
+					SCOPED_STARTUP_TRACE("GLSL::Link(" + name + ")", "shader")
+					glLinkProgram(objID);
 
-			if (!IsValid() && logReporting) {
-				LOG_L(L_WARNING, "[GLSL-PO::%s] program-object name: %s, link-log:\n%s\n", __func__, name.c_str(), log.c_str());
-			}
+					valid = glslIsValid(objID);
+				}
+				log += glslGetLog(objID);
 
-			#ifdef _DEBUG
-			if (IsValid()) {
-				for (const auto& [name, index] : attribLocations) {
-					GLint indexOut = glGetAttribLocation(objID, name.c_str());
-					if (indexOut == -1) {
-						LOG_L(L_WARNING, "[GLSL-PO::%s] Attribute %s for program %u is unused(-1)", __func__, name.c_str(), objID);
-					} 
-					else if (indexOut != index) {
-						LOG_L(L_ERROR, "[GLSL-PO::%s] Setting attribute %s to location %d(requested %d) for program %u", __func__, name.c_str(), indexOut, index, objID);
-						assert(false);
+				if (!IsValid() && parallelCompile) {
+					for (size_t i = 0; i < compiledObjs.size(); i++) {
+						static_cast<const GLSLShaderObject*>(shaderObjs[i])->CheckCompileStatus(compiledObjs[i].get());
 					}
 				}
-			}
-			#endif
 
+				if (!IsValid() && logReporting) {
+					LOG_L(L_WARNING, "[GLSL-PO::%s] program-object name: %s, link-log:\n%s\n", __func__, name.c_str(), log.c_str());
+				}
+
+				if (IsValid() && useBinaryCache)
+					shaderHandler->SaveProgramBinary(objID, binaryKey);
+
+				#ifdef _DEBUG
+				if (IsValid()) {
+					for (const auto& [name, index] : attribLocations) {
+						GLint indexOut = glGetAttribLocation(objID, name.c_str());
+						if (indexOut == -1) {
+							LOG_L(L_WARNING, "[GLSL-PO::%s] Attribute %s for program %u is unused(-1)", __func__, name.c_str(), objID);
+						} 
+						else if (indexOut != index) {
+							LOG_L(L_ERROR, "[GLSL-PO::%s] Setting attribute %s to location %d(requested %d) for program %u", __func__, name.c_str(), indexOut, index, objID);
+							assert(false);
+						}
+					}
+				}
+				#endif
+			}
 		} else {
 			valid = true;
 		}
@@ -739,6 +799,32 @@ namespace Shader {
 			glDeleteProgram(oldProgID);
 	}
 
+	std::string GLSLProgramObject::GetBinaryCacheKey() const {
+		std::string key;
+
+		for (const IShaderObject* so: shaderObjs) {
+			key += so->GetCacheKey();
+		}
+
+		// the bound locations are baked into the binary, sort them for a stable key
+		std::vector<std::pair<std::string, int>> locations;
+
+		for (const auto& [name, index] : attribLocations) {
+			locations.emplace_back("a" + name, index);
+		}
+		for (const auto& [name, index] : outputLocations) {
+			locations.emplace_back("o" + name, index);
+		}
+
+		std::sort(locations.begin(), locations.end());
+
+		for (const auto& [name, index] : locations) {
+			key += name + " " + IntToString(index) + "\n";
+		}
+
+		return key;
+	}
+
 	int GLSLProgramObject::GetUniformType(const int idx) {
 		GLint size = 0;
 		GLenum type = 0;
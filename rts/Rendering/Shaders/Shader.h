@@ -52,6 +52,8 @@ namespace Shader {
 		unsigned int GetObjID() const { return objID; }
 		unsigned int GetType() const { return type; }
 		unsigned int GetHash() const;
+		// everything the compiled object depends on, unlike GetHash collision-free
+		std::string GetCacheKey() const;
 
 		const std::string& GetLog() const { return log; }
 
@@ -101,7 +103,9 @@ namespace Shader {
 		///        it will be flagged for deletion, and deletion will not occur until glDetachShader is called
 		///        to detach it from all program objects to which it is attached.
 		typedef std::unique_ptr<CompiledShaderObject, std::function<void(CompiledShaderObject* so)>> CompiledShaderObjectUniquePtr;
-		CompiledShaderObjectUniquePtr CompileShaderObject();
+		/// @param deferStatus leave the status to CheckCompileStatus, querying it waits for a parallel compile
+		CompiledShaderObjectUniquePtr CompileShaderObject(bool deferStatus = false);
+		void CheckCompileStatus(CompiledShaderObject* so) const;
 	};
 
 	struct IProgramObject;
@@ -466,6 +470,9 @@ namespace Shader {
 		void SetUniformMatrix4fv(int idx, bool transp, const float* v) override;
 
 	private:
+		// key of the program in CShaderHandler's program-binary cache
+		std::string GetBinaryCacheKey() const;
+
 		int GetUniformType(const int idx) override;
 		int GetUniformLoc(const char* name) override;
 
@@ -5,14 +5,50 @@
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GlobalRenderingInfo.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 #include "System/SafeUtil.h"
+#include "lib/xxhash/xxh3.h"
+#include "fmt/format.h"
 
 #include <cassert>
+#include <cstring>
+#include <fstream>
 
 #include "System/Misc/TracyDefs.h"
 
+CONFIG(bool, UseShaderBinaryCache).defaultValue(true).headlessValue(false).safemodeValue(false).description("If linked shader programs should be stored in the cache directory and loaded from there on the next start instead of being compiled again, as far as the driver supports it.");
+
+CONFIG(bool, ParallelShaderCompile).defaultValue(true).headlessValue(false).safemodeValue(false).description("If shaders should be compiled on driver threads where supported (KHR_parallel_shader_compile), Lua shaders created with async = true then do not stall the game.");
+
+static constexpr char PROGRAM_BINARY_MAGIC[] = "ProgramBinaryCache-1";
+
+template<typename T> static void AppendCacheData(std::string& blob, const T& v) {
+	blob.append(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template<typename T> static bool ReadCacheData(const char*& ptr, const char* end, T& v) {
+	if (size_t(end - ptr) < sizeof(T))
+		return false;
+
+	std::memcpy(&v, ptr, sizeof(T));
+	ptr += sizeof(T);
+	return true;
+}
+
+// binaries are only valid for the exact driver that produced them
+static std::string GetDriverKey() {
+	return std::string(globalRenderingInfo.glVendor) + "\n" + globalRenderingInfo.glRenderer + "\n" + globalRenderingInfo.glVersion;
+}
+
+static std::string GetProgramBinaryFile(const XXH128_hash_t& keyHash) {
+	return fmt::format("cache/shaders/{:016x}.bin", keyHash.low64);
+}
+
 
 CShaderHandler* CShaderHandler::GetInstance() {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -37,6 +73,8 @@ CShaderHandler::~CShaderHandler() {
 
 	programObjects.clear();
 	shaderCache.Clear();
+
+	LogProgramBinaryStats();
 }
 
 
@@ -47,6 +85,8 @@ void CShaderHandler::ReloadAll() {
 			(jt->second)->Reload(true, true);
 		}
 	}
+
+	LogProgramBinaryStats();
 }
 
 bool CShaderHandler::ReleaseProgramObjects(const std::string& poClass) {
@@ -146,3 +186,166 @@ Shader::IShaderObject* CShaderHandler::CreateShaderObject(const std::string& soN
 #endif
 	return so;
 }
+
+
+bool CShaderHandler::UseProgramBinaryCache()
+{
+	if (numProgramBinaryFormats < 0) {
+		numProgramBinaryFormats = 0;
+
+		if (GLAD_GL_ARB_get_program_binary)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numProgramBinaryFormats);
+	}
+
+	return (numProgramBinaryFormats > 0 && configHandler->GetBool("UseShaderBinaryCache"));
+}
+
+bool CShaderHandler::LoadProgramBinary(unsigned int progID, const std::string& progKey)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const XXH128_hash_t keyHash = XXH3_128bits(progKey.data(), progKey.size());
+	const std::string cacheFile = dataDirsAccess.LocateFile(GetProgramBinaryFile(keyHash));
+
+	std::ifstream ifs(cacheFile, std::ios::binary);
+
+	if (!ifs.is_open()) {
+		numProgramBinaryMisses++;
+		return false;
+	}
+
+	const std::string blob = {std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>()};
+	const std::string driverKey = GetDriverKey();
+
+	const char* ptr = blob.data();
+	const char* end = blob.data() + blob.size();
+
+	const auto ReadHeader = [&]() {
+		XXH128_hash_t fileKeyHash = {0, 0};
+		uint32_t driverKeySize = 0;
+
+		if (blob.size() < sizeof(PROGRAM_BINARY_MAGIC) || std::memcmp(ptr, PROGRAM_BINARY_MAGIC, sizeof(PROGRAM_BINARY_MAGIC)) != 0)
+			return false;
+
+		ptr += sizeof(PROGRAM_BINARY_MAGIC);
+
+		if (!ReadCacheData(ptr, end, fileKeyHash.low64) || !ReadCacheData(ptr, end, fileKeyHash.high64))
+			return false;
+		// a different program with the same file name
+		if (!XXH128_isEqual(fileKeyHash, keyHash))
+			return false;
+
+		if (!ReadCacheData(ptr, end, driverKeySize) || size_t(end - ptr) < driverKeySize)
+			return false;
+		// written by another driver (version)
+		if (driverKey.compare(0, std::string::npos, ptr, driverKeySize) != 0)
+			return false;
+
+		ptr += driverKeySize;
+		return true;
+	};
+
+	GLenum binaryFormat = 0;
+
+	if (!ReadHeader() || !ReadCacheData(ptr, end, binaryFormat) || ptr == end) {
+		numProgramBinaryMisses++;
+		return false;
+	}
+
+	GLint linked = GL_FALSE;
+
+	glProgramBinary(progID, binaryFormat, ptr, static_cast<GLsizei>(end - ptr));
+	glGetProgramiv(progID, GL_LINK_STATUS, &linked);
+
+	if (linked == GL_FALSE) {
+		LOG_L(L_DEBUG, "[ShaderHandler::%s] driver rejected program binary \"%s\"", __func__, cacheFile.c_str());
+		numProgramBinaryRejects++;
+		return false;
+	}
+
+	numProgramBinaryHits++;
+	return true;
+}
+
+void CShaderHandler::SaveProgramBinary(unsigned int progID, const std::string& progKey)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	GLint binarySize = 0;
+	GLenum binaryFormat = 0;
+
+	glGetProgramiv(progID, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+
+	if (binarySize <= 0)
+		return;
+
+	const XXH128_hash_t keyHash = XXH3_128bits(progKey.data(), progKey.size());
+	const std::string driverKey = GetDriverKey();
+
+	std::string blob;
+
+	blob.append(PROGRAM_BINARY_MAGIC, sizeof(PROGRAM_BINARY_MAGIC));
+	AppendCacheData(blob, keyHash.low64);
+	AppendCacheData(blob, keyHash.high64);
+	AppendCacheData(blob, uint32_t(driverKey.size()));
+	blob.append(driverKey);
+
+	const size_t formatPos = blob.size();
+
+	AppendCacheData(blob, binaryFormat);
+	blob.resize(blob.size() + binarySize);
+
+	glGetProgramBinary(progID, binarySize, &binarySize, &binaryFormat, &blob[formatPos + sizeof(binaryFormat)]);
+
+	if (binarySize <= 0)
+		return;
+
+	blob.resize(formatPos + sizeof(binaryFormat) + binarySize);
+	std::memcpy(&blob[formatPos], &binaryFormat, sizeof(binaryFormat));
+
+	const std::string cacheFile = dataDirsAccess.LocateFile(GetProgramBinaryFile(keyHash), FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+	std::ofstream ofs(cacheFile, std::ios::binary | std::ios::trunc);
+
+	if (!ofs.write(blob.data(), blob.size()))
+		LOG_L(L_WARNING, "[ShaderHandler::%s] could not write cache-file \"%s\"", __func__, cacheFile.c_str());
+}
+
+void CShaderHandler::LogProgramBinaryStats() const
+{
+	if ((numProgramBinaryHits + numProgramBinaryMisses + numProgramBinaryRejects) == 0)
+		return;
+
+	LOG("[ShaderHandler::%s] program-binary cache: %u hits, %u misses, %u rejected by the driver", __func__, numProgramBinaryHits, numProgramBinaryMisses, numProgramBinaryRejects);
+}
+
+
+bool CShaderHandler::UseParallelCompile()
+{
+	if (parallelCompile < 0) {
+		parallelCompile = 0;
+
+		if (configHandler->GetBool("ParallelShaderCompile")) {
+			// 0xFFFFFFFF lets the driver pick the number of threads
+			if (GLAD_GL_KHR_parallel_shader_compile) {
+				glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
+				parallelCompile = 1;
+			} else if (GLAD_GL_ARB_parallel_shader_compile) {
+				glMaxShaderCompilerThreadsARB(0xFFFFFFFF);
+				parallelCompile = 1;
+			}
+		}
+
+		LOG("[ShaderHandler::%s] parallel shader compilation %s", __func__, (parallelCompile > 0)? "enabled": "unavailable or disabled");
+	}
+
+	return (parallelCompile > 0);
+}
+
+bool CShaderHandler::IsProgramLinkComplete(unsigned int progID)
+{
+	if (!UseParallelCompile())
+		return true;
+
+	GLint complete = GL_FALSE;
+	glGetProgramiv(progID, GL_COMPLETION_STATUS_KHR, &complete);
+
+	return (complete != GL_FALSE);
+}
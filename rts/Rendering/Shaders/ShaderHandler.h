@@ -3,6 +3,7 @@
 #ifndef SPRING_SHADERHANDLER_HDR
 #define SPRING_SHADERHANDLER_HDR
 
+#include <cstdint>
 #include <string>
 
 #include "Rendering/GL/myGL.h" //GLuint
@@ -78,6 +79,23 @@ public:
 	const ShaderCache& GetShaderCache() const { return shaderCache; }
 	      ShaderCache& GetShaderCache()       { return shaderCache; }
 
+	/**
+	 * Persistent cache of linked GLSL programs in cache/shaders/, see GLSLProgramObject::Reload.
+	 * @param progKey Everything the program was linked from (sources, definitions, bound locations);
+	 *                the driver is keyed in by the handler.
+	 */
+	bool UseProgramBinaryCache();
+	bool LoadProgramBinary(unsigned int progID, const std::string& progKey);
+	void SaveProgramBinary(unsigned int progID, const std::string& progKey);
+	void LogProgramBinaryStats() const;
+
+	/**
+	 * KHR/ARB_parallel_shader_compile: compiles and links run on driver threads
+	 * and only block once their status is queried, which callers should defer.
+	 */
+	bool UseParallelCompile();
+	bool IsProgramLinkComplete(unsigned int progID);
+
 private:
 	// all created programs, by name
 	ProgramTable programObjects;
@@ -85,6 +103,15 @@ private:
 	ShaderCache shaderCache;
 
 	Shader::IProgramObject* currentlyBoundProgram = nullptr;
+
+	// -1 until first queried
+	int numProgramBinaryFormats = -1;
+	int parallelCompile = -1;
+
+	uint32_t numProgramBinaryHits = 0;
+	uint32_t numProgramBinaryMisses = 0;
+	// binaries the driver refused to load, e.g. after an update that kept the version string
+	uint32_t numProgramBinaryRejects = 0;
 	static inline CShaderHandler* gShaderHandler = nullptr;
 };
 
@@ -20,6 +20,9 @@
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/GL/RenderBuffers.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Objects/SolidObject.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Matrix44f.h"
@@ -33,6 +36,22 @@ CONFIG(int, Shadows).defaultValue(2).headlessValue(-1).minimumValue(-1).safemode
 CONFIG(int, ShadowMapSize).defaultValue(CShadowHandler::DEF_SHADOWMAP_SIZE).minimumValue(32).description("Sets the resolution of shadows. Higher numbers increase quality at the cost of performance.");
 CONFIG(int, ShadowProjectionMode).defaultValue(CShadowHandler::SHADOWPROMODE_CAM_CENTER);
 CONFIG(bool, ShadowColorMode).defaultValue(true).description("Whether the colorbuffer of shadowmap FBO is RGB vs greyscale(to conserve some VRAM)");
+CONFIG(bool, ShadowStaticCache).defaultValue(true).description("Whether terrain and idle buildings are rendered into a separate shadow depth texture that is only redrawn when they change. Only used with ShadowProjectionMode = 0.");
+
+CONFIG(int, ShadowCascades).defaultValue(1).minimumValue(1).maximumValue(CShadowHandler::MAX_SHADOW_CASCADES).description("Number of shadow cascades. 1 uses the regular shadow map only, every additional cascade covers a slice of the view near the camera at its own resolution.");
+CONFIG(int, ShadowCascadeMapSize).defaultValue(CShadowHandler::DEF_SHADOWMAP_SIZE).minimumValue(CShadowHandler::MIN_SHADOWMAP_SIZE).maximumValue(CShadowHandler::MAX_SHADOWMAP_SIZE).description("Resolution of each near shadow cascade.");
+CONFIG(float, ShadowCascadeRange).defaultValue(4000.0f).minimumValue(100.0f).description("View distance in elmos covered by the near shadow cascades, the regular shadow map is used beyond it.");
+CONFIG(int, ShadowCascadeUpdateInterval).defaultValue(2).minimumValue(1).description("The nearest shadow cascade is redrawn every frame, cascade N (counting from 0) every N times this many frames.");
+
+// share of logarithmic vs. uniform split distances between the near cascades
+static constexpr float CASCADE_SPLIT_LAMBDA = 0.75f;
+// extra coverage of cascades that are not redrawn every frame, so the camera can move a bit
+static constexpr float CASCADE_BOUNDS_MARGIN = 1.2f;
+
+// sim-frames an immobile object must not have moved to be baked into the static cache
+static constexpr int STATIC_CASTER_IDLE_FRAMES = GAME_SPEED * 5;
+// draw-frames after which the static cache is rebuilt anyway to pick up newly idle objects
+static constexpr uint32_t STATIC_CACHE_REFRESH_FRAMES = 600;
 
 CShadowHandler shadowHandler;
 
@@ -72,11 +91,23 @@ void CShadowHandler::Init()
 	shadowColorMode = configHandler->GetInt("ShadowColorMode");
 	shadowGenBits = SHADOWGEN_BIT_NONE;
 
+	shadowCascadeMapSize = configHandler->GetInt("ShadowCascadeMapSize");
+	shadowCascadeUpdateInterval = configHandler->GetInt("ShadowCascadeUpdateInterval");
+	shadowCascadeRange = configHandler->GetFloat("ShadowCascadeRange");
+
 	shadowsLoaded = false;
 	inShadowPass = false;
 
 	shadowDepthTexture = 0;
 	shadowColorTexture = 0;
+	shadowStaticDepthTexture = 0;
+	shadowCascadeDepthTexture = 0;
+
+	numNearCascades = 0;
+	staticCacheActive = false;
+	staticCacheDirty = true;
+	shadowCasterLayer = SHADOWCASTER_LAYER_ALL;
+	staticCasters.clear();
 
 	if (!tmpFirstInit && !shadowsSupported)
 		return;
@@ -111,6 +142,13 @@ void CShadowHandler::Init()
 	if (tmpFirstInit)
 		shadowsSupported = true;
 
+	// the cache only stays valid while the light-space transform does not follow the camera
+	if (shadowConfig > 0 && shadowProMode == SHADOWPROMODE_MAP_CENTER && GLAD_GL_ARB_copy_image && configHandler->GetBool("ShadowStaticCache"))
+		staticCacheActive = InitStaticCache();
+
+	if (shadowConfig > 0 && configHandler->GetInt("ShadowCascades") > 1 && !InitCascades())
+		LOG_L(L_WARNING, "[%s] failed to initialize shadow cascades, using the regular shadow map only", __func__);
+
 	LoadProjectionMatrix(CCameraHandler::GetCamera(CCamera::CAMTYPE_SHADOW));
 
 	if (shadowConfig > 0)
@@ -184,8 +222,30 @@ void CShadowHandler::FreeFBOAndTextures() {
 
 	smOpaqFBO.Kill();
 
+	if (smStaticFBO.IsValid()) {
+		smStaticFBO.Bind();
+		smStaticFBO.DetachAll();
+		smStaticFBO.Unbind();
+	}
+
+	smStaticFBO.Kill();
+
+	if (smCascadeFBO.IsValid()) {
+		smCascadeFBO.Bind();
+		smCascadeFBO.DetachAll();
+		smCascadeFBO.Unbind();
+	}
+
+	smCascadeFBO.Kill();
+
 	glDeleteTextures(1, &shadowDepthTexture); shadowDepthTexture = 0;
 	glDeleteTextures(1, &shadowColorTexture); shadowColorTexture = 0;
+	glDeleteTextures(1, &shadowStaticDepthTexture); shadowStaticDepthTexture = 0;
+	glDeleteTextures(1, &shadowCascadeDepthTexture); shadowCascadeDepthTexture = 0;
+
+	staticCacheActive = false;
+	staticCasters.clear();
+	numNearCascades = 0;
 }
 
 
@@ -433,6 +493,306 @@ bool CShadowHandler::InitFBOAndTextures()
 	return status;
 }
 
+bool CShadowHandler::InitStaticCache()
+{
+	smStaticFBO.Init(false);
+
+	if (!smStaticFBO.IsValid()) {
+		LOG_L(L_WARNING, "[%s] static shadow cache framebuffer not valid", __func__);
+		return false;
+	}
+
+	// never sampled, only copied into shadowDepthTexture; has to match its format
+	const int depthBits = std::min(globalRendering->supportDepthBufferBitDepth, 24);
+	const GLint depthFormat = CGlobalRendering::DepthBitsToFormat(depthBits);
+
+	glGenTextures(1, &shadowStaticDepthTexture);
+	glBindTexture(GL_TEXTURE_2D, shadowStaticDepthTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0); //no mips
+	glTexImage2D(GL_TEXTURE_2D, 0, depthFormat, shadowMapSize, shadowMapSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	smStaticFBO.Bind();
+	smStaticFBO.AttachTexture(shadowStaticDepthTexture, GL_TEXTURE_2D, GL_DEPTH_ATTACHMENT);
+
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	const bool status = smStaticFBO.CheckStatus("SHADOW-STATIC");
+
+	smStaticFBO.Unbind();
+
+	if (!status) {
+		smStaticFBO.Kill();
+		glDeleteTextures(1, &shadowStaticDepthTexture); shadowStaticDepthTexture = 0;
+	}
+
+	return status;
+}
+
+bool CShadowHandler::InitCascades()
+{
+	const int numCascades = std::min(configHandler->GetInt("ShadowCascades") - 1, int(MAX_NEAR_CASCADES));
+
+	smCascadeFBO.Init(false);
+
+	if (!smCascadeFBO.IsValid())
+		return false;
+
+	static constexpr float one[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+
+	const int depthBits = std::min(globalRendering->supportDepthBufferBitDepth, 24);
+	const GLint depthFormat = CGlobalRendering::DepthBitsToFormat(depthBits);
+
+	glGenTextures(1, &shadowCascadeDepthTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, shadowCascadeDepthTexture);
+	glTexParameterfv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BORDER_COLOR, one);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_BASE_LEVEL, 0);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0); //no mips
+	// only ever sampled with depth comparison
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, depthFormat, shadowCascadeMapSize, shadowCascadeMapSize, numCascades, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	smCascadeFBO.Bind();
+	smCascadeFBO.AttachTextureLayer(shadowCascadeDepthTexture, GL_DEPTH_ATTACHMENT, 0, 0);
+
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	const bool status = smCascadeFBO.CheckStatus("SHADOW-CASCADES");
+
+	smCascadeFBO.Unbind();
+
+	if (!status) {
+		smCascadeFBO.Kill();
+		glDeleteTextures(1, &shadowCascadeDepthTexture); shadowCascadeDepthTexture = 0;
+		return false;
+	}
+
+	for (auto& sc : cascades) {
+		sc = {};
+	}
+
+	numNearCascades = numCascades;
+	return true;
+}
+
+void CShadowHandler::SetupShadowCascadeTexSampler(unsigned int texUnit) const
+{
+	glActiveTexture(texUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, shadowCascadeDepthTexture);
+}
+
+void CShadowHandler::ResetShadowCascadeTexSampler(unsigned int texUnit) const
+{
+	glActiveTexture(texUnit);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+}
+
+void CShadowHandler::SetShadowCascadeUniforms(Shader::IProgramObject* po) const
+{
+	static constexpr const char* cascadeMatNames[MAX_NEAR_CASCADES] = {
+		"shadowCascadeMat0",
+		"shadowCascadeMat1",
+		"shadowCascadeMat2",
+	};
+
+	po->SetUniform("numShadowCascades", numNearCascades);
+
+	for (int i = 0; i < numNearCascades; i++) {
+		po->SetUniformMatrix4x4(cascadeMatNames[i], false, &cascades[i].viewMatrix[SHADOWMAT_TYPE_DRAWING].m[0]);
+	}
+}
+
+bool CShadowHandler::ShouldDrawShadowCaster(const CSolidObject* o, bool canBeStatic, int lastChangeFrame)
+{
+	switch (shadowCasterLayer) {
+		case SHADOWCASTER_LAYER_STATIC: {
+			if (!canBeStatic || !o->immobile || o->luaDraw)
+				return false;
+
+			if (o->GetLuaMaterialData()->Enabled())
+				return false;
+
+			if ((o->engineDrawMask & DrawFlags::SO_SHOPAQ_FLAG) != DrawFlags::SO_SHOPAQ_FLAG)
+				return false;
+
+			if ((gs->frameNum - lastChangeFrame) < STATIC_CASTER_IDLE_FRAMES)
+				return false;
+
+			staticCasters.insert(o);
+			return true;
+		} break;
+		case SHADOWCASTER_LAYER_CASCADE: {
+			// the shadow camera's frustum is the cascade's while it is drawn
+			return (CCameraHandler::GetCamera(CCamera::CAMTYPE_SHADOW)->InView(o->drawMidPos, o->GetDrawRadius()));
+		} break;
+		case SHADOWCASTER_LAYER_DYNAMIC: {
+			if (staticCasters.find(o) == staticCasters.end())
+				return true;
+
+			if (lastChangeFrame <= staticCacheFrame)
+				return false;
+
+			// moved since it was baked; draw it here until the rebuild next frame drops it
+			staticCacheDirty = true;
+			return true;
+		} break;
+		default: {
+		} break;
+	}
+
+	return true;
+}
+
+void CShadowHandler::RemoveShadowCaster(const CSolidObject* o)
+{
+	staticCacheDirty |= (staticCasters.erase(o) > 0);
+}
+
+bool CShadowHandler::StaticCacheValid() const
+{
+	if (staticCacheDirty)
+		return false;
+
+	if (staticCacheHeightMapUpdates != readMap->GetNumUnsyncedHeightMapUpdates())
+		return false;
+
+	// sun direction or shadow-map scales changed
+	if (!(staticCacheViewMatrix == viewMatrix[SHADOWMAT_TYPE_DRAWING]))
+		return false;
+
+	if ((globalRendering->drawFrame - staticCacheDrawFrame) >= STATIC_CACHE_REFRESH_FRAMES)
+		return false;
+
+	// baked objects that went out of LOS, turned transparent, got a Lua material, etc
+	for (const CSolidObject* o : staticCasters) {
+		if (!o->HasDrawFlag(DrawFlags::SO_SHOPAQ_FLAG))
+			return false;
+
+		if ((o->engineDrawMask & DrawFlags::SO_SHOPAQ_FLAG) != DrawFlags::SO_SHOPAQ_FLAG)
+			return false;
+
+		if (o->GetLuaMaterialData()->Enabled())
+			return false;
+	}
+
+	return true;
+}
+
+void CShadowHandler::DrawStaticShadowPasses()
+{
+	ZoneScopedN("Draw::World::CreateShadows::Static");
+
+	inShadowPass = true;
+	shadowCasterLayer = SHADOWCASTER_LAYER_STATIC;
+	staticCasters.clear();
+
+	smStaticFBO.Bind();
+	glClear(GL_DEPTH_BUFFER_BIT);
+
+	glPushAttrib(GL_POLYGON_BIT | GL_ENABLE_BIT);
+	glEnable(GL_CULL_FACE);
+	glCullFace(GL_BACK);
+
+	if ((shadowGenBits & SHADOWGEN_BIT_MODEL) != 0) {
+		unitDrawer->DrawShadowPass();
+		featureDrawer->DrawShadowPass();
+	}
+
+	glCullFace(GL_BACK);
+	if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0)
+		readMap->GetGroundDrawer()->DrawShadowPass();
+
+	glPopAttrib();
+
+	smOpaqFBO.Bind();
+
+	shadowCasterLayer = SHADOWCASTER_LAYER_ALL;
+	inShadowPass = false;
+
+	staticCacheDirty = false;
+	staticCacheViewMatrix = viewMatrix[SHADOWMAT_TYPE_DRAWING];
+	staticCacheHeightMapUpdates = readMap->GetNumUnsyncedHeightMapUpdates();
+	staticCacheDrawFrame = globalRendering->drawFrame;
+	staticCacheFrame = gs->frameNum;
+}
+
+void CShadowHandler::DrawCascadePasses()
+{
+	ZoneScopedN("Draw::World::CreateShadows::Cascades");
+
+	CCamera* shadCam = CCameraHandler::GetCamera(CCamera::CAMTYPE_SHADOW);
+	Shader::IProgramObject* modelProgGL4 = shadowGenProgs[SHADOWGEN_PROGRAM_MODEL_GL4];
+
+	inShadowPass = true;
+	shadowCasterLayer = SHADOWCASTER_LAYER_CASCADE;
+
+	smCascadeFBO.Bind();
+
+	glPushAttrib(GL_POLYGON_BIT | GL_ENABLE_BIT);
+	glEnable(GL_CULL_FACE);
+
+	for (int i = 0; i < numNearCascades; i++) {
+		ShadowCascade& sc = cascades[i];
+
+		if (sc.drawFrame != globalRendering->drawFrame)
+			continue;
+
+		SetShadowCamera(shadCam, sc.viewMatrix, sc.projScales, shadowCascadeMapSize);
+
+		smCascadeFBO.AttachTextureLayer(shadowCascadeDepthTexture, GL_DEPTH_ATTACHMENT, 0, i);
+		glClear(GL_DEPTH_BUFFER_BIT);
+
+		// the GL4 program reads the regular shadow matrix from the UBO otherwise
+		if (modelProgGL4 != nullptr) {
+			modelProgGL4->Enable();
+			modelProgGL4->SetUniform("useCascadeView", 1);
+			modelProgGL4->SetUniformMatrix4x4("cascadeView", false, &sc.viewMatrix[SHADOWMAT_TYPE_DRAWING].m[0]);
+			modelProgGL4->Disable();
+		}
+
+		glCullFace(GL_BACK);
+
+		if ((shadowGenBits & SHADOWGEN_BIT_PROJ) != 0)
+			projectileDrawer->DrawShadowOpaque();
+
+		if ((shadowGenBits & SHADOWGEN_BIT_MODEL) != 0) {
+			unitDrawer->DrawShadowPass();
+			featureDrawer->DrawShadowPass();
+		}
+
+		glCullFace(GL_BACK);
+		if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0)
+			readMap->GetGroundDrawer()->DrawShadowPass();
+	}
+
+	if (modelProgGL4 != nullptr) {
+		modelProgGL4->Enable();
+		modelProgGL4->SetUniform("useCascadeView", 0);
+		modelProgGL4->Disable();
+	}
+
+	glPopAttrib();
+
+	// CreateShadows leaves it bound
+	smOpaqFBO.Bind();
+
+	shadowCasterLayer = SHADOWCASTER_LAYER_ALL;
+	inShadowPass = false;
+
+	SetShadowCamera(shadCam);
+}
+
 void CShadowHandler::DrawShadowPasses()
 {
 	inShadowPass = true;
@@ -474,7 +834,7 @@ void CShadowHandler::DrawShadowPasses()
 	// Restore GL_BACK culling, because Lua shadow materials might
 	// have changed culling at their own discretion
 	glCullFace(GL_BACK);
-	if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0){
+	if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0 && shadowCasterLayer != SHADOWCASTER_LAYER_DYNAMIC) {
 		ZoneScopedN("Draw::World::CreateShadows::Terrain");
 		readMap->GetGroundDrawer()->DrawShadowPass();
 	}
@@ -490,7 +850,7 @@ void CShadowHandler::DrawShadowPasses()
 	inShadowPass = false;
 }
 
-static CMatrix44f ComposeLightMatrix(const CCamera* playerCam, const ISkyLight* light)
+static CMatrix44f ComposeLightMatrix(const CCamera* playerCam, const ISkyLight* light, bool fixedAxes)
 {
 	CMatrix44f lightMatrix;
 
@@ -498,11 +858,14 @@ static CMatrix44f ComposeLightMatrix(const CCamera* playerCam, const ISkyLight*
 	float3 zDir = -float3(light->GetLightDir());
 
 	// Try to rotate LM's X and Y around Z direction to fit playerCam tightest
+	// (or around the world axes, which keeps the matrix constant for the static cache)
+	const std::array<const float3*, 3> camAxes = { &playerCam->forward, &playerCam->right, &playerCam->up };
+	const std::array<const float3*, 3> mapAxes = { &FwdVector, &RgtVector, &UpVector };
 
 	// find the most orthogonal vector to zDir and call it xDir
 	float minDot = 1.0f;
 	float3 xDir;
-	for (const auto* dir : { &playerCam->forward, &playerCam->right, &playerCam->up }) {
+	for (const auto* dir : (fixedAxes? mapAxes: camAxes)) {
 		const float dp = zDir.dot(*dir);
 		if (math::fabs(dp) < minDot) {
 			xDir = std::copysign(1.0f, dp) * (*dir);
@@ -527,11 +890,8 @@ static CMatrix44f ComposeScaleMatrix(const float4 scales)
 	return (CMatrix44f(FwdVector * 0.5f, RgtVector / scales.x, UpVector / scales.y, FwdVector / scales.w));
 }
 
-void CShadowHandler::SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam)
+static void ComposeViewMatrices(CMatrix44f* viewMats, const CMatrix44f& lightMatrix, const CMatrix44f& scaleMatrix, const float3& midPos)
 {
-	const CMatrix44f lightMatrix = ComposeLightMatrix(playerCam, ISky::GetSky()->GetLight());
-	const CMatrix44f scaleMatrix = ComposeScaleMatrix(shadowProjScales = GetShadowProjectionScales(playerCam, lightMatrix));
-
 	// KISS; define only the world-to-light transform (P[CULLING] is unused anyway)
 	//
 	// we have two options: either place the camera such that it *looks at* projMidPos
@@ -543,44 +903,139 @@ void CShadowHandler::SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam)
 	//   we can omit inverting X (does not impact VC) or disable PD face-culling
 	//   or just let objects end up behind znear since InView only tests against
 	//   zfar
-	viewMatrix[SHADOWMAT_TYPE_CULLING].LoadIdentity();
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetX(lightMatrix.GetX());
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetY(lightMatrix.GetY());
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetZ(lightMatrix.GetZ());
-	viewMatrix[SHADOWMAT_TYPE_CULLING].SetPos(projMidPos[2]);
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].LoadIdentity();
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetX(lightMatrix.GetX());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetY(lightMatrix.GetY());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetZ(lightMatrix.GetZ());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_CULLING].SetPos(midPos);
 
 	// shaders need this form, projection into SM-space is done by shadow2DProj()
 	// note: ShadowGenVertProg is a special case because it does not use uniforms
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].LoadIdentity();
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetX(lightMatrix.GetX());
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetY(lightMatrix.GetY());
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetZ(lightMatrix.GetZ());
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].Scale(float3(scaleMatrix[0], scaleMatrix[5], scaleMatrix[10])); // extract (X.x, Y.y, Z.z)
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].Transpose();
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetPos(viewMatrix[SHADOWMAT_TYPE_DRAWING] * -projMidPos[2]);
-	viewMatrix[SHADOWMAT_TYPE_DRAWING].SetPos(viewMatrix[SHADOWMAT_TYPE_DRAWING].GetPos() + scaleMatrix.GetPos()); // add z-bias
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].LoadIdentity();
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetX(lightMatrix.GetX());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetY(lightMatrix.GetY());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetZ(lightMatrix.GetZ());
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].Scale(float3(scaleMatrix[0], scaleMatrix[5], scaleMatrix[10])); // extract (X.x, Y.y, Z.z)
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].Transpose();
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetPos(viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING] * -midPos);
+	viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].SetPos(viewMats[CShadowHandler::SHADOWMAT_TYPE_DRAWING].GetPos() + scaleMatrix.GetPos()); // add z-bias
+}
+
+void CShadowHandler::SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam)
+{
+	const CMatrix44f lightMatrix = ComposeLightMatrix(playerCam, ISky::GetSky()->GetLight(), staticCacheActive);
+	const CMatrix44f scaleMatrix = ComposeScaleMatrix(shadowProjScales = GetShadowProjectionScales(playerCam, lightMatrix));
+
+	ComposeViewMatrices(viewMatrix, lightMatrix, scaleMatrix, projMidPos[2]);
+
+	// cascades are fit with spheres, a basis that follows the camera would only force redraws
+	if (numNearCascades > 0)
+		UpdateCascades(playerCam, ComposeLightMatrix(playerCam, ISky::GetSky()->GetLight(), true));
+}
+
+void CShadowHandler::UpdateCascades(CCamera* playerCam, const CMatrix44f& lightMatrix)
+{
+	const float nearDist = playerCam->GetNearPlaneDist();
+	const float farDist = std::max(playerCam->GetFarPlaneDist(), nearDist + 1.0f);
+	const float maxDist = std::clamp(shadowCascadeRange, nearDist + 1.0f, farDist);
+
+	float3 frustumVerts[8];
+	for (int i = 0; i < 8; i++) {
+		frustumVerts[i] = playerCam->GetFrustumVert(i);
+	}
+
+	float sliceBegDist = nearDist;
+
+	for (int c = 0; c < numNearCascades; c++) {
+		ShadowCascade& sc = cascades[c];
+
+		const float splitFrac = (c + 1.0f) / numNearCascades;
+		const float logSplit = nearDist * std::pow(maxDist / nearDist, splitFrac);
+		const float uniSplit = nearDist + (maxDist - nearDist) * splitFrac;
+		const float sliceEndDist = mix(uniSplit, logSplit, CASCADE_SPLIT_LAMBDA);
+
+		// view depth is linear along the frustum edges
+		float3 sliceVerts[8];
+		for (int i = 0; i < 4; i++) {
+			sliceVerts[i    ] = mix(frustumVerts[i], frustumVerts[4 + i], (sliceBegDist - nearDist) / (farDist - nearDist));
+			sliceVerts[i + 4] = mix(frustumVerts[i], frustumVerts[4 + i], (sliceEndDist - nearDist) / (farDist - nearDist));
+		}
+
+		sliceBegDist = sliceEndDist;
+
+		sc.reqMidPos = ZeroVector;
+		for (const float3& v : sliceVerts) {
+			sc.reqMidPos += v;
+		}
+		sc.reqMidPos *= 0.125f;
+
+		float sqRadius = 0.0f;
+		for (const float3& v : sliceVerts) {
+			sqRadius = std::max(sqRadius, (v - sc.reqMidPos).SqLength());
+		}
+		sc.reqRadius = math::sqrt(sqRadius);
+
+		const uint32_t updateInterval = std::max(1, shadowCascadeUpdateInterval * c);
+
+		bool redraw = !sc.valid;
+		redraw |= ((globalRendering->drawFrame - sc.drawFrame) >= updateInterval);
+		redraw |= !(sc.lightMatrix == lightMatrix);
+
+		// the required bounds must not leave the drawn ones (in the light's XY-plane)
+		const float3 midPosDiff = sc.reqMidPos - sc.midPos;
+		const float midPosDist = math::sqrt(Square(midPosDiff.dot(lightMatrix.GetX())) + Square(midPosDiff.dot(lightMatrix.GetY())));
+		redraw |= ((midPosDist + sc.reqRadius) > sc.radius);
+
+		if (!redraw)
+			continue;
+
+		sc.radius = sc.reqRadius * ((c == 0)? 1.0f: CASCADE_BOUNDS_MARGIN);
+		sc.midPos = sc.reqMidPos;
+
+		{
+			// move in whole texels to keep edges from crawling while the camera moves
+			const float texelSize = (sc.radius * 2.0f) / shadowCascadeMapSize;
+			const float midPosX = sc.midPos.dot(lightMatrix.GetX());
+			const float midPosY = sc.midPos.dot(lightMatrix.GetY());
+
+			sc.midPos += (lightMatrix.GetX() * (std::floor(midPosX / texelSize) * texelSize - midPosX));
+			sc.midPos += (lightMatrix.GetY() * (std::floor(midPosY / texelSize) * texelSize - midPosY));
+			// same depth range as the regular map, casters between the light and the slice stay in
+			sc.midPos += (lightMatrix.GetZ() * lightMatrix.GetZ().dot(projMidPos[2] - sc.midPos));
+		}
+
+		sc.projScales = float4(sc.radius * 2.0f, sc.radius * 2.0f, 0.0f, shadowProjScales.w);
+		sc.lightMatrix = lightMatrix;
+		sc.drawFrame = globalRendering->drawFrame;
+		sc.valid = true;
+
+		ComposeViewMatrices(sc.viewMatrix, lightMatrix, ComposeScaleMatrix(sc.projScales), sc.midPos);
+	}
 }
 
 void CShadowHandler::SetShadowCamera(CCamera* shadowCam)
 {
-	const int realShTexSize = shadowConfig > 0 ? shadowMapSize : 1;
+	SetShadowCamera(shadowCam, viewMatrix, shadowProjScales, shadowConfig > 0 ? shadowMapSize : 1);
+}
 
+void CShadowHandler::SetShadowCamera(CCamera* shadowCam, const CMatrix44f* viewMats, const float4& projScales, int texSize)
+{
 	// first set matrices needed by shaders (including ShadowGenVertProg)
 	shadowCam->SetProjMatrix(projMatrix[SHADOWMAT_TYPE_DRAWING]);
-	shadowCam->SetViewMatrix(viewMatrix[SHADOWMAT_TYPE_DRAWING]);
+	shadowCam->SetViewMatrix(viewMats[SHADOWMAT_TYPE_DRAWING]);
 
-	shadowCam->SetAspectRatio(shadowProjScales.x / shadowProjScales.y);
+	shadowCam->SetAspectRatio(projScales.x / projScales.y);
 	// convert xy-diameter to radius
-	shadowCam->SetFrustumScales(shadowProjScales * float4(0.5f, 0.5f, 1.0f, 1.0f));
+	shadowCam->SetFrustumScales(projScales * float4(0.5f, 0.5f, 1.0f, 1.0f));
 	shadowCam->UpdateFrustum();
-	shadowCam->UpdateLoadViewport(0, 0, realShTexSize, realShTexSize);
+	shadowCam->UpdateLoadViewport(0, 0, texSize, texSize);
 	// load matrices into gl_{ModelView,Projection}Matrix
 	shadowCam->Update({false, false, false, false, false});
 
 	// next set matrices needed for SP visibility culling (these
 	// are *NEVER* loaded into gl_{ModelView,Projection}Matrix!)
 	shadowCam->SetProjMatrix(projMatrix[SHADOWMAT_TYPE_CULLING]);
-	shadowCam->SetViewMatrix(viewMatrix[SHADOWMAT_TYPE_CULLING]);
+	shadowCam->SetViewMatrix(viewMats[SHADOWMAT_TYPE_CULLING]);
 	shadowCam->UpdateFrustum();
 }
 
@@ -649,8 +1104,26 @@ void CShadowHandler::CreateShadows()
 
 	CCamera* prvCam = CCameraHandler::GetSetActiveCamera(CCamera::CAMTYPE_SHADOW);
 
-	if (ISky::GetSky()->GetLight()->GetLightIntensity() > 0.0f)
+	if (ISky::GetSky()->GetLight()->GetLightIntensity() > 0.0f) {
+		if (staticCacheActive) {
+			if (!StaticCacheValid())
+				DrawStaticShadowPasses();
+
+			// start from the cached depth, only the remaining casters are drawn on top
+			glCopyImageSubData(
+				shadowStaticDepthTexture, GL_TEXTURE_2D, 0, 0, 0, 0,
+				shadowDepthTexture      , GL_TEXTURE_2D, 0, 0, 0, 0,
+				shadowMapSize, shadowMapSize, 1
+			);
+			shadowCasterLayer = SHADOWCASTER_LAYER_DYNAMIC;
+		}
+
 		DrawShadowPasses();
+		shadowCasterLayer = SHADOWCASTER_LAYER_ALL;
+
+		if (numNearCascades > 0)
+			DrawCascadePasses();
+	}
 
 	CCameraHandler::SetActiveCamera(prvCam->GetCamType());
 	prvCam->Update();
@@ -9,17 +9,21 @@
 #include "Rendering/GL/FBO.h"
 #include "System/float4.h"
 #include "System/Matrix44f.h"
+#include "System/UnorderedSet.hpp"
 
 namespace Shader {
 	struct IProgramObject;
 }
 
 class CCamera;
+class CSolidObject;
 class CShadowHandler
 {
 public:
 	CShadowHandler()
-		:smOpaqFBO(true)
+		: smOpaqFBO(true)
+		, smStaticFBO(true)
+		, smCascadeFBO(true)
 	{}
 
 	void Init();
@@ -52,6 +56,11 @@ public:
 		DEF_SHADOWMAP_SIZE =  2048,
 		MAX_SHADOWMAP_SIZE = 16384,
 	};
+	enum ShadowCascadeCounts {
+		// the regular shadow map is always the last (farthest) cascade
+		MAX_SHADOW_CASCADES = 4,
+		MAX_NEAR_CASCADES = MAX_SHADOW_CASCADES - 1,
+	};
 
 	enum ShadowGenProgram {
 		SHADOWGEN_PROGRAM_MODEL      = 0,
@@ -66,6 +75,13 @@ public:
 		SHADOWMAT_TYPE_DRAWING = 1,
 	};
 
+	enum ShadowCasterLayer {
+		SHADOWCASTER_LAYER_ALL     = 0, // no static cache, everything is drawn every frame
+		SHADOWCASTER_LAYER_STATIC  = 1, // (re)building the static cache
+		SHADOWCASTER_LAYER_DYNAMIC = 2, // drawing on top of the static cache
+		SHADOWCASTER_LAYER_CASCADE = 3, // drawing one of the near cascades
+	};
+
 	Shader::IProgramObject* GetShadowGenProg(ShadowGenProgram p) {
 		return shadowGenProgs[p];
 	}
@@ -82,6 +98,15 @@ public:
 
 	uint32_t GetShadowTextureID() const { return shadowDepthTexture; }
 	uint32_t GetColorTextureID() const { return shadowColorTexture; }
+	uint32_t GetCascadeTextureID() const { return shadowCascadeDepthTexture; }
+
+	// number of cascades in front of the regular shadow map, 0 if disabled
+	int GetNumNearCascades() const { return numNearCascades; }
+
+	void SetupShadowCascadeTexSampler(unsigned int texUnit) const;
+	void ResetShadowCascadeTexSampler(unsigned int texUnit) const;
+	// numShadowCascades and shadowCascadeMat{0,1,2} of a shader sampling the cascades
+	void SetShadowCascadeUniforms(Shader::IProgramObject* po) const;
 
 	static bool ShadowsInitialized() { return firstInit; }
 	static bool ShadowsSupported() { return shadowsSupported; }
@@ -93,16 +118,36 @@ public:
 	void DrawFrustumDebug() const;
 
 	bool& DebugFrustumRef() { return debugFrustum; }
+
+	/**
+	 * Decides whether a model that passed all other shadow-pass checks is
+	 * drawn in the current pass. While the static cache is rebuilt, idle
+	 * immobile objects are recorded as part of it; afterwards they are left
+	 * out of the per-frame pass until their transform changes again.
+	 */
+	bool ShouldDrawShadowCaster(const CSolidObject* o, bool canBeStatic, int lastChangeFrame);
+	void RemoveShadowCaster(const CSolidObject* o);
+
+	ShadowCasterLayer GetShadowCasterLayer() const { return shadowCasterLayer; }
+	bool InCascadePass() const { return (shadowCasterLayer == SHADOWCASTER_LAYER_CASCADE); }
+	bool StaticCacheActive() const { return staticCacheActive; }
 private:
 	void FreeFBOAndTextures();
 	bool InitFBOAndTextures();
+	bool InitStaticCache();
+	bool InitCascades();
 
+	bool StaticCacheValid() const;
+	void DrawStaticShadowPasses();
 	void DrawShadowPasses();
+	void DrawCascadePasses();
 	void LoadProjectionMatrix(const CCamera* shadowCam);
 	void LoadShadowGenShaders();
 
 	void SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam);
 	void SetShadowCamera(CCamera* shadowCam);
+	void SetShadowCamera(CCamera* shadowCam, const CMatrix44f* viewMats, const float4& projScales, int texSize);
+	void UpdateCascades(CCamera* playerCam, const CMatrix44f& lightMatrix);
 
 	float4 GetShadowProjectionScales(CCamera*, const CMatrix44f&);
 	float3 CalcShadowProjectionPos(CCamera*, float3*);
@@ -117,11 +162,18 @@ public:
 	int shadowProMode;
 	int shadowColorMode;
 
+	int shadowCascadeMapSize;
+	int shadowCascadeUpdateInterval;
+	float shadowCascadeRange;
+
 private:
 	bool shadowsLoaded = false;
 	bool inShadowPass = false;
 	bool debugFrustum = false;
 
+	bool staticCacheActive = false;
+	bool staticCacheDirty = true;
+
 	inline static bool firstInit = true;
 	inline static bool shadowsSupported = false;
 
@@ -140,8 +192,45 @@ private:
 
 	uint32_t shadowDepthTexture;
 	uint32_t shadowColorTexture;
+	// depth of terrain and idle immobile objects only
+	uint32_t shadowStaticDepthTexture;
 
 	FBO smOpaqFBO;
+	FBO smStaticFBO;
+
+	ShadowCasterLayer shadowCasterLayer = SHADOWCASTER_LAYER_ALL;
+
+	// objects baked into shadowStaticDepthTexture
+	spring::unordered_set<const CSolidObject*> staticCasters;
+
+	// state the static cache was built with
+	CMatrix44f staticCacheViewMatrix;
+	uint32_t staticCacheHeightMapUpdates = 0;
+	uint32_t staticCacheDrawFrame = 0;
+	int staticCacheFrame = 0;
+
+	struct ShadowCascade {
+		// culling and drawing view matrices the cascade was last drawn with
+		CMatrix44f viewMatrix[2];
+		CMatrix44f lightMatrix;
+		float4 projScales;
+
+		// light-space bounds as drawn and as required by the current view
+		float3 midPos;
+		float3 reqMidPos;
+		float radius = 0.0f;
+		float reqRadius = 0.0f;
+
+		uint32_t drawFrame = 0;
+		bool valid = false;
+	};
+
+	std::array<ShadowCascade, MAX_NEAR_CASCADES> cascades;
+	int numNearCascades = 0;
+
+	// one layer per near cascade, depth only
+	uint32_t shadowCascadeDepthTexture;
+	FBO smCascadeFBO;
 
 	/// xmid, ymid, p17, p18
 	static constexpr float4 shadowTexProjCenter = {
@@ -8,6 +8,7 @@
 
 #include <IL/il.h>
 #include <SDL_video.h>
+#include "xsimd/xsimd.hpp"
 
 #include "Rendering/GL/myGL.h"
 #ifndef HEADLESS
@@ -393,6 +394,46 @@ static bool IsValidImageFormat(int format) {
 }
 
 
+// 8-bit RGBA pixels read as little-endian words keep their alpha in the top byte
+static constexpr uint32_t RGBA8_ALPHA_MASK = 0xFF000000u;
+
+// expands RGB (or BGR) to RGBA; byte-wise so the compiler can vectorize the shuffle
+template<bool swapRB>
+static void ExpandToRGBA8(const uint8_t* src, uint8_t* dst, size_t numPixels, uint8_t alpha)
+{
+	constexpr size_t R = swapRB? 2: 0;
+	constexpr size_t B = swapRB? 0: 2;
+
+	for (size_t i = 0; i < numPixels; i++) {
+		dst[i * 4 + 0] = src[i * 3 + R];
+		dst[i * 4 + 1] = src[i * 3 + 1];
+		dst[i * 4 + 2] = src[i * 3 + B];
+		dst[i * 4 + 3] = alpha;
+	}
+}
+
+#ifndef HEADLESS
+// mem[i] = (mem[i] & andMask) ^ xorMask for all pixels
+static void MaskPixelsRGBA8(uint8_t* mem, size_t numPixels, uint32_t andMask, uint32_t xorMask)
+{
+	using WordBatch = xsimd::simd_type<uint32_t>;
+
+	uint32_t* pixels = reinterpret_cast<uint32_t*>(mem);
+	size_t i = 0;
+
+	for (; (i + WordBatch::size) <= numPixels; i += WordBatch::size) {
+		WordBatch px; px.load_unaligned(pixels + i);
+		px = (px & WordBatch(andMask)) ^ WordBatch(xorMask);
+		px.store_unaligned(pixels + i);
+	}
+
+	for (; i < numPixels; i++) {
+		pixels[i] = (pixels[i] & andMask) ^ xorMask;
+	}
+}
+#endif
+
+
 
 //////////////////////////////////////////////////////////////////////
 // BitmapAction
@@ -1282,22 +1323,19 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 	#endif
 
 
-	CFileHandler file(filename);
-	std::vector<uint8_t> buffer;
+	// IL decodes from the mapped file or archive entry directly if possible
+	CFileHandler file(filename, SPRING_VFS_RAW_FIRST, true);
 
 	if (!file.FileExists()) {
 		AllocDummy();
 		return false;
 	}
 
-	if (!file.IsBuffered()) {
-		buffer.resize(file.FileSize(), 0);
-		file.Read(buffer.data(), buffer.size());
-	} else {
-		// steal if file was loaded from VFS
-		buffer = std::move(file.GetBuffer());
-	}
+	const std::span<const uint8_t> buffer = file.GetView();
 
+	// 8-bit RGB or BGR images are expanded to RGBA after the decoder lock is released
+	std::vector<uint8_t> rgbData;
+	ILint srcFormat = 0;
 
 	{
 		std::scoped_lock lck(ITexMemPool::texMemPool->GetMutex());
@@ -1318,6 +1356,7 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 
 			isLoaded = !!ilLoadL(IL_TYPE_UNKNOWN, buffer.data(), static_cast<ILuint>(buffer.size()));
 			currFormat = ilGetInteger(IL_IMAGE_FORMAT);
+			srcFormat = currFormat;
 			isValid = (isLoaded && IsValidImageFormat(currFormat));
 			dataType = ilGetInteger(IL_IMAGE_TYPE);
 			// auto bpp = ilGetInteger(IL_IMAGE_BYTES_PER_PIXEL);
@@ -1373,7 +1412,22 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 			streflop::streflop_init<streflop::Simple>();
 		}
 
-		if (isValid) {
+		const bool expandRGB = isValid
+			&& ((srcFormat == IL_RGB || srcFormat == IL_BGR) && dataType == IL_UNSIGNED_BYTE && ilGetInteger(IL_IMAGE_BPC) == 1)
+			&& (reqChannel == 4 && (reqDataType == 0 || reqDataType == GL_UNSIGNED_BYTE));
+
+		if (expandRGB) {
+			channels = 4;
+			xsize = ilGetInteger(IL_IMAGE_WIDTH);
+			ysize = ilGetInteger(IL_IMAGE_HEIGHT);
+
+			ITexMemPool::texMemPool->FreeRaw(GetRawMem(), curMemSize);
+			memIdx = ITexMemPool::texMemPool->AllocIdxRaw(GetMemSize());
+
+			for (const ILubyte* imgData = ilGetData(); imgData != nullptr; imgData = nullptr) {
+				rgbData.assign(imgData, imgData + xsize * ysize * 3);
+			}
+		} else if (isValid) {
 			{
 				// conditional transformation
 				ILenum dstFormat;
@@ -1416,6 +1470,19 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 		return false;
 	}
 
+	if (!rgbData.empty()) {
+		const uint8_t alpha = static_cast<uint8_t>(255 * defaultAlpha);
+
+		if (srcFormat == IL_BGR) {
+			ExpandToRGBA8<true>(rgbData.data(), GetRawMem(), xsize * ysize, alpha);
+		} else {
+			ExpandToRGBA8<false>(rgbData.data(), GetRawMem(), xsize * ysize, alpha);
+		}
+
+		// alpha is already set
+		hasAlpha = true;
+	}
+
 	if (!hasAlpha || forceReplaceAlpha)
 		ReplaceAlpha(defaultAlpha);
 
@@ -1423,6 +1490,30 @@ bool CBitmap::Load(std::string const& filename, float defaultAlpha, uint32_t req
 }
 
 
+void CBitmap::LoadBatch(std::span<LoadRequest> requests)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const auto LoadRequested = [](LoadRequest& req) {
+		req.loaded = req.bitmap->Load(req.fileName);
+
+		if (!req.loaded && !req.fallbackName.empty())
+			req.loaded = req.bitmap->Load(req.fallbackName);
+	};
+
+	if (requests.size() <= 1) {
+		for (LoadRequest& req: requests) {
+			LoadRequested(req);
+		}
+
+		return;
+	}
+
+	for_mt(0, requests.size(), [&](const int i) {
+		LoadRequested(requests[i]);
+	});
+}
+
+
 bool CBitmap::LoadGrayscale(const std::string& filename)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -1432,20 +1523,12 @@ bool CBitmap::LoadGrayscale(const std::string& filename)
 	channels = 1;
 
 
-	CFileHandler file(filename);
+	CFileHandler file(filename, SPRING_VFS_RAW_FIRST, true);
 
 	if (!file.FileExists())
 		return false;
 
-	std::vector<uint8_t> buffer;
-
-	if (!file.IsBuffered()) {
-		buffer.resize(file.FileSize() + 1, 0);
-		file.Read(buffer.data(), file.FileSize());
-	} else {
-		// steal if file was loaded from VFS
-		buffer = std::move(file.GetBuffer());
-	}
+	const std::span<const uint8_t> buffer = file.GetView();
 
 	{
 		std::scoped_lock lck(ITexMemPool::texMemPool->GetMutex());
@@ -1909,6 +1992,12 @@ void CBitmap::ReplaceAlpha(float a)
 	if (compressed)
 		return;
 
+	if (channels == 4 && dataType == GL_UNSIGNED_BYTE) {
+		const uint32_t alpha = static_cast<uint8_t>(255 * a);
+		MaskPixelsRGBA8(GetRawMem(), xsize * ysize, ~RGBA8_ALPHA_MASK, alpha << 24);
+		return;
+	}
+
 	auto action = BitmapAction::GetBitmapAction(this);
 	action->ReplaceAlpha(a);
 #endif
@@ -2050,6 +2139,11 @@ void CBitmap::InvertAlpha()
 	if (compressed)
 		return; // Don't try to invert DDS
 
+	if (channels == 4 && dataType == GL_UNSIGNED_BYTE) {
+		MaskPixelsRGBA8(GetRawMem(), xsize * ysize, ~0u, RGBA8_ALPHA_MASK);
+		return;
+	}
+
 	auto action = BitmapAction::GetBitmapAction(this);
 	action->InvertAlpha();
 #endif
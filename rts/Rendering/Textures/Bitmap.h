@@ -29,6 +29,15 @@ struct TextureCreationParams {
 };
 
 class CBitmap {
+public:
+	struct LoadRequest {
+		CBitmap* bitmap = nullptr;
+
+		std::string fileName;
+		std::string fallbackName; // tried if fileName can not be loaded, unless empty
+
+		bool loaded = false;
+	};
 public:
 	CBitmap();
 	CBitmap(const uint8_t* data, int xsize, int ysize, int channels = 4, uint32_t reqDataType = 0);
@@ -64,6 +73,9 @@ public:
 
 	/// Load data from a file on the VFS
 	bool Load(std::string const& filename, float defaultAlpha = 1.0f, uint32_t reqChannel = 4, uint32_t reqDataType = 0x1401/*GL_UNSIGNED_BYTE*/, bool forceReplaceAlpha = false);
+	/// Runs Load (with default arguments) for all requests on the thread pool; only the
+	/// decoder itself is serialized, file reads and format conversions overlap
+	static void LoadBatch(std::span<LoadRequest> requests);
 	/// Load data from a gray-scale file on the VFS
 	bool LoadGrayscale(std::string const& filename);
 
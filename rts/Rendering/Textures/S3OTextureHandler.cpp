@@ -6,18 +6,25 @@
 
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/SimpleParser.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/ShadowHandler.h"
+#include "Rendering/GL/TexBind.h"
 #include "Rendering/Units/UnitDrawer.h"
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Models/ModelsLock.h"
 #include "Rendering/Textures/Bitmap.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <chrono>
+#include <cmath>
 #include <set>
 #include <sstream>
 
@@ -32,6 +39,15 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_TEXTURE)
 
 #define TEX_MAT_UID(pTxID, sTxID) ((std::uint64_t(pTxID) << 32u) | sTxID)
 
+CONFIG(bool, S3OTextureStreaming).defaultValue(false).headlessValue(false).safemodeValue(false).description("Upload only the low-resolution mip levels of DDS model textures at load time and stream in the higher ones when models are drawn large enough to need them.");
+CONFIG(int, S3OTextureStreamingBudget).defaultValue(1024).minimumValue(64).description("VRAM budget in MB for streamed model textures, the least recently drawn ones drop back to their low-resolution levels when it is exceeded.");
+
+// levels of at most this size are uploaded at load time and never evicted
+static constexpr uint32_t STREAM_TAIL_SIZE = 128;
+// texels wanted per on-screen pixel of a model, UV layouts rarely fill the texture
+static constexpr float STREAM_TEXELS_PER_PIXEL = 2.0f;
+static constexpr uint32_t STREAM_MAX_PENDING_LOADS = 4;
+
 
 // The S3O texture handler uses two textures.
 // The first contains diffuse color (RGB) and teamcolor (A)
@@ -51,6 +67,11 @@ void CS3OTextureHandler::Init()
 	// dummies
 	textures.emplace_back();
 	textures.emplace_back();
+
+#ifndef HEADLESS
+	textureStreaming = configHandler->GetBool("S3OTextureStreaming");
+	streamingBudget = static_cast<uint64_t>(configHandler->GetInt("S3OTextureStreamingBudget")) << 20;
+#endif
 }
 
 void CS3OTextureHandler::Kill()
@@ -65,6 +86,14 @@ void CS3OTextureHandler::Kill()
 	textureCache.clear();
 	textureTable.clear();
 	bitmapCache.clear();
+
+#ifndef HEADLESS
+	// loads still in flight finish on their own, their images are dropped with the futures
+	streamedTextures.clear();
+	streamedBytes = 0;
+	pendingBytes = 0;
+	numPendingLoads = 0;
+#endif
 }
 
 void CS3OTextureHandler::Reload()
@@ -89,15 +118,99 @@ void CS3OTextureHandler::Reload()
 			uint32_t newTexId = bitmap.CreateMipMapTexture(0.0f, 0.0f, 0, texData.texID);
 			assert(newTexId == texData.texID);
 		}
+
+	#ifndef HEADLESS
+		// all levels were just uploaded, the texture is no longer streamed
+		if (texData.streamIdx >= 0) {
+			StreamedTexture& st = streamedTextures[texData.streamIdx];
+
+			{
+				auto binding = GL::TexBind(GL_TEXTURE_2D, texData.texID);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+			}
+
+			if (st.pendingLoad.valid()) {
+				pendingBytes -= GetStreamedBytes(st, st.loadingLevel, st.residentLevel);
+				numPendingLoads -= 1;
+			}
+
+			streamedBytes -= GetStreamedBytes(st, st.residentLevel, st.tailLevel);
+
+			st.texID = 0;
+			st.pendingLoad = {};
+			texData.streamIdx = -1;
+		}
+	#endif
 	}
+
+#ifndef HEADLESS
+	for (S3OTexMat& texMat: textures) {
+		texMat.tex1StreamIdx = texMat.tex1StreamIdx >= 0 && streamedTextures[texMat.tex1StreamIdx].texID != 0 ? texMat.tex1StreamIdx : -1;
+		texMat.tex2StreamIdx = texMat.tex2StreamIdx >= 0 && streamedTextures[texMat.tex2StreamIdx].texID != 0 ? texMat.tex2StreamIdx : -1;
+	}
+#endif
 }
 
 
+static void PrepareModelBitmap(CBitmap& bitmap, bool loaded, const S3DModel* model, unsigned int texNum, bool invertAxis, bool invertAlpha)
+{
+	if (!loaded) {
+		if (texNum == 0)
+			LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, model->texs[texNum].c_str(), model->name.c_str());
+
+		// file not found (or headless build), set a single pixel so model is visible
+		bitmap.AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
+	}
+
+	if (invertAxis)
+		bitmap.ReverseYAxis();
+	if (invertAlpha)
+		bitmap.InvertAlpha();
+}
+
 void CS3OTextureHandler::PreloadTexture(S3DModel* model, bool invertAxis, bool invertAlpha)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	// models are parsed concurrently, so their textures are decoded outside of the
+	// lock and only the bitmaps that nobody else cached meanwhile are inserted
+	std::array<CBitmap, 2> bitmaps;
+	std::array<CBitmap::LoadRequest, 2> requests;
+	std::array<unsigned int, 2> requestTexNums;
+	size_t numRequests = 0;
+
+	{
+		auto lock = CModelsLock::GetScopedLock();
+
+		for (unsigned int texNum = 0; texNum < 2; texNum++) {
+			const std::string& textureName = model->texs[texNum];
+
+			if (textureCache.contains(textureName) || bitmapCache.contains(textureName))
+				continue;
+			if (numRequests > 0 && requests[0].fileName == textureName)
+				continue;
+
+			requests[numRequests] = {&bitmaps[numRequests], textureName, "unittextures/" + textureName};
+			requestTexNums[numRequests] = texNum;
+			numRequests++;
+		}
+	}
+
+	CBitmap::LoadBatch({requests.data(), numRequests});
+
+	for (size_t i = 0; i < numRequests; i++) {
+		// never invert alpha for tex2
+		PrepareModelBitmap(bitmaps[i], requests[i].loaded, model, requestTexNums[i], invertAxis, invertAlpha && requestTexNums[i] == 0);
+	}
+
 	auto lock = CModelsLock::GetScopedLock();
 
+	for (size_t i = 0; i < numRequests; i++) {
+		if (textureCache.contains(requests[i].fileName))
+			continue;
+
+		bitmapCache.emplace(requests[i].fileName, std::move(bitmaps[i]));
+	}
+
 	LoadAndCacheTexture(model, 0, invertAxis, invertAlpha, true);
 	LoadAndCacheTexture(model, 1, invertAxis,       false, true); // never invert alpha for tex2
 }
@@ -158,21 +271,24 @@ unsigned int CS3OTextureHandler::LoadAndCacheTexture(
 
 		bitmap = &(iter->second);
 
-		if (!bitmap->Load(textureName) && !bitmap->Load("unittextures/" + textureName)) {
-			if (texNum == 0)
-				LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, textureName.c_str(), model->name.c_str());
-
-			// file not found (or headless build), set a single pixel so model is visible
-			bitmap->AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
-		}
+		const bool loaded = bitmap->Load(textureName) || bitmap->Load("unittextures/" + textureName);
 
-		if (invertAxis)
-			bitmap->ReverseYAxis();
-		if (invertAlpha)
-			bitmap->InvertAlpha();
+		PrepareModelBitmap(*bitmap, loaded, model, texNum, invertAxis, invertAlpha);
 	}
 
-	const unsigned int texID = preloadCall ? 0 : bitmap->CreateMipMapTexture();
+	unsigned int texID = 0;
+	int streamIdx = -1;
+
+	if (!preloadCall) {
+	#ifndef HEADLESS
+		// the bitmap was not modified, so the levels can be re-read from the file as they are
+		if (textureStreaming && textureIt != textureCache.end() && !textureIt->second.invertAxis && !textureIt->second.invertAlpha)
+			texID = CreateStreamedTexture(textureName, *bitmap, streamIdx);
+	#endif
+
+		if (texID == 0)
+			texID = bitmap->CreateMipMapTexture();
+	}
 #ifndef HEADLESS
 	assert(preloadCall || texID > 0);
 #endif
@@ -180,6 +296,7 @@ unsigned int CS3OTextureHandler::LoadAndCacheTexture(
 	if (textureIt != textureCache.end() && texID > 0) {
 		assert(!preloadCall);
 		textureIt->second.texID = texID;
+		textureIt->second.streamIdx = streamIdx;
 	}
 	else {
 		//save main params from the preloadCall pass, such that data is stored correctly for Reload()
@@ -191,7 +308,8 @@ unsigned int CS3OTextureHandler::LoadAndCacheTexture(
 			static_cast<uint32_t>(bitmap->xsize),
 			static_cast<uint32_t>(bitmap->ysize),
 			invertAxis,
-			invertAlpha
+			invertAlpha,
+			streamIdx
 		};
 	}
 
@@ -220,9 +338,239 @@ unsigned int CS3OTextureHandler::InsertTextureMat(const S3DModel* model)
 	texMat.tex1SizeY = tex1.ysize;
 	texMat.tex2SizeX = tex2.xsize;
 	texMat.tex2SizeY = tex2.ysize;
+	texMat.tex1StreamIdx = tex1.streamIdx;
+	texMat.tex2StreamIdx = tex2.streamIdx;
 
 	textureTable[TEX_MAT_UID(texMat.tex1, texMat.tex2)] = texMat.num;
 
 	return texMat.num;
 }
 
+
+
+void CS3OTextureHandler::RequestTextureSize(unsigned int num, float pixelSize)
+{
+#ifndef HEADLESS
+	if (!textureStreaming || num >= textures.size())
+		return;
+
+	const S3OTexMat& texMat = textures[num];
+
+	for (const int streamIdx: {texMat.tex1StreamIdx, texMat.tex2StreamIdx}) {
+		if (streamIdx < 0)
+			continue;
+
+		std::atomic<float>& requestedSize = streamedTextures[streamIdx].requestedSize;
+		float curSize = requestedSize.load(std::memory_order_relaxed);
+
+		while (curSize < pixelSize && !requestedSize.compare_exchange_weak(curSize, pixelSize, std::memory_order_relaxed));
+	}
+#endif
+}
+
+void CS3OTextureHandler::UpdateStreaming()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+#ifndef HEADLESS
+	if (!textureStreaming)
+		return;
+
+	const int curFrame = globalRendering->drawFrame;
+
+	for (StreamedTexture& st: streamedTextures) {
+		if (st.texID == 0)
+			continue;
+
+		if (st.pendingLoad.valid() && st.pendingLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+			FinishStreamedLoad(st);
+
+		const float pixelSize = st.requestedSize.exchange(0.0f, std::memory_order_relaxed);
+
+		if (pixelSize <= 0.0f)
+			continue;
+
+		const float wantedTexels = std::max(pixelSize * STREAM_TEXELS_PER_PIXEL, 1.0f);
+		const float wantedLevel = std::floor(std::log2(st.size / wantedTexels));
+
+		st.wantedLevel = static_cast<uint32_t>(std::clamp(wantedLevel, 0.0f, static_cast<float>(st.tailLevel)));
+		st.lastDrawFrame = curFrame;
+	}
+
+	for (StreamedTexture& st: streamedTextures) {
+		if (numPendingLoads >= STREAM_MAX_PENDING_LOADS)
+			break;
+
+		if (st.texID == 0 || st.pendingLoad.valid() || st.lastDrawFrame != curFrame || st.wantedLevel >= st.residentLevel)
+			continue;
+
+		// make room by dropping the least recently drawn textures, settle for less detail if that is not enough
+		uint32_t loadingLevel = st.wantedLevel;
+
+		while (loadingLevel < st.residentLevel && (streamedBytes + pendingBytes + GetStreamedBytes(st, loadingLevel, st.residentLevel)) > streamingBudget) {
+			if (!EvictLeastRecentlyUsed(curFrame))
+				loadingLevel += 1;
+		}
+
+		if (loadingLevel >= st.residentLevel)
+			continue;
+
+		st.loadingLevel = loadingLevel;
+		st.pendingLoad = ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::Background, [fileName = st.fileName]() {
+			nv_dds::CDDSImage image;
+
+			if (!image.load(fileName, true))
+				image.load("unittextures/" + fileName, true);
+
+			return image;
+		});
+
+		pendingBytes += GetStreamedBytes(st, st.loadingLevel, st.residentLevel);
+		numPendingLoads += 1;
+	}
+
+	// still over budget (e.g. everything drawn this frame wants its full size), drop what was not drawn
+	while (streamedBytes > streamingBudget && EvictLeastRecentlyUsed(curFrame));
+#endif
+}
+
+
+#ifndef HEADLESS
+unsigned int CS3OTextureHandler::CreateStreamedTexture(const std::string& fileName, const CBitmap& bitmap, int& streamIdx)
+{
+	const nv_dds::CDDSImage& image = bitmap.ddsimage;
+
+	if (!bitmap.compressed || !image.is_valid() || image.get_type() != nv_dds::TextureFlat || image.get_num_mipmaps() == 0)
+		return 0;
+
+	const uint32_t numLevels = image.get_num_mipmaps() + 1;
+	uint32_t tailLevel = 0;
+
+	while ((tailLevel + 1) < numLevels && std::max(image.get_level(tailLevel).get_width(), image.get_level(tailLevel).get_height()) > STREAM_TAIL_SIZE)
+		tailLevel += 1;
+
+	// small enough to stay resident as a whole
+	if (tailLevel == 0)
+		return 0;
+
+	const GL::TextureCreationParams tcp;
+	unsigned int texID = 0;
+
+	glGenTextures(1, &texID);
+
+	{
+		auto binding = GL::TexBind(GL_TEXTURE_2D, texID);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, tailLevel);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, numLevels - 1);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, tcp.GetMinFilter(image.get_num_mipmaps()));
+
+		if (!image.upload_texture2D_levels(tailLevel, numLevels - 1, GL_TEXTURE_2D)) {
+			glDeleteTextures(1, &texID);
+			return 0;
+		}
+	}
+
+	streamIdx = static_cast<int>(streamedTextures.size());
+
+	StreamedTexture& st = streamedTextures.emplace_back();
+
+	st.fileName = fileName;
+	st.texID = texID;
+	st.size = std::max(image.get_width(), image.get_height());
+	st.numLevels = numLevels;
+	st.tailLevel = tailLevel;
+	st.residentLevel = tailLevel;
+	st.wantedLevel = tailLevel;
+	st.loadingLevel = tailLevel;
+
+	st.levelBytes.reserve(numLevels);
+
+	for (uint32_t level = 0; level < numLevels; level++) {
+		st.levelBytes.push_back(image.get_level(level).get_size());
+	}
+
+	return texID;
+}
+
+uint32_t CS3OTextureHandler::GetStreamedBytes(const StreamedTexture& st, uint32_t firstLevel, uint32_t lastLevel) const
+{
+	uint32_t bytes = 0;
+
+	for (uint32_t level = firstLevel; level < lastLevel; level++) {
+		bytes += st.levelBytes[level];
+	}
+
+	return bytes;
+}
+
+void CS3OTextureHandler::FinishStreamedLoad(StreamedTexture& st)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const nv_dds::CDDSImage& image = st.pendingLoad.get();
+	const uint32_t bytes = GetStreamedBytes(st, st.loadingLevel, st.residentLevel);
+
+	pendingBytes -= bytes;
+	numPendingLoads -= 1;
+
+	// the file may have vanished or changed (e.g. by a VFS reload) since the texture was created
+	bool valid = image.is_valid() && image.get_type() == nv_dds::TextureFlat && (image.get_num_mipmaps() + 1) == st.numLevels;
+
+	for (uint32_t level = st.loadingLevel; valid && level < st.residentLevel; level++) {
+		valid = (image.get_level(level).get_size() == st.levelBytes[level]);
+	}
+
+	if (valid) {
+		auto binding = GL::TexBind(GL_TEXTURE_2D, st.texID);
+
+		if (image.upload_texture2D_levels(st.loadingLevel, st.residentLevel - 1, GL_TEXTURE_2D)) {
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, st.loadingLevel);
+
+			streamedBytes += bytes;
+			st.residentLevel = st.loadingLevel;
+		}
+	} else {
+		LOG_L(L_WARNING, "[%s] could not stream in the mip levels of texture \"%s\"", __func__, st.fileName.c_str());
+	}
+
+	st.loadingLevel = st.residentLevel;
+	st.pendingLoad = {};
+}
+
+void CS3OTextureHandler::EvictStreamedLevels(StreamedTexture& st)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto binding = GL::TexBind(GL_TEXTURE_2D, st.texID);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, st.tailLevel);
+
+	// redefining the dropped levels as empty lets the driver release their storage
+	for (uint32_t level = st.residentLevel; level < st.tailLevel; level++) {
+		glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	streamedBytes -= GetStreamedBytes(st, st.residentLevel, st.tailLevel);
+
+	st.residentLevel = st.tailLevel;
+	st.loadingLevel = st.tailLevel;
+}
+
+bool CS3OTextureHandler::EvictLeastRecentlyUsed(int curFrame)
+{
+	StreamedTexture* lruTexture = nullptr;
+
+	for (StreamedTexture& st: streamedTextures) {
+		if (st.texID == 0 || st.pendingLoad.valid() || st.residentLevel >= st.tailLevel || st.lastDrawFrame == curFrame)
+			continue;
+
+		if (lruTexture == nullptr || st.lastDrawFrame < lruTexture->lastDrawFrame)
+			lruTexture = &st;
+	}
+
+	if (lruTexture == nullptr)
+		return false;
+
+	EvictStreamedLevels(*lruTexture);
+	return true;
+}
+#endif
@@ -3,6 +3,9 @@
 #ifndef S3O_TEXTURE_HANDLER_H
 #define S3O_TEXTURE_HANDLER_H
 
+#include <atomic>
+#include <deque>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -27,6 +30,10 @@ public:
 
 		unsigned int tex2SizeX;
 		unsigned int tex2SizeY;
+
+		// indices into streamedTextures, -1 if fully resident
+		int tex1StreamIdx = -1;
+		int tex2StreamIdx = -1;
 	};
 
 	struct CachedS3OTex {
@@ -35,6 +42,7 @@ public:
 		unsigned int ysize;
 		bool invertAxis;
 		bool invertAlpha;
+		int streamIdx;
 	};
 
 	void Init();
@@ -44,6 +52,11 @@ public:
 	void LoadTexture(S3DModel* model);
 	void PreloadTexture(S3DModel* model, bool invertAxis, bool invertAlpha);
 
+	// once per draw frame after the model draw flags were updated
+	void UpdateStreaming();
+	// thread-safe, <pixelSize> is the on-screen diameter of a model using texture-material <num>
+	void RequestTextureSize(unsigned int num, float pixelSize);
+
 public:
 	const S3OTexMat* GetTexture(unsigned int num) {
 		if (num < textures.size())
@@ -62,6 +75,17 @@ private:
 	);
 	unsigned int InsertTextureMat(const S3DModel* model);
 
+#ifndef HEADLESS
+	struct StreamedTexture;
+
+	unsigned int CreateStreamedTexture(const std::string& fileName, const CBitmap& bitmap, int& streamIdx);
+
+	uint32_t GetStreamedBytes(const StreamedTexture& st, uint32_t firstLevel, uint32_t lastLevel) const;
+	void FinishStreamedLoad(StreamedTexture& st);
+	void EvictStreamedLevels(StreamedTexture& st);
+	bool EvictLeastRecentlyUsed(int curFrame);
+#endif
+
 private:
 	typedef spring::unsynced_map<std::string, CachedS3OTex> TextureCache;
 	typedef spring::unsynced_map<std::string, CBitmap> BitmapCache;
@@ -72,6 +96,47 @@ private:
 	BitmapCache bitmapCache;
 
 	std::vector<S3OTexMat> textures;
+
+#ifndef HEADLESS
+	// A DDS texture of which only the mip tail is resident at first; the levels above
+	// it are read from the file on a worker thread once a model using the texture is
+	// drawn large enough to need them, and dropped again when the VRAM budget is hit
+	// (least recently drawn first). GL_TEXTURE_BASE_LEVEL is kept at residentLevel.
+	struct StreamedTexture {
+		std::string fileName;
+
+		unsigned int texID = 0;
+		// largest dimension of level 0
+		uint32_t size = 0;
+
+		// levels [tailLevel, numLevels) are always resident
+		uint32_t numLevels = 0;
+		uint32_t tailLevel = 0;
+		uint32_t residentLevel = 0;
+		uint32_t wantedLevel = 0;
+		uint32_t loadingLevel = 0;
+
+		int lastDrawFrame = -1;
+
+		std::vector<uint32_t> levelBytes;
+
+		// largest on-screen size since the last UpdateStreaming
+		std::atomic<float> requestedSize = {0.0f};
+
+		std::shared_future<nv_dds::CDDSImage> pendingLoad;
+	};
+
+	// stable addresses, StreamedTexture is neither copyable nor movable
+	std::deque<StreamedTexture> streamedTextures;
+
+	// bytes of the resident and loading levels above the mip tails
+	uint64_t streamingBudget = 0;
+	uint64_t streamedBytes = 0;
+	uint64_t pendingBytes = 0;
+	uint32_t numPendingLoads = 0;
+
+	bool textureStreaming = false;
+#endif
 };
 
 extern CS3OTextureHandler textureHandlerS3O;
@@ -0,0 +1,212 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SkylineAtlasAlloc.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <bit>
+
+#include "System/Misc/TracyDefs.h"
+
+inline bool CSkylineAtlasAlloc::CompareTex(const SAtlasEntry* tex1, const SAtlasEntry* tex2)
+{
+	// sort by large to small
+	if (tex1->size.y > tex2->size.y) return true;
+	if (tex2->size.y > tex1->size.y) return false;
+
+	if (tex1->size.x > tex2->size.x) return true;
+	if (tex2->size.x > tex1->size.x) return false;
+
+	// keeps the placement independent of the entry map's iteration order
+	return (tex1->name > tex2->name);
+}
+
+
+bool CSkylineAtlasAlloc::IncreaseSize()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const auto GrowDim = [](int& dim, int maxDim) {
+		if (dim >= maxDim)
+			return false;
+
+		dim = std::min(dim * 2, maxDim);
+		return true;
+	};
+
+	const int oldSizeX = packSize.x;
+
+	// grow the smaller side first, keeps the atlas roughly square
+	const bool grown = (packSize.y < packSize.x)?
+		(GrowDim(packSize.y, maxsize.y) || GrowDim(packSize.x, maxsize.x)):
+		(GrowDim(packSize.x, maxsize.x) || GrowDim(packSize.y, maxsize.y));
+
+	if (packSize.x == oldSizeX)
+		return grown;
+
+	// the new columns are empty
+	if (skyline.back().y == 0) {
+		skyline.back().width += (packSize.x - oldSizeX);
+	} else {
+		skyline.push_back({oldSizeX, 0, packSize.x - oldSizeX});
+	}
+
+	return true;
+}
+
+
+bool CSkylineAtlasAlloc::FindPosition(int w, int h, size_t& bestIdx, int2& bestPos) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	int bestTop = std::numeric_limits<int>::max();
+	int bestWidth = std::numeric_limits<int>::max();
+
+	for (size_t i = 0, n = skyline.size(); i < n; i++) {
+		const int x = skyline[i].x;
+
+		// segments are sorted by x, none further right can fit either
+		if ((x + w) > packSize.x)
+			break;
+
+		// rest on the highest segment below [x, x + w)
+		int y = 0;
+
+		for (size_t j = i, remaining = w; remaining > 0; j++) {
+			y = std::max(y, skyline[j].y);
+			remaining -= std::min<size_t>(remaining, skyline[j].width);
+		}
+
+		if ((y + h) > packSize.y)
+			continue;
+
+		// lowest top edge first, then the tightest segment
+		if ((y + h) > bestTop || ((y + h) == bestTop && skyline[i].width >= bestWidth))
+			continue;
+
+		bestTop = y + h;
+		bestWidth = skyline[i].width;
+		bestIdx = i;
+		bestPos = {x, y};
+	}
+
+	return (bestTop != std::numeric_limits<int>::max());
+}
+
+
+void CSkylineAtlasAlloc::Place(size_t idx, int2 pos, int w, int h)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	skyline.insert(skyline.begin() + idx, {pos.x, pos.y + h, w});
+
+	// cut away what the new segment covers
+	const int newEnd = pos.x + w;
+	size_t last = idx + 1;
+
+	while (last < skyline.size() && (skyline[last].x + skyline[last].width) <= newEnd) {
+		last++;
+	}
+
+	if (last < skyline.size() && skyline[last].x < newEnd) {
+		skyline[last].width -= (newEnd - skyline[last].x);
+		skyline[last].x = newEnd;
+	}
+
+	skyline.erase(skyline.begin() + idx + 1, skyline.begin() + last);
+
+	// merge with neighbours of equal height, the rest of the skyline is unchanged
+	if ((idx + 1) < skyline.size() && skyline[idx + 1].y == skyline[idx].y) {
+		skyline[idx].width += skyline[idx + 1].width;
+		skyline.erase(skyline.begin() + idx + 1);
+	}
+
+	if (idx > 0 && skyline[idx - 1].y == skyline[idx].y) {
+		skyline[idx - 1].width += skyline[idx].width;
+		skyline.erase(skyline.begin() + idx);
+	}
+}
+
+
+bool CSkylineAtlasAlloc::Allocate()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (skyline.empty()) {
+		packSize = {std::min(atlasSize.x, maxsize.x), std::min(atlasSize.y, maxsize.y)};
+		skyline.push_back({0, 0, packSize.x});
+	}
+
+	const int padding = 1 << GetNumTexLevels();
+
+	std::vector<SAtlasEntry*> newEntries;
+	newEntries.reserve(entries.size());
+
+	int64_t neededArea = usedArea;
+
+	for (auto& [name, entry]: entries) {
+		// placed by an earlier call, empty entries are never placed
+		if (entry.texCoords.x2 > 0.0f || entry.size.x <= 0 || entry.size.y <= 0)
+			continue;
+
+		newEntries.push_back(&entry);
+		neededArea += static_cast<int64_t>(entry.size.x + padding) * (entry.size.y + padding);
+	}
+
+	std::sort(newEntries.begin(), newEntries.end(), CSkylineAtlasAlloc::CompareTex);
+
+	// growing up front saves failed searches through a too small atlas
+	while ((static_cast<int64_t>(packSize.x) * packSize.y) < neededArea) {
+		if (!IncreaseSize())
+			break;
+	}
+
+	bool success = true;
+
+	for (SAtlasEntry* curtex: newEntries) {
+		const int w = curtex->size.x + padding;
+		const int h = curtex->size.y + padding;
+
+		size_t idx = 0;
+		int2 pos;
+
+		bool found = false;
+
+		while (!(found = FindPosition(w, h, idx, pos))) {
+			if (!IncreaseSize())
+				break;
+		}
+
+		if (!found) {
+			success = false;
+			continue;
+		}
+
+		Place(idx, pos, w, h);
+		usedArea += static_cast<int64_t>(w) * h;
+
+		curtex->texCoords.x1 = pos.x;
+		curtex->texCoords.y1 = pos.y;
+		curtex->texCoords.x2 = pos.x + curtex->size.x;
+		curtex->texCoords.y2 = pos.y + curtex->size.y;
+	}
+
+	// crop to the used part, which only grows on later calls
+	atlasSize = {0, 0};
+
+	for (const Segment& seg: skyline) {
+		if (seg.y == 0)
+			continue;
+
+		atlasSize.x = std::max(atlasSize.x, seg.x + seg.width);
+		atlasSize.y = std::max(atlasSize.y, seg.y);
+	}
+
+	return success;
+}
+
+int CSkylineAtlasAlloc::GetNumTexLevels() const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	return std::min(
+		std::bit_width(static_cast<uint32_t>(GetMinDim())),
+		numLevels
+	);
+}
@@ -0,0 +1,54 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SKYLINE_ATLAS_ALLOC_H
+#define SKYLINE_ATLAS_ALLOC_H
+
+#include <vector>
+
+#include "IAtlasAllocator.h"
+
+
+/**
+ * Bottom-left skyline packer.
+ *
+ * The free space is kept as the top edge ("skyline") of everything placed so
+ * far; each entry goes where its top edge ends up lowest. Allocate() is
+ * incremental: entries placed by an earlier call keep their position, only new
+ * ones are packed on top and the atlas grows without moving anything, so the
+ * font atlas can add glyphs without a repack. Texcoords are exclusive (x2 - x1
+ * is the width), as with CRowAtlasAlloc.
+ */
+class CSkylineAtlasAlloc : public IAtlasAllocator
+{
+public:
+	CSkylineAtlasAlloc() {
+		atlasSize = {256, 256};
+		numLevels = 1;
+	}
+
+	bool Allocate() override;
+	int GetNumTexLevels() const override;
+	uint32_t GetNumPages() const override { return 1; }
+private:
+	struct Segment {
+		int x;
+		int y;
+		int width;
+	};
+
+private:
+	bool FindPosition(int w, int h, size_t& bestIdx, int2& bestPos) const;
+	void Place(size_t idx, int2 pos, int w, int h);
+	bool IncreaseSize();
+	static bool CompareTex(const SAtlasEntry* tex1, const SAtlasEntry* tex2);
+
+private:
+	// sorted by x and covering [0, packSize.x) without gaps
+	std::vector<Segment> skyline;
+
+	// the area packed into; atlasSize is cropped to the used part of it
+	int2 packSize;
+	int64_t usedArea = 0;
+};
+
+#endif // SKYLINE_ATLAS_ALLOC_H
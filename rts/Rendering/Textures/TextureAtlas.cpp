@@ -7,6 +7,7 @@
 #include "LegacyAtlasAlloc.h"
 #include "QuadtreeAtlasAlloc.h"
 #include "RowAtlasAlloc.h"
+#include "SkylineAtlasAlloc.h"
 #include "MultiPageAtlasAlloc.hpp"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/myGL.h"
@@ -56,6 +57,7 @@ void CTextureAtlas::ReinitAllocator()
 	using MPLegacyAtlasAlloc   = MultiPageAtlasAlloc<CLegacyAtlasAlloc>;
 	using MPQuadtreeAtlasAlloc = MultiPageAtlasAlloc<CQuadtreeAtlasAlloc>;
 	using MPRowAtlasAlloc      = MultiPageAtlasAlloc<CRowAtlasAlloc>;
+	using MPSkylineAtlasAlloc  = MultiPageAtlasAlloc<CSkylineAtlasAlloc>;
 
 	static constexpr uint32_t MAX_TEXTURE_PAGES = 16;
 
@@ -66,6 +68,8 @@ void CTextureAtlas::ReinitAllocator()
 		case ATLAS_ALLOC_MP_LEGACY   : { atlasAllocator = new   MPLegacyAtlasAlloc(MAX_TEXTURE_PAGES); } break;
 		case ATLAS_ALLOC_MP_QUADTREE : { atlasAllocator = new MPQuadtreeAtlasAlloc(MAX_TEXTURE_PAGES); } break;
 		case ATLAS_ALLOC_MP_ROW      : { atlasAllocator = new      MPRowAtlasAlloc(MAX_TEXTURE_PAGES); } break;
+		case ATLAS_ALLOC_SKYLINE     : { atlasAllocator = new   CSkylineAtlasAlloc(                 ); } break;
+		case ATLAS_ALLOC_MP_SKYLINE  : { atlasAllocator = new  MPSkylineAtlasAlloc(MAX_TEXTURE_PAGES); } break;
 		default:                       {                               assert(false); } break;
 	}
 
@@ -118,17 +122,70 @@ size_t CTextureAtlas::AddTexFromFile(std::string texName, const std::string& fil
 		return (it->second);
 	}
 
-	CBitmap bitmap;
-	if (!bitmap.Load(file)) {
-		bitmap.Alloc(2, 2, 4);
-		LOG_L(L_WARNING, "[TexAtlas::%s] could not load texture from file \"%s\"", __func__, file.c_str());
+	// decoded together with all other files in Finalize
+	MemTex& tex = memTextures.emplace_back();
+
+	tex.names.emplace_back(std::move(texName));
+	tex.file = file;
+
+	return (files[lcFile] = memTextures.size() - 1);
+}
+
+void CTextureAtlas::LoadPendingFiles()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<size_t> pendingIndices;
+
+	for (size_t i = 0; i < memTextures.size(); ++i) {
+		if (!memTextures[i].file.empty())
+			pendingIndices.push_back(i);
+	}
+
+	if (pendingIndices.empty())
+		return;
+
+	std::vector<CBitmap> bitmaps(pendingIndices.size());
+	std::vector<CBitmap::LoadRequest> requests(pendingIndices.size());
+
+	for (size_t i = 0; i < pendingIndices.size(); ++i) {
+		requests[i].bitmap = &bitmaps[i];
+		requests[i].fileName = memTextures[pendingIndices[i]].file;
 	}
 
-	// only support RGBA for now
-	if (bitmap.channels != 4 || bitmap.compressed)
-		throw content_error("Unsupported bitmap format in file " + file);
+	CBitmap::LoadBatch(requests);
+
+	for (size_t i = 0; i < pendingIndices.size(); ++i) {
+		MemTex& memTex = memTextures[pendingIndices[i]];
+		CBitmap& bitmap = bitmaps[i];
+
+		if (!requests[i].loaded) {
+			LOG_L(L_WARNING, "[TexAtlas::%s] could not load texture from file \"%s\"", __func__, memTex.file.c_str());
+			bitmap.Alloc(2, 2, 4);
+
+			// make textures that went missing since the last load stand out
+			if (initialized)
+				bitmap.Fill(SColor(1.0f, 0.0f, 0.0f, 1.0f));
+		}
+
+		// only support RGBA for now
+		if (bitmap.channels != 4 || bitmap.compressed) {
+			if (!initialized)
+				throw content_error("Unsupported bitmap format in file " + memTex.file);
+
+			LOG_L(L_WARNING, "[TexAtlas::%s] unsupported bitmap format in file \"%s\"", __func__, memTex.file.c_str());
+			bitmap.Alloc(2, 2, 4);
+		}
+
+		memTex.xsize = bitmap.xsize;
+		memTex.ysize = bitmap.ysize;
+		memTex.texType = RGBA32;
+		memTex.mem.assign(bitmap.GetRawMem(), bitmap.GetRawMem() + bitmap.GetMemSize());
+		memTex.file.clear();
 
-	return (files[lcFile] = AddTexFromMem(std::move(texName), bitmap.xsize, bitmap.ysize, RGBA32, bitmap.GetRawMem()));
+		for (const auto& texName : memTex.names) {
+			atlasAllocator->AddEntry(texName, int2(memTex.xsize, memTex.ysize));
+		}
+	}
 }
 
 
@@ -138,6 +195,8 @@ bool CTextureAtlas::Finalize()
 	if (initialized && !reloadable)
 		return true;
 
+	LoadPendingFiles();
+
 	const bool success = atlasAllocator->Allocate() && (initialized = CreateTexture());
 
 	if (!reloadable) {
@@ -299,24 +358,8 @@ void CTextureAtlas::ReloadTextures()
 	for (const auto& [filename, idx] : files) {
 		assert(idx < memTextures.size());
 		nonFileEntries.erase(idx);
-		auto& memTex = memTextures[idx];
-
-		CBitmap bitmap;
-		if (!bitmap.Load(filename)) {
-			LOG_L(L_WARNING, "[TexAtlas::%s] could not reload texture from file \"%s\"", __func__, filename.c_str());
-			bitmap.Alloc(2, 2, 4);
-			bitmap.Fill(SColor(1.0f, 0.0f, 0.0f, 1.0f));
-		}
-
-		memTex.xsize = bitmap.xsize;
-		memTex.ysize = bitmap.ysize;
-		memTex.texType = RGBA32;
-		memTex.mem.resize(bitmap.GetMemSize(), 0);
-		std::memcpy(memTex.mem.data(), bitmap.GetRawMem(), memTex.mem.size());
-
-		for (const auto& texName : memTex.names) {
-			atlasAllocator->AddEntry(texName, int2(memTex.xsize, memTex.ysize));
-		}
+		// reloaded by Finalize, which also re-adds the entries
+		memTextures[idx].file = filename;
 	}
 
 	for (auto idx : nonFileEntries) {
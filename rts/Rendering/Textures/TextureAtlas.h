@@ -26,7 +26,9 @@ public:
 		ATLAS_ALLOC_ROW         = 2,
 		ATLAS_ALLOC_MP_LEGACY   = 3,
 		ATLAS_ALLOC_MP_QUADTREE = 4,
-		ATLAS_ALLOC_MP_ROW      = 5
+		ATLAS_ALLOC_MP_ROW      = 5,
+		ATLAS_ALLOC_SKYLINE     = 6,
+		ATLAS_ALLOC_MP_SKYLINE  = 7
 	};
 
 public:
@@ -142,6 +144,7 @@ protected:
 		}
 	}
 	bool CreateTexture();
+	void LoadPendingFiles();
 
 protected:
 	uint32_t allocType;
@@ -166,6 +169,7 @@ protected:
 
 			names = std::move(t.names);
 			mem = std::move(t.mem);
+			file = std::move(t.file);
 
 			return *this;
 		}
@@ -178,6 +182,9 @@ protected:
 
 		std::vector<std::string> names;
 		std::vector<uint8_t> mem;
+
+		// set until the file has been loaded into <mem> by LoadPendingFiles
+		std::string file;
 	};
 
 	std::string name;
@@ -5,6 +5,7 @@
 #include "LegacyAtlasAlloc.h"
 #include "QuadtreeAtlasAlloc.h"
 #include "RowAtlasAlloc.h"
+#include "SkylineAtlasAlloc.h"
 #include "MultiPageAtlasAlloc.hpp"
 
 #include "Rendering/GlobalRendering.h"
@@ -71,6 +72,7 @@ CTextureRenderAtlas::CTextureRenderAtlas(
 	using MPLegacyAtlasAlloc = MultiPageAtlasAlloc<CLegacyAtlasAlloc>;
 	using MPQuadtreeAtlasAlloc = MultiPageAtlasAlloc<CQuadtreeAtlasAlloc>;
 	using MPRowAtlasAlloc = MultiPageAtlasAlloc<CRowAtlasAlloc>;
+	using MPSkylineAtlasAlloc = MultiPageAtlasAlloc<CSkylineAtlasAlloc>;
 
 	static constexpr uint32_t MAX_TEXTURE_PAGES = 16;
 
@@ -81,6 +83,8 @@ CTextureRenderAtlas::CTextureRenderAtlas(
 		case CTextureAtlas::ATLAS_ALLOC_MP_LEGACY:   { atlasAllocator = std::make_unique<  MPLegacyAtlasAlloc>(MAX_TEXTURE_PAGES); } break;
 		case CTextureAtlas::ATLAS_ALLOC_MP_QUADTREE: { atlasAllocator = std::make_unique<MPQuadtreeAtlasAlloc>(MAX_TEXTURE_PAGES); } break;
 		case CTextureAtlas::ATLAS_ALLOC_MP_ROW:      { atlasAllocator = std::make_unique<     MPRowAtlasAlloc>(MAX_TEXTURE_PAGES); } break;
+		case CTextureAtlas::ATLAS_ALLOC_SKYLINE:     { atlasAllocator = std::make_unique<  CSkylineAtlasAlloc>(                 ); } break;
+		case CTextureAtlas::ATLAS_ALLOC_MP_SKYLINE:  { atlasAllocator = std::make_unique< MPSkylineAtlasAlloc>(MAX_TEXTURE_PAGES); } break;
 		default:                                     {                                                              assert(false); } break;
 	}
 
@@ -116,7 +120,7 @@ CTextureRenderAtlas::~CTextureRenderAtlas()
 		shaderHandler->ReleaseProgramObjects("[TextureRenderAtlas]");
 
 	for (auto& [_, tID] : nameToTexID) {
-		if (tID) {
+		if (tID && !externalTexIDs.contains(tID)) {
 			glDeleteTextures(1, &tID);
 			tID = 0;
 		}
@@ -195,6 +199,22 @@ bool CTextureRenderAtlas::AddTex(const std::string& name, int xsize, int ysize,
 	return AddTexFromBitmapRaw(name, bm);
 }
 
+bool CTextureRenderAtlas::AddTexFromID(const std::string& name, uint32_t texID, int xsize, int ysize)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (finalized)
+		return false;
+
+	if (texID == 0 || nameToTexID.contains(name))
+		return false;
+
+	atlasAllocator->AddEntry(name, int2{ xsize, ysize });
+	nameToTexID[name] = texID;
+	externalTexIDs.insert(texID);
+
+	return true;
+}
+
 AtlasedTexture CTextureRenderAtlas::GetTexture(const std::string& texName)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -342,10 +362,13 @@ bool CTextureRenderAtlas::Finalize()
 
 					auto texBind = GL::TexBind(GL_TEXTURE_2D, texID);
 
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+					// keep the sampling state of textures we do not own, texels map 1:1 anyway
+					if (!externalTexIDs.contains(texID)) {
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+						glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+					}
 
 					rb.AddQuadTriangles(
 						std::move(posTL),
@@ -368,12 +391,14 @@ bool CTextureRenderAtlas::Finalize()
 		return false;
 
 	for (auto& [_, texID] : nameToTexID) {
-		if (texID) {
+		if (texID && !externalTexIDs.contains(texID))
 			glDeleteTextures(1, &texID);
-			texID = 0;
-		}
+
+		texID = 0;
 	}
 
+	externalTexIDs.clear();
+
 	//DumpTexture();
 
 	return true;
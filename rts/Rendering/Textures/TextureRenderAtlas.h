@@ -10,6 +10,7 @@
 #include "System/type2.h"
 #include "System/Color.h"
 #include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
 
 class CBitmap;
 namespace Shader {
@@ -32,6 +33,8 @@ public:
 	bool AddTexFromFile(const std::string& name, const std::string& file);
 	bool AddTexFromBitmap(const std::string& name, const CBitmap& bm);
 	bool AddTex(const std::string& name, int xsize, int ysize, const SColor& color);
+	// renders an existing texture into the atlas, <texID> stays owned by the caller
+	bool AddTexFromID(const std::string& name, uint32_t texID, int xsize, int ysize);
 
 	AtlasedTexture GetTexture(const std::string& texName);
 	AtlasedTexture GetTexture(const std::string& texName, const std::string& texBackupName);
@@ -53,6 +56,7 @@ private:
 	bool AddTexFromBitmapRaw(const std::string& name, const CBitmap& bm);
 
 	spring::unordered_map<std::string, uint32_t> nameToTexID;
+	spring::unordered_set<uint32_t> externalTexIDs;
 	int atlasSizeX;
 	int atlasSizeY;
 	CTextureAtlas::AllocatorType allocType;
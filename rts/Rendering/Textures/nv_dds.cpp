@@ -857,6 +857,49 @@ bool CDDSImage::upload_texture2D(unsigned int imageIndex, int target) const
     return true;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// uploads a subrange of the levels of a compressed/uncompressed 2D texture,
+// used for streaming in high-resolution levels after the low ones
+bool CDDSImage::upload_texture2D_levels(unsigned int firstLevel, unsigned int lastLevel, int target) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+    assert(m_valid);
+    assert(!m_images.empty());
+    assert(m_type == TextureFlat);
+
+    if (firstLevel > lastLevel || lastLevel > m_images[0].get_num_mipmaps())
+        return false;
+
+    GLint alignment = -1;
+    if (!is_compressed() && !is_dword_aligned())
+    {
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    }
+
+    for (unsigned int level = firstLevel; level <= lastLevel; level++)
+    {
+        const CSurface &surface = get_level(level);
+
+        if (is_compressed())
+        {
+            glCompressedTexImage2DARB(target, level, m_format,
+                surface.get_width(), surface.get_height(), 0,
+                surface.get_size(), surface);
+        }
+        else
+        {
+            glTexImage2D(target, level, m_components, surface.get_width(),
+                surface.get_height(), 0, m_format, GL_UNSIGNED_BYTE, surface);
+        }
+    }
+
+    if (alignment != -1)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, alignment);
+
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // uploads a compressed/uncompressed 3D texture
 bool CDDSImage::upload_texture3D() const
@@ -223,6 +223,8 @@ namespace nv_dds
 
             bool upload_texture1D() const;
             bool upload_texture2D(unsigned int imageIndex, int target) const;
+            // uploads the levels [firstLevel, lastLevel] of a flat image, level 0 is the image itself
+            bool upload_texture2D_levels(unsigned int firstLevel, unsigned int lastLevel, int target) const;
             bool upload_texture3D() const;
             bool upload_textureRectangle() const;
             bool upload_textureCubemap() const;
@@ -284,6 +286,15 @@ namespace nv_dds
                 return m_images[0].get_mipmap(index);
             }
 
+            // level 0 is the image itself, level n the (n-1)-th mipmap
+            inline const CSurface &get_level(unsigned int level) const
+            {
+                if (level == 0)
+                    return m_images[0];
+
+                return get_mipmap(level - 1);
+            }
+
             inline const CTexture &get_cubemap_face(unsigned int face) const
             {
                 assert(m_valid);
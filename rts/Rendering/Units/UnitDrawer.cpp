@@ -2,6 +2,9 @@
 
 #include "UnitDrawer.h"
 
+#include <bit>
+#include <cstring>
+
 #include "Game/Camera.h"
 #include "Game/CameraHandler.h"
 #include "Game/Game.h"
@@ -24,6 +27,7 @@
 #include "Rendering/LuaObjectDrawer.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Textures/Bitmap.h"
+#include "Rendering/Textures/TextureRenderAtlas.h"
 #include "Rendering/Textures/3DOTextureHandler.h"
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "Rendering/Common/ModelDrawerHelpers.h"
@@ -218,7 +222,11 @@ bool CUnitDrawer::ShouldDrawUnitShadow(CUnit* u)
 	if (!u->HasDrawFlag(DrawFlags::SO_SHOPAQ_FLAG))
 		return false;
 
-	if (LuaObjectDrawer::AddShadowMaterialObject(u, LUAOBJ_UNIT))
+	if (!shadowHandler.ShouldDrawShadowCaster(u, !u->beingBuilt, GetLastChangeFrame(u)))
+		return false;
+
+	// Lua materials only run in the regular shadow pass, cascades use the engine shader
+	if (!shadowHandler.InCascadePass() && LuaObjectDrawer::AddShadowMaterialObject(u, LUAOBJ_UNIT))
 		return false;
 
 	if ((u->engineDrawMask & thisPassMask) != thisPassMask)
@@ -242,7 +250,9 @@ CUnitDrawerGLSL::CUnitDrawerGLSL()
 {}
 
 CUnitDrawerGLSL::~CUnitDrawerGLSL()
-{}
+{
+	miniMapIcons.Kill();
+}
 
 void CUnitDrawerGLSL::DrawUnitModel(const CUnit* unit, bool noLuaCall) const
 {
@@ -345,9 +355,85 @@ void CUnitDrawerGLSL::DrawUnitMiniMapIcon(TypedRenderBuffer<VA_TYPE_2DTC>& rb, c
 	);
 }
 
+// calls func(iconScale, pos, color) for each of the units and ghosts of one icon type that show up on the minimap
+template<typename F>
+void CUnitDrawerGLSL::ForEachMiniMapIcon(const std::vector<const CUnit*>& units, const std::vector<const GhostSolidObject*>& ghosts, F&& func) const
+{
+	SColor currentColor;
+	const auto myAllyTeam = gu->myAllyTeam;
+	const auto isFullView = gu->spectatingFullView;
+	const float ghostIconDimming = modelDrawerData->ghostIconDimming;
+
+	for (const CUnit* unit : units) {
+		if (unit->noMinimap)
+			continue;
+		if (unit->myIcon == nullptr)
+			continue;
+		if (!unit->drawIcon)
+			continue;
+		if (unit->IsInVoid())
+			continue;
+
+		if (unit->isSelected) {
+			currentColor = color4::white; // selected color
+		}
+		else {
+			if (minimap->UseSimpleColors()) {
+				if (unit->team == gu->myTeam) {
+					currentColor = minimap->GetMyTeamIconColor();
+				}
+				else if (teamHandler.Ally(myAllyTeam, unit->allyteam)) {
+					currentColor = minimap->GetAllyTeamIconColor();
+				}
+				else {
+					currentColor = minimap->GetEnemyTeamIconColor();
+				}
+			}
+			else {
+				currentColor = teamHandler.Team(unit->team)->color;
+			}
+
+			if (!isFullView && !(unit->losStatus[myAllyTeam] & LOS_INRADAR)) {
+				if (ghostIconDimming == 0.0f)
+					continue;
+
+				currentColor.r *= ghostIconDimming;
+				currentColor.g *= ghostIconDimming;
+				currentColor.b *= ghostIconDimming;
+			}
+		}
+
+		const float iconScale = CUnitDrawerHelper::GetUnitIconScale(unit);
+		const float3& pos = (!isFullView) ?
+			unit->GetObjDrawErrorPos(myAllyTeam) :
+			unit->GetObjDrawMidPos();
+
+		func(iconScale, pos, currentColor);
+	}
+
+	if (isFullView || ghostIconDimming <= 0.0f)
+		return;
+
+	for (const auto& ghost : ghosts) {
+		if (minimap->UseSimpleColors())
+			currentColor = minimap->GetEnemyTeamIconColor();
+		else
+			currentColor = teamHandler.Team(ghost->team)->color;
+
+		currentColor.r *= ghostIconDimming;
+		currentColor.g *= ghostIconDimming;
+		currentColor.b *= ghostIconDimming;
+
+		func(ghost->myIcon->GetSize(), ghost->midPos, currentColor);
+	}
+}
+
 void CUnitDrawerGLSL::DrawUnitMiniMapIcons() const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (DrawUnitMiniMapIconsInstanced())
+		return;
+
 	static auto& rb = RenderBuffer::GetTypedRenderBuffer<VA_TYPE_2DTC>();
 	rb.AssertSubmission();
 
@@ -356,11 +442,6 @@ void CUnitDrawerGLSL::DrawUnitMiniMapIcons() const
 	sh.Enable();
 	sh.SetUniform("alphaCtrl", 0.0f, 1.0f, 0.0f, 0.0f); // GL_GREATER > 0.0
 
-	SColor currentColor;
-	const auto myAllyTeam = gu->myAllyTeam;
-	const auto isFullView = gu->spectatingFullView;
-	const float ghostIconDimming = modelDrawerData->ghostIconDimming;
-
 	if (!minimap->UseUnitIcons())
 		icon::iconHandler.GetDefaultIconData()->BindTexture();
 
@@ -376,78 +457,178 @@ void CUnitDrawerGLSL::DrawUnitMiniMapIcons() const
 		if (minimap->UseUnitIcons())
 			icon->BindTexture();
 
-		for (const CUnit* unit : units) {
-			assert(unit->myIcon == icon);
-			if (unit->noMinimap)
-				continue;
-			if (unit->myIcon == nullptr)
-				continue;
-			if (!unit->drawIcon)
-				continue;
-			if (unit->IsInVoid())
-				continue;
+		ForEachMiniMapIcon(units, ghosts, [&](const float iconScale, const float3& pos, const SColor& color) {
+			DrawUnitMiniMapIcon(rb, iconScale, pos, color);
+		});
 
-			if (unit->isSelected) {
-				currentColor = color4::white; // selected color
-			}
-			else {
-				if (minimap->UseSimpleColors()) {
-					if (unit->team == gu->myTeam) {
-						currentColor = minimap->GetMyTeamIconColor();
-					}
-					else if (teamHandler.Ally(myAllyTeam, unit->allyteam)) {
-						currentColor = minimap->GetAllyTeamIconColor();
-					}
-					else {
-						currentColor = minimap->GetEnemyTeamIconColor();
-					}
-				}
-				else {
-					currentColor = teamHandler.Team(unit->team)->color;
-				}
+		rb.Submit(GL_TRIANGLES);
+	}
 
-				if (!isFullView && !(unit->losStatus[myAllyTeam] & LOS_INRADAR)) {
-					if (ghostIconDimming == 0.0f)
-						continue;
+	sh.SetUniform("alphaCtrl", 0.0f, 0.0f, 0.0f, 1.0f);
+	sh.Disable();
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
 
-					currentColor.r *= ghostIconDimming;
-					currentColor.g *= ghostIconDimming;
-					currentColor.b *= ghostIconDimming;
-				}
-			}
+bool CUnitDrawerGLSL::DrawUnitMiniMapIconsInstanced() const
+{
+	const CTextureRenderAtlas* iconAtlas = icon::iconHandler.GetIconAtlas();
 
-			const float iconScale = CUnitDrawerHelper::GetUnitIconScale(unit);
-			const float3& pos = (!isFullView) ?
-				unit->GetObjDrawErrorPos(myAllyTeam) :
-				unit->GetObjDrawMidPos();
+	if (iconAtlas == nullptr || !miniMapIcons.Init())
+		return false;
+
+	auto& icons = miniMapIcons.icons;
+	icons.clear();
+
+	for (const auto& [icon, objects] : modelDrawerData->GetUnitsByIcon()) {
+		if (icon == nullptr)
+			continue;
+
+		const auto& [units, ghosts] = objects;
+
+		if (units.empty() && ghosts.empty())
+			continue;
+
+		const AtlasedTexture tc = icon::iconHandler.GetIconAtlasTexture(minimap->UseUnitIcons() ? icon : icon::iconHandler.GetDefaultIconData());
 
-			DrawUnitMiniMapIcon(rb, iconScale, pos, currentColor);
+		ForEachMiniMapIcon(units, ghosts, [&](const float iconScale, const float3& pos, const SColor& color) {
+			icons.push_back({float2{pos.x, pos.z}, iconScale, color, float4{tc.x1, tc.y1, tc.x2, tc.y2}});
+		});
+	}
+
+	if (icons.empty())
+		return true;
+
+	miniMapIcons.Upload();
+
+	Shader::IProgramObject* shader = miniMapIcons.shader;
+
+	shader->Enable();
+	shader->SetUniform("iconSize", minimap->GetUnitSizeX(), minimap->GetUnitSizeY());
+	shader->SetUniform("mapSize", mapDims.mapx * SQUARE_SIZE * 1.0f, mapDims.mapy * SQUARE_SIZE * 1.0f);
+	shader->SetUniform("rotation", static_cast<int>(minimap->GetRotationOption()));
+
+	glBindTexture(GL_TEXTURE_2D, iconAtlas->GetTexID());
+
+	miniMapIcons.vao.Bind();
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, miniMapIcons.uploadedIcons.size());
+	miniMapIcons.vao.Unbind();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	shader->Disable();
+
+	return true;
+}
+
+bool CUnitDrawerGLSL::MiniMapIcons::Init()
+{
+	// one per drawer instance
+	static int numShaders = 0;
+
+	if (initialized)
+		return (shader != nullptr && shader->IsValid());
+
+	initialized = true;
+
+	shader = shaderHandler->CreateProgramObject("[UnitDrawer-MiniMapIcons]", IntToString(numShaders++, "MiniMapIcons%i"));
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/MiniMapIconsVertProg.glsl", "", GL_VERTEX_SHADER));
+	shader->AttachShaderObject(shaderHandler->CreateShaderObject("GLSL/MiniMapIconsFragProg.glsl", "", GL_FRAGMENT_SHADER));
+	shader->BindAttribLocation("iconPosScale", 0);
+	shader->BindAttribLocation("iconColor", 1);
+	shader->BindAttribLocation("iconTexCoords", 2);
+	shader->Link();
+
+	shader->Enable();
+	shader->SetUniform("iconTex", 0);
+	shader->Disable();
+	shader->Validate();
+
+	if (!shader->IsValid()) {
+		LOG_L(L_WARNING, "[UnitDrawer::%s] minimap icon shader error, falling back to per-icon quads: %s", __func__, shader->GetLog().c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void CUnitDrawerGLSL::MiniMapIcons::Kill()
+{
+	if (shader != nullptr) {
+		const std::string shaderName = shader->GetName();
+		shaderHandler->ReleaseProgramObject("[UnitDrawer-MiniMapIcons]", shaderName);
+	}
+
+	shader = nullptr;
+	initialized = false;
+
+	icons = {};
+	uploadedIcons = {};
+
+	instVBO = {};
+	vao = {};
+}
+
+void CUnitDrawerGLSL::MiniMapIcons::Upload()
+{
+	static_assert(sizeof(MiniMapIcon) == 32);
+
+	// icons are gathered in a stable order (per icon type, then per unit), so
+	// between frames mostly the moving units differ; only re-upload the runs of
+	// instances that changed, merging runs separated by a few unchanged ones
+	static constexpr size_t MAX_UNCHANGED_RUN = 32;
+
+	const size_t numIcons = icons.size();
+
+	instVBO.Bind(GL_ARRAY_BUFFER);
+
+	if (instVBO.GetSize() < numIcons * sizeof(MiniMapIcon)) {
+		instVBO.New(std::bit_ceil(numIcons) * sizeof(MiniMapIcon), GL_DYNAMIC_DRAW);
+		uploadedIcons.clear();
+
+		vao.Bind();
+		instVBO.Bind(GL_ARRAY_BUFFER);
+
+		for (GLuint i = 0; i < 3; ++i) {
+			glEnableVertexAttribArray(i);
+			glVertexAttribDivisor(i, 1);
 		}
 
-		if (!isFullView && ghostIconDimming > 0.0f) {
-			for (const auto& ghost : ghosts) {
-				if (minimap->UseSimpleColors())
-					currentColor = minimap->GetEnemyTeamIconColor();
-				else
-					currentColor = teamHandler.Team(ghost->team)->color;
+		// pos and scale are read as one vec3
+		glVertexAttribPointer(0, 3, GL_FLOAT        , false, sizeof(MiniMapIcon), VA_TYPE_OFFSET(MiniMapIcon, pos      ));
+		glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true , sizeof(MiniMapIcon), VA_TYPE_OFFSET(MiniMapIcon, color    ));
+		glVertexAttribPointer(2, 4, GL_FLOAT        , false, sizeof(MiniMapIcon), VA_TYPE_OFFSET(MiniMapIcon, texCoords));
 
-				currentColor.r *= ghostIconDimming;
-				currentColor.g *= ghostIconDimming;
-				currentColor.b *= ghostIconDimming;
+		vao.Unbind();
 
-				const float iconScale = ghost->myIcon->GetSize();
-				const float3& pos = ghost->midPos;
+		for (GLuint i = 0; i < 3; ++i) {
+			glDisableVertexAttribArray(i);
+			glVertexAttribDivisor(i, 0);
+		}
+	}
 
-				DrawUnitMiniMapIcon(rb, iconScale, pos, currentColor);
-			}
+	const auto IsChanged = [&](size_t i) {
+		return (i >= uploadedIcons.size() || std::memcmp(&icons[i], &uploadedIcons[i], sizeof(MiniMapIcon)) != 0);
+	};
+
+	for (size_t i = 0; i < numIcons; ) {
+		if (!IsChanged(i)) {
+			++i;
+			continue;
 		}
 
-		rb.Submit(GL_TRIANGLES);
+		size_t j = i + 1;
+
+		for (size_t k = j; k < numIcons && (k - j) < MAX_UNCHANGED_RUN; ++k) {
+			if (IsChanged(k))
+				j = k + 1;
+		}
+
+		instVBO.SetBufferSubData(i * sizeof(MiniMapIcon), (j - i) * sizeof(MiniMapIcon), &icons[i]);
+		i = j;
 	}
 
-	sh.SetUniform("alphaCtrl", 0.0f, 0.0f, 0.0f, 1.0f);
-	sh.Disable();
-	glBindTexture(GL_TEXTURE_2D, 0);
+	instVBO.Unbind();
+
+	std::swap(icons, uploadedIcons);
 }
 
 float CUnitDrawerGLSL::DrawUnitIcon(TypedRenderBuffer<VA_TYPE_TC>& rb, const icon::CIconData* icon, const float iconRadius, float3 pos, const uint8_t* color, const float unitRadius) const
@@ -788,25 +969,22 @@ void CUnitDrawerGLSL::DrawAlphaObjectsAux(int modelType) const
 void CUnitDrawerGLSL::DrawGhostedBuildings(int modelType) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const auto& deadGhostedBuildings = modelDrawerData->GetDeadGhostBuildings(gu->myAllyTeam, modelType);
 	const auto& liveGhostedBuildings = modelDrawerData->GetLiveGhostBuildings(gu->myAllyTeam, modelType);
 
 	glColor4f(0.6f, 0.6f, 0.6f, IModelDrawerState::alphaValues.y);
 
 	// buildings that died while ghosted
-	for (GhostSolidObject* dgb : deadGhostedBuildings) {
-		if (camera->InView(dgb->pos, dgb->GetModel()->GetDrawRadius())) {
-			glPushMatrix();
-			glTranslatef3(dgb->pos);
-			glRotatef(dgb->facing * 90.0f, 0, 1, 0);
+	modelDrawerData->ForEachDeadGhostInView(camera, gu->myAllyTeam, modelType, [this, modelType](const GhostSolidObject* dgb) {
+		glPushMatrix();
+		glTranslatef3(dgb->pos);
+		glRotatef(dgb->facing * 90.0f, 0, 1, 0);
 
-			CModelDrawerHelper::BindModelTypeTexture(modelType, dgb->GetModel()->textureType);
-			SetTeamColor(dgb->team, IModelDrawerState::alphaValues.y);
+		CModelDrawerHelper::BindModelTypeTexture(modelType, dgb->GetModel()->textureType);
+		SetTeamColor(dgb->team, IModelDrawerState::alphaValues.y);
 
-			dgb->GetModel()->DrawStatic();
-			glPopMatrix();
-		}
-	}
+		dgb->GetModel()->DrawStatic();
+		glPopMatrix();
+	});
 
 	for (CUnit* lgb : liveGhostedBuildings) {
 		DrawAlphaUnit(lgb, modelType, DrawFlags::SO_ALPHAF_FLAG, true);
@@ -1322,6 +1500,7 @@ bool CUnitDrawerGLSL::ShowUnitBuildSquare(const BuildInfo& buildInfo, const std:
 
 	uint64_t hashKey = spring::LiteHash(pos);
 	hashKey = spring::hash_combine(spring::LiteHash(buildInfo.buildFacing), hashKey);
+	hashKey = spring::hash_combine(spring::LiteHash(buildInfo.def->id), hashKey);
 	/*
 	for (const auto& cmd : commands) {
 		const BuildInfo bc(cmd);
@@ -1669,43 +1848,58 @@ void CUnitDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, bool d
 	if (gu->spectatingFullView)
 		return;
 
-	const auto& deadGhostBuildings = modelDrawerData->GetDeadGhostBuildings(gu->myAllyTeam, modelType);
-
-	const auto oldMM = modelDrawerState->SetMatrixMode(ShaderMatrixModes::STATIC_MATMODE);
-	// deadGhostedBuildings
-	{
-		modelDrawerState->SetColorMultiplier(0.6f, 0.6f, 0.6f, IModelDrawerState::alphaValues.y);
-		modelDrawerState->SetTeamColor(0, IModelDrawerState::alphaValues.y); //teamID doesn't matter here
+	struct GhostInstance {
+		const S3DModel* model;
+		int team;
+		Transform worldTra;
+	};
 
-		int prevModelType = -1;
-		int prevTexType = -1;
-		for (const auto* dgb : deadGhostBuildings) {
-			if (!camera->InView(dgb->pos, dgb->GetModel()->GetDrawRadius()))
-				continue;
+	static std::vector<GhostInstance> ghostInstances;
+	static std::vector<GhostInstance> radarGhostInstances;
 
-			static CMatrix44f staticWorldMat;
+	// ghosts never move, so they go batched per texture with per-instance placements
+	const auto SubmitGhosts = [&smv, modelType](std::vector<GhostInstance>& ghosts) {
+		std::sort(ghosts.begin(), ghosts.end(), [](const GhostInstance& a, const GhostInstance& b) {
+			return (a.model->textureType < b.model->textureType);
+		});
 
-			staticWorldMat.LoadIdentity();
-			staticWorldMat.Translate(dgb->pos);
+		for (size_t i = 0, n = ghosts.size(); i < n; ) {
+			const int texType = ghosts[i].model->textureType;
 
-			staticWorldMat.RotateY(-dgb->facing * math::DEG_TO_RAD * 90.0f);
+			CModelDrawerHelper::BindModelTypeTexture(modelType, texType);
 
-			if (prevModelType != modelType || prevTexType != dgb->GetModel()->textureType) {
-				prevModelType = modelType; prevTexType = dgb->GetModel()->textureType;
-				CModelDrawerHelper::BindModelTypeTexture(modelType, dgb->GetModel()->textureType); //inefficient rendering, but w/e
+			for (; i < n && ghosts[i].model->textureType == texType; ++i) {
+				smv.AddToSubmission(ghosts[i].model, ghosts[i].team, DrawFlags::SO_ALPHAF_FLAG, ghosts[i].worldTra);
 			}
 
-			modelDrawerState->SetStaticModelMatrix(staticWorldMat);
-			smv.SubmitImmediately(dgb->GetModel(), dgb->team, DrawFlags::SO_ALPHAF_FLAG); //need to submit immediately every model because of static per-model matrix
+			smv.Submit(GL_TRIANGLES, false);
 		}
+
+		ghosts.clear();
+	};
+
+	const auto oldMM = modelDrawerState->SetMatrixMode(ShaderMatrixModes::ARRAY_MATMODE);
+	// deadGhostedBuildings
+	{
+		modelDrawerData->ForEachDeadGhostInView(camera, gu->myAllyTeam, modelType, [](const GhostSolidObject* dgb) {
+			CMatrix44f staticWorldMat;
+
+			staticWorldMat.Translate(dgb->pos);
+			staticWorldMat.RotateY(-dgb->facing * math::DEG_TO_RAD * 90.0f);
+
+			ghostInstances.push_back({ dgb->GetModel(), dgb->team, Transform::FromMatrix(staticWorldMat) });
+		});
+
+		modelDrawerState->SetColorMultiplier(0.6f, 0.6f, 0.6f, IModelDrawerState::alphaValues.y);
+		modelDrawerState->SetTeamColor(0, IModelDrawerState::alphaValues.y); //teamID doesn't matter here
+
+		SubmitGhosts(ghostInstances);
 	}
 
 	// liveGhostedBuildings
 	{
 		const auto& liveGhostedBuildings = modelDrawerData->GetLiveGhostBuildings(gu->myAllyTeam, modelType);
 
-		int prevModelType = -1;
-		int prevTexType = -1;
 		for (const auto* lgb : liveGhostedBuildings) {
 			if (!camera->InView(lgb->pos, lgb->model->GetDrawRadius()))
 				continue;
@@ -1725,33 +1919,27 @@ void CUnitDrawerGL4::DrawAlphaObjects(int modelType, bool drawReflection, bool d
 			if (model->type != modelType)
 				continue;
 
-			static CMatrix44f staticWorldMat;
+			CMatrix44f staticWorldMat;
 
-			staticWorldMat.LoadIdentity();
 			staticWorldMat.Translate(lgb->pos);
-
 			staticWorldMat.RotateY(-lgb->buildFacing * math::DEG_TO_RAD * 90.0f);
 
 			const unsigned short losStatus = lgb->losStatus[gu->myAllyTeam];
 
 			// ghosted enemy units
-			if (losStatus & LOS_CONTRADAR) {
-				modelDrawerState->SetColorMultiplier(0.9f, 0.9f, 0.9f, IModelDrawerState::alphaValues.z);
-				modelDrawerState->SetTeamColor(lgb->team, IModelDrawerState::alphaValues.z);
-			}
-			else {
-				modelDrawerState->SetColorMultiplier(0.6f, 0.6f, 0.6f, IModelDrawerState::alphaValues.y);
-				modelDrawerState->SetTeamColor(lgb->team, IModelDrawerState::alphaValues.y);
-			}
+			auto& instances = (losStatus & LOS_CONTRADAR)? radarGhostInstances: ghostInstances;
+			instances.push_back({ model, lgb->team, Transform::FromMatrix(staticWorldMat) });
+		}
 
-			if (prevModelType != modelType || prevTexType != model->textureType) {
-				prevModelType = modelType; prevTexType = model->textureType;
-				CModelDrawerHelper::BindModelTypeTexture(modelType, model->textureType); //inefficient rendering, but w/e
-			}
+		modelDrawerState->SetColorMultiplier(0.9f, 0.9f, 0.9f, IModelDrawerState::alphaValues.z);
+		modelDrawerState->SetTeamColor(0, IModelDrawerState::alphaValues.z); //teamID comes from the instance data
 
-			modelDrawerState->SetStaticModelMatrix(staticWorldMat);
-			smv.SubmitImmediately(model, lgb->team, DrawFlags::SO_ALPHAF_FLAG); //need to submit immediately every model because of static per-model matrix
-		}
+		SubmitGhosts(radarGhostInstances);
+
+		modelDrawerState->SetColorMultiplier(0.6f, 0.6f, 0.6f, IModelDrawerState::alphaValues.y);
+		modelDrawerState->SetTeamColor(0, IModelDrawerState::alphaValues.y);
+
+		SubmitGhosts(ghostInstances);
 	}
 
 	modelDrawerState->SetColorMultiplier(IModelDrawerState::alphaValues.x);
@@ -8,7 +8,11 @@
 #include "Rendering/Common/ModelDrawerState.hpp"
 #include "Rendering/Units/UnitDrawerData.h"
 #include "Rendering/GL/LightHandler.h"
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
 #include "Game/UI/CursorIcons.h"
+#include "System/Color.h"
+#include "System/float4.h"
 #include "System/type2.h"
 #include "Sim/Units/CommandAI/Command.h"
 
@@ -52,6 +56,9 @@ public:
 	static void AddTempDrawUnit(const CUnitDrawerData::TempDrawUnit& tempDrawUnit) { modelDrawerData->AddTempDrawUnit(tempDrawUnit); }
 
 	static const std::vector<CUnit*>& GetUnsortedUnits() { return modelDrawerData->GetUnsortedObjects(); }
+	static bool FindUnitsInScreenRect(const CCamera* cam, float l, float t, float r, float b, std::vector<CUnit*>& units) {
+		return (modelDrawerData != nullptr && modelDrawerData->FindUnitsInScreenRect(cam, l, t, r, b, units));
+	}
 
 	static void ClearPreviousDrawFlags() { modelDrawerData->ClearPreviousDrawFlags(); }
 	static void UnitLeavesGhostChanged(const CUnit* unit, const bool leaveDeadGhost) { modelDrawerData->UnitLeavesGhostChanged(unit, leaveDeadGhost); }
@@ -190,8 +197,36 @@ protected:
 	void PopIndividualAlphaState(const S3DModel* model, int teamID, bool deferredPass) const;
 
 	void DrawUnitMiniMapIcon(TypedRenderBuffer<VA_TYPE_2DTC>& rb, const float iconScale, const float3& pos, const SColor& color) const;
+	bool DrawUnitMiniMapIconsInstanced() const;
+	template<typename F> void ForEachMiniMapIcon(const std::vector<const CUnit*>& units, const std::vector<const GhostSolidObject*>& ghosts, F&& func) const;
 	float DrawUnitIcon(TypedRenderBuffer<VA_TYPE_TC>& rb, const icon::CIconData* icon, const float iconRadius, float3 pos, const uint8_t* color, const float unitRadius) const;
 	void DrawUnitIconScreen(TypedRenderBuffer<VA_TYPE_2DTC>& rb, const icon::CIconData* icon, const float3 pos, SColor& color, const float unitRadius, bool isIcon) const;
+private:
+	struct MiniMapIcon {
+		float2 pos; // world xz
+		float scale;
+		SColor color;
+		float4 texCoords; // icon atlas x1, y1, x2, y2
+	};
+
+	// minimap icons drawn as one instanced call from the icon atlas
+	struct MiniMapIcons {
+		bool Init();
+		void Kill();
+		void Upload();
+
+		std::vector<MiniMapIcon> icons;
+		// what the instance buffer currently holds
+		std::vector<MiniMapIcon> uploadedIcons;
+
+		VBO instVBO;
+		VAO vao;
+
+		Shader::IProgramObject* shader = nullptr;
+		bool initialized = false;
+	};
+
+	mutable MiniMapIcons miniMapIcons;
 };
 
 //TODO remove CUnitDrawerLegacy inheritance
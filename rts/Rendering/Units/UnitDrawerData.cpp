@@ -71,6 +71,14 @@ CR_REG_METADATA(CUnitDrawerData::TempDrawUnit, (
 	CR_IGNORED(unitDef)
 ))
 
+CR_BIND(CUnitDrawerData::DeadGhostCell, )
+CR_REG_METADATA(CUnitDrawerData::DeadGhostCell, (
+	CR_MEMBER(mins),
+	CR_MEMBER(maxs),
+	CR_MEMBER(ghosts),
+	CR_MEMBER(spheres)
+))
+
 CR_BIND(CUnitDrawerData::SavedData, )
 CR_REG_METADATA(CUnitDrawerData::SavedData, (
 	CR_MEMBER(tempOpaqueUnits),
@@ -131,8 +139,17 @@ CUnitDrawerData::CUnitDrawerData(bool& mtModelDrawer_)
 	unitDefImages.clear();
 	unitDefImages.resize(unitDefHandler->NumUnitDefs() + 1);
 
+	ghostGridSize[0] = (mapDims.mapx * SQUARE_SIZE + GHOST_CELL_SIZE - 1) / GHOST_CELL_SIZE;
+	ghostGridSize[1] = (mapDims.mapy * SQUARE_SIZE + GHOST_CELL_SIZE - 1) / GHOST_CELL_SIZE;
+
 	savedData.deadGhostBuildings.resize(teamHandler.ActiveAllyTeams());
 	savedData.liveGhostBuildings.resize(teamHandler.ActiveAllyTeams());
+
+	for (auto& cells: savedData.deadGhostBuildings) {
+		cells.resize(ghostGridSize[0] * ghostGridSize[1]);
+	}
+
+	ghostSweepCells.resize(teamHandler.ActiveAllyTeams(), 0);
 }
 
 CUnitDrawerData::~CUnitDrawerData()
@@ -147,23 +164,23 @@ CUnitDrawerData::~CUnitDrawerData()
 	}
 
 	for (int allyTeam = 0; allyTeam < savedData.deadGhostBuildings.size(); ++allyTeam) {
-		for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_CNT; modelType++) {
-			auto& lgb = savedData.liveGhostBuildings[allyTeam][modelType];
-			auto& dgb = savedData.deadGhostBuildings[allyTeam][modelType];
-
-			for (auto it = dgb.begin(); it != dgb.end(); ++it) {
-				GhostSolidObject* gso = *it;
-
-				if (gso->DecRef())
-					continue;
-
-				// <ghost> might be the gbOwner of a decal; groundDecals is deleted after us
-				groundDecals->GhostDestroyed(gso);
-				ghostMemPool.free(gso);
+		for (DeadGhostCell& cell: savedData.deadGhostBuildings[allyTeam]) {
+			for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_CNT; modelType++) {
+				for (GhostSolidObject* gso: cell.ghosts[modelType]) {
+					if (gso->DecRef())
+						continue;
+
+					// <ghost> might be the gbOwner of a decal; groundDecals is deleted after us
+					groundDecals->GhostDestroyed(gso);
+					ghostMemPool.free(gso);
+				}
 			}
+		}
 
-			dgb.clear();
-			lgb.clear();
+		savedData.deadGhostBuildings[allyTeam].clear();
+
+		for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_CNT; modelType++) {
+			savedData.liveGhostBuildings[allyTeam][modelType].clear();
 		}
 	}
 
@@ -217,6 +234,8 @@ void CUnitDrawerData::Update()
 			updateBody(unit);
 	}
 
+	UpdateScreenPositions();
+
 	if ((useDistToGroundForIcons = (camHandler->GetCurrentController()).GetUseDistToGroundForIcons())) {
 		const float3& camPos = camera->GetPos();
 		// use the height at the current camera position
@@ -229,26 +248,190 @@ void CUnitDrawerData::Update()
 	}
 }
 
+void CUnitDrawerData::UpdateScreenPositions()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const CCamera* playerCam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+
+	screenViewProjMat = playerCam->GetViewProjectionMatrix();
+	screenViewSize[0] = playerCam->viewport[2];
+	screenViewSize[1] = playerCam->viewport[3];
+	screenGridSize[0] = std::max(1, (screenViewSize[0] + SCREEN_GRID_CELL_SIZE - 1) / SCREEN_GRID_CELL_SIZE);
+	screenGridSize[1] = std::max(1, (screenViewSize[1] + SCREEN_GRID_CELL_SIZE - 1) / SCREEN_GRID_CELL_SIZE);
+
+	screenPositions.resize(unsortedObjects.size());
+
+	const auto projectBody = [this, playerCam](const int k) {
+		screenPositions[k] = {unsortedObjects[k], playerCam->CalcViewPortCoordinates(unsortedObjects[k]->drawPos)};
+	};
+
+	if (mtModelDrawer) {
+		for_mt_chunk(0, unsortedObjects.size(), projectBody, CModelDrawerDataConcept::MT_CHUNK_OR_MIN_CHUNK_SIZE_UPDT);
+	} else {
+		for (int k = 0, n = unsortedObjects.size(); k < n; k++)
+			projectBody(k);
+	}
+
+	// counting sort into cells; anything behind the camera or past the far plane can never match
+	const size_t numCells = screenGridSize[0] * screenGridSize[1];
+	const auto GetCell = [this](const float3& vpPos) -> int {
+		if (vpPos.z < 0.0f || vpPos.z > 1.0f)
+			return -2;
+		if (vpPos.x < 0.0f || vpPos.x > screenViewSize[0] || vpPos.y < 0.0f || vpPos.y > screenViewSize[1])
+			return -1;
+
+		const int cx = std::min(static_cast<int>(vpPos.x) / SCREEN_GRID_CELL_SIZE, screenGridSize[0] - 1);
+		const int cy = std::min(static_cast<int>(vpPos.y) / SCREEN_GRID_CELL_SIZE, screenGridSize[1] - 1);
+		return (cy * screenGridSize[0] + cx);
+	};
+
+	screenGridOffsets.clear();
+	screenGridOffsets.resize(numCells + 1, 0);
+	offscreenUnits.clear();
+
+	for (const UnitScreenPos& sp: screenPositions) {
+		const int cell = GetCell(sp.vpPos);
+
+		if (cell >= 0)
+			screenGridOffsets[cell + 1]++;
+	}
+	for (size_t i = 1; i <= numCells; i++) {
+		screenGridOffsets[i] += screenGridOffsets[i - 1];
+	}
+
+	screenGridUnits.resize(screenGridOffsets[numCells]);
+
+	// reuse screenGridOffsets[c] as insertion cursor for cell c, shifted back below
+	for (uint32_t k = 0, n = screenPositions.size(); k < n; k++) {
+		const int cell = GetCell(screenPositions[k].vpPos);
+
+		if (cell >= 0) {
+			screenGridUnits[screenGridOffsets[cell]++] = k;
+			continue;
+		}
+		if (cell == -1)
+			offscreenUnits.push_back(k);
+	}
+	for (size_t i = numCells; i > 0; i--) {
+		screenGridOffsets[i] = screenGridOffsets[i - 1];
+	}
+
+	screenGridOffsets[0] = 0;
+	screenPositionsValid = true;
+}
+
+bool CUnitDrawerData::FindUnitsInScreenRect(const CCamera* cam, float l, float t, float r, float b, std::vector<CUnit*>& units) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// another camera is active (e.g. during minimap or shadow passes) or the view changed since Update
+	if (cam->viewport[2] != screenViewSize[0] || cam->viewport[3] != screenViewSize[1])
+		return false;
+	if (!(cam->GetViewProjectionMatrix() == screenViewProjMat))
+		return false;
+	if (!screenPositionsValid)
+		return false;
+
+	const auto InRect = [&](const float3& vpPos) {
+		return (vpPos.x >= l && vpPos.x <= r && vpPos.y >= t && vpPos.y <= b);
+	};
+
+	if (l < 0.0f || t < 0.0f || r > screenViewSize[0] || b > screenViewSize[1]) {
+		for (const uint32_t k: offscreenUnits) {
+			if (InRect(screenPositions[k].vpPos))
+				units.push_back(screenPositions[k].unit);
+		}
+	}
+
+	if (r < 0.0f || b < 0.0f || l > screenViewSize[0] || t > screenViewSize[1])
+		return true;
+
+	const int cx0 = std::clamp(static_cast<int>(std::max(l, 0.0f)) / SCREEN_GRID_CELL_SIZE, 0, screenGridSize[0] - 1);
+	const int cx1 = std::clamp(static_cast<int>(std::max(r, 0.0f)) / SCREEN_GRID_CELL_SIZE, 0, screenGridSize[0] - 1);
+	const int cy0 = std::clamp(static_cast<int>(std::max(t, 0.0f)) / SCREEN_GRID_CELL_SIZE, 0, screenGridSize[1] - 1);
+	const int cy1 = std::clamp(static_cast<int>(std::max(b, 0.0f)) / SCREEN_GRID_CELL_SIZE, 0, screenGridSize[1] - 1);
+
+	for (int cy = cy0; cy <= cy1; cy++) {
+		for (int cx = cx0; cx <= cx1; cx++) {
+			const int cell = cy * screenGridSize[0] + cx;
+
+			for (uint32_t i = screenGridOffsets[cell], n = screenGridOffsets[cell + 1]; i < n; i++) {
+				const UnitScreenPos& sp = screenPositions[screenGridUnits[i]];
+
+				if (InRect(sp.vpPos))
+					units.push_back(sp.unit);
+			}
+		}
+	}
+
+	return true;
+}
+
 void CUnitDrawerData::UpdateGhostedBuildings()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	for (int allyTeam = 0; allyTeam < savedData.deadGhostBuildings.size(); ++allyTeam) {
-		for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_CNT; modelType++) {
-			auto& dgb = savedData.deadGhostBuildings[allyTeam][modelType];
+	const CCamera* playerCam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
 
-			for (int i = 0; i < dgb.size(); /*no-op*/) {
-				GhostSolidObject* gso = dgb[i];
+	const uint32_t numCells = ghostGridSize[0] * ghostGridSize[1];
+	const uint32_t numSweepCells = (numCells + GHOST_SWEEP_FRAMES - 1) / GHOST_SWEEP_FRAMES;
 
-				if (!losHandler->InLos(gso->pos, allyTeam)) {
-					++i;
+	for (int allyTeam = 0; allyTeam < savedData.deadGhostBuildings.size(); ++allyTeam) {
+		auto& cells = savedData.deadGhostBuildings[allyTeam];
+		uint32_t& sweepCell = ghostSweepCells[allyTeam];
+
+		// ghosts the player can see vanish as soon as LOS is regained, all
+		// others (and those of other allyteams) within GHOST_SWEEP_FRAMES calls
+		if (allyTeam == gu->myAllyTeam) {
+			for (DeadGhostCell& cell: cells) {
+				if (cell.Empty() || !playerCam->InView(cell.mins, cell.maxs))
 					continue;
-				}
 
-				// obtained LOS on the ghost of a dead building
-				RemoveDeadGhost(gso, dgb, i); // swaps element with last so counter shouldn't be increased.
+				UpdateDeadGhostCell(cell, allyTeam);
+			}
+		}
+
+		for (uint32_t i = 0; i < numSweepCells; i++) {
+			UpdateDeadGhostCell(cells[sweepCell], allyTeam);
+			sweepCell = (sweepCell + 1) % numCells;
+		}
+	}
+}
+
+void CUnitDrawerData::UpdateDeadGhostCell(DeadGhostCell& cell, int allyTeam)
+{
+	if (cell.Empty())
+		return;
+
+	bool empty = true;
+
+	for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_CNT; modelType++) {
+		const auto& spheres = cell.spheres[modelType];
+
+		for (size_t i = 0; i < spheres.size(); /*no-op*/) {
+			if (!losHandler->InLos(spheres[i], allyTeam)) {
+				++i;
+				continue;
 			}
+
+			// obtained LOS on the ghost of a dead building
+			RemoveDeadGhost(cell, modelType, i); // swaps element with last so counter shouldn't be increased.
 		}
+
+		empty &= spheres.empty();
 	}
+
+	if (!empty)
+		return;
+
+	cell.mins = { std::numeric_limits<float>::max()};
+	cell.maxs = {-std::numeric_limits<float>::max()};
+}
+
+int CUnitDrawerData::GetGhostCellIndex(const float3& pos) const
+{
+	const int x = std::clamp(static_cast<int>(pos.x / GHOST_CELL_SIZE), 0, ghostGridSize[0] - 1);
+	const int z = std::clamp(static_cast<int>(pos.z / GHOST_CELL_SIZE), 0, ghostGridSize[1] - 1);
+
+	return (z * ghostGridSize[0] + x);
 }
 
 const icon::CIconData* CUnitDrawerData::GetUnitIcon(const CUnit* unit)
@@ -432,6 +615,8 @@ void CUnitDrawerData::UpdateObjectDrawFlags(CSolidObject* o) const
 			case CCamera::CAMTYPE_PLAYER: {
 				const float sqrCamDist = (u->drawPos - cam->GetPos()).SqLength();
 
+				CModelDrawerHelper::RequestObjectTextureSize(u, math::sqrt(sqrCamDist), cam);
+
 				if (!IsAlpha(u)) {
 					u->SetDrawFlag(DrawFlags::SO_OPAQUE_FLAG);
 				}
@@ -583,6 +768,8 @@ void CUnitDrawerData::RenderUnitPreCreated(const CUnit* unit)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	UpdateObject(unit, true);
+
+	screenPositionsValid = false;
 }
 
 void CUnitDrawerData::RenderUnitCreated(const CUnit* unit, int cloaked)
@@ -641,8 +828,7 @@ bool CUnitDrawerData::UpdateUnitGhosts(const CUnit* unit, const bool addNewGhost
 
 			// <gso> can be inserted for multiple allyteams
 			// (the ref-counter saves us come deletion time)
-			savedData.deadGhostBuildings[allyTeam][gsoModel->type].push_back(gso);
-			gso->IncRef();
+			AddDeadGhost(gso, allyTeam, gsoModel->type);
 
 			if (allyTeam == gu->myAllyTeam) {
 				unitsByIcon[u->myIcon].second.push_back(gso);
@@ -668,6 +854,9 @@ void CUnitDrawerData::RenderUnitDestroyed(const CUnit* unit)
 	DelObject(unit, true);
 	UpdateUnitIcon(unit, false, true);
 
+	// the cache would hold a dangling pointer until the next Update
+	screenPositionsValid = false;
+
 	LuaObjectDrawer::SetObjectLOD(u, LUAOBJ_UNIT, 0);
 }
 
@@ -734,15 +923,37 @@ void CUnitDrawerData::ReviewPrevLos(const CUnit* unit)
 	}
 }
 
-void CUnitDrawerData::RemoveDeadGhost(GhostSolidObject* gso, std::vector<GhostSolidObject*>& dgb, int index)
+void CUnitDrawerData::AddDeadGhost(GhostSolidObject* gso, int allyTeam, int modelType)
+{
+	DeadGhostCell& cell = savedData.deadGhostBuildings[allyTeam][GetGhostCellIndex(gso->pos)];
+	const float drawRadius = gso->GetModel()->GetDrawRadius();
+
+	cell.ghosts[modelType].push_back(gso);
+	cell.spheres[modelType].emplace_back(gso->pos, drawRadius);
+
+	cell.mins = float3::min(cell.mins, gso->pos - drawRadius);
+	cell.maxs = float3::max(cell.maxs, gso->pos + drawRadius);
+
+	gso->IncRef();
+}
+
+void CUnitDrawerData::RemoveDeadGhost(DeadGhostCell& cell, int modelType, size_t index)
 {
+	auto& ghosts = cell.ghosts[modelType];
+	auto& spheres = cell.spheres[modelType];
+
+	GhostSolidObject* gso = ghosts[index];
+
 	if (!gso->DecRef()) {
 		spring::VectorErase(unitsByIcon[gso->myIcon].second, const_cast<const GhostSolidObject*>(gso));
 		groundDecals->GhostDestroyed(gso);
 		ghostMemPool.free(gso);
 	}
-	dgb[index] = dgb.back();
-	dgb.pop_back();
+
+	ghosts[index] = ghosts.back();
+	ghosts.pop_back();
+	spheres[index] = spheres.back();
+	spheres.pop_back();
 }
 
 void CUnitDrawerData::PlayerChanged(int playerNum)
@@ -761,9 +972,11 @@ void CUnitDrawerData::PlayerChanged(int playerNum)
 		UpdateUnitIcon(unit, true, false);
 	}
 
-	for (auto& ghosts : savedData.deadGhostBuildings[gu->myAllyTeam]) {
-		for (auto ghost : ghosts) {
-			unitsByIcon[ghost->myIcon].second.push_back(ghost);
+	for (const DeadGhostCell& cell : savedData.deadGhostBuildings[gu->myAllyTeam]) {
+		for (const auto& ghosts : cell.ghosts) {
+			for (auto ghost : ghosts) {
+				unitsByIcon[ghost->myIcon].second.push_back(ghost);
+			}
 		}
 	}
 
@@ -1,12 +1,17 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 #pragma once
 
+#include <limits>
+
 #include "System/float3.h"
+#include "System/float4.h"
+#include "System/Matrix44f.h"
 #include "Rendering/Common/ModelDrawerData.h"
 #include "Rendering/UnitDefImage.h"
 #include "Game/GlobalUnsynced.h"
 
 struct S3DModel;
+class CCamera;
 class CUnitDrawer;
 struct UnitDef;
 
@@ -86,6 +91,20 @@ public:
 	private:
 		mutable const UnitDef* unitDef;
 	};
+	/// dead ghosts of one allyteam within a GHOST_CELL_SIZE square of the map
+	struct DeadGhostCell {
+		CR_DECLARE_STRUCT(DeadGhostCell)
+
+		/// grows to enclose every ghost added since the cell was last empty
+		float3 mins = { std::numeric_limits<float>::max()};
+		float3 maxs = {-std::numeric_limits<float>::max()};
+
+		std::array<std::vector<GhostSolidObject*>, MODELTYPE_CNT> ghosts;
+		/// pos and model draw radius of ghosts[i], for culling without touching the ghost
+		std::array<std::vector<float4>, MODELTYPE_CNT> spheres;
+
+		bool Empty() const { return (maxs.x < mins.x); }
+	};
 	struct SavedData {
 		CR_DECLARE_STRUCT(SavedData)
 
@@ -93,8 +112,8 @@ public:
 		std::array< std::vector<TempDrawUnit>, MODELTYPE_CNT> tempOpaqueUnits;
 		std::array< std::vector<TempDrawUnit>, MODELTYPE_CNT> tempAlphaUnits;
 
-		/// buildings that were in LOS_PREVLOS when they died and not in LOS since
-		std::vector<std::array<std::vector<GhostSolidObject*>, MODELTYPE_CNT>> deadGhostBuildings;
+		/// buildings that were in LOS_PREVLOS when they died and not in LOS since, [allyTeam][cell]
+		std::vector<std::vector<DeadGhostCell>> deadGhostBuildings;
 
 		/// buildings that left LOS but are still alive
 		std::vector<std::array<std::vector<CUnit*>, MODELTYPE_CNT>> liveGhostBuildings;
@@ -135,9 +154,25 @@ public:
 	const std::vector<TempDrawUnit>& GetTempOpaqueDrawUnits(int modelType) const { return savedData.tempOpaqueUnits[modelType]; }
 	const std::vector<TempDrawUnit>& GetTempAlphaDrawUnits(int modelType) const { return  savedData.tempAlphaUnits[modelType]; }
 
-	const std::vector<GhostSolidObject*>& GetDeadGhostBuildings(int allyTeam, int modelType) const {
-		assert((unsigned)gu->myAllyTeam < savedData.deadGhostBuildings.size());
-		return savedData.deadGhostBuildings[allyTeam][modelType];
+	/// Calls func(const GhostSolidObject*) for every dead ghost of <modelType> seen by <allyTeam>
+	/// whose model sphere is in view of <cam>; cells entirely outside the frustum are skipped.
+	template<typename Func>
+	void ForEachDeadGhostInView(const CCamera* cam, int allyTeam, int modelType, Func&& func) const {
+		assert((unsigned)allyTeam < savedData.deadGhostBuildings.size());
+
+		for (const DeadGhostCell& cell: savedData.deadGhostBuildings[allyTeam]) {
+			const auto& spheres = cell.spheres[modelType];
+
+			if (spheres.empty() || !cam->InView(cell.mins, cell.maxs))
+				continue;
+
+			for (size_t i = 0, n = spheres.size(); i < n; i++) {
+				if (!cam->InView(spheres[i], spheres[i].w))
+					continue;
+
+				func(const_cast<const GhostSolidObject*>(cell.ghosts[modelType][i]));
+			}
+		}
 	}
 	const std::vector<CUnit*           >& GetLiveGhostBuildings(int allyTeam, int modelType) const {
 		assert((unsigned)gu->myAllyTeam < savedData.liveGhostBuildings.size());
@@ -148,6 +183,11 @@ public:
 	const auto* GetSavedData() const { return &savedData; }
 
 	const spring::unsynced_map<icon::CIconData*, std::pair<std::vector<const CUnit*>, std::vector<const GhostSolidObject*> > >& GetUnitsByIcon() const { return unitsByIcon; }
+
+	/// Appends the units whose drawPos projects (as by CCamera::CalcViewPortCoordinates)
+	/// into [l,r]x[t,b] with depth in [0,1], from the per-frame screen position cache.
+	/// Returns false when the cache is stale or was not built for cam's current view.
+	bool FindUnitsInScreenRect(const CCamera* cam, float l, float t, float r, float b, std::vector<CUnit*>& units) const;
 protected:
 	void UpdateObjectDrawFlags(CSolidObject* o) const override;
 private:
@@ -159,6 +199,7 @@ private:
 	void UpdateUnitIconState(CUnit* unit);
 	void UpdateUnitIconStateScreen(CUnit* unit);
 	static void UpdateDrawPos(CUnit* unit);
+	void UpdateScreenPositions();
 
 	/// Returns true if the given unit should be drawn as icon in the current frame.
 	bool DrawAsIconByDistance(const CUnit* unit, const float sqUnitCamDist) const;
@@ -189,7 +230,13 @@ private:
 	std::vector<UnitDefImage> unitDefImages;
 
 	S3DModel* GetUnitModel(const CUnit* unit) const;
-	void RemoveDeadGhost(GhostSolidObject* gso, std::vector<GhostSolidObject*>& dgb, int index);
+
+	void AddDeadGhost(GhostSolidObject* gso, int allyTeam, int modelType);
+	void RemoveDeadGhost(DeadGhostCell& cell, int modelType, size_t index);
+	/// drops the ghosts in <cell> that <allyTeam> has regained LOS on
+	void UpdateDeadGhostCell(DeadGhostCell& cell, int allyTeam);
+
+	int GetGhostCellIndex(const float3& pos) const;
 
 
 	// icons
@@ -200,4 +247,35 @@ private:
 
 	// IconsAsUI
 	static constexpr float iconSizeMult = 0.005f; // 1/200
+
+	// screen-space positions of unsortedObjects as seen by the player camera,
+	// bucketed into SCREEN_GRID_CELL_SIZE pixel cells for rectangle queries
+	struct UnitScreenPos {
+		CUnit* unit;
+		float3 vpPos;
+	};
+
+	std::vector<UnitScreenPos> screenPositions;
+	/// per-cell offsets into screenGridUnits, numCells + 1 entries
+	std::vector<uint32_t> screenGridOffsets;
+	/// indices into screenPositions; units in front of the camera but outside the viewport go to offscreenUnits
+	std::vector<uint32_t> screenGridUnits;
+	std::vector<uint32_t> offscreenUnits;
+
+	CMatrix44f screenViewProjMat;
+	int screenViewSize[2] = {0, 0};
+	int screenGridSize[2] = {0, 0};
+	/// cleared when units are added or removed between two Update's
+	bool screenPositionsValid = false;
+
+	static constexpr int SCREEN_GRID_CELL_SIZE = 64;
+
+	// dead ghosts are bucketed per GHOST_CELL_SIZE elmos; LOS on cells outside the
+	// player view is re-checked over GHOST_SWEEP_FRAMES calls of UpdateGhostedBuildings
+	static constexpr int GHOST_CELL_SIZE = SQUARE_SIZE * 64;
+	static constexpr int GHOST_SWEEP_FRAMES = 8;
+
+	int ghostGridSize[2] = {0, 0};
+	/// per-allyteam cell of the next incremental LOS sweep
+	std::vector<uint32_t> ghostSweepCells;
 };
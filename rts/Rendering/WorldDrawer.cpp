@@ -27,9 +27,11 @@
 #include "Rendering/SmoothHeightMeshDrawer.h"
 #include "Rendering/InMapDrawView.h"
 #include "Rendering/ShadowHandler.h"
+#include "Rendering/GL/GPUTimer.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
 #include "Rendering/Models/IModelParser.h"
 #include "Rendering/Models/3DModelVAO.h"
+#include "Rendering/Models/ModelGPUCuller.h"
 #include "Rendering/Models/ModelsLock.h"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Textures/ColorMap.h"
@@ -128,6 +130,7 @@ void CWorldDrawer::InitPost() const
 	}
 	{
 		DepthBufferCopy::Init();
+		ModelGPUCuller::Init();
 	}
 	{
 		IGroundDecalDrawer::Init();
@@ -158,13 +161,11 @@ void CWorldDrawer::InitPost() const
 		modelLoader.DrainPreloadFutures(0);
 		auto& mv = S3DModelVAO::GetInstance();
 		if (preloadMode) {
-			{
-				auto lock = CLoadLock::GetUniqueLock();
-				mv.UploadVBOs();
-			}
+			modelLoader.UploadModels();
 			mv.SetSafeToDeleteVectors();
 			modelLoader.LogErrors();
-			CModelsLock::SetThreadSafety(false); //all models are already preloaded
+			// stays thread-safe, anything missed can still be
+			// preloaded by workers during the game (see PreloadModel)
 		}
 	}
 }
@@ -193,10 +194,14 @@ void CWorldDrawer::Kill()
 
 	readMap->KillGroundDrawer();
 	IGroundDecalDrawer::FreeInstance();
+	ModelGPUCuller::Kill();
 	DepthBufferCopy::Kill();
 	LuaObjectDrawer::Kill();
 	SmoothHeightMeshDrawer::FreeInstance();
 
+	commandDrawer->Kill();
+	lineDrawer.Kill();
+
 	numUpdates = 0;
 }
 
@@ -220,6 +225,7 @@ void CWorldDrawer::Update(bool newSimFrame)
 	// lineDrawer.UpdateLineStipple();
 	CUnitDrawer::UpdateStatic();
 	CFeatureDrawer::UpdateStatic();
+	textureHandlerS3O.UpdateStreaming();
 	projectileDrawer->UpdateDrawFlags();
 
 	if (newSimFrame) {
@@ -247,6 +253,7 @@ void CWorldDrawer::GenerateIBLTextures() const
 
 	if (shadowHandler.ShadowsLoaded()) {
 		SCOPED_TIMER("Draw::World::CreateShadows");
+		SCOPED_GPU_TIMER("Draw::World::CreateShadows");
 		SCOPED_GL_DEBUGGROUP("Draw::World::CreateShadows");
 
 		game->SetDrawMode(CGame::gameShadowDraw);
@@ -298,6 +305,7 @@ void CWorldDrawer::ResetMVPMatrices() const
 void CWorldDrawer::Draw() const
 {
 	SCOPED_TIMER("Draw::World");
+	SCOPED_GPU_TIMER("Draw::World");
 	SCOPED_GL_DEBUGGROUP("Draw::World");
 
 	const auto& sky = ISky::GetSky();
@@ -315,6 +323,7 @@ void CWorldDrawer::Draw() const
 	DrawAlphaObjects();
 	{
 		SCOPED_TIMER("Draw::World::DrawWorld");
+		SCOPED_GPU_TIMER("Draw::World::DrawWorld");
 		SCOPED_GL_DEBUGGROUP("Draw::World::DrawWorld");
 		eventHandler.DrawWorld();
 	}
@@ -334,9 +343,13 @@ void CWorldDrawer::DrawOpaqueObjects() const
 	if (globalRendering->drawGround) {
 		{
 			SCOPED_TIMER("Draw::World::Terrain");
+			SCOPED_GPU_TIMER("Draw::World::Terrain");
 			SCOPED_GL_DEBUGGROUP("Draw::World::Terrain");
 			gd->Draw(DrawPass::Normal);
 			depthBufferCopy->MakeDepthBufferCopy();
+
+			if (ModelGPUCuller::IsValid())
+				ModelGPUCuller::GetInstance().BuildDepthPyramid(camera);
 		}
 		{
 			eventHandler.DrawPreDecals();
@@ -364,6 +377,7 @@ void CWorldDrawer::DrawOpaqueObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Opaque");
+		SCOPED_GPU_TIMER("Draw::World::Models::Opaque");
 		SCOPED_GL_DEBUGGROUP("Draw::World::Models::Opaque");
 		unitDrawer->Draw(false);
 		featureDrawer->Draw(false);
@@ -395,6 +409,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GPU_TIMER("Draw::World::Models::Alpha");
 		SCOPED_GL_DEBUGGROUP("Draw::World::Models::Alpha");
 		// clip in model-space
 		if (hasWaterRendering) {
@@ -411,6 +426,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 	}
 	{
 		SCOPED_TIMER("Draw::World::Particles");
+		SCOPED_GPU_TIMER("Draw::World::Particles");
 		SCOPED_GL_DEBUGGROUP("Draw::World::Particles");
 		projectileDrawer->DrawAlpha(!hasWaterRendering, true, false, false);
 
@@ -424,6 +440,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 	// draw water (in-between)
 	{
 		SCOPED_TIMER("Draw::World::Water");
+		SCOPED_GPU_TIMER("Draw::World::Water");
 		SCOPED_GL_DEBUGGROUP("Draw::World::Water");
 
 		const auto& water = IWater::GetWater();
@@ -437,6 +454,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GPU_TIMER("Draw::World::Models::Alpha");
 		SCOPED_GL_DEBUGGROUP("Draw::World::Alpha");
 		glPushMatrix();
 		glLoadIdentity();
@@ -450,6 +468,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 	}
 	{
 		SCOPED_TIMER("Draw::World::Particles");
+		SCOPED_GPU_TIMER("Draw::World::Particles");
 		SCOPED_GL_DEBUGGROUP("Draw::World::Particles");
 		projectileDrawer->DrawAlpha(true, false, false, false);
 
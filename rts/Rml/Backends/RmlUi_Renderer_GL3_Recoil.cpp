@@ -29,6 +29,9 @@
  */
 
 #include "RmlUi_Renderer_GL3_Recoil.h"
+
+#include <cstring>
+
 #include <RmlUi/Core/Log.h>
 
 #include "Rendering/GL/VAO.h"
@@ -39,6 +42,7 @@
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Textures/Bitmap.h"
 #include "System/Log/ILog.h"
+#include "System/SpringHash.h"
 #include "RmlUi/Core/Mesh.h"
 #include "RmlUi/Core/Colour.h"
 #include "RmlUi/Core/MeshUtilities.h"
@@ -472,8 +476,54 @@ struct CompiledGeometryData
 	std::unique_ptr<VBO> vbo;
 	std::unique_ptr<VBO> ibo;
 	GLsizei num_indices = 0;
+
+	// CPU copies, merged into batches and compared against recompiled geometry
+	Rml::Vector<Rml::Vertex> vertices;
+	Rml::Vector<int> indices;
+
+	uint32_t hash = 0;
+	uint32_t release_frame = 0;
 };
 
+static CompiledGeometryData* CreateGeometryData(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices, GLenum usage)
+{
+	auto vao = std::make_unique<VAO>();
+	auto vbo = std::make_unique<VBO>(GL_ARRAY_BUFFER);
+	auto ibo = std::make_unique<VBO>(GL_ELEMENT_ARRAY_BUFFER);
+
+	vao->Generate();
+	vbo->Generate();
+	ibo->Generate();
+
+	vao->Bind();
+
+	vbo->Bind();
+	vbo->New(vertices.size() * sizeof(Rml::Vertex), usage, vertices.data());
+
+	for (const AttributeDef& def: VA_TYPE_RML_VERTEX::attributeDefs) {
+		glEnableVertexAttribArray(def.index);
+		glVertexAttribPointer(def.index, def.count, def.type, def.normalize, def.stride, def.data);
+	}
+
+	ibo->Bind();
+	ibo->New(indices.size() * sizeof(int), usage, indices.data());
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	return new CompiledGeometryData{
+		std::move(vao), std::move(vbo), std::move(ibo), (GLsizei) indices.size()
+	};
+}
+
+static uint32_t HashGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices)
+{
+	uint32_t hash = 0;
+	hash = spring::LiteHash(vertices.data(), vertices.size() * sizeof(Rml::Vertex), hash);
+	hash = spring::LiteHash(indices.data(), indices.size() * sizeof(int), hash);
+	return hash;
+}
+
 struct FramebufferData
 {
 	int width, height;
@@ -671,6 +721,7 @@ RenderInterface_GL3_Recoil::RenderInterface_GL3_Recoil()
 		Rml::Mesh mesh;
 		Rml::MeshUtilities::GenerateQuad(mesh, Rml::Vector2f(-1), Rml::Vector2f(2), {});
 		fullscreen_quad_geometry = RenderInterface_GL3_Recoil::CompileGeometry(mesh.vertices, mesh.indices);
+		batch_geometry = Gfx::CreateGeometryData({}, {}, GL_STREAM_DRAW);
 	}
 }
 
@@ -681,6 +732,17 @@ RenderInterface_GL3_Recoil::~RenderInterface_GL3_Recoil()
 		fullscreen_quad_geometry = {};
 	}
 
+	if (batch_geometry != nullptr) {
+		DeleteGeometry(batch_geometry);
+		batch_geometry = nullptr;
+	}
+
+	for (const auto& [hash, geometry]: released_geometry) {
+		DeleteGeometry(geometry);
+	}
+
+	released_geometry.clear();
+
 	if (program_data) {
 		shaderHandler->ReleaseProgramObjects("[Rml RenderInterface]");
 		program_data.reset();
@@ -773,11 +835,25 @@ void RenderInterface_GL3_Recoil::BeginFrame()
 	program_transform_dirty.set();
 	scissor_state = Rml::Rectanglei::MakeInvalid();
 
+	frame_index += 1;
+
 	Gfx::CheckGLError("BeginFrame");
 }
 
 void RenderInterface_GL3_Recoil::EndFrame()
 {
+	FlushBatch();
+
+	for (auto it = released_geometry.begin(); it != released_geometry.end(); ) {
+		if ((frame_index - it->second->release_frame) <= MaxReleasedGeometryAge) {
+			++it;
+			continue;
+		}
+
+		DeleteGeometry(it->second);
+		it = released_geometry.erase(it);
+	}
+
 	const Gfx::FramebufferData& fb_active = render_layers.GetTopLayer();
 	const Gfx::FramebufferData& fb_postprocess = render_layers.GetPostprocessPrimary();
 
@@ -863,6 +939,8 @@ void RenderInterface_GL3_Recoil::EndFrame()
 
 void RenderInterface_GL3_Recoil::Clear()
 {
+	FlushBatch();
+
 	glClearColor(0, 0, 0, 1);
 	glClear(GL_COLOR_BUFFER_BIT);
 }
@@ -870,36 +948,86 @@ void RenderInterface_GL3_Recoil::Clear()
 Rml::CompiledGeometryHandle
 RenderInterface_GL3_Recoil::CompileGeometry(Rml::Span<const Rml::Vertex> vertices, Rml::Span<const int> indices)
 {
-	auto vao = std::make_unique<VAO>();
-	auto vbo = std::make_unique<VBO>(GL_ARRAY_BUFFER);
-	auto ibo = std::make_unique<VBO>(GL_ELEMENT_ARRAY_BUFFER);
+	const uint32_t hash = Gfx::HashGeometry(vertices, indices);
 
-	vao->Generate();
-	vbo->Generate();
-	ibo->Generate();
+	// reuse the buffers of identical geometry released recently
+	for (auto [it, end] = released_geometry.equal_range(hash); it != end; ++it) {
+		Gfx::CompiledGeometryData* geometry = it->second;
 
-	vao->Bind();
+		if (geometry->vertices.size() != vertices.size() || geometry->indices.size() != indices.size())
+			continue;
+		if (std::memcmp(geometry->vertices.data(), vertices.data(), vertices.size() * sizeof(Rml::Vertex)) != 0)
+			continue;
+		if (std::memcmp(geometry->indices.data(), indices.data(), indices.size() * sizeof(int)) != 0)
+			continue;
 
-	vbo->Bind();
-	vbo->New(vertices.size() * sizeof(Rml::Vertex), GL_STATIC_DRAW, vertices.data());
+		released_geometry.erase(it);
+		return (Rml::CompiledGeometryHandle) geometry;
+	}
 
-	for (const AttributeDef& def: Gfx::VA_TYPE_RML_VERTEX::attributeDefs) {
-		glEnableVertexAttribArray(def.index);
-		glVertexAttribPointer(def.index, def.count, def.type, def.normalize, def.stride, def.data);
+	Gfx::CompiledGeometryData* geometry = Gfx::CreateGeometryData(vertices, indices, GL_STATIC_DRAW);
+
+	geometry->vertices.assign(vertices.begin(), vertices.end());
+	geometry->indices.assign(indices.begin(), indices.end());
+	geometry->hash = hash;
+
+	return (Rml::CompiledGeometryHandle) geometry;
+}
+
+void RenderInterface_GL3_Recoil::RenderGeometry(Rml::CompiledGeometryHandle handle, Rml::Vector2f translation,
+												Rml::TextureHandle texture)
+{
+	const auto* geometry = (const Gfx::CompiledGeometryData*) handle;
+
+	const bool special_texture = (texture == TexturePostprocess || texture == TextureEnableWithoutBinding);
+
+	if (special_texture || batch_geometry == nullptr || geometry->vertices.size() > MaxBatchedGeometryVertices) {
+		FlushBatch();
+		DrawGeometry(handle, translation, texture);
+		return;
 	}
 
-	ibo->Bind();
-	ibo->New(indices.size() * sizeof(int), GL_STATIC_DRAW, indices.data());
+	if (texture != batch.texture)
+		FlushBatch();
 
-	glBindVertexArray(0);
+	const int base_vertex = (int) batch.vertices.size();
+
+	batch.texture = texture;
+	batch.vertices.reserve(batch.vertices.size() + geometry->vertices.size());
+	batch.indices.reserve(batch.indices.size() + geometry->indices.size());
+
+	for (Rml::Vertex vertex: geometry->vertices) {
+		vertex.position += translation;
+		batch.vertices.push_back(vertex);
+	}
+	for (const int index: geometry->indices) {
+		batch.indices.push_back(base_vertex + index);
+	}
+}
+
+void RenderInterface_GL3_Recoil::FlushBatch()
+{
+	if (batch.indices.empty())
+		return;
+
+	batch_geometry->vao->Bind();
+	batch_geometry->vbo->Bind();
+	batch_geometry->vbo->New(batch.vertices.size() * sizeof(Rml::Vertex), GL_STREAM_DRAW, batch.vertices.data());
+	// element array binding is VAO state, so this keeps the VAO pointing at it
+	batch_geometry->ibo->Bind();
+	batch_geometry->ibo->New(batch.indices.size() * sizeof(int), GL_STREAM_DRAW, batch.indices.data());
+	batch_geometry->vao->Unbind();
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	return (Rml::CompiledGeometryHandle) new Gfx::CompiledGeometryData{
-		std::move(vao), std::move(vbo), std::move(ibo), (GLsizei) indices.size()
-	};
+	batch_geometry->num_indices = (GLsizei) batch.indices.size();
+
+	batch.vertices.clear();
+	batch.indices.clear();
+
+	DrawGeometry((Rml::CompiledGeometryHandle) batch_geometry, {}, batch.texture);
 }
 
-void RenderInterface_GL3_Recoil::RenderGeometry(Rml::CompiledGeometryHandle handle, Rml::Vector2f translation,
+void RenderInterface_GL3_Recoil::DrawGeometry(Rml::CompiledGeometryHandle handle, Rml::Vector2f translation,
 												Rml::TextureHandle texture)
 {
 	auto* geometry = (Gfx::CompiledGeometryData*) handle;
@@ -933,6 +1061,12 @@ void RenderInterface_GL3_Recoil::ReleaseGeometry(Rml::CompiledGeometryHandle han
 {
 	auto geometry = (Gfx::CompiledGeometryData*) handle;
 
+	geometry->release_frame = frame_index;
+	released_geometry.emplace(geometry->hash, geometry);
+}
+
+void RenderInterface_GL3_Recoil::DeleteGeometry(Gfx::CompiledGeometryData* geometry)
+{
 	geometry->vao->Delete();
 	geometry->vbo->Release();
 	geometry->ibo->Release();
@@ -954,6 +1088,13 @@ static Rml::Rectanglei VerticallyFlipped(Rml::Rectanglei rect, int viewport_heig
 
 void RenderInterface_GL3_Recoil::SetScissor(Rml::Rectanglei region, bool vertically_flip)
 {
+	if (region.Valid() && vertically_flip)
+		region = VerticallyFlipped(region, viewport_height);
+
+	// elements commonly re-set the scissor region they share
+	if (region.Valid() != scissor_state.Valid() || (region.Valid() && region != scissor_state))
+		FlushBatch();
+
 	if (region.Valid() != scissor_state.Valid()) {
 		if (region.Valid())
 			glEnable(GL_SCISSOR_TEST);
@@ -961,9 +1102,6 @@ void RenderInterface_GL3_Recoil::SetScissor(Rml::Rectanglei region, bool vertica
 			glDisable(GL_SCISSOR_TEST);
 	}
 
-	if (region.Valid() && vertically_flip)
-		region = VerticallyFlipped(region, viewport_height);
-
 	if (region.Valid() && region != scissor_state) {
 		// Some render APIs don't like offscreen positions (WebGL in particular), so clamp them to the viewport.
 		const int x = Rml::Math::Clamp(region.Left(), 0, viewport_width);
@@ -990,6 +1128,8 @@ void RenderInterface_GL3_Recoil::SetScissorRegion(Rml::Rectanglei region)
 
 void RenderInterface_GL3_Recoil::EnableClipMask(bool enable)
 {
+	FlushBatch();
+
 	if (enable)
 		glEnable(GL_STENCIL_TEST);
 	else
@@ -1000,6 +1140,8 @@ void
 RenderInterface_GL3_Recoil::RenderToClipMask(Rml::ClipMaskOperation operation, Rml::CompiledGeometryHandle geometry,
 											 Rml::Vector2f translation)
 {
+	FlushBatch();
+
 	RMLUI_ASSERT(glIsEnabled(GL_STENCIL_TEST))
 	using Rml::ClipMaskOperation;
 
@@ -1033,7 +1175,7 @@ RenderInterface_GL3_Recoil::RenderToClipMask(Rml::ClipMaskOperation operation, R
 			break;
 	}
 
-	RenderGeometry(geometry, translation, {});
+	DrawGeometry(geometry, translation, {});
 
 	// Restore state
 	// @performance Cache state so we don't toggle it unnecessarily.
@@ -1080,7 +1222,7 @@ RenderInterface_GL3_Recoil::GenerateTexture(Rml::Span<const Rml::byte> source_da
 
 void RenderInterface_GL3_Recoil::DrawFullscreenQuad()
 {
-	RenderGeometry(fullscreen_quad_geometry, {}, RenderInterface_GL3_Recoil::TexturePostprocess);
+	DrawGeometry(fullscreen_quad_geometry, {}, RenderInterface_GL3_Recoil::TexturePostprocess);
 }
 
 void RenderInterface_GL3_Recoil::DrawFullscreenQuad(Rml::Vector2f uv_offset, Rml::Vector2f uv_scaling)
@@ -1092,7 +1234,7 @@ void RenderInterface_GL3_Recoil::DrawFullscreenQuad(Rml::Vector2f uv_offset, Rml
 			vertex.tex_coord = (vertex.tex_coord * uv_scaling) + uv_offset;
 	}
 	const Rml::CompiledGeometryHandle geometry = CompileGeometry(mesh.vertices, mesh.indices);
-	RenderGeometry(geometry, {}, RenderInterface_GL3_Recoil::TexturePostprocess);
+	DrawGeometry(geometry, {}, RenderInterface_GL3_Recoil::TexturePostprocess);
 	ReleaseGeometry(geometry);
 }
 
@@ -1264,12 +1406,21 @@ void RenderInterface_GL3_Recoil::RenderBlur(float sigma, const Gfx::FramebufferD
 
 void RenderInterface_GL3_Recoil::ReleaseTexture(Rml::TextureHandle texture_handle)
 {
+	FlushBatch();
+
 	glDeleteTextures(1, (GLuint*) &texture_handle);
 }
 
 void RenderInterface_GL3_Recoil::SetTransform(const Rml::Matrix4f* new_transform)
 {
-	transform = (new_transform ? (projection * (*new_transform)) : projection);
+	const Rml::Matrix4f new_matrix = (new_transform ? (projection * (*new_transform)) : projection);
+
+	if (new_matrix == transform)
+		return;
+
+	FlushBatch();
+
+	transform = new_matrix;
 	program_transform_dirty.set();
 }
 
@@ -1479,6 +1630,8 @@ void RenderInterface_GL3_Recoil::RenderShader(Rml::CompiledShaderHandle shader_h
 											  Rml::CompiledGeometryHandle geometry_handle,
 											  Rml::Vector2f translation, Rml::TextureHandle /*texture*/)
 {
+	FlushBatch();
+
 	RMLUI_ASSERT(shader_handle && geometry_handle)
 	const CompiledShader& shader = *reinterpret_cast<CompiledShader*>(shader_handle);
 	const CompiledShaderType type = shader.type;
@@ -1660,6 +1813,8 @@ void RenderInterface_GL3_Recoil::RenderFilters(Rml::Span<const Rml::CompiledFilt
 
 Rml::LayerHandle RenderInterface_GL3_Recoil::PushLayer()
 {
+	FlushBatch();
+
 	const Rml::LayerHandle layer_handle = render_layers.PushLayer();
 
 	glBindFramebuffer(GL_FRAMEBUFFER, render_layers.GetLayer(layer_handle).framebuffer);
@@ -1672,6 +1827,8 @@ void RenderInterface_GL3_Recoil::CompositeLayers(Rml::LayerHandle source_handle,
 												 Rml::BlendMode blend_mode,
 												 Rml::Span<const Rml::CompiledFilterHandle> filters)
 {
+	FlushBatch();
+
 	using Rml::BlendMode;
 
 	// Blit source layer to postprocessing buffer. Do this regardless of whether we actually have any filters to be
@@ -1704,12 +1861,16 @@ void RenderInterface_GL3_Recoil::CompositeLayers(Rml::LayerHandle source_handle,
 
 void RenderInterface_GL3_Recoil::PopLayer()
 {
+	FlushBatch();
+
 	render_layers.PopLayer();
 	glBindFramebuffer(GL_FRAMEBUFFER, render_layers.GetTopLayer().framebuffer);
 }
 
 Rml::TextureHandle RenderInterface_GL3_Recoil::SaveLayerAsTexture()
 {
+	FlushBatch();
+
 	RMLUI_ASSERT(scissor_state.Valid());
 	const Rml::Rectanglei bounds = scissor_state;
 
@@ -1750,6 +1911,8 @@ Rml::TextureHandle RenderInterface_GL3_Recoil::SaveLayerAsTexture()
 
 Rml::CompiledFilterHandle RenderInterface_GL3_Recoil::SaveLayerAsMaskImage()
 {
+	FlushBatch();
+
 	BlitLayerToPostprocessPrimary(render_layers.GetTopLayerHandle());
 
 	const Gfx::FramebufferData& source = render_layers.GetPostprocessPrimary();
@@ -36,6 +36,7 @@
 #include <RmlUi/Core/RenderInterface.h>
 #include <RmlUi/Core/Types.h>
 #include <bitset>
+#include <unordered_map>
 
 enum class ProgramId;
 enum class UniformId;
@@ -43,6 +44,7 @@ enum class UniformId;
 namespace Gfx {
 	struct ProgramData;
 	struct FramebufferData;
+	struct CompiledGeometryData;
 }
 
 namespace Shader
@@ -111,6 +113,10 @@ public:
 	static constexpr Rml::TextureHandle TexturePostprocess = Rml::TextureHandle(-2);
 
 private:
+	void DrawGeometry(Rml::CompiledGeometryHandle handle, Rml::Vector2f translation, Rml::TextureHandle texture);
+	void FlushBatch();
+	void DeleteGeometry(Gfx::CompiledGeometryData* geometry);
+
 	Shader::IProgramObject* UseProgram(ProgramId program_id);
 	int GetUniformLocation(const char* name) const;
 	void SubmitTransformUniform(Rml::Vector2f translation);
@@ -141,6 +147,24 @@ private:
 
 	Rml::UniquePtr<const Gfx::ProgramData> program_data;
 
+	// geometry up to this size is merged into the pending batch instead of drawn on its own
+	static constexpr size_t MaxBatchedGeometryVertices = 1024;
+	// frames released geometry is kept around to be picked up by an identical CompileGeometry
+	static constexpr uint32_t MaxReleasedGeometryAge = 60;
+
+	// consecutive RenderGeometry calls with the same texture, translations pre-applied
+	struct GeometryBatch {
+		Rml::Vector<Rml::Vertex> vertices;
+		Rml::Vector<int> indices;
+		Rml::TextureHandle texture = {};
+	};
+	GeometryBatch batch;
+	Gfx::CompiledGeometryData* batch_geometry = nullptr;
+
+	// released geometry by content hash; text and decorators are often recompiled unchanged
+	std::unordered_multimap<uint32_t, Gfx::CompiledGeometryData*> released_geometry;
+	uint32_t frame_index = 0;
+
 	/*
 	    Manages render targets, including the layer stack and postprocessing framebuffers.
 
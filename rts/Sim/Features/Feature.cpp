@@ -51,6 +51,7 @@ CR_REG_METADATA(CFeature, (
 	CR_MEMBER(lastReclaimFrame),
 	CR_MEMBER(fireTime),
 	CR_MEMBER(smokeTime),
+	CR_MEMBER(settledFrames),
 
 	CR_MEMBER(def),
 	CR_MEMBER(udef),
@@ -212,6 +213,9 @@ void CFeature::Initialize(const FeatureLoadParams& params)
 				// (this is still never animated but allows for
 				// custom piece display-lists, etc)
 				localModel.SetModel(model);
+				// which also means the matrices can be derived once, so per-piece
+				// hit-tests (e.g. the threaded weapon pre-fire pass) only read them
+				localModel.UpdatePieceMatrices();
 			} else {
 				LOG_L(L_ERROR, "[%s] couldn't load model for %s", __FUNCTION__, def->name.c_str());
 			}
@@ -533,13 +537,14 @@ void CFeature::UpdateTransformAndPhysState()
 void CFeature::UpdateQuadFieldPosition(const float3& moveVec)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	quadField.RemoveFeature(this);
+	const float3 oldPos = pos;
+
 	UnBlock();
 
 	Move(moveVec, true);
 
 	Block();
-	quadField.AddFeature(this);
+	quadField.MovedFeature(this, oldPos);
 }
 
 
@@ -620,7 +625,17 @@ bool CFeature::UpdatePosition()
 	// use an exact comparison for the y-component (gravity is small)
 	if (!pos.equals(preFrameTra.t, float3(float3::cmp_eps(), 0.0f, float3::cmp_eps()))) {
 		eventHandler.FeatureMoved(this, preFrameTra.t);
-		return true;
+
+		// wrecks creeping down slopes or drifting in water would never pass
+		// the comparison above; put them to sleep once they have crawled for
+		// a while, damage impulses and terrain changes wake them up again
+		if (moveCtrl.enabled || pos.SqDistance(preFrameTra.t) >= Square(SLEEP_SPEED)) {
+			settledFrames = 0;
+			return true;
+		}
+
+		if ((settledFrames += 1) < SLEEP_FRAMES)
+			return true;
 	}
 
 	// position updates should not stop before speed drops to zero, but
@@ -7,6 +7,7 @@
 
 #include "Sim/Objects/SolidObject.h"
 #include "System/Matrix44f.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/Resource.h"
 
 #define TREE_RADIUS 20
@@ -24,6 +25,11 @@ class CFeature: public CSolidObject, public spring::noncopyable
 {
 	CR_DECLARE(CFeature)
 
+public:
+	// features crawling slower than this (elmos per frame) for SLEEP_FRAMES leave the FH update-queue
+	static constexpr float SLEEP_SPEED = 0.01f;
+	static constexpr int SLEEP_FRAMES = GAME_SPEED;
+
 public:
 	CFeature();
 	~CFeature();
@@ -130,6 +136,8 @@ public:
 	int lastReclaimFrame = 0;
 	int fireTime = 0;
 	int smokeTime = 0;
+	// consecutive updates spent moving slower than SLEEP_SPEED
+	int settledFrames = 0;
 
 	SResourcePack defResources = {0.0f, 1.0f};
 	SResourcePack resources = {0.0f, 1.0f};
@@ -214,7 +214,7 @@ void CFeatureHandler::Update()
 {
 	SCOPED_TIMER("Sim::Features");
 
-	if ((gs->frameNum & 31) == 0) {
+	if ((gs->frameNum & ((32 << gs->simQualityLevel) - 1)) == 0) {
 		const auto& pred = [this](int id) { return (this->TryFreeFeatureID(id)); };
 		const auto& iter = std::remove_if(deletedFeatureIDs.begin(), deletedFeatureIDs.end(), pred);
 
@@ -289,6 +289,8 @@ void CFeatureHandler::SetFeatureUpdateable(CFeature* feature)
 		return;
 	}
 
+	// woken up, give it a full SLEEP_FRAMES to settle again
+	feature->settledFrames = 0;
 	// always true
 	feature->inUpdateQue = spring::VectorInsertUnique(updateFeatures, feature);
 }
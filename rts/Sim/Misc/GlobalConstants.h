@@ -66,6 +66,14 @@ static constexpr int UNIT_SLOWUPDATE_RATE = 15;
  */
 static constexpr int TEAM_SLOWUPDATE_RATE = 30;
 
+/**
+ * @brief max sim quality level
+ *
+ * Highest degradation level the autohost can set on an overloaded
+ * server; each level halves the rate of non-critical sim work.
+ */
+static constexpr int MAX_SIM_QUALITY_LEVEL = 3;
+
 
 /**
  * @brief max teams
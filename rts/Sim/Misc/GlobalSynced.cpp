@@ -48,7 +48,8 @@ CR_REG_METADATA(CGlobalSynced, (
 	CR_MEMBER(cheatEnabled),
 	CR_MEMBER(noHelperAIs),
 	CR_MEMBER(editDefsEnabled),
-	CR_MEMBER(useLuaGaia)
+	CR_MEMBER(useLuaGaia),
+	CR_MEMBER(simQualityLevel)
 ))
 
 
@@ -82,6 +83,7 @@ void CGlobalSynced::ResetState() {
 	noHelperAIs     = false;
 	editDefsEnabled = false;
 	useLuaGaia      = true;
+	simQualityLevel = 0;
 
 	gsRNG.SetSeed(18655, true);
 	log_framePrefixer_setFrameNumReference(&frameNum);
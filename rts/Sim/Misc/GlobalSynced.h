@@ -48,6 +48,10 @@ public:
 	// remains true until first SimFrame call
 	bool PreSimFrame() const { return (frameNum == -1); }
 
+	// frames between runs of the work that is deferred at the current sim quality level
+	int SimQualityPeriod() const { return (1 << simQualityLevel); }
+	bool SimQualityFrame() const { return ((frameNum & (SimQualityPeriod() - 1)) == 0); }
+
 private:
 	/**
 	* @brief temp num
@@ -130,6 +134,15 @@ public:
 	* Whether or not LuaGaia is enabled
 	*/
 	bool useLuaGaia = true;
+
+	/**
+	* @brief sim quality level
+	*
+	* Set by the server (on request of the autohost) through a synced
+	* command; 0 runs everything at full rate, up to MAX_SIM_QUALITY_LEVEL
+	* non-critical work is spread over SimQualityPeriod frames.
+	*/
+	int simQualityLevel = 0;
 };
 
 
@@ -28,7 +28,10 @@ CR_BIND(CGroundBlockingObjectMap, )
 CR_REG_METADATA(CGroundBlockingObjectMap, (
 	CR_MEMBER(arrCells),
 	CR_MEMBER(vecCells),
-	CR_MEMBER(vecIndcs)
+	CR_MEMBER(vecIndcs),
+	CR_MEMBER(occupancy),
+	CR_MEMBER(occupancyMapX),
+	CR_MEMBER(occupancyStride)
 ))
 
 
@@ -180,11 +183,11 @@ bool CGroundBlockingObjectMap::GroundBlocked(int x, int z, const CSolidObject* i
 	if (static_cast<unsigned int>(x) >= mapDims.mapx || static_cast<unsigned int>(z) >= mapDims.mapy)
 		return false;
 
-	const BlockingMapCell& cell = GetCellUnsafeConst(z * mapDims.mapx + x);
-
-	if (cell.empty())
+	if (!SquareOccupiedUnsafe(x, z))
 		return false;
 
+	const BlockingMapCell& cell = GetCellUnsafeConst(z * mapDims.mapx + x);
+
 	// check if the first object in <cell> is NOT the ignoree
 	// if so the ground is definitely blocked at this location
 	if (cell[0] != ignoreObj)
@@ -206,6 +209,45 @@ bool CGroundBlockingObjectMap::GroundBlocked(const float3& pos, const CSolidObje
 }
 
 
+bool CGroundBlockingObjectMap::RangeOccupiedUnsafe(int xmin, int zmin, int xmax, int zmax) const
+{
+	assert(xmin >= 0 && xmax < int(occupancyMapX));
+	assert(zmin >= 0 && zmax < int(occupancy.size() / occupancyStride));
+
+	if (xmin > xmax || zmin > zmax)
+		return false;
+
+	const int wmin = xmin >> 6;
+	const int wmax = xmax >> 6;
+
+	// bits of the first and last word within [xmin, xmax]
+	const uint64_t minMask = ~uint64_t(0) << (xmin & 63);
+	const uint64_t maxMask = ~uint64_t(0) >> (63 - (xmax & 63));
+
+	for (int z = zmin; z <= zmax; z++) {
+		const uint64_t* row = &occupancy[z * occupancyStride];
+
+		if (wmin == wmax) {
+			if ((row[wmin] & minMask & maxMask) != 0)
+				return true;
+
+			continue;
+		}
+
+		uint64_t bits = (row[wmin] & minMask) | (row[wmax] & maxMask);
+
+		for (int w = wmin + 1; w < wmax; w++) {
+			bits |= row[w];
+		}
+
+		if (bits != 0)
+			return true;
+	}
+
+	return false;
+}
+
+
 CGroundBlockingObjectMap::BlockingMapCell CGroundBlockingObjectMap::GetCellUnsafeConst(const float3& pos) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -288,8 +330,10 @@ bool CGroundBlockingObjectMap::CellInsertUnique(unsigned int sqr, CSolidObject*
 
 	if (ac.Contains(o))
 		return false;
-	if (ac.Insert(o))
+	if (ac.Insert(o)) {
+		SetOccupied(sqr);
 		return true;
+	}
 
 	// array-cell is full, spill over
 	if ((vc = &GetVecCell(sqr)) == &vecCells[0]) {
@@ -312,8 +356,12 @@ bool CGroundBlockingObjectMap::CellErase(unsigned int sqr, CSolidObject* o) {
 	VecCell* vc = nullptr;
 
 	if (ac.Erase(o)) {
-		if (ac.GetVecIndx() == 0)
+		if (ac.GetVecIndx() == 0) {
+			if (ac.Empty())
+				ClearOccupied(sqr);
+
 			return true;
+		}
 
 		// never allow a hole between array and vector parts
 		assert(!vecCells[ac.GetVecIndx()].empty());
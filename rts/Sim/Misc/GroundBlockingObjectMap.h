@@ -3,7 +3,9 @@
 #ifndef GROUNDBLOCKINGOBJECTMAP_H
 #define GROUNDBLOCKINGOBJECTMAP_H
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include "Sim/Objects/SolidObject.h"
@@ -97,8 +99,13 @@ public:
 	};
 
 
-	void Init(unsigned int numSquares) {
+	void Init(unsigned int numSquares, unsigned int numSquaresX) {
 		arrCells.resize(numSquares);
+
+		occupancyMapX = numSquaresX;
+		occupancyStride = (numSquaresX + 63) / 64;
+		occupancy.clear();
+		occupancy.resize(occupancyStride * (numSquares / numSquaresX), 0);
 		vecCells.reserve(32);
 		vecIndcs.reserve(32);
 
@@ -117,6 +124,8 @@ public:
 		}
 
 		vecIndcs.clear();
+
+		std::fill(occupancy.begin(), occupancy.end(), 0);
 	}
 
 	unsigned int CalcChecksum() const;
@@ -138,6 +147,9 @@ public:
 
 	// same as GroundBlocked(), but does not bounds-check mapSquare
 	CSolidObject* GroundBlockedUnsafe(unsigned int mapSquare) const {
+		if (!SquareOccupiedUnsafe(mapSquare % occupancyMapX, mapSquare / occupancyMapX))
+			return nullptr;
+
 		const BlockingMapCell& cell = GetCellUnsafeConst(mapSquare);
 
 		if (cell.empty())
@@ -164,6 +176,16 @@ public:
 	}
 
 
+	// the occupancy plane holds one bit per square, set iff any object is in its cell;
+	// footprint tests can reject empty areas a 64-square word at a time without
+	// touching the (much larger) cells
+	bool SquareOccupiedUnsafe(unsigned int x, unsigned int z) const {
+		return ((occupancy[z * occupancyStride + (x >> 6)] >> (x & 63)) & 1);
+	}
+	// inclusive bounds, must be within the map; empty ranges are never occupied
+	bool RangeOccupiedUnsafe(int xmin, int zmin, int xmax, int zmax) const;
+
+
 	BlockingMapCell GetCellUnsafeConst(const float3& pos) const;
 	BlockingMapCell GetCellUnsafeConst(unsigned int mapSquare) const {
 		assert(mapSquare < arrCells.size());
@@ -182,10 +204,25 @@ private:
 	bool CellInsertUnique(unsigned int sqr, CSolidObject* o);
 	bool CellErase(unsigned int sqr, CSolidObject* o);
 
+	void SetOccupied(unsigned int sqr) {
+		const unsigned int x = sqr % occupancyMapX;
+		const unsigned int z = sqr / occupancyMapX;
+		occupancy[z * occupancyStride + (x >> 6)] |= (uint64_t(1) << (x & 63));
+	}
+	void ClearOccupied(unsigned int sqr) {
+		const unsigned int x = sqr % occupancyMapX;
+		const unsigned int z = sqr / occupancyMapX;
+		occupancy[z * occupancyStride + (x >> 6)] &= ~(uint64_t(1) << (x & 63));
+	}
+
 private:
 	std::vector<ArrCell> arrCells;
 	std::vector<VecCell> vecCells;
 	std::vector<uint32_t> vecIndcs;
+
+	std::vector<uint64_t> occupancy;
+	unsigned int occupancyMapX = 1;
+	unsigned int occupancyStride = 0;
 };
 
 extern CGroundBlockingObjectMap groundBlockingObjectMap;
@@ -23,7 +23,10 @@
 CR_BIND_DERIVED(CInterceptHandler, CObject, )
 CR_REG_METADATA(CInterceptHandler, (
 	CR_MEMBER(interceptors),
-	CR_MEMBER(interceptables)
+	CR_MEMBER(interceptables),
+	CR_IGNORED(interceptorGrid),
+	CR_IGNORED(interceptorCandidates),
+	CR_POSTLOAD(PostLoad)
 ))
 
 CInterceptHandler interceptHandler;
@@ -36,85 +39,257 @@ void CInterceptHandler::Update(bool forced) {
 		return;
 
 	for (CWeapon* w: interceptors) {
-		const WeaponDef* wDef = w->weaponDef;
-		const CUnit* wOwner = w->owner;
+		for (CWeaponProjectile* p: interceptables) {
+			TestInterceptor(w, p);
+		}
+	}
+}
 
-		assert(wDef->interceptor || wDef->isShield);
 
-		for (CWeaponProjectile* p: interceptables) {
-			if (!p->CanBeInterceptedBy(wDef))
-				continue;
-			if (w->HasIncomingProjectile(p->id))
-				continue;
+void CInterceptHandler::TestInterceptor(CWeapon* w, CWeaponProjectile* p)
+{
+	const WeaponDef* wDef = w->weaponDef;
+	const CUnit* wOwner = w->owner;
 
-			const int pAllyTeam = p->GetAllyteamID();
+	assert(wDef->interceptor || wDef->isShield);
 
-			if (teamHandler.IsValidAllyTeam(pAllyTeam) && teamHandler.Ally(wOwner->allyteam, pAllyTeam))
-				continue;
+	if (!p->CanBeInterceptedBy(wDef))
+		return;
+	if (w->HasIncomingProjectile(p->id))
+		return;
 
-			// note: will be called every Update so long as gadget does not return true
-			if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
-				continue;
+	const int pAllyTeam = p->GetAllyteamID();
+
+	if (teamHandler.IsValidAllyTeam(pAllyTeam) && teamHandler.Ally(wOwner->allyteam, pAllyTeam))
+		return;
+
+	// note: will be called every Update so long as gadget does not return true
+	if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
+		return;
+
+	// there are four cases when an interceptor <w> should fire at a projectile <p>:
+	//     1. p's target position inside w's interception circle (w's owner can move!)
+	//     2. p's current position inside w's interception circle
+	//     3. p's projected impact position inside w's interception circle
+	//     4. p's trajectory intersects w's interception circle
+	//
+	// these checks all need to be evaluated periodically, not just
+	// when a projectile is created and handed to AddInterceptTarget
+	const float weaponDist = w->aimFromPos.distance(p->pos);
+	const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
+
+	const float3& pImpactPos = p->pos + p->dir * impactDist;
+	const float3& pTargetPos = p->GetTargetPos();
+	const float3  pWeaponVec = p->pos - w->aimFromPos;
+
+	if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 1
+	}
+
+	if (false /*wDef->noFlyThroughIntercept*/) {
+		// <w> is just a static interceptor and fires only at projectiles
+		// TARGETED within its current interception area; any projectiles
+		// CROSSING its interception area aren't targeted
+		//XXX implement in lua?
+		return;
+	}
 
-			// there are four cases when an interceptor <w> should fire at a projectile <p>:
-			//     1. p's target position inside w's interception circle (w's owner can move!)
-			//     2. p's current position inside w's interception circle
-			//     3. p's projected impact position inside w's interception circle
-			//     4. p's trajectory intersects w's interception circle
-			//
-			// these checks all need to be evaluated periodically, not just
-			// when a projectile is created and handed to AddInterceptTarget
-			const float weaponDist = w->aimFromPos.distance(p->pos);
-			const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
-
-			const float3& pImpactPos = p->pos + p->dir * impactDist;
-			const float3& pTargetPos = p->GetTargetPos();
-			const float3  pWeaponVec = p->pos - w->aimFromPos;
-
-			if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 1
+	if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 2
+	}
+
+	if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
+		const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
+		const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
+
+		// the projected impact position can briefly shift into the covered
+		// area during transition from vertical to horizontal flight, so we
+		// perform an extra test (NOTE: assumes non-parabolic trajectory)
+		if (pTargetDir.dot(pImpactDir) >= 0.999f) {
+			w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+			w->AddIncomingProjectile(p->id);
+			return; // 3
+		}
+	}
+
+	const float3 pMinSepPos = p->pos + p->dir * std::clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
+	const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
+
+	if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 4
+	}
+}
+
+
+void CInterceptHandler::UpdateInterceptorGrid()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	InterceptorGrid& grid = interceptorGrid;
+
+	if (!grid.dirty && grid.entries.size() == interceptors.size()) {
+		bool moved = false;
+
+		for (size_t i = 0, n = interceptors.size(); i < n && !moved; i++) {
+			const CWeapon* w = interceptors[i];
+			const InterceptorGrid::Entry& e = grid.entries[i];
+
+			moved |= (e.weapon != w);
+			moved |= (e.posX != w->aimFromPos.x);
+			moved |= (e.posZ != w->aimFromPos.z);
+			moved |= (e.range != w->weaponDef->coverageRange);
+		}
+
+		if (!moved)
+			return;
+	}
+
+	grid.dirty = false;
+	grid.entries.clear();
+	grid.entries.reserve(interceptors.size());
+	grid.tempNums.assign(interceptors.size(), 0);
+	grid.tempNum = 0;
+
+	for (auto& cell: grid.cells) {
+		cell.clear();
+	}
+
+	if (interceptors.empty()) {
+		grid.numCellsX = 0;
+		grid.numCellsZ = 0;
+		return;
+	}
+
+	grid.minX = std::numeric_limits<float>::max();
+	grid.minZ = std::numeric_limits<float>::max();
+	grid.maxX = std::numeric_limits<float>::lowest();
+	grid.maxZ = std::numeric_limits<float>::lowest();
+
+	for (const CWeapon* w: interceptors) {
+		const InterceptorGrid::Entry& e = grid.entries.emplace_back(w, w->aimFromPos.x, w->aimFromPos.z, w->weaponDef->coverageRange);
+
+		grid.minX = std::min(grid.minX, e.posX - e.range);
+		grid.minZ = std::min(grid.minZ, e.posZ - e.range);
+		grid.maxX = std::max(grid.maxX, e.posX + e.range);
+		grid.maxZ = std::max(grid.maxZ, e.posZ + e.range);
+	}
+
+	grid.cellSize = std::max(InterceptorGrid::CELL_SIZE, std::max(grid.maxX - grid.minX, grid.maxZ - grid.minZ) / InterceptorGrid::MAX_CELLS);
+
+	// GetInterceptorCandidates samples rays once per cell-size, so each point on
+	// a ray is at most half a cell away from a sample; the extra elmo is for the
+	// rounding errors
+	const float cellPad = grid.cellSize * 0.5f + 1.0f;
+
+	grid.minX -= cellPad;
+	grid.minZ -= cellPad;
+	grid.maxX += cellPad;
+	grid.maxZ += cellPad;
+
+	grid.numCellsX = static_cast<int>((grid.maxX - grid.minX) / grid.cellSize) + 1;
+	grid.numCellsZ = static_cast<int>((grid.maxZ - grid.minZ) / grid.cellSize) + 1;
+	grid.cells.resize(grid.numCellsX * grid.numCellsZ);
+
+	for (size_t i = 0, n = grid.entries.size(); i < n; i++) {
+		const InterceptorGrid::Entry& e = grid.entries[i];
+
+		const int x0 = std::clamp(static_cast<int>((e.posX - e.range - cellPad - grid.minX) / grid.cellSize), 0, grid.numCellsX - 1);
+		const int z0 = std::clamp(static_cast<int>((e.posZ - e.range - cellPad - grid.minZ) / grid.cellSize), 0, grid.numCellsZ - 1);
+		const int x1 = std::clamp(static_cast<int>((e.posX + e.range + cellPad - grid.minX) / grid.cellSize), 0, grid.numCellsX - 1);
+		const int z1 = std::clamp(static_cast<int>((e.posZ + e.range + cellPad - grid.minZ) / grid.cellSize), 0, grid.numCellsZ - 1);
+
+		for (int z = z0; z <= z1; z++) {
+			for (int x = x0; x <= x1; x++) {
+				grid.cells[z * grid.numCellsX + x].push_back(i);
 			}
+		}
+	}
+}
+
+
+void CInterceptHandler::GetInterceptorCandidates(const CWeaponProjectile* p, std::vector<int>& candidates)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	candidates.clear();
+	UpdateInterceptorGrid();
 
-			if (false /*wDef->noFlyThroughIntercept*/) {
-				// <w> is just a static interceptor and fires only at projectiles
-				// TARGETED within its current interception area; any projectiles
-				// CROSSING its interception area aren't targeted
-				//XXX implement in lua?
+	InterceptorGrid& grid = interceptorGrid;
+
+	if (grid.entries.empty())
+		return;
+
+	const int tempNum = ++grid.tempNum;
+
+	const auto AddCell = [&](float x, float z) {
+		const int cx = std::clamp(static_cast<int>((x - grid.minX) / grid.cellSize), 0, grid.numCellsX - 1);
+		const int cz = std::clamp(static_cast<int>((z - grid.minZ) / grid.cellSize), 0, grid.numCellsZ - 1);
+
+		for (const int i: grid.cells[cz * grid.numCellsX + cx]) {
+			if (grid.tempNums[i] == tempNum)
 				continue;
-			}
 
-			if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 2
-			}
+			grid.tempNums[i] = tempNum;
+			candidates.push_back(i);
+		}
+	};
+
+	// case 1 of TestInterceptor
+	const float3& targetPos = p->GetTargetPos();
+
+	if (targetPos.x >= grid.minX && targetPos.x <= grid.maxX && targetPos.z >= grid.minZ && targetPos.z <= grid.maxZ)
+		AddCell(targetPos.x, targetPos.z);
 
-			if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
-				const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
-				const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
-
-				// the projected impact position can briefly shift into the covered
-				// area during transition from vertical to horizontal flight, so we
-				// perform an extra test (NOTE: assumes non-parabolic trajectory)
-				if (pTargetDir.dot(pImpactDir) >= 0.999f) {
-					w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-					w->AddIncomingProjectile(p->id);
-					continue; // 3
-				}
+	// cases 2-4 only test points on the ray pos + dir * s with s >= -1 (the ground
+	// hit distance is -1 if there is none), and their 2D distance to the interceptor
+	// can only be smaller than the 3D one
+	const float rayPosX = p->pos.x - p->dir.x;
+	const float rayPosZ = p->pos.z - p->dir.z;
+	const float rayLen2D = math::sqrt(Square(p->dir.x) + Square(p->dir.z));
+
+	if (rayLen2D == 0.0f) {
+		if (rayPosX >= grid.minX && rayPosX <= grid.maxX && rayPosZ >= grid.minZ && rayPosZ <= grid.maxZ)
+			AddCell(rayPosX, rayPosZ);
+	} else {
+		const float rayDirX = p->dir.x / rayLen2D;
+		const float rayDirZ = p->dir.z / rayLen2D;
+
+		float tEnter = 0.0f;
+		float tExit = std::numeric_limits<float>::max();
+
+		const auto ClipSlab = [&](float rayPos, float rayDir, float slabMin, float slabMax) {
+			if (rayDir == 0.0f) {
+				if (rayPos < slabMin || rayPos > slabMax)
+					tExit = -1.0f;
+
+				return;
 			}
 
-			const float3 pMinSepPos = p->pos + p->dir * std::clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
-			const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
+			const float t0 = (slabMin - rayPos) / rayDir;
+			const float t1 = (slabMax - rayPos) / rayDir;
+
+			tEnter = std::max(tEnter, std::min(t0, t1));
+			tExit = std::min(tExit, std::max(t0, t1));
+		};
 
-			if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 4
+		ClipSlab(rayPosX, rayDirX, grid.minX, grid.maxX);
+		ClipSlab(rayPosZ, rayDirZ, grid.minZ, grid.maxZ);
+
+		if (tEnter <= tExit) {
+			for (float t = tEnter; t < tExit; t += grid.cellSize) {
+				AddCell(rayPosX + rayDirX * t, rayPosZ + rayDirZ * t);
 			}
+
+			AddCell(rayPosX + rayDirX * tExit, rayPosZ + rayDirZ * tExit);
 		}
 	}
+
+	// test in the same order as Update does
+	std::sort(candidates.begin(), candidates.end());
 }
 
 
@@ -123,6 +298,7 @@ void CInterceptHandler::AddInterceptorWeapon(CWeapon* weapon)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	interceptors.push_back(weapon);
+	interceptorGrid.dirty = true;
 }
 
 
@@ -132,6 +308,7 @@ void CInterceptHandler::RemoveInterceptorWeapon(CWeapon* weapon)
 	auto it = std::find(interceptors.begin(), interceptors.end(), weapon);
 	if (it != interceptors.end()) {
 		interceptors.erase(it);
+		interceptorGrid.dirty = true;
 	}
 }
 
@@ -147,7 +324,13 @@ void CInterceptHandler::AddInterceptTarget(CWeaponProjectile* target, const floa
 	// die before the interceptable itself does)
 	AddDeathDependence(target, DEPENDENCE_INTERCEPTABLE);
 
-	Update(true);
+	// only the new target needs to be tested right away, and only against the
+	// interceptors it can come near; all other pairs are re-tested by Update
+	GetInterceptorCandidates(target, interceptorCandidates);
+
+	for (const int i: interceptorCandidates) {
+		TestInterceptor(interceptors[i], target);
+	}
 }
 
 
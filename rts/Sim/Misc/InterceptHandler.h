@@ -4,13 +4,14 @@
 #define INTERCEPT_HANDLER_H
 
 #include <deque>
+#include <vector>
+
 #include "System/Misc/NonCopyable.h"
 #include "System/Object.h"
 
 class CWeapon;
 class CWeaponProjectile;
 class CProjectile;
-class float3;
 
 class CInterceptHandler : public CObject, spring::noncopyable
 {
@@ -26,9 +27,55 @@ public:
 
 	void DependentDied(CObject* o);
 
+	void PostLoad() { interceptorGrid.dirty = true; }
+
 private:
+	void TestInterceptor(CWeapon* w, CWeaponProjectile* p);
+
+	void UpdateInterceptorGrid();
+	void GetInterceptorCandidates(const CWeaponProjectile* p, std::vector<int>& candidates);
+
+private:
+	// Uniform grid over the interceptors' coverage circles, used to find the interceptors
+	// a new projectile might fall under. Each interceptor is filed under every cell its
+	// circle (widened by half a cell) touches, as seen from where its aim-point was when
+	// the grid got built; any interceptor that has moved since then forces a rebuild.
+	struct InterceptorGrid {
+		struct Entry {
+			const CWeapon* weapon;
+			float posX;
+			float posZ;
+			float range;
+		};
+
+		// cells grow beyond CELL_SIZE if the interceptors are spread out wide enough
+		static constexpr float CELL_SIZE = 512.0f;
+		static constexpr int MAX_CELLS = 128;
+
+		std::vector< std::vector<int> > cells;
+		std::vector<Entry> entries;
+
+		// indexed like <interceptors>, to dedup candidates from several cells
+		std::vector<int> tempNums;
+
+		float minX = 0.0f;
+		float minZ = 0.0f;
+		float maxX = 0.0f;
+		float maxZ = 0.0f;
+		float cellSize = CELL_SIZE;
+
+		int numCellsX = 0;
+		int numCellsZ = 0;
+		int tempNum = 0;
+
+		bool dirty = true;
+	};
+
 	std::deque<CWeapon*> interceptors;
 	std::deque<CWeaponProjectile*> interceptables;
+
+	InterceptorGrid interceptorGrid;
+	std::vector<int> interceptorCandidates;
 };
 
 extern CInterceptHandler interceptHandler;
@@ -127,11 +127,76 @@ void ILosType::Kill()
 	losDeleted.clear();
 	losRecalc.clear();
 
+	losMoves.clear();
+	spring::clear_unordered_map(circleRemoves);
+
+	for (auto& changes: allyTeamLosChanges) {
+		changes.clear();
+	}
+	for (auto& moves: allyTeamLosMoves) {
+		moves.clear();
+	}
+
+	mergedLosMap.clear();
+
 	// mark as invalid
 	size = {0, 0};
 }
 
 
+const std::vector<unsigned short>& ILosType::GetMergedLosMap(SRectangle& rect, bool fullUpdate)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	rect = {};
+
+	if (fullUpdate || mergedLosMap.empty()) {
+		mergedLosMap.resize(size.x * size.y, 0);
+		rect = {0, 0, size.x, size.y};
+	} else {
+		for (const CLosMap& losMap: losMaps) {
+			const SRectangle& r = losMap.GetMergedChangedRect();
+
+			if (r.GetArea() == 0)
+				continue;
+
+			if (rect.GetArea() == 0) {
+				rect = r;
+				continue;
+			}
+
+			rect.x1 = std::min(rect.x1, r.x1);
+			rect.z1 = std::min(rect.z1, r.z1);
+			rect.x2 = std::max(rect.x2, r.x2);
+			rect.z2 = std::max(rect.z2, r.z2);
+		}
+	}
+
+	for (CLosMap& losMap: losMaps) {
+		losMap.ClearMergedChangedRect();
+	}
+
+	// OR the bit-planes of all allyteams a word at a time and expand just the squares inside <rect>
+	for (int z = rect.z1; z < rect.z2; z++) {
+		const unsigned int beg = z * size.x + rect.x1;
+		const unsigned int end = z * size.x + rect.x2;
+
+		for (unsigned int w = (beg >> 6); w <= ((end - 1) >> 6); w++) {
+			std::uint64_t bits = 0;
+
+			for (const CLosMap& losMap: losMaps) {
+				bits |= losMap.GetVisibilityBits()[w];
+			}
+
+			for (unsigned int idx = std::max(beg, w << 6), last = std::min(end, (w + 1) << 6); idx < last; idx++) {
+				mergedLosMap[idx] = (bits >> (idx & 63)) & 1;
+			}
+		}
+	}
+
+	return mergedLosMap;
+}
+
+
 float ILosType::GetRadius(const CUnit* unit) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -304,6 +369,65 @@ inline void ILosType::LosRemove(SLosInstance* li)
 }
 
 
+void ILosType::PairCircleMoves()
+{
+	RECOIL_TRACY_ZONE(LOS);
+	assert(algoType == LOS_ALGO_CIRCLE);
+	losMoves.clear();
+
+	if (losRemove.empty() || losAdd.empty())
+		return;
+
+	const auto GetKey = [](const SLosInstance* li) {
+		return ((std::uint64_t(li->allyteam) << 32) | std::uint32_t(li->radius));
+	};
+
+	for (auto& p: circleRemoves) {
+		p.second.clear();
+	}
+	for (size_t i = 0; i < losRemove.size(); i++) {
+		circleRemoves[GetKey(losRemove[i])].push_back(i);
+	}
+
+	pairedLosChanges.clear();
+	pairedLosChanges.resize(losRemove.size(), 0);
+
+	// units moving by a few squares at a time make up nearly all of the changes, pair each
+	// added footprint with the most recently queued removed one it overlaps for the most part
+	const auto addEnd = std::remove_if(losAdd.begin(), losAdd.end(), [&](SLosInstance* li) {
+		const auto it = circleRemoves.find(GetKey(li));
+
+		if (it == circleRemoves.end() || it->second.empty())
+			return false;
+
+		auto& removes = it->second;
+		SLosInstance* ri = losRemove[removes.back()];
+
+		const int2 offset = ri->basePos - li->basePos;
+
+		if (std::max(std::abs(offset.x), std::abs(offset.y)) >= std::max(li->radius, 1))
+			return false;
+
+		pairedLosChanges[removes.back()] = 1;
+		removes.pop_back();
+
+		losMoves.emplace_back(ri, li);
+		return true;
+	});
+
+	losAdd.erase(addEnd, losAdd.end());
+
+	size_t numUnpaired = 0;
+
+	for (size_t i = 0; i < losRemove.size(); i++) {
+		if (pairedLosChanges[i] == 0)
+			losRemove[numUnpaired++] = losRemove[i];
+	}
+
+	losRemove.resize(numUnpaired);
+}
+
+
 inline void ILosType::RefInstance(SLosInstance* li)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -498,7 +622,7 @@ inline int ILosType::GetHashNum(const int allyteam, const int2 baseLos, const fl
 
 void ILosType::Update()
 {
-	RECOIL_DETAILED_TRACY_ZONE;
+	RECOIL_TRACY_ZONE(LOS);
 	// delayed delete
 	while (!delayedDeleteQue.empty() && delayedDeleteQue.front().timeoutTime < gs->frameNum) {
 		UnrefInstance(delayedDeleteQue.front().instance);
@@ -568,12 +692,53 @@ void ILosType::Update()
 		}
 	}
 
-	// remove sight
-	//FIXME multithread?
-	for (SLosInstance* li: losRemove) {
-		LosRemove(li);
+	// circles are plain counters without any events, so a footprint that only shifted
+	// can be updated by its difference instead of a full remove and re-add
+	if (algoType == LOS_ALGO_CIRCLE) {
+		PairCircleMoves();
+	} else {
+		losMoves.clear();
 	}
 
+	// every allyteam writes only to its own los-map, so the sight changes of different
+	// allyteams can be applied in parallel; each one still sees them in queue order
+	const auto ApplyLosChanges = [this](const std::vector<SLosInstance*>& losChanges, bool add) {
+		allyTeamLosChanges.resize(losMaps.size());
+		allyTeamLosMoves.resize(losMaps.size());
+
+		for (auto& changes: allyTeamLosChanges) {
+			changes.clear();
+		}
+		for (auto& moves: allyTeamLosMoves) {
+			moves.clear();
+		}
+		for (SLosInstance* li: losChanges) {
+			allyTeamLosChanges[li->allyteam].push_back(li);
+		}
+		for (const auto& move: losMoves) {
+			if (!add)
+				allyTeamLosMoves[move.second->allyteam].push_back(move);
+		}
+
+		for_mt(0, allyTeamLosChanges.size(), [&](const int allyTeam) {
+			for (const auto& move: allyTeamLosMoves[allyTeam]) {
+				assert(move.second->refCount > 0);
+				losMaps[allyTeam].MoveCircle(move.first, move.second);
+			}
+			for (SLosInstance* li: allyTeamLosChanges[allyTeam]) {
+				if (add) {
+					assert(li->refCount > 0);
+					LosAdd(li);
+				} else {
+					LosRemove(li);
+				}
+			}
+		});
+	};
+
+	// remove sight, and move shifted circles
+	ApplyLosChanges(losRemove, false);
+
 	// raycast terrain
 	if (algoType == LOS_ALGO_RAYCAST)  {
 		for_mt(0, losRecalc.size(), [&](const int idx) {
@@ -585,10 +750,7 @@ void ILosType::Update()
 	}
 
 	// add sight
-	for (SLosInstance* li: losAdd) {
-		assert(li->refCount > 0);
-		LosAdd(li);
-	}
+	ApplyLosChanges(losAdd, true);
 
 	// delete / move to cache unused instances
 	if (algoType == LOS_ALGO_RAYCAST) {
@@ -831,6 +993,10 @@ void CLosHandler::Update()
 	const size_t maxUnitIndex = minUnitIndex + losBatchSize + (activeUnits.size() % losBatchRate) * (losBatchMult == (losBatchRate - 1));
 	#endif
 
+	// units still queue their changes every frame, the instances are only
+	// recalculated once per period when the server runs at reduced quality
+	const bool updateInstances = gs->SimQualityFrame();
+
 	for_mt(0, losTypes.size(), [&](const int idx) {
 		ILosType* lt = losTypes[idx];
 
@@ -849,14 +1015,15 @@ void CLosHandler::Update()
 		}
 		#endif
 
-		lt->Update();
+		if (updateInstances)
+			lt->Update();
 	});
 }
 
 
 void CLosHandler::UpdateHeightMapSynced(SRectangle rect)
 {
-	RECOIL_DETAILED_TRACY_ZONE;
+	RECOIL_TRACY_ZONE(LOS);
 	for (ILosType* lt: losTypes) {
 		ZoneScopedN("LosHandler::UpdateHeightMapSynced");
 		lt->UpdateHeightMapSynced(rect);
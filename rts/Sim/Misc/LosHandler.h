@@ -3,6 +3,7 @@
 #ifndef LOS_HANDLER_H
 #define LOS_HANDLER_H
 
+#include <cstdint>
 #include <vector>
 #include <deque>
 
@@ -108,7 +109,7 @@ public:
 
 	inline bool InSight(const float3 pos, int allyTeam) const {
 		assert(allyTeam < losMaps.size());
-		return (losMaps[allyTeam].At(PosToSquare(pos)) != 0);
+		return (losMaps[allyTeam].IsVisible(PosToSquare(pos)));
 	}
 
 public:
@@ -133,12 +134,22 @@ public:
 	void RemoveUnit(CUnit* unit, bool delayed = false);
 	void UpdateUnit(CUnit* unit, bool ignore = false);
 
+	/**
+	 * Unsynced union of all allyteams' maps for full-view spectators, 1 where any
+	 * allyteam sees the square and 0 elsewhere. Brings the squares changed since
+	 * the previous call (all of them on the first or a <fullUpdate> call) up to
+	 * date and returns their bounds in <rect>.
+	 */
+	const std::vector<unsigned short>& GetMergedLosMap(SRectangle& rect, bool fullUpdate);
+
 private:
 	//void PostLoad();
 
 	void LosAdd(SLosInstance* instance);
 	void LosRemove(SLosInstance* instance);
 
+	void PairCircleMoves();
+
 	void RefInstance(SLosInstance* instance);
 	void UnrefInstance(SLosInstance* instance);
 	void DelayedUnrefInstance(SLosInstance* instance);
@@ -192,6 +203,20 @@ private:
 	std::vector<SLosInstance*> losDeleted;
 	std::vector<SLosInstance*> losRecalc;
 
+	// circle footprints that got replaced by an overlapping one of the same size,
+	// first is the removed instance and second the added one
+	std::vector< std::pair<SLosInstance*, SLosInstance*> > losMoves;
+	// candidates for the above, indices into losRemove per allyteam and radius
+	spring::unordered_map<std::uint64_t, std::vector<unsigned int> > circleRemoves;
+	std::vector<std::uint8_t> pairedLosChanges;
+
+	// losRemove, losAdd and losMoves split by allyteam, each of which has its own los-map
+	std::vector< std::vector<SLosInstance*> > allyTeamLosChanges;
+	std::vector< std::vector< std::pair<SLosInstance*, SLosInstance*> > > allyTeamLosMoves;
+
+	// only allocated once a spectator views it, see GetMergedLosMap
+	std::vector<unsigned short> mergedLosMap;
+
 	static constexpr int CACHE_SIZE = 4096;
 };
 
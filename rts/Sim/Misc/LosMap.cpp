@@ -10,6 +10,7 @@
 #include "System/float3.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
+#include "System/Misc/TracyDefs.h"
 #include "System/Threading/ThreadPool.h"
 #include "Game/GlobalUnsynced.h" // for myAllyTeam
 
@@ -19,6 +20,7 @@ static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RADIUS_ISQRT_TABL
 
 static std::array<std::vector<float>, ThreadPool::MAX_THREADS> RAYCAST_ANGLE_TABLES;
 static std::array<std::vector< char>, ThreadPool::MAX_THREADS> LOSRAY_SQUARE_TABLES; // visible squares per instance
+static std::array<std::vector<  int>, ThreadPool::MAX_THREADS> CIRCLE_WIDTH_TABLES; // half-width per line, for MoveCircle
 
 
 static float isqrtTableLookup(unsigned r, int threadNum)
@@ -107,6 +109,14 @@ void MidpointCircleAlgoPerLine(int radius, const F& func)
 
 
 
+inline static constexpr size_t ToAngleMapIdx(const int2 p, const int radius)
+{
+	// [-radius, +radius]^2 -> [0, +2*radius]^2 -> idx
+	return (p.y + radius) * (2 * radius + 1) + (p.x + radius);
+}
+
+
+
 //////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////
 /// raycast precalculation helper
@@ -117,9 +127,22 @@ public:
 	typedef std::vector<int2> LosLine;
 	typedef std::vector<LosLine> LosTable;
 
+	// the rays of a LosTable flattened for UnsafeLosAdd, with every square already
+	// resolved to its angle-map index for all four mirrored rays at once
+	struct LosRayKernel {
+		// range of each ray within the per-square arrays, numRays + 1 entries
+		std::vector<unsigned int> rayOffsets;
+		std::vector<std::array<unsigned int, 4>> squareIndices;
+		std::vector<float> squareInvRadii;
+	};
+
 	// only generates table if not in cache
 	void GenerateForLosSize(size_t losSize);
 
+	const LosRayKernel& GetLosRayKernel(size_t losSize) {
+		return losRayKernels[losSize];
+	}
+
 	const int2 GetLosTableRaySquare(size_t losSize, size_t rayIndex, size_t squareIdx) {
 		return losTables[losSize][rayIndex][squareIdx];
 	}
@@ -138,8 +161,10 @@ private:
 	//   do we even need a table for *every* possible radius?
 	//   why not precalculate only the largest and subsample?
 	std::array<LosTable, MAX_UNIT_SENSOR_RADIUS + 1> losTables;
+	std::array<LosRayKernel, MAX_UNIT_SENSOR_RADIUS + 1> losRayKernels;
 
 private:
+	static LosRayKernel BuildLosRayKernel(const LosTable& losRays, int radius);
 	static LosLine GetRay(int x, int y);
 	static LosTable GetLosRays(int radius);
 	static std::vector<int2> GetCircleSurface(const int radius);
@@ -166,6 +191,7 @@ void CLosTableHelper::GenerateForLosSize(size_t losSize)
 		return;
 
 	table = GetLosRays(losSize);
+	losRayKernels[losSize] = BuildLosRayKernel(table, losSize);
 }
 
 
@@ -202,6 +228,33 @@ CLosTableHelper::LosTable CLosTableHelper::GetLosRays(const int radius)
 }
 
 
+CLosTableHelper::LosRayKernel CLosTableHelper::BuildLosRayKernel(const LosTable& losRays, const int radius)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	LosRayKernel kernel;
+	kernel.rayOffsets.reserve(losRays.size() + 1);
+	kernel.rayOffsets.push_back(0);
+
+	for (const LosLine& line: losRays) {
+		for (const int2 square: line) {
+			kernel.squareIndices.push_back({
+				static_cast<unsigned int>(ToAngleMapIdx(      square              , radius)),
+				static_cast<unsigned int>(ToAngleMapIdx(     -square              , radius)),
+				static_cast<unsigned int>(ToAngleMapIdx(int2( square.y, -square.x), radius)),
+				static_cast<unsigned int>(ToAngleMapIdx(int2(-square.y,  square.x), radius)),
+			});
+
+			// same value isqrtTableLookup returns for this square
+			kernel.squareInvRadii.push_back(math::isqrt(std::max(unsigned(square.x * square.x + square.y * square.y), 1u)));
+		}
+
+		kernel.rayOffsets.push_back(kernel.squareIndices.size());
+	}
+
+	return kernel;
+}
+
+
 /**
  * @brief returns the surface coords of a 2d circle.
  * Note, we only return the upper right part, the other 3 are generated via mirroring.
@@ -419,11 +472,158 @@ void CLosMap::AddCircle(SLosInstance* instance, int amount)
 			const unsigned sx = std::clamp(instance->basePos.x - width,     0, size.x);
 			const unsigned ex = std::clamp(instance->basePos.x + width + 1, 0, size.x);
 
-			for (unsigned x_ = sx; x_ < ex; ++x_) {
-				losmap[(y_ * size.x) + x_] += amount;
-			}
+			AddSpan((y_ * size.x) + sx, (y_ * size.x) + ex, amount);
+		}
+	});
+}
+
+
+void CLosMap::AddSpan(unsigned int beg, unsigned int end, int amount)
+{
+	for (unsigned int idx = beg; idx < end; ++idx) {
+		losmap[idx] += amount;
+	}
+
+	// squares can only enter sight when added to and only leave it when removed from
+	if (amount > 0) {
+		SetVisibilityBits(beg, end);
+	} else {
+		ClearHiddenVisibilityBits(beg, end);
+	}
+}
+
+void CLosMap::SetVisibilityBits(unsigned int beg, unsigned int end)
+{
+	if (beg >= end)
+		return;
+
+	const unsigned int begWord = beg >> 6;
+	const unsigned int endWord = (end - 1) >> 6;
+
+	const std::uint64_t begMask = ~std::uint64_t(0) << (beg & 63);
+	const std::uint64_t endMask = ~std::uint64_t(0) >> (63 - ((end - 1) & 63));
+
+	std::uint64_t newBits = 0;
+
+	if (begWord == endWord) {
+		newBits |= (~visibilityBits[begWord] & begMask & endMask);
+		visibilityBits[begWord] |= (begMask & endMask);
+	} else {
+		newBits |= (~visibilityBits[begWord] & begMask);
+		visibilityBits[begWord] |= begMask;
+
+		for (unsigned int word = begWord + 1; word < endWord; ++word) {
+			newBits |= ~visibilityBits[word];
+			visibilityBits[word] = ~std::uint64_t(0);
+		}
+
+		newBits |= (~visibilityBits[endWord] & endMask);
+		visibilityBits[endWord] |= endMask;
+	}
+
+	if (newBits != 0)
+		AddChangedSpan(beg, end);
+}
+
+void CLosMap::ClearHiddenVisibilityBits(unsigned int beg, unsigned int end)
+{
+	std::uint64_t oldBits = 0;
+
+	for (unsigned int idx = beg; idx < end; ++idx) {
+		const std::uint64_t bit = std::uint64_t(losmap[idx] == 0) << (idx & 63);
+
+		oldBits |= (visibilityBits[idx >> 6] & bit);
+		visibilityBits[idx >> 6] &= ~bit;
+	}
+
+	if (oldBits != 0)
+		AddChangedSpan(beg, end);
+}
+
+void CLosMap::AddChangedSpan(unsigned int beg, unsigned int end)
+{
+	// spans normally lie on a single row, otherwise widen to full rows
+	const int z1 = beg / size.x;
+	const int z2 = (end - 1) / size.x + 1;
+	const int x1 = (z2 - z1 == 1) ? beg % size.x : 0;
+	const int x2 = (z2 - z1 == 1) ? (end - 1) % size.x + 1 : size.x;
+
+	const auto AddToRect = [&](SRectangle& rect) {
+		if (rect.GetArea() == 0) {
+			rect = SRectangle(x1, z1, x2, z2);
+			return;
 		}
+
+		rect.x1 = std::min(rect.x1, x1);
+		rect.z1 = std::min(rect.z1, z1);
+		rect.x2 = std::max(rect.x2, x2);
+		rect.z2 = std::max(rect.z2, z2);
+	};
+
+	AddToRect(changedRect);
+	AddToRect(mergedChangedRect);
+}
+
+
+void CLosMap::MoveCircle(const SLosInstance* oldInstance, const SLosInstance* newInstance)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(oldInstance->radius == newInstance->radius);
+
+	const int radius = newInstance->radius;
+	const int2 oldPos = oldInstance->basePos;
+	const int2 newPos = newInstance->basePos;
+
+	std::vector<int>& widths = CIRCLE_WIDTH_TABLES[ThreadPool::GetThreadNum()];
+	widths.resize(2 * radius + 1);
+
+	MidpointCircleAlgoPerLine(radius, [&](int width, int y) {
+		widths[y + radius] = width;
 	});
+
+	const auto AddLineSpan = [&](unsigned y_, int sx, int ex, int amount) {
+		if (sx < ex)
+			AddSpan((y_ * size.x) + sx, (y_ * size.x) + ex, amount);
+	};
+
+	const int minY = std::min(oldPos.y, newPos.y) - radius;
+	const int maxY = std::max(oldPos.y, newPos.y) + radius;
+
+	for (int y = minY; y <= maxY; ++y) {
+		const unsigned y_ = y;
+
+		if (y_ >= size.y)
+			continue;
+
+		// [osx, oex) and [nsx, nex) are the clamped spans AddCircle would cover on this line
+		int osx = 0, oex = 0;
+		int nsx = 0, nex = 0;
+
+		if (std::abs(y - oldPos.y) <= radius) {
+			const int width = widths[y - oldPos.y + radius];
+
+			osx = std::clamp(oldPos.x - width,     0, size.x);
+			oex = std::clamp(oldPos.x + width + 1, 0, size.x);
+		}
+		if (std::abs(y - newPos.y) <= radius) {
+			const int width = widths[y - newPos.y + radius];
+
+			nsx = std::clamp(newPos.x - width,     0, size.x);
+			nex = std::clamp(newPos.x + width + 1, 0, size.x);
+		}
+
+		if (osx >= oex || nsx >= nex) {
+			AddLineSpan(y_, osx, oex, -1);
+			AddLineSpan(y_, nsx, nex,  1);
+			continue;
+		}
+
+		// only the parts of each span outside of the other one change
+		AddLineSpan(y_, osx, std::min(oex, nsx), -1);
+		AddLineSpan(y_, std::max(osx, nex), oex, -1);
+		AddLineSpan(y_, nsx, std::min(nex, osx),  1);
+		AddLineSpan(y_, std::max(nsx, oex), nex,  1);
+	}
 }
 
 
@@ -455,15 +655,15 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 
 				readMap->UpdateLOS(SRectangle(p1.x, p1.y,  p3.x, p3.y));
 			}
+
+			SetVisibilityBits(rle.start, rle.start + rle.length);
 		}
 
 		return;
 	}
 
 	for (const SLosInstance::RLE rle: losSquares) {
-		for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-			losmap[idx] += amount;
-		}
+		AddSpan(rle.start, rle.start + rle.length, amount);
 	}
 }
 
@@ -488,7 +688,7 @@ void CLosMap::PrepareRaycast(SLosInstance* instance) const
 
 void CLosMap::LosAdd(SLosInstance* li) const
 {
-	RECOIL_DETAILED_TRACY_ZONE;
+	RECOIL_TRACY_ZONE(LOS);
 	const auto MAP_SQUARE_FULLRES = [&](int2 pos) {
 		float2 fpos = pos;
 		fpos += 0.5f;
@@ -515,13 +715,6 @@ void CLosMap::LosAdd(SLosInstance* li) const
 }
 
 
-inline static constexpr size_t ToAngleMapIdx(const int2 p, const int radius)
-{
-	// [-radius, +radius]^2 -> [0, +2*radius]^2 -> idx
-	return (p.y + radius) * (2 * radius + 1) + (p.x + radius);
-}
-
-
 inline void CastLos(
 	float* prvAngle,
 	float* maxAngle,
@@ -553,6 +746,31 @@ inline void CastLos(
 	*prvAngle = raycastAngles[oidx];
 }
 
+// CastLos without branches, for one square of four rays at once; gives the
+// same results, and lets the compiler keep all four rays' state in registers
+inline void CastLos4(
+	float* prvAngles,
+	float* maxAngles,
+	const std::array<unsigned int, 4>& oidcs,
+	float invR,
+	char* losRaySquares,
+	const float* raycastAngles
+) {
+	for (int k = 0; k < 4; k++) {
+		const float angle = raycastAngles[oidcs[k]];
+
+		const bool belowMax = (angle < maxAngles[k]);
+		const bool belowPrv = (!belowMax && angle < prvAngles[k]);
+
+		maxAngles[k] = belowPrv? (prvAngles[k] - LOS_BONUS_HEIGHT * invR): maxAngles[k];
+
+		const bool hidden = (belowMax || (belowPrv && angle < maxAngles[k]));
+
+		prvAngles[k] = hidden? prvAngles[k]: angle;
+		losRaySquares[oidcs[k]] &= !hidden;
+	}
+}
+
 
 void CLosMap::AddSquaresToInstance(SLosInstance* li, const std::vector<char>& losRaySquares) const
 {
@@ -656,24 +874,18 @@ void CLosMap::UnsafeLosAdd(SLosInstance* li) const
 		}
 	});
 
-	// cast the rays
+	// cast the rays, each square together with its three mirrors
 	losRaySquares[ToAngleMapIdx(int2(0, 0), radius)] = true;
 
-	const size_t numRays = helper.GetLosTableSize(radius);
+	const CLosTableHelper::LosRayKernel& kernel = helper.GetLosRayKernel(radius);
+	const size_t numRays = std::max(kernel.rayOffsets.size(), size_t(1)) - 1;
 
 	for (size_t i = 0; i < numRays; ++i) {
 		float maxAngles[4] = {-1e7, -1e7, -1e7, -1e7};
 		float prvAngles[4] = {-1e7, -1e7, -1e7, -1e7};
 
-		const size_t numSquares = helper.GetLosTableRaySize(radius, i);
-
-		for (size_t n = 0; n < numSquares; n++) {
-			const int2 square = helper.GetLosTableRaySquare(radius, i, n);
-
-			CastLos(&prvAngles[0], &maxAngles[0],       square              , losRaySquares, raycastAngles, radius, threadNum);
-			CastLos(&prvAngles[1], &maxAngles[1],      -square              , losRaySquares, raycastAngles, radius, threadNum);
-			CastLos(&prvAngles[2], &maxAngles[2], int2( square.y, -square.x), losRaySquares, raycastAngles, radius, threadNum);
-			CastLos(&prvAngles[3], &maxAngles[3], int2(-square.y,  square.x), losRaySquares, raycastAngles, radius, threadNum);
+		for (size_t n = kernel.rayOffsets[i], e = kernel.rayOffsets[i + 1]; n < e; n++) {
+			CastLos4(&prvAngles[0], &maxAngles[0], kernel.squareIndices[n], kernel.squareInvRadii[n], losRaySquares.data(), raycastAngles.data());
 		}
 	}
 
@@ -5,8 +5,10 @@
 #ifndef LOS_MAP_H
 #define LOS_MAP_H
 
+#include <cstdint>
 #include <vector>
 #include "System/type2.h"
+#include "System/Rectangle.h"
 #include "System/SpringMath.h"
 
 
@@ -24,6 +26,10 @@ public:
 
 		losmap.clear();
 		losmap.resize(size.x * size.y, 0);
+		visibilityBits.clear();
+		visibilityBits.resize((size.x * size.y + 63) / 64, 0);
+		changedRect = {};
+		mergedChangedRect = {};
 
 		ctrHeightMap = ctrHeightMap_;
 		mipHeightMap = mipHeightMap_;
@@ -37,6 +43,10 @@ public:
 	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
 	void AddCircle(SLosInstance* instance, int amount);
 
+	/// same as AddCircle(oldInstance, -1) plus AddCircle(newInstance, 1) for two circles
+	/// of equal radius, but touches only the squares where their footprints differ
+	void MoveCircle(const SLosInstance* oldInstance, const SLosInstance* newInstance);
+
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void AddRaycast(SLosInstance* instance, int amount);
 
@@ -50,9 +60,36 @@ public:
 		return losmap[p.y * size.x + p.x];
 	}
 
+	/// same as At(p) != 0, but reads the bit-plane which packs 16 times as many squares per cache-line
+	bool IsVisible(int2 p) const {
+		p.x = std::clamp(p.x, 0, size.x - 1);
+		p.y = std::clamp(p.y, 0, size.y - 1);
+
+		const unsigned int idx = p.y * size.x + p.x;
+		return ((visibilityBits[idx >> 6] >> (idx & 63)) & 1);
+	}
+
 	// FIXME temp fix for CBaseGroundDrawer and AI interface, which need raw data
 	const unsigned short& front() const { return losmap.front(); }
 	const auto& GetLosMap() const { return losmap; }
+	/// bit i is set iff losmap[i] != 0, 64 squares per word
+	const auto& GetVisibilityBits() const { return visibilityBits; }
+
+	/// bounds of the squares whose visibility bit changed since the last ClearChangedRect, empty if none
+	const SRectangle& GetChangedRect() const { return changedRect; }
+	void ClearChangedRect() { changedRect = {}; }
+
+	/// same as GetChangedRect, but consumed by ILosType::GetMergedLosMap instead of the per-allyteam views
+	const SRectangle& GetMergedChangedRect() const { return mergedChangedRect; }
+	void ClearMergedChangedRect() { mergedChangedRect = {}; }
+
+private:
+	// adds <amount> to the squares [beg, end) and keeps the bit-plane in sync
+	void AddSpan(unsigned int beg, unsigned int end, int amount);
+	void SetVisibilityBits(unsigned int beg, unsigned int end);
+	void ClearHiddenVisibilityBits(unsigned int beg, unsigned int end);
+	void AddChangedSpan(unsigned int beg, unsigned int end);
+
 private:
 	void LosAdd(SLosInstance* instance) const;
 	void UnsafeLosAdd(SLosInstance* instance) const;
@@ -65,6 +102,11 @@ protected:
 	int2 LOS2HEIGHT;
 
 	std::vector<unsigned short> losmap;
+	// derived from losmap, updated whenever a counter changes from or to zero
+	std::vector<std::uint64_t> visibilityBits;
+	// consumed by the unsynced info-textures to re-upload only what changed
+	SRectangle changedRect;
+	SRectangle mergedChangedRect;
 
 	const float* ctrHeightMap = nullptr;
 	const float* mipHeightMap = nullptr;
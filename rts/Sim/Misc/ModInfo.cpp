@@ -117,6 +117,9 @@ void CModInfo::ResetState()
 		pfRawMoveSpeedThreshold = 0.f;
 		qtMaxNodesSearched = 8192;
 		qtRefreshPathMinDist = 512.f;
+		qtMaxSearchesPerFrame = 0;
+		qtFlowFieldMinGroupSize = 0;
+		qtAbstractGraphMinDist = 0.f;
 		qtMaxNodesSearchedRelativeToMapOpenNodes = 0.25;
 
 		enableSmoothMesh = true;
@@ -176,6 +179,9 @@ void CModInfo::Init(const std::string& modFileName)
 		pfRawMoveSpeedThreshold = system.GetFloat("pfRawMoveSpeedThreshold", pfRawMoveSpeedThreshold);
 		qtMaxNodesSearched = system.GetInt("qtMaxNodesSearched", qtMaxNodesSearched);
 		qtRefreshPathMinDist = system.GetFloat("qtRefreshPathMinDist", qtRefreshPathMinDist);
+		qtMaxSearchesPerFrame = system.GetInt("qtMaxSearchesPerFrame", qtMaxSearchesPerFrame);
+		qtFlowFieldMinGroupSize = system.GetInt("qtFlowFieldMinGroupSize", qtFlowFieldMinGroupSize);
+		qtAbstractGraphMinDist = system.GetFloat("qtAbstractGraphMinDist", qtAbstractGraphMinDist);
 		qtMaxNodesSearchedRelativeToMapOpenNodes = system.GetFloat("qtMaxNodesSearchedRelativeToMapOpenNodes", qtMaxNodesSearchedRelativeToMapOpenNodes);
 
 		enableSmoothMesh = system.GetBool("enableSmoothMesh", enableSmoothMesh);
@@ -362,6 +368,9 @@ void CModInfo::Init(const std::string& modFileName)
 	qtMaxNodesSearched                       = std::max  (qtMaxNodesSearched                      , 1024          );
 	qtMaxNodesSearchedRelativeToMapOpenNodes = std::max  (qtMaxNodesSearchedRelativeToMapOpenNodes,    0.0f       );
 	qtRefreshPathMinDist                     = std::max  (qtRefreshPathMinDist                    ,    0.0f       );
+	qtMaxSearchesPerFrame                    = std::max  (qtMaxSearchesPerFrame                   ,    0          );
+	qtFlowFieldMinGroupSize                  = std::max  (qtFlowFieldMinGroupSize                 ,    0          );
+	qtAbstractGraphMinDist                   = std::max  (qtAbstractGraphMinDist                  ,    0.0f       );
 	quadFieldQuadSizeInElmos                 = std::clamp(quadFieldQuadSizeInElmos                ,    8    , 1024);
 	smoothMeshResDivider                     = std::max  (smoothMeshResDivider                    ,    1          );
 	smoothMeshSmoothRadius                   = std::max  (smoothMeshSmoothRadius                  ,    1          );
@@ -214,6 +214,21 @@ public:
 	/// would bring the unit nearer to the goal.
 	float qtRefreshPathMinDist;
 
+	/// Maximum number of synced path searches QTPFS executes per frame, 0 for no limit. Searches
+	/// beyond the limit stay queued, oldest request first, so a mass move order is spread over a
+	/// few frames instead of causing one long frame.
+	int qtMaxSearchesPerFrame;
+
+	/// Number of synced QTPFS searches in one frame for the same move type, goal quad and goal
+	/// radius from which they share a single flow-field (a reverse search from the goal) instead
+	/// of searching individually, 0 to disable.
+	int qtFlowFieldMinGroupSize;
+
+	/// Straight-line distance (in elmos) from which QTPFS first searches a coarse graph of
+	/// root-node clusters and then limits the regular search to the clusters along that route,
+	/// 0 to disable. The coarse graph is only built when enabled.
+	float qtAbstractGraphMinDist;
+
 	float pfRawDistMult;
 	float pfUpdateRateScale;
 
@@ -7,6 +7,7 @@
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/QuadFieldTrace.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/ContainerUtil.h"
 #include "System/Threading/ThreadPool.h"
@@ -33,7 +34,11 @@ CR_REG_METADATA(CQuadField, (
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+	CR_IGNORED(quadsChangeLists),
+	CR_IGNORED(mergedQuadsChanges),
+	CR_IGNORED(unitsQueryCaches),
+	CR_IGNORED(unitQuadsVersion)
 ))
 
 CR_BIND(CQuadField::Quad, )
@@ -78,7 +83,10 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 
 	invQuadSize = {1.0f / quadSizeX, 1.0f / quadSizeZ};
 
+	QUADFIELD_TRACE_QUERY(mapDims, quadSize);
+
 	baseQuads.resize(numQuadsX * numQuadsZ);
+	ClearUnitsQueryCaches();
 
 	size_t threadCount = ThreadPool::GetNumThreads();
 
@@ -104,6 +112,8 @@ void CQuadField::Kill()
 		quad.Clear();
 	}
 
+	ClearUnitsQueryCaches();
+
 	for (auto cache : tempUnits)
 		cache.ReleaseAll();
 
@@ -120,6 +130,20 @@ void CQuadField::Kill()
 }
 
 
+void CQuadField::ClearUnitsQueryCaches()
+{
+	for (UnitsQueryCache& cache: unitsQueryCaches) {
+		for (UnitsQueryCacheEntry& entry: cache.entries) {
+			entry = {};
+		}
+
+		cache.nextEntry = 0;
+	}
+
+	unitQuadsVersion = 0;
+}
+
+
 int2 CQuadField::WorldPosToQuadField(const float3 p) const
 {
 	return int2(
@@ -136,10 +160,10 @@ int CQuadField::WorldPosToQuadFieldIdx(const float3 p) const
 }
 
 
-#ifndef UNIT_TEST // ClampInBounds() is not linked
 void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	QUADFIELD_TRACE_QUERY(QuadFieldTrace::QUERY_CIRCLE, pos, ZeroVector, radius, 0.0f);
 	pos.AssertNaNs();
 	pos.ClampInBounds();
 	qfq.quads = tempQuads[qfq.threadOwner].ReserveVector();
@@ -171,6 +195,7 @@ void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
 void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	QUADFIELD_TRACE_QUERY(QuadFieldTrace::QUERY_RECTANGLE, mins, maxs, 0.0f, 0.0f);
 	mins.AssertNaNs();
 	maxs.AssertNaNs();
 	qfq.quads = tempQuads[qfq.threadOwner].ReserveVector();
@@ -191,13 +216,13 @@ void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, cons
 
 	return;
 }
-#endif // UNIT_TEST
 
 
 /// note: this function got an UnitTest, check the tests/ folder!
 void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	QUADFIELD_TRACE_QUERY(QuadFieldTrace::QUERY_RAY, start, dir, length, 0.0f);
 	dir.AssertNaNs();
 	start.AssertNaNs();
 
@@ -281,7 +306,6 @@ void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const f
 	}
 }
 
-#ifndef UNIT_TEST // needs GetQuadsRectangle()
 // Test with wide ray that also extends width at the extremes.
 void CQuadField::GetQuadsOnWideRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length, float width)
 {
@@ -312,6 +336,9 @@ void CQuadField::GetQuadsOnWideRay(QuadFieldQuery& qfq, const float3& start, con
 		return GetQuadsRectangle(qfq, mins, maxs);
 	}
 
+	// the rectangle case above is traced as such
+	QUADFIELD_TRACE_QUERY(QuadFieldTrace::QUERY_WIDE_RAY, start, dir, length, width);
+
 	auto& queryQuads = *(qfq.quads = tempQuads[qfq.threadOwner].ReserveVector());
 
 	// iterate z-range; compute which columns (x) are touched for each row (z)
@@ -371,7 +398,6 @@ void CQuadField::GetQuadsOnWideRay(QuadFieldQuery& qfq, const float3& start, con
 		}
 	}
 }
-#endif
 
 
 #ifndef UNIT_TEST
@@ -393,6 +419,7 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
 	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
+	unitQuadsVersion++;
 	return true;
 }
 
@@ -424,6 +451,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 
 	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
 	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
+	unitQuadsVersion++;
 	return true;
 }
 #endif
@@ -454,6 +482,74 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
+	unitQuadsVersion++;
+}
+
+void CQuadField::MovedUnits(const std::vector<CUnit*>& units)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (QuadsChangeList& changeList: quadsChangeLists) {
+		changeList.changes.clear();
+		changeList.quads.clear();
+	}
+
+	// read-only w.r.t. the quads, only the change-lists are written
+	for_mt_chunk(0, units.size(), [&](const int i) {
+		const CUnit* unit = units[i];
+		const int threadNum = ThreadPool::GetThreadNum();
+
+		QuadsChangeList& changeList = quadsChangeLists[threadNum];
+		QuadFieldQuery qfQuery;
+		qfQuery.threadOwner = threadNum;
+		GetQuads(qfQuery, unit->pos, unit->radius);
+
+		if (qfQuery.quads->size() == unit->quads.size()) {
+			if (std::equal(qfQuery.quads->begin(), qfQuery.quads->end(), unit->quads.begin()))
+				return;
+		}
+
+		changeList.changes.push_back({size_t(i), changeList.quads.size(), changeList.quads.size() + qfQuery.quads->size(), threadNum});
+		changeList.quads.insert(changeList.quads.end(), qfQuery.quads->begin(), qfQuery.quads->end());
+	});
+
+	MergeQuadsChanges();
+
+	for (const QuadsChange& change: mergedQuadsChanges) {
+		CUnit* unit = units[change.batchIdx];
+
+		const auto& quads = quadsChangeLists[change.threadNum].quads;
+		const auto quadsBeg = quads.begin() + change.quadsBeg;
+		const auto quadsEnd = quads.begin() + change.quadsEnd;
+
+		for (const int qi: unit->quads) {
+			spring::VectorErase(baseQuads[qi].units, unit);
+			spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		}
+
+		for (auto it = quadsBeg; it != quadsEnd; ++it) {
+			spring::VectorInsertUnique(baseQuads[*it].units, unit, false);
+			spring::VectorInsertUnique(baseQuads[*it].teamUnits[unit->allyteam], unit, false);
+		}
+
+		unit->quads.assign(quadsBeg, quadsEnd);
+	}
+
+	unitQuadsVersion += (!mergedQuadsChanges.empty());
+}
+
+void CQuadField::MergeQuadsChanges()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	mergedQuadsChanges.clear();
+
+	for (const QuadsChangeList& changeList: quadsChangeLists) {
+		mergedQuadsChanges.insert(mergedQuadsChanges.end(), changeList.changes.begin(), changeList.changes.end());
+	}
+
+	// which thread found a change depends on scheduling, the order they are applied in must not
+	std::sort(mergedQuadsChanges.begin(), mergedQuadsChanges.end(), [](const QuadsChange& a, const QuadsChange& b) {
+		return (a.batchIdx < b.batchIdx);
+	});
 }
 
 void CQuadField::RemoveUnit(CUnit* unit)
@@ -465,6 +561,7 @@ void CQuadField::RemoveUnit(CUnit* unit)
 	}
 
 	unit->quads.clear();
+	unitQuadsVersion++;
 
 	#ifdef DEBUG_QUADFIELD
 	for (const Quad& q: baseQuads) {
@@ -553,6 +650,28 @@ void CQuadField::RemoveFeature(CFeature* feature)
 }
 
 
+void CQuadField::MovedFeature(CFeature* feature, const float3& oldPos)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	QuadFieldQuery oldQuery;
+	QuadFieldQuery newQuery;
+	GetQuads(oldQuery, oldPos, feature->radius);
+	GetQuads(newQuery, feature->pos, feature->radius);
+
+	// sliding wrecks mostly stay within the same quads
+	if (oldQuery.quads->size() == newQuery.quads->size()) {
+		if (std::equal(oldQuery.quads->begin(), oldQuery.quads->end(), newQuery.quads->begin()))
+			return;
+	}
+
+	for (const int qi: *oldQuery.quads) {
+		spring::VectorErase(baseQuads[qi].features, feature);
+	}
+	for (const int qi: *newQuery.quads) {
+		spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
+	}
+}
+
 
 void CQuadField::MovedProjectile(CProjectile* p)
 {
@@ -570,6 +689,36 @@ void CQuadField::MovedProjectile(CProjectile* p)
 	}
 }
 
+void CQuadField::MovedProjectiles(const std::vector<CProjectile*>& projectiles)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	for (QuadsChangeList& changeList: quadsChangeLists) {
+		changeList.changes.clear();
+		changeList.quads.clear();
+	}
+
+	for_mt_chunk(0, projectiles.size(), [&](const int i) {
+		const CProjectile* p = projectiles[i];
+
+		if (!p->synced)
+			return;
+		if (p->hitscan)
+			return;
+		if (WorldPosToQuadFieldIdx(p->pos) == p->quads.back())
+			return;
+
+		const int threadNum = ThreadPool::GetThreadNum();
+		quadsChangeLists[threadNum].changes.push_back({size_t(i), 0, 0, threadNum});
+	});
+
+	MergeQuadsChanges();
+
+	for (const QuadsChange& change: mergedQuadsChanges) {
+		RemoveProjectile(projectiles[change.batchIdx]);
+		AddProjectile(projectiles[change.batchIdx]);
+	}
+}
+
 void CQuadField::AddProjectile(CProjectile* p)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -608,15 +757,35 @@ void CQuadField::RemoveProjectile(CProjectile* p)
 
 
 
-void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
+const std::vector<CUnit*>& CQuadField::GetUnitCandidates(const float3& pos, float radius, int curThread)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	auto curThread = qfq.threadOwner;
+	UnitsQueryCache& cache = unitsQueryCaches[curThread];
+
+	// the quads only depend on the xz-position and radius, compare those exactly
+	for (const UnitsQueryCacheEntry& entry: cache.entries) {
+		if (entry.frameNum != gs->frameNum || entry.unitQuadsVersion != unitQuadsVersion)
+			continue;
+		if (entry.posX != pos.x || entry.posZ != pos.z || entry.radius != radius)
+			continue;
+
+		return entry.candidates;
+	}
+
+	UnitsQueryCacheEntry& entry = cache.entries[cache.nextEntry];
+	cache.nextEntry = (cache.nextEntry + 1) % cache.entries.size();
+
+	entry.posX = pos.x;
+	entry.posZ = pos.z;
+	entry.radius = radius;
+	entry.frameNum = gs->frameNum;
+	entry.unitQuadsVersion = unitQuadsVersion;
+	entry.candidates.clear();
+
 	QuadFieldQuery qfQuery;
 	qfQuery.threadOwner = curThread;
 	GetQuads(qfQuery, pos, radius);
 	const int tempNum = gs->GetMtTempNum(curThread);
-	qfq.units = tempUnits[curThread].ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
@@ -624,44 +793,44 @@ void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 				continue;
 
 			u->mtTempNum[curThread] = tempNum;
-			qfq.units->push_back(u);
+			entry.candidates.push_back(u);
 		}
 	}
 
-	return;
+	return entry.candidates;
 }
 
-void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float radius, bool spherical)
+void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
 	auto curThread = qfq.threadOwner;
-	QuadFieldQuery qfQuery;
-	qfQuery.threadOwner = curThread;
-	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetMtTempNum(curThread);
+	const std::vector<CUnit*>& candidates = GetUnitCandidates(pos, radius, curThread);
+
 	qfq.units = tempUnits[curThread].ReserveVector();
+	qfq.units->assign(candidates.begin(), candidates.end());
+}
 
-	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
-			if (u->mtTempNum[curThread] == tempNum)
-				continue;
+void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float radius, bool spherical)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto curThread = qfq.threadOwner;
+	// positions may have changed since the candidates were cached, so always re-test them
+	const std::vector<CUnit*>& candidates = GetUnitCandidates(pos, radius, curThread);
 
-			u->mtTempNum[curThread] = tempNum;
+	qfq.units = tempUnits[curThread].ReserveVector();
 
-			const float totRad       = radius + u->radius;
-			const float totRadSq     = totRad * totRad;
-			const float posUnitDstSq = spherical?
-				pos.SqDistance(u->pos):
-				pos.SqDistance2D(u->pos);
+	for (CUnit* u: candidates) {
+		const float totRad       = radius + u->radius;
+		const float totRadSq     = totRad * totRad;
+		const float posUnitDstSq = spherical?
+			pos.SqDistance(u->pos):
+			pos.SqDistance2D(u->pos);
 
-			if (posUnitDstSq >= totRadSq)
-				continue;
+		if (posUnitDstSq >= totRadSq)
+			continue;
 
-			qfq.units->push_back(u);
-		}
+		qfq.units->push_back(u);
 	}
-
-	return;
 }
 
 void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
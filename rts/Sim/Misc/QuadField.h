@@ -151,10 +151,22 @@ public:
 	void MovedUnit(CUnit* unit);
 	void RemoveUnit(CUnit* unit);
 
+	/**
+	 * Batched MovedUnit: the new quad sets are computed in parallel into
+	 * per-thread change-lists, which are then applied serially in batch
+	 * order. Leaves every quad exactly as calling MovedUnit on each unit
+	 * in turn would; @c units must not contain duplicates.
+	 */
+	void MovedUnits(const std::vector<CUnit*>& units);
+
 	void AddFeature(CFeature* feature);
 	void RemoveFeature(CFeature* feature);
+	/// like RemoveFeature at oldPos plus AddFeature, but leaves the quads alone if the feature stays within them
+	void MovedFeature(CFeature* feature, const float3& oldPos);
 
 	void MovedProjectile(CProjectile* projectile);
+	/// batched MovedProjectile, see MovedUnits
+	void MovedProjectiles(const std::vector<CProjectile*>& projectiles);
 	void AddProjectile(CProjectile* projectile);
 	void RemoveProjectile(CProjectile* projectile);
 
@@ -219,6 +231,9 @@ public:
 	}
 
 
+	// bumped whenever the unit contents of any quad change
+	unsigned int GetUnitQuadsVersion() const { return unitQuadsVersion; }
+
 	int GetNumQuadsX() const { return numQuadsX; }
 	int GetNumQuadsZ() const { return numQuadsZ; }
 
@@ -231,7 +246,42 @@ private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	void MergeQuadsChanges();
+
+	// deduplicated contents of the quads overlapping the (pos, radius) circle, served from
+	// the calling thread's query cache if the same circle was asked for already this frame
+	const std::vector<CUnit*>& GetUnitCandidates(const float3& pos, float radius, int curThread);
+	void ClearUnitsQueryCaches();
+
 private:
+	struct QuadsChange {
+		size_t batchIdx;
+		// range into the owning change-list's quads
+		size_t quadsBeg;
+		size_t quadsEnd;
+		int threadNum;
+	};
+	struct QuadsChangeList {
+		std::vector<QuadsChange> changes;
+		std::vector<int> quads;
+	};
+
+	struct UnitsQueryCacheEntry {
+		float posX = 0.0f;
+		float posZ = 0.0f;
+		float radius = -1.0f;
+
+		int frameNum = -1;
+		unsigned int unitQuadsVersion = 0;
+
+		// contiguous, so repeated queries don't walk the per-quad vectors again
+		std::vector<CUnit*> candidates;
+	};
+	struct UnitsQueryCache {
+		std::array<UnitsQueryCacheEntry, 4> entries;
+		size_t nextEntry = 0;
+	};
+
 	std::vector<Quad> baseQuads;
 
 	// preallocated vectors for Get*Exact functions
@@ -241,6 +291,15 @@ private:
 	std::array< QueryVectorCache<CSolidObject*>, ThreadPool::MAX_THREADS > tempSolids;
 	std::array< QueryVectorCache<int>, ThreadPool::MAX_THREADS > tempQuads;
 
+	// scratch space for the batched Moved* functions
+	std::array< QuadsChangeList, ThreadPool::MAX_THREADS > quadsChangeLists;
+	std::vector<QuadsChange> mergedQuadsChanges;
+
+	// frame-local caches for GetUnits and GetUnitsExact; any change to the unit
+	// contents of a quad bumps the version and thereby invalidates all entries
+	std::array< UnitsQueryCache, ThreadPool::MAX_THREADS > unitsQueryCaches;
+	unsigned int unitQuadsVersion = 0;
+
 	float2 invQuadSize;
 
 	int numQuadsX;
@@ -0,0 +1,108 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QUAD_FIELD_TRACE_H
+#define QUAD_FIELD_TRACE_H
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "System/float3.h"
+#include "System/type2.h"
+
+#if defined(QUADFIELD_TRACE)
+	#define QUADFIELD_TRACE_QUERY(...) QuadFieldTrace::Record(__VA_ARGS__)
+#else
+	#define QUADFIELD_TRACE_QUERY(...)
+#endif
+
+/**
+ * Query traces of CQuadField, replayed by test/other/benchmarkQuadFieldTrace.
+ *
+ * Built with QUADFIELD_TRACE, every quad lookup (which all unit, feature and
+ * projectile queries start with) is appended to quadfield_trace.txt in the
+ * working directory: one "m" line with the map and quad size per Init, then one
+ * line per query as "c pos radius", "r mins maxs", "l start dir length" or
+ * "w start dir length width". Without the build option the macro expands to
+ * nothing.
+ */
+namespace QuadFieldTrace {
+	enum QueryType {
+		QUERY_CIRCLE    = 'c',
+		QUERY_RECTANGLE = 'r',
+		QUERY_RAY       = 'l',
+		QUERY_WIDE_RAY  = 'w',
+	};
+
+	struct Query {
+		int type;
+		float3 a; // pos, mins or start
+		float3 b; // maxs or dir
+		float length; // radius or length
+		float width;
+	};
+
+	struct Trace {
+		int2 mapDims;
+		int quadSize = 0;
+		std::vector<Query> queries;
+	};
+
+	#if defined(QUADFIELD_TRACE)
+	inline std::mutex& GetMutex() { static std::mutex mutex; return mutex; }
+	inline FILE* GetFile() {
+		static FILE* file = fopen("quadfield_trace.txt", "w");
+		return file;
+	}
+
+	inline void Record(int2 mapDims, int quadSize) {
+		const std::lock_guard<std::mutex> lock(GetMutex());
+
+		if (FILE* f = GetFile(); f != nullptr)
+			fprintf(f, "m %d %d %d\n", mapDims.x, mapDims.y, quadSize);
+	}
+	inline void Record(QueryType type, const float3& a, const float3& b, float length, float width) {
+		const std::lock_guard<std::mutex> lock(GetMutex());
+
+		if (FILE* f = GetFile(); f != nullptr)
+			fprintf(f, "%c %a %a %a %a %a %a %a %a\n", type, a.x, a.y, a.z, b.x, b.y, b.z, length, width);
+	}
+	#endif
+
+	// reads the first map section of <fileName>; returns false if there is none
+	inline bool Load(const char* fileName, Trace& trace) {
+		FILE* f = fopen(fileName, "r");
+
+		if (f == nullptr)
+			return false;
+
+		char line[512];
+		char type;
+		Query q;
+
+		while (fgets(line, sizeof(line), f) != nullptr) {
+			if (line[0] == 'm') {
+				// a second game in the same file
+				if (trace.quadSize != 0)
+					break;
+
+				sscanf(line, "m %d %d %d", &trace.mapDims.x, &trace.mapDims.y, &trace.quadSize);
+				continue;
+			}
+
+			if (trace.quadSize == 0)
+				continue;
+
+			if (sscanf(line, "%c %a %a %a %a %a %a %a %a", &type, &q.a.x, &q.a.y, &q.a.z, &q.b.x, &q.b.y, &q.b.z, &q.length, &q.width) != 9)
+				continue;
+
+			q.type = type;
+			trace.queries.push_back(q);
+		}
+
+		fclose(f);
+		return (trace.quadSize != 0);
+	}
+}
+
+#endif // QUAD_FIELD_TRACE_H
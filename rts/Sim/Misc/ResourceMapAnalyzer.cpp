@@ -18,11 +18,16 @@ using std::fclose;
 #include "Game/GameSetup.h"
 #include "Map/MapInfo.h"
 #include "Map/MetalMap.h"
+#include "System/CRC.h"
+#include "System/FileSystem/ArchiveScanner.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+#include "System/Threading/ThreadPool.h"
 
+#include <algorithm>
 #include <stdexcept>
 
 #include "System/Misc/TracyDefs.h"
@@ -30,6 +35,9 @@ using std::fclose;
 static constexpr float3 ERRORVECTOR(-1, 0, 0);
 static std::string CACHE_BASE("");
 
+// bump whenever the spot search or the file layout changes
+static constexpr int CACHE_VERSION = 2;
+
 CResourceMapAnalyzer::CResourceMapAnalyzer(int resourceId)
 	: resourceId(resourceId)
 	, numSpotsFound(-1)
@@ -177,80 +185,48 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 		return;
 
 	// Now work out how much resources each spot can make
-	// by adding up the resources from nearby spots
-	for (int y = 0; y < mapHeight; y++) {
-		for (int x = 0; x < mapWidth; x++) {
-			totalResources = 0;
-
-			// first spot needs full calculation
-			if (x == 0 && y == 0)
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight){
-						for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
-							if (sx >= 0 && sx < mapWidth) {
-								// get the resources from all pixels around the extractor radius
-								totalResources += rexArrayA[sy * mapWidth + sx];
-							}
-						}
-					}
-				}
-
-			// quick calc test
-			if (x > 0) {
-				totalResources = tempAverage[y * mapWidth + x - 1];
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight) {
-						const int addX = x + xend[a];
-						const int remX = x - xend[a] - 1;
-
-						if (addX < mapWidth) {
-							totalResources += rexArrayA[sy * mapWidth + addX];
-						}
-						if (remX >= 0) {
-							totalResources -= rexArrayA[sy * mapWidth + remX];
-						}
-					}
-				}
-			} else if (y > 0) {
-				// x == 0 here
-				totalResources = tempAverage[(y - 1) * mapWidth];
-				// remove the top half
-				int a = xtractorRadius;
-
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int remY = y - xend[a] - 1;
-
-						if (remY >= 0) {
-							totalResources -= rexArrayA[remY * mapWidth + sx];
-						}
+	// by adding up the resources from nearby spots; every
+	// row starts with a full sum over the extractor circle
+	// and then slides along x, so rows are independent
+	for_mt(0, mapHeight, [&](const int y) {
+		int rowResources = 0;
+
+		for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				for (int sx = -xend[a]; sx <= xend[a]; sx++) {
+					if (sx >= 0 && sx < mapWidth) {
+						// get the resources from all pixels around the extractor radius
+						rowResources += rexArrayA[sy * mapWidth + sx];
 					}
 				}
+			}
+		}
 
-				// add the bottom half
-				a = xtractorRadius;
+		tempAverage[y * mapWidth] = rowResources;
 
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int addY = y + xend[a];
+		for (int x = 1; x < mapWidth; x++) {
+			for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+				if (sy >= 0 && sy < mapHeight) {
+					const int addX = x + xend[a];
+					const int remX = x - xend[a] - 1;
 
-						if (addY < mapHeight) {
-							totalResources += rexArrayA[addY * mapWidth + sx];
-						}
+					if (addX < mapWidth) {
+						rowResources += rexArrayA[sy * mapWidth + addX];
+					}
+					if (remX >= 0) {
+						rowResources -= rexArrayA[sy * mapWidth + remX];
 					}
 				}
 			}
 
 			// set that spot's resource making ability
 			// (divide by cells to values are small)
-			tempAverage[y * mapWidth + x] = totalResources;
-
-			if (maxResource < totalResources) {
-				// find the spot with the highest resource value to set as the map's max
-				maxResource = totalResources;
-			}
+			tempAverage[y * mapWidth + x] = rowResources;
 		}
-	}
+	});
+
+	// find the spot with the highest resource value to set as the map's max
+	maxResource = *std::max_element(tempAverage.begin(), tempAverage.end());
 
 	// make a list for the distribution of values
 	std::vector<int> valueDist(256, 0);
@@ -525,6 +501,8 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 			throw std::runtime_error("failed to open file for writing");
 
 		assert(numSpotsFound != -1);
+		writeToFile(CACHE_VERSION, saveFile);
+		writeToFile(GetResourceMapChecksum(), saveFile);
 		writeToFile(numSpotsFound, saveFile);
 		writeToFile(averageIncome, saveFile);
 		for (int i = 0; i < numSpotsFound; i++) {
@@ -534,7 +512,8 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 		LOG_L(L_WARNING, "Failed to save the analyzed resource-map to file %s, reason: %s", cacheFileName.c_str(), err.what());
 	}
 
-	fclose(saveFile);
+	if (saveFile != nullptr)
+		fclose(saveFile);
 }
 
 static void fileReadChecked(void* buf, size_t size, size_t count, FILE* fstream) {
@@ -556,6 +535,16 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 
 	if (cacheFile != nullptr) {
 		try {
+			int cacheVersion = 0;
+			uint32_t cacheChecksum = 0;
+
+			fileReadChecked(&cacheVersion, sizeof(int), 1, cacheFile);
+			fileReadChecked(&cacheChecksum, sizeof(uint32_t), 1, cacheFile);
+
+			// stale file, or the resource map was altered (e.g. by a mapinfo override)
+			if (cacheVersion != CACHE_VERSION || cacheChecksum != GetResourceMapChecksum())
+				throw std::runtime_error("outdated cache");
+
 			fileReadChecked(&numSpotsFound, sizeof(int), 1, cacheFile);
 			vectoredSpots.resize(numSpotsFound);
 			fileReadChecked(&averageIncome, sizeof(float), 1, cacheFile);
@@ -564,6 +553,9 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 			}
 			loaded = true;
 		} catch (const std::runtime_error& err) {
+			numSpotsFound = -1;
+			vectoredSpots.clear();
+			averageIncome = 0.0f;
 			LOG_L(L_WARNING, "Failed to load the resource map cache from file %s: %s", cacheFileName.c_str(), err.what());
 		}
 		fclose(cacheFile);
@@ -579,5 +571,13 @@ std::string CResourceMapAnalyzer::GetCacheFileName() const {
 	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
 	std::string absFile = CACHE_BASE + gameSetup->mapName + resource->name;
 
+	// spots depend on the map archive and on the extractor radius (set by the game)
+	absFile += "_" + IntToString(static_cast<int>(archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName)), "%08x");
+	absFile += "_" + IntToString(static_cast<int>(extractorRadius));
+
 	return absFile;
 }
+
+uint32_t CResourceMapAnalyzer::GetResourceMapChecksum() const {
+	return CRC::CalcDigest(resourceHandler->GetResourceMap(resourceId), totalCells);
+}
@@ -38,6 +38,7 @@ private:
 	bool LoadResourceMap();
 
 	std::string GetCacheFileName() const;
+	uint32_t GetResourceMapChecksum() const;
 
 	int resourceId;
 	int numSpotsFound;
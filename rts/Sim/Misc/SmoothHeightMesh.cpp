@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <array>
 #include <vector>
 #include <cassert>
 #include <limits>
@@ -65,7 +66,7 @@ void SmoothHeightMesh::Init(int2 max, int res, int smoothRad)
 
 	enabled = modInfo.enableSmoothMesh;
 
-	// we use SSE in performance sensitive code, don't let the window size be too small.
+	// the minimum window size the former SSE maxima search needed, kept as it shapes the mesh
 	if (smoothRad < 4) smoothRad = 4;
 
 	fmaxx = max.x * SQUARE_SIZE;
@@ -102,10 +103,8 @@ void SmoothHeightMesh::InitDataStructures() {
 	mesh.resize(maxx * maxy, 0.0f);
 	tempMesh.resize(maxx * maxy, 0.0f);
 	origMesh.resize(maxx * maxy, 0.0f);
-	colsMaxima.clear();
-	colsMaxima.resize(maxx, -std::numeric_limits<float>::max());
-	maximaRows.clear();
-	maximaRows.resize(maxx, -1);
+	workBuffers.clear();
+	workBuffers.resize(ThreadPool::GetMaxThreads());
 }
 
 void SmoothHeightMesh::Kill() {
@@ -119,6 +118,7 @@ void SmoothHeightMesh::Kill() {
 	maximaMesh.clear();
 	mesh.clear();
 	origMesh.clear();
+	workBuffers.clear();
 }
 
 float SmoothHeightMesh::GetHeight(float x, float y)
@@ -164,143 +164,70 @@ inline static float GetRealGroundHeight(int x, int y, int resolution) {
 	return heightMap[baseIndex];
 }
 
-inline static void FindMaximumColumnHeights(
-	const int2 map,
-	const int y,
-	const int minx,
-	const int maxx,
-	const int winSize,
-	const int resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// initialize the algorithm: find the maximum
-	// height per column and the corresponding row
+// van Herk/Gil-Werman running maximum, out[i] = max(in[i], ..., in[i + 2*winSize]) for
+// i < numOut; <in> holds numOut + 2*winSize values and so do the scratch arrays <g> and <h>.
+// A max is exact regardless of evaluation order, so this matches a brute-force search.
+inline static void SlidingMaxRow(const float* in, float* out, int numOut, int winSize, float* g, float* h)
+{
+	const int k = winSize * 2 + 1;
+	const int n = numOut + k - 1;
 
-	const int miny = std::max(y - winSize, 0);
-	const int maxy = std::min(y + winSize, map.y - 1);
+	// prefix (g) and suffix (h) maxima within every block of k values
+	for (int b = 0; b < n; b += k) {
+		const int e = std::min(b + k, n);
 
-	for (int y1 = miny; y1 <= maxy; ++y1) {
-		for (int x = minx; x <= maxx; ++x)  {
-			const float curh = GetRealGroundHeight(x, y1, resolution);
+		g[b] = in[b];
+		for (int i = b + 1; i < e; ++i)
+			g[i] = std::max(g[i - 1], in[i]);
 
-			if (curh >= colsMaxima[x]) {
-				colsMaxima[x] = curh;
-				maximaRows[x] = y1;
-			}
-		}
+		h[e - 1] = in[e - 1];
+		for (int i = e - 2; i >= b; --i)
+			h[i] = std::max(h[i + 1], in[i]);
 	}
 
-#ifdef SMOOTH_MESH_DEBUG_MAXIMA
-	for (int x = minx; x <= maxx; ++x)
-		LOG("%s: y:%d col:%d row:%d max: %f", __func__, y, x, maximaRows[x], colsMaxima[x]);
-#endif
+	// every window spans at most two blocks
+	for (int i = 0; i < numOut; ++i)
+		out[i] = std::max(h[i], g[i + k - 1]);
 }
 
+// same as SlidingMaxRow but down the columns of a row-major block <numCols> wide,
+// all columns advance together s.t. the inner loops vectorize
+inline static void SlidingMaxColumns(const float* in, float* out, int numOut, int numCols, int winSize, float* g, float* h)
+{
+	const int k = winSize * 2 + 1;
+	const int n = numOut + k - 1;
 
-inline static void FindRadialMaximum(
-	const int2 map,
-	int y,
-	int minx,
-	int maxx,
-	int winSize,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<float>& mesh
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	for (int x = minx; x <= maxx; ++x) {
-		float maxRowHeight = -std::numeric_limits<float>::max();
-
-		// find current maximum within radius smoothRadius
-		// (in every column stack) along the current row
-		const int startx = std::max(x - winSize, 0);
-		const int endx = std::min(x + winSize, map.x - 1);
-
-		// This may mean the last SSE max function compares some values have already been compared
-		// This is harmless and avoids needlessly messy SSE code here
-		const int endIdx = endx - 3;
-
-		// Main loop for finding maximum height values
-		__m128 best = _mm_loadu_ps(&colsMaxima[startx]);
-		for (int i = startx + 4; i < endIdx; i += 4) {
-			__m128 next = _mm_loadu_ps(&colsMaxima[i]);
-			best = _mm_max_ps(best, next);
-		}
+	for (int b = 0; b < n; b += k) {
+		const int e = std::min(b + k, n);
 
-		// Check the last few height values
-		{
-			__m128 next = _mm_loadu_ps(&colsMaxima[endIdx]);
-			best = _mm_max_ps(best, next);
-		}
+		std::copy(&in[b * numCols], &in[(b + 1) * numCols], &g[b * numCols]);
+		for (int i = b + 1; i < e; ++i) {
+			const float* src = &in[i * numCols];
+			const float* prv = &g[(i - 1) * numCols];
+			      float* dst = &g[i * numCols];
 
-		// This is an SSE horizontal compare
-		{
-			// split the four values into sets of two and compare
-			__m128 bestAlt = _mm_movehl_ps(best, best);
-			best = _mm_max_ps(best, bestAlt);
-
-			// split the two values and compare
-			bestAlt = _mm_shuffle_ps(best, best, _MM_SHUFFLE(0, 0, 0, 1));
-			best = _mm_max_ss(best, bestAlt);
-			_mm_store_ss(&maxRowHeight, best);
+			for (int c = 0; c < numCols; ++c)
+				dst[c] = std::max(prv[c], src[c]);
 		}
 
-		mesh[x + y * map.x] = maxRowHeight;
-
-#ifdef SMOOTH_MESH_DEBUG_MAXIMA
-		LOG("%s: y:%d x:%d local max: %f", __func__, y, x, maxRowHeight);
-#endif
-	}
-}
-
-
-inline static void AdvanceMaximas(
-	const int2 map,
-	const int y,
-	const int minx,
-	const int maxx,
-	const int winSize,
-	const int resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// fix remaining maximums after a pass
-	const int miny = std::max(y - winSize, 0);
-	const int virtualRow = y + winSize;
-	const int maxy = std::min(virtualRow, map.y - 1);
-
-	for (int x = minx; x <= maxx; ++x) {
-		if (maximaRows[x] < miny) {
-			// find a new maximum if the old one left the window
-			colsMaxima[x] = -std::numeric_limits<float>::max();
-
-			for (int y1 = miny; y1 <= maxy; ++y1) {
-				const float h = GetRealGroundHeight(x, y1, resolution);
-
-				if (h >= colsMaxima[x]) {
-					colsMaxima[x] = h;
-					maximaRows[x] = y1;
-				}
-			}
-		} else if (virtualRow < map.y) {
-			// else, just check if a new maximum has entered the window
-			const float h = GetRealGroundHeight(x, maxy, resolution);
+		std::copy(&in[(e - 1) * numCols], &in[e * numCols], &h[(e - 1) * numCols]);
+		for (int i = e - 2; i >= b; --i) {
+			const float* src = &in[i * numCols];
+			const float* nxt = &h[(i + 1) * numCols];
+			      float* dst = &h[i * numCols];
 
-			if (h >= colsMaxima[x]) {
-				colsMaxima[x] = h;
-				maximaRows[x] = maxy;
-			}
+			for (int c = 0; c < numCols; ++c)
+				dst[c] = std::max(nxt[c], src[c]);
 		}
+	}
 
-#ifdef SMOOTH_MESH_DEBUG_MAXIMA
-		LOG("%s: y:%d x:%d column max: %f", __func__, y, x, colsMaxima[x]);
-#endif
+	for (int i = 0; i < numOut; ++i) {
+		const float* hs = &h[i * numCols];
+		const float* gs = &g[(i + k - 1) * numCols];
+		      float* dst = &out[i * numCols];
 
-		assert(maximaRows[x] <= maxy);
-		assert(maximaRows[x] >= y - winSize);
+		for (int c = 0; c < numCols; ++c)
+			dst[c] = std::max(hs[c], gs[c]);
 	}
 }
 
@@ -363,73 +290,59 @@ inline static void BlurVertical(
 	const int blurSize,
 	const int resolution,
 	const std::vector<float>& mesh,
-	      std::vector<float>& smoothed
+	      std::vector<float>& smoothed,
+	SmoothHeightMesh::WorkBuffers& wb
 ) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	// See BlurHorizontal for all the detailed comments.
+	// See BlurHorizontal for all the detailed comments; the per-column running
+	// sums advance a row at a time here, which keeps the memory accesses linear
+	// (and vectorizable) while adding up in the same order as a column walk.
 
 	const int lineSize = mapSize.x;
 	const int mapMaxY = mapSize.y - 1;
+	const int numCols = max.x - min.x + 1;
 
-	for (int x = min.x; x <= max.x; ++x)
-	{
-		float avg = 0.0f;
-		float lv = 0;
-		float rv = 0;
-		float weight = 1.f / ((float)(blurSize*2 + 1));
-		int li = min.y - blurSize;
-		int ri = min.y + blurSize;
-		for (int y1 = li; y1 <= ri; ++y1) {
-			avg += mesh[x + std::max(0, std::min(y1, mapMaxY)) * lineSize];
-		}
-		ri++;
+	const float weight = 1.f / ((float)(blurSize*2 + 1));
+	const float* heightMap = readMap->GetCornerHeightMapSynced();
 
-#ifdef SMOOTH_MESH_DEBUG_BLUR
-		LOG("%s: starting average is: %f (%f) (w: %f)", __func__, avg, avg*weight, weight);
-#endif
+	wb.avg.assign(numCols, 0.0f);
+	wb.lv.assign(numCols, 0.0f);
+	wb.rv.assign(numCols, 0.0f);
 
-		for (int y = min.y; y <= max.y; ++y)
-		{
-			avg += (-lv) + rv;
-			const float gh = GetRealGroundHeight(x, y, resolution);
-			smoothed[x + y * lineSize] = std::max(gh, avg*weight);
+	float* avg = wb.avg.data();
+	float* lv = wb.lv.data();
+	float* rv = wb.rv.data();
 
-			lv = mesh[ x + std::max(0, std::min(li, mapMaxY)) * lineSize];
-			rv = mesh[ x +             std::min(ri, mapMaxY)  * lineSize];
-			li++; ri++;
+	int li = min.y - blurSize;
+	int ri = min.y + blurSize;
+	for (int y1 = li; y1 <= ri; ++y1) {
+		const float* row = &mesh[min.x + std::max(0, std::min(y1, mapMaxY)) * lineSize];
 
-#ifdef SMOOTH_MESH_DEBUG_BLUR
-			LOG("%s: x: %d, y: %d, avg: %f (%f) (g: %f)", __func__, x, y, avg, avg*weight, gh);
-			LOG("%s: for next line -%f +%f", __func__, lv, rv);
-#endif
-		}
+		for (int i = 0; i < numCols; ++i)
+			avg[i] += row[i];
 	}
-}
+	ri++;
 
+	for (int y = min.y; y <= max.y; ++y)
+	{
+		const float* lrow = &mesh[min.x + std::max(0, std::min(li, mapMaxY)) * lineSize];
+		const float* rrow = &mesh[min.x +             std::min(ri, mapMaxY)  * lineSize];
+		const float* grow = &heightMap[(min.x + y * mapDims.mapxp1) * resolution];
+		      float* dst  = &smoothed[min.x + y * lineSize];
 
-inline static void CheckInvariants(
-	int y,
-	int maxx,
-	int maxy,
-	int winSize,
-	int resolution,
-	const std::vector<float>& colsMaxima,
-	const std::vector<int>& maximaRows
-) {
-	RECOIL_DETAILED_TRACY_ZONE;
-	// check invariants - only for initial mesh creationgit reset HEAD~
-	if (y <= maxy) {
-		for (int x = 0; x <= maxx; ++x) {
-			assert(maximaRows[x] > y - winSize);
-			assert(maximaRows[x] <= maxy);
-			assert(colsMaxima[x] <= readMap->GetCurrMaxHeight() + 1.f);
-			assert(colsMaxima[x] >= readMap->GetCurrMinHeight() - 1.f);
-		}
-	}
-	for (int y1 = std::max(0, (y - winSize) + 1); y1 <= std::min(maxy, y + winSize + 1); ++y1) {
-		for (int x1 = 0; x1 <= maxx; ++x1) {
-			assert(GetRealGroundHeight(x1, y1, resolution) <= colsMaxima[x1] + 1.f);
+		for (int i = 0; i < numCols; ++i) {
+			avg[i] += (-lv[i]) + rv[i];
+			dst[i] = std::max(grow[i * resolution], avg[i]*weight);
+
+			lv[i] = lrow[i];
+			rv[i] = rrow[i];
 		}
+		li++; ri++;
+
+#ifdef SMOOTH_MESH_DEBUG_BLUR
+		for (int i = 0; i < numCols; ++i)
+			LOG("%s: x: %d, y: %d, avg: %f (%f) (g: %f)", __func__, min.x + i, y, avg[i], avg[i]*weight, grow[i * resolution]);
+#endif
 	}
 }
 
@@ -512,43 +425,49 @@ inline static bool UpdateSmoothMeshRequired(SmoothHeightMesh::MapChangeTrack& ma
 }
 
 
-void SmoothHeightMesh::UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax) {
+void SmoothHeightMesh::UpdateMaximaArea(int2 min, int2 max, WorkBuffers& wb) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const int winSize = smoothRadius / resolution;
-	const int blurSize = std::max(1, winSize / 2);
-	int2 map{maxx, maxy};
 
-	int2 impactRadius{winSize, winSize};
-	int2 min = damageMin - impactRadius;
-	int2 max = damageMax + impactRadius;
+	// the maxima of min..max need the ground heights winSize samples around it
+	const int numOutCols = max.x - min.x + 1;
+	const int numOutRows = max.y - min.y + 1;
+	const int numCols = numOutCols + winSize * 2;
+	const int numRows = numOutRows + winSize * 2;
 
-	min.x = std::clamp(min.x, 0, map.x - 1);
-	min.y = std::clamp(min.y, 0, map.y - 1);
-	max.x = std::clamp(max.x, 0, map.x - 1);
-	max.y = std::clamp(max.y, 0, map.y - 1);
+	wb.heights.resize(numRows * numCols);
+	wb.colMaxima.resize(numOutRows * numCols);
+	wb.prefixMax.resize(numRows * numCols);
+	wb.suffixMax.resize(numRows * numCols);
 
-#ifdef SMOOTH_MESH_DEBUG_GENERAL
-LOG("%s: quad index %d (%d,%d)-(%d,%d) (%d,%d)-(%d,%d) updating maxima"
-	, __func__, damagedAreaIndex, damageMin.x, damageMin.y, damageMax.x, damageMax.y, min.x, min.y, max.x, max.y
-	);
-
-LOG("%s: quad area in world space (%f,%f) (%f,%f)", __func__
-	, (float)damageMin.x * fresolution, (float)damageMin.y * fresolution
-	, (float)damageMax.x * fresolution, (float)damageMax.y * fresolution
-	);
-#endif
+	const float* heightMap = readMap->GetCornerHeightMapSynced();
+
+	// samples outside the map never raise a maximum
+	for (int r = 0; r < numRows; ++r) {
+		const int y = min.y - winSize + r;
+		float* row = &wb.heights[r * numCols];
+
+		if (y < 0 || y >= maxy) {
+			std::fill(row, row + numCols, -std::numeric_limits<float>::max());
+			continue;
+		}
 
-	for (int i = min.x; i <= max.x; ++i)
-		colsMaxima[i] = -std::numeric_limits<float>::max();
+		for (int c = 0; c < numCols; ++c) {
+			const int x = min.x - winSize + c;
+			row[c] = (x >= 0 && x < maxx)? heightMap[(x + y * mapDims.mapxp1) * resolution]: -std::numeric_limits<float>::max();
+		}
+	}
 
-	for (int i = min.x; i <= max.x; ++i)
-		maximaRows[i] = -1;
+	// separable: per-column maxima over the window rows, then along each row
+	SlidingMaxColumns(wb.heights.data(), wb.colMaxima.data(), numOutRows, numCols, winSize, wb.prefixMax.data(), wb.suffixMax.data());
 
-	FindMaximumColumnHeights(map, damageMin.y, min.x, max.x, winSize, resolution, colsMaxima, maximaRows);
+	for (int r = 0; r < numOutRows; ++r) {
+		SlidingMaxRow(&wb.colMaxima[r * numCols], &maximaMesh[min.x + (min.y + r) * maxx], numOutCols, winSize, wb.prefixMax.data(), wb.suffixMax.data());
 
-	for (int y = damageMin.y; y <= damageMax.y; ++y) {
-		FindRadialMaximum(map, y, damageMin.x, damageMax.x, winSize, resolution, colsMaxima, maximaMesh);
-		AdvanceMaximas(map, y+1, min.x, max.x, winSize, resolution, colsMaxima, maximaRows);
+#ifdef SMOOTH_MESH_DEBUG_MAXIMA
+		for (int x = min.x; x <= max.x; ++x)
+			LOG("%s: y:%d x:%d local max: %f", __func__, min.y + r, x, maximaMesh[x + (min.y + r) * maxx]);
+#endif
 	}
 }
 
@@ -572,33 +491,33 @@ void SmoothHeightMesh::UpdateSmoothMesh() {
 	else
 		activeQueue = &mapChangeTrack.verticalBlurQueue;
 
-	const int damagedAreaIndex = activeQueue->front();
-	activeQueue->pop();
-
-	// area of the map which to recalculate the height values
-	const int damageX = damagedAreaIndex % mapChangeTrack.width;
-	const int damageY = damagedAreaIndex / mapChangeTrack.width;
-	int2 damageMin{damageX*SAMPLES_PER_QUAD, damageY*SAMPLES_PER_QUAD};
-	int2 damageMax = damageMin + int2{SAMPLES_PER_QUAD - 1, SAMPLES_PER_QUAD - 1};
-
-	damageMin.x = std::clamp(damageMin.x, 0, maxx - 1);
-	damageMin.y = std::clamp(damageMin.y, 0, maxy - 1);
-	damageMax.x = std::clamp(damageMax.x, 0, maxx - 1);
-	damageMax.y = std::clamp(damageMax.y, 0, maxy - 1);
-
-	if (updateMaxima) {
-		UpdateSmoothMeshMaximas(damageMin, damageMax);
-
-		mapChangeTrack.horizontalBlurQueue.push(damagedAreaIndex);
-		mapChangeTrack.damageMap[damagedAreaIndex] = false;
-	} else {
-		const int winSize = smoothRadius / resolution;
-		const int blurSize = std::max(1, winSize / 2);
-		const int2 map{maxx, maxy};
+	// a fixed number of quads per frame, independent of the thread count; quads
+	// of one stage write disjoint parts of its output mesh and only read meshes
+	// that stage does not touch, so they can be processed in parallel
+	std::array<int, QUADS_PER_UPDATE> quadIndices;
+	std::array<int2, QUADS_PER_UPDATE> quadMins;
+	std::array<int2, QUADS_PER_UPDATE> quadMaxs;
+	int numQuads = 0;
+
+	for (; numQuads < QUADS_PER_UPDATE && !activeQueue->empty(); ++numQuads) {
+		const int damagedAreaIndex = activeQueue->front();
+		activeQueue->pop();
+
+		// area of the map which to recalculate the height values
+		const int damageX = damagedAreaIndex % mapChangeTrack.width;
+		const int damageY = damagedAreaIndex / mapChangeTrack.width;
+		int2 damageMin{damageX*SAMPLES_PER_QUAD, damageY*SAMPLES_PER_QUAD};
+		int2 damageMax = damageMin + int2{SAMPLES_PER_QUAD - 1, SAMPLES_PER_QUAD - 1};
+
+		damageMin.x = std::clamp(damageMin.x, 0, maxx - 1);
+		damageMin.y = std::clamp(damageMin.y, 0, maxy - 1);
+		damageMax.x = std::clamp(damageMax.x, 0, maxx - 1);
+		damageMax.y = std::clamp(damageMax.y, 0, maxy - 1);
 
 #ifdef SMOOTH_MESH_DEBUG_GENERAL
-	LOG("%s: quad index %d (%d,%d)-(%d,%d) applying blur", __func__
+	LOG("%s: quad index %d (%d,%d)-(%d,%d) %s", __func__
 		, damagedAreaIndex, damageMin.x, damageMin.y, damageMax.x, damageMax.y
+		, updateMaxima? "updating maxima": "applying blur"
 		);
 
 	LOG("%s: quad area in world space (%f,%f) (%f,%f)", __func__
@@ -607,13 +526,40 @@ void SmoothHeightMesh::UpdateSmoothMesh() {
 		);
 #endif
 
-		if (doHorizontalBlur) {
-			BlurHorizontal(map, damageMin, damageMax, blurSize, resolution, maximaMesh, tempMesh);
-			mapChangeTrack.verticalBlurQueue.push(damagedAreaIndex);
+		quadIndices[numQuads] = damagedAreaIndex;
+		quadMins[numQuads] = damageMin;
+		quadMaxs[numQuads] = damageMax;
+	}
+
+	const int winSize = smoothRadius / resolution;
+	const int blurSize = std::max(1, winSize / 2);
+	const int2 map{maxx, maxy};
+
+	if (updateMaxima) {
+		for_mt(0, numQuads, [&](const int i) {
+			UpdateMaximaArea(quadMins[i], quadMaxs[i], workBuffers[ThreadPool::GetThreadNum()]);
+		});
+
+		for (int i = 0; i < numQuads; ++i) {
+			mapChangeTrack.horizontalBlurQueue.push(quadIndices[i]);
+			mapChangeTrack.damageMap[quadIndices[i]] = false;
+		}
+	} else if (doHorizontalBlur) {
+		for_mt(0, numQuads, [&](const int i) {
+			BlurHorizontal(map, quadMins[i], quadMaxs[i], blurSize, resolution, maximaMesh, tempMesh);
+		});
+
+		for (int i = 0; i < numQuads; ++i) {
+			mapChangeTrack.verticalBlurQueue.push(quadIndices[i]);
 		}
-		else {
-			BlurVertical(map, damageMin, damageMax, blurSize, resolution, tempMesh, mesh);
-			CopyMeshPart(map.x, damageMin, damageMax, mesh, tempMesh);
+	} else {
+		// the vertical blur reads tempMesh beyond its own quad, sync it only once all are done
+		for_mt(0, numQuads, [&](const int i) {
+			BlurVertical(map, quadMins[i], quadMaxs[i], blurSize, resolution, tempMesh, mesh, workBuffers[ThreadPool::GetThreadNum()]);
+		});
+
+		for (int i = 0; i < numQuads; ++i) {
+			CopyMeshPart(map.x, quadMins[i], quadMaxs[i], mesh, tempMesh);
 		}
 	}
 }
@@ -627,23 +573,30 @@ void SmoothHeightMesh::MakeSmoothMesh() {
 
 	// blur size is half the window size to create a wider plateau
 	const int blurSize = std::max(1, winSize / 2);
-	int2 min{0, 0};
-	int2 max{maxx-1, maxy-1};
-	int2 map{maxx, maxy};
-
- 	FindMaximumColumnHeights(map, 0, 0, max.x, winSize, resolution, colsMaxima, maximaRows);
-
-	for (int y = 0; y <= max.y; ++y) {
-		FindRadialMaximum(map, y, 0, max.x, winSize, resolution, colsMaxima, maximaMesh);
-		AdvanceMaximas(map, y+1, 0, max.x, winSize, resolution, colsMaxima, maximaRows);
-
-#ifdef _DEBUG
-		CheckInvariants(y, max.x, max.y, winSize, resolution, colsMaxima, maximaRows);
-#endif
-	}
-
-	BlurHorizontal(map, min, max, blurSize, resolution, maximaMesh, tempMesh);
-	BlurVertical(map, min, max, blurSize, resolution, tempMesh, mesh);
+	const int2 map{maxx, maxy};
+
+	// full rows resp. columns per task, the blurs add up in the same order as a single pass
+	const int numRowBlocks = (maxy + SAMPLES_PER_QUAD - 1) / SAMPLES_PER_QUAD;
+	const int numColBlocks = (maxx + SAMPLES_PER_QUAD - 1) / SAMPLES_PER_QUAD;
+
+	for_mt(0, numRowBlocks, [&](const int i) {
+		const int2 min{0, i * SAMPLES_PER_QUAD};
+		const int2 max{maxx - 1, std::min(min.y + SAMPLES_PER_QUAD, maxy) - 1};
+
+		UpdateMaximaArea(min, max, workBuffers[ThreadPool::GetThreadNum()]);
+	});
+	for_mt(0, numRowBlocks, [&](const int i) {
+		const int2 min{0, i * SAMPLES_PER_QUAD};
+		const int2 max{maxx - 1, std::min(min.y + SAMPLES_PER_QUAD, maxy) - 1};
+
+		BlurHorizontal(map, min, max, blurSize, resolution, maximaMesh, tempMesh);
+	});
+	for_mt(0, numColBlocks, [&](const int i) {
+		const int2 min{i * SAMPLES_PER_QUAD, 0};
+		const int2 max{std::min(min.x + SAMPLES_PER_QUAD, maxx) - 1, maxy - 1};
+
+		BlurVertical(map, min, max, blurSize, resolution, tempMesh, mesh, workBuffers[ThreadPool::GetThreadNum()]);
+	});
 
 	// <mesh> now contains the final smoothed heightmap, save it in origMesh
 	std::copy(mesh.begin(), mesh.end(), origMesh.begin());
@@ -15,6 +15,8 @@ class CGround;
 namespace SmoothHeightMeshNamespace {
 	constexpr int SMOOTH_MESH_UPDATE_DELAY = GAME_SPEED;
 	constexpr int SAMPLES_PER_QUAD = 32;
+	// quads (of one stage) recalculated per UpdateSmoothMesh, split over the workers
+	constexpr int QUADS_PER_UPDATE = 8;
 }
 
 /**
@@ -37,6 +39,18 @@ public:
 		bool activeBuffer = 0;
 	};
 
+	// per-thread scratch space for the maxima and the vertical blur
+	struct WorkBuffers {
+		std::vector<float> heights;
+		std::vector<float> colMaxima;
+		std::vector<float> prefixMax;
+		std::vector<float> suffixMax;
+
+		std::vector<float> avg;
+		std::vector<float> lv;
+		std::vector<float> rv;
+	};
+
 	void Init(int2 max, int res, int smoothRad);
 	void Kill();
 
@@ -64,7 +78,7 @@ public:
 private:
 	void InitMapChangeTracking();
 	void InitDataStructures();
-	void UpdateSmoothMeshMaximas(int2 damageMin, int2 damageMax);
+	void UpdateMaximaArea(int2 min, int2 max, WorkBuffers& wb);
 
 	bool enabled = true;
 
@@ -81,8 +95,7 @@ private:
 	std::vector<float> tempMesh;
 	std::vector<float> origMesh;
 
-	std::vector<float> colsMaxima;
-	std::vector<int> maximaRows;
+	std::vector<WorkBuffers> workBuffers;
 
 	MapChangeTrack mapChangeTrack;
 };
@@ -3,6 +3,10 @@
 #ifndef MOVE_TYPE_COMPONENTS_H__
 #define MOVE_TYPE_COMPONENTS_H__
 
+#include <array>
+#include <cstdint>
+#include <vector>
+
 #include "MoveTypesEvents.h"
 #include "System/Ecs/Components/BaseComponents.h"
 #include <System/Threading/ThreadPool.h>
@@ -47,6 +51,28 @@ struct YardmapTrapCheckSystemComponent {
 	std::array<std::vector<CUnit*>, ThreadPool::MAX_THREADS> trappedUnitLists;
 };
 
+// Packed copy of the per-unit fields the unit-unit collision broad-phase needs, indexed by unit
+// id and rebuilt after UpdatePreCollisions every frame. Lets HandleUnitCollisions reject the bulk
+// of its QuadField candidates from a few flat arrays instead of from their UnitDef and MoveDef.
+struct UnitCollisionMirrorSystemComponent {
+	static constexpr std::size_t page_size = 1;
+
+	// the unit each slot was filled from, anything else is not mirrored and never rejected
+	std::vector<const CUnit*> units;
+
+	std::vector<float> posX;
+	std::vector<float> posZ;
+	// footprint radius the collision test uses, and UnitDef::separationDistance
+	std::vector<float> radius;
+	std::vector<float> separation;
+	// skidding or flying units are skipped as collidees
+	std::vector<std::uint8_t> ignored;
+
+	// per-thread scratch for the candidate batches
+	std::array<std::vector<float>, ThreadPool::MAX_THREADS> distances;
+	std::array<std::vector<CUnit*>, ThreadPool::MAX_THREADS> candidates;
+};
+
 constexpr size_t UNIT_EVENT_VECTOR_RESERVE = 4;
 
 ALIAS_COMPONENT_LIST_RESERVE(FeatureCollisionEvents, std::vector<FeatureCollisionEvent>, UNIT_EVENT_VECTOR_RESERVE);
@@ -31,6 +31,7 @@
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "Sim/Weapons/Weapon.h"
+#include "System/Ecs/Utils/SystemGlobalUtils.h"
 #include "System/creg/STL_Tuple.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
@@ -279,6 +280,76 @@ static bool CheckCollisionInclSAT(
 
 
 
+// Broad-phase for HandleUnitCollisions: drops the QuadField candidates that can neither collide
+// with the collider nor be close enough to need separating, using only the packed per-unit mirror.
+// The bound is conservative (2D distance plus a margin, where the real tests are 3D or equal) so
+// the narrow-phase sees exactly the units that can matter, in their original order.
+static const std::vector<CUnit*>& FilterUnitCollisionCandidates(
+	MoveTypes::UnitCollisionMirrorSystemComponent& mirror,
+	const CUnit* collider,
+	const std::vector<CUnit*>& units,
+	float colliderRadius,
+	float colliderSeparationDist,
+	int curThread
+) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// large but finite, squares of these must not overflow
+	constexpr float FAR_AWAY = 1e15f;
+
+	std::vector<float>& batch = mirror.distances[curThread];
+	std::vector<CUnit*>& candidates = mirror.candidates[curThread];
+
+	const size_t numUnits = units.size();
+	const size_t numSlots = mirror.units.size();
+
+	candidates.clear();
+	batch.resize(numUnits * 3);
+
+	if (numUnits == 0)
+		return candidates;
+
+	float* dxs = &batch[numUnits * 0];
+	float* dzs = &batch[numUnits * 1];
+	float* rss = &batch[numUnits * 2];
+
+	for (size_t i = 0; i < numUnits; i++) {
+		const CUnit* unit = units[i];
+		const unsigned int id = unit->id;
+
+		// not mirrored this frame, or the transport being unloaded from (which has
+		// side-effects on the collider at any distance): always hand to the narrow-phase
+		if (id >= numSlots || mirror.units[id] != unit || int(id) == collider->unloadingTransportId) {
+			dxs[i] = 0.0f;
+			dzs[i] = 0.0f;
+			rss[i] = FAR_AWAY;
+			continue;
+		}
+
+		if (mirror.ignored[id]) {
+			dxs[i] = FAR_AWAY;
+			dzs[i] = 0.0f;
+			rss[i] = 0.0f;
+			continue;
+		}
+
+		dxs[i] = collider->pos.x - mirror.posX[id];
+		dzs[i] = collider->pos.z - mirror.posZ[id];
+		rss[i] = colliderRadius + mirror.radius[id] + std::max({0.0f, colliderSeparationDist, mirror.separation[id]}) + 1.0f;
+	}
+
+	// branch-free over the packed batch, vectorizes
+	for (size_t i = 0; i < numUnits; i++) {
+		rss[i] = (dxs[i] * dxs[i] + dzs[i] * dzs[i]) - (rss[i] * rss[i]);
+	}
+
+	for (size_t i = 0; i < numUnits; i++) {
+		if (rss[i] <= 0.0f)
+			candidates.push_back(units[i]);
+	}
+
+	return candidates;
+}
+
 static void HandleUnitCollisionsAux(
 	const CUnit* collider,
 	const CUnit* collidee,
@@ -2804,7 +2875,10 @@ void CGroundMoveType::HandleUnitCollisions(
 	qfQuery.threadOwner = curThread;
 	quadField.GetUnitsExact(qfQuery, collider->pos, searchRadius);
 
-	for (CUnit* collidee: *qfQuery.units) {
+	auto& collisionMirror = Sim::systemGlobals.GetSystemComponent<MoveTypes::UnitCollisionMirrorSystemComponent>();
+	const std::vector<CUnit*>& collidees = FilterUnitCollisionCandidates(collisionMirror, collider, *qfQuery.units, colliderParams.y, colliderSeparationDist, curThread);
+
+	for (CUnit* collidee: collidees) {
 		if (collidee == collider) continue;
 		if (collidee->IsSkidding()) continue;
 		if (collidee->IsFlying()) continue;
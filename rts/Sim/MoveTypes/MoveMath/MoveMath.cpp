@@ -345,6 +345,10 @@ CMoveMath::BlockType CMoveMath::RangeIsBlocked(int xmin, int xmax, int zmin, int
 	xmax = std::min(xmax, mapDims.mapx - 1);
 	zmax = std::min(zmax, mapDims.mapy - 1);
 
+	// nothing to test against, skip the per-square cell scans
+	if (!groundBlockingObjectMap.RangeOccupiedUnsafe(xmin, zmin, xmax, zmax))
+		return BLOCK_NONE;
+
 	BlockType ret = BLOCK_NONE;
 	if (ThreadPool::inMultiThreadedSection) {
 		const int tempNum = gs->GetMtTempNum(thread);
@@ -365,6 +369,10 @@ CMoveMath::BlockType CMoveMath::RangeIsBlockedTempNum(int xmin, int xmax, int zm
 	xmax = std::min(xmax, mapDims.mapx - 1);
 	zmax = std::min(zmax, mapDims.mapy - 1);
 
+	// nothing to test against, skip the per-square cell scans
+	if (!groundBlockingObjectMap.RangeOccupiedUnsafe(xmin, zmin, xmax, zmax))
+		return BLOCK_NONE;
+
 	BlockType ret = BLOCK_NONE;
 	if (ThreadPool::inMultiThreadedSection) {
 		const int tempNum = gs->GetMtTempNum(thread);
@@ -87,13 +87,20 @@ void AMoveType::SlowUpdate()
 void AMoveType::UpdateCollisionMap(bool force)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	if (WantsCollisionMapUpdate(force))
+		quadField.MovedUnit(owner);
+}
+
+bool AMoveType::WantsCollisionMapUpdate(bool force)
+{
 	if (!force && ((gs->frameNum + owner->id) % modInfo.unitQuadPositionUpdateRate))
-		return;
+		return false;
 
-	if (owner->pos != oldCollisionUpdatePos){
-		oldCollisionUpdatePos = owner->pos;
-		quadField.MovedUnit(owner);
-	}
+	if (owner->pos == oldCollisionUpdatePos)
+		return false;
+
+	oldCollisionUpdatePos = owner->pos;
+	return true;
 }
 
 void AMoveType::UpdateGroundBlockMap() {
@@ -54,6 +54,8 @@ public:
 	virtual bool Update() = 0;
 	virtual void SlowUpdate();
 	void UpdateCollisionMap(bool force = false);
+	// true if the owner's quads are due to be updated (by the caller), see UpdateCollisionMap
+	bool WantsCollisionMapUpdate(bool force = false);
 	void UpdateGroundBlockMap();
 
 	virtual bool IsSkidding() const { return false; }
@@ -8,16 +8,56 @@
 #include "Sim/Features/Feature.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/MoveTypes/Components/MoveTypesComponents.h"
+#include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitHandler.h"
 
+#include "System/Ecs/Utils/SystemGlobalUtils.h"
 #include "System/EventHandler.h"
 #include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 
 using namespace MoveTypes;
 
-void GroundMoveSystem::Init() {}
+static void SystemInit() {
+    Sim::systemGlobals.CreateSystemComponent<UnitCollisionMirrorSystemComponent>();
+}
+
+void GroundMoveSystem::Init() {
+    SystemInit();
+
+    Sim::systemUtils.OnPostLoad().connect<&SystemInit>();
+}
+
+static void UpdateCollisionMirror() {
+    auto& mirror = Sim::systemGlobals.GetSystemComponent<UnitCollisionMirrorSystemComponent>();
+    const auto& activeUnits = unitHandler.GetActiveUnits();
+
+    if (mirror.units.size() != unitHandler.MaxUnits()) {
+        mirror.units.resize(unitHandler.MaxUnits());
+        mirror.posX.resize(unitHandler.MaxUnits());
+        mirror.posZ.resize(unitHandler.MaxUnits());
+        mirror.radius.resize(unitHandler.MaxUnits());
+        mirror.separation.resize(unitHandler.MaxUnits());
+        mirror.ignored.resize(unitHandler.MaxUnits());
+    }
+
+    // slots of dead units keep their old pointer, which never matches a live candidate again
+    // unless the id is reused (and then it's refreshed below)
+    for_mt_chunk(0, activeUnits.size(), [&](const int i) {
+        const CUnit* unit = activeUnits[i];
+        const MoveDef* md = unit->moveDef;
+        const int id = unit->id;
+
+        mirror.units[id] = unit;
+        mirror.posX[id] = unit->pos.x;
+        mirror.posZ[id] = unit->pos.z;
+        mirror.radius[id] = (md != nullptr)? md->CalcFootPrintMaxInteriorRadius(): unit->CalcFootPrintMaxInteriorRadius();
+        mirror.separation[id] = unit->unitDef->separationDistance;
+        mirror.ignored[id] = (unit->IsSkidding() || unit->IsFlying());
+    });
+}
 
 template<typename T, typename F>
 void issue_events(F func)
@@ -35,7 +75,8 @@ void GroundMoveSystem::Update() {
 	{
 		SCOPED_TIMER("Sim::Unit::MoveType::1::UpdateTraversalPlan");
         auto view = Sim::registry.view<GroundMoveType>();
-        for_mt(0, view.size(), [&view](const int i){
+        // units waiting on or following a path cost far more than idle ones
+        for_mt_chunk_adaptive("Sim::Unit::MoveType::1::UpdateTraversalPlan::Tail", 0, view.size(), [&view](const int i){
             auto entity = view.storage<GroundMoveType>()[i];
             auto unitId = view.get<GroundMoveType>(entity);
 
@@ -48,7 +89,7 @@ void GroundMoveSystem::Update() {
             #endif
 
 			moveType->UpdateTraversalPlan();
-		});
+		}, true);
 	}
 	{
 		SCOPED_TIMER("Sim::Unit::MoveType::2::UpdatePreCollisions");
@@ -102,12 +143,16 @@ void GroundMoveSystem::Update() {
             if (!unit->pos.IsInBounds() && (unit->speed.w > MAX_UNIT_SPEED))
                 unit->ForcedKillUnit(nullptr, false, true, -CSolidObject::DAMAGE_KILLED_OOB);
 		});
+
+        // positions are final for this frame's collision detection from here on
+        UpdateCollisionMirror();
 	}
     {
         SCOPED_TIMER("Sim::Unit::MoveType::3::CollisionDetection");
         auto view = Sim::registry.view<GroundMoveType>();
         //size_t count = view.storage<GroundMoveType>().size();
-        for_mt(0, view.size(), [&view](const int i){
+        // the cost grows with the number of nearby objects, i.e. with unit density
+        for_mt_chunk_adaptive("Sim::Unit::MoveType::3::CollisionDetection::Tail", 0, view.size(), [&view](const int i){
             auto entity = view.storage<GroundMoveType>()[i];
             assert( Sim::registry.valid(entity) );
             assert( Sim::registry.all_of<GroundMoveType>(entity) );
@@ -121,7 +166,7 @@ void GroundMoveSystem::Update() {
 
             moveType->SetMtJobId(i);
             moveType->UpdateCollisionDetections();
-        });
+        }, true);
     }
 	{
         SCOPED_TIMER("Sim::Unit::MoveType::4::ProcessCollisionEvents");
@@ -7,6 +7,8 @@
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Objects/SolidObject.h"
 
+#include "System/Threading/ThreadPool.h"
+
 #include "System/Misc/TracyDefs.h"
 
 namespace HAPFS {
@@ -26,11 +28,21 @@ void PathHeatMap::Init(unsigned int scalex, unsigned int scalez) {
 	xsize  = mapDims.hmapx / xscale;
 	zsize  = mapDims.hmapy / zscale;
 
+	bandRows = std::max(1u, (zsize + NUM_HEAT_BANDS - 1) / NUM_HEAT_BANDS);
+
 	heatMapOffset = 0;
 
 	heatMap.resize(xsize * zsize);
 }
 
+void PathHeatMap::Update(const CPathManager* pm) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the queued heat is relative to the offset at the time it was added
+	DepositHeat(pm);
+
+	++heatMapOffset;
+}
+
 unsigned int PathHeatMap::GetHeatMapIndex(unsigned int hmx, unsigned int hmz) const {
 	RECOIL_DETAILED_TRACY_ZONE;
 	assert(!heatMap.empty());
@@ -42,21 +54,39 @@ unsigned int PathHeatMap::GetHeatMapIndex(unsigned int hmx, unsigned int hmz) co
 	return (hmz * xsize + hmx);
 }
 
-void PathHeatMap::AddHeat(const CSolidObject* owner, const CPathManager* pm, unsigned int pathID) {
+void PathHeatMap::AddHeat(const CSolidObject* owner, unsigned int pathID) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (pathID == 0)
 		return;
 	if (!owner->moveDef->heatMapping)
 		return;
 
-	// internally clears and reserves squares
-	pm->GetDetailedPathSquares(pathID, pathSquares);
+	// called every frame by PathManager::UpdatePath, from the
+	// single-threaded part of the unit update; the squares are
+	// looked up later by DepositHeat since that can be batched
+	heatRequests.push_back({pathID, owner->id, owner->moveDef->heatProduced});
+}
+
+void PathHeatMap::DepositHeat(const CPathManager* pm) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const unsigned int numRequests = heatRequests.size();
 
-	if (pathSquares.empty())
+	if (numRequests == 0)
 		return;
 
-	// called every frame by PathManager::UpdatePath
-	//
+	if (requestDeposits.size() < numRequests)
+		requestDeposits.resize(numRequests);
+
+	requestBandOffsets.clear();
+	requestBandOffsets.resize(numRequests * NUM_HEAT_BANDS, 0);
+
+	// path lookups are not thread-safe, but nothing modifies paths until the requests are done
+	requestSquares.resize(numRequests);
+
+	for (unsigned int r = 0; r < numRequests; r++) {
+		requestSquares[r] = pm->GetDetailedPathSquaresRef(heatRequests[r].pathID);
+	}
+
 	// the i-th waypoint receives an amount of heat equal to
 	// ((N - i) / N) * heatProduced so the entire _remaining_
 	// path is constantly reserved (the default PFS consumes
@@ -75,14 +105,82 @@ void PathHeatMap::AddHeat(const CSolidObject* owner, const CPathManager* pm, uns
 	//   the heatmapped paths look like "breadcrumb" trails
 	//   this does not matter only because the default PFS
 	//   uses the same spacing-factor between waypoints
-	unsigned int i = pathSquares.size();
+	//
+	// gathering is independent per request, every request
+	// has its own deposit list and band counters
+	for_mt_chunk(0, numRequests, [&](const int r) {
+		const HeatRequest& request = heatRequests[r];
 
-	const float scale = 1.0f / i;
-	const float value = scale * owner->moveDef->heatProduced;
+		const IPath::square_list_type* pathSquares = requestSquares[r];
 
-	for (const int2 sqr: pathSquares) {
-		UpdateHeatValue(sqr.x, sqr.y, (i--) * value, owner->id);
+		std::vector<HeatDeposit>& deposits = requestDeposits[r];
+		deposits.clear();
+
+		if (pathSquares == nullptr || pathSquares->empty())
+			return;
+
+		unsigned int* bandCounts = &requestBandOffsets[r * NUM_HEAT_BANDS];
+		unsigned int i = pathSquares->size();
+
+		const float scale = 1.0f / i;
+		const float value = scale * request.heatProduced;
+
+		// squares are stored goal-first, the unit's end of the path is at the back
+		for (auto it = pathSquares->rbegin(); it != pathSquares->rend(); ++it) {
+			const int2 sqr = *it;
+			const unsigned int heat = (i--) * value;
+			const HeatDeposit deposit = {GetHeatMapIndex(sqr.x, sqr.y), heat + heatMapOffset, request.ownerID};
+
+			// heat only decreases along a path, so a repeat of the previous cell can never win
+			if (!deposits.empty() && deposits.back().cellIdx == deposit.cellIdx)
+				continue;
+
+			deposits.push_back(deposit);
+			bandCounts[GetHeatBand(deposit.cellIdx)] += 1;
+		}
+	});
+
+	// turn the counts into write cursors, request-major within each band so every
+	// band receives its deposits in exactly the order the requests were queued
+	unsigned int numDeposits = 0;
+
+	for (unsigned int b = 0; b < NUM_HEAT_BANDS; b++) {
+		bandOffsets[b] = numDeposits;
+
+		for (unsigned int r = 0; r < numRequests; r++) {
+			const unsigned int count = requestBandOffsets[r * NUM_HEAT_BANDS + b];
+
+			requestBandOffsets[r * NUM_HEAT_BANDS + b] = numDeposits;
+			numDeposits += count;
+		}
 	}
+
+	bandOffsets[NUM_HEAT_BANDS] = numDeposits;
+	bandDeposits.resize(numDeposits);
+
+	for_mt_chunk(0, numRequests, [&](const int r) {
+		unsigned int* bandCursors = &requestBandOffsets[r * NUM_HEAT_BANDS];
+
+		for (const HeatDeposit& deposit: requestDeposits[r]) {
+			bandDeposits[bandCursors[GetHeatBand(deposit.cellIdx)]++] = deposit;
+		}
+	});
+
+	// bands cover disjoint cells; within one the deposits are applied in queue order,
+	// which makes the outcome (including ties) identical to applying them serially
+	for_mt(0, NUM_HEAT_BANDS, [&](const int b) {
+		for (unsigned int n = bandOffsets[b]; n < bandOffsets[b + 1]; n++) {
+			const HeatDeposit& deposit = bandDeposits[n];
+			HeatCell& cell = heatMap[deposit.cellIdx];
+
+			if (cell.value < deposit.value) {
+				cell.value = deposit.value;
+				cell.ownerID = deposit.ownerID;
+			}
+		}
+	});
+
+	heatRequests.clear();
 }
 
 void PathHeatMap::UpdateHeatValue(unsigned int x, unsigned int y, unsigned int value, unsigned int ownerID) {
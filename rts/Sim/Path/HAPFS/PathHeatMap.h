@@ -3,7 +3,10 @@
 #ifndef HAPFS_PATH_HEATMAP_HDR
 #define HAPFS_PATH_HEATMAP_HDR
 
+#include <algorithm>
+#include <array>
 #include <vector>
+#include "IPath.h"
 #include "System/type2.h"
 
 
@@ -24,15 +27,19 @@ public:
 	void Init(unsigned int sizex, unsigned int sizez);
 	void Kill() {
 		heatMap.clear();
-		pathSquares.clear();
+		heatRequests.clear();
+		requestSquares.clear();
+		requestDeposits.clear();
+		bandDeposits.clear();
 	}
 
-	void Update() { ++heatMapOffset; }
+	// deposits the heat of every AddHeat call since the last frame, then ages the map
+	void Update(const CPathManager* pm);
 
 
 	unsigned int GetHeatMapIndex(unsigned int x, unsigned int y) const;
 
-	void AddHeat(const CSolidObject* owner, const CPathManager* pm, unsigned int pathID);
+	void AddHeat(const CSolidObject* owner, unsigned int pathID);
 	void UpdateHeatValue(unsigned int x, unsigned int y, unsigned int value, unsigned int ownerID);
 
 	const int GetHeatValue(unsigned int x, unsigned int y) const {
@@ -50,13 +57,43 @@ private:
 		unsigned int ownerID = 0;
 	};
 
+	struct HeatRequest {
+		unsigned int pathID;
+		unsigned int ownerID;
+		float heatProduced;
+	};
+
+	struct HeatDeposit {
+		unsigned int cellIdx;
+		unsigned int value;
+		unsigned int ownerID;
+	};
+
+	// the map is split into this many horizontal bands which are updated in parallel;
+	// the result does not depend on it (or on the thread count), only the speed does
+	static constexpr unsigned int NUM_HEAT_BANDS = 16;
+
+	unsigned int GetHeatBand(unsigned int cellIdx) const { return std::min((cellIdx / xsize) / bandRows, NUM_HEAT_BANDS - 1); }
+
+	void DepositHeat(const CPathManager* pm);
 
 	// resolution is hmapx*hmapy
 	std::vector<HeatCell> heatMap;
-	std::vector<int2> pathSquares;
+
+	// queued in sim order by AddHeat, deposited in that same order by Update
+	std::vector<HeatRequest> heatRequests;
+
+	std::vector<const IPath::square_list_type*> requestSquares;
+	std::vector<std::vector<HeatDeposit>> requestDeposits;
+
+	// per request and band: number of deposits, then write cursor into bandDeposits
+	std::vector<unsigned int> requestBandOffsets;
+	std::vector<HeatDeposit> bandDeposits;
+	std::array<unsigned int, NUM_HEAT_BANDS + 1> bandOffsets;
 
 	unsigned int xscale = 0, xsize = 0;
 	unsigned int zscale = 0, zsize = 0;
+	unsigned int bandRows = 1;
 
 	// heatmap values are relative to this
 	unsigned int heatMapOffset = 0;
@@ -783,7 +783,7 @@ void CPathManager::Update()
 		assert(IsFinalized());
 
 		//pathFlowMap->Update();
-		pathHeatMap->Update();
+		pathHeatMap->Update(this);
 
 		auto medResPE = &pathingStates[PATH_MED_RES];
 		auto lowResPE = &pathingStates[PATH_LOW_RES];
@@ -860,7 +860,7 @@ void CPathManager::UpdatePath(const CSolidObject* owner, unsigned int pathID)
 	assert(IsFinalized());
 
 	//pathFlowMap->AddFlow(owner);
-	pathHeatMap->AddHeat(owner, this, pathID);
+	pathHeatMap->AddHeat(owner, pathID);
 }
 
 
@@ -941,6 +941,18 @@ void CPathManager::GetDetailedPathSquares(unsigned pathID, std::vector<int2>& sq
 }
 
 
+const IPath::square_list_type* CPathManager::GetDetailedPathSquaresRef(unsigned int pathID) const
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const MultiPath* multiPath = GetMultiPathConst(pathID);
+
+	if (multiPath == nullptr)
+		return nullptr;
+
+	return &multiPath->maxResPath.squares;
+}
+
+
 
 void CPathManager::GetPathWayPoints(
 	unsigned int pathID,
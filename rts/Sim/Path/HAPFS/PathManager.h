@@ -167,6 +167,13 @@ public:
 	 */
 	void GetDetailedPathSquares(unsigned pathID, std::vector<int2>& points) const;
 
+	/**
+	 * Same squares as GetDetailedPathSquares (but in the path's own order, goal
+	 * first) without copying them, or nullptr if <pathID> is unknown. The list is
+	 * only valid until the path is next modified.
+	 */
+	const IPath::square_list_type* GetDetailedPathSquaresRef(unsigned int pathID) const;
+
 	void GetPathWayPoints(unsigned int pathID, std::vector<float3>& points, std::vector<int>& starts) const override;
 
 	void TerrainChange(unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2, unsigned int type) override;
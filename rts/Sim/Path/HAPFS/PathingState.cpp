@@ -2,8 +2,9 @@
 
 #include "PathingState.h"
 
-#include "zlib.h"
-#include "minizip/zip.h"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
 
 #include "Game/GlobalUnsynced.h"
 #include "Game/LoadScreen.h"
@@ -21,11 +22,10 @@
 #include "PathMemPool.h"
 
 #include "System/Config/ConfigHandler.h"
-#include "System/FileSystem/Archives/IArchive.h"
-#include "System/FileSystem/ArchiveLoader.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/MemoryMappedFile.h"
 #include "System/Platform/Threading.h"
 #include "System/StringUtil.h"
 #include "System/Threading/ThreadPool.h" // for_mt
@@ -53,7 +53,46 @@ static const std::string GetPathCacheDir() {
 
 static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".zip");
+	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".pe");
+}
+
+
+// Cache files are stored uncompressed so they can be mapped instead of inflated:
+// a header page followed by one section per MoveDef (center-offsets, then vertex
+// costs), each starting on a page boundary so loading one only touches its pages.
+static constexpr std::uint32_t CACHE_MAGIC = 0x45504148; // "HAPE"
+// bump whenever the section layout changes
+static constexpr std::uint32_t CACHE_VERSION = 1;
+static constexpr std::uint32_t CACHE_SECTION_ALIGNMENT = 4096;
+
+struct CacheFileHeader {
+	std::uint32_t magic;
+	std::uint32_t version;
+	std::uint32_t hashCode;
+	std::uint32_t numMoveDefs;
+	std::uint32_t numBlocks;
+	std::uint32_t blockSize;
+	std::uint32_t numVertices;
+	std::uint32_t sectionAlignment;
+};
+
+static CacheFileHeader MakeCacheFileHeader(std::uint32_t hashCode, std::uint32_t numBlocks, std::uint32_t blockSize) {
+	return {CACHE_MAGIC, CACHE_VERSION, hashCode, std::uint32_t(moveDefHandler.GetNumMoveDefs()), numBlocks, blockSize, PATH_DIRECTION_VERTICES, CACHE_SECTION_ALIGNMENT};
+}
+
+static std::size_t AlignCacheSize(std::size_t size) {
+	return ((size + CACHE_SECTION_ALIGNMENT - 1) / CACHE_SECTION_ALIGNMENT) * CACHE_SECTION_ALIGNMENT;
+}
+
+static std::size_t GetCacheSectionOffset(const CacheFileHeader& header, unsigned int pathType) {
+	const std::size_t offsetsSize = AlignCacheSize(header.numBlocks * sizeof(short2));
+	const std::size_t costsSize = AlignCacheSize(header.numBlocks * PATH_DIRECTION_VERTICES * sizeof(float));
+
+	return (AlignCacheSize(sizeof(CacheFileHeader)) + pathType * (offsetsSize + costsSize));
+}
+
+static std::size_t GetCacheFileSize(const CacheFileHeader& header) {
+	return (GetCacheSectionOffset(header, header.numMoveDefs));
 }
 
 void PathingState::KillStatic() { pathingStates = 0; }
@@ -503,9 +542,10 @@ bool PathingState::ReadFile(const std::string& peFileName, const std::string& ma
 	if (!FileSystem::FileExists(cacheFileName))
 		return false;
 
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+	CMemoryMappedFile file(dataDirsAccess.LocateFile(cacheFileName));
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
+	if (!file.IsOpen() || file.GetSize() < sizeof(CacheFileHeader)) {
+		file.Close();
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
@@ -514,46 +554,31 @@ bool PathingState::ReadFile(const std::string& peFileName, const std::string& ma
 	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
 	loadscreen->SetLoadMessage(calcMsg);
 
-	const unsigned fid = upfile->FindFile("pathinfo");
-	if (fid >= upfile->NumFiles()) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
-	std::vector<std::uint8_t> buffer;
-
-	if (!upfile->GetFile(fid, buffer) || buffer.size() < 4) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
-
-	const unsigned int filehash = *(reinterpret_cast<unsigned int*>(&buffer[0]));
-	const unsigned int blockSize = blockStates.GetSize() * sizeof(short2);
-	unsigned int pos = sizeof(unsigned);
+	const CacheFileHeader expected = MakeCacheFileHeader(fileHashCode, blockStates.GetSize(), BLOCK_SIZE);
+	CacheFileHeader header;
+	std::memcpy(&header, file.GetData(), sizeof(header));
 
-	if (filehash != fileHashCode) {
+	if (std::memcmp(&header, &expected, sizeof(header)) != 0 || file.GetSize() < GetCacheFileSize(header)) {
+		LOG_L(L_WARNING, "[PathEstimator::%s] ignoring stale cache file %s", __func__, cacheFileName.c_str());
+		file.Close();
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	if (buffer.size() < (pos + blockSize * moveDefHandler.GetNumMoveDefs())) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+	// every section is page-aligned and self-contained, so the copies fault in
+	// disjoint page ranges straight from the page cache and can run in parallel
+	for_mt(0, header.numMoveDefs, [&](unsigned int pathType) {
+		const std::size_t sectionPos = GetCacheSectionOffset(header, pathType);
+		const std::size_t offsetsSize = header.numBlocks * sizeof(short2);
+		const std::size_t costsSize = header.numBlocks * PATH_DIRECTION_VERTICES * sizeof(float);
+		const std::size_t costsPos = sectionPos + AlignCacheSize(offsetsSize);
 
-	// read center-offset data
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		std::memcpy(&blockStates.peNodeOffsets[pathType][0], &buffer[pos], blockSize);
-		pos += blockSize;
-	}
+		file.WillNeed(sectionPos, AlignCacheSize(offsetsSize) + costsSize);
 
-	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
-		FileSystem::Remove(cacheFileName);
-		return false;
-	}
+		std::memcpy(&blockStates.peNodeOffsets[pathType][0], file.GetData() + sectionPos, offsetsSize);
+		std::memcpy(&vertexCosts[pathType * header.numBlocks * PATH_DIRECTION_VERTICES], file.GetData() + costsPos, costsSize);
+	});
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
 	return true;
 }
 
@@ -570,41 +595,47 @@ bool PathingState::WriteFile(const std::string& peFileName, const std::string& m
 
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
 	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName);
+	const std::string filePath = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+	const std::string tempPath = filePath + ".tmp";
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
-	// open file for writing in a suitable location
-	zipFile file = zipOpen(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
-
-	if (file == nullptr)
-		return false;
-
-	zipOpenNewFileInZip(file, "pathinfo", nullptr, nullptr, 0, nullptr, 0, nullptr, Z_DEFLATED, Z_BEST_COMPRESSION);
+	const CacheFileHeader header = MakeCacheFileHeader(fileHashCode, blockStates.GetSize(), BLOCK_SIZE);
+	const std::vector<char> padding(CACHE_SECTION_ALIGNMENT, 0);
 
-	// write hash-code (NOTE: this also affects the CRC!)
-	zipWriteInFileInZip(file, (const void*) &fileHashCode, 4);
+	const auto WritePadded = [&](std::ofstream& file, const void* data, std::size_t size) {
+		file.write(reinterpret_cast<const char*>(data), size);
+		file.write(padding.data(), AlignCacheSize(size) - size);
+	};
 
-	// write center-offsets
-	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
-		zipWriteInFileInZip(file, (const void*) &blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
-	}
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
 
-	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+		if (!file.is_open())
+			return false;
 
-	zipCloseFileInZip(file);
-	zipClose(file, nullptr);
+		WritePadded(file, &header, sizeof(header));
 
+		// one section per MoveDef: its center-offsets, then its vertex-costs
+		for (unsigned int pathType = 0; pathType < header.numMoveDefs; ++pathType) {
+			WritePadded(file, &blockStates.peNodeOffsets[pathType][0], header.numBlocks * sizeof(short2));
+			WritePadded(file, &vertexCosts[pathType * header.numBlocks * PATH_DIRECTION_VERTICES], header.numBlocks * PATH_DIRECTION_VERTICES * sizeof(float));
+		}
 
-	// get the CRC over the written path data
-	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return false;
+		}
+	}
 
-	if (upfile == nullptr || !upfile->IsOpen()) {
-		FileSystem::Remove(cacheFileName);
+	// rename last so a concurrent or interrupted run never sees a partial file
+	std::remove(filePath.c_str());
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+		std::remove(tempPath.c_str());
 		return false;
 	}
 
-	assert(upfile->FindFile("pathinfo") < upfile->NumFiles());
 	return true;
 }
 
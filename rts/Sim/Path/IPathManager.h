@@ -37,6 +37,18 @@ public:
 	virtual bool PathUpdated(unsigned int pathID) { return false; }
 	virtual void ClearPathUpdated(unsigned int pathID) {}
 
+	/**
+	 * whether RequestPath(immediateResult = false) can queue caller-less
+	 * requests, which then run with the next Update alongside all others
+	 */
+	virtual bool AllowDeferredRequests() const { return false; }
+
+	/**
+	 * returns if the search for a deferred request has not run yet, in
+	 * which case the path only consists of temporary waypoints
+	 */
+	virtual bool PathSearchPending(unsigned int pathID) const { return false; }
+
 	virtual void RemoveCacheFiles() {}
 	virtual void Update() {}
 	virtual void UpdatePath(const CSolidObject* owner, unsigned int pathID) {}
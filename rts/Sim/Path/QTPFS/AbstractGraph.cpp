@@ -0,0 +1,332 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cassert>
+#include <queue>
+
+#include "AbstractGraph.h"
+#include "Node.h"
+#include "NodeLayer.h"
+#include "PathThreads.h"
+
+#include "Sim/Misc/GlobalConstants.h"
+
+#include "System/Misc/TracyDefs.h"
+
+// transient marker for leafs of the cluster being flood-filled
+static constexpr std::uint16_t UNASSIGNED_COMPONENT = QTPFS::AbstractGraph::NO_COMPONENT - 1;
+
+void QTPFS::AbstractGraph::Clear() {
+	clusters.clear();
+	nodeComponents.clear();
+	clusterNodes.clear();
+	floodNodes.clear();
+
+	xClusters = 0;
+	zClusters = 0;
+	clusterSize = 0;
+}
+
+void QTPFS::AbstractGraph::Build(const NodeLayer& nodeLayer) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	xClusters = nodeLayer.GetXRootNodes();
+	zClusters = nodeLayer.GetZRootNodes();
+	clusterSize = nodeLayer.GetRootNodeSize();
+
+	clusters.clear();
+	clusters.resize(nodeLayer.GetRootNodeCount());
+	nodeComponents.assign(nodeLayer.GetMaxNodesAlloced(), NO_COMPONENT);
+
+	minMoveCost = QTPFS_POSITIVE_INFINITY;
+
+	// all components have to exist before any cluster can link to its neighbours
+	for (unsigned int i = 0; i < clusters.size(); i++) {
+		BuildClusterComponents(nodeLayer, i);
+	}
+	// links are symmetric, so every cluster only needs to add its outgoing edges
+	for (unsigned int i = 0; i < clusters.size(); i++) {
+		LinkCluster(nodeLayer, i, false);
+	}
+}
+
+void QTPFS::AbstractGraph::UpdateArea(const NodeLayer& nodeLayer, const SRectangle& r) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!IsBuilt())
+		return;
+
+	const int cx1 = r.x1 / clusterSize;
+	const int cz1 = r.z1 / clusterSize;
+	const int cx2 = std::min((r.x2 - 1) / clusterSize, xClusters - 1);
+	const int cz2 = std::min((r.z2 - 1) / clusterSize, zClusters - 1);
+
+	for (int cz = cz1; cz <= cz2; cz++) {
+		for (int cx = cx1; cx <= cx2; cx++) {
+			UnlinkCluster(cz * xClusters + cx);
+		}
+	}
+	for (int cz = cz1; cz <= cz2; cz++) {
+		for (int cx = cx1; cx <= cx2; cx++) {
+			BuildClusterComponents(nodeLayer, cz * xClusters + cx);
+		}
+	}
+	// neighbours keep their components, they only need their edges into these clusters back
+	for (int cz = cz1; cz <= cz2; cz++) {
+		for (int cx = cx1; cx <= cx2; cx++) {
+			LinkCluster(nodeLayer, cz * xClusters + cx, true);
+		}
+	}
+}
+
+unsigned int QTPFS::AbstractGraph::GetClusterIndex(const INode* node) const {
+	return ((node->zmin() / clusterSize) * xClusters + (node->xmin() / clusterSize));
+}
+
+std::uint32_t QTPFS::AbstractGraph::GetNodeId(const INode* node) const {
+	const std::uint16_t componentIndex = nodeComponents[node->GetIndex()];
+
+	if (componentIndex == NO_COMPONENT)
+		return -1u;
+
+	return MakeId(GetClusterIndex(node), componentIndex);
+}
+
+void QTPFS::AbstractGraph::GatherClusterNodes(const NodeLayer& nodeLayer, unsigned int clusterIndex) {
+	clusterNodes.clear();
+	floodNodes.clear();
+
+	// root node indices match cluster indices, see PathManager::InitNodeLayer
+	floodNodes.push_back(nodeLayer.GetPoolNode(clusterIndex));
+
+	while (!floodNodes.empty()) {
+		const INode* curNode = floodNodes.back();
+		floodNodes.pop_back();
+
+		if (curNode->IsLeaf()) {
+			clusterNodes.push_back(curNode);
+			continue;
+		}
+
+		for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+			floodNodes.push_back(nodeLayer.GetPoolNode(curNode->GetChildBaseIndex() + i));
+		}
+	}
+}
+
+void QTPFS::AbstractGraph::BuildClusterComponents(const NodeLayer& nodeLayer, unsigned int clusterIndex) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	Cluster& cluster = clusters[clusterIndex];
+
+	cluster.components.clear();
+	GatherClusterNodes(nodeLayer, clusterIndex);
+
+	if (nodeComponents.size() < size_t(nodeLayer.GetMaxNodesAlloced()))
+		nodeComponents.resize(nodeLayer.GetMaxNodesAlloced(), NO_COMPONENT);
+
+	for (const INode* node: clusterNodes) {
+		nodeComponents[node->GetIndex()] = (node->AllSquaresImpassable() || node->IsExitOnly())? NO_COMPONENT: UNASSIGNED_COMPONENT;
+	}
+
+	for (const INode* node: clusterNodes) {
+		if (nodeComponents[node->GetIndex()] != UNASSIGNED_COMPONENT)
+			continue;
+
+		const std::uint16_t componentIndex = std::uint16_t(cluster.components.size());
+		assert(componentIndex <= COMPONENT_MASK);
+
+		Component& component = cluster.components.emplace_back();
+
+		float sumArea = 0.0f;
+		float sumCost = 0.0f;
+		float2 sumPos;
+
+		floodNodes.clear();
+		floodNodes.push_back(node);
+		nodeComponents[node->GetIndex()] = componentIndex;
+
+		while (!floodNodes.empty()) {
+			const INode* curNode = floodNodes.back();
+			floodNodes.pop_back();
+
+			const float area = curNode->area();
+
+			sumArea += area;
+			sumCost += area * curNode->GetMoveCost();
+			sumPos.x += area * (curNode->xmin() + curNode->xmax()) * 0.5f;
+			sumPos.y += area * (curNode->zmin() + curNode->zmax()) * 0.5f;
+
+			// anything outside this cluster is either assigned or has no component
+			for (const INode::NeighbourPoints& ngb: curNode->GetNeighbours()) {
+				if (nodeComponents[ngb.nodeId] != UNASSIGNED_COMPONENT)
+					continue;
+
+				nodeComponents[ngb.nodeId] = componentIndex;
+				floodNodes.push_back(nodeLayer.GetPoolNode(ngb.nodeId));
+			}
+		}
+
+		component.anchor = {sumPos.x / sumArea * SQUARE_SIZE, sumPos.y / sumArea * SQUARE_SIZE};
+		component.moveCost = sumCost / sumArea;
+
+		minMoveCost = std::min(minMoveCost, component.moveCost);
+	}
+}
+
+void QTPFS::AbstractGraph::LinkCluster(const NodeLayer& nodeLayer, unsigned int clusterIndex, bool linkBack) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	GatherClusterNodes(nodeLayer, clusterIndex);
+
+	for (const INode* node: clusterNodes) {
+		const std::uint16_t componentIndex = nodeComponents[node->GetIndex()];
+
+		if (componentIndex == NO_COMPONENT)
+			continue;
+
+		const std::uint32_t srcId = MakeId(clusterIndex, componentIndex);
+
+		for (const INode::NeighbourPoints& ngb: node->GetNeighbours()) {
+			const INode* ngbNode = nodeLayer.GetPoolNode(ngb.nodeId);
+			const unsigned int ngbClusterIndex = GetClusterIndex(ngbNode);
+
+			if (ngbClusterIndex == clusterIndex)
+				continue;
+
+			const std::uint32_t tgtId = GetNodeId(ngbNode);
+
+			if (tgtId == -1u)
+				continue;
+
+			// the entrance: cost from either component's centre to the shared edge
+			const float2& netPoint = ngb.netpoints[0];
+			const Component& srcComponent = GetComponent(srcId);
+			const Component& tgtComponent = GetComponent(tgtId);
+			const float cost =
+				srcComponent.moveCost * srcComponent.anchor.Distance(netPoint) +
+				tgtComponent.moveCost * tgtComponent.anchor.Distance(netPoint);
+
+			AddEdge(srcId, tgtId, cost);
+
+			if (linkBack)
+				AddEdge(tgtId, srcId, cost);
+		}
+	}
+}
+
+void QTPFS::AbstractGraph::UnlinkCluster(unsigned int clusterIndex) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const int cx = clusterIndex % xClusters;
+	const int cz = clusterIndex / xClusters;
+
+	// leafs only link to direct (edge or corner) neighbours, so no edge can come from further away
+	for (int nz = std::max(cz - 1, 0); nz <= std::min(cz + 1, zClusters - 1); nz++) {
+		for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, xClusters - 1); nx++) {
+			if (nx == cx && nz == cz)
+				continue;
+
+			for (Component& component: clusters[nz * xClusters + nx].components) {
+				auto& edges = component.edges;
+				edges.erase(std::remove_if(edges.begin(), edges.end(), [clusterIndex](const Edge& e) { return (GetIdCluster(e.tgtId) == clusterIndex); }), edges.end());
+			}
+		}
+	}
+}
+
+void QTPFS::AbstractGraph::AddEdge(std::uint32_t srcId, std::uint32_t tgtId, float cost) {
+	auto& edges = GetComponent(srcId).edges;
+	const auto iter = std::find_if(edges.begin(), edges.end(), [tgtId](const Edge& e) { return (e.tgtId == tgtId); });
+
+	// several entrances between the same two components, keep the cheapest
+	if (iter != edges.end()) {
+		iter->cost = std::min(iter->cost, cost);
+		return;
+	}
+
+	edges.push_back({tgtId, cost});
+}
+
+bool QTPFS::AbstractGraph::FindCorridor(const INode* srcNode, const INode* tgtNode, SearchData& searchData, std::vector<std::uint8_t>& corridor) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!IsBuilt())
+		return false;
+
+	const std::uint32_t srcId = GetNodeId(srcNode);
+	const std::uint32_t tgtId = GetNodeId(tgtNode);
+
+	if (srcId == -1u || tgtId == -1u)
+		return false;
+
+	const float2 tgtAnchor = GetComponent(tgtId).anchor;
+	const auto hCost = [&](std::uint32_t id) { return (GetComponent(id).anchor.Distance(tgtAnchor) * minMoveCost); };
+
+	auto& searchNodes = searchData.searchNodes;
+	searchNodes.clear();
+	searchNodes[srcId] = {0.0f, -1u};
+
+	// same entry type and total order as the leaf-level search, so synced results match everywhere
+	std::priority_queue<SearchQueueNode, std::vector<SearchQueueNode>, ShouldMoveTowardsBottomOfPriorityQueue> openIds;
+	openIds.emplace(int(srcId), hCost(srcId));
+
+	bool foundTgt = false;
+
+	while (!openIds.empty()) {
+		const SearchQueueNode curOpenId = openIds.top();
+		openIds.pop();
+
+		const std::uint32_t curId = curOpenId.nodeIndex;
+		const float curCost = searchNodes[curId].gCost;
+
+		if (curId == tgtId) {
+			foundTgt = true;
+			break;
+		}
+
+		// stale entry, a cheaper one was already expanded
+		if (curOpenId.heapPriority > curCost + hCost(curId))
+			continue;
+
+		for (const Edge& edge: GetComponent(curId).edges) {
+			const float ngbCost = curCost + edge.cost;
+			const auto iter = searchNodes.find(edge.tgtId);
+
+			if (iter != searchNodes.end() && ngbCost >= iter->second.gCost)
+				continue;
+
+			searchNodes[edge.tgtId] = {ngbCost, curId};
+			openIds.emplace(int(edge.tgtId), ngbCost + hCost(edge.tgtId));
+		}
+	}
+
+	if (!foundTgt)
+		return false;
+
+	corridor.assign(clusters.size(), 0);
+
+	for (std::uint32_t id = tgtId; id != -1u; id = searchNodes[id].prevId) {
+		const int cx = GetIdCluster(id) % xClusters;
+		const int cz = GetIdCluster(id) / xClusters;
+
+		// widen by one cluster so smoothing and detours around the entrances have some room
+		for (int nz = std::max(cz - 1, 0); nz <= std::min(cz + 1, zClusters - 1); nz++) {
+			for (int nx = std::max(cx - 1, 0); nx <= std::min(cx + 1, xClusters - 1); nx++) {
+				corridor[nz * xClusters + nx] = 1;
+			}
+		}
+	}
+
+	return true;
+}
+
+std::uint64_t QTPFS::AbstractGraph::GetMemFootPrint() const {
+	std::uint64_t memFootPrint = sizeof(AbstractGraph);
+
+	memFootPrint += (nodeComponents.size() * sizeof(decltype(nodeComponents)::value_type));
+
+	for (const Cluster& cluster: clusters) {
+		memFootPrint += sizeof(Cluster) + cluster.components.size() * sizeof(Component);
+
+		for (const Component& component: cluster.components) {
+			memFootPrint += (component.edges.size() * sizeof(Edge));
+		}
+	}
+
+	return memFootPrint;
+}
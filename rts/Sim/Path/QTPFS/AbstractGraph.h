@@ -0,0 +1,111 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QTPFS_ABSTRACTGRAPH_H_
+#define QTPFS_ABSTRACTGRAPH_H_
+
+#include <cinttypes>
+#include <vector>
+
+#include "System/float3.h"
+#include "System/Rectangle.h"
+#include "System/UnorderedMap.hpp"
+
+namespace QTPFS {
+	struct INode;
+	struct NodeLayer;
+
+	// Coarse graph over a node-layer for long-distance searches. Every root node is a cluster,
+	// split into components of open leaf nodes that are connected without leaving the cluster.
+	// Components of neighbouring clusters are linked wherever one of their leafs touch (the
+	// cluster entrances), weighted by the move-cost from each component's centre to the shared
+	// edge. A search over this graph yields the corridor of clusters a long path has to cross,
+	// which PathSearch then uses to keep the leaf-level search from flooding the rest of the map.
+	//
+	// Closed and exit-only leafs are left out so that a link always means both sides can reach
+	// each other, which makes the corridor conservative: if it exists, so does a real path in it.
+	struct AbstractGraph {
+	public:
+		struct Edge {
+			std::uint32_t tgtId;
+			float cost;
+		};
+
+		struct Component {
+			float2 anchor;
+			float moveCost = 0.0f;
+			std::vector<Edge> edges;
+		};
+
+		struct Cluster {
+			std::vector<Component> components;
+		};
+
+		struct SearchNode {
+			float gCost;
+			std::uint32_t prevId;
+		};
+
+		// per-thread scratch space for FindCorridor
+		struct SearchData {
+			spring::unordered_map<std::uint32_t, SearchNode> searchNodes;
+		};
+
+		// a root node is at most QTPFS_MAX_NODE_SIZE^2 = 4096 leafs, so it can't have more components
+		static constexpr std::uint32_t COMPONENT_BITS = 12;
+		static constexpr std::uint32_t COMPONENT_MASK = (1 << COMPONENT_BITS) - 1;
+		static constexpr std::uint16_t NO_COMPONENT = 0xFFFF;
+
+		static std::uint32_t MakeId(unsigned int clusterIndex, unsigned int componentIndex) { return ((clusterIndex << COMPONENT_BITS) | componentIndex); }
+		static unsigned int GetIdCluster(std::uint32_t id) { return (id >> COMPONENT_BITS); }
+		static unsigned int GetIdComponent(std::uint32_t id) { return (id & COMPONENT_MASK); }
+
+		void Clear();
+		void Build(const NodeLayer& nodeLayer);
+
+		// re-links all clusters overlapping <r> after their leafs were re-tesselated
+		void UpdateArea(const NodeLayer& nodeLayer, const SRectangle& r);
+
+		bool IsBuilt() const { return (!clusters.empty()); }
+
+		unsigned int GetNumClusters() const { return clusters.size(); }
+		unsigned int GetClusterIndex(const INode* node) const;
+
+		// Searches the abstract graph from <srcNode>'s component to <tgtNode>'s and flags every
+		// cluster on the way plus its eight neighbours in <corridor>; false (and <corridor> left
+		// alone) if either node isn't part of a component or the two are not connected.
+		bool FindCorridor(const INode* srcNode, const INode* tgtNode, SearchData& searchData, std::vector<std::uint8_t>& corridor) const;
+
+		std::uint64_t GetMemFootPrint() const;
+
+	private:
+		void GatherClusterNodes(const NodeLayer& nodeLayer, unsigned int clusterIndex);
+		void BuildClusterComponents(const NodeLayer& nodeLayer, unsigned int clusterIndex);
+		void LinkCluster(const NodeLayer& nodeLayer, unsigned int clusterIndex, bool linkBack);
+		void UnlinkCluster(unsigned int clusterIndex);
+
+		void AddEdge(std::uint32_t srcId, std::uint32_t tgtId, float cost);
+
+		const Component& GetComponent(std::uint32_t id) const { return clusters[GetIdCluster(id)].components[GetIdComponent(id)]; }
+		      Component& GetComponent(std::uint32_t id)       { return clusters[GetIdCluster(id)].components[GetIdComponent(id)]; }
+
+		std::uint32_t GetNodeId(const INode* node) const;
+
+	private:
+		std::vector<Cluster> clusters;
+
+		// component of every leaf node, indexed by pool index
+		std::vector<std::uint16_t> nodeComponents;
+
+		// scratch space for (re)building clusters, only ever used by the layer's update thread
+		std::vector<const INode*> clusterNodes;
+		std::vector<const INode*> floodNodes;
+
+		int xClusters = 0;
+		int zClusters = 0;
+		int clusterSize = 0;
+
+		float minMoveCost = 0.0f;
+	};
+}
+
+#endif
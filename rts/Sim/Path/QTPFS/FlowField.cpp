@@ -0,0 +1,129 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <queue>
+
+#include "FlowField.h"
+#include "Node.h"
+#include "NodeLayer.h"
+#include "PathThreads.h"
+
+#include "Sim/Misc/GlobalConstants.h"
+
+#include "System/Misc/TracyDefs.h"
+
+float2 QTPFS::FlowField::GetAnchor(const INode* node) const {
+	if (node->GetIndex() == goalNodeIndex)
+		return goalPoint;
+
+	return {(node->xmin() + node->xmax()) * 0.5f * SQUARE_SIZE, (node->zmin() + node->zmax()) * 0.5f * SQUARE_SIZE};
+}
+
+bool QTPFS::FlowField::Build(const NodeLayer& nodeLayer, unsigned int goalNodeIndex, const float3& goalPoint) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const INode* goalNode = nodeLayer.GetPoolNode(goalNodeIndex);
+
+	this->goalNodeIndex = goalNodeIndex;
+	this->goalPoint = {goalPoint.x, goalPoint.z};
+
+	costs.clear();
+
+	if (goalNode->AllSquaresImpassable())
+		return false;
+
+	costs.resize(nodeLayer.GetMaxNodesAlloced(), QTPFS_POSITIVE_INFINITY);
+	costs[goalNodeIndex] = 0.0f;
+
+	// same entry type and total order as the search queue, so the result is identical everywhere
+	std::priority_queue<SearchQueueNode, std::vector<SearchQueueNode>, ShouldMoveTowardsBottomOfPriorityQueue> openNodes;
+	openNodes.emplace(goalNodeIndex, 0.0f);
+
+	while (!openNodes.empty()) {
+		const SearchQueueNode curOpenNode = openNodes.top();
+		openNodes.pop();
+
+		// stale entry, a cheaper one was already expanded
+		if (curOpenNode.heapPriority > costs[curOpenNode.nodeIndex])
+			continue;
+
+		const INode* curNode = nodeLayer.GetPoolNode(curOpenNode.nodeIndex);
+		const float2 curAnchor = GetAnchor(curNode);
+
+		for (const INode::NeighbourPoints& ngb: curNode->GetNeighbours()) {
+			const INode* ngbNode = nodeLayer.GetPoolNode(ngb.nodeId);
+
+			if (ngbNode->AllSquaresImpassable())
+				continue;
+
+			// travelling ngb -> cur, through the transition point on their shared edge
+			const float2& netPoint = ngb.netpoints[0];
+			const float cost =
+				curOpenNode.heapPriority +
+				curNode->GetMoveCost() * curAnchor.Distance(netPoint) +
+				ngbNode->GetMoveCost() * GetAnchor(ngbNode).Distance(netPoint);
+
+			if (cost >= costs[ngb.nodeId])
+				continue;
+
+			costs[ngb.nodeId] = cost;
+			openNodes.emplace(ngb.nodeId, cost);
+		}
+	}
+
+	return true;
+}
+
+bool QTPFS::FlowField::Trace(const NodeLayer& nodeLayer, const float3& srcPoint, std::vector<unsigned int>& nodes, std::vector<float2>& points) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (costs.empty())
+		return false;
+
+	const INode* curNode = nodeLayer.GetNode(srcPoint.x / SQUARE_SIZE, srcPoint.z / SQUARE_SIZE);
+	float2 curPoint = {srcPoint.x, srcPoint.z};
+
+	nodes.push_back(curNode->GetIndex());
+
+	// every step after the first strictly lowers the cost, so this bound is never reached on a
+	// consistent field; it only guards against walking in circles on a stale one
+	for (size_t n = 0; n < costs.size() && curNode->GetIndex() != goalNodeIndex; n++) {
+		// let units escape from a closed node, like the regular search does
+		const bool curClosed = curNode->AllSquaresImpassable();
+		const float curMoveCost = curClosed? QTPFS_CLOSED_NODE_COST: curNode->GetMoveCost();
+		const float curCost = costs[curNode->GetIndex()];
+
+		const INode* bestNode = nullptr;
+		float2 bestPoint;
+		float bestCost = QTPFS_POSITIVE_INFINITY;
+
+		for (const INode::NeighbourPoints& ngb: curNode->GetNeighbours()) {
+			const float ngbCost = costs[ngb.nodeId];
+
+			if (ngbCost >= curCost && !(curClosed && ngbCost < QTPFS_POSITIVE_INFINITY))
+				continue;
+
+			const INode* ngbNode = nodeLayer.GetPoolNode(ngb.nodeId);
+			const float2& netPoint = ngb.netpoints[0];
+			const float cost =
+				ngbCost +
+				curMoveCost * curPoint.Distance(netPoint) +
+				ngbNode->GetMoveCost() * GetAnchor(ngbNode).Distance(netPoint);
+
+			if (cost >= bestCost)
+				continue;
+
+			bestNode = ngbNode;
+			bestPoint = netPoint;
+			bestCost = cost;
+		}
+
+		if (bestNode == nullptr)
+			return false;
+
+		nodes.push_back(bestNode->GetIndex());
+		points.push_back(bestPoint);
+
+		curNode = bestNode;
+		curPoint = bestPoint;
+	}
+
+	return (curNode->GetIndex() == goalNodeIndex);
+}
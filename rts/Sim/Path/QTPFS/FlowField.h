@@ -0,0 +1,43 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QTPFS_FLOWFIELD_H_
+#define QTPFS_FLOWFIELD_H_
+
+#include <cinttypes>
+#include <vector>
+
+#include "System/float3.h"
+
+namespace QTPFS {
+	struct INode;
+	struct NodeLayer;
+
+	// Cost-to-goal of every node in a layer, from one reverse Dijkstra out of the goal node.
+	// Used when many synced searches of the same layer head for the same goal node and goal
+	// radius: each of them then only has to walk down the field instead of running its own
+	// search. Costs are measured between node centres (the goal point for the goal node) via
+	// the same edge transition points and move-costs the regular search uses.
+	struct FlowField {
+	public:
+		// false if the goal is impassable, in which case the regular search has to deal with it
+		bool Build(const NodeLayer& nodeLayer, unsigned int goalNodeIndex, const float3& goalPoint);
+
+		// Walks from <srcPoint> down the field and appends the visited node indices to <nodes>
+		// and the transition points between them to <points> (one less than nodes); false if
+		// the source cannot reach the goal.
+		bool Trace(const NodeLayer& nodeLayer, const float3& srcPoint, std::vector<unsigned int>& nodes, std::vector<float2>& points) const;
+
+		unsigned int GetGoalNodeIndex() const { return goalNodeIndex; }
+
+	private:
+		float2 GetAnchor(const INode* node) const;
+
+	private:
+		std::vector<float> costs;
+
+		float2 goalPoint;
+		unsigned int goalNodeIndex = -1u;
+	};
+}
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "Node.h"
 #include "NodeLayer.h"
+#include "NodeLayerCache.h"
 #include "PathDefines.h"
 #include "PathManager.h"
 #include "PathThreads.h"
@@ -668,46 +669,26 @@ unsigned int QTPFS::QTNode::GetMaxNumNeighbors() const {
 }
 
 
-// THIS FUNCTION IS NOT USED
-// Loading the cache seems to be slower than regenerating the data live at the moment.
-void QTPFS::QTNode::Serialize(std::fstream& fStream, NodeLayer& nodeLayer, unsigned int* streamSize, unsigned int depth, bool readMode) {
+// node state as it is after tesselation, for NodeLayerCache; nodes are written
+// flat in pool order so childBaseIndex stays valid without re-splitting
+void QTPFS::QTNode::Serialize(CacheWriter& writer) const {
 	RECOIL_DETAILED_TRACY_ZONE;
-	// overwritten when de-serializing
-	unsigned int numChildren = QTNODE_CHILD_COUNT * (1 - int(IsLeaf()));
-
-	(*streamSize) += (3 * sizeof(unsigned int));
-	(*streamSize) += (3 * sizeof(float));
-
-	if (readMode) {
-		fStream.read(reinterpret_cast<char*>(&nodeNumber), sizeof(unsigned int));
-		fStream.read(reinterpret_cast<char*>(&numChildren), sizeof(unsigned int));
-		fStream.read(reinterpret_cast<char*>(&childBaseIndex), sizeof(unsigned int));
-
-		// fStream.read(reinterpret_cast<char*>(&speedModAvg), sizeof(float));
-		// fStream.read(reinterpret_cast<char*>(&speedModSum), sizeof(float));
-		fStream.read(reinterpret_cast<char*>(&moveCostAvg), sizeof(float));
-
-		if (numChildren > 0) {
-			// re-create child nodes
-			assert(IsLeaf());
-			Split(nodeLayer, depth, true);
-		} else {
-			// node was a leaf in an earlier life, register it
-			// nodeLayer.RegisterNode(this);
-		}
-	} else {
-		fStream.write(reinterpret_cast<const char*>(&nodeNumber), sizeof(unsigned int));
-		fStream.write(reinterpret_cast<const char*>(&numChildren), sizeof(unsigned int));
-		fStream.write(reinterpret_cast<const char*>(&childBaseIndex), sizeof(unsigned int));
-
-		// fStream.write(reinterpret_cast<const char*>(&speedModAvg), sizeof(float));
-		// fStream.write(reinterpret_cast<const char*>(&speedModSum), sizeof(float));
-		fStream.write(reinterpret_cast<const char*>(&moveCostAvg), sizeof(float));
-	}
+	writer.Put(nodeNumber);
+	writer.Put(index);
+	writer.Put(points);
+	writer.Put(moveCostAvg);
+	writer.Put(childBaseIndex);
+	writer.PutVector(neighbours);
+}
 
-	for (unsigned int i = 0; i < numChildren; i++) {
-		nodeLayer.GetPoolNode(childBaseIndex + i)->Serialize(fStream, nodeLayer, streamSize, depth + 1, readMode);
-	}
+bool QTPFS::QTNode::Deserialize(CacheReader& reader) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	reader.Get(nodeNumber);
+	reader.Get(index);
+	reader.Get(points);
+	reader.Get(moveCostAvg);
+	reader.Get(childBaseIndex);
+	return reader.GetVector(neighbours);
 }
 
 
@@ -25,6 +25,8 @@
 
 namespace QTPFS {
 	struct NodeLayer;
+	struct CacheWriter;
+	struct CacheReader;
 	struct SearchNode;
 	struct UpdateThreadData;
 
@@ -83,7 +85,8 @@ namespace QTPFS {
 
 		void PreTesselate(NodeLayer& nl, const SRectangle& r, SRectangle& ur, unsigned int depth, const UpdateThreadData* threadData);
 		void Tesselate(NodeLayer& nl, const SRectangle& r, unsigned int depth, const UpdateThreadData* threadData);
-		void Serialize(std::fstream& fStream, NodeLayer& nodeLayer, unsigned int* streamSize, unsigned int depth, bool readMode);
+		void Serialize(CacheWriter& writer) const;
+		bool Deserialize(CacheReader& reader);
 
 		bool IsLeaf() const { return (childBaseIndex == -1u); }
 		bool CanSplit(unsigned int depth, bool forced) const;
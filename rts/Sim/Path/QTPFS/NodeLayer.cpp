@@ -22,6 +22,7 @@ inline int __bsfd (int mask)
 #include "NodeLayer.h"
 #include "PathManager.h"
 #include "Node.h"
+#include "NodeLayerCache.h"
 
 #include "Map/MapInfo.h"
 #include "Sim/Misc/ModInfo.h"
@@ -77,12 +78,16 @@ void QTPFS::NodeLayer::Init(unsigned int layerNum) {
 
 	MoveDef* md = moveDefHandler.GetMoveDefByPathType(layerNum);
 	useShortestPath = md->preferShortestPath;
+
+	// built by the PathManager once the layer is tesselated
+	abstractGraph.Clear();
 }
 
 void QTPFS::NodeLayer::Clear() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	curSpeedMods.clear();
 	curSpeedBins.clear();
+	abstractGraph.Clear();
 }
 
 
@@ -197,6 +202,103 @@ bool QTPFS::NodeLayer::Update(UpdateThreadData& threadData) {
 }
 
 
+void QTPFS::NodeLayer::Serialize(CacheWriter& writer) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	writer.Put(layerNumber);
+	writer.Put(numLeafNodes);
+	writer.Put(updateCounter);
+	writer.Put(numOpenNodes);
+	writer.Put(numClosedNodes);
+	writer.Put(maxNodesAlloced);
+	writer.Put(numRootNodes);
+	writer.Put(xRootNodes);
+	writer.Put(zRootNodes);
+	writer.Put(rootNodeSize);
+	writer.Put(rootMask);
+	writer.Put(xsize);
+	writer.Put(zsize);
+	writer.Put(maxRelSpeedMod);
+	writer.Put(avgRelSpeedMod);
+
+	// the free-list is mostly one long descending run, store it as (first, count) pairs
+	std::vector<uint32_t> freeRuns;
+	for (size_t i = 0, n = nodeIndcs.size(); i < n; ) {
+		size_t j = i + 1;
+		while (j < n && nodeIndcs[j] + 1 == nodeIndcs[j - 1])
+			j++;
+
+		freeRuns.push_back(nodeIndcs[i]);
+		freeRuns.push_back(j - i);
+		i = j;
+	}
+	writer.PutVector(freeRuns);
+
+	for (size_t i = 0; i < NUM_POOL_CHUNKS; i++) {
+		writer.Put(static_cast<uint32_t>(poolNodes[i].size()));
+	}
+	for (int32_t i = 0; i < maxNodesAlloced; i++) {
+		GetPoolNode(i)->Serialize(writer);
+	}
+}
+
+bool QTPFS::NodeLayer::Deserialize(CacheReader& reader) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	// Init must have run, it sets up everything not stored here
+	reader.Get(layerNumber);
+	reader.Get(numLeafNodes);
+	reader.Get(updateCounter);
+	reader.Get(numOpenNodes);
+	reader.Get(numClosedNodes);
+	reader.Get(maxNodesAlloced);
+	reader.Get(numRootNodes);
+	reader.Get(xRootNodes);
+	reader.Get(zRootNodes);
+	reader.Get(rootNodeSize);
+	reader.Get(rootMask);
+	reader.Get(xsize);
+	reader.Get(zsize);
+	reader.Get(maxRelSpeedMod);
+	reader.Get(avgRelSpeedMod);
+
+	std::vector<uint32_t> freeRuns;
+	if (!reader.GetVector(freeRuns) || (freeRuns.size() & 1) != 0)
+		return false;
+
+	nodeIndcs.clear();
+	for (size_t i = 0; i < freeRuns.size(); i += 2) {
+		if (freeRuns[i + 1] > freeRuns[i] + 1u || nodeIndcs.size() + freeRuns[i + 1] > POOL_TOTAL_SIZE)
+			return false;
+
+		for (uint32_t k = 0; k < freeRuns[i + 1]; k++) {
+			nodeIndcs.push_back(freeRuns[i] - k);
+		}
+	}
+
+	for (size_t i = 0; i < NUM_POOL_CHUNKS; i++) {
+		uint32_t chunkSize = 0;
+		reader.Get(chunkSize);
+
+		if (chunkSize != 0 && chunkSize != POOL_CHUNK_SIZE)
+			return false;
+
+		poolNodes[i].clear();
+		poolNodes[i].resize(chunkSize);
+	}
+
+	if (!reader.Ok() || maxNodesAlloced < 0 || size_t(maxNodesAlloced) > POOL_TOTAL_SIZE)
+		return false;
+
+	for (int32_t i = 0; i < maxNodesAlloced; i++) {
+		if (poolNodes[i / POOL_CHUNK_SIZE].empty())
+			return false;
+		if (!GetPoolNode(i)->Deserialize(reader))
+			return false;
+	}
+
+	return true;
+}
+
+
 QTPFS::SpeedBinType QTPFS::NodeLayer::GetSpeedModBin(float absSpeedMod, float relSpeedMod) const {
 	RECOIL_DETAILED_TRACY_ZONE;
 	// NOTE:
@@ -11,6 +11,7 @@
 #include <cinttypes>
 
 #include "System/Rectangle.h"
+#include "AbstractGraph.h"
 #include "Node.h"
 #include "PathDefines.h"
 #include "PathThreads.h"
@@ -141,6 +142,7 @@ namespace QTPFS {
 			}
 
 			memFootPrint += (nodeIndcs.size() * sizeof(decltype(nodeIndcs)::value_type));
+			memFootPrint += abstractGraph.GetMemFootPrint();
 			return memFootPrint;
 		}
 
@@ -155,6 +157,10 @@ namespace QTPFS {
 			return numRootNodes;
 		}
 
+		int GetXRootNodes() const { return xRootNodes; }
+		int GetZRootNodes() const { return zRootNodes; }
+		int GetRootNodeSize() const { return rootNodeSize; }
+
 		int GetNodelayer() const {
 			return layerNumber;
 		}
@@ -165,6 +171,12 @@ namespace QTPFS {
 
 		bool UseShortestPath() { return useShortestPath; }
 
+		void Serialize(CacheWriter& writer) const;
+		bool Deserialize(CacheReader& reader);
+
+		const AbstractGraph& GetAbstractGraph() const { return abstractGraph; }
+		      AbstractGraph& GetAbstractGraph()       { return abstractGraph; }
+
 	private:
 		std::vector<QTNode> poolNodes[16];
 		std::vector<unsigned int> nodeIndcs;
@@ -175,6 +187,9 @@ namespace QTPFS {
 		std::vector<SpeedModType> curSpeedMods;
 		std::vector<SpeedBinType> curSpeedBins;
 
+		// not serialized, rebuilt from the nodes when enabled
+		AbstractGraph abstractGraph;
+
 public:
 		static constexpr unsigned int NUM_POOL_CHUNKS = sizeof(poolNodes) / sizeof(poolNodes[0]);
 		static constexpr unsigned int POOL_TOTAL_SIZE = (1024 * 1024) / 2;
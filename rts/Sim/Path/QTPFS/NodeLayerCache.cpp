@@ -0,0 +1,167 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdio>
+#include <fstream>
+
+#include "NodeLayerCache.h"
+#include "NodeLayer.h"
+#include "Node.h"
+
+#include "Game/GameSetup.h"
+#include "Game/GameVersion.h"
+#include "Map/MapInfo.h"
+#include "Map/ReadMap.h"
+#include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+
+#include "System/Misc/TracyDefs.h"
+
+static constexpr std::uint32_t CACHE_MAGIC = 0x4C4E5451; // "QTNL"
+// bump whenever NodeLayer or QTNode serialization changes
+static constexpr std::uint32_t CACHE_VERSION = 1;
+
+static std::string GetCacheFileName(const sha512::raw_digest& key) {
+	sha512::hex_digest keyHex;
+	sha512::dump_digest(key, keyHex);
+
+	// a prefix is plenty to tell maps apart, the full key is checked on load
+	return FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + "QTPFS/" + std::string(keyHex.data(), 32) + ".dat";
+}
+
+
+sha512::raw_digest QTPFS::NodeLayerCache::CalcKey(int rootSize) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	std::vector<std::uint8_t> keyData;
+	CacheWriter writer(keyData);
+
+	const std::string& syncVersion = SpringVersion::GetSync();
+	keyData.insert(keyData.end(), syncVersion.begin(), syncVersion.end());
+
+	writer.Put(CACHE_VERSION);
+	writer.Put(archiveScanner->GetArchiveCompleteChecksumBytes(gameSetup->mapName));
+	writer.Put(archiveScanner->GetArchiveCompleteChecksumBytes(gameSetup->modName));
+
+	writer.Put(mapDims.mapx);
+	writer.Put(mapDims.mapy);
+	writer.Put(rootSize);
+	writer.Put(NodeLayer::NUM_SPEEDMOD_BINS);
+	writer.Put(NodeLayer::MIN_SPEEDMOD_VALUE);
+	writer.Put(NodeLayer::MAX_SPEEDMOD_VALUE);
+	writer.Put(QTNode::MinSizeX());
+	writer.Put(QTNode::MinSizeZ());
+	writer.Put(QTNode::MAX_DEPTH);
+	writer.Put(CMoveMath::noHoverWaterMove);
+	writer.Put(CMoveMath::waterDamageCost);
+
+	for (const CMapInfo::TerrainType& tt: mapInfo->terrainTypes) {
+		writer.Put(tt.tankSpeed);
+		writer.Put(tt.kbotSpeed);
+		writer.Put(tt.hoverSpeed);
+		writer.Put(tt.shipSpeed);
+	}
+	for (unsigned int i = 0, n = moveDefHandler.GetNumMoveDefs(); i < n; i++) {
+		writer.Put(moveDefHandler.GetMoveDefByPathType(i)->CalcCheckSum());
+	}
+
+	// the synced maps as they are now, not as they are in the archive
+	sha512::raw_digest mapDigest;
+	sha512::calc_digest(reinterpret_cast<const std::uint8_t*>(readMap->GetCenterHeightMapSynced()), mapDims.mapx * mapDims.mapy * sizeof(float), mapDigest.data());
+	writer.Put(mapDigest);
+	sha512::calc_digest(readMap->GetTypeMapSynced(), mapDims.hmapx * mapDims.hmapy, mapDigest.data());
+	writer.Put(mapDigest);
+
+	sha512::raw_digest key;
+	sha512::calc_digest(keyData, key);
+	return key;
+}
+
+bool QTPFS::NodeLayerCache::Load(const sha512::raw_digest& key, std::vector<NodeLayer>& nodeLayers) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::string fileName = GetCacheFileName(key);
+
+	if (!FileSystem::FileExists(fileName))
+		return false;
+
+	std::vector<std::uint8_t> fileData(FileSystem::GetFileSize(fileName));
+	{
+		std::ifstream file(fileName, std::ios::binary);
+		if (!file.read(reinterpret_cast<char*>(fileData.data()), fileData.size()))
+			return false;
+	}
+
+	CacheReader reader(fileData.data(), fileData.data() + fileData.size());
+
+	std::uint32_t magic = 0;
+	std::uint32_t version = 0;
+	std::uint32_t numLayers = 0;
+	sha512::raw_digest fileKey;
+
+	reader.Get(magic);
+	reader.Get(version);
+	reader.Get(fileKey);
+	reader.Get(numLayers);
+
+	if (!reader.Ok() || magic != CACHE_MAGIC || version != CACHE_VERSION || fileKey != key || numLayers != nodeLayers.size()) {
+		LOG_L(L_WARNING, "[QTPFS::NodeLayerCache::%s] ignoring stale cache file %s", __func__, fileName.c_str());
+		return false;
+	}
+
+	bool loaded = true;
+
+	for (unsigned int layerNum = 0; loaded && layerNum < numLayers; layerNum++) {
+		nodeLayers[layerNum].Init(layerNum);
+		loaded = nodeLayers[layerNum].Deserialize(reader);
+	}
+
+	if (!loaded || !reader.AtEnd()) {
+		LOG_L(L_WARNING, "[QTPFS::NodeLayerCache::%s] corrupt cache file %s", __func__, fileName.c_str());
+
+		// leave nothing half-loaded behind for the regular tesselation
+		nodeLayers.clear();
+		nodeLayers.resize(numLayers);
+		return false;
+	}
+
+	LOG("[QTPFS::NodeLayerCache::%s] loaded %u node-layers from %s", __func__, numLayers, fileName.c_str());
+	return true;
+}
+
+bool QTPFS::NodeLayerCache::Save(const sha512::raw_digest& key, const std::vector<NodeLayer>& nodeLayers) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::string fileName = GetCacheFileName(key);
+	const std::string tempName = fileName + ".tmp";
+
+	std::vector<std::uint8_t> fileData;
+	CacheWriter writer(fileData);
+
+	writer.Put(CACHE_MAGIC);
+	writer.Put(CACHE_VERSION);
+	writer.Put(key);
+	writer.Put(static_cast<std::uint32_t>(nodeLayers.size()));
+
+	for (const NodeLayer& nodeLayer: nodeLayers) {
+		nodeLayer.Serialize(writer);
+	}
+
+	if (!FileSystem::CreateDirectory(FileSystem::GetDirectory(fileName)))
+		return false;
+
+	{
+		std::ofstream file(tempName, std::ios::binary | std::ios::trunc);
+		if (!file.write(reinterpret_cast<const char*>(fileData.data()), fileData.size()))
+			return false;
+	}
+
+	// rename last so a concurrent or interrupted run never sees a partial file
+	std::remove(fileName.c_str());
+	if (std::rename(tempName.c_str(), fileName.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		return false;
+	}
+
+	LOG("[QTPFS::NodeLayerCache::%s] saved %u node-layers (%uKB) to %s", __func__, unsigned(nodeLayers.size()), unsigned(fileData.size() >> 10), fileName.c_str());
+	return true;
+}
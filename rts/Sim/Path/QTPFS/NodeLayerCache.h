@@ -0,0 +1,83 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef QTPFS_NODELAYERCACHE_H_
+#define QTPFS_NODELAYERCACHE_H_
+
+#include <cinttypes>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+#include "System/Sync/SHA512.hpp"
+
+namespace QTPFS {
+	struct NodeLayer;
+
+	// flat little helpers for the node-layer cache; only trivially copyable data goes in
+	struct CacheWriter {
+	public:
+		CacheWriter(std::vector<std::uint8_t>& b): buffer(b) {}
+
+		template<typename T> void Put(const T& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			const auto* p = reinterpret_cast<const std::uint8_t*>(&v);
+			buffer.insert(buffer.end(), p, p + sizeof(T));
+		}
+		template<typename T> void PutVector(const std::vector<T>& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			Put(static_cast<std::uint32_t>(v.size()));
+			const auto* p = reinterpret_cast<const std::uint8_t*>(v.data());
+			buffer.insert(buffer.end(), p, p + v.size() * sizeof(T));
+		}
+
+	private:
+		std::vector<std::uint8_t>& buffer;
+	};
+
+	struct CacheReader {
+	public:
+		CacheReader(const std::uint8_t* b, const std::uint8_t* e): cur(b), end(e) {}
+
+		template<typename T> bool Get(T& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			ok = ok && (size_t(end - cur) >= sizeof(T));
+			if (ok) {
+				std::memcpy(&v, cur, sizeof(T));
+				cur += sizeof(T);
+			}
+			return ok;
+		}
+		template<typename T> bool GetVector(std::vector<T>& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			std::uint32_t n = 0;
+			ok = Get(n) && (size_t(end - cur) / sizeof(T) >= n);
+			if (!ok)
+				return false;
+			v.resize(n);
+			std::memcpy(v.data(), cur, n * sizeof(T));
+			cur += n * sizeof(T);
+			return true;
+		}
+
+		bool Ok() const { return ok; }
+		bool AtEnd() const { return (cur == end); }
+
+	private:
+		const std::uint8_t* cur;
+		const std::uint8_t* end;
+		bool ok = true;
+	};
+
+	// Node layers as they are after the initial map-wide tesselation, stored in the cache dir.
+	// The key covers everything that tesselation depends on, including the synced height- and
+	// type-maps (Lua may have changed them before the PFS is created), so a hit reproduces the
+	// layers exactly; pfsCheckSum is still computed from them and synced as before.
+	namespace NodeLayerCache {
+		sha512::raw_digest CalcKey(int rootSize);
+
+		bool Load(const sha512::raw_digest& key, std::vector<NodeLayer>& nodeLayers);
+		bool Save(const sha512::raw_digest& key, const std::vector<NodeLayer>& nodeLayers);
+	}
+}
+
+#endif
@@ -15,6 +15,7 @@
 
 #include "PathDefines.h"
 #include "PathManager.h"
+#include "NodeLayerCache.h"
 
 #include "Utils/PathSpeedModInfoSystemUtils.h"
 
@@ -56,7 +57,11 @@
 #define NUL_RECTANGLE SRectangle(0, 0,             0,            0)
 #define MAP_RECTANGLE SRectangle(0, 0,  mapDims.mapx, mapDims.mapy)
 
+// search budget at reduced sim quality for games that do not set qtMaxSearchesPerFrame
+static constexpr int DEGRADED_MAX_SEARCHES_PER_FRAME = 64;
+
 CONFIG(int, PathingThreadCount).defaultValue(0).safemodeValue(1).minimumValue(0);
+CONFIG(bool, QTPFSNodeLayerCache).defaultValue(false).safemodeValue(false).description("Store the initial QTPFS node-layers in the cache directory and reuse them when the map, game and terrain are unchanged.");
 
 namespace QTPFS {
 	struct PMLoadScreen {
@@ -225,6 +230,14 @@ QTPFS::PathManager::~PathManager() {
 	searchThreadData.clear();
 	updateThreadData.clear();
 
+	LOG("[QTPFS] expanded nodes per path: %.1f over %u searches, %.1f over %u abstract-graph searches"
+		, numNodesSearched[0] / std::max(1.0, double(numSearchesExecuted[0])), unsigned(numSearchesExecuted[0])
+		, numNodesSearched[1] / std::max(1.0, double(numSearchesExecuted[1])), unsigned(numSearchesExecuted[1]));
+	LOG("[QTPFS] terrain changes: %u raw rects merged into %u"
+		, unsigned(numRawTerrainChanges), unsigned(numMergedTerrainChanges));
+	LOG("[QTPFS] shared paths: %u from earlier frames, %u coalesced within a frame"
+		, unsigned(numSharedPathHits[0]), unsigned(numSharedPathHits[1]));
+
 	systemGlobals.ClearComponents();
 
 	// make this is destroyed last to ensure entity 0 will be first picked up next time.
@@ -254,7 +267,9 @@ std::int64_t QTPFS::PathManager::Finalize() {
 std::int64_t QTPFS::PathManager::PostFinalizeRefresh() {
 	RECOIL_DETAILED_TRACY_ZONE;
 	const spring_time t0 = spring_gettime();
-	
+
+	ProcessTerrainChanges();
+
 	bool updateNeeded = nodeLayersMapDamageTrack.mapChangeTrackers.end() !=
 		std::ranges::find_if(nodeLayersMapDamageTrack.mapChangeTrackers,
 			[](const QTPFS::PathManager::MapChangeTrack &ct) -> bool { return ct.damageQueue.size() > 0; });
@@ -380,7 +395,8 @@ void QTPFS::PathManager::Load() {
 		sha512::dump_digest(mapCheckSum, mapCheckSumHex);
 		sha512::dump_digest(modCheckSum, modCheckSumHex);
 
-		InitNodeLayersThreaded(MAP_RECTANGLE);
+		InitNodeLayers();
+		InitAbstractGraphs();
 		PathSpeedModInfoSystem::Init();
 		RemoveDeadPathsSystem::Init();
 		RequeuePathsSystem::Init();
@@ -472,6 +488,43 @@ std::uint64_t QTPFS::PathManager::GetMemFootPrint() const {
 
 
 
+void QTPFS::PathManager::InitNodeLayers() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (!configHandler->GetBool("QTPFSNodeLayerCache")) {
+		InitNodeLayersThreaded(MAP_RECTANGLE);
+		return;
+	}
+
+	const sha512::raw_digest cacheKey = NodeLayerCache::CalcKey(rootSize);
+
+	if (NodeLayerCache::Load(cacheKey, nodeLayers)) {
+		// what UpdateNodeLayer would have done for every tesselated layer
+		for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
+			pathCache.SetLayerPathCount(layerNum, INITIAL_PATH_RESERVE);
+		}
+		pmLoadScreen.AddMessage("[PathManager] loaded node-layers from cache");
+		return;
+	}
+
+	InitNodeLayersThreaded(MAP_RECTANGLE);
+
+	if (!NodeLayerCache::Save(cacheKey, nodeLayers))
+		LOG_L(L_WARNING, "[PathManager::%s] failed to write node-layer cache", __func__);
+}
+
+void QTPFS::PathManager::InitAbstractGraphs() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (modInfo.qtAbstractGraphMinDist <= 0.0f)
+		return;
+
+	// after tesselation (or loading from the cache), UpdateNodeLayer keeps them current
+	for_mt(0, nodeLayers.size(), [this](const int layerNum){
+		nodeLayers[layerNum].GetAbstractGraph().Build(nodeLayers[layerNum]);
+	});
+
+	pmLoadScreen.AddMessage("[PathManager] built abstract graphs");
+}
+
 void QTPFS::PathManager::InitNodeLayersThreaded(const SRectangle& rect) {
 	RECOIL_DETAILED_TRACY_ZONE;
 	streflop::streflop_init<streflop::Simple>();
@@ -696,6 +749,9 @@ void QTPFS::PathManager::UpdateNodeLayer(unsigned int layerNum, const SRectangle
 		#ifndef QTPFS_CONSERVATIVE_NEIGHBOR_CACHE_UPDATES
 		nodeLayers[layerNum].ExecNodeNeighborCacheUpdates(ur, updateThreadData[currentThread]);
 		#endif
+
+		// needs the new neighbour links
+		nodeLayer.GetAbstractGraph().UpdateArea(nodeLayer, re);
 	}
 }
 
@@ -706,7 +762,28 @@ void QTPFS::PathManager::TerrainChange(unsigned int x1, unsigned int z1,  unsign
 	if (!IsFinalized())
 		return;
 
-	MapChanged(x1, z1, x2, z2);
+	// batched until the next Update, base building and artillery fire produce many small
+	// overlapping rects per frame which would otherwise each walk the damage map of every
+	// layer; the given coordinates are inclusive
+	terrainChangeRects.push_back(SRectangle(x1, z1, x2 + 1, z2 + 1));
+	numRawTerrainChanges++;
+}
+
+void QTPFS::PathManager::ProcessTerrainChanges() {
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (terrainChangeRects.empty())
+		return;
+
+	// merged rects cover exactly the same squares, so the damage maps end up the same;
+	// splitting large rects would only add more of them
+	terrainChangeRects.Process(true);
+
+	for (const SRectangle& r: terrainChangeRects) {
+		MapChanged(r.x1, r.z1, r.x2 - 1, r.z2 - 1);
+	}
+
+	numMergedTerrainChanges += terrainChangeRects.size();
+	terrainChangeRects.clear();
 }
 
 void QTPFS::PathManager::MapChanged(int x1, int y1, int x2, int y2) {
@@ -751,6 +828,7 @@ void QTPFS::PathManager::Update() {
 	{
 		SCOPED_TIMER("Sim::Path::MapUpdates");
 
+		ProcessTerrainChanges();
 		RequestMaxSpeedModRefreshForLayer(0);
 
 		auto numBlocksToUpdate = [this](int layerNum) {
@@ -853,7 +931,7 @@ void QTPFS::PathManager::ThreadUpdate() {
 
 
 bool QTPFS::PathManager::InitializeSearch(QTPFS::entity searchEntity) {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 	PathSearch* search = GetSearch(searchEntity);
 
 	if (search->initialized)
@@ -913,6 +991,17 @@ bool QTPFS::PathManager::InitializeSearch(QTPFS::entity searchEntity) {
 
 void QTPFS::PathManager::ReadyQueuedSearches() {
 	RECOIL_DETAILED_TRACY_ZONE;
+	int maxSearches = modInfo.qtMaxSearchesPerFrame;
+
+	// an overloaded server caps the budget even if the game leaves it unlimited,
+	// and halves it for every level past the first
+	if (gs->simQualityLevel > 0)
+		maxSearches = std::max(1, ((maxSearches > 0)? maxSearches: DEGRADED_MAX_SEARCHES_PER_FRAME) >> (gs->simQualityLevel - 1));
+
+	if (maxSearches > 0 && registry.view<PathSearch>().size() > static_cast<size_t>(maxSearches)) {
+		ReadyOldestQueuedSearches(maxSearches);
+		return;
+	}
 	{
 		// Only synced searches get queued for batch processing.
 		auto pathView = registry.view<PathSearch>();
@@ -935,10 +1024,142 @@ void QTPFS::PathManager::ReadyQueuedSearches() {
 	}
 }
 
+void QTPFS::PathManager::ReadyOldestQueuedSearches(int maxSearches) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto pathView = registry.view<PathSearch>();
+
+	// Only synced state decides which searches run this frame, so every client picks the same
+	// ones. Ties keep storage order, which is the same everywhere too.
+	queuedSearchOrder.assign(pathView.begin(), pathView.end());
+	std::stable_sort(queuedSearchOrder.begin(), queuedSearchOrder.end(), [this](QTPFS::entity a, QTPFS::entity b){
+		return (registry.get<PathSearch>(a).queuedFrame < registry.get<PathSearch>(b).queuedFrame);
+	});
+
+	// The group is empty here, so searches enter it, and are later committed, in request order.
+	// The rest are not even initialized yet, so they do not take part in path sharing until
+	// their turn comes.
+	int numReady = 0;
+	for (QTPFS::entity entity : queuedSearchOrder) {
+		if (numReady >= maxSearches)
+			break;
+
+		if (InitializeSearch(entity)) {
+			registry.emplace_or_replace<ProcessPath>(entity);
+			numReady++;
+		} else
+			registry.destroy(entity);
+	}
+	queuedSearchOrder.clear();
+}
+
+void QTPFS::PathManager::ExecuteFlowFieldSearches() {
+	RECOIL_TRACY_ZONE(PATH);
+	const int minGroupSize = modInfo.qtFlowFieldMinGroupSize;
+
+	if (minGroupSize <= 0)
+		return;
+
+	auto pathView = registry.group<PathSearch, ProcessPath>();
+
+	if (pathView.size() < static_cast<size_t>(minGroupSize))
+		return;
+
+	// reuse the group slots (and their field allocations) across frames
+	for (size_t i = 0; i < numFlowFieldGroups; i++) {
+		flowFieldGroups[i].searches.clear();
+	}
+	flowFieldGroupIndices.clear();
+	numFlowFieldGroups = 0;
+
+	// Group the plain full-path searches of owned synced paths by layer, goal node and goal
+	// radius. This walks the group in storage order and only reads synced state, so every
+	// client forms the same groups. Raw checks and repairs run as before.
+	for (const QTPFS::entity searchEntity: pathView) {
+		const PathSearch& search = pathView.get<PathSearch>(searchEntity);
+
+		if (!search.synced || search.rawPathCheck || search.tryPathRepair || search.doPathRepair)
+			continue;
+
+		const IPath* path = registry.try_get<IPath>(QTPFS::entity(search.GetID()));
+
+		if (path == nullptr || path->GetOwner() == nullptr)
+			continue;
+
+		const float3 goalPoint = path->GetGoalPosition().cClampInBounds();
+		const INode* goalNode = nodeLayers[search.GetPathType()].GetNode(goalPoint.x / SQUARE_SIZE, goalPoint.z / SQUARE_SIZE);
+
+		const float radius = path->GetRadius();
+		const std::uint64_t groupKey =
+			(std::uint64_t(search.GetPathType()) << 52) |
+			(std::uint64_t(goalNode->GetIndex()) << 32) |
+			std::uint64_t(*reinterpret_cast<const std::uint32_t*>(&radius));
+
+		const auto [iter, isNew] = flowFieldGroupIndices.try_emplace(groupKey, numFlowFieldGroups);
+
+		if (isNew) {
+			if (numFlowFieldGroups == flowFieldGroups.size())
+				flowFieldGroups.emplace_back();
+
+			FlowFieldGroup& group = flowFieldGroups[numFlowFieldGroups++];
+			group.goalPoint = goalPoint;
+			group.pathType = search.GetPathType();
+			group.goalNodeIndex = goalNode->GetIndex();
+		}
+
+		flowFieldGroups[iter->second].searches.push_back(searchEntity);
+	}
+
+	flowFieldSearches.clear();
+
+	for (size_t i = 0; i < numFlowFieldGroups; i++) {
+		FlowFieldGroup& group = flowFieldGroups[i];
+
+		if (group.searches.size() < static_cast<size_t>(minGroupSize)) {
+			group.searches.clear();
+			continue;
+		}
+
+		for (const QTPFS::entity searchEntity: group.searches) {
+			flowFieldSearches.emplace_back(searchEntity, i);
+		}
+	}
+
+	if (flowFieldSearches.empty())
+		return;
+
+	for_mt(0, numFlowFieldGroups, [this](int i){
+		FlowFieldGroup& group = flowFieldGroups[i];
+
+		if (group.searches.empty())
+			return;
+
+		if (!group.flowField.Build(nodeLayers[group.pathType], group.goalNodeIndex, group.goalPoint))
+			group.searches.clear();
+	});
+
+	// members of a field that could not be built, or that cannot reach the goal through
+	// it, are left to the regular search below
+	for_mt(0, flowFieldSearches.size(), [this](int i){
+		const auto [searchEntity, groupIndex] = flowFieldSearches[i];
+		const FlowFieldGroup& group = flowFieldGroups[groupIndex];
+
+		if (group.searches.empty())
+			return;
+
+		PathSearch& search = registry.get<PathSearch>(searchEntity);
+		IPath* path = &registry.get<IPath>(QTPFS::entity(search.GetID()));
+
+		BasicTimer searchTimer(0);
+		search.flowFieldPath = search.FlowFieldFinalize(group.flowField, path);
+		path->SetSearchTime(searchTimer.GetDuration());
+	});
+}
+
 void QTPFS::PathManager::ExecuteQueuedSearches() {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 
 	ReadyQueuedSearches();
+	ExecuteFlowFieldSearches();
 
 	// Only synced searches get queued for batch processing.
 	auto pathView = registry.group<PathSearch, ProcessPath>();
@@ -953,6 +1174,9 @@ void QTPFS::PathManager::ExecuteQueuedSearches() {
 		assert(registry.all_of<PathSearch>(pathSearchEntity));
 
 		PathSearch* search = &pathView.get<PathSearch>(pathSearchEntity);
+		if (search->flowFieldPath)
+			return;
+
 		int pathType = search->GetPathType();
 		NodeLayer& nodeLayer = nodeLayers[pathType];
 		ExecuteSearch(search, nodeLayer, pathType);
@@ -983,6 +1207,14 @@ void QTPFS::PathManager::ExecuteQueuedSearches() {
 
 		PathSearch* search = &pathView.get<PathSearch>(pathSearchEntity);
 		QTPFS::entity pathEntity = (QTPFS::entity)search->GetID();
+
+		if (search->GetNumNodesSearched() > 0) {
+			numNodesSearched[search->useAbstractCorridor] += search->GetNumNodesSearched();
+			numSearchesExecuted[search->useAbstractCorridor]++;
+		}
+
+		numSharedPathHits[0] += search->pathWasShared;
+
 		if (registry.valid(pathEntity)) {
 			// Only owned paths should be actioned in this function.
 			IPath* path = registry.try_get<IPath>(pathEntity);
@@ -1000,11 +1232,9 @@ void QTPFS::PathManager::ExecuteQueuedSearches() {
 						RequeueSearch(path, false, true, search->tryPathRepair);
 						// LOG("%s: %x - raw path check failed", __func__, entt::to_integral(pathEntity));
 					} else if (search->pathRequestWaiting) {
-						// nothing to do - it will be rerun next frame
-						// LOG("%s: %x - waiting for partial root path", __func__, entt::to_integral(pathEntity));
-						// continue;
-						registry.remove<PathSearchRef>(pathEntity);
-						RequeueSearch(path, false, search->allowPartialSearch, false);
+						// resolved below, once every other result of this frame is in
+						waitingSearches.push_back(pathSearchEntity);
+						continue;
 					} else if (search->rejectPartialSearch) {
 						registry.remove<PathSearchRef>(pathEntity);
 						RequeueSearch(path, false, false, false);
@@ -1025,6 +1255,50 @@ void QTPFS::PathManager::ExecuteQueuedSearches() {
 		if (registry.valid(pathSearchEntity))
 			registry.destroy(pathSearchEntity);
 	}
+
+	// A search waits when its sharing-chain head (same move type, source area and target node)
+	// was still unfinished as it ran, which is always the case for requests issued in the same
+	// frame. If the head is done by now, fan its result out right away instead of re-running the
+	// follower next frame; otherwise it is requeued as before.
+	for (auto pathSearchEntity : waitingSearches) {
+		PathSearch* search = &registry.get<PathSearch>(pathSearchEntity);
+		QTPFS::entity pathEntity = (QTPFS::entity)search->GetID();
+		IPath* path = registry.valid(pathEntity)? registry.try_get<IPath>(pathEntity): nullptr;
+
+		if (path != nullptr) {
+			SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
+			QTPFS::entity chainHeadEntity = entt::null;
+
+			if (sharedPathsIt != sharedPaths.end())
+				chainHeadEntity = sharedPathsIt->second;
+
+			const bool headIsCopyable =
+				(chainHeadEntity != pathEntity) &&
+				registry.valid(chainHeadEntity) &&
+				registry.all_of<IPath>(chainHeadEntity) &&
+				!registry.all_of<PathSearchRef>(chainHeadEntity);
+
+			if (headIsCopyable) {
+				search->SharedFinalize(&registry.get<IPath>(chainHeadEntity), path);
+				search->pathRequestWaiting = false;
+				numSharedPathHits[1]++;
+
+				// same as a failed search above
+				if (!search->PathWasFound())
+					path->SetBoundingBox();
+
+				completePath(pathEntity, path);
+			} else {
+				registry.remove<PathSearchRef>(pathEntity);
+				RequeueSearch(path, false, search->allowPartialSearch, false);
+			}
+		}
+
+		if (registry.valid(pathSearchEntity))
+			registry.destroy(pathSearchEntity);
+	}
+
+	waitingSearches.clear();
 }
 
 // #pragma GCC push_options
@@ -1035,7 +1309,7 @@ bool QTPFS::PathManager::ExecuteSearch(
 	NodeLayer& nodeLayer,
 	unsigned int pathType
 ) {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 
 	BasicTimer searchTimer(0);
 
@@ -1122,6 +1396,7 @@ bool QTPFS::PathManager::ExecuteSearch(
 						auto& headChainPath = registry.get<IPath>(chainHeadEntity);
 						search->SharedFinalize(&headChainPath, path);
 						search->pathRequestWaiting = false;
+						search->pathWasShared = true;
 
 						// if (search->Getowner() != nullptr && 2102 == search->Getowner()->id)
 						// 	LOG("%s: full shared (%d)", __func__, search->GetID());
@@ -1186,7 +1461,7 @@ bool QTPFS::PathManager::ExecuteSearch(
 }
 
 void QTPFS::PathManager::QueueDeadPathSearches() {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 
 	// Only owned can be marked as dead.
 	auto pathUpdatesView = registry.view<IPath, PathIsToBeUpdated>();
@@ -1320,6 +1595,7 @@ unsigned int QTPFS::PathManager::QueueSearch(
 	newSearch->allowPartialSearch = !allowRawSearch;
 	newSearch->initialized = false;
 	newSearch->synced = synced;
+	newSearch->queuedFrame = gs->frameNum;
 
 	// LOG("%s: %s (%x) %d -> %d ", __func__
 	// 		, unit != nullptr ? unit->unitDef->name.c_str() : "non-unit"
@@ -1387,6 +1663,7 @@ unsigned int QTPFS::PathManager::RequeueSearch(
 	newSearch->initialized = false;
 	newSearch->allowPartialSearch = allowPartialSearch;
 	newSearch->synced = oldPath->IsSynced();
+	newSearch->queuedFrame = gs->frameNum;
 
 	assert(newSearch->synced == true);
 
@@ -1590,6 +1867,14 @@ void QTPFS::PathManager::ClearPathUpdated(unsigned int pathID) {
 	livePath->SetNumPathUpdates(0);
 }
 
+bool QTPFS::PathManager::PathSearchPending(unsigned int pathID) const {
+	RECOIL_DETAILED_TRACY_ZONE;
+	QTPFS::entity pathEntity = (QTPFS::entity)pathID;
+	if (!registry.valid(pathEntity)) { return false; }
+
+	return (registry.all_of<PathIsTemp>(pathEntity));
+}
+
 
 float3 QTPFS::PathManager::NextWayPoint(
 	const CSolidObject* owner,
@@ -1599,7 +1884,7 @@ float3 QTPFS::PathManager::NextWayPoint(
 	float, // radius,
 	bool synced
 ) {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 	const float3 noPathPoint = -XZVector;
 
 	if (!IsFinalized())
@@ -7,9 +7,11 @@
 
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Path/IPathManager.h"
+#include "FlowField.h"
 #include "NodeLayer.h"
 #include "PathCache.h"
 #include "PathSearch.h"
+#include "System/Misc/RectangleOverlapHandler.h"
 #include "System/UnorderedMap.hpp"
 
 struct MoveDef;
@@ -49,6 +51,9 @@ namespace QTPFS {
 		bool PathUpdated(unsigned int pathID) override;
 		void ClearPathUpdated(unsigned int pathID) override;
 
+		bool AllowDeferredRequests() const override { return true; }
+		bool PathSearchPending(unsigned int pathID) const override;
+
 		bool AllowShortestPath() override { return true; }
 
 		void TerrainChange(unsigned int x1, unsigned int z1,  unsigned int x2, unsigned int z2, unsigned int type) override;
@@ -95,6 +100,7 @@ namespace QTPFS {
 
 	private:
 		void MapChanged(int x1, int z1, int x2, int z2);
+		void ProcessTerrainChanges();
 
 		void ThreadUpdate();
 		void Load();
@@ -110,14 +116,16 @@ namespace QTPFS {
 		typedef spring::unordered_map<unsigned int, unsigned int>::iterator PathTypeMapIt;
 		typedef spring::unordered_map<unsigned int, PathSearchTrace::Execution*> PathTraceMap;
 		typedef spring::unordered_map<unsigned int, PathSearchTrace::Execution*>::iterator PathTraceMapIt;
-		typedef spring::unordered_map<PathHashType, QTPFS::entity> SharedPathMap;
-		typedef spring::unordered_map<PathHashType, QTPFS::entity>::iterator SharedPathMapIt;
-		typedef spring::unordered_map<PathHashType, QTPFS::entity> PartialSharedPathMap;
-		typedef spring::unordered_map<PathHashType, QTPFS::entity>::iterator PartialSharedPathMapIt;
+		typedef spring::flat_hash_map<PathHashType, QTPFS::entity> SharedPathMap;
+		typedef spring::flat_hash_map<PathHashType, QTPFS::entity>::iterator SharedPathMapIt;
+		typedef spring::flat_hash_map<PathHashType, QTPFS::entity> PartialSharedPathMap;
+		typedef spring::flat_hash_map<PathHashType, QTPFS::entity>::iterator PartialSharedPathMapIt;
 
 		typedef std::vector<PathSearch*> PathSearchVect;
 		typedef std::vector<PathSearch*>::iterator PathSearchVectIt;
 
+		void InitNodeLayers();
+		void InitAbstractGraphs();
 		void InitNodeLayersThreaded(const SRectangle& rect);
 		void InitNodeLayer(unsigned int layerNum, const SRectangle& r);
 		void InitRootSize(const SRectangle& r);
@@ -129,6 +137,8 @@ namespace QTPFS {
 		void RemovePathSearch(QTPFS::entity pathEntity);
 
 		void ReadyQueuedSearches();
+		void ReadyOldestQueuedSearches(int maxSearches);
+		void ExecuteFlowFieldSearches();
 		void ExecuteQueuedSearches();
 		void QueueDeadPathSearches();
 
@@ -171,6 +181,24 @@ namespace QTPFS {
 		std::vector<SearchThreadData> searchThreadData;
 		std::vector<UpdateThreadData> updateThreadData;
 		std::vector<unsigned char> nodeLayerUpdatePriorityOrder;
+		std::vector<QTPFS::entity> queuedSearchOrder;
+
+		struct FlowFieldGroup {
+			FlowField flowField;
+			std::vector<QTPFS::entity> searches;
+			float3 goalPoint;
+			unsigned int pathType = 0;
+			unsigned int goalNodeIndex = 0;
+		};
+
+		// rebuilt every frame, the field only lives as long as the searches that share it
+		std::vector<FlowFieldGroup> flowFieldGroups;
+		std::vector<std::pair<QTPFS::entity, size_t>> flowFieldSearches;
+		spring::flat_hash_map<std::uint64_t, size_t> flowFieldGroupIndices;
+		size_t numFlowFieldGroups = 0;
+
+		// searches of this frame that waited on a path-sharing chain head, resolved last
+		std::vector<QTPFS::entity> waitingSearches;
 
 		PathTraceMap pathTraces;
 		SharedPathMap sharedPaths;
@@ -181,6 +209,18 @@ namespace QTPFS {
 
 		NodeLayersChangeTrack nodeLayersMapDamageTrack;
 
+		// TerrainChange rects of the current frame, merged before they reach the damage maps
+		CRectangleOverlapHandler terrainChangeRects;
+		std::uint64_t numRawTerrainChanges = 0;
+		std::uint64_t numMergedTerrainChanges = 0;
+
+		// expanded nodes and executed searches, [1] for those limited by the abstract graph
+		std::uint64_t numNodesSearched[2] = {0, 0};
+		std::uint64_t numSearchesExecuted[2] = {0, 0};
+
+		// searches answered by copying a shared path, [1] for heads that completed in the same frame
+		std::uint64_t numSharedPathHits[2] = {0, 0};
+
 		int deadPathsToUpdatePerFrame = 1;
 		int recalcDeadPathUpdateRateOnFrame = 0;
 		int rootSize = 0;
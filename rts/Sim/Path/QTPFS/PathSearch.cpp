@@ -8,6 +8,7 @@
 #include "PathSearch.h"
 #include "Path.h"
 #include "PathCache.h"
+#include "FlowField.h"
 #include "Map/MapInfo.h"
 #include "NodeLayer.h"
 #include "Sim/Misc/CollisionHandler.h"
@@ -147,7 +148,7 @@ void QTPFS::PathSearch::Initialize(
 // #pragma GCC optimize ("O0")
 
 void QTPFS::PathSearch::InitializeThread(SearchThreadData* threadData) {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 	searchThreadData = threadData;
 
 	badGoal = false;
@@ -269,8 +270,7 @@ void QTPFS::PathSearch::InitializeThread(SearchThreadData* threadData) {
 		data.openNodes = &searchThreadData->openNodes[i];
 		data.minSearchNode = data.srcSearchNode;
 
-		while (!data.openNodes->empty())
-			data.openNodes->pop();
+		data.openNodes->clear();
 	}
 
 	// Set search boundaries for path repairs. If a repair cannot be made within the boundaries then the path is better
@@ -311,6 +311,21 @@ void QTPFS::PathSearch::InitializeThread(SearchThreadData* threadData) {
 	// 		);
 	// }
 
+	// long searches first find their route on the abstract graph and then only refine it within
+	// the clusters along the way; partial and repair searches are already limited in other ways
+	useAbstractCorridor = false;
+
+	if (!rawPathCheck && !doPathRepair && !doPartialSearch && modInfo.qtAbstractGraphMinDist > 0.0f) {
+		if (fwd.srcPoint.SqDistance2D(fwd.tgtPoint) >= Square(modInfo.qtAbstractGraphMinDist)) {
+			useAbstractCorridor = nodeLayer->GetAbstractGraph().FindCorridor(
+				srcNode,
+				tgtNode,
+				searchThreadData->abstractSearchData,
+				searchThreadData->abstractCorridor
+			);
+		}
+	}
+
 	curSearchNode = nullptr;
 	nextSearchNode = nullptr;
 }
@@ -358,7 +373,7 @@ void QTPFS::PathSearch::PreLoadNode(uint32_t dir, uint32_t nodeId, uint32_t prev
 }
 
 void QTPFS::PathSearch::LoadPartialPath(IPath* path) {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 	auto& nodes = path->GetNodeList();
 
 	assert(path->GetPathType() == pathType);
@@ -520,7 +535,7 @@ void QTPFS::PathSearch::LoadRepairPath() {
 // #pragma GCC pop_options
 
 bool QTPFS::PathSearch::Execute(unsigned int searchStateOffset) {
-	RECOIL_DETAILED_TRACY_ZONE;
+	RECOIL_TRACY_ZONE(PATH);
 	auto& fwd = directionalSearchData[SearchThreadData::SEARCH_FORWARD];
 	auto& bwd = directionalSearchData[SearchThreadData::SEARCH_BACKWARD];
 
@@ -688,7 +703,7 @@ void QTPFS::PathSearch::SetForwardSearchLimit() {
 // #pragma GCC optimize ("O0")
 
 bool QTPFS::PathSearch::ExecutePathSearch() {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 
 	#ifdef QTPFS_TRACE_PATH_SEARCHES
 	searchExec = new PathSearchTrace::Execution(gs->frameNum);
@@ -1206,7 +1221,7 @@ bool QTPFS::PathSearch::ExecutePathSearch() {
 // #pragma GCC pop_options
 
 bool QTPFS::PathSearch::ExecuteRawSearch() {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 	assert(pathOwner != nullptr);
 	auto& fwd = directionalSearchData[SearchThreadData::SEARCH_FORWARD];
 
@@ -1314,7 +1329,7 @@ void QTPFS::PathSearch::UpdateNode(SearchNode* nextNode, SearchNode* prevNode, u
 }
 
 void QTPFS::PathSearch::IterateNodes(unsigned int searchDir) {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 	DirectionalSearchData& searchData = directionalSearchData[searchDir];
 
 	SearchQueueNode curOpenNode = (*searchData.openNodes).top();
@@ -1433,6 +1448,14 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const INode* curNode, unsigned int
 		//   nightmare), while in the second we would get low-quality paths (player
 		//   nightmare)
 		int nxtNodesId = nxtNodes[i].nodeId;
+
+		if (useAbstractCorridor) {
+			const AbstractGraph& abstractGraph = nodeLayer->GetAbstractGraph();
+			const unsigned int clusterIndex = abstractGraph.GetClusterIndex(nodeLayer->GetPoolNode(nxtNodesId));
+
+			if (!searchThreadData->abstractCorridor[clusterIndex])
+				continue;
+		}
 		
 		// LOG("%s: target node search from %d to %d", __func__
 		// 		, curNode->GetIndex()
@@ -1553,7 +1576,7 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const INode* curNode, unsigned int
 }
 
 void QTPFS::PathSearch::Finalize(IPath* path) {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(PATH);
 
 	// LOG("%s: [%p : %d] Finalize search.", __func__
 	// 		, &nodeLayer[path->GetPathType()]
@@ -2569,6 +2592,71 @@ bool QTPFS::PathSearch::SharedFinalize(const IPath* srcPath, IPath* dstPath) {
 	return true;
 }
 
+bool QTPFS::PathSearch::FlowFieldFinalize(const FlowField& flowField, IPath* path) {
+	RECOIL_DETAILED_TRACY_ZONE;
+	auto& fwd = directionalSearchData[SearchThreadData::SEARCH_FORWARD];
+
+	std::vector<unsigned int> nodes;
+	std::vector<float2> points;
+
+	if (!flowField.Trace(*nodeLayer, fwd.srcPoint, nodes, points))
+		return false;
+
+	// same layout TracePath produces for a full path: the source node has no waypoint of
+	// its own, every following node is entered through the waypoint stored with it
+	if (nodes.size() > 1) {
+		float3 boundaryMins(std::numeric_limits<float>::infinity(), 0.f, std::numeric_limits<float>::infinity());
+		float3 boundaryMaxs(-1.f, 0.f, -1.f);
+
+		path->AllocPoints(nodes.size() + 1);
+		path->AllocNodes(nodes.size());
+
+		for (unsigned int i = 0; i < nodes.size(); i++) {
+			const INode* node = nodeLayer->GetPoolNode(nodes[i]);
+			const float2 netPoint = (i > 0)? points[i - 1]: float2();
+
+			if (i > 0)
+				path->SetPoint(i, {netPoint.x, 0.0f, netPoint.y});
+
+			path->SetNode(i, nodes[i], node->GetNodeNumber(), float2(netPoint), (i > 0)? int(i): -1, false);
+			path->SetNodeBoundary(i, node->xmin(), node->zmin(), node->xmax(), node->zmax());
+
+			boundaryMins.x = std::min(boundaryMins.x, float(node->xmin() * SQUARE_SIZE));
+			boundaryMins.z = std::min(boundaryMins.z, float(node->zmin() * SQUARE_SIZE));
+			boundaryMaxs.x = std::max(boundaryMaxs.x, float(node->xmax() * SQUARE_SIZE));
+			boundaryMaxs.z = std::max(boundaryMaxs.z, float(node->zmax() * SQUARE_SIZE));
+		}
+
+		path->SetBoundingBox(boundaryMins, boundaryMaxs);
+	} else {
+		path->AllocPoints(2);
+		path->AllocNodes(0);
+	}
+
+	path->SetSourcePoint(fwd.srcPoint);
+	path->SetTargetPoint(fwd.tgtPoint);
+	path->SetGoalPosition(goalPos);
+	path->SetRepathTriggerIndex(0);
+	path->SetIsRawPath(false);
+
+	#ifdef QTPFS_SMOOTH_PATHS
+	SmoothPath(path);
+	#endif
+
+	path->SetNextPointIndex(0);
+	path->SetFirstNodeIdOfCleanPath(0);
+
+	if (!path->IsBoundingBoxOverriden())
+		path->SetBoundingBox();
+
+	haveFullPath = true;
+	havePartPath = false;
+
+	path->SetHasFullPath(haveFullPath);
+	path->SetHasPartialPath(havePartPath);
+	return true;
+}
+
 // TODO: use node.h version?
 unsigned int GetChildId(uint32_t nodeNumber, uint32_t i, uint32_t depth) {
 	uint32_t shift = (QTPFS::QTNode::MAX_DEPTH - (depth + 1)) * QTPFS_NODE_NUMBER_SHIFT_STEP;
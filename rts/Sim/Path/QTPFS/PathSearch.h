@@ -15,6 +15,7 @@ struct CollisionVolume;
 
 namespace QTPFS {
 	struct IPath;
+	struct FlowField;
 	struct NodeLayer;
 	struct PathCache;
 	struct SearchNode;
@@ -118,6 +119,7 @@ namespace QTPFS {
 		bool Execute(unsigned int searchStateOffset = 0);
 		void Finalize(IPath* path);
 		bool SharedFinalize(const IPath* srcPath, IPath* dstPath);
+		bool FlowFieldFinalize(const FlowField& flowField, IPath* path);
 		PathSearchTrace::Execution* GetExecutionTrace() { return searchExec; }
 
 		const PathHashType GetHash() const { return pathSearchHash; };
@@ -125,6 +127,8 @@ namespace QTPFS {
 
 		bool PathWasFound() const { return haveFullPath | havePartPath; }
 
+		size_t GetNumNodesSearched() const { return (fwdNodesSearched + bwdNodesSearched); }
+
 		void SetPathType(int newPathType) { pathType = newPathType; }
 		int GetPathType() const { return pathType; }
 
@@ -261,6 +265,18 @@ public:
 		bool partialReverseTrace = false;
 		bool doPathRepair = false;
 
+		// sim frame of the request; the oldest go first when over qtMaxSearchesPerFrame
+		int queuedFrame = 0;
+
+		// path was taken from a group flow-field, no need to Execute
+		bool flowFieldPath = false;
+
+		// search was limited to the clusters the abstract graph routed it through
+		bool useAbstractCorridor = false;
+
+		// result was copied from the head of the search's path-sharing chain
+		bool pathWasShared = false;
+
 		bool fwdPathConnected = false;
 		bool bwdPathConnected = false;
 		bool useFwdPathOnly = false;
@@ -6,7 +6,9 @@
 #include <queue>
 #include <vector>
 
+#include "AbstractGraph.h"
 #include "Node.h"
+#include "NodeHeap.h"
 
 #include "Map/ReadMap.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -110,7 +112,15 @@ namespace QTPFS {
 
     // Reminder that std::priority does comparisons to push element back to the bottom. So using
     // ShouldMoveTowardsBottomOfPriorityQueue here means the smallest value will be top()
-    typedef std::priority_queue<SearchQueueNode, std::vector<SearchQueueNode>, ShouldMoveTowardsBottomOfPriorityQueue> SearchPriorityQueue;
+    // (dary_heap follows the same convention; run benchmarkQTPFSNodeHeap before switching)
+#ifdef QTPFS_DARY_OPEN_NODE_HEAP
+    typedef dary_heap<SearchQueueNode, ShouldMoveTowardsBottomOfPriorityQueue, QTPFS_DARY_OPEN_NODE_HEAP> SearchPriorityQueue;
+#else
+    struct SearchPriorityQueue: public std::priority_queue<SearchQueueNode, std::vector<SearchQueueNode>, ShouldMoveTowardsBottomOfPriorityQueue> {
+        // drop everything but keep the allocation, instead of popping entries one at a time
+        void clear() { c.clear(); }
+    };
+#endif
 
 	struct SearchThreadData {
 
@@ -121,6 +131,11 @@ namespace QTPFS {
 		SparseData<SearchNode> allSearchedNodes[SEARCH_DIRECTIONS];
         SearchPriorityQueue openNodes[SEARCH_DIRECTIONS];
         std::vector<INode*> tmpNodesStore;
+
+        // clusters a long search is limited to, see AbstractGraph::FindCorridor
+        AbstractGraph::SearchData abstractSearchData;
+        std::vector<std::uint8_t> abstractCorridor;
+
         int threadId = 0;
 
 		SearchThreadData(size_t nodeCount, int curThreadId)
@@ -130,7 +145,7 @@ namespace QTPFS {
 
         void ResetQueue() { ZoneScoped; for (int i=0; i<SEARCH_DIRECTIONS; ++i) ResetQueue(i); }
 
-        void ResetQueue(int i) { ZoneScoped; while (!openNodes[i].empty()) openNodes[i].pop(); }
+        void ResetQueue(int i) { ZoneScoped; openNodes[i].clear(); }
 
 		void Init(size_t sparseSize, size_t denseSize) {
             constexpr size_t tmpNodeStoreInitialReserve = 128;
@@ -151,6 +166,7 @@ namespace QTPFS {
                 memFootPrint += openNodes[i].size() * sizeof(std::remove_reference_t<decltype(openNodes[0])>::value_type);
             }
             memFootPrint += tmpNodesStore.size() * sizeof(decltype(tmpNodesStore)::value_type);
+            memFootPrint += abstractCorridor.size() * sizeof(decltype(abstractCorridor)::value_type);
 
             return memFootPrint;
         }
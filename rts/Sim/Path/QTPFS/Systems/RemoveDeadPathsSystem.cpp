@@ -41,7 +41,7 @@ void RemoveDeadPathsSystem::Update()
     SCOPED_TIMER("ECS::RemoveDeadPathsSystem::Update");
 
     auto& comp = systemGlobals.GetSystemComponent<RemoveDeadPathsComponent>();
-    if (gs->frameNum % comp.refreshRate != comp.refreshOffset) return;
+    if (gs->frameNum % (comp.refreshRate * gs->SimQualityPeriod()) != comp.refreshOffset) return;
 
     auto* pm = dynamic_cast<PathManager*>(pathManager);
 
@@ -26,6 +26,8 @@ public:
 
 	~CExpGenSpawnable() override;
 	virtual void Init(const CUnit* owner, const float3& offset);
+	// tried by the CEG before Init(), true if the effect went to ParticleGPUSim and the spawnable can be freed
+	virtual bool SpawnGPUParticles(const CUnit* owner, const float3& offset) { return false; }
 
 	static bool GetSpawnableMemberInfo(const std::string& spawnableName, SExpGenSpawnableMemberInfo& memberInfo);
 	static int GetSpawnableID(const std::string& spawnableName);
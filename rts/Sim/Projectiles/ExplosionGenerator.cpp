@@ -1104,6 +1104,12 @@ bool CCustomExplosionGenerator::Explosion(
 		for (unsigned int c = 0; c < psi.count; c++) {
 			CExpGenSpawnable* projectile = CExpGenSpawnable::CreateSpawnable(psi.spawnableID);
 			ExecuteExplosionCode(&psi.code[0], damage, (char*) projectile, c, dir);
+
+			if (projectile->SpawnGPUParticles(owner, pos)) {
+				projMemPool.free(projectile);
+				continue;
+			}
+
 			projectile->Init(owner, pos);
 		}
 	}
@@ -3,6 +3,8 @@
 #include "Projectile.h"
 #include "Map/MapInfo.h"
 #include "Rendering/Colors.h"
+#include "Rendering/Env/Particles/ParticleGPUSim.h"
+#include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/Textures/TextureAtlas.h"
 #include "Rendering/GL/RenderBuffers.h"
 #include "Sim/Projectiles/ExpGenSpawnableMemberInfo.h"
@@ -145,6 +147,37 @@ void CProjectile::Init(const CUnit* owner, const float3& offset)
 }
 
 
+bool CProjectile::InitGPUParticles(const CUnit* owner, const float3& offset)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	assert(!synced);
+
+	if (!ParticleGPUSim::IsValid())
+		return false;
+
+	if (owner != nullptr) {
+		ownerID = owner->id;
+		teamID = owner->team;
+		allyteamID =  teamHandler.IsValidTeam(teamID)? teamHandler.AllyTeam(teamID): -1;
+	}
+
+	const float3 relPos = pos;
+
+	SetPosition(relPos + offset);
+
+	// GPU particles are never LOS-checked again, the ones not visible right now
+	// are left to Init() (which expects to see the unmodified relative position)
+	if (!CProjectileDrawer::CanDrawProjectile(this, allyteamID)) {
+		SetPosition(relPos);
+		return false;
+	}
+
+	SetVelocityAndSpeed(speed);
+	CExpGenSpawnable::Init(owner, offset);
+	return true;
+}
+
+
 void CProjectile::Update()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -145,6 +145,9 @@ protected:
 
 	static bool GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo);
 	static bool IsValidTexture(const AtlasedTexture* tex);
+
+	// the part of Init() a SpawnGPUParticles override needs, false if the effect has to stay a projectile
+	bool InitGPUParticles(const CUnit* owner, const float3& offset);
 public:
 	static void AddMiniMapVertices(VA_TYPE_C&& v1, VA_TYPE_C&& v2);
 
@@ -1,6 +1,9 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <array>
+#include <numeric>
+#include <typeinfo>
 
 #include "Projectile.h"
 #include "ProjectileHandler.h"
@@ -18,7 +21,19 @@
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Rendering/Env/Particles/Classes/NanoProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/BeamLaserProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/EmgProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/ExplosiveProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/FireBallProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/FlameProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/LargeBeamLaserProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/LaserProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/LightningProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/MissileProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/StarburstProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/TorpedoProjectile.h"
 #include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
+#include "Sim/Projectiles/WeaponProjectiles/WeaponProjectileTypes.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitHandler.h"
@@ -42,6 +57,7 @@
 
 CONFIG(int, MaxParticles).defaultValue(10000).headlessValue(0).minimumValue(0);
 CONFIG(int, MaxNanoParticles).defaultValue(2000).headlessValue(0).minimumValue(0);
+CONFIG(bool, ProjectilePreUpdateMT).defaultValue(true).description("Compute the interpolation transforms of synced projectiles on all threads before their (serial) Update. Does not affect the simulation.");
 
 
 CR_BIND(CProjectileHandler, )
@@ -50,10 +66,12 @@ CR_REG_METADATA(CProjectileHandler, (
 	CR_MEMBER_UN(flyingPieces),
 	CR_MEMBER_UN(groundFlashes),
 	CR_MEMBER_UN(resortFlyingPieces),
+	CR_MEMBER(numUnsortedProjectiles),
 
 	CR_MEMBER(maxParticles),
 	CR_MEMBER(maxNanoParticles),
 	CR_MEMBER(currentNanoParticles),
+	CR_IGNORED(syncedPreUpdateMT),
 	CR_MEMBER_UN(frameCurrentParticles),
 	CR_MEMBER_UN(frameProjectileCounts)
 ))
@@ -74,11 +92,14 @@ void CProjectileHandler::Init()
 	frameCurrentParticles = 0;
 	frameProjectileCounts[false] = 0;
 	frameProjectileCounts[ true] = 0;
+	numUnsortedProjectiles[false] = 0;
+	numUnsortedProjectiles[ true] = 0;
 
 	resortFlyingPieces.fill(false);
 
 	maxParticles     = configHandler->GetInt("MaxParticles");
 	maxNanoParticles = configHandler->GetInt("MaxNanoParticles");
+	syncedPreUpdateMT = configHandler->GetBool("ProjectilePreUpdateMT");
 
 	projMemPool.clear();
 	projMemPool.reserve(1024);
@@ -94,7 +115,7 @@ void CProjectileHandler::Init()
 	CExpGenSpawnable::InitSpawnables();
 
 	// register ConfigNotify()
-	configHandler->NotifyOnChange(this, {"MaxParticles", "MaxNanoParticles"});
+	configHandler->NotifyOnChange(this, {"MaxParticles", "MaxNanoParticles", "ProjectilePreUpdateMT"});
 }
 
 void CProjectileHandler::Kill()
@@ -139,6 +160,7 @@ void CProjectileHandler::ConfigNotify(const std::string& key, const std::string&
 	RECOIL_DETAILED_TRACY_ZONE;
 	maxParticles     = configHandler->GetInt("MaxParticles");
 	maxNanoParticles = configHandler->GetInt("MaxNanoParticles");
+	syncedPreUpdateMT = configHandler->GetBool("ProjectilePreUpdateMT");
 
 	projectiles[false].reserve(static_cast<size_t>(maxParticles) * 2);
 }
@@ -156,6 +178,26 @@ static void MAPPOS_SANITY_CHECK(const float3 v)
 	assert(v.y <=  MAX_PROJECTILE_HEIGHT);
 }
 
+// T is (one of) the final projectile class(es) of the run, so Update() is bound statically
+template<typename T>
+static void UpdateSyncedRun(spring::FreeListMapCompact<CProjectile*, int>& pc, size_t begin, size_t end, size_t numPreUpdated)
+{
+	for (size_t i = begin; i < end; ++i) {
+		T* p = static_cast<T*>(pc[i]);
+		assert(p != nullptr);
+
+		MAPPOS_SANITY_CHECK(p->pos);
+
+		// projectiles added by previous Update()'s were not included in the threaded PreUpdate
+		if (i >= numPreUpdated)
+			p->PreUpdate();
+
+		p->Update();
+
+		MAPPOS_SANITY_CHECK(p->pos);
+	}
+}
+
 template<bool synced>
 void CProjectileHandler::UpdateProjectilesImpl()
 {
@@ -189,21 +231,59 @@ void CProjectileHandler::UpdateProjectilesImpl()
 		++i;
 	}
 
+	// consecutive Update()'s then mostly run the same code on objects of the same layout;
+	// only regroup once enough were appended or swapped into holes to be out of place
+	if ((numUnsortedProjectiles[synced] * 4) > pc.size())
+		SortProjectiles<synced>();
+
 	// WARNING: same as above but for p->Update()
 	if constexpr (synced) {
+		// PreUpdate only snapshots each projectile's own (unsynced) interpolation transform, so
+		// it can run ahead for all of them; Update() has to stay serial and in container order
+		// since projectiles observe each other (interception, explosion callins) while updating
+		size_t numPreUpdated = 0;
+
+		if (syncedPreUpdateMT) {
+			SCOPED_TIMER("Sim::Projectiles::PreUpdateSyncedMT");
+			for_mt_chunk(0, pc.size(), [&pc](int i) {
+				pc[i]->PreUpdate();
+			});
+
+			numPreUpdated = pc.size();
+		}
 
 		SCOPED_TIMER("Sim::Projectiles::UpdateSyncedST");
-		for (size_t i = 0; i < pc.size(); ++i) {
-			CProjectile* p = pc[i];
-			assert(p != nullptr);
-
-			MAPPOS_SANITY_CHECK(p->pos);
-			p->PreUpdate();
-			p->Update();
-			quadField.MovedProjectile(p);
+		// walk the container in runs of one projectile type; projectiles appended
+		// by Update()'s of a run are visited by the runs that follow it
+		for (size_t i = 0; i < pc.size(); /*no-op*/) {
+			const uint32_t runType = pc[i]->GetProjectileType();
+
+			size_t j = i + 1;
+
+			while (j < pc.size() && pc[j]->GetProjectileType() == runType)
+				++j;
+
+			switch (runType) {
+				case WEAPON_BEAMLASER_PROJECTILE     : { UpdateSyncedRun<CBeamLaserProjectile     >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_EMG_PROJECTILE           : { UpdateSyncedRun<CEmgProjectile           >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_EXPLOSIVE_PROJECTILE     : { UpdateSyncedRun<CExplosiveProjectile     >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_FIREBALL_PROJECTILE      : { UpdateSyncedRun<CFireBallProjectile      >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_FLAME_PROJECTILE         : { UpdateSyncedRun<CFlameProjectile         >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_LARGEBEAMLASER_PROJECTILE: { UpdateSyncedRun<CLargeBeamLaserProjectile>(pc, i, j, numPreUpdated); } break;
+				case WEAPON_LASER_PROJECTILE         : { UpdateSyncedRun<CLaserProjectile         >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_LIGHTNING_PROJECTILE     : { UpdateSyncedRun<CLightningProjectile     >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_MISSILE_PROJECTILE       : { UpdateSyncedRun<CMissileProjectile       >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_STARBURST_PROJECTILE     : { UpdateSyncedRun<CStarburstProjectile     >(pc, i, j, numPreUpdated); } break;
+				case WEAPON_TORPEDO_PROJECTILE       : { UpdateSyncedRun<CTorpedoProjectile       >(pc, i, j, numPreUpdated); } break;
+				// pieces, flares, fires; not worth a run of their own
+				default                              : { UpdateSyncedRun<CProjectile              >(pc, i, j, numPreUpdated); } break;
+			}
 
-			MAPPOS_SANITY_CHECK(p->pos);
+			i = j;
 		}
+
+		// nothing reads projectile quads until CheckCollisions, so they can all be updated at once
+		quadField.MovedProjectiles(pc.GetData());
 	}
 	else {
 		SCOPED_TIMER("Sim::Projectiles::UpdateUnsyncedMT");
@@ -220,6 +300,43 @@ void CProjectileHandler::UpdateProjectilesImpl()
 }
 
 
+template<bool synced>
+void CProjectileHandler::SortProjectiles()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static std::vector<uint64_t> sortKeys;
+	static std::vector<size_t> sortOrder;
+
+	auto& pc = projectiles[synced];
+
+	sortKeys.resize(pc.size());
+	sortOrder.resize(pc.size());
+
+	for (size_t i = 0, n = pc.size(); i < n; ++i) {
+		const CProjectile* p = pc[i];
+
+		if constexpr (synced) {
+			// the order is part of the simulation, so key on state every client agrees on
+			sortKeys[i] = (uint64_t(p->GetProjectileType()) << 32) | uint32_t(p->id);
+		} else {
+			// a hash collision only merges two groups, unsynced update order is free either way
+			sortKeys[i] = typeid(*p).hash_code();
+		}
+	}
+
+	std::iota(sortOrder.begin(), sortOrder.end(), 0);
+	std::stable_sort(sortOrder.begin(), sortOrder.end(), [](size_t a, size_t b) {
+		return (sortKeys[a] < sortKeys[b]);
+	});
+
+	// bring the cached particle count up to date, it only covers a prefix of the container
+	GetCurrentParticles();
+
+	pc.Reorder(sortOrder);
+	numUnsortedProjectiles[synced] = 0;
+}
+
+
 template<class T>
 static void UPDATE_PTR_CONTAINER(T& cont) {
 	if (cont.empty())
@@ -277,6 +394,36 @@ static void UPDATE_REF_CONTAINER(T& cont) {
 	cont.erase(cont.begin() + size, cont.end());
 }
 
+// same as UPDATE_REF_CONTAINER for items whose Update() only touches the item itself;
+// the updates run threaded, the dead items are then compacted out serially (keeping
+// the order intact so a resort has less work)
+template<class T>
+static void UPDATE_REF_CONTAINER_MT(T& cont, std::vector<uint8_t>& alive) {
+	if (cont.empty())
+		return;
+
+	alive.clear();
+	alive.resize(cont.size(), 0);
+
+	for_mt_chunk(0, cont.size(), [&cont, &alive](int i) {
+		alive[i] = cont[i].Update();
+	});
+
+	size_t size = 0;
+
+	for (size_t i = 0, n = cont.size(); i < n; ++i) {
+		if (!alive[i])
+			continue;
+
+		if (size != i)
+			cont[size] = std::move(cont[i]);
+
+		++size;
+	}
+
+	cont.erase(cont.begin() + size, cont.end());
+}
+
 
 
 void CProjectileHandler::CreateProjectile(CProjectile* p)
@@ -313,6 +460,8 @@ void CProjectileHandler::DestroyProjectile(CProjectile* p)
 		projectiles[false].Del(p->id);
 	}
 
+	numUnsortedProjectiles[p->synced] += 1;
+
 	projMemPool.free(p);
 }
 
@@ -334,7 +483,7 @@ void CProjectileHandler::Update()
 		for (int modelType = 0; modelType < MODELTYPE_CNT; ++modelType) {
 			auto& fpc = flyingPieces[modelType];
 
-			UPDATE_REF_CONTAINER(fpc);
+			UPDATE_REF_CONTAINER_MT(fpc, flyingPiecesAlive);
 
 			if (resortFlyingPieces[modelType]) {
 				std::stable_sort(fpc.begin(), fpc.end());
@@ -345,15 +494,19 @@ void CProjectileHandler::Update()
 	// precache part of particles count calculation that else becomes very heavy
 	{
 		ZoneScopedNC("ProjectileHandler::CountParticles", tracy::Color::Goldenrod);
-		frameCurrentParticles = 0;
+		// GetProjectilesCount is const, so count per thread and sum up afterwards
+		std::array<int, ThreadPool::MAX_THREADS> threadParticles = {};
 
-		for (const CProjectile* p : projectiles[true]) {
-			frameCurrentParticles += p->GetProjectilesCount();
-		}
-		for (const CProjectile* p : projectiles[false]) {
-			frameCurrentParticles += p->GetProjectilesCount();
+		for (const bool synced: {true, false}) {
+			const auto& pc = projectiles[synced];
+
+			for_mt_chunk(0, pc.size(), [&pc, &threadParticles](int i) {
+				threadParticles[ThreadPool::GetThreadNum()] += pc[i]->GetProjectilesCount();
+			});
 		}
 
+		frameCurrentParticles = std::accumulate(threadParticles.begin(), threadParticles.end(), 0);
+
 		frameProjectileCounts[true] = projectiles[true].size();
 		frameProjectileCounts[false] = projectiles[false].size();
 	}
@@ -371,6 +524,8 @@ void CProjectileHandler::AddProjectile(CProjectile* p)
 	else
 		p->id = static_cast<int>(projectiles[false].Add(p)); //don't bother with shuffling unsynced ids 
 
+	numUnsortedProjectiles[p->synced] += 1;
+
 	if (p->synced) {
 		ASSERT_SYNCED(freeIDs.size());
 		ASSERT_SYNCED(p->id);
@@ -425,6 +580,70 @@ static bool CheckProjectileCollisionFlags(const CProjectile* p, const CUnit* u)
 }
 
 
+// Drops every unit whose collision volume's bounding sphere is not touched by the segment
+// [ppos0, ppos1], keeping the others in order. Both Collision() (tests ppos0 against that
+// sphere first) and Intersect() (tests against the volume's box) can only report hits for
+// the survivors, so the exact tests see the same units they would otherwise hit; piece-tree
+// volumes are not bounded by the sphere and always survive.
+static void FilterUnitsBySweptBounds(std::vector<CUnit*>& units, const float3 ppos0, const float3 ppos1)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// the candidates are already within (speed + radius) of ppos0, so this is only
+	// worth it once there are enough of them for the exact tests to add up
+	constexpr size_t MIN_BATCH_SIZE = 4;
+	// absorbs rounding differences between the bounding sphere and the volume transforms
+	constexpr float BOUNDS_MARGIN = 1.0f;
+
+	static std::vector<float> cxs, cys, czs, rss;
+
+	const size_t numUnits = units.size();
+
+	if (numUnits < MIN_BATCH_SIZE)
+		return;
+
+	cxs.resize(numUnits);
+	cys.resize(numUnits);
+	czs.resize(numUnits);
+	rss.resize(numUnits);
+
+	for (size_t i = 0; i < numUnits; i++) {
+		const CUnit* unit = units[i];
+		const CollisionVolume& cv = unit->collisionVolume;
+		const float3 cp = cv.GetWorldSpacePos(unit);
+
+		cxs[i] = cp.x;
+		cys[i] = cp.y;
+		czs[i] = cp.z;
+		rss[i] = cv.DefaultToPieceTree()? std::numeric_limits<float>::max(): Square(cv.GetBoundingRadius() + BOUNDS_MARGIN);
+	}
+
+	const float3 sd = ppos1 - ppos0;
+	const float sdSq = sd.SqLength();
+	const float sdInvSq = (sdSq > 0.0f)? (1.0f / sdSq): 0.0f;
+
+	// closest point on the segment to each sphere center, branch-free over the batch so it vectorizes
+	for (size_t i = 0; i < numUnits; i++) {
+		const float wx = cxs[i] - ppos0.x;
+		const float wy = cys[i] - ppos0.y;
+		const float wz = czs[i] - ppos0.z;
+		const float t = std::clamp((wx * sd.x + wy * sd.y + wz * sd.z) * sdInvSq, 0.0f, 1.0f);
+		const float qx = wx - sd.x * t;
+		const float qy = wy - sd.y * t;
+		const float qz = wz - sd.z * t;
+
+		rss[i] -= (qx * qx + qy * qy + qz * qz);
+	}
+
+	size_t numKept = 0;
+
+	for (size_t i = 0; i < numUnits; i++) {
+		units[numKept] = units[i];
+		numKept += (rss[i] >= 0.0f);
+	}
+
+	units.resize(numKept);
+}
+
 void CProjectileHandler::CheckUnitCollisions(
 	CProjectile* p,
 	std::vector<CUnit*>& tempUnits,
@@ -435,6 +654,8 @@ void CProjectileHandler::CheckUnitCollisions(
 	if (!p->checkCol)
 		return;
 
+	FilterUnitsBySweptBounds(tempUnits, ppos0, ppos1);
+
 	CollisionQuery cq;
 
 	for (CUnit* unit: tempUnits) {
@@ -589,6 +810,25 @@ void CProjectileHandler::CheckUnitFeatureCollisions(bool synced)
 void CProjectileHandler::CheckGroundCollisions(bool synced)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
+	static std::vector<float> sampleXs;
+	static std::vector<float> sampleZs;
+	static std::vector<float> sampleHeights;
+
+	// sample the ground below every projectile in one batch up front; projectiles
+	// created or moved by the Collision() calls below are re-sampled individually
+	const size_t numSampled = projectiles[synced].size();
+
+	sampleXs.resize(numSampled);
+	sampleZs.resize(numSampled);
+	sampleHeights.resize(numSampled);
+
+	for (size_t i = 0; i < numSampled; ++i) {
+		sampleXs[i] = projectiles[synced][i]->pos.x;
+		sampleZs[i] = projectiles[synced][i]->pos.z;
+	}
+
+	CGround::GetHeightsReal(sampleXs.data(), sampleZs.data(), sampleHeights.data(), numSampled);
+
 	//can't use iterators here, because instructions inside the loop modify projectiles[synced]
 	for (size_t i = 0; i < projectiles[synced].size(); ++i) {
 		CProjectile* p = projectiles[synced][i];
@@ -614,7 +854,8 @@ void CProjectileHandler::CheckGroundCollisions(bool synced)
 		const float px = p->pos.x;
 		const float py = p->pos.y;
 		const float pz = p->pos.z;
-		const float gy = CGround::GetHeightReal(px, pz);
+		const bool sampled = (i < numSampled && sampleXs[i] == px && sampleZs[i] == pz);
+		const float gy = sampled? sampleHeights[i]: CGround::GetHeightReal(px, pz);
 
 		const bool belowGround = (py < gy);
 		const bool insideWater = (py <= CGround::GetWaterLevel(px, pz));
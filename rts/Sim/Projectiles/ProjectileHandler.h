@@ -84,6 +84,9 @@ public:
 	int maxNanoParticles = 0;
 	int currentNanoParticles = 0;
 
+	// split the synced update into a threaded PreUpdate and a serial Update pass
+	bool syncedPreUpdateMT = true;
+
 	// these vars are used to precache parts of GetCurrentParticles() calculations
 	mutable int frameCurrentParticles = 0;
 	mutable int frameProjectileCounts[2] = {0, 0};
@@ -91,6 +94,11 @@ public:
 	// flying pieces (unsynced) are sorted from time to time to reduce GL state changes
 	std::array<                bool, MODELTYPE_CNT> resortFlyingPieces{};
 	std::array<FlyingPieceContainer, MODELTYPE_CNT> flyingPieces{};
+	// per-piece Update() results of the threaded flying piece update
+	std::vector<uint8_t> flyingPiecesAlive;
+
+	// projectiles added or moved by a removal since they were last grouped by type
+	size_t numUnsortedProjectiles[2] = {0, 0};
 
 	// unsynced
 	GroundFlashContainer groundFlashes;
@@ -103,6 +111,10 @@ private:
 	template<bool synced>
 	CProjectile* GetProjectileByID(int id);
 
+	// groups projectiles by their type (see UpdateProjectilesImpl)
+	template<bool synced>
+	void SortProjectiles();
+
 	template<bool synced>
 	void UpdateProjectilesImpl();
 	void UpdateProjectiles() {
@@ -12,10 +12,11 @@
 static constexpr size_t PMP_ALIGN = 16; // smallest that fits the needs of all the various projectile types
 static constexpr size_t PMP_S = AlignUp(sizeof(CStarburstProjectile), PMP_ALIGN); //biggest in size
 
+// thread-cached s.t. projectiles and particles can be spawned from parallel sections
 #if (defined(__x86_64) || defined(__x86_64__) || defined(_M_X64))
-typedef StaticMemPool<MAX_PROJECTILES, PMP_S, PMP_ALIGN> ProjMemPool;
+typedef ThreadCachedMemPool<StaticMemPool<MAX_PROJECTILES, PMP_S, PMP_ALIGN>> ProjMemPool;
 #else
-typedef FixedDynMemPool<PMP_S, MAX_PROJECTILES / 2000, MAX_PROJECTILES / 64, PMP_ALIGN> ProjMemPool;
+typedef ThreadCachedMemPool<FixedDynMemPool<PMP_S, MAX_PROJECTILES / 2000, MAX_PROJECTILES / 64, PMP_ALIGN>> ProjMemPool;
 #endif
 
 extern ProjMemPool projMemPool;
@@ -6,7 +6,7 @@
 #include "WeaponProjectile.h"
 #include "System/Color.h"
 
-class CBeamLaserProjectile: public CWeaponProjectile
+class CBeamLaserProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CBeamLaserProjectile)
 public:
@@ -5,7 +5,7 @@
 
 #include "WeaponProjectile.h"
 
-class CEmgProjectile : public CWeaponProjectile
+class CEmgProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CEmgProjectile)
 public:
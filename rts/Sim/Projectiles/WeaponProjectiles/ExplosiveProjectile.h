@@ -5,7 +5,7 @@
 
 #include "WeaponProjectile.h"
 
-class CExplosiveProjectile : public CWeaponProjectile
+class CExplosiveProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CExplosiveProjectile)
 public:
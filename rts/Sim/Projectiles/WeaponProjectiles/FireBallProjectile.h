@@ -6,7 +6,7 @@
 #include <algorithm>
 #include "WeaponProjectile.h"
 
-class CFireBallProjectile : public CWeaponProjectile
+class CFireBallProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CFireBallProjectile)
 	CR_DECLARE_SUB(Spark)
@@ -5,7 +5,7 @@
 
 #include "WeaponProjectile.h"
 
-class CFlameProjectile : public CWeaponProjectile
+class CFlameProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CFlameProjectile)
 public:
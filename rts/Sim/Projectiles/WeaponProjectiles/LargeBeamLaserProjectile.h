@@ -7,7 +7,7 @@
 #include "Rendering/Textures/TextureAtlas.h"
 #include "System/Color.h"
 
-class CLargeBeamLaserProjectile : public CWeaponProjectile
+class CLargeBeamLaserProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CLargeBeamLaserProjectile)
 public:
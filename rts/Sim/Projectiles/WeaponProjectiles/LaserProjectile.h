@@ -5,7 +5,7 @@
 
 #include "WeaponProjectile.h"
 
-class CLaserProjectile : public CWeaponProjectile
+class CLaserProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CLaserProjectile)
 public:
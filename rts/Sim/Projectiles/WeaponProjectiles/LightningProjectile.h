@@ -7,7 +7,7 @@
 
 class CWeapon;
 
-class CLightningProjectile : public CWeaponProjectile
+class CLightningProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CLightningProjectile)
 public:
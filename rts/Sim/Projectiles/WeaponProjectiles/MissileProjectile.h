@@ -9,7 +9,7 @@ class CUnit;
 class CSmokeTrailProjectile;
 
 
-class CMissileProjectile : public CWeaponProjectile
+class CMissileProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CMissileProjectile)
 protected:
@@ -8,7 +8,7 @@
 
 class CSmokeTrailProjectile;
 
-class CStarburstProjectile : public CWeaponProjectile
+class CStarburstProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CStarburstProjectile)
 	CR_DECLARE_SUB(TracerPart)
@@ -5,7 +5,7 @@
 
 #include "WeaponProjectile.h"
 
-class CTorpedoProjectile : public CWeaponProjectile
+class CTorpedoProjectile final : public CWeaponProjectile
 {
 	CR_DECLARE_DERIVED(CTorpedoProjectile)
 public:
@@ -1,5 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+#include <algorithm>
+
 #include "Sim/Units/CommandAI/BuilderCaches.h"
+#include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/Unit.h"
@@ -9,140 +12,184 @@ spring::unordered_set<int> CBuilderCaches::reclaimers;
 spring::unordered_set<int> CBuilderCaches::featureReclaimers;
 spring::unordered_set<int> CBuilderCaches::resurrecters;
 
+CBuilderCaches::ClaimIndex CBuilderCaches::unitReclaimClaims;
+CBuilderCaches::ClaimIndex CBuilderCaches::featureReclaimClaims;
+CBuilderCaches::ClaimIndex CBuilderCaches::resurrectClaims;
+
 std::vector<int> CBuilderCaches::removees;
 
-void CBuilderCaches::InitStatic()
+
+void CBuilderCaches::ClaimIndex::Add(int builderID, int targetID)
 {
-	spring::clear_unordered_set(reclaimers);
-	spring::clear_unordered_set(featureReclaimers);
-	spring::clear_unordered_set(resurrecters);
+	const auto iter = builderTargets.find(builderID);
+
+	if (iter != builderTargets.end()) {
+		if (iter->second == targetID)
+			return;
+
+		Remove(builderID);
+	}
+
+	builderTargets[builderID] = targetID;
+	targetBuilders[targetID].push_back(builderID);
 }
 
-void CBuilderCaches::AddUnitToReclaimers(CUnit* unit) { reclaimers.insert(unit->id); }
-void CBuilderCaches::RemoveUnitFromReclaimers(CUnit* unit) { reclaimers.erase(unit->id); }
+void CBuilderCaches::ClaimIndex::Remove(int builderID)
+{
+	const auto iter = builderTargets.find(builderID);
 
-void CBuilderCaches::AddUnitToFeatureReclaimers(CUnit* unit) { featureReclaimers.insert(unit->id); }
-void CBuilderCaches::RemoveUnitFromFeatureReclaimers(CUnit* unit) { featureReclaimers.erase(unit->id); }
+	if (iter == builderTargets.end())
+		return;
 
-void CBuilderCaches::AddUnitToResurrecters(CUnit* unit) { resurrecters.insert(unit->id); }
-void CBuilderCaches::RemoveUnitFromResurrecters(CUnit* unit) { resurrecters.erase(unit->id); }
+	const auto targetIter = targetBuilders.find(iter->second);
+	std::vector<int>& builders = targetIter->second;
 
+	// keep the order, it decides which stale claims a lookup prunes first
+	builders.erase(std::find(builders.begin(), builders.end(), builderID));
 
-/**
- * Checks if a unit is being reclaimed by a friendly con.
- *
- * We assume that there will not be a lot of reclaimers, because performance
- * would suck if there were. Ideally, reclaimers should be assigned on a
- * per-unit basis, but this requires tracking of deaths, which albeit
- * already done, is not exactly simple to follow.
- *
- * TODO easy: store reclaiming units per allyteam
- * TODO harder: update reclaimers as they start/finish reclaims and/or die
- */
-bool CBuilderCaches::IsUnitBeingReclaimed(const CUnit* unit, const CUnit* friendUnit)
+	if (builders.empty())
+		targetBuilders.erase(targetIter);
+
+	builderTargets.erase(iter);
+}
+
+void CBuilderCaches::ClaimIndex::Clear()
 {
-	bool retval = false;
+	spring::clear_unordered_map(builderTargets);
+	spring::clear_unordered_map(targetBuilders);
+}
 
-	removees.clear();
-	removees.reserve(reclaimers.size());
 
-	for (auto it = reclaimers.begin(); it != reclaimers.end(); ++it) {
-		const CUnit* u = unitHandler.GetUnit(*it);
-		const CCommandAI* cai = u->commandAI;
-		const CCommandQueue& cq = cai->commandQue;
+// target of <unit>'s current command if it is <cmdID> with a matching param-count, else -1
+static int GetClaimedTarget(const CUnit* unit, int cmdID, bool allowAreaParams)
+{
+	const CCommandQueue& cq = unit->commandAI->commandQue;
 
-		if (cq.empty()) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const Command& c = cq.front();
-		if (c.GetID() != CMD_RECLAIM || (c.GetNumParams() != 1 && c.GetNumParams() != 5)) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const int cmdUnitId = (int)c.GetParam(0);
-		if (cmdUnitId == unit->id && (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))) {
-			retval = true;
-			break;
-		}
-	}
+	if (cq.empty())
+		return -1;
 
-	for (auto it = removees.begin(); it != removees.end(); ++it)
-		RemoveUnitFromReclaimers(unitHandler.GetUnit(*it));
+	const Command& c = cq.front();
 
-	return retval;
+	if (c.GetID() != cmdID)
+		return -1;
+	if (c.GetNumParams() != 1 && (!allowAreaParams || c.GetNumParams() != 5))
+		return -1;
+
+	return (int)c.GetParam(0);
 }
 
 
+void CBuilderCaches::InitStatic()
+{
+	spring::clear_unordered_set(reclaimers);
+	spring::clear_unordered_set(featureReclaimers);
+	spring::clear_unordered_set(resurrecters);
 
-bool CBuilderCaches::IsFeatureBeingReclaimed(int featureId, const CUnit* friendUnit)
+	unitReclaimClaims.Clear();
+	featureReclaimClaims.Clear();
+	resurrectClaims.Clear();
+}
+
+void CBuilderCaches::AddUnitToReclaimers(CUnit* unit)
 {
-	bool retval = false;
+	reclaimers.insert(unit->id);
 
-	removees.clear();
-	removees.reserve(featureReclaimers.size());
+	if (const int targetID = GetClaimedTarget(unit, CMD_RECLAIM, true); targetID >= 0)
+		unitReclaimClaims.Add(unit->id, targetID);
+}
+void CBuilderCaches::RemoveUnitFromReclaimers(CUnit* unit) { reclaimers.erase(unit->id); unitReclaimClaims.Remove(unit->id); }
 
-	for (auto it = featureReclaimers.begin(); it != featureReclaimers.end(); ++it) {
-		const CUnit* u = unitHandler.GetUnit(*it);
-		const CCommandAI* cai = u->commandAI;
-		const CCommandQueue& cq = cai->commandQue;
+void CBuilderCaches::AddUnitToFeatureReclaimers(CUnit* unit)
+{
+	featureReclaimers.insert(unit->id);
 
-		if (cq.empty()) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const Command& c = cq.front();
-		if (c.GetID() != CMD_RECLAIM || (c.GetNumParams() != 1 && c.GetNumParams() != 5)) {
-			removees.push_back(u->id);
-			continue;
-		}
-		const int cmdFeatureId = (int)c.GetParam(0);
-		if ((cmdFeatureId - unitHandler.MaxUnits()) == featureId && (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))) {
-			retval = true;
-			break;
-		}
-	}
+	if (const int targetID = GetClaimedTarget(unit, CMD_RECLAIM, true); targetID >= 0)
+		featureReclaimClaims.Add(unit->id, targetID - unitHandler.MaxUnits());
+}
+void CBuilderCaches::RemoveUnitFromFeatureReclaimers(CUnit* unit) { featureReclaimers.erase(unit->id); featureReclaimClaims.Remove(unit->id); }
 
-	for (auto it = removees.begin(); it != removees.end(); ++it)
-		RemoveUnitFromFeatureReclaimers(unitHandler.GetUnit(*it));
+void CBuilderCaches::AddUnitToResurrecters(CUnit* unit)
+{
+	resurrecters.insert(unit->id);
 
-	return retval;
+	if (const int targetID = GetClaimedTarget(unit, CMD_RESURRECT, false); targetID >= 0)
+		resurrectClaims.Add(unit->id, targetID - unitHandler.MaxUnits());
 }
+void CBuilderCaches::RemoveUnitFromResurrecters(CUnit* unit) { resurrecters.erase(unit->id); resurrectClaims.Remove(unit->id); }
 
 
+/**
+ * Checks if a unit is being reclaimed by a friendly con.
+ *
+ * Only builders that claimed <unit> through AddUnitToReclaimers are looked
+ * at. Those whose current command no longer is a reclaim are dropped, like
+ * the full scan over all reclaimers used to do.
+ */
+bool CBuilderCaches::IsUnitBeingReclaimed(const CUnit* unit, const CUnit* friendUnit)
+{
+	return (IsBeingClaimed(unitReclaimClaims, unit->id, 0, CMD_RECLAIM, true, friendUnit, &RemoveUnitFromReclaimers));
+}
+
+bool CBuilderCaches::IsFeatureBeingReclaimed(int featureId, const CUnit* friendUnit)
+{
+	return (IsBeingClaimed(featureReclaimClaims, featureId, unitHandler.MaxUnits(), CMD_RECLAIM, true, friendUnit, &RemoveUnitFromFeatureReclaimers));
+}
+
 bool CBuilderCaches::IsFeatureBeingResurrected(int featureId, const CUnit* friendUnit)
 {
+	return (IsBeingClaimed(resurrectClaims, featureId, unitHandler.MaxUnits(), CMD_RESURRECT, false, friendUnit, &RemoveUnitFromResurrecters));
+}
+
+
+bool CBuilderCaches::IsBeingClaimed(
+	ClaimIndex& claims,
+	int targetID,
+	int targetOffset,
+	int cmdID,
+	bool allowAreaParams,
+	const CUnit* friendUnit,
+	void (*removeClaimant)(CUnit*)
+) {
+	const auto iter = claims.targetBuilders.find(targetID);
+
+	if (iter == claims.targetBuilders.end())
+		return false;
+
 	bool retval = false;
 
 	removees.clear();
-	removees.reserve(resurrecters.size());
 
-	for (auto it = resurrecters.begin(); it != resurrecters.end(); ++it) {
-		const CUnit* u = unitHandler.GetUnit(*it);
-		const CCommandAI* cai = u->commandAI;
-		const CCommandQueue& cq = cai->commandQue;
+	for (const int builderID: iter->second) {
+		const CUnit* u = unitHandler.GetUnit(builderID);
+		const int claimedID = GetClaimedTarget(u, cmdID, allowAreaParams);
 
-		if (cq.empty()) {
-			removees.push_back(u->id);
+		// no longer doing this kind of job at all
+		if (claimedID < 0) {
+			removees.push_back(builderID);
 			continue;
 		}
-		const Command& c = cq.front();
-		if (c.GetID() != CMD_RESURRECT || c.GetNumParams() != 1) {
-			removees.push_back(u->id);
+
+		// moved on without re-claiming, until it does the claim on
+		// <targetID> is stale
+		if ((claimedID - targetOffset) != targetID) {
+			removees.push_back(-1 - builderID);
 			continue;
 		}
-		const int cmdFeatureId = (int)c.GetParam(0);
-		if ((cmdFeatureId - unitHandler.MaxUnits()) == featureId && (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam))) {
+
+		if (friendUnit == nullptr || teamHandler.Ally(friendUnit->allyteam, u->allyteam)) {
 			retval = true;
 			break;
 		}
 	}
 
-	for (auto it = removees.begin(); it != removees.end(); ++it)
-		RemoveUnitFromResurrecters(unitHandler.GetUnit(*it));
+	// <iter> is invalidated from here on
+	for (const int removee: removees) {
+		if (removee >= 0) {
+			removeClaimant(unitHandler.GetUnit(removee));
+		} else {
+			claims.Remove(-1 - removee);
+		}
+	}
 
 	return retval;
 }
-
-
-
@@ -3,6 +3,7 @@
 #ifndef _BUILDER_CACHES_H_
 #define _BUILDER_CACHES_H_
 
+#include "System/UnorderedMap.hpp"
 #include "System/UnorderedSet.hpp"
 
 #include <vector>
@@ -11,6 +12,33 @@ class CUnit;
 
 class CBuilderCaches
 {
+private:
+	// Which builders claimed which target, as of their last Add* call. Lookups only visit the
+	// claimants of one target instead of every reclaimer, and still check each one against its
+	// current front command like a full scan would.
+	struct ClaimIndex {
+		void Add(int builderID, int targetID);
+		void Remove(int builderID);
+		void Clear();
+
+		spring::unordered_map<int, int> builderTargets;
+		spring::unordered_map<int, std::vector<int>> targetBuilders;
+	};
+
+	static ClaimIndex unitReclaimClaims;
+	static ClaimIndex featureReclaimClaims;
+	static ClaimIndex resurrectClaims;
+
+	static bool IsBeingClaimed(
+		ClaimIndex& claims,
+		int targetID,
+		int targetOffset,
+		int cmdID,
+		bool allowAreaParams,
+		const CUnit* friendUnit,
+		void (*removeClaimant)(CUnit*)
+	);
+
 public:
 	/**
 	 * Checks if a unit is being reclaimed by a friendly con.
@@ -2,8 +2,11 @@
 
 #include "Command.h"
 #include "CommandParamsPool.hpp"
+#include "CommandRing.h"
 
 CommandParamsPool cmdParamsPool;
+// after cmdParamsPool, freeing the nodes on exit can still release pages
+CCommandNodePool cmdNodePool;
 
 CR_BIND(Command, )
 CR_REG_METADATA(Command, (
@@ -40,16 +40,16 @@ public:
 
 	unsigned int AcquirePage() {
 		if (indcs.empty()) {
-			const size_t numIndices = indcs.size();
+			const size_t numPages = pages.size();
 
-			pages.resize(std::max(N, pages.size() << 1));
-			indcs.resize(std::max(N, indcs.size() << 1));
+			pages.resize(std::max(N, numPages << 1));
+			indcs.reserve(pages.size());
 
-			const auto beg = indcs.begin() + numIndices;
-			const auto end = indcs.end();
-
-			// generate new indices
-			std::for_each(beg, end, [&](const unsigned int& i) { indcs[&i - &indcs[0]] = &i - &indcs[0]; });
+			// only the pages just added are free, all older ones are in use; hand
+			// out the lowest first so the pool stays compact
+			for (size_t i = pages.size(); i > numPages; i--) {
+				indcs.push_back(i - 1);
+			}
 		}
 
 		const unsigned int pageIndex = indcs.back();
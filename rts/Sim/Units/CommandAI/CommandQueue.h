@@ -3,10 +3,10 @@
 #ifndef _COMMAND_QUEUE_H
 #define _COMMAND_QUEUE_H
 
-#include <deque>
 #include "Command.h"
+#include "CommandRing.h"
 
-/// A wrapper class for std::deque<Command> to keep track of commands
+/// A wrapper class for CCommandRing to keep track of commands
 class CCommandQueue {
 
 	friend class CCommandAI;
@@ -28,7 +28,7 @@ class CCommandQueue {
 		/// limit to a float's integer range
 		static const int maxTagValue = (1 << 24); // 16777216
 
-		typedef std::deque<Command> basis;
+		typedef CCommandRing basis;
 
 		typedef basis::size_type              size_type;
 		typedef basis::iterator               iterator;
@@ -44,11 +44,11 @@ class CCommandQueue {
 		inline void push_front(const Command& cmd);
 
 		void emplace_back(Command&& cmd) {
-			queue.emplace_back(cmd);
+			queue.push_back(cmd);
 			queue.back().SetTag(GetNextTag());
 		}
 		void emplace_front(Command&& cmd) {
-			queue.emplace_front(cmd);
+			queue.push_front(cmd);
 			queue.front().SetTag(GetNextTag());
 		}
 
@@ -107,7 +107,7 @@ class CCommandQueue {
 		inline void SetQueueType(QueueType type) { queueType = type; }
 
 	private:
-		std::deque<Command> queue;
+		CCommandRing queue;
 		QueueType queueType;
 		int tagCounter;
 };
@@ -0,0 +1,299 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COMMAND_RING_H
+#define COMMAND_RING_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "Command.h"
+#include "System/creg/creg_cond.h"
+
+/* Slab of Command nodes shared by every command queue. Nodes are never handed back to the
+ * allocator, so once a game has warmed up, queueing and completing commands costs no heap
+ * traffic at all (a std::deque<Command> allocates and frees a block every few commands).
+ * Freed nodes are reset first, which hands any pooled params back to cmdParamsPool. */
+class CCommandNodePool {
+public:
+	Command* Alloc() {
+		if (freeNodes.empty())
+			AddChunk();
+
+		Command* node = freeNodes.back();
+		freeNodes.pop_back();
+		return node;
+	}
+
+	void Free(Command* node) {
+		*node = Command();
+		freeNodes.push_back(node);
+	}
+
+private:
+	void AddChunk() {
+		chunks.emplace_back(new Command[CHUNK_SIZE]);
+		freeNodes.reserve(chunks.size() * CHUNK_SIZE);
+
+		// hand out low addresses first
+		for (size_t i = CHUNK_SIZE; i > 0; i--) {
+			freeNodes.push_back(&chunks.back()[i - 1]);
+		}
+	}
+
+private:
+	static constexpr size_t CHUNK_SIZE = 1024;
+
+	std::vector< std::unique_ptr<Command[]> > chunks;
+	std::vector<Command*> freeNodes;
+};
+
+extern CCommandNodePool cmdNodePool;
+
+
+
+/* Double-ended queue of Commands, laid out as a ring of pointers into cmdNodePool. Only the
+ * (small) pointer ring ever grows, so references to queued commands stay valid across every
+ * push, pop and insert that leaves them in the queue; CAI code relies on that the same way it
+ * did with std::deque. Iterators are random-access and invalidated by any modification. */
+class CCommandRing {
+public:
+	typedef Command value_type;
+	typedef size_t size_type;
+	typedef std::ptrdiff_t difference_type;
+
+	template<typename R, typename V> class Iterator {
+	public:
+		typedef std::random_access_iterator_tag iterator_category;
+		typedef Command value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef V* pointer;
+		typedef V& reference;
+
+		Iterator() = default;
+		Iterator(R* r, size_t i): ring(r), index(i) {}
+
+		// iterator -> const_iterator
+		template<typename R2, typename V2>
+		Iterator(const Iterator<R2, V2>& it): ring(it.ring), index(it.index) {}
+
+		V& operator * () const { return (*ring)[index]; }
+		V* operator -> () const { return &(*ring)[index]; }
+		V& operator [] (difference_type n) const { return (*ring)[index + n]; }
+
+		Iterator& operator ++ () { ++index; return *this; }
+		Iterator& operator -- () { --index; return *this; }
+		Iterator operator ++ (int) { return {ring, index++}; }
+		Iterator operator -- (int) { return {ring, index--}; }
+
+		Iterator& operator += (difference_type n) { index += n; return *this; }
+		Iterator& operator -= (difference_type n) { index -= n; return *this; }
+
+		Iterator operator + (difference_type n) const { return {ring, index + n}; }
+		Iterator operator - (difference_type n) const { return {ring, index - n}; }
+
+		friend Iterator operator + (difference_type n, const Iterator& it) { return (it + n); }
+
+		template<typename R2, typename V2> difference_type operator - (const Iterator<R2, V2>& it) const { return (difference_type(index) - difference_type(it.index)); }
+
+		template<typename R2, typename V2> bool operator == (const Iterator<R2, V2>& it) const { return (index == it.index); }
+		template<typename R2, typename V2> bool operator != (const Iterator<R2, V2>& it) const { return (index != it.index); }
+		template<typename R2, typename V2> bool operator <  (const Iterator<R2, V2>& it) const { return (index <  it.index); }
+		template<typename R2, typename V2> bool operator >  (const Iterator<R2, V2>& it) const { return (index >  it.index); }
+		template<typename R2, typename V2> bool operator <= (const Iterator<R2, V2>& it) const { return (index <= it.index); }
+		template<typename R2, typename V2> bool operator >= (const Iterator<R2, V2>& it) const { return (index >= it.index); }
+
+	private:
+		template<typename R2, typename V2> friend class Iterator;
+		friend class CCommandRing;
+
+		R* ring = nullptr;
+		size_t index = 0;
+	};
+
+	typedef Iterator<CCommandRing, Command> iterator;
+	typedef Iterator<const CCommandRing, const Command> const_iterator;
+	typedef std::reverse_iterator<iterator> reverse_iterator;
+	typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+public:
+	CCommandRing() = default;
+	CCommandRing(const CCommandRing&) = delete;
+	~CCommandRing() { clear(); }
+
+	CCommandRing& operator = (const CCommandRing&) = delete;
+
+	bool empty() const { return (count == 0); }
+	size_type size() const { return count; }
+
+	// <cmd> is copied before anything moves, it may live in this queue
+	void push_back(const Command& cmd) {
+		Command* node = NewNode(cmd);
+		Reserve(count + 1);
+		slots[Slot(count++)] = node;
+	}
+	void push_front(const Command& cmd) {
+		Command* node = NewNode(cmd);
+		Reserve(count + 1);
+		head = (head - 1) & (slots.size() - 1);
+		slots[head] = node;
+		count++;
+	}
+
+	void pop_back() {
+		assert(!empty());
+		cmdNodePool.Free(slots[Slot(--count)]);
+	}
+	void pop_front() {
+		assert(!empty());
+		cmdNodePool.Free(slots[head]);
+		head = (head + 1) & (slots.size() - 1);
+		count--;
+	}
+
+	iterator insert(const_iterator pos, const Command& cmd) {
+		const size_t index = pos.index;
+		Command* node = NewNode(cmd);
+
+		assert(index <= count);
+		Reserve(count + 1);
+
+		// shift whichever side is shorter, like std::deque does
+		if (index < (count / 2)) {
+			head = (head - 1) & (slots.size() - 1);
+			count++;
+
+			for (size_t i = 0; i < index; i++) {
+				slots[Slot(i)] = slots[Slot(i + 1)];
+			}
+		} else {
+			count++;
+
+			for (size_t i = count - 1; i > index; i--) {
+				slots[Slot(i)] = slots[Slot(i - 1)];
+			}
+		}
+
+		slots[Slot(index)] = node;
+		return {this, index};
+	}
+
+	iterator erase(const_iterator pos) { return (erase(pos, pos + 1)); }
+	iterator erase(const_iterator first, const_iterator last) {
+		const size_t index = first.index;
+		const size_t numErased = last.index - first.index;
+
+		assert(first.index <= last.index && last.index <= count);
+
+		for (size_t i = index; i < (index + numErased); i++) {
+			cmdNodePool.Free(slots[Slot(i)]);
+		}
+
+		if (index < (count - (index + numErased))) {
+			for (size_t i = index; i > 0; i--) {
+				slots[Slot(i - 1 + numErased)] = slots[Slot(i - 1)];
+			}
+
+			head = (head + numErased) & (slots.size() - 1);
+		} else {
+			for (size_t i = index + numErased; i < count; i++) {
+				slots[Slot(i - numErased)] = slots[Slot(i)];
+			}
+		}
+
+		count -= numErased;
+		return {this, index};
+	}
+
+	void clear() {
+		for (size_t i = 0; i < count; i++) {
+			cmdNodePool.Free(slots[Slot(i)]);
+		}
+
+		head = 0;
+		count = 0;
+	}
+
+	// only used by creg, which fills in the contents afterwards
+	void resize(size_type n) {
+		while (count > n)
+			pop_back();
+		while (count < n)
+			push_back(Command());
+	}
+
+	iterator       begin()       { return {this, 0}; }
+	const_iterator begin() const { return {this, 0}; }
+	iterator       end()         { return {this, count}; }
+	const_iterator end()   const { return {this, count}; }
+
+	reverse_iterator       rbegin()       { return reverse_iterator(end()); }
+	const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+	reverse_iterator       rend()         { return reverse_iterator(begin()); }
+	const_reverse_iterator rend()   const { return const_reverse_iterator(begin()); }
+
+	      Command& front()       { assert(!empty()); return *slots[head]; }
+	const Command& front() const { assert(!empty()); return *slots[head]; }
+	      Command& back()        { assert(!empty()); return *slots[Slot(count - 1)]; }
+	const Command& back()  const { assert(!empty()); return *slots[Slot(count - 1)]; }
+
+	      Command& operator [] (size_type i)       { assert(i < count); return *slots[Slot(i)]; }
+	const Command& operator [] (size_type i) const { assert(i < count); return *slots[Slot(i)]; }
+
+	      Command& at(size_type i)       { CheckIndex(i); return (*this)[i]; }
+	const Command& at(size_type i) const { CheckIndex(i); return (*this)[i]; }
+
+private:
+	size_t Slot(size_t i) const { return ((head + i) & (slots.size() - 1)); }
+
+	void CheckIndex(size_type i) const {
+		if (i >= count)
+			throw std::out_of_range("CCommandRing::at");
+	}
+
+	static Command* NewNode(const Command& cmd) {
+		Command* node = cmdNodePool.Alloc();
+		*node = cmd;
+		return node;
+	}
+
+	void Reserve(size_t n) {
+		if (n <= slots.size())
+			return;
+
+		// capacity stays a power of two so Slot can mask; unroll the ring while copying
+		std::vector<Command*> newSlots(std::max(size_t(8), slots.size() * 2), nullptr);
+
+		for (size_t i = 0; i < count; i++) {
+			newSlots[i] = slots[Slot(i)];
+		}
+
+		slots.swap(newSlots);
+		head = 0;
+	}
+
+private:
+	std::vector<Command*> slots;
+
+	size_t head = 0;
+	size_t count = 0;
+};
+
+
+#ifdef USING_CREG
+namespace creg
+{
+	template<>
+	struct DeduceType<CCommandRing> {
+		static std::unique_ptr<IType> Get() {
+			return std::unique_ptr<IType>(new DynamicArrayType<CCommandRing>());
+		}
+	};
+}
+#endif
+
+#endif // COMMAND_RING_H
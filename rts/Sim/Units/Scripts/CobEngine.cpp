@@ -7,20 +7,27 @@
 #include "CobThread.h"
 #include "CobFile.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <memory>
+
 #include "System/Misc/TracyDefs.h"
 #include "Lua/LuaUI.h"
 
 CR_BIND(CCobEngine, )
 
 CR_REG_METADATA(CCobEngine, (
-	CR_MEMBER(threadInstances),
+	CR_MEMBER(threadSlab),
+	CR_MEMBER(freeThreadSlots),
+	CR_MEMBER(threadSlots),
 	CR_MEMBER(tickAddedThreads),
 	CR_MEMBER(tickRemovedThreads),
 	CR_MEMBER(runningThreadIDs),
-	CR_MEMBER(sleepingThreadIDs),
+	CR_MEMBER(sleepWheel),
+	CR_MEMBER(sleepWheelTime),
 	// always null/empty when saving
 	CR_IGNORED(waitingThreadIDs),
+	CR_IGNORED(wokenThreads),
 
 	CR_IGNORED(curThread),
 	CR_IGNORED(deferredCallins),
@@ -32,7 +39,8 @@ CR_REG_METADATA(CCobEngine, (
 CR_BIND(CCobEngine::SleepingThread, )
 CR_REG_METADATA(CCobEngine::SleepingThread, (
 	CR_MEMBER(id),
-	CR_MEMBER(wt)
+	CR_MEMBER(wt),
+	CR_MEMBER(slot)
 ))
 
 static const char* const numCobThreadsPlot = "CobThreads";
@@ -44,28 +52,50 @@ int CCobEngine::AddThread(CCobThread&& thread)
 		thread.SetID(GenThreadID());
 
 	CCobInstance* o = thread.cobInst;
-	CCobThread& t = threadInstances[thread.GetID()];
+
+	int slot = threadSlab.size();
+
+	if (!freeThreadSlots.empty()) {
+		slot = freeThreadSlots.back();
+		freeThreadSlots.pop_back();
+	} else {
+		threadSlab.emplace_back();
+	}
+
+	CCobThread& t = threadSlab[slot];
 
 	// move thread into registry, hand its ID to owner
 	t = std::move(thread);
+	t.SetSlabIndex(slot);
 	o->AddThreadID(t.GetID());
 
-	TracyPlot(numCobThreadsPlot, static_cast<int64_t>(threadInstances.size()));
+	threadSlots[t.GetID()] = slot;
+
+	TracyPlot(numCobThreadsPlot, static_cast<int64_t>(threadSlots.size()));
 
 	return (t.GetID());
 }
 
 bool CCobEngine::RemoveThread(int threadID) {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const auto it = threadInstances.find(threadID);
+	const auto it = threadSlots.find(threadID);
 
-	if (it != threadInstances.end()) {
-		threadInstances.erase(it);
-		TracyPlot(numCobThreadsPlot, static_cast<int64_t>(threadInstances.size()));
-		return true;
-	}
+	if (it == threadSlots.end())
+		return false;
+
+	const int slot = it->second;
+
+	// unregister first, the dtor's callbacks must not find a half-dead thread
+	// and the slot may only be recycled once they are done
+	threadSlots.erase(it);
+
+	std::destroy_at(&threadSlab[slot]);
+	std::construct_at(&threadSlab[slot]);
+
+	freeThreadSlots.push_back(slot);
 
-	return false;
+	TracyPlot(numCobThreadsPlot, static_cast<int64_t>(threadSlots.size()));
+	return true;
 }
 
 void CCobEngine::ProcessQueuedThreads() {
@@ -78,9 +108,9 @@ void CCobEngine::ProcessQueuedThreads() {
 	}
 	tickRemovedThreads.clear();
 
-	// move new threads spawned by START into threadInstances;
+	// move new threads spawned by START into threadSlab;
 	// their ID's will already have been scheduled into either
-	// waitingThreadIDs or sleepingThreadIDs
+	// waitingThreadIDs or sleepWheel
 	for (CCobThread& t: tickAddedThreads) {
 		AddThread(std::move(t));
 	}
@@ -97,7 +127,10 @@ void CCobEngine::ScheduleThread(const CCobThread* thread)
 			waitingThreadIDs.push_back(thread->GetID());
 		} break;
 		case CCobThread::Sleep: {
-			sleepingThreadIDs.push(SleepingThread{thread->GetID(), thread->GetWakeTime()});
+			// a (bogus) wake-time in the past goes into the bucket due next
+			const int wheelTime = std::max(thread->GetWakeTime(), sleepWheelTime);
+
+			sleepWheel[wheelTime & SLEEP_WHEEL_MASK].push_back(SleepingThread{thread->GetID(), thread->GetWakeTime(), thread->GetSlabIndex()});
 		} break;
 		default: {
 			LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, thread->GetState(), thread->GetID());
@@ -110,8 +143,8 @@ void CCobEngine::SanityCheckThreads(const CCobInstance* owner)
 	RECOIL_DETAILED_TRACY_ZONE;
 	if (false) {
 		// no threads belonging to owner should be left
-		for (const auto& p: threadInstances) {
-			assert(p.second.cobInst != owner);
+		for (const CCobThread& t: threadSlab) {
+			assert(t.cobInst != owner);
 		}
 		for (const CCobThread& t: tickAddedThreads) {
 			assert(t.cobInst != owner);
@@ -136,43 +169,82 @@ void CCobEngine::TickThread(CCobThread* thread)
 void CCobEngine::WakeSleepingThreads()
 {
 	ZoneScoped;
-	// check on the sleeping threads, remove any whose owner died
-	while (!sleepingThreadIDs.empty()) {
-		CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
-
-		if (zzzThread == nullptr) {
-			sleepingThreadIDs.pop();
-			continue;
+	// wake every bucket up to the current time, in the same <wt, id> order a
+	// single priority-queue over all sleepers would yield
+	for (; sleepWheelTime < currentTime; sleepWheelTime++) {
+		std::vector<SleepingThread>& bucket = sleepWheel[sleepWheelTime & SLEEP_WHEEL_MASK];
+
+		// split off the due entries, keep those that are a lap (or more) ahead
+		const auto SplitDueThreads = [&](size_t i) {
+			size_t numSleeping = i;
+
+			for (; i < bucket.size(); i++) {
+				if (bucket[i].wt <= sleepWheelTime) {
+					wokenThreads.push_back(bucket[i]);
+				} else {
+					bucket[numSleeping++] = bucket[i];
+				}
+			}
+
+			bucket.resize(numSleeping);
+		};
+
+		wokenThreads.clear();
+		SplitDueThreads(0);
+		std::sort(wokenThreads.begin(), wokenThreads.end(), CCobThreadComp());
+
+		for (size_t i = 0; i < wokenThreads.size(); i++) {
+			const SleepingThread st = wokenThreads[i];
+			const size_t numSleeping = bucket.size();
+
+			CCobThread* zzzThread = GetThread(st.id, st.slot);
+
+			// thread owner died while it was sleeping
+			if (zzzThread == nullptr)
+				continue;
+
+			// wake up the thread and tick it (if not dead)
+			// this can quite possibly re-add the thread to <sleepWheel>
+			// again, but any thread is guaranteed to sleep for at least 1 tick
+			switch (zzzThread->GetState()) {
+				case CCobThread::Sleep: {
+					zzzThread->SetState(CCobThread::Run);
+					TickThread(zzzThread);
+				} break;
+				case CCobThread::Dead: {
+					RemoveThread(zzzThread->GetID());
+				} break;
+				default: {
+					LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, zzzThread->GetState(), zzzThread->GetID());
+				} break;
+			}
+
+			if (bucket.size() == numSleeping)
+				continue;
+
+			// unless it slept for a negative amount of time, which lands it in
+			// this bucket and has to be merged into what is left of the batch
+			SplitDueThreads(numSleeping);
+			std::sort(wokenThreads.begin() + i + 1, wokenThreads.end(), CCobThreadComp());
 		}
+	}
+}
 
-		// not yet time to execute this thread or any subsequent sleepers
-		if (zzzThread->GetWakeTime() >= currentTime)
-			break;
-
-		// remove executing thread from the queue
-		sleepingThreadIDs.pop();
-
-		// wake up the thread and tick it (if not dead)
-		// this can quite possibly re-add the thread to <sleepingThreadIDs>
-		// again, but any thread is guaranteed to sleep for at least 1 tick
-		switch (zzzThread->GetState()) {
-			case CCobThread::Sleep: {
-				zzzThread->SetState(CCobThread::Run);
-				TickThread(zzzThread);
-			} break;
-			case CCobThread::Dead: {
-				RemoveThread(zzzThread->GetID());
-			} break;
-			default: {
-				LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, zzzThread->GetState(), zzzThread->GetID());
-			} break;
-		}
+std::vector<CCobEngine::SleepingThread> CCobEngine::GetSleepingThreadIDs() const
+{
+	std::vector<SleepingThread> sleepingThreads;
+
+	for (const std::vector<SleepingThread>& bucket: sleepWheel) {
+		sleepingThreads.insert(sleepingThreads.end(), bucket.begin(), bucket.end());
 	}
+
+	std::sort(sleepingThreads.begin(), sleepingThreads.end(), CCobThreadComp());
+	return sleepingThreads;
 }
 
 void CCobEngine::TickRunningThreads()
 {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(COB);
 	// advance all currently running threads
 	for (const int threadID: runningThreadIDs) {
 		TickThread(GetThread(threadID));
@@ -190,7 +262,7 @@ void CCobEngine::TickRunningThreads()
 
 void CCobEngine::Tick(int deltaTime)
 {
-	ZoneScoped;
+	RECOIL_TRACY_ZONE(COB);
 	currentTime += deltaTime;
 
 	TickRunningThreads();
@@ -13,7 +13,7 @@
 #include "CobThread.h"
 #include "CobDeferredCallin.h"
 #include "System/creg/creg_cond.h"
-#include "System/creg/STL_Queue.h"
+#include "System/creg/STL_Deque.h"
 #include "System/creg/STL_Map.h"
 #include "System/Cpp11Compat.hpp"
 
@@ -32,24 +32,34 @@ public:
 
 		int id;
 		int wt;
+		// slab index at the time the thread went to sleep, -1 if it was not in the slab yet
+		int slot;
 	};
 
+	// wake-up order: earliest first, ties broken by thread ID
 	struct CCobThreadComp {
 	public:
 		bool operator() (const SleepingThread& a, const SleepingThread& b) const {
-			return a.wt > b.wt || (a.wt == b.wt && a.id > b.id);
+			return a.wt < b.wt || (a.wt == b.wt && a.id < b.id);
 		}
 	};
 
+	// one bucket per millisecond of wake-time; sleepers further ahead than this
+	// share a bucket with nearer ones and are simply skipped until they are due
+	static constexpr int SLEEP_WHEEL_SIZE = 4096;
+	static constexpr int SLEEP_WHEEL_MASK = SLEEP_WHEEL_SIZE - 1;
+
 public:
 	void Init() {
-		threadInstances.reserve(2048);
+		threadSlots.reserve(2048);
 		tickAddedThreads.reserve(128);
 
 		runningThreadIDs.reserve(512);
 		waitingThreadIDs.reserve(512);
 
-		sleepingThreadIDs = {};
+		sleepWheel.clear();
+		sleepWheel.resize(SLEEP_WHEEL_SIZE);
+		sleepWheelTime = 0;
 
 		curThread = nullptr;
 
@@ -57,18 +67,19 @@ public:
 		threadCounter = 0;
 	}
 	void Kill() {
-		// threadInstances is never explicitly iterated in the actual code,
+		// threadSlots is never explicitly iterated in the actual code,
 		// but iterated during sync dumps, so clean it with clear_unordered_map
-		spring::clear_unordered_map(threadInstances);
+		spring::clear_unordered_map(threadSlots);
 		spring::clear_unordered_map(deferredCallins);
+		threadSlab.clear();
+		freeThreadSlots.clear();
 		tickAddedThreads.clear();
 
 		runningThreadIDs.clear();
 		waitingThreadIDs.clear();
 
-		while (!sleepingThreadIDs.empty()) {
-			sleepingThreadIDs.pop();
-		}
+		sleepWheel.clear();
+		wokenThreads.clear();
 	}
 
 	void Tick(int deltaTime);
@@ -76,12 +87,19 @@ public:
 
 
 	CCobThread* GetThread(int threadID) {
-		const auto it = threadInstances.find(threadID);
+		const auto it = threadSlots.find(threadID);
 
-		if (it == threadInstances.end())
+		if (it == threadSlots.end())
 			return nullptr;
 
-		return &(it->second);
+		return &threadSlab[it->second];
+	}
+	// skips the lookup if <slot> still holds the thread
+	CCobThread* GetThread(int threadID, int slot) {
+		if (static_cast<size_t>(slot) < threadSlab.size() && threadSlab[slot].GetID() == threadID)
+			return &threadSlab[slot];
+
+		return (GetThread(threadID));
 	}
 
 	bool RemoveThread(int threadID);
@@ -95,12 +113,14 @@ public:
 	void ScheduleThread(const CCobThread* thread);
 	void SanityCheckThreads(const CCobInstance* owner);
 
-	const auto& GetThreadInstances() const { return threadInstances; }
+	const auto& GetThreadSlots() const { return threadSlots; }
+	const auto& GetThreadSlab() const { return threadSlab; }
 //	const auto& GetTickAddedThreads() const { return tickAddedThreads; }
 //	const auto& GetTickRemovedThreads() const { return tickRemovedThreads; }
 //	const auto& GetRunningThreadIDs() const { return runningThreadIDs; }
 	const auto& GetWaitingThreadIDs() const { return waitingThreadIDs; }
-	const auto& GetSleepingThreadIDs() const { return sleepingThreadIDs; }
+	// sorted in wake-up order, only meant for sync dumps
+	std::vector<SleepingThread> GetSleepingThreadIDs() const;
 	const auto  GetCurrTime() const { return currentTime; }
 	const auto  GetThreadCounter() const { return threadCounter; }
 	const auto  GetCurrCounter() const { return threadCounter; }
@@ -114,8 +134,12 @@ private:
 	void TickRunningThreads();
 
 private:
-	// registry of every thread across all script instances
-	spring::unordered_map<int, CCobThread> threadInstances;
+	// registry of every thread across all script instances; a deque so that
+	// threads never move while running, e.g. when RealCall adds new ones
+	std::deque<CCobThread> threadSlab;
+	std::vector<int> freeThreadSlots;
+	// thread ID -> index into threadSlab
+	spring::unordered_map<int, int> threadSlots;
 	// threads that are spawned during Tick
 	std::vector<CCobThread> tickAddedThreads;
 	// threads that are killed during Tick
@@ -126,9 +150,13 @@ private:
 
 	spring::unordered_map<int, std::vector<CCobDeferredCallin> > deferredCallins;
 
-	// stores <id, waketime> pairs s.t. after waking up the ID can be checked
-	// for validity; thread owner might get removed while a thread is sleeping
-	std::priority_queue<SleepingThread, std::vector<SleepingThread>, CCobThreadComp> sleepingThreadIDs;
+	// timer wheel of <id, waketime, slot> entries s.t. after waking up the ID can be
+	// checked for validity; thread owner might get removed while a thread is sleeping
+	std::vector<std::vector<SleepingThread>> sleepWheel;
+	// entries due during the bucket being woken, sorted like the old priority-queue
+	std::vector<SleepingThread> wokenThreads;
+	// every bucket before this time has been woken
+	int sleepWheelTime = 0;
 
 	CCobThread* curThread = nullptr;
 
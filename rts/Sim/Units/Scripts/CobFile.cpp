@@ -219,3 +219,122 @@ int CCobFile::GetFunctionId(const std::string& name)
 
 	return -1;
 }
+
+
+CCobFile::DecodedOp CCobFile::DecodeOp(int pc) const
+{
+	DecodedOp dop = {DOP_LEGACY, pc, 0, 0};
+	int numOperands = 0;
+
+	switch (code[pc]) {
+		case MOVE                : { dop.op = DOP_MOVE                ; numOperands = 2; } break;
+		case TURN                : { dop.op = DOP_TURN                ; numOperands = 2; } break;
+		case SPIN                : { dop.op = DOP_SPIN                ; numOperands = 2; } break;
+		case STOP_SPIN           : { dop.op = DOP_STOP_SPIN           ; numOperands = 2; } break;
+		case SHOW                : { dop.op = DOP_SHOW                ; numOperands = 1; } break;
+		case HIDE                : { dop.op = DOP_HIDE                ; numOperands = 1; } break;
+		case CACHE               : { dop.op = DOP_NOP                 ; numOperands = 1; } break;
+		case DONT_CACHE          : { dop.op = DOP_NOP                 ; numOperands = 1; } break;
+		case MOVE_NOW            : { dop.op = DOP_MOVE_NOW            ; numOperands = 2; } break;
+		case TURN_NOW            : { dop.op = DOP_TURN_NOW            ; numOperands = 2; } break;
+		case SHADE               : { dop.op = DOP_NOP                 ; numOperands = 1; } break;
+		case DONT_SHADE          : { dop.op = DOP_NOP                 ; numOperands = 1; } break;
+		case EMIT_SFX            : { dop.op = DOP_EMIT_SFX            ; numOperands = 1; } break;
+
+		case WAIT_TURN           : { dop.op = DOP_WAIT_TURN           ; numOperands = 2; } break;
+		case WAIT_MOVE           : { dop.op = DOP_WAIT_MOVE           ; numOperands = 2; } break;
+		case SLEEP               : { dop.op = DOP_SLEEP               ; numOperands = 0; } break;
+
+		case PUSH_CONSTANT       : { dop.op = DOP_PUSH_CONSTANT       ; numOperands = 1; } break;
+		case PUSH_LOCAL_VAR      : { dop.op = DOP_PUSH_LOCAL_VAR      ; numOperands = 1; } break;
+		case PUSH_STATIC         : { dop.op = DOP_PUSH_STATIC         ; numOperands = 1; } break;
+		case CREATE_LOCAL_VAR    : { dop.op = DOP_CREATE_LOCAL_VAR    ; numOperands = 0; } break;
+		case POP_LOCAL_VAR       : { dop.op = DOP_POP_LOCAL_VAR       ; numOperands = 1; } break;
+		case POP_STATIC          : { dop.op = DOP_POP_STATIC          ; numOperands = 1; } break;
+		case POP_STACK           : { dop.op = DOP_POP_STACK           ; numOperands = 0; } break;
+
+		case ADD                 : { dop.op = DOP_ADD                 ; numOperands = 0; } break;
+		case SUB                 : { dop.op = DOP_SUB                 ; numOperands = 0; } break;
+		case MUL                 : { dop.op = DOP_MUL                 ; numOperands = 0; } break;
+		case DIV                 : { dop.op = DOP_DIV                 ; numOperands = 0; } break;
+		case MOD                 : { dop.op = DOP_MOD                 ; numOperands = 0; } break;
+		case BITWISE_AND         : { dop.op = DOP_BITWISE_AND         ; numOperands = 0; } break;
+		case BITWISE_OR          : { dop.op = DOP_BITWISE_OR          ; numOperands = 0; } break;
+		case BITWISE_XOR         : { dop.op = DOP_BITWISE_XOR         ; numOperands = 0; } break;
+		case BITWISE_NOT         : { dop.op = DOP_BITWISE_NOT         ; numOperands = 0; } break;
+
+		case RAND                : { dop.op = DOP_RAND                ; numOperands = 0; } break;
+		case GET_UNIT_VALUE      : { dop.op = DOP_GET_UNIT_VALUE      ; numOperands = 0; } break;
+		case GET                 : { dop.op = DOP_GET                 ; numOperands = 0; } break;
+
+		case SET_LESS            : { dop.op = DOP_SET_LESS            ; numOperands = 0; } break;
+		case SET_LESS_OR_EQUAL   : { dop.op = DOP_SET_LESS_OR_EQUAL   ; numOperands = 0; } break;
+		case SET_GREATER         : { dop.op = DOP_SET_GREATER         ; numOperands = 0; } break;
+		case SET_GREATER_OR_EQUAL: { dop.op = DOP_SET_GREATER_OR_EQUAL; numOperands = 0; } break;
+		case SET_EQUAL           : { dop.op = DOP_SET_EQUAL           ; numOperands = 0; } break;
+		case SET_NOT_EQUAL       : { dop.op = DOP_SET_NOT_EQUAL       ; numOperands = 0; } break;
+		case LOGICAL_AND         : { dop.op = DOP_LOGICAL_AND         ; numOperands = 0; } break;
+		case LOGICAL_OR          : { dop.op = DOP_LOGICAL_OR          ; numOperands = 0; } break;
+		case LOGICAL_XOR         : { dop.op = DOP_LOGICAL_XOR         ; numOperands = 0; } break;
+		case LOGICAL_NOT         : { dop.op = DOP_LOGICAL_NOT         ; numOperands = 0; } break;
+
+		case START               : { dop.op = DOP_START               ; numOperands = 2; } break;
+		case CALL                : { dop.op = DOP_REAL_CALL           ; numOperands = 2; } break;
+		case REAL_CALL           : { dop.op = DOP_REAL_CALL           ; numOperands = 2; } break;
+		case LUA_CALL            : { dop.op = DOP_LUA_CALL            ; numOperands = 2; } break;
+		case BATCH_LUA           : { dop.op = DOP_BATCH_LUA           ; numOperands = 2; } break;
+		case JUMP                : { dop.op = DOP_JUMP                ; numOperands = 1; } break;
+		case RETURN              : { dop.op = DOP_RETURN              ; numOperands = 0; } break;
+		case JUMP_NOT_EQUAL      : { dop.op = DOP_JUMP_NOT_EQUAL      ; numOperands = 1; } break;
+		case SIGNAL              : { dop.op = DOP_SIGNAL              ; numOperands = 0; } break;
+		case SET_SIGNAL_MASK     : { dop.op = DOP_SET_SIGNAL_MASK     ; numOperands = 0; } break;
+
+		case EXPLODE             : { dop.op = DOP_EXPLODE             ; numOperands = 1; } break;
+		case PLAY_SOUND          : { dop.op = DOP_PLAY_SOUND          ; numOperands = 1; } break;
+
+		case SET                 : { dop.op = DOP_SET                 ; numOperands = 0; } break;
+		case ATTACH              : { dop.op = DOP_ATTACH              ; numOperands = 0; } break;
+		case DROP                : { dop.op = DOP_DROP                ; numOperands = 0; } break;
+
+		// SIGNATURE_LUA and unknown opcodes are reported by the legacy interpreter
+		default: {
+			return dop;
+		} break;
+	}
+
+	// operands running off the end of the code would throw from code.at()
+	if ((pc + numOperands) >= static_cast<int>(code.size())) {
+		dop.op = DOP_LEGACY;
+		return dop;
+	}
+
+	dop.next = pc + 1 + numOperands;
+	dop.a = (numOperands > 0)? code[pc + 1]: 0;
+	dop.b = (numOperands > 1)? code[pc + 2]: 0;
+
+	if (code[pc] != CALL && code[pc] != REAL_CALL)
+		return dop;
+
+	// leave calls to nonexistent scripts to the legacy interpreter, whatever it makes of them
+	if (static_cast<size_t>(dop.a) >= scriptNames.size()) {
+		dop = {DOP_LEGACY, pc, 0, 0};
+		return dop;
+	}
+
+	// CALL is otherwise rewritten in-place by the interpreter on first execution
+	if (code[pc] == CALL && scriptNames[dop.a].find("lua_") == 0)
+		dop.op = DOP_LUA_CALL;
+
+	return dop;
+}
+
+void CCobFile::Predecode()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	decodedCode.clear();
+	decodedCode.reserve(code.size());
+
+	for (int pc = 0, n = static_cast<int>(code.size()); pc < n; pc++) {
+		decodedCode.push_back(DecodeOp(pc));
+	}
+}
@@ -15,6 +15,89 @@ class CFileHandler;
 
 class CCobFile
 {
+public:
+	// dense handler indices for the pre-decoded instruction stream used by CCobThread::Tick
+	enum DecodedOpCode {
+		DOP_LEGACY = 0, // executed by the raw-opcode interpreter (unknown opcode, truncated operands, ...)
+
+		DOP_MOVE,
+		DOP_TURN,
+		DOP_SPIN,
+		DOP_STOP_SPIN,
+		DOP_SHOW,
+		DOP_HIDE,
+		DOP_NOP, // SHADE, DONT_SHADE, CACHE, DONT_CACHE
+		DOP_MOVE_NOW,
+		DOP_TURN_NOW,
+		DOP_EMIT_SFX,
+
+		DOP_WAIT_TURN,
+		DOP_WAIT_MOVE,
+		DOP_SLEEP,
+
+		DOP_PUSH_CONSTANT,
+		DOP_PUSH_LOCAL_VAR,
+		DOP_PUSH_STATIC,
+		DOP_CREATE_LOCAL_VAR,
+		DOP_POP_LOCAL_VAR,
+		DOP_POP_STATIC,
+		DOP_POP_STACK,
+
+		DOP_ADD,
+		DOP_SUB,
+		DOP_MUL,
+		DOP_DIV,
+		DOP_MOD,
+		DOP_BITWISE_AND,
+		DOP_BITWISE_OR,
+		DOP_BITWISE_XOR,
+		DOP_BITWISE_NOT,
+
+		DOP_RAND,
+		DOP_GET_UNIT_VALUE,
+		DOP_GET,
+
+		DOP_SET_LESS,
+		DOP_SET_LESS_OR_EQUAL,
+		DOP_SET_GREATER,
+		DOP_SET_GREATER_OR_EQUAL,
+		DOP_SET_EQUAL,
+		DOP_SET_NOT_EQUAL,
+		DOP_LOGICAL_AND,
+		DOP_LOGICAL_OR,
+		DOP_LOGICAL_XOR,
+		DOP_LOGICAL_NOT,
+
+		DOP_START,
+		DOP_REAL_CALL, // also CALL, resolved at load-time
+		DOP_LUA_CALL,  // also CALL to a lua_ script
+		DOP_BATCH_LUA,
+		DOP_JUMP,
+		DOP_RETURN,
+		DOP_JUMP_NOT_EQUAL,
+		DOP_SIGNAL,
+		DOP_SET_SIGNAL_MASK,
+
+		DOP_EXPLODE,
+		DOP_PLAY_SOUND,
+
+		DOP_SET,
+		DOP_ATTACH,
+		DOP_DROP,
+
+		DOP_COUNT
+	};
+
+	// One entry per code word, as if an instruction started there, so <pc> (and everything
+	// derived from it: jump targets, return addresses, script offsets, saved games) keeps
+	// indexing both arrays the same way and jumps need no translation.
+	struct DecodedOp {
+		int op;   // DecodedOpCode
+		int next; // pc after the opcode and its operands
+		int a;    // first operand, or 0
+		int b;    // second operand, or 0
+	};
+
 public:
 	CCobFile(CFileHandler& in, const std::string& scriptName);
 	CCobFile(CCobFile&& f) { *this = std::move(f); }
@@ -23,6 +106,7 @@ public:
 		numStaticVars = f.numStaticVars;
 
 		code = std::move(f.code);
+		decodedCode = std::move(f.decodedCode);
 		scriptNames = std::move(f.scriptNames);
 		scriptOffsets = std::move(f.scriptOffsets);
 
@@ -39,10 +123,24 @@ public:
 
 	int GetFunctionId(const std::string& name);
 
+	// translates <code> into <decodedCode>, called by CCobFileHandler once a file is loaded
+	void Predecode();
+	DecodedOp DecodeOp(int pc) const;
+
+	const DecodedOp& GetDecodedOp(int pc) const {
+		static const DecodedOp legacyOp = {DOP_LEGACY, 0, 0, 0};
+
+		if (static_cast<size_t>(pc) >= decodedCode.size())
+			return legacyOp;
+
+		return decodedCode[pc];
+	}
+
 public:
 	int numStaticVars = 0;
 
 	std::vector<int> code;
+	std::vector<DecodedOp> decodedCode;
 	std::vector<std::string> scriptNames;
 	std::vector<int> scriptOffsets;
 	/// Assumes that the scripts are sorted by offset in the file
@@ -18,6 +18,7 @@ CCobFile* CCobFileHandler::GetCobFile(const std::string& name)
 
 	cobFileHandles[name] = cobFileObjects.size();
 	cobFileObjects.emplace_back(CCobFile(f, name));
+	cobFileObjects.back().Predecode();
 
 	return &cobFileObjects[cobFileObjects.size() - 1];
 }
@@ -35,6 +36,7 @@ CCobFile* CCobFileHandler::ReloadCobFile(const std::string& name)
 	assert(f.FileExists());
 
 	cobFileObjects[it->second] = CCobFile(f, name);
+	cobFileObjects[it->second].Predecode();
 	return &cobFileObjects[it->second];
 }
 
@@ -542,7 +542,7 @@ void CCobInstance::EndBurst(int weaponNum) { ZoneScoped; Call(COBFN_EndBurst + C
  */
 int CCobInstance::RealCall(int functionId, std::array<int, 1 + MAX_COB_ARGS>& args, ThreadCallbackType cb, int cbParam, int* retCode)
 {
-	RECOIL_DETAILED_TRACY_ZONE;
+	RECOIL_TRACY_ZONE(COB);
 	int ret = -1;
 
 	if (size_t(functionId) >= cobFile->scriptNames.size()) {
@@ -20,6 +20,7 @@ CR_REG_METADATA(CCobThread, (
 	CR_IGNORED(cobFile),
 
 	CR_MEMBER(id),
+	CR_MEMBER(slabIndex),
 	CR_MEMBER(pc),
 
 	CR_MEMBER(wakeTime),
@@ -91,6 +92,7 @@ CCobThread::~CCobThread()
 
 CCobThread& CCobThread::operator = (CCobThread&& t) {
 	id = t.id;
+	slabIndex = t.slabIndex;
 	pc = t.pc;
 
 	wakeTime = t.wakeTime;
@@ -118,6 +120,7 @@ CCobThread& CCobThread::operator = (CCobThread&& t) {
 
 CCobThread& CCobThread::operator = (const CCobThread& t) {
 	id = t.id;
+	slabIndex = t.slabIndex;
 	pc = t.pc;
 
 	wakeTime = t.wakeTime;
@@ -234,6 +237,23 @@ void CCobThread::InitStack(unsigned int n, CCobThread* t)
 #define GET_LONG_PC() (cobFile->code.at(pc++))
 #endif
 
+#if defined(__GNUC__)
+	// labels-as-values, every handler jumps straight to the next one
+	#define COB_THREADED_DISPATCH
+#endif
+
+#ifndef NDEBUG
+// the decoded stream has to read exactly what the raw interpreter would
+static bool CheckDecodedOp(const CCobFile* cobFile, int pc, const CCobFile::DecodedOp& op)
+{
+	if (op.op == CCobFile::DOP_LEGACY)
+		return true;
+
+	const CCobFile::DecodedOp raw = cobFile->DecodeOp(pc);
+	return (raw.op == op.op && raw.next == op.next && raw.a == op.a && raw.b == op.b);
+}
+#endif
+
 bool CCobThread::Tick()
 {
 	assert(state != Sleep);
@@ -246,492 +266,1041 @@ bool CCobThread::Tick()
 
 	state = Run;
 
-	int r1, r2, r3, r4, r5, r6;
-
-	while (state == Run) {
-		const int opcode = GET_LONG_PC();
-
-		switch (opcode) {
-			case PUSH_CONSTANT: {
-				r1 = GET_LONG_PC();
-				PushDataStack(r1);
-			} break;
-			case SLEEP: {
-				r1 = PopDataStack();
-				wakeTime = cobEngine->GetCurrTime() + r1;
-				state = Sleep;
-
-				cobEngine->ScheduleThread(this);
-				return true;
-			} break;
-			case SPIN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
-				r3 = PopDataStack();         // speed
-				r4 = PopDataStack();         // accel
-				cobInst->Spin(r1, r2, r3, r4);
-			} break;
-			case STOP_SPIN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
-				r3 = PopDataStack();         // decel
-
-				cobInst->StopSpin(r1, r2, r3);
-			} break;
-			case RETURN: {
-				retCode = PopDataStack();
-
-				if (LocalReturnAddr() == -1) {
-					state = Dead;
-
-					// leave values intact on stack in case caller wants to check them
-					// callStackSize -= 1;
-					return false;
-				}
-
-				// return to caller
-				pc = LocalReturnAddr();
-				if (dataStack.size() > LocalStackFrame())
-					dataStack.resize(LocalStackFrame());
-
-				callStack.pop_back();
-			} break;
-
-
-			case SHADE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case DONT_SHADE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case CACHE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case DONT_CACHE: {
-				r1 = GET_LONG_PC();
-			} break;
-
-			case SIGNATURE_LUA: {
-				LOG_L(L_ERROR, "BAD ACCESS: Entered a lua method reference.");
-				state = Dead;
-				return false;
-			} break;
-
-			case BATCH_LUA: {
-				DeferredCall(false);
-			} break;
-
-			case CALL: {
-				r1 = GET_LONG_PC();
-				pc--;
-
-				if (cobFile->scriptNames[r1].find("lua_") == 0) {
-					cobFile->code[pc - 1] = LUA_CALL;
-					LuaCall();
-					break;
-				}
-
-				cobFile->code[pc - 1] = REAL_CALL;
+	const CCobFile::DecodedOp* op = nullptr;
 
-				// fall-through
-			}
-			case REAL_CALL: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+	int r1, r2, r3, r4, r5, r6;
 
-				// do not call zero-length functions
-				if (cobFile->scriptLengths[r1] == 0)
-					break;
+	// handler bodies mirror StepLegacy, with operands already fetched and pc already advanced
+	#ifdef COB_THREADED_DISPATCH
+	static void* const dispatchTable[CCobFile::DOP_COUNT] = {
+		&&DOP_LEGACY,
+
+		&&DOP_MOVE,
+		&&DOP_TURN,
+		&&DOP_SPIN,
+		&&DOP_STOP_SPIN,
+		&&DOP_SHOW,
+		&&DOP_HIDE,
+		&&DOP_NOP,
+		&&DOP_MOVE_NOW,
+		&&DOP_TURN_NOW,
+		&&DOP_EMIT_SFX,
+
+		&&DOP_WAIT_TURN,
+		&&DOP_WAIT_MOVE,
+		&&DOP_SLEEP,
+
+		&&DOP_PUSH_CONSTANT,
+		&&DOP_PUSH_LOCAL_VAR,
+		&&DOP_PUSH_STATIC,
+		&&DOP_CREATE_LOCAL_VAR,
+		&&DOP_POP_LOCAL_VAR,
+		&&DOP_POP_STATIC,
+		&&DOP_POP_STACK,
+
+		&&DOP_ADD,
+		&&DOP_SUB,
+		&&DOP_MUL,
+		&&DOP_DIV,
+		&&DOP_MOD,
+		&&DOP_BITWISE_AND,
+		&&DOP_BITWISE_OR,
+		&&DOP_BITWISE_XOR,
+		&&DOP_BITWISE_NOT,
+
+		&&DOP_RAND,
+		&&DOP_GET_UNIT_VALUE,
+		&&DOP_GET,
+
+		&&DOP_SET_LESS,
+		&&DOP_SET_LESS_OR_EQUAL,
+		&&DOP_SET_GREATER,
+		&&DOP_SET_GREATER_OR_EQUAL,
+		&&DOP_SET_EQUAL,
+		&&DOP_SET_NOT_EQUAL,
+		&&DOP_LOGICAL_AND,
+		&&DOP_LOGICAL_OR,
+		&&DOP_LOGICAL_XOR,
+		&&DOP_LOGICAL_NOT,
+
+		&&DOP_START,
+		&&DOP_REAL_CALL,
+		&&DOP_LUA_CALL,
+		&&DOP_BATCH_LUA,
+		&&DOP_JUMP,
+		&&DOP_RETURN,
+		&&DOP_JUMP_NOT_EQUAL,
+		&&DOP_SIGNAL,
+		&&DOP_SET_SIGNAL_MASK,
+
+		&&DOP_EXPLODE,
+		&&DOP_PLAY_SOUND,
+
+		&&DOP_SET,
+		&&DOP_ATTACH,
+		&&DOP_DROP,
+	};
+
+	#define COB_OP(name) name:
+	#define COB_NEXT()                                             \
+		do {                                                       \
+			if (state != Run)                                      \
+				goto finished;                                     \
+			op = &cobFile->GetDecodedOp(pc);                       \
+			assert(CheckDecodedOp(cobFile, pc, *op));              \
+			goto *dispatchTable[op->op];                           \
+		} while (false)
+
+	COB_NEXT();
+	#else
+	#define COB_OP(name) case CCobFile::name:
+	#define COB_NEXT() break
 
-				CallInfo& ci = PushCallStackRef();
-				ci.functionId = r1;
-				ci.returnAddr = pc;
-				ci.stackTop = dataStack.size() - r2;
+	while (state == Run) {
+		op = &cobFile->GetDecodedOp(pc);
+		assert(CheckDecodedOp(cobFile, pc, *op));
 
-				paramCount = r2;
+		switch (op->op) {
+	#endif
 
-				// call cobFile->scriptNames[r1]
-				pc = cobFile->scriptOffsets[r1];
-			} break;
-			case LUA_CALL: {
-				LuaCall();
-			} break;
+	COB_OP(DOP_LEGACY) {
+		switch (StepLegacy()) {
+			case StepYield: { return true ; } break;
+			case StepDead : { return false; } break;
+			default       : {               } break;
+		}
+	} COB_NEXT();
+
+	COB_OP(DOP_PUSH_CONSTANT) {
+		pc = op->next;
+		PushDataStack(op->a);
+	} COB_NEXT();
+	COB_OP(DOP_SLEEP) {
+		pc = op->next;
+		r1 = PopDataStack();
+		wakeTime = cobEngine->GetCurrTime() + r1;
+		state = Sleep;
 
+		cobEngine->ScheduleThread(this);
+		return true;
+	} COB_NEXT();
+	COB_OP(DOP_SPIN) {
+		pc = op->next;
+		r3 = PopDataStack();         // speed
+		r4 = PopDataStack();         // accel
+		cobInst->Spin(op->a, op->b, r3, r4);
+	} COB_NEXT();
+	COB_OP(DOP_STOP_SPIN) {
+		pc = op->next;
+		r3 = PopDataStack();         // decel
+		cobInst->StopSpin(op->a, op->b, r3);
+	} COB_NEXT();
+	COB_OP(DOP_RETURN) {
+		pc = op->next;
+		retCode = PopDataStack();
+
+		if (LocalReturnAddr() == -1) {
+			state = Dead;
+
+			// leave values intact on stack in case caller wants to check them
+			return false;
+		}
 
-			case POP_STATIC: {
-				r1 = GET_LONG_PC();
-				r2 = PopDataStack();
+		// return to caller
+		pc = LocalReturnAddr();
+		if (dataStack.size() > LocalStackFrame())
+			dataStack.resize(LocalStackFrame());
 
-				if (static_cast<size_t>(r1) < cobInst->staticVars.size())
-					cobInst->staticVars[r1] = r2;
-			} break;
-			case POP_STACK: {
-				PopDataStack();
-			} break;
+		callStack.pop_back();
+	} COB_NEXT();
 
+	// SHADE, DONT_SHADE, CACHE, DONT_CACHE
+	COB_OP(DOP_NOP) {
+		pc = op->next;
+	} COB_NEXT();
 
-			case START: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+	COB_OP(DOP_BATCH_LUA) {
+		pc = op->next;
+		DeferredCall(op->a, op->b, false);
+	} COB_NEXT();
 
-				if (cobFile->scriptLengths[r1] == 0)
-					break;
+	COB_OP(DOP_REAL_CALL) {
+		pc = op->next;
 
+		// do not call zero-length functions
+		if (cobFile->scriptLengths[op->a] != 0) {
+			CallInfo& ci = PushCallStackRef();
+			ci.functionId = op->a;
+			ci.returnAddr = pc;
+			ci.stackTop = dataStack.size() - op->b;
 
-				CCobThread t(cobInst);
+			paramCount = op->b;
 
-				t.SetID(cobEngine->GenThreadID());
-				t.InitStack(r2, this);
-				t.Start(r1, signalMask, {{0}}, true);
+			// call cobFile->scriptNames[op->a]
+			pc = cobFile->scriptOffsets[op->a];
+		}
+	} COB_NEXT();
+	COB_OP(DOP_LUA_CALL) {
+		pc = op->next;
+		LuaCall(op->a, op->b);
+	} COB_NEXT();
+
+	COB_OP(DOP_POP_STATIC) {
+		pc = op->next;
+		r2 = PopDataStack();
+
+		if (static_cast<size_t>(op->a) < cobInst->staticVars.size())
+			cobInst->staticVars[op->a] = r2;
+	} COB_NEXT();
+	COB_OP(DOP_POP_STACK) {
+		pc = op->next;
+		PopDataStack();
+	} COB_NEXT();
+
+	COB_OP(DOP_START) {
+		pc = op->next;
+
+		if (cobFile->scriptLengths[op->a] != 0) {
+			CCobThread t(cobInst);
+
+			t.SetID(cobEngine->GenThreadID());
+			t.InitStack(op->b, this);
+			t.Start(op->a, signalMask, {{0}}, true);
+
+			// calling AddThread directly might move <this>, defer it
+			cobEngine->QueueAddThread(std::move(t));
+		}
+	} COB_NEXT();
 
-				// calling AddThread directly might move <this>, defer it
-				cobEngine->QueueAddThread(std::move(t));
-			} break;
-
-			case CREATE_LOCAL_VAR: {
-				if (paramCount == 0) {
-					PushDataStack(0);
-				} else {
-					paramCount--;
-				}
-			} break;
-			case GET_UNIT_VALUE: {
-				r1 = PopDataStack();
-				if ((r1 >= LUA0) && (r1 <= LUA9)) {
-					PushDataStack(luaArgs[r1 - LUA0]);
-					break;
-				}
-				r1 = cobInst->GetUnitVal(r1, 0, 0, 0, 0);
-				PushDataStack(r1);
-			} break;
+	COB_OP(DOP_CREATE_LOCAL_VAR) {
+		pc = op->next;
 
+		if (paramCount == 0) {
+			PushDataStack(0);
+		} else {
+			paramCount--;
+		}
+	} COB_NEXT();
+	COB_OP(DOP_GET_UNIT_VALUE) {
+		pc = op->next;
+		r1 = PopDataStack();
+
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			PushDataStack(luaArgs[r1 - LUA0]);
+		} else {
+			PushDataStack(cobInst->GetUnitVal(r1, 0, 0, 0, 0));
+		}
+	} COB_NEXT();
+
+	COB_OP(DOP_JUMP_NOT_EQUAL) {
+		pc = op->next;
+
+		if (PopDataStack() == 0)
+			pc = op->a;
+	} COB_NEXT();
+	COB_OP(DOP_JUMP) {
+		pc = op->a;
+	} COB_NEXT();
+
+	COB_OP(DOP_POP_LOCAL_VAR) {
+		pc = op->next;
+		r2 = PopDataStack();
+		dataStack[LocalStackFrame() + op->a] = r2;
+	} COB_NEXT();
+	COB_OP(DOP_PUSH_LOCAL_VAR) {
+		pc = op->next;
+		r2 = dataStack[LocalStackFrame() + op->a];
+		PushDataStack(r2);
+	} COB_NEXT();
+
+	COB_OP(DOP_BITWISE_AND) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 & r2);
+	} COB_NEXT();
+	COB_OP(DOP_BITWISE_OR) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 | r2);
+	} COB_NEXT();
+	COB_OP(DOP_BITWISE_XOR) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 ^ r2);
+	} COB_NEXT();
+	COB_OP(DOP_BITWISE_NOT) {
+		pc = op->next;
+		r1 = PopDataStack();
+		PushDataStack(~r1);
+	} COB_NEXT();
+
+	COB_OP(DOP_EXPLODE) {
+		pc = op->next;
+		r2 = PopDataStack();
+		cobInst->Explode(op->a, r2);
+	} COB_NEXT();
+
+	COB_OP(DOP_PLAY_SOUND) {
+		pc = op->next;
+		r2 = PopDataStack();
+		cobInst->PlayUnitSound(op->a, r2);
+	} COB_NEXT();
+
+	COB_OP(DOP_PUSH_STATIC) {
+		pc = op->next;
+
+		if (static_cast<size_t>(op->a) < cobInst->staticVars.size())
+			PushDataStack(cobInst->staticVars[op->a]);
+	} COB_NEXT();
+
+	COB_OP(DOP_SET_NOT_EQUAL) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 != r2));
+	} COB_NEXT();
+	COB_OP(DOP_SET_EQUAL) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 == r2));
+	} COB_NEXT();
+
+	COB_OP(DOP_SET_LESS) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 < r2));
+	} COB_NEXT();
+	COB_OP(DOP_SET_LESS_OR_EQUAL) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 <= r2));
+	} COB_NEXT();
+
+	COB_OP(DOP_SET_GREATER) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 > r2));
+	} COB_NEXT();
+	COB_OP(DOP_SET_GREATER_OR_EQUAL) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(int(r1 >= r2));
+	} COB_NEXT();
+
+	COB_OP(DOP_RAND) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
+		PushDataStack(r3);
+	} COB_NEXT();
+	COB_OP(DOP_EMIT_SFX) {
+		pc = op->next;
+		r1 = PopDataStack();
+		cobInst->EmitSfx(r1, op->a);
+	} COB_NEXT();
+	COB_OP(DOP_MUL) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(r1 * r2);
+	} COB_NEXT();
+
+	COB_OP(DOP_SIGNAL) {
+		pc = op->next;
+		r1 = PopDataStack();
+		cobInst->Signal(r1);
+	} COB_NEXT();
+	COB_OP(DOP_SET_SIGNAL_MASK) {
+		pc = op->next;
+		signalMask = PopDataStack();
+	} COB_NEXT();
+
+	COB_OP(DOP_TURN) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		cobInst->Turn(op->a, op->b, r1, r2);
+	} COB_NEXT();
+	COB_OP(DOP_GET) {
+		pc = op->next;
+		r5 = PopDataStack();
+		r4 = PopDataStack();
+		r3 = PopDataStack();
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			PushDataStack(luaArgs[r1 - LUA0]);
+		} else {
+			r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
+			PushDataStack(r6);
+		}
+	} COB_NEXT();
+	COB_OP(DOP_ADD) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(r1 + r2);
+	} COB_NEXT();
+	COB_OP(DOP_SUB) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		PushDataStack(r1 - r2);
+	} COB_NEXT();
+
+	COB_OP(DOP_DIV) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (r2 != 0) {
+			r3 = r1 / r2;
+		} else {
+			r3 = 1000; // infinity!
+			ShowError("division by zero");
+		}
+		PushDataStack(r3);
+	} COB_NEXT();
+	COB_OP(DOP_MOD) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+
+		if (r2 != 0) {
+			PushDataStack(r1 % r2);
+		} else {
+			PushDataStack(0);
+			ShowError("modulo division by zero");
+		}
+	} COB_NEXT();
+
+	COB_OP(DOP_MOVE) {
+		pc = op->next;
+		r4 = PopDataStack();
+		r3 = PopDataStack();
+		cobInst->Move(op->a, op->b, r3, r4);
+	} COB_NEXT();
+	COB_OP(DOP_MOVE_NOW) {
+		pc = op->next;
+		r3 = PopDataStack();
+		cobInst->MoveNow(op->a, op->b, r3);
+	} COB_NEXT();
+	COB_OP(DOP_TURN_NOW) {
+		pc = op->next;
+		r3 = PopDataStack();
+		cobInst->TurnNow(op->a, op->b, r3);
+	} COB_NEXT();
+
+	COB_OP(DOP_WAIT_TURN) {
+		pc = op->next;
+
+		if (cobInst->NeedsWait(CCobInstance::ATurn, op->a, op->b)) {
+			state = WaitTurn;
+			waitPiece = op->a;
+			waitAxis = op->b;
+			return true;
+		}
+	} COB_NEXT();
+	COB_OP(DOP_WAIT_MOVE) {
+		pc = op->next;
+
+		if (cobInst->NeedsWait(CCobInstance::AMove, op->a, op->b)) {
+			state = WaitMove;
+			waitPiece = op->a;
+			waitAxis = op->b;
+			return true;
+		}
+	} COB_NEXT();
 
-			case JUMP_NOT_EQUAL: {
-				r1 = GET_LONG_PC();
-				r2 = PopDataStack();
+	COB_OP(DOP_SET) {
+		pc = op->next;
+		r2 = PopDataStack();
+		r1 = PopDataStack();
 
-				if (r2 == 0)
-					pc = r1;
+		if ((r1 >= LUA0) && (r1 <= LUA9)) {
+			luaArgs[r1 - LUA0] = r2;
+		} else {
+			cobInst->SetUnitVal(r1, r2);
+		}
+	} COB_NEXT();
+
+	COB_OP(DOP_ATTACH) {
+		pc = op->next;
+		r3 = PopDataStack();
+		r2 = PopDataStack();
+		r1 = PopDataStack();
+		cobInst->AttachUnit(r2, r1);
+	} COB_NEXT();
+	COB_OP(DOP_DROP) {
+		pc = op->next;
+		r1 = PopDataStack();
+		cobInst->DropUnit(r1);
+	} COB_NEXT();
+
+	// like bitwise ops, but only on values 1 and 0
+	COB_OP(DOP_LOGICAL_NOT) {
+		pc = op->next;
+		r1 = PopDataStack();
+		PushDataStack(int(r1 == 0));
+	} COB_NEXT();
+	COB_OP(DOP_LOGICAL_AND) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 && r2));
+	} COB_NEXT();
+	COB_OP(DOP_LOGICAL_OR) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int(r1 || r2));
+	} COB_NEXT();
+	COB_OP(DOP_LOGICAL_XOR) {
+		pc = op->next;
+		r1 = PopDataStack();
+		r2 = PopDataStack();
+		PushDataStack(int((!!r1) ^ (!!r2)));
+	} COB_NEXT();
+
+	COB_OP(DOP_HIDE) {
+		pc = op->next;
+		cobInst->SetVisibility(op->a, false);
+	} COB_NEXT();
+	COB_OP(DOP_SHOW) {
+		pc = op->next;
+
+		int i;
+		for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
+			if (LocalFunctionID() == cobFile->scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i])
+				break;
+
+		// if true, we are in a Fire-script and should show a special flare effect
+		if (i < MAX_WEAPONS_PER_UNIT) {
+			cobInst->ShowFlare(op->a);
+		} else {
+			cobInst->SetVisibility(op->a, true);
+		}
+	} COB_NEXT();
 
+	#ifdef COB_THREADED_DISPATCH
+finished:
+	#else
+			default: {
+				assert(false);
 			} break;
-			case JUMP: {
-				r1 = GET_LONG_PC();
-				// this seem to be an error in the docs..
-				//r2 = cobFile->scriptOffsets[LocalFunctionID()] + r1;
-				pc = r1;
-			} break;
+		}
+	}
+	#endif
 
+	#undef COB_NEXT
+	#undef COB_OP
 
-			case POP_LOCAL_VAR: {
-				r1 = GET_LONG_PC();
-				r2 = PopDataStack();
-				dataStack[LocalStackFrame() + r1] = r2;
-			} break;
-			case PUSH_LOCAL_VAR: {
-				r1 = GET_LONG_PC();
-				r2 = dataStack[LocalStackFrame() + r1];
-				PushDataStack(r2);
-			} break;
+	// can arrive here as dead, through CCobInstance::Signal()
+	return (state != Dead);
+}
 
+CCobThread::LegacyStepResult CCobThread::StepLegacy()
+{
+	int r1, r2, r3, r4, r5, r6;
 
-			case BITWISE_AND: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
-				PushDataStack(r1 & r2);
-			} break;
-			case BITWISE_OR: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
-				PushDataStack(r1 | r2);
-			} break;
-			case BITWISE_XOR: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
-				PushDataStack(r1 ^ r2);
-			} break;
-			case BITWISE_NOT: {
-				r1 = PopDataStack();
-				PushDataStack(~r1);
-			} break;
+	const int opcode = GET_LONG_PC();
+
+	switch (opcode) {
+		case PUSH_CONSTANT: {
+			r1 = GET_LONG_PC();
+			PushDataStack(r1);
+		} break;
+		case SLEEP: {
+			r1 = PopDataStack();
+			wakeTime = cobEngine->GetCurrTime() + r1;
+			state = Sleep;
+
+			cobEngine->ScheduleThread(this);
+			return StepYield;
+		} break;
+		case SPIN: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+			r3 = PopDataStack();         // speed
+			r4 = PopDataStack();         // accel
+			cobInst->Spin(r1, r2, r3, r4);
+		} break;
+		case STOP_SPIN: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+			r3 = PopDataStack();         // decel
+
+			cobInst->StopSpin(r1, r2, r3);
+		} break;
+		case RETURN: {
+			retCode = PopDataStack();
+
+			if (LocalReturnAddr() == -1) {
+				state = Dead;
 
-			case EXPLODE: {
-				r1 = GET_LONG_PC();
-				r2 = PopDataStack();
-				cobInst->Explode(r1, r2);
-			} break;
+				// leave values intact on stack in case caller wants to check them
+				// callStackSize -= 1;
+				return StepDead;
+			}
 
-			case PLAY_SOUND: {
-				r1 = GET_LONG_PC();
-				r2 = PopDataStack();
-				cobInst->PlayUnitSound(r1, r2);
-			} break;
+			// return to caller
+			pc = LocalReturnAddr();
+			if (dataStack.size() > LocalStackFrame())
+				dataStack.resize(LocalStackFrame());
+
+			callStack.pop_back();
+		} break;
+
+
+		case SHADE: {
+			r1 = GET_LONG_PC();
+		} break;
+		case DONT_SHADE: {
+			r1 = GET_LONG_PC();
+		} break;
+		case CACHE: {
+			r1 = GET_LONG_PC();
+		} break;
+		case DONT_CACHE: {
+			r1 = GET_LONG_PC();
+		} break;
+
+		case SIGNATURE_LUA: {
+			LOG_L(L_ERROR, "BAD ACCESS: Entered a lua method reference.");
+			state = Dead;
+			return StepDead;
+		} break;
+
+		case BATCH_LUA: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+			DeferredCall(r1, r2, false);
+		} break;
+
+		case CALL: {
+			r1 = GET_LONG_PC();
+			pc--;
+
+			if (cobFile->scriptNames[r1].find("lua_") == 0) {
+				cobFile->code[pc - 1] = LUA_CALL;
 
-			case PUSH_STATIC: {
 				r1 = GET_LONG_PC();
+				r2 = GET_LONG_PC();
+				LuaCall(r1, r2);
+				break;
+			}
 
-				if (static_cast<size_t>(r1) < cobInst->staticVars.size())
-					PushDataStack(cobInst->staticVars[r1]);
-			} break;
+			cobFile->code[pc - 1] = REAL_CALL;
 
-			case SET_NOT_EQUAL: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
+			// fall-through
+		}
+		case REAL_CALL: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
 
-				PushDataStack(int(r1 != r2));
-			} break;
-			case SET_EQUAL: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
+			// do not call zero-length functions
+			if (cobFile->scriptLengths[r1] == 0)
+				break;
 
-				PushDataStack(int(r1 == r2));
-			} break;
+			CallInfo& ci = PushCallStackRef();
+			ci.functionId = r1;
+			ci.returnAddr = pc;
+			ci.stackTop = dataStack.size() - r2;
 
-			case SET_LESS: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
+			paramCount = r2;
 
-				PushDataStack(int(r1 < r2));
-			} break;
-			case SET_LESS_OR_EQUAL: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
+			// call cobFile->scriptNames[r1]
+			pc = cobFile->scriptOffsets[r1];
+		} break;
+		case LUA_CALL: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+			LuaCall(r1, r2);
+		} break;
 
-				PushDataStack(int(r1 <= r2));
-			} break;
 
-			case SET_GREATER: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
+		case POP_STATIC: {
+			r1 = GET_LONG_PC();
+			r2 = PopDataStack();
 
-				PushDataStack(int(r1 > r2));
-			} break;
-			case SET_GREATER_OR_EQUAL: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
+			if (static_cast<size_t>(r1) < cobInst->staticVars.size())
+				cobInst->staticVars[r1] = r2;
+		} break;
+		case POP_STACK: {
+			PopDataStack();
+		} break;
 
-				PushDataStack(int(r1 >= r2));
-			} break;
 
-			case RAND: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-				r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
-				PushDataStack(r3);
-			} break;
-			case EMIT_SFX: {
-				r1 = PopDataStack();
-				r2 = GET_LONG_PC();
-				cobInst->EmitSfx(r1, r2);
-			} break;
-			case MUL: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
-				PushDataStack(r1 * r2);
-			} break;
+		case START: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
 
+			if (cobFile->scriptLengths[r1] == 0)
+				break;
 
-			case SIGNAL: {
-				r1 = PopDataStack();
-				cobInst->Signal(r1);
-			} break;
-			case SET_SIGNAL_MASK: {
-				r1 = PopDataStack();
-				signalMask = r1;
-			} break;
 
+			CCobThread t(cobInst);
 
-			case TURN: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-				r3 = GET_LONG_PC(); // piece
-				r4 = GET_LONG_PC(); // axis
-
-				cobInst->Turn(r3, r4, r1, r2);
-			} break;
-			case GET: {
-				r5 = PopDataStack();
-				r4 = PopDataStack();
-				r3 = PopDataStack();
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-				if ((r1 >= LUA0) && (r1 <= LUA9)) {
-					PushDataStack(luaArgs[r1 - LUA0]);
-					break;
-				}
-				r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
-				PushDataStack(r6);
-			} break;
-			case ADD: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-				PushDataStack(r1 + r2);
-			} break;
-			case SUB: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-				r3 = r1 - r2;
-				PushDataStack(r3);
-			} break;
+			t.SetID(cobEngine->GenThreadID());
+			t.InitStack(r2, this);
+			t.Start(r1, signalMask, {{0}}, true);
 
-			case DIV: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-
-				if (r2 != 0) {
-					r3 = r1 / r2;
-				} else {
-					r3 = 1000; // infinity!
-					ShowError("division by zero");
-				}
-				PushDataStack(r3);
-			} break;
-			case MOD: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-
-				if (r2 != 0) {
-					PushDataStack(r1 % r2);
-				} else {
-					PushDataStack(0);
-					ShowError("modulo division by zero");
-				}
-			} break;
+			// calling AddThread directly might move <this>, defer it
+			cobEngine->QueueAddThread(std::move(t));
+		} break;
 
+		case CREATE_LOCAL_VAR: {
+			if (paramCount == 0) {
+				PushDataStack(0);
+			} else {
+				paramCount--;
+			}
+		} break;
+		case GET_UNIT_VALUE: {
+			r1 = PopDataStack();
+			if ((r1 >= LUA0) && (r1 <= LUA9)) {
+				PushDataStack(luaArgs[r1 - LUA0]);
+				break;
+			}
+			r1 = cobInst->GetUnitVal(r1, 0, 0, 0, 0);
+			PushDataStack(r1);
+		} break;
 
-			case MOVE: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
-				r4 = PopDataStack();
-				r3 = PopDataStack();
-				cobInst->Move(r1, r2, r3, r4);
-			} break;
-			case MOVE_NOW: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
-				r3 = PopDataStack();
-				cobInst->MoveNow(r1, r2, r3);
-			} break;
-			case TURN_NOW: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
-				r3 = PopDataStack();
-				cobInst->TurnNow(r1, r2, r3);
-			} break;
 
+		case JUMP_NOT_EQUAL: {
+			r1 = GET_LONG_PC();
+			r2 = PopDataStack();
 
-			case WAIT_TURN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			if (r2 == 0)
+				pc = r1;
 
-				if (cobInst->NeedsWait(CCobInstance::ATurn, r1, r2)) {
-					state = WaitTurn;
-					waitPiece = r1;
-					waitAxis = r2;
-					return true;
-				}
-			} break;
-			case WAIT_MOVE: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+		} break;
+		case JUMP: {
+			r1 = GET_LONG_PC();
+			// this seem to be an error in the docs..
+			//r2 = cobFile->scriptOffsets[LocalFunctionID()] + r1;
+			pc = r1;
+		} break;
+
+
+		case POP_LOCAL_VAR: {
+			r1 = GET_LONG_PC();
+			r2 = PopDataStack();
+			dataStack[LocalStackFrame() + r1] = r2;
+		} break;
+		case PUSH_LOCAL_VAR: {
+			r1 = GET_LONG_PC();
+			r2 = dataStack[LocalStackFrame() + r1];
+			PushDataStack(r2);
+		} break;
+
+
+		case BITWISE_AND: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+			PushDataStack(r1 & r2);
+		} break;
+		case BITWISE_OR: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+			PushDataStack(r1 | r2);
+		} break;
+		case BITWISE_XOR: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+			PushDataStack(r1 ^ r2);
+		} break;
+		case BITWISE_NOT: {
+			r1 = PopDataStack();
+			PushDataStack(~r1);
+		} break;
+
+		case EXPLODE: {
+			r1 = GET_LONG_PC();
+			r2 = PopDataStack();
+			cobInst->Explode(r1, r2);
+		} break;
+
+		case PLAY_SOUND: {
+			r1 = GET_LONG_PC();
+			r2 = PopDataStack();
+			cobInst->PlayUnitSound(r1, r2);
+		} break;
+
+		case PUSH_STATIC: {
+			r1 = GET_LONG_PC();
+
+			if (static_cast<size_t>(r1) < cobInst->staticVars.size())
+				PushDataStack(cobInst->staticVars[r1]);
+		} break;
+
+		case SET_NOT_EQUAL: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+
+			PushDataStack(int(r1 != r2));
+		} break;
+		case SET_EQUAL: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+
+			PushDataStack(int(r1 == r2));
+		} break;
+
+		case SET_LESS: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+
+			PushDataStack(int(r1 < r2));
+		} break;
+		case SET_LESS_OR_EQUAL: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+
+			PushDataStack(int(r1 <= r2));
+		} break;
+
+		case SET_GREATER: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+
+			PushDataStack(int(r1 > r2));
+		} break;
+		case SET_GREATER_OR_EQUAL: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+
+			PushDataStack(int(r1 >= r2));
+		} break;
+
+		case RAND: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+			r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
+			PushDataStack(r3);
+		} break;
+		case EMIT_SFX: {
+			r1 = PopDataStack();
+			r2 = GET_LONG_PC();
+			cobInst->EmitSfx(r1, r2);
+		} break;
+		case MUL: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+			PushDataStack(r1 * r2);
+		} break;
+
+
+		case SIGNAL: {
+			r1 = PopDataStack();
+			cobInst->Signal(r1);
+		} break;
+		case SET_SIGNAL_MASK: {
+			r1 = PopDataStack();
+			signalMask = r1;
+		} break;
+
+
+		case TURN: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+			r3 = GET_LONG_PC(); // piece
+			r4 = GET_LONG_PC(); // axis
+
+			cobInst->Turn(r3, r4, r1, r2);
+		} break;
+		case GET: {
+			r5 = PopDataStack();
+			r4 = PopDataStack();
+			r3 = PopDataStack();
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+			if ((r1 >= LUA0) && (r1 <= LUA9)) {
+				PushDataStack(luaArgs[r1 - LUA0]);
+				break;
+			}
+			r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
+			PushDataStack(r6);
+		} break;
+		case ADD: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+			PushDataStack(r1 + r2);
+		} break;
+		case SUB: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+			r3 = r1 - r2;
+			PushDataStack(r3);
+		} break;
+
+		case DIV: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+
+			if (r2 != 0) {
+				r3 = r1 / r2;
+			} else {
+				r3 = 1000; // infinity!
+				ShowError("division by zero");
+			}
+			PushDataStack(r3);
+		} break;
+		case MOD: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+
+			if (r2 != 0) {
+				PushDataStack(r1 % r2);
+			} else {
+				PushDataStack(0);
+				ShowError("modulo division by zero");
+			}
+		} break;
+
+
+		case MOVE: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+			r4 = PopDataStack();
+			r3 = PopDataStack();
+			cobInst->Move(r1, r2, r3, r4);
+		} break;
+		case MOVE_NOW: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+			r3 = PopDataStack();
+			cobInst->MoveNow(r1, r2, r3);
+		} break;
+		case TURN_NOW: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+			r3 = PopDataStack();
+			cobInst->TurnNow(r1, r2, r3);
+		} break;
+
+
+		case WAIT_TURN: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+
+			if (cobInst->NeedsWait(CCobInstance::ATurn, r1, r2)) {
+				state = WaitTurn;
+				waitPiece = r1;
+				waitAxis = r2;
+				return StepYield;
+			}
+		} break;
+		case WAIT_MOVE: {
+			r1 = GET_LONG_PC();
+			r2 = GET_LONG_PC();
+
+			if (cobInst->NeedsWait(CCobInstance::AMove, r1, r2)) {
+				state = WaitMove;
+				waitPiece = r1;
+				waitAxis = r2;
+				return StepYield;
+			}
+		} break;
 
-				if (cobInst->NeedsWait(CCobInstance::AMove, r1, r2)) {
-					state = WaitMove;
-					waitPiece = r1;
-					waitAxis = r2;
-					return true;
-				}
-			} break;
 
+		case SET: {
+			r2 = PopDataStack();
+			r1 = PopDataStack();
 
-			case SET: {
-				r2 = PopDataStack();
-				r1 = PopDataStack();
+			if ((r1 >= LUA0) && (r1 <= LUA9)) {
+				luaArgs[r1 - LUA0] = r2;
+				break;
+			}
 
-				if ((r1 >= LUA0) && (r1 <= LUA9)) {
-					luaArgs[r1 - LUA0] = r2;
+			cobInst->SetUnitVal(r1, r2);
+		} break;
+
+
+		case ATTACH: {
+			r3 = PopDataStack();
+			r2 = PopDataStack();
+			r1 = PopDataStack();
+			cobInst->AttachUnit(r2, r1);
+		} break;
+		case DROP: {
+			r1 = PopDataStack();
+			cobInst->DropUnit(r1);
+		} break;
+
+		// like bitwise ops, but only on values 1 and 0
+		case LOGICAL_NOT: {
+			r1 = PopDataStack();
+			PushDataStack(int(r1 == 0));
+		} break;
+		case LOGICAL_AND: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+			PushDataStack(int(r1 && r2));
+		} break;
+		case LOGICAL_OR: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+			PushDataStack(int(r1 || r2));
+		} break;
+		case LOGICAL_XOR: {
+			r1 = PopDataStack();
+			r2 = PopDataStack();
+			PushDataStack(int((!!r1) ^ (!!r2)));
+		} break;
+
+
+		case HIDE: {
+			r1 = GET_LONG_PC();
+			cobInst->SetVisibility(r1, false);
+		} break;
+
+		case SHOW: {
+			r1 = GET_LONG_PC();
+
+			int i;
+			for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
+				if (LocalFunctionID() == cobFile->scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i])
 					break;
-				}
-
-				cobInst->SetUnitVal(r1, r2);
-			} break;
 
+			// if true, we are in a Fire-script and should show a special flare effect
+			if (i < MAX_WEAPONS_PER_UNIT) {
+				cobInst->ShowFlare(r1);
+			} else {
+				cobInst->SetVisibility(r1, true);
+			}
+		} break;
 
-			case ATTACH: {
-				r3 = PopDataStack();
-				r2 = PopDataStack();
-				r1 = PopDataStack();
-				cobInst->AttachUnit(r2, r1);
-			} break;
-			case DROP: {
-				r1 = PopDataStack();
-				cobInst->DropUnit(r1);
-			} break;
-
-			// like bitwise ops, but only on values 1 and 0
-			case LOGICAL_NOT: {
-				r1 = PopDataStack();
-				PushDataStack(int(r1 == 0));
-			} break;
-			case LOGICAL_AND: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
-				PushDataStack(int(r1 && r2));
-			} break;
-			case LOGICAL_OR: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
-				PushDataStack(int(r1 || r2));
-			} break;
-			case LOGICAL_XOR: {
-				r1 = PopDataStack();
-				r2 = PopDataStack();
-				PushDataStack(int((!!r1) ^ (!!r2)));
-			} break;
-
-
-			case HIDE: {
-				r1 = GET_LONG_PC();
-				cobInst->SetVisibility(r1, false);
-			} break;
-
-			case SHOW: {
-				r1 = GET_LONG_PC();
-
-				int i;
-				for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
-					if (LocalFunctionID() == cobFile->scriptIndex[COBFN_FirePrimary + COBFN_Weapon_Funcs * i])
-						break;
-
-				// if true, we are in a Fire-script and should show a special flare effect
-				if (i < MAX_WEAPONS_PER_UNIT) {
-					cobInst->ShowFlare(r1);
-				} else {
-					cobInst->SetVisibility(r1, true);
-				}
-			} break;
-
-			default: {
-				const char* name = cobFile->name.c_str();
-				const char* func = cobFile->scriptNames[LocalFunctionID()].c_str();
+		default: {
+			const char* name = cobFile->name.c_str();
+			const char* func = cobFile->scriptNames[LocalFunctionID()].c_str();
 
-				LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, opcode, name, func, pc - 1);
+			LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, opcode, name, func, pc - 1);
 
-				#if 0
-				auto ei = execTrace.begin();
-				while (ei != execTrace.end()) {
-					LOG_L(L_ERROR, "\tprogctr: %3x  opcode: %s", __func__, *ei, GetOpcodeName(cobFile->code[*ei]));
-					++ei;
-				}
-				#endif
+			#if 0
+			auto ei = execTrace.begin();
+			while (ei != execTrace.end()) {
+				LOG_L(L_ERROR, "\tprogctr: %3x  opcode: %s", __func__, *ei, GetOpcodeName(cobFile->code[*ei]));
+				++ei;
+			}
+			#endif
 
-				state = Dead;
-				return false;
-			} break;
-		}
+			state = Dead;
+			return StepDead;
+		} break;
 	}
 
-	// can arrive here as dead, through CCobInstance::Signal()
-	return (state != Dead);
+	return StepNext;
 }
 
 void CCobThread::ShowError(const char* msg)
@@ -752,10 +1321,9 @@ void CCobThread::ShowError(const char* msg)
 }
 
 
-void CCobThread::DeferredCall(bool synced)
+void CCobThread::DeferredCall(int r1, int r2, bool synced)
 {
-	const int r1 = GET_LONG_PC(); // script id
-	const int r2 = GET_LONG_PC(); // arg count
+	// r1 is the script id, r2 the arg count
 
 	// Make sure to clean args from stack on exit
 	CCobStackGuard guard{&dataStack, r2};
@@ -782,11 +1350,10 @@ void CCobThread::DeferredCall(bool synced)
 }
 
 
-void CCobThread::LuaCall()
+void CCobThread::LuaCall(int r1, int r2)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
-	const int r1 = GET_LONG_PC(); // script id
-	const int r2 = GET_LONG_PC(); // arg count
+	// r1 is the script id, r2 the arg count
 
 	// Make sure to clean args from stack on exit
 	CCobStackGuard guard{&dataStack, r2};
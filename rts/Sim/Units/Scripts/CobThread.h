@@ -68,6 +68,7 @@ public:
 	void Stop();
 
 	void SetID(int threadID) { id = threadID; }
+	void SetSlabIndex(int index) { slabIndex = index; }
 	void SetState(State s) { state = s; }
 
 	/**
@@ -101,6 +102,7 @@ public:
 	const std::string& GetName();
 
 	int GetID() const { return id; }
+	int GetSlabIndex() const { return slabIndex; }
 	int GetStackVal(int pos) const { return dataStack[pos]; }
 	int GetWakeTime() const { return wakeTime; }
 	int GetRetCode() const { return retCode; }
@@ -127,8 +129,16 @@ protected:
 		int stackTop = -1;
 	};
 
-	void LuaCall();
-	void DeferredCall(bool synced);
+	enum LegacyStepResult {StepNext, StepYield, StepDead};
+
+	/**
+	 * Executes the single raw instruction at pc, for whatever the decoded
+	 * stream does not handle itself (unknown opcodes, truncated operands).
+	 */
+	LegacyStepResult StepLegacy();
+
+	void LuaCall(int scriptId, int argCount);
+	void DeferredCall(int scriptId, int argCount, bool synced);
 
 	void PushCallStack(CallInfo v) { callStack.push_back(v); }
 	void PushDataStack(int v) { dataStack.push_back(v); }
@@ -149,6 +159,8 @@ protected:
 
 protected:
 	int id = -1;
+	// position in CCobEngine::threadSlab, -1 until the engine takes ownership
+	int slabIndex = -1;
 	int pc = 0;
 
 	int wakeTime = 0;
@@ -221,6 +221,16 @@ Spring.UnitScript.UpdateCallIn(number unitID, string fname[, function callIn]) -
 	new functionID is returned.  If callIn isn't given or is nil, the callIn is
 	nilled, returns true if it was removed, or false if the callin didn't exist.
 	See also Spring.UnitScript.CreateScript.
+
+Spring.UnitScript.SetBatchedCallIn(string fname[, function callIn]) -> boolean
+	Opts the calling handle into receiving fname ("AimWeapon", "StartMoving" or
+	"StopMoving") once per frame for all of its units at the same time, instead
+	of once per unit.  callIn is called as callIn(unitIDs, ...) with one array
+	per regular callIn argument, in the order the engine issued them.  Only units
+	whose script has fname defined are included; there is no active unit during
+	the call, use CallAsUnit for the Spring.UnitScript functions that need one.
+	Passing nil switches back to per-unit calls.  Returns false if fname can not
+	be batched.
 */
 
 
@@ -237,6 +247,11 @@ Spring.UnitScript.UpdateCallIn(number unitID, string fname[, function callIn]) -
 CUnit* CLuaUnitScript::activeUnit;
 CUnitScript* CLuaUnitScript::activeScript;
 
+std::vector<CLuaUnitScript::HandleCallInBatches> CLuaUnitScript::handleCallInBatches;
+
+static constexpr std::array<const char*, 3> batchedCallInNames = {"AimWeapon", "StartMoving", "StopMoving"};
+static constexpr std::array<int, 3> batchedCallInArgs = {3, 1, 0};
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -301,6 +316,13 @@ void CLuaUnitScript::HandleFreed(CLuaHandle* handle)
 
 		spring::SafeDestruct(script);
 	}
+
+	// the refs die with the lua_State
+	const auto pred = [handle](const HandleCallInBatches& hb) { return (hb.handle == handle); };
+	const auto iter = std::find_if(handleCallInBatches.begin(), handleCallInBatches.end(), pred);
+
+	if (iter != handleCallInBatches.end())
+		handleCallInBatches.erase(iter);
 }
 
 
@@ -842,6 +864,9 @@ int CLuaUnitScript::QueryWeapon(int weaponNum)
 void CLuaUnitScript::AimWeapon(int weaponNum, float heading, float pitch)
 {
 	ZoneScoped;
+	if (QueueBatchedCallIn(BATCH_AimWeapon, weaponNum + LUA_WEAPON_BASE_INDEX, heading, pitch))
+		return;
+
 	Call(LUAFN_AimWeapon, weaponNum + LUA_WEAPON_BASE_INDEX, heading, pitch);
 }
 
@@ -977,8 +1002,8 @@ bool CLuaUnitScript::RawRunCallIn(int functionId, int inArgs, int outArgs)
 
 
 void CLuaUnitScript::Destroy() { ZoneScoped; Call(LUAFN_Destroy); }
-void CLuaUnitScript::StartMoving(bool reversing) { ZoneScoped; Call(LUAFN_StartMoving, reversing * 1.0f); }
-void CLuaUnitScript::StopMoving() { ZoneScoped; Call(LUAFN_StopMoving); }
+void CLuaUnitScript::StartMoving(bool reversing) { ZoneScoped; if (!QueueBatchedCallIn(BATCH_StartMoving, reversing * 1.0f)) Call(LUAFN_StartMoving, reversing * 1.0f); }
+void CLuaUnitScript::StopMoving() { ZoneScoped; if (!QueueBatchedCallIn(BATCH_StopMoving, 0.0f)) Call(LUAFN_StopMoving); }
 void CLuaUnitScript::StartSkidding(const float3& vel) { ZoneScoped; Call(LUAFN_StartSkidding, vel.x, vel.y, vel.z); }
 void CLuaUnitScript::StopSkidding() { ZoneScoped; Call(LUAFN_StopSkidding); }
 void CLuaUnitScript::ChangeHeading(short deltaHeading) { ZoneScoped; Call(LUAFN_ChangeHeading, deltaHeading * 1.0f); }
@@ -995,6 +1020,150 @@ void CLuaUnitScript::FireWeapon(int weaponNum) { ZoneScoped; Call(LUAFN_FireWeap
 void CLuaUnitScript::EndBurst(int weaponNum) { ZoneScoped; Call(LUAFN_EndBurst, weaponNum + LUA_WEAPON_BASE_INDEX); }
 
 
+void CLuaUnitScript::RunUnbatchedCallIn(BatchedCallInType type, const float* args)
+{
+	switch (type) {
+		case BATCH_AimWeapon  : { Call(LUAFN_AimWeapon, args[0], args[1], args[2]); } break;
+		case BATCH_StartMoving: { Call(LUAFN_StartMoving, args[0]); } break;
+		case BATCH_StopMoving : { Call(LUAFN_StopMoving); } break;
+		default: {} break;
+	}
+}
+
+
+bool CLuaUnitScript::QueueBatchedCallIn(BatchedCallInType type, float arg1, float arg2, float arg3)
+{
+	constexpr int typeFuncs[BATCH_Last] = {LUAFN_AimWeapon, LUAFN_StartMoving, LUAFN_StopMoving};
+
+	// units that never defined the callin keep ignoring it
+	if (!HasFunction(typeFuncs[type]))
+		return false;
+
+	for (HandleCallInBatches& hb: handleCallInBatches) {
+		if (hb.handle != handle)
+			continue;
+
+		CallInBatch& batch = hb.batches[type];
+
+		if (batch.funcRef == LUA_NOREF)
+			return false;
+
+		const float args[] = {arg1, arg2, arg3};
+
+		batch.unitIDs.push_back(unit->id);
+		batch.args.insert(batch.args.end(), args, args + batch.numArgs);
+		return true;
+	}
+
+	return false;
+}
+
+
+void CLuaUnitScript::RunBatchedCallIns()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	static std::vector<int> unitIDs;
+	static std::vector<float> args;
+
+	// handles are visited in the order they first batched something, so every
+	// client runs the same sequence of calls; the batches are re-fetched after
+	// each call since Lua can (un)register handles and functions from within
+	for (size_t i = 0; i < handleCallInBatches.size(); i++) {
+		CLuaHandle* handle = handleCallInBatches[i].handle;
+		lua_State* L = handleCallInBatches[i].L;
+
+		for (int type = 0; type < BATCH_Last; type++) {
+			if (i >= handleCallInBatches.size() || handleCallInBatches[i].handle != handle)
+				break;
+
+			CallInBatch& batch = handleCallInBatches[i].batches[type];
+
+			if (batch.unitIDs.empty())
+				continue;
+
+			const int funcRef = batch.funcRef;
+			const int numArgs = batch.numArgs;
+
+			// anything queued from here on is for the next frame
+			unitIDs.clear();
+			args.clear();
+			unitIDs.swap(batch.unitIDs);
+			args.swap(batch.args);
+
+			// units can die or get a new script between queueing and flushing
+			size_t numUnits = 0;
+
+			for (size_t j = 0, n = unitIDs.size(); j < n; j++) {
+				const CUnit* u = unitHandler.GetUnit(unitIDs[j]);
+				CLuaUnitScript* script = (u != nullptr)? dynamic_cast<CLuaUnitScript*>(u->script): nullptr;
+
+				if (script == nullptr || script->handle != handle)
+					continue;
+
+				// batching was switched off after these were queued
+				if (funcRef == LUA_NOREF) {
+					script->RunUnbatchedCallIn(BatchedCallInType(type), args.data() + j * numArgs);
+					continue;
+				}
+
+				unitIDs[numUnits] = unitIDs[j];
+				std::copy_n(args.begin() + j * numArgs, numArgs, args.begin() + numUnits * numArgs);
+				numUnits++;
+			}
+
+			if (numUnits == 0)
+				continue;
+
+			LUA_CALL_IN_CHECK(L);
+			lua_checkstack(L, 2 + numArgs);
+			lua_rawgeti(L, LUA_REGISTRYINDEX, funcRef);
+
+			lua_createtable(L, numUnits, 0);
+			for (size_t j = 0; j < numUnits; j++) {
+				lua_pushnumber(L, unitIDs[j]);
+				lua_rawseti(L, -2, j + 1);
+			}
+			for (int k = 0; k < numArgs; k++) {
+				lua_createtable(L, numUnits, 0);
+
+				for (size_t j = 0; j < numUnits; j++) {
+					lua_pushnumber(L, args[j * numArgs + k]);
+					lua_rawseti(L, -2, j + 1);
+				}
+			}
+
+			CUnit* oldActiveUnit = activeUnit;
+			CUnitScript* oldActiveScript = activeScript;
+
+			activeUnit = nullptr;
+			activeScript = nullptr;
+
+			std::string err;
+			const int error = handle->RunCallInLUS(L, &err, 1 + numArgs, 0);
+
+			activeUnit = oldActiveUnit;
+			activeScript = oldActiveScript;
+
+			if (error == 0)
+				continue;
+
+			if (i >= handleCallInBatches.size() || handleCallInBatches[i].handle != handle)
+				break;
+
+			LOG_L(L_ERROR, "[LuaUnitScript::%s][%s::%s] error=%i trace=%s", __func__, handle->GetName().c_str(), batchedCallInNames[type], error, err.c_str());
+
+			// fall back to per-unit calls, like RemoveCallIn does for regular ones
+			CallInBatch& failedBatch = handleCallInBatches[i].batches[type];
+
+			if (failedBatch.funcRef == funcRef) {
+				luaL_unref(L, LUA_REGISTRYINDEX, funcRef);
+				failedBatch.funcRef = LUA_NOREF;
+			}
+		}
+	}
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -1013,6 +1182,7 @@ bool CLuaUnitScript::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(CreateScript);
 	REGISTER_LUA_CFUNC(UpdateCallIn);
+	REGISTER_LUA_CFUNC(SetBatchedCallIn);
 	REGISTER_LUA_CFUNC(CallAsUnit);
 
 	REGISTER_LUA_CFUNC(GetUnitValue);
@@ -1167,6 +1337,53 @@ int CLuaUnitScript::UpdateCallIn(lua_State* L)
 }
 
 
+int CLuaUnitScript::SetBatchedCallIn(lua_State* L)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const std::string fname = luaL_checkstring(L, 1);
+
+	if (!lua_isfunction(L, 2) && !lua_isnoneornil(L, 2))
+		luaL_error(L, "Incorrect arguments to %s()", __func__);
+
+	const auto namePred = [fname](const char* name) { return (fname == name); };
+	const auto nameIter = std::find_if(batchedCallInNames.begin(), batchedCallInNames.end(), namePred);
+
+	if (nameIter == batchedCallInNames.end()) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+
+	CLuaHandle* handle = CLuaHandle::GetHandle(L);
+
+	const auto handlePred = [handle](const HandleCallInBatches& hb) { return (hb.handle == handle); };
+	auto handleIter = std::find_if(handleCallInBatches.begin(), handleCallInBatches.end(), handlePred);
+
+	if (handleIter == handleCallInBatches.end()) {
+		handleCallInBatches.emplace_back();
+		handleIter = handleCallInBatches.end() - 1;
+		handleIter->handle = handle;
+		handleIter->L = L;
+	}
+
+	const size_t type = nameIter - batchedCallInNames.begin();
+	CallInBatch& batch = handleIter->batches[type];
+
+	// anything already queued goes to the new function, or per-unit if nil
+	batch.numArgs = batchedCallInArgs[type];
+
+	luaL_unref(L, LUA_REGISTRYINDEX, batch.funcRef);
+	batch.funcRef = LUA_NOREF;
+
+	if (lua_isfunction(L, 2)) {
+		lua_pushvalue(L, 2);
+		batch.funcRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	}
+
+	lua_pushboolean(L, true);
+	return 1;
+}
+
+
 int CLuaUnitScript::CallAsUnit(lua_State* L)
 {
 	RECOIL_DETAILED_TRACY_ZONE;
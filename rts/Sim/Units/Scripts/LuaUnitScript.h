@@ -36,6 +36,34 @@ private:
 	// used to enforce SetDeathScriptFinished can only be used inside Killed
 	bool inKilled = false;
 
+	// callins that a handle can opt into receiving for all of its units at
+	// once, see SetBatchedCallIn; only those without return values qualify
+	enum BatchedCallInType {
+		BATCH_AimWeapon = 0,
+		BATCH_StartMoving,
+		BATCH_StopMoving,
+		BATCH_Last
+	};
+
+	struct CallInBatch {
+		std::vector<int> unitIDs;
+		// <numArgs> consecutive entries per unit
+		std::vector<float> args;
+
+		int funcRef = -2; // LUA_NOREF
+		int numArgs = 0;
+	};
+
+	struct HandleCallInBatches {
+		CLuaHandle* handle;
+		lua_State* L;
+
+		std::array<CallInBatch, BATCH_Last> batches;
+	};
+
+	// in order of registration, which keeps the flush order synced
+	static std::vector<HandleCallInBatches> handleCallInBatches;
+
 public:
 	// for creg use only
 	CLuaUnitScript() : CUnitScript(nullptr) {}
@@ -74,6 +102,10 @@ protected:
 
 	std::string GetScriptName(int functionId) const;
 
+	// true if the callin was queued for this frame's batch instead of run now
+	bool QueueBatchedCallIn(BatchedCallInType type, float arg1, float arg2 = 0.0f, float arg3 = 0.0f);
+	void RunUnbatchedCallIn(BatchedCallInType type, const float* args);
+
 public:
 
 	// takes LUAFN_* constant as argument
@@ -139,9 +171,13 @@ public:
 	static void HandleFreed(CLuaHandle* handle);
 	static bool PushEntries(lua_State* L);
 
+	// runs everything queued by QueueBatchedCallIn, once per sim-frame
+	static void RunBatchedCallIns();
+
 private:
 	static int CreateScript(lua_State* L);
 	static int UpdateCallIn(lua_State* L);
+	static int SetBatchedCallIn(lua_State* L);
 
 	// other call-outs are stateful
 	static int CallAsUnit(lua_State* L);
@@ -6,6 +6,7 @@
 
 #include "CobEngine.h"
 #include "CobFileHandler.h"
+#include "LuaUnitScript.h"
 #include "UnitScript.h"
 #include "UnitScriptFactory.h"
 #include "Sim/Units/Unit.h"
@@ -127,6 +128,10 @@ void CUnitScriptEngine::Tick(int deltaTime)
 {
 	SCOPED_TIMER("CUnitScriptEngine::Tick");
 
+	// deliver the callins queued by this frame's unit updates first, in the same
+	// frame they would otherwise have run in
+	CLuaUnitScript::RunBatchedCallIns();
+
 	cobEngine->Tick(deltaTime);
 
 	// tick all (COB or LUS) script instances that have registered themselves as animating
@@ -58,6 +58,7 @@
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "Sim/Weapons/WeaponLoader.h"
+#include "Sim/Weapons/Systems/WeaponUpdateSystem.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Matrix44f.h"
@@ -338,6 +339,7 @@ void CUnit::PostInit(const CUnit* builder)
 	ZoneScoped;
 	CWeaponLoader::LoadWeapons(this);
 	CWeaponLoader::InitWeapons(this);
+	WeaponUpdateSystem::AddUnit(this);
 
 	// does nothing for LUS, calls Create+SetMaxReloadTime for COB
 	script->Create();
@@ -713,18 +715,6 @@ void CUnit::UpdateWeaponVectors()
 	}
 }
 
-void CUnit::UpdateWeapons()
-{
-	ZoneScoped;
-
-	if (!CanUpdateWeapons())
-			return;
-
-	for (CWeapon* w: weapons) {
-		w->Update();
-	}
-}
-
 void CUnit::UpdateTransportees()
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -1061,32 +1051,44 @@ void CUnit::SlowUpdate()
 	AddResources(resourcesUncondMake);
 	UseResources(resourcesUncondUse);
 
-	if (activated && UseResources(resourcesCondUse))
-		AddResources(resourcesCondMake);
+	// nothing can fail between consecutive makes, so each run of them is
+	// credited to the team in one go instead of one call per source
+	if (activated && UseResources(resourcesCondUse)) {
+		AddResources(resourcesCondMake + unitDef->resourceMake * 0.5f);
+	} else {
+		AddResources(unitDef->resourceMake * 0.5f);
+	}
 
-	AddResources(unitDef->resourceMake * 0.5f);
+	float windEnergy = 0.0f;
 
 	if (activated) {
 		if (UseEnergy(unitDef->upkeep.energy * 0.5f)) {
-			AddMetal(unitDef->makesMetal * 0.5f);
+			const float extracted = metalExtract * 0.5f * (unitDef->extractsMetal > 0.0f);
 
-			if (unitDef->extractsMetal > 0.0f)
-				AddMetal(metalExtract * 0.5f);
+			// negative makesMetal is an upkeep that can fail, keep it separate
+			if (unitDef->makesMetal >= 0.0f) {
+				AddMetal(unitDef->makesMetal * 0.5f + extracted);
+			} else {
+				AddMetal(unitDef->makesMetal * 0.5f);
+				AddMetal(extracted);
+			}
 		}
 
 		UseMetal(unitDef->upkeep.metal * 0.5f);
 
-		if (unitDef->windGenerator > 0.0f) {
-			if (envResHandler.GetCurrentWindStrength() > unitDef->windGenerator) {
- 				AddEnergy(unitDef->windGenerator * 0.5f);
-			} else {
-				AddEnergy(envResHandler.GetCurrentWindStrength() * 0.5f);
-			}
-		}
+		if (unitDef->windGenerator > 0.0f)
+			windEnergy = std::min(envResHandler.GetCurrentWindStrength(), unitDef->windGenerator) * 0.5f;
 	}
 
 	// FIXME: tidal part should be under "if (activated)"?
-	AddEnergy((unitDef->tidalGenerator * envResHandler.GetCurrentTidalStrength()) * 0.5f);
+	const float tidalEnergy = (unitDef->tidalGenerator * envResHandler.GetCurrentTidalStrength()) * 0.5f;
+
+	if (tidalEnergy >= 0.0f) {
+		AddEnergy(windEnergy + tidalEnergy);
+	} else {
+		AddEnergy(windEnergy);
+		AddEnergy(tidalEnergy);
+	}
 
 
 	if (health < maxHealth) {
@@ -193,7 +193,6 @@ public:
 
 	void SetLeavesGhost(bool newLeavesGhost, bool leaveDeadGhost);
 
-	void UpdateWeapons();
 	void UpdateWeaponVectors();
 
 	void SlowUpdateWeapons();
@@ -274,6 +273,36 @@ public:
 		return std::max(0.0f, 1.0f - (limExperience * experienceWeight));
 	}
 
+public:
+	// everything Update() touches for every unit in every frame, declared
+	// together s.t. CUnitHandler::UpdateUnits pulls in one or two cache lines
+	// of each unit here rather than one per field across the whole object
+
+	// used for radar inaccuracy etc
+	float3 posErrorVector;
+	float3 posErrorDelta;
+
+	int nextPosErrorUpdate = 1;
+
+	// how long the unit has been inactive
+	unsigned int restTime = 0;
+
+	// decaying value of how much damage the unit has taken recently (for severity of death)
+	float recentDamage = 0.0f;
+
+	// how much the lowest damage direction of the flanking bonus can turn upon an attack (zeroed when attacked, slowly increases)
+	float  flankingBonusMobility = 10.0f;
+	// how much ability of the flanking bonus direction to move builds up each frame
+	float  flankingBonusMobilityAdd = 0.01f;
+
+	// prevent damage from hitting an already dead unit (causing multi wreck etc)
+	bool isDead = false;
+	// if unit is currently incompletely constructed (implies buildProgress < 1)
+	bool beingBuilt = true;
+private:
+	// if we are stunned by a weapon or for other reason, access via IsStunned/SetStunned(bool)
+	bool stunned = false;
+
 public:
 	const UnitDef* unitDef = nullptr;
 
@@ -337,10 +366,6 @@ public:
 	// units take less damage when attacked from this dir (encourage flanking fire)
 	float3 flankingBonusDir = RgtVector;
 
-	// used for radar inaccuracy etc
-	float3 posErrorVector;
-	float3 posErrorDelta;
-
 
 	int featureDefID = -1; // FeatureDef id of the wreck we spawn on death
 
@@ -384,9 +409,6 @@ public:
 	// the wreck level the unit will eventually create when it has died
 	int delayedWreckLevel = -1;
 
-	// how long the unit has been inactive
-	unsigned int restTime = 0;
-
 	float reloadSpeed = 1.0f;
 	float maxRange = 0.0f;
 
@@ -450,9 +472,6 @@ public:
 
 	float buildTime = 100.0f;
 
-	// decaying value of how much damage the unit has taken recently (for severity of death)
-	float recentDamage = 0.0f;
-
 	int fireState = 0;
 	int moveState = 0;
 
@@ -467,10 +486,6 @@ public:
 	 */
 	int flankingBonusMode = 0;
 
-	// how much the lowest damage direction of the flanking bonus can turn upon an attack (zeroed when attacked, slowly increases)
-	float  flankingBonusMobility = 10.0f;
-	// how much ability of the flanking bonus direction to move builds up each frame
-	float  flankingBonusMobilityAdd = 0.01f;
 	// average factor to multiply damage by
 	float  flankingBonusAvgDamage = 1.4f;
 	// (max damage - min damage) / 2
@@ -480,8 +495,6 @@ public:
 	// multiply all damage the unit take with this
 	float curArmorMultiple = 1.0f;
 
-	int nextPosErrorUpdate = 1;
-
 	int lastTerrainType = -1;
 	// Used for calling setSFXoccupy which TA scripts want
 	int curTerrainType = 0;
@@ -494,8 +507,6 @@ public:
 
 	// if the unit is in it's 'on'-state
 	bool activated = false;
-	// prevent damage from hitting an already dead unit (causing multi wreck etc)
-	bool isDead = false;
 
 	bool armoredState = false;
 
@@ -520,8 +531,6 @@ public:
 
 	// if true, unit will not be automatically fired upon unless attacker's fireState is set to > FIREATWILL
 	bool neutral = false;
-	// if unit is currently incompletely constructed (implies buildProgress < 1)
-	bool beingBuilt = true;
 	// if the updir is straight up or align to the ground vector
 	bool upright = true;
 	// whether the ground below this unit has been terraformed
@@ -547,9 +556,6 @@ public:
 	icon::CIconData* myIcon = nullptr;
 
 	bool drawIcon = true;
-private:
-	// if we are stunned by a weapon or for other reason, access via IsStunned/SetStunned(bool)
-	bool stunned = false;
 };
 
 struct GlobalUnitParams {
@@ -1,6 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
+#include <cstring>
 
 #include "UnitHandler.h"
 #include "Unit.h"
@@ -14,6 +16,7 @@
 #include "Sim/Ecs/Registry.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/MoveTypes/Systems/GeneralMoveSystem.h"
@@ -21,6 +24,7 @@
 #include "Sim/MoveTypes/Systems/UnitTrapCheckSystem.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Weapons/Weapon.h"
+#include "Sim/Weapons/Systems/WeaponUpdateSystem.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
@@ -49,7 +53,9 @@ CR_REG_METADATA(CUnitHandler, (
 
 	CR_MEMBER(builderCAIs),
 
-	CR_MEMBER(activeSlowUpdateUnit),
+	CR_MEMBER(slowUpdateSlots),
+	CR_MEMBER(slowUpdateSlotCosts),
+	CR_MEMBER(unitSlowUpdateSlots),
 	CR_MEMBER(activeUpdateUnit),
 
 	CR_MEMBER(maxUnits),
@@ -60,6 +66,9 @@ CR_REG_METADATA(CUnitHandler, (
 
 
 
+static_assert(sizeof(CUnitHandler::UnitHotState) == 32, "UnitHotState should stay at two entries per cache line");
+static_assert(MAX_TEAMS <= 256, "UnitHotState::team must hold every team number");
+
 UnitMemPool unitMemPool;
 
 CUnitHandler unitHandler;
@@ -111,11 +120,19 @@ void CUnitHandler::Init() {
 		maxUnitRadius = 0.0f;
 	}
 	{
-		activeSlowUpdateUnit = 0;
 		activeUpdateUnit = 0;
 	}
+	{
+		for (auto& slot: slowUpdateSlots) {
+			slot.clear();
+		}
+
+		slowUpdateSlotCosts.fill(0);
+	}
 	{
 		units.resize(maxUnits, nullptr);
+		unitSlowUpdateSlots.resize(maxUnits, 0);
+		unitHotStates.resize(maxUnits, UnitHotState{});
 		activeUnits.reserve(maxUnits);
 
 		unitMemPool.reserve(128);
@@ -157,6 +174,12 @@ void CUnitHandler::Kill()
 
 		activeUnits.clear();
 		unitsToBeRemoved.clear();
+		unitSlowUpdateSlots.clear();
+		unitHotStates.clear();
+
+		for (auto& slot: slowUpdateSlots) {
+			slot.clear();
+		}
 
 		// only iterated by unsynced code, GetBuilderCAIs has no synced callers
 		builderCAIs.clear();
@@ -200,10 +223,9 @@ void CUnitHandler::InsertActiveUnit(CUnit* unit)
 	assert(insertionPos < activeUnits.size());
 	activeUnits.insert(activeUnits.begin() + insertionPos, unit);
 
-	// do not (slow)update the same unit twice if the new one
-	// gets inserted behind our current iterator position and
+	// do not update the same unit twice if the new one gets
+	// inserted behind our current iterator position and
 	// right-shifts the rest
-	activeSlowUpdateUnit += (insertionPos <= activeSlowUpdateUnit);
 	activeUpdateUnit += (insertionPos <= activeUpdateUnit);
 
 	#else
@@ -211,6 +233,45 @@ void CUnitHandler::InsertActiveUnit(CUnit* unit)
 	#endif
 
 	units[unit->id] = unit;
+
+	InsertSlowUpdateUnit(unit);
+}
+
+
+static unsigned int GetSlowUpdateCost(const UnitDef* ud)
+{
+	// Measured timings would differ per client, so the cost of a unit's SlowUpdate is
+	// estimated from its def instead; beyond the fixed part, SlowUpdateWeapons re-targets
+	// every weapon and builders scan their surroundings for work.
+	return (2 + ud->NumWeapons() + ud->IsBuilderUnit() * 2);
+}
+
+void CUnitHandler::InsertSlowUpdateUnit(CUnit* unit)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// pick the cheapest slot; ties go to the lowest index so all clients agree
+	const auto slotIter = std::min_element(slowUpdateSlotCosts.begin(), slowUpdateSlotCosts.end());
+	const size_t slotIndex = slotIter - slowUpdateSlotCosts.begin();
+
+	slowUpdateSlots[slotIndex].push_back(unit);
+	slowUpdateSlotCosts[slotIndex] += GetSlowUpdateCost(unit->unitDef);
+	unitSlowUpdateSlots[unit->id] = slotIndex;
+}
+
+void CUnitHandler::RemoveSlowUpdateUnit(const CUnit* unit)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const size_t slotIndex = unitSlowUpdateSlots[unit->id];
+
+	std::vector<CUnit*>& slot = slowUpdateSlots[slotIndex];
+
+	// keep the order of the rest intact, it decides their SlowUpdate order
+	const auto unitIter = std::find(slot.begin(), slot.end(), unit);
+
+	assert(unitIter != slot.end());
+	slot.erase(unitIter);
+
+	slowUpdateSlotCosts[slotIndex] -= GetSlowUpdateCost(unit->unitDef);
 }
 
 
@@ -307,9 +368,7 @@ void CUnitHandler::DeleteUnit(CUnit* delUnit)
 
 	teamHandler.Team(delUnitTeam)->RemoveUnit(delUnit, CTeam::RemoveDied);
 
-	if (activeSlowUpdateUnit > std::distance(activeUnits.begin(), it))
-		--activeSlowUpdateUnit;
-
+	RemoveSlowUpdateUnit(delUnit);
 	activeUnits.erase(it);
 
 	spring::VectorErase(GetUnitsByTeamAndDef(delUnitTeam,           0), delUnit);
@@ -341,9 +400,56 @@ void CUnitHandler::UpdateUnitMoveTypes()
 void CUnitHandler::UpdateUnitLosStates()
 {
 	ZoneScopedC(tracy::Color::Goldenrod);
-	for (CUnit* unit: activeUnits) {
-		for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
-			unit->UpdateLosStatus(at);
+	const size_t numAllyTeams = teamHandler.ActiveAllyTeams();
+
+	losStatesPrev.resize(activeUnits.size() * numAllyTeams);
+	losStatesNext.resize(activeUnits.size() * numAllyTeams);
+	losStatesChanged.resize(activeUnits.size());
+
+	// the LOS queries only read, so all new states can be computed up front
+	{
+		SCOPED_TIMER("Sim::Unit::CalcLosStatesMT");
+
+		for_mt_chunk(0, activeUnits.size(), [&](const int idx) {
+			CUnit* unit = activeUnits[idx];
+
+			uint8_t* prevStates = &losStatesPrev[idx * numAllyTeams];
+			uint8_t* nextStates = &losStatesNext[idx * numAllyTeams];
+
+			std::copy_n(unit->losStatus.begin(), numAllyTeams, prevStates);
+
+			for (size_t at = 0; at < numAllyTeams; ++at) {
+				if ((prevStates[at] & LOS_ALL_MASK_BITS) == LOS_ALL_MASK_BITS) {
+					nextStates[at] = prevStates[at]; // all changes are masked
+					continue;
+				}
+
+				nextStates[at] = unit->CalcLosStatus(at);
+			}
+
+			losStatesChanged[idx] = (std::memcmp(prevStates, nextStates, numAllyTeams) != 0);
+		});
+	}
+
+	// dispatch in unit and allyteam order, same as updating them one by one;
+	// if a callin already changed the state of a later unit it is recomputed
+	for (size_t idx = 0, n = activeUnits.size(); idx < n; ++idx) {
+		if (!losStatesChanged[idx])
+			continue;
+
+		CUnit* unit = activeUnits[idx];
+
+		const uint8_t* prevStates = &losStatesPrev[idx * numAllyTeams];
+		const uint8_t* nextStates = &losStatesNext[idx * numAllyTeams];
+
+		for (size_t at = 0; at < numAllyTeams; ++at) {
+			if (unit->losStatus[at] != prevStates[at]) {
+				unit->UpdateLosStatus(at);
+				continue;
+			}
+
+			if (nextStates[at] != prevStates[at])
+				unit->SetLosStatus(at, nextStates[at]);
 		}
 	}
 }
@@ -353,27 +459,19 @@ void CUnitHandler::SlowUpdateUnits()
 {
 	SCOPED_TIMER("Sim::Unit::SlowUpdate");
 
-	assert(activeSlowUpdateUnit >= 0);
-
-	// reset the iterator every <UNIT_SLOWUPDATE_RATE> frames
-	if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) == 0)
-		activeSlowUpdateUnit = 0;
+	// stagger the SlowUpdate's; every unit sits in one of <UNIT_SLOWUPDATE_RATE> slots
+	// which are balanced by estimated cost rather than count, see InsertSlowUpdateUnit
+	const std::vector<CUnit*>& slot = slowUpdateSlots[gs->frameNum % UNIT_SLOWUPDATE_RATE];
 
-	const size_t idxBeg = activeSlowUpdateUnit;
-	const size_t maximumCnt = activeUnits.size() - idxBeg;
-	const size_t logicalCnt = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1;
-	const size_t indCnt = logicalCnt > maximumCnt ? maximumCnt : logicalCnt;
-	const size_t idxEnd = idxBeg + indCnt;
-
-	activeSlowUpdateUnit = idxEnd;
-	// stagger the SlowUpdate's
+	// units created from within SlowUpdate can land in this slot, they wait a cycle
+	const size_t slotSize = slot.size();
 
 	static std::vector<CUnit*> updateBoundingVolumeList;
 	updateBoundingVolumeList.clear();
 	{
 		ZoneScopedN("Sim::Unit::SlowUpdateST");
-		for (size_t i = idxBeg; i < idxEnd; ++i) {
-			CUnit* unit = activeUnits[i];
+		for (size_t i = 0; i < slotSize; ++i) {
+			CUnit* unit = slot[i];
 
 			unit->SanityCheck();
 			unit->SlowUpdate();
@@ -398,23 +496,35 @@ void CUnitHandler::UpdateUnits()
 {
 	SCOPED_TIMER("Sim::Unit::Update");
 
+	static std::vector<CUnit*> movedUnits;
+	movedUnits.clear();
+
 	size_t activeUnitCount = activeUnits.size();
 	for (size_t i = 0; i < activeUnitCount; ++i) {
 		CUnit* unit = activeUnits[i];
 
 		unit->SanityCheck();
 		unit->Update();
-		unit->moveType->UpdateCollisionMap();
+
+		if (unit->moveType->WantsCollisionMapUpdate())
+			movedUnits.push_back(unit);
+
 		// unsynced; done on-demand when drawing unit
 		// unit->UpdateLocalModel();
 		unit->SanityCheck();
 
 		assert(activeUnits[i] == unit);
 	}
+
+	// quad positions are only refreshed every unitQuadPositionUpdateRate frames anyway,
+	// deferring them to the end of the loop lets the quad sets be computed in parallel
+	quadField.MovedUnits(movedUnits);
 }
 
 void CUnitHandler::UpdateUnitWeapons()
 {
+	CWeapon::FlushLineOfFireChecks();
+
 	{
 		SCOPED_TIMER("Sim::Unit::UpdateWeaponVectors");
 
@@ -423,14 +533,39 @@ void CUnitHandler::UpdateUnitWeapons()
 			unit->UpdateWeaponVectors();
 		});
 	}
+	{
+		SCOPED_TIMER("Sim::Unit::WeaponPreFireMT");
+		WeaponUpdateSystem::PreFireUpdate();
+	}
 	{
 		SCOPED_TIMER("Sim::Unit::Weapon");
-		for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
-			activeUnits[activeUpdateUnit]->UpdateWeapons();
-		}
+		WeaponUpdateSystem::Update();
 	}
 }
 
+void CUnitHandler::UpdateUnitHotStates()
+{
+	SCOPED_TIMER("Sim::Unit::UpdateHotStates");
+
+	for_mt_chunk(0, activeUnits.size(), [&](const int idx) {
+		const CUnit* unit = activeUnits[idx];
+		UnitHotState& hs = unitHotStates[unit->id];
+
+		hs.pos = unit->pos;
+		hs.health = unit->health;
+		hs.maxHealth = unit->maxHealth;
+		hs.unitDefID = unit->unitDef->id;
+		hs.team = unit->team;
+		hs.allyteam = unit->allyteam;
+		hs.heading = unit->heading;
+		hs.flags = 0;
+		hs.flags |= (UnitHotState::FLAG_DEAD        * unit->isDead);
+		hs.flags |= (UnitHotState::FLAG_BEING_BUILT * unit->beingBuilt);
+		hs.flags |= (UnitHotState::FLAG_STUNNED     * unit->IsStunned());
+		hs.flags |= (UnitHotState::FLAG_IN_AIR      * unit->IsInAir());
+	});
+}
+
 void CUnitHandler::UpdatePreFrame()
 {
 	SCOPED_TIMER("Sim::Unit::UpdatePreFrame");
@@ -476,6 +611,17 @@ void CUnitHandler::UpdatePostAnimation()
 	SCOPED_TIMER("Sim::Unit::UpdatePostAnimation");
 	inUpdateCall = true;
 
+	// scripts have just moved pieces; resolve every unit's dirty piece tree at once instead of
+	// piece by piece on first use, each only touches its own LocalModel and the transforms do
+	// not depend on who computes them. Transportees below, next frame's synced piece queries
+	// and the (threaded) drawer update then all find them clean
+	{
+		SCOPED_TIMER("Sim::Unit::UpdatePieceTransformsMT");
+		for_mt_chunk(0, activeUnits.size(), [&](const int idx) {
+			activeUnits[idx]->localModel.UpdatePieceTransforms();
+		});
+	}
+
 	for (auto* unit : activeUnits) {
 		unit->UpdateTransportees();
 	}
@@ -4,10 +4,12 @@
 #define UNITHANDLER_H
 
 #include <array>
+#include <cstdint>
 #include <vector>
 
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/SimObjectIDPool.h"
+#include "System/float3.h"
 #include "System/creg/STL_Map.h"
 
 struct UnitDef;
@@ -19,6 +21,33 @@ class CUnitHandler
 	CR_DECLARE_STRUCT(CUnitHandler)
 
 public:
+	/**
+	 * Compact copy of the unit state read by scans over the whole population,
+	 * stored contiguously by unit ID (two per cache line) s.t. such scans need
+	 * not touch each scattered CUnit. Only refreshed by UpdateUnitHotStates, on
+	 * the frames a consumer (UnitStateExporter) asks for it; entries are stale
+	 * otherwise.
+	 */
+	struct UnitHotState {
+		enum Flags: std::uint8_t {
+			FLAG_DEAD        = 1 << 0,
+			FLAG_BEING_BUILT = 1 << 1,
+			FLAG_STUNNED     = 1 << 2,
+			FLAG_IN_AIR      = 1 << 3,
+		};
+
+		bool HasFlag(Flags f) const { return ((flags & f) != 0); }
+
+		float3 pos;
+		float health;
+		float maxHealth;
+		int unitDefID;
+		std::uint8_t team;
+		std::uint8_t allyteam;
+		short heading;
+		std::uint8_t flags;
+	};
+
 	CUnitHandler(): idPool(MAX_UNITS) {}
 
 	void Init();
@@ -75,7 +104,12 @@ public:
 	std::vector<CUnit*>& GetUnitsByTeam      (int teamNum               ) { return unitsByDefs[teamNum][        0]; }
 	std::vector<CUnit*>& GetUnitsByTeamAndDef(int teamNum, int unitDefID) { return unitsByDefs[teamNum][unitDefID]; }
 
-	const spring::unordered_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
+	const spring::flat_hash_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
+
+	const UnitHotState& GetUnitHotState(unsigned int id) const { return unitHotStates[id]; }
+	const std::vector<UnitHotState>& GetUnitHotStates() const { return unitHotStates; }
+	/// copies the current state of all active units into their UnitHotState entries
+	void UpdateUnitHotStates();
 
 private:
 	void InsertActiveUnit(CUnit* unit);
@@ -84,6 +118,8 @@ private:
 	void DeleteUnit(CUnit* unit);
 	void DeleteUnits();
 	void SlowUpdateUnits();
+	void InsertSlowUpdateUnit(CUnit* unit);
+	void RemoveSlowUpdateUnit(const CUnit* unit);
 	void UpdateUnitPathing(const size_t idxBeg, const size_t idxEnd);
 	void UpdateUnitMoveTypes();
 	void UpdateUnitLosStates();
@@ -104,10 +140,24 @@ private:
 	std::vector<CUnit*> unitsToBeRemoved;                                ///< units that will be removed at start of next update
 	std::vector<CUnit*> unitsJustAdded;                                  ///< units created this frame
 
-	spring::unordered_map<unsigned int, CBuilderCAI*> builderCAIs;
+	spring::flat_hash_map<unsigned int, CBuilderCAI*> builderCAIs;
+
+
+	///< units SlowUpdate'd on frames where (frameNum % UNIT_SLOWUPDATE_RATE) equals the index,
+	///< plus the summed (estimated) cost of each; see InsertSlowUpdateUnit
+	std::array<std::vector<CUnit*>, UNIT_SLOWUPDATE_RATE> slowUpdateSlots;
+	std::array<unsigned int, UNIT_SLOWUPDATE_RATE> slowUpdateSlotCosts;
+
+	std::vector<std::uint8_t> unitSlowUpdateSlots;                       ///< slot of each unit, indexed by ID
+
+	///< not serialized, rebuilt from the units at the end of the first frame after loading
+	std::vector<UnitHotState> unitHotStates;
 
+	///< not serialized, UpdateUnitLosStates scratch; [activeUnit * numAllyTeams + allyTeam]
+	std::vector<uint8_t> losStatesPrev;
+	std::vector<uint8_t> losStatesNext;
+	std::vector<uint8_t> losStatesChanged;
 
-	size_t activeSlowUpdateUnit = 0;  ///< first unit of batch that will be SlowUpdate'd this frame
 	size_t activeUpdateUnit = 0;      ///< first unit of batch that will be SlowUpdate'd this frame
 
 
@@ -93,6 +93,9 @@ CBeamLaser::CBeamLaser(CUnit* owner, const WeaponDef* def)
 	if (def != nullptr)
 		color = def->visuals.color;
 
+	// sweep-fire keeps going without a target
+	hasBaseUpdate = false;
+
 	sweepFireState.SetDamageAllies((collisionFlags & Collision::NOFRIENDLIES) == 0);
 }
 
@@ -0,0 +1,23 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef WEAPON_COMPONENTS_H__
+#define WEAPON_COMPONENTS_H__
+
+#include "System/Ecs/Components/BaseComponents.h"
+
+namespace Weapons {
+
+// Units that own at least one weapon, by unit id. Only these are visited by
+// WeaponUpdateSystem, most buildings and economy units never are.
+ALIAS_COMPONENT(ArmedUnit, int);
+
+template<class Archive, class Snapshot>
+void serializeComponents(Archive &archive, Snapshot &snapshot) {
+    snapshot.template component
+        < ArmedUnit
+        >(archive);
+}
+
+}
+
+#endif
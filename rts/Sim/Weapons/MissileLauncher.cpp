@@ -10,6 +10,7 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "Rendering/GlobalRendering.h"
 #include "Sim/Misc/GeometricObjects.h"
@@ -204,6 +205,7 @@ bool CMissileLauncher::HaveFreeLineOfFire(const float3& srcPos, const float3& tg
 	// that trajectoryheight missiles follow is singularly unique
 	// so no need to spin it off until something else needs this
 	QuadFieldQuery qfQuery;
+	qfQuery.threadOwner = ThreadPool::GetThreadNum();
 	quadField.GetQuadsOnRay(qfQuery, srcPos, targetVec, xzTargetDist);
 
 	if (qfQuery.quads->empty())
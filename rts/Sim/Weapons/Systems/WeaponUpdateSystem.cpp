@@ -0,0 +1,78 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "WeaponUpdateSystem.h"
+
+#include "Sim/Ecs/Registry.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitHandler.h"
+#include "Sim/Weapons/Components/WeaponComponents.h"
+#include "Sim/Weapons/Weapon.h"
+
+#include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
+
+#include "System/Misc/TracyDefs.h"
+
+using namespace Weapons;
+
+void WeaponUpdateSystem::AddUnit(const CUnit* unit) {
+    if (unit->weapons.empty())
+        return;
+
+    Sim::registry.emplace_or_replace<ArmedUnit>(unit->entityReference, unit->id);
+}
+
+void WeaponUpdateSystem::PreFireUpdate() {
+    RECOIL_DETAILED_TRACY_ZONE;
+    const auto& activeUnits = unitHandler.GetActiveUnits();
+
+    // the line-of-fire tests below hit-test other units' piece trees, which
+    // must not be resolved lazily (and concurrently) on first use
+    for_mt_chunk(0, activeUnits.size(), [&activeUnits](const int idx) {
+        const CUnit* unit = activeUnits[idx];
+
+        if (unit->collisionVolume.DefaultToPieceTree())
+            unit->localModel.UpdatePieceMatrices();
+    });
+
+    // the expensive read-only part of UpdateFire, tested against the world as
+    // it is before any weapon fires; every weapon only writes its own result,
+    // so the outcome does not depend on the thread count or order. Update()
+    // below then aims, fires and spawns projectiles serially as before, and
+    // retests any weapon whose target or position changed in between
+    for_mt_chunk(0, activeUnits.size(), [&activeUnits](const int idx) {
+        CUnit* unit = activeUnits[idx];
+
+        if (unit->weapons.empty() || !unit->CanUpdateWeapons())
+            return;
+
+        for (CWeapon* w: unit->weapons) {
+            if (w->IsIdle())
+                continue;
+
+            w->PreFireUpdate();
+        }
+    });
+}
+
+void WeaponUpdateSystem::Update() {
+    RECOIL_DETAILED_TRACY_ZONE;
+    auto view = Sim::registry.view<ArmedUnit>();
+
+    // units created by script callins during the loop are appended to the
+    // storage and, like with the move systems, only get visited next frame
+    view.each([](ArmedUnit& unitId){
+        CUnit* unit = unitHandler.GetUnit(unitId.value);
+
+        if (!unit->CanUpdateWeapons())
+            return;
+
+        for (CWeapon* w: unit->weapons) {
+            // skip the virtual call for weapons that have nothing to do
+            if (w->IsIdle())
+                continue;
+
+            w->Update();
+        }
+    });
+}
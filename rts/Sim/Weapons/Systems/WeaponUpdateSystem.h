@@ -0,0 +1,15 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef WEAPON_UPDATE_SYSTEM_H__
+#define WEAPON_UPDATE_SYSTEM_H__
+
+class CUnit;
+
+class WeaponUpdateSystem {
+public:
+    static void AddUnit(const CUnit* unit);
+    static void PreFireUpdate();
+    static void Update();
+};
+
+#endif
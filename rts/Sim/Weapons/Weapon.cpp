@@ -34,8 +34,15 @@
 
 #include "System/Misc/TracyDefs.h"
 
+#include <atomic>
+
 //constexpr float SAFE_INTERCEPT_EPS = (1.0 / 65536);
 
+// per weapon-def, indexed by WeaponDef::id; TryTarget runs on the
+// worker threads during the pre-fire pass, hence the atomic counters
+static std::vector<std::atomic<int>> numLineOfFireChecks;
+static std::vector<int> numLineOfFireChecksPrevFrame;
+
 CR_BIND_DERIVED_POOL(CWeapon, CObject, , weaponMemPool.allocMem, weaponMemPool.freeMem)
 CR_REG_METADATA(CWeapon, (
 	CR_MEMBER(owner),
@@ -113,6 +120,8 @@ CR_REG_METADATA(CWeapon, (
 
 	CR_MEMBER(weaponAimAdjustPriority),
 	CR_MEMBER(fastAutoRetargeting),
+	CR_IGNORED(hasBaseUpdate),
+	CR_IGNORED(preFireCheck),
 	CR_MEMBER(fastQueryPointUpdate),
 	CR_MEMBER(accurateLeading),
 	CR_MEMBER(burstControlWhenOutOfArc)
@@ -196,6 +205,7 @@ CWeapon::CWeapon(CUnit* owner, const WeaponDef* def):
 
 	weaponAimAdjustPriority(1.f),
 	fastAutoRetargeting(false),
+	hasBaseUpdate(true),
 	fastQueryPointUpdate(false),
 	accurateLeading(0),
 	burstControlWhenOutOfArc(0)
@@ -418,6 +428,61 @@ bool CWeapon::CallAimingScript(bool waitForAim)
 }
 
 
+bool CWeapon::IsIdle() const
+{
+	// without a target (of its own or the owner's), a running salvo or a stockpile
+	// to build, none of the steps in Update() can do anything
+	if (!hasBaseUpdate)
+		return false;
+	if (HaveTarget() || owner->curTarget.type != Target_None)
+		return false;
+
+	return (salvoLeft == 0 && !weaponDef->stockpile);
+}
+
+
+void CWeapon::PreFireUpdate()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// same gate as UpdateFire; weapons that refresh their pieces right before
+	// testing (fastQueryPointUpdate) can only be tested there
+	if (!HaveTarget() || fastQueryPointUpdate)
+		return;
+	if (HaveUnitTarget() && currentTarget.unit->isDead)
+		return;
+	if (!CanFire(false, false, false))
+		return;
+
+	preFireCheck.target = currentTarget;
+	preFireCheck.targetPos = GetLeadTargetPos(currentTarget);
+	preFireCheck.aimFromPos = aimFromPos;
+	preFireCheck.muzzlePos = weaponMuzzlePos;
+	preFireCheck.result = TryTarget(preFireCheck.targetPos, currentTarget, true);
+	preFireCheck.frame = gs->frameNum;
+}
+
+bool CWeapon::TryPreFireTarget()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	const PreFireCheck& pfc = preFireCheck;
+
+	// anything Update() or an earlier unit's weapons and script did since the
+	// pre-fire pass that affects the test (retargeting, moved target or weapon,
+	// target killed) misses
+	bool valid = (pfc.frame == gs->frameNum);
+	valid = valid && (pfc.target == currentTarget);
+	valid = valid && (!HaveUnitTarget() || !currentTarget.unit->isDead);
+	valid = valid && pfc.targetPos.same(currentTargetPos);
+	valid = valid && pfc.aimFromPos.same(aimFromPos);
+	valid = valid && pfc.muzzlePos.same(weaponMuzzlePos);
+
+	if (valid)
+		return pfc.result;
+
+	return (TryTarget(currentTargetPos, currentTarget, true));
+}
+
+
 bool CWeapon::CanFire(bool ignoreAngleGood, bool ignoreTargetType, bool ignoreRequestedDir) const
 {
 	RECOIL_DETAILED_TRACY_ZONE;
@@ -465,7 +530,7 @@ void CWeapon::UpdateFire()
 		UpdateWeaponVectors();
 	} 
 
-	if (!TryTarget(currentTargetPos, currentTarget, true))
+	if (!TryPreFireTarget())
 		return;
 
 	// pre-check if we got enough resources (so CobBlockShot gets only called when really possible to shoot)
@@ -957,10 +1022,43 @@ bool CWeapon::TryTarget(const float3 tgtPos, const SWeaponTarget& trg, bool preF
 	if (preFire && (weaponMuzzlePos.y < CGround::GetHeightReal(weaponMuzzlePos.x, weaponMuzzlePos.z)))
 		return false;
 
+	// not counted until the first FlushLineOfFireChecks has sized the table
+	if (static_cast<size_t>(weaponDef->id) < numLineOfFireChecks.size())
+		numLineOfFireChecks[weaponDef->id].fetch_add(1, std::memory_order_relaxed);
+
 	// TODO: add a forcedUserTarget (forced-fire mode enabled with CTRL e.g.) and skip the tests below
 	return (HaveFreeLineOfFire(GetAimFromPos(preFire), tgtPos, trg));
 }
 
+
+int CWeapon::GetNumLineOfFireChecks(int weaponDefID)
+{
+	if (weaponDefID < 0 || static_cast<size_t>(weaponDefID) >= numLineOfFireChecksPrevFrame.size())
+		return 0;
+
+	return numLineOfFireChecksPrevFrame[weaponDefID];
+}
+
+void CWeapon::FlushLineOfFireChecks()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	// sized on demand, since weapon-defs can change between games
+	if (numLineOfFireChecks.size() != weaponDefHandler->NumWeaponDefs())
+		numLineOfFireChecks = std::vector<std::atomic<int>>(weaponDefHandler->NumWeaponDefs());
+
+	numLineOfFireChecksPrevFrame.resize(weaponDefHandler->NumWeaponDefs(), 0);
+
+	for (size_t i = 0; i < numLineOfFireChecks.size(); i++) {
+		const int numChecks = numLineOfFireChecks[i].exchange(0, std::memory_order_relaxed);
+
+		// only plot weapon-defs that have been active, keeps the list short
+		if ((numChecks | numLineOfFireChecksPrevFrame[i]) != 0)
+			TracyPlot(weaponDefHandler->GetWeaponDefByID(i)->name.c_str(), static_cast<int64_t>(numChecks));
+
+		numLineOfFireChecksPrevFrame[i] = numChecks;
+	}
+}
+
 float CWeapon::GetShapedWeaponRange(const float3& dir, float maxLength) const
 {
 	maxLength = std::max(maxLength, 1e-6f); // prevent possible NaNs
@@ -31,6 +31,12 @@ public:
 	virtual void SlowUpdate();
 	virtual void Update();
 
+	// true if Update() is known to be a no-op this frame
+	bool IsIdle() const;
+	// tests the line of fire to the current target ahead of Update(), may run
+	// concurrently for different weapons (see WeaponUpdateSystem::PreFireUpdate)
+	void PreFireUpdate();
+
 public:
 	bool Attack(const SWeaponTarget& newTarget);
 	void SetAttackTarget(const SWeaponTarget& newTarget); //< does no validity checks!
@@ -76,6 +82,10 @@ public:
 	float TargetWeight(const CUnit* unit) const;
 
 	static float GetStaticRange2D(const CWeapon* w, const WeaponDef* wd, float modHeightDiff, float modProjGravity);
+
+	// line-of-fire rays cast per weapon-def during the last completed frame
+	static int GetNumLineOfFireChecks(int weaponDefID);
+	static void FlushLineOfFireChecks();
 	static float GetLiveRange2D(const CWeapon* w, const WeaponDef* wd, float modHeightDiff, float modProjGravity) { return (w->GetRange2D(0.0f, modHeightDiff)); }
 
 	virtual float GetRange2D(float boost, float ydiff) const;
@@ -129,6 +139,7 @@ private:
 	void HoldIfTargetInvalid();
 
 	bool TryTarget(const float3 tgtPos, const SWeaponTarget& trg, bool preFire = false) const;
+	bool TryPreFireTarget();
 public:
 	CUnit* owner;
 	CWeapon* slavedTo;                      // use this weapon to choose target
@@ -169,6 +180,7 @@ public:
 	bool doTargetGroundPos;                 // (used for bombers) target the ground pos under the unit instead of the center aimPos
 	bool noAutoTarget;
 	bool alreadyWarnedAboutMissingPieces;
+	bool hasBaseUpdate;                     // false for types whose Update() does extra work, see IsIdle
 
 	unsigned int badTargetCategory;         // targets in this category get a lot lower targeting priority
 	unsigned int onlyTargetCategory;        // only targets in this category can be targeted (default 0xffffffff)
@@ -217,6 +229,18 @@ protected:
 	// projectiles that are on the way to our interception zone
 	// (eg. nuke toward a repulsor, or missile toward a shield)
 	std::vector<int> incomingProjectileIDs;
+
+private:
+	// TryTarget result computed by PreFireUpdate, reused by UpdateFire if none
+	// of its inputs changed in between; only valid during <frame>, not saved
+	struct PreFireCheck {
+		SWeaponTarget target;
+		float3 targetPos;
+		float3 aimFromPos;
+		float3 muzzlePos;
+		int frame = -1;
+		bool result = false;
+	} preFireCheck;
 };
 
 #endif /* WEAPON_H */
@@ -23,6 +23,20 @@ typedef std::map<std::string, std::string> StringMap;
 
 ConfigHandler* configHandler = nullptr;
 
+namespace {
+	struct KeyVersions {
+		// std::map nodes never move, ConfigVar handles keep pointers into them
+		std::map<std::string, std::atomic<uint32_t>> versions;
+		spring::mutex mutex;
+	};
+
+	// ConfigVar's can be static too, this avoids depending on initialization order
+	KeyVersions& GetKeyVersions() {
+		static KeyVersions keyVersions;
+		return keyVersions;
+	}
+}
+
 
 /******************************************************************************/
 
@@ -243,6 +257,8 @@ void ConfigHandlerImpl::Delete(const std::string& key)
 
 		rwcs->Delete(key);
 	}
+
+	BumpKeyVersion(key);
 }
 
 bool ConfigHandlerImpl::IsSet(const std::string& key) const
@@ -316,8 +332,11 @@ void ConfigHandlerImpl::SetString(const std::string& key, const std::string& val
 		overlay->Delete(key);
 
 	// Don't do anything if value didn't change.
-	if (IsSet(key) && GetString(key) == value)
+	if (IsSet(key) && GetString(key) == value) {
+		// removing the overlay above may still have changed it
+		BumpKeyVersion(key);
 		return;
+	}
 
 	if (useOverlay) {
 		overlay->SetString(key, value);
@@ -349,6 +368,8 @@ void ConfigHandlerImpl::SetString(const std::string& key, const std::string& val
 		}
 	}
 
+	BumpKeyVersion(key);
+
 	std::lock_guard<spring::mutex> lck(observerMutex);
 
 	if (notify)
@@ -436,6 +457,8 @@ void ConfigHandler::Instantiate(const std::string configSource, const bool safem
 	configHandler = new ConfigHandlerImpl(locations, safemode);
 	configHandler->FinalizeLoad();
 
+	BumpKeyVersions();
+
 	//assert(configHandler->GetString("test") == "x y z");
 }
 
@@ -450,4 +473,37 @@ bool ConfigHandler::Get(const std::string& key) const
 }
 
 
+const std::atomic<uint32_t>* ConfigHandler::GetKeyVersion(const std::string& key)
+{
+	KeyVersions& keyVersions = GetKeyVersions();
+	std::lock_guard<spring::mutex> lck(keyVersions.mutex);
+
+	return &(keyVersions.versions.try_emplace(key, 1u).first->second);
+}
+
+void ConfigHandler::BumpKeyVersion(const std::string& key)
+{
+	KeyVersions& keyVersions = GetKeyVersions();
+	std::lock_guard<spring::mutex> lck(keyVersions.mutex);
+
+	const auto iter = keyVersions.versions.find(key);
+
+	// nobody holds a handle to it
+	if (iter == keyVersions.versions.end())
+		return;
+
+	iter->second.fetch_add(1, std::memory_order_release);
+}
+
+void ConfigHandler::BumpKeyVersions()
+{
+	KeyVersions& keyVersions = GetKeyVersions();
+	std::lock_guard<spring::mutex> lck(keyVersions.mutex);
+
+	for (auto& [key, version]: keyVersions.versions) {
+		version.fetch_add(1, std::memory_order_release);
+	}
+}
+
+
 /******************************************************************************/
\ No newline at end of file
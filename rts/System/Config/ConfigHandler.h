@@ -3,6 +3,8 @@
 #ifndef CONFIGHANDLER_H
 #define CONFIGHANDLER_H
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -35,6 +37,15 @@ public:
 	 */
 	static void Deallocate();
 
+	/**
+	 * @brief Change counter of a config variable, see ConfigVar
+	 *
+	 * Bumped whenever the variable is set or deleted, and for all variables
+	 * when the configHandler is (re)instantiated. The counter outlives any
+	 * configHandler instance.
+	 */
+	static const std::atomic<uint32_t>* GetKeyVersion(const std::string& key);
+
 public:
 	/**
 	 * @brief Register an observer
@@ -163,6 +174,9 @@ public:
 protected:
 	typedef std::function<void(const std::string&, const std::string&)> ConfigNotifyCallback;
 
+	static void BumpKeyVersion(const std::string& key);
+	static void BumpKeyVersions();
+
 	virtual void AddObserver(ConfigNotifyCallback callback, void* observer, const std::vector<std::string>& configs) = 0;
 	virtual void RemoveObserver(void* observer) = 0;
 
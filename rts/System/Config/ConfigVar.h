@@ -0,0 +1,93 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef CONFIG_VAR_H
+#define CONFIG_VAR_H
+
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "ConfigHandler.h"
+
+/**
+ * @brief Typed, cached handle onto a single config variable
+ *
+ * For code that reads a setting every frame: the key is resolved into its
+ * change counter once, and Get only goes through configHandler again after
+ * a SetString or Delete on that key (or a re-Instantiate) bumped it. The
+ * cached value and the counter it was read at are swapped as one, so Get
+ * may be called from any thread.
+ *
+ *   static ConfigVar<int> smoothTimeOffset("SmoothTimeOffset");
+ *   const int offset = smoothTimeOffset.Get();
+ *
+ * Observers registered through ConfigHandler::NotifyOnChange keep working
+ * as before, for code that has to react to a change rather than read it.
+ */
+template<typename T>
+class ConfigVar
+{
+	static_assert(std::is_same_v<T, bool> || std::is_same_v<T, int> || std::is_same_v<T, unsigned> || std::is_same_v<T, float>);
+
+public:
+	explicit ConfigVar(const char* key_): key(key_), keyVersion(ConfigHandler::GetKeyVersion(key)) {}
+	ConfigVar(const ConfigVar&) = delete;
+
+	ConfigVar& operator = (const ConfigVar&) = delete;
+
+	T Get() const {
+		const uint64_t cached = cache.load(std::memory_order_acquire);
+		const uint32_t version = keyVersion->load(std::memory_order_acquire);
+
+		if (uint32_t(cached >> 32) == version)
+			return Unpack(uint32_t(cached));
+
+		// a change racing with this read bumps the version again, the next Get picks it up
+		const T value = Read();
+
+		cache.store((uint64_t(version) << 32) | Pack(value), std::memory_order_release);
+		return value;
+	}
+
+	operator T () const { return (Get()); }
+
+	const std::string& GetKey() const { return key; }
+
+private:
+	T Read() const {
+		if constexpr (std::is_same_v<T, bool>)
+			return (configHandler->GetBool(key));
+		else if constexpr (std::is_same_v<T, int>)
+			return (configHandler->GetInt(key));
+		else if constexpr (std::is_same_v<T, unsigned>)
+			return (configHandler->GetUnsigned(key));
+		else
+			return (configHandler->GetFloat(key));
+	}
+
+	static uint32_t Pack(T value) {
+		if constexpr (std::is_same_v<T, bool>)
+			return (uint32_t(value));
+		else
+			return (std::bit_cast<uint32_t>(value));
+	}
+
+	static T Unpack(uint32_t bits) {
+		if constexpr (std::is_same_v<T, bool>)
+			return (bits != 0);
+		else
+			return (std::bit_cast<T>(bits));
+	}
+
+private:
+	std::string key;
+
+	const std::atomic<uint32_t>* keyVersion;
+
+	// (version << 32) | value bits; versions start at 1, so the first Get always reads
+	mutable std::atomic<uint64_t> cache = {0};
+};
+
+#endif // CONFIG_VAR_H
@@ -60,6 +60,14 @@ class CEventClient
 			MinSpecialTeam = AllAccessTeam
 		};
 
+		// transition argument of UnitLosChangedBatch, passed on as-is to Lua
+		enum LosTransition {
+			LosEnteredLos   = 1,
+			LosLeftLos      = 2,
+			LosEnteredRadar = 3,
+			LosLeftRadar    = 4,
+		};
+
 	public:
 		inline const std::string& GetName()   const { return name;   }
 		inline int                GetOrder()  const { return order;  }
@@ -145,6 +153,13 @@ class CEventClient
 			int weaponDefID,
 			int projectileID,
 			bool paralyzer) {}
+		virtual void UnitDamagedBatch(
+			const CUnit* unit,
+			const CUnit* attacker,
+			float damage,
+			int weaponDefID,
+			int projectileID,
+			bool paralyzer) {}
 		virtual void UnitStunned(const CUnit* unit, bool stunned) {}
 		virtual void UnitExperience(const CUnit* unit, float oldExperience) {}
 		virtual void UnitHarvestStorageFull(const CUnit* unit) {}
@@ -155,6 +170,7 @@ class CEventClient
 		virtual void UnitEnteredLos(const CUnit* unit, int allyTeam) {}
 		virtual void UnitLeftRadar(const CUnit* unit, int allyTeam) {}
 		virtual void UnitLeftLos(const CUnit* unit, int allyTeam) {}
+		virtual void UnitLosChangedBatch(const CUnit* unit, int allyTeam, int transition) {}
 
 		virtual void UnitEnteredUnderwater(const CUnit* unit) {}
 		virtual void UnitEnteredWater(const CUnit* unit) {}
@@ -194,6 +210,7 @@ class CEventClient
 		virtual void RenderFeatureDestroyed(const CFeature* feature) {}
 
 		virtual void ProjectileCreated(const CProjectile* proj) {}
+		virtual void ProjectileCreatedBatch(const CProjectile* proj) {}
 		virtual void ProjectileDestroyed(const CProjectile* proj) {}
 
 		virtual void RenderProjectileCreated(const CProjectile* proj) {}
@@ -375,6 +392,10 @@ class CEventClient
 		virtual void LoadProgress(const std::string& msg, const bool replace_lastline);
 
 		virtual void CollectGarbage(bool forced) {}
+		// not an event; called on CollectGarbage clients to spend at most maxRunTime milliseconds
+		virtual void CollectGarbageInBudget(float maxRunTime) {}
+		// not an event; called once per sim-frame on *Batch clients to deliver what they queued
+		virtual void SendBatchedEvents() {}
 		virtual void DbgTimingInfo(DbgTimingInfoType type, const spring_time start, const spring_time end) {}
 		virtual void Pong(uint8_t pingTag, const spring_time pktSendTime, const spring_time pktRecvTime) {}
 		virtual void MetalMapChanged(const int x, const int z) {}
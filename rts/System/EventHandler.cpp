@@ -9,6 +9,7 @@
 #include "System/Platform/Threading.h"
 #include "System/GlobalConfig.h"
 
+#include "System/TimeProfiler.h"
 #include "System/Misc/TracyDefs.h"
 
 CEventHandler eventHandler;
@@ -116,6 +117,18 @@ bool CEventHandler::IsKnown(const std::string& eName) const
 }
 
 
+int CEventHandler::GetEventIndex(const std::string& eName) const
+{
+	const auto comp = [](const EventPair& a, const EventPair& b) { return (a.first < b.first); };
+	const auto iter = std::lower_bound(eventMap.begin(), eventMap.end(), EventPair{eName, {}}, comp);
+
+	if (iter == eventMap.end() || iter->first != eName)
+		return -1;
+
+	return (iter - eventMap.begin());
+}
+
+
 bool CEventHandler::IsManaged(const std::string& eName) const
 {
 	const auto comp = [](const EventPair& a, const EventPair& b) { return (a.first < b.first); };
@@ -627,10 +640,44 @@ void CEventHandler::UnitHarvestStorageFull(const CUnit* unit)
 
 void CEventHandler::CollectGarbage(bool forced)
 {
-	ZoneScoped;
+	SCOPED_TIMER("Lua::CollectGarbage");
 	ITERATE_EVENTCLIENTLIST(CollectGarbage, forced);
 }
 
+void CEventHandler::CollectGarbageInBudget(float maxRunTime)
+{
+	SCOPED_TIMER("Lua::CollectGarbage");
+
+	if (listCollectGarbage.empty())
+		return;
+
+	// clients are handed whatever budget is left, so rotate which one goes first
+	static size_t firstClient = 0;
+
+	const spring_time endTime = spring_gettime() + spring_msecs(maxRunTime);
+	const size_t numClients = listCollectGarbage.size();
+
+	firstClient = (firstClient + 1) % numClients;
+
+	for (size_t i = 0; i < numClients; i++) {
+		const float runTime = (endTime - spring_gettime()).toMilliSecsf();
+
+		if (runTime <= 0.0f)
+			break;
+
+		listCollectGarbage[(firstClient + i) % numClients]->CollectGarbageInBudget(runTime);
+	}
+}
+
+void CEventHandler::SendBatchedEvents()
+{
+	ZoneScoped;
+	// a client in both lists sends everything on the first call
+	IterateEventClientList(listUnitDamagedBatch, &CEventClient::SendBatchedEvents);
+	IterateEventClientList(listProjectileCreatedBatch, &CEventClient::SendBatchedEvents);
+	IterateEventClientList(listUnitLosChangedBatch, &CEventClient::SendBatchedEvents);
+}
+
 void CEventHandler::DbgTimingInfo(DbgTimingInfoType type, const spring_time start, const spring_time end)
 {
 	ITERATE_EVENTCLIENTLIST(DbgTimingInfo, type, start, end);
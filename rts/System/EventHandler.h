@@ -38,6 +38,9 @@ class CEventHandler
 		void GetEventList(std::vector<std::string>& list) const;
 
 		bool IsKnown(const std::string& ciName) const;
+		// position of ciName in the event-map, -1 if unknown; stays the same for any given event
+		int GetEventIndex(const std::string& ciName) const;
+		size_t GetNumEvents() const { return eventMap.size(); }
 		bool IsManaged(const std::string& ciName) const;
 		bool IsUnsynced(const std::string& ciName) const;
 		bool IsController(const std::string& ciName) const;
@@ -312,6 +315,8 @@ class CEventHandler
 		void GameProgress(int gameFrame);
 
 		void CollectGarbage(bool forced);
+		void CollectGarbageInBudget(float maxRunTime);
+		void SendBatchedEvents();
 		void DbgTimingInfo(DbgTimingInfoType type, const spring_time start, const spring_time end);
 		void Pong(uint8_t pingTag, const spring_time pktSendTime, const spring_time pktRecvTime);
 		void MetalMapChanged(const int x, const int z);
@@ -458,10 +463,15 @@ UNIT_CALLIN_INT_PARAMS(Taken)
 UNIT_CALLIN_INT_PARAMS(Given)
 
 
-#define UNIT_CALLIN_LOS_PARAM(name)                                        \
-	inline void CEventHandler:: Unit ## name (const CUnit* unit, int at)   \
-	{                                                                      \
-		ITERATE_ALLYTEAM_EVENTCLIENTLIST(Unit ## name, at, unit, at)       \
+#define UNIT_CALLIN_LOS_PARAM(name)                                                      \
+	inline void CEventHandler:: Unit ## name (const CUnit* unit, int at)                 \
+	{                                                                                    \
+		{                                                                                \
+			ITERATE_ALLYTEAM_EVENTCLIENTLIST(Unit ## name, at, unit, at)                 \
+		}                                                                                \
+		{                                                                                \
+			ITERATE_ALLYTEAM_EVENTCLIENTLIST(UnitLosChangedBatch, at, unit, at, CEventClient::Los ## name) \
+		}                                                                                \
 	}
 
 UNIT_CALLIN_LOS_PARAM(EnteredRadar)
@@ -552,7 +562,12 @@ inline void CEventHandler::UnitDamaged(
 	int projectileID,
 	bool paralyzer)
 {
-	ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamaged, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
+	{
+		ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamaged, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
+	}
+	{
+		ITERATE_UNIT_ALLYTEAM_EVENTCLIENTLIST(UnitDamagedBatch, unit, attacker, damage, weaponDefID, projectileID, paralyzer)
+	}
 }
 
 inline void CEventHandler::UnitStunned(
@@ -679,6 +694,11 @@ inline void CEventHandler::ProjectileCreated(const CProjectile* proj, int allyTe
 			ec->ProjectileCreated(proj);
 		}
 	}
+
+	for (CEventClient* ec: listProjectileCreatedBatch) {
+		if ((allyTeam < 0) || ec->CanReadAllyTeam(allyTeam))
+			ec->ProjectileCreatedBatch(proj);
+	}
 }
 
 
@@ -15,6 +15,7 @@
 #include "FileSystem.h"
 #include "DataDirsAccess.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/StartupTrace.h"
 
 static CPoolArchiveFactory sdpArchiveFactory;
 static CDirArchiveFactory sddArchiveFactory;
@@ -60,6 +61,7 @@ bool CArchiveLoader::IsArchiveFile(const std::string& fileName) const
 
 IArchive* CArchiveLoader::OpenArchive(const std::string& fileName, const std::string& type) const
 {
+	SCOPED_STARTUP_TRACE("CArchiveLoader::OpenArchive(" + fileName + ")", "archive")
 	IArchive* ret = nullptr;
 
 	const std::string fileExt = type.empty() ? FileSystem::GetExtension(fileName) : type;
@@ -2,10 +2,14 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstdio>
 #include <memory>
 #include <random>
+#include <semaphore>
 #include <chrono>
+#include <cstring>
+#include <type_traits>
 
 #include <sys/types.h>
 #include <sys/stat.h>
@@ -22,6 +26,7 @@
 #include "DataDirsAccess.h"
 #include "FileSystem.h"
 #include "FileQueryFlags.h"
+#include "MemoryMappedFile.h"
 #include "Lua/LuaParser.h"
 #include "System/ContainerUtil.h"
 #include "System/StringUtil.h"
@@ -30,6 +35,7 @@
 #include "System/FileSystem/RapidHandler.h"
 #include "System/FileSystem/Archives/PoolArchive.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/StartupTrace.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/UnorderedMap.hpp"
 #include "System/UnorderedSet.hpp"
@@ -61,6 +67,82 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_ARCHIVESCANNER)
 constexpr static int INTERNAL_VER = 20;
 
 
+/*
+ * Binary form of the ArchiveCache, read through a memory mapping instead of
+ * being parsed by Lua. All integers are native-endian; strings are stored
+ * once in a shared table and referenced by index, variable-length members
+ * (filesInfo, archivedata items, dependencies) as ranges into flat arrays.
+ * Sections follow the header in declaration order, string bytes come last.
+ */
+namespace BinCache {
+	static constexpr char MAGIC[8] = {'R', 'C', 'L', 'A', 'C', 'A', 'C', 'H'};
+	static constexpr uint32_t FORMAT_VER = 1;
+	static constexpr uint32_t ENDIAN_TAG = 0x01020304;
+
+	struct Header {
+		char magic[8];
+		uint32_t formatVer;
+		uint32_t internalVer;
+		uint32_t endianTag;
+
+		uint32_t numStrings;
+		uint32_t numArchives;
+		uint32_t numBrokenArchives;
+		// filesInfo entries of all archives, followed by numPoolFiles pool entries
+		uint32_t numFileInfos;
+		uint32_t numPoolFiles;
+		uint32_t numInfoItems;
+		uint32_t numDepends;
+		uint32_t stringBytes;
+	};
+
+	struct ArchiveRecord {
+		uint32_t name;
+		uint32_t path;
+		uint32_t archiveDataPath;
+		uint32_t modified;
+		uint32_t modifiedArchiveData;
+
+		uint32_t firstFileInfo, numFileInfos;
+		uint32_t firstInfoItem, numInfoItems;
+		uint32_t firstDepend, numDepends;
+
+		sha512::raw_digest checksum;
+	};
+
+	struct BrokenRecord {
+		uint32_t name;
+		uint32_t path;
+		uint32_t problem;
+		uint32_t modified;
+	};
+
+	struct FileInfoRecord {
+		uint32_t fileName;
+		int32_t size;
+		uint32_t modTime;
+
+		sha512::raw_digest checksum;
+	};
+
+	struct InfoItemRecord {
+		uint32_t key;
+		uint32_t valueType;
+		// string index for INFO_VALUE_TYPE_STRING, raw value bits otherwise
+		uint32_t value;
+	};
+
+	static_assert(std::is_trivially_copyable_v<ArchiveRecord>);
+	static_assert(std::is_trivially_copyable_v<FileInfoRecord>);
+	static_assert((sizeof(Header) % 4) == 0 && (sizeof(ArchiveRecord) % 4) == 0 && (sizeof(FileInfoRecord) % 4) == 0);
+
+	static std::string GetPath(const std::string& luaCachePath)
+	{
+		return (luaCachePath.substr(0, luaCachePath.size() - FileSystem::GetExtension(luaCachePath).size()) + "bin");
+	}
+}
+
+
 /*
  * Engine known (and used?) tags in [map|mod]info.lua
  */
@@ -620,6 +702,24 @@ void CArchiveScanner::ReadCache()
 
     cacheFile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua");
 
+	// prefer the binary cache unless the Lua one was rewritten since, e.g. by an older engine
+	const std::string binCacheFile = BinCache::GetPath(cacheFile);
+	const uint32_t binCacheTime = FileSystemAbstraction::GetFileModificationTime(binCacheFile);
+	const uint32_t luaCacheTime = FileSystemAbstraction::GetFileModificationTime(cacheFile);
+
+	if (binCacheTime != 0 && binCacheTime >= luaCacheTime) {
+		if (ReadBinaryCacheData(binCacheFile)) {
+			ScanAllDirs();
+			return;
+		}
+
+		// discard whatever was read before the error
+		const std::string luaCacheFile = std::move(cacheFile);
+
+		Clear();
+		cacheFile = std::move(luaCacheFile);
+	}
+
 	if (!FileSystem::FileExists(cacheFile)) {
 		// Try to save initial scanning of assets, but will have to redo hashing
 		// as the previous version had bugs in that area
@@ -699,6 +799,8 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	if (CheckCachedData(fullName, modifiedTime, doChecksum))
 		return;
 
+	SCOPED_STARTUP_TRACE("CArchiveScanner::ScanArchive(" + fullName + ")", "archive")
+
 	isDirty = true;
 	isInScan = true;
 
@@ -973,18 +1075,81 @@ IFileFilter* CArchiveScanner::CreateIgnoreFilter(IArchive* ar)
  * Returns 0 if file could not be opened.
  */
 bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, ArchiveInfo& archiveInfo)
+{
+	std::vector<ArchiveHashJob> jobs(1);
+
+	if (!PrepareArchiveChecksum(archiveName, archiveInfo, jobs.front()))
+		return false;
+
+	HashArchiveFiles(jobs);
+	return (FinishArchiveChecksum(jobs.front()));
+}
+
+/**
+ * Checksums all not yet hashed archives among archivePaths in one
+ * go, s.t. the files of all of them are spread over the thread-pool
+ * rather than only those of a single archive at a time.
+ */
+void CArchiveScanner::GetArchiveChecksums(const std::vector<std::string>& archivePaths)
+{
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+	std::vector<ArchiveHashJob> jobs;
+	jobs.reserve(archivePaths.size());
+
+	// (re)scan first, this may add to archiveInfos and invalidate references
+	for (const std::string& archivePath: archivePaths) {
+		// virtual archives are always rescanned and hashed by ScanArchive
+		if (FileSystem::GetExtension(archivePath) == "sva")
+			continue;
+
+		ScanArchive(archivePath, false);
+	}
+
+	for (const std::string& archivePath: archivePaths) {
+		if (FileSystem::GetExtension(archivePath) == "sva")
+			continue;
+
+		const auto aiIter = archiveInfosIndex.find(StringToLower(FileSystem::GetFilename(archivePath)));
+
+		if (aiIter == archiveInfosIndex.end())
+			continue;
+
+		ArchiveInfo& ai = archiveInfos[aiIter->second];
+
+		if (ai.hashed || !ai.replaced.empty())
+			continue;
+
+		if (!PrepareArchiveChecksum(archivePath, ai, jobs.emplace_back()))
+			jobs.pop_back();
+	}
+
+	if (jobs.empty())
+		return;
+
+	HashArchiveFiles(jobs);
+
+	for (ArchiveHashJob& job: jobs) {
+		isDirty |= (job.archiveInfo->hashed = FinishArchiveChecksum(job));
+	}
+}
+
+bool CArchiveScanner::PrepareArchiveChecksum(const std::string& archiveName, ArchiveInfo& archiveInfo, ArchiveHashJob& job)
 {
 	// try to open an archive
-	std::unique_ptr<IArchive> ar(archiveLoader.OpenArchive(archiveName));
+	job.ar.reset(archiveLoader.OpenArchive(archiveName));
+	job.archiveInfo = &archiveInfo;
 
-	if (ar == nullptr)
+	if (job.ar == nullptr)
 		return false;
 
+	const auto& ar = job.ar;
 	const bool sdpArchive = (ar->GetType() == ARCHIVE_TYPE_SDP);
-	const bool compressedArchive = (ar->GetType() == ARCHIVE_TYPE_SD7 || ar->GetType() == ARCHIVE_TYPE_SDZ);
 
 	// load ignore list
-	std::unique_ptr<IFileFilter> ignore(CreateIgnoreFilter(ar.get()));
+	job.ignore.reset(CreateIgnoreFilter(ar.get()));
+
+	const auto& ignore = job.ignore;
 
 	// warm up. For some archive types ar->FileInfo(fid) is a mutable operation loading important IArchive::SFileInfo fields
 	std::atomic_uint32_t numFiles = {0};
@@ -999,7 +1164,7 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 	});
 
 	// store relevant lowercased filenames from the archive
-	std::vector<std::string> fileNames;
+	std::vector<std::string>& fileNames = job.fileNames;
 
 	fileNames.reserve(numFiles.load());
 	archiveInfo.filesInfo.reserve(numFiles.load());
@@ -1031,22 +1196,77 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 		fileNames.emplace_back(std::move(fi.fileName));
 	}
 
+	return true;
+}
+
+void CArchiveScanner::HashArchiveFiles(std::vector<ArchiveHashJob>& jobs)
+{
+	// files at least this large are read by at most NUM_LARGE_FILE_READS
+	// threads at a time, and their per-thread buffers are released after
+	// hashing; bounds the memory held by whole-file reads of large .smf's
+	// and pool entries
+	static constexpr int32_t LARGE_FILE_SIZE = 32 * 1024 * 1024;
+	static constexpr uint32_t NUM_LARGE_FILE_READS = 2;
+
+	static std::counting_semaphore<NUM_LARGE_FILE_READS> largeFileReads(NUM_LARGE_FILE_READS);
+
+	// flattened (job, file) pairs
+	std::vector<std::pair<uint32_t, uint32_t>> hashTasks;
+
+	for (size_t j = 0; j < jobs.size(); j++) {
+		const auto& filesInfo = jobs[j].archiveInfo->filesInfo;
+		const auto& fileNames = jobs[j].fileNames;
+
+		for (size_t i = 0; i < fileNames.size(); i++) {
+			const auto it = filesInfo.find(fileNames[i]);
+			assert(it != filesInfo.end());
+
+			if (it->second.checksum != sha512::NULL_RAW_DIGEST)
+				continue;
+
+			hashTasks.emplace_back(j, i);
+		}
+	}
+
 	std::array<std::vector<uint8_t>, ThreadPool::MAX_THREADS> fileBuffers;
 
-	for_mt(0, fileNames.size(), [&ar, &fileNames = std::as_const(fileNames), &fileBuffers, &filesInfo = archiveInfo.filesInfo, this](int i) {
-		const auto& fileName = fileNames[i]; // note generally (i != fid) due to ignore->Match(fi.fileName) filtering
+	for_mt(0, hashTasks.size(), [&jobs, &hashTasks = std::as_const(hashTasks), &fileBuffers, this](int t) {
+		const auto [j, i] = hashTasks[t];
 
-		const auto it = filesInfo.find(fileName);
-		assert(it != filesInfo.end());
-		if (it->second.checksum != sha512::NULL_RAW_DIGEST)
-			return;
+		ArchiveHashJob& job = jobs[j];
+
+		const auto& fileName = job.fileNames[i]; // note generally (i != fid) due to ignore->Match(fi.fileName) filtering
+		const auto it = job.archiveInfo->filesInfo.find(fileName);
+		assert(it != job.archiveInfo->filesInfo.end());
+
+		const bool largeFile = (it->second.size >= LARGE_FILE_SIZE);
 
 		auto& fileBuffer = fileBuffers[ThreadPool::GetThreadNum()];
 		fileBuffer.clear();
 
+		if (largeFile)
+			largeFileReads.acquire();
+
 		// note ar->FindFile() converts to lowercase
-		numFilesHashed.fetch_add(static_cast<uint32_t>(ar->CalcHash(ar->FindFile(fileName), it->second.checksum, fileBuffer)));
+		numFilesHashed.fetch_add(static_cast<uint32_t>(job.ar->CalcHash(job.ar->FindFile(fileName), it->second.checksum, fileBuffer)));
+
+		if (largeFile) {
+			fileBuffer = {};
+			largeFileReads.release();
+		}
 	});
+}
+
+bool CArchiveScanner::FinishArchiveChecksum(ArchiveHashJob& job)
+{
+	const auto& ar = job.ar;
+	const auto& ignore = job.ignore;
+
+	ArchiveInfo& archiveInfo = *job.archiveInfo;
+	std::vector<std::string>& fileNames = job.fileNames;
+
+	const bool sdpArchive = (ar->GetType() == ARCHIVE_TYPE_SDP);
+	const bool compressedArchive = (ar->GetType() == ARCHIVE_TYPE_SD7 || ar->GetType() == ARCHIVE_TYPE_SDZ);
 
 	// stable sort by filename
 	std::stable_sort(fileNames.begin(), fileNames.end(), [](const auto& lhs, const auto& rhs) {
@@ -1126,6 +1346,7 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 
 bool CArchiveScanner::ReadCacheData(const std::string& filename, bool loadOldVersion)
 {
+	SCOPED_STARTUP_TRACE("CArchiveScanner::ReadCacheData", "archive")
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
 	if (!FileSystem::FileExists(filename)) {
 		LOG_L(L_INFO, "[AS::%s] ArchiveCache %s doesn't exist", __func__, filename.c_str());
@@ -1423,10 +1644,309 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 	if (fclose(out) == EOF)
 		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
 
+	WriteBinaryCacheData(BinCache::GetPath(filename));
+
 	isDirty = false;
 }
 
 
+bool CArchiveScanner::ReadBinaryCacheData(const std::string& filename)
+{
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+	CMemoryMappedFile file;
+
+	if (!file.Open(filename))
+		return false;
+
+	const uint8_t* data = file.GetData();
+	const size_t size = file.GetSize();
+
+	if (size < sizeof(BinCache::Header))
+		return false;
+
+	BinCache::Header hdr;
+	std::memcpy(&hdr, data, sizeof(hdr));
+
+	if (std::memcmp(hdr.magic, BinCache::MAGIC, sizeof(hdr.magic)) != 0)
+		return false;
+	if (hdr.formatVer != BinCache::FORMAT_VER || hdr.internalVer != INTERNAL_VER || hdr.endianTag != BinCache::ENDIAN_TAG)
+		return false;
+
+	const size_t numFileInfos = size_t(hdr.numFileInfos) + hdr.numPoolFiles;
+
+	const size_t stringOffsetsPos = sizeof(BinCache::Header);
+	const size_t archivesPos  = stringOffsetsPos + (size_t(hdr.numStrings) + 1) * sizeof(uint32_t);
+	const size_t brokenPos    = archivesPos  + size_t(hdr.numArchives      ) * sizeof(BinCache::ArchiveRecord);
+	const size_t fileInfosPos = brokenPos    + size_t(hdr.numBrokenArchives) * sizeof(BinCache::BrokenRecord);
+	const size_t infoItemsPos = fileInfosPos +               numFileInfos      * sizeof(BinCache::FileInfoRecord);
+	const size_t dependsPos   = infoItemsPos + size_t(hdr.numInfoItems     ) * sizeof(BinCache::InfoItemRecord);
+	const size_t stringsPos   = dependsPos   + size_t(hdr.numDepends       ) * sizeof(uint32_t);
+
+	if ((stringsPos + hdr.stringBytes) != size) {
+		LOG_L(L_WARNING, "[AS::%s] truncated or corrupt ArchiveCache \"%s\"", __func__, filename.c_str());
+		return false;
+	}
+
+	// all sections are 4-byte aligned relative to the page-aligned mapping
+	const auto* stringOffsets = reinterpret_cast<const uint32_t*>(data + stringOffsetsPos);
+	const auto* archiveRecs   = reinterpret_cast<const BinCache::ArchiveRecord*>(data + archivesPos);
+	const auto* brokenRecs    = reinterpret_cast<const BinCache::BrokenRecord*>(data + brokenPos);
+	const auto* fileInfoRecs  = reinterpret_cast<const BinCache::FileInfoRecord*>(data + fileInfosPos);
+	const auto* infoItemRecs  = reinterpret_cast<const BinCache::InfoItemRecord*>(data + infoItemsPos);
+	const auto* dependRecs    = reinterpret_cast<const uint32_t*>(data + dependsPos);
+	const auto* stringBytes   = reinterpret_cast<const char*>(data + stringsPos);
+
+	for (uint32_t i = 0; i < hdr.numStrings; i++) {
+		if (stringOffsets[i] > stringOffsets[i + 1] || stringOffsets[i + 1] > hdr.stringBytes)
+			return false;
+	}
+
+	bool valid = true;
+
+	const auto GetString = [&](uint32_t idx) -> std::string {
+		if (idx >= hdr.numStrings) {
+			valid = false;
+			return {};
+		}
+
+		return {stringBytes + stringOffsets[idx], stringBytes + stringOffsets[idx + 1]};
+	};
+	const auto ValidRange = [](uint32_t first, uint32_t count, size_t total) {
+		return (first <= total && count <= (total - first));
+	};
+	const auto ReadFileInfos = [&](uint32_t first, uint32_t count, spring::unordered_map<std::string, FileInfo>& filesInfoMap) {
+		filesInfoMap.reserve(filesInfoMap.size() + count);
+
+		for (uint32_t j = first; j < (first + count); j++) {
+			const BinCache::FileInfoRecord& rec = fileInfoRecs[j];
+
+			FileInfo& fi = filesInfoMap[GetString(rec.fileName)];
+			fi.size = rec.size;
+			fi.modTime = rec.modTime;
+			fi.checksum = rec.checksum;
+		}
+	};
+
+	for (uint32_t i = 0; i < hdr.numArchives && valid; ++i) {
+		const BinCache::ArchiveRecord& rec = archiveRecs[i];
+
+		if (!ValidRange(rec.firstFileInfo, rec.numFileInfos, hdr.numFileInfos) ||
+			!ValidRange(rec.firstInfoItem, rec.numInfoItems, hdr.numInfoItems) ||
+			!ValidRange(rec.firstDepend, rec.numDepends, hdr.numDepends)) {
+			valid = false;
+			break;
+		}
+
+		const std::string curArchiveName = GetString(rec.name);
+
+		ArchiveInfo& ai = GetAddArchiveInfo(StringToLower(curArchiveName));
+
+		ai.origName        = curArchiveName;
+		ai.path            = GetString(rec.path);
+		ai.archiveDataPath = GetString(rec.archiveDataPath);
+
+		ai.modified = rec.modified;
+		ai.modifiedArchiveData = rec.modifiedArchiveData;
+
+		ReadFileInfos(rec.firstFileInfo, rec.numFileInfos, ai.filesInfo);
+
+		ai.checksum = rec.checksum;
+
+		ai.updated = false;
+		ai.hashed = (ai.checksum != sha512::NULL_RAW_DIGEST);
+
+		ai.archiveData = {};
+
+		if (rec.numInfoItems == 0)
+			continue;
+
+		for (uint32_t j = rec.firstInfoItem; j < (rec.firstInfoItem + rec.numInfoItems); j++) {
+			const BinCache::InfoItemRecord& item = infoItemRecs[j];
+			const std::string key = GetString(item.key);
+
+			switch (item.valueType) {
+				case INFO_VALUE_TYPE_STRING : { ai.archiveData.SetInfoItemValueString (key, GetString(item.value)); } break;
+				case INFO_VALUE_TYPE_INTEGER: { ai.archiveData.SetInfoItemValueInteger(key, std::bit_cast<int  >(item.value)); } break;
+				case INFO_VALUE_TYPE_FLOAT  : { ai.archiveData.SetInfoItemValueFloat  (key, std::bit_cast<float>(item.value)); } break;
+				case INFO_VALUE_TYPE_BOOL   : { ai.archiveData.SetInfoItemValueBool   (key, item.value != 0); } break;
+				default                     : { valid = false; } break;
+			}
+		}
+
+		for (uint32_t j = rec.firstDepend; j < (rec.firstDepend + rec.numDepends); j++) {
+			ai.archiveData.GetDependencies().emplace_back(GetString(dependRecs[j]));
+		}
+
+		if (ai.archiveData.IsMap()) {
+			AddDependency(ai.archiveData.GetDependencies(), GetMapHelperContentName());
+		} else if (ai.archiveData.IsGame()) {
+			AddDependency(ai.archiveData.GetDependencies(), GetSpringBaseContentName());
+		}
+	}
+
+	for (uint32_t i = 0; i < hdr.numBrokenArchives && valid; ++i) {
+		const BinCache::BrokenRecord& rec = brokenRecs[i];
+		const std::string name = StringToLower(GetString(rec.name));
+
+		BrokenArchive& ba = GetAddBrokenArchive(name);
+		ba.name = name;
+		ba.path = GetString(rec.path);
+		ba.modified = rec.modified;
+		ba.updated = false;
+		ba.problem = GetString(rec.problem);
+	}
+
+	if (valid)
+		ReadFileInfos(hdr.numFileInfos, hdr.numPoolFiles, poolFilesInfo);
+
+	if (!valid) {
+		LOG_L(L_WARNING, "[AS::%s] corrupt ArchiveCache \"%s\"", __func__, filename.c_str());
+		return false;
+	}
+
+	isDirty = false;
+
+	return true;
+}
+
+void CArchiveScanner::WriteBinaryCacheData(const std::string& filename) const
+{
+	BinCache::Header hdr;
+	std::memcpy(hdr.magic, BinCache::MAGIC, sizeof(hdr.magic));
+
+	hdr.formatVer = BinCache::FORMAT_VER;
+	hdr.internalVer = INTERNAL_VER;
+	hdr.endianTag = BinCache::ENDIAN_TAG;
+
+	spring::unordered_map<std::string, uint32_t> stringIndices;
+	std::vector<uint32_t> stringOffsets = {0};
+	std::string stringBytes;
+
+	std::vector<BinCache::ArchiveRecord> archiveRecs;
+	std::vector<BinCache::BrokenRecord> brokenRecs;
+	std::vector<BinCache::FileInfoRecord> fileInfoRecs;
+	std::vector<BinCache::InfoItemRecord> infoItemRecs;
+	std::vector<uint32_t> dependRecs;
+
+	const auto AddString = [&](const std::string& str) -> uint32_t {
+		const auto iter = stringIndices.find(str);
+
+		if (iter != stringIndices.end())
+			return (iter->second);
+
+		const uint32_t idx = uint32_t(stringIndices.size());
+
+		stringBytes.append(str);
+		stringOffsets.push_back(uint32_t(stringBytes.size()));
+		stringIndices.emplace(str, idx);
+
+		return idx;
+	};
+	const auto AddFileInfos = [&](const spring::unordered_map<std::string, FileInfo>& filesInfoMap) {
+		for (const auto& [fn, fi]: filesInfoMap) {
+			fileInfoRecs.push_back({AddString(fn), fi.size, fi.modTime, fi.checksum});
+		}
+	};
+
+	archiveRecs.reserve(archiveInfos.size());
+	brokenRecs.reserve(brokenArchives.size());
+	fileInfoRecs.reserve(poolFilesInfo.size());
+
+	for (const ArchiveInfo& arcInfo: archiveInfos) {
+		BinCache::ArchiveRecord& rec = archiveRecs.emplace_back();
+
+		rec.name = AddString(arcInfo.origName);
+		rec.path = AddString(arcInfo.path);
+		rec.archiveDataPath = AddString(arcInfo.archiveDataPath);
+		rec.modified = arcInfo.modified;
+		rec.modifiedArchiveData = arcInfo.modifiedArchiveData;
+		rec.checksum = arcInfo.checksum;
+
+		rec.firstFileInfo = uint32_t(fileInfoRecs.size());
+		AddFileInfos(arcInfo.filesInfo);
+		rec.numFileInfos = uint32_t(fileInfoRecs.size()) - rec.firstFileInfo;
+
+		rec.firstInfoItem = uint32_t(infoItemRecs.size());
+		rec.firstDepend = uint32_t(dependRecs.size());
+
+		// same filtering as the Lua cache
+		const ArchiveData& archData = arcInfo.archiveData;
+
+		if (!archData.GetName().empty()) {
+			for (const auto& [key, item]: archData.GetInfo()) {
+				BinCache::InfoItemRecord& itemRec = infoItemRecs.emplace_back();
+
+				itemRec.key = AddString(key);
+				itemRec.valueType = item.valueType;
+
+				switch (item.valueType) {
+					case INFO_VALUE_TYPE_STRING : { itemRec.value = AddString(item.valueTypeString); } break;
+					case INFO_VALUE_TYPE_INTEGER: { itemRec.value = std::bit_cast<uint32_t>(item.value.typeInteger); } break;
+					case INFO_VALUE_TYPE_FLOAT  : { itemRec.value = std::bit_cast<uint32_t>(item.value.typeFloat); } break;
+					case INFO_VALUE_TYPE_BOOL   : { itemRec.value = uint32_t(item.value.typeBool); } break;
+				}
+			}
+
+			std::vector<std::string> deps = archData.GetDependencies();
+			if (archData.IsMap()) {
+				FilterDep(deps, GetMapHelperContentName());
+			} else if (archData.IsGame()) {
+				FilterDep(deps, GetSpringBaseContentName());
+			}
+
+			for (const auto& dep: deps) {
+				dependRecs.push_back(AddString(dep));
+			}
+		}
+
+		rec.numInfoItems = uint32_t(infoItemRecs.size()) - rec.firstInfoItem;
+		rec.numDepends = uint32_t(dependRecs.size()) - rec.firstDepend;
+	}
+
+	hdr.numFileInfos = uint32_t(fileInfoRecs.size());
+	AddFileInfos(poolFilesInfo);
+	hdr.numPoolFiles = uint32_t(fileInfoRecs.size()) - hdr.numFileInfos;
+
+	for (const BrokenArchive& ba: brokenArchives) {
+		brokenRecs.push_back({AddString(ba.name), AddString(ba.path), AddString(ba.problem), ba.modified});
+	}
+
+	hdr.numStrings = uint32_t(stringIndices.size());
+	hdr.numArchives = uint32_t(archiveRecs.size());
+	hdr.numBrokenArchives = uint32_t(brokenRecs.size());
+	hdr.numInfoItems = uint32_t(infoItemRecs.size());
+	hdr.numDepends = uint32_t(dependRecs.size());
+	hdr.stringBytes = uint32_t(stringBytes.size());
+
+	FILE* out = fopen(filename.c_str(), "wb");
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+		return;
+	}
+
+	const auto WriteSection = [out](const void* ptr, size_t numBytes) {
+		return (numBytes == 0 || fwrite(ptr, numBytes, 1, out) == 1);
+	};
+
+	bool written = true;
+	written &= WriteSection(&hdr, sizeof(hdr));
+	written &= WriteSection(stringOffsets.data(), stringOffsets.size() * sizeof(uint32_t));
+	written &= WriteSection(archiveRecs.data(), archiveRecs.size() * sizeof(BinCache::ArchiveRecord));
+	written &= WriteSection(brokenRecs.data(), brokenRecs.size() * sizeof(BinCache::BrokenRecord));
+	written &= WriteSection(fileInfoRecs.data(), fileInfoRecs.size() * sizeof(BinCache::FileInfoRecord));
+	written &= WriteSection(infoItemRecs.data(), infoItemRecs.size() * sizeof(BinCache::InfoItemRecord));
+	written &= WriteSection(dependRecs.data(), dependRecs.size() * sizeof(uint32_t));
+	written &= WriteSection(stringBytes.data(), stringBytes.size());
+
+	if ((fclose(out) == EOF) || !written) {
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+		// never leave a partial file behind, the Lua cache still has everything
+		FileSystem::Remove(filename);
+	}
+}
+
+
 static void sortByName(std::vector<CArchiveScanner::ArchiveData>& data)
 {
 	std::stable_sort(data.begin(), data.end(), [](const CArchiveScanner::ArchiveData& a, const CArchiveScanner::ArchiveData& b) {
@@ -1672,12 +2192,21 @@ sha512::raw_digest CArchiveScanner::GetArchiveSingleChecksumBytes(const std::str
 
 sha512::raw_digest CArchiveScanner::GetArchiveCompleteChecksumBytes(const std::string& name)
 {
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
 	sha512::raw_digest checksum{0};
+	std::vector<std::string> archivePaths;
 
 	for (const std::string& depName: GetAllArchivesUsedBy(name)) {
 		const std::string& archiveName = ArchiveFromName(depName);
-		const std::string  archivePath = GetArchivePath(archiveName) + archiveName;
 
+		archivePaths.emplace_back(GetArchivePath(archiveName) + archiveName);
+	}
+
+	// hash all dependencies at once, then just collect their (now cached) checksums
+	GetArchiveChecksums(archivePaths);
+
+	for (const std::string& archivePath: archivePaths) {
 		const sha512::raw_digest archiveChecksum = GetArchiveSingleChecksumBytes(archivePath);
 
 		for (uint8_t i = 0; i < sha512::SHA_LEN; i++) {
@@ -8,6 +8,7 @@
 #include <deque>
 #include <vector>
 #include <atomic>
+#include <memory>
 
 #include "System/Info.h"
 #include "System/Sync/SHA512.hpp"
@@ -187,6 +188,15 @@ private:
 		bool updated = false;
 		bool hashed = false;
 	};
+	struct ArchiveHashJob {
+		std::unique_ptr<IArchive> ar;
+		std::unique_ptr<IFileFilter> ignore;
+
+		ArchiveInfo* archiveInfo = nullptr;
+
+		// relevant files, not yet sorted
+		std::vector<std::string> fileNames;
+	};
 	struct BrokenArchive {
 		std::string name;         // lower-case
 		std::string path;         // FileSystem::GetDirectory(origName)
@@ -218,6 +228,10 @@ private:
 	bool ReadCacheData(const std::string& filename, bool loadOldVersion = false);
 	void WriteCacheData(const std::string& filename);
 
+	/// versioned binary form of the cache, written next to the Lua one
+	bool ReadBinaryCacheData(const std::string& filename);
+	void WriteBinaryCacheData(const std::string& filename) const;
+
 	IFileFilter* CreateIgnoreFilter(IArchive* ar);
 
 	/**
@@ -225,6 +239,12 @@ private:
 	 * Returns false if file could not be opened.
 	 */
 	bool GetArchiveChecksum(const std::string& filename, ArchiveInfo& archiveInfo);
+	/// hashes the given archives together, spreading all their files over the thread-pool
+	void GetArchiveChecksums(const std::vector<std::string>& archivePaths);
+
+	bool PrepareArchiveChecksum(const std::string& archiveName, ArchiveInfo& archiveInfo, ArchiveHashJob& job);
+	void HashArchiveFiles(std::vector<ArchiveHashJob>& jobs);
+	bool FinishArchiveChecksum(ArchiveHashJob& job);
 
 	bool CheckCachedData(const std::string& fullName, unsigned& modified, bool doChecksum);
 
@@ -4,6 +4,7 @@
 #include "System/GlobalConfig.h"
 #include "System/MainDefines.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <cassert>
 
@@ -72,3 +73,36 @@ bool CBufferedArchive::GetFile(uint32_t fid, std::vector<std::uint8_t>& buffer)
 	
 	return (ret == 1);
 }
+
+void CBufferedArchive::PrefetchFiles(const std::vector<uint32_t>& fids)
+{
+	if (!globalConfig.vfsCacheArchiveFiles || noCache)
+		return;
+
+	{
+		std::scoped_lock lck(mutex);
+		if (fileCache.empty())
+			fileCache.resize(NumFiles());
+	}
+
+	// same access pattern as GetFile: every fid is touched by one thread
+	for_mt(0, fids.size(), [&](int i) {
+		const uint32_t fid = fids[i];
+
+		assert(IsFileId(fid));
+
+		auto& [numAccessed, gotBuffered, fileData] = fileCache[fid];
+
+		if (gotBuffered)
+			return;
+
+		auto scopedSemAcq = AcquireSemaphoreScoped();
+
+		// unlike on-demand reads, cache right away since the file is known to be needed
+		if (GetFileImpl(fid, fileData) == 1) {
+			gotBuffered = true;
+		} else {
+			fileData.clear();
+		}
+	});
+}
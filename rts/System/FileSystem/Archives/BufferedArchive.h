@@ -24,6 +24,8 @@ public:
 	int GetType() const override { return ARCHIVE_TYPE_BUF; }
 
 	bool GetFile(uint32_t fid, std::vector<std::uint8_t>& buffer) override;
+	// decompresses the files concurrently on the thread-pool, returns when all are cached
+	void PrefetchFiles(const std::vector<uint32_t>& fids) override;
 
 protected:
 	virtual int GetFileImpl(uint32_t fid, std::vector<std::uint8_t>& buffer) = 0;
@@ -8,6 +8,7 @@
 #include <cinttypes>
 #include <memory>
 #include <semaphore>
+#include <span>
 
 #include "ArchiveTypes.h"
 #include "System/Sync/SHA512.hpp"
@@ -89,6 +90,20 @@ public:
 	 * @see GetFile(uint32_t fid, std::vector<std::uint8_t>& buffer)
 	 */
 	bool GetFile(const std::string& name, std::vector<std::uint8_t>& buffer);
+	/**
+	 * Reads the given files ahead of use s.t. later GetFile calls are served
+	 * from memory; a no-op for archives that do not cache their contents.
+	 * @param fids file IDs in [0, NumFiles())
+	 */
+	virtual void PrefetchFiles(const std::vector<uint32_t>& fids) {}
+	/**
+	 * Returns the content of a file in place, without reading it into a
+	 * buffer; only possible for files stored uncompressed.
+	 * @param fid file ID in [0, NumFiles())
+	 * @return read-only view valid for the lifetime of the archive, or an
+	 *   empty span if the file has to be fetched through GetFile
+	 */
+	virtual std::span<const std::uint8_t> GetFileView(uint32_t fid) { return {}; }
 
 	uint32_t ExtractedSize() const {
 		uint32_t size = 0;
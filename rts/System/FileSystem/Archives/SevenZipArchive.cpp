@@ -190,8 +190,8 @@ CSevenZipArchive::~CSevenZipArchive()
 		if (!data)
 			continue;
 
-		if (data->outBuffer != nullptr) {
-			IAlloc_Free(&allocImp, data->outBuffer);
+		for (const DecodedBlock& block: data->decodedBlocks) {
+			IAlloc_Free(&allocImp, block.buffer);
 		}
 		ISzAlloc_Free(&allocImp, data->lookStream.buf);
 		SzArEx_Free(&data->db, &allocImp);
@@ -212,26 +212,73 @@ int CSevenZipArchive::GetFileImpl(uint32_t fid, std::vector<std::uint8_t>& buffe
 
 	auto& db            = perThreadData[tnum]->db;
 	auto& lookStream    = perThreadData[tnum]->lookStream;
-	auto& outBuffer     = perThreadData[tnum]->outBuffer;
-	auto& blockIndex    = perThreadData[tnum]->blockIndex;
-	auto& outBufferSize = perThreadData[tnum]->outBufferSize;
+	auto& decodedBlocks = perThreadData[tnum]->decodedBlocks;
+
+	const uint32_t fp = fileEntries[fid].fp;
+
+	// SzArEx_Extract only reuses the block it decoded last, and solid blocks have to be
+	// decoded from their start for each file; hand it a previously decoded one if any
+	const auto pred = [folderIndex = db.FileToFolder[fp]](const DecodedBlock& b) { return (b.blockIndex == folderIndex); };
+	const auto iter = std::find_if(decodedBlocks.begin(), decodedBlocks.end(), pred);
+
+	UInt32 blockIndex = 0xFFFFFFFF;
+	size_t outBufferSize = 0;
+	Byte* outBuffer = nullptr;
+
+	if (iter != decodedBlocks.end()) {
+		std::rotate(iter, iter + 1, decodedBlocks.end());
+
+		blockIndex    = decodedBlocks.back().blockIndex;
+		outBufferSize = decodedBlocks.back().size;
+		outBuffer     = decodedBlocks.back().buffer;
+		decodedBlocks.pop_back();
+	}
 
 	size_t offset = 0;
 	size_t outSizeProcessed = 0;
 
-	if (auto res = SzArEx_Extract(&db, &lookStream.vt, fileEntries[fid].fp, &blockIndex, &outBuffer, &outBufferSize, &offset, &outSizeProcessed, &allocImp, &allocTempImp); res != SZ_OK) {
+	if (auto res = SzArEx_Extract(&db, &lookStream.vt, fp, &blockIndex, &outBuffer, &outBufferSize, &offset, &outSizeProcessed, &allocImp, &allocTempImp); res != SZ_OK) {
 		LOG_L(L_ERROR, "[%s] error opening \"%s\": %s", __func__, archiveFile.c_str(), GetErrorStr(res));
+		IAlloc_Free(&allocImp, outBuffer);
 		return 0;
 	}
 
-
 	buffer.resize(outSizeProcessed);
 	if (outSizeProcessed > 0) {
 		memcpy(buffer.data(), reinterpret_cast<char*>(outBuffer) + offset, outSizeProcessed);
 	}
+
+	// empty files belong to no block and leave no buffer behind
+	if (outBuffer != nullptr) {
+		decodedBlocks.push_back({blockIndex, outBufferSize, outBuffer});
+		TrimDecodedBlocks(decodedBlocks);
+	}
+
 	return 1;
 }
 
+void CSevenZipArchive::TrimDecodedBlocks(std::vector<DecodedBlock>& decodedBlocks)
+{
+	const size_t budget = DECODED_BLOCKS_BUDGET / parallelAccessNum;
+
+	size_t totalSize = 0;
+	size_t numEvicted = decodedBlocks.size() - 1;
+
+	// the most recent block is always kept, same as SzArEx_Extract does by itself
+	for (size_t i = decodedBlocks.size(); i > 0; --i) {
+		if ((totalSize += decodedBlocks[i - 1].size) > budget && i < decodedBlocks.size())
+			break;
+
+		numEvicted = i - 1;
+	}
+
+	for (size_t i = 0; i < numEvicted; ++i) {
+		IAlloc_Free(&allocImp, decodedBlocks[i].buffer);
+	}
+
+	decodedBlocks.erase(decodedBlocks.begin(), decodedBlocks.begin() + numEvicted);
+}
+
 const std::string& CSevenZipArchive::FileName(uint32_t fid) const
 {
 	assert(IsFileId(fid));
@@ -55,19 +55,27 @@ private:
 
 	Recoil::AtomicFirstIndex<uint32_t> afi;
 
+	struct DecodedBlock {
+		UInt32 blockIndex;
+		size_t size;
+		Byte* buffer;
+	};
+
 	struct PerThreadData {
 		CFileInStream archiveStream;
 		CSzArEx db;
 		CLookToRead2 lookStream;
-		UInt32 blockIndex = 0xFFFFFFFF;
-		size_t outBufferSize = 0;
-		Byte* outBuffer = nullptr;
+		// most recently used last
+		std::vector<DecodedBlock> decodedBlocks;
 	};
 
 	void OpenArchive(int tnum);
+	void TrimDecodedBlocks(std::vector<DecodedBlock>& decodedBlocks);
 
 	static inline spring::mutex archiveLock;
 	static constexpr size_t INPUT_BUF_SIZE = (size_t)1 << 18;
+	// memory kept for decoded solid blocks, split between the accessing threads
+	static constexpr size_t DECODED_BLOCKS_BUDGET = (size_t)1 << 28;
 
 	struct FileEntry {
 		int fp;
@@ -62,7 +62,8 @@ CZipArchive::CZipArchive(const std::string& archiveName)
 			info.uncompressed_size, //size
 			fName, //origName
 			info.crc, //crc
-			static_cast<uint32_t>(CTimeUtil::DosTimeToTime64(info.dosDate)) //modTime
+			static_cast<uint32_t>(CTimeUtil::DosTimeToTime64(info.dosDate)), //modTime
+			(info.compression_method == 0 && (info.flag & 1) == 0) //stored
 		);
 
 		lcNameIndex.emplace(StringToLower(fd.origName), fileEntries.size() - 1);
@@ -162,3 +163,48 @@ int CZipArchive::GetFileImpl(uint32_t fid, std::vector<std::uint8_t>& buffer)
 	return ret;
 }
 
+std::span<const std::uint8_t> CZipArchive::GetFileView(uint32_t fid)
+{
+	assert(IsFileId(fid));
+	const auto& fe = fileEntries[fid];
+
+	if (!fe.stored || fe.size <= 0)
+		return {};
+
+	std::call_once(mapArchiveFlag, [this]() { mappedArchive.Open(GetArchiveFile()); });
+
+	if (!mappedArchive.IsOpen())
+		return {};
+
+	// the local header has a variable size, let minizip parse it for the data offset
+	ZPOS64_T dataPos = 0;
+
+	{
+		auto scopedSemAcq = AcquireSemaphoreScoped();
+
+		const auto tnum = afi.AcquireScoped();
+		assert(tnum < parallelAccessNum);
+		unzFile& thisThreadZip = zipPerThread[tnum];
+
+		if (!thisThreadZip)
+			thisThreadZip = unzOpen(GetArchiveFile().c_str());
+
+		if (thisThreadZip == nullptr)
+			return {};
+
+		unz_file_pos fp = fe.fp;
+		unzGoToFilePos(thisThreadZip, &fp);
+
+		if (unzOpenCurrentFile(thisThreadZip) != UNZ_OK)
+			return {};
+
+		dataPos = unzGetCurrentFileZStreamPos64(thisThreadZip);
+		unzCloseCurrentFile(thisThreadZip);
+	}
+
+	if (dataPos == 0 || (dataPos + fe.size) > mappedArchive.GetSize())
+		return {};
+
+	// NB: unlike GetFile this does not verify the CRC
+	return {mappedArchive.GetData() + dataPos, static_cast<size_t>(fe.size)};
+}
@@ -6,8 +6,10 @@
 #include "IArchiveFactory.h"
 #include "BufferedArchive.h"
 #include "minizip/unzip.h"
+#include "System/FileSystem/MemoryMappedFile.h"
 #include "System/Threading/AtomicFirstIndex.hpp"
 
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -42,6 +44,8 @@ public:
 	int32_t FileSize(uint32_t fid) const override;
 	SFileInfo FileInfo(uint32_t fid) const override;
 
+	std::span<const std::uint8_t> GetFileView(uint32_t fid) override;
+
 	#if 0
 	uint32_t GetCrc32(uint32_t fid) {
 		assert(IsFileId(fid));
@@ -63,10 +67,16 @@ private:
 		std::string origName;
 		uint32_t crc;
 		uint32_t modTime;
+		// neither compressed nor encrypted, can be viewed in place
+		bool stored;
 	};
 
 	std::vector<FileEntry> fileEntries;
 
+	// whole archive, mapped on the first GetFileView call
+	CMemoryMappedFile mappedArchive;
+	std::once_flag mapArchiveFlag;
+
 	static inline spring::mutex archiveLock;
 };
 
@@ -38,10 +38,10 @@ CFileHandler::CFileHandler(const char* fileName, const char* modes)
 }
 
 
-CFileHandler::CFileHandler(const string& fileName, const string& modes)
+CFileHandler::CFileHandler(const string& fileName, const string& modes, bool mapView)
 {
 	Close();
-	Open(fileName, modes);
+	Open(fileName, modes, mapView);
 }
 
 
@@ -57,6 +57,9 @@ bool CFileHandler::TryReadFromPWD(const string& fileName)
 #else
 	const std::string fullpath(fileName);
 #endif
+	if (mapView && TryMapRawFile(fullpath))
+		return true;
+
 	ifs.open(fullpath.c_str(), std::ios::in | std::ios::binary);
 	if (ifs && !ifs.bad() && ifs.is_open()) {
 		ifs.seekg(0, std::ios_base::end);
@@ -73,6 +76,10 @@ bool CFileHandler::TryReadFromRawFS(const string& fileName)
 {
 #ifndef TOOLS
 	const string rawpath = dataDirsAccess.LocateFile(fileName);
+
+	if (mapView && TryMapRawFile(rawpath))
+		return true;
+
 	ifs.open(rawpath.c_str(), std::ios::in | std::ios::binary);
 	if (ifs && !ifs.bad() && ifs.is_open()) {
 		ifs.seekg(0, std::ios_base::end);
@@ -92,6 +99,12 @@ bool CFileHandler::TryReadFromVFS(const string& fileName, int section)
 	if (vfsHandler == nullptr)
 		return (loadCode = -2, false);
 
+	if (mapView && !(fileView = vfsHandler->GetFileView(StringToLower(fileName), (CVFSHandler::Section) section)).empty()) {
+		fileSize = fileView.size();
+		loadCode = 1;
+		return true;
+	}
+
 	if ((loadCode = vfsHandler->LoadFile(StringToLower(fileName), fileBuffer, (CVFSHandler::Section) section)) == 1) {
 		// capacity can exceed size if FH was used to open more than one file
 		// assert(fileBuffer.size() == fileBuffer.capacity());
@@ -104,9 +117,25 @@ bool CFileHandler::TryReadFromVFS(const string& fileName, int section)
 }
 
 
-void CFileHandler::Open(const string& fileName, const string& modes)
+bool CFileHandler::TryMapRawFile(const std::string& filePath)
+{
+	// empty files can not be mapped, those are left to ifs
+	if (mappedFile == nullptr)
+		mappedFile = std::make_unique<CMemoryMappedFile>();
+
+	if (!mappedFile->Open(filePath))
+		return false;
+
+	fileView = {mappedFile->GetData(), mappedFile->GetSize()};
+	fileSize = fileView.size();
+	return true;
+}
+
+
+void CFileHandler::Open(const string& fileName, const string& modes, bool mapView)
 {
 	this->fileName = fileName;
+	this->mapView = mapView;
 	for (char c: modes) {
 #ifndef TOOLS
 		CVFSHandler::Section section = CVFSHandler::GetModeSection(c);
@@ -130,6 +159,11 @@ void CFileHandler::Close()
 
 	ifs.close();
 	fileBuffer.clear();
+
+	fileView = {};
+
+	if (mappedFile != nullptr)
+		mappedFile->Close();
 }
 
 
@@ -173,15 +207,17 @@ int CFileHandler::Read(void* buf, int length)
 		return ifs.gcount();
 	}
 
-	if (fileBuffer.empty())
+	const auto memData = GetMemData();
+
+	if (memData.empty())
 		return 0;
 
 	if ((length + filePos) > fileSize)
 		length = fileSize - filePos;
 
 	if (length > 0) {
-		assert(fileBuffer.size() >= (filePos + length));
-		memcpy(buf, &fileBuffer[filePos], length);
+		assert(memData.size() >= (filePos + length));
+		memcpy(buf, &memData[filePos], length);
 		filePos += length;
 	}
 
@@ -218,7 +254,7 @@ void CFileHandler::Seek(int length, std::ios_base::seekdir where)
 		ifs.seekg(length, where);
 		return;
 	}
-	if (fileBuffer.empty())
+	if (GetMemData().empty())
 		return;
 
 	switch (where) {
@@ -234,7 +270,7 @@ bool CFileHandler::Eof() const
 	if (ifs.is_open())
 		return ifs.eof();
 
-	if (!fileBuffer.empty())
+	if (!GetMemData().empty())
 		return (filePos >= fileSize);
 
 	return true;
@@ -250,6 +286,23 @@ int CFileHandler::GetPos()
 }
 
 
+std::span<const std::uint8_t> CFileHandler::GetView()
+{
+	if (ifs.is_open()) {
+		// neither mapped nor buffered, e.g. empty or mapping failed
+		filePos = std::max(0, GetPos());
+		fileBuffer.resize(std::max(fileSize, 0));
+
+		ifs.clear();
+		ifs.seekg(0, std::ios_base::beg);
+		ifs.read(reinterpret_cast<char*>(fileBuffer.data()), fileBuffer.size());
+		ifs.close();
+	}
+
+	return GetMemData();
+}
+
+
 bool CFileHandler::LoadStringData(string& data)
 {
 	if (!FileExists())
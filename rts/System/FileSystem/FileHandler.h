@@ -6,9 +6,12 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <memory>
+#include <span>
 #include <cinttypes>
 
 #include "VFSModes.h"
+#include "MemoryMappedFile.h"
 
 /**
  * This is for direct VFS file content access.
@@ -24,10 +27,14 @@ class CFileHandler
 public:
 	CFileHandler() { Close(); }
 	CFileHandler(const char* fileName, const char* modes = SPRING_VFS_RAW_FIRST);
-	CFileHandler(const std::string& fileName, const std::string& modes = SPRING_VFS_RAW_FIRST);
+	/**
+	 * @param mapView map raw files and view uncompressed VFS files in place
+	 *   rather than reading them, see GetView
+	 */
+	CFileHandler(const std::string& fileName, const std::string& modes = SPRING_VFS_RAW_FIRST, bool mapView = false);
 	virtual ~CFileHandler() { Close(); }
 
-	void Open(const std::string& fileName, const std::string& modes = SPRING_VFS_RAW_FIRST);
+	void Open(const std::string& fileName, const std::string& modes = SPRING_VFS_RAW_FIRST, bool mapView = false);
 	void Close();
 
 	int Read(void* buf, int length);
@@ -39,6 +46,8 @@ public:
 	bool FileExists() const { return (fileSize >= 0); }
 	// true if (and only if) TryReadFromVFS succeeds
 	bool IsBuffered() const { return (!fileBuffer.empty()); }
+	// true if the contents are mapped or viewed in place (never buffered)
+	bool IsMapped() const { return (!fileView.empty()); }
 
 	bool Eof() const;
 	int GetPos();
@@ -51,6 +60,13 @@ public:
 	static std::string GetArchiveContainingFile(const std::string& filePath, const std::string& modes);
 
 	std::vector<std::uint8_t>& GetBuffer() { return fileBuffer; }
+	/**
+	 * Returns the whole contents of the file for parsing in place: the mapped
+	 * view if there is one, the buffer otherwise. Files that are neither get
+	 * read into the buffer first. Valid until Close, and in case of a VFS view
+	 * as long as its archive stays loaded.
+	 */
+	std::span<const std::uint8_t> GetView();
 
 	static bool InReadDir(const std::string& path);
 	static bool InWriteDir(const std::string& path);
@@ -69,6 +85,12 @@ protected:
 	virtual bool TryReadFromRawFS(const std::string& fileName);
 	virtual bool TryReadFromVFS(const std::string& fileName, int section);
 
+	bool TryMapRawFile(const std::string& filePath);
+
+	std::span<const std::uint8_t> GetMemData() const {
+		return (fileView.empty()? std::span<const std::uint8_t>(fileBuffer): fileView);
+	}
+
 	static bool InsertRawFiles(std::vector<std::string>& fileSet, const std::string& path, const std::string& pattern, bool recursive);
 	static bool InsertVFSFiles(std::vector<std::string>& fileSet, const std::string& path, const std::string& pattern, bool recursive, int section);
 
@@ -79,9 +101,15 @@ protected:
 	std::ifstream ifs;
 	std::vector<std::uint8_t> fileBuffer;
 
+	// either a view into mappedFile or into a VFS archive
+	std::span<const std::uint8_t> fileView;
+	std::unique_ptr<CMemoryMappedFile> mappedFile;
+
 	int filePos = 0;
 	int fileSize = -1;
 	int loadCode = -3; // {-1,0,1} if loaded from VFS
+
+	bool mapView = false;
 };
 
 #endif // _FILE_HANDLER_H
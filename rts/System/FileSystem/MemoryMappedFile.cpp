@@ -0,0 +1,146 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MemoryMappedFile.h"
+
+#include <algorithm>
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#include <windows.h>
+#endif
+
+#include "System/Misc/TracyDefs.h"
+
+
+#ifndef _WIN32
+
+bool CMemoryMappedFile::Open(const std::string& filePath)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	Close();
+
+	if ((fileDesc = open(filePath.c_str(), O_RDONLY)) < 0)
+		return false;
+
+	struct stat info;
+
+	if (fstat(fileDesc, &info) != 0 || info.st_size <= 0) {
+		Close();
+		return false;
+	}
+
+	void* ptr = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fileDesc, 0);
+
+	if (ptr == MAP_FAILED) {
+		Close();
+		return false;
+	}
+
+	data = static_cast<const std::uint8_t*>(ptr);
+	size = info.st_size;
+	return true;
+}
+
+void CMemoryMappedFile::Close()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (data != nullptr)
+		munmap(const_cast<std::uint8_t*>(data), size);
+	if (fileDesc >= 0)
+		close(fileDesc);
+
+	data = nullptr;
+	size = 0;
+	fileDesc = -1;
+}
+
+void CMemoryMappedFile::WillNeed(std::size_t offset, std::size_t length) const
+{
+	if (data == nullptr || offset >= size)
+		return;
+
+	// madvise wants a page-aligned start
+	const std::size_t pageOffset = offset - (offset % GetPageSize());
+	const std::size_t pageLength = std::min(size, offset + length) - pageOffset;
+
+	madvise(const_cast<std::uint8_t*>(data + pageOffset), pageLength, MADV_WILLNEED);
+}
+
+std::size_t CMemoryMappedFile::GetPageSize()
+{
+	static const std::size_t pageSize = sysconf(_SC_PAGESIZE);
+	return pageSize;
+}
+
+#else
+
+bool CMemoryMappedFile::Open(const std::string& filePath)
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	Close();
+
+	HANDLE hFile = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	fileHandle = hFile;
+
+	LARGE_INTEGER fileSize;
+
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart <= 0) {
+		Close();
+		return false;
+	}
+
+	if ((mapHandle = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr)) == nullptr) {
+		Close();
+		return false;
+	}
+
+	if ((data = static_cast<const std::uint8_t*>(MapViewOfFile(mapHandle, FILE_MAP_READ, 0, 0, 0))) == nullptr) {
+		Close();
+		return false;
+	}
+
+	size = fileSize.QuadPart;
+	return true;
+}
+
+void CMemoryMappedFile::Close()
+{
+	RECOIL_DETAILED_TRACY_ZONE;
+	if (data != nullptr)
+		UnmapViewOfFile(data);
+	if (mapHandle != nullptr)
+		CloseHandle(mapHandle);
+	if (fileHandle != nullptr)
+		CloseHandle(fileHandle);
+
+	data = nullptr;
+	size = 0;
+	mapHandle = nullptr;
+	fileHandle = nullptr;
+}
+
+void CMemoryMappedFile::WillNeed(std::size_t offset, std::size_t length) const
+{
+	// PrefetchVirtualMemory needs Win8, let the page faults do the work instead
+}
+
+std::size_t CMemoryMappedFile::GetPageSize()
+{
+	static const std::size_t pageSize = []() {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return std::size_t(info.dwAllocationGranularity);
+	}();
+
+	return pageSize;
+}
+
+#endif
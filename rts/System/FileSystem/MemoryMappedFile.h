@@ -0,0 +1,50 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MEMORY_MAPPED_FILE_H
+#define MEMORY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Read-only view of a whole file through the OS page cache, for large binary
+ * caches that are consumed piecewise: pages are only faulted in once touched,
+ * and nothing gets read or decompressed up front.
+ */
+class CMemoryMappedFile
+{
+public:
+	CMemoryMappedFile() = default;
+	explicit CMemoryMappedFile(const std::string& filePath) { Open(filePath); }
+	CMemoryMappedFile(const CMemoryMappedFile&) = delete;
+	~CMemoryMappedFile() { Close(); }
+
+	CMemoryMappedFile& operator = (const CMemoryMappedFile&) = delete;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+
+	const std::uint8_t* GetData() const { return data; }
+	std::size_t GetSize() const { return size; }
+
+	// hint that [offset, offset + length) is about to be read in full
+	void WillNeed(std::size_t offset, std::size_t length) const;
+
+	static std::size_t GetPageSize();
+
+private:
+	const std::uint8_t* data = nullptr;
+	std::size_t size = 0;
+
+	#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mapHandle = nullptr;
+	#else
+	int fileDesc = -1;
+	#endif
+};
+
+#endif // MEMORY_MAPPED_FILE_H
@@ -0,0 +1,82 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _VFS_FILE_INDEX_H
+#define _VFS_FILE_INDEX_H
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "System/UnorderedMap.hpp"
+
+class IArchive;
+
+/**
+ * Immutable snapshot of the files visible in one VFS section.
+ * Built by CVFSHandler after its archives change and shared with
+ * readers, s.t. lookups need not take the VFS lock.
+ */
+class CVFSFileIndex
+{
+public:
+	struct FileData {
+		IArchive* ar;
+		int size;
+	};
+	typedef std::pair<std::string, FileData> FileEntry;
+	typedef std::vector<FileEntry>::const_iterator FileIter;
+
+	/**
+	 * @param sortedFiles entries sorted by (normalized) name; for duplicate
+	 *   names the first one wins, as in a lower_bound search
+	 */
+	explicit CVFSFileIndex(std::vector<FileEntry> sortedFiles): files(std::move(sortedFiles)) {
+		lookup.reserve(files.size());
+
+		for (size_t i = 0, n = files.size(); i < n; i++) {
+			if (i > 0 && files[i - 1].first == files[i].first)
+				continue;
+
+			// keys view the strings in files, which never change after this
+			lookup.emplace(std::string_view(files[i].first), static_cast<uint32_t>(i));
+		}
+	}
+
+	CVFSFileIndex(const CVFSFileIndex&) = delete;
+	CVFSFileIndex& operator = (const CVFSFileIndex&) = delete;
+
+	FileData Find(std::string_view normalizedPath) const {
+		const auto iter = lookup.find(normalizedPath);
+
+		if (iter == lookup.end())
+			return {nullptr, 0};
+
+		return files[iter->second].second;
+	}
+
+	/**
+	 * @param dir normalized directory path with a trailing slash, or empty
+	 * @return range of all files (recursively) below dir
+	 */
+	std::pair<FileIter, FileIter> GetDirRange(std::string dir) const {
+		if (dir.empty())
+			return {files.cbegin(), files.cend()};
+
+		const auto pred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
+
+		// turn '/' into '0' for the end
+		const FileIter beg = std::lower_bound(files.cbegin(), files.cend(), FileEntry{dir, FileData{}}, pred); dir.back() += 1;
+		const FileIter end = std::upper_bound(files.cbegin(), files.cend(), FileEntry{dir, FileData{}}, pred);
+		return {beg, end};
+	}
+
+	const std::vector<FileEntry>& GetFiles() const { return files; }
+
+private:
+	std::vector<FileEntry> files;
+	spring::unsynced_map<std::string_view, uint32_t> lookup;
+};
+
+#endif // _VFS_FILE_INDEX_H
@@ -30,11 +30,12 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_VFS)
 
 // GetFileData can be called on a thread other than main (e.g. sound) via
 // FileHandler::Open, while {Add,Remove}Archive are reached from multiple
-// places including LuaVFS
+// places including LuaVFS; lookups only read the per-section file indices
+// and take the lock when those need to be rebuilt
 static spring::recursive_mutex vfsMutex;
 
 
-static CVFSHandler* vfs = nullptr;
+static std::atomic<CVFSHandler*> vfs = nullptr;
 
 
 void CVFSHandler::GrabLock() { vfsMutex.lock(); }
@@ -49,7 +50,7 @@ void CVFSHandler::FreeInstance(CVFSHandler* handler)
 		return;
 	}
 
-	spring::SafeDelete(vfs);
+	delete vfs.exchange(nullptr);
 }
 
 void CVFSHandler::SetGlobalInstance(CVFSHandler* handler)
@@ -60,19 +61,17 @@ void CVFSHandler::SetGlobalInstance(CVFSHandler* handler)
 }
 void CVFSHandler::SetGlobalInstanceRaw(CVFSHandler* handler)
 {
-	const char* curHandlerName = (vfs != nullptr)? vfs->GetName(): "null";
+	const CVFSHandler* curHandler = vfs.load();
+	const char* curHandlerName = (curHandler != nullptr)? curHandler->GetName(): "null";
 	const char* newHandlerName = handler->GetName();
 
-	LOG_L(L_INFO, "[VFSHandler::%s] handler=%p (%s) global=%p (%s)", __func__, handler, newHandlerName, vfs, curHandlerName);
+	LOG_L(L_INFO, "[VFSHandler::%s] handler=%p (%s) global=%p (%s)", __func__, handler, newHandlerName, curHandler, curHandlerName);
 
 	// assert(vfsMutex.locked());
 	vfs = handler;
 }
 
-CVFSHandler* CVFSHandler::GetGlobalInstance() {
-	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
-	return vfs;
-}
+CVFSHandler* CVFSHandler::GetGlobalInstance() { return vfs.load(); }
 
 
 
@@ -203,6 +202,7 @@ bool CVFSHandler::AddArchive(const std::string& archiveName, bool overwrite)
 	}
 
 	std::stable_sort(files[rawSection].begin(), files[rawSection].end(), [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); });
+	InvalidateFileIndex(rawSection);
 	return true;
 }
 
@@ -271,6 +271,7 @@ bool CVFSHandler::RemoveArchive(const std::string& archiveName)
 
 		// wipe entries belonging to the to-be-deleted archive
 		files[section].erase(pos, end);
+		InvalidateFileIndex(section);
 	}
 
 
@@ -309,6 +310,7 @@ void CVFSHandler::DeleteArchives(Section section)
 
 	archives[section].clear();
 	files[section].clear();
+	InvalidateFileIndex(section);
 }
 
 void CVFSHandler::ReserveArchives()
@@ -325,6 +327,7 @@ void CVFSHandler::ReserveArchives()
 
 		files[section].clear();
 		files[section].reserve(2048);
+		InvalidateFileIndex(Section(section));
 	}
 
 	// preload universal dependencies
@@ -369,6 +372,10 @@ void CVFSHandler::UnMapArchives(bool reload)
 		files[Section::Map ].clear();
 		files[Section::Menu].clear();
 	}
+
+	for (int section = Section::Mod; section < Section::Count; section++) {
+		InvalidateFileIndex(Section(section));
+	}
 }
 
 void CVFSHandler::ReMapArchives(bool reload)
@@ -388,6 +395,10 @@ void CVFSHandler::ReMapArchives(bool reload)
 		files[Section::TempMap ].clear();
 		files[Section::TempMenu].clear();
 	}
+
+	for (int section = Section::Mod; section < Section::Count; section++) {
+		InvalidateFileIndex(Section(section));
+	}
 }
 
 
@@ -399,6 +410,9 @@ void CVFSHandler::SwapArchiveSections(Section src, Section dst)
 
 	std::swap(   files[src],    files[dst]);
 	std::swap(archives[src], archives[dst]);
+
+	InvalidateFileIndex(src);
+	InvalidateFileIndex(dst);
 }
 
 
@@ -411,15 +425,20 @@ std::string CVFSHandler::GetNormalizedPath(const std::string& rawPath)
 }
 
 
-CVFSHandler::FileData CVFSHandler::GetFileData(const std::string& normalizedFilePath, Section section) const
+std::shared_ptr<const CVFSFileIndex> CVFSHandler::GetFileIndex(Section section) const
 {
 	assert(section < Section::Count);
+
+	if (std::shared_ptr<const CVFSFileIndex> fileIndex = fileIndices[section].load(); fileIndex != nullptr)
+		return fileIndex;
+
 	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
 
+	// another thread might have rebuilt it while we waited
+	if (std::shared_ptr<const CVFSFileIndex> fileIndex = fileIndices[section].load(); fileIndex != nullptr)
+		return fileIndex;
+
 	const auto& vect = files[section];
-	const auto  cbeg = vect.cbegin();
-	const auto  cend = vect.cend();
-	const auto  file = FileEntry{normalizedFilePath, FileData{}};
 	const auto  sane = [&]() -> bool {
 		for (size_t i = 1, n = vect.size(); i < n; i++) {
 			if (vect[i - 1].first > vect[i].first)
@@ -428,18 +447,17 @@ CVFSHandler::FileData CVFSHandler::GetFileData(const std::string& normalizedFile
 		return true;
 	};
 
-	{
-		assert(sane());
-
-		const auto pred = [ ](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
-		const auto iter = std::lower_bound(cbeg, cend, file, pred);
+	assert(sane());
 
-		if (iter != cend && iter->first == normalizedFilePath)
-			return {iter->second.ar, iter->second.size};
-	}
+	auto fileIndex = std::make_shared<const CVFSFileIndex>(vect);
+	fileIndices[section].store(fileIndex);
+	return fileIndex;
+}
 
-	// file does not exist in the VFS
-	return {nullptr, 0};
+CVFSHandler::FileData CVFSHandler::GetFileData(const std::string& normalizedFilePath, Section section) const
+{
+	// nullptr if the file does not exist in the VFS
+	return (GetFileIndex(section)->Find(normalizedFilePath));
 }
 
 
@@ -458,6 +476,19 @@ int CVFSHandler::LoadFile(const std::string& filePath, std::vector<std::uint8_t>
 	return (fileData.ar->GetFile(normalizedPath, buffer));
 }
 
+std::span<const std::uint8_t> CVFSHandler::GetFileView(const std::string& filePath, Section section)
+{
+	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
+
+	const std::string& normalizedPath = GetNormalizedPath(filePath);
+	const FileData& fileData = GetFileData(normalizedPath, section);
+
+	if (fileData.ar == nullptr)
+		return {};
+
+	return (fileData.ar->GetFileView(fileData.ar->FindFile(normalizedPath)));
+}
+
 int CVFSHandler::FileExists(const std::string& filePath, Section section)
 {
 	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
@@ -523,8 +554,6 @@ std::vector<std::string> CVFSHandler::GetAllArchiveNames() const
 
 std::vector<std::string> CVFSHandler::GetFilesInDir(const std::string& rawDir, bool recursive, Section section)
 {
-	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
-
 	assert(section < Section::Count);
 
 	LOG_L(L_DEBUG, "[%s::%s<this=%p>(rawDir=\"%s\")] section=%d", vfsName, __func__, this, rawDir.c_str(), section);
@@ -533,21 +562,14 @@ std::vector<std::string> CVFSHandler::GetFilesInDir(const std::string& rawDir, b
 	std::string dir = GetNormalizedPath(rawDir);
 
 
-	const auto filesPred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
-
-	auto& filesVec = files[section];
-	auto  filesBeg = filesVec.begin();
-	auto  filesEnd = filesVec.end();
-
 	// non-empty directories to look in should have a trailing backslash
-	if (!dir.empty()) {
-		if (dir.back() != '/')
-			dir += "/";
+	if (!dir.empty() && dir.back() != '/')
+		dir += "/";
 
-		// limit the iterator range; turn '/' into '0' for filesEnd
-		filesBeg = std::lower_bound(filesVec.begin(), filesVec.end(), FileEntry{dir, FileData{}}, filesPred); dir.back() += 1;
-		filesEnd = std::upper_bound(filesVec.begin(), filesVec.end(), FileEntry{dir, FileData{}}, filesPred); dir.back() -= 1;
-	}
+	// keeps the file names alive, even if the section changes meanwhile
+	const auto fileIndex = GetFileIndex(section);
+
+	auto [filesBeg, filesEnd] = fileIndex->GetDirRange(dir);
 
 	dirFiles.reserve(std::distance(filesBeg, filesEnd));
 
@@ -575,8 +597,6 @@ std::vector<std::string> CVFSHandler::GetFilesInDir(const std::string& rawDir, b
 
 std::vector<std::string> CVFSHandler::GetDirsInDir(const std::string& rawDir, bool recursive, Section section)
 {
-	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
-
 	assert(section < Section::Count);
 
 	LOG_L(L_DEBUG, "[%s::%s<this=%p>(rawDir=\"%s\")] section=%d", vfsName, __func__, this, rawDir.c_str(), section);
@@ -586,21 +606,14 @@ std::vector<std::string> CVFSHandler::GetDirsInDir(const std::string& rawDir, bo
 	std::string dir = GetNormalizedPath(rawDir);
 
 
-	const auto filesPred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
-
-	auto& filesVec = files[section];
-	auto  filesBeg = filesVec.begin();
-	auto  filesEnd = filesVec.end();
-
 	// non-empty directories to look in should have a trailing backslash
-	if (!dir.empty()) {
-		if (dir.back() != '/')
-			dir += "/";
+	if (!dir.empty() && dir.back() != '/')
+		dir += "/";
 
-		// limit the iterator range (as in GetFilesInDir)
-		filesBeg = std::lower_bound(filesVec.begin(), filesVec.end(), FileEntry{dir, FileData{}}, filesPred); dir.back() += 1;
-		filesEnd = std::upper_bound(filesVec.begin(), filesVec.end(), FileEntry{dir, FileData{}}, filesPred); dir.back() -= 1;
-	}
+	// keeps the file names alive, even if the section changes meanwhile
+	const auto fileIndex = GetFileIndex(section);
+
+	auto [filesBeg, filesEnd] = fileIndex->GetDirRange(dir);
 
 	dirs.reserve(std::distance(filesBeg, filesEnd));
 
@@ -633,3 +646,56 @@ std::vector<std::string> CVFSHandler::GetDirsInDir(const std::string& rawDir, bo
 	return dirs;
 }
 
+size_t CVFSHandler::PrefetchFilesInDirs(const std::vector<std::string>& rawDirs, int maxFileSize, Section section)
+{
+	// also keeps the archives alive while their files are read
+	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
+
+	assert(section < Section::Count);
+
+	LOG_L(L_DEBUG, "[%s::%s<this=%p>(#rawDirs=%u)] section=%d", vfsName, __func__, this, uint32_t(rawDirs.size()), section);
+
+	const auto filesPred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
+	const auto& filesVec = files[section];
+
+	// file IDs per archive, in VFS-order
+	std::vector<std::pair<IArchive*, std::vector<uint32_t>>> archiveFiles;
+
+	size_t numFiles = 0;
+
+	for (const std::string& rawDir: rawDirs) {
+		std::string dir = GetNormalizedPath(rawDir);
+
+		if (dir.empty())
+			continue;
+		if (dir.back() != '/')
+			dir += "/";
+
+		// limit the iterator range (as in GetFilesInDir)
+		auto filesBeg = std::lower_bound(filesVec.begin(), filesVec.end(), FileEntry{dir, FileData{}}, filesPred); dir.back() += 1;
+		auto filesEnd = std::upper_bound(filesVec.begin(), filesVec.end(), FileEntry{dir, FileData{}}, filesPred); dir.back() -= 1;
+
+		for (; filesBeg != filesEnd; ++filesBeg) {
+			const auto& [path, fileData] = *filesBeg;
+
+			if (fileData.ar == nullptr || fileData.size > maxFileSize)
+				continue;
+
+			const auto pred = [&](const auto& p) { return (p.first == fileData.ar); };
+			auto iter = std::find_if(archiveFiles.begin(), archiveFiles.end(), pred);
+
+			if (iter == archiveFiles.end())
+				iter = archiveFiles.insert(archiveFiles.end(), {fileData.ar, {}});
+
+			iter->second.push_back(fileData.ar->FindFile(path));
+			numFiles += 1;
+		}
+	}
+
+	for (auto& [ar, fids]: archiveFiles) {
+		ar->PrefetchFiles(fids);
+	}
+
+	return numFiles;
+}
+
@@ -4,10 +4,14 @@
 #define _VFS_HANDLER_H
 
 #include <array>
+#include <atomic>
+#include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <cinttypes>
 
+#include "VFSFileIndex.h"
 #include "System/UnorderedMap.hpp"
 
 class IArchive;
@@ -104,6 +108,16 @@ public:
 	 */
 	int LoadFile(const std::string& filePath, std::vector<std::uint8_t>& buffer, Section section);
 
+	/**
+	 * Returns the contents of a file within the VFS in place, if its archive
+	 * stores it uncompressed.
+	 * @param filePath raw file path, for example "maps/myMap.smf",
+	 *   case-insensitive
+	 * @return read-only view valid while the archive stays loaded, or an empty
+	 *   span if the file does not exist or has to be read through LoadFile
+	 */
+	std::span<const std::uint8_t> GetFileView(const std::string& filePath, Section section);
+
 
 	/**
 	 * Returns all the files in the given (virtual) directory without the
@@ -121,6 +135,16 @@ public:
 	 */
 	std::vector<std::string> GetDirsInDir(const std::string& dir, bool recursive, Section section);
 
+	/**
+	 * Reads all files (recursively) below the given (virtual) directories
+	 * ahead of use, concurrently per archive, s.t. subsequent LoadFile
+	 * calls are served from the archives' caches.
+	 * @param dirs raw directory paths, for example "gamedata/"
+	 * @param maxFileSize larger files are left to be read on demand
+	 * @return number of files prefetched
+	 */
+	size_t PrefetchFilesInDirs(const std::vector<std::string>& dirs, int maxFileSize, Section section);
+
 
 	bool HasTempArchive(const std::string& archiveName) const { return (HasArchive(archiveName, GetTempArchiveSection(archiveName))); }
 
@@ -159,17 +183,23 @@ public:
 	void SwapArchiveSections(Section src, Section dst);
 
 private:
-	struct FileData {
-		IArchive* ar;
-		int size;
-	};
-	typedef std::pair<std::string, FileData> FileEntry;
+	typedef CVFSFileIndex::FileData FileData;
+	typedef CVFSFileIndex::FileEntry FileEntry;
 
 	std::string GetNormalizedPath(const std::string& rawPath);
 	FileData GetFileData(const std::string& normalizedFilePath, Section section) const;
 
+	/**
+	 * Returns the current index of a section without locking, and
+	 * (re)builds it under the lock if files changed since.
+	 */
+	std::shared_ptr<const CVFSFileIndex> GetFileIndex(Section section) const;
+	// caller has the lock, after changing files[section]
+	void InvalidateFileIndex(Section section) { fileIndices[section].store(nullptr); }
+
 private:
 	std::array<std::vector<FileEntry>, Section::Count> files;
+	mutable std::array<std::atomic<std::shared_ptr<const CVFSFileIndex>>, Section::Count> fileIndices;
 	std::array<spring::unordered_map<std::string, IArchive*>, Section::Count> archives;
 
 	const char* vfsName = "";
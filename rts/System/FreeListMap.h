@@ -209,6 +209,28 @@ namespace spring {
 			freeKeys.shrink_to_fit();
 		}
 
+		// moves the value at position order[i] (and its key) to position i,
+		// <order> must be a permutation of [0, size)
+		void Reorder(const std::vector<size_t>& order) {
+			assert(order.size() == vault.size());
+
+			std::vector<TVal> newVault;
+			std::vector<TKey> newPkVec;
+
+			newVault.reserve(vault.capacity());
+			newPkVec.reserve(pkVec.capacity());
+
+			for (size_t i = 0, n = order.size(); i < n; ++i) {
+				newVault.emplace_back(std::move(vault[order[i]]));
+				newPkVec.emplace_back(pkVec[order[i]]);
+
+				kpMap[newPkVec.back()] = i;
+			}
+
+			vault = std::move(newVault);
+			pkVec = std::move(newPkVec);
+		}
+
 		constexpr auto begin()        { return vault.begin(); }
 		constexpr auto end()          { return vault.end();   }
 		constexpr auto cbegin() const { return vault.begin(); }
@@ -1,5 +1,9 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <future>
 #include <sstream>
 #include <zlib.h>
 
@@ -41,6 +45,7 @@
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "System/SafeUtil.h"
 #include "System/Platform/errorhandler.h"
+#include "System/Platform/Threading.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/GZFileHandler.h"
@@ -49,6 +54,7 @@
 #include "System/creg/Serializer.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
+#include "System/Sync/SyncChecker.h"
 
 #define MAX_STRING_SIZE (1 << 19) // 512kB excluding null-term
 
@@ -251,76 +257,138 @@ static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer&
 }
 
 
-void CCregLoadSaveHandler::SaveGame(const std::string& path)
-{
 #ifdef USING_CREG
-	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
+/// savegames are written as a series of independent gzip members so they can be
+/// compressed in parallel; gzread (CGZFileHandler) reads them back as one stream
+static constexpr size_t SAVE_CHUNK_SIZE = 4 << 20;
 
-	// NB: Selection leaves CObject reference as Unit's listener,
-	//     But isn't serialized - leak on load.
-	selectedUnitsHandler.ClearSelected();
+static std::string DeflateSaveChunk(const char* data, size_t size)
+{
+	z_stream zs = {};
+	std::string chunk;
 
-	try {
-		std::stringstream oss;
+	// 15 + 16: gzip wrapper, level matches the old "wb5" mode
+	if (deflateInit2(&zs, 5, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return chunk;
 
-		// write our own header. SavePackage() will add its own
-		WriteString(oss, SpringVersion::GetSync());
-		WriteString(oss, gameSetup->setupText);
-		WriteString(oss, modName);
-		WriteString(oss, mapName);
+	chunk.resize(deflateBound(&zs, size));
 
+	zs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	zs.avail_in  = size;
+	zs.next_out  = reinterpret_cast<Bytef*>(chunk.data());
+	zs.avail_out = chunk.size();
 
-		{
-			Sim::SaveComponents(oss);
+	chunk.resize((deflate(&zs, Z_FINISH) == Z_STREAM_END)? zs.total_out: 0);
+	deflateEnd(&zs);
+	return chunk;
+}
 
-			creg::COutputStreamSerializer os;
+static void WriteSaveFile(FILE* file, std::string&& data)
+{
+	// own threads rather than pool tasks, the pool might be gone before this
+	// ext-job is joined on shutdown; a sliding window keeps them all busy
+	const size_t maxJobs = std::max(1, Threading::GetPhysicalCpuCores() / 2);
 
-			// save lua state first as lua unit scripts depend on it
-			const int luaStart = oss.tellp();
-			SaveLuaState(luaGaia, os, oss);
-			SaveLuaState(luaRules, os, oss);
-			PrintSize("Lua", ((int)oss.tellp()) - luaStart);
+	std::deque< std::future<std::string> > chunks;
 
-			// save creg state
-			const int gameStart = oss.tellp();
-			CGameStateCollector gsc;
-			os.SavePackage(&oss, &gsc, gsc.GetClass());
-			PrintSize("Game", ((int)oss.tellp()) - gameStart);
+	size_t offset = 0;
+	bool writeError = false;
 
+	while (offset < data.size() || !chunks.empty()) {
+		while (offset < data.size() && chunks.size() < maxJobs) {
+			const size_t chunkSize = std::min(SAVE_CHUNK_SIZE, data.size() - offset);
 
-			// save AI state
-			const int aiStart = oss.tellp();
+			chunks.emplace_back(std::async(std::launch::async, DeflateSaveChunk, data.data() + offset, chunkSize));
+			offset += chunkSize;
+		}
 
-			for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
-				std::stringstream aiData;
-				eoh->Save(&aiData, ai.first);
+		// written in order while the chunks behind it are still being compressed
+		const std::string chunkData = chunks.front().get();
+		chunks.pop_front();
 
-				std::uint64_t aiSize = aiData.tellp();
-				creg::WriteUInt(&oss, aiSize);
-				if (aiSize > 0)
-					oss << aiData.rdbuf();
-			}
-			PrintSize("AIs", ((int)oss.tellp()) - aiStart);
-		}
+		if (writeError)
+			continue;
+
+		writeError |= chunkData.empty();
+		writeError |= (fwrite(chunkData.data(), 1, chunkData.size(), file) != chunkData.size());
+	}
+
+	fclose(file);
+
+	if (writeError)
+		LOG_L(L_ERROR, "[LSH::%s] failed to write save-file", __func__);
+}
+
+/// header and full sim state, shared by savegames and mid-game join snapshots
+static void SaveGameState(std::stringstream& oss)
+{
+	// write our own header. SavePackage() will add its own
+	WriteString(oss, SpringVersion::GetSync());
+	WriteString(oss, gameSetup->setupText);
+	WriteString(oss, modName);
+	WriteString(oss, mapName);
+
+	Sim::SaveComponents(oss);
+
+	creg::COutputStreamSerializer os;
+
+	// save lua state first as lua unit scripts depend on it
+	const int luaStart = oss.tellp();
+	SaveLuaState(luaGaia, os, oss);
+	SaveLuaState(luaRules, os, oss);
+	PrintSize("Lua", ((int)oss.tellp()) - luaStart);
+
+	// save creg state
+	const int gameStart = oss.tellp();
+	CGameStateCollector gsc;
+	os.SavePackage(&oss, &gsc, gsc.GetClass());
+	PrintSize("Game", ((int)oss.tellp()) - gameStart);
+
+
+	// save AI state
+	const int aiStart = oss.tellp();
+
+	for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
+		std::stringstream aiData;
+		eoh->Save(&aiData, ai.first);
+
+		std::uint64_t aiSize = aiData.tellp();
+		creg::WriteUInt(&oss, aiSize);
+		if (aiSize > 0)
+			oss << aiData.rdbuf();
+	}
+	PrintSize("AIs", ((int)oss.tellp()) - aiStart);
+}
+#endif //USING_CREG
+
+
+void CCregLoadSaveHandler::SaveGame(const std::string& path)
+{
+#ifdef USING_CREG
+	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
+
+	// NB: Selection leaves CObject reference as Unit's listener,
+	//     But isn't serialized - leak on load.
+	selectedUnitsHandler.ClearSelected();
+
+	try {
+		std::stringstream oss;
+
+		SaveGameState(oss);
 
 		{
-			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
+			FILE* file = fopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb");
 
 			if (file == nullptr) {
 				LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
 				return;
 			}
 
-			std::string data = oss.str();
-			std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-				gzwrite(file, data.c_str(), data.size());
-				gzflush(file, Z_FINISH);
-				gzclose(file);
-			};
+			// moves the buffer out instead of copying the whole game state once more
+			std::string data = std::move(oss).str();
 
-			// gzFile is just a plain typedef (struct gzFile_s {}* gzFile), can be copied
 			// need to keep a reference to the future around or its destructor will block
-			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
+			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, WriteSaveFile, file, std::move(data))));
 		}
 
 		//FIXME add lua state
@@ -340,6 +408,91 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #endif //USING_CREG
 }
 
+bool CCregLoadSaveHandler::SaveSnapshot(std::vector<std::uint8_t>& snapshot)
+{
+	snapshot.clear();
+
+#ifdef USING_CREG
+	// same listener problem as in SaveGame, but the donor keeps playing
+	const std::vector<int> selection(selectedUnitsHandler.selectedUnits.begin(), selectedUnitsHandler.selectedUnits.end());
+	selectedUnitsHandler.ClearSelected();
+
+	try {
+		std::stringstream oss;
+
+		SaveGameState(oss);
+
+		const std::string data = oss.str();
+		uLongf deflSize = compressBound(data.size());
+
+		// raw size up front so the receiver can inflate in one go
+		snapshot.resize(sizeof(std::uint32_t) + deflSize);
+		*reinterpret_cast<std::uint32_t*>(snapshot.data()) = data.size();
+
+		if (compress2(snapshot.data() + sizeof(std::uint32_t), &deflSize, reinterpret_cast<const Bytef*>(data.data()), data.size(), Z_BEST_SPEED) == Z_OK) {
+			snapshot.resize(sizeof(std::uint32_t) + deflSize);
+			PrintSize("[LSH::SaveSnapshot] compressed", snapshot.size());
+		} else {
+			snapshot.clear();
+			LOG_L(L_ERROR, "[LSH::%s] compression failed", __func__);
+		}
+	} catch (const std::exception& ex) {
+		snapshot.clear();
+		LOG_L(L_ERROR, "[LSH::%s] exception \"%s\"", __func__, ex.what());
+	} catch (...) {
+		snapshot.clear();
+		LOG_L(L_ERROR, "[LSH::%s] unknown error", __func__);
+	}
+
+	for (const int unitID: selection) {
+		if (CUnit* unit = unitHandler.GetUnit(unitID); unit != nullptr)
+			selectedUnitsHandler.AddUnit(unit);
+	}
+#else //USING_CREG
+	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
+#endif //USING_CREG
+
+	return (!snapshot.empty());
+}
+
+/// snapshot counterpart of LoadGameStartInfo; the setup script already came with NETMSG_GAMEDATA
+bool CCregLoadSaveHandler::LoadSnapshot(const std::vector<std::uint8_t>& snapshot, unsigned snapshotSyncChecksum)
+{
+	if (snapshot.size() <= sizeof(std::uint32_t))
+		return false;
+
+	std::vector<char> data(*reinterpret_cast<const std::uint32_t*>(snapshot.data()));
+	uLongf rawSize = data.size();
+
+	if (uncompress(reinterpret_cast<Bytef*>(data.data()), &rawSize, snapshot.data() + sizeof(std::uint32_t), snapshot.size() - sizeof(std::uint32_t)) != Z_OK || rawSize != data.size()) {
+		LOG_L(L_ERROR, "[LSH::%s] corrupt snapshot (%u bytes)", __func__, unsigned(snapshot.size()));
+		return false;
+	}
+
+	iss.str("");
+	iss.clear();
+	iss.rdbuf()->sputn(data.data(), data.size());
+
+	std::string saveVersion;
+	std::string setupText;
+
+	ReadString(iss, saveVersion);
+	ReadString(iss, setupText);
+	ReadString(iss, modName);
+	ReadString(iss, mapName);
+
+	// unlike a savegame this can not be loaded anyway, everyone else runs a different build
+	if (saveVersion != SpringVersion::GetSync()) {
+		LOG_L(L_ERROR, "[LSH::%s] snapshot taken by engine version \"%s\", incompatible with \"%s\"", __func__, saveVersion.c_str(), SpringVersion::GetSync().c_str());
+		return false;
+	}
+
+	scriptText = std::move(setupText);
+	syncChecksum = snapshotSyncChecksum;
+	fromSnapshot = true;
+	return true;
+}
+
 /// loads the data (map&mod-name,setup-script) needed by PreGame
 bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 {
@@ -425,6 +578,13 @@ void CCregLoadSaveHandler::LoadAIData()
 	// cleanup
 	iss.str("");
 
+	// the running checksum spans frames; resume it where the donor was so our
+	// sync responses from the next frame on can be compared with everyone else's
+#ifdef SYNCCHECK
+	if (fromSnapshot)
+		CSyncChecker::SetChecksum(syncChecksum);
+#endif
+
 	gs->paused = false;
 	if (gameServer != nullptr) {
 		gameServer->isPaused = false;
@@ -3,8 +3,10 @@
 #ifndef CREG_LOAD_SAVE_HANDLER_H
 #define CREG_LOAD_SAVE_HANDLER_H
 
+#include <cstdint>
 #include <string>
 #include <sstream>
+#include <vector>
 #include "LoadSaveHandler.h"
 
 class CCregLoadSaveHandler : public ILoadSaveHandler
@@ -18,8 +20,16 @@ public:
 	void LoadAIData() override;
 	void SaveGame(const std::string& path) override;
 
+	/// serializes the running game for a mid-game joiner, zlib-compressed
+	static bool SaveSnapshot(std::vector<std::uint8_t>& snapshot);
+	bool LoadSnapshot(const std::vector<std::uint8_t>& snapshot, unsigned snapshotSyncChecksum);
+
 protected:
 	std::stringstream iss;
+
+	/// CSyncChecker state of the donor when the snapshot was taken
+	unsigned syncChecksum = 0;
+	bool fromSnapshot = false;
 };
 
 #endif // CREG_LOAD_SAVE_HANDLER_H
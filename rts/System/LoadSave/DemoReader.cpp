@@ -3,6 +3,7 @@
 #include "DemoReader.h"
 
 #include "Game/GameVersion.h"
+#include "Net/Protocol/NetMessageTypes.h"
 #include "Sim/Misc/GlobalConstants.h"
 
 #ifndef TOOLS
@@ -15,6 +16,7 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 
+#include <algorithm>
 #include <array>
 #include <climits>
 #include <stdexcept>
@@ -80,6 +82,7 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		playbackDemo->Read(const_cast<char*>(setupScript.data()), setupScript.size());
 	}
 
+	chunkHeaderPos = playbackDemo->GetPos();
 	playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader));
 	chunkHeader.swab();
 
@@ -100,6 +103,8 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		bytesRemaining = playbackDemoSize - curPos;
 	}
 	playbackDemo->Seek(curPos);
+
+	LoadIndex();
 }
 
 
@@ -126,8 +131,17 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 		}
 		bytesRemaining -= chunkHeader.length;
 
+		if (buf->length >= (sizeof(std::uint8_t) + sizeof(std::int32_t)) && buf->data[0] == NETMSG_KEYFRAME) {
+			std::int32_t frameNum;
+			memcpy(&frameNum, &buf->data[1], sizeof(frameNum));
+
+			if (frameIndex.empty() || frameNum >= (frameIndex.back().frameNum + INDEX_FRAME_INTERVAL))
+				frameIndex.push_back({frameNum, chunkHeader.modGameTime, chunkHeaderPos, 0});
+		}
+
 		if (!ReachedEnd()) {
 			// read next chunk header
+			chunkHeaderPos = playbackDemo->GetPos();
 			if (playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader)) < sizeof(chunkHeader)) {
 				delete buf;
 				bytesRemaining = 0;
@@ -147,6 +161,34 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 	return nullptr;
 }
 
+const CDemoReader::IndexEntry* CDemoReader::FindIndexEntry(int frameNum) const
+{
+	const auto pred = [](int frameNum, const IndexEntry& e) { return (frameNum < e.frameNum); };
+	const auto iter = std::upper_bound(frameIndex.begin(), frameIndex.end(), frameNum, pred);
+
+	if (iter == frameIndex.begin())
+		return nullptr;
+
+	return &*(iter - 1);
+}
+
+bool CDemoReader::SeekToIndexEntry(const IndexEntry& entry)
+{
+	const std::int64_t streamBeg = fileHeader.headerSize + fileHeader.scriptSize;
+	const std::int64_t streamEnd = streamBeg + ((fileHeader.demoStreamSize != 0)? fileHeader.demoStreamSize: (playbackDemoSize - streamBeg));
+
+	if (entry.streamPos < streamBeg || (entry.streamPos + std::int64_t(sizeof(chunkHeader))) > streamEnd)
+		return false;
+
+	playbackDemo->Seek(chunkHeaderPos = entry.streamPos);
+	playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader));
+	chunkHeader.swab();
+
+	nextDemoReadTime = chunkHeader.modGameTime + demoTimeOffset;
+	bytesRemaining = streamEnd - entry.streamPos - sizeof(chunkHeader);
+	return true;
+}
+
 bool CDemoReader::ReachedEnd()
 {
 	return (bytesRemaining <= 0 || playbackDemo->Eof() || (playbackDemo->GetPos() > playbackDemoSize));
@@ -160,7 +202,7 @@ void CDemoReader::LoadStats()
 		return;
 
 	const int curPos = playbackDemo->GetPos();
-	playbackDemo->Seek(fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize);
+	playbackDemo->Seek(GetStatsPos());
 
 	winningAllyTeams.clear();
 	playerStats.clear();
@@ -200,3 +242,29 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+void CDemoReader::LoadIndex()
+{
+	// the index follows the statistics, and neither exists if Spring crashed while writing the demo
+	if (fileHeader.demoStreamSize == 0 || fileHeader.numIndexEntries <= 0)
+		return;
+
+	const int curPos = playbackDemo->GetPos();
+	const int indexPos = GetStatsPos() + fileHeader.winningAllyTeamsSize + fileHeader.playerStatSize + fileHeader.teamStatSize;
+
+	frameIndex.clear();
+	frameIndex.resize(fileHeader.numIndexEntries);
+
+	playbackDemo->Seek(indexPos);
+
+	if (playbackDemo->Read(reinterpret_cast<char*>(frameIndex.data()), frameIndex.size() * sizeof(IndexEntry)) < int(frameIndex.size() * sizeof(IndexEntry))) {
+		LOG_L(L_WARNING, "[DemoReader::%s] demo block index is truncated, ignoring it", __func__);
+		frameIndex.clear();
+	}
+
+	for (IndexEntry& entry: frameIndex) {
+		entry.swab();
+	}
+
+	playbackDemo->Seek(curPos);
+}
@@ -9,6 +9,7 @@
 #include "Demo.h"
 
 #include "Game/Players/PlayerStatistics.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamStatistics.h"
 
 namespace netcode { class RawPacket; }
@@ -19,6 +20,13 @@ class CFileHandler;
  */
 class CDemoReader : public CDemo
 {
+public:
+	/// where the chunk carrying a given keyframe starts in the demo stream
+	typedef DemoIndexEntry IndexEntry;
+
+	// a keyframe is indexed at most once per this many frames
+	static constexpr int INDEX_FRAME_INTERVAL = DEMOFILE_BLOCK_FRAMES;
+
 public:
 	/**
 	@brief Open a demofile for reading
@@ -52,10 +60,27 @@ public:
 	const std::vector< std::vector<TeamStatistics> >& GetTeamStats() const { return teamStats; }
 	const std::vector< unsigned char >& GetWinningAllyTeams() const { return winningAllyTeams; }
 
+	/**
+	 * The block index stored in the file, or (for demos whose recording was
+	 * not finished) built while the demo is read, so it only covers what was
+	 * played so far; fileOffset is 0 for entries of the latter kind.
+	 * Meant as the lookup for seeking; rewinding additionally needs the sim
+	 * state at that frame, which can not yet be restored in a running game.
+	 */
+	const std::vector<IndexEntry>& GetFrameIndex() const { return frameIndex; }
+	/// last indexed entry at or before <frameNum>, nullptr if there is none
+	const IndexEntry* FindIndexEntry(int frameNum) const;
+
+	/// continue reading the demo stream from <entry>, false if it lies outside the stream
+	bool SeekToIndexEntry(const IndexEntry& entry);
+
 	/// Not needed for normal demo watching
 	void LoadStats();
 
 private:
+	void LoadIndex();
+	int GetStatsPos() const { return (fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize); }
+
 	CFileHandler* playbackDemo;
 
 	float demoTimeOffset;
@@ -64,6 +89,10 @@ private:
 	int playbackDemoSize;
 
 	DemoStreamChunkHeader chunkHeader;
+	/// stream position of <chunkHeader>
+	int chunkHeaderPos;
+
+	std::vector<IndexEntry> frameIndex;
 
 	std::string setupScript;	// the original, unaltered version from script
 
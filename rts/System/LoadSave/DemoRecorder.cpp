@@ -2,12 +2,17 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <zlib.h>
 
 #include "DemoRecorder.h"
 #include "base64.h"
 #include "Game/GameVersion.h"
+#include "Net/Protocol/NetMessageTypes.h"
 #include "Sim/Misc/TeamStatistics.h"
 #include "System/TimeUtil.h"
 #include "System/StringUtil.h"
@@ -16,6 +21,8 @@
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
+#include "System/Threading/SpringThreading.h"
 #include "System/Threading/ThreadPool.h"
 
 #ifdef CreateDirectory
@@ -27,26 +34,295 @@
 #endif
 
 
-// server and client memory-streams
-static std::string demoStreams[2];
-static spring::mutex demoMutex;
+// packets are handed to the writer in batches of (at least) this size
+static constexpr size_t STREAM_BATCH_SIZE = 256 * 1024;
+// past this much uncompressed data waiting in the queue the recording thread
+// stalls, so a disk that can not keep up does not eat all memory instead
+static constexpr size_t MAX_QUEUED_BYTES = 64 * 1024 * 1024;
 
 
-CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
+/**
+ * Writes the file as concatenated gzip members (see demofile.h): the header
+ * is stored uncompressed so it has a fixed size and can be rewritten in place
+ * once the stream sizes are known, every block of the stream is deflated on
+ * its own, and the block index is appended when the recording is finished.
+ */
+class CDemoStreamWriter
 {
-	std::lock_guard<spring::mutex> lock(demoMutex);
+public:
+	~CDemoStreamWriter() {
+		assert(!thread.joinable());
+
+		if (file != nullptr)
+			fclose(file);
+	}
+
+	bool Open(const std::string& fileName) {
+		if ((file = fopen(fileName.c_str(), "wb")) == nullptr)
+			return false;
+
+		memset(&zstream, 0, sizeof(zstream));
+		return (deflateInit2(&zstream, 9, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	}
+
+	void Start(const std::shared_ptr<CDemoStreamWriter>& self) {
+		thread = spring::thread([self]() { self->Run(); });
+	}
+
+	void Append(const void* data, size_t size) {
+		batch.append(reinterpret_cast<const char*>(data), size);
+		streamSize += size;
+
+		if (batch.size() >= STREAM_BATCH_SIZE)
+			PushBatch();
+	}
+
+	void PushHeader(const DemoFileHeader& header) {
+		PushJob(JOB_HEADER, std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+	}
+
+	// everything appended from here on goes into a new gzip member
+	void StartBlock(int frameNum, float modGameTime) {
+		PushBatch();
+		PushJob(JOB_BLOCK, {}, {frameNum, modGameTime, std::int64_t(sizeof(DemoFileHeader) + streamSize), 0});
+
+		blockFrameNum = frameNum;
+	}
+
+	// queues the remaining data and closes the file, the thread exits after that
+	void Finish() {
+		PushBatch();
+		PushJob(JOB_FINISH, {});
+	}
+
+	spring::thread&& GetThread() { return std::move(thread); }
+
+	size_t GetStreamSize() const { return streamSize; }
+	int GetBlockFrameNum() const { return blockFrameNum; }
+	size_t GetQueuedJobs() const { return queuedJobs.load(); }
+	size_t GetQueuedBytes() const { return queuedBytes.load(); }
+	size_t GetWrittenBytes() const { return writtenBytes.load(); }
+
+private:
+	enum JobType {
+		JOB_HEADER,
+		JOB_DATA,
+		JOB_BLOCK,
+		JOB_FINISH,
+	};
+
+	struct Job {
+		JobType type;
+		std::string data;
+		DemoIndexEntry entry;
+	};
+
+	void PushBatch() {
+		if (batch.empty())
+			return;
+
+		PushJob(JOB_DATA, std::move(batch));
+
+		batch.clear();
+		batch.reserve(STREAM_BATCH_SIZE);
+	}
+
+	void PushJob(JobType type, std::string&& data, const DemoIndexEntry& entry = {}) {
+		{
+			std::unique_lock<spring::mutex> lock(jobMutex);
+
+			spaceCond.wait(lock, [&]() { return (queuedBytes.load() <= MAX_QUEUED_BYTES); });
+
+			queuedBytes += data.size();
+			queuedJobs += 1;
+
+			jobs.push_back({type, std::move(data), entry});
+		}
+
+		jobCond.notify_one();
+	}
+
+	void Run() {
+		Threading::SetThreadName("demowriter");
+
+		for (bool done = false; !done; ) {
+			Job job;
+
+			{
+				std::unique_lock<spring::mutex> lock(jobMutex);
+
+				jobCond.wait(lock, [&]() { return (!jobs.empty()); });
+
+				job = std::move(jobs.front());
+				jobs.pop_front();
+
+				queuedBytes -= job.data.size();
+				queuedJobs -= 1;
+			}
+
+			spaceCond.notify_one();
+
+			switch (job.type) {
+				case JOB_HEADER: { WriteHeader(job.data);            } break;
+				case JOB_DATA  : { Deflate(job.data, Z_NO_FLUSH);    } break;
+				case JOB_BLOCK : { NextBlock(job.entry);             } break;
+				case JOB_FINISH: { Deflate(job.data, Z_NO_FLUSH); EndMember(); done = true; } break;
+			}
+		}
+
+		WriteIndex();
+
+		deflateEnd(&zstream);
+
+		if (fclose(file) != 0)
+			failed = true;
+
+		file = nullptr;
+
+		if (failed)
+			LOG_L(L_ERROR, "[DemoStreamWriter::%s] error writing demo file (errno %d: %s)", __func__, errno, strerror(errno));
+	}
+
+	void Write(const void* data, size_t size) {
+		if (failed)
+			return;
+
+		failed = (fwrite(data, 1, size, file) != size);
+		writtenBytes += size;
+	}
+
+	void NextBlock(DemoIndexEntry entry) {
+		EndMember();
+
+		entry.fileOffset = ftell(file);
+		index.push_back(entry);
+	}
+
+	void EndMember() {
+		Deflate({}, Z_FINISH);
+		deflateReset(&zstream);
+	}
+
+	void WriteIndex() {
+		if (index.empty() || headerData.size() != sizeof(DemoFileHeader))
+			return;
+
+		DemoFileHeader header;
+		memcpy(&header, headerData.data(), sizeof(header));
+		header.swab();
+		header.numIndexEntries = index.size();
+		header.indexFileOffset = ftell(file);
+		header.swab();
+
+		for (DemoIndexEntry& entry: index) {
+			entry.swab();
+		}
+
+		// the last block member was finished by JOB_FINISH
+		Deflate(std::string(reinterpret_cast<const char*>(index.data()), index.size() * sizeof(DemoIndexEntry)), Z_FINISH);
+		WriteHeader(std::string(reinterpret_cast<const char*>(&header), sizeof(header)));
+	}
+
+	void WriteHeader(const std::string& data) {
+		z_stream hstream;
+		memset(&hstream, 0, sizeof(hstream));
+
+		if (deflateInit2(&hstream, Z_NO_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+			return;
+
+		std::vector<uint8_t> member(deflateBound(&hstream, data.size()));
+
+		hstream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+		hstream.avail_in = data.size();
+		hstream.next_out = member.data();
+		hstream.avail_out = member.size();
+
+		deflate(&hstream, Z_FINISH);
+		member.resize(member.size() - hstream.avail_out);
+		deflateEnd(&hstream);
+
+		// stored members only depend on the input length, but check anyway
+		// rather than overwrite the start of the stream that follows
+		if (headerSize == 0)
+			headerSize = member.size();
+
+		if (member.size() != headerSize) {
+			LOG_L(L_ERROR, "[DemoStreamWriter::%s] header size changed (" _STPF_ " vs " _STPF_ " bytes)", __func__, member.size(), headerSize);
+			return;
+		}
+
+		fseek(file, 0, SEEK_SET);
+		Write(member.data(), member.size());
+		fseek(file, 0, SEEK_END);
+
+		headerData = data;
+	}
+
+	void Deflate(const std::string& data, int flush) {
+		uint8_t outBuffer[64 * 1024];
+
+		zstream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+		zstream.avail_in = data.size();
+
+		do {
+			zstream.next_out = outBuffer;
+			zstream.avail_out = sizeof(outBuffer);
+
+			deflate(&zstream, flush);
+			Write(outBuffer, sizeof(outBuffer) - zstream.avail_out);
+		} while (zstream.avail_out == 0);
+	}
+
+private:
+	FILE* file = nullptr;
+	z_stream zstream;
+
+	spring::thread thread;
+
+	// owned by the recording thread
+	std::string batch;
+	size_t streamSize = 0;
+	int blockFrameNum = 0;
+
+	// owned by the writer thread
+	std::string headerData;
+	std::vector<DemoIndexEntry> index;
+	size_t headerSize = 0;
+	bool failed = false;
+
+	spring::mutex jobMutex;
+	spring::condition_variable jobCond;
+	spring::condition_variable spaceCond;
+
+	std::deque<Job> jobs;
+
+	std::atomic<size_t> queuedJobs = {0};
+	std::atomic<size_t> queuedBytes = {0};
+	std::atomic<size_t> writtenBytes = {0};
+};
 
-	SetStream();
+
+
+CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
+{
 	SetName(mapName, modName);
 	SetFileHeader();
-	WriteFileHeader(false);
 
-	file = gzopen(demoName.c_str(), "wb9");
+	writer = std::make_shared<CDemoStreamWriter>();
+
+	if (!writer->Open(demoName)) {
+		LOG_L(L_ERROR, "[DemoRecorder::%s] can not open demo file \"%s\"", __func__, demoName.c_str());
+		writer.reset();
+		return;
+	}
+
+	writer->Start(writer);
+	WriteFileHeader(false);
 }
 
 CDemoRecorder::~CDemoRecorder()
 {
-	if (file == nullptr)
+	if (writer == nullptr)
 		return;
 
 	WriteWinnerList();
@@ -57,12 +333,6 @@ CDemoRecorder::~CDemoRecorder()
 }
 
 
-void CDemoRecorder::SetStream()
-{
-	demoStreams[isServerDemo].clear();
-	demoStreams[isServerDemo].reserve(8 * 1024 * 1024);
-}
-
 void CDemoRecorder::SetFileHeader()
 {
 	memset(&fileHeader, 0, sizeof(DemoFileHeader));
@@ -79,33 +349,43 @@ void CDemoRecorder::SetFileHeader()
 
 void CDemoRecorder::WriteDemoFile()
 {
-	// zlib FAQ claims the lib is thread-safe, "however any library routines that zlib uses and
-	// any application-provided memory allocation routines must also be thread-safe. zlib's gz*
-	// functions use stdio library routines, and most of zlib's functions use the library memory
-	// allocation routines by default" (so code below should be OK)
-	// gz* should usually be finished before ctor runs again when reloading, but take no chances
-	std::string& data = demoStreams[isServerDemo];
-	std::function<void(gzFile, std::string&)> func = [](gzFile file, std::string& data) {
-		std::lock_guard<spring::mutex> lock(demoMutex);
-
-		gzwrite(file, data.c_str(), data.size());
-		gzflush(file, Z_FINISH);
-		gzclose(file);
-	};
+	// the writer only has to drain its queue and finish the deflate stream
+	// by now, which can still take a while on a slow disk; have it done off
+	// the main thread and waited for at exit like other external jobs
+	writer->Finish();
 
-	LOG("[DemoRecorder::%s] writing %s-demo \"%s\" (" _STPF_ " bytes)", __func__, (isServerDemo? "server": "client"), demoName.c_str(), data.size());
+	LOG("[DemoRecorder::%s] writing %s-demo \"%s\" (" _STPF_ " bytes)", __func__, (isServerDemo? "server": "client"), demoName.c_str(), writer->GetStreamSize());
 
-	#ifndef _WIN32
 	// NOTE: can not use ThreadPool for this directly here, workers are already gone
-	// FIXME: does not currently (august 2017) compile on Windows mingw buildbots
-	ThreadPool::AddExtJob(spring::thread(std::move(func), file, std::ref(data)));
-	#else
-	ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::ref(data))));
-	#endif
+	ThreadPool::AddExtJob(writer->GetThread());
+	writer.reset();
+}
+
+std::string CDemoRecorder::Statistics() const
+{
+	if (writer == nullptr)
+		return "demo writer: inactive";
+
+	std::ostringstream oss;
+	oss << "demo writer: " << writer->GetQueuedJobs() << " queued batches (" << writer->GetQueuedBytes() << " bytes), ";
+	oss << writer->GetStreamSize() << " bytes recorded, " << writer->GetWrittenBytes() << " bytes written";
+	return oss.str();
+}
+
+void CDemoRecorder::AppendToStream(const void* data, size_t size)
+{
+	// the demo file could not be opened, recording is a no-op
+	if (writer == nullptr)
+		return;
+
+	writer->Append(data, size);
 }
 
 void CDemoRecorder::WriteSetupText(const std::string& text)
 {
+	if (writer == nullptr)
+		return;
+
 	LOG_L(L_INFO, "[CDemoRecorder::%s] SetupText=\"%s\"", __func__,
 		base64_encode(reinterpret_cast<const uint8_t*>(text.c_str()), text.size()).c_str());
 
@@ -120,18 +400,32 @@ void CDemoRecorder::WriteSetupText(const std::string& text)
 	}
 
 	fileHeader.scriptSize = length;
-	demoStreams[isServerDemo].append(text.c_str(), length);
+	AppendToStream(text.c_str(), length);
 }
 
 void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime)
 {
+	if (writer == nullptr)
+		return;
+
 	DemoStreamChunkHeader chunkHeader;
 
+	// the first chunk starts a block, as does the first keyframe after each DEMOFILE_BLOCK_FRAMES
+	if (fileHeader.demoStreamSize == 0) {
+		writer->StartBlock(0, modGameTime);
+	} else if (length >= (sizeof(std::uint8_t) + sizeof(std::int32_t)) && buf[0] == NETMSG_KEYFRAME) {
+		std::int32_t frameNum;
+		memcpy(&frameNum, &buf[1], sizeof(frameNum));
+
+		if (frameNum >= (writer->GetBlockFrameNum() + DEMOFILE_BLOCK_FRAMES))
+			writer->StartBlock(frameNum, modGameTime);
+	}
+
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
-	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
-	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(buf), length);
+	AppendToStream(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
+	AppendToStream(reinterpret_cast<const char*>(buf), length);
 	fileHeader.demoStreamSize += (length + sizeof(chunkHeader));
 }
 
@@ -229,10 +523,12 @@ void CDemoRecorder::SetWinningAllyTeams(const std::vector<unsigned char>& winnin
 }
 
 /** @brief Write DemoFileHeader
-Write the DemoFileHeader at the start of the file and restores the original
-position in the file afterwards. */
-unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
+(Re)writes the DemoFileHeader at the start of the file, on the writer thread. */
+void CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 {
+	if (writer == nullptr)
+		return;
+
 	DemoFileHeader tmpHeader;
 	memcpy(&tmpHeader, &fileHeader, sizeof(fileHeader));
 
@@ -242,28 +538,24 @@ unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 	// to little endian
 	tmpHeader.swab();
 
-	if (demoStreams[isServerDemo].empty()) {
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader));
-	} else {
-		assert(demoStreams[isServerDemo].size() >= sizeof(tmpHeader));
-		memcpy(&demoStreams[isServerDemo][0], reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader)); // no non-const .data() until C++17
-	}
-
-	return (demoStreams[isServerDemo].size());
+	writer->PushHeader(tmpHeader);
 }
 
 /** @brief Write the CPlayer::Statistics at the current position in the file. */
 void CDemoRecorder::WritePlayerStats()
 {
-	const size_t pos = demoStreams[isServerDemo].size();
+	if (writer == nullptr)
+		return;
+
+	const size_t pos = writer->GetStreamSize();
 
 	for (PlayerStatistics& stats: playerStats) {
 		stats.swab();
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&stats), sizeof(PlayerStatistics));
+		AppendToStream(reinterpret_cast<const char*>(&stats), sizeof(PlayerStatistics));
 	}
 
 	fileHeader.numPlayers = playerStats.size();
-	fileHeader.playerStatSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.playerStatSize = int(writer->GetStreamSize() - pos);
 
 	playerStats.clear();
 }
@@ -273,41 +565,44 @@ void CDemoRecorder::WritePlayerStats()
 /** @brief Write the winningAllyTeams at the current position in the file. */
 void CDemoRecorder::WriteWinnerList()
 {
-	if (fileHeader.numTeams == 0)
+	if (writer == nullptr || fileHeader.numTeams == 0)
 		return;
 
-	const size_t pos = demoStreams[isServerDemo].size();
+	const size_t pos = writer->GetStreamSize();
 
 	// Write the array of winningAllyTeams.
 	for (size_t i = 0; i < winningAllyTeams.size(); i++) { // NOLINT{modernize-loop-convert}
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&winningAllyTeams[i]), sizeof(unsigned char));
+		AppendToStream(reinterpret_cast<const char*>(&winningAllyTeams[i]), sizeof(unsigned char));
 	}
 
 	winningAllyTeams.clear();
 
-	fileHeader.winningAllyTeamsSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.winningAllyTeamsSize = int(writer->GetStreamSize() - pos);
 }
 
 /** @brief Write the TeamStatistics at the current position in the file. */
 void CDemoRecorder::WriteTeamStats()
 {
-	const size_t pos = demoStreams[isServerDemo].size();
+	if (writer == nullptr)
+		return;
+
+	const size_t pos = writer->GetStreamSize();
 
 	// Write array of dwords indicating number of TeamStatistics per team.
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		unsigned int c = swabDWord(history.size());
-		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&c), sizeof(unsigned int));
+		AppendToStream(reinterpret_cast<const char*>(&c), sizeof(unsigned int));
 	}
 
 	// Write big array of TeamStatistics.
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		for (TeamStatistics& stats: history) {
 			stats.swab();
-			demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&stats), sizeof(TeamStatistics));
+			AppendToStream(reinterpret_cast<const char*>(&stats), sizeof(TeamStatistics));
 		}
 	}
 
-	fileHeader.teamStatSize = int(demoStreams[isServerDemo].size() - pos);
+	fileHeader.teamStatSize = int(writer->GetStreamSize() - pos);
 
 	teamStats.clear();
 }
@@ -3,14 +3,16 @@
 #ifndef DEMO_RECORDER
 #define DEMO_RECORDER
 
+#include <memory>
 #include <vector>
 #include <sstream>
-#include <zlib.h>
 
 #include "Demo.h"
 #include "Game/Players/PlayerStatistics.h"
 #include "Sim/Misc/TeamStatistics.h"
 
+class CDemoStreamWriter;
+
 
 /**
  * @brief Used to record demos
@@ -32,7 +34,7 @@ public:
 		memcpy(&fileHeader, &r.fileHeader, sizeof(fileHeader));
 		memset(&r.fileHeader, 0, sizeof(fileHeader));
 
-		std::swap(file, r.file);
+		std::swap(writer, r.writer);
 
 		std::swap(demoName, r.demoName);
 		std::swap(playerStats, r.playerStats);
@@ -44,12 +46,11 @@ public:
 	}
 
 
-	bool IsValid() const { return (file != nullptr); }
+	bool IsValid() const { return (writer != nullptr); }
 
 	void WriteSetupText(const std::string& text);
 	void SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime);
 
-	void SetStream();
 	void SetName(const std::string& mapName, const std::string& modName);
 	const std::string& GetName() const { return demoName; }
 
@@ -62,16 +63,23 @@ public:
 	void SetTeamStats(int teamNum, const std::vector<TeamStatistics>& stats);
 	void SetWinningAllyTeams(const std::vector<unsigned char>& winningAllyTeams);
 
+	// depth of the background writer's queue, for the dedicated server's status output
+	std::string Statistics() const;
+
 private:
-	unsigned int WriteFileHeader(bool updateStreamLength);
+	void WriteFileHeader(bool updateStreamLength);
 	void SetFileHeader();
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
 	void WriteDemoFile();
 
+	void AppendToStream(const void* data, size_t size);
+
 private:
-	gzFile file = nullptr;
+	// compresses and writes the stream on its own thread, SaveToDemo only
+	// gathers packets into batches and queues those (shared with the thread)
+	std::shared_ptr<CDemoStreamWriter> writer;
 
 	std::vector<PlayerStatistics> playerStats;
 	std::vector< std::vector<TeamStatistics> > teamStats;
@@ -21,7 +21,13 @@
  * The current demofile version. Only change on major modifications for which
  * appending stuff to DemoFileHeader is not sufficient.
  */
-#define DEMOFILE_VERSION 5
+#define DEMOFILE_VERSION 6
+
+/**
+ * The demo stream is cut into an independently compressed block at the first
+ * keyframe after this many frames (30 seconds of game time).
+ */
+#define DEMOFILE_BLOCK_FRAMES (30 * 30)
 
 #pragma pack(push, 1)
 
@@ -40,6 +46,15 @@
  *         CTeam::Statistics for each team.
  *       - Array of all CTeam::Statistics (total number of items is the
  *         sum of the elements in the array of dwords).
+ *     - Block index, numIndexEntries DemoIndexEntry's (since version 6)
+ *
+ * Since version 6 the file is a series of concatenated gzip members, which
+ * gzread and friends treat as one stream: the DemoFileHeader on its own, the
+ * startscript, one member per block of the demo stream (with the statistics
+ * being part of the last one), and the block index. Each block starts with
+ * the chunk carrying a keyframe, so it can be decompressed and parsed without
+ * anything that precedes it given its DemoIndexEntry::fileOffset; the index
+ * itself is found through DemoFileHeader::indexFileOffset.
  *
  * The header is designed to be extensible: it contains a version field and a
  * headerSize field to support this. The version field is a major version number
@@ -70,6 +85,8 @@ struct DemoFileHeader
 	int teamStatElemSize;         ///< sizeof(CTeam::Statistics)
 	int teamStatPeriod;           ///< Interval (in seconds) between team stats.
 	int winningAllyTeamsSize;     ///< The size of the vector of the winning ally teams
+	int numIndexEntries;          ///< Number of DemoIndexEntry's in the block index, 0 if the recording was not finished
+	std::int64_t indexFileOffset; ///< Offset of the gzip member holding the block index within the (compressed) file
 
 
 	/// Change structure from host endian to little endian or vice versa.
@@ -89,6 +106,29 @@ struct DemoFileHeader
 		swabDWordInPlace(teamStatElemSize);
 		swabDWordInPlace(teamStatPeriod);
 		swabDWordInPlace(winningAllyTeamsSize);
+		swabDWordInPlace(numIndexEntries);
+		swab64InPlace(indexFileOffset);
+	}
+};
+
+/**
+ * @brief Spring demo block index entry
+ *
+ * One per independently compressed block of the demo stream.
+ */
+struct DemoIndexEntry
+{
+	int frameNum;               ///< Frame of the keyframe the block starts with (0 for the first block)
+	float modGameTime;          ///< Gametime of the first chunk in the block
+	std::int64_t streamPos;     ///< Offset of the block's first DemoStreamChunkHeader within the uncompressed file
+	std::int64_t fileOffset;    ///< Offset of the block's gzip member within the (compressed) file
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabFloatInPlace(modGameTime);
+		swab64InPlace(streamPos);
+		swab64InPlace(fileOffset);
 	}
 };
 
@@ -7,11 +7,19 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #include "Backend.h"
 #include "DefaultFilter.h"
+#include "Level.h"
 #include "LogUtil.h"
 #include "System/MainDefines.h"
+#include "System/Threading/MPSCRingBuffer.h"
 
 #define MAX_LOG_SINKS 8
 
@@ -50,10 +58,20 @@ namespace log_formatter {
 	}
 
 
+	// held while records are passed to the sinks in async mode, so
+	// that only one thread at a time drains the ring (its consumer)
+	// sinks register themselves before main, hence not a plain static
+	static std::recursive_mutex& GetSinkMutex() {
+		static std::recursive_mutex sinkMutex;
+		return sinkMutex;
+	}
+
 	bool insert_sink(log_sink_ptr sink) {
+		std::lock_guard<std::recursive_mutex> lock(GetSinkMutex());
 		return (array_insert(sinks, sink, numSinks));
 	}
 	bool remove_sink(log_sink_ptr sink) {
+		std::lock_guard<std::recursive_mutex> lock(GetSinkMutex());
 		return (array_remove(sinks, sink, numSinks));
 	}
 
@@ -66,6 +84,31 @@ namespace log_formatter {
 }
 
 
+namespace log_async {
+	// formatted by the logging thread, deduplicated and sunk by the log thread
+	struct Record {
+		int level = 0;
+		bool hasSection = false;
+
+		std::string section;
+		std::string msg;
+	};
+
+	static constexpr size_t RING_SIZE = 4096;
+	// the log thread also wakes up by itself at this interval
+	static constexpr std::chrono::milliseconds WAKE_INTERVAL = std::chrono::milliseconds(5);
+
+	static Recoil::MPSCRingBuffer<Record> ring(RING_SIZE);
+
+	static std::atomic<bool> enabled = {false};
+	static std::atomic<bool> running = {false};
+
+	static std::mutex wakeMutex;
+	static std::condition_variable wakeCond;
+	static std::thread thread;
+}
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -75,6 +118,9 @@ extern "C" {
 static _threadlocal log_record_t cur_record = {{0}, "", "",  0, 0};
 static _threadlocal log_record_t prv_record = {{0}, "", "",  0, 0};
 
+// previous record of whichever thread is draining the async ring
+static log_record_t async_prv_record = {{0}, "", "",  0, 0};
+
 
 extern void log_formatter_format(log_record_t* log, va_list arguments);
 
@@ -91,11 +137,63 @@ void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc) { log_formatter:
  */
 ///@{
 
-// formats and routes the record to all sinks
-void log_backend_record(int level, const char* section, const char* fmt, va_list arguments)
+// routes an already formatted message to all sinks, unless it repeats the previous one too often
+static void log_backend_sink(int level, const char* section, const char* msg, log_record_t* prv)
 {
 	const auto& sinks = log_formatter::sinks;
 
+	// check for duplicates after formatting; can not be
+	// done in log_frontend_record or log_filter_record
+	const int cmp = (prv->msg[0] != 0 && STRCASECMP(msg, prv->msg) == 0);
+
+	prv->cnt += cmp;
+	prv->cnt *= cmp;
+
+	if (const auto limit = log_filter_getRepeatLimit(); limit && prv->cnt >= limit)
+		return;
+
+	// sink the record into each registered sink
+	for (size_t i = 0; i < log_formatter::numSinks; i++) {
+		assert(sinks[i] != nullptr);
+		sinks[i](level, section, msg);
+	}
+
+	if (prv->cnt > 0)
+		return;
+
+	strncpy(prv->msg, msg, sizeof(prv->msg) - 1);
+}
+
+// sinks everything queued so far; the caller becomes the ring consumer while it holds the lock
+static void log_backend_drain()
+{
+	std::lock_guard<std::recursive_mutex> lock(log_formatter::GetSinkMutex());
+
+	log_async::ring.PopBulk([](log_async::Record&& r) {
+		log_backend_sink(r.level, r.hasSection? r.section.c_str(): nullptr, r.msg.c_str(), &async_prv_record);
+	}, log_async::ring.Capacity());
+}
+
+static void log_backend_asyncLoop()
+{
+	while (log_async::running.load(std::memory_order_acquire)) {
+		{
+			std::unique_lock<std::mutex> lock(log_async::wakeMutex);
+			log_async::wakeCond.wait_for(lock, log_async::WAKE_INTERVAL);
+		}
+
+		log_backend_drain();
+	}
+
+	log_backend_drain();
+}
+
+static void log_backend_stopAsync() { log_backend_setAsync(false); }
+
+
+// formats and routes the record to all sinks
+void log_backend_record(int level, const char* section, const char* fmt, va_list arguments)
+{
 	if (log_formatter::numSinks == 0)
 		return;
 
@@ -106,32 +204,80 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 	// format the record
 	log_formatter_format(&cur_record, arguments);
 
-	// check for duplicates after formatting; can not be
-	// done in log_frontend_record or log_filter_record
-	const int cmp = (prv_record.msg[0] != 0 && STRCASECMP(cur_record.msg, prv_record.msg) == 0);
+	if (!log_async::enabled.load(std::memory_order_acquire)) {
+		log_backend_sink(level, section, cur_record.msg, &prv_record);
+		return;
+	}
 
-	cur_record.cnt += cmp;
-	cur_record.cnt *= cmp;
+	// sections can come from Lua, copy them along with the message
+	log_async::Record record;
+	record.level = level;
+	record.hasSection = (section != nullptr);
+	record.section = (section != nullptr)? section: "";
+	record.msg = cur_record.msg;
 
-	if (const auto limit = log_filter_getRepeatLimit(); limit && cur_record.cnt >= limit)
-		return;
+	// ring is full, do the log thread's work rather than drop anything
+	while (!log_async::ring.Push(std::move(record))) {
+		log_backend_drain();
+	}
 
-	// sink the record into each registered sink
-	for (size_t i = 0; i < log_formatter::numSinks; i++) {
-		assert(sinks[i] != nullptr);
-		sinks[i](level, section, cur_record.msg);
+	// nothing may get lost if we are about to go down, or raced with setAsync(false)
+	if (level >= LOG_LEVEL_FATAL || !log_async::enabled.load(std::memory_order_acquire)) {
+		log_backend_drain();
+		return;
 	}
 
-	if (cur_record.cnt > 0)
+	if (log_async::ring.Size() >= (log_async::ring.Capacity() / 2))
+		log_async::wakeCond.notify_one();
+}
+
+void log_backend_flush()
+{
+	if (!log_async::enabled.load(std::memory_order_acquire))
 		return;
 
-	memcpy(prv_record.msg, cur_record.msg, sizeof(cur_record.msg));
+	log_backend_drain();
+}
+
+void log_backend_setAsync(bool enable)
+{
+	static std::mutex toggleMutex;
+	static bool atExitRegistered = false;
+
+	std::lock_guard<std::mutex> lock(toggleMutex);
+
+	if (enable == log_async::enabled.load())
+		return;
+
+	if (enable) {
+		// stop and drain before the sinks' statics get destroyed
+		if (!atExitRegistered)
+			atExitRegistered = (std::atexit(&log_backend_stopAsync) == 0);
+
+		log_async::running.store(true, std::memory_order_release);
+		log_async::thread = std::thread(&log_backend_asyncLoop);
+		log_async::enabled.store(true, std::memory_order_release);
+		return;
+	}
+
+	// records pushed until here are still sunk by the thread or the final drain
+	log_async::enabled.store(false, std::memory_order_release);
+	log_async::running.store(false, std::memory_order_release);
+	log_async::wakeCond.notify_one();
+
+	if (log_async::thread.joinable())
+		log_async::thread.join();
+
+	log_backend_drain();
 }
 
 /// Passes on a cleanup request to all sinks
 void log_backend_cleanup() {
 	const auto& funcs = log_formatter::cleanupFuncs;
 
+	// crash or fatal error, get everything queued out first
+	log_backend_flush();
+
 	for (size_t i = 0; i < log_formatter::numFuncs; i++) {
 		assert(funcs[i] != nullptr);
 		funcs[i]();
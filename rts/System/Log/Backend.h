@@ -27,6 +27,17 @@ void log_backend_registerSink(log_sink_ptr sink);
 void log_backend_unregisterSink(log_sink_ptr sink);
 
 
+/**
+ * Sinks log records on a background thread instead of the logging one.
+ * Records are still formatted by the caller; fatal ones, LOG_CLEANUP and
+ * disabling async mode again sink everything that is still queued.
+ */
+void log_backend_setAsync(bool enable);
+
+/// Sinks all records queued in async mode on the calling thread
+void log_backend_flush();
+
+
 typedef void (*log_cleanup_ptr)();
 
 /**
@@ -18,6 +18,7 @@ static void log_sink_record_logSinkHandler(int level, const char* section, const
 
 void LogSinkHandler::AddSink(ILogSink* logSink) {
 	assert(logSink != nullptr);
+	std::lock_guard<std::recursive_mutex> lock(sinksMutex);
 
 	if (sinks.empty())
 		log_backend_registerSink(&log_sink_record_logSinkHandler);
@@ -27,6 +28,7 @@ void LogSinkHandler::AddSink(ILogSink* logSink) {
 
 void LogSinkHandler::RemoveSink(ILogSink* logSink) {
 	assert(logSink != nullptr);
+	std::lock_guard<std::recursive_mutex> lock(sinksMutex);
 	sinks.erase(logSink);
 
 	if (!sinks.empty())
@@ -43,6 +45,8 @@ void LogSinkHandler::RecordLogMessage(
 	if (!sinking)
 		return;
 
+	std::lock_guard<std::recursive_mutex> lock(sinksMutex);
+
 	// forward to clients (currently only InfoConsole)
 	for (ILogSink* sink: sinks) {
 		sink->RecordLogMessage(level, section, message);
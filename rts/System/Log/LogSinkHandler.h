@@ -3,6 +3,7 @@
 #ifndef LOG_SINK_HANDLER_H
 #define LOG_SINK_HANDLER_H
 
+#include <mutex>
 #include <string>
 #include "System/UnorderedSet.hpp"
 
@@ -51,6 +52,8 @@ public:
 
 private:
 	spring::unsynced_set<ILogSink*> sinks;
+	// records can arrive from the async log thread while sinks are added or removed
+	std::recursive_mutex sinksMutex;
 
 	/**
 	 * Whether log records are passed on to registered sinks, or dismissed.
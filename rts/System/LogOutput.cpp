@@ -6,6 +6,7 @@
 #include "Game/GameVersion.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Log/Backend.h"
 #include "System/Log/DefaultFilter.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/ILog.h"
@@ -44,6 +45,11 @@ CONFIG(int, LogRepeatLimit)
 	.defaultValue(0)
 	.description("Allow at most this many consecutive identical messages to be logged. Set to 0 to disable the limit.");
 
+CONFIG(bool, LogAsync)
+	.defaultValue(true)
+	.safemodeValue(false)
+	.description("Write log messages to the logfile, console and other sinks from a background thread. Fatal errors and crashes still flush everything.");
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -173,6 +179,7 @@ void CLogOutput::Initialize()
 
 	log_filter_setRepeatLimit(configHandler->GetInt("LogRepeatLimit")); // all sinks
 	log_file_addLogFile(filePath.c_str(), nullptr, LOG_LEVEL_ALL, configHandler->GetInt("LogFlushLevel"));
+	log_backend_setAsync(configHandler->GetBool("LogAsync"));
 
 	LOG("LogOutput initialized. Logging to %s", filePath.c_str());
 }
@@ -9,6 +9,7 @@
 
 #include <memory.h>
 #include <algorithm>
+#include <cassert>
 #include <cstring>
 
 #include <xmmintrin.h>
@@ -291,29 +292,22 @@ CMatrix44f& CMatrix44f::RotateEulerZYX(const float3& angles)
 //
 CMatrix44f& CMatrix44f::Scale(const float3& scales)
 {
-	m[ 0] *= scales.x;
-	m[ 1] *= scales.x;
-	m[ 2] *= scales.x;
-	m[ 3] *= scales.x;
-
-	m[ 4] *= scales.y;
-	m[ 5] *= scales.y;
-	m[ 6] *= scales.y;
-	m[ 7] *= scales.y;
-
-	m[ 8] *= scales.z;
-	m[ 9] *= scales.z;
-	m[10] *= scales.z;
-	m[11] *= scales.z;
+	_mm_store_ps(&md[0][0], _mm_mul_ps(_mm_load_ps(&md[0][0]), _mm_set1_ps(scales.x)));
+	_mm_store_ps(&md[1][0], _mm_mul_ps(_mm_load_ps(&md[1][0]), _mm_set1_ps(scales.y)));
+	_mm_store_ps(&md[2][0], _mm_mul_ps(_mm_load_ps(&md[2][0]), _mm_set1_ps(scales.z)));
 	return *this;
 }
 
+// same operation order as the scalar m[12+i] += (x*m[i] + y*m[4+i] + z*m[8+i]),
+// without FMA this is bit-identical and therefore also safe for synced code
 CMatrix44f& CMatrix44f::Translate(const float x, const float y, const float z)
 {
-	m[12] += (x*m[0] + y*m[4] + z*m[ 8]);
-	m[13] += (x*m[1] + y*m[5] + z*m[ 9]);
-	m[14] += (x*m[2] + y*m[6] + z*m[10]);
-	m[15] += (x*m[3] + y*m[7] + z*m[11]);
+	__m128 t;
+	t =               _mm_mul_ps(_mm_load_ps(&md[0][0]), _mm_set1_ps(x)) ;
+	t = _mm_add_ps(t, _mm_mul_ps(_mm_load_ps(&md[1][0]), _mm_set1_ps(y)));
+	t = _mm_add_ps(t, _mm_mul_ps(_mm_load_ps(&md[2][0]), _mm_set1_ps(z)));
+
+	_mm_store_ps(&md[3][0], _mm_add_ps(_mm_load_ps(&md[3][0]), t));
 	return *this;
 }
 
@@ -472,6 +466,44 @@ float4 CMatrix44f::operator* (const float4 v) const
 	#endif
 }
 
+__FORCE_ALIGN_STACK__
+void CMatrix44f::MulPoints(const CMatrix44f& mat, const float3* points, float3* outPoints, size_t count)
+{
+	const __m128 c0 = _mm_load_ps(&mat.md[0][0]);
+	const __m128 c1 = _mm_load_ps(&mat.md[1][0]);
+	const __m128 c2 = _mm_load_ps(&mat.md[2][0]);
+	const __m128 c3 = _mm_load_ps(&mat.md[3][0]);
+
+	// same operations as operator*(float3), w=1 makes the last product exact
+	for (size_t i = 0; i < count; i++) {
+		const float3 p = points[i];
+
+		__m128 out;
+		out =                 _mm_mul_ps(c0, _mm_set1_ps(p.x)) ;
+		out = _mm_add_ps(out, _mm_mul_ps(c1, _mm_set1_ps(p.y)));
+		out = _mm_add_ps(out, _mm_mul_ps(c2, _mm_set1_ps(p.z)));
+		out = _mm_add_ps(out, _mm_mul_ps(c3, _mm_set1_ps(1.0f)));
+
+		alignas(16) float fout[4];
+		_mm_store_ps(fout, out);
+		outPoints[i] = {fout[0], fout[1], fout[2]};
+	}
+}
+
+void CMatrix44f::MulHierarchy(const CMatrix44f* localMats, const int* parents, CMatrix44f* outMats, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		assert(parents[i] < static_cast<int>(i));
+
+		if (parents[i] < 0) {
+			outMats[i] = localMats[i];
+			continue;
+		}
+
+		MatrixMatrixMultiplySSE(outMats[ parents[i] ], localMats[i], &outMats[i]);
+	}
+}
+
 
 void CMatrix44f::SetUpVector(const float3& up)
 {
@@ -497,14 +529,17 @@ void CMatrix44f::SetUpVector(const float3& up)
 
 CMatrix44f& CMatrix44f::Transpose()
 {
-	std::swap(md[0][1], md[1][0]);
-	std::swap(md[0][2], md[2][0]);
-	std::swap(md[0][3], md[3][0]);
+	__m128 c0 = _mm_load_ps(&md[0][0]);
+	__m128 c1 = _mm_load_ps(&md[1][0]);
+	__m128 c2 = _mm_load_ps(&md[2][0]);
+	__m128 c3 = _mm_load_ps(&md[3][0]);
 
-	std::swap(md[1][2], md[2][1]);
-	std::swap(md[1][3], md[3][1]);
+	_MM_TRANSPOSE4_PS(c0, c1, c2, c3);
 
-	std::swap(md[2][3], md[3][2]);
+	_mm_store_ps(&md[0][0], c0);
+	_mm_store_ps(&md[1][0], c1);
+	_mm_store_ps(&md[2][0], c2);
+	_mm_store_ps(&md[3][0], c3);
 	return *this;
 }
 
@@ -100,6 +100,13 @@ public:
 	float3 Mul(const float3 v) const { return ((*this) * v); }
 	float4 Mul(const float4 v) const { return ((*this) * v); }
 
+	/// batch kernels, bit-identical to the per-element operators (also in synced code)
+	/// outPoints[i] = mat * points[i] (w=1); points and outPoints may be the same array
+	static void MulPoints(const CMatrix44f& mat, const float3* points, float3* outPoints, size_t count);
+	/// outMats[i] = outMats[parents[i]] * localMats[i], or localMats[i] for roots (parents[i] < 0);
+	/// parents must precede their children, as in a depth-first piece order
+	static void MulHierarchy(const CMatrix44f* localMats, const int* parents, CMatrix44f* outMats, size_t count);
+
 	/// approximately equal
 	bool equals(const CMatrix44f& rhs) const;
 
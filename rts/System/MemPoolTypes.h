@@ -3,15 +3,18 @@
 #ifndef MEMPOOL_TYPES_H
 #define MEMPOOL_TYPES_H
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstring> // memset
 #include <cmath>
 #include <array>
+#include <atomic>
 #include <deque>
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
 
 #include "smmalloc/smmalloc.h"
 
@@ -19,6 +22,7 @@
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
 #include "System/Platform/Threading.h"
+#include "System/Threading/SpringThreading.h"
 #include "System/Log/ILog.h"
 
 template<uint32_t NumBuckets, size_t BucketSize> struct PassThroughPool {
@@ -372,6 +376,180 @@ template<size_t N, class ...T>
 using StaticMemPoolT = StaticMemPool<N, sizeof(TypesMem<T...>), alignof(TypesMem<T...>)>;
 
 
+namespace MemPoolDetail {
+	static constexpr size_t MAX_THREAD_SLOTS = 64;
+
+	inline std::atomic<size_t> numThreadSlots = {0};
+
+	// handed out once per thread; threads beyond MAX_THREAD_SLOTS share the locked path
+	inline size_t GetThreadSlot() {
+		// constant-initialized, avoids the guard of a dynamic thread_local on every call
+		thread_local size_t slot = size_t(-1);
+
+		if (slot == size_t(-1))
+			slot = numThreadSlots.fetch_add(1, std::memory_order_relaxed);
+
+		return slot;
+	}
+}
+
+// Per-thread magazines in front of one of the single-threaded pools above,
+// s.t. objects can be created and destroyed from parallel sections. Each
+// thread pops pages from its own magazine without locking; an empty one is
+// refilled with <M> pages from the central pool at once, and a full one
+// (2 * M) hands half of its pages back, so the central lock is taken once
+// per M allocations at most.
+//
+// NB: which pages a thread receives depends on scheduling; synced code must
+// not derive anything (e.g. an ordering) from the addresses when allocating
+// in parallel. Pages cached by other threads are not available to a thread
+// whose magazine ran dry while the central pool is exhausted.
+template<typename Pool, size_t M = 32> struct ThreadCachedMemPool {
+public:
+	template<typename T, typename... A> T* alloc(A&&... a) {
+		static_assert(sizeof(T) <= PAGE_SIZE(), "");
+		return new (allocMem(sizeof(T))) T(std::forward<A>(a)...);
+	}
+
+	void* allocMem(size_t size) {
+		assert(size <= PAGE_SIZE());
+
+		const size_t slot = MemPoolDetail::GetThreadSlot();
+
+		if (slot >= MemPoolDetail::MAX_THREAD_SLOTS) {
+			std::lock_guard<spring::spinlock> lck(mutex);
+			return (overflowPage = pool.allocMem(size));
+		}
+
+		Magazine& mag = magazines[slot];
+
+		if (mag.pages.empty())
+			Refill(mag);
+		if (mag.pages.empty())
+			return (mag.lastPage = nullptr);
+
+		// must pop before ctor runs; objects can be created recursively
+		return (mag.lastPage = spring::VectorBackPop(mag.pages));
+	}
+
+	template<typename T> void free(T*& p) {
+		assert(mapped(p));
+		void* m = p;
+
+		spring::SafeDestruct(p);
+		// after the dtor, which can allocate by proxy (see DynMemPool::free)
+		freeMem(m);
+	}
+
+	void freeMem(void* m) {
+		const size_t slot = MemPoolDetail::GetThreadSlot();
+
+		if (slot >= MemPoolDetail::MAX_THREAD_SLOTS) {
+			std::lock_guard<spring::spinlock> lck(mutex);
+			pool.freeMem(m);
+			return;
+		}
+
+		Magazine& mag = magazines[slot];
+
+		// pools hand out zeroed pages, keep it that way for cached ones
+		std::memset(m, 0, PAGE_SIZE());
+		mag.pages.push_back(m);
+
+		if (mag.pages.size() >= (M * 2))
+			Flush(mag, M);
+	}
+
+	static constexpr size_t PAGE_SIZE() { return Pool::PAGE_SIZE(); }
+
+	// these (and clear, reserve) must not run concurrently with allocations
+	size_t alloc_size() const { return pool.alloc_size(); }
+	size_t freed_size() const {
+		size_t numCached = 0;
+
+		for (const Magazine& mag: magazines) {
+			numCached += mag.pages.size();
+		}
+
+		return (pool.freed_size() + numCached * PAGE_SIZE());
+	}
+
+	bool mapped(void* p) const { return pool.mapped(p); }
+	// whether <p> is the page last handed out to the calling thread
+	bool alloced(void* p) const {
+		const size_t slot = MemPoolDetail::GetThreadSlot();
+
+		if (slot >= MemPoolDetail::MAX_THREAD_SLOTS)
+			return (overflowPage == p);
+
+		return (magazines[slot].lastPage == p);
+	}
+	bool can_alloc() const {
+		const size_t slot = MemPoolDetail::GetThreadSlot();
+		return ((slot < MemPoolDetail::MAX_THREAD_SLOTS && !magazines[slot].pages.empty()) || pool.can_alloc());
+	}
+	bool can_free() const { return pool.can_free(); }
+
+	void reserve(size_t n) {
+		pool.reserve(n);
+
+		for (Magazine& mag: magazines) {
+			mag.pages.reserve(M * 2);
+		}
+	}
+	void clear() {
+		// cached pages belong to the pool, whose clear() reclaims all of them
+		for (Magazine& mag: magazines) {
+			mag.pages.clear();
+			mag.lastPage = nullptr;
+		}
+
+		overflowPage = nullptr;
+		pool.clear();
+	}
+
+private:
+	struct alignas(64) Magazine {
+		std::vector<void*> pages;
+		void* lastPage = nullptr;
+	};
+
+	void Refill(Magazine& mag) {
+		std::lock_guard<spring::spinlock> lck(mutex);
+
+		for (size_t i = 0; i < M && pool.can_alloc(); i++) {
+			void* m = pool.allocMem(PAGE_SIZE());
+
+			if (m == nullptr)
+				break;
+
+			mag.pages.push_back(m);
+		}
+
+		// handed out in the order the central pool would have used
+		std::reverse(mag.pages.begin(), mag.pages.end());
+	}
+
+	void Flush(Magazine& mag, size_t n) {
+		std::lock_guard<spring::spinlock> lck(mutex);
+
+		// oldest pages first, recently freed ones are more likely still cached
+		for (size_t i = 0; i < n; i++) {
+			pool.freeMem(mag.pages[i]);
+		}
+
+		mag.pages.erase(mag.pages.begin(), mag.pages.begin() + n);
+	}
+
+private:
+	Pool pool;
+	spring::spinlock mutex;
+
+	std::array<Magazine, MemPoolDetail::MAX_THREAD_SLOTS> magazines;
+	void* overflowPage = nullptr;
+};
+
+
 // dynamic memory allocator operating with stable index positions
 // has gaps management
 template <typename T>
@@ -401,7 +579,12 @@ public:
 
 	virtual size_t Allocate(size_t numElems);
 	virtual void Free(size_t firstElem, size_t numElems, const T* T0 = nullptr);
+	// moves [firstElem, firstElem + numElems) into the best fitting gap in front of it,
+	// returns the new position or firstElem if no such gap exists
+	size_t Relocate(size_t firstElem, size_t numElems, const T* T0 = nullptr);
+
 	const size_t GetSize() const { return data.size(); }
+	size_t GetNumFreeElems() const;
 	const std::vector<T>& GetData() const { return data; }
 	      std::vector<T>& GetData()       { return data; }
 
@@ -410,9 +593,13 @@ public:
 
 	static constexpr std::size_t INVALID_INDEX = ~0u;
 private:
+	size_t TakeGap(std::multimap<size_t, size_t>::iterator sizePosIt, size_t numElems);
+	void EraseSizeToPosition(size_t size, size_t pos);
+	void TrimTrailingGaps();
 	void CompactGaps();
 private:
 	std::vector<T> data;
+	// free gaps bucketed by size, lower_bound() yields the best fit
 	std::multimap<size_t, size_t> sizeToPositions;
 	std::map<size_t, size_t> positionToSize;
 };
@@ -432,21 +619,8 @@ inline size_t StablePosAllocator<T>::Allocate(size_t numElems)
 	}
 
 	//try to find gaps >= in size than requested
-	for (auto it = sizeToPositions.lower_bound(numElems); it != sizeToPositions.end(); ++it) {
-		if (it->first < numElems)
-			continue;
-
-		size_t returnPos = it->second;
-		positionToSize.erase(it->second);
-
-		if (it->first > numElems) {
-			size_t gapSize = it->first - numElems;
-			size_t gapPos = it->second + numElems;
-			sizeToPositions.emplace(gapSize, gapPos);
-			positionToSize.emplace(gapPos, gapSize);
-		}
-
-		sizeToPositions.erase(it);
+	if (auto it = sizeToPositions.lower_bound(numElems); it != sizeToPositions.end()) {
+		size_t returnPos = TakeGap(it, numElems);
 		myLog("StablePosAllocator<T>::Allocate(%u) = %u", uint32_t(numElems), uint32_t(returnPos));
 		return returnPos;
 	}
@@ -458,6 +632,89 @@ inline size_t StablePosAllocator<T>::Allocate(size_t numElems)
 	return returnPos;
 }
 
+//carve numElems off the front of the gap, the remainder stays a gap
+template<typename T>
+inline size_t StablePosAllocator<T>::TakeGap(std::multimap<size_t, size_t>::iterator sizePosIt, size_t numElems)
+{
+	assert(sizePosIt->first >= numElems);
+
+	size_t returnPos = sizePosIt->second;
+	positionToSize.erase(sizePosIt->second);
+
+	if (sizePosIt->first > numElems) {
+		size_t gapSize = sizePosIt->first - numElems;
+		size_t gapPos = sizePosIt->second + numElems;
+		sizeToPositions.emplace(gapSize, gapPos);
+		positionToSize.emplace(gapPos, gapSize);
+	}
+
+	sizeToPositions.erase(sizePosIt);
+	return returnPos;
+}
+
+//erase {size, pos} pair from sizeToPositions multimap
+template<typename T>
+inline void StablePosAllocator<T>::EraseSizeToPosition(size_t size, size_t pos)
+{
+	auto [beg, end] = sizeToPositions.equal_range(size);
+	for (auto it = beg; it != end; ++it) {
+		if (it->second != pos)
+			continue;
+
+		sizeToPositions.erase(it);
+		break;
+	}
+}
+
+//gaps that ended up at the end of data are not gaps anymore
+template<typename T>
+inline void StablePosAllocator<T>::TrimTrailingGaps()
+{
+	while (!positionToSize.empty()) {
+		std::map<size_t, size_t>::iterator posSizeFin = positionToSize.end(); std::advance(posSizeFin, -1);
+		if (posSizeFin->first + posSizeFin->second != data.size())
+			break;
+
+		data.resize(posSizeFin->first);
+		EraseSizeToPosition(posSizeFin->second, posSizeFin->first);
+		positionToSize.erase(posSizeFin);
+	}
+}
+
+template<typename T>
+inline size_t StablePosAllocator<T>::GetNumFreeElems() const
+{
+	size_t numFreeElems = 0;
+	for (const auto& [pos, size] : positionToSize)
+		numFreeElems += size;
+
+	return numFreeElems;
+}
+
+template<typename T>
+inline size_t StablePosAllocator<T>::Relocate(size_t firstElem, size_t numElems, const T* T0)
+{
+	assert(firstElem + numElems <= data.size());
+
+	if (numElems == 0)
+		return firstElem;
+
+	//smallest gap that fits and lies in front of the range
+	auto it = sizeToPositions.lower_bound(numElems);
+	while (it != sizeToPositions.end() && it->second > firstElem)
+		++it;
+
+	if (it == sizeToPositions.end())
+		return firstElem;
+
+	const size_t newPos = TakeGap(it, numElems);
+	std::copy(data.begin() + firstElem, data.begin() + firstElem + numElems, data.begin() + newPos);
+	Free(firstElem, numElems, T0);
+
+	myLog("StablePosAllocator<T>::Relocate(%u, %u) = %u", uint32_t(firstElem), uint32_t(numElems), uint32_t(newPos));
+	return newPos;
+}
+
 //merge adjacent gaps and trim data vec
 template<typename T>
 inline void StablePosAllocator<T>::CompactGaps()
@@ -465,19 +722,6 @@ inline void StablePosAllocator<T>::CompactGaps()
 	if (positionToSize.empty())
 		return;
 
-	//helper to erase {size, pos} pair from sizeToPositions multimap
-	const auto eraseSizeToPositionsKVFunc = [this](size_t size, size_t pos) {
-		auto [beg, end] = sizeToPositions.equal_range(size);
-		for (auto it = beg; it != end; /*noop*/)
-			if (it->second == pos) {
-				it = sizeToPositions.erase(it);
-				break;
-			}
-			else {
-				++it;
-			}
-	};
-
 	bool found;
 	std::size_t posStartFrom = 0u;
 	do {
@@ -494,8 +738,8 @@ inline void StablePosAllocator<T>::CompactGaps()
 				std::size_t newPos = posSizeThis->first;
 				std::size_t newSize = posSizeThis->second + posSizeNext->second;
 
-				eraseSizeToPositionsKVFunc(posSizeThis->second, posSizeThis->first);
-				eraseSizeToPositionsKVFunc(posSizeNext->second, posSizeNext->first);
+				EraseSizeToPosition(posSizeThis->second, posSizeThis->first);
+				EraseSizeToPosition(posSizeNext->second, posSizeNext->first);
 
 				positionToSize.erase(posSizeThis);
 				positionToSize.erase(posSizeNext); //this iterator is guaranteed to stay valid after 1st erase
@@ -510,15 +754,7 @@ inline void StablePosAllocator<T>::CompactGaps()
 		}
 	} while (found);
 
-	std::map<size_t, size_t>::iterator posSizeFin = positionToSize.end(); std::advance(posSizeFin, -1);
-	if (posSizeFin->first + posSizeFin->second == data.size()) {
-		//trim data vector
-		data.resize(posSizeFin->first);
-		//erase old sizeToPositions
-		eraseSizeToPositionsKVFunc(posSizeFin->second, posSizeFin->first);
-		//erase old positionToSize
-		positionToSize.erase(posSizeFin);
-	}
+	TrimTrailingGaps();
 }
 
 template<typename T>
@@ -538,6 +774,8 @@ inline void StablePosAllocator<T>::Free(size_t firstElem, size_t numElems, const
 	if (firstElem + numElems == data.size()) {
 		myLog("StablePosAllocator<T>::Free(%u, %u)", uint32_t(firstElem), uint32_t(numElems));
 		data.resize(firstElem);
+		//otherwise gaps left in front keep the vector from ever shrinking further
+		TrimTrailingGaps();
 		return;
 	}
 
@@ -0,0 +1,139 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <utility>
+
+#if defined(ALLOCATION_COUNTING)
+	#define SCOPED_ALLOC_TAG(name) static const uint32_t __allocTagIdx = CAllocCounter::RegisterTag(name); CAllocCounter::ScopedTag __scopedAllocTag(__allocTagIdx);
+#else
+	#define SCOPED_ALLOC_TAG(name)
+#endif
+
+/**
+ * Heap allocation counts per subsystem and frame.
+ *
+ * Built with ALLOCATION_COUNTING, the global operator new (System/TraceMemory.cpp)
+ * charges every allocation to the tag of the calling thread. SCOPED_ALLOC_TAG
+ * sets that tag until the end of its scope, nested scopes charge the innermost
+ * one and untagged code charges OTHER_TAG. Every SCOPED_TIMER opens a tag named
+ * after its timer; worker threads of a for_mt keep their own (usually OTHER_TAG).
+ * Lua states mostly allocate from the arena of their LuaMemPool, which never
+ * reaches operator new, so the pool reports those through CountLua instead.
+ *
+ * EndFrame (called on every buffer swap) latches the counts of the frame that
+ * just ended, including the sim frames run during it. Without the build option
+ * the macro expands to nothing and all counts stay zero.
+ */
+class CAllocCounter {
+public:
+	static constexpr uint32_t MAX_TAGS = 128;
+	static constexpr uint32_t OTHER_TAG = 0;
+
+	struct Stats {
+		uint64_t numAllocs = 0;
+		uint64_t numBytes = 0;
+		uint64_t numLuaAllocs = 0;
+		uint64_t numLuaBytes = 0;
+	};
+
+	class ScopedTag {
+	public:
+		explicit ScopedTag(uint32_t tag): prevTag(std::exchange(curTag, tag)) {}
+		~ScopedTag() { curTag = prevTag; }
+
+		ScopedTag(const ScopedTag&) = delete;
+		ScopedTag& operator = (const ScopedTag&) = delete;
+	private:
+		uint32_t prevTag;
+	};
+
+public:
+	static constexpr bool IsEnabled() {
+	#if defined(ALLOCATION_COUNTING)
+		return true;
+	#else
+		return false;
+	#endif
+	}
+
+	// returns the same index for every call with an equal name, OTHER_TAG once all are taken
+	static uint32_t RegisterTag(const char* name) {
+		const std::lock_guard<std::mutex> lock(tagMutex);
+		const uint32_t n = numTags.load(std::memory_order_relaxed);
+
+		for (uint32_t i = 0; i < n; i++) {
+			if (std::strcmp(tagNames[i], name) == 0)
+				return i;
+		}
+
+		if (n == MAX_TAGS)
+			return OTHER_TAG;
+
+		tagNames[n] = name;
+		numTags.store(n + 1, std::memory_order_release);
+		return n;
+	}
+
+	// hot paths; must not allocate themselves
+	static void Count(size_t numBytes) {
+	#if defined(ALLOCATION_COUNTING)
+		Counter& c = counters[curTag];
+		c.numAllocs.fetch_add(1, std::memory_order_relaxed);
+		c.numBytes.fetch_add(numBytes, std::memory_order_relaxed);
+	#endif
+	}
+	static void CountLua(size_t numBytes) {
+	#if defined(ALLOCATION_COUNTING)
+		Counter& c = counters[curTag];
+		c.numLuaAllocs.fetch_add(1, std::memory_order_relaxed);
+		c.numLuaBytes.fetch_add(numBytes, std::memory_order_relaxed);
+	#endif
+	}
+
+	static void EndFrame() {
+		for (uint32_t i = 0, n = GetNumTags(); i < n; i++) {
+			Counter& c = counters[i];
+			Stats& s = frameStats[i];
+
+			s.numAllocs    = c.numAllocs.exchange(0, std::memory_order_relaxed);
+			s.numBytes     = c.numBytes.exchange(0, std::memory_order_relaxed);
+			s.numLuaAllocs = c.numLuaAllocs.exchange(0, std::memory_order_relaxed);
+			s.numLuaBytes  = c.numLuaBytes.exchange(0, std::memory_order_relaxed);
+		}
+	}
+
+	static uint32_t GetNumTags() { return numTags.load(std::memory_order_acquire); }
+	static const char* GetTagName(uint32_t tag) { return tagNames[tag]; }
+	// counts of the last completed frame
+	static const Stats& GetFrameStats(uint32_t tag) { return frameStats[tag]; }
+
+private:
+	struct Counter {
+		std::atomic<uint64_t> numAllocs = {0};
+		std::atomic<uint64_t> numBytes = {0};
+		std::atomic<uint64_t> numLuaAllocs = {0};
+		std::atomic<uint64_t> numLuaBytes = {0};
+	};
+
+	static inline thread_local uint32_t curTag = OTHER_TAG;
+
+	static std::array<Counter, MAX_TAGS> counters;
+	static std::array<Stats, MAX_TAGS> frameStats;
+
+	static inline std::array<const char*, MAX_TAGS> tagNames = {"Other"};
+	static inline std::atomic<uint32_t> numTags = {1};
+	static inline std::mutex tagMutex;
+};
+
+// defined out of class, the nested types have to be complete
+inline std::array<CAllocCounter::Counter, CAllocCounter::MAX_TAGS> CAllocCounter::counters;
+inline std::array<CAllocCounter::Stats, CAllocCounter::MAX_TAGS> CAllocCounter::frameStats;
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,149 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+
+namespace spring {
+	/**
+	 * @brief Lock-free log-linear (HDR-style) latency histogram
+	 *
+	 * Samples are stored in 0.1ms units; every power-of-two range is split
+	 * into SUB_BUCKETS linear buckets, which bounds the relative error of a
+	 * reported percentile to 1/SUB_BUCKETS. Record() may be called from any
+	 * thread, Snapshot() from any other; Decay() ages old samples so that
+	 * percentiles follow the recent distribution rather than the whole game.
+	 */
+	class LatencyHistogram {
+	public:
+		struct Snapshot {
+			float p50 = 0.0f;
+			float p95 = 0.0f;
+			float p99 = 0.0f;
+			float max = 0.0f;
+			float jitter = 0.0f;
+			uint32_t numSamples = 0;
+		};
+
+	public:
+		void Record(float ms) {
+			const uint32_t ticks = static_cast<uint32_t>(std::fmax(ms, 0.0f) * TICKS_PER_MS);
+
+			counts[BucketIndex(ticks)].fetch_add(1, std::memory_order_relaxed);
+
+			// RFC 3550 interarrival jitter estimate, J += (|D| - J) / 16
+			const float prev = lastSample.exchange(ms, std::memory_order_relaxed);
+			if (prev >= 0.0f) {
+				const float j = jitter.load(std::memory_order_relaxed);
+				jitter.store(j + (std::fabs(ms - prev) - j) / 16.0f, std::memory_order_relaxed);
+			}
+		}
+
+		/**
+		 * halves every bucket once more than <maxSamples> are held; called at a
+		 * fixed cadence this keeps between maxSamples/2 and maxSamples of the
+		 * most recent samples no matter how often Record() runs in between
+		 */
+		void Decay(uint32_t maxSamples) {
+			uint64_t total = 0;
+
+			for (const auto& c: counts) {
+				total += c.load(std::memory_order_relaxed);
+			}
+
+			if (total <= maxSamples)
+				return;
+
+			for (auto& c: counts) {
+				c.store(c.load(std::memory_order_relaxed) >> 1, std::memory_order_relaxed);
+			}
+		}
+
+		Snapshot GetSnapshot() const {
+			std::array<uint32_t, NUM_BUCKETS> local;
+			uint64_t total = 0;
+
+			for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+				total += (local[i] = counts[i].load(std::memory_order_relaxed));
+			}
+
+			Snapshot s;
+			s.jitter = jitter.load(std::memory_order_relaxed);
+			s.numSamples = static_cast<uint32_t>(total);
+
+			if (total == 0)
+				return s;
+
+			const uint64_t r50 = (total * 50 + 99) / 100;
+			const uint64_t r95 = (total * 95 + 99) / 100;
+			const uint64_t r99 = (total * 99 + 99) / 100;
+
+			uint64_t seen = 0;
+			for (uint32_t i = 0; i < NUM_BUCKETS; ++i) {
+				if (local[i] == 0)
+					continue;
+
+				const uint64_t prevSeen = seen;
+				const float value = BucketValue(i) * (1.0f / TICKS_PER_MS);
+
+				seen += local[i];
+
+				if (prevSeen < r50 && seen >= r50) s.p50 = value;
+				if (prevSeen < r95 && seen >= r95) s.p95 = value;
+				if (prevSeen < r99 && seen >= r99) s.p99 = value;
+
+				s.max = value;
+			}
+
+			return s;
+		}
+
+	private:
+		static constexpr uint32_t TICKS_PER_MS = 10;
+		static constexpr uint32_t SUB_BUCKET_BITS = 4;
+		static constexpr uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+		// covers 0 to 2^20 ticks (~105 seconds); larger samples land in the last bucket
+		static constexpr uint32_t MAX_EXPONENT = 20;
+		static constexpr uint32_t NUM_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+		static uint32_t BucketIndex(uint32_t ticks) {
+			if (ticks < SUB_BUCKETS)
+				return ticks;
+
+			const uint32_t exponent = std::bit_width(ticks) - 1;
+
+			if (exponent >= MAX_EXPONENT)
+				return NUM_BUCKETS - 1;
+
+			const uint32_t shift = exponent - SUB_BUCKET_BITS;
+			const uint32_t sub = (ticks >> shift) & (SUB_BUCKETS - 1);
+
+			return (shift + 1) * SUB_BUCKETS + sub;
+		}
+
+		/// midpoint of the value range mapped to bucket <idx>, in ticks
+		static float BucketValue(uint32_t idx) {
+			if (idx < SUB_BUCKETS)
+				return static_cast<float>(idx);
+
+			const uint32_t shift = idx / SUB_BUCKETS - 1;
+			const uint32_t sub = idx % SUB_BUCKETS;
+			const uint32_t lower = (SUB_BUCKETS + sub) << shift;
+
+			return lower + ((1u << shift) - 1) * 0.5f;
+		}
+
+	private:
+		std::array<std::atomic<uint32_t>, NUM_BUCKETS> counts = {};
+
+		std::atomic<float> lastSample = {-1.0f};
+		std::atomic<float> jitter = {0.0f};
+	};
+}
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,137 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef STARTUP_TRACE_H
+#define STARTUP_TRACE_H
+
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+#define SCOPED_STARTUP_TRACE(name, cat) CStartupTrace::Scope __startupTraceScope(name, cat);
+
+/**
+ * Timeline of everything that runs until a game has finished loading.
+ *
+ * Enabled by --startup-trace=<file>, which makes every ScopedOnceTimer, every
+ * loadscreen stage and every SCOPED_STARTUP_TRACE scope (archive scans, Lua
+ * code loads, shader compiles, ...) record a complete-event. Once loading is
+ * done the events are written in the Chrome trace format (chrome://tracing,
+ * Perfetto), which nests them per thread by time, and recording stops. Events
+ * are only collected while enabled, a disabled scope costs one clock read.
+ */
+class CStartupTrace {
+public:
+	class Scope {
+	public:
+		Scope(const char* name_, const char* cat_): name(name_), cat(cat_), startTime(spring_gettime()) {}
+		Scope(std::string name_, const char* cat_): name(std::move(name_)), cat(cat_), startTime(spring_gettime()) {}
+		~Scope() { AddEvent(name, cat, startTime, spring_gettime() - startTime); }
+
+		Scope(const Scope&) = delete;
+		Scope& operator = (const Scope&) = delete;
+	private:
+		std::string name;
+		const char* cat;
+		spring_time startTime;
+	};
+
+public:
+	static void Enable(const std::string& fileName) {
+		const std::lock_guard<std::mutex> lock(mutex);
+
+		traceFile = fileName;
+		traceStart = spring_gettime();
+		enabled.store(true, std::memory_order_release);
+	}
+
+	static bool IsEnabled() { return enabled.load(std::memory_order_acquire); }
+	static const std::string& GetFileName() { return traceFile; }
+
+	static void AddEvent(const std::string& name, const char* cat, spring_time startTime, spring_time duration) {
+		if (!IsEnabled())
+			return;
+
+		const std::lock_guard<std::mutex> lock(mutex);
+
+		events.push_back({name, cat, (startTime - traceStart).toMicroSecsi(), duration.toMicroSecsi(), GetThreadIndex()});
+	}
+
+	// stops recording; returns false if nothing was recorded or <filePath> can not be written
+	static bool Finish(const std::string& filePath) {
+		if (!enabled.exchange(false, std::memory_order_acq_rel))
+			return false;
+
+		const std::lock_guard<std::mutex> lock(mutex);
+		FILE* file = fopen(filePath.c_str(), "w");
+
+		if (file == nullptr)
+			return false;
+
+		fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+		for (size_t i = 0, n = events.size(); i < n; i++) {
+			const Event& e = events[i];
+
+			fprintf(file, "\t{\"name\": \"%s\", \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %lld, \"dur\": %lld, \"pid\": 0, \"tid\": %u}%s\n",
+				Escape(e.name).c_str(), e.cat, static_cast<long long>(e.ts), static_cast<long long>(e.dur), e.tid, (i + 1 < n)? ",": "");
+		}
+
+		fprintf(file, "]}\n");
+		fclose(file);
+
+		events.clear();
+		events.shrink_to_fit();
+		return true;
+	}
+
+private:
+	struct Event {
+		std::string name;
+		const char* cat;
+		int64_t ts;
+		int64_t dur;
+		uint32_t tid;
+	};
+
+	// small stable per-thread numbers read better in trace viewers than OS ids
+	static uint32_t GetThreadIndex() {
+		static std::atomic<uint32_t> numThreads = {0};
+		static thread_local const uint32_t index = numThreads.fetch_add(1, std::memory_order_relaxed);
+		return index;
+	}
+
+	static std::string Escape(const std::string& s) {
+		std::string r;
+		r.reserve(s.size());
+
+		for (const char c: s) {
+			if (c == '"' || c == '\\') {
+				r += '\\';
+				r += c;
+				continue;
+			}
+			if (static_cast<unsigned char>(c) < 0x20) {
+				r += ' ';
+				continue;
+			}
+
+			r += c;
+		}
+
+		return r;
+	}
+
+private:
+	static inline std::atomic<bool> enabled = {false};
+	static inline std::mutex mutex;
+
+	static inline std::vector<Event> events;
+	static inline std::string traceFile;
+	static inline spring_time traceStart;
+};
+
+#endif // STARTUP_TRACE_H
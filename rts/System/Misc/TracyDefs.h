@@ -1,9 +1,158 @@
 #pragma once
 
+#include <atomic>
+#include <iterator>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
 #include <tracy/Tracy.hpp>
 
 #ifdef RECOIL_DETAILED_TRACY_ZONING
 	#define RECOIL_DETAILED_TRACY_ZONE ZoneScoped
 #else
 	#define RECOIL_DETAILED_TRACY_ZONE do {} while(0)
-#endif
\ No newline at end of file
+#endif
+
+
+/*
+	Categorized zones, coarse enough to stay enabled in regular Tracy builds
+	(unlike the detailed ones above). A category is compiled out entirely by
+	leaving its bit out of RECOIL_TRACY_CATEGORIES, and can be switched off at
+	runtime through the TracyZones config or the /TracyZones command.
+
+		RECOIL_TRACY_ZONE(LOS);                        // zone named after the function
+		RECOIL_TRACY_ZONE_N(PATH, "QTPFS::RawSearch");
+		RECOIL_TRACY_ZONE_NAME(LUA, name, strlen(name)); // dynamic name for the zone above
+
+	SCOPED_TIMER zones are categorized by their name, see CategoryOf.
+*/
+#define RECOIL_TRACY_CAT_SIM  (1u << 0)
+#define RECOIL_TRACY_CAT_PATH (1u << 1)
+#define RECOIL_TRACY_CAT_LOS  (1u << 2)
+#define RECOIL_TRACY_CAT_COB  (1u << 3)
+#define RECOIL_TRACY_CAT_LUA  (1u << 4)
+#define RECOIL_TRACY_CAT_NET  (1u << 5)
+#define RECOIL_TRACY_CAT_DRAW (1u << 6)
+#define RECOIL_TRACY_CAT_MISC (1u << 7)
+#define RECOIL_TRACY_CAT_ALL  ((1u << 8) - 1)
+
+#ifndef RECOIL_TRACY_CATEGORIES
+	#define RECOIL_TRACY_CATEGORIES RECOIL_TRACY_CAT_ALL
+#endif
+
+namespace Recoil::TracyZones {
+	inline std::atomic<uint32_t> enabledCategories = {RECOIL_TRACY_CAT_ALL};
+
+	inline bool IsEnabled(uint32_t category) {
+		return ((RECOIL_TRACY_CATEGORIES & category) != 0 && (enabledCategories.load(std::memory_order_relaxed) & category) != 0);
+	}
+	inline void SetEnabled(uint32_t categories) { enabledCategories.store(categories & RECOIL_TRACY_CAT_ALL, std::memory_order_relaxed); }
+	inline uint32_t GetEnabled() { return enabledCategories.load(std::memory_order_relaxed); }
+
+	// maps CTimeProfiler timer names onto categories, evaluated at compile time
+	constexpr uint32_t CategoryOf(std::string_view name) {
+		if (name.starts_with("Sim::Path") || name.find("::Path::") != std::string_view::npos)
+			return RECOIL_TRACY_CAT_PATH;
+		if (name.starts_with("Sim::Los") || name.ends_with("::Los"))
+			return RECOIL_TRACY_CAT_LOS;
+		if (name.starts_with("Sim::Script"))
+			return RECOIL_TRACY_CAT_COB;
+		if (name.starts_with("Sim::") || name.starts_with("ECS::"))
+			return RECOIL_TRACY_CAT_SIM;
+		if (name.starts_with("Lua::"))
+			return RECOIL_TRACY_CAT_LUA;
+		if (name.starts_with("Draw::") || name.starts_with("Update::") || name.starts_with("Misc::SwapBuffers"))
+			return RECOIL_TRACY_CAT_DRAW;
+
+		return RECOIL_TRACY_CAT_MISC;
+	}
+
+	// indexed by bit, as understood by the TracyZones config and command
+	constexpr std::string_view CATEGORY_NAMES[] = {"sim", "path", "los", "cob", "lua", "net", "draw", "misc"};
+
+	// "all", "none" or a comma-separated list like "sim,path,lua"; unknown names are ignored
+	inline uint32_t ParseCategories(std::string_view list) {
+		uint32_t categories = 0;
+
+		while (!list.empty()) {
+			const size_t sep = list.find(',');
+			const std::string_view name = list.substr(0, sep);
+
+			if (name == "all")
+				categories |= RECOIL_TRACY_CAT_ALL;
+
+			for (size_t i = 0; i < std::size(CATEGORY_NAMES); i++) {
+				categories |= ((name == CATEGORY_NAMES[i]) * (1u << i));
+			}
+
+			list.remove_prefix((sep == std::string_view::npos)? list.size(): sep + 1);
+		}
+
+		return categories;
+	}
+}
+
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_SIM)
+	#define RECOIL_TRACY_CAT_SIM_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_SIM_COMPILED 0
+#endif
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_PATH)
+	#define RECOIL_TRACY_CAT_PATH_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_PATH_COMPILED 0
+#endif
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_LOS)
+	#define RECOIL_TRACY_CAT_LOS_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_LOS_COMPILED 0
+#endif
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_COB)
+	#define RECOIL_TRACY_CAT_COB_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_COB_COMPILED 0
+#endif
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_LUA)
+	#define RECOIL_TRACY_CAT_LUA_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_LUA_COMPILED 0
+#endif
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_NET)
+	#define RECOIL_TRACY_CAT_NET_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_NET_COMPILED 0
+#endif
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_DRAW)
+	#define RECOIL_TRACY_CAT_DRAW_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_DRAW_COMPILED 0
+#endif
+#if (RECOIL_TRACY_CATEGORIES & RECOIL_TRACY_CAT_MISC)
+	#define RECOIL_TRACY_CAT_MISC_COMPILED 1
+#else
+	#define RECOIL_TRACY_CAT_MISC_COMPILED 0
+#endif
+
+#define RECOIL_TRACY_CAT_SIM_COLOR tracy::Color::SteelBlue
+#define RECOIL_TRACY_CAT_PATH_COLOR tracy::Color::Orange
+#define RECOIL_TRACY_CAT_LOS_COLOR tracy::Color::SeaGreen
+#define RECOIL_TRACY_CAT_COB_COLOR tracy::Color::Khaki
+#define RECOIL_TRACY_CAT_LUA_COLOR tracy::Color::Orchid
+#define RECOIL_TRACY_CAT_NET_COLOR tracy::Color::Turquoise
+#define RECOIL_TRACY_CAT_DRAW_COLOR tracy::Color::LightSlateGray
+#define RECOIL_TRACY_CAT_MISC_COLOR tracy::Color::Gray
+
+#define RECOIL_TRACY_SELECT_0(...) do {} while(0)
+#define RECOIL_TRACY_SELECT_1(...) __VA_ARGS__
+#define RECOIL_TRACY_SELECT_I(compiled, ...) RECOIL_TRACY_SELECT_##compiled(__VA_ARGS__)
+#define RECOIL_TRACY_SELECT(compiled, ...) RECOIL_TRACY_SELECT_I(compiled, __VA_ARGS__)
+
+// NB: name must be a compile-time literal, or nullptr to use the function name
+#define RECOIL_TRACY_ZONE_N(cat, name) RECOIL_TRACY_SELECT(RECOIL_TRACY_CAT_##cat##_COMPILED, ZoneNamedNC(__recoilTracyZone, name, RECOIL_TRACY_CAT_##cat##_COLOR, Recoil::TracyZones::IsEnabled(RECOIL_TRACY_CAT_##cat)))
+#define RECOIL_TRACY_ZONE(cat) RECOIL_TRACY_ZONE_N(cat, nullptr)
+// renames the zone opened by RECOIL_TRACY_ZONE{_N} in the same scope, txt is copied
+#define RECOIL_TRACY_ZONE_NAME(cat, txt, size) RECOIL_TRACY_SELECT(RECOIL_TRACY_CAT_##cat##_COMPILED, ZoneNameV(__recoilTracyZone, txt, size))
+
+// for SCOPED_TIMER, whose zone category follows from the timer name
+#define RECOIL_TRACY_TIMER_ZONE(name, color) ZoneNamedNC(___tracy_scoped_zone, name, color, Recoil::TracyZones::IsEnabled(std::integral_constant<uint32_t, Recoil::TracyZones::CategoryOf(name)>::value))
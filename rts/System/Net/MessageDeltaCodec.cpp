@@ -0,0 +1,185 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MessageDeltaCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "RawPacket.h"
+#include "Net/Protocol/NetMessageTypes.h"
+
+namespace netcode {
+
+unsigned MessageDeltaCodec::GetSlot(uint8_t msgID)
+{
+	// all of these carry a uint16_t size, so the length of a decoded message
+	// can be checked against its own header
+	switch (msgID) {
+		case NETMSG_COMMAND          : return 0;
+		case NETMSG_SELECT           : return 1;
+		case NETMSG_AICOMMAND        : return 2;
+		case NETMSG_AICOMMAND_TRACKED: return 3;
+		case NETMSG_AICOMMANDS       : return 4;
+		case NETMSG_LUAMSG           : return 5;
+		default                      : break;
+	}
+
+	return NUM_SLOTS;
+}
+
+
+std::shared_ptr<const RawPacket> MessageDeltaCodec::Encode(std::shared_ptr<const RawPacket> pkt)
+{
+	const RawPacket& raw = *pkt;
+	const unsigned slot = (raw.length > 0)? GetSlot(raw.data[0]): NUM_SLOTS;
+
+	if (slot >= NUM_SLOTS)
+		return pkt;
+
+	std::vector<uint8_t>& base = sendBases[slot];
+	std::shared_ptr<const RawPacket> ret = pkt;
+
+	rawBytes += raw.length;
+
+	if (encoding && !base.empty() && raw.length <= 0xFFFF) {
+		const auto MatchLength = [&](unsigned i) {
+			unsigned n = 0;
+
+			while ((i + n) < raw.length && (i + n) < base.size() && n < MAX_RUN && raw.data[i + n] == base[i + n])
+				n++;
+
+			return n;
+		};
+
+		unsigned litStart = 0;
+
+		const auto AddLiterals = [&](unsigned end) {
+			while (litStart < end) {
+				const unsigned n = std::min(end - litStart, MAX_RUN);
+
+				scratch.push_back(0x80 | (n - 1));
+				scratch.insert(scratch.end(), raw.data + litStart, raw.data + litStart + n);
+				litStart += n;
+			}
+		};
+
+		scratch.clear();
+		scratch.resize(HEADER_SIZE, 0);
+
+		for (unsigned i = 0; i < raw.length && scratch.size() < raw.length; ) {
+			const unsigned n = MatchLength(i);
+
+			if (n < MIN_COPY) {
+				i += 1;
+				continue;
+			}
+
+			AddLiterals(i);
+			scratch.push_back(n - 1);
+
+			litStart = (i += n);
+		}
+
+		AddLiterals(raw.length);
+
+		if (scratch.size() < raw.length) {
+			const uint16_t encSize = scratch.size();
+			const uint16_t rawSize = raw.length;
+
+			scratch[0] = NETMSG_CONN_DELTA;
+			scratch[3] = raw.data[0];
+			std::memcpy(&scratch[1], &encSize, sizeof(encSize));
+			std::memcpy(&scratch[4], &rawSize, sizeof(rawSize));
+
+			ret.reset(new RawPacket(scratch.data(), scratch.size()));
+			numEncoded += 1;
+		}
+	}
+
+	encodedBytes += ret->length;
+
+	base.assign(raw.data, raw.data + raw.length);
+	return ret;
+}
+
+std::shared_ptr<const RawPacket> MessageDeltaCodec::Decode(const uint8_t* data, unsigned length)
+{
+	if (length < HEADER_SIZE || data[0] != NETMSG_CONN_DELTA)
+		return {};
+
+	const uint8_t msgID = data[3];
+	const unsigned slot = GetSlot(msgID);
+
+	if (slot >= NUM_SLOTS)
+		return {};
+
+	uint16_t rawSize = 0;
+	std::memcpy(&rawSize, &data[4], sizeof(rawSize));
+
+	if (rawSize == 0)
+		return {};
+
+	const std::vector<uint8_t>& base = recvBases[slot];
+
+	scratch.clear();
+	scratch.reserve(rawSize);
+
+	for (unsigned pos = HEADER_SIZE; pos < length; ) {
+		const uint8_t op = data[pos++];
+		const unsigned n = (op & 0x7F) + 1;
+
+		if ((scratch.size() + n) > rawSize)
+			return {};
+
+		if (op & 0x80) {
+			if ((pos + n) > length)
+				return {};
+
+			scratch.insert(scratch.end(), data + pos, data + pos + n);
+			pos += n;
+		} else {
+			const size_t offset = scratch.size();
+
+			if ((offset + n) > base.size())
+				return {};
+
+			scratch.insert(scratch.end(), base.begin() + offset, base.begin() + offset + n);
+		}
+	}
+
+	if (scratch.size() != rawSize || scratch[0] != msgID)
+		return {};
+
+	recvBases[slot] = scratch;
+	return std::shared_ptr<const RawPacket>(new RawPacket(scratch.data(), scratch.size()));
+}
+
+void MessageDeltaCodec::Observe(const uint8_t* data, unsigned length)
+{
+	if (length == 0)
+		return;
+
+	const unsigned slot = GetSlot(data[0]);
+
+	if (slot >= NUM_SLOTS)
+		return;
+
+	recvBases[slot].assign(data, data + length);
+}
+
+
+void MessageDeltaCodec::Reset()
+{
+	for (unsigned slot = 0; slot < NUM_SLOTS; slot++) {
+		sendBases[slot].clear();
+		recvBases[slot].clear();
+	}
+
+	numEncoded = 0;
+	rawBytes = 0;
+	encodedBytes = 0;
+
+	encoding = false;
+}
+
+} // namespace netcode
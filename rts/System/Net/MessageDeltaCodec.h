@@ -0,0 +1,88 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _MESSAGE_DELTA_CODEC_H
+#define _MESSAGE_DELTA_CODEC_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace netcode {
+
+class RawPacket;
+
+/// connection-level message ids, never seen above the connection itself
+enum {
+	/// uint8_t capabilities; first message on every connection
+	NETMSG_CONN_CAPS  = 0xFC,
+	/// uint16_t messageSize, uint8_t origMsgID, uint16_t origSize, std::vector<uint8_t> ops
+	NETMSG_CONN_DELTA = 0xFD,
+};
+
+enum {
+	CONN_CAPS_DELTA = 1,
+};
+
+/**
+ * @brief Delta encoding of the command stream against the previous message of each type
+ *
+ * Consecutive commands of one player are mostly identical byte-for-byte
+ * (same player, command id, options and often most parameters), so every
+ * eligible message is encoded as a list of ops against the last message of
+ * the same type sent on that connection: either copy a run of bytes from the
+ * same position in the base, or take a run of literal bytes. The result is
+ * only sent if it is actually smaller than the message.
+ *
+ * Both ends keep their base per type up to date with every eligible message,
+ * whether it went out encoded or not, which works because the connection is
+ * reliable and ordered.
+ */
+class MessageDeltaCodec
+{
+public:
+	static bool IsEligible(uint8_t msgID) { return (GetSlot(msgID) < NUM_SLOTS); }
+
+	/// returns <pkt> itself or its NETMSG_CONN_DELTA form, whichever is smaller
+	std::shared_ptr<const RawPacket> Encode(std::shared_ptr<const RawPacket> pkt);
+	/// expands a NETMSG_CONN_DELTA message, nullptr if it is malformed
+	std::shared_ptr<const RawPacket> Decode(const uint8_t* data, unsigned length);
+	/// remembers an eligible message that arrived as-is
+	void Observe(const uint8_t* data, unsigned length);
+
+	void SetEncoding(bool b) { encoding = b; }
+	void Reset();
+
+	bool IsEncoding() const { return encoding; }
+
+	uint64_t GetNumEncoded() const { return numEncoded; }
+	/// eligible bytes handed to Encode, and what actually went out for them
+	uint64_t GetRawBytes() const { return rawBytes; }
+	uint64_t GetEncodedBytes() const { return encodedBytes; }
+
+public:
+	static constexpr unsigned HEADER_SIZE = 1 + 2 + 1 + 2;
+
+private:
+	static constexpr unsigned NUM_SLOTS = 6;
+	static constexpr unsigned MAX_RUN = 128;
+	// a copy op shorter than this costs more than the literal bytes it saves
+	static constexpr unsigned MIN_COPY = 3;
+
+	static unsigned GetSlot(uint8_t msgID);
+
+	std::array<std::vector<uint8_t>, NUM_SLOTS> sendBases;
+	std::array<std::vector<uint8_t>, NUM_SLOTS> recvBases;
+
+	std::vector<uint8_t> scratch;
+
+	uint64_t numEncoded = 0;
+	uint64_t rawBytes = 0;
+	uint64_t encodedBytes = 0;
+
+	bool encoding = false;
+};
+
+} // namespace netcode
+
+#endif // _MESSAGE_DELTA_CODEC_H
@@ -0,0 +1,119 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PacketBufferPool.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <mutex>
+#include <vector>
+
+#include "System/Threading/SpringThreading.h"
+
+namespace netcode
+{
+namespace PacketBufferPool
+{
+	// classes are 64, 128, ..., 65536 bytes (the maximal packet size)
+	static constexpr uint32_t MIN_CLASS_SHIFT = 6;
+	static constexpr uint32_t NUM_CLASSES = 11;
+	// upper bound of idle bytes cached per class
+	static constexpr uint32_t MAX_CACHED_BYTES_PER_CLASS = 1 << 20;
+
+	struct SizeClass {
+		spring::spinlock lock;
+		std::vector<uint8_t*> freeList;
+	};
+
+	static std::array<SizeClass, NUM_CLASSES>& GetClasses() {
+		// intentionally leaked, packets may outlive static destruction order
+		static auto* classes = new std::array<SizeClass, NUM_CLASSES>();
+		return *classes;
+	}
+
+	static std::atomic<uint64_t> numHits = {0};
+	static std::atomic<uint64_t> numMisses = {0};
+	static std::atomic<uint64_t> numBytesCopied = {0};
+	static std::atomic<uint64_t> frameBytesCopied = {0};
+	static std::atomic<uint64_t> lastFrameBytesCopied = {0};
+
+
+	static uint32_t ClassIndex(uint32_t size) {
+		const uint32_t shift = std::bit_width(std::max(size, 1u << MIN_CLASS_SHIFT) - 1);
+		return shift - MIN_CLASS_SHIFT;
+	}
+
+	static uint32_t ClassSize(uint32_t idx) { return (1u << (idx + MIN_CLASS_SHIFT)); }
+
+
+	uint8_t* Acquire(uint32_t size) {
+		if (size == 0)
+			return nullptr;
+
+		const uint32_t idx = ClassIndex(size);
+
+		if (idx >= NUM_CLASSES) {
+			numMisses.fetch_add(1, std::memory_order_relaxed);
+			return new uint8_t[size];
+		}
+
+		SizeClass& sc = GetClasses()[idx];
+		{
+			std::lock_guard<spring::spinlock> lk(sc.lock);
+
+			if (!sc.freeList.empty()) {
+				uint8_t* buffer = sc.freeList.back();
+				sc.freeList.pop_back();
+				numHits.fetch_add(1, std::memory_order_relaxed);
+				return buffer;
+			}
+		}
+
+		numMisses.fetch_add(1, std::memory_order_relaxed);
+		return new uint8_t[ClassSize(idx)];
+	}
+
+	void Release(uint8_t* buffer, uint32_t size) {
+		if (buffer == nullptr)
+			return;
+
+		const uint32_t idx = ClassIndex(size);
+
+		if (idx >= NUM_CLASSES) {
+			delete[] buffer;
+			return;
+		}
+
+		SizeClass& sc = GetClasses()[idx];
+		{
+			std::lock_guard<spring::spinlock> lk(sc.lock);
+
+			if ((sc.freeList.size() + 1) * ClassSize(idx) <= MAX_CACHED_BYTES_PER_CLASS) {
+				sc.freeList.push_back(buffer);
+				return;
+			}
+		}
+
+		delete[] buffer;
+	}
+
+
+	void CountCopy(uint32_t numBytes) {
+		numBytesCopied.fetch_add(numBytes, std::memory_order_relaxed);
+		frameBytesCopied.fetch_add(numBytes, std::memory_order_relaxed);
+	}
+
+	void EndFrame() {
+		lastFrameBytesCopied.store(frameBytesCopied.exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	Stats GetStats() {
+		return {
+			numHits.load(std::memory_order_relaxed),
+			numMisses.load(std::memory_order_relaxed),
+			numBytesCopied.load(std::memory_order_relaxed),
+			lastFrameBytesCopied.load(std::memory_order_relaxed),
+		};
+	}
+}
+} // namespace netcode
@@ -0,0 +1,45 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PACKET_BUFFER_POOL_H
+#define PACKET_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace netcode
+{
+
+/**
+ * @brief Size-class slab pool for RawPacket payloads
+ *
+ * Buffers are recycled through per-class free-lists instead of going
+ * back to the heap, which removes most allocator traffic from the
+ * packet send/receive paths. Safe to use from any thread.
+ */
+namespace PacketBufferPool
+{
+	struct Stats {
+		uint64_t hits;
+		uint64_t misses;
+		uint64_t bytesCopied;
+		uint64_t lastFrameBytesCopied;
+
+		float HitRate() const { return ((hits + misses) > 0)? (hits * 1.0f / (hits + misses)): 0.0f; }
+	};
+
+	/// @return a buffer of at least <size> bytes; size 0 returns nullptr
+	uint8_t* Acquire(uint32_t size);
+	/// @param size the size originally requested from Acquire
+	void Release(uint8_t* buffer, uint32_t size);
+
+	/// accounts for a payload copy (e.g. into or out of a transport)
+	void CountCopy(uint32_t numBytes);
+	/// closes the current server frame for the per-frame copy counter
+	void EndFrame();
+
+	Stats GetStats();
+}
+
+} // namespace netcode
+
+#endif // PACKET_BUFFER_POOL_H
@@ -13,8 +13,9 @@ namespace netcode
 RawPacket::RawPacket(const uint8_t* const tdata, const uint32_t newLength): length(newLength)
 {
 	if (length > 0) {
-		data = new uint8_t[length];
+		data = PacketBufferPool::Acquire(length);
 		memcpy(data, tdata, length);
+		PacketBufferPool::CountCopy(length);
 	} else {
 		LOG_L(L_ERROR, "[%s] tried to pack a zero-length packet", __func__);
 		// TODO handle error
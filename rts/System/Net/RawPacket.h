@@ -5,12 +5,14 @@
 
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <utility>
 
 #include <string>
 #include <vector>
 
+#include "PacketBufferPool.h"
 #include "System/Misc/NonCopyable.h"
 #include "System/SafeVector.h"
 
@@ -40,13 +42,26 @@ public:
 		if (length == 0)
 			return;
 
-		data = new uint8_t[length];
+		data = PacketBufferPool::Acquire(length);
 	}
 
 	RawPacket(const uint32_t length, uint8_t msgID): RawPacket(length) {
 		*this << (id = msgID);
 	}
 
+	/**
+	 * @brief take ownership of a malloc'ed buffer without copying it
+	 * Used for payloads handed over by C transports (e.g. DCF), which
+	 * would otherwise be copied and freed right away.
+	 */
+	static RawPacket Adopt(uint8_t* mallocBuffer, const uint32_t length) {
+		RawPacket p;
+		p.data = mallocBuffer;
+		p.length = length;
+		p.malloced = true;
+		return p;
+	}
+
 	RawPacket(const RawPacket&  p) = delete;
 	RawPacket(      RawPacket&& p) { *this = std::move(p); }
 
@@ -68,6 +83,9 @@ public:
 		length = p.length;
 		p.length = 0;
 
+		malloced = p.malloced;
+		p.malloced = false;
+
 		return *this;
 	}
 
@@ -117,14 +135,22 @@ public:
 		if (length == 0)
 			return;
 
-		delete[] data;
+		if (malloced) {
+			free(data);
+		} else {
+			PacketBufferPool::Release(data, length);
+		}
+
 		data = nullptr;
+		malloced = false;
 
 		length = 0;
 	}
 
 public:
 	uint8_t id = 0;
+	/// true if data came from Adopt() and must be free'd instead of pooled
+	bool malloced = false;
 	uint8_t* data = nullptr;
 
 	uint32_t pos = 0;
@@ -18,6 +18,7 @@
 
 #ifndef UNIT_TEST
 CONFIG(bool, UDPConnectionLogDebugMessages).defaultValue(false);
+CONFIG(bool, NetworkDeltaCompression).defaultValue(true).description("Delta-encode commands against the previous one on UDP links, if the other end agrees.");
 #endif
 
 
@@ -265,6 +266,9 @@ void UDPConnection::Init()
 	// make sure protocoldef is initialized
 	CBaseNetProtocol::Get();
 
+	ProtocolDef::GetInstance()->AddType(NETMSG_CONN_CAPS, 2);
+	ProtocolDef::GetInstance()->AddType(NETMSG_CONN_DELTA, -2);
+
 	lastNakTime = spring_gettime();
 	lastUnackResentTime = spring_gettime();
 	lastPacketSendTime = spring_gettime();
@@ -314,10 +318,21 @@ void UDPConnection::Init()
 	closed = false;
 	resend = false;
 
+	logMessages = false;
+	deltaCompression = true;
+
 	#ifndef UNIT_TEST
 	logMessages = configHandler->GetBool("UDPConnectionLogDebugMessages");
+	deltaCompression = configHandler->GetBool("NetworkDeltaCompression");
 	#endif
 
+	// tell the other end what we can decode; it goes out with the first
+	// flush after Unmute, ahead of anything the owner sends
+	const std::uint8_t caps[2] = {NETMSG_CONN_CAPS, std::uint8_t(deltaCompression? CONN_CAPS_DELTA: 0)};
+
+	deltaCodec.Reset();
+	outgoingData.emplace_back(new RawPacket(caps, sizeof(caps)));
+
 	netLossFactor = globalConfig.networkLossFactor;
 	lastMidChunk = -1;
 #if	NETWORK_TEST
@@ -349,7 +364,7 @@ UDPConnection::~UDPConnection()
 void UDPConnection::SendData(std::shared_ptr<const RawPacket> pkt)
 {
 	assert(pkt->length > 0);
-	outgoingData.push_back(pkt);
+	outgoingData.push_back(deltaCodec.Encode(std::move(pkt)));
 }
 
 std::shared_ptr<const RawPacket> UDPConnection::Peek(unsigned ahead) const
@@ -644,8 +659,14 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 			// this returns false for zero/invalid pktLength
 			if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength)) {
-				msgQueue.emplace_back(new RawPacket(bufp, pktLength));
-				std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
+				pos += pktLength;
+
+				std::shared_ptr<const RawPacket> msgPacket = ReceiveMessage(bufp, pktLength);
+
+				if (msgPacket == nullptr)
+					continue;
+
+				msgQueue.push_back(msgPacket);
 
 				#ifdef ENABLE_DEBUG_STATS
 				// server sends both of these, clients send only keyframe messages
@@ -672,7 +693,6 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 				}
 				#endif
 
-				pos += pktLength;
 				numPings += (msgPacket->data[0] == NETMSG_PING); // incoming
 			} else {
 				if (pktLength >= 0) {
@@ -693,6 +713,32 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 	UpdateWaitingPackets();
 }
 
+std::shared_ptr<const RawPacket> UDPConnection::ReceiveMessage(const unsigned char* data, unsigned length)
+{
+	switch (data[0]) {
+		case NETMSG_CONN_CAPS: {
+			// only start encoding once the other end said it can decode
+			deltaCodec.SetEncoding(deltaCompression && (data[1] & CONN_CAPS_DELTA) != 0);
+			return {};
+		} break;
+		case NETMSG_CONN_DELTA: {
+			std::shared_ptr<const RawPacket> msg = deltaCodec.Decode(data, length);
+
+			if (msg == nullptr || !ProtocolDef::GetInstance()->IsValidPacket(msg->data, msg->length)) {
+				LOG_L(L_ERROR, "\t[%s] discarding undecodable delta message: ID %d, LEN %u", __func__, (int)data[3], length);
+				return {};
+			}
+
+			return msg;
+		} break;
+		default: {
+		} break;
+	}
+
+	deltaCodec.Observe(data, length);
+	return std::shared_ptr<const RawPacket>(new RawPacket(data, length));
+}
+
 void UDPConnection::Flush(const bool forced)
 {
 	if (muted)
@@ -809,6 +855,7 @@ std::string UDPConnection::Statistics() const
 		"\t{%.3fx, %.3fx} relative protocol overhead {up, down}\n",
 		"\t%u incoming chunks dropped, %u outgoing chunks resent\n",
 		"\t%u incoming chunks processed\n",
+		"\t%lu commands delta-encoded, %lu bytes sent for %lu raw (%.3fx)\n",
 	};
 
 	std::string msg = "[UDPConnection::Statistics]\n";
@@ -817,6 +864,12 @@ std::string UDPConnection::Statistics() const
 	msg += spring::format(fmts[2], spring::SafeDivide(sentOverhead * 1.0f, dataSent * 1.0f), spring::SafeDivide(recvOverhead * 1.0f, dataRecv * 1.0f));
 	msg += spring::format(fmts[3], droppedChunks, resentChunks);
 	msg += spring::format(fmts[4], lastInOrder + 1);
+	msg += spring::format(fmts[5],
+		(unsigned long) deltaCodec.GetNumEncoded(),
+		(unsigned long) deltaCodec.GetEncodedBytes(),
+		(unsigned long) deltaCodec.GetRawBytes(),
+		spring::SafeDivide(deltaCodec.GetEncodedBytes() * 1.0f, deltaCodec.GetRawBytes() * 1.0f)
+	);
 	return msg;
 }
 
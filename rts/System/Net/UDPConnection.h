@@ -8,6 +8,7 @@
 #include <deque>
 
 #include "Connection.h"
+#include "MessageDeltaCodec.h"
 #include "System/Misc/SpringTime.h"
 #include "System/UnorderedSet.hpp"
 
@@ -155,6 +156,9 @@ private:
 	void UpdateWaitingPackets();
 	void UpdateResendRequests();
 
+	/// strips connection-level messages, returns what should go to msgQueue (if anything)
+	std::shared_ptr<const RawPacket> ReceiveMessage(const unsigned char* data, unsigned length);
+
 private:
 	spring_time lastChunkCreatedTime;
 	spring_time lastPacketSendTime;
@@ -179,6 +183,7 @@ private:
 	bool resend;
 	bool sharedSocket;
 	bool logMessages;
+	bool deltaCompression;
 
 	int netLossFactor;
 	int reconnectTime;
@@ -224,6 +229,8 @@ private:
 
 	RawPacket fragmentBuffer;
 
+	MessageDeltaCodec deltaCodec;
+
 	// Traffic statistics and stuff
 	#ifdef ENABLE_DEBUG_STATS
 	float sumDeltaFramePacketRecvTime;
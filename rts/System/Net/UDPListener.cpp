@@ -9,9 +9,17 @@
 
 #include <memory>
 #include <asio.hpp>
+#include <array>
+#include <chrono>
 #include <cinttypes>
+#include <functional>
 #include <queue>
 
+#if defined(SO_REUSEPORT)
+	#include <poll.h>
+	#include <sys/socket.h>
+#endif
+
 #include "ProtocolDef.h"
 #include "UDPConnection.h"
 #include "Socket.h"
@@ -23,10 +31,17 @@ namespace netcode
 {
 using namespace asio;
 
-UDPListener::UDPListener(int port, const std::string& ip): acceptNewConnections(false)
+UDPListener::UDPListener(int port, const std::string& ip, int numSockets): acceptNewConnections(false)
 {
+	#if !defined(SO_REUSEPORT)
+	if (numSockets > 1)
+		LOG_L(L_WARNING, "[%s] SO_REUSEPORT is not supported on this platform, using a single socket", __func__);
+
+	numSockets = 1;
+	#endif
+
 	// resets socket on any exception
-	const std::string err = TryBindSocket(port, socket, ip);
+	const std::string err = TryBindSocket(port, socket, ip, numSockets > 1);
 
 	if (!err.empty())
 		throw network_error(err);
@@ -34,17 +49,38 @@ UDPListener::UDPListener(int port, const std::string& ip): acceptNewConnections(
 	socket->non_blocking(true);
 	SetAcceptingConnections(true);
 
-	LOG("[%s] successfully bound socket on port %i", __func__, socket->local_endpoint().port());
+	// the others take the port the first one got (which is random for port 0)
+	for (int i = 1; i < numSockets; i++) {
+		std::shared_ptr<asio::ip::udp::socket> extraSocket;
+
+		if (!TryBindSocket(socket->local_endpoint().port(), extraSocket, ip, true).empty())
+			break;
+
+		extraSocket->non_blocking(true);
+		extraSockets.push_back(extraSocket);
+	}
+
+	for (size_t i = 0, n = GetNumSockets(); n > 1 && i < n; i++) {
+		receiveThreads.emplace_back(&UDPListener::ReceiveThread, this, i);
+	}
+
+	LOG("[%s] successfully bound %u socket(s) on port %i", __func__, unsigned(GetNumSockets()), socket->local_endpoint().port());
 }
 
 UDPListener::~UDPListener() {
+	stopReceiving.store(true);
+
+	for (std::thread& t: receiveThreads) {
+		t.join();
+	}
+
 	for (const auto& p: dropMap) {
 		LOG("[%s] dropped %lu packets from unknown IP %s", __func__, (unsigned long) p.second, (p.first).c_str());
 	}
 }
 
 
-std::string UDPListener::TryBindSocket(int port, std::shared_ptr<asio::ip::udp::socket>& sock, const std::string& ip)
+std::string UDPListener::TryBindSocket(int port, std::shared_ptr<asio::ip::udp::socket>& sock, const std::string& ip, bool reusePort)
 {
 	std::string errorMsg;
 
@@ -85,6 +121,11 @@ std::string UDPListener::TryBindSocket(int port, std::shared_ptr<asio::ip::udp::
 				throw std::runtime_error("[UDPListener] failed to open IPv4 socket: " + err.message());
 		}
 
+		#if defined(SO_REUSEPORT)
+		if (reusePort)
+			sock->set_option(asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true));
+		#endif
+
 		sock->bind(endpoint);
 
 		LOG(
@@ -106,98 +147,221 @@ std::string UDPListener::TryBindSocket(int port, std::shared_ptr<asio::ip::udp::
 }
 
 void UDPListener::Update(int loopSleepTime) {
-	if (loopSleepTime == 0)
-		netservice.poll();
-	else {
-		fd_set rset;
-		FD_ZERO(&rset);
-		FD_SET(socket->native_handle(), &rset);
-		timeval to = {
-			(loopSleepTime / 1000),       // long tv_sec
-			(loopSleepTime % 1000) * 1000 // long tv_usec
-		};
-		::select(1, &rset, nullptr, nullptr, &to);
-	}
+	if (!receiveThreads.empty()) {
+		UpdateReceiveThreads(loopSleepTime);
+	} else {
+		if (loopSleepTime == 0)
+			netservice.poll();
+		else {
+			fd_set rset;
+			FD_ZERO(&rset);
+			FD_SET(socket->native_handle(), &rset);
+			timeval to = {
+				(loopSleepTime / 1000),       // long tv_sec
+				(loopSleepTime % 1000) * 1000 // long tv_usec
+			};
+			::select(1, &rset, nullptr, nullptr, &to);
+		}
 
-	size_t bytesAvailable = 0;
+		size_t bytesAvailable = 0;
 
-	while ((bytesAvailable = socket->available()) > 0) {
-		recvBuffer.clear();
-		recvBuffer.resize(bytesAvailable, 0);
+		while ((bytesAvailable = socket->available()) > 0) {
+			recvBuffer.clear();
+			recvBuffer.resize(bytesAvailable, 0);
 
-		ip::udp::endpoint udpEndPoint;
-		asio::ip::udp::socket::message_flags msgFlags = 0;
-		asio::error_code err;
+			ip::udp::endpoint udpEndPoint;
+			asio::ip::udp::socket::message_flags msgFlags = 0;
+			asio::error_code err;
 
-		const size_t bytesReceived = socket->receive_from(asio::buffer(recvBuffer), udpEndPoint, msgFlags, err);
+			const size_t bytesReceived = socket->receive_from(asio::buffer(recvBuffer), udpEndPoint, msgFlags, err);
 
-		const auto ci = connMap.find(udpEndPoint);
+			const auto ci = connMap.find(udpEndPoint);
 
-		// known connection but expired
-		if (ci != connMap.end() && ci->second.expired())
-			continue;
+			// known connection but expired
+			if (ci != connMap.end() && ci->second.expired())
+				continue;
 
-		if (CheckErrorCode(err))
-			break;
+			if (CheckErrorCode(err))
+				break;
 
-		if (bytesReceived < Packet::headerSize)
+			ProcessPacket(udpEndPoint, socket, recvBuffer.data(), bytesReceived);
+		}
+	}
+
+	for (auto i = connMap.cbegin(); i != connMap.cend(); ) {
+		if (i->second.expired()) {
+			LOG_L(L_DEBUG, "[UDPListener::%s] connection closed: [%s]:%i", __func__, i->first.address().to_string().c_str(), i->first.port());
+			i = connMap.erase(i);
 			continue;
+		}
+		i->second.lock()->Update();
+		++i;
+	}
+}
+
+void UDPListener::ProcessPacket(const asio::ip::udp::endpoint& udpEndPoint, const std::shared_ptr<asio::ip::udp::socket>& recvSocket, const std::uint8_t* bytes, size_t bytesReceived)
+{
+	const auto ci = connMap.find(udpEndPoint);
 
-		Packet data(&recvBuffer[0], bytesReceived);
+	// known connection but expired
+	if (ci != connMap.end() && ci->second.expired())
+		return;
 
-		if (ci != connMap.end()) {
-			ci->second.lock()->ProcessRawPacket(data);
-			continue;
+	if (bytesReceived < Packet::headerSize)
+		return;
+
+	Packet data(bytes, bytesReceived);
+
+	if (ci != connMap.end()) {
+		ci->second.lock()->ProcessRawPacket(data);
+		return;
+	}
+
+
+	// unknown connection but still have the packet, maybe a new client wants to connect from sender's address
+	if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
+		if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
+			// answer through the socket the kernel routes this client to
+			std::shared_ptr<UDPConnection> incoming(new UDPConnection(recvSocket, udpEndPoint));
+			waiting.push(incoming);
+			connMap[udpEndPoint] = incoming;
+			incoming->ProcessRawPacket(data);
 		}
 
+		return;
+	}
 
-		// unknown connection but still have the packet, maybe a new client wants to connect from sender's address
-		if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
-			if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
-				std::shared_ptr<UDPConnection> incoming(new UDPConnection(socket, udpEndPoint));
-				waiting.push(incoming);
-				connMap[udpEndPoint] = incoming;
-				incoming->ProcessRawPacket(data);
-			}
 
+	const asio::ip::address& senderAddr = udpEndPoint.address();
+	const std::string& senderIP = senderAddr.to_string();
+
+	if (dropMap.find(senderIP) == dropMap.end()) {
+		LOG_L(L_DEBUG, "[UDPListener::%s] dropping packet from unknown IP: [%s]:%i", __func__, senderIP.c_str(), udpEndPoint.port());
+		dropMap[senderIP] = 0;
+	} else {
+		dropMap[senderIP] += 1;
+	}
+
+#ifdef DEBUG
+	std::string conns;
+	for (auto it = connMap.cbegin(); it != connMap.cend(); ++it) {
+		conns += spring::format(" [%s]:%i;", it->first.address().to_string().c_str(),it->first.port());
+	}
+	LOG_L(L_DEBUG, "[UDPListener::%s] open connections: %s", __func__, conns.c_str());
+#endif
+}
+
+
+void UDPListener::UpdateReceiveThreads(int loopSleepTime)
+{
+	{
+		std::unique_lock<std::mutex> lock(receiveMutex);
+
+		if (loopSleepTime > 0)
+			receiveCond.wait_for(lock, std::chrono::milliseconds(loopSleepTime), [&]() { return (!receiveQueue.packets.empty()); });
+
+		std::swap(receiveQueue, processQueue);
+	}
+
+	// per socket (hence per client) the packets are still in the order they arrived
+	for (const ReceivedPacket& rp: processQueue.packets) {
+		ProcessPacket(rp.sender, GetSocket(rp.socketIdx), &processQueue.bytes[rp.offset], rp.size);
+	}
+
+	processQueue.bytes.clear();
+	processQueue.packets.clear();
+}
+
+void UDPListener::ReceiveThread(size_t socketIdx)
+{
+#if defined(SO_REUSEPORT)
+	constexpr size_t MAX_BATCH_SIZE = 32;
+	constexpr size_t MAX_DATAGRAM_SIZE = 65536;
+
+	const int fd = GetSocket(socketIdx)->native_handle();
+
+	std::vector<std::uint8_t> buffers(MAX_BATCH_SIZE * MAX_DATAGRAM_SIZE);
+	std::array<ip::udp::endpoint, MAX_BATCH_SIZE> senders;
+	std::array<size_t, MAX_BATCH_SIZE> sizes;
+
+	#if defined(__linux__)
+	std::array<mmsghdr, MAX_BATCH_SIZE> msgs;
+	std::array<iovec, MAX_BATCH_SIZE> iovecs;
+	#endif
+
+	while (!stopReceiving.load()) {
+		pollfd pfd = {fd, POLLIN, 0};
+
+		// wake up now and then to see if the listener is going away
+		if (::poll(&pfd, 1, 100) <= 0)
 			continue;
-		}
 
+		size_t numReceived = 0;
+
+		#if defined(__linux__)
+		// everything that is queued up in one call
+		for (size_t i = 0; i < MAX_BATCH_SIZE; i++) {
+			iovecs[i] = {&buffers[i * MAX_DATAGRAM_SIZE], MAX_DATAGRAM_SIZE};
+			msgs[i] = {};
+			msgs[i].msg_hdr.msg_name = senders[i].data();
+			msgs[i].msg_hdr.msg_namelen = senders[i].capacity();
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
 
-		const asio::ip::address& senderAddr = udpEndPoint.address();
-		const std::string& senderIP = senderAddr.to_string();
+		const int ret = ::recvmmsg(fd, msgs.data(), MAX_BATCH_SIZE, MSG_DONTWAIT, nullptr);
 
-		if (dropMap.find(senderIP) == dropMap.end()) {
-			LOG_L(L_DEBUG, "[UDPListener::%s] dropping packet from unknown IP: [%s]:%i", __func__, senderIP.c_str(), udpEndPoint.port());
-			dropMap[senderIP] = 0;
-		} else {
-			dropMap[senderIP] += 1;
+		for (int i = 0; i < ret; i++) {
+			senders[i].resize(msgs[i].msg_hdr.msg_namelen);
+			sizes[i] = msgs[i].msg_len;
 		}
 
-	#ifdef DEBUG
-		std::string conns;
-		for (auto it = connMap.cbegin(); it != connMap.cend(); ++it) {
-			conns += spring::format(" [%s]:%i;", it->first.address().to_string().c_str(),it->first.port());
+		numReceived = std::max(ret, 0);
+		#else
+		for (; numReceived < MAX_BATCH_SIZE; numReceived++) {
+			socklen_t senderSize = senders[numReceived].capacity();
+			const ssize_t ret = ::recvfrom(fd, &buffers[numReceived * MAX_DATAGRAM_SIZE], MAX_DATAGRAM_SIZE, MSG_DONTWAIT, senders[numReceived].data(), &senderSize);
+
+			if (ret < 0)
+				break;
+
+			senders[numReceived].resize(senderSize);
+			sizes[numReceived] = ret;
 		}
-		LOG_L(L_DEBUG, "[UDPListener::%s] open connections: %s", __func__, conns.c_str());
-	#endif
-	}
+		#endif
 
-	for (auto i = connMap.cbegin(); i != connMap.cend(); ) {
-		if (i->second.expired()) {
-			LOG_L(L_DEBUG, "[UDPListener::%s] connection closed: [%s]:%i", __func__, i->first.address().to_string().c_str(), i->first.port());
-			i = connMap.erase(i);
+		if (numReceived == 0)
 			continue;
+
+		{
+			std::lock_guard<std::mutex> lock(receiveMutex);
+
+			for (size_t i = 0; i < numReceived; i++) {
+				receiveQueue.packets.push_back({senders[i], socketIdx, receiveQueue.bytes.size(), sizes[i]});
+				receiveQueue.bytes.insert(receiveQueue.bytes.end(), &buffers[i * MAX_DATAGRAM_SIZE], &buffers[i * MAX_DATAGRAM_SIZE] + sizes[i]);
+			}
 		}
-		i->second.lock()->Update();
-		++i;
+
+		receiveCond.notify_one();
 	}
+#endif
+}
+
+
+const std::shared_ptr<asio::ip::udp::socket>& UDPListener::GetEndpointSocket(const asio::ip::udp::endpoint& endpoint) const
+{
+	if (extraSockets.empty())
+		return socket;
+
+	const size_t hash = std::hash<std::string>()(endpoint.address().to_string()) ^ endpoint.port();
+	return (GetSocket(hash % GetNumSockets()));
 }
 
 
 std::shared_ptr<UDPConnection> UDPListener::SpawnConnection(const std::string& ip, const unsigned port)
 {
-	std::shared_ptr<UDPConnection> newConn(new UDPConnection(socket, ip::udp::endpoint(WrapIP(ip), port)));
+	const ip::udp::endpoint endpoint(WrapIP(ip), port);
+	std::shared_ptr<UDPConnection> newConn(new UDPConnection(GetEndpointSocket(endpoint), endpoint));
 	connMap[newConn->GetEndpoint()] = newConn;
 	return newConn;
 }
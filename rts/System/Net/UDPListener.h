@@ -4,11 +4,16 @@
 #define _UDP_LISTENER_H
 
 #include "System/Misc/NonCopyable.h"
+#include <atomic>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <asio/ip/udp.hpp>
 #include <map>
 #include <queue>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace netcode
 {
@@ -20,6 +25,12 @@ class UDPConnection;
  * one client.
  * You can Listen for new connections, initiate new ones and send/recieve data
  * to/from them.
+ *
+ * With more than one socket (where SO_REUSEPORT is available) all of them are
+ * bound to the same port and the kernel spreads the clients over them by source
+ * address. Each socket then has its own thread which receives in batches and
+ * queues the datagrams for Update(), which still dispatches them to the (not
+ * thread-safe) connections; replies go out through the socket a client uses.
  */
 class UDPListener : spring::noncopyable
 {
@@ -28,8 +39,10 @@ public:
 	 * @brief Open a socket and make it ready for listening
 	 * @param  port the port to bind the socket to
 	 * @param  ip local IP to bind to, or "" for any
+	 * @param  numSockets sockets (and receive threads) sharing the port,
+	 *         1 receives on the calling thread
 	 */
-	UDPListener(int port, const std::string& ip = "");
+	UDPListener(int port, const std::string& ip = "", int numSockets = 1);
 
 	/**
 	 * @brief close the socket and DELETE all connections
@@ -45,8 +58,9 @@ public:
 	 * @param  ip local IP (v4 or v6) to bind to,
 	 *         the default value "" results in the v6 any address "::",
 	 *         or the v4 equivalent "0.0.0.0", if v6 is no supported
+	 * @param  reusePort set SO_REUSEPORT before binding
 	 */
-	static std::string TryBindSocket(int port, std::shared_ptr<asio::ip::udp::socket>& sock, const std::string& ip = "");
+	static std::string TryBindSocket(int port, std::shared_ptr<asio::ip::udp::socket>& sock, const std::string& ip = "", bool reusePort = false);
 
 	/**
 	 * @brief Run this from time to time
@@ -77,6 +91,25 @@ public:
 	void UpdateConnections(); // Updates connections when the endpoint has been reconnected
 
 	auto& GetSocket() { return socket; }
+	size_t GetNumSockets() const { return (1 + extraSockets.size()); }
+private:
+	struct ReceivedPacket {
+		asio::ip::udp::endpoint sender;
+		size_t socketIdx;
+		size_t offset;
+		size_t size;
+	};
+	struct ReceiveQueue {
+		std::vector<std::uint8_t> bytes;
+		std::vector<ReceivedPacket> packets;
+	};
+
+	void ProcessPacket(const asio::ip::udp::endpoint& sender, const std::shared_ptr<asio::ip::udp::socket>& recvSocket, const std::uint8_t* data, size_t size);
+	void ReceiveThread(size_t socketIdx);
+	void UpdateReceiveThreads(int loopSleepTime);
+
+	const std::shared_ptr<asio::ip::udp::socket>& GetSocket(size_t socketIdx) const { return ((socketIdx == 0)? socket: extraSockets[socketIdx - 1]); }
+	const std::shared_ptr<asio::ip::udp::socket>& GetEndpointSocket(const asio::ip::udp::endpoint& endpoint) const;
 private:
 	/**
 	 * @brief Do we accept packets from unknown sources?
@@ -94,6 +127,18 @@ private:
 	std::map< std::string, size_t> dropMap;
 
 	std::queue< std::shared_ptr<UDPConnection> > waiting;
+
+	/// further sockets bound to the same port, each drained by a receive thread
+	std::vector< std::shared_ptr<asio::ip::udp::socket> > extraSockets;
+	std::vector<std::thread> receiveThreads;
+
+	/// filled by the receive threads, swapped into processQueue by Update
+	ReceiveQueue receiveQueue;
+	ReceiveQueue processQueue;
+
+	std::mutex receiveMutex;
+	std::condition_variable receiveCond;
+	std::atomic<bool> stopReceiving = {false};
 };
 
 }
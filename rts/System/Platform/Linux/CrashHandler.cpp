@@ -994,6 +994,10 @@ namespace CrashHandler
 		// print stacktrace
 		PrepareStacktrace();
 		HaltedStacktrace(siginfo, uctx, signame);
+		#ifndef DEDICATED
+		// where the threads stalled before the crash, if they did
+		Watchdog::LogHangSamples();
+		#endif
 		CleanupStacktrace();
 
 		if (signal != SIGIO) {
@@ -210,6 +210,31 @@ namespace Threading {
 		return ( 0x80000000 >> std::countl_zero(policy) );
 	}
 
+	uint32_t GetCacheGroupMask(uint32_t affinityMask) {
+		cpu_topology::ProcessorCaches pc = springproc::CPUID::GetInstance().GetProcessorCaches();
+
+		// logical processors sharing the (largest) L3 with the first group in affinityMask, e.g. one Ryzen CCD
+		auto cache = std::ranges::find_if(pc.groupCaches
+			, [affinityMask](const auto& gc) -> bool { return !!(affinityMask & gc.groupMask); });
+
+		return ( (cache != pc.groupCaches.end()) ? cache->groupMask : 0xffffffff );
+	}
+
+	uint32_t GetBackgroundThreadMask(uint32_t avoidMask) {
+		cpu_topology::ProcessorMasks pm = springproc::CPUID::GetInstance().GetAvailableProcessorAffinityMask();
+
+		const uint32_t availMask = (pm.performanceCoreMask | pm.efficiencyCoreMask) & GetAvailableCoresMask();
+
+		// Background work (loading, streaming, ...) is a good fit for the low-power cores the sim workers avoid;
+		// without those use whatever is left over by the main and worker threads, e.g. SMT siblings or other CCDs.
+		if ((pm.efficiencyCoreMask & availMask) != 0)
+			return (pm.efficiencyCoreMask & availMask);
+		if ((availMask & ~avoidMask) != 0)
+			return (availMask & ~avoidMask);
+
+		return availMask;
+	}
+
 	std::once_flag optimalThreadCountLogFlag;
 
 	uint32_t GetOptimalThreadCount() {
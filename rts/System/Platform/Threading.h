@@ -129,6 +129,8 @@ namespace Threading {
 
 	uint32_t GetSystemAffinityMask(int forThreadCount = std::numeric_limits<int>::max());
 	uint32_t GetPreferredMainThreadMask(uint32_t affinityMask);
+	uint32_t GetCacheGroupMask(uint32_t affinityMask);
+	uint32_t GetBackgroundThreadMask(uint32_t avoidMask);
 	uint32_t GetOptimalThreadCount();
 
 	/**
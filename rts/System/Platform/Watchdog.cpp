@@ -7,6 +7,7 @@
 #endif
 
 #include <algorithm>
+#include <array>
 #include <functional>
 
 #include "Game/GameVersion.h"
@@ -18,11 +19,14 @@
 #include "System/Platform/Misc.h"
 #include "System/Platform/Threading.h"
 #include "System/StringHash.h"
+#include "System/TimeProfiler.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/UnorderedMap.hpp"
 
 CONFIG(int, HangTimeout).defaultValue(60).minimumValue(-1).maximumValue(600)
 		.description("Number of seconds that, if spent in the same code segment, indicate a hang; -1 to disable.");
+CONFIG(int, HangSampleThreshold).defaultValue(0).minimumValue(0).maximumValue(10000)
+		.description("Milliseconds without a heartbeat after which the watchdog samples the stalled thread's current profiler scope, which is logged when the thread recovers or hangs; 0 to disable.");
 
 namespace Watchdog
 {
@@ -37,6 +41,7 @@ namespace Watchdog
 
 		void ResetThreadInfo() {
 			timer = spring_notime;
+			scope = nullptr;
 
 			thread = {};
 			threadid = 0;
@@ -55,7 +60,10 @@ namespace Watchdog
 			#endif
 		}
 
-		spring_time timer;
+		// heartbeat, written by the thread and read by the watchdog
+		std::atomic<spring_time> timer;
+		// CTimeProfiler::GetThreadScope of the registered thread
+		std::atomic<const std::atomic<unsigned>*> scope;
 
 		std::atomic<Threading::NativeThreadHandle> thread;
 		std::atomic<Threading::NativeThreadId> threadid;
@@ -85,6 +93,90 @@ namespace Watchdog
 	static std::atomic<bool> hangDetectorThreadInterrupted = {false};
 
 	static spring_time hangTimeout = spring_msecs(0);
+	static spring_time sampleThreshold = spring_msecs(0);
+
+
+	struct HangSample {
+		std::atomic<spring_time> time;
+		std::atomic<unsigned> scope;
+		std::atomic<unsigned> stallTime;
+		std::atomic<unsigned> threadNum;
+	};
+
+	// written only by the watchdog thread; readers (the crash handler) may
+	// see an entry that is being overwritten, which is fine for a report
+	static std::array<HangSample, 256> hangSamples;
+	static std::atomic<unsigned> numHangSamples = {0};
+
+	// per thread, start of the stall being sampled
+	static spring_time stallStartTimes[WDT_COUNT];
+
+
+	static void AddHangSample(unsigned threadNum, unsigned scope, spring_time curTime, spring_time stallTime) {
+		const unsigned n = numHangSamples.load(std::memory_order_relaxed);
+		HangSample& sample = hangSamples[n % hangSamples.size()];
+
+		sample.time.store(curTime, std::memory_order_relaxed);
+		sample.scope.store(scope, std::memory_order_relaxed);
+		sample.stallTime.store(stallTime.toMilliSecsi(), std::memory_order_relaxed);
+		sample.threadNum.store(threadNum, std::memory_order_relaxed);
+
+		numHangSamples.store(n + 1, std::memory_order_release);
+	}
+
+	static void LogHangSamples(unsigned threadNum, spring_time minTime) {
+		const unsigned n = numHangSamples.load(std::memory_order_acquire);
+
+		for (unsigned i = n - std::min<unsigned>(n, hangSamples.size()); i < n; i++) {
+			const HangSample& sample = hangSamples[i % hangSamples.size()];
+			const spring_time time = sample.time.load(std::memory_order_relaxed);
+			const unsigned num = sample.threadNum.load(std::memory_order_relaxed);
+
+			if (time < minTime || (threadNum < WDT_COUNT && num != threadNum))
+				continue;
+
+			const unsigned scope = sample.scope.load(std::memory_order_relaxed);
+			const std::string name = (scope == 0)? "<none>": CTimeProfiler::GetTimerName(scope);
+
+			LOG_L(L_WARNING, "\t[%s] +%ums in \"%s\" (0x%08x) at %.3fs",
+				threadNames[std::min<unsigned>(num, WDT_COUNT - 1)],
+				sample.stallTime.load(std::memory_order_relaxed),
+				name.empty()? "???": name.c_str(),
+				scope,
+				time.toSecsf()
+			);
+		}
+	}
+
+	// records the current scope of every thread that missed its heartbeat,
+	// and reports each stall once the thread beats again
+	static void SampleStalledThreads(const spring_time curtime) {
+		for (unsigned int i = 0; i < WDT_COUNT; ++i) {
+			const WatchDogThreadInfo* threadInfo = registeredThreads[i];
+			const spring_time curwdt = threadInfo->timer;
+			const std::atomic<unsigned>* scope = threadInfo->scope;
+
+			const bool stalled = threadSlots[i].active && spring_istime(curwdt) && scope != nullptr && (curtime - curwdt) > sampleThreshold;
+
+			// the previous stall ended with a new heartbeat (or its thread is gone)
+			if (spring_istime(stallStartTimes[i]) && (!stalled || curwdt > stallStartTimes[i])) {
+				const spring_time stallEnd = spring_istime(curwdt)? curwdt: curtime;
+
+				LOG_L(L_WARNING, "[Watchdog] %s-thread missed its heartbeat for %ims, sampled scopes:", threadNames[i], int((stallEnd - stallStartTimes[i]).toMilliSecsi()));
+				LogHangSamples(i, stallStartTimes[i]);
+
+				stallStartTimes[i] = spring_notime;
+			}
+
+			if (!stalled)
+				continue;
+
+			if (!spring_istime(stallStartTimes[i]))
+				stallStartTimes[i] = curwdt;
+
+			AddHangSample(i, scope->load(std::memory_order_relaxed), curtime, curtime - curwdt);
+		}
+	}
 
 
 	static inline void UpdateActiveThreads(Threading::NativeThreadId num) {
@@ -162,9 +254,25 @@ namespace Watchdog
 				}
 
 				CrashHandler::CleanupStacktrace(LOG_LEVEL_WARNING);
+
+				for (unsigned int i = 0; i < WDT_COUNT; ++i) {
+					if (!hangThreads[i])
+						continue;
+
+					LOG_L(L_WARNING, "[Watchdog] sampled scopes of the %s-thread:", threadNames[i]);
+					LogHangSamples(i, curtime - hangTimeout);
+				}
 			}
 
-			spring::this_thread::sleep_for(std::chrono::seconds(1));
+			if (!spring_istime(sampleThreshold)) {
+				spring::this_thread::sleep_for(std::chrono::seconds(1));
+				continue;
+			}
+
+			SampleStalledThreads(curtime);
+
+			// a few samples per stall without waking up much more often than needed
+			spring::this_thread::sleep_for(std::chrono::milliseconds(std::clamp(int(sampleThreshold.toMilliSecsi() / 2), 10, 1000)));
 		}
 	}
 
@@ -211,6 +319,7 @@ namespace Watchdog
 		threadInfo->thread = thread;
 		threadInfo->threadid = threadId;
 		threadInfo->timer = spring_gettime();
+		threadInfo->scope = &CTimeProfiler::GetThreadScope();
 		threadInfo->numreg += 1;
 
 		// note: WDT_MAIN and WDT_LOAD share the same controls if LoadingMT=0
@@ -393,11 +502,25 @@ namespace Watchdog
 		}
 
 		hangTimeout = spring_secs(hangTimeoutSecs);
+		sampleThreshold = spring_msecs(configHandler->GetInt("HangSampleThreshold"));
+
+		numHangSamples = 0;
+		std::fill(std::begin(stallStartTimes), std::end(stallStartTimes), spring_notime);
 
 		// start the watchdog thread
 		hangDetectorThread = spring::thread(&HangDetectorLoop);
 
-		LOG("[WatchDog::%s] installed (hang-timeout: %is)", __func__, hangTimeoutSecs);
+		LOG("[WatchDog::%s] installed (hang-timeout: %is, sample-threshold: %ims)", __func__, hangTimeoutSecs, int(sampleThreshold.toMilliSecsi()));
+	}
+
+
+	void LogHangSamples()
+	{
+		if (numHangSamples.load(std::memory_order_acquire) == 0)
+			return;
+
+		LOG_L(L_WARNING, "[Watchdog] last sampled scopes of stalled threads:");
+		LogHangSamples(WDT_COUNT, spring_notime);
 	}
 
 
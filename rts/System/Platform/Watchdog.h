@@ -32,6 +32,9 @@ namespace Watchdog
 	bool DeregisterThread(WatchdogThreadnum num);
 	bool DeregisterCurrentThread();
 	bool HasThread(WatchdogThreadnum num);
+
+	// Logs the profiler scopes recorded on missed heartbeats (HangSampleThreshold)
+	void LogHangSamples();
 }
 
 #endif // _WATCHDOG_H
@@ -12,6 +12,9 @@
 #include "System/Log/LogSinkHandler.h"
 #include "System/LogOutput.h"
 #include "System/Threading/SpringThreading.h"
+#ifndef DEDICATED
+#include "System/Platform/Watchdog.h"
+#endif
 #include "seh.h"
 #include "System/StringUtil.h"
 #include "System/SafeCStrings.h"
@@ -471,6 +474,10 @@ LONG CALLBACK ExceptionHandler(LPEXCEPTION_POINTERS e)
 	// print trace inline: avoids modifying the stack which might confuse
 	// StackWalk when using the context record passed to ExceptionHandler
 	StacktraceInline(nullptr, e);
+	#ifndef DEDICATED
+	// where the threads stalled before the crash, if they did
+	Watchdog::LogHangSamples();
+	#endif
 	CleanupStacktrace();
 
 	// only the first crash is of any real interest
@@ -75,6 +75,8 @@ public:
 public:
 	unsigned numEmptyPlayRequests = 0;
 	unsigned numAbortedPlays = 0;
+	unsigned numMergedPlayRequests = 0;
+	unsigned numCulledPlayRequests = 0;
 
 private:
 	virtual bool LoadSoundDefsImpl(LuaParser* defsParser) = 0;
@@ -9,14 +9,82 @@
 #include "Sim/Misc/GuiSoundSet.h"
 #include "Sim/Objects/WorldObject.h"
 #include "System/Sound/ISound.h"
+#include "System/Sound/ISoundChannels.h"
 #include "System/Sound/SoundLog.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/UnorderedMap.hpp"
 
+#include <algorithm>
 #include <climits>
+#include <cmath>
+
+// conflicts with the likely/unlikely macros
+#ifdef   likely
+#undef   likely
+#undef unlikely
+#endif
+
+#include "System/ConcurrentQueue.h"
 
 extern spring::recursive_mutex soundMutex;
 
 
+namespace {
+	struct PlayRequest {
+		// nullptr marks the start of a new frame
+		AudioChannel* channel;
+
+		size_t id;
+
+		float3 pos;
+		float3 velocity;
+
+		float volume;
+		bool relative;
+	};
+
+	struct PlayCandidate {
+		PlayRequest request;
+
+		int priority;
+		float distance;
+
+		// of the merged requests
+		float volumeSq;
+		float maxVolume;
+		int numMerged;
+		float3 posSum;
+		float3 velSum;
+	};
+
+	struct SourceRank {
+		size_t index;
+
+		int priority;
+		float distance;
+	};
+
+	// requests beyond this are dropped, e.g. while the sound thread is stalled
+	static constexpr size_t MAX_QUEUED_REQUESTS = 8192;
+
+	// positional requests for the same item within one frame and cell are played as one
+	static constexpr float AGGREGATE_CELL_SIZE = 128.0f;
+	// N merged requests sound sqrt(N) times as loud (incoherent sum), up to this factor
+	static constexpr float MAX_AGGREGATE_GAIN = 2.0f;
+	// requests quieter than this after distance attenuation are dropped (about -48dB)
+	static constexpr float MIN_AUDIBLE_GAIN = 1.0f / 256.0f;
+
+	moodycamel::ConcurrentQueue<PlayRequest> playRequests;
+
+	// only touched by the sound thread
+	std::vector<PlayRequest> pendingRequests;
+	std::vector<PlayCandidate> playCandidates;
+	spring::unsynced_map<std::uint64_t, size_t> candidateBuckets; // <{item, cell}, index into playCandidates>
+	std::vector<SourceRank> sourceRanks;
+	std::vector<std::uint8_t> claimedSources;
+}
+
+
 
 void AudioChannel::SetVolume(float newVolume)
 {
@@ -69,67 +137,221 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 	if (id == 0 || volume <= 0.0f)
 		return;
 
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
-
-	if (!enabled)
+	if (playRequests.size_approx() >= MAX_QUEUED_REQUESTS)
 		return;
 
-	// get the sound item, then find a source for it
-	const SoundItem* sndItem = sound->GetSoundItem(id);
+	// everything else (enabled-state, distance, limits) is checked by ProcessPlayRequests
+	playRequests.enqueue({this, id, pos, velocity, volume, relative});
+}
+
 
-	if (sndItem == nullptr) {
-		sound->numEmptyPlayRequests++;
+void AudioChannel::QueueNewFrame()
+{
+	if (playRequests.size_approx() >= MAX_QUEUED_REQUESTS)
 		return;
-	}
 
-	// check distance to listener
-	if (pos.distance(sound->GetListenerPos()) > sndItem->MaxDistance()) {
-		if (!relative)
-			return;
+	playRequests.enqueue({nullptr, 0, ZeroVector, ZeroVector, 0.0f, false});
+}
+
+void AudioChannel::ClearPlayRequests()
+{
+	PlayRequest request;
+
+	while (playRequests.try_dequeue(request));
+}
+
+void AudioChannel::ProcessPlayRequests(std::vector<CSoundSource>& sources)
+{
+	size_t numRequests = 0;
+
+	pendingRequests.resize(std::max(pendingRequests.size(), size_t(256)));
 
-		LOG("[AudioChannel::%s] maximum distance ignored for relative playback of sound-item \"%s\"", __func__, (sndItem->Name()).c_str());
+	// take everything queued so far in one go
+	while ((numRequests += playRequests.try_dequeue_bulk(pendingRequests.data() + numRequests, pendingRequests.size() - numRequests)) == pendingRequests.size()) {
+		pendingRequests.resize(pendingRequests.size() * 2);
 	}
 
-	// don't spam to many sounds per frame
-	if (emitsThisFrame >= emitsPerFrame)
-		return;
+	const float3& listenerPos = sound->GetListenerPos();
 
-	emitsThisFrame++;
+	playCandidates.clear();
+	candidateBuckets.clear();
 
-	// check if the sound item is already played
-	if (curSources.size() >= maxConcurrentSources) {
-		CSoundSource* src = nullptr;
+	for (size_t i = 0; i < numRequests; i++) {
+		const PlayRequest& request = pendingRequests[i];
 
-		int prio = INT_MAX;
+		if (request.channel == nullptr) {
+			// requests are only merged within a frame
+			candidateBuckets.clear();
 
-		for (CSoundSource* tmp: curSources) {
-			if (tmp->GetCurrentPriority() < prio) {
-				src  = tmp;
-				prio = src->GetCurrentPriority();
-			}
+			Channels::General->UpdateFrame();
+			Channels::Battle->UpdateFrame();
+			Channels::UnitReply->UpdateFrame();
+			Channels::UserInterface->UpdateFrame();
+			continue;
 		}
 
-		if (src == nullptr || prio > sndItem->GetPriority()) {
-			LOG_L(L_DEBUG, "[AudioChannel::%s] maximum concurrent playbacks reached for sound-item %s", __func__, (sndItem->Name()).c_str());
-			return;
+		AudioChannel* channel = request.channel;
+
+		if (!channel->enabled)
+			continue;
+
+		// get the sound item, then find a source for it
+		const SoundItem* sndItem = sound->GetSoundItem(request.id);
+
+		if (sndItem == nullptr) {
+			sound->numEmptyPlayRequests++;
+			continue;
 		}
 
-		src->Stop();
-	}
+		// check distance to listener
+		const float distance = request.pos.distance(listenerPos);
+
+		if (distance > sndItem->MaxDistance()) {
+			if (!request.relative)
+				continue;
+
+			LOG("[AudioChannel::%s] maximum distance ignored for relative playback of sound-item \"%s\"", __func__, (sndItem->Name()).c_str());
+		}
+
+		const bool positional = (!request.relative && sndItem->Is3D());
+
+		std::uint64_t bucketKey = 0;
+
+		if (positional) {
+			// at least as loud as the source will be, channel volume changes are picked up by UpdateVolume
+			const float maxGain = request.volume * sndItem->MaxGain() * std::max(channel->volume, 1.0f) * MAX_AGGREGATE_GAIN;
+
+			if ((maxGain * CSoundSource::GetDistanceGain(distance, sndItem->GetRolloff())) < MIN_AUDIBLE_GAIN) {
+				sound->numCulledPlayRequests++;
+				continue;
+			}
+
+			const std::uint64_t cellX = static_cast<std::uint16_t>(static_cast<int>(std::floor(request.pos.x / AGGREGATE_CELL_SIZE)));
+			const std::uint64_t cellZ = static_cast<std::uint16_t>(static_cast<int>(std::floor(request.pos.z / AGGREGATE_CELL_SIZE)));
+			bucketKey = (std::uint64_t(request.id) << 32) | (cellX << 16) | cellZ;
+
+			const auto bucketIt = candidateBuckets.find(bucketKey);
+
+			if (bucketIt != candidateBuckets.end()) {
+				PlayCandidate& candidate = playCandidates[bucketIt->second];
+
+				// same item and cell from another channel, keep them apart
+				if (candidate.request.channel == channel) {
+					candidate.volumeSq += (request.volume * request.volume);
+					candidate.maxVolume = std::max(candidate.maxVolume, request.volume);
+					candidate.numMerged += 1;
+					candidate.posSum += request.pos;
+					candidate.velSum += request.velocity;
 
-	// find a sound source to play the item in
-	CSoundSource* sndSource = sound->GetNextBestSource();
+					sound->numMergedPlayRequests++;
+					continue;
+				}
+			}
+		}
+
+		// don't spam to many sounds per frame
+		if (channel->emitsThisFrame >= channel->emitsPerFrame)
+			continue;
+
+		if (positional)
+			candidateBuckets[bucketKey] = playCandidates.size();
+
+		channel->emitsThisFrame++;
+		playCandidates.push_back({request, sndItem->GetPriority(), (request.relative)? 0.0f: distance,  request.volume * request.volume, request.volume, 1, request.pos, request.velocity});
+	}
 
-	if (sndSource == nullptr || (sndSource->GetCurrentPriority() >= sndItem->GetPriority())) {
-		LOG_L(L_DEBUG, "[AudioChannel::%s] no source found for sound-item %s", __func__, (sndItem->Name()).c_str());
+	if (playCandidates.empty())
 		return;
+
+	// one louder source at the center of each bucket
+	for (PlayCandidate& candidate: playCandidates) {
+		if (candidate.numMerged == 1)
+			continue;
+
+		PlayRequest& request = candidate.request;
+
+		request.volume = std::min(std::sqrt(candidate.volumeSq), candidate.maxVolume * MAX_AGGREGATE_GAIN);
+		request.pos = candidate.posSum / candidate.numMerged;
+		request.velocity = candidate.velSum / candidate.numMerged;
+
+		candidate.distance = request.pos.distance(listenerPos);
 	}
-	if (sndSource->IsPlaying())
-		sound->numAbortedPlays++;
 
-	// play the sound item
-	sndSource->PlayAsync(this, id, pos, velocity, volume, sndItem->GetPriority(), relative);
-	curSources.insert(sndSource);
+	// most important and then nearest requests get first pick of the sources
+	std::stable_sort(playCandidates.begin(), playCandidates.end(), [](const PlayCandidate& a, const PlayCandidate& b) {
+		if (a.priority != b.priority)
+			return (a.priority > b.priority);
+		return (a.distance < b.distance);
+	});
+
+	// rank the sources once instead of scanning all of them per request:
+	// free ones (INT_MIN) first, then by priority, the farthest first
+	sourceRanks.clear();
+	sourceRanks.reserve(sources.size());
+	claimedSources.clear();
+	claimedSources.resize(sources.size(), 0);
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		sourceRanks.push_back({i, sources[i].GetCurrentPriority(), sources[i].GetListenerDistance(listenerPos)});
+	}
+
+	std::stable_sort(sourceRanks.begin(), sourceRanks.end(), [](const SourceRank& a, const SourceRank& b) {
+		if (a.priority != b.priority)
+			return (a.priority < b.priority);
+		return (a.distance > b.distance);
+	});
+
+	size_t nextRank = 0;
+
+	for (const PlayCandidate& candidate: playCandidates) {
+		const PlayRequest& request = candidate.request;
+		AudioChannel* channel = request.channel;
+		CSoundSource* sndSource = nullptr;
+
+		// check if the channel already plays its maximum number of sounds
+		if (channel->curSources.size() >= channel->maxConcurrentSources) {
+			int prio = INT_MAX;
+
+			for (CSoundSource* tmp: channel->curSources) {
+				if (tmp->GetCurrentPriority() < prio) {
+					sndSource = tmp;
+					prio = sndSource->GetCurrentPriority();
+				}
+			}
+
+			if (sndSource == nullptr || prio > candidate.priority) {
+				LOG_L(L_DEBUG, "[AudioChannel::%s] maximum concurrent playbacks reached for sound-item %s", __func__, (sound->GetSoundItem(request.id)->Name()).c_str());
+				continue;
+			}
+
+			// reuse the stopped source right away
+			sndSource->Stop();
+		} else {
+			while (nextRank < sourceRanks.size() && claimedSources[sourceRanks[nextRank].index] != 0)
+				nextRank++;
+
+			// all taken, only channel-internal steals are left
+			if (nextRank == sourceRanks.size())
+				continue;
+
+			// candidates only get less important, but a later one might still steal within its channel
+			if (sourceRanks[nextRank].priority >= candidate.priority) {
+				LOG_L(L_DEBUG, "[AudioChannel::%s] no source found for sound-item %s", __func__, (sound->GetSoundItem(request.id)->Name()).c_str());
+				continue;
+			}
+
+			sndSource = &sources[sourceRanks[nextRank++].index];
+		}
+
+		claimedSources[sndSource - sources.data()] = 1;
+
+		if (sndSource->IsPlaying())
+			sound->numAbortedPlays++;
+
+		// play the sound item
+		sndSource->PlayAsync(channel, request.id, request.pos, request.velocity, request.volume, candidate.priority, request.relative);
+		channel->curSources.insert(sndSource);
+	}
 }
 
 
@@ -5,6 +5,7 @@
 
 #include <deque>
 #include <cstring>
+#include <vector>
 
 #include "System/Sound/IAudioChannel.h"
 #include "System/UnorderedSet.hpp"
@@ -49,6 +50,21 @@ public:
 	float StreamGetTime();
 	float StreamGetPlayTime();
 
+	/**
+	 * @brief Assign sources to queued play requests
+	 *
+	 * PlaySample only queues a request (without locking), the sound thread
+	 * calls this with soundMutex held before updating the sources. Requests
+	 * passing the per-channel limits are served highest priority and nearest
+	 * to the listener first, each taking the free or least important (then
+	 * farthest) remaining source.
+	 */
+	static void ProcessPlayRequests(std::vector<CSoundSource>& sources);
+	/// per-frame emit limits are reset in queue order
+	static void QueueNewFrame();
+	/// drops requests that were not processed, channels may be gone after this
+	static void ClearPlayRequests();
+
 protected:
 	void FindSourceAndPlay(size_t id, const float3& pos, const float3& velocity, float volume, bool relative) override;
 	void SoundSourceFinished(CSoundSource* sndSource) override;
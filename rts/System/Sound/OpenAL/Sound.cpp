@@ -22,6 +22,7 @@
 
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sound/SoundLog.h"
+#include "AudioChannel.h"
 #include "SoundSource.h"
 #include "SoundBuffer.h"
 #include "SoundItem.h"
@@ -41,13 +42,30 @@
 #include "System/Platform/Threading.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "System/float3.h"
 
+// conflicts with the likely/unlikely macros
+#ifdef   likely
+#undef   likely
+#undef unlikely
+#endif
+
+#include "System/ConcurrentQueue.h"
+
+CONFIG(bool, snd_predecode).defaultValue(true).description("Decode the files of all sounds.lua items in the background after loading, instead of when each is first played.");
+
 
 spring::recursive_mutex soundMutex;
 
 
+struct CSound::PreDecodeState {
+	moodycamel::ConcurrentQueue<DecodedSoundBuffer> decoded;
+	std::atomic<bool> cancelled = {false};
+};
+
+
 CSound::CSound()
 {
 	configHandler->NotifyOnChange(this, {"snd_volmaster", "snd_eaxpreset", "snd_filter", "UseEFX", "snd_volgeneral", "snd_volunitreply", "snd_volbattle", "snd_volui", "snd_volmusic", "PitchAdjust"});
@@ -120,6 +138,14 @@ void CSound::Kill()
 		if (soundThread.joinable())
 			soundThread.join();
 	}
+	{
+		// workers still decoding drop their results
+		if (preDecodeState != nullptr)
+			preDecodeState->cancelled = true;
+
+		preDecodeState.reset();
+		AudioChannel::ClearPlayRequests();
+	}
 
 	SoundBuffer::Deinitialise();
 }
@@ -753,12 +779,17 @@ void CSound::Update()
 {
 	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
 
+	UploadPreDecodedBuffers();
+
 	// limit consumption-rate to prevent source starvation
 	// lock is held, size can not be changed except by loop
 	for (size_t i = 0, n = std::min(size_t(4), preloadSet.size()); i < n; i++) {
 		GetSoundId(*preloadSet.begin());
 	}
 
+	// sources picked here start playing in their Update below
+	AudioChannel::ProcessPlayRequests(soundSources);
+
 	for (CSoundSource& source: soundSources) {
 		source.Update();
 	}
@@ -842,6 +873,8 @@ void CSound::PrintDebugInfo()
 	LOG_L(L_DEBUG, "# reserved for buffers: %i kB", (int)(SoundBuffer::AllocedSize() / 1024));
 	LOG_L(L_DEBUG, "# PlayRequests for empty sound: %i", numEmptyPlayRequests);
 	LOG_L(L_DEBUG, "# Samples disrupted: %i", numAbortedPlays);
+	LOG_L(L_DEBUG, "# PlayRequests merged: %i", numMergedPlayRequests);
+	LOG_L(L_DEBUG, "# PlayRequests inaudible: %i", numCulledPlayRequests);
 	LOG_L(L_DEBUG, "# SoundItems: %i", (int)soundItems.size());
 }
 
@@ -921,9 +954,102 @@ bool CSound::LoadSoundDefsImpl(LuaParser* defsParser)
 		snddef["file"] = file;
 	}
 
+	PreDecodeSoundBuffers();
 	return true;
 }
 
+void CSound::PreDecodeSoundBuffers()
+{
+	// only caller is LoadSoundDefsImpl which holds soundMutex
+	if (!configHandler->GetBool("snd_predecode") || !ThreadPool::HasThreads())
+		return;
+
+	std::vector<std::string> paths;
+	paths.reserve(soundItemDefsMap.size());
+
+	for (const auto& pair: soundItemDefsMap) {
+		const auto fileIt = pair.second.find("file");
+
+		if (fileIt == pair.second.end())
+			continue;
+		if (SoundBuffer::GetId(fileIt->second) > 0 || failureSet.find(fileIt->second) != failureSet.end())
+			continue;
+
+		paths.push_back(fileIt->second);
+	}
+
+	std::sort(paths.begin(), paths.end());
+	paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+	if (paths.empty())
+		return;
+
+	if (preDecodeState == nullptr)
+		preDecodeState = std::make_shared<PreDecodeState>();
+
+	LOG("[Sound::%s] decoding %u sound files in the background", __func__, uint32_t(paths.size()));
+
+	// batches keep the task count down for games with thousands of sounds
+	constexpr size_t BATCH_SIZE = 16;
+
+	for (size_t i = 0; i < paths.size(); i += BATCH_SIZE) {
+		std::vector<std::string> batch(paths.begin() + i, paths.begin() + std::min(i + BATCH_SIZE, paths.size()));
+
+		ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::Background, [state = preDecodeState, batch = std::move(batch)]() {
+			std::vector<std::uint8_t> fileBuffer;
+
+			for (const std::string& path: batch) {
+				if (state->cancelled)
+					return;
+
+				CFileHandler file(path, SPRING_VFS_RAW_FIRST);
+
+				// failures are left to LoadSoundBuffer, which also reports them
+				if (!file.FileExists())
+					continue;
+
+				fileBuffer.resize(file.FileSize());
+
+				if (file.Read(fileBuffer.data(), fileBuffer.size()) != static_cast<int>(fileBuffer.size()))
+					continue;
+
+				DecodedSoundBuffer decodedBuffer;
+				decodedBuffer.path = path;
+
+				if (!SoundBuffer::Decode(path, file.GetFileExt(), fileBuffer, decodedBuffer.data))
+					continue;
+
+				state->decoded.enqueue(std::move(decodedBuffer));
+			}
+		});
+	}
+}
+
+void CSound::UploadPreDecodedBuffers()
+{
+	if (preDecodeState == nullptr)
+		return;
+
+	DecodedSoundBuffer decodedBuffer;
+
+	while (preDecodeState->decoded.try_dequeue(decodedBuffer)) {
+		// already loaded on demand while this was being decoded
+		if (SoundBuffer::GetId(decodedBuffer.path) > 0)
+			continue;
+
+		SoundBuffer soundBuf;
+		soundBuf.Upload(decodedBuffer.path, decodedBuffer.data);
+		CheckError("[Sound::UploadPreDecodedBuffers]");
+
+		if (soundBuf.GetLength() <= 0.0f) {
+			failureSet.insert(decodedBuffer.path);
+			continue;
+		}
+
+		SoundBuffer::Insert(std::move(soundBuf));
+	}
+}
+
 // only used internally, locked in caller's scope
 size_t CSound::LoadSoundBuffer(const std::string& path)
 {
@@ -961,16 +1087,10 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 
 
 	SoundBuffer soundBuf;
-	const std::string& soundExt = file.GetFileExt();
-
-	switch (soundExt[0]) {
-		case 'w': { soundBuf.LoadWAV   (path, loadBuffer); } break; // wav
-		case 'o': { soundBuf.LoadVorbis(path, loadBuffer); } break; // ogg
-		case 'm': { soundBuf.LoadMp3   (path, loadBuffer); } break; // mp3
-		default : {
-			LOG_L(L_WARNING, "[%s] unknown audio format \"%s\"", __func__, soundExt.c_str());
-		} break;
-	}
+	SoundBuffer::DecodedData soundData;
+
+	if (SoundBuffer::Decode(path, file.GetFileExt(), loadBuffer, soundData))
+		soundBuf.Upload(path, soundData);
 
 	CheckError("[Sound::LoadSoundBuffer]");
 
@@ -985,10 +1105,8 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 
 void CSound::NewFrame()
 {
-	Channels::General->UpdateFrame();
-	Channels::Battle->UpdateFrame();
-	Channels::UnitReply->UpdateFrame();
-	Channels::UserInterface->UpdateFrame();
+	// the emit counters belong to the sound thread now, reset them in order with the requests
+	AudioChannel::QueueNewFrame();
 }
 
 
@@ -4,6 +4,7 @@
 #define _SOUND_H_
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 #include <al.h>
@@ -15,6 +16,7 @@
 #include "System/UnorderedSet.hpp"
 #include "System/Threading/SpringThreading.h"
 
+#include "SoundBuffer.h"
 #include "SoundItem.h"
 
 class CSoundSource;
@@ -76,6 +78,14 @@ private:
 	typedef spring::unordered_map<std::string, std::string> SoundItemNameMap;
 	typedef spring::unordered_map<std::string, SoundItemNameMap> SoundItemDefsMap;
 
+	struct DecodedSoundBuffer {
+		std::string path;
+		SoundBuffer::DecodedData data;
+	};
+
+	// shared with the decoding workers, which may outlive a reload
+	struct PreDecodeState;
+
 private:
 	void Cleanup();
 	void OpenOpenALDevice(const std::string& deviceName);
@@ -93,6 +103,11 @@ private:
 	size_t MakeItemFromDef(const SoundItemNameMap& itemDef);
 	size_t LoadSoundBuffer(const std::string& filename);
 
+	/// decodes the files of all sounds.lua items on ThreadPool workers
+	void PreDecodeSoundBuffers();
+	/// turns finished decodes into buffers, called by Update
+	void UploadPreDecodedBuffers();
+
 private:
 	ALCdevice* curDevice = nullptr;
 	ALCcontext* curContext = nullptr;
@@ -111,6 +126,8 @@ private:
 
 	std::vector<std::uint8_t> loadBuffer;
 
+	std::shared_ptr<PreDecodeState> preDecodeState;
+
 	SoundItemNameMap defaultItemNameMap;
 	SoundItemDefsMap soundItemDefsMap; // parsed from sounds.lua
 
@@ -19,8 +19,6 @@
 SoundBuffer::bufferMapT SoundBuffer::bufferMap;
 SoundBuffer::bufferVecT SoundBuffer::buffers;
 
-static std::vector<std::uint8_t> decodeBuffer;
-
 
 #pragma pack(push, 1)
 // Header copied from WavLib by Michael McTernan
@@ -42,7 +40,21 @@ struct WAVHeader
 #pragma pack(pop)
 
 
-bool SoundBuffer::LoadWAV(const std::string& file, const std::vector<std::uint8_t>& buffer)
+bool SoundBuffer::Decode(const std::string& file, const std::string& fileExt, std::vector<std::uint8_t>& buffer, DecodedData& data)
+{
+	switch (fileExt.empty()? 0: fileExt[0]) {
+		case 'w': { return (DecodeWAV   (file, buffer, data)); } break; // wav
+		case 'o': { return (DecodeVorbis(file, buffer, data)); } break; // ogg
+		case 'm': { return (DecodeMp3   (file, buffer, data)); } break; // mp3
+		default : {
+			LOG_L(L_WARNING, "[%s] unknown audio format \"%s\"", __func__, fileExt.c_str());
+		} break;
+	}
+
+	return false;
+}
+
+bool SoundBuffer::DecodeWAV(const std::string& file, std::vector<std::uint8_t>& buffer, DecodedData& data)
 {
 	WAVHeader* header = (WAVHeader*)(&buffer[0]);
 
@@ -113,17 +125,17 @@ bool SoundBuffer::LoadWAV(const std::string& file, const std::vector<std::uint8_
 		header->datalen = std::uint32_t(buffer.size() - sizeof(WAVHeader))&(~std::uint32_t((header->BitsPerSample*header->channels)/8 -1));
 	}
 
-	if (header->datalen <= 0 || !AlGenBuffer(file, format, &buffer[sizeof(WAVHeader)], header->datalen, header->SamplesPerSec))
-		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
-
-	filename = file;
-	channels = header->channels;
-	length   = float(header->datalen) / (header->channels * header->SamplesPerSec * header->BitsPerSample);
+	if (header->datalen > 0)
+		data.samples.assign(buffer.begin() + sizeof(WAVHeader), buffer.begin() + sizeof(WAVHeader) + header->datalen);
 
+	data.format   = format;
+	data.rate     = header->SamplesPerSec;
+	data.channels = header->channels;
+	data.length   = float(header->datalen) / (header->channels * header->SamplesPerSec * header->BitsPerSample);
 	return true;
 }
 
-bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer)
+bool SoundBuffer::DecodeVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data)
 {
 	OggDecoder decoder;
 	const bool loaded = decoder.LoadData(buffer.data(), buffer.size());
@@ -142,6 +154,8 @@ bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uin
 		}
 	}
 
+	std::vector<std::uint8_t>& decodeBuffer = data.samples;
+
 	size_t pos = 0;
 	int section = 0;
 	long read = 0;
@@ -169,16 +183,16 @@ bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uin
 		pos += read;
 	} while (read > 0); // read == 0 indicated EOF, read < 0 is error
 
-	if (!AlGenBuffer(file, format, &decodeBuffer[0], pos, decoder.GetRate()))
-		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
+	decodeBuffer.resize(pos);
 
-	filename = file;
-	channels = decoder.GetChannels();
-	length   = decoder.GetTotalTime();
+	data.format   = format;
+	data.rate     = decoder.GetRate();
+	data.channels = decoder.GetChannels();
+	data.length   = decoder.GetTotalTime();
 	return true;
 }
 
-bool SoundBuffer::LoadMp3(const std::string& file, const std::vector<std::uint8_t>& buffer)
+bool SoundBuffer::DecodeMp3(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data)
 {
 	auto decoder = Mp3Decoder();
 	const bool loaded = decoder.LoadData(buffer.data(), buffer.size());
@@ -197,6 +211,8 @@ bool SoundBuffer::LoadMp3(const std::string& file, const std::vector<std::uint8_
 		}
 	}
 
+	std::vector<std::uint8_t>& decodeBuffer = data.samples;
+
 	size_t pos = 0;
 	long read = 0;
 
@@ -214,13 +230,26 @@ bool SoundBuffer::LoadMp3(const std::string& file, const std::vector<std::uint8_
 		pos += read;
 	} while (read > 0); // read == 0 indicated EOF, read < 0 is error
 
-	if (!AlGenBuffer(file, format, &decodeBuffer[0], pos, decoder.GetRate()))
+	decodeBuffer.resize(pos);
+
+	data.format   = format;
+	data.rate     = decoder.GetRate();
+	data.channels = decoder.GetChannels();
+	data.length   = decoder.GetTotalTime();
+	return true;
+}
+
+bool SoundBuffer::Upload(const std::string& file, const DecodedData& data)
+{
+	const bool generated = (!data.samples.empty() && AlGenBuffer(file, data.format, data.samples.data(), data.samples.size(), data.rate));
+
+	if (!generated)
 		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
 
 	filename = file;
-	channels = decoder.GetChannels();
-	length   = decoder.GetTotalTime();
-	return true;
+	channels = data.channels;
+	length   = data.length;
+	return generated;
 }
 
 bool SoundBuffer::AlGenBuffer(const std::string& file, ALenum format, const std::uint8_t* data, size_t datalength, int rate)
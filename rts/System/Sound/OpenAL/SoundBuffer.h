@@ -22,6 +22,16 @@
 class SoundBuffer : spring::noncopyable
 {
 public:
+	/// PCM samples of a decoded file, ready to be handed to OpenAL
+	struct DecodedData {
+		std::vector<std::uint8_t> samples;
+
+		ALenum format = AL_NONE;
+		int rate = 0;
+		int channels = 0;
+		float length = 0.0f;
+	};
+
 	/// Construct an "empty" buffer
 	/// can be played, but you won't hear anything
 	SoundBuffer() = default;
@@ -37,9 +47,15 @@ public:
 		return *this;
 	}
 
-	bool LoadWAV(const std::string& file, const std::vector<std::uint8_t>& buffer);
-	bool LoadVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer);
-	bool LoadMp3(const std::string& file, const std::vector<std::uint8_t>& buffer);
+	/**
+	 * Decodes {wav,ogg,mp3} file contents (selected by extension) without
+	 * touching OpenAL or any shared state, can be called from any thread.
+	 * The buffer is modified (wav headers are byte-swapped in place).
+	 */
+	static bool Decode(const std::string& file, const std::string& fileExt, std::vector<std::uint8_t>& buffer, DecodedData& data);
+
+	/// creates the AL buffer, leaves a zero-length buffer on failure
+	bool Upload(const std::string& file, const DecodedData& data);
 	bool Release();
 
 	const std::string& GetFilename() const { return filename; }
@@ -68,6 +84,10 @@ public:
 	static size_t Insert(SoundBuffer&& buffer);
 
 private:
+	static bool DecodeWAV(const std::string& file, std::vector<std::uint8_t>& buffer, DecodedData& data);
+	static bool DecodeVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data);
+	static bool DecodeMp3(const std::string& file, const std::vector<std::uint8_t>& buffer, DecodedData& data);
+
 	bool AlGenBuffer(const std::string& file, ALenum format, const std::uint8_t* data, size_t datalength, int rate);
 
 	std::string filename;
@@ -35,6 +35,10 @@ public:
 	size_t GetSoundBufferID() const { return soundBufferID; }
 
 	float MaxDistance() const { return maxDist; }
+	/// upper bound of GetGain
+	float MaxGain() const { return (gain * (1.0f + gainMod)); }
+	float GetRolloff() const { return rolloff; }
+	bool Is3D() const { return in3D; }
 	const std::string& Name() const { return name; }
 	int GetPriority() const { return priority; }
 
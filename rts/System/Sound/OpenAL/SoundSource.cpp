@@ -146,6 +146,27 @@ int CSoundSource::GetCurrentPriority() const
 	return (curPlayingItem.priority);
 }
 
+float CSoundSource::GetDistanceGain(float distance, float rolloff)
+{
+	// AL_INVERSE_DISTANCE_CLAMPED, see CSound::InitThread; distances are scaled
+	// to meters for OpenAL but the ratio does not change
+	const float rolloffFactor = ROLLOFF_FACTOR * rolloff * heightRolloffModifier;
+	const float clampedDist = std::max(distance, REFERENCE_DIST);
+
+	return (REFERENCE_DIST / (REFERENCE_DIST + rolloffFactor * (clampedDist - REFERENCE_DIST)));
+}
+
+float CSoundSource::GetListenerDistance(const float3& listenerPos) const
+{
+	if (asyncPlayItem.id != 0)
+		return ((asyncPlayItem.relative)? 0.0f: asyncPlayItem.position.distance(listenerPos));
+
+	if (curPlayingItem.id == 0 || !in3D)
+		return 0.0f;
+
+	return (curPlayingItem.pos.distance(listenerPos));
+}
+
 bool CSoundSource::IsPlaying(const bool checkOpenAl) const
 {
 	if (curStream)
@@ -213,7 +234,7 @@ void CSoundSource::Play(IAudioChannel* channel, SoundItem* item, float3 pos, flo
 	Stop();
 
 	curVolume = volume;
-	curPlayingItem = {item->soundItemID,  item->loopTime, item->priority,  item->GetGain(), item->rolloff};
+	curPlayingItem = {item->soundItemID,  item->loopTime, item->priority,  item->GetGain(), item->rolloff,  pos};
 	curChannel = channel;
 
 	alSourcei(id, AL_BUFFER, itemBuffer.GetId());
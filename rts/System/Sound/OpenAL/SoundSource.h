@@ -40,6 +40,8 @@ public:
 	bool IsValid() const { return (id != 0); };
 
 	int GetCurrentPriority() const;
+	/// distance of the current or pending sound to the listener, 0 if not positional
+	float GetListenerDistance(const float3& listenerPos) const;
 	bool IsPlaying(const bool checkOpenAl = false) const;
 	void Stop();
 
@@ -52,6 +54,9 @@ public:
 	float GetStreamTime();
 	float GetStreamPlayTime();
 
+	/// attenuation OpenAL applies at distance (in elmos) to a 3D source with the given item rolloff
+	static float GetDistanceGain(float distance, float rolloff);
+
 	static void SetPitch(const float& newPitch) { globalPitch = newPitch; }
 	static void SetHeightRolloffModifer(const float& mod) { heightRolloffModifier = mod; }
 
@@ -81,6 +86,8 @@ private:
 
 		float rndGain = 0.0f;
 		float rolloff = 0.0f;
+
+		float3 pos;
 	};
 
 private:
@@ -71,6 +71,8 @@
 #include "System/SpringExitCode.h"
 #include "System/StartScriptGen.h"
 #include "System/TimeProfiler.h"
+#include "System/Misc/StartupTrace.h"
+#include "System/Misc/TracyDefs.h"
 #include "System/UriParser.h"
 #include "System/LoadLock.h"
 #include "System/Config/ConfigHandler.h"
@@ -95,6 +97,7 @@
 #include "System/Platform/Watchdog.h"
 #include "System/Sound/ISound.h"
 #include "System/Sync/FPUCheck.h"
+#include "System/Threading/AsyncTask.h"
 #include "System/Threading/ThreadPool.h"
 
 #include "Game/UnsyncedGameCommands.h"
@@ -113,6 +116,9 @@ CONFIG(bool, FontConfigSearchAttributes).defaultValue(true).description("Whether
 CONFIG(bool, FontConfigApplySubstitutions).defaultValue(true).description("[EXPERIMENTAL] In case it's disabled FcConfigSubstitute is not getting called, this might break non-ASCII font rendering.");
 CONFIG(int, MaxFontTries).defaultValue(5).description("Represents the maximum number of attempts to search for a glyph replacement using the FontConfig library (lower = foreign glyphs may fail to render, higher = searching for foreign glyphs can lag the game).");
 CONFIG(int, MaxPinnedFonts).defaultValue(10).description("Maximum number of fonts to pin to cache. Increasing this will eventually use more memory, but can alleviate processing spikes when rendering new glyphs.");
+CONFIG(bool, AsyncGlyphRasterization).defaultValue(true).description("Whether new glyphs are rasterized on worker threads, they are drawn as the 'not found' glyph for a frame or two instead of stalling the frame.");
+CONFIG(bool, FontGlyphCache).defaultValue(true).description("Whether the rasterized glyphs of each font are saved to the cache directory and restored on startup.");
+CONFIG(std::string, TracyZones).defaultValue("all").description("Categories of Tracy profiler zones to record when a profiler is attached: \"all\", \"none\" or a comma-separated list of sim, path, los, cob, lua, net, draw and misc. Can be changed in-game with /TracyZones.");
 
 CONFIG(std::string, name).defaultValue(UnnamedPlayerName).description("Sets your name in the game. Since this is overridden by lobbies with your lobby username when playing, it usually only comes up when viewing replays or starting the engine directly for testing purposes.");
 CONFIG(std::string, DefaultStartScript).defaultValue("").description("filename of script.txt to use when no command line parameters are specified.");
@@ -157,6 +163,10 @@ DEFINE_string_EX(calc_checksum,      "calc-checksum",      "",    "Calculate nam
  * the same port number is heavily reused across many replays. Forcing onlyLocal solves this. */
 DEFINE_bool_EX  (onlyLocal,              "only-local",     false, "Force OnlyLocal mode (no network listening sockets). Use for parallelized watching of multiplayer replays");
 
+DEFINE_VARIABLE_EX(GFLAGS_NAMESPACE::int32, I, benchmark_frame, "benchmark-frame", 0, "Run the game unthrottled and quit at this frame, writing timer totals as JSON (see --benchmark-out)");
+DEFINE_string_EX(benchmark_out,          "benchmark-out",  "benchmark.json", "File written by --benchmark-frame");
+DEFINE_string_EX(startup_trace,          "startup-trace",  "",    "Record all startup and loading stages until the game starts and write them to this file in Chrome trace (JSON) format");
+
 
 
 int spring::exitCode = spring::EXIT_CODE_SUCCESS;
@@ -209,6 +219,9 @@ SpringApp::SpringApp(int argc, char** argv)
 	// as our clock anymore)
 	spring_time::setstarttime(spring_time::gettime(true));
 
+	if (!FLAGS_startup_trace.empty())
+		CStartupTrace::Enable(FLAGS_startup_trace);
+
 	// gu does not exist yet, pre-seed for ShowSplashScreen
 	guRNG.Seed(CGlobalUnsyncedRNG::rng_val_type(&argc));
 	// ditto for unsynced Lua states (which do not use guRNG)
@@ -234,8 +247,10 @@ SpringApp::~SpringApp()
  */
 bool SpringApp::Init()
 {
+	SCOPED_STARTUP_TRACE("SpringApp::Init", "init")
 	SpringMath::Init();
 	LuaMemPool::InitStatic(configHandler->GetBool("UseLuaMemPools"));
+	Recoil::TracyZones::SetEnabled(Recoil::TracyZones::ParseCategories(configHandler->GetString("TracyZones")));
 
 	CGlobalRendering::InitStatic();
 	globalRendering->SetFullScreen(FLAGS_window, FLAGS_fullscreen);
@@ -253,29 +268,43 @@ bool SpringApp::Init()
 	Watchdog::RegisterThread(WDT_MAIN, true);
 
 	// Create Window
-	if (!InitWindow(("Recoil " + SpringVersion::GetFull()).c_str())) {
-		SDL_Quit();
-		return false;
+	{
+		SCOPED_STARTUP_TRACE("SpringApp::InitWindow", "init")
+
+		if (!InitWindow(("Recoil " + SpringVersion::GetFull()).c_str())) {
+			SDL_Quit();
+			return false;
+		}
 	}
 
 	Threading::SetThreadName("recoil-main"); // set default threadname for pstree
 
 	// Init OpenGL
-	globalRendering->PostInit();
-	globalRendering->UpdateGLConfigs();
-	globalRendering->UpdateGLGeometry();
-	globalRendering->InitGLState();
+	{
+		SCOPED_STARTUP_TRACE("SpringApp::InitGL", "init")
+		globalRendering->PostInit();
+		globalRendering->UpdateGLConfigs();
+		globalRendering->UpdateGLGeometry();
+		globalRendering->InitGLState();
+	}
 
 	CCameraHandler::InitStatic();
 	CBitmap::InitPool(configHandler->GetInt("TextureMemPoolSize"));
 
 	UpdateInterfaceGeometry();
-	InitFonts();
+	{
+		SCOPED_STARTUP_TRACE("SpringApp::InitFonts", "init")
+		InitFonts();
+	}
 
 	ClearScreen();
 
-	if (!InitFileSystem())
-		return false;
+	{
+		SCOPED_STARTUP_TRACE("SpringApp::InitFileSystem", "init")
+
+		if (!InitFileSystem())
+			return false;
+	}
 
 	// Affinity
 	Threading::SetThreadScheduler();
@@ -300,7 +329,10 @@ bool SpringApp::Init()
 
 	CNamedTextures::Init();
 	LuaOpenGL::Init();
-	ISound::Initialize(false);
+	{
+		SCOPED_STARTUP_TRACE("ISound::Initialize", "init")
+		ISound::Initialize(false);
+	}
 
 	// Lua socket restrictions
 	CLuaSocketRestrictions::InitStatic();
@@ -575,6 +607,8 @@ void SpringApp::ParseCmdLine(int argc, char* argv[])
 	CTextureAtlas::SetDebug(FLAGS_textureatlas);
 
 	CGameSetup::forceOnlyLocal = FLAGS_onlyLocal;
+	CGame::benchmarkEndFrame = FLAGS_benchmark_frame;
+	CGame::benchmarkFile = FLAGS_benchmark_out;
 
 	// if this fails, configHandler remains null
 	// logOutput's init depends on configHandler
@@ -872,6 +906,8 @@ bool SpringApp::Update()
 	globalRendering->UpdateWindow();
 	globalRendering->UpdateTimer();
 
+	Threading::RunMainThreadTasks();
+
 	#if 0
 	if (activeController == nullptr)
 		return true;
@@ -889,6 +925,10 @@ bool SpringApp::Update()
 
 	// always swap by default, not doing so can upset some drivers
 	globalRendering->SwapBuffers(swap, false);
+
+	if (retc && activeController != nullptr)
+		activeController->PostSwapBuffers();
+
 	return retc;
 }
 
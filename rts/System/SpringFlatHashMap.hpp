@@ -0,0 +1,393 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SPRING_FLAT_HASH_MAP_H_
+#define _SPRING_FLAT_HASH_MAP_H_
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define SPRING_FLAT_HASH_MAP_SSE2
+	#include <emmintrin.h>
+#endif
+
+#include "SpringHash.h"
+
+namespace spring {
+	/**
+	 * Open-addressing map in the style of the SwissTable: the index is split
+	 * into groups of 16 control bytes that hold 7 bits of each key's hash and
+	 * are matched against a probe with one SSE2 compare, so a lookup touches
+	 * one or two cache lines of metadata before looking at any key.
+	 *
+	 * The pairs themselves live in a dense vector (the index only stores
+	 * positions into it), which makes iteration a linear scan and gives an
+	 * order that depends only on the sequence of insertions and erasures:
+	 * new keys are appended, erase moves the last pair into the hole. Unlike
+	 * spring::unordered_map neither the capacity nor clear() affect it, so
+	 * synced code may iterate these freely.
+	 *
+	 * NB: like std::vector, inserting invalidates all iterators and references,
+	 * erasing invalidates those to the erased and to the last element.
+	 */
+	template<typename K, typename V, typename H = spring::synced_hash<K>, typename C = std::equal_to<K>>
+	class flat_hash_map {
+	public:
+		using key_type        = K;
+		using mapped_type     = V;
+		using value_type      = std::pair<K, V>;
+		using size_type       = size_t;
+		using reference       = value_type&;
+		using const_reference = const value_type&;
+
+		using iterator       = typename std::vector<value_type>::iterator;
+		using const_iterator = typename std::vector<value_type>::const_iterator;
+
+	public:
+		flat_hash_map() = default;
+		flat_hash_map(size_t numElems) { reserve(numElems); }
+		flat_hash_map(const flat_hash_map&) = default;
+		flat_hash_map(flat_hash_map&& other) noexcept { swap(other); }
+		flat_hash_map(std::initializer_list<value_type> l) {
+			reserve(l.size());
+
+			for (const value_type& p: l) {
+				try_emplace(p.first, p.second);
+			}
+		}
+
+		flat_hash_map& operator = (const flat_hash_map&) = default;
+		flat_hash_map& operator = (flat_hash_map&& other) noexcept { swap(other); return *this; }
+
+		void swap(flat_hash_map& other) noexcept {
+			std::swap(hasher, other.hasher);
+			std::swap(comp, other.comp);
+			values.swap(other.values);
+			ctrl.swap(other.ctrl);
+			slots.swap(other.slots);
+			std::swap(groupMask, other.groupMask);
+			std::swap(growthLeft, other.growthLeft);
+		}
+
+		iterator begin() { return values.begin(); }
+		iterator end() { return values.end(); }
+		const_iterator begin() const { return values.begin(); }
+		const_iterator end() const { return values.end(); }
+		const_iterator cbegin() const { return values.cbegin(); }
+		const_iterator cend() const { return values.cend(); }
+
+		size_t size() const { return values.size(); }
+		bool empty() const { return values.empty(); }
+
+		iterator find(const K& key) {
+			const size_t slot = FindSlot(key);
+			return (slot == NO_SLOT)? end(): (begin() + slots[slot]);
+		}
+		const_iterator find(const K& key) const {
+			const size_t slot = FindSlot(key);
+			return (slot == NO_SLOT)? end(): (begin() + slots[slot]);
+		}
+
+		bool contains(const K& key) const { return (FindSlot(key) != NO_SLOT); }
+		size_t count(const K& key) const { return (FindSlot(key) != NO_SLOT); }
+
+		V* try_get(const K& key) {
+			const size_t slot = FindSlot(key);
+			return (slot == NO_SLOT)? nullptr: &values[slots[slot]].second;
+		}
+		const V* try_get(const K& key) const {
+			const size_t slot = FindSlot(key);
+			return (slot == NO_SLOT)? nullptr: &values[slots[slot]].second;
+		}
+
+		const V get_or_return_default(const K& key) const {
+			const V* v = try_get(key);
+			return (v != nullptr)? *v: V();
+		}
+
+
+		template<typename... Args>
+		std::pair<iterator, bool> try_emplace(const K& key, Args&&... args) {
+			const uint64_t hash = Hash(key);
+			const size_t slot = FindSlot(key, hash);
+
+			if (slot != NO_SLOT)
+				return {begin() + slots[slot], false};
+
+			InsertIndex(hash);
+			values.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+			return {end() - 1, true};
+		}
+
+		template<typename... Args>
+		std::pair<iterator, bool> emplace(const K& key, Args&&... args) { return try_emplace(key, std::forward<Args>(args)...); }
+
+		std::pair<iterator, bool> insert(const value_type& p) { return try_emplace(p.first, p.second); }
+
+		template<typename Iter>
+		void insert(Iter first, Iter last) {
+			for (; first != last; ++first) {
+				try_emplace(first->first, first->second);
+			}
+		}
+
+		// contains(key) MUST be false
+		void insert_unique(K&& key, V&& value) {
+			assert(!contains(key));
+
+			InsertIndex(Hash(key));
+			values.emplace_back(std::move(key), std::move(value));
+		}
+		void insert_unique(value_type&& p) { insert_unique(std::move(p.first), std::move(p.second)); }
+
+		V& operator [] (const K& key) { return (try_emplace(key).first->second); }
+
+
+		size_t erase(const K& key) {
+			const size_t slot = FindSlot(key);
+
+			if (slot == NO_SLOT)
+				return 0;
+
+			EraseSlot(slot);
+			return 1;
+		}
+
+		// returns an iterator to the pair that took the place of <it>, or end()
+		iterator erase(const_iterator it) {
+			const size_t index = it - cbegin();
+
+			EraseSlot(FindIndexSlot(Hash(it->first), index));
+			return (begin() + index);
+		}
+
+		// keeps the capacity; unlike spring::unordered_map this is safe for synced maps
+		void clear() {
+			values.clear();
+
+			if (ctrl.empty())
+				return;
+
+			std::memset(ctrl.data(), CTRL_EMPTY, ctrl.size());
+			growthLeft = MaxLoad(groupMask + 1);
+		}
+
+		void reserve(size_t numElems) {
+			if (numElems > (values.size() + growthLeft))
+				Rehash(NumGroupsFor(numElems));
+
+			values.reserve(numElems);
+		}
+
+	private:
+		static constexpr size_t GROUP_SIZE = 16;
+		static constexpr size_t NO_SLOT = size_t(-1);
+
+		// full slots hold the top seven hash bits, i.e. never have the sign bit set
+		static constexpr int8_t CTRL_EMPTY = -128;
+		static constexpr int8_t CTRL_DELETED = -2;
+
+		// at most 7/8 of all slots are used (live or deleted)
+		static constexpr size_t MaxLoad(size_t numGroups) { return (numGroups * GROUP_SIZE * 7) / 8; }
+		static size_t NumGroupsFor(size_t numElems) {
+			return std::bit_ceil(std::max<size_t>(1, (numElems * 8 + GROUP_SIZE * 7 - 1) / (GROUP_SIZE * 7)));
+		}
+
+		struct Group {
+			explicit Group(const int8_t* p) {
+			#ifdef SPRING_FLAT_HASH_MAP_SSE2
+				bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			#else
+				std::memcpy(bytes, p, GROUP_SIZE);
+			#endif
+			}
+
+			// one bit per matching slot, lowest slot first
+			uint32_t Match(int8_t c) const {
+			#ifdef SPRING_FLAT_HASH_MAP_SSE2
+				return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(c), bytes)));
+			#else
+				uint32_t mask = 0;
+				for (size_t i = 0; i < GROUP_SIZE; i++) {
+					mask |= (uint32_t(bytes[i] == c) << i);
+				}
+				return mask;
+			#endif
+			}
+
+			uint32_t MatchEmpty() const { return Match(CTRL_EMPTY); }
+			uint32_t MatchEmptyOrDeleted() const {
+			#ifdef SPRING_FLAT_HASH_MAP_SSE2
+				return static_cast<uint32_t>(_mm_movemask_epi8(bytes));
+			#else
+				uint32_t mask = 0;
+				for (size_t i = 0; i < GROUP_SIZE; i++) {
+					mask |= (uint32_t(bytes[i] < 0) << i);
+				}
+				return mask;
+			#endif
+			}
+
+		#ifdef SPRING_FLAT_HASH_MAP_SSE2
+			__m128i bytes;
+		#else
+			int8_t bytes[GROUP_SIZE];
+		#endif
+		};
+
+		// synced_hash is mostly the identity for integers, spread it over all bits
+		uint64_t Hash(const K& key) const { return (static_cast<uint64_t>(hasher(key)) * 0x9E3779B97F4A7C15ull); }
+
+		static size_t H1(uint64_t hash) { return static_cast<size_t>(hash >> 25); }
+		static int8_t H2(uint64_t hash) { return static_cast<int8_t>(hash >> 57); }
+
+		// groups are visited in triangular order, which covers all of them for
+		// power-of-two counts; <f> returns true once the probe can stop
+		template<typename F>
+		void Probe(uint64_t hash, F&& f) const {
+			for (size_t group = H1(hash) & groupMask, step = 1; !f(group * GROUP_SIZE, Group(&ctrl[group * GROUP_SIZE])); group = (group + step++) & groupMask) {
+			}
+		}
+
+		size_t FindSlot(const K& key) const { return (values.empty()? NO_SLOT: FindSlot(key, Hash(key))); }
+		size_t FindSlot(const K& key, uint64_t hash) const {
+			if (values.empty())
+				return NO_SLOT;
+
+			const int8_t h2 = H2(hash);
+
+			for (size_t group = H1(hash) & groupMask, step = 1; ; group = (group + step++) & groupMask) {
+				const Group g(&ctrl[group * GROUP_SIZE]);
+
+				for (uint32_t mask = g.Match(h2); mask != 0; mask &= (mask - 1)) {
+					const size_t slot = group * GROUP_SIZE + std::countr_zero(mask);
+
+					if (comp(values[slots[slot]].first, key))
+						return slot;
+				}
+
+				// a group with free slots ends every chain passing through it
+				if (g.MatchEmpty() != 0)
+					return NO_SLOT;
+			}
+		}
+
+		// slot referring to values[index], which must exist
+		size_t FindIndexSlot(uint64_t hash, size_t index) const {
+			const int8_t h2 = H2(hash);
+			size_t found = NO_SLOT;
+
+			Probe(hash, [&](size_t base, const Group& g) {
+				for (uint32_t mask = g.Match(h2); mask != 0; mask &= (mask - 1)) {
+					const size_t slot = base + std::countr_zero(mask);
+
+					if (slots[slot] == index) {
+						found = slot;
+						return true;
+					}
+				}
+
+				return false;
+			});
+
+			assert(found != NO_SLOT);
+			return found;
+		}
+
+		size_t FindFreeSlot(uint64_t hash) const {
+			size_t found = NO_SLOT;
+
+			Probe(hash, [&](size_t base, const Group& g) {
+				const uint32_t mask = g.MatchEmptyOrDeleted();
+
+				if (mask == 0)
+					return false;
+
+				found = base + std::countr_zero(mask);
+				return true;
+			});
+
+			return found;
+		}
+
+		// claims a slot for the pair about to be appended to <values>
+		void InsertIndex(uint64_t hash) {
+			if (growthLeft == 0) {
+				const size_t numGroups = ctrl.size() / GROUP_SIZE;
+
+				// mostly deleted slots: rebuild in place, otherwise grow
+				if (numGroups != 0 && (values.size() * 16) <= (MaxLoad(numGroups) * 13)) {
+					Rehash(numGroups);
+				} else {
+					Rehash(std::max<size_t>(1, numGroups * 2));
+				}
+			}
+
+			const size_t slot = FindFreeSlot(hash);
+
+			growthLeft -= (ctrl[slot] == CTRL_EMPTY);
+			ctrl[slot] = H2(hash);
+			slots[slot] = static_cast<uint32_t>(values.size());
+		}
+
+		void EraseSlot(size_t slot) {
+			const size_t index = slots[slot];
+			const size_t last = values.size() - 1;
+
+			// chains passing this group already end in it if it has an empty
+			// slot, otherwise the slot has to become a tombstone
+			if (Group(&ctrl[slot & ~(GROUP_SIZE - 1)]).MatchEmpty() != 0) {
+				ctrl[slot] = CTRL_EMPTY;
+				growthLeft += 1;
+			} else {
+				ctrl[slot] = CTRL_DELETED;
+			}
+
+			if (index != last) {
+				slots[FindIndexSlot(Hash(values[last].first), last)] = static_cast<uint32_t>(index);
+				values[index] = std::move(values[last]);
+			}
+
+			values.pop_back();
+		}
+
+		void Rehash(size_t numGroups) {
+			ctrl.assign(numGroups * GROUP_SIZE, CTRL_EMPTY);
+			slots.assign(numGroups * GROUP_SIZE, 0);
+
+			groupMask = numGroups - 1;
+			growthLeft = MaxLoad(numGroups);
+
+			for (size_t i = 0, n = values.size(); i < n; i++) {
+				const uint64_t hash = Hash(values[i].first);
+				const size_t slot = FindFreeSlot(hash);
+
+				ctrl[slot] = H2(hash);
+				slots[slot] = static_cast<uint32_t>(i);
+			}
+
+			growthLeft -= values.size();
+		}
+
+	private:
+		H hasher;
+		C comp;
+
+		std::vector<value_type> values;
+		std::vector<int8_t> ctrl;
+		std::vector<uint32_t> slots;
+
+		size_t groupMask = 0;
+		size_t growthLeft = 0;
+	};
+};
+
+#endif
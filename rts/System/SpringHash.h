@@ -4,12 +4,25 @@
 #define _SPRING_HASH_H_
 
 #include "lib/xxhash/xxh3.h"
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <type_traits>
 #include <memory>
 #include <bit>
 
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+	#define SPRING_HASH_HW_CRC32C
+	#include <nmmintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define SPRING_HASH_TARGET_SSE42
+	#else
+		#define SPRING_HASH_TARGET_SSE42 __attribute__((target("sse4.2")))
+	#endif
+#endif
+
 namespace spring {
 	static inline uint32_t LiteHash(const void* p, unsigned size, uint32_t cs0 = 0) {
 		return static_cast<uint32_t>(XXH3_64bits_withSeed(p, static_cast<size_t>(size), static_cast<XXH64_hash_t>(cs0)));
@@ -22,6 +35,85 @@ namespace spring {
 	static inline uint32_t LiteHash(const T* p, uint32_t cs0 = 0) { return LiteHash(p, sizeof(T), cs0); }
 
 
+	// CRC32C (Castagnoli, reflected) without pre- or post-inversion, so it can be chained
+	// through <crc>; the SSE4.2 instruction and the table yield the same value, clients
+	// with and without it stay in sync
+	namespace detail {
+		inline constexpr std::array<uint32_t, 256> CRC32C_TABLE = []() {
+			std::array<uint32_t, 256> table = {};
+
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t c = i;
+
+				for (int k = 0; k < 8; k++) {
+					c = (c >> 1) ^ (0x82F63B78u & (0u - (c & 1u)));
+				}
+
+				table[i] = c;
+			}
+
+			return table;
+		}();
+
+		static inline uint32_t CRC32CSoft(const uint8_t* p, size_t size, uint32_t crc) {
+			for (size_t i = 0; i < size; i++) {
+				crc = CRC32C_TABLE[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+			}
+
+			return crc;
+		}
+
+		#ifdef SPRING_HASH_HW_CRC32C
+		SPRING_HASH_TARGET_SSE42 static inline uint32_t CRC32CHard(const uint8_t* p, size_t size, uint32_t crc) {
+			#if defined(__x86_64__) || defined(_M_X64)
+			uint64_t crc64 = crc;
+
+			for (; size >= sizeof(uint64_t); p += sizeof(uint64_t), size -= sizeof(uint64_t)) {
+				uint64_t v;
+				memcpy(&v, p, sizeof(v));
+				crc64 = _mm_crc32_u64(crc64, v);
+			}
+
+			crc = static_cast<uint32_t>(crc64);
+			#endif
+
+			for (; size >= sizeof(uint32_t); p += sizeof(uint32_t), size -= sizeof(uint32_t)) {
+				uint32_t v;
+				memcpy(&v, p, sizeof(v));
+				crc = _mm_crc32_u32(crc, v);
+			}
+
+			for (; size > 0; p += 1, size -= 1) {
+				crc = _mm_crc32_u8(crc, *p);
+			}
+
+			return crc;
+		}
+
+		static inline bool HaveHardCRC32C() {
+			#ifdef _MSC_VER
+			int regs[4] = {0, 0, 0, 0};
+			__cpuid(regs, 1);
+			return ((regs[2] >> 20) & 1);
+			#else
+			return __builtin_cpu_supports("sse4.2");
+			#endif
+		}
+		#endif
+	}
+
+	static inline uint32_t CRC32C(const void* p, size_t size, uint32_t crc = 0) {
+		#ifdef SPRING_HASH_HW_CRC32C
+		static const bool haveHardCRC = detail::HaveHardCRC32C();
+
+		if (haveHardCRC)
+			return detail::CRC32CHard(static_cast<const uint8_t*>(p), size, crc);
+		#endif
+
+		return detail::CRC32CSoft(static_cast<const uint8_t*>(p), size, crc);
+	}
+
+
 	template<typename T>
 	struct synced_hash {
 		uint32_t operator()(const T& s) const;
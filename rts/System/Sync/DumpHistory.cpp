@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <fstream>
+#include <map>
 
 #include "DumpHistory.h"
 #include "SyncChecker.h"
@@ -38,11 +39,26 @@ void DumpHistory(std::fstream& file, int frameNum, bool serverRequest)
 
 	file << std::format("internal frame checksums ({}):\n", frameNum);
 
+	// symbols are only looked up here, once per distinct callsite
+	std::map<unsigned, unsigned> callsiteIDs;
+
+	const auto DumpRecord = [&](const CSyncChecker::HistoryRecord& record) {
+		const auto it = callsiteIDs.emplace(record.callsite, callsiteIDs.size()).first;
+		file << std::format("\t{:08x} @{}\n", record.checksum, it->second);
+	};
+
 	for (int i = startIndex; i < startIndex + firstRangeSize; ++i) {
-		file << std::format("\t{:08x}\n", data[i]);
+		DumpRecord(data[i]);
 	}
 	for (int i = 0; i < secondRangeSize; ++i) {
-		file << std::format("\t{:08x}\n", data[i]);
+		DumpRecord(data[i]);
+	}
+
+	// ids follow first use, so the dumps of clients in sync match textually up to the first diverging call
+	file << std::format("callsites ({}):\n", callsiteIDs.size());
+
+	for (const auto& [callsite, id]: callsiteIDs) {
+		file << std::format("\t@{}: {}\n", id, CSyncChecker::ResolveCallsite(callsite));
 	}
 #endif // SYNC_HISTORY
 }
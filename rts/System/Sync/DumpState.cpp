@@ -1,15 +1,23 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <cstring>
+#include <deque>
 #include <string>
 #include <fstream>
+#include <memory>
+#include <type_traits>
 #include <vector>
 #include <list>
 
+#include <zlib.h>
+
 #include "fmt/format.h"
 #include "fmt/printf.h"
 
 #include "DumpState.h"
+#include "DumpStateFormat.h"
 #include "DumpHistory.h"
+#include "SyncChecker.h"
 
 #include "Game/Game.h"
 #include "Game/GameSetup.h"
@@ -39,12 +47,20 @@
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "Map/ReadMap.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/Log/ILog.h"
 #include "System/SpringHash.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
+
+CONFIG(bool, DumpStateBinary).defaultValue(false).description("Write state dumps (/dumpstate and desync reports) in the compact binary format, from a worker thread; compare two of them with the dumpstatediff tool.");
 
 static bool onlyHash = true;
 
+// past this much serialized state waiting to be written the sim thread stalls
+static constexpr size_t MAX_QUEUED_DUMP_BYTES = 64 * 1024 * 1024;
+
 namespace {
 	inline std::string TapFloats(const float v) {
 		std::ostringstream str;
@@ -111,12 +127,404 @@ namespace {
 }
 
 
+/**
+ * Compresses and writes the serialized frames of a binary dump on its own
+ * thread. Frame buffers are recycled once written, so a long dump keeps at
+ * most MAX_QUEUED_DUMP_BYTES (plus the buffer being filled) in memory.
+ */
+class CBinaryDumpWriter
+{
+public:
+	~CBinaryDumpWriter() {
+		assert(!thread.joinable());
+
+		if (file != nullptr)
+			gzclose(file);
+	}
+
+	bool Open(const std::string& fileName) {
+		// favour speed, these files are short-lived
+		return ((file = gzopen(fileName.c_str(), "wb1")) != nullptr);
+	}
+
+	void Start(const std::shared_ptr<CBinaryDumpWriter>& self) {
+		thread = spring::thread([self]() { self->Run(); });
+	}
+
+	std::vector<std::uint8_t> GetBuffer() {
+		std::lock_guard<spring::mutex> lock(jobMutex);
+
+		if (freeBuffers.empty())
+			return {};
+
+		std::vector<std::uint8_t> buffer = std::move(freeBuffers.back());
+		freeBuffers.pop_back();
+		buffer.clear();
+		return buffer;
+	}
+
+	void Push(std::vector<std::uint8_t>&& buffer) {
+		{
+			std::unique_lock<spring::mutex> lock(jobMutex);
+
+			spaceCond.wait(lock, [&]() { return (queuedBytes <= MAX_QUEUED_DUMP_BYTES); });
+
+			queuedBytes += buffer.size();
+			jobs.push_back(std::move(buffer));
+		}
+
+		jobCond.notify_one();
+	}
+
+	void Finish() {
+		{
+			std::lock_guard<spring::mutex> lock(jobMutex);
+			finished = true;
+		}
+
+		jobCond.notify_one();
+	}
+
+	spring::thread&& GetThread() { return std::move(thread); }
+
+private:
+	void Run() {
+		Threading::SetThreadName("dumpstate");
+
+		while (true) {
+			std::vector<std::uint8_t> buffer;
+
+			{
+				std::unique_lock<spring::mutex> lock(jobMutex);
+
+				jobCond.wait(lock, [&]() { return (!jobs.empty() || finished); });
+
+				if (jobs.empty())
+					break;
+
+				buffer = std::move(jobs.front());
+				jobs.pop_front();
+			}
+
+			if (gzwrite(file, buffer.data(), buffer.size()) != int(buffer.size()))
+				LOG_L(L_ERROR, "[%s] error writing state dump (%s)", __func__, gzerror(file, nullptr));
+
+			{
+				std::lock_guard<spring::mutex> lock(jobMutex);
+
+				queuedBytes -= buffer.size();
+
+				if (freeBuffers.size() < 4)
+					freeBuffers.push_back(std::move(buffer));
+			}
+
+			spaceCond.notify_one();
+		}
+
+		gzclose(file);
+		file = nullptr;
+	}
+
+private:
+	gzFile file = nullptr;
+
+	spring::thread thread;
+	spring::mutex jobMutex;
+	spring::condition_variable jobCond;
+	spring::condition_variable spaceCond;
+
+	std::deque< std::vector<std::uint8_t> > jobs;
+	std::vector< std::vector<std::uint8_t> > freeBuffers;
+
+	size_t queuedBytes = 0;
+	bool finished = false;
+};
+
+
+namespace {
+	// folds sub-objects of varying count into one field of a fixed-size record
+	struct StateHasher {
+		template<typename T> StateHasher& operator << (const T& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			hash = spring::LiteHash(v, hash);
+			return *this;
+		}
+
+		std::uint32_t hash = 0;
+	};
+
+	inline void TapFloats(float (&dst)[3], const float3& v) {
+		dst[0] = v.x;
+		dst[1] = v.y;
+		dst[2] = v.z;
+	}
+
+	template<typename T> void AppendRecords(std::vector<std::uint8_t>& buffer, const T* records, size_t count) {
+		const size_t size = buffer.size();
+
+		buffer.resize(size + count * sizeof(T));
+		memcpy(buffer.data() + size, records, count * sizeof(T));
+	}
+
+	void FillUnitRecord(const CUnit* u, DumpStateFormat::UnitRecord& r) {
+		r.id = u->id;
+		r.unitDefID = u->unitDef->id;
+
+		TapFloats(r.pos, u->pos);
+		TapFloats(r.speed, u->speed);
+		TapFloats(r.xdir, u->rightdir);
+		TapFloats(r.ydir, u->updir);
+		TapFloats(r.zdir, u->frontdir);
+		TapFloats(r.midPos, u->midPos);
+
+		r.health = u->health;
+		r.experience = u->experience;
+		r.heading = u->heading;
+		r.mapSquare = u->mapSquare;
+		r.physicalState = u->physicalState;
+		r.fireState = u->fireState;
+		r.moveState = u->moveState;
+		r.flags = (u->isDead << 0) | (u->activated << 1) | (u->inBuildStance << 2);
+
+		{
+			StateHasher h;
+
+			for (const LocalModelPiece& lmp: u->localModel.pieces) {
+				h << lmp.GetPosition() << lmp.GetRotation() << lmp.GetScriptVisible();
+			}
+
+			r.piecesHash = h.hash;
+		}
+		{
+			StateHasher h;
+
+			for (const CWeapon* w: u->weapons) {
+				h << w->weaponNum << float3(w->weaponDir) << float3(w->aimFromPos) << float3(w->relAimFromPos);
+				h << float3(w->weaponMuzzlePos) << float3(w->relWeaponMuzzlePos);
+			}
+
+			r.weaponsHash = h.hash;
+		}
+		{
+			const CCommandAI* cai = u->commandAI;
+			StateHasher h;
+
+			for (const Command& c: cai->commandQue) {
+				h << c.GetID() << c.GetTag() << c.GetOpts();
+
+				for (unsigned int n = 0; n < c.GetNumParams(); n++) {
+					h << c.GetParam(n);
+				}
+			}
+
+			r.orderTargetID = (cai->orderTarget != nullptr)? cai->orderTarget->id: -1;
+			r.numCommands = cai->commandQue.size();
+			r.commandsHash = h.hash;
+		}
+		{
+			const AMoveType* amt = u->moveType;
+			StateHasher h;
+
+			h << float3(amt->goalPos) << float3(amt->oldPos) << float3(amt->oldSlowUpdatePos);
+			h << amt->GetMaxSpeed() << amt->GetMaxWantedSpeed() << amt->progressState;
+
+			if (const auto* gmt = dynamic_cast<const CGroundMoveType*>(amt); gmt != nullptr)
+				h << float3(gmt->GetCurrWayPoint()) << float3(gmt->GetNextWayPoint());
+
+			r.moveTypeHash = h.hash;
+		}
+		{
+			StateHasher h;
+
+			if (const CBuilder* b = dynamic_cast<const CBuilder*>(u); b != nullptr) {
+				const auto SolidObjectID = [](const CSolidObject* so) { return ((so != nullptr)? so->id: -1); };
+
+				h << SolidObjectID(b->curResurrect) << b->lastResurrected << SolidObjectID(b->curBuild);
+				h << SolidObjectID(b->curCapture) << SolidObjectID(b->curReclaim) << b->reclaimingUnit;
+				h << SolidObjectID(b->helpTerraform) << b->terraforming << b->terraformHelp << b->myTerraformLeft;
+				h << b->terraformType << b->tx1 << b->tx2 << b->tz1 << b->tz2;
+				h << float3(b->terraformCenter) << b->terraformRadius;
+			}
+
+			r.builderHash = h.hash;
+		}
+	}
+
+	void FillFeatureRecord(const CFeature* f, DumpStateFormat::FeatureRecord& r) {
+		r.id = f->id;
+		r.featureDefID = f->def->id;
+
+		TapFloats(r.pos, f->pos);
+		TapFloats(r.speed, f->speed);
+		TapFloats(r.xdir, f->rightdir);
+		TapFloats(r.ydir, f->updir);
+		TapFloats(r.zdir, f->frontdir);
+		TapFloats(r.midPos, f->midPos);
+
+		r.health = f->health;
+		r.reclaimLeft = f->reclaimLeft;
+	}
+
+	void FillProjectileRecord(const CProjectile* p, DumpStateFormat::ProjectileRecord& r) {
+		r.id = p->id;
+		r.ownerID = p->GetOwnerID();
+
+		TapFloats(r.pos, p->pos);
+		TapFloats(r.dir, p->dir);
+		TapFloats(r.speed, p->speed);
+
+		r.weapon = p->weapon;
+		r.piece = p->piece;
+		r.checkCol = p->checkCol;
+		r.deleteMe = p->deleteMe;
+	}
+
+	void FillFileHeader(DumpStateFormat::FileHeader& header, int minFrameNum, int maxFrameNum) {
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, DumpStateFormat::MAGIC, sizeof(header.magic));
+		memcpy(header.gameID, game->gameID, sizeof(header.gameID));
+
+		strncpy(header.syncVersion, SpringVersion::GetSync().c_str(), sizeof(header.syncVersion) - 1);
+		strncpy(header.mapName, gameSetup->mapName.c_str(), sizeof(header.mapName) - 1);
+		strncpy(header.modName, gameSetup->modName.c_str(), sizeof(header.modName) - 1);
+
+		header.version = DumpStateFormat::VERSION;
+		header.minFrame = minFrameNum;
+		header.maxFrame = maxFrameNum;
+		header.initSeed = gsRNG.GetInitSeed();
+	}
+
+	/**
+	 * Serializes the current frame into <buffer>. The sim thread is parked in
+	 * here for the whole time, so the objects can be read from the pool threads
+	 * without copying them first; only fixed-size records are produced, all the
+	 * formatting is left to the offline tool.
+	 */
+	void DumpStateBinary(std::vector<std::uint8_t>& buffer) {
+		using namespace DumpStateFormat;
+
+		static std::vector<const CFeature*> features;
+		static std::vector<const CProjectile*> projectiles;
+
+		static std::vector<UnitRecord> unitRecords;
+		static std::vector<FeatureRecord> featureRecords;
+		static std::vector<ProjectileRecord> projectileRecords;
+
+		const std::vector<CUnit*>& activeUnits = unitHandler.GetActiveUnits();
+
+		features.clear();
+		projectiles.clear();
+
+		for (const int featureID: featureHandler.GetActiveFeatureIDs()) {
+			features.push_back(featureHandler.GetFeature(featureID));
+		}
+		for (const CProjectile* p: projectileHandler.GetActiveProjectiles(true)) {
+			projectiles.push_back(p);
+		}
+
+		unitRecords.resize(activeUnits.size());
+		featureRecords.resize(features.size());
+		projectileRecords.resize(projectiles.size());
+
+		for_mt(0, activeUnits.size(), [&](const int i) { FillUnitRecord(activeUnits[i], unitRecords[i]); });
+		for_mt(0, features.size(), [&](const int i) { FillFeatureRecord(features[i], featureRecords[i]); });
+		for_mt(0, projectiles.size(), [&](const int i) { FillProjectileRecord(projectiles[i], projectileRecords[i]); });
+
+		FrameHeader frameHeader;
+		frameHeader.frameNum = gs->frameNum;
+		frameHeader.randSeed = gsRNG.GetLastSeed();
+		#ifdef SYNCCHECK
+		frameHeader.syncChecksum = CSyncChecker::GetChecksum();
+		#else
+		frameHeader.syncChecksum = 0;
+		#endif
+		frameHeader.numUnits = unitRecords.size();
+		frameHeader.numFeatures = featureRecords.size();
+		frameHeader.numProjectiles = projectileRecords.size();
+		frameHeader.numTeams = teamHandler.ActiveTeams();
+		frameHeader.numAllyTeams = teamHandler.ActiveAllyTeams();
+
+		AppendRecords(buffer, &frameHeader, 1);
+		AppendRecords(buffer, unitRecords.data(), unitRecords.size());
+		AppendRecords(buffer, featureRecords.data(), featureRecords.size());
+		AppendRecords(buffer, projectileRecords.data(), projectileRecords.size());
+
+		for (int a = 0; a < teamHandler.ActiveTeams(); ++a) {
+			const CTeam* t = teamHandler.Team(a);
+			const TeamRecord r = {
+				t->teamNum,
+				t->res.metal, t->res.energy,
+				t->resPull.metal, t->resPull.energy,
+				t->resIncome.metal, t->resIncome.energy,
+				t->resExpense.metal, t->resExpense.energy,
+			};
+
+			AppendRecords(buffer, &r, 1);
+		}
+
+		const std::array<ILosType*, NUM_LOS_TYPES> losTypes = {
+			&losHandler->los,
+			&losHandler->airLos,
+			&losHandler->radar,
+			&losHandler->sonar,
+			&losHandler->seismic,
+			&losHandler->jammer,
+			&losHandler->sonarJammer
+		};
+
+		for (int a = 0; a < teamHandler.ActiveAllyTeams(); ++a) {
+			AllyTeamRecord r;
+			r.id = a;
+
+			for (int lti = 0; lti < NUM_LOS_TYPES; ++lti) {
+				const auto lt = losTypes[lti];
+				const auto* lm = &lt->losMaps[a].front();
+
+				r.losHashes[lti] = spring::LiteHash(lm, sizeof(*lm) * lt->size.x * lt->size.y, 0);
+			}
+
+			AppendRecords(buffer, &r, 1);
+		}
+
+		{
+			const auto heightmap = readMap->GetCornerHeightMapSynced();
+			const auto centerNormals = readMap->GetCenterNormalsSynced();
+			const auto faceNormals = readMap->GetFaceNormalsSynced();
+			const auto smoothMesh = smoothGround.GetMeshData();
+
+			MapRecord r;
+			r.heightMapHash = spring::LiteHash(heightmap, sizeof(heightmap[0]) * mapDims.mapxp1 * mapDims.mapyp1, 0);
+			r.centerNormalsHash = spring::LiteHash(centerNormals, sizeof(centerNormals[0]) * mapDims.mapx * mapDims.mapy, 0);
+			r.faceNormalsHash = spring::LiteHash(faceNormals, sizeof(faceNormals[0]) * mapDims.mapx * mapDims.mapy * 2, 0);
+			r.smoothMeshHash = spring::LiteHash(smoothMesh, sizeof(smoothMesh[0]) * smoothGround.GetMaxX() * smoothGround.GetMaxY(), 0);
+			r.cobTime = cobEngine->GetCurrTime();
+			r.numCobThreads = cobEngine->GetThreadSlots().size();
+
+			StateHasher h;
+
+			for (const auto& [tid, slot]: cobEngine->GetThreadSlots()) {
+				const CCobThread& thread = cobEngine->GetThreadSlab()[slot];
+				const int ownerID = (thread.cobInst->GetUnit() != nullptr)? thread.cobInst->GetUnit()->id: -1;
+
+				h << tid << thread.GetID() << thread.GetWakeTime() << ownerID << thread.GetState();
+				h << thread.GetSignalMask() << thread.GetRetCode() << thread.IsDead() << thread.IsWaiting();
+			}
+
+			r.cobThreadsHash = h.hash;
+
+			AppendRecords(buffer, &r, 1);
+		}
+	}
+}
+
+
 void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod, std::optional<bool> outputFloats, std::optional<int> historyFrame, bool serverRequest)
 {
 	if (outputFloats.has_value())
 		onlyHash = !outputFloats.value();
 
 	static std::fstream file;
+	static std::shared_ptr<CBinaryDumpWriter> binaryWriter;
 	static int gMinFrameNum = -1;
 	static int gMaxFrameNum = -1;
 	static int gFramePeriod =  1;
@@ -143,6 +551,11 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod, std::
 			file.flush();
 			file.close();
 		}
+		if (binaryWriter != nullptr) {
+			binaryWriter->Finish();
+			ThreadPool::AddExtJob(binaryWriter->GetThread());
+			binaryWriter.reset();
+		}
 
 		gHistoryFrame = historyFrame.value_or(-1);
 
@@ -153,11 +566,35 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod, std::
 		name += IntToString(gMinFrameNum);
 		name += "-";
 		name += IntToString(gMaxFrameNum);
-		name += "].txt";
+		name += "]";
 
-		file.open(name.c_str(), std::ios::out);
+		if (configHandler->GetBool("DumpStateBinary")) {
+			binaryWriter = std::make_shared<CBinaryDumpWriter>();
 
-		if (file.is_open()) {
+			if (binaryWriter->Open(name + ".sds")) {
+				DumpStateFormat::FileHeader header;
+				std::vector<std::uint8_t> buffer;
+
+				FillFileHeader(header, gMinFrameNum, gMaxFrameNum);
+				AppendRecords(buffer, &header, 1);
+
+				binaryWriter->Start(binaryWriter);
+				binaryWriter->Push(std::move(buffer));
+			} else {
+				binaryWriter.reset();
+			}
+
+			// the checksum history stays text, it only gets written once
+			if (gHistoryFrame > -1)
+				name += "-history";
+		}
+
+		name += ".txt";
+
+		if (binaryWriter == nullptr || gHistoryFrame > -1)
+			file.open(name.c_str(), std::ios::out);
+
+		if (file.is_open() && binaryWriter == nullptr) {
 			file << " mapName: " << gameSetup->mapName << "\n";
 			file << " modName: " << gameSetup->modName << "\n";
 			file << "minFrame: " << gMinFrameNum << "\n";
@@ -169,7 +606,37 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod, std::
 			file << " syncVer: " << SpringVersion::GetSync() << "\n";
 		}
 
-		LOG("[%s] using dump-file \"%s\"", __func__, name.c_str());
+		LOG("[%s] using dump-file \"%s%s\"", __func__, name.c_str(), (binaryWriter != nullptr)? " (binary: .sds)": "");
+	}
+
+	if (binaryWriter != nullptr) {
+		if (gs->frameNum < gMinFrameNum)
+			return;
+
+		if (gs->frameNum <= gMaxFrameNum && (gs->frameNum % gFramePeriod) == 0) {
+			std::vector<std::uint8_t> buffer = binaryWriter->GetBuffer();
+
+			DumpStateBinary(buffer);
+			binaryWriter->Push(std::move(buffer));
+		}
+
+		if (gs->frameNum < gMaxFrameNum)
+			return;
+
+		if (gHistoryFrame > -1 && file.is_open()) {
+			DumpHistory(file, gHistoryFrame, serverRequest);
+			file.close();
+		}
+
+		// let the writer drain in the background, the sim does not wait for it
+		binaryWriter->Finish();
+		ThreadPool::AddExtJob(binaryWriter->GetThread());
+		binaryWriter.reset();
+
+		gMinFrameNum = -1;
+		gMaxFrameNum = -1;
+		gFramePeriod =  1;
+		return;
 	}
 
 	if (file.bad() || !file.is_open())
@@ -461,8 +928,9 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod, std::
 	{
 		file << "\tCobEngine:\n";
 		file << "\t\tcurrentTime: " << cobEngine->GetCurrTime();
-		file << "\t\tCobThreads: " << cobEngine->GetThreadInstances().size() << "\n";
-		for (const auto& [tid, thread] : cobEngine->GetThreadInstances()) {
+		file << "\t\tCobThreads: " << cobEngine->GetThreadSlots().size() << "\n";
+		for (const auto& [tid, slot] : cobEngine->GetThreadSlots()) {
+			const CCobThread& thread = cobEngine->GetThreadSlab()[slot];
 			auto ownerID = thread.cobInst->GetUnit() ? thread.cobInst->GetUnit()->id : -1;
 			file << "\t\t\tid: " << tid << " t.id " << thread.GetID() << " t.wt " << thread.GetWakeTime()
 				 << " owner " << ownerID
@@ -477,13 +945,11 @@ void DumpState(int newMinFrameNum, int newMaxFrameNum, int newFramePeriod, std::
 		}
 		file << "\n";
 
-		auto zzzThreads = cobEngine->GetSleepingThreadIDs(); //copied on purpose
+		const auto zzzThreads = cobEngine->GetSleepingThreadIDs();
 		file << "\t\tSleepingThreads: " << zzzThreads.size();
 		file << "\t\t\twts|ids:";
-		while (!zzzThreads.empty()) {
-			const auto& zt = zzzThreads.top();
+		for (const auto& zt : zzzThreads) {
 			file << " " << zt.wt << "|" << zt.id;
-			zzzThreads.pop();
 		}
 		file << "\n";
 	}
@@ -0,0 +1,133 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DUMPSTATE_FORMAT_H
+#define DUMPSTATE_FORMAT_H
+
+#include <cstdint>
+
+/**
+ * Layout of the binary state dumps (DumpStateBinary=1), shared between the
+ * engine and tools/DumpStateDiff; plain little-endian structs, no engine types.
+ *
+ * A dump is a gzip stream holding one FileHeader followed by per-frame blocks:
+ *   FrameHeader
+ *   UnitRecord       [numUnits]
+ *   FeatureRecord    [numFeatures]
+ *   ProjectileRecord [numProjectiles]
+ *   TeamRecord       [numTeams]
+ *   AllyTeamRecord   [numAllyTeams]
+ *   MapRecord
+ *
+ * Records appear in simulation order, which is itself synced. Sub-objects that
+ * vary in count (pieces, weapons, commands, ...) are folded into per-record
+ * hashes so every record has a fixed size; a mismatching hash means the text
+ * dump of that frame has to be looked at for details.
+ */
+namespace DumpStateFormat {
+	static constexpr char MAGIC[8] = "SPRDUMP";
+	static constexpr std::int32_t VERSION = 1;
+	static constexpr int NUM_LOS_TYPES = 7;
+
+	struct FileHeader {
+		char magic[8];
+		std::int32_t version;
+		std::int32_t minFrame;
+		std::int32_t maxFrame;
+		std::uint32_t initSeed;
+		std::uint8_t gameID[16];
+		char syncVersion[64];
+		char mapName[128];
+		char modName[128];
+	};
+
+	struct FrameHeader {
+		std::int32_t frameNum;
+		std::uint32_t randSeed;
+		std::uint32_t syncChecksum;
+		std::int32_t numUnits;
+		std::int32_t numFeatures;
+		std::int32_t numProjectiles;
+		std::int32_t numTeams;
+		std::int32_t numAllyTeams;
+	};
+
+	struct UnitRecord {
+		std::int32_t id;
+		std::int32_t unitDefID;
+		float pos[3];
+		float speed[3];
+		float xdir[3];
+		float ydir[3];
+		float zdir[3];
+		float midPos[3];
+		float health;
+		float experience;
+		std::int32_t heading;
+		std::int32_t mapSquare;
+		std::int32_t physicalState;
+		std::int32_t fireState;
+		std::int32_t moveState;
+		std::int32_t flags; // isDead | activated << 1 | inBuildStance << 2
+		std::int32_t orderTargetID;
+		std::int32_t numCommands;
+		std::uint32_t piecesHash;
+		std::uint32_t weaponsHash;
+		std::uint32_t commandsHash;
+		std::uint32_t moveTypeHash;
+		std::uint32_t builderHash;
+	};
+
+	struct FeatureRecord {
+		std::int32_t id;
+		std::int32_t featureDefID;
+		float pos[3];
+		float speed[3];
+		float xdir[3];
+		float ydir[3];
+		float zdir[3];
+		float midPos[3];
+		float health;
+		float reclaimLeft;
+	};
+
+	struct ProjectileRecord {
+		std::int32_t id;
+		std::int32_t ownerID;
+		float pos[3];
+		float dir[3];
+		float speed[3];
+		std::int32_t weapon;
+		std::int32_t piece;
+		std::int32_t checkCol;
+		std::int32_t deleteMe;
+	};
+
+	struct TeamRecord {
+		std::int32_t id;
+		float metal;
+		float energy;
+		float metalPull;
+		float energyPull;
+		float metalIncome;
+		float energyIncome;
+		float metalExpense;
+		float energyExpense;
+	};
+
+	struct AllyTeamRecord {
+		std::int32_t id;
+		std::uint32_t losHashes[NUM_LOS_TYPES];
+	};
+
+	struct MapRecord {
+		std::uint32_t heightMapHash;
+		std::uint32_t centerNormalsHash;
+		std::uint32_t faceNormalsHash;
+		std::uint32_t smoothMeshHash;
+		std::int32_t cobTime;
+		std::int32_t numCobThreads;
+		std::uint32_t cobThreadsHash;
+	};
+}
+
+#endif // DUMPSTATE_FORMAT_H
@@ -8,6 +8,22 @@
 // This cannot be included in the header file (SyncChecker.h) because include conflicts will occur.
 #include "System/Threading/ThreadPool.h"
 
+#ifdef SYNC_HISTORY
+	#include <cstdint>
+	#include "fmt/format.h"
+
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define SYNC_CALLER_ADDRESS() _ReturnAddress()
+	#else
+		#define SYNC_CALLER_ADDRESS() __builtin_return_address(0)
+	#endif
+
+	#ifndef _WIN32
+		#include <dlfcn.h>
+	#endif
+#endif
+
 
 unsigned CSyncChecker::g_checksum;
 int CSyncChecker::inSyncedCode;
@@ -16,7 +32,7 @@ void CSyncChecker::NewFrame()
 {
 	g_checksum = 0xfade1eaf;
 #ifdef SYNC_HISTORY
-	LogHistory();
+	LogHistory(0);
 #endif // SYNC_HISTORY
 }
 
@@ -31,13 +47,20 @@ void CSyncChecker::Sync(const void* p, unsigned size)
 	// Sync calls should not be occurring in multi-threaded sections
 	debugSyncCheckThreading();
 #endif
-	// most common cases first, make it easy for compiler to optimize for it
+	// nearly every call covers 4 to 12 bytes (a SyncedPrimitive or a SyncedFloat3),
+	// where the per-call setup of XXH3 costs more than hashing the data itself;
+	// CRC32C runs one instruction per word (with an identical table fallback)
 	// simple xor is not enough to detect multiple zeroes, e.g.
-	g_checksum = spring::LiteHash(p, size, g_checksum);
+	g_checksum = spring::CRC32C(p, size, g_checksum);
 	//LOG("[Sync::Checker] chksum=%u\n", g_checksum);
 
 #ifdef SYNC_HISTORY
-	LogHistory();
+	// code addresses of one binary all lie within 2GB of each other, so the
+	// offset to Sync itself identifies the callsite with no registration step
+	const std::intptr_t caller = reinterpret_cast<std::intptr_t>(SYNC_CALLER_ADDRESS());
+	const std::intptr_t anchor = reinterpret_cast<std::intptr_t>(&CSyncChecker::Sync);
+
+	LogHistory(static_cast<unsigned>(caller - anchor));
 #endif // SYNC_HISTORY
 }
 
@@ -45,7 +68,7 @@ void CSyncChecker::Sync(const void* p, unsigned size)
 
 unsigned CSyncChecker::nextHistoryIndex = 0;
 unsigned CSyncChecker::nextFrameIndex = 0;
-std::array<unsigned, MAX_SYNC_HISTORY> CSyncChecker::logs;
+std::array<CSyncChecker::HistoryRecord, MAX_SYNC_HISTORY> CSyncChecker::logs;
 std::array<unsigned, MAX_SYNC_HISTORY_FRAMES> CSyncChecker::logFrames;
 
 void CSyncChecker::NewGameFrame()
@@ -55,14 +78,14 @@ void CSyncChecker::NewGameFrame()
 		nextFrameIndex = 0;
 }
 
-void CSyncChecker::LogHistory()
+void CSyncChecker::LogHistory(unsigned callsite)
 {
-	logs[nextHistoryIndex++] = g_checksum;
+	logs[nextHistoryIndex++] = {g_checksum, callsite};
 	if (nextHistoryIndex == MAX_SYNC_HISTORY)
 		nextHistoryIndex = 0;
 }
 
-std::tuple<unsigned, unsigned, unsigned*> CSyncChecker::GetFrameHistory(unsigned rewindFrames)
+std::tuple<unsigned, unsigned, const CSyncChecker::HistoryRecord*> CSyncChecker::GetFrameHistory(unsigned rewindFrames)
 {
 	int endFrameIndex = nextFrameIndex - rewindFrames;
 	int startFrameIndex = endFrameIndex - 1;
@@ -75,6 +98,27 @@ std::tuple<unsigned, unsigned, unsigned*> CSyncChecker::GetFrameHistory(unsigned
 	return std::make_tuple(logFrames[startFrameIndex], logFrames[endFrameIndex], logs.data());
 }
 
+std::string CSyncChecker::ResolveCallsite(unsigned callsite)
+{
+	if (callsite == 0)
+		return "NewFrame";
+
+	const std::intptr_t anchor = reinterpret_cast<std::intptr_t>(&CSyncChecker::Sync);
+	const void* address = reinterpret_cast<const void*>(anchor + static_cast<std::int32_t>(callsite));
+
+#ifndef _WIN32
+	Dl_info info;
+
+	// the module offset feeds straight into addr2line -e <module>
+	if (dladdr(address, &info) != 0 && info.dli_fname != nullptr) {
+		const std::uintptr_t offset = reinterpret_cast<std::uintptr_t>(address) - reinterpret_cast<std::uintptr_t>(info.dli_fbase);
+		return fmt::format("{}+{:#x} ({})", info.dli_fname, offset, (info.dli_sname != nullptr)? info.dli_sname: "?");
+	}
+#endif
+
+	return fmt::format("{}", address);
+}
+
 #endif // SYNC_HISTORY
 
 #endif // SYNCCHECK
@@ -9,8 +9,10 @@
 
 #include <cassert>
 #include <array>
+#include <string>
+#include <tuple>
 
-static constexpr size_t MAX_SYNC_HISTORY = 2500000; // 10MB, ~= 10 seconds of typical midgame
+static constexpr size_t MAX_SYNC_HISTORY = 2500000; // 20MB, ~= 10 seconds of typical midgame
 static constexpr size_t MAX_SYNC_HISTORY_FRAMES = 1000;
 
 /**
@@ -33,12 +35,30 @@ class CSyncChecker {
 		 * Keeps a running checksum over all assignments to synced variables.
 		 */
 		static unsigned GetChecksum() { return g_checksum; }
+		/**
+		 * Resumes the running checksum of another client, for mid-game joiners
+		 * that load a snapshot instead of simulating from frame 0.
+		 */
+		static void SetChecksum(unsigned checksum) { g_checksum = checksum; }
 		static void NewFrame();
 		static void debugSyncCheckThreading();
 		static void Sync(const void* p, unsigned size);
 		#ifdef SYNC_HISTORY
-		static std::tuple<unsigned, unsigned, unsigned*> GetFrameHistory(unsigned rewindFrames);
-		static std::pair<unsigned, unsigned*> GetHistory() { return std::make_pair(nextHistoryIndex, logs.data()); };
+		/**
+		 * One entry per Sync call: the running checksum after it, and where
+		 * it was called from. The callsite is the return address of Sync as
+		 * an offset into the executable, so recording it costs no more than
+		 * the store; it is only turned back into a symbol (ResolveCallsite)
+		 * when the server asks for the history of a desynced frame.
+		 */
+		struct HistoryRecord {
+			unsigned checksum;
+			unsigned callsite;
+		};
+
+		static std::tuple<unsigned, unsigned, const HistoryRecord*> GetFrameHistory(unsigned rewindFrames);
+		static std::pair<unsigned, const HistoryRecord*> GetHistory() { return std::make_pair(nextHistoryIndex, logs.data()); };
+		static std::string ResolveCallsite(unsigned callsite);
 		static void NewGameFrame();
 		#endif // SYNC_HISTORY
 
@@ -60,11 +80,11 @@ class CSyncChecker {
 		/**
 		 * Sync hash logs
 		 */
-		static void LogHistory();
+		static void LogHistory(unsigned callsite);
 
 		static unsigned nextHistoryIndex;
 		static unsigned nextFrameIndex;
-		static std::array<unsigned, MAX_SYNC_HISTORY> logs;
+		static std::array<HistoryRecord, MAX_SYNC_HISTORY> logs;
 		static std::array<unsigned, MAX_SYNC_HISTORY_FRAMES> logFrames;
 #endif // SYNC_HISTORY
 };
@@ -33,7 +33,7 @@ public:
 	/**
 	 * @brief Conversion from float3
 	 */
-	SyncedFloat3(const float3& f) : x(f.x), y(f.y), z(f.z) {}
+	SyncedFloat3(const float3& f) { Assign(f.x, f.y, f.z, "copy"); }
 
 	/**
 	 * @brief Constructor
@@ -43,8 +43,7 @@ public:
 	 *
 	 * With parameters, initializes x/y/z to the given floats.
 	 */
-	SyncedFloat3(const float x = 0.0f, const float y = 0.0f, const float z = 0.0f)
-			: x(x), y(y), z(z) {}
+	SyncedFloat3(const float x = 0.0f, const float y = 0.0f, const float z = 0.0f) { Assign(x, y, z, "copy"); }
 
 	/**
 	 * @brief float[3] Constructor
@@ -52,7 +51,20 @@ public:
 	 *
 	 * With parameters, initializes x/y/z to the given float[3].
 	 */
-	SyncedFloat3(const float f[3]) : x(f[0]), y(f[1]), z(f[2]) {}
+	SyncedFloat3(const float f[3]) { Assign(f[0], f[1], f[2], "copy"); }
+
+	SyncedFloat3& operator= (const SyncedFloat3& f) = default;
+
+	/**
+	 * @brief operator =
+	 * @param f float3 to assign
+	 *
+	 * Sets this to the given float3, without going through a temporary.
+	 */
+	SyncedFloat3& operator= (const float3& f) {
+		Assign(f.x, f.y, f.z, "=");
+		return *this;
+	}
 
 	/**
 	 * @brief operator =
@@ -61,11 +73,7 @@ public:
 	 * Sets the float3 to the given float[3].
 	 */
 	SyncedFloat3& operator= (const float f[3]) {
-
-		x = f[0];
-		y = f[1];
-		z = f[2];
-
+		Assign(f[0], f[1], f[2], "=");
 		return *this;
 	}
 
@@ -116,10 +124,7 @@ public:
 	 * float with the new sum.
 	 */
 	void operator+= (const float3& f) {
-
-		x += f.x;
-		y += f.y;
-		z += f.z;
+		Assign(x + f.x, y + f.y, z + f.z, "+=");
 	}
 
 	/**
@@ -165,10 +170,7 @@ public:
 	 * the new float3 inside this one.
 	 */
 	void operator-= (const float3& f) {
-
-		x -= f.x;
-		y -= f.y;
-		z -= f.z;
+		Assign(x - f.x, y - f.y, z - f.z, "-=");
 	}
 
 	/**
@@ -203,9 +205,7 @@ public:
 	 * the new float3 inside this one.
 	 */
 	void operator*= (const float3& f) {
-		x *= f.x;
-		y *= f.y;
-		z *= f.z;
+		Assign(x * f.x, y * f.y, z * f.z, "*=");
 	}
 
 	/**
@@ -216,9 +216,7 @@ public:
 	 * the new float3 inside this one.
 	 */
 	void operator*= (const float f) {
-		x *= f;
-		y *= f;
-		z *= f;
+		Assign(x * f, y * f, z * f, "*=");
 	}
 
 	/**
@@ -255,10 +253,7 @@ public:
 	 * the new values inside this float3.
 	 */
 	void operator/= (const float3& f) {
-
-		x /= f.x;
-		y /= f.y;
-		z /= f.z;
+		Assign(x / f.x, y / f.y, z / f.z, "/=");
 	}
 
 	/**
@@ -616,12 +611,29 @@ public:
 		assert(!math::isnan(z) && !math::isinf(z));
 	}
 
+private:
+	/**
+	 * @brief writes all three components, then syncs them as one 12-byte block
+	 *
+	 * Going through the SyncedFloat operators would hash every component on
+	 * its own; one call over the contiguous x/y/z is a third of the work.
+	 */
+	void Assign(const float nx, const float ny, const float nz, const char* op) {
+		x.x = nx;
+		y.x = ny;
+		z.x = nz;
+
+		Sync::Assert(&x, sizeof(float) * 3, op);
+	}
+
 public:
 	SyncedFloat x; ///< x component
 	SyncedFloat y; ///< y component
 	SyncedFloat z; ///< z component
 };
 
+static_assert(sizeof(SyncedFloat3) == sizeof(float) * 3, "SyncedFloat3::Assign syncs x/y/z as one block");
+
 #else // SYNCDEBUG || SYNCCHECK
 
 typedef float3 SyncedFloat3;
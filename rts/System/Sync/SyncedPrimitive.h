@@ -39,6 +39,9 @@ template <class T>
 struct SyncedPrimitive
 {
 private:
+	// batches its component writes into a single sync
+	friend struct SyncedFloat3;
+
 	T x;
 	void Sync(const char* op) {Sync::Assert(x, op);}
 
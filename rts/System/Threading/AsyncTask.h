@@ -0,0 +1,279 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
+
+/*
+	Coroutine tasks for unsynced pipelines that hop between the main (GL)
+	thread and ThreadPool workers, written linearly instead of as futures
+	polled every frame:
+
+		Threading::AsyncTask<void> LoadTexture(std::string name) {
+			co_await Threading::ToThreadPool();   // decode on a worker
+			CBitmap bmp;
+			bmp.Load(name);
+			co_await Threading::ToMainThread();   // upload on the GL thread
+			texID = bmp.CreateTexture();
+		}
+
+	A task runs on the calling thread until its first co_await. Its result
+	can be co_await'ed from another task, polled with IsReady or waited for
+	with Get; if the AsyncTask is dropped the coroutine keeps running and
+	frees itself when done. Main thread continuations run from
+	RunMainThreadTasks, once per frame in SpringApp::Update.
+
+	NB: resumption order across threads is not deterministic, never use
+	this from synced code.
+*/
+
+namespace Threading {
+	class MainThreadExecutor {
+	public:
+		static void Post(std::coroutine_handle<> h) {
+			std::lock_guard<spring::mutex> lck(mutex);
+			queued.push_back(h);
+			numQueued.fetch_add(1, std::memory_order_release);
+		}
+
+		// continuations posted while running are picked up on the next call
+		static void Run() {
+			assert(Threading::IsMainThread());
+
+			if (numQueued.load(std::memory_order_acquire) == 0)
+				return;
+
+			std::vector<std::coroutine_handle<>> handles;
+			{
+				std::lock_guard<spring::mutex> lck(mutex);
+				std::swap(handles, queued);
+				numQueued.store(0, std::memory_order_relaxed);
+			}
+
+			for (std::coroutine_handle<> h: handles) {
+				h.resume();
+			}
+		}
+
+		static bool Empty() { return (numQueued.load(std::memory_order_acquire) == 0); }
+
+	private:
+		static inline spring::mutex mutex;
+		static inline std::vector<std::coroutine_handle<>> queued;
+		static inline std::atomic<size_t> numQueued = {0};
+	};
+
+	static inline void RunMainThreadTasks() { MainThreadExecutor::Run(); }
+
+
+	// resumes the awaiting coroutine from the next RunMainThreadTasks, or right away if already there
+	static inline auto ToMainThread() {
+		struct Awaiter {
+			bool await_ready() const noexcept { return Threading::IsMainThread(); }
+			void await_suspend(std::coroutine_handle<> h) const { MainThreadExecutor::Post(h); }
+			void await_resume() const noexcept {}
+		};
+
+		return Awaiter{};
+	}
+
+	// resumes the awaiting coroutine on an async worker, or right away if there are none
+	static inline auto ToThreadPool(ThreadPool::TaskPriority priority = ThreadPool::TaskPriority::Normal) {
+		struct Awaiter {
+			bool await_ready() const noexcept { return !ThreadPool::HasThreads(); }
+			void await_suspend(std::coroutine_handle<> h) const {
+				// the worker may resume (and finish) the coroutine before this returns, members are gone then
+				ThreadPool::EnqueueWithPriority(priority, [h]() { h.resume(); });
+			}
+			void await_resume() const noexcept {}
+
+			ThreadPool::TaskPriority priority;
+		};
+
+		return Awaiter{priority};
+	}
+
+
+	namespace detail {
+		struct AsyncPromiseBase {
+			// set once the coroutine reached its final suspend point
+			static inline char doneTag = 0;
+
+			struct FinalAwaiter {
+				bool await_ready() const noexcept { return false; }
+
+				template<typename P>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept {
+					AsyncPromiseBase& p = h.promise();
+
+					void* cont = p.continuation.exchange(&doneTag, std::memory_order_acq_rel);
+
+					p.done.store(true, std::memory_order_release);
+					p.done.notify_all();
+
+					const bool lastRef = p.Release();
+
+					if (lastRef) {
+						// nobody is going to look at the result anymore
+						p.LogException();
+						h.destroy();
+					}
+
+					if (cont != nullptr)
+						return std::coroutine_handle<>::from_address(cont);
+
+					return std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			std::suspend_never initial_suspend() const noexcept { return {}; }
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+
+			void unhandled_exception() noexcept { exception = std::current_exception(); }
+
+			// false if the coroutine already finished, the awaiter should continue without suspending
+			bool SetContinuation(std::coroutine_handle<> h) {
+				void* expected = nullptr;
+				return continuation.compare_exchange_strong(expected, h.address(), std::memory_order_acq_rel);
+			}
+
+			void Wait() const {
+				while (!done.load(std::memory_order_acquire)) {
+					if (!Threading::IsMainThread()) {
+						done.wait(false, std::memory_order_acquire);
+						continue;
+					}
+
+					// the task might itself be waiting for the main thread
+					MainThreadExecutor::Run();
+					std::this_thread::yield();
+				}
+			}
+
+			bool Release() { return (refs.fetch_sub(1, std::memory_order_acq_rel) == 1); }
+
+			void RethrowException() const {
+				if (exception != nullptr)
+					std::rethrow_exception(exception);
+			}
+
+			void LogException() const {
+				if (exception == nullptr)
+					return;
+
+				try {
+					std::rethrow_exception(exception);
+				} catch (const std::exception& e) {
+					LOG_L(L_ERROR, "[AsyncTask] unobserved exception \"%s\"", e.what());
+				} catch (...) {
+					LOG_L(L_ERROR, "[AsyncTask] unobserved unknown exception");
+				}
+			}
+
+			std::atomic<void*> continuation = {nullptr};
+			std::atomic<bool> done = {false};
+			// held by the AsyncTask and by the running coroutine
+			std::atomic<int> refs = {2};
+
+			std::exception_ptr exception;
+		};
+	}
+
+
+	template<typename T>
+	class AsyncTask {
+	public:
+		struct promise_type: public detail::AsyncPromiseBase {
+			AsyncTask get_return_object() { return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+			template<typename U>
+			void return_value(U&& u) { value.emplace(std::forward<U>(u)); }
+
+			T TakeResult() {
+				RethrowException();
+				return std::move(*value);
+			}
+
+			std::optional<T> value;
+		};
+
+		AsyncTask() = default;
+		AsyncTask(const AsyncTask&) = delete;
+		AsyncTask(AsyncTask&& t) noexcept { *this = std::move(t); }
+		~AsyncTask() { Reset(); }
+
+		AsyncTask& operator = (const AsyncTask&) = delete;
+		AsyncTask& operator = (AsyncTask&& t) noexcept {
+			if (this != &t) {
+				Reset();
+				std::swap(handle, t.handle);
+			}
+
+			return *this;
+		}
+
+		bool Valid() const { return (handle != nullptr); }
+		bool IsReady() const { return (handle != nullptr && handle.promise().done.load(std::memory_order_acquire)); }
+
+		// blocks until done; the result can be taken only once
+		T Get() {
+			assert(Valid());
+			handle.promise().Wait();
+			return handle.promise().TakeResult();
+		}
+
+		// drops this handle, the coroutine (if still running) finishes on its own
+		void Reset() {
+			if (handle == nullptr)
+				return;
+
+			if (handle.promise().Release())
+				handle.destroy();
+
+			handle = nullptr;
+		}
+
+		auto operator co_await() {
+			struct Awaiter {
+				bool await_ready() const { return h.promise().done.load(std::memory_order_acquire); }
+				bool await_suspend(std::coroutine_handle<> cont) const { return h.promise().SetContinuation(cont); }
+				T await_resume() const { return h.promise().TakeResult(); }
+
+				std::coroutine_handle<promise_type> h;
+			};
+
+			assert(Valid());
+			return Awaiter{handle};
+		}
+
+	private:
+		explicit AsyncTask(std::coroutine_handle<promise_type> h): handle(h) {}
+
+	private:
+		std::coroutine_handle<promise_type> handle = nullptr;
+	};
+
+
+	template<>
+	struct AsyncTask<void>::promise_type: public detail::AsyncPromiseBase {
+		AsyncTask get_return_object() { return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+
+		void return_void() {}
+		void TakeResult() { RethrowException(); }
+	};
+}
@@ -0,0 +1,146 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace Recoil {
+	// Bounded multi-producer single-consumer ring, after D.Vyukov's
+	// sequence-tagged cell design. Producers claim a slot with a CAS on
+	// the enqueue position and publish it by bumping the slot sequence;
+	// the (only) consumer never needs a RMW op, so Pop/Peek stay cheap.
+	// Capacity is rounded up to a power of two.
+	template<typename T>
+	class MPSCRingBuffer {
+	public:
+		explicit MPSCRingBuffer(size_t minCapacity)
+			: capacity(std::bit_ceil(std::max<size_t>(minCapacity, 2)))
+			, mask(capacity - 1)
+			, cells(std::make_unique<Cell[]>(capacity))
+		{
+			for (size_t i = 0; i < capacity; ++i) {
+				cells[i].seq.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+		MPSCRingBuffer& operator = (const MPSCRingBuffer&) = delete;
+
+		~MPSCRingBuffer() { Clear(); }
+
+		// producer side (any thread); returns false if the ring is full
+		template<typename U>
+		bool Push(U&& item) {
+			size_t pos = enqueuePos.load(std::memory_order_relaxed);
+
+			while (true) {
+				Cell& cell = cells[pos & mask];
+
+				const size_t seq = cell.seq.load(std::memory_order_acquire);
+				const intptr_t dif = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+				if (dif == 0) {
+					if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+
+					continue;
+				}
+
+				// slot still holds an item the consumer has not taken yet
+				if (dif < 0)
+					return false;
+
+				pos = enqueuePos.load(std::memory_order_relaxed);
+			}
+
+			Cell& cell = cells[pos & mask];
+			new (cell.Storage()) T(std::forward<U>(item));
+			cell.seq.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		// consumer side (single thread only)
+		bool Pop(T& item) {
+			Cell& cell = cells[dequeuePos & mask];
+
+			if (cell.seq.load(std::memory_order_acquire) != (dequeuePos + 1))
+				return false;
+
+			item = std::move(*cell.Item());
+			cell.Item()->~T();
+			cell.seq.store(dequeuePos + capacity, std::memory_order_release);
+
+			dequeuePos += 1;
+			return true;
+		}
+
+		// drains up to <maxItems> published items via <func(T&&)>, in order
+		template<typename Func>
+		size_t PopBulk(Func&& func, size_t maxItems) {
+			size_t numPopped = 0;
+
+			for (T item; numPopped < maxItems && Pop(item); ++numPopped) {
+				func(std::move(item));
+			}
+
+			return numPopped;
+		}
+
+		// returns the <ahead>'th published item without removing it, or
+		// nullptr; stops at the first slot whose producer has not finished
+		const T* Peek(size_t ahead) const {
+			if (ahead >= capacity)
+				return nullptr;
+
+			for (size_t i = 0; i <= ahead; ++i) {
+				const Cell& cell = cells[(dequeuePos + i) & mask];
+
+				if (cell.seq.load(std::memory_order_acquire) != (dequeuePos + i + 1))
+					return nullptr;
+			}
+
+			return cells[(dequeuePos + ahead) & mask].Item();
+		}
+
+		bool Empty() const { return (Peek(0) == nullptr); }
+
+		// approximate when called while producers are active
+		size_t Size() const {
+			const size_t epos = enqueuePos.load(std::memory_order_acquire);
+			return ((epos > dequeuePos)? (epos - dequeuePos): 0);
+		}
+
+		size_t Capacity() const { return capacity; }
+
+		// consumer side; discards every published item
+		void Clear() {
+			for (T item; Pop(item); ) {}
+		}
+
+	private:
+		struct alignas(64) Cell {
+			std::atomic<size_t> seq;
+			alignas(T) std::byte storage[sizeof(T)];
+
+			void* Storage() { return storage; }
+			      T* Item()       { return std::launder(reinterpret_cast<      T*>(storage)); }
+			const T* Item() const { return std::launder(reinterpret_cast<const T*>(storage)); }
+		};
+
+		const size_t capacity;
+		const size_t mask;
+
+		std::unique_ptr<Cell[]> cells;
+
+		alignas(64) std::atomic<size_t> enqueuePos = {0};
+		alignas(64) size_t dequeuePos = 0;
+	};
+}
@@ -23,6 +23,7 @@
 #undef unlikely
 #endif
 
+#include <bit>
 #include <utility>
 #include <functional>
 #include <cinttypes>
@@ -42,6 +43,7 @@
 
 #ifndef UNIT_TEST
 CONFIG(int, WorkerThreadCount).defaultValue(-1).safemodeValue(0).minimumValue(-1).description("Number of workers (including the main thread!) used by ThreadPool.");
+CONFIG(unsigned, AsyncWorkerCoreAffinity).defaultValue(0).safemodeValue(0).description("Defines a bitmask indicating which CPU cores the async (background) ThreadPool workers should use, 0 picks efficiency cores or the cores left over by the main thread and sim workers.");
 #endif
 
 
@@ -66,20 +68,34 @@ bool ThreadPool::inMultiThreadedSection;
 
 // global [idx = 0] and smaller per-thread [idx > 0] queues; the latter are
 // for tasks that want to execute on specific threads, e.g. parallel_reduce
+// async tasks have one set per priority and can be stolen by other workers
 // note: std::shared_ptr<T> can not be made atomic, queues must store T*'s
 #ifdef USE_BOOST_LOCKFREE_QUEUE
-static std::array<boost::lockfree::queue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[2];
+typedef std::array<boost::lockfree::queue<ITaskGroup*>, ThreadPool::MAX_THREADS> TaskQueues;
 #else
-static std::array<moodycamel::ConcurrentQueue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[2];
+typedef std::array<moodycamel::ConcurrentQueue<ITaskGroup*>, ThreadPool::MAX_THREADS> TaskQueues;
 #endif
 
+static TaskQueues syncTaskQueues;
+static TaskQueues asyncTaskQueues[ThreadPool::NUM_TASK_PRIORITIES];
+
+// number of for_mt / parallel sections currently waiting in WaitForFinished
+static std::atomic<int> numSyncSections = {0};
+
 static std::vector<void*> workerThreads[2];
 static std::array<bool, ThreadPool::MAX_THREADS> exitFlags;
 static std::array<ThreadStats, ThreadPool::MAX_THREADS> threadStats[2];
+// read by the profiler while the workers update them
+static std::array<std::atomic<uint64_t>, ThreadPool::MAX_THREADS> workerBusyTimes[2];
+static std::array<std::atomic<uint32_t>, ThreadPool::MAX_THREADS> workerAffinities[2];
 static spring::signal newTasksSignal[2];
 
 static _threadlocal int threadnum(0);
 
+// async workers are not reachable through parallel_reduce, they pick up a new mask themselves
+static std::atomic<uint32_t> asyncWorkerMask = {0};
+static std::atomic<int> asyncWorkerMaskGen = {0};
+
 #ifndef UNITSYNC
 // if enabled, allows OpenGL calls from ThreadPool tasks
 // so certain logic (e.g. loading models) can be written
@@ -131,72 +147,64 @@ int GetMaxThreads() { return std::min(MAX_THREADS, Threading::GetLogicalCpuCores
 
 bool HasThreads() { return !workerThreads[false].empty(); }
 
+uint64_t GetWorkerBusyTime(int tid, bool async) { return workerBusyTimes[async][tid].load(std::memory_order_relaxed); }
+uint32_t GetWorkerAffinity(int tid, bool async) { return workerAffinities[async][tid].load(std::memory_order_relaxed); }
 
 
-static bool DoTask(int tid, bool async)
+
+static bool PopTask(TaskQueues::value_type& queue, ITaskGroup*& tg)
 {
-	#ifndef UNIT_TEST
-	SCOPED_MT_TIMER("ThreadPool::RunTask");
+	#ifdef USE_BOOST_LOCKFREE_QUEUE
+	return (queue.pop(tg));
+	#else
+	return (queue.try_dequeue(tg));
+	#endif
+}
+
+static void RunTask(ITaskGroup* tg, int tid, bool async)
+{
+	assert(!async || tg->IsAsyncTask());
+
+	#ifdef USE_TASK_STATS_TRACKING
+	const uint64_t wdt = tg->GetDeltaTime(spring_now());
+	const uint64_t edt = tg->ExecuteLoop(tid, false);
+
+	workerBusyTimes[async][tid].fetch_add(edt, std::memory_order_relaxed);
+
+	threadStats[async][tid].numTasksRun += 1;
+	threadStats[async][tid].sumExecTime += edt;
+	threadStats[async][tid].sumWaitTime += wdt;
+	threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
+	threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
+	threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
+	threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
+	#else
+	workerBusyTimes[async][tid].fetch_add(tg->ExecuteLoop(tid, false), std::memory_order_relaxed);
 	#endif
+}
 
+static bool DoSyncTask(int tid)
+{
 	ITaskGroup* tg = nullptr;
 
 	// any external thread calling WaitForFinished will have
 	// id=0 and *only* processes tasks from the global queue
 	for (int idx = 0; idx <= tid; idx += std::max(tid, 1)) {
-		auto& queue = taskQueues[async][idx];
+		auto& queue = syncTaskQueues[idx];
 
-		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		if (queue.pop(tg)) {
-		#else
-		if (queue.try_dequeue(tg)) {
-		#endif
+		if (PopTask(queue, tg)) {
 			// inform other workers when there is global work to do
 			// waking is an expensive kernel-syscall, so better shift this
 			// cost to the workers too (the main thread only wakes when ALL
 			// workers are sleeping)
 			if (idx == 0)
-				NotifyWorkerThreads(true, async);
-
-			assert(!async || tg->IsAsyncTask());
-
-			#ifdef USE_TASK_STATS_TRACKING
-			const uint64_t wdt = tg->GetDeltaTime(spring_now());
-			const uint64_t edt = tg->ExecuteLoop(tid, false);
-
-			threadStats[async][tid].numTasksRun += 1;
-			threadStats[async][tid].sumExecTime += edt;
-			threadStats[async][tid].sumWaitTime += wdt;
-			threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
-			threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
-			threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
-			threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
-			#else
-			tg->ExecuteLoop(tid, false);
-			#endif
+				NotifyWorkerThreads(true, false);
+
+			RunTask(tg, tid, false);
 		}
 
-		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		while (queue.pop(tg)) {
-		#else
-		while (queue.try_dequeue(tg)) {
-		#endif
-			assert(!async || tg->IsAsyncTask());
-
-			#ifdef USE_TASK_STATS_TRACKING
-			const uint64_t wdt = tg->GetDeltaTime(spring_now());
-			const uint64_t edt = tg->ExecuteLoop(tid, false);
-
-			threadStats[async][tid].numTasksRun += 1;
-			threadStats[async][tid].sumExecTime += edt;
-			threadStats[async][tid].sumWaitTime += wdt;
-			threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
-			threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
-			threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
-			threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
-			#else
-			tg->ExecuteLoop(tid, false);
-			#endif
+		while (PopTask(queue, tg)) {
+			RunTask(tg, tid, false);
 		}
 	}
 
@@ -204,6 +212,62 @@ static bool DoTask(int tid, bool async)
 	return (tg != nullptr);
 }
 
+static bool DoAsyncTask(int tid)
+{
+	const int numQueues = GetNumThreads();
+
+	ITaskGroup* tg = nullptr;
+
+	// one task at a time, s.t. newly pushed higher-priority tasks are seen
+	// after at most the current one; own queue first, then the global one
+	// and the other workers' (async tasks are all spread over the workers
+	// by Enqueue, without stealing a long one could hold up its followers)
+	for (int prio = 0; prio < NUM_TASK_PRIORITIES; prio++) {
+		if (prio == static_cast<int>(TaskPriority::Background) && numSyncSections.load(std::memory_order_relaxed) > 0)
+			break;
+
+		for (int n = 0; n < numQueues; n++) {
+			if (!PopTask(asyncTaskQueues[prio][(tid + n) % numQueues], tg))
+				continue;
+
+			RunTask(tg, tid, true);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool DoTask(int tid, bool async)
+{
+	#ifndef UNIT_TEST
+	SCOPED_MT_TIMER("ThreadPool::RunTask");
+	#endif
+
+	if (async)
+		return (DoAsyncTask(tid));
+
+	return (DoSyncTask(tid));
+}
+
+
+static void UpdateAsyncWorkerAffinity(int tid, int& maskGen)
+{
+	const int curMaskGen = asyncWorkerMaskGen.load(std::memory_order_acquire);
+
+	if (curMaskGen == maskGen)
+		return;
+
+	char threadName[24];
+	std::snprintf(threadName, sizeof(threadName), "AsyncWorker %d", tid);
+
+	const std::uint32_t workerCores = asyncWorkerMask.load(std::memory_order_relaxed);
+
+	Threading::SetAffinityHelper(threadName, workerCores);
+	workerAffinities[true][tid].store(workerCores, std::memory_order_relaxed);
+
+	maskGen = curMaskGen;
+}
 
 __FORCE_ALIGN_STACK__
 static void WorkerLoop(int tid, bool async)
@@ -222,11 +286,18 @@ static void WorkerLoop(int tid, bool async)
 	const auto ourSpinTime = spring_time::fromMicroSecs(30 * (tid == 1));
 	const auto maxSleepTime = spring_time::fromMilliSecs(30);
 
+	int asyncMaskGen = 0;
+
+	workerAffinities[async][tid].store(0, std::memory_order_relaxed);
+
 	while (!exitFlags[tid]) {
 		const auto spinlockEnd = spring_now() + ourSpinTime;
 		      auto sleepTime   = spring_time::fromMicroSecs(1);
 
 		while (!DoTask(tid, async) && !exitFlags[tid]) {
+			if (async)
+				UpdateAsyncWorkerAffinity(tid, asyncMaskGen);
+
 			if (spring_now() < spinlockEnd)
 				continue;
 
@@ -244,6 +315,12 @@ void WaitForFinished(std::shared_ptr<ITaskGroup>&& taskGroup)
 	// can be any worker-thread (for_mt inside another for_mt, etc)
 	const int tid = GetThreadNum();
 
+	// keeps background tasks from competing with this section for cores
+	struct SyncSectionScope {
+		SyncSectionScope() { numSyncSections.fetch_add(1, std::memory_order_relaxed); }
+		~SyncSectionScope() { numSyncSections.fetch_sub(1, std::memory_order_relaxed); }
+	} syncSectionScope;
+
 	{
 		#ifndef UNIT_TEST
 		SCOPED_MT_TIMER("ThreadPool::WaitFor");
@@ -301,7 +378,8 @@ void WaitForFinished(std::shared_ptr<ITaskGroup>&& taskGroup)
 void PushTaskGroup(std::shared_ptr<ITaskGroup>&& taskGroup) { PushTaskGroup(taskGroup.get()); }
 void PushTaskGroup(ITaskGroup* taskGroup)
 {
-	auto& queue = taskQueues[ taskGroup->IsAsyncTask() ][ taskGroup->WantedThread() ];
+	auto& queues = taskGroup->IsAsyncTask()? asyncTaskQueues[taskGroup->Priority()]: syncTaskQueues;
+	auto& queue = queues[taskGroup->WantedThread()];
 
 	#if 0
 	// fake single-task group, handled by WaitForFinished to
@@ -319,9 +397,13 @@ void PushTaskGroup(ITaskGroup* taskGroup)
 	#endif
 
 	#if 1
-	// AsyncTask's do not care about wakeup-latency as much
-	if (taskGroup->IsAsyncTask())
+	// AsyncTask's do not care about wakeup-latency as much, unless urgent
+	if (taskGroup->IsAsyncTask()) {
+		if (taskGroup->priority == ThreadPool::TaskPriority::High)
+			NotifyWorkerThreads(true, true);
+
 		return;
+	}
 
 	NotifyWorkerThreads(false, false);
 	#else
@@ -404,13 +486,11 @@ static void KillThreads(int wantedNumThreads, int curNumThreads)
 	for (int i = curNumThreads - 1; i >= wantedNumThreads && i > 0; --i) {
 		ITaskGroup* tg = nullptr;
 
-		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		while (taskQueues[false][i].pop(tg));
-		while (taskQueues[ true][i].pop(tg));
-		#else
-		while (taskQueues[false][i].try_dequeue(tg));
-		while (taskQueues[ true][i].try_dequeue(tg));
-		#endif
+		while (PopTask(syncTaskQueues[i], tg));
+
+		for (auto& queues: asyncTaskQueues) {
+			while (PopTask(queues[i], tg));
+		}
 	}
 
 	assert((wantedNumThreads != 0) || workerThreads[false].empty());
@@ -476,8 +556,11 @@ void SetThreadCount(int wantedNumThreads)
 		assert(workerThreads[true].empty());
 
 		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		taskQueues[false][0].reserve(1024);
-		taskQueues[ true][0].reserve(1024);
+		syncTaskQueues[0].reserve(1024);
+
+		for (auto& queues: asyncTaskQueues) {
+			queues[0].reserve(1024);
+		}
 		#endif
 
 		#ifdef USE_TASK_STATS_TRACKING
@@ -612,6 +695,12 @@ void SetDefaultThreadCount()
 	#endif
 
 	std::uint32_t workerAvailCores = systemCores & ~mainAffinity;
+	std::uint32_t poolCoreAffinity = 0;
+
+	// fill the L3 (CCD) of the main thread first, the sim workers touch much of the same data
+	const std::uint32_t localCores = workerAvailCores & Threading::GetCacheGroupMask((mainAffinity != 0)? mainAffinity: systemCores);
+	const std::uint32_t otherCores = workerAvailCores & ~localCores;
+	const std::int32_t numLocalCores = std::popcount(localCores);
 
 	{
 		// parallel_reduce now folds over shared_ptrs to futures
@@ -626,17 +715,20 @@ void SetDefaultThreadCount()
 
 			const std::uint32_t workerCore =
 				 (threadPinPolicy == cpu_topology::THREAD_PIN_POLICY_PER_PERF_CORE)
-				 ? FindWorkerThreadCore(i - 1, workerAvailCores, mainAffinity)
+				 ? ((i - 1) < numLocalCores)
+				 	? FindWorkerThreadCore(i - 1                , localCores, mainAffinity)
+				 	: FindWorkerThreadCore(i - 1 - numLocalCores, otherCores, mainAffinity)
 				 : workerAvailCores;
 
 			char threadName[20];
 			std::snprintf(threadName, sizeof(threadName), "Worker %d", i);
 
 			Threading::SetAffinityHelper(threadName, workerCore);
+			workerAffinities[false][i].store(workerCore, std::memory_order_relaxed);
 			return workerCore;
 		};
 
-		const std::uint32_t poolCoreAffinity = parallel_reduce<SyncTask<decltype(AffinityFunc)>>(AffinityFunc, ReduceFunc);
+		poolCoreAffinity = parallel_reduce<SyncTask<decltype(AffinityFunc)>>(AffinityFunc, ReduceFunc);
 		const std::uint32_t mainCoreAffinity = ~poolCoreAffinity & systemCores;
 
 		if (mainAffinity == 0)
@@ -647,6 +739,28 @@ void SetDefaultThreadCount()
 
 		Threading::SetAffinityHelper("Main", mainAffinity);
 	}
+	{
+		// async workers run loading, streaming and other background jobs; keep them off
+		// the cores of the main thread and sim workers, on low-power cores if there are any
+		std::uint32_t asyncAffinity = 0;
+
+		#ifndef UNIT_TEST
+		asyncAffinity = configHandler->GetUnsigned("AsyncWorkerCoreAffinity");
+		#endif
+
+		if (asyncAffinity == 0 && threadPinPolicy != cpu_topology::THREAD_PIN_POLICY_NONE)
+			asyncAffinity = Threading::GetBackgroundThreadMask(poolCoreAffinity | mainAffinity);
+
+		if (asyncAffinity == 0)
+			return;
+
+		LOG("[ThreadPool] Async worker affinity requested as 0x%08x", asyncAffinity);
+
+		asyncWorkerMask.store(asyncAffinity, std::memory_order_relaxed);
+		asyncWorkerMaskGen.fetch_add(1, std::memory_order_release);
+
+		NotifyWorkerThreads(true, true);
+	}
 }
 
 
@@ -3,7 +3,20 @@
 #ifndef _THREADPOOL_H
 #define _THREADPOOL_H
 
+namespace ThreadPool {
+	// order in which async workers pick up enqueued tasks; for_mt and
+	// parallel sections run on their own workers and always come first
+	enum class TaskPriority: int {
+		High       = 0, // something (e.g. drawing) is or will soon be waiting on the result
+		Normal     = 1,
+		Background = 2, // never started while a for_mt or parallel section is running
+	};
+
+	static constexpr int NUM_TASK_PRIORITIES = 3;
+}
+
 #ifndef THREADPOOL
+#include <cstdint>
 #include <functional>
 #include <future>
 #include "System/Threading/SpringThreading.h"
@@ -16,6 +29,13 @@ namespace ThreadPool {
 		return std::shared_future(std::async(std::launch::deferred, std::forward<F>(f), std::forward<Args>(args)...));
 	}
 
+	template<class F, class... Args>
+	static auto EnqueueWithPriority(TaskPriority priority, F&& f, Args&&... args)
+	-> std::shared_future<std::invoke_result_t<F, Args...>>
+	{
+		return Enqueue(std::forward<F>(f), std::forward<Args>(args)...);
+	}
+
 	static inline void AddExtJob(spring::thread&& t) { t.join(); }
 	static inline void AddExtJob(std::future<void>&& f) { f.get(); }
 	static inline void ClearExtJobs() {}
@@ -28,6 +48,8 @@ namespace ThreadPool {
 	static inline int GetNumThreads() { return 1; }
 	static inline void NotifyWorkerThreads(bool force, bool async) {}
 	static inline bool HasThreads() { return false; }
+	static inline uint64_t GetWorkerBusyTime(int tid, bool async) { return 0; }
+	static inline uint32_t GetWorkerAffinity(int tid, bool async) { return 0; }
 
 	static constexpr int MAX_THREADS = 1;
 }
@@ -52,6 +74,12 @@ static inline void for_mt_chunk(int b, int e, F&& f, int chunkSize = 0)
 	for_mt(b, e, f);
 }
 
+template <typename F>
+static inline void for_mt_chunk_adaptive(const char* name, int b, int e, F&& f, bool guided = false)
+{
+	for_mt(b, e, f);
+}
+
 
 static inline void parallel(const std::function<void()>&& f)
 {
@@ -69,11 +97,14 @@ static inline auto parallel_reduce(F&& f, G&& g) -> std::invoke_result_t<F>
 #include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
 
+#include <algorithm>
 #include  <array>
 #include <vector>
 #include <numeric>
 #include <atomic>
 
+#include "System/Misc/TracyDefs.h"
+
 #undef gt
 #include <memory>
 
@@ -89,6 +120,9 @@ namespace ThreadPool {
 	template<class F, class... Args>
 	static auto Enqueue(F&& f, Args&&... args)
 	-> std::shared_future<std::invoke_result_t<F, Args...>>;
+	template<class F, class... Args>
+	static auto EnqueueWithPriority(TaskPriority priority, F&& f, Args&&... args)
+	-> std::shared_future<std::invoke_result_t<F, Args...>>;
 
 	void AddExtJob(spring::thread&& t);
 	void AddExtJob(std::future<void>&& f);
@@ -112,6 +146,10 @@ namespace ThreadPool {
 	int GetNumThreads();
 	void NotifyWorkerThreads(bool force, bool async);
 
+	// nanoseconds spent running tasks, and the cores a worker is pinned to (0 if not)
+	uint64_t GetWorkerBusyTime(int tid, bool async);
+	uint32_t GetWorkerAffinity(int tid, bool async);
+
 	extern bool inMultiThreadedSection;
 
 	static constexpr int MAX_THREADS = 32;
@@ -183,6 +221,7 @@ public:
 
 	int RemainingTasks() const { return remainingTasks; }
 	int WantedThread() const { return wantedThread; }
+	int Priority() const { return static_cast<int>(priority); }
 
 	bool WaitFor(const spring_time& rel_time) const {
 		const auto end = spring_now() + rel_time;
@@ -208,6 +247,7 @@ public:
 public:
 	std::atomic_int remainingTasks;
 	std::atomic_int wantedThread; // if 0 (default), task will be executed by an arbitrary thread
+	ThreadPool::TaskPriority priority = ThreadPool::TaskPriority::Normal; // only used by async tasks, set before pushing
 	std::atomic_int taskPoolMask; // whether this task is managed (owned) and in use by a TaskPool
 
 	std::atomic_bool inTaskQueue; // whether this task is still in a thread's queue
@@ -779,6 +819,101 @@ static inline void for_mt_chunk(int b, int e, F&& f, int minChunkSize = 1, int m
 }
 
 
+/**
+ * Self-tuning chunk state of one for_mt_chunk_adaptive call site, chunks are
+ * sized s.t. each takes roughly TARGET_CHUNK_TIME based on the item cost the
+ * previous calls measured.
+ */
+struct AdaptiveChunkState {
+	static constexpr float TARGET_CHUNK_TIME = 20000.0f; // ns
+	static constexpr float COST_SMOOTHING = 0.25f;
+
+	int GetChunkSize(int numElems, int numThreads) const {
+		const float cost = nsPerItem.load(std::memory_order_relaxed);
+		const int maxChunkSize = std::max(1, numElems / numThreads);
+
+		// first call, start with a few chunks per thread
+		if (cost <= 0.0f)
+			return std::max(1, maxChunkSize / 8);
+
+		return std::clamp(static_cast<int>(TARGET_CHUNK_TIME / cost), 1, maxChunkSize);
+	}
+
+	void AddSample(uint64_t busyTime, int numElems) {
+		const float sample = busyTime / static_cast<float>(numElems);
+		const float cost = nsPerItem.load(std::memory_order_relaxed);
+
+		nsPerItem.store((cost <= 0.0f)? sample: (cost + (sample - cost) * COST_SMOOTHING), std::memory_order_relaxed);
+	}
+
+	std::atomic<float> nsPerItem = {0.0f};
+};
+
+/**
+ * for_mt_chunk for loops with uneven per-item cost; threads keep grabbing
+ * chunks from a shared cursor until the range is exhausted. If guided, the
+ * chunks start at a share of the remaining items and shrink towards the
+ * measured size near the end, cheaper to hand out without growing the tail.
+ * The time between the first and the last worker running out of items is
+ * plotted in Tracy under <name>, which must be a string literal.
+ */
+template <typename F>
+static inline void for_mt_chunk_adaptive(const char* name, int b, int e, F&& f, bool guided = false)
+{
+	const int numElems = e - b;
+	if (numElems <= 0)
+		return;
+
+	// one per call site, each passes a lambda of its own type
+	static AdaptiveChunkState state;
+
+	const int numThreads = ThreadPool::GetNumThreads();
+
+	if (!ThreadPool::HasThreads() || numElems == 1) {
+		for (int i = b; i < e; ++i)
+			f(i);
+
+		return;
+	}
+
+	const int chunkSize = state.GetChunkSize(numElems, numThreads);
+
+	std::atomic<int> cursor = {b};
+	std::array<uint64_t, ThreadPool::MAX_THREADS> busyTimes;
+	std::array<uint64_t, ThreadPool::MAX_THREADS> doneTimes;
+
+	for_mt(0, numThreads, [&](const int jobId) {
+		const spring_time t0 = spring_now();
+
+		while (true) {
+			int beg = cursor.load(std::memory_order_relaxed);
+			int num = 0;
+
+			do {
+				num = guided? std::max(chunkSize, (e - beg) / (2 * numThreads)): chunkSize;
+			} while (beg < e && !cursor.compare_exchange_weak(beg, beg + num, std::memory_order_relaxed));
+
+			if (beg >= e)
+				break;
+
+			for (int i = beg, end = std::min(beg + num, e); i < end; ++i)
+				f(i);
+		}
+
+		const spring_time t1 = spring_now();
+
+		busyTimes[jobId] = (t1 - t0).toNanoSecsi();
+		doneTimes[jobId] = t1.toNanoSecsi();
+	});
+
+	const auto [minDone, maxDone] = std::minmax_element(doneTimes.begin(), doneTimes.begin() + numThreads);
+
+	state.AddSample(std::accumulate(busyTimes.begin(), busyTimes.begin() + numThreads, uint64_t(0)), numElems);
+
+	TracyPlot(name, static_cast<int64_t>(*maxDone - *minDone) / 1000); // us
+}
+
+
 template <typename F>
 static inline void parallel(F&& f)
 {
@@ -847,7 +982,7 @@ static inline auto parallel_reduce(F&& f, G&& g) -> std::invoke_result_t<F>
 
 namespace ThreadPool {
 	template<class F, class... Args>
-	static inline auto Enqueue(F&& f, Args&&... args)
+	static inline auto EnqueueWithPriority(TaskPriority priority, F&& f, Args&&... args)
 	-> std::shared_future<std::invoke_result_t<F, Args...>>
 	{
 		using return_type = std::invoke_result_t<F, Args...>;
@@ -866,13 +1001,21 @@ namespace ThreadPool {
 		auto fut = task->GetFuture();
 
 		// minor hack: assume AsyncTask's will cause (heavy) disk IO
-		// although these can never block the main thread, the async
-		// workers might still be handed an uneven work distribution
+		// spread them over the async workers, idle ones steal the
+		// rest if the distribution turns out uneven
 		task->wantedThread.store(1 + task->GetId() % (ThreadPool::GetNumThreads() - 1));
+		task->priority = priority;
 
 		ThreadPool::PushTaskGroup(task);
 		return fut;
 	}
+
+	template<class F, class... Args>
+	static inline auto Enqueue(F&& f, Args&&... args)
+	-> std::shared_future<std::invoke_result_t<F, Args...>>
+	{
+		return EnqueueWithPriority(TaskPriority::Normal, std::forward<F>(f), std::forward<Args>(args)...);
+	}
 }
 
 #endif
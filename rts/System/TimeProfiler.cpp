@@ -2,12 +2,14 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdio>
 #include <cstring>
 
 #include "System/TimeProfiler.h"
 #include "System/GlobalRNG.h"
 #include "System/StringHash.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/StartupTrace.h"
 #include "System/Threading/SpringThreading.h"
 
 #ifdef THREADPOOL
@@ -24,6 +26,9 @@ static spring::unordered_map<unsigned, int> refCounters;
 
 static CGlobalUnsyncedRNG profileColorRNG;
 
+// innermost ScopedTimer per thread, sampled by the watchdog on missed heartbeats
+static thread_local std::atomic<unsigned> threadScope = {0};
+
 const std::array<CTimeProfiler::ProfileSortFunc, CTimeProfiler::SortType::ST_COUNT> CTimeProfiler::SortingFunctions = {
 	[](const TimeRecordPair& a, const TimeRecordPair& b) { return (a.first          < b.first         ); }, // ST_ALPHABETICAL = 0,
 	[](const TimeRecordPair& a, const TimeRecordPair& b) { return (a.second.total   > b.second.total  ); }, // ST_TOTALTIME    = 1,
@@ -45,7 +50,10 @@ ScopedTimer::ScopedTimer(const unsigned _nameHash, bool _autoShowGraph, bool _sp
 	// note that address-comparison is intended here, timer names are (and must be) literals
 	, autoShowGraph(_autoShowGraph)
 	, specialTimer(_specialTimer)
+	, parentScope(threadScope.load(std::memory_order_relaxed))
 {
+	threadScope.store(nameHash, std::memory_order_relaxed);
+
 	auto iter = refCounters.find(nameHash);
 
 	if (iter == refCounters.end())
@@ -65,6 +73,8 @@ ScopedTimer::~ScopedTimer()
 	if (--(iter->second) == 0) {
 		CTimeProfiler::GetInstance().AddTime(nameHash, startTime, GetDuration(), autoShowGraph, specialTimer, false);
 	}
+
+	threadScope.store(parentScope, std::memory_order_relaxed);
 }
 
 
@@ -89,7 +99,10 @@ ScopedOnceTimer::ScopedOnceTimer(const std::string& timerName, const char* timer
 
 ScopedOnceTimer::~ScopedOnceTimer()
 {
-	LOG(frmt, __func__, name, int(GetDuration().toMilliSecsi()));
+	const spring_time duration = GetDuration();
+
+	CStartupTrace::AddEvent(name, "timer", startTime, duration);
+	LOG(frmt, __func__, name, int(duration.toMilliSecsi()));
 }
 
 spring_time ScopedOnceTimer::GetDuration() const
@@ -165,6 +178,27 @@ bool CTimeProfiler::RegisterTimer(const char* timerName)
 	return false;
 }
 
+std::string CTimeProfiler::GetTimerName(unsigned nameHash)
+{
+	// may be called from the crash handler, which must not wait for a lock its thread holds
+	std::unique_lock<HashNamMutexType> lock(hashToNameMutex, std::try_to_lock);
+
+	if (!lock.owns_lock())
+		return {};
+
+	const auto iter = hashToName.find(nameHash);
+
+	if (iter == hashToName.end())
+		return {};
+
+	return iter->second;
+}
+
+const std::atomic<unsigned>& CTimeProfiler::GetThreadScope()
+{
+	return threadScope;
+}
+
 bool CTimeProfiler::UnRegisterTimer(const char* timerName)
 {
 	const unsigned nameHash = hashString(timerName);
@@ -440,3 +474,36 @@ void CTimeProfiler::PrintProfilingInfo() const
 	}
 }
 
+void CTimeProfiler::WriteProfilingInfo(FILE* file) const
+{
+	std::vector< std::pair<std::string, TimeRecord> > records;
+
+	{
+		std::lock_guard<ProfileMutexType> lock(profileMutex);
+		std::lock_guard<HashNamMutexType> nameLock(hashToNameMutex);
+
+		records.reserve(profiles.size());
+
+		for (const auto& profile: profiles) {
+			const auto iter = hashToName.find(profile.first);
+
+			if (iter == hashToName.end())
+				continue;
+
+			records.emplace_back(iter->second, profile.second);
+		}
+	}
+
+	std::sort(records.begin(), records.end(), SortingFunctions[ST_ALPHABETICAL]);
+
+	fprintf(file, "\t\"timers\": {\n");
+
+	for (size_t i = 0, n = records.size(); i < n; i++) {
+		const TimeRecord& tr = records[i].second;
+
+		// timer names are literals without quotes or backslashes
+		fprintf(file, "\t\t\"%s\": {\"totalMs\": %.3f}%s\n", records[i].first.c_str(), tr.total.toMilliSecsf(), (i + 1 < n)? ",": "");
+	}
+
+	fprintf(file, "\t}\n");
+}
@@ -4,11 +4,13 @@
 #define TIME_PROFILER_H
 
 #include <atomic>
+#include <cstdio>
 #include <string>
 #include <deque>
 #include <vector>
 #include <array>
 
+#include "System/Misc/AllocCounter.h"
 #include "System/Misc/SpringTime.h"
 #include "System/Misc/NonCopyable.h"
 #include "System/float3.h"
@@ -20,8 +22,8 @@
 // disable these for minimal profiling; all special
 // timers contribute even when profiler is disabled
 // NB: names are assumed to be compile-time literals
-#define SCOPED_TIMER(      name)  ZoneScopedNC(name, tracy::Color::Goldenrod); static TimerNameRegistrar __tnr(name); ScopedTimer __scopedTimer(hashString(name));
-#define SCOPED_TIMER_NOREG(name)  ZoneScopedNC(name, tracy::Color::Goldenrod);                                        ScopedTimer __scopedTimer(hashString(name));
+#define SCOPED_TIMER(      name)  RECOIL_TRACY_TIMER_ZONE(name, tracy::Color::Goldenrod); static TimerNameRegistrar __tnr(name); ScopedTimer __scopedTimer(hashString(name)); SCOPED_ALLOC_TAG(name)
+#define SCOPED_TIMER_NOREG(name)  RECOIL_TRACY_TIMER_ZONE(name, tracy::Color::Goldenrod);                                     ScopedTimer __scopedTimer(hashString(name));
 
 #define SCOPED_SPECIAL_TIMER(      name)  static TimerNameRegistrar __stnr(name); ScopedTimer __scopedTimer(hashString(name), false, true);
 #define SCOPED_SPECIAL_TIMER_NOREG(name)                                          ScopedTimer __scopedTimer(hashString(name), false, true);
@@ -61,6 +63,9 @@ public:
 private:
 	const bool autoShowGraph;
 	const bool specialTimer;
+
+	/// scope of the enclosing timer, restored on destruction
+	const unsigned parentScope;
 };
 
 
@@ -108,6 +113,15 @@ public:
 	static bool RegisterTimer(const char* name);
 	static bool UnRegisterTimer(const char* name);
 
+	/// name of a registered timer, empty if unknown or if the name table is busy
+	static std::string GetTimerName(unsigned nameHash);
+	/**
+	 * Hash of the calling thread's innermost ScopedTimer (0 outside of any).
+	 * Written with relaxed stores only, other threads (the watchdog) may read
+	 * it through the returned reference for as long as the thread runs.
+	 */
+	static const std::atomic<unsigned>& GetThreadScope();
+
 	struct TimeRecord {
 		TimeRecord() {
 			frames.fill(spring_time(0));
@@ -188,7 +202,10 @@ public:
 	void CleanupOldThreadProfiles();
 
 	void SetEnabled(bool b) { enabled = b; }
+	bool IsEnabled() const { return enabled; }
 	void PrintProfilingInfo() const;
+	/// writes every timer's totals as a "timers" member of an enclosing JSON object
+	void WriteProfilingInfo(FILE* file) const;
 
 	void AddTime(
 		unsigned nameHash,
@@ -1,21 +1,32 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
-#if defined(TRACY_ENABLE)
+// compiled for TRACY_PROFILE_MEMORY and ALLOCATION_COUNTING builds, see CMakeLists.txt
+#if defined(TRACY_ENABLE) || defined(ALLOCATION_COUNTING)
 
 #include <new>
 #include <cstdlib>
+
+#if defined(TRACY_ENABLE)
 #include <tracy/Tracy.hpp>
+#endif
+
+#include "System/Misc/AllocCounter.h"
 
 void* operator new(std::size_t count)
 {
 	auto ptr = malloc(count);
+#if defined(TRACY_ENABLE)
 	TracyAlloc(ptr, count);
+#endif
+	CAllocCounter::Count(count);
 	return ptr;
 }
 
 void operator delete (void* ptr) noexcept
 {
+#if defined(TRACY_ENABLE)
 	TracyFree(ptr);
+#endif
 	free(ptr);
 }
 
@@ -56,6 +56,9 @@
 	}
 #endif
 
+// open-addressing alternative with SIMD probing and a capacity-independent iteration order
+#include "SpringFlatHashMap.hpp"
+
 
 namespace spring {
 	// Synced unordered maps must be reconstructed (on reload)
@@ -99,6 +99,13 @@ namespace creg
 			return std::unique_ptr<IType>(new MapType<spring::unsynced_map<TKey, TValue> >());
 		}
 	};
+	// pairs are written in iteration order and re-inserted in it, which restores the order
+	template<typename TKey, typename TValue>
+	struct DeduceType<spring::flat_hash_map<TKey, TValue> > {
+		static std::unique_ptr<IType> Get() {
+			return std::unique_ptr<IType>(new MapType<spring::flat_hash_map<TKey, TValue> >());
+		}
+	};
 
 	template<typename T>
 	struct PairType : public IType
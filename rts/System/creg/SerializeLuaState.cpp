@@ -14,6 +14,7 @@
 #include "System/UnorderedMap.hpp"
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
+#include <cmath>
 #include <deque>
 
 struct creg_lua_State;
@@ -114,11 +115,10 @@ union creg_TKey {
 };
 
 
+// not a creg class, tables serialize their nodes themselves
 struct creg_Node {
-	CR_DECLARE_STRUCT(creg_Node)
 	creg_TValue i_val;
 	creg_TKey i_key;
-	void Serialize(creg::ISerializer* s);
 };
 
 ASSERT_SIZE(Node)
@@ -390,6 +390,37 @@ union creg_GCObject {
 };
 
 
+// Serializes a non-null GCObject pointer whose type tag was already written
+static void SerializeGCObjectPtr(creg::ISerializer* s, void** ptr, int tt)
+{
+	creg::Class* c = nullptr;
+
+	switch(tt) {
+		case LUA_TSTRING: { c = creg_TString::StaticClass(); break; }
+		case LUA_TUSERDATA: { c = creg_Udata::StaticClass(); break; }
+		case LUA_TFUNCTION: {
+			bool isC;
+			if (s->IsWriting())
+				isC = ((creg_GCObject*) *ptr)->cl.c.isC;
+
+			s->SerializeInt(&isC, sizeof(isC));
+			if (isC) {
+				c = creg_CClosure::StaticClass();
+			} else {
+				c = creg_LClosure::StaticClass();
+			}
+			break;
+			}
+		case LUA_TTABLE: { c = creg_Table::StaticClass(); break; }
+		case LUA_TPROTO: { c = creg_Proto::StaticClass(); break; }
+		case LUA_TUPVAL: { c = creg_UpVal::StaticClass(); break; }
+		case LUA_TTHREAD: { c = creg_lua_State::StaticClass(); break; }
+		default: { assert(false); break; }
+	}
+
+	s->SerializeObjectPtr(ptr, c);
+}
+
 // Specialization because we have to figure the real class and not
 // serialize GCObject* pointers.
 namespace creg {
@@ -414,32 +445,7 @@ public:
 			return;
 		}
 
-		Class *c = nullptr;
-
-		switch(tt) {
-			case LUA_TSTRING: { c = creg_TString::StaticClass(); break; }
-			case LUA_TUSERDATA: { c = creg_Udata::StaticClass(); break; }
-			case LUA_TFUNCTION: {
-				bool isC;
-				if (s->IsWriting())
-					isC = gco->cl.c.isC;
-
-				s->SerializeInt(&isC, sizeof(isC));
-				if (isC) {
-					c = creg_CClosure::StaticClass();
-				} else {
-					c = creg_LClosure::StaticClass();
-				}
-				break;
-				}
-			case LUA_TTABLE: { c = creg_Table::StaticClass(); break; }
-			case LUA_TPROTO: { c = creg_Proto::StaticClass(); break; }
-			case LUA_TUPVAL: { c = creg_UpVal::StaticClass(); break; }
-			case LUA_TTHREAD: { c = creg_lua_State::StaticClass(); break; }
-			default: { assert(false); break; }
-		}
-
-		s->SerializeObjectPtr(ptr, c);
+		SerializeGCObjectPtr(s, ptr, tt);
 	}
 	std::string GetName() const override {
 		return "creg_GCObject*";
@@ -463,14 +469,6 @@ CR_REG_METADATA(creg_TValue, (
 ))
 
 
-CR_BIND_POOL(creg_Node, , allocProtector, freeProtector)
-CR_REG_METADATA(creg_Node, (
-	CR_MEMBER(i_val),
-	CR_IGNORED(i_key),
-	CR_SERIALIZER(Serialize)
-))
-
-
 CR_BIND_POOL(creg_Table, , luaContext.alloc, freeProtector)
 CR_REG_METADATA(creg_Table, (
 	CR_COMMON_HEADER(),
@@ -744,10 +742,76 @@ void creg_TValue::Serialize(creg::ISerializer* s)
 }
 
 
-void creg_Node::Serialize(creg::ISerializer* s)
+/*
+ * Values nothing else can point to (the array and node parts of tables and the
+ * constants of protos) skip the creg object bookkeeping SerializeInstance does.
+ * Each is written as a type tag and a payload; integral numbers get their own
+ * tag and are stored as zigzag varints, GC objects as plain creg pointers so
+ * interned strings and shared tables are still written once.
+ */
+static constexpr lu_byte COMPACT_TAG_INTEGER = LUA_TDEADKEY + 1;
+
+static bool IsCompactInteger(lua_Number n)
+{
+	// excludes NaN, -0 and anything that would not survive the int32 round-trip
+	if (!(n >= -2147483648.0 && n < 2147483648.0))
+		return false;
+
+	return (static_cast<lua_Number>(static_cast<int32_t>(n)) == n && !(n == 0 && std::signbit(n)));
+}
+
+static void SerializeCompactTValue(creg::ISerializer* s, creg_TValue* tv)
+{
+	lu_byte tag;
+	if (s->IsWriting()) {
+		tag = tv->tt;
+
+		if (tag == LUA_TNUMBER && IsCompactInteger(tv->value.n))
+			tag = COMPACT_TAG_INTEGER;
+	}
+
+	s->SerializeInt(&tag, sizeof(tag));
+
+	if (!s->IsWriting()) {
+		tv->tt = (tag == COMPACT_TAG_INTEGER)? LUA_TNUMBER: tag;
+		tv->value.gc = nullptr;
+	}
+
+	switch (tag) {
+		case COMPACT_TAG_INTEGER: {
+			uint32_t zigzag;
+			if (s->IsWriting()) {
+				const int32_t i = static_cast<int32_t>(tv->value.n);
+				zigzag = (static_cast<uint32_t>(i) << 1) ^ static_cast<uint32_t>(i >> 31);
+			}
+
+			s->SerializeInt(&zigzag, sizeof(zigzag));
+
+			if (!s->IsWriting())
+				tv->value.n = static_cast<lua_Number>(static_cast<int32_t>((zigzag >> 1) ^ -(zigzag & 1)));
+		} break;
+		case LUA_TSTRING:
+		case LUA_TTABLE:
+		case LUA_TFUNCTION:
+		case LUA_TUSERDATA:
+		case LUA_TTHREAD: {
+			SerializeGCObjectPtr(s, (void**) &tv->value.gc, tag);
+		} break;
+		default: {
+			tv->Serialize(s);
+		} break;
+	}
+}
+
+template<typename C>
+static void SerializeCompactTValues(creg::ISerializer* s, creg_TValue** vecPtr, C count)
 {
-	SerializeInstance(s, &i_key.tvk);
-	SerializePtr(s, &i_key.nk.next);
+	if (!s->IsWriting())
+		*vecPtr = (creg_TValue*) luaContext.alloc(count * sizeof(creg_TValue));
+
+	for (unsigned i = 0; i < unsigned(count); ++i) {
+		SerializeCompactTValue(s, &(*vecPtr)[i]);
+	}
 }
 
 
@@ -755,7 +819,7 @@ void creg_Table::Serialize(creg::ISerializer* s)
 {
 	int sizenode = twoto(lsizenode);
 
-	SerializeCVector(s, &array, sizearray);
+	SerializeCompactTValues(s, &array, sizearray);
 	bool empty;
 	creg_Node* dummy = GetDummyNode();
 	if (s->IsWriting())
@@ -770,7 +834,25 @@ void creg_Table::Serialize(creg::ISerializer* s)
 			assert(node == dummy);
 		}
 	} else {
-		SerializeCVector(s, &node, sizenode);
+		if (!s->IsWriting())
+			node = (creg_Node*) luaContext.alloc(sizenode * sizeof(creg_Node));
+
+		for (int i = 0; i < sizenode; ++i) {
+			creg_Node& n = node[i];
+
+			SerializeCompactTValue(s, &n.i_val);
+			SerializeCompactTValue(s, &n.i_key.tvk);
+
+			// chains never leave the node array, store them as index + 1
+			uint32_t nextIdx;
+			if (s->IsWriting())
+				nextIdx = (n.i_key.nk.next == nullptr)? 0: (n.i_key.nk.next - node) + 1;
+
+			s->SerializeInt(&nextIdx, sizeof(nextIdx));
+
+			if (!s->IsWriting())
+				n.i_key.nk.next = (nextIdx == 0)? nullptr: node + (nextIdx - 1);
+		}
 	}
 
 	ptrdiff_t lastfreeOffset;
@@ -817,7 +899,7 @@ void creg_Table::PostLoad()
 
 void creg_Proto::Serialize(creg::ISerializer* s)
 {
-	SerializeCVector(s, &k,        sizek);
+	SerializeCompactTValues(s, &k, sizek);
 	SerializeCVector(s, &code,     sizecode);
 	SerializeCVector(s, &p,        sizep);
 	SerializeCVector(s, &lineinfo, sizelineinfo);
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <string>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -11,6 +12,7 @@
 #include "Game/GameData.h"
 #include "Game/GameVersion.h"
 #include "Net/GameServer.h"
+#include "Net/GameServerHost.h"
 #include "System/Exceptions.h"
 #include "System/GlobalConfig.h"
 #include "System/GlobalRNG.h"
@@ -53,7 +55,7 @@ extern "C"
 {
 #endif
 
-void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
+void ParseCmdLine(int argc, char* argv[], std::vector<std::string>& scriptNames)
 {
 	#undef  LOG_SECTION_CURRENT
 	#define LOG_SECTION_CURRENT LOG_SECTION_DEFAULT
@@ -70,10 +72,11 @@ void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
 		exit(0);
 	}
 
-	if (argc >= 2)
-		scriptName = argv[1];
+	// more than one script hosts all of those games in this process
+	for (int i = 1; i < argc; i++)
+		scriptNames.emplace_back(argv[i]);
 
-	if (scriptName.empty() && !FLAGS_list_config_vars) {
+	if (scriptNames.empty() && !FLAGS_list_config_vars) {
 		gflags::ShowUsageWithFlags(argv[0]);
 		exit(1);
 	}
@@ -105,6 +108,84 @@ void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
 
 
 
+static bool LoadScript(
+	const std::string& scriptName,
+	CGlobalUnsyncedRNG& rng,
+	const std::shared_ptr<ClientSetup>& dsClientSetup,
+	const std::shared_ptr<GameData>& dsGameData,
+	const std::shared_ptr<CGameSetup>& dsGameSetup
+) {
+	LOG("loading script from file: %s", scriptName.c_str());
+
+	std::string scriptText;
+	CFileHandler fh(scriptName);
+
+	if (!fh.FileExists())
+		throw content_error("script does not exist in given location: " + scriptName);
+
+	if (!fh.LoadStringData(scriptText))
+		throw content_error("script cannot be read: " + scriptName);
+
+	dsClientSetup->LoadFromStartScript(scriptText);
+
+	if (!dsGameSetup->Init(scriptText)) {
+		// read the script provided by cmdline
+		LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
+		return false;
+	}
+
+	if (dsGameSetup->fixedRNGSeed == 0) {
+		dsGameData->SetRandomSeed(rng.NextInt());
+	} else {
+		dsGameData->SetRandomSeed(dsGameSetup->fixedRNGSeed);
+	}
+
+	{
+		sha512::raw_digest dsMapChecksum;
+		sha512::raw_digest dsModChecksum;
+		sha512::hex_digest dsMapChecksumHex;
+		sha512::hex_digest dsModChecksumHex;
+
+		std::memcpy(dsMapChecksum.data(), &dsGameSetup->dsMapHash[0], sizeof(dsGameSetup->dsMapHash));
+		std::memcpy(dsModChecksum.data(), &dsGameSetup->dsModHash[0], sizeof(dsGameSetup->dsModHash));
+		sha512::dump_digest(dsMapChecksum, dsMapChecksumHex);
+		sha512::dump_digest(dsModChecksum, dsModChecksumHex);
+
+		LOG("[script-checksums]\n\tmap=%s\n\tmod=%s", dsMapChecksumHex.data(), dsModChecksumHex.data());
+
+		// use script-provided hashes if any byte is non-zero; these
+		// are only used by some client-side (pregame) sanity checks
+		const auto hashPred = [](uint8_t byte) { return (byte != 0); };
+
+		if (std::find_if(dsMapChecksum.begin(), dsMapChecksum.end(), hashPred) != dsMapChecksum.end()) {
+			dsGameData->SetMapChecksum(dsMapChecksum.data());
+			dsGameSetup->LoadStartPositions(false); // reduced mode
+		} else {
+			dsGameData->SetMapChecksum(&archiveScanner->GetArchiveCompleteChecksumBytes(dsGameSetup->mapName)[0]);
+
+			CFileHandler f("maps/" + dsGameSetup->mapName);
+			if (!f.FileExists())
+				vfsHandler->AddArchiveWithDeps(dsGameSetup->mapName, false);
+
+			dsGameSetup->LoadStartPositions(); // full mode
+		}
+
+		if (std::find_if(dsModChecksum.begin(), dsModChecksum.end(), hashPred) != dsModChecksum.end()) {
+			dsGameData->SetModChecksum(dsModChecksum.data());
+		} else {
+			const std::string& modArchive = archiveScanner->ArchiveFromName(dsGameSetup->modName);
+			const sha512::raw_digest& modCheckSum = archiveScanner->GetArchiveCompleteChecksumBytes(modArchive);
+
+			dsGameData->SetModChecksum(&modCheckSum[0]);
+		}
+	}
+
+	dsGameData->SetSetupText(dsGameSetup->setupText);
+	return true;
+}
+
+
+
 int main(int argc, char* argv[])
 {
 	Threading::SetMainThread();
@@ -114,14 +195,13 @@ int main(int argc, char* argv[])
 		// since we are not using SDL_GetTicks as our clock anymore)
 		spring_time::setstarttime(spring_time::gettime(true));
 
-		std::string scriptName;
-		std::string scriptText;
+		std::vector<std::string> scriptNames;
 		std::string binaryName = argv[0];
 
-		gflags::SetUsageMessage("Usage: " + binaryName + " [options] path_to_script.txt");
+		gflags::SetUsageMessage("Usage: " + binaryName + " [options] path_to_script.txt [more_scripts.txt ...]");
 		gflags::SetVersionString(SpringVersion::GetFull());
 		gflags::ParseCommandLineFlags(&argc, &argv, true);
-		ParseCmdLine(argc, argv, scriptName);
+		ParseCmdLine(argc, argv, scriptNames);
 
 		CLogOutput::LogSectionInfo();
 		CLogOutput::LogConfigInfo();
@@ -135,86 +215,48 @@ int main(int argc, char* argv[])
 		CrashHandler::Install();
 
 		LOG("report any errors to Mantis or the forums.");
-		LOG("loading script from file: %s", scriptName.c_str());
-
-		// server will take ownership of these
-		std::shared_ptr<ClientSetup> dsClientSetup(new ClientSetup());
-		std::shared_ptr<GameData> dsGameData(new GameData());
-		std::shared_ptr<CGameSetup> dsGameSetup(new CGameSetup());
 
-		CFileHandler fh(scriptName);
-
-		if (!fh.FileExists())
-			throw content_error("script does not exist in given location: " + scriptName);
-
-		if (!fh.LoadStringData(scriptText))
-			throw content_error("script cannot be read: " + scriptName);
-
-		dsClientSetup->LoadFromStartScript(scriptText);
-
-		if (!dsGameSetup->Init(scriptText)) {
-			// read the script provided by cmdline
-			LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
-			return 1;
-		}
-
-		// create the server, it will run in a separate thread
 		CGlobalUnsyncedRNG rng;
 
 		const uint32_t sleepTime = FLAGS_sleeptime;
 		const uint32_t randSeed = time(nullptr) % ((spring_gettime().toNanoSecsi() + 1) * 9007);
 
 		rng.Seed(randSeed);
-		if (dsGameSetup->fixedRNGSeed == 0) {
-			dsGameData->SetRandomSeed(rng.NextInt());
-		} else {
-			dsGameData->SetRandomSeed(dsGameSetup->fixedRNGSeed);
-		}
-
-		{
-			sha512::raw_digest dsMapChecksum;
-			sha512::raw_digest dsModChecksum;
-			sha512::hex_digest dsMapChecksumHex;
-			sha512::hex_digest dsModChecksumHex;
-
-			std::memcpy(dsMapChecksum.data(), &dsGameSetup->dsMapHash[0], sizeof(dsGameSetup->dsMapHash));
-			std::memcpy(dsModChecksum.data(), &dsGameSetup->dsModHash[0], sizeof(dsGameSetup->dsModHash));
-			sha512::dump_digest(dsMapChecksum, dsMapChecksumHex);
-			sha512::dump_digest(dsModChecksum, dsModChecksumHex);
 
-			LOG("[script-checksums]\n\tmap=%s\n\tmod=%s", dsMapChecksumHex.data(), dsModChecksumHex.data());
+		if (scriptNames.size() > 1) {
+			LOG("starting %u servers...", unsigned(scriptNames.size()));
 
-			// use script-provided hashes if any byte is non-zero; these
-			// are only used by some client-side (pregame) sanity checks
-			const auto hashPred = [](uint8_t byte) { return (byte != 0); };
+			// all games share the host's threads and transport, and the archive cache
+			CGameServerHost host;
 
-			if (std::find_if(dsMapChecksum.begin(), dsMapChecksum.end(), hashPred) != dsMapChecksum.end()) {
-				dsGameData->SetMapChecksum(dsMapChecksum.data());
-				dsGameSetup->LoadStartPositions(false); // reduced mode
-			} else {
-				dsGameData->SetMapChecksum(&archiveScanner->GetArchiveCompleteChecksumBytes(dsGameSetup->mapName)[0]);
+			for (size_t i = 0; i < scriptNames.size(); i++) {
+				// server will take ownership of these
+				std::shared_ptr<ClientSetup> dsClientSetup(new ClientSetup());
+				std::shared_ptr<GameData> dsGameData(new GameData());
+				std::shared_ptr<CGameSetup> dsGameSetup(new CGameSetup());
 
-				CFileHandler f("maps/" + dsGameSetup->mapName);
-				if (!f.FileExists())
-					vfsHandler->AddArchiveWithDeps(dsGameSetup->mapName, false);
+				if (!LoadScript(scriptNames[i], rng, dsClientSetup, dsGameData, dsGameSetup))
+					return 1;
 
-				dsGameSetup->LoadStartPositions(); // full mode
+				// peers of this game select it with "game_id" in their DCF config
+				host.AddGame(dsClientSetup, dsGameData, dsGameSetup, i + 1);
 			}
 
-			if (std::find_if(dsModChecksum.begin(), dsModChecksum.end(), hashPred) != dsModChecksum.end()) {
-				dsGameData->SetModChecksum(dsModChecksum.data());
-			} else {
-				const std::string& modArchive = archiveScanner->ArchiveFromName(dsGameSetup->modName);
-				const sha512::raw_digest& modCheckSum = archiveScanner->GetArchiveCompleteChecksumBytes(modArchive);
-
-				dsGameData->SetModChecksum(&modCheckSum[0]);
+			while (host.RemoveFinishedGames() > 0) {
+				spring_secs(sleepTime).sleep(true);
 			}
-		}
+		} else {
+			// server will take ownership of these
+			std::shared_ptr<ClientSetup> dsClientSetup(new ClientSetup());
+			std::shared_ptr<GameData> dsGameData(new GameData());
+			std::shared_ptr<CGameSetup> dsGameSetup(new CGameSetup());
+
+			if (!LoadScript(scriptNames[0], rng, dsClientSetup, dsGameData, dsGameSetup))
+				return 1;
 
-		LOG("starting server...");
+			LOG("starting server...");
 
-		{
-			dsGameData->SetSetupText(dsGameSetup->setupText);
+			// create the server, it will run in a separate thread
 			CGameServer server(dsClientSetup, dsGameData, dsGameSetup);
 
 			while (!server.HasGameID()) {
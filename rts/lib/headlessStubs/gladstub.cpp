@@ -51,6 +51,7 @@ int GLAD_GL_ARB_shading_language_420pack = 0;
 int GLAD_GL_ARB_shading_language_100 = 0;
 int GLAD_GL_ARB_shader_storage_buffer_object = 0;
 int GLAD_GL_ARB_seamless_cube_map = 0;
+int GLAD_GL_ARB_parallel_shader_compile = 0;
 int GLAD_GL_ARB_occlusion_query = 0;
 int GLAD_GL_ARB_multi_draw_indirect = 0;
 int GLAD_GL_ARB_multitexture = 1;
@@ -59,6 +60,7 @@ int GLAD_GL_ARB_map_buffer_range = 0;
 int GLAD_GL_ARB_invalidate_subdata = 0;
 int GLAD_GL_ARB_instanced_arrays = 0;
 int GLAD_GL_ARB_imaging = 0;
+int GLAD_GL_ARB_get_program_binary = 0;
 int GLAD_GL_ARB_framebuffer_object = 1;
 int GLAD_GL_ARB_fragment_shader = 0;
 int GLAD_GL_ARB_fragment_program = 0;
@@ -71,7 +73,9 @@ int GLAD_GL_ARB_copy_buffer = 0;
 int GLAD_GL_ARB_conservative_depth = 0;
 int GLAD_GL_ARB_clip_control = 0;
 int GLAD_GL_ARB_buffer_storage = 0;
+int GLAD_GL_ARB_base_instance = 0;
 int GLAD_GL_KHR_debug = 0;
+int GLAD_GL_KHR_parallel_shader_compile = 0;
 
 GLenum APIENTRY impl_glCheckFramebufferStatus(GLenum target) {
     return GL_FRAMEBUFFER_COMPLETE;
@@ -124,11 +128,14 @@ decltype(glad_glBindFramebuffer) glad_glBindFramebuffer = nullptr;
 decltype(glad_glBindImageTexture) glad_glBindImageTexture = nullptr;
 decltype(glad_glBindRenderbuffer) glad_glBindRenderbuffer = nullptr;
 decltype(glad_glBindTexture) glad_glBindTexture = nullptr;
+decltype(glad_glBindTextures) glad_glBindTextures = nullptr;
+decltype(glad_glBindTextureUnit) glad_glBindTextureUnit = nullptr;
 decltype(glad_glBindVertexArray) glad_glBindVertexArray = nullptr;
 decltype(glad_glBlendColor) glad_glBlendColor = nullptr;
 decltype(glad_glBlendEquation) glad_glBlendEquation = nullptr;
 decltype(glad_glBlendEquationSeparate) glad_glBlendEquationSeparate = nullptr;
 decltype(glad_glBlendFunc) glad_glBlendFunc = nullptr;
+decltype(glad_glBlendFunci) glad_glBlendFunci = nullptr;
 decltype(glad_glBlendFuncSeparate) glad_glBlendFuncSeparate = nullptr;
 decltype(glad_glBlendFuncSeparatei) glad_glBlendFuncSeparatei = nullptr;
 decltype(glad_glBlitFramebuffer) glad_glBlitFramebuffer = nullptr;
@@ -136,6 +143,7 @@ decltype(glad_glBufferData) glad_glBufferData = nullptr;
 decltype(glad_glBufferStorage) glad_glBufferStorage = nullptr;
 decltype(glad_glBufferSubData) glad_glBufferSubData = nullptr;
 decltype(glad_glCallList) glad_glCallList = nullptr;
+decltype(glad_glCallLists) glad_glCallLists = nullptr;
 decltype(glad_glCheckFramebufferStatus) glad_glCheckFramebufferStatus = nullptr;
 decltype(glad_glClear) glad_glClear = nullptr;
 decltype(glad_glClearAccum) glad_glClearAccum = nullptr;
@@ -186,9 +194,11 @@ decltype(glad_glDepthRangef) glad_glDepthRangef = nullptr;
 decltype(glad_glDetachShader) glad_glDetachShader = nullptr;
 decltype(glad_glDisable) glad_glDisable = nullptr;
 decltype(glad_glDisableClientState) glad_glDisableClientState = nullptr;
+decltype(glad_glDisablei) glad_glDisablei = nullptr;
 decltype(glad_glDisableVertexAttribArray) glad_glDisableVertexAttribArray = nullptr;
 decltype(glad_glDispatchCompute) glad_glDispatchCompute = nullptr;
 decltype(glad_glDrawArrays) glad_glDrawArrays = nullptr;
+decltype(glad_glDrawArraysIndirect) glad_glDrawArraysIndirect = nullptr;
 decltype(glad_glDrawArraysInstanced) glad_glDrawArraysInstanced = nullptr;
 decltype(glad_glDrawArraysInstancedBaseInstance) glad_glDrawArraysInstancedBaseInstance = nullptr;
 decltype(glad_glDrawBuffer) glad_glDrawBuffer = nullptr;
@@ -204,6 +214,7 @@ decltype(glad_glDrawRangeElements) glad_glDrawRangeElements = nullptr;
 decltype(glad_glEdgeFlag) glad_glEdgeFlag = nullptr;
 decltype(glad_glEnable) glad_glEnable = nullptr;
 decltype(glad_glEnableClientState) glad_glEnableClientState = nullptr;
+decltype(glad_glEnablei) glad_glEnablei = nullptr;
 decltype(glad_glEnableVertexAttribArray) glad_glEnableVertexAttribArray = nullptr;
 decltype(glad_glEnd) glad_glEnd = nullptr;
 decltype(glad_glEndConditionalRender) glad_glEndConditionalRender = nullptr;
@@ -252,6 +263,7 @@ decltype(glad_glGetFramebufferParameteriv) glad_glGetFramebufferParameteriv = nu
 decltype(glad_glGetIntegeri_v) glad_glGetIntegeri_v = nullptr;
 decltype(glad_glGetIntegerv) glad_glGetIntegerv = nullptr;
 decltype(glad_glGetProgramInfoLog) glad_glGetProgramInfoLog = nullptr;
+decltype(glad_glGetProgramBinary) glad_glGetProgramBinary = nullptr;
 decltype(glad_glGetProgramiv) glad_glGetProgramiv = nullptr;
 decltype(glad_glGetQueryObjectiv) glad_glGetQueryObjectiv = nullptr;
 decltype(glad_glGetQueryObjectui64v) glad_glGetQueryObjectui64v = nullptr;
@@ -299,10 +311,13 @@ decltype(glad_glMapGrid2f) glad_glMapGrid2f = nullptr;
 decltype(glad_glMaterialf) glad_glMaterialf = nullptr;
 decltype(glad_glMaterialfv) glad_glMaterialfv = nullptr;
 decltype(glad_glMatrixMode) glad_glMatrixMode = nullptr;
+decltype(glad_glMaxShaderCompilerThreadsARB) glad_glMaxShaderCompilerThreadsARB = nullptr;
+decltype(glad_glMaxShaderCompilerThreadsKHR) glad_glMaxShaderCompilerThreadsKHR = nullptr;
 decltype(glad_glMemoryBarrier) glad_glMemoryBarrier = nullptr;
 decltype(glad_glMinSampleShading) glad_glMinSampleShading = nullptr;
 decltype(glad_glMultMatrixd) glad_glMultMatrixd = nullptr;
 decltype(glad_glMultMatrixf) glad_glMultMatrixf = nullptr;
+decltype(glad_glMultiDrawArraysIndirect) glad_glMultiDrawArraysIndirect = nullptr;
 decltype(glad_glMultiDrawElementsIndirect) glad_glMultiDrawElementsIndirect = nullptr;
 decltype(glad_glMultiTexCoord1f) glad_glMultiTexCoord1f = nullptr;
 decltype(glad_glMultiTexCoord2f) glad_glMultiTexCoord2f = nullptr;
@@ -327,6 +342,7 @@ decltype(glad_glPopAttrib) glad_glPopAttrib = nullptr;
 decltype(glad_glPopMatrix) glad_glPopMatrix = nullptr;
 decltype(glad_glPopName) glad_glPopName = nullptr;
 decltype(glad_glPrimitiveRestartIndex) glad_glPrimitiveRestartIndex = nullptr;
+decltype(glad_glProgramBinary) glad_glProgramBinary = nullptr;
 decltype(glad_glProgramParameteri) glad_glProgramParameteri = nullptr;
 decltype(glad_glPushAttrib) glad_glPushAttrib = nullptr;
 decltype(glad_glPushMatrix) glad_glPushMatrix = nullptr;
@@ -563,11 +579,14 @@ int gladLoadGL(void) {
     glad_glBindImageTexture = MakeStubImpl(glad_glBindImageTexture);
     glad_glBindRenderbuffer = MakeStubImpl(glad_glBindRenderbuffer);
     glad_glBindTexture = MakeStubImpl(glad_glBindTexture);
+    glad_glBindTextures = MakeStubImpl(glad_glBindTextures);
+    glad_glBindTextureUnit = MakeStubImpl(glad_glBindTextureUnit);
     glad_glBindVertexArray = MakeStubImpl(glad_glBindVertexArray);
     glad_glBlendColor = MakeStubImpl(glad_glBlendColor);
     glad_glBlendEquation = MakeStubImpl(glad_glBlendEquation);
     glad_glBlendEquationSeparate = MakeStubImpl(glad_glBlendEquationSeparate);
     glad_glBlendFunc = MakeStubImpl(glad_glBlendFunc);
+    glad_glBlendFunci = MakeStubImpl(glad_glBlendFunci);
     glad_glBlendFuncSeparate = MakeStubImpl(glad_glBlendFuncSeparate);
     glad_glBlendFuncSeparatei = MakeStubImpl(glad_glBlendFuncSeparatei);
     glad_glBlitFramebuffer = MakeStubImpl(glad_glBlitFramebuffer);
@@ -576,6 +595,7 @@ int gladLoadGL(void) {
     glad_glBufferSubData = MakeStubImpl(glad_glBufferSubData);
     glad_glCallList = MakeStubImpl(glad_glCallList);
     glad_glCheckFramebufferStatus = impl_glCheckFramebufferStatus;
+    glad_glCallLists = MakeStubImpl(glad_glCallLists);
     glad_glClear = MakeStubImpl(glad_glClear);
     glad_glClearAccum = MakeStubImpl(glad_glClearAccum);
     glad_glClearBufferData = MakeStubImpl(glad_glClearBufferData);
@@ -625,9 +645,11 @@ int gladLoadGL(void) {
     glad_glDetachShader = MakeStubImpl(glad_glDetachShader);
     glad_glDisable = MakeStubImpl(glad_glDisable);
     glad_glDisableClientState = MakeStubImpl(glad_glDisableClientState);
+    glad_glDisablei = MakeStubImpl(glad_glDisablei);
     glad_glDisableVertexAttribArray = MakeStubImpl(glad_glDisableVertexAttribArray);
     glad_glDispatchCompute = MakeStubImpl(glad_glDispatchCompute);
     glad_glDrawArrays = MakeStubImpl(glad_glDrawArrays);
+    glad_glDrawArraysIndirect = MakeStubImpl(glad_glDrawArraysIndirect);
     glad_glDrawArraysInstanced = MakeStubImpl(glad_glDrawArraysInstanced);
     glad_glDrawArraysInstancedBaseInstance = MakeStubImpl(glad_glDrawArraysInstancedBaseInstance);
     glad_glDrawBuffer = MakeStubImpl(glad_glDrawBuffer);
@@ -643,6 +665,7 @@ int gladLoadGL(void) {
     glad_glEdgeFlag = MakeStubImpl(glad_glEdgeFlag);
     glad_glEnable = MakeStubImpl(glad_glEnable);
     glad_glEnableClientState = MakeStubImpl(glad_glEnableClientState);
+    glad_glEnablei = MakeStubImpl(glad_glEnablei);
     glad_glEnableVertexAttribArray = MakeStubImpl(glad_glEnableVertexAttribArray);
     glad_glEnd = MakeStubImpl(glad_glEnd);
     glad_glEndConditionalRender = MakeStubImpl(glad_glEndConditionalRender);
@@ -691,6 +714,7 @@ int gladLoadGL(void) {
     glad_glGetIntegeri_v = MakeStubImpl(glad_glGetIntegeri_v);
     glad_glGetIntegerv = MakeStubImpl(glad_glGetIntegerv);
     glad_glGetProgramInfoLog = MakeStubImpl(glad_glGetProgramInfoLog);
+    glad_glGetProgramBinary = MakeStubImpl(glad_glGetProgramBinary);
     glad_glGetProgramiv = MakeStubImpl(glad_glGetProgramiv);
     glad_glGetQueryObjectiv = MakeStubImpl(glad_glGetQueryObjectiv);
     glad_glGetQueryObjectui64v = MakeStubImpl(glad_glGetQueryObjectui64v);
@@ -738,10 +762,13 @@ int gladLoadGL(void) {
     glad_glMaterialf = MakeStubImpl(glad_glMaterialf);
     glad_glMaterialfv = MakeStubImpl(glad_glMaterialfv);
     glad_glMatrixMode = MakeStubImpl(glad_glMatrixMode);
+    glad_glMaxShaderCompilerThreadsARB = MakeStubImpl(glad_glMaxShaderCompilerThreadsARB);
+    glad_glMaxShaderCompilerThreadsKHR = MakeStubImpl(glad_glMaxShaderCompilerThreadsKHR);
     glad_glMemoryBarrier = MakeStubImpl(glad_glMemoryBarrier);
     glad_glMinSampleShading = MakeStubImpl(glad_glMinSampleShading);
     glad_glMultMatrixd = MakeStubImpl(glad_glMultMatrixd);
     glad_glMultMatrixf = MakeStubImpl(glad_glMultMatrixf);
+    glad_glMultiDrawArraysIndirect = MakeStubImpl(glad_glMultiDrawArraysIndirect);
     glad_glMultiDrawElementsIndirect = MakeStubImpl(glad_glMultiDrawElementsIndirect);
     glad_glMultiTexCoord1f = MakeStubImpl(glad_glMultiTexCoord1f);
     glad_glMultiTexCoord2f = MakeStubImpl(glad_glMultiTexCoord2f);
@@ -766,6 +793,7 @@ int gladLoadGL(void) {
     glad_glPopMatrix = MakeStubImpl(glad_glPopMatrix);
     glad_glPopName = MakeStubImpl(glad_glPopName);
     glad_glPrimitiveRestartIndex = MakeStubImpl(glad_glPrimitiveRestartIndex);
+    glad_glProgramBinary = MakeStubImpl(glad_glProgramBinary);
     glad_glProgramParameteri = MakeStubImpl(glad_glProgramParameteri);
     glad_glPushAttrib = MakeStubImpl(glad_glPushAttrib);
     glad_glPushMatrix = MakeStubImpl(glad_glPushMatrix);
@@ -233,7 +233,7 @@ const char* spring_lua_get_handle_name(lua_State* L)
 static constexpr const char* LUA_OOM_FMT_STR = "[%s][handle=%s][OOM] synced=%d {alloced,maximum}={" _STPF_ "," _STPF_ "}bytes\n";
 
 // tracks allocations across all states
-static SLuaAllocState gLuaAllocState = {{0}, {0}, {0}, {0}};
+static SLuaAllocState gLuaAllocState = {{0}, {0}, {0}, {0}, {0}};
 static SLuaAllocError gLuaAllocError = {};
 
 void spring_lua_alloc_log_error(const luaContextData* lcd)
@@ -288,6 +288,7 @@ void* spring_lua_alloc(void* ud, void* ptr, size_t osize, size_t nsize)
 	gLuaAllocState.luaAllocTime += (t1 - t0).toMicroSecsi();
 	las->numLuaAllocs += 1;
 	las->luaAllocTime += (t1 - t0).toMicroSecsi();
+	las->numAllocBytes += (nsize > osize)? (nsize - osize): 0;
 
 	return mem;
 }
@@ -0,0 +1,171 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Game/FormationUnitGrid.h"
+#include "System/float3.h"
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+typedef CFormationUnitGrid::UnitReference UnitReference;
+
+// the scan CSelectedUnitsHandlerAI::MakeFormationFrontOrder used before the grid
+static std::vector<int> LinearAssign(
+	std::vector<UnitReference> unassignedUnits,
+	const std::vector<int>& slotTypes,
+	const std::vector<float3>& slotPositions
+) {
+	std::vector<int> unitIDs;
+	unitIDs.reserve(slotTypes.size());
+
+	for (size_t i = 0; i < slotTypes.size(); i++) {
+		size_t closestUnit = 0;
+		float closestDistSq = std::numeric_limits<float>::infinity();
+
+		for (size_t j = 0; j < unassignedUnits.size(); j++) {
+			if (unassignedUnits[j].unitDefId != slotTypes[i])
+				continue;
+
+			const float curDistSq = unassignedUnits[j].pos.SqDistance(slotPositions[i]);
+
+			if (curDistSq < closestDistSq) {
+				closestUnit = j;
+				closestDistSq = curDistSq;
+			}
+		}
+
+		unitIDs.push_back(unassignedUnits[closestUnit].unitId);
+		unassignedUnits[closestUnit] = unassignedUnits.back();
+		unassignedUnits.pop_back();
+	}
+
+	return unitIDs;
+}
+
+static std::vector<int> GridAssign(
+	const std::vector<UnitReference>& units,
+	const std::vector<int>& slotTypes,
+	const std::vector<float3>& slotPositions
+) {
+	CFormationUnitGrid grid;
+	std::vector<int> unitIDs;
+	unitIDs.reserve(slotTypes.size());
+
+	grid.Init(units);
+
+	for (size_t i = 0; i < slotTypes.size(); i++) {
+		unitIDs.push_back(grid.PopClosest(slotTypes[i], slotPositions[i]));
+	}
+
+	return unitIDs;
+}
+
+// one slot per unit, slot types are a shuffled copy of the unit types
+static void MakeSlots(
+	const std::vector<UnitReference>& units,
+	std::mt19937& rng,
+	std::vector<int>& slotTypes,
+	std::vector<float3>& slotPositions,
+	float extent
+) {
+	std::uniform_real_distribution<float> coord(0.0f, extent);
+
+	slotTypes.clear();
+	slotPositions.clear();
+
+	for (const UnitReference& unit: units) {
+		slotTypes.push_back(unit.unitDefId);
+		slotPositions.emplace_back(coord(rng), 0.0f, coord(rng));
+	}
+
+	std::shuffle(slotTypes.begin(), slotTypes.end(), rng);
+}
+
+
+TEST_CASE("FormationUnitGridRandom")
+{
+	for (uint32_t seed = 1; seed <= 32; seed++) {
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> coord(0.0f, 4096.0f);
+
+		const int numUnits = 1 + (rng() % 500);
+		const int numTypes = 1 + (rng() % 8);
+
+		std::vector<UnitReference> units;
+		std::vector<int> slotTypes;
+		std::vector<float3> slotPositions;
+
+		for (int i = 0; i < numUnits; i++) {
+			units.emplace_back(i, rng() % numTypes, float3(coord(rng), 0.0f, coord(rng)));
+		}
+
+		MakeSlots(units, rng, slotTypes, slotPositions, 4096.0f);
+
+		INFO("seed " << seed);
+		CHECK(GridAssign(units, slotTypes, slotPositions) == LinearAssign(units, slotTypes, slotPositions));
+	}
+}
+
+TEST_CASE("FormationUnitGridStacked")
+{
+	for (uint32_t seed = 1; seed <= 32; seed++) {
+		std::mt19937 rng(seed);
+
+		const int numUnits = 1 + (rng() % 300);
+		const int numTypes = 1 + (rng() % 3);
+
+		std::vector<UnitReference> units;
+		std::vector<int> slotTypes;
+		std::vector<float3> slotPositions;
+
+		// few distinct positions on a coarse lattice, so many units share a
+		// position and many are equally far from a lattice-aligned slot
+		for (int i = 0; i < numUnits; i++) {
+			units.emplace_back(i, rng() % numTypes, float3((rng() % 4) * 64.0f, 0.0f, (rng() % 4) * 64.0f));
+		}
+
+		for (const UnitReference& unit: units) {
+			slotTypes.push_back(unit.unitDefId);
+			slotPositions.emplace_back((rng() % 7) * 32.0f, 0.0f, (rng() % 7) * 32.0f);
+		}
+
+		std::shuffle(slotTypes.begin(), slotTypes.end(), rng);
+
+		INFO("seed " << seed);
+		CHECK(GridAssign(units, slotTypes, slotPositions) == LinearAssign(units, slotTypes, slotPositions));
+	}
+}
+
+TEST_CASE("FormationUnitGridSamePosition")
+{
+	std::vector<UnitReference> units;
+	std::vector<int> slotTypes;
+	std::vector<float3> slotPositions;
+
+	for (int i = 0; i < 64; i++) {
+		units.emplace_back(i, i % 2, float3(100.0f, 0.0f, 100.0f));
+	}
+
+	std::mt19937 rng(64);
+	MakeSlots(units, rng, slotTypes, slotPositions, 200.0f);
+
+	CHECK(GridAssign(units, slotTypes, slotPositions) == LinearAssign(units, slotTypes, slotPositions));
+}
+
+TEST_CASE("FormationUnitGridMissingType")
+{
+	// slots asking for a type with no units left fall back to the front unit
+	std::vector<UnitReference> units;
+	std::vector<int> slotTypes;
+	std::vector<float3> slotPositions;
+
+	for (int i = 0; i < 16; i++) {
+		units.emplace_back(i, i % 4, float3(i * 16.0f, 0.0f, 0.0f));
+		slotTypes.push_back((i < 8) ? 0 : 7);
+		slotPositions.emplace_back(256.0f - i * 16.0f, 0.0f, 0.0f);
+	}
+
+	CHECK(GridAssign(units, slotTypes, slotPositions) == LinearAssign(units, slotTypes, slotPositions));
+}
@@ -1,5 +1,6 @@
 
 #include "System/Log/ILog.h"
+#include "System/Log/Backend.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/StreamSink.h"
 #include "System/Log/LogUtil.h"
@@ -8,6 +9,9 @@
 
 #include <cstdarg>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 
 
@@ -231,3 +235,54 @@ TEST_CASE("IsEnabled")
 	TLOG_SL(   "other-one-time-section", L_DEBUG, "Testing LOG_IS_ENABLED_S");
 }
 
+
+TEST_CASE("Async")
+{
+	constexpr int NUM_THREADS = 4;
+	constexpr int NUM_RECORDS = 1000;
+
+	log_backend_setAsync(true);
+
+	std::vector<std::thread> threads;
+
+	for (int t = 0; t < NUM_THREADS; t++) {
+		threads.emplace_back([t]() {
+			for (int i = 0; i < NUM_RECORDS; i++) {
+				LOG("(Async) thread=%d record=%d", t, i);
+			}
+		});
+	}
+
+	for (std::thread& t: threads) {
+		t.join();
+	}
+
+	// sinks everything still queued
+	log_backend_setAsync(false);
+
+	std::vector<int> nextRecords(NUM_THREADS, 0);
+	std::string line;
+
+	// every record arrives exactly once, in order per thread
+	while (std::getline(ls.logStream, line)) {
+		int t = -1;
+		int i = -1;
+
+		if (sscanf(line.c_str(), "(Async) thread=%d record=%d", &t, &i) != 2)
+			continue;
+
+		REQUIRE(t >= 0);
+		REQUIRE(t < NUM_THREADS);
+		CHECK(i == nextRecords[t]++);
+	}
+
+	for (int t = 0; t < NUM_THREADS; t++) {
+		CHECK(nextRecords[t] == NUM_RECORDS);
+	}
+
+	ls.logStream.str(std::string());
+	ls.logStream.clear();
+
+	LOG( "Testing sync logging after async");
+	TLOG("Testing sync logging after async");
+}
@@ -0,0 +1,118 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Net/MessageDeltaCodec.h"
+#include "System/Net/RawPacket.h"
+#include "Net/Protocol/NetMessageTypes.h"
+
+#include <cstring>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+using netcode::MessageDeltaCodec;
+using netcode::RawPacket;
+
+static std::shared_ptr<const RawPacket> MakeCommand(uint8_t playerNum, int32_t cmdID, const std::vector<float>& params)
+{
+	const uint16_t size = 1 + 2 + 1 + 4 + 1 + params.size() * sizeof(float);
+
+	std::shared_ptr<RawPacket> pkt(new RawPacket(size, NETMSG_COMMAND));
+	*pkt << size << playerNum << cmdID << uint8_t(0) << params;
+	return pkt;
+}
+
+static bool SameBytes(const RawPacket& a, const RawPacket& b)
+{
+	return (a.length == b.length && std::memcmp(a.data, b.data, a.length) == 0);
+}
+
+// what UDPConnection::ReceiveMessage does with every message
+static std::shared_ptr<const RawPacket> Receive(MessageDeltaCodec& codec, const RawPacket& wire)
+{
+	if (wire.data[0] == netcode::NETMSG_CONN_DELTA)
+		return codec.Decode(wire.data, wire.length);
+
+	codec.Observe(wire.data, wire.length);
+	return std::shared_ptr<const RawPacket>(new RawPacket(wire.data, wire.length));
+}
+
+
+TEST_CASE("MessageDeltaCodec")
+{
+	MessageDeltaCodec sender;
+	MessageDeltaCodec receiver;
+
+	sender.SetEncoding(true);
+
+	SECTION("first message of a type is sent raw") {
+		const auto cmd = MakeCommand(3, 10, {100.0f, 0.0f, 200.0f});
+		const auto wire = sender.Encode(cmd);
+
+		CHECK(wire == cmd);
+		CHECK(sender.GetNumEncoded() == 0);
+	}
+
+	SECTION("similar commands round-trip and shrink") {
+		for (int i = 0; i < 50; i++) {
+			const auto cmd = MakeCommand(3, 10, {100.0f + i, 0.0f, 200.0f, 1.0f, 2.0f, 3.0f});
+			const auto wire = sender.Encode(cmd);
+			const auto recv = Receive(receiver, *wire);
+
+			REQUIRE(recv != nullptr);
+			CHECK(SameBytes(*recv, *cmd));
+		}
+
+		CHECK(sender.GetNumEncoded() == 49);
+		CHECK(sender.GetEncodedBytes() < sender.GetRawBytes());
+	}
+
+	SECTION("size changes and unrelated types stay in sync") {
+		const std::vector<std::shared_ptr<const RawPacket>> cmds = {
+			MakeCommand(1, 20, {}),
+			MakeCommand(1, 20, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f}),
+			MakeCommand(1, 20, {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f}),
+			MakeCommand(2, 21, {1.0f, 2.0f, 3.0f}),
+			MakeCommand(2, 21, {1.0f, 2.0f, 3.0f}),
+		};
+
+		for (const auto& cmd: cmds) {
+			const auto wire = sender.Encode(cmd);
+			const auto recv = Receive(receiver, *wire);
+
+			REQUIRE(recv != nullptr);
+			CHECK(SameBytes(*recv, *cmd));
+
+			// not eligible, passes through untouched
+			const uint8_t ping[] = {NETMSG_NEWFRAME};
+			const std::shared_ptr<const RawPacket> frame(new RawPacket(ping, sizeof(ping)));
+			CHECK(sender.Encode(frame) == frame);
+		}
+	}
+
+	SECTION("encoding can be switched on later") {
+		MessageDeltaCodec lateSender;
+
+		for (int i = 0; i < 4; i++) {
+			lateSender.SetEncoding(i >= 2);
+
+			const auto cmd = MakeCommand(5, 30, {float(i), 1.0f, 1.0f, 1.0f});
+			const auto recv = Receive(receiver, *lateSender.Encode(cmd));
+
+			REQUIRE(recv != nullptr);
+			CHECK(SameBytes(*recv, *cmd));
+		}
+
+		CHECK(lateSender.GetNumEncoded() == 2);
+	}
+
+	SECTION("malformed delta messages are rejected") {
+		sender.Encode(MakeCommand(3, 10, {1.0f, 2.0f, 3.0f, 4.0f}));
+		const auto wire = sender.Encode(MakeCommand(3, 10, {1.0f, 2.0f, 3.0f, 5.0f}));
+
+		REQUIRE(wire->data[0] == netcode::NETMSG_CONN_DELTA);
+
+		// receiver never saw the base
+		CHECK(receiver.Decode(wire->data, wire->length) == nullptr);
+		CHECK(receiver.Decode(wire->data, MessageDeltaCodec::HEADER_SIZE - 1) == nullptr);
+	}
+}
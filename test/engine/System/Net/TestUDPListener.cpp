@@ -1,9 +1,14 @@
 
 #include "System/Net/UDPListener.h"
+#include "System/Net/UDPConnection.h"
+#include "Net/Protocol/BaseNetProtocol.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
 
 #include <catch_amalgamated.hpp>
 
+InitSpringTime ist;
+
 namespace streflop {
 	template<typename T> inline void streflop_init() {
 		// Do nothing by default, or for unknown types
@@ -93,3 +98,42 @@ TEST_CASE("TryBindSocket")
 	t.TestPort(-1, false);
 }
 
+
+TEST_CASE("MultiSocketListener")
+{
+	netcode::UDPListener listener(0, "127.0.0.1", 4);
+
+#if defined(SO_REUSEPORT)
+	CHECK(listener.GetNumSockets() == 4);
+#else
+	CHECK(listener.GetNumSockets() == 1);
+#endif
+
+	const unsigned port = listener.GetSocket()->local_endpoint().port();
+
+	// every client (source port) is routed to one of the sockets by the kernel,
+	// its connection has to come out of Update() like with a single socket
+	std::vector< std::shared_ptr<netcode::UDPConnection> > clients;
+	std::vector< std::shared_ptr<netcode::UDPConnection> > accepted;
+
+	for (int i = 0; i < 8; i++) {
+		clients.emplace_back(new netcode::UDPConnection(0, "127.0.0.1", port));
+		clients.back()->Unmute();
+		clients.back()->SendData(CBaseNetProtocol::Get().SendKeyFrame(i));
+		clients.back()->Flush(true);
+	}
+
+	for (int n = 0; n < 100 && accepted.size() < clients.size(); n++) {
+		listener.Update(10);
+
+		while (listener.HasIncomingConnections()) {
+			accepted.push_back(listener.AcceptConnection());
+		}
+	}
+
+	CHECK(accepted.size() == clients.size());
+
+	for (const auto& conn: accepted) {
+		CHECK(conn->HasIncomingData());
+	}
+}
@@ -0,0 +1,88 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Threading/MPSCRingBuffer.h"
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <catch_amalgamated.hpp>
+
+
+TEST_CASE("MPSCRingBuffer_SingleThread")
+{
+	Recoil::MPSCRingBuffer<std::shared_ptr<int>> ring(5);
+
+	CHECK(ring.Capacity() == 8);
+	CHECK(ring.Empty());
+	CHECK(ring.Peek(0) == nullptr);
+
+	for (int i = 0; i < 8; ++i) {
+		CHECK(ring.Push(std::make_shared<int>(i)));
+	}
+
+	// full
+	CHECK_FALSE(ring.Push(std::make_shared<int>(8)));
+	CHECK(ring.Size() == 8);
+
+	REQUIRE(ring.Peek(0) != nullptr);
+	REQUIRE(ring.Peek(3) != nullptr);
+	CHECK(**ring.Peek(0) == 0);
+	CHECK(**ring.Peek(3) == 3);
+	CHECK(ring.Peek(8) == nullptr);
+
+	std::shared_ptr<int> item;
+	CHECK(ring.Pop(item));
+	CHECK(*item == 0);
+	CHECK(ring.Push(std::make_shared<int>(8)));
+
+	std::vector<int> drained;
+	CHECK(ring.PopBulk([&](std::shared_ptr<int>&& p) { drained.push_back(*p); }, 4) == 4);
+	CHECK(drained == std::vector<int>{1, 2, 3, 4});
+
+	ring.Clear();
+	CHECK(ring.Empty());
+	CHECK(ring.Size() == 0);
+}
+
+TEST_CASE("MPSCRingBuffer_MultiProducer")
+{
+	constexpr int NUM_PRODUCERS = 4;
+	constexpr int NUM_ITEMS = 20000;
+
+	Recoil::MPSCRingBuffer<int> ring(256);
+	std::vector<std::thread> producers;
+
+	for (int p = 0; p < NUM_PRODUCERS; ++p) {
+		producers.emplace_back([&ring, p]() {
+			for (int i = 0; i < NUM_ITEMS; ++i) {
+				while (!ring.Push(p * NUM_ITEMS + i)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	// per-producer order must be preserved, and nothing may be lost
+	std::vector<int> lastSeen(NUM_PRODUCERS, -1);
+	int numReceived = 0;
+	bool ordered = true;
+
+	while (numReceived < NUM_PRODUCERS * NUM_ITEMS) {
+		numReceived += ring.PopBulk([&](int&& v) {
+			const int p = v / NUM_ITEMS;
+			const int i = v % NUM_ITEMS;
+			ordered &= (i > lastSeen[p]);
+			lastSeen[p] = i;
+		}, 64);
+	}
+
+	for (auto& t: producers) {
+		t.join();
+	}
+
+	CHECK(ordered);
+	CHECK(ring.Empty());
+	CHECK(std::all_of(lastSeen.begin(), lastSeen.end(), [](int i) { return (i == NUM_ITEMS - 1); }));
+}
@@ -9,6 +9,9 @@
 #include "System/Log/ILog.h"
 #include "System/SpringHash.h"
 
+#include <cstring>
+#include <vector>
+
 
 #define CATCH_CONFIG_MAIN
 #include <catch_amalgamated.hpp>
@@ -289,9 +292,126 @@ TEST_CASE("Matrix44MatrixMultiply")
 	}
 }
 
+static std::vector<CMatrix44f> MakePieceMatrices(size_t count)
+{
+	std::vector<CMatrix44f> mats(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		mats[i] = CMatrix44f(0.1f * i, 0.27f * i, -0.13f * i);
+		mats[i].Translate(float3(i * 0.5f, 1.0f - i * 0.25f, 2.0f + i));
+	}
+
+	return mats;
+}
+
+// a small model shape: a few chains hanging off the root, parents first
+static std::vector<int> MakePieceParents(size_t count)
+{
+	std::vector<int> parents(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		parents[i] = (i == 0)? -1: ((i % 4 == 1)? 0: int(i - 1));
+	}
+
+	return parents;
+}
+
+
+TEST_CASE("Matrix44SimdKernels")
+{
+	const std::vector<CMatrix44f> mats = MakePieceMatrices(32);
+	const std::vector<int> parents = MakePieceParents(mats.size());
+
+	// must match the scalar versions bit for bit, synced code depends on it
+	for (const CMatrix44f& mat: mats) {
+		CMatrix44f ref = mat;
+		CMatrix44f sse = mat;
+
+		ref.m[12] += (1.5f*ref.m[0] + -2.25f*ref.m[4] + 3.125f*ref.m[ 8]);
+		ref.m[13] += (1.5f*ref.m[1] + -2.25f*ref.m[5] + 3.125f*ref.m[ 9]);
+		ref.m[14] += (1.5f*ref.m[2] + -2.25f*ref.m[6] + 3.125f*ref.m[10]);
+		ref.m[15] += (1.5f*ref.m[3] + -2.25f*ref.m[7] + 3.125f*ref.m[11]);
+		sse.Translate(1.5f, -2.25f, 3.125f);
+		CHECK(memcmp(&ref, &sse, sizeof(CMatrix44f)) == 0);
+
+		for (int i = 0; i < 12; ++i) {
+			ref.m[i] *= ((i < 4)? 0.5f: ((i < 8)? 3.0f: -1.75f));
+		}
+		sse.Scale(0.5f, 3.0f, -1.75f);
+		CHECK(memcmp(&ref, &sse, sizeof(CMatrix44f)) == 0);
+
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				ref.md[i][j] = mat.md[j][i];
+			}
+		}
+		sse = mat;
+		sse.Transpose();
+		CHECK(memcmp(&ref, &sse, sizeof(CMatrix44f)) == 0);
+	}
+
+	std::vector<float3> points(257);
+	std::vector<float3> outPoints(points.size());
+
+	for (size_t i = 0; i < points.size(); ++i) {
+		points[i] = float3(i * 0.75f, -(i * 1.5f), 100.0f - i);
+	}
+
+	CMatrix44f::MulPoints(mats[7], points.data(), outPoints.data(), points.size());
+
+	for (size_t i = 0; i < points.size(); ++i) {
+		const float3 p = mats[7] * points[i];
+		CHECK(memcmp(&p, &outPoints[i], sizeof(float3)) == 0);
+	}
+
+	std::vector<CMatrix44f> outMats(mats.size());
+	std::vector<CMatrix44f> refMats(mats.size());
+
+	CMatrix44f::MulHierarchy(mats.data(), parents.data(), outMats.data(), mats.size());
+
+	for (size_t i = 0; i < mats.size(); ++i) {
+		refMats[i] = (parents[i] < 0)? mats[i]: (refMats[ parents[i] ] * mats[i]);
+		CHECK(memcmp(&refMats[i], &outMats[i], sizeof(CMatrix44f)) == 0);
+	}
+}
+
 TEST_CASE("MatMult")
 {
-	BENCHMARK("MM")	{
-		return 0;
+	const std::vector<CMatrix44f> mats = MakePieceMatrices(64);
+	const std::vector<int> parents = MakePieceParents(mats.size());
+
+	std::vector<CMatrix44f> outMats(mats.size());
+	std::vector<float3> points(1024, float3(1.0f, 2.0f, 3.0f));
+
+	BENCHMARK("MM") {
+		return (mats[1] * mats[2]);
+	};
+	BENCHMARK("Translate") {
+		CMatrix44f mat = mats[3];
+		return mat.Translate(1.0f, 2.0f, 3.0f);
+	};
+	BENCHMARK("Transpose") {
+		CMatrix44f mat = mats[3];
+		return mat.Transpose();
+	};
+	BENCHMARK("PieceHierarchy (per piece)") {
+		for (size_t i = 0; i < mats.size(); ++i) {
+			outMats[i] = (parents[i] < 0)? mats[i]: (outMats[ parents[i] ] * mats[i]);
+		}
+		return outMats.back();
+	};
+	BENCHMARK("PieceHierarchy (batch)") {
+		CMatrix44f::MulHierarchy(mats.data(), parents.data(), outMats.data(), mats.size());
+		return outMats.back();
+	};
+	BENCHMARK("MulPoints (per point)") {
+		for (float3& p: points) {
+			p = mats[5] * p;
+		}
+		return points.back();
+	};
+	BENCHMARK("MulPoints (batch)") {
+		CMatrix44f::MulPoints(mats[5], points.data(), points.data(), points.size());
+		return points.back();
 	};
 }
@@ -48,12 +48,9 @@ void LuaRoot::Serialize(creg::ISerializer* s) {
 	creg::SerializeLuaThread(s, &flh.L_GC);
 }
 
-TEST_CASE("SerializeLuaState")
+static void OpenTestState(int* context)
 {
-	int context = 1;
-
-
-	flh.L = lua_newstate(l_alloc, &context);
+	flh.L = lua_newstate(l_alloc, context);
 	lua_atpanic(flh.L, handlepanic);
 	SPRING_LUA_OPEN_LIB(flh.L, luaopen_base);
 	SPRING_LUA_OPEN_LIB(flh.L, luaopen_math);
@@ -62,39 +59,126 @@ TEST_CASE("SerializeLuaState")
 
 	lua_settop(flh.L, 0);
 	creg::AutoRegisterCFunctions("Test::", flh.L);
-	flh.L_GC = lua_newthread(flh.L);
-	int idx = luaL_ref(flh.L, LUA_REGISTRYINDEX);
-	const char* code = "local co = coroutine.create(function ()\n local function f()\n coroutine.yield()\n end\n f()\n end);\ncoroutine.resume(co);\n";
+}
 
-	int err = luaL_loadbuffer(flh.L, code, strlen(code), "yield");
+static void RunCode(const char* code, const char* name)
+{
+	int err = luaL_loadbuffer(flh.L, code, strlen(code), name);
 	if (err)
 	{
 		printf("%s\n", lua_tostring(flh.L, -1));
 		lua_pop(flh.L, 1);
 	}
 	lua_pcall(flh.L, 0, 0, 0);
+}
 
-	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
-	{
-		LuaRoot root;
-		creg::COutputStreamSerializer oser;
-		oser.SavePackage(&ss, &root, root.GetClass());
-	}
+static void SaveLuaRoot(std::ostream* os)
+{
+	LuaRoot root;
+	creg::COutputStreamSerializer oser;
+	oser.SavePackage(os, &root, root.GetClass());
+}
 
-	{
-		creg::CInputStreamSerializer iser;
-		void* loaded;
-		creg::Class* loadedCls;
-		creg::CopyLuaContext(flh.L);
-		LUA_CLOSE(&flh.L);
-		iser.LoadPackage(&ss, loaded, loadedCls);
-		LuaRoot* loadedRoot = (LuaRoot*) loaded;
-		delete loadedRoot;
-	}
+static void LoadLuaRoot(std::istream* is)
+{
+	creg::CInputStreamSerializer iser;
+	void* loaded;
+	creg::Class* loadedCls;
+	creg::CopyLuaContext(flh.L);
+	LUA_CLOSE(&flh.L);
+	iser.LoadPackage(is, loaded, loadedCls);
+	LuaRoot* loadedRoot = (LuaRoot*) loaded;
+	delete loadedRoot;
+}
+
+static std::string CallChecksum()
+{
+	lua_getglobal(flh.L, "checksum");
+	lua_pcall(flh.L, 0, 1, 0);
+	std::string result = lua_isstring(flh.L, -1) ? lua_tostring(flh.L, -1) : "";
+	lua_pop(flh.L, 1);
+	return result;
+}
+
+TEST_CASE("SerializeLuaState")
+{
+	int context = 1;
+
+	OpenTestState(&context);
+	flh.L_GC = lua_newthread(flh.L);
+	int idx = luaL_ref(flh.L, LUA_REGISTRYINDEX);
+	const char* code = "local co = coroutine.create(function ()\n local function f()\n coroutine.yield()\n end\n f()\n end);\ncoroutine.resume(co);\n";
+
+	RunCode(code, "yield");
+
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+	SaveLuaRoot(&ss);
+	LoadLuaRoot(&ss);
 
 	lua_rawgeti(flh.L, LUA_REGISTRYINDEX, idx);
 	lua_State* L_GC = lua_tothread(flh.L, -1);
 	CHECK(L_GC == flh.L_GC);
 
 	lua_close(flh.L);
-}
\ No newline at end of file
+}
+
+// gadget-like state: many small tables with string keys, shared tables and a large array
+TEST_CASE("SerializeLuaStateTables")
+{
+	int context = 1;
+
+	OpenTestState(&context);
+	flh.L_GC = nullptr;
+
+	const char* code =
+		"local shared = {1, 2, 3}\n"
+		"units = {}\n"
+		"for i = 1, 20000 do\n"
+		" units[i] = {id = i, name = 'unit' .. (i % 100), pos = {i * 0.5, 0, -i}, alive = (i % 2 == 0), big = i * 1e12, neg = -0.0, ref = shared}\n"
+		"end\n"
+		"byName = {}\n"
+		"for i = 1, 20000, 7 do byName['k' .. i] = units[i] end\n"
+		"byUnit = {}\n"
+		"for i = 1, 20000, 13 do byUnit[units[i]] = i end\n"
+		"function checksum()\n"
+		" local sum, len, shared, keyed = 0, 0, 0, 0\n"
+		" for i, u in ipairs(units) do\n"
+		"  sum = sum + u.id + u.pos[1] + u.pos[3] + u.big + (u.alive and 1 or 0) + 1 / u.neg\n"
+		"  len = len + #u.name\n"
+		"  if u.ref == units[1].ref then shared = shared + 1 end\n"
+		" end\n"
+		" for k, u in pairs(byName) do if units[u.id] == u then keyed = keyed + 1 end end\n"
+		" for u, i in pairs(byUnit) do if units[i] == u then keyed = keyed + 1 end end\n"
+		" return string.format('%.17g %d %d %d', sum, len, shared, keyed)\n"
+		"end\n";
+
+	RunCode(code, "tables");
+
+	const std::string before = CallChecksum();
+	CHECK(!before.empty());
+
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+	SaveLuaRoot(&ss);
+	const std::string saved = ss.str();
+	CHECK(!saved.empty());
+
+	LoadLuaRoot(&ss);
+	CHECK(CallChecksum() == before);
+
+	BENCHMARK("Save") {
+		std::ostringstream os(std::ios::out | std::ios::binary);
+		SaveLuaRoot(&os);
+		return os.tellp();
+	};
+
+	// includes closing the previous state
+	BENCHMARK("Load") {
+		std::istringstream is(saved, std::ios::in | std::ios::binary);
+		LoadLuaRoot(&is);
+		return flh.L;
+	};
+
+	CHECK(CallChecksum() == before);
+
+	lua_close(flh.L);
+}
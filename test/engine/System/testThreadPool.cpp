@@ -1,9 +1,11 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "System/Threading/ThreadPool.h"
+#include "System/Threading/AsyncTask.h"
 #include "System/Log/ILog.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/Misc/SpringTime.h"
+#include "System/Platform/Threading.h"
 #include "System/SpringMath.h"
 #include "System/GlobalRNG.h"
 
@@ -127,7 +129,7 @@ TEST_CASE("test_parallel_reduce")
 		return threadnum;
 	};
 
-	const int result = parallel_reduce(TestFunc, ReduceFunc);
+	const int result = parallel_reduce<SyncTask<decltype(TestFunc)>>(TestFunc, ReduceFunc);
 	CHECK(result == ((NUM_THREADS - 1) * ((NUM_THREADS - 1) + 1)) / 2);
 }
 
@@ -183,6 +185,177 @@ TEST_CASE("test_null_for_mt")
 }
 
 
+TEST_CASE("test_for_mt_chunk_adaptive")
+{
+	LOG("[%s::test_for_mt_chunk_adaptive]", __func__);
+
+	for (const bool guided: {false, true}) {
+		std::vector<int> nums(NUM_RUNS, 0);
+
+		// repeated calls let the chunk size settle, every index must still be visited once
+		for (int n = 0; n < 10; n++) {
+			for_mt_chunk_adaptive("test_for_mt_chunk_adaptive", 0, NUM_RUNS, [&](const int i) {
+				SAFE_CHECK(i >= 0);
+				SAFE_CHECK(i < NUM_RUNS);
+
+				// uneven per-item cost, later items are far more expensive
+				const spring_time finish = spring_now() + spring_time::fromNanoSecs((i * i) / NUM_RUNS);
+				while (spring_now() < finish) {}
+
+				nums[i] += 1;
+			}, guided);
+		}
+
+		for (int i = 0; i < NUM_RUNS; i++) {
+			CHECK(nums[i] == 10);
+		}
+	}
+
+	for_mt_chunk_adaptive("test_for_mt_chunk_adaptive", 0, 0, [&](const int i) {
+		SAFE_CHECK(false); // shouldn't be called once
+	});
+}
+
+TEST_CASE("test_async_priorities")
+{
+	LOG("[%s::test_async_priorities]", __func__);
+
+	// a single async worker makes the execution order deterministic
+	ThreadPool::SetThreadCount(std::min(2, NUM_THREADS));
+
+	if (!ThreadPool::HasThreads()) {
+		ThreadPool::SetThreadCount(NUM_THREADS);
+		return;
+	}
+
+	std::atomic<bool> started = {false};
+	std::atomic<bool> release = {false};
+	std::vector<int> order;
+
+	auto blocker = ThreadPool::Enqueue([&]() {
+		started = true;
+		while (!release) {}
+	});
+
+	while (!started) {}
+
+	// queued while the worker is busy, must run highest priority first
+	auto bgTask = ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::Background, [&]() { order.push_back(2); });
+	auto nmTask = ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::Normal    , [&]() { order.push_back(1); });
+	auto hiTask = ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::High      , [&]() { order.push_back(0); });
+
+	release = true;
+
+	blocker.get();
+	bgTask.get();
+	nmTask.get();
+	hiTask.get();
+
+	CHECK(order == std::vector<int>{0, 1, 2});
+
+	ThreadPool::SetThreadCount(NUM_THREADS);
+	CHECK(ThreadPool::GetNumThreads() == NUM_THREADS);
+}
+
+TEST_CASE("test_async_work_stealing")
+{
+	LOG("[%s::test_async_work_stealing]", __func__);
+
+	if (!ThreadPool::HasThreads() || ThreadPool::GetNumThreads() < 3)
+		return;
+
+	std::atomic<bool> release = {false};
+	std::atomic<int> count = {0};
+
+	// Enqueue spreads tasks round-robin; while one worker is blocked the
+	// others have to take over the tasks queued for it or this hangs
+	std::vector<std::shared_future<void>> futures;
+
+	futures.push_back(ThreadPool::Enqueue([&]() { while (!release) {} }));
+
+	for (int i = 0; i < 10 * ThreadPool::GetNumThreads(); i++) {
+		futures.push_back(ThreadPool::Enqueue([&]() { count += 1; }));
+	}
+
+	while (count < static_cast<int>(futures.size() - 1)) {}
+
+	release = true;
+
+	for (auto& f: futures) {
+		f.get();
+	}
+
+	CHECK(count == static_cast<int>(futures.size() - 1));
+}
+
+
+static Threading::AsyncTask<int> AsyncSquare(int i, std::atomic<int>& numOnMain)
+{
+	co_await Threading::ToThreadPool(ThreadPool::TaskPriority::High);
+
+	const int sq = i * i;
+
+	co_await Threading::ToMainThread();
+
+	numOnMain += Threading::IsMainThread();
+	co_return sq;
+}
+
+static Threading::AsyncTask<int> AsyncSumSquares(int n, std::atomic<int>& numOnMain)
+{
+	int sum = 0;
+
+	for (int i = 0; i < n; i++) {
+		sum += co_await AsyncSquare(i, numOnMain);
+	}
+
+	co_return sum;
+}
+
+static Threading::AsyncTask<void> AsyncThrow()
+{
+	co_await Threading::ToThreadPool();
+	throw std::runtime_error("AsyncThrow");
+}
+
+TEST_CASE("test_async_task")
+{
+	LOG("[%s::test_async_task]", __func__);
+
+	Threading::SetMainThread();
+
+	std::atomic<int> numOnMain = {0};
+
+	{
+		// Get pumps the main thread continuations while waiting
+		Threading::AsyncTask<int> task = AsyncSumSquares(100, numOnMain);
+
+		CHECK(task.Get() == 328350);
+		CHECK(numOnMain == 100);
+	}
+	{
+		Threading::AsyncTask<void> task = AsyncThrow();
+
+		CHECK_THROWS_AS(task.Get(), std::runtime_error);
+	}
+	{
+		numOnMain = 0;
+
+		// dropped tasks still run to completion
+		for (int i = 0; i < 100; i++) {
+			AsyncSquare(i, numOnMain);
+		}
+
+		while (numOnMain < 100) {
+			Threading::RunMainThreadTasks();
+		}
+
+		CHECK(numOnMain == 100);
+		CHECK(Threading::MainThreadExecutor::Empty());
+	}
+}
+
+
 TEST_CASE("test_sse_for_mt")
 {
 	LOG("[%s::test_sse_for_mt]", __func__);
@@ -316,6 +489,65 @@ TEST_CASE("test_for_mt_reaction_times")
 }
 
 
+static void test_async_latency_aux(ThreadPool::TaskPriority priority, const char* name)
+{
+	constexpr int NUM_PROBES = 50;
+
+	const auto& ExecKernel = [](const spring_time t) {
+		const spring_time finish = spring_now() + t;
+		while (spring_now() < finish) {}
+	};
+
+	// keep every async worker busy with background work for a while
+	std::vector<std::shared_future<void>> bgFutures;
+
+	for (int i = 0; i < 20 * ThreadPool::GetNumThreads(); i++) {
+		bgFutures.push_back(ThreadPool::EnqueueWithPriority(ThreadPool::TaskPriority::Background, ExecKernel, spring_time::fromMilliSecs(2)));
+	}
+
+	float sumLatency = 0.0f;
+	float maxLatency = 0.0f;
+	float sumForTime = 0.0f;
+
+	for (int i = 0; i < NUM_PROBES; i++) {
+		const spring_time start = spring_now();
+
+		auto probe = ThreadPool::EnqueueWithPriority(priority, [start]() { return (spring_now() - start).toMilliSecsf(); });
+		const float latency = probe.get();
+
+		sumLatency += latency;
+		maxLatency = std::max(maxLatency, latency);
+
+		// a sim-style parallel section, background tasks must not start meanwhile
+		const spring_time forStart = spring_now();
+
+		for_mt(0, 100, [&](const int j) {
+			ExecKernel(spring_time::fromMicroSecs(10));
+		});
+
+		sumForTime += (spring_now() - forStart).toMilliSecsf();
+	}
+
+	for (auto& f: bgFutures) {
+		f.get();
+	}
+
+	LOG("\t%-10s task latency under background load: avg=%.3fms max=%.3fms (%d probes), for_mt avg=%.3fms", name, sumLatency / NUM_PROBES, maxLatency, NUM_PROBES, sumForTime / NUM_PROBES);
+}
+
+TEST_CASE("test_async_latency")
+{
+	LOG("[%s::test_async_latency]", __func__);
+
+	if (!ThreadPool::HasThreads())
+		return;
+
+	test_async_latency_aux(ThreadPool::TaskPriority::High      , "high");
+	test_async_latency_aux(ThreadPool::TaskPriority::Normal    , "normal");
+	test_async_latency_aux(ThreadPool::TaskPriority::Background, "background");
+}
+
+
 TEST_CASE("test_parallel_gtn_cost")
 {
 	std::vector<float> costs(NUM_THREADS);
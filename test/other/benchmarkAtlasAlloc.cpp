@@ -0,0 +1,138 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#include "Rendering/Textures/LegacyAtlasAlloc.h"
+#include "Rendering/Textures/QuadtreeAtlasAlloc.h"
+#include "Rendering/Textures/RowAtlasAlloc.h"
+#include "Rendering/Textures/SkylineAtlasAlloc.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Pack time and occupancy (entry area over atlas area) of the atlas allocators:
+//   BenchProjectileAtlas: a few thousand projectile/CEG-like textures packed at once
+//   BenchGlyphAtlas: font glyphs added in small batches, one Allocate per batch
+//   as CFontTexture does while text with new glyphs is drawn
+namespace {
+	struct Entry {
+		std::string name;
+		int2 size;
+	};
+
+	std::vector<Entry> MakeProjectileEntries(size_t count) {
+		std::mt19937 rng(0x5eed);
+		std::uniform_int_distribution<int> pow2Dist(3, 7);
+		std::uniform_int_distribution<int> oddDist(8, 200);
+		std::uniform_real_distribution<float> kindDist(0.0f, 1.0f);
+
+		std::vector<Entry> result;
+		result.reserve(count);
+
+		for (size_t i = 0; i < count; i++) {
+			int2 size;
+
+			// mostly power-of-two squares, some strips (lasers, trails) and odd sizes
+			if (const float kind = kindDist(rng); kind < 0.6f) {
+				size.x = size.y = 1 << pow2Dist(rng);
+			} else if (kind < 0.8f) {
+				size = {1 << pow2Dist(rng), 1 << (pow2Dist(rng) - 2)};
+			} else {
+				size = {oddDist(rng), oddDist(rng)};
+			}
+
+			result.push_back({"tex" + std::to_string(i), size});
+		}
+
+		return result;
+	}
+
+	std::vector<Entry> MakeGlyphEntries(size_t count) {
+		std::mt19937 rng(0x91f);
+		std::uniform_int_distribution<int> wDist(6, 22);
+		std::uniform_int_distribution<int> hDist(14, 26);
+
+		std::vector<Entry> result;
+		result.reserve(count * 2);
+
+		for (size_t i = 0; i < count; i++) {
+			const int2 size = {wDist(rng), hDist(rng)};
+
+			// glyph and its outline, see CFontTexture
+			result.push_back({std::to_string(i)       , size});
+			result.push_back({std::to_string(i) + "sh", size + int2(4, 4)});
+		}
+
+		return result;
+	}
+
+	template<typename AtlasAlloc>
+	void BenchProjectileAtlas(benchmark::State& state) {
+		const std::vector<Entry> entries = MakeProjectileEntries(state.range(0));
+
+		int64_t entryArea = 0;
+		int64_t atlasArea = 0;
+
+		for (const Entry& e: entries) {
+			entryArea += int64_t(e.size.x) * e.size.y;
+		}
+
+		for (auto _: state) {
+			AtlasAlloc alloc;
+			alloc.SetMaxSize(16384, 16384);
+			alloc.SetMaxTexLevel(4);
+
+			for (const Entry& e: entries) {
+				alloc.AddEntry(e.name, e.size);
+			}
+
+			benchmark::DoNotOptimize(alloc.Allocate());
+			atlasArea = int64_t(alloc.GetAtlasSize().x) * alloc.GetAtlasSize().y;
+		}
+
+		state.counters["occupancy"] = double(entryArea) / std::max<int64_t>(atlasArea, 1);
+	}
+
+	template<typename AtlasAlloc>
+	void BenchGlyphAtlas(benchmark::State& state) {
+		const std::vector<Entry> entries = MakeGlyphEntries(state.range(0));
+		constexpr size_t BATCH_SIZE = 2 * 16;
+
+		int64_t entryArea = 0;
+		int64_t atlasArea = 0;
+
+		for (const Entry& e: entries) {
+			entryArea += int64_t(e.size.x) * e.size.y;
+		}
+
+		for (auto _: state) {
+			AtlasAlloc alloc;
+			alloc.SetMaxSize(8192, 8192);
+
+			for (size_t i = 0; i < entries.size(); i += BATCH_SIZE) {
+				for (size_t j = i; j < std::min(i + BATCH_SIZE, entries.size()); j++) {
+					alloc.AddEntry(entries[j].name, entries[j].size);
+				}
+
+				benchmark::DoNotOptimize(alloc.Allocate());
+				alloc.clear();
+			}
+
+			atlasArea = int64_t(alloc.GetAtlasSize().x) * alloc.GetAtlasSize().y;
+		}
+
+		state.counters["occupancy"] = double(entryArea) / std::max<int64_t>(atlasArea, 1);
+	}
+}
+
+BENCHMARK(BenchProjectileAtlas<CLegacyAtlasAlloc>)->Arg(500)->Arg(4000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchProjectileAtlas<CQuadtreeAtlasAlloc>)->Arg(500)->Arg(4000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchProjectileAtlas<CRowAtlasAlloc>)->Arg(500)->Arg(4000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchProjectileAtlas<CSkylineAtlasAlloc>)->Arg(500)->Arg(4000)->Unit(benchmark::kMillisecond);
+
+// the other allocators place everything again on each Allocate, which the font atlas can not use
+BENCHMARK(BenchGlyphAtlas<CRowAtlasAlloc>)->Arg(2000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchGlyphAtlas<CSkylineAtlasAlloc>)->Arg(2000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -1,10 +1,14 @@
 #include "System/MemPoolTypes.h"
+#include "System/UnorderedMap.hpp"
 #include "System/Log/ILog.h"
 
 #include <benchmark/benchmark.h>
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
 #include <vector>
 
 namespace {
@@ -46,27 +50,27 @@ static void BenchStaticMemPoolAllocation(benchmark::State& state) {
 	}
 }
 
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::large>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::large>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::large>>);
-
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<512, 16, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<512, 16, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<512, 16, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<512, 16, objsizes::large>>);
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<1024, 32, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<1024, 32, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<1024, 32, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<1024, 32, objsizes::large>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::micro, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::small, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::medium, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<1024, objsizes::large, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::micro, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::small, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::medium, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<10240, objsizes::large, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::micro, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::small, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::medium, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<StaticMemPool<102400, objsizes::large, 16>>);
+
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::micro, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::small, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::medium, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::large, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::micro, 1024, 32, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::small, 1024, 32, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::medium, 1024, 32, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocation<FixedDynMemPool<objsizes::large, 1024, 32, 16>>);
 
 template <typename TMempool>
 static void BenchStaticMemPoolAllocationDeallocation(benchmark::State& state) {
@@ -91,26 +95,186 @@ static void BenchStaticMemPoolAllocationDeallocation(benchmark::State& state) {
 	}
 }
 
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::large>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::large>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::large>>);
-
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<512, 16, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<512, 16, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<512, 16, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<512, 16, objsizes::large>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<1024, 32, objsizes::micro>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<1024, 32, objsizes::small>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<1024, 32, objsizes::medium>>);
-BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<1024, 32, objsizes::large>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::micro, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::small, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::medium, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<1024, objsizes::large, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::micro, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::small, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::medium, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<10240, objsizes::large, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::micro, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::small, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::medium, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<StaticMemPool<102400, objsizes::large, 16>>);
+
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::micro, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::small, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::medium, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::large, 512, 16, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::micro, 1024, 32, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::small, 1024, 32, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::medium, 1024, 32, 16>>);
+BENCHMARK(BenchStaticMemPoolAllocationDeallocation<FixedDynMemPool<objsizes::large, 1024, 32, 16>>);
+
+
+// allocation from parallel sections: the single-threaded pools behind one lock
+// (as they would have to be shared) vs ThreadCachedMemPool's per-thread magazines
+template <typename TMempool>
+struct LockedMemPool {
+	void* allocMem(size_t size) { std::lock_guard<spring::spinlock> lck(mutex); return pool.allocMem(size); }
+	void freeMem(void* p) { std::lock_guard<spring::spinlock> lck(mutex); pool.freeMem(p); }
+	void clear() { pool.clear(); }
+
+	static constexpr size_t PAGE_SIZE() { return TMempool::PAGE_SIZE(); }
+
+	TMempool pool;
+	spring::spinlock mutex;
+};
+
+template <typename TMempool>
+static void BenchThreadedAllocationDeallocation(benchmark::State& state) {
+	static TMempool mempool;
+
+	// short-lived particles, most die within a few frames of their creation
+	constexpr size_t NUM_LIVE = 256;
+	std::array<void*, NUM_LIVE> allocated;
+
+	if (state.thread_index() == 0)
+		mempool.clear();
+
+	for (auto _ : state) {
+		for (size_t i = 0; i < NUM_LIVE; i++) {
+			benchmark::DoNotOptimize(allocated[i] = mempool.allocMem(mempool.PAGE_SIZE()));
+		}
+		for (size_t i = 0; i < NUM_LIVE; i++) {
+			mempool.freeMem(allocated[i]);
+		}
+
+		benchmark::ClobberMemory();
+	}
+
+	state.SetItemsProcessed(state.iterations() * NUM_LIVE);
+}
+
+BENCHMARK(BenchThreadedAllocationDeallocation<LockedMemPool<StaticMemPool<102400, objsizes::small, 16>>>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BenchThreadedAllocationDeallocation<ThreadCachedMemPool<StaticMemPool<102400, objsizes::small, 16>>>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BenchThreadedAllocationDeallocation<LockedMemPool<FixedDynMemPool<objsizes::small, 1024, 32, 16>>>)->ThreadRange(1, 16)->UseRealTime();
+BENCHMARK(BenchThreadedAllocationDeallocation<ThreadCachedMemPool<FixedDynMemPool<objsizes::small, 1024, 32, 16>>>)->ThreadRange(1, 16)->UseRealTime();
+
+// spring::unordered_map vs spring::flat_hash_map for the lookups the engine does most:
+// object IDs (dense, mostly hits) and 64-bit hashes (sparse, some misses)
+namespace {
+	template<typename TKey>
+	struct MapKeys {
+		MapKeys(size_t numKeys) {
+			std::mt19937_64 rng(0x5eed);
+
+			for (size_t i = 0; i < numKeys; i++) {
+				if constexpr (sizeof(TKey) == sizeof(uint64_t)) {
+					keys.push_back(rng());
+				} else {
+					keys.push_back(static_cast<TKey>(i * 3));
+				}
+			}
+
+			// one in eight lookups is for a key that is not in the map
+			for (size_t i = 0; i < (numKeys * 4); i++) {
+				const TKey key = keys[rng() % keys.size()];
+				probes.push_back(((i & 7) == 0)? static_cast<TKey>(key + 1): key);
+			}
+		}
+
+		std::vector<TKey> keys;
+		std::vector<TKey> probes;
+	};
+}
+
+template <typename TMap>
+static void BenchMapLookup(benchmark::State& state) {
+	const MapKeys<typename TMap::key_type> mk(state.range(0));
+
+	TMap map;
+	for (const auto key: mk.keys) {
+		map[key] = static_cast<typename TMap::mapped_type>(key);
+	}
+
+	for (auto _ : state) {
+		typename TMap::mapped_type sum = 0;
+
+		for (const auto key: mk.probes) {
+			const auto iter = map.find(key);
+			sum += (iter != map.end())? iter->second: 0;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * mk.probes.size());
+}
+
+template <typename TMap>
+static void BenchMapChurn(benchmark::State& state) {
+	const MapKeys<typename TMap::key_type> mk(state.range(0));
+
+	TMap map;
+
+	for (auto _ : state) {
+		// insert everything, then erase every other key and re-insert it
+		for (const auto key: mk.keys) {
+			map[key] = 0;
+		}
+		for (size_t i = 0; i < mk.keys.size(); i += 2) {
+			map.erase(mk.keys[i]);
+		}
+		for (size_t i = 0; i < mk.keys.size(); i += 2) {
+			map[mk.keys[i]] = 1;
+		}
+
+		benchmark::DoNotOptimize(map.size());
+		spring::clear_unordered_map(map);
+	}
+
+	state.SetItemsProcessed(state.iterations() * mk.keys.size() * 2);
+}
+
+template <typename TMap>
+static void BenchMapIterate(benchmark::State& state) {
+	const MapKeys<typename TMap::key_type> mk(state.range(0));
+
+	TMap map;
+	for (const auto key: mk.keys) {
+		map[key] = static_cast<typename TMap::mapped_type>(key);
+	}
+	// holes left behind by erased keys, as in long-lived maps
+	for (size_t i = 0; i < mk.keys.size(); i += 4) {
+		map.erase(mk.keys[i]);
+	}
+
+	for (auto _ : state) {
+		typename TMap::mapped_type sum = 0;
+
+		for (const auto& [key, value]: map) {
+			sum += value;
+		}
+
+		benchmark::DoNotOptimize(sum);
+	}
+
+	state.SetItemsProcessed(state.iterations() * map.size());
+}
+
+BENCHMARK(BenchMapLookup<spring::unordered_map<uint32_t, uint32_t>>)->Range(64, 64 << 10);
+BENCHMARK(BenchMapLookup<spring::flat_hash_map<uint32_t, uint32_t>>)->Range(64, 64 << 10);
+BENCHMARK(BenchMapLookup<spring::unordered_map<uint64_t, uint64_t>>)->Range(64, 64 << 10);
+BENCHMARK(BenchMapLookup<spring::flat_hash_map<uint64_t, uint64_t>>)->Range(64, 64 << 10);
+
+BENCHMARK(BenchMapChurn<spring::unordered_map<uint32_t, uint32_t>>)->Range(64, 64 << 10);
+BENCHMARK(BenchMapChurn<spring::flat_hash_map<uint32_t, uint32_t>>)->Range(64, 64 << 10);
+BENCHMARK(BenchMapChurn<spring::unordered_map<uint64_t, uint64_t>>)->Range(64, 64 << 10);
+BENCHMARK(BenchMapChurn<spring::flat_hash_map<uint64_t, uint64_t>>)->Range(64, 64 << 10);
+
+BENCHMARK(BenchMapIterate<spring::unordered_map<uint32_t, uint32_t>>)->Range(64, 64 << 10);
+BENCHMARK(BenchMapIterate<spring::flat_hash_map<uint32_t, uint32_t>>)->Range(64, 64 << 10);
 
 BENCHMARK_MAIN();
@@ -0,0 +1,448 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+/*
+ * Synthetic network load benchmark.
+ *
+ * Spins up a server loop that does CGameServer's per-frame network work (drain
+ * every client, relay its commands to all clients, emit NETMSG_NEWFRAME) and N
+ * scripted fake clients that replay the client->server traffic of a demo file,
+ * or synthetic command traffic if no demo is given. Reports server frame time,
+ * throughput, allocations and NEWFRAME delivery latency percentiles, so that
+ * netcode changes can be compared across connection types before they ship.
+ *
+ * Usage:
+ *   benchmarkNetLoad [--clients=160] [--frames=1800] [--transport=loopback|udp|dcf]
+ *                    [--demo=file.sdfz] [--port=18452] [--dcf-config=file.json] [--realtime]
+ */
+
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/Misc/LatencyHistogram.h"
+#include "System/Net/LoopbackConnection.h"
+#include "System/Net/PacketBufferPool.h"
+#include "System/Net/ProtocolDef.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/UDPConnection.h"
+#include "System/Net/UDPListener.h"
+#ifdef BENCHMARK_WITH_DCF
+#include "Net/DCFConnection.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+using netcode::CConnection;
+using netcode::RawPacket;
+
+namespace streflop {
+	template<typename T> inline void streflop_init() {}
+}
+
+// count every heap allocation made while the benchmark runs
+static std::atomic<uint64_t> numAllocs = {0};
+
+void* operator new(size_t size) {
+	numAllocs.fetch_add(1, std::memory_order_relaxed);
+
+	if (void* p = std::malloc(std::max<size_t>(size, 1)))
+		return p;
+
+	throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+
+namespace {
+	typedef std::chrono::steady_clock Clock;
+	typedef std::shared_ptr<const RawPacket> PacketPtr;
+	typedef std::vector<std::vector<PacketPtr>> Script; // per frame
+
+	struct Options {
+		unsigned numClients = 160;
+		unsigned numFrames = 1800;
+		unsigned port = 18452;
+		bool realTime = false;
+		std::string transport = "loopback";
+		std::string demoFile;
+		std::string dcfConfig = "config/dcf_network.json";
+	};
+
+	// the server's and the client's view of one fake client; ends may alias
+	struct Link {
+		std::shared_ptr<CConnection> clientSend;
+		std::shared_ptr<CConnection> clientRecv;
+		std::shared_ptr<CConnection> serverSend;
+		std::shared_ptr<CConnection> serverRecv;
+
+		unsigned script = 0;
+		unsigned framesSeen = 0;
+	};
+
+	struct Results {
+		spring::LatencyHistogram frameTimes;
+		spring::LatencyHistogram deliveryTimes;
+
+		uint64_t messagesIn = 0;
+		uint64_t bytesIn = 0;
+		uint64_t messagesOut = 0;
+		uint64_t bytesOut = 0;
+	};
+
+
+	bool ParseOptions(int argc, char** argv, Options& opts) {
+		for (int i = 1; i < argc; ++i) {
+			const std::string arg = argv[i];
+			const size_t eq = arg.find('=');
+			const std::string key = arg.substr(0, eq);
+			const std::string val = (eq != std::string::npos)? arg.substr(eq + 1): "";
+
+			if (key == "--clients") { opts.numClients = std::clamp(std::atoi(val.c_str()), 1, static_cast<int>(MAX_PLAYERS) - 1); continue; }
+			if (key == "--frames") { opts.numFrames = std::max(std::atoi(val.c_str()), 1); continue; }
+			if (key == "--port") { opts.port = std::atoi(val.c_str()); continue; }
+			if (key == "--transport") { opts.transport = val; continue; }
+			if (key == "--demo") { opts.demoFile = val; continue; }
+			if (key == "--dcf-config") { opts.dcfConfig = val; continue; }
+			if (key == "--realtime") { opts.realTime = true; continue; }
+
+			std::fprintf(stderr, "unknown option \"%s\"\n", arg.c_str());
+			return false;
+		}
+
+		return true;
+	}
+
+
+	// offset of the playerNum byte in the client->server messages that matter for load
+	int PlayerNumOffset(uint8_t msgID) {
+		switch (msgID) {
+			case NETMSG_PAUSE:
+			case NETMSG_USER_SPEED:
+			case NETMSG_DIRECT_CONTROL:
+			case NETMSG_DC_UPDATE:
+			case NETMSG_SHARE:
+			case NETMSG_SETSHARE:
+			case NETMSG_SYNCRESPONSE:
+			case NETMSG_TEAM:
+				return 1;
+			case NETMSG_CHAT:
+			case NETMSG_MAPDRAW:
+				return 2; // after uint8 size
+			case NETMSG_COMMAND:
+			case NETMSG_SELECT:
+			case NETMSG_AICOMMAND:
+			case NETMSG_AICOMMANDS:
+			case NETMSG_AISHARE:
+			case NETMSG_LUAMSG:
+				return 3; // after uint16 size
+			default:
+				break;
+		}
+
+		return -1;
+	}
+
+	// splits the demo's recorded client traffic into one frame-indexed script per player
+	std::vector<Script> LoadDemoScripts(const std::string& demoFile, unsigned numFrames) {
+		std::vector<Script> scripts(MAX_PLAYERS);
+		CDemoReader reader(demoFile, 0.0f);
+
+		int frame = 0;
+
+		while (!reader.ReachedEnd() && frame < static_cast<int>(numFrames)) {
+			std::unique_ptr<RawPacket> packet(reader.GetData(3.402823466e+38f));
+
+			if (packet == nullptr || packet->length == 0)
+				continue;
+
+			const uint8_t msgID = packet->data[0];
+
+			if (msgID == NETMSG_NEWFRAME || msgID == NETMSG_KEYFRAME) {
+				frame++;
+				continue;
+			}
+
+			const int offset = PlayerNumOffset(msgID);
+
+			if (offset < 0 || packet->length <= static_cast<uint32_t>(offset))
+				continue;
+
+			Script& script = scripts[packet->data[offset] % MAX_PLAYERS];
+			script.resize(numFrames);
+			script[frame].emplace_back(std::make_shared<const RawPacket>(packet->data, packet->length));
+		}
+
+		scripts.erase(std::remove_if(scripts.begin(), scripts.end(), [](const Script& s) { return s.empty(); }), scripts.end());
+		return scripts;
+	}
+
+	// roughly what an active player sends: a command every few frames plus periodic sync responses
+	std::vector<Script> MakeSyntheticScripts(unsigned numClients, unsigned numFrames) {
+		std::vector<Script> scripts(numClients, Script(numFrames));
+		std::mt19937 rng(12345);
+
+		const float params[4] = {1024.0f, 0.0f, 2048.0f, 0.0f};
+
+		for (unsigned c = 0; c < numClients; ++c) {
+			for (unsigned f = 0; f < numFrames; ++f) {
+				if ((rng() % 4) == 0)
+					scripts[c][f].emplace_back(CBaseNetProtocol::Get().SendCommand(c, 10, 0, 0, 3, params));
+				if ((f % 16) == (c % 16))
+					scripts[c][f].emplace_back(CBaseNetProtocol::Get().SendSyncResponse(c, f, rng()));
+			}
+		}
+
+		return scripts;
+	}
+
+
+	bool CreateLoopbackLinks(std::vector<Link>& links) {
+		for (Link& link: links) {
+			link.clientSend = std::make_shared<netcode::CLoopbackConnection>();
+			link.clientRecv = std::make_shared<netcode::CLoopbackConnection>();
+			link.serverRecv = link.clientSend;
+			link.serverSend = link.clientRecv;
+		}
+
+		return true;
+	}
+
+	bool CreateUDPLinks(std::vector<Link>& links, std::unique_ptr<netcode::UDPListener>& listener, unsigned port) {
+		listener = std::make_unique<netcode::UDPListener>(port, "127.0.0.1");
+
+		for (Link& link: links) {
+			auto conn = std::make_shared<netcode::UDPConnection>(0, "127.0.0.1", port);
+
+			// any first packet makes the listener spawn a connection for this endpoint
+			conn->SendData(CBaseNetProtocol::Get().SendNewFrame());
+			conn->Flush(true);
+
+			const auto deadline = Clock::now() + std::chrono::seconds(2);
+
+			while (!listener->HasIncomingConnections()) {
+				if (Clock::now() > deadline) {
+					std::fprintf(stderr, "UDP handshake timed out\n");
+					return false;
+				}
+
+				listener->Update(1);
+			}
+
+			link.clientSend = conn;
+			link.clientRecv = conn;
+			link.serverSend = listener->AcceptConnection();
+			link.serverRecv = link.serverSend;
+		}
+
+		return true;
+	}
+
+#ifdef BENCHMARK_WITH_DCF
+	// DCF broadcasts itself: one server end shared by every link, one SDK client per fake client
+	bool CreateDCFLinks(std::vector<Link>& links, const std::string& config) {
+		try {
+			auto server = std::make_shared<DCFConnection>(config);
+			server->Unmute();
+
+			for (Link& link: links) {
+				auto conn = std::make_shared<DCFConnection>(config);
+				conn->Unmute();
+
+				link.clientSend = conn;
+				link.clientRecv = conn;
+				link.serverSend = server;
+				link.serverRecv = server;
+			}
+		} catch (const std::exception& e) {
+			std::fprintf(stderr, "DCF setup failed: %s\n", e.what());
+			return false;
+		}
+
+		return true;
+	}
+#endif
+
+
+	template<typename T>
+	std::vector<T*> UniqueEnds(std::vector<Link>& links, std::shared_ptr<T> Link::*end) {
+		std::vector<T*> ends;
+		std::set<T*> seen;
+
+		for (Link& link: links) {
+			if (seen.insert((link.*end).get()).second)
+				ends.push_back((link.*end).get());
+		}
+
+		return ends;
+	}
+
+	void Run(std::vector<Link>& links, netcode::UDPListener* listener, const std::vector<Script>& scripts, const Options& opts, Results& results) {
+		const std::vector<CConnection*> serverSendEnds = UniqueEnds(links, &Link::serverSend);
+		const std::vector<CConnection*> serverRecvEnds = UniqueEnds(links, &Link::serverRecv);
+
+		std::vector<Clock::time_point> frameSendTimes(opts.numFrames);
+		std::vector<PacketPtr> relayed;
+
+		const auto broadcast = [&](const PacketPtr& pkt) {
+			for (CConnection* conn: serverSendEnds) {
+				conn->SendData(pkt);
+			}
+
+			results.messagesOut += serverSendEnds.size();
+			results.bytesOut += pkt->length * serverSendEnds.size();
+		};
+
+		const auto frameLength = std::chrono::microseconds(1000000 / GAME_SPEED);
+		auto nextFrameTime = Clock::now();
+
+		for (unsigned frame = 0; frame < opts.numFrames; ++frame) {
+			// clients: replay this frame's script, then consume whatever the server sent
+			for (Link& link: links) {
+				const Script& script = scripts[link.script];
+
+				for (const PacketPtr& pkt: script[frame % script.size()]) {
+					link.clientSend->SendData(pkt);
+				}
+
+				link.clientSend->Flush(false);
+				link.clientRecv->Update();
+
+				for (PacketPtr pkt; (pkt = link.clientRecv->GetData()) != nullptr; ) {
+					if (pkt->data[0] != NETMSG_NEWFRAME || link.framesSeen >= frame + 1)
+						continue;
+
+					results.deliveryTimes.Record(std::chrono::duration<float, std::milli>(Clock::now() - frameSendTimes[link.framesSeen++]).count());
+				}
+			}
+
+			// server: what CGameServer::Update and CreateNewFrame do to the network per frame
+			const auto frameStart = Clock::now();
+
+			// server-side UDP connections share the listener's socket
+			if (listener != nullptr)
+				listener->Update(0);
+
+			for (CConnection* conn: serverRecvEnds) {
+				conn->Update();
+
+				for (PacketPtr pkt; (pkt = conn->GetData()) != nullptr; ) {
+					results.messagesIn += 1;
+					results.bytesIn += pkt->length;
+
+					// sync responses stay on the server, everything else is relayed to all clients
+					// (NEWFRAMEs only show up as the UDP handshake and must not confuse the clients)
+					if (pkt->data[0] != NETMSG_SYNCRESPONSE && pkt->data[0] != NETMSG_NEWFRAME)
+						relayed.emplace_back(std::move(pkt));
+				}
+			}
+
+			for (const PacketPtr& pkt: relayed) {
+				broadcast(pkt);
+			}
+			relayed.clear();
+
+			frameSendTimes[frame] = Clock::now();
+			broadcast(CBaseNetProtocol::Get().SendNewFrame());
+
+			for (CConnection* conn: serverSendEnds) {
+				conn->Flush(false);
+			}
+
+			netcode::PacketBufferPool::EndFrame();
+
+			results.frameTimes.Record(std::chrono::duration<float, std::milli>(Clock::now() - frameStart).count());
+
+			if (opts.realTime) {
+				std::this_thread::sleep_until(nextFrameTime += frameLength);
+			}
+		}
+	}
+
+	void Report(const Options& opts, const Results& results, double wallSeconds, uint64_t allocs) {
+		const auto frameTimes = results.frameTimes.GetSnapshot();
+		const auto delivery = results.deliveryTimes.GetSnapshot();
+		const auto pool = netcode::PacketBufferPool::GetStats();
+
+		std::printf("transport=%s clients=%u frames=%u wall=%.2fs\n", opts.transport.c_str(), opts.numClients, opts.numFrames, wallSeconds);
+		std::printf("server frame ms: p50=%.2f p95=%.2f p99=%.2f max=%.2f\n", frameTimes.p50, frameTimes.p95, frameTimes.p99, frameTimes.max);
+		std::printf("newframe delivery ms: p50=%.2f p95=%.2f p99=%.2f max=%.2f (%u samples)\n", delivery.p50, delivery.p95, delivery.p99, delivery.max, delivery.numSamples);
+		std::printf("throughput: in %.0f msg/s %.1f KiB/s, out %.0f msg/s %.1f KiB/s\n",
+			results.messagesIn / wallSeconds, results.bytesIn / 1024.0 / wallSeconds,
+			results.messagesOut / wallSeconds, results.bytesOut / 1024.0 / wallSeconds);
+		std::printf("allocations: %.1f per frame, packet pool hit rate %.3f\n", allocs * 1.0 / opts.numFrames, pool.HitRate());
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	Options opts;
+
+	if (!ParseOptions(argc, argv, opts))
+		return 1;
+
+	// make sure ProtocolDef is initialized before anything parses packets
+	CBaseNetProtocol::Get();
+
+	std::vector<Script> scripts;
+
+	try {
+		scripts = opts.demoFile.empty()? MakeSyntheticScripts(opts.numClients, opts.numFrames): LoadDemoScripts(opts.demoFile, opts.numFrames);
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "failed to load demo \"%s\": %s\n", opts.demoFile.c_str(), e.what());
+		return 1;
+	}
+
+	if (scripts.empty()) {
+		std::fprintf(stderr, "no client traffic to replay\n");
+		return 1;
+	}
+
+	std::vector<Link> links(opts.numClients);
+	std::unique_ptr<netcode::UDPListener> listener;
+
+	for (unsigned i = 0; i < links.size(); ++i) {
+		links[i].script = i % scripts.size();
+	}
+
+	bool created = false;
+
+	if (opts.transport == "loopback") {
+		created = CreateLoopbackLinks(links);
+	} else if (opts.transport == "udp") {
+		created = CreateUDPLinks(links, listener, opts.port);
+#ifdef BENCHMARK_WITH_DCF
+	} else if (opts.transport == "dcf") {
+		created = CreateDCFLinks(links, opts.dcfConfig);
+#endif
+	} else {
+		std::fprintf(stderr, "unsupported transport \"%s\"\n", opts.transport.c_str());
+	}
+
+	if (!created)
+		return 1;
+
+	Results results;
+
+	const uint64_t allocsBefore = numAllocs.load();
+	const auto t0 = Clock::now();
+
+	Run(links, listener.get(), scripts, opts, results);
+
+	const double wallSeconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+	Report(opts, results, wallSeconds, numAllocs.load() - allocsBefore);
+	return 0;
+}
@@ -0,0 +1,128 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Path/QTPFS/NodeHeap.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <queue>
+#include <random>
+#include <tuple>
+#include <vector>
+
+// Replays the open-queue traffic of QTPFS::PathSearch (lazy deletion: a better gCost
+// pushes a second entry, stale ones are skipped when they surface) on a tesselation-
+// sized grid, so only the queue differs between runs. Mirrors SearchQueueNode and its
+// comparator from PathThreads.h, which drags in the whole map layer.
+namespace {
+	struct QueueNode {
+		QueueNode(int index, float priority): heapPriority(priority), nodeIndex(index) {}
+
+		float heapPriority;
+		int nodeIndex;
+	};
+
+	struct QueueNodeCmp {
+		bool operator() (const QueueNode& lhs, const QueueNode& rhs) const {
+			return std::tie(lhs.heapPriority, lhs.nodeIndex) > std::tie(rhs.heapPriority, rhs.nodeIndex);
+		}
+	};
+
+	struct SearchGrid {
+		SearchGrid(int size, unsigned int seed): size(size), moveCosts(size * size) {
+			std::mt19937 rng(seed);
+			std::uniform_real_distribution<float> costDist(1.0f, 4.0f);
+
+			// sprinkle in impassable squares like a real map
+			for (float& cost: moveCosts) {
+				cost = ((rng() % 16) == 0)? -1.0f: costDist(rng);
+			}
+		}
+
+		int size;
+		std::vector<float> moveCosts;
+	};
+
+	const SearchGrid& GetGrid(int size) {
+		static SearchGrid grid(size, 0x5eed);
+
+		if (grid.size != size)
+			grid = SearchGrid(size, 0x5eed);
+
+		return grid;
+	}
+}
+
+template<typename TQueue>
+static void BenchSearch(benchmark::State& state) {
+	const SearchGrid& grid = GetGrid(state.range(0));
+	const int n = grid.size;
+	const int tgt = n * n - 1;
+
+	std::vector<float> gCosts(n * n);
+	TQueue openNodes;
+
+	size_t numExpanded = 0;
+
+	for (auto _ : state) {
+		std::fill(gCosts.begin(), gCosts.end(), INFINITY);
+
+		while (!openNodes.empty())
+			openNodes.pop();
+
+		gCosts[0] = 0.0f;
+		openNodes.emplace(0, 0.0f);
+
+		while (!openNodes.empty()) {
+			const QueueNode cur = openNodes.top();
+			openNodes.pop();
+
+			if (cur.nodeIndex == tgt)
+				break;
+
+			const int cx = cur.nodeIndex % n;
+			const int cz = cur.nodeIndex / n;
+			const float g = gCosts[cur.nodeIndex];
+
+			// stale entry
+			if (cur.heapPriority > g + std::hypot(float(n - 1 - cx), float(n - 1 - cz)))
+				continue;
+
+			numExpanded++;
+
+			constexpr int dx[] = {-1, 1, 0, 0};
+			constexpr int dz[] = {0, 0, -1, 1};
+
+			for (int i = 0; i < 4; i++) {
+				const int nx = cx + dx[i];
+				const int nz = cz + dz[i];
+
+				if (nx < 0 || nz < 0 || nx >= n || nz >= n)
+					continue;
+
+				const int ni = nz * n + nx;
+				const float cost = grid.moveCosts[ni];
+
+				if (cost < 0.0f || g + cost >= gCosts[ni])
+					continue;
+
+				gCosts[ni] = g + cost;
+				openNodes.emplace(ni, gCosts[ni] + std::hypot(float(n - 1 - nx), float(n - 1 - nz)));
+			}
+		}
+
+		benchmark::DoNotOptimize(gCosts.data());
+		benchmark::ClobberMemory();
+	}
+
+	state.counters["expanded/s"] = benchmark::Counter(numExpanded, benchmark::Counter::kIsRate);
+}
+
+using StdQueue = std::priority_queue<QueueNode, std::vector<QueueNode>, QueueNodeCmp>;
+
+BENCHMARK(BenchSearch<StdQueue>)->Arg(256)->Arg(1024);
+BENCHMARK(BenchSearch<QTPFS::dary_heap<QueueNode, QueueNodeCmp, 2>>)->Arg(256)->Arg(1024);
+BENCHMARK(BenchSearch<QTPFS::dary_heap<QueueNode, QueueNodeCmp, 4>>)->Arg(256)->Arg(1024);
+BENCHMARK(BenchSearch<QTPFS::dary_heap<QueueNode, QueueNodeCmp, 8>>)->Arg(256)->Arg(1024);
+
+BENCHMARK_MAIN();
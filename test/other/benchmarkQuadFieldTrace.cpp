@@ -0,0 +1,124 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/QuadFieldTrace.h"
+#include "Sim/Misc/GlobalConstants.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+// Replays the quad lookups of a game (captured by an engine built with
+// QUADFIELD_TRACE) against CQuadField, split by query type:
+//   benchmarkQuadFieldTrace --trace=quadfield_trace.txt [google benchmark flags]
+// Without a trace a synthetic one is used: unit-sized circles and weapon rays
+// clustered around a few battle fronts of a 16x16 map, which keeps the numbers
+// comparable between builds but is no substitute for a real game.
+namespace {
+	QuadFieldTrace::Trace trace;
+
+	void MakeSyntheticTrace(QuadFieldTrace::Trace& t) {
+		std::mt19937 rng(0x5eed);
+		std::uniform_real_distribution<float> unitDist(0.0f, 1.0f);
+		std::normal_distribution<float> frontDist(0.0f, 600.0f);
+		std::uniform_real_distribution<float> dirDist(-1.0f, 1.0f);
+
+		t.mapDims = {16 * 64, 16 * 64};
+		t.quadSize = 128;
+
+		const float mapSize = t.mapDims.x * SQUARE_SIZE;
+		const float3 fronts[] = {{mapSize * 0.3f, 0.0f, mapSize * 0.4f}, {mapSize * 0.6f, 0.0f, mapSize * 0.5f}, {mapSize * 0.5f, 0.0f, mapSize * 0.8f}};
+
+		for (int i = 0; i < 200000; i++) {
+			const float3& front = fronts[i % 3];
+			const float3 pos = {std::clamp(front.x + frontDist(rng), 0.0f, mapSize), 50.0f, std::clamp(front.z + frontDist(rng), 0.0f, mapSize)};
+			const float3 dir = float3(dirDist(rng), dirDist(rng) * 0.1f, dirDist(rng)).SafeNormalize();
+			const float roll = unitDist(rng);
+
+			// mostly collision and target-search circles, then weapon rays and a few area scans
+			if (roll < 0.6f) {
+				t.queries.push_back({QuadFieldTrace::QUERY_CIRCLE, pos, ZeroVector, 20.0f + unitDist(rng) * 600.0f, 0.0f});
+			} else if (roll < 0.85f) {
+				t.queries.push_back({QuadFieldTrace::QUERY_RAY, pos, dir, 100.0f + unitDist(rng) * 1200.0f, 0.0f});
+			} else if (roll < 0.95f) {
+				t.queries.push_back({QuadFieldTrace::QUERY_WIDE_RAY, pos, dir, 100.0f + unitDist(rng) * 800.0f, 10.0f + unitDist(rng) * 40.0f});
+			} else {
+				const float3 ext = {unitDist(rng) * 1000.0f, 0.0f, unitDist(rng) * 1000.0f};
+				t.queries.push_back({QuadFieldTrace::QUERY_RECTANGLE, pos - ext, pos + ext, 0.0f, 0.0f});
+			}
+		}
+	}
+
+	void RunQuery(const QuadFieldTrace::Query& q) {
+		QuadFieldQuery qfQuery;
+
+		switch (q.type) {
+			case QuadFieldTrace::QUERY_CIRCLE   : { quadField.GetQuads(qfQuery, q.a, q.length); } break;
+			case QuadFieldTrace::QUERY_RECTANGLE: { quadField.GetQuadsRectangle(qfQuery, q.a, q.b); } break;
+			case QuadFieldTrace::QUERY_RAY      : { quadField.GetQuadsOnRay(qfQuery, q.a, q.b, q.length); } break;
+			case QuadFieldTrace::QUERY_WIDE_RAY : { quadField.GetQuadsOnWideRay(qfQuery, q.a, q.b, q.length, q.width); } break;
+			default: { return; } break;
+		}
+
+		benchmark::DoNotOptimize(qfQuery.quads->data());
+	}
+}
+
+// state.range(0) is a QueryType, or 0 for the whole trace in recorded order
+static void BenchReplay(benchmark::State& state) {
+	const int type = state.range(0);
+	size_t numQueries = 0;
+
+	for (auto _: state) {
+		for (const QuadFieldTrace::Query& q: trace.queries) {
+			if (type != 0 && q.type != type)
+				continue;
+
+			RunQuery(q);
+			numQueries++;
+		}
+	}
+
+	state.SetItemsProcessed(numQueries);
+}
+
+BENCHMARK(BenchReplay)->ArgName("all")->Arg(0)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchReplay)->ArgName("circle")->Arg(QuadFieldTrace::QUERY_CIRCLE)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchReplay)->ArgName("rectangle")->Arg(QuadFieldTrace::QUERY_RECTANGLE)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchReplay)->ArgName("ray")->Arg(QuadFieldTrace::QUERY_RAY)->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchReplay)->ArgName("wideray")->Arg(QuadFieldTrace::QUERY_WIDE_RAY)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+	benchmark::Initialize(&argc, argv);
+
+	const char* traceFile = nullptr;
+
+	for (int i = 1; i < argc; i++) {
+		if (strncmp(argv[i], "--trace=", 8) == 0)
+			traceFile = argv[i] + 8;
+	}
+
+	if (traceFile != nullptr) {
+		if (!QuadFieldTrace::Load(traceFile, trace)) {
+			fprintf(stderr, "can not read a quadfield trace from \"%s\"\n", traceFile);
+			return 1;
+		}
+	} else {
+		MakeSyntheticTrace(trace);
+	}
+
+	// normally set by the map
+	float3::maxxpos = trace.mapDims.x * SQUARE_SIZE - 1;
+	float3::maxzpos = trace.mapDims.y * SQUARE_SIZE - 1;
+
+	quadField.Init(trace.mapDims, trace.quadSize);
+
+	printf("replaying %zu quadfield queries on a %dx%d map (quad size %d)\n", trace.queries.size(), trace.mapDims.x, trace.mapDims.y, trace.quadSize);
+
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
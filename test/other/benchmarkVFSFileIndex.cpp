@@ -0,0 +1,101 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/FileSystem/VFSFileIndex.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+
+// Compares CVFSHandler::GetFileData before (lower_bound over the sorted section
+// under the VFS lock) and after (lock-free hashed CVFSFileIndex snapshot), for
+// 100k lookups spread across 8 threads on a game-sized section.
+namespace {
+	constexpr int NUM_THREADS = 8;
+	constexpr int NUM_LOOKUPS = 100000;
+	constexpr int NUM_FILES = 20000;
+
+	typedef CVFSFileIndex::FileEntry FileEntry;
+
+	struct Section {
+		Section() {
+			std::mt19937 rng(0x5eed);
+
+			const char* dirs[] = {"gamedata/", "luarules/gadgets/", "luaui/widgets/", "objects3d/", "scripts/", "sounds/", "unittextures/", "units/"};
+
+			files.reserve(NUM_FILES);
+
+			for (int i = 0; i < NUM_FILES; i++) {
+				files.emplace_back(std::string(dirs[rng() % std::size(dirs)]) + "file_" + std::to_string(rng()) + ".lua", CVFSFileIndex::FileData{nullptr, i});
+			}
+
+			std::stable_sort(files.begin(), files.end(), [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); });
+
+			// mostly hits, some misses like FileExists probes
+			for (int i = 0; i < NUM_LOOKUPS; i++) {
+				paths.push_back(((rng() % 8) == 0)? "units/missing_" + std::to_string(i) + ".lua": files[rng() % files.size()].first);
+			}
+
+			index.store(std::make_shared<const CVFSFileIndex>(files));
+		}
+
+		std::vector<FileEntry> files;
+		std::vector<std::string> paths;
+
+		std::recursive_mutex mutex;
+		std::atomic<std::shared_ptr<const CVFSFileIndex>> index;
+	};
+
+	Section& GetSection() {
+		static Section section;
+		return section;
+	}
+}
+
+static void BenchLockedLookup(benchmark::State& state) {
+	Section& section = GetSection();
+
+	const auto pred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
+	const size_t beg = (NUM_LOOKUPS / NUM_THREADS) * state.thread_index();
+	const size_t end = beg + (NUM_LOOKUPS / NUM_THREADS);
+
+	for (auto _: state) {
+		for (size_t i = beg; i < end; i++) {
+			std::lock_guard<std::recursive_mutex> lck(section.mutex);
+
+			const auto iter = std::lower_bound(section.files.cbegin(), section.files.cend(), FileEntry{section.paths[i], {}}, pred);
+			const bool found = (iter != section.files.cend() && iter->first == section.paths[i]);
+
+			benchmark::DoNotOptimize(found? iter->second.size: -1);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * (end - beg));
+}
+
+static void BenchIndexLookup(benchmark::State& state) {
+	Section& section = GetSection();
+
+	const size_t beg = (NUM_LOOKUPS / NUM_THREADS) * state.thread_index();
+	const size_t end = beg + (NUM_LOOKUPS / NUM_THREADS);
+
+	for (auto _: state) {
+		for (size_t i = beg; i < end; i++) {
+			const auto index = section.index.load();
+
+			benchmark::DoNotOptimize(index->Find(section.paths[i]).size);
+		}
+	}
+
+	state.SetItemsProcessed(state.iterations() * (end - beg));
+}
+
+BENCHMARK(BenchLockedLookup)->Threads(NUM_THREADS)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BenchIndexLookup)->Threads(NUM_THREADS)->UseRealTime()->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
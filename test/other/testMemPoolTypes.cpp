@@ -1,6 +1,7 @@
 #include "System/MemPoolTypes.h"
 #include "System/Log/ILog.h"
 
+#include <algorithm>
 #include <vector>
 #include <cstddef>
 
@@ -190,4 +191,55 @@ TEMPLATE_TEST_CASE_METHOD(AllocFixture, "test allocator's clear method", "[class
 	}
 }
 
+TEST_CASE("StablePosAllocator trims gaps that end up at the end")
+{
+	StablePosAllocator<int> spa;
+
+	const size_t pos0 = spa.Allocate(4);
+	const size_t pos1 = spa.Allocate(4);
+	const size_t pos2 = spa.Allocate(4);
+	REQUIRE(spa.GetSize() == 12);
+
+	spa.Free(pos1, 4);
+	REQUIRE(spa.GetSize() == 12);
+	REQUIRE(spa.GetNumFreeElems() == 4);
+
+	spa.Free(pos2, 4);
+	REQUIRE(spa.GetSize() == 4);
+	REQUIRE(spa.GetNumFreeElems() == 0);
+
+	spa.Free(pos0, 4);
+	REQUIRE(spa.GetSize() == 0);
+}
+
+TEST_CASE("StablePosAllocator relocates ranges into gaps in front of them")
+{
+	StablePosAllocator<int> spa;
+
+	const size_t pos0 = spa.Allocate(8);
+	const size_t pos1 = spa.Allocate(2);
+	const size_t pos2 = spa.Allocate(3);
+
+	std::fill(spa.GetData().begin() + pos2, spa.GetData().begin() + pos2 + 3, 42);
+
+	spa.Free(pos0, 8);
+	REQUIRE(spa.GetNumFreeElems() == 8);
+
+	const int zero = 0;
+	const size_t newPos2 = spa.Relocate(pos2, 3, &zero);
+	REQUIRE(newPos2 < pos1);
+	REQUIRE(spa.GetSize() == pos1 + 2);
+	REQUIRE(spa.GetNumFreeElems() == 5);
+
+	for (size_t i = 0; i < 3; ++i)
+		REQUIRE(spa[newPos2 + i] == 42);
+
+	// nothing in front of the first range
+	REQUIRE(spa.Relocate(newPos2, 3) == newPos2);
+
+	// the remaining gap is too small
+	const size_t pos3 = spa.Allocate(6);
+	REQUIRE(spa.Relocate(pos3, 6) == pos3);
+}
+
 } // unnamed namespace
@@ -3,8 +3,20 @@
 #include <string>
 #include <map>
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 #include <gflags/gflags.h>
 #include <iomanip> //hex
+#include <zlib.h>
 
 #include "StringSerializer.h"
 
@@ -32,9 +44,16 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
+	DEFINE_bool  (index,        false, "Print the block index");
+	DEFINE_bool  (blockstats,   false, "Only print traffic stats, decompressing the demo's blocks in parallel");
+	DEFINE_string(batchdir,     "",    "Analyse every demo in this directory, writing team, player and packet stats as csv");
+	DEFINE_string(batchout,     "demostats", "Path prefix of the csv files written by batchdir");
+	DEFINE_int32 (threads,      0,     "Number of demos analysed at once by batchdir, 0 for one per core");
 
 
 void TrafficDump(CDemoReader& reader, bool trafficStats);
+bool BlockTrafficStats(const std::string& filename);
+bool BatchAnalyse(const std::string& dirname, const std::string& outPrefix, int numThreads);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
 
 int main (int argc, char* argv[])
@@ -43,6 +62,9 @@ int main (int argc, char* argv[])
 
 	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options] path_to_demo.sdfz");
 	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (!FLAGS_batchdir.empty())
+		return (BatchAnalyse(FLAGS_batchdir, FLAGS_batchout, FLAGS_threads)? 0: 1);
+
 	if (!FLAGS_demofile.empty()) {
 		filename = FLAGS_demofile;
 	} else if (argc >= 2) {
@@ -52,6 +74,9 @@ int main (int argc, char* argv[])
 		gflags::ShowUsageWithFlags(argv[0]);
 	}
 
+	if (FLAGS_blockstats)
+		return (BlockTrafficStats(filename)? 0: 1);
+
 	CDemoReader reader(filename, 0.0f);
 	reader.LoadStats();
 	if (FLAGS_dump)
@@ -75,6 +100,15 @@ int main (int argc, char* argv[])
 		buf << reader.GetFileHeader();
 		std::wcout << buf.str();
 	}
+	if (FLAGS_index)
+	{
+		const std::vector<CDemoReader::IndexEntry>& index = reader.GetFrameIndex();
+		for (unsigned i = 0; i < index.size(); ++i)
+		{
+			std::cout << "Block " << i << ": frame " << index[i].frameNum << ", time " << index[i].modGameTime
+			          << ", stream position " << index[i].streamPos << ", file offset " << index[i].fileOffset << std::endl;
+		}
+	}
 	if (FLAGS_playerstats || FLAGS_stats)
 	{
 		const std::vector<PlayerStatistics> statvec = reader.GetPlayerStats();
@@ -366,6 +400,12 @@ void TrafficDump(CDemoReader& reader, bool trafficStats)
 					case MAPDRAW_ERASE:
 						std::cout << " ERASE x:" << *(uint32_t*)&buffer[4] << " z:" << *(uint32_t*)&buffer[8];
 						break;
+					case MAPDRAW_POLYLINE:
+						std::cout << " POLYLINE flags:" << (unsigned)buffer[4] << " points:";
+						for (unsigned i = 5; (i + 3) < packet->length; i += 4) {
+							std::cout << " (" << *(uint16_t*)&buffer[i] << "," << *(uint16_t*)&buffer[i + 2] << ")";
+						}
+						break;
 				}
 				std::cout << std::endl;
 				break;
@@ -452,6 +492,360 @@ void TrafficDump(CDemoReader& reader, bool trafficStats)
 	}
 }
 
+// inflates the single gzip member at <offset>, which is how every part of a version 6 demo is stored
+static bool InflateMember(FILE* file, long offset, std::vector<unsigned char>& data)
+{
+	z_stream zstream;
+	memset(&zstream, 0, sizeof(zstream));
+
+	if (fseek(file, offset, SEEK_SET) != 0 || inflateInit2(&zstream, 15 + 16) != Z_OK)
+		return false;
+
+	unsigned char inBuffer[64 * 1024];
+	unsigned char outBuffer[64 * 1024];
+	int ret = Z_OK;
+
+	data.clear();
+
+	while (ret != Z_STREAM_END) {
+		if (zstream.avail_in == 0) {
+			if ((zstream.avail_in = fread(inBuffer, 1, sizeof(inBuffer), file)) == 0)
+				break;
+
+			zstream.next_in = inBuffer;
+		}
+
+		zstream.next_out = outBuffer;
+		zstream.avail_out = sizeof(outBuffer);
+
+		if ((ret = inflate(&zstream, Z_NO_FLUSH)) != Z_OK && ret != Z_STREAM_END)
+			break;
+
+		data.insert(data.end(), outBuffer, outBuffer + (sizeof(outBuffer) - zstream.avail_out));
+	}
+
+	inflateEnd(&zstream);
+	return (ret == Z_STREAM_END);
+}
+
+bool BlockTrafficStats(const std::string& filename)
+{
+	FILE* file = fopen(filename.c_str(), "rb");
+
+	if (file == nullptr) {
+		std::cout << "Can not open " << filename << std::endl;
+		return false;
+	}
+
+	std::vector<unsigned char> data;
+	DemoFileHeader header;
+
+	if (!InflateMember(file, 0, data) || data.size() != sizeof(header)) {
+		std::cout << "Demo has no separately stored header (version < 6?)" << std::endl;
+		fclose(file);
+		return false;
+	}
+
+	memcpy(&header, data.data(), sizeof(header));
+	header.swab();
+
+	if (header.version != DEMOFILE_VERSION || header.numIndexEntries <= 0 || !InflateMember(file, header.indexFileOffset, data) || data.size() != (header.numIndexEntries * sizeof(DemoIndexEntry))) {
+		std::cout << "Demo has no block index (unfinished recording?)" << std::endl;
+		fclose(file);
+		return false;
+	}
+
+	fclose(file);
+
+	std::vector<DemoIndexEntry> index(header.numIndexEntries);
+	memcpy(index.data(), data.data(), data.size());
+
+	for (DemoIndexEntry& entry: index) {
+		entry.swab();
+	}
+
+	const std::int64_t streamEnd = std::int64_t(header.headerSize) + header.scriptSize + header.demoStreamSize;
+	const unsigned numThreads = std::max(1u, std::min(unsigned(index.size()), std::thread::hardware_concurrency()));
+
+	std::vector< std::vector<unsigned> > trafficCounters(numThreads, std::vector<unsigned>(NETMSG_LAST, 0));
+	std::vector<std::thread> threads;
+	std::atomic<unsigned> nextBlock = {0};
+	std::atomic<bool> failed = {false};
+
+	// every block is a gzip member of its own, starting at a chunk header
+	const auto countBlocks = [&](std::vector<unsigned>& trafficCounter) {
+		FILE* blockFile = fopen(filename.c_str(), "rb");
+		std::vector<unsigned char> block;
+
+		for (unsigned i = nextBlock++; i < index.size() && blockFile != nullptr; i = nextBlock++) {
+			if (!InflateMember(blockFile, index[i].fileOffset, block)) {
+				failed = true;
+				break;
+			}
+
+			const std::int64_t blockEnd = (i + 1 < index.size())? index[i + 1].streamPos: streamEnd;
+			const size_t blockSize = std::min(size_t(blockEnd - index[i].streamPos), block.size());
+
+			for (size_t pos = 0; (pos + sizeof(DemoStreamChunkHeader)) <= blockSize; ) {
+				DemoStreamChunkHeader chunkHeader;
+				memcpy(&chunkHeader, &block[pos], sizeof(chunkHeader));
+				chunkHeader.swab();
+
+				if ((pos += sizeof(chunkHeader)) < blockSize && chunkHeader.length > 0 && block[pos] < NETMSG_LAST)
+					trafficCounter[block[pos]] += chunkHeader.length;
+
+				pos += chunkHeader.length;
+			}
+		}
+
+		if (blockFile != nullptr)
+			fclose(blockFile);
+	};
+
+	for (unsigned i = 0; i < numThreads; ++i)
+		threads.emplace_back(countBlocks, std::ref(trafficCounters[i]));
+	for (std::thread& thread: threads)
+		thread.join();
+
+	if (failed) {
+		std::cout << "Demo is corrupt" << std::endl;
+		return false;
+	}
+
+	for (unsigned i = 0; i != NETMSG_LAST; ++i)
+	{
+		unsigned count = 0;
+		for (const std::vector<unsigned>& trafficCounter: trafficCounters)
+			count += trafficCounter[i];
+		if (count > 0)
+			std::cout << "Msg " << i << ": " << count << std::endl;
+	}
+	return true;
+}
+
+// Streams through one demo after the other, keeping its buffers between them;
+// rows are gathered per demo and appended to the shared outputs in one go.
+class CBatchAnalyser
+{
+public:
+	bool Analyse(const std::string& path, const std::string& name);
+
+	const std::string& GetTeamRows() const { return teamRows; }
+	const std::string& GetPlayerRows() const { return playerRows; }
+	const std::string& GetFrameRows() const { return frameRows; }
+
+private:
+	bool Read(void* buf, unsigned length) { return (gzread(file, buf, length) == int(length)); }
+
+	void AddFrameRow(const std::string& name, int frameNum, unsigned numPackets, unsigned numBytes) {
+		if (numPackets == 0)
+			return;
+
+		rowBuffer.str("");
+		rowBuffer << name << ";" << frameNum << ";" << numPackets << ";" << numBytes << "\n";
+		frameRows += rowBuffer.str();
+	}
+
+private:
+	gzFile file = nullptr;
+
+	std::vector<unsigned char> packet;
+	std::vector<unsigned> numTeamStats;
+	std::ostringstream rowBuffer;
+
+	std::string teamRows;
+	std::string playerRows;
+	std::string frameRows;
+};
+
+bool CBatchAnalyser::Analyse(const std::string& path, const std::string& name)
+{
+	teamRows.clear();
+	playerRows.clear();
+	frameRows.clear();
+
+	if ((file = gzopen(path.c_str(), "rb")) == nullptr)
+		return false;
+
+	gzbuffer(file, 256 * 1024);
+
+	DemoFileHeader header;
+	bool ret = Read(&header, sizeof(header));
+
+	header.swab();
+
+	if (!ret || memcmp(header.magic, DEMOFILE_MAGIC, sizeof(header.magic)) != 0 || header.version != DEMOFILE_VERSION || header.headerSize != sizeof(header)) {
+		gzclose(file);
+		return false;
+	}
+
+	gzseek(file, header.scriptSize, SEEK_CUR);
+
+	{
+		// crashed recordings have no stream size, read those until EOF
+		const std::int64_t streamSize = (header.demoStreamSize != 0)? header.demoStreamSize: std::numeric_limits<std::int64_t>::max();
+
+		int frameNum = 0;
+		unsigned numPackets = 0;
+		unsigned numBytes = 0;
+
+		for (std::int64_t pos = 0; (pos + std::int64_t(sizeof(DemoStreamChunkHeader))) <= streamSize; ) {
+			DemoStreamChunkHeader chunkHeader;
+
+			if (!Read(&chunkHeader, sizeof(chunkHeader)))
+				break;
+
+			chunkHeader.swab();
+			packet.resize(chunkHeader.length);
+
+			if (!Read(packet.data(), chunkHeader.length))
+				break;
+
+			pos += (sizeof(chunkHeader) + chunkHeader.length);
+
+			if (chunkHeader.length > 0) {
+				switch (packet[0]) {
+					case NETMSG_NEWFRAME: {
+						AddFrameRow(name, frameNum, numPackets, numBytes);
+						frameNum += 1;
+						numPackets = 0;
+						numBytes = 0;
+					} break;
+					case NETMSG_KEYFRAME: {
+						AddFrameRow(name, frameNum, numPackets, numBytes);
+						if (chunkHeader.length >= (1 + sizeof(std::int32_t)))
+							memcpy(&frameNum, &packet[1], sizeof(std::int32_t));
+						numPackets = 0;
+						numBytes = 0;
+					} break;
+					default: {
+					} break;
+				}
+			}
+
+			numPackets += 1;
+			numBytes += chunkHeader.length;
+		}
+
+		AddFrameRow(name, frameNum, numPackets, numBytes);
+	}
+
+	// same as CDemoReader::LoadStats, but streamed
+	if (header.demoStreamSize != 0 && ret) {
+		gzseek(file, header.winningAllyTeamsSize, SEEK_CUR);
+
+		for (int playerNum = 0; playerNum < header.numPlayers && ret; ++playerNum) {
+			PlayerStatistics stats;
+
+			if (!(ret = Read(&stats, sizeof(stats))))
+				break;
+
+			stats.swab();
+
+			rowBuffer.str("");
+			rowBuffer << name << ";" << playerNum << ";" << stats.mousePixels << ";" << stats.mouseClicks << ";" << stats.keyPresses << ";";
+			rowBuffer << stats.numCommands << ";" << stats.unitCommands << "\n";
+			playerRows += rowBuffer.str();
+		}
+
+		numTeamStats.clear();
+		numTeamStats.resize(std::max(0, header.numTeams), 0);
+
+		for (unsigned& numStats: numTeamStats) {
+			ret = ret && Read(&numStats, sizeof(numStats));
+			numStats = swabDWord(numStats);
+		}
+
+		for (unsigned teamNum = 0; teamNum < numTeamStats.size() && ret; ++teamNum) {
+			for (unsigned i = 0; i < numTeamStats[teamNum] && ret; ++i) {
+				TeamStatistics stats;
+
+				if (!(ret = Read(&stats, sizeof(stats))))
+					break;
+
+				stats.swab();
+
+				rowBuffer.str("");
+				rowBuffer << name << ";" << teamNum << ";" << (i * header.teamStatPeriod) << ";";
+				rowBuffer << stats.metalUsed << ";" << stats.energyUsed << ";" << stats.metalProduced << ";" << stats.energyProduced << ";";
+				rowBuffer << stats.metalExcess << ";" << stats.energyExcess << ";" << stats.metalReceived << ";" << stats.energyReceived << ";";
+				rowBuffer << stats.metalSent << ";" << stats.energySent << ";" << stats.damageDealt << ";" << stats.damageReceived << ";";
+				rowBuffer << stats.unitsProduced << ";" << stats.unitsDied << ";" << stats.unitsReceived << ";" << stats.unitsSent << ";";
+				rowBuffer << stats.unitsCaptured << ";" << stats.unitsOutCaptured << ";" << stats.unitsKilled << "\n";
+				teamRows += rowBuffer.str();
+			}
+		}
+	}
+
+	gzclose(file);
+	file = nullptr;
+	return ret;
+}
+
+bool BatchAnalyse(const std::string& dirname, const std::string& outPrefix, int numThreads)
+{
+	std::vector<std::filesystem::path> demoPaths;
+	std::error_code err;
+
+	for (const auto& entry: std::filesystem::directory_iterator(dirname, err)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".sdfz")
+			demoPaths.push_back(entry.path());
+	}
+
+	if (err) {
+		std::cout << "Can not read directory " << dirname << ": " << err.message() << std::endl;
+		return false;
+	}
+
+	std::sort(demoPaths.begin(), demoPaths.end());
+
+	std::ofstream teamOut((outPrefix + "_teamstats.csv").c_str());
+	std::ofstream playerOut((outPrefix + "_playerstats.csv").c_str());
+	std::ofstream frameOut((outPrefix + "_packets.csv").c_str());
+
+	teamOut << "Demo;Team;Time[sec];MetalUsed;EnergyUsed;MetalProduced;EnergyProduced;MetalExcess;EnergyExcess;"
+	        << "MetalReceived;EnergyReceived;MetalSent;EnergySent;DamageDealt;DamageReceived;"
+	        << "UnitsProduced;UnitsDied;UnitsReceived;UnitsSent;UnitsCaptured;UnitsOutCaptured;UnitsKilled" << std::endl;
+	playerOut << "Demo;Player;MousePixels;MouseClicks;KeyPresses;NumCommands;UnitCommands" << std::endl;
+	frameOut << "Demo;Frame;Packets;Bytes" << std::endl;
+
+	if (numThreads <= 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+	std::vector<std::thread> threads;
+	std::mutex outMutex;
+	std::atomic<size_t> nextDemo = {0};
+	std::atomic<size_t> numFailed = {0};
+
+	const auto analyseDemos = [&]() {
+		CBatchAnalyser analyser;
+
+		for (size_t i = nextDemo++; i < demoPaths.size(); i = nextDemo++) {
+			const std::string name = demoPaths[i].filename().string();
+
+			if (!analyser.Analyse(demoPaths[i].string(), name)) {
+				std::lock_guard<std::mutex> lock(outMutex);
+				std::cout << "Skipping unreadable or incomplete demo " << name << std::endl;
+				numFailed += 1;
+			}
+
+			// partial rows of a truncated demo are still worth having
+			std::lock_guard<std::mutex> lock(outMutex);
+			teamOut << analyser.GetTeamRows();
+			playerOut << analyser.GetPlayerRows();
+			frameOut << analyser.GetFrameRows();
+		}
+	};
+
+	for (int i = 0; i < std::min(numThreads, int(demoPaths.size())); ++i)
+		threads.emplace_back(analyseDemos);
+	for (std::thread& thread: threads)
+		thread.join();
+
+	std::cout << "Analysed " << (demoPaths.size() - numFailed) << " of " << demoPaths.size() << " demos" << std::endl;
+	return (numFailed == 0);
+}
+
 template<typename T>
 void PrintSep(std::ofstream& file, T value)
 {
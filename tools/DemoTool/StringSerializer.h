@@ -41,6 +41,8 @@ wstringstream& operator<<(wstringstream& str, const DemoFileHeader& header)
 	str<<L"TeamStatElemSize: " <<header.teamStatElemSize<<endl;
 	str<<L"TeamStatPeriod: " <<header.teamStatPeriod<<endl;
 	str<<L"WinningAllyTeamsSize: " << header.winningAllyTeamsSize<<endl;
+	str<<L"NumIndexEntries: " << header.numIndexEntries<<endl;
+	str<<L"IndexFileOffset: " << header.indexFileOffset<<endl;
 	return str;
 }
 
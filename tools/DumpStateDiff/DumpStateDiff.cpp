@@ -0,0 +1,407 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cinttypes>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <gflags/gflags.h>
+#include <zlib.h>
+
+#include "System/Sync/DumpStateFormat.h"
+
+/*
+Usage:
+dumpstatediff [options] ClientGameState-A.sds ClientGameState-B.sds
+
+Compares two binary state dumps (written with DumpStateBinary=1) frame by
+frame and prints every field that differs, starting at the first frame that
+diverges. Exits with 0 if the dumps match, 1 if they do not, 2 on errors.
+*/
+
+	DEFINE_int32(maxdiffs,   50,    "Stop after printing this many differences, 0 for no limit");
+	DEFINE_bool (firstframe, false, "Stop after the first frame that differs");
+
+using namespace DumpStateFormat;
+
+namespace {
+	enum FieldType {
+		FIELD_INT,
+		FIELD_UINT,
+		FIELD_FLOAT,
+	};
+
+	struct Field {
+		const char* name;
+		size_t offset;
+		int count;
+		FieldType type;
+	};
+
+	#define FIELD(R, name, type) {#name, offsetof(R, name), int(sizeof(R::name) / 4), type}
+
+	const Field UNIT_FIELDS[] = {
+		FIELD(UnitRecord, unitDefID, FIELD_INT),
+		FIELD(UnitRecord, pos, FIELD_FLOAT),
+		FIELD(UnitRecord, speed, FIELD_FLOAT),
+		FIELD(UnitRecord, xdir, FIELD_FLOAT),
+		FIELD(UnitRecord, ydir, FIELD_FLOAT),
+		FIELD(UnitRecord, zdir, FIELD_FLOAT),
+		FIELD(UnitRecord, midPos, FIELD_FLOAT),
+		FIELD(UnitRecord, health, FIELD_FLOAT),
+		FIELD(UnitRecord, experience, FIELD_FLOAT),
+		FIELD(UnitRecord, heading, FIELD_INT),
+		FIELD(UnitRecord, mapSquare, FIELD_INT),
+		FIELD(UnitRecord, physicalState, FIELD_INT),
+		FIELD(UnitRecord, fireState, FIELD_INT),
+		FIELD(UnitRecord, moveState, FIELD_INT),
+		FIELD(UnitRecord, flags, FIELD_INT),
+		FIELD(UnitRecord, orderTargetID, FIELD_INT),
+		FIELD(UnitRecord, numCommands, FIELD_INT),
+		FIELD(UnitRecord, piecesHash, FIELD_UINT),
+		FIELD(UnitRecord, weaponsHash, FIELD_UINT),
+		FIELD(UnitRecord, commandsHash, FIELD_UINT),
+		FIELD(UnitRecord, moveTypeHash, FIELD_UINT),
+		FIELD(UnitRecord, builderHash, FIELD_UINT),
+	};
+
+	const Field FEATURE_FIELDS[] = {
+		FIELD(FeatureRecord, featureDefID, FIELD_INT),
+		FIELD(FeatureRecord, pos, FIELD_FLOAT),
+		FIELD(FeatureRecord, speed, FIELD_FLOAT),
+		FIELD(FeatureRecord, xdir, FIELD_FLOAT),
+		FIELD(FeatureRecord, ydir, FIELD_FLOAT),
+		FIELD(FeatureRecord, zdir, FIELD_FLOAT),
+		FIELD(FeatureRecord, midPos, FIELD_FLOAT),
+		FIELD(FeatureRecord, health, FIELD_FLOAT),
+		FIELD(FeatureRecord, reclaimLeft, FIELD_FLOAT),
+	};
+
+	const Field PROJECTILE_FIELDS[] = {
+		FIELD(ProjectileRecord, ownerID, FIELD_INT),
+		FIELD(ProjectileRecord, pos, FIELD_FLOAT),
+		FIELD(ProjectileRecord, dir, FIELD_FLOAT),
+		FIELD(ProjectileRecord, speed, FIELD_FLOAT),
+		FIELD(ProjectileRecord, weapon, FIELD_INT),
+		FIELD(ProjectileRecord, piece, FIELD_INT),
+		FIELD(ProjectileRecord, checkCol, FIELD_INT),
+		FIELD(ProjectileRecord, deleteMe, FIELD_INT),
+	};
+
+	const Field TEAM_FIELDS[] = {
+		FIELD(TeamRecord, metal, FIELD_FLOAT),
+		FIELD(TeamRecord, energy, FIELD_FLOAT),
+		FIELD(TeamRecord, metalPull, FIELD_FLOAT),
+		FIELD(TeamRecord, energyPull, FIELD_FLOAT),
+		FIELD(TeamRecord, metalIncome, FIELD_FLOAT),
+		FIELD(TeamRecord, energyIncome, FIELD_FLOAT),
+		FIELD(TeamRecord, metalExpense, FIELD_FLOAT),
+		FIELD(TeamRecord, energyExpense, FIELD_FLOAT),
+	};
+
+	const Field ALLYTEAM_FIELDS[] = {
+		FIELD(AllyTeamRecord, losHashes, FIELD_UINT),
+	};
+
+	const Field MAP_FIELDS[] = {
+		FIELD(MapRecord, heightMapHash, FIELD_UINT),
+		FIELD(MapRecord, centerNormalsHash, FIELD_UINT),
+		FIELD(MapRecord, faceNormalsHash, FIELD_UINT),
+		FIELD(MapRecord, smoothMeshHash, FIELD_UINT),
+		FIELD(MapRecord, cobTime, FIELD_INT),
+		FIELD(MapRecord, numCobThreads, FIELD_INT),
+		FIELD(MapRecord, cobThreadsHash, FIELD_UINT),
+	};
+
+	#undef FIELD
+
+
+	class CDumpFile {
+	public:
+		CDumpFile(const char* fileName): name(fileName), file(gzopen(fileName, "rb")) {
+			if (file != nullptr)
+				gzbuffer(file, 256 * 1024);
+		}
+		~CDumpFile() {
+			if (file != nullptr)
+				gzclose(file);
+		}
+
+		template<typename T> bool Read(T* data, size_t count) {
+			if (count == 0)
+				return true;
+
+			const size_t size = count * sizeof(T);
+			return (gzread(file, data, size) == int(size));
+		}
+
+		template<typename T> bool ReadVector(std::vector<T>& data, int count) {
+			if (count < 0)
+				return false;
+
+			data.resize(count);
+			return Read(data.data(), count);
+		}
+
+		bool IsOpen() const { return (file != nullptr); }
+		bool AtEnd() const { return gzeof(file); }
+
+		const char* GetName() const { return name.c_str(); }
+
+	private:
+		std::string name;
+		gzFile file;
+	};
+
+
+	struct Frame {
+		bool Read(CDumpFile& dump) {
+			if (!dump.Read(&header, 1))
+				return false;
+
+			return (dump.ReadVector(units, header.numUnits) &&
+				dump.ReadVector(features, header.numFeatures) &&
+				dump.ReadVector(projectiles, header.numProjectiles) &&
+				dump.ReadVector(teams, header.numTeams) &&
+				dump.ReadVector(allyTeams, header.numAllyTeams) &&
+				dump.Read(&map, 1));
+		}
+
+		FrameHeader header;
+
+		std::vector<UnitRecord> units;
+		std::vector<FeatureRecord> features;
+		std::vector<ProjectileRecord> projectiles;
+		std::vector<TeamRecord> teams;
+		std::vector<AllyTeamRecord> allyTeams;
+
+		MapRecord map;
+	};
+
+
+	class CDumpComparer {
+	public:
+		bool LimitReached() const { return (FLAGS_maxdiffs > 0 && numDiffs >= FLAGS_maxdiffs); }
+		int GetNumDiffs() const { return numDiffs; }
+
+		// returns false if the frame has any difference
+		bool CompareFrames(const Frame& a, const Frame& b) {
+			const int oldNumDiffs = numDiffs;
+
+			frameNum = a.header.frameNum;
+
+			if (a.header.randSeed != b.header.randSeed)
+				Report("frame", -1, "randSeed", "%u vs %u", a.header.randSeed, b.header.randSeed);
+			if (a.header.syncChecksum != b.header.syncChecksum)
+				Report("frame", -1, "syncChecksum", "%08x vs %08x", a.header.syncChecksum, b.header.syncChecksum);
+
+			CompareRecords("unit", a.units, b.units, UNIT_FIELDS);
+			CompareRecords("feature", a.features, b.features, FEATURE_FIELDS);
+			CompareRecords("projectile", a.projectiles, b.projectiles, PROJECTILE_FIELDS);
+			CompareRecords("team", a.teams, b.teams, TEAM_FIELDS);
+			CompareRecords("allyteam", a.allyTeams, b.allyTeams, ALLYTEAM_FIELDS);
+			CompareFields("map", -1, &a.map, &b.map, MAP_FIELDS);
+
+			return (numDiffs == oldNumDiffs);
+		}
+
+	private:
+		template<typename R, size_t N>
+		void CompareRecords(const char* kind, const std::vector<R>& a, const std::vector<R>& b, const Field (&fields)[N]) {
+			// records are matched by id, objects created or destroyed on only one side are reported as such
+			recordIndices.clear();
+
+			for (size_t i = 0; i < b.size(); i++) {
+				recordIndices.emplace(b[i].id, i);
+			}
+
+			if (a.size() != b.size())
+				Report(kind, -1, "count", "%zu vs %zu", a.size(), b.size());
+
+			for (size_t i = 0; i < a.size(); i++) {
+				const auto it = recordIndices.find(a[i].id);
+
+				if (it == recordIndices.end()) {
+					Report(kind, a[i].id, "(object)", "only in %s", "A");
+					continue;
+				}
+
+				CompareFields(kind, a[i].id, &a[i], &b[it->second], fields);
+				recordIndices.erase(it);
+			}
+
+			for (const auto& p: recordIndices) {
+				Report(kind, p.first, "(object)", "only in %s", "B");
+			}
+		}
+
+		template<typename R, size_t N>
+		void CompareFields(const char* kind, int id, const R* a, const R* b, const Field (&fields)[N]) {
+			const auto* pa = reinterpret_cast<const std::uint8_t*>(a);
+			const auto* pb = reinterpret_cast<const std::uint8_t*>(b);
+
+			for (const Field& f: fields) {
+				if (memcmp(pa + f.offset, pb + f.offset, f.count * 4) == 0)
+					continue;
+
+				std::string va;
+				std::string vb;
+
+				for (int n = 0; n < f.count; n++) {
+					FormatValue(va, pa + f.offset + n * 4, f.type, n > 0);
+					FormatValue(vb, pb + f.offset + n * 4, f.type, n > 0);
+				}
+
+				Report(kind, id, f.name, "%s vs %s", va.c_str(), vb.c_str());
+			}
+		}
+
+		static void FormatValue(std::string& out, const std::uint8_t* p, FieldType type, bool separator) {
+			char buf[64];
+
+			std::uint32_t bits;
+			memcpy(&bits, p, sizeof(bits));
+
+			switch (type) {
+				case FIELD_INT: {
+					snprintf(buf, sizeof(buf), "%d", std::int32_t(bits));
+				} break;
+				case FIELD_UINT: {
+					snprintf(buf, sizeof(buf), "%08x", bits);
+				} break;
+				case FIELD_FLOAT: {
+					// print the bits too, a last-digit difference is not visible otherwise
+					float value;
+					memcpy(&value, p, sizeof(value));
+					snprintf(buf, sizeof(buf), "%.9g[%08x]", value, bits);
+				} break;
+			}
+
+			if (separator)
+				out += ",";
+
+			out += buf;
+		}
+
+		template<typename... Args>
+		void Report(const char* kind, int id, const char* field, const char* fmt, Args... args) {
+			if (LimitReached())
+				return;
+
+			numDiffs += 1;
+
+			char buf[512];
+			snprintf(buf, sizeof(buf), fmt, args...);
+
+			if (id >= 0) {
+				printf("frame %d %s %d %s: %s\n", frameNum, kind, id, field, buf);
+			} else {
+				printf("frame %d %s %s: %s\n", frameNum, kind, field, buf);
+			}
+		}
+
+	private:
+		std::unordered_map<int, size_t> recordIndices;
+
+		int frameNum = 0;
+		int numDiffs = 0;
+	};
+
+
+	bool ReadFileHeader(CDumpFile& dump, FileHeader& header) {
+		if (!dump.Read(&header, 1) || memcmp(header.magic, MAGIC, sizeof(header.magic)) != 0) {
+			fprintf(stderr, "%s is not a binary state dump\n", dump.GetName());
+			return false;
+		}
+		if (header.version != VERSION) {
+			fprintf(stderr, "%s has version %d, expected %d\n", dump.GetName(), header.version, VERSION);
+			return false;
+		}
+
+		header.syncVersion[sizeof(header.syncVersion) - 1] = 0;
+		header.mapName[sizeof(header.mapName) - 1] = 0;
+		header.modName[sizeof(header.modName) - 1] = 0;
+
+		printf("%s: frames %d-%d, syncVer %s, map %s, game %s\n", dump.GetName(), header.minFrame, header.maxFrame, header.syncVersion, header.mapName, header.modName);
+		return true;
+	}
+}
+
+
+int main(int argc, char* argv[])
+{
+	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options] dumpA.sds dumpB.sds");
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+	if (argc != 3) {
+		gflags::ShowUsageWithFlags(argv[0]);
+		return 2;
+	}
+
+	CDumpFile dumpA(argv[1]);
+	CDumpFile dumpB(argv[2]);
+
+	if (!dumpA.IsOpen() || !dumpB.IsOpen()) {
+		fprintf(stderr, "could not open %s\n", dumpA.IsOpen()? argv[2]: argv[1]);
+		return 2;
+	}
+
+	FileHeader headerA;
+	FileHeader headerB;
+
+	if (!ReadFileHeader(dumpA, headerA) || !ReadFileHeader(dumpB, headerB))
+		return 2;
+
+	if (strcmp(headerA.syncVersion, headerB.syncVersion) != 0)
+		printf("warning: dumps were written by different engine versions\n");
+	if (memcmp(headerA.gameID, headerB.gameID, sizeof(headerA.gameID)) != 0)
+		printf("warning: dumps are from different games\n");
+
+	CDumpComparer comparer;
+	Frame frameA;
+	Frame frameB;
+
+	int numFrames = 0;
+	int firstBadFrame = -1;
+
+	bool mismatch = false;
+
+	while (!comparer.LimitReached()) {
+		const bool haveA = frameA.Read(dumpA);
+		const bool haveB = frameB.Read(dumpB);
+
+		if (!haveA || !haveB) {
+			if ((mismatch = (haveA != haveB)))
+				printf("%s ends after %d frames\n", haveA? argv[2]: argv[1], numFrames);
+
+			break;
+		}
+
+		if (frameA.header.frameNum != frameB.header.frameNum) {
+			printf("frame numbers diverge: %d vs %d\n", frameA.header.frameNum, frameB.header.frameNum);
+			mismatch = true;
+			break;
+		}
+
+		numFrames += 1;
+
+		if (comparer.CompareFrames(frameA, frameB))
+			continue;
+
+		if (firstBadFrame < 0)
+			firstBadFrame = frameA.header.frameNum;
+
+		if (FLAGS_firstframe)
+			break;
+	}
+
+	if (firstBadFrame < 0) {
+		printf("%d frames compared, no differences\n", numFrames);
+		return (mismatch? 1: 0);
+	}
+
+	printf("%d frames compared, first difference in frame %d (%d reported)\n", numFrames, firstBadFrame, comparer.GetNumDiffs());
+	return 1;
+}
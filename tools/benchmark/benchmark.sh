@@ -1,45 +1,40 @@
 #!/bin/bash
 
+# Runs each command TESTRUNS times on the same start script (or replay) and
+# collects the per-timer JSON written by --benchmark-frame, e.g. to compare
+# spring-headless builds of different commits:
+#   CMD[0]="/path/to/old/spring-headless" CMD[1]="/path/to/new/spring-headless"
+
 set -e
 
 TESTRUNS=4
+FRAMES=${FRAMES:-9000}
 
-CMD[0]="./spring_pic --benchmark 20 --benchmarkstart 0"
-CMD[1]="./spring_nonpic --benchmark 20 --benchmarkstart 0"
-CMD[2]="./spring_mt --benchmark 20 --benchmarkstart 0"
-
-#CMD1=$CMD2
+CMD[0]="./spring-headless"
+#CMD[1]="./spring-headless-other"
 
 SCRIPT="script_benchmark.txt"
 #SCRIPT="script_benchmark_zwzsg.txt"
-#SCRIPT="demos/20121114_033937_TheHunters-v3_91.0.1-368-gbca8185 develop.sdf"
-DEMOFILE=bench_results_2012-11-20_10-33-36/benchmark.sdf
+#SCRIPT="demos/20121114_033937_TheHunters-v3_91.0.1-368-gbca8185 develop.sdfz"
 
 PREFIX=$PWD/bench_results_$(date +"%Y-%m-%d_%H-%M-%S")
 
 
 mkdir "$PREFIX"
 
-if ! [ -s "$DEMOFILE" ]; then
-	echo Creating demo
-	${CMD[0]} "$SCRIPT" >/dev/null 2>&1 &
-	wait
-	DEMOFILE=`cat infolog.txt | grep "Writing demo: " | cut -c27-`
-	echo demo file: $DEMOFILE
-	cp -v "$DEMOFILE" "$PREFIX/benchmark.sdf"
-	mv benchmark.data "$PREFIX/data-0-cmd1.data"
-fi
-
-
 CMDCOUNT=${#CMD[*]}
 for (( i=1; i <= TESTRUNS; i++ )); do
 	echo Round $i/$TESTRUNS
 	for (( k=0; k < $CMDCOUNT; k++ )); do
 		echo Running CMD $(($k+1))/$CMDCOUNT
-		${CMD[$k]} "$DEMOFILE" >/dev/null 2>&1
-		mv benchmark.data "$PREFIX/data-${i}-cmd${k}.data"
+		${CMD[$k]} --benchmark-frame $FRAMES --benchmark-out "$PREFIX/run-${i}-cmd${k}.json" "$SCRIPT" >/dev/null 2>&1
 	done
 done
 
-#./plot
-#./plot_mass.sh $TESTRUNS
+# total ms per timer, averaged over all runs of each command
+if command -v jq >/dev/null; then
+	for (( k=0; k < $CMDCOUNT; k++ )); do
+		echo "CMD $(($k+1)): ${CMD[$k]}"
+		jq -s 'map(.timers | map_values(.totalMs)) | (length as $n | reduce .[] as $r ({}; reduce ($r | keys[]) as $t (.; .[$t] += $r[$t] / $n)))' "$PREFIX"/run-*-cmd${k}.json
+	done
+fi
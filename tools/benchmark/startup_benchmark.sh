@@ -0,0 +1,76 @@
+#!/bin/bash
+
+# Measures how long each command takes from process start until the game has
+# loaded, TESTRUNS times on the same start script, from the startup traces
+# written by --startup-trace (open any of them in chrome://tracing or Perfetto
+# for the full timeline), e.g. to compare spring-headless builds of different
+# commits:
+#   CMD[0]="/path/to/old/spring-headless" CMD[1]="/path/to/new/spring-headless"
+#
+# COLD=1 deletes the archive cache of WRITEDIR before every run (and drops the
+# OS page cache when run as root), so archives are rescanned and read from disk.
+# BASELINE=<summary-cmd0.json of an earlier run> makes the script fail when the
+# total load time of CMD[0] exceeds the baseline by more than THRESHOLD percent.
+
+set -e
+
+TESTRUNS=${TESTRUNS:-4}
+COLD=${COLD:-1}
+THRESHOLD=${THRESHOLD:-10}
+WRITEDIR=${WRITEDIR:-$HOME/.spring}
+
+CMD[0]="./spring-headless"
+#CMD[1]="./spring-headless-other"
+
+SCRIPT="script_benchmark.txt"
+
+PREFIX=$PWD/startup_results_$(date +"%Y-%m-%d_%H-%M-%S")
+
+
+mkdir "$PREFIX"
+
+CMDCOUNT=${#CMD[*]}
+for (( i=1; i <= TESTRUNS; i++ )); do
+	echo Round $i/$TESTRUNS
+	for (( k=0; k < $CMDCOUNT; k++ )); do
+		echo Running CMD $(($k+1))/$CMDCOUNT
+
+		if [ "$COLD" = "1" ]; then
+			rm -f "$WRITEDIR"/cache/ArchiveCache*
+			if [ "$(id -u)" = "0" ]; then
+				sync
+				echo 3 > /proc/sys/vm/drop_caches
+			fi
+		fi
+
+		# quit as soon as the first sim-frame ran
+		${CMD[$k]} --write-dir "$WRITEDIR" --startup-trace "$PREFIX/trace-${i}-cmd${k}.json" --benchmark-frame 1 --benchmark-out "$PREFIX/frames-${i}-cmd${k}.json" "$SCRIPT" >/dev/null 2>&1
+	done
+done
+
+if ! command -v jq >/dev/null; then
+	echo "jq not found, traces are in $PREFIX"
+	[ -z "$BASELINE" ] || exit 1
+	exit 0
+fi
+
+# wall time until the trace ended and the top-level init and load stages, each averaged over all runs
+for (( k=0; k < $CMDCOUNT; k++ )); do
+	echo "CMD $(($k+1)): ${CMD[$k]}"
+	jq -s 'map(.traceEvents) as $runs | ($runs | length) as $n | {
+		totalMs: ($runs | map(map(.ts + .dur) | max) | add / $n / 1000),
+		stages: (reduce $runs[] as $r ({}; reduce ($r[] | select(.cat == "init" or .cat == "load")) as $e (.; .[$e.name] += $e.dur / $n / 1000)))
+	}' "$PREFIX"/trace-*-cmd${k}.json | tee "$PREFIX/summary-cmd${k}.json"
+done
+
+if [ -n "$BASELINE" ]; then
+	BASE_MS=$(jq '.totalMs' "$BASELINE")
+	CURR_MS=$(jq '.totalMs' "$PREFIX/summary-cmd0.json")
+
+	if jq -n --argjson b "$BASE_MS" --argjson c "$CURR_MS" --argjson t "$THRESHOLD" -e '$c > $b * (1 + $t / 100)' >/dev/null; then
+		echo "startup regression: ${CURR_MS}ms vs. ${BASE_MS}ms baseline (threshold ${THRESHOLD}%)"
+		exit 1
+	fi
+
+	echo "startup time ${CURR_MS}ms vs. ${BASE_MS}ms baseline"
+fi
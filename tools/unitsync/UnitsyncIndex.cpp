@@ -0,0 +1,342 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#include "UnitsyncIndex.h"
+
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <type_traits>
+
+#include "lib/xxhash/xxh3.h"
+#include "Game/GameVersion.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MemoryMappedFile.h"
+#include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+
+
+CUnitsyncIndex unitsyncIndex;
+
+namespace {
+	constexpr char MAGIC[8] = {'R', 'C', 'L', 'U', 'S', 'I', 'D', 'X'};
+	constexpr uint32_t FORMAT_VER = 1;
+	constexpr uint32_t ENDIAN_TAG = 0x01020304;
+
+	struct Header {
+		char magic[8];
+		uint32_t formatVer;
+		uint32_t endianTag;
+		uint32_t numEntries;
+	};
+
+	// entries are stored as length-prefixed fields since none of them are fixed-size
+	class Writer {
+	public:
+		template<typename T> void Put(const T& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			bytes.append(reinterpret_cast<const char*>(&v), sizeof(T));
+		}
+		void Put(const std::string& s) {
+			Put(uint32_t(s.size()));
+			bytes.append(s);
+		}
+		template<typename T> void Put(const std::vector<T>& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			Put(uint32_t(v.size()));
+			bytes.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+		}
+
+		const std::string& GetBytes() const { return bytes; }
+
+	private:
+		std::string bytes;
+	};
+
+	class Reader {
+	public:
+		Reader(const uint8_t* d, size_t n): data(d), size(n) {}
+
+		template<typename T> bool Get(T& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (!Have(sizeof(T)))
+				return false;
+
+			std::memcpy(&v, data + pos, sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+		bool Get(std::string& s) {
+			uint32_t len = 0;
+			if (!Get(len) || !Have(len))
+				return false;
+
+			s.assign(reinterpret_cast<const char*>(data + pos), len);
+			pos += len;
+			return true;
+		}
+		template<typename T> bool Get(std::vector<T>& v) {
+			static_assert(std::is_trivially_copyable_v<T>);
+			uint32_t len = 0;
+			if (!Get(len) || !Have(size_t(len) * sizeof(T)))
+				return false;
+
+			v.resize(len);
+			std::memcpy(v.data(), data + pos, v.size() * sizeof(T));
+			pos += v.size() * sizeof(T);
+			return true;
+		}
+
+		bool AtEnd() const { return (pos == size); }
+
+	private:
+		bool Have(size_t n) const { return (n <= (size - pos)); }
+
+	private:
+		const uint8_t* data;
+		size_t size;
+		size_t pos = 0;
+	};
+}
+
+
+std::string CUnitsyncIndex::GetFilePath()
+{
+	return (FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(FORMAT_VER, "UnitsyncIndex%i.bin"));
+}
+
+uint64_t CUnitsyncIndex::GetMapStamp(const std::string& mapName)
+{
+	std::string stampData;
+
+	for (const std::string& depName: archiveScanner->GetAllArchivesUsedBy(mapName)) {
+		const std::string& archiveName = archiveScanner->ArchiveFromName(depName);
+		const std::string& archivePath = archiveScanner->GetArchivePath(archiveName);
+
+		// unresolved dependency, the map might work once it shows up
+		if (archivePath.empty())
+			return 0;
+
+		const std::string fullPath = archivePath + archiveName;
+
+		// the modification time of a directory does not cover its content
+		if (FileSystem::DirExists(fullPath))
+			return 0;
+
+		stampData += fullPath;
+		stampData += IntToString(int(FileSystem::GetFileModificationTime(fullPath)), "|%i;");
+	}
+
+	if (stampData.empty())
+		return 0;
+
+	// zero is reserved for maps that can not be indexed
+	return (XXH3_64bits(stampData.data(), stampData.size()) | 1);
+}
+
+
+void CUnitsyncIndex::Load()
+{
+	entries.clear();
+	dirty = false;
+
+	const std::string filePath = GetFilePath();
+
+	CMemoryMappedFile file;
+
+	if (!file.Open(filePath))
+		return;
+
+	if (ReadEntries(file.GetData(), file.GetSize())) {
+		LOG_L(L_INFO, "[UnitsyncIndex::%s] read %u map entries from \"%s\"", __func__, uint32_t(entries.size()), filePath.c_str());
+		return;
+	}
+
+	LOG_L(L_WARNING, "[UnitsyncIndex::%s] ignoring outdated or corrupt \"%s\"", __func__, filePath.c_str());
+	entries.clear();
+}
+
+bool CUnitsyncIndex::ReadEntries(const uint8_t* data, size_t size)
+{
+	Reader reader(data, size);
+	Header hdr;
+
+	if (!reader.Get(hdr))
+		return false;
+	if (std::memcmp(hdr.magic, MAGIC, sizeof(hdr.magic)) != 0)
+		return false;
+	if (hdr.formatVer != FORMAT_VER || hdr.endianTag != ENDIAN_TAG)
+		return false;
+
+	std::string version;
+
+	if (!reader.Get(version) || version != SpringVersion::GetFull())
+		return false;
+
+	entries.reserve(hdr.numEntries);
+
+	for (uint32_t i = 0; i < hdr.numEntries; i++) {
+		std::string mapName;
+		MapEntry entry;
+
+		uint8_t flags = 0;
+		uint32_t minimapMask = 0;
+
+		bool read = true;
+		read &= reader.Get(mapName);
+		read &= reader.Get(entry.stamp);
+		read &= reader.Get(flags);
+		read &= reader.Get(entry.minHeight);
+		read &= reader.Get(entry.maxHeight);
+
+		InternalMapInfo& info = entry.info;
+		read &= reader.Get(info.description);
+		read &= reader.Get(info.author);
+		read &= reader.Get(info.tidalStrength);
+		read &= reader.Get(info.gravity);
+		read &= reader.Get(info.maxMetal);
+		read &= reader.Get(info.extractorRadius);
+		read &= reader.Get(info.minWind);
+		read &= reader.Get(info.maxWind);
+		read &= reader.Get(info.width);
+		read &= reader.Get(info.height);
+		read &= reader.Get(info.xPos);
+		read &= reader.Get(info.zPos);
+		read &= reader.Get(minimapMask);
+
+		for (int mip = MIN_INDEXED_MINIMAP_MIP; read && mip < NUM_MINIMAP_MIPS; mip++) {
+			if ((minimapMask & (1u << mip)) != 0)
+				read &= reader.Get(entry.minimaps[mip]);
+		}
+
+		if (!read)
+			return false;
+
+		entry.valid = ((flags & 1) != 0);
+		entry.hasHeights = ((flags & 2) != 0);
+
+		entries[std::move(mapName)] = std::move(entry);
+	}
+
+	return reader.AtEnd();
+}
+
+
+void CUnitsyncIndex::Save()
+{
+	if (!dirty)
+		return;
+
+	dirty = false;
+
+	Header hdr;
+	std::memcpy(hdr.magic, MAGIC, sizeof(hdr.magic));
+
+	hdr.formatVer = FORMAT_VER;
+	hdr.endianTag = ENDIAN_TAG;
+	hdr.numEntries = uint32_t(entries.size());
+
+	Writer writer;
+	writer.Put(hdr);
+	// followed by the engine version, map parsing defaults and rules can differ between them
+	writer.Put(SpringVersion::GetFull());
+
+	for (const auto& [mapName, entry]: entries) {
+		const InternalMapInfo& info = entry.info;
+
+		uint32_t minimapMask = 0;
+
+		for (int mip = MIN_INDEXED_MINIMAP_MIP; mip < NUM_MINIMAP_MIPS; mip++) {
+			minimapMask |= ((!entry.minimaps[mip].empty()) * (1u << mip));
+		}
+
+		writer.Put(mapName);
+		writer.Put(entry.stamp);
+		writer.Put(uint8_t((entry.valid * 1) | (entry.hasHeights * 2)));
+		writer.Put(entry.minHeight);
+		writer.Put(entry.maxHeight);
+
+		writer.Put(info.description);
+		writer.Put(info.author);
+		writer.Put(info.tidalStrength);
+		writer.Put(info.gravity);
+		writer.Put(info.maxMetal);
+		writer.Put(info.extractorRadius);
+		writer.Put(info.minWind);
+		writer.Put(info.maxWind);
+		writer.Put(info.width);
+		writer.Put(info.height);
+		writer.Put(info.xPos);
+		writer.Put(info.zPos);
+		writer.Put(minimapMask);
+
+		for (int mip = MIN_INDEXED_MINIMAP_MIP; mip < NUM_MINIMAP_MIPS; mip++) {
+			if ((minimapMask & (1u << mip)) != 0)
+				writer.Put(entry.minimaps[mip]);
+		}
+	}
+
+	const std::string filePath = GetFilePath();
+	const std::string& bytes = writer.GetBytes();
+
+	FILE* out = fopen(filePath.c_str(), "wb");
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[UnitsyncIndex::%s] failed to write to \"%s\"!", __func__, filePath.c_str());
+		return;
+	}
+
+	const bool written = (fwrite(bytes.data(), bytes.size(), 1, out) == 1);
+
+	if ((fclose(out) == EOF) || !written) {
+		LOG_L(L_ERROR, "[UnitsyncIndex::%s] failed to write to \"%s\"!", __func__, filePath.c_str());
+		// everything in it can be regenerated from the archives
+		FileSystem::Remove(filePath);
+	}
+}
+
+void CUnitsyncIndex::Clear()
+{
+	entries.clear();
+	dirty = false;
+}
+
+
+const CUnitsyncIndex::MapEntry* CUnitsyncIndex::Find(const std::string& mapName, uint64_t stamp) const
+{
+	if (stamp == 0)
+		return nullptr;
+
+	const auto iter = entries.find(mapName);
+
+	if (iter == entries.end() || iter->second.stamp != stamp)
+		return nullptr;
+
+	return &iter->second;
+}
+
+CUnitsyncIndex::MapEntry& CUnitsyncIndex::Insert(const std::string& mapName, uint64_t stamp)
+{
+	assert(stamp != 0);
+
+	MapEntry& entry = entries[mapName];
+
+	entry = {};
+	entry.stamp = stamp;
+	dirty = true;
+
+	return entry;
+}
+
+void CUnitsyncIndex::AddMinimap(const std::string& mapName, uint64_t stamp, int mipLevel, const std::vector<uint8_t>& blocks)
+{
+	if (mipLevel < MIN_INDEXED_MINIMAP_MIP || mipLevel >= NUM_MINIMAP_MIPS)
+		return;
+
+	const auto iter = entries.find(mapName);
+
+	if (iter == entries.end() || stamp == 0 || iter->second.stamp != stamp)
+		return;
+
+	iter->second.minimaps[mipLevel] = blocks;
+	dirty = true;
+}
@@ -0,0 +1,94 @@
+/* This file is part of the Recoil engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef UNITSYNC_INDEX_H
+#define UNITSYNC_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/UnorderedMap.hpp"
+
+/**
+ * @brief map related meta-data
+ */
+struct InternalMapInfo
+{
+	std::string description;  ///< Description (max 255 chars)
+	std::string author;       ///< Creator of the map (max 200 chars)
+	int tidalStrength;        ///< Tidal strength
+	int gravity;              ///< Gravity
+	float maxMetal;           ///< Metal scale factor
+	int extractorRadius;      ///< Extractor radius (of metal extractors)
+	int minWind;              ///< Minimum wind speed
+	int maxWind;              ///< Maximum wind speed
+	int width;                ///< Width of the map
+	int height;               ///< Height of the map
+	std::vector<float> xPos;  ///< Start positions X coordinates defined by the map
+	std::vector<float> zPos;  ///< Start positions Z coordinates defined by the map
+};
+
+
+/**
+ * Persistent record of the per-map query results that otherwise require
+ * loading the map archive (mapinfo, SMF header, minimap), so a lobby that
+ * enumerates all maps on every start only pays for maps it has not seen yet.
+ *
+ * Entries are keyed by map name and stamped with the paths and modification
+ * times of every archive the map depends on; a changed or moved archive makes
+ * its entry stale. The file lives next to the ArchiveCache and is rewritten on
+ * (Un)Init when something was added.
+ */
+class CUnitsyncIndex
+{
+public:
+	static constexpr int NUM_MINIMAP_MIPS = 9;
+	// full-size minimaps are 512KB of DXT1 each, only keep the thumbnail sizes
+	static constexpr int MIN_INDEXED_MINIMAP_MIP = 2;
+
+	struct MapEntry {
+		uint64_t stamp = 0;
+
+		// if false, info.description holds the parser error
+		bool valid = false;
+		// SMF maps only
+		bool hasHeights = false;
+
+		float minHeight = 0.0f;
+		float maxHeight = 0.0f;
+
+		InternalMapInfo info = {};
+
+		// raw DXT1 blocks per mip level, empty if not (yet) requested
+		std::array<std::vector<uint8_t>, NUM_MINIMAP_MIPS> minimaps;
+	};
+
+public:
+	void Load();
+	void Save();
+	void Clear();
+
+	// both return entries that stay valid only until the next Insert
+	const MapEntry* Find(const std::string& mapName, uint64_t stamp) const;
+	MapEntry& Insert(const std::string& mapName, uint64_t stamp);
+
+	void AddMinimap(const std::string& mapName, uint64_t stamp, int mipLevel, const std::vector<uint8_t>& blocks);
+
+	// zero if the map can not be indexed (directory or missing archives)
+	static uint64_t GetMapStamp(const std::string& mapName);
+
+private:
+	static std::string GetFilePath();
+
+	bool ReadEntries(const uint8_t* data, size_t size);
+
+private:
+	spring::unsynced_map<std::string, MapEntry> entries;
+
+	bool dirty = false;
+};
+
+extern CUnitsyncIndex unitsyncIndex;
+
+#endif // UNITSYNC_INDEX_H
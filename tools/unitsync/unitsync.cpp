@@ -2,6 +2,7 @@
 
 #include "unitsync.h"
 #include "unitsync_api.h"
+#include "UnitsyncIndex.h"
 
 #include <algorithm>
 #include <cstring>
@@ -128,26 +129,6 @@ struct GameDataUnitDef {
 	std::string fullName;
 };
 
-/**
- * @brief map related meta-data
- */
-struct InternalMapInfo
-{
-	std::string description;  ///< Description (max 255 chars)
-	std::string author;       ///< Creator of the map (max 200 chars)
-	int tidalStrength;        ///< Tidal strength
-	int gravity;              ///< Gravity
-	float maxMetal;           ///< Metal scale factor
-	int extractorRadius;      ///< Extractor radius (of metal extractors)
-	int minWind;              ///< Minimum wind speed
-	int maxWind;              ///< Maximum wind speed
-	int width;                ///< Width of the map
-	int height;               ///< Height of the map
-	std::vector<float> xPos;  ///< Start positions X coordinates defined by the map
-	std::vector<float> zPos;  ///< Start positions Z coordinates defined by the map
-};
-
-
 static std::vector<InfoItem> infoItems;
 static std::set<std::string> infoSet;
 static std::vector<GameDataUnitDef> unitDefs;
@@ -347,6 +328,9 @@ static void _Cleanup()
 	spring::SafeDelete(unitsyncConfigObserver);
 	internal_deleteMapInfos();
 
+	unitsyncIndex.Save();
+	unitsyncIndex.Clear();
+
 	lpClose();
 	LOG("deinitialized");
 }
@@ -403,6 +387,7 @@ EXPORT(int) Init(bool isServer, int id)
 		FileSystemInitializer::Initialize();
 		// check if VFS is okay (throws if not)
 		CheckForImportantFilesInVFS();
+		unitsyncIndex.Load();
 		ThreadPool::SetThreadCount(0);
 		configHandler->Set("UnitsyncAutoUnLoadMaps", true); //reset on each load (backwards compatibility)
 		unitsyncConfigObserver = new UnitsyncConfigObserver();
@@ -582,13 +567,12 @@ EXPORT(const char*) GetArchivePath(const char* archiveName)
 
 
 
-static bool internal_GetMapInfo(const char* mapName, InternalMapInfo* outInfo)
+// everything the index keeps of a map, read with the map archive loaded
+static void internal_ReadMapEntry(const std::string& mapName, CUnitsyncIndex::MapEntry& entry)
 {
-	CheckInit();
-	CheckNullOrEmpty(mapName);
-	CheckNull(outInfo);
+	InternalMapInfo* outInfo = &entry.info;
 
-	LOG_L(L_DEBUG, "get map info: %s", mapName);
+	LOG_L(L_DEBUG, "get map info: %s", mapName.c_str());
 
 	const std::string mapFile = GetMapFile(mapName);
 
@@ -609,9 +593,15 @@ static bool internal_GetMapInfo(const char* mapName, InternalMapInfo* outInfo)
 			try {
 				const CSMFMapFile file(mapFile);
 				const SMFHeader& mh = file.GetHeader();
+				const LuaTable smfTable = mapTable.SubTable("smf");
 
 				outInfo->width  = mh.mapx * SQUARE_SIZE;
 				outInfo->height = mh.mapy * SQUARE_SIZE;
+
+				// override the header's min- and maxHeight values
+				entry.minHeight = smfTable.KeyExists("minHeight")? smfTable.GetFloat("minHeight", 0.0f): mh.minHeight;
+				entry.maxHeight = smfTable.KeyExists("maxHeight")? smfTable.GetFloat("maxHeight", 0.0f): mh.maxHeight;
+				entry.hasHeights = true;
 			}
 			catch (content_error&) {
 				outInfo->width  = -1;
@@ -634,9 +624,10 @@ static bool internal_GetMapInfo(const char* mapName, InternalMapInfo* outInfo)
 
 	// If the map did not parse, say so now
 	if (!err.empty()) {
-		SetLastError(err);
 		outInfo->description = err;
-		return false;
+		entry.valid = false;
+		entry.hasHeights = false;
+		return;
 	}
 
 	outInfo->description = mapTable.GetString("description", "");
@@ -663,6 +654,44 @@ static bool internal_GetMapInfo(const char* mapName, InternalMapInfo* outInfo)
 		LOG_L(L_DEBUG, "startpos: %.0f, %.0f", pos.x, pos.z);
 	}
 
+	entry.valid = true;
+}
+
+// serves the map from the index if none of its archives changed since it was read
+static const CUnitsyncIndex::MapEntry* internal_GetMapEntry(const std::string& mapName)
+{
+	static CUnitsyncIndex::MapEntry unindexedEntry;
+
+	const uint64_t stamp = CUnitsyncIndex::GetMapStamp(mapName);
+
+	if (const CUnitsyncIndex::MapEntry* indexedEntry = unitsyncIndex.Find(mapName, stamp); indexedEntry != nullptr)
+		return indexedEntry;
+
+	CUnitsyncIndex::MapEntry entry;
+	internal_ReadMapEntry(mapName, entry);
+	entry.stamp = stamp;
+
+	if (stamp == 0)
+		return &(unindexedEntry = std::move(entry));
+
+	return &(unitsyncIndex.Insert(mapName, stamp) = std::move(entry));
+}
+
+static bool internal_GetMapInfo(const char* mapName, InternalMapInfo* outInfo)
+{
+	CheckInit();
+	CheckNullOrEmpty(mapName);
+	CheckNull(outInfo);
+
+	const CUnitsyncIndex::MapEntry* entry = internal_GetMapEntry(mapName);
+
+	*outInfo = entry->info;
+
+	if (!entry->valid) {
+		SetLastError(entry->info.description);
+		return false;
+	}
+
 	return true;
 }
 
@@ -748,6 +777,11 @@ static void internal_deleteMapInfos()
 EXPORT(float) GetMapMinHeight(const char* mapName) {
 	try {
 		CheckInit();
+		CheckNullOrEmpty(mapName);
+
+		if (const CUnitsyncIndex::MapEntry* entry = internal_GetMapEntry(mapName); entry->hasHeights)
+			return (entry->minHeight);
+
 		const std::string mapFile = GetMapFile(mapName);
 		ScopedMapLoader loader(mapName, mapFile);
 		CSMFMapFile file(mapFile);
@@ -770,6 +804,11 @@ EXPORT(float) GetMapMinHeight(const char* mapName) {
 EXPORT(float) GetMapMaxHeight(const char* mapName) {
 	try {
 		CheckInit();
+		CheckNullOrEmpty(mapName);
+
+		if (const CUnitsyncIndex::MapEntry* entry = internal_GetMapEntry(mapName); entry->hasHeights)
+			return (entry->maxHeight);
+
 		const std::string mapFile = GetMapFile(mapName);
 		ScopedMapLoader loader(mapName, mapFile);
 		CSMFMapFile file(mapFile);
@@ -900,15 +939,10 @@ static unsigned short* GetMinimapSM3(std::string mapFileName, int mipLevel)
 	*/
 }
 
-static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
+static unsigned short* DecodeMinimapDXT1(const std::vector<uint8_t>& buffer, int mipsize)
 {
-	CSMFMapFile in(mapFileName);
-	std::vector<uint8_t> buffer;
-	const int mipsize = in.ReadMinimap(buffer, mipLevel);
-
-	// Do stuff
 	unsigned short* colors = (unsigned short*)((void*)imgbuf);
-	unsigned char* temp = &buffer[0];
+	const unsigned char* temp = &buffer[0];
 
 	const int numblocks = buffer.size() / 8;
 	for (int i = 0; i < numblocks; i++) {
@@ -959,6 +993,17 @@ static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
 	return colors;
 }
 
+static unsigned short* GetMinimapSMF(const std::string& mapName, const std::string& mapFileName, uint64_t mapStamp, int mipLevel)
+{
+	CSMFMapFile in(mapFileName);
+	std::vector<uint8_t> buffer;
+	const int mipsize = in.ReadMinimap(buffer, mipLevel);
+
+	unitsyncIndex.AddMinimap(mapName, mapStamp, mipLevel, buffer);
+
+	return DecodeMinimapDXT1(buffer, mipsize);
+}
+
 EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 {
 	try {
@@ -968,13 +1013,25 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 		if (mipLevel < 0 || mipLevel > 8)
 			throw std::out_of_range("Miplevel must be between 0 and 8 (inclusive) in GetMinimap.");
 
+		uint64_t mapStamp = 0;
+
+		// lobby thumbnails, decoded from the index without loading the map
+		if (mipLevel >= CUnitsyncIndex::MIN_INDEXED_MINIMAP_MIP) {
+			const CUnitsyncIndex::MapEntry* entry = internal_GetMapEntry(mapName);
+
+			if (!entry->minimaps[mipLevel].empty())
+				return DecodeMinimapDXT1(entry->minimaps[mipLevel], 1024 >> mipLevel);
+
+			mapStamp = entry->stamp;
+		}
+
 		const std::string mapFile = GetMapFile(mapName);
 		ScopedMapLoader mapLoader(mapName, mapFile);
 
 		unsigned short* ret = nullptr;
 		const std::string extension = FileSystem::GetExtension(mapFile);
 		if (extension == "smf") {
-			ret = GetMinimapSMF(mapFile, mipLevel);
+			ret = GetMinimapSMF(mapName, mapFile, mapStamp, mipLevel);
 		} else if (extension == "sm3") {
 			ret = GetMinimapSM3(mapFile, mipLevel);
 		}